@@ -128,6 +128,28 @@ static gboolean gst_deinitialized = FALSE;
 
 GstClockTime _priv_gst_start_time;
 
+#ifndef GST_DISABLE_GST_DEBUG
+static GstClockTime init_phase_time;
+
+/* log how long the phase of the initialization that ends now took,
+ * GST_DEBUG=GST_INIT:4 gives a breakdown of the startup time */
+static void
+init_phase_done (const gchar * phase)
+{
+  GstClockTime now;
+
+  if (gst_debug_category_get_threshold (GST_CAT_GST_INIT) < GST_LEVEL_INFO)
+    return;
+
+  now = gst_util_get_timestamp ();
+  GST_INFO ("init phase '%s' took %" GST_TIME_FORMAT, phase,
+      GST_TIME_ARGS (now - init_phase_time));
+  init_phase_time = now;
+}
+#else
+#define init_phase_done(phase)
+#endif
+
 #ifdef G_OS_WIN32
 HMODULE _priv_gst_dll_handle = NULL;
 #endif
@@ -143,6 +165,7 @@ gchar *_gst_executable_path = NULL;
 
 #ifndef GST_DISABLE_GST_DEBUG
 const gchar *priv_gst_dump_dot_dir;
+gboolean priv_gst_dump_dot_async;
 #endif
 
 /* defaults */
@@ -556,8 +579,10 @@ init_pre (GOptionContext * context, GOptionGroup * group, gpointer data,
   _priv_gst_start_time = gst_util_get_timestamp ();
 
 #ifndef GST_DISABLE_GST_DEBUG
+  init_phase_time = _priv_gst_start_time;
   _priv_gst_debug_init ();
   priv_gst_dump_dot_dir = g_getenv ("GST_DEBUG_DUMP_DOT_DIR");
+  priv_gst_dump_dot_async = g_getenv ("GST_DEBUG_DUMP_DOT_ASYNC") != NULL;
 #endif
 
 #ifdef ENABLE_NLS
@@ -614,6 +639,8 @@ init_pre (GOptionContext * context, GOptionGroup * group, gpointer data,
       "implemented using real hardware atomic operations!");
 #endif
 
+  init_phase_done ("debug system and translations");
+
   return TRUE;
 }
 
@@ -653,9 +680,12 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
     return TRUE;
   }
 
+  init_phase_done ("option parsing");
+
   llf = G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_ERROR | G_LOG_FLAG_FATAL;
   g_log_set_handler (g_log_domain_gstreamer, llf, debug_log_handler, NULL);
 
+  _priv_gst_free_list_initialize ();
   _priv_gst_mini_object_initialize ();
   _priv_gst_quarks_initialize ();
   _priv_gst_allocator_initialize ();
@@ -678,95 +708,99 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   g_type_class_ref (gst_bus_get_type ());
   g_type_class_ref (gst_task_get_type ());
   g_type_class_ref (gst_clock_get_type ());
-  g_type_class_ref (gst_debug_color_mode_get_type ());
 
   gst_uri_handler_get_type ();
 
-  g_type_class_ref (gst_object_flags_get_type ());
-  g_type_class_ref (gst_bin_flags_get_type ());
-  g_type_class_ref (gst_buffer_flags_get_type ());
-  g_type_class_ref (gst_buffer_copy_flags_get_type ());
-  g_type_class_ref (gst_bus_flags_get_type ());
-  g_type_class_ref (gst_bus_sync_reply_get_type ());
-  g_type_class_ref (gst_caps_flags_get_type ());
-  g_type_class_ref (gst_clock_return_get_type ());
-  g_type_class_ref (gst_clock_entry_type_get_type ());
-  g_type_class_ref (gst_clock_flags_get_type ());
-  g_type_class_ref (gst_clock_type_get_type ());
-  g_type_class_ref (gst_debug_graph_details_get_type ());
-  g_type_class_ref (gst_state_get_type ());
-  g_type_class_ref (gst_state_change_return_get_type ());
-  g_type_class_ref (gst_state_change_get_type ());
-  g_type_class_ref (gst_element_flags_get_type ());
-  g_type_class_ref (gst_tracer_value_scope_get_type ());
-  g_type_class_ref (gst_tracer_value_flags_get_type ());
-  g_type_class_ref (gst_core_error_get_type ());
-  g_type_class_ref (gst_library_error_get_type ());
-  g_type_class_ref (gst_resource_error_get_type ());
-  g_type_class_ref (gst_stream_error_get_type ());
-  g_type_class_ref (gst_event_type_flags_get_type ());
-  g_type_class_ref (gst_event_type_get_type ());
-  g_type_class_ref (gst_seek_type_get_type ());
-  g_type_class_ref (gst_seek_flags_get_type ());
-  g_type_class_ref (gst_qos_type_get_type ());
-  g_type_class_ref (gst_format_get_type ());
-  g_type_class_ref (gst_debug_level_get_type ());
-  g_type_class_ref (gst_debug_color_flags_get_type ());
-  g_type_class_ref (gst_iterator_result_get_type ());
-  g_type_class_ref (gst_iterator_item_get_type ());
-  g_type_class_ref (gst_message_type_get_type ());
-  g_type_class_ref (gst_mini_object_flags_get_type ());
-  g_type_class_ref (gst_pad_link_return_get_type ());
-  g_type_class_ref (gst_pad_link_check_get_type ());
-  g_type_class_ref (gst_flow_return_get_type ());
-  g_type_class_ref (gst_pad_mode_get_type ());
-  g_type_class_ref (gst_pad_direction_get_type ());
-  g_type_class_ref (gst_pad_flags_get_type ());
-  g_type_class_ref (gst_pad_presence_get_type ());
-  g_type_class_ref (gst_pad_template_flags_get_type ());
-  g_type_class_ref (gst_pipeline_flags_get_type ());
-  g_type_class_ref (gst_plugin_error_get_type ());
-  g_type_class_ref (gst_plugin_flags_get_type ());
-  g_type_class_ref (gst_plugin_dependency_flags_get_type ());
-  g_type_class_ref (gst_rank_get_type ());
-  g_type_class_ref (gst_query_type_flags_get_type ());
-  g_type_class_ref (gst_query_type_get_type ());
-  g_type_class_ref (gst_buffering_mode_get_type ());
-  g_type_class_ref (gst_stream_status_type_get_type ());
-  g_type_class_ref (gst_structure_change_type_get_type ());
-  g_type_class_ref (gst_tag_merge_mode_get_type ());
-  g_type_class_ref (gst_tag_flag_get_type ());
-  g_type_class_ref (gst_tag_scope_get_type ());
   g_type_class_ref (gst_task_pool_get_type ());
-  g_type_class_ref (gst_task_state_get_type ());
-  g_type_class_ref (gst_toc_entry_type_get_type ());
-  g_type_class_ref (gst_type_find_probability_get_type ());
-  g_type_class_ref (gst_uri_error_get_type ());
-  g_type_class_ref (gst_uri_type_get_type ());
-  g_type_class_ref (gst_parse_error_get_type ());
-  g_type_class_ref (gst_parse_flags_get_type ());
-  g_type_class_ref (gst_search_mode_get_type ());
-  g_type_class_ref (gst_progress_type_get_type ());
-  g_type_class_ref (gst_buffer_pool_acquire_flags_get_type ());
-  g_type_class_ref (gst_memory_flags_get_type ());
-  g_type_class_ref (gst_map_flags_get_type ());
-  g_type_class_ref (gst_caps_intersect_mode_get_type ());
-  g_type_class_ref (gst_pad_probe_type_get_type ());
-  g_type_class_ref (gst_pad_probe_return_get_type ());
-  g_type_class_ref (gst_segment_flags_get_type ());
-  g_type_class_ref (gst_scheduling_flags_get_type ());
-  g_type_class_ref (gst_meta_flags_get_type ());
-  g_type_class_ref (gst_toc_entry_type_get_type ());
-  g_type_class_ref (gst_toc_scope_get_type ());
-  g_type_class_ref (gst_toc_loop_type_get_type ());
+  g_type_class_ref (gst_work_stealing_task_pool_get_type ());
+  g_type_class_ref (gst_thread_policy_get_type ());
   g_type_class_ref (gst_control_binding_get_type ());
   g_type_class_ref (gst_control_source_get_type ());
-  g_type_class_ref (gst_lock_flags_get_type ());
-  g_type_class_ref (gst_allocator_flags_get_type ());
-  g_type_class_ref (gst_stream_flags_get_type ());
-  g_type_class_ref (gst_stream_type_get_type ());
-  g_type_class_ref (gst_stack_trace_flags_get_type ());
-  g_type_class_ref (gst_promise_result_get_type ());
+
+  /* only register the enum and flags types, their classes are created when
+   * they are first used */
+  g_type_ensure (gst_debug_color_mode_get_type ());
+  g_type_ensure (gst_object_flags_get_type ());
+  g_type_ensure (gst_bin_flags_get_type ());
+  g_type_ensure (gst_buffer_flags_get_type ());
+  g_type_ensure (gst_buffer_copy_flags_get_type ());
+  g_type_ensure (gst_bus_flags_get_type ());
+  g_type_ensure (gst_bus_sync_reply_get_type ());
+  g_type_ensure (gst_caps_flags_get_type ());
+  g_type_ensure (gst_clock_return_get_type ());
+  g_type_ensure (gst_clock_entry_type_get_type ());
+  g_type_ensure (gst_clock_flags_get_type ());
+  g_type_ensure (gst_clock_type_get_type ());
+  g_type_ensure (gst_debug_graph_details_get_type ());
+  g_type_ensure (gst_state_get_type ());
+  g_type_ensure (gst_state_change_return_get_type ());
+  g_type_ensure (gst_state_change_get_type ());
+  g_type_ensure (gst_element_flags_get_type ());
+  g_type_ensure (gst_tracer_value_scope_get_type ());
+  g_type_ensure (gst_tracer_value_flags_get_type ());
+  g_type_ensure (gst_core_error_get_type ());
+  g_type_ensure (gst_library_error_get_type ());
+  g_type_ensure (gst_resource_error_get_type ());
+  g_type_ensure (gst_stream_error_get_type ());
+  g_type_ensure (gst_event_type_flags_get_type ());
+  g_type_ensure (gst_event_type_get_type ());
+  g_type_ensure (gst_seek_type_get_type ());
+  g_type_ensure (gst_seek_flags_get_type ());
+  g_type_ensure (gst_qos_type_get_type ());
+  g_type_ensure (gst_format_get_type ());
+  g_type_ensure (gst_debug_level_get_type ());
+  g_type_ensure (gst_debug_color_flags_get_type ());
+  g_type_ensure (gst_iterator_result_get_type ());
+  g_type_ensure (gst_iterator_item_get_type ());
+  g_type_ensure (gst_message_type_get_type ());
+  g_type_ensure (gst_mini_object_flags_get_type ());
+  g_type_ensure (gst_pad_link_return_get_type ());
+  g_type_ensure (gst_pad_link_check_get_type ());
+  g_type_ensure (gst_flow_return_get_type ());
+  g_type_ensure (gst_pad_mode_get_type ());
+  g_type_ensure (gst_pad_direction_get_type ());
+  g_type_ensure (gst_pad_flags_get_type ());
+  g_type_ensure (gst_pad_presence_get_type ());
+  g_type_ensure (gst_pad_template_flags_get_type ());
+  g_type_ensure (gst_pipeline_flags_get_type ());
+  g_type_ensure (gst_plugin_error_get_type ());
+  g_type_ensure (gst_plugin_flags_get_type ());
+  g_type_ensure (gst_plugin_dependency_flags_get_type ());
+  g_type_ensure (gst_rank_get_type ());
+  g_type_ensure (gst_query_type_flags_get_type ());
+  g_type_ensure (gst_query_type_get_type ());
+  g_type_ensure (gst_buffering_mode_get_type ());
+  g_type_ensure (gst_stream_status_type_get_type ());
+  g_type_ensure (gst_structure_change_type_get_type ());
+  g_type_ensure (gst_tag_merge_mode_get_type ());
+  g_type_ensure (gst_tag_flag_get_type ());
+  g_type_ensure (gst_tag_scope_get_type ());
+  g_type_ensure (gst_task_state_get_type ());
+  g_type_ensure (gst_toc_entry_type_get_type ());
+  g_type_ensure (gst_type_find_probability_get_type ());
+  g_type_ensure (gst_uri_error_get_type ());
+  g_type_ensure (gst_uri_type_get_type ());
+  g_type_ensure (gst_parse_error_get_type ());
+  g_type_ensure (gst_parse_flags_get_type ());
+  g_type_ensure (gst_search_mode_get_type ());
+  g_type_ensure (gst_progress_type_get_type ());
+  g_type_ensure (gst_buffer_pool_acquire_flags_get_type ());
+  g_type_ensure (gst_memory_flags_get_type ());
+  g_type_ensure (gst_map_flags_get_type ());
+  g_type_ensure (gst_caps_intersect_mode_get_type ());
+  g_type_ensure (gst_pad_probe_type_get_type ());
+  g_type_ensure (gst_pad_probe_return_get_type ());
+  g_type_ensure (gst_segment_flags_get_type ());
+  g_type_ensure (gst_scheduling_flags_get_type ());
+  g_type_ensure (gst_meta_flags_get_type ());
+  g_type_ensure (gst_toc_scope_get_type ());
+  g_type_ensure (gst_toc_loop_type_get_type ());
+  g_type_ensure (gst_lock_flags_get_type ());
+  g_type_ensure (gst_allocator_flags_get_type ());
+  g_type_ensure (gst_stream_flags_get_type ());
+  g_type_ensure (gst_stream_type_get_type ());
+  g_type_ensure (gst_stack_trace_flags_get_type ());
+  g_type_ensure (gst_promise_result_get_type ());
 
   _priv_gst_event_initialize ();
   _priv_gst_buffer_initialize ();
@@ -781,6 +815,8 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   g_type_class_ref (gst_param_spec_fraction_get_type ());
   gst_parse_context_get_type ();
 
+  init_phase_done ("core types");
+
   _priv_gst_plugin_initialize ();
 
   /* register core plugins */
@@ -789,6 +825,8 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
       gst_register_core_elements, VERSION, GST_LICENSE, PACKAGE,
       GST_PACKAGE_NAME, GST_PACKAGE_ORIGIN);
 
+  init_phase_done ("core elements");
+
   /*
    * Any errors happening below this point are non-fatal, we therefore mark
    * gstreamer as being initialized, since it is the case from a plugin point of
@@ -803,6 +841,8 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   if (!gst_update_registry ())
     return FALSE;
 
+  init_phase_done ("registry");
+
   GST_INFO ("GLib runtime version: %d.%d.%d", glib_major_version,
       glib_minor_version, glib_micro_version);
   GST_INFO ("GLib headers version: %d.%d.%d", GLIB_MAJOR_VERSION,
@@ -813,6 +853,11 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   _priv_gst_tracing_init ();
 #endif
 
+  init_phase_done ("tracing");
+  GST_INFO ("initialization took %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (GST_CLOCK_DIFF (_priv_gst_start_time,
+              gst_util_get_timestamp ())));
+
   return TRUE;
 }
 
@@ -1090,6 +1135,9 @@ gst_deinit (void)
     bin_class->pool = NULL;
   }
   gst_task_cleanup_all ();
+#ifndef GST_DISABLE_GST_DEBUG
+  _priv_gst_debug_utils_cleanup ();
+#endif
 
   g_slist_foreach (_priv_gst_preload_plugins, (GFunc) g_free, NULL);
   g_slist_free (_priv_gst_preload_plugins);
@@ -1122,6 +1170,7 @@ gst_deinit (void)
 
   _priv_gst_caps_features_cleanup ();
   _priv_gst_caps_cleanup ();
+  _priv_gst_free_list_cleanup ();
 
   g_type_class_unref (g_type_class_peek (gst_object_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_pad_get_type ()));
@@ -1132,97 +1181,10 @@ gst_deinit (void)
   g_type_class_unref (g_type_class_peek (gst_bin_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_bus_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_task_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_object_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_bin_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_buffer_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_buffer_copy_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_bus_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_bus_sync_reply_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_caps_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_clock_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_clock_return_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_clock_entry_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_clock_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_debug_graph_details_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_state_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_state_change_return_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_state_change_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_element_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_tracer_value_scope_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_tracer_value_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_core_error_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_library_error_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_plugin_dependency_flags_get_type
-          ()));
-  g_type_class_unref (g_type_class_peek (gst_parse_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_resource_error_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_search_mode_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_stream_error_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_stream_status_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_structure_change_type_get_type
-          ()));
-  g_type_class_unref (g_type_class_peek (gst_event_type_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_event_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_seek_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_seek_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_qos_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_format_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_debug_level_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_debug_color_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_iterator_result_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_iterator_item_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_message_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_meta_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_mini_object_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_link_return_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_link_check_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_flow_return_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_mode_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_direction_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_presence_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_template_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pipeline_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_plugin_error_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_plugin_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_rank_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_query_type_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_query_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_buffering_mode_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_tag_merge_mode_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_tag_flag_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_tag_scope_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_task_state_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_toc_entry_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_toc_scope_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_type_find_probability_get_type
-          ()));
-  g_type_class_unref (g_type_class_peek (gst_uri_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_uri_error_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_parse_error_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_param_spec_fraction_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_progress_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_buffer_pool_acquire_flags_get_type
-          ()));
-  g_type_class_unref (g_type_class_peek (gst_memory_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_map_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_caps_intersect_mode_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_probe_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_pad_probe_return_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_segment_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_scheduling_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_stream_type_get_type ()));
 
   g_type_class_unref (g_type_class_peek (gst_control_binding_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_control_source_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_toc_entry_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_toc_loop_type_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_lock_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_allocator_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_stream_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_debug_color_mode_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_stack_trace_flags_get_type ()));
-  g_type_class_unref (g_type_class_peek (gst_promise_result_get_type ()));
 
   gst_deinitialized = TRUE;
   GST_INFO ("deinitialized GStreamer");
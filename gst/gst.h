@@ -51,6 +51,7 @@
 #include <gst/gstelementmetadata.h>
 #include <gst/gsterror.h>
 #include <gst/gstevent.h>
+#include <gst/gstfreelist.h>
 #include <gst/gstghostpad.h>
 #include <gst/gstinfo.h>
 #include <gst/gstiterator.h>
@@ -79,6 +80,7 @@
 #include <gst/gsttagsetter.h>
 #include <gst/gsttask.h>
 #include <gst/gsttaskpool.h>
+#include <gst/gstthreadpolicy.h>
 #include <gst/gsttoc.h>
 #include <gst/gsttocsetter.h>
 #include <gst/gsttracer.h>
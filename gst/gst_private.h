@@ -129,11 +129,88 @@ G_GNUC_INTERNAL  void  _priv_gst_debug_init (void);
 G_GNUC_INTERNAL  void  _priv_gst_context_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_toc_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_date_time_initialize (void);
+G_GNUC_INTERNAL  void  _priv_gst_free_list_initialize (void);
+
+/* message filtering, see gst_bus_set_message_types() */
+G_GNUC_INTERNAL  gboolean  _priv_gst_bus_accepts_message_type (GstBus * bus, GstMessageType type);
+G_GNUC_INTERNAL  gboolean  _priv_gst_bin_accepts_message_type (GstElement * bin, GstMessageType type);
+G_GNUC_INTERNAL  void      _priv_gst_message_take_contents (GstMessage * message, GstMessage * other);
+
+/* deep-notify filtering, see gst_bin_set_deep_notify_filter() */
+G_GNUC_INTERNAL  gboolean  _priv_gst_bin_accepts_deep_notify (GstObject * object, GstObject * orig, GQuark name);
+
+/* snapshot iterators, see gst_bin_iterate_elements_snapshot() */
+G_GNUC_INTERNAL  GstIterator * _priv_gst_iterator_new_array (GType type, GPtrArray * array);
+
+/* skipping proxy pads in gst_pad_push_data() */
+G_GNUC_INTERNAL  gboolean  _priv_gst_proxy_pad_push_through (GstPad * pad, GstPadProbeType type, gpointer data, GstFlowReturn * ret);
+
+/* GST_OBJECT_LOCK(), GST_PAD_STREAM_LOCK() and GST_STATE_LOCK() for the
+ * places in the core where contention matters. When the lock is contended
+ * and tracers are active the time it took to take it is passed to the
+ * "object-lock-wait" tracer hooks. */
+G_GNUC_INTERNAL  void  _priv_gst_object_lock_contended (GstObject * object, GMutex * lock);
+G_GNUC_INTERNAL  void  _priv_gst_object_rec_lock_contended (GstObject * object, GRecMutex * lock, const gchar * name);
+
+#define GST_OBJECT_LOCK_TRACED(obj) G_STMT_START {                     \
+  GstObject *__gst_lock_obj = GST_OBJECT_CAST (obj);                    \
+  if (G_UNLIKELY (!g_mutex_trylock (GST_OBJECT_GET_LOCK (__gst_lock_obj)))) \
+    _priv_gst_object_lock_contended (__gst_lock_obj,                    \
+        GST_OBJECT_GET_LOCK (__gst_lock_obj));                          \
+} G_STMT_END
+
+#define GST_PAD_STREAM_LOCK_TRACED(pad) G_STMT_START {                 \
+  GstPad *__gst_lock_pad = GST_PAD_CAST (pad);                          \
+  if (G_UNLIKELY (!GST_PAD_STREAM_TRYLOCK (__gst_lock_pad)))            \
+    _priv_gst_object_rec_lock_contended (GST_OBJECT_CAST (__gst_lock_pad), \
+        GST_PAD_GET_STREAM_LOCK (__gst_lock_pad), "stream");            \
+} G_STMT_END
+
+#define GST_STATE_LOCK_TRACED(elem) G_STMT_START {                     \
+  GstElement *__gst_lock_elem = GST_ELEMENT_CAST (elem);                \
+  if (G_UNLIKELY (!GST_STATE_TRYLOCK (__gst_lock_elem)))                \
+    _priv_gst_object_rec_lock_contended (GST_OBJECT_CAST (__gst_lock_elem), \
+        GST_STATE_GET_LOCK (__gst_lock_elem), "state");                 \
+} G_STMT_END
 
 /* cleanup functions called from gst_deinit(). */
 G_GNUC_INTERNAL  void  _priv_gst_allocator_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_features_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_free_list_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_debug_utils_cleanup (void);
+
+/* per-thread free-lists for fixed size objects, see gstfreelist.c */
+typedef enum {
+  GST_FREE_LIST_BUFFER,
+  GST_FREE_LIST_EVENT,
+  GST_FREE_LIST_META,
+  GST_FREE_LIST_BUFFER_LIST,
+  GST_FREE_LIST_SAMPLE,
+  GST_FREE_LIST_LAST
+} GstFreeListType;
+
+typedef struct {
+  guint64 hits;
+  guint64 misses;
+  guint64 overflows;
+} GstFreeListStats;
+
+G_GNUC_INTERNAL  void      _priv_gst_free_list_set_block_size (GstFreeListType type, gsize size);
+G_GNUC_INTERNAL  gpointer  _priv_gst_free_list_alloc (GstFreeListType type);
+G_GNUC_INTERNAL  void      _priv_gst_free_list_free  (GstFreeListType type, gpointer mem);
+G_GNUC_INTERNAL  void      _priv_gst_free_list_get_stats (GstFreeListType type, GstFreeListStats * stats);
+
+/* all clock entries are allocated with this size by gstclock.c, the extra
+ * fields are used by gstsystemclock.c to keep its async entries in a heap */
+typedef struct {
+  GstClockEntry entry;
+
+  gint          heap_index;     /* -1 when not in the async heap */
+  guint64       heap_seqnum;    /* orders entries with the same time */
+} GstClockEntryImpl;
+
+#define GST_CLOCK_ENTRY_IMPL(e) ((GstClockEntryImpl *)(e))
 
 /* called from gst_task_cleanup_all(). */
 G_GNUC_INTERNAL  void  _priv_gst_element_cleanup (void);
@@ -144,6 +221,34 @@ gboolean _priv_gst_registry_remove_cache_plugins (GstRegistry *registry);
 
 G_GNUC_INTERNAL  void _priv_gst_registry_cleanup (void);
 
+/* Recreates the timer and async thread state of the default system clock
+ * in the child of a fork */
+G_GNUC_INTERNAL  void _priv_gst_system_clock_after_fork (void);
+
+G_GNUC_INTERNAL
+GList * _priv_gst_registry_get_feature_view (GstRegistry * registry,
+                                             GType type, guint64 key,
+                                             guint minrank,
+                                             GstPluginFeatureFilter filter,
+                                             gpointer user_data);
+
+G_GNUC_INTERNAL
+GList * _priv_gst_registry_get_uri_factories (GstRegistry * registry,
+                                              GstURIType type,
+                                              const gchar * protocol);
+
+/* modification times of the scanned plugin directories, stored in the
+ * registry cache */
+G_GNUC_INTERNAL
+GHashTable * _priv_gst_registry_get_directories (GstRegistry * registry);
+
+G_GNUC_INTERNAL
+void _priv_gst_registry_set_directory (GstRegistry * registry,
+                                       const gchar * path, gint64 mtime);
+
+/* changes whenever the rank of any plugin feature changes */
+G_GNUC_INTERNAL  guint _priv_gst_plugin_feature_get_rank_cookie (void);
+
 GST_EXPORT
 gboolean _gst_plugin_loader_client_run (void);
 
@@ -160,6 +265,46 @@ G_GNUC_INTERNAL gboolean _priv_gst_value_parse_simple_string (gchar * str, gchar
 G_GNUC_INTERNAL gboolean _priv_gst_value_parse_value (gchar * str, gchar ** after, GValue * value, GType default_type);
 G_GNUC_INTERNAL gchar * _priv_gst_value_serialize_any_list (const GValue * value, const gchar * begin, const gchar * end, gboolean print_type);
 
+/* binary serialization, see gstvalue.c */
+typedef enum {
+  GST_BINARY_KIND_STRUCTURE = 1,
+  GST_BINARY_KIND_CAPS,
+  GST_BINARY_KIND_TAG_LIST,
+  GST_BINARY_KIND_EVENT,
+  GST_BINARY_KIND_QUERY
+} GstBinaryKind;
+
+typedef struct {
+  const guint8 *data;
+  gsize size;
+  gsize offset;
+
+  guint depth;
+} GstBinaryReader;
+
+#define GST_BINARY_READER_INIT(data, size) { (data), (size), 0, 0 }
+
+G_GNUC_INTERNAL void     _priv_gst_binary_write_header (GByteArray * array, GstBinaryKind kind);
+G_GNUC_INTERNAL gboolean _priv_gst_binary_read_header (GstBinaryReader * reader, GstBinaryKind kind);
+G_GNUC_INTERNAL void     _priv_gst_binary_write_uint8 (GByteArray * array, guint8 val);
+G_GNUC_INTERNAL gboolean _priv_gst_binary_read_uint8 (GstBinaryReader * reader, guint8 * val);
+G_GNUC_INTERNAL void     _priv_gst_binary_write_uint32 (GByteArray * array, guint32 val);
+G_GNUC_INTERNAL gboolean _priv_gst_binary_read_uint32 (GstBinaryReader * reader, guint32 * val);
+G_GNUC_INTERNAL void     _priv_gst_binary_write_uint64 (GByteArray * array, guint64 val);
+G_GNUC_INTERNAL gboolean _priv_gst_binary_read_uint64 (GstBinaryReader * reader, guint64 * val);
+G_GNUC_INTERNAL void     _priv_gst_binary_write_string (GByteArray * array, const gchar * str);
+G_GNUC_INTERNAL gboolean _priv_gst_binary_read_string (GstBinaryReader * reader, gchar ** str);
+G_GNUC_INTERNAL gboolean _priv_gst_value_write_binary (GByteArray * array, const GValue * value);
+G_GNUC_INTERNAL gboolean _priv_gst_value_read_binary (GstBinaryReader * reader, GValue * value);
+G_GNUC_INTERNAL gboolean _priv_gst_structure_write_binary (GByteArray * array, const GstStructure * structure);
+G_GNUC_INTERNAL GstStructure * _priv_gst_structure_read_binary (GstBinaryReader * reader);
+G_GNUC_INTERNAL gboolean _priv_gst_structure_has_fields_of (const GstStructure * structure, const GstStructure * reference);
+/* gst_caps_to_string() that keeps the result for caps that are not writable */
+G_GNUC_INTERNAL gchar * _priv_gst_caps_describe (const GstCaps * caps);
+
+G_GNUC_INTERNAL gboolean _priv_gst_caps_write_binary (GByteArray * array, const GstCaps * caps);
+G_GNUC_INTERNAL GstCaps * _priv_gst_caps_read_binary (GstBinaryReader * reader);
+
 /* Used in GstBin for manual state handling */
 G_GNUC_INTERNAL  void _priv_gst_element_state_changed (GstElement *element,
                       GstState oldstate, GstState newstate, GstState pending);
@@ -198,6 +343,9 @@ gboolean		priv_gst_registry_binary_read_cache	(GstRegistry * registry, const cha
 G_GNUC_INTERNAL
 gboolean		priv_gst_registry_binary_write_cache	(GstRegistry * registry, GList * plugins, const char *location);
 
+G_GNUC_INTERNAL
+void			priv_gst_registry_binary_cleanup	(void);
+
 
 G_GNUC_INTERNAL
 void      __gst_element_factory_add_static_pad_template (GstElementFactory    * elementfactory,
@@ -207,6 +355,12 @@ G_GNUC_INTERNAL
 void      __gst_element_factory_add_interface           (GstElementFactory    * elementfactory,
                                                          const gchar          * interfacename);
 
+G_GNUC_INTERNAL
+gboolean  __gst_element_factory_can_accept_caps         (GstElementFactory    * elementfactory,
+                                                         const GstCaps        * caps,
+                                                         GstPadDirection        direction,
+                                                         gboolean               subsetonly);
+
 /* used in gstvalue.c and gststructure.c */
 #define GST_ASCII_IS_STRING(c) (g_ascii_isalnum((c)) || ((c) == '_') || \
     ((c) == '-') || ((c) == '+') || ((c) == '/') || ((c) == ':') || \
@@ -410,7 +564,12 @@ struct _GstTypeFindFactory {
 
   GstTypeFindFunction           function;
   gchar **                      extensions;
+  /* leading bytes of the stream as hex strings */
+  gchar **                      prefixes;
   GstCaps *                     caps;
+  /* caps of factories loaded from the registry cache, parsed into caps on
+   * first use */
+  const gchar *                 caps_string;
 
   gpointer                      user_data;
   GDestroyNotify                user_data_notify;
@@ -452,6 +611,9 @@ struct _GstElementFactory {
   GType                 type;                   /* unique GType of element or 0 if not loaded */
 
   gpointer              metadata;
+  /* metadata of factories loaded from the registry cache, parsed into
+   * metadata on first use */
+  const gchar *         metadata_string;
 
   GList *               staticpadtemplates;     /* GstStaticPadTemplate list */
   guint                 numpadtemplates;
@@ -462,6 +624,14 @@ struct _GstElementFactory {
 
   GList *               interfaces;             /* interface type names this element implements */
 
+  /* media types of the static pad templates, see
+   * __gst_element_factory_can_accept_caps() */
+  gpointer              caps_matcher;
+
+  /* recycled instances, protected by the object lock */
+  GQueue                pool;
+  guint                 pool_size;
+
   /*< private >*/
   gpointer _gst_reserved[GST_PADDING];
 };
@@ -480,6 +650,9 @@ struct _GstDeviceProviderFactory {
 
   volatile GstDeviceProvider *provider;
   gpointer                   metadata;
+  /* metadata of factories loaded from the registry cache, parsed into
+   * metadata on first use */
+  const gchar *              metadata_string;
 
   gpointer _gst_reserved[GST_PADDING];
 };
@@ -45,6 +45,11 @@
 #include "gst_private.h"
 #include "gstmemory.h"
 
+#include <stdlib.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 #define GST_CAT_DEFAULT gst_allocator_debug
 
@@ -366,13 +371,13 @@ G_DEFINE_TYPE (GstAllocatorSysmem, gst_allocator_sysmem, GST_TYPE_ALLOCATOR);
 
 /* initialize the fields */
 static inline void
-_sysmem_init (GstMemorySystem * mem, GstMemoryFlags flags,
-    GstMemory * parent, gsize slice_size,
+_sysmem_init (GstMemorySystem * mem, GstAllocator * allocator,
+    GstMemoryFlags flags, GstMemory * parent, gsize slice_size,
     gpointer data, gsize maxsize, gsize align, gsize offset, gsize size,
     gpointer user_data, GDestroyNotify notify)
 {
   gst_memory_init (GST_MEMORY_CAST (mem),
-      flags, _sysmem_allocator, parent, maxsize, align, offset, size);
+      flags, allocator, parent, maxsize, align, offset, size);
 
   mem->slice_size = slice_size;
   mem->data = data;
@@ -382,7 +387,7 @@ _sysmem_init (GstMemorySystem * mem, GstMemoryFlags flags,
 
 /* create a new memory block that manages the given memory */
 static inline GstMemorySystem *
-_sysmem_new (GstMemoryFlags flags,
+_sysmem_new (GstAllocator * allocator, GstMemoryFlags flags,
     GstMemory * parent, gpointer data, gsize maxsize, gsize align, gsize offset,
     gsize size, gpointer user_data, GDestroyNotify notify)
 {
@@ -392,12 +397,59 @@ _sysmem_new (GstMemoryFlags flags,
   slice_size = sizeof (GstMemorySystem);
 
   mem = g_slice_alloc (slice_size);
-  _sysmem_init (mem, flags, parent, slice_size,
+  _sysmem_init (mem, allocator, flags, parent, slice_size,
       data, maxsize, align, offset, size, user_data, notify);
 
   return mem;
 }
 
+#ifdef HAVE_POSIX_MEMALIGN
+/* from this size on the data is allocated separately with the requested
+ * alignment instead of allocating more and aligning inside the block */
+#define LARGE_BLOCK_SIZE (256 * 1024)
+
+#if defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+/* the data of blocks from this size on is aligned to and backed by huge
+ * pages when the system has them */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+
+static GstMemorySystem *
+_sysmem_new_large_block (GstMemoryFlags flags,
+    gsize maxsize, gsize align, gsize offset, gsize size)
+{
+  gpointer data;
+  gsize alignment, padding;
+
+  /* posix_memalign() needs at least the size of a pointer */
+  alignment = MAX (align + 1, sizeof (gpointer));
+#ifdef HUGE_PAGE_SIZE
+  if (maxsize >= HUGE_PAGE_SIZE)
+    alignment = MAX (alignment, HUGE_PAGE_SIZE);
+#endif
+
+  if (posix_memalign (&data, alignment, maxsize) != 0)
+    return NULL;
+
+#ifdef HUGE_PAGE_SIZE
+  /* only a hint, the memory works the same without huge pages */
+  if (maxsize >= HUGE_PAGE_SIZE)
+    madvise (data, maxsize, MADV_HUGEPAGE);
+#endif
+
+  if (offset && (flags & GST_MEMORY_FLAG_ZERO_PREFIXED))
+    memset (data, 0, offset);
+
+  padding = maxsize - (offset + size);
+  if (padding && (flags & GST_MEMORY_FLAG_ZERO_PADDED))
+    memset ((guint8 *) data + offset + size, 0, padding);
+
+  /* the data is freed with the memory */
+  return _sysmem_new (_sysmem_allocator, flags, NULL, data, maxsize, align,
+      offset, size, data, free);
+}
+#endif
+
 /* allocate the memory and structure in one block */
 static GstMemorySystem *
 _sysmem_new_block (GstMemoryFlags flags,
@@ -409,6 +461,11 @@ _sysmem_new_block (GstMemoryFlags flags,
 
   /* ensure configured alignment */
   align |= gst_memory_alignment;
+
+#ifdef HAVE_POSIX_MEMALIGN
+  if (maxsize >= LARGE_BLOCK_SIZE)
+    return _sysmem_new_large_block (flags, maxsize, align, offset, size);
+#endif
   /* allocate more to compensate for alignment */
   maxsize += align;
   /* alloc header and data in one block */
@@ -434,7 +491,7 @@ _sysmem_new_block (GstMemoryFlags flags,
   if (padding && (flags & GST_MEMORY_FLAG_ZERO_PADDED))
     memset (data + offset + size, 0, padding);
 
-  _sysmem_init (mem, flags, NULL, slice_size, data, maxsize,
+  _sysmem_init (mem, _sysmem_allocator, flags, NULL, slice_size, data, maxsize,
       align, offset, size, NULL, NULL);
 
   return mem;
@@ -483,7 +540,7 @@ _sysmem_share (GstMemorySystem * mem, gssize offset, gsize size)
 
   /* the shared memory is always readonly */
   sub =
-      _sysmem_new (GST_MINI_OBJECT_FLAGS (parent) |
+      _sysmem_new (parent->allocator, GST_MINI_OBJECT_FLAGS (parent) |
       GST_MINI_OBJECT_FLAG_LOCK_READONLY, parent, mem->data, mem->mem.maxsize,
       mem->mem.align, mem->mem.offset + offset, size, NULL, NULL);
 
@@ -576,6 +633,120 @@ gst_allocator_sysmem_init (GstAllocatorSysmem * allocator)
   alloc->mem_is_span = (GstMemoryIsSpanFunction) _sysmem_is_span;
 }
 
+/* an allocator that maps large blocks into huge pages, it makes the same
+ * memory as the system memory allocator */
+typedef struct
+{
+  GstAllocatorSysmem parent;
+} GstAllocatorHugepage;
+
+typedef struct
+{
+  GstAllocatorSysmemClass parent_class;
+} GstAllocatorHugepageClass;
+
+static GType gst_allocator_hugepage_get_type (void);
+G_DEFINE_TYPE (GstAllocatorHugepage, gst_allocator_hugepage,
+    gst_allocator_sysmem_get_type ());
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && defined(MAP_ANONYMOUS)
+/* blocks are mapped in multiples of this size, smaller blocks are allocated
+ * from the system memory allocator */
+#define HUGEPAGE_ALLOC_SIZE (2 * 1024 * 1024)
+
+static void
+_hugepage_unmap (GstMemorySystem * mem)
+{
+  munmap (mem->data, mem->mem.maxsize);
+}
+
+static GstMemorySystem *
+_hugepage_new_block (GstAllocator * allocator, GstMemoryFlags flags,
+    gsize maxsize, gsize align, gsize offset, gsize size)
+{
+  GstMemorySystem *mem;
+  guint8 *data = MAP_FAILED;
+  gsize head, tail;
+
+  maxsize = (maxsize + HUGEPAGE_ALLOC_SIZE - 1) &
+      ~((gsize) HUGEPAGE_ALLOC_SIZE - 1);
+
+#ifdef MAP_HUGETLB
+  /* reserved huge pages, these are aligned to the huge page size */
+  data = mmap (NULL, maxsize, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+  if (data == MAP_FAILED) {
+    /* fall back to transparent huge pages, which the kernel can only use for
+     * the part of the mapping that is aligned to the huge page size. Map a
+     * huge page more and trim the mapping to an aligned range. */
+    data = mmap (NULL, maxsize + HUGEPAGE_ALLOC_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED)
+      return NULL;
+
+    head = (-(guintptr) data) & (HUGEPAGE_ALLOC_SIZE - 1);
+    tail = HUGEPAGE_ALLOC_SIZE - head;
+    if (head)
+      munmap (data, head);
+    if (tail)
+      munmap (data + head + maxsize, tail);
+    data += head;
+
+#if defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+    madvise (data, maxsize, MADV_HUGEPAGE);
+#endif
+  }
+
+  /* the mapping is zero filled, like the flags might want */
+  mem = _sysmem_new (allocator, flags, NULL, data, maxsize, align, offset,
+      size, NULL, (GDestroyNotify) _hugepage_unmap);
+  mem->user_data = mem;
+
+  return mem;
+}
+#endif
+
+static GstMemory *
+hugepage_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+#ifdef HUGEPAGE_ALLOC_SIZE
+  GstMemorySystem *mem;
+  gsize maxsize = size + params->prefix + params->padding;
+  gsize align = params->align | gst_memory_alignment;
+
+  if (maxsize >= HUGEPAGE_ALLOC_SIZE && align < HUGEPAGE_ALLOC_SIZE) {
+    mem = _hugepage_new_block (allocator, params->flags, maxsize, align,
+        params->prefix, size);
+    if (mem)
+      return (GstMemory *) mem;
+
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "failed to map %" G_GSIZE_FORMAT
+        " bytes, using system memory", maxsize);
+  }
+#endif
+
+  return default_alloc (_sysmem_allocator, size, params);
+}
+
+static void
+gst_allocator_hugepage_class_init (GstAllocatorHugepageClass * klass)
+{
+  GstAllocatorClass *allocator_class = (GstAllocatorClass *) klass;
+
+  allocator_class->alloc = hugepage_alloc;
+}
+
+static void
+gst_allocator_hugepage_init (GstAllocatorHugepage * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  alloc->mem_type = GST_ALLOCATOR_HUGEPAGE;
+}
+
 void
 _priv_gst_allocator_initialize (void)
 {
@@ -589,6 +760,22 @@ _priv_gst_allocator_initialize (void)
 #endif
 #endif
 
+  /* the alignment can only be raised, for example to what the SIMD
+   * instructions of the machine want */
+  {
+    const gchar *env;
+    guint64 align;
+
+    if ((env = g_getenv ("GST_MEMORY_ALIGNMENT")) != NULL) {
+      align = g_ascii_strtoull (env, NULL, 10);
+      if (align > 0 && (align & (align - 1)) == 0)
+        gst_memory_alignment |= align - 1;
+      else
+        GST_CAT_WARNING (GST_CAT_MEMORY, "invalid memory alignment '%s', "
+            "must be a power of two", env);
+    }
+  }
+
   GST_CAT_DEBUG (GST_CAT_MEMORY, "memory alignment: %" G_GSIZE_FORMAT,
       gst_memory_alignment);
 
@@ -600,7 +787,21 @@ _priv_gst_allocator_initialize (void)
   gst_allocator_register (GST_ALLOCATOR_SYSMEM,
       gst_object_ref (_sysmem_allocator));
 
-  _default_allocator = gst_object_ref (_sysmem_allocator);
+  gst_allocator_register (GST_ALLOCATOR_HUGEPAGE,
+      gst_object_ref_sink (g_object_new (gst_allocator_hugepage_get_type (),
+              NULL)));
+
+  {
+    const gchar *env;
+
+    if ((env = g_getenv ("GST_DEFAULT_ALLOCATOR")) != NULL) {
+      if (!(_default_allocator = gst_allocator_find (env)))
+        GST_CAT_WARNING (GST_CAT_MEMORY, "unknown default allocator '%s'",
+            env);
+    }
+  }
+  if (_default_allocator == NULL)
+    _default_allocator = gst_object_ref (_sysmem_allocator);
 }
 
 void
@@ -644,7 +845,8 @@ gst_memory_new_wrapped (GstMemoryFlags flags, gpointer data,
   g_return_val_if_fail (offset + size <= maxsize, NULL);
 
   mem =
-      _sysmem_new (flags, NULL, data, maxsize, 0, offset, size, user_data,
+      _sysmem_new (_sysmem_allocator, flags, NULL, data, maxsize, 0, offset,
+      size, user_data,
       notify);
 
   return (GstMemory *) mem;
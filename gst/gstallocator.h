@@ -62,6 +62,19 @@ GST_EXPORT gsize gst_memory_alignment;
  */
 #define GST_ALLOCATOR_SYSMEM   "SystemMemory"
 
+/**
+ * GST_ALLOCATOR_HUGEPAGE:
+ *
+ * The allocator name for the allocator that backs large blocks of system
+ * memory with huge pages. It uses reserved huge pages when there are, and
+ * transparent huge pages otherwise. Blocks smaller than a huge page, and
+ * blocks that can't be mapped, are allocated by the #GST_ALLOCATOR_SYSMEM
+ * allocator.
+ *
+ * Since: 1.14
+ */
+#define GST_ALLOCATOR_HUGEPAGE "HugePageMemory"
+
 /**
  * GstAllocationParams:
  * @flags: flags to control allocation
@@ -84,12 +97,16 @@ struct _GstAllocationParams {
 /**
  * GstAllocatorFlags:
  * @GST_ALLOCATOR_FLAG_CUSTOM_ALLOC: The allocator has a custom alloc function.
+ * @GST_ALLOCATOR_FLAG_UNLOCKED_READ_MAP: Mapping the memory of the allocator
+ *     for reading does not lock the memory. Only for allocators whose map
+ *     function returns a pointer without side effects. (Since 1.14)
  * @GST_ALLOCATOR_FLAG_LAST: first flag that can be used for custom purposes
  *
  * Flags for allocators.
  */
 typedef enum {
   GST_ALLOCATOR_FLAG_CUSTOM_ALLOC  = (GST_OBJECT_FLAG_LAST << 0),
+  GST_ALLOCATOR_FLAG_UNLOCKED_READ_MAP = (GST_OBJECT_FLAG_LAST << 1),
 
   GST_ALLOCATOR_FLAG_LAST          = (GST_OBJECT_FLAG_LAST << 16)
 } GstAllocatorFlags;
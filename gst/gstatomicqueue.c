@@ -35,6 +35,12 @@
  *
  * The #GstAtomicQueue object implements a queue that can be used from multiple
  * threads without performing any blocking operations.
+ *
+ * A queue made with gst_atomic_queue_new() grows when it is full. A queue
+ * made with gst_atomic_queue_new_bounded() is a fixed size ring instead that
+ * never allocates after its creation, which scales better when many threads
+ * push and pop at the same time. Items can be pushed and popped in batches
+ * with gst_atomic_queue_push_many() and gst_atomic_queue_pop_many().
  */
 
 G_DEFINE_BOXED_TYPE (GstAtomicQueue, gst_atomic_queue,
@@ -64,12 +70,15 @@ struct _GstAQueueMem
   GstAQueueMem *free;
 };
 
+/* the largest power of 2 in a guint, higher sizes are clamped to it */
+#define MAX_CLP2 (G_MAXUINT / 2 + 1)
+
 static guint
 clp2 (guint n)
 {
   guint res = 1;
 
-  while (res < n)
+  while (res < n && res < MAX_CLP2)
     res <<= 1;
 
   return res;
@@ -101,6 +110,190 @@ free_queue_mem (GstAQueueMem * mem)
   g_free (mem);
 }
 
+/* The bounded queue is a ring of cells with a sequence number each, as
+ * described by Dmitry Vyukov. A cell with sequence pos can be written by the
+ * writer that claims position pos, after which the sequence becomes pos + 1
+ * and the cell can be read by the reader that claims position pos. The
+ * reader then sets the sequence to pos + size for the next round.
+ *
+ * The positions wrap around, which is fine because the size is a power of
+ * two. The write and read positions are in separate cache lines so that
+ * writers and readers don't slow down each other. */
+#define CACHE_LINE_SIZE 64
+
+/* the distance between positions and sequences must fit in a gint */
+#define MAX_RING_CAPACITY (1U << 30)
+
+typedef struct _GstARingCell GstARingCell;
+typedef struct _GstARing GstARing;
+
+struct _GstARingCell
+{
+  volatile gint sequence;
+  gpointer data;
+};
+
+struct _GstARing
+{
+  volatile gint enqueue_pos;
+  gchar pad1[CACHE_LINE_SIZE - sizeof (gint)];
+  volatile gint dequeue_pos;
+  gchar pad2[CACHE_LINE_SIZE - sizeof (gint)];
+  guint mask;
+  GstARingCell *cells;
+};
+
+static GstARing *
+new_ring (guint capacity)
+{
+  GstARing *ring;
+  guint i;
+
+  ring = g_new0 (GstARing, 1);
+  /* with a single cell a full and an empty cell can't be told apart */
+  ring->mask = clp2 (CLAMP (capacity, 2, MAX_RING_CAPACITY)) - 1;
+  ring->cells = g_new (GstARingCell, ring->mask + 1);
+  for (i = 0; i <= ring->mask; i++) {
+    ring->cells[i].sequence = i;
+    ring->cells[i].data = NULL;
+  }
+
+  return ring;
+}
+
+static void
+free_ring (GstARing * ring)
+{
+  g_free (ring->cells);
+  g_free (ring);
+}
+
+/* claims up to n cells after the write position, returns the number of
+ * claimed cells or 0 when the ring is full */
+static guint
+ring_push_many (GstARing * ring, gpointer * data, guint n)
+{
+  GstARingCell *cell;
+  guint pos, seq, i;
+  gint diff;
+
+  while (TRUE) {
+    pos = g_atomic_int_get (&ring->enqueue_pos);
+
+    cell = &ring->cells[pos & ring->mask];
+    seq = g_atomic_int_get (&cell->sequence);
+    diff = (gint) (seq - pos);
+
+    /* the cell still has the item of the previous round */
+    if (diff < 0)
+      return 0;
+    /* another writer claimed the cell, try again */
+    if (G_UNLIKELY (diff > 0))
+      continue;
+
+    /* see how many of the next cells are free as well */
+    for (i = 1; i < n; i++) {
+      cell = &ring->cells[(pos + i) & ring->mask];
+      if ((guint) g_atomic_int_get (&cell->sequence) != pos + i)
+        break;
+    }
+
+    if (G_LIKELY (g_atomic_int_compare_and_exchange (&ring->enqueue_pos,
+                (gint) pos, (gint) (pos + i))))
+      break;
+  }
+
+  n = i;
+  for (i = 0; i < n; i++) {
+    cell = &ring->cells[(pos + i) & ring->mask];
+    cell->data = data[i];
+    /* make the item visible to the readers */
+    g_atomic_int_set (&cell->sequence, pos + i + 1);
+  }
+
+  return n;
+}
+
+/* claims up to n filled cells after the read position, returns the number
+ * of claimed cells or 0 when the ring is empty */
+static guint
+ring_pop_many (GstARing * ring, gpointer * data, guint n)
+{
+  GstARingCell *cell;
+  guint pos, seq, i;
+  gint diff;
+
+  while (TRUE) {
+    pos = g_atomic_int_get (&ring->dequeue_pos);
+
+    cell = &ring->cells[pos & ring->mask];
+    seq = g_atomic_int_get (&cell->sequence);
+    diff = (gint) (seq - (pos + 1));
+
+    /* the cell was not written yet */
+    if (diff < 0)
+      return 0;
+    /* another reader claimed the cell, try again */
+    if (G_UNLIKELY (diff > 0))
+      continue;
+
+    for (i = 1; i < n; i++) {
+      cell = &ring->cells[(pos + i) & ring->mask];
+      if ((guint) g_atomic_int_get (&cell->sequence) != pos + i + 1)
+        break;
+    }
+
+    if (G_LIKELY (g_atomic_int_compare_and_exchange (&ring->dequeue_pos,
+                (gint) pos, (gint) (pos + i))))
+      break;
+  }
+
+  n = i;
+  for (i = 0; i < n; i++) {
+    cell = &ring->cells[(pos + i) & ring->mask];
+    data[i] = cell->data;
+    cell->data = NULL;
+    /* hand the cell to the writer of the next round */
+    g_atomic_int_set (&cell->sequence, pos + i + ring->mask + 1);
+  }
+
+  return n;
+}
+
+static gpointer
+ring_peek (GstARing * ring)
+{
+  GstARingCell *cell;
+  guint pos, seq;
+  gint diff;
+
+  while (TRUE) {
+    pos = g_atomic_int_get (&ring->dequeue_pos);
+    cell = &ring->cells[pos & ring->mask];
+    seq = g_atomic_int_get (&cell->sequence);
+    diff = (gint) (seq - (pos + 1));
+
+    if (diff < 0)
+      return NULL;
+    if (G_LIKELY (diff == 0))
+      return cell->data;
+  }
+}
+
+static guint
+ring_length (GstARing * ring)
+{
+  guint head, tail;
+
+  /* read the read position first, the write position can only be ahead of
+   * it then */
+  head = g_atomic_int_get (&ring->dequeue_pos);
+  tail = g_atomic_int_get (&ring->enqueue_pos);
+
+  /* positions that were claimed but not yet filled are counted too */
+  return MIN (tail - head, ring->mask + 1);
+}
+
 struct _GstAtomicQueue
 {
   volatile gint refcount;
@@ -110,6 +303,9 @@ struct _GstAtomicQueue
   GstAQueueMem *head_mem;
   GstAQueueMem *tail_mem;
   GstAQueueMem *free_list;
+
+  /* set for bounded queues, the lists above are not used then */
+  GstARing *ring;
 };
 
 static void
@@ -165,10 +361,70 @@ gst_atomic_queue_new (guint initial_size)
 #endif
   queue->head_mem = queue->tail_mem = new_queue_mem (initial_size, 0);
   queue->free_list = NULL;
+  queue->ring = NULL;
 
   return queue;
 }
 
+/**
+ * gst_atomic_queue_new_bounded:
+ * @capacity: the maximum number of items in the queue
+ *
+ * Create a new atomic queue instance that holds at most @capacity items.
+ * @capacity will be rounded up to the nearest power of 2 and can be at most
+ * 2^30.
+ *
+ * Unlike a queue made with gst_atomic_queue_new() the queue never grows, so
+ * that all memory is allocated here. gst_atomic_queue_try_push() fails when
+ * the queue is full and gst_atomic_queue_push() waits until there is space.
+ *
+ * Returns: a new #GstAtomicQueue
+ *
+ * Since: 1.14
+ */
+GstAtomicQueue *
+gst_atomic_queue_new_bounded (guint capacity)
+{
+  GstAtomicQueue *queue;
+
+  g_return_val_if_fail (capacity > 0, NULL);
+  g_return_val_if_fail (capacity <= MAX_RING_CAPACITY, NULL);
+
+  queue = g_new (GstAtomicQueue, 1);
+
+  queue->refcount = 1;
+#ifdef LOW_MEM
+  queue->num_readers = 0;
+#endif
+  queue->head_mem = queue->tail_mem = NULL;
+  queue->free_list = NULL;
+  queue->ring = new_ring (capacity);
+
+  return queue;
+}
+
+/**
+ * gst_atomic_queue_get_capacity:
+ * @queue: a #GstAtomicQueue
+ *
+ * Get the maximum number of items in @queue.
+ *
+ * Returns: the capacity of a queue made with gst_atomic_queue_new_bounded()
+ * or 0 when @queue grows as needed.
+ *
+ * Since: 1.14
+ */
+guint
+gst_atomic_queue_get_capacity (GstAtomicQueue * queue)
+{
+  g_return_val_if_fail (queue != NULL, 0);
+
+  if (queue->ring == NULL)
+    return 0;
+
+  return queue->ring->mask + 1;
+}
+
 /**
  * gst_atomic_queue_ref:
  * @queue: a #GstAtomicQueue
@@ -186,6 +442,12 @@ gst_atomic_queue_ref (GstAtomicQueue * queue)
 static void
 gst_atomic_queue_free (GstAtomicQueue * queue)
 {
+  if (queue->ring) {
+    free_ring (queue->ring);
+    g_free (queue);
+    return;
+  }
+
   free_queue_mem (queue->head_mem);
   if (queue->head_mem != queue->tail_mem)
     free_queue_mem (queue->tail_mem);
@@ -225,6 +487,9 @@ gst_atomic_queue_peek (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, NULL);
 
+  if (queue->ring)
+    return ring_peek (queue->ring);
+
   while (TRUE) {
     GstAQueueMem *next;
 
@@ -276,6 +541,12 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, NULL);
 
+  if (queue->ring) {
+    if (ring_pop_many (queue->ring, &ret, 1) == 0)
+      return NULL;
+    return ret;
+  }
+
 #ifdef LOW_MEM
   g_atomic_int_inc (&queue->num_readers);
 #endif
@@ -333,6 +604,9 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
  * @data: the data
  *
  * Append @data to the tail of the queue.
+ *
+ * When @queue was made with gst_atomic_queue_new_bounded() and is full, this
+ * function waits until another thread pops an item.
  */
 void
 gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
@@ -342,6 +616,12 @@ gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
 
   g_return_if_fail (queue != NULL);
 
+  if (queue->ring) {
+    while (G_UNLIKELY (ring_push_many (queue->ring, &data, 1) == 0))
+      g_thread_yield ();
+    return;
+  }
+
   do {
     while (TRUE) {
       GstAQueueMem *mem;
@@ -404,6 +684,9 @@ gst_atomic_queue_length (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, 0);
 
+  if (queue->ring)
+    return ring_length (queue->ring);
+
 #ifdef LOW_MEM
   g_atomic_int_inc (&queue->num_readers);
 #endif
@@ -421,3 +704,107 @@ gst_atomic_queue_length (GstAtomicQueue * queue)
 
   return tail - head;
 }
+
+/**
+ * gst_atomic_queue_try_push:
+ * @queue: a #GstAtomicQueue
+ * @data: the data
+ *
+ * Append @data to the tail of the queue unless the queue is full. Only a
+ * queue made with gst_atomic_queue_new_bounded() can be full.
+ *
+ * Returns: %TRUE when @data was added to @queue.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_atomic_queue_try_push (GstAtomicQueue * queue, gpointer data)
+{
+  g_return_val_if_fail (queue != NULL, FALSE);
+
+  if (queue->ring)
+    return ring_push_many (queue->ring, &data, 1) == 1;
+
+  gst_atomic_queue_push (queue, data);
+
+  return TRUE;
+}
+
+/**
+ * gst_atomic_queue_push_many:
+ * @queue: a #GstAtomicQueue
+ * @data: (array length=n_data): the items to append
+ * @n_data: the number of items in @data
+ *
+ * Append as many items of @data to the tail of the queue as fit, in order.
+ * The items of a bounded queue are claimed together, so that other threads
+ * contend for the queue once instead of once for every item.
+ *
+ * Returns: the number of items that were appended, which is less than
+ * @n_data only when @queue is bounded and full.
+ *
+ * Since: 1.14
+ */
+guint
+gst_atomic_queue_push_many (GstAtomicQueue * queue, gpointer * data,
+    guint n_data)
+{
+  guint i, n;
+
+  g_return_val_if_fail (queue != NULL, 0);
+  g_return_val_if_fail (data != NULL || n_data == 0, 0);
+
+  if (queue->ring) {
+    for (i = 0; i < n_data; i += n) {
+      n = ring_push_many (queue->ring, data + i, n_data - i);
+      if (n == 0)
+        break;
+    }
+    return i;
+  }
+
+  for (i = 0; i < n_data; i++)
+    gst_atomic_queue_push (queue, data[i]);
+
+  return n_data;
+}
+
+/**
+ * gst_atomic_queue_pop_many:
+ * @queue: a #GstAtomicQueue
+ * @data: (out caller-allocates) (array length=n_data): storage for the items
+ * @n_data: the maximum number of items to pop
+ *
+ * Remove up to @n_data items from the head of the queue and store them in
+ * @data, in order.
+ *
+ * Returns: the number of items stored in @data, which is less than @n_data
+ * only when @queue became empty.
+ *
+ * Since: 1.14
+ */
+guint
+gst_atomic_queue_pop_many (GstAtomicQueue * queue, gpointer * data,
+    guint n_data)
+{
+  guint i, n;
+
+  g_return_val_if_fail (queue != NULL, 0);
+  g_return_val_if_fail (data != NULL || n_data == 0, 0);
+
+  if (queue->ring) {
+    for (i = 0; i < n_data; i += n) {
+      n = ring_pop_many (queue->ring, data + i, n_data - i);
+      if (n == 0)
+        break;
+    }
+    return i;
+  }
+
+  for (i = 0; i < n_data; i++) {
+    if ((data[i] = gst_atomic_queue_pop (queue)) == NULL)
+      break;
+  }
+
+  return i;
+}
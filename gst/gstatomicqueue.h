@@ -47,6 +47,12 @@ GType              gst_atomic_queue_get_type    (void);
 GST_EXPORT
 GstAtomicQueue *   gst_atomic_queue_new         (guint initial_size) G_GNUC_MALLOC;
 
+GST_EXPORT
+GstAtomicQueue *   gst_atomic_queue_new_bounded (guint capacity) G_GNUC_MALLOC;
+
+GST_EXPORT
+guint              gst_atomic_queue_get_capacity (GstAtomicQueue * queue);
+
 GST_EXPORT
 void               gst_atomic_queue_ref         (GstAtomicQueue * queue);
 
@@ -56,9 +62,20 @@ void               gst_atomic_queue_unref       (GstAtomicQueue * queue);
 GST_EXPORT
 void               gst_atomic_queue_push        (GstAtomicQueue* queue, gpointer data);
 
+GST_EXPORT
+gboolean           gst_atomic_queue_try_push    (GstAtomicQueue* queue, gpointer data);
+
+GST_EXPORT
+guint              gst_atomic_queue_push_many   (GstAtomicQueue* queue, gpointer *data,
+                                                 guint n_data);
+
 GST_EXPORT
 gpointer           gst_atomic_queue_pop         (GstAtomicQueue* queue);
 
+GST_EXPORT
+guint              gst_atomic_queue_pop_many    (GstAtomicQueue* queue, gpointer *data,
+                                                 guint n_data);
+
 GST_EXPORT
 gpointer           gst_atomic_queue_peek        (GstAtomicQueue* queue);
 
@@ -131,6 +131,7 @@
 
 #include "gstevent.h"
 #include "gstbin.h"
+#include "gstpipeline.h"
 #include "gstinfo.h"
 #include "gsterror.h"
 
@@ -159,6 +160,12 @@ struct _GstBinPrivate
 
   guint32 structure_cookie;
 
+  /* GstBinSortEntry in the order of the last complete sort, or NULL. The
+   * elements are not reffed, the cache is dropped when a child is removed.
+   * with LOCK */
+  GArray *sort_cache;
+  guint32 sort_cache_cookie;
+
 #if 0
   /* cached index */
   GstIndex *index;
@@ -170,6 +177,33 @@ struct _GstBinPrivate
   gboolean posted_eos;
   gboolean posted_playing;
   GstElementFlags suppressed_flags;
+
+  /* a latency recalculation is running and another one was requested while
+   * it was running. Coalesced callers wait on latency_cond until a pass that
+   * started after their call is done and return its result. with LOCK */
+  gboolean latency_running;
+  gboolean latency_pending;
+  GThread *latency_thread;
+  guint latency_passes_started;
+  guint latency_passes_done;
+  gboolean latency_result;
+  GCond latency_cond;
+
+  /* change the state of independent children concurrently, the pool is
+   * created on first use. with STATE_LOCK */
+  gboolean parallel_state_change;
+  GstTaskPool *state_pool;
+
+  /* deep-notify of children is only propagated for these 0 terminated
+   * properties and for objects of this type, see
+   * gst_bin_set_deep_notify_filter(). with LOCK */
+  GType deep_notify_type;
+  GQuark *deep_notify_props;
+
+  /* immutable array with refs to the children, made on demand by
+   * gst_bin_iterate_elements_snapshot() and dropped when the children
+   * change. with LOCK */
+  GPtrArray *children_snapshot;
 };
 
 typedef struct
@@ -179,6 +213,7 @@ typedef struct
 } BinContinueData;
 
 static void gst_bin_dispose (GObject * object);
+static void gst_bin_finalize (GObject * object);
 
 static void gst_bin_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -220,6 +255,7 @@ static GstBusSyncReply bin_bus_handler (GstBus * bus,
     GstMessage * message, GstBin * bin);
 static gboolean gst_bin_query (GstElement * element, GstQuery * query);
 static void gst_bin_set_context (GstElement * element, GstContext * context);
+static gboolean gst_bin_reset (GstElement * element);
 
 static gboolean gst_bin_do_latency_func (GstBin * bin);
 
@@ -230,6 +266,8 @@ static gint bin_element_is_sink (GstElement * child, GstBin * bin);
 static gint bin_element_is_src (GstElement * child, GstBin * bin);
 
 static GstIterator *gst_bin_sort_iterator_new (GstBin * bin);
+static void gst_bin_invalidate_sort_cache (GstBin * bin);
+static void gst_bin_invalidate_children_snapshot (GstBin * bin);
 
 /* Bin signals and properties */
 enum
@@ -244,12 +282,14 @@ enum
 
 #define DEFAULT_ASYNC_HANDLING	FALSE
 #define DEFAULT_MESSAGE_FORWARD	FALSE
+#define DEFAULT_PARALLEL_STATE_CHANGE	FALSE
 
 enum
 {
   PROP_0,
   PROP_ASYNC_HANDLING,
   PROP_MESSAGE_FORWARD,
+  PROP_PARALLEL_STATE_CHANGE,
   PROP_LAST
 };
 
@@ -448,7 +488,28 @@ gst_bin_class_init (GstBinClass * klass)
           "Forwards all children messages",
           DEFAULT_MESSAGE_FORWARD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBin:parallel-state-change:
+   *
+   * Change the state of children that don't depend on each other at the same
+   * time. The children are still handled from the sinks to the sources, but
+   * all elements of a level of the graph, like several sinks, change their
+   * state concurrently and the bin waits for all of them before it continues
+   * with the elements upstream of them.
+   *
+   * This speeds up state changes of bins with several elements that are slow
+   * to open their device or connection.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_STATE_CHANGE,
+      g_param_spec_boolean ("parallel-state-change", "Parallel State Change",
+          "Change the state of independent children concurrently",
+          DEFAULT_PARALLEL_STATE_CHANGE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->dispose = gst_bin_dispose;
+  gobject_class->finalize = gst_bin_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class, "Generic bin",
       "Generic/Bin",
@@ -471,6 +532,7 @@ gst_bin_class_init (GstBinClass * klass)
   gstelement_class->send_event = GST_DEBUG_FUNCPTR (gst_bin_send_event);
   gstelement_class->query = GST_DEBUG_FUNCPTR (gst_bin_query);
   gstelement_class->set_context = GST_DEBUG_FUNCPTR (gst_bin_set_context);
+  gstelement_class->reset = GST_DEBUG_FUNCPTR (gst_bin_reset);
 
   klass->add_element = GST_DEBUG_FUNCPTR (gst_bin_add_func);
   klass->remove_element = GST_DEBUG_FUNCPTR (gst_bin_remove_func);
@@ -507,6 +569,8 @@ gst_bin_init (GstBin * bin)
   bin->priv->asynchandling = DEFAULT_ASYNC_HANDLING;
   bin->priv->structure_cookie = 0;
   bin->priv->message_forward = DEFAULT_MESSAGE_FORWARD;
+  bin->priv->parallel_state_change = DEFAULT_PARALLEL_STATE_CHANGE;
+  g_cond_init (&bin->priv->latency_cond);
 }
 
 static void
@@ -524,8 +588,17 @@ gst_bin_dispose (GObject * object)
   gst_object_replace ((GstObject **) provided_clock_p, NULL);
   gst_object_replace ((GstObject **) clock_provider_p, NULL);
   bin_remove_messages (bin, NULL, GST_MESSAGE_ANY);
+  g_free (bin->priv->deep_notify_props);
+  bin->priv->deep_notify_props = NULL;
+  bin->priv->deep_notify_type = G_TYPE_INVALID;
   GST_OBJECT_UNLOCK (object);
 
+  if (bin->priv->state_pool) {
+    gst_task_pool_cleanup (bin->priv->state_pool);
+    gst_object_unref (bin->priv->state_pool);
+    bin->priv->state_pool = NULL;
+  }
+
   while (bin->children) {
     gst_bin_remove (bin, GST_ELEMENT_CAST (bin->children->data));
   }
@@ -533,10 +606,23 @@ gst_bin_dispose (GObject * object)
     g_critical ("could not remove elements from bin '%s'",
         GST_STR_NULL (GST_OBJECT_NAME (object)));
   }
+  GST_OBJECT_LOCK (object);
+  gst_bin_invalidate_children_snapshot (bin);
+  GST_OBJECT_UNLOCK (object);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_bin_finalize (GObject * object)
+{
+  GstBin *bin = GST_BIN_CAST (object);
+
+  g_cond_clear (&bin->priv->latency_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 /**
  * gst_bin_new:
  * @name: (allow-none): the name of the new bin
@@ -570,6 +656,11 @@ gst_bin_set_property (GObject * object, guint prop_id,
       gstbin->priv->message_forward = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_PARALLEL_STATE_CHANGE:
+      GST_OBJECT_LOCK (gstbin);
+      gstbin->priv->parallel_state_change = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -595,6 +686,11 @@ gst_bin_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, gstbin->priv->message_forward);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_PARALLEL_STATE_CHANGE:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_boolean (value, gstbin->priv->parallel_state_change);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1210,6 +1306,8 @@ gst_bin_add_func (GstBin * bin, GstElement * element)
   bin->children_cookie++;
   if (!GST_BIN_IS_NO_RESYNC (bin))
     bin->priv->structure_cookie++;
+  gst_bin_invalidate_sort_cache (bin);
+  gst_bin_invalidate_children_snapshot (bin);
 
   /* distribute the bus */
   gst_element_set_bus (element, bin->child_bus);
@@ -1444,6 +1542,82 @@ gst_bin_get_suppressed_flags (GstBin * bin)
   return res;
 }
 
+/**
+ * gst_bin_set_deep_notify_filter:
+ * @bin: a #GstBin
+ * @type: only propagate notifications of objects of this type or
+ *     %G_TYPE_INVALID for all objects
+ * @property_names: (array zero-terminated=1) (allow-none): only propagate
+ *     notifications of these properties or %NULL for all properties
+ *
+ * Limit the #GstObject::deep-notify signals of the children of @bin that
+ * are emitted on @bin and its parents. Notifications that don't match are
+ * not propagated any further than the children of @bin, which avoids
+ * walking the whole hierarchy for frequently changing properties nobody
+ * is interested in.
+ *
+ * Passing %G_TYPE_INVALID and %NULL removes the filter.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+void
+gst_bin_set_deep_notify_filter (GstBin * bin, GType type,
+    const gchar * const *property_names)
+{
+  GQuark *props = NULL;
+  guint i, n;
+
+  g_return_if_fail (GST_IS_BIN (bin));
+
+  if (property_names) {
+    n = g_strv_length ((gchar **) property_names);
+    props = g_new (GQuark, n + 1);
+    for (i = 0; i < n; i++)
+      props[i] = g_quark_from_string (property_names[i]);
+    props[n] = 0;
+  }
+
+  GST_OBJECT_LOCK (bin);
+  g_free (bin->priv->deep_notify_props);
+  bin->priv->deep_notify_props = props;
+  bin->priv->deep_notify_type = type;
+  GST_OBJECT_UNLOCK (bin);
+}
+
+/* check if the deep-notify of @orig for the property @name can be
+ * propagated to @object and its parents */
+gboolean
+_priv_gst_bin_accepts_deep_notify (GstObject * object, GstObject * orig,
+    GQuark name)
+{
+  GstBin *bin;
+  gboolean res = TRUE;
+  GQuark *props;
+
+  if (!GST_IS_BIN (object))
+    return TRUE;
+
+  bin = GST_BIN_CAST (object);
+
+  GST_OBJECT_LOCK (bin);
+  if (bin->priv->deep_notify_type != G_TYPE_INVALID &&
+      !g_type_is_a (G_OBJECT_TYPE (orig), bin->priv->deep_notify_type))
+    res = FALSE;
+
+  if (res && (props = bin->priv->deep_notify_props)) {
+    for (; *props != 0; props++) {
+      if (*props == name)
+        break;
+    }
+    res = (*props != 0);
+  }
+  GST_OBJECT_UNLOCK (bin);
+
+  return res;
+}
+
 /* signal vfunc, will be called when a new element was added */
 static void
 gst_bin_deep_element_added_func (GstBin * bin, GstBin * sub_bin,
@@ -1645,6 +1819,8 @@ gst_bin_remove_func (GstBin * bin, GstElement * element)
   bin->children_cookie++;
   if (!GST_BIN_IS_NO_RESYNC (bin))
     bin->priv->structure_cookie++;
+  gst_bin_invalidate_sort_cache (bin);
+  gst_bin_invalidate_children_snapshot (bin);
 
   if (is_sink && !othersink
       && !(bin->priv->suppressed_flags & GST_ELEMENT_FLAG_SINK)) {
@@ -1777,6 +1953,7 @@ gst_bin_remove_func (GstBin * bin, GstElement * element)
       ret = GST_STATE_CHANGE_ASYNC;
     }
     GST_STATE_RETURN (bin) = ret;
+    gst_element_publish_state (GST_ELEMENT_CAST (bin));
   }
 no_state_recalc:
   /* clear bus */
@@ -1910,6 +2087,57 @@ gst_bin_iterate_elements (GstBin * bin)
   return result;
 }
 
+/* with LOCK. The snapshot only holds refs to current children, so this
+ * never drops the last ref of an element */
+static void
+gst_bin_invalidate_children_snapshot (GstBin * bin)
+{
+  if (bin->priv->children_snapshot) {
+    g_ptr_array_unref (bin->priv->children_snapshot);
+    bin->priv->children_snapshot = NULL;
+  }
+}
+
+/**
+ * gst_bin_iterate_elements_snapshot:
+ * @bin: a #GstBin
+ *
+ * Gets an iterator for the elements in this bin at the time of the call.
+ *
+ * Unlike gst_bin_iterate_elements(), the iterator never returns
+ * %GST_ITERATOR_RESYNC and does not take the lock of @bin while iterating,
+ * elements added or removed after this call are not seen. The snapshot is
+ * shared between all iterators made while the children don't change.
+ *
+ * MT safe.  Caller owns returned value.
+ *
+ * Returns: (transfer full): a #GstIterator of #GstElement
+ *
+ * Since: 1.14
+ */
+GstIterator *
+gst_bin_iterate_elements_snapshot (GstBin * bin)
+{
+  GstIterator *result;
+  GPtrArray *array;
+  GList *walk;
+
+  g_return_val_if_fail (GST_IS_BIN (bin), NULL);
+
+  GST_OBJECT_LOCK (bin);
+  if (!(array = bin->priv->children_snapshot)) {
+    array = g_ptr_array_new_full (bin->numchildren,
+        (GDestroyNotify) gst_object_unref);
+    for (walk = bin->children; walk; walk = walk->next)
+      g_ptr_array_add (array, gst_object_ref (walk->data));
+    bin->priv->children_snapshot = array;
+  }
+  result = _priv_gst_iterator_new_array (GST_TYPE_ELEMENT, array);
+  GST_OBJECT_UNLOCK (bin);
+
+  return result;
+}
+
 static GstIteratorItem
 iterate_child_recurse (GstIterator * it, const GValue * item)
 {
@@ -2104,7 +2332,19 @@ gst_bin_get_state_func (GstElement * element, GstState * state,
  * on the sinkpads. When an element reaches degree 0, its state is
  * changed next.
  * When all elements are handled the algorithm stops.
+ *
+ * The order of a complete sort is cached in the bin and replayed by the
+ * next iterators until a child is added or removed, pads are linked or
+ * unlinked or the SINK or SOURCE flag of a child changes.
  */
+typedef struct
+{
+  GstElement *element;
+  GstElementFlags flags;
+} GstBinSortEntry;
+
+#define SORT_FLAGS (GST_ELEMENT_FLAG_SINK | GST_ELEMENT_FLAG_SOURCE)
+
 typedef struct _GstBinSortIterator
 {
   GstIterator it;
@@ -2115,8 +2355,48 @@ typedef struct _GstBinSortIterator
   gint best_deg;                /* best degree */
   GHashTable *hash;             /* hashtable with element dependencies */
   gboolean dirty;               /* we detected structure change */
+  GArray *order;                /* cached order we replay, or NULL */
+  guint index;                  /* next entry in order */
+  GArray *record;               /* order of the sort we do, or NULL */
+  guint32 cache_cookie;         /* sort_cache_cookie when we started */
 } GstBinSortIterator;
 
+/* should be called with the bin LOCK held */
+static void
+gst_bin_invalidate_sort_cache (GstBin * bin)
+{
+  bin->priv->sort_cache_cookie++;
+  if (bin->priv->sort_cache) {
+    g_array_unref (bin->priv->sort_cache);
+    bin->priv->sort_cache = NULL;
+  }
+}
+
+/* check if the cached order still matches the children of the bin.
+ * should be called with the bin LOCK held */
+static gboolean
+sort_cache_is_valid (GstBin * bin)
+{
+  GArray *cache = bin->priv->sort_cache;
+  guint i;
+
+  /* without resyncs the iterator would not notice that a cached element was
+   * removed */
+  if (GST_BIN_IS_NO_RESYNC (bin))
+    return FALSE;
+
+  if (cache == NULL || cache->len != bin->numchildren)
+    return FALSE;
+
+  for (i = 0; i < cache->len; i++) {
+    GstBinSortEntry *entry = &g_array_index (cache, GstBinSortEntry, i);
+
+    if ((GST_OBJECT_FLAGS (entry->element) & SORT_FLAGS) != entry->flags)
+      return FALSE;
+  }
+  return TRUE;
+}
+
 static void
 copy_to_queue (gpointer data, gpointer user_data)
 {
@@ -2145,6 +2425,14 @@ gst_bin_sort_iterator_copy (const GstBinSortIterator * it,
   g_hash_table_iter_init (&iter, it->hash);
   while (g_hash_table_iter_next (&iter, &key, &value))
     g_hash_table_insert (copy->hash, key, value);
+
+  if (it->order)
+    copy->order = g_array_ref (it->order);
+  if (it->record) {
+    copy->record = g_array_sized_new (FALSE, FALSE, sizeof (GstBinSortEntry),
+        it->record->len);
+    g_array_append_vals (copy->record, it->record->data, it->record->len);
+  }
 }
 
 /* we add and subtract 1 to make sure we don't confuse NULL and 0 */
@@ -2336,6 +2624,16 @@ gst_bin_sort_iterator_next (GstBinSortIterator * bit, GValue * result)
   GstElement *best;
   GstBin *bin = bit->bin;
 
+  /* replay the order of an earlier sort */
+  if (bit->order) {
+    if (bit->index >= bit->order->len)
+      return GST_ITERATOR_DONE;
+
+    best = g_array_index (bit->order, GstBinSortEntry, bit->index++).element;
+    g_value_set_object (result, best);
+    return GST_ITERATOR_OK;
+  }
+
   /* empty queue, we have to find a next best element */
   if (g_queue_is_empty (&bit->queue)) {
     bit->best = NULL;
@@ -2357,6 +2655,14 @@ gst_bin_sort_iterator_next (GstBinSortIterator * bit, GValue * result)
       g_value_set_object (result, best);
     } else {
       GST_DEBUG_OBJECT (bin, "queue empty, elements exhausted");
+      /* keep the order for the next iterators when nothing changed while we
+       * sorted */
+      if (bit->record && !bit->dirty
+          && bit->cache_cookie == bin->priv->sort_cache_cookie
+          && bin->priv->sort_cache == NULL) {
+        bin->priv->sort_cache = bit->record;
+        bit->record = NULL;
+      }
       /* no more unhandled elements, we are done */
       return GST_ITERATOR_DONE;
     }
@@ -2368,6 +2674,13 @@ gst_bin_sort_iterator_next (GstBinSortIterator * bit, GValue * result)
   }
 
   GST_DEBUG_OBJECT (bin, "queue head gives %s", GST_ELEMENT_NAME (best));
+  if (bit->record) {
+    GstBinSortEntry entry;
+
+    entry.element = best;
+    entry.flags = GST_OBJECT_FLAGS (best) & SORT_FLAGS;
+    g_array_append_val (bit->record, entry);
+  }
   /* update degrees of linked elements */
   update_degree (best, bit);
 
@@ -2383,6 +2696,26 @@ gst_bin_sort_iterator_resync (GstBinSortIterator * bit)
   GST_DEBUG_OBJECT (bin, "resync");
   bit->dirty = FALSE;
   clear_queue (&bit->queue);
+  if (bit->order) {
+    g_array_unref (bit->order);
+    bit->order = NULL;
+  }
+  if (bit->record) {
+    g_array_unref (bit->record);
+    bit->record = NULL;
+  }
+
+  if (sort_cache_is_valid (bin)) {
+    GST_DEBUG_OBJECT (bin, "using cached order");
+    bit->order = g_array_ref (bin->priv->sort_cache);
+    bit->index = 0;
+    return;
+  }
+
+  bit->cache_cookie = bin->priv->sort_cache_cookie;
+  bit->record = g_array_sized_new (FALSE, FALSE, sizeof (GstBinSortEntry),
+      bin->numchildren);
+  g_hash_table_remove_all (bit->hash);
   /* reset degrees */
   g_list_foreach (bin->children, (GFunc) reset_degree, bit);
   /* calc degrees, incrementing */
@@ -2401,6 +2734,10 @@ gst_bin_sort_iterator_free (GstBinSortIterator * bit)
   GST_DEBUG_OBJECT (bin, "free");
   clear_queue (&bit->queue);
   g_hash_table_destroy (bit->hash);
+  if (bit->order)
+    g_array_unref (bit->order);
+  if (bit->record)
+    g_array_unref (bit->record);
   gst_object_unref (bin);
 }
 
@@ -2424,6 +2761,8 @@ gst_bin_sort_iterator_new (GstBin * bin)
       (GstIteratorFreeFunction) gst_bin_sort_iterator_free);
   g_queue_init (&result->queue);
   result->hash = g_hash_table_new (NULL, NULL);
+  result->order = NULL;
+  result->record = NULL;
   gst_object_ref (bin);
   result->bin = bin;
   gst_bin_sort_iterator_resync (result);
@@ -2471,7 +2810,7 @@ gst_bin_element_set_state (GstBin * bin, GstElement * element,
   gboolean locked;
   GList *found;
 
-  GST_STATE_LOCK (element);
+  GST_STATE_LOCK_TRACED (element);
 
   GST_OBJECT_LOCK (element);
   /* set base_time and start time on child */
@@ -2727,15 +3066,61 @@ failed:
  * This function simply emits the 'do-latency' signal so any custom latency
  * calculations will be performed.
  *
+ * When the latency of @bin is already being recalculated, the signal is not
+ * emitted again right away. The running recalculation then does one more
+ * pass when it is finished, so that many calls, like for the
+ * #GST_MESSAGE_LATENCY of all sinks, cause only one or two queries. The
+ * coalesced calls wait for that pass and return its result.
+ *
  * Returns: %TRUE if the latency could be queried and reconfigured.
  */
 gboolean
 gst_bin_recalculate_latency (GstBin * bin)
 {
+  GstBinPrivate *priv = bin->priv;
   gboolean res;
 
-  g_signal_emit (bin, gst_bin_signals[DO_LATENCY], 0, &res);
-  GST_DEBUG_OBJECT (bin, "latency returned %d", res);
+  GST_OBJECT_LOCK (bin);
+  if (priv->latency_running) {
+    guint pass;
+
+    priv->latency_pending = TRUE;
+    if (priv->latency_thread == g_thread_self ()) {
+      /* called from the do-latency handler, we can't wait for ourselves but
+       * the running pass will be repeated */
+      GST_DEBUG_OBJECT (bin, "latency recalculation from the handler");
+      GST_OBJECT_UNLOCK (bin);
+      return TRUE;
+    }
+
+    /* wait for the next pass, the running one may have missed our change */
+    GST_DEBUG_OBJECT (bin, "latency is being recalculated, coalescing");
+    pass = priv->latency_passes_started + 1;
+    while ((gint) (priv->latency_passes_done - pass) < 0)
+      g_cond_wait (&priv->latency_cond, GST_OBJECT_GET_LOCK (bin));
+    res = priv->latency_result;
+    GST_OBJECT_UNLOCK (bin);
+
+    return res;
+  }
+  priv->latency_running = TRUE;
+  priv->latency_thread = g_thread_self ();
+  do {
+    priv->latency_pending = FALSE;
+    priv->latency_passes_started++;
+    GST_OBJECT_UNLOCK (bin);
+
+    g_signal_emit (bin, gst_bin_signals[DO_LATENCY], 0, &res);
+    GST_DEBUG_OBJECT (bin, "latency returned %d", res);
+
+    GST_OBJECT_LOCK (bin);
+    priv->latency_passes_done++;
+    priv->latency_result = res;
+    g_cond_broadcast (&priv->latency_cond);
+  } while (priv->latency_pending);
+  priv->latency_running = FALSE;
+  priv->latency_thread = NULL;
+  GST_OBJECT_UNLOCK (bin);
 
   return res;
 }
@@ -2793,6 +3178,47 @@ gst_bin_do_latency_func (GstBin * bin)
   return res;
 }
 
+/* messages that gst_bin_handle_message_func() uses itself */
+#define BIN_HANDLED_MESSAGES (GST_MESSAGE_ERROR | GST_MESSAGE_EOS | \
+    GST_MESSAGE_STREAM_START | GST_MESSAGE_STATE_DIRTY | \
+    GST_MESSAGE_SEGMENT_START | GST_MESSAGE_SEGMENT_DONE | \
+    GST_MESSAGE_DURATION_CHANGED | GST_MESSAGE_CLOCK_LOST | \
+    GST_MESSAGE_CLOCK_PROVIDE | GST_MESSAGE_ASYNC_START | \
+    GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_STRUCTURE_CHANGE | \
+    GST_MESSAGE_NEED_CONTEXT | GST_MESSAGE_HAVE_CONTEXT | \
+    GST_MESSAGE_RESET_TIME)
+
+/* check if a message of @type posted on the child bus of @element is used by
+ * the bin or by the parents of the bin */
+gboolean
+_priv_gst_bin_accepts_message_type (GstElement * element, GstMessageType type)
+{
+  GstBin *bin = GST_BIN_CAST (element);
+  GstBinClass *klass = GST_BIN_GET_CLASS (bin);
+  GstBinClass *pipeline_class;
+  gboolean forward;
+
+  if (!(type & GST_MESSAGE_EXTENDED) && (type & BIN_HANDLED_MESSAGES))
+    return TRUE;
+
+  /* subclasses could handle any message, GstPipeline only handles the ones
+   * above */
+  pipeline_class = g_type_class_peek (GST_TYPE_PIPELINE);
+  if (klass->handle_message != gst_bin_handle_message_func &&
+      (pipeline_class == NULL
+          || klass->handle_message != pipeline_class->handle_message))
+    return TRUE;
+
+  GST_OBJECT_LOCK (bin);
+  forward = bin->priv->message_forward;
+  GST_OBJECT_UNLOCK (bin);
+  if (forward)
+    return TRUE;
+
+  /* everything else is posted by the bin */
+  return gst_element_accepts_message_type (element, type);
+}
+
 static gboolean
 gst_bin_post_message (GstElement * element, GstMessage * msg)
 {
@@ -2830,6 +3256,266 @@ reset_state (const GValue * data, gpointer user_data)
         gst_element_state_get_name (state));
 }
 
+/* the level of @element in the graph of @bin: 0 for elements that are not
+ * linked to other children downstream, otherwise one more than the highest
+ * level of the children downstream. @levels contains the levels of the
+ * children that were already handled */
+static gint
+get_element_level (GstBin * bin, GstElement * element, GHashTable * levels)
+{
+  GList *pads;
+  gint level = 0;
+
+  GST_OBJECT_LOCK (element);
+  for (pads = element->srcpads; pads; pads = g_list_next (pads)) {
+    GstPad *peer;
+    GstElement *peer_element;
+
+    if (!(peer = gst_pad_get_peer (GST_PAD_CAST (pads->data))))
+      continue;
+
+    if ((peer_element = gst_pad_get_parent_element (peer))) {
+      gpointer peer_level;
+
+      /* elements outside of the bin and loops in the graph don't count */
+      if (GST_OBJECT_PARENT (peer_element) == GST_OBJECT_CAST (bin) &&
+          g_hash_table_lookup_extended (levels, peer_element, NULL,
+              &peer_level))
+        level = MAX (level, GPOINTER_TO_INT (peer_level) + 1);
+      gst_object_unref (peer_element);
+    }
+    gst_object_unref (peer);
+  }
+  GST_OBJECT_UNLOCK (element);
+
+  return level;
+}
+
+/* the default task pool can't join its tasks, the pushed state changes
+ * count down @pending when they are done */
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint pending;
+} BinStateChangeWait;
+
+typedef struct
+{
+  GstBin *bin;
+  GstElement *child;
+  gint level;
+  GstClockTime base_time;
+  GstClockTime start_time;
+  GstState current;
+  GstState next;
+  GstStateChangeReturn ret;
+  BinStateChangeWait *wait;
+} BinChildStateChange;
+
+static void
+bin_child_state_change_func (BinChildStateChange * change)
+{
+  BinStateChangeWait *wait = change->wait;
+
+  change->ret = gst_bin_element_set_state (change->bin, change->child,
+      change->base_time, change->start_time, change->current, change->next);
+
+  if (wait) {
+    g_mutex_lock (&wait->lock);
+    if (--wait->pending == 0)
+      g_cond_signal (&wait->cond);
+    g_mutex_unlock (&wait->lock);
+  }
+}
+
+/* change the state of the children from the sinks to the sources, all children
+ * of the same level at the same time. Returns GST_ITERATOR_ERROR when a child
+ * failed and GST_ITERATOR_RESYNC when the bin changed and the state change has
+ * to be repeated. should be called with the STATE_LOCK */
+static GstIteratorResult
+gst_bin_change_children_state_parallel (GstBin * bin, GstIterator * it,
+    GstClockTime base_time, GstClockTime start_time, GstState current,
+    GstState next, gboolean * have_async, gboolean * have_no_preroll)
+{
+  GstBinPrivate *priv = bin->priv;
+  GstIteratorResult ires = GST_ITERATOR_DONE;
+  GHashTable *levels;
+  GArray *changes;
+  GValue data = { 0, };
+  gboolean done = FALSE;
+  gint level, max_level = 0;
+  guint i, j;
+  BinStateChangeWait wait;
+
+  g_mutex_init (&wait.lock);
+  g_cond_init (&wait.cond);
+  wait.pending = 0;
+
+  levels = g_hash_table_new (NULL, NULL);
+  changes = g_array_new (FALSE, TRUE, sizeof (BinChildStateChange));
+
+  /* collect the children with their level first, the iterator returns them
+   * from the sinks upstream so the levels of their peers are known */
+  while (!done) {
+    switch ((ires = gst_iterator_next (it, &data))) {
+      case GST_ITERATOR_OK:
+      {
+        BinChildStateChange change = { bin, };
+
+        change.child = g_value_dup_object (&data);
+        change.level = get_element_level (bin, change.child, levels);
+        change.base_time = base_time;
+        change.start_time = start_time;
+        change.current = current;
+        change.next = next;
+        g_hash_table_insert (levels, change.child,
+            GINT_TO_POINTER (change.level));
+        g_array_append_val (changes, change);
+        max_level = MAX (max_level, change.level);
+        g_value_reset (&data);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        goto done;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+
+  if (changes->len > 1 && !priv->state_pool) {
+    GError *err = NULL;
+
+    priv->state_pool = gst_task_pool_new ();
+    gst_task_pool_prepare (priv->state_pool, &err);
+    if (err) {
+      /* the state changes are done in this thread then */
+      GST_WARNING_OBJECT (bin, "failed to prepare pool: %s", err->message);
+      g_clear_error (&err);
+      gst_object_unref (priv->state_pool);
+      priv->state_pool = NULL;
+    }
+  }
+
+  ires = GST_ITERATOR_DONE;
+  for (level = 0; level <= max_level; level++) {
+    BinChildStateChange *last = NULL;
+
+    /* start all children of the level but the last one in the pool, the
+     * last one is handled in this thread */
+    for (i = 0; i < changes->len; i++) {
+      BinChildStateChange *change = &g_array_index (changes,
+          BinChildStateChange, i);
+
+      if (change->level != level)
+        continue;
+
+      if (last && priv->state_pool) {
+        GError *err = NULL;
+
+        g_mutex_lock (&wait.lock);
+        wait.pending++;
+        g_mutex_unlock (&wait.lock);
+
+        last->wait = &wait;
+        gst_task_pool_push (priv->state_pool,
+            (GstTaskPoolFunction) bin_child_state_change_func, last, &err);
+        if (err) {
+          GST_WARNING_OBJECT (bin, "failed to push to pool: %s", err->message);
+          g_clear_error (&err);
+          g_mutex_lock (&wait.lock);
+          wait.pending--;
+          g_mutex_unlock (&wait.lock);
+          last->wait = NULL;
+          bin_child_state_change_func (last);
+        }
+      } else if (last) {
+        bin_child_state_change_func (last);
+      }
+      last = change;
+    }
+    if (last)
+      bin_child_state_change_func (last);
+
+    /* wait for the state changes running in the pool */
+    g_mutex_lock (&wait.lock);
+    while (wait.pending > 0)
+      g_cond_wait (&wait.cond, &wait.lock);
+    g_mutex_unlock (&wait.lock);
+
+    /* collect the results of the level in the order of the iterator */
+    for (i = 0; i < changes->len; i++) {
+      BinChildStateChange *change = &g_array_index (changes,
+          BinChildStateChange, i);
+
+      if (change->level != level)
+        continue;
+
+      switch (change->ret) {
+        case GST_STATE_CHANGE_SUCCESS:
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+              "child '%s' changed state to %d(%s) successfully",
+              GST_ELEMENT_NAME (change->child), next,
+              gst_element_state_get_name (next));
+          break;
+        case GST_STATE_CHANGE_ASYNC:
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+              "child '%s' is changing state asynchronously to %s",
+              GST_ELEMENT_NAME (change->child),
+              gst_element_state_get_name (next));
+          *have_async = TRUE;
+          break;
+        case GST_STATE_CHANGE_FAILURE:{
+          GstObject *parent;
+
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+              "child '%s' failed to go to state %d(%s)",
+              GST_ELEMENT_NAME (change->child),
+              next, gst_element_state_get_name (next));
+
+          /* only fail if the child is still inside this bin, like the
+           * sequential state change does */
+          parent = gst_object_get_parent (GST_OBJECT_CAST (change->child));
+          if (parent == GST_OBJECT_CAST (bin))
+            ires = GST_ITERATOR_ERROR;
+          if (parent)
+            gst_object_unref (parent);
+          break;
+        }
+        case GST_STATE_CHANGE_NO_PREROLL:
+          GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+              "child '%s' changed state to %d(%s) successfully without preroll",
+              GST_ELEMENT_NAME (change->child), next,
+              gst_element_state_get_name (next));
+          *have_no_preroll = TRUE;
+          break;
+        default:
+          g_assert_not_reached ();
+          break;
+      }
+    }
+    if (ires == GST_ITERATOR_ERROR)
+      goto done;
+  }
+
+  /* the iterator is exhausted, it only returns something else than DONE now
+   * when the bin changed during the state changes */
+  if (gst_iterator_next (it, &data) == GST_ITERATOR_RESYNC)
+    ires = GST_ITERATOR_RESYNC;
+
+done:
+  g_value_unset (&data);
+  for (j = 0; j < changes->len; j++)
+    gst_object_unref (g_array_index (changes, BinChildStateChange, j).child);
+  g_array_free (changes, TRUE);
+  g_hash_table_destroy (levels);
+  g_cond_clear (&wait.cond);
+  g_mutex_clear (&wait.lock);
+
+  return ires;
+}
+
 static GstStateChangeReturn
 gst_bin_change_state_func (GstElement * element, GstStateChange transition)
 {
@@ -2841,6 +3527,7 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
   GstClockTime base_time, start_time;
   GstIterator *it;
   gboolean done;
+  gboolean parallel;
   GValue data = { 0, };
 
   /* we don't need to take the STATE_LOCK, it is already taken */
@@ -2913,6 +3600,7 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
    * don't want them to interfere with this state change */
   GST_OBJECT_LOCK (bin);
   bin->polling = TRUE;
+  parallel = bin->priv->parallel_state_change;
   GST_OBJECT_UNLOCK (bin);
 
   /* iterate in state change order */
@@ -2931,6 +3619,20 @@ restart:
 
   have_no_preroll = FALSE;
 
+  if (parallel) {
+    switch (gst_bin_change_children_state_parallel (bin, it, base_time,
+            start_time, current, next, &have_async, &have_no_preroll)) {
+      case GST_ITERATOR_RESYNC:
+        GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "iterator doing resync");
+        gst_iterator_resync (it);
+        goto restart;
+      case GST_ITERATOR_ERROR:
+        goto undo;
+      default:
+        goto children_done;
+    }
+  }
+
   done = FALSE;
   while (!done) {
     switch (gst_iterator_next (it, &data)) {
@@ -3014,6 +3716,7 @@ restart:
     }
   }
 
+children_done:
   ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
   if (G_UNLIKELY (ret == GST_STATE_CHANGE_FAILURE))
     goto done;
@@ -3222,7 +3925,7 @@ gst_bin_continue_func (GstBin * bin, BinContinueData * data)
   pending = data->pending;
 
   GST_DEBUG_OBJECT (bin, "waiting for state lock");
-  GST_STATE_LOCK (bin);
+  GST_STATE_LOCK_TRACED (bin);
 
   GST_DEBUG_OBJECT (bin, "doing state continue");
   GST_OBJECT_LOCK (bin);
@@ -3240,6 +3943,7 @@ gst_bin_continue_func (GstBin * bin, BinContinueData * data)
   GST_STATE_PENDING (bin) = pending;
   /* mark busy */
   GST_STATE_RETURN (bin) = GST_STATE_CHANGE_ASYNC;
+  gst_element_publish_state (GST_ELEMENT_CAST (bin));
   GST_OBJECT_UNLOCK (bin);
 
   GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
@@ -3339,6 +4043,7 @@ bin_handle_async_start (GstBin * bin)
   GST_STATE_NEXT (bin) = new_state;
   GST_STATE_PENDING (bin) = new_state;
   GST_STATE_RETURN (bin) = GST_STATE_CHANGE_ASYNC;
+  gst_element_publish_state (GST_ELEMENT_CAST (bin));
   GST_OBJECT_UNLOCK (bin);
 
   /* post message */
@@ -3466,6 +4171,7 @@ bin_handle_async_done (GstBin * bin, GstStateChangeReturn ret,
       state_changed = TRUE;
     }
   }
+  gst_element_publish_state (GST_ELEMENT_CAST (bin));
   GST_OBJECT_UNLOCK (bin);
 
   if (state_changed) {
@@ -3721,6 +4427,7 @@ gst_bin_handle_message_func (GstBin * bin, GstMessage * message)
       /* flag error */
       GST_DEBUG_OBJECT (bin, "got ERROR message, unlocking state change");
       GST_STATE_RETURN (bin) = GST_STATE_CHANGE_FAILURE;
+      gst_element_publish_state (GST_ELEMENT_CAST (bin));
       GST_STATE_BROADCAST (bin);
       GST_OBJECT_UNLOCK (bin);
 
@@ -3981,6 +4688,8 @@ gst_bin_handle_message_func (GstBin * bin, GstMessage * message)
       gst_message_parse_structure_change (message, NULL, NULL, &busy);
 
       GST_OBJECT_LOCK (bin);
+      /* the links changed, the order of the last sort is not valid anymore */
+      gst_bin_invalidate_sort_cache (bin);
       if (busy) {
         /* while the pad is busy, avoid following it when doing state changes.
          * Don't update the cookie yet, we will do that after the structure
@@ -4424,6 +5133,34 @@ gst_bin_set_context (GstElement * element, GstContext * context)
   gst_iterator_free (children);
 }
 
+static void
+reset_child (const GValue * item, gpointer user_data)
+{
+  GstElement *element = g_value_get_object (item);
+  gboolean *res = user_data;
+
+  if (!gst_element_reset (element))
+    *res = FALSE;
+}
+
+/* the children are part of the bin, reset them too */
+static gboolean
+gst_bin_reset (GstElement * element)
+{
+  GstIterator *children;
+  gboolean res;
+
+  res = GST_ELEMENT_CLASS (parent_class)->reset (element);
+
+  children = gst_bin_iterate_elements (GST_BIN_CAST (element));
+  while (gst_iterator_foreach (children, reset_child,
+          &res) == GST_ITERATOR_RESYNC)
+    gst_iterator_resync (children);
+  gst_iterator_free (children);
+
+  return res;
+}
+
 static gint
 compare_name (const GValue * velement, const gchar * name)
 {
@@ -225,6 +225,9 @@ GstIterator*    gst_bin_iterate_elements	 (GstBin *bin);
 GST_EXPORT
 GstIterator*    gst_bin_iterate_sorted		 (GstBin *bin);
 
+GST_EXPORT
+GstIterator*    gst_bin_iterate_elements_snapshot (GstBin *bin);
+
 GST_EXPORT
 GstIterator*    gst_bin_iterate_recurse		 (GstBin *bin);
 
@@ -250,6 +253,12 @@ void            gst_bin_set_suppressed_flags (GstBin * bin, GstElementFlags flag
 GST_EXPORT
 GstElementFlags gst_bin_get_suppressed_flags (GstBin * bin);
 
+/* deep-notify filtering */
+
+GST_EXPORT
+void            gst_bin_set_deep_notify_filter (GstBin * bin, GType type,
+                                                const gchar * const * property_names);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstBin, gst_object_unref)
 #endif
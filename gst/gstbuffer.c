@@ -142,14 +142,38 @@ struct _GstMetaItem
 };
 #define ITEM_SIZE(info) ((info)->size + sizeof (GstMetaItem))
 
-#define GST_BUFFER_MEM_MAX         16
+/* meta items up to this size are allocated with this size from the
+ * per-thread free-lists */
+#define ITEM_CACHED_SIZE 64
+
+/* size of the meta item stored in the buffer itself. Buffer pools put the
+ * same metas on every buffer, most of all GstVideoMeta, so the storage fits
+ * one of those: a GstMeta, the buffer and the map and unmap functions, the
+ * flags, format, id, width, height and number of planes and the offset and
+ * stride of the 4 planes */
+#define ITEM_INLINE_SIZE (sizeof (GstMetaItem) + sizeof (GstMeta) + \
+    3 * sizeof (gpointer) + 4 * sizeof (gsize) + 10 * sizeof (gint))
+
+/* memory blocks stored in the buffer itself, when more are added, the
+ * array is moved out of line and grown as needed up to GST_BUFFER_MEM_MAX */
+#define GST_BUFFER_MEM_INLINE      16
+#define GST_BUFFER_MEM_MAX         1024
 
 #define GST_BUFFER_SLICE_SIZE(b)   (((GstBufferImpl *)(b))->slice_size)
 #define GST_BUFFER_MEM_LEN(b)      (((GstBufferImpl *)(b))->len)
+#define GST_BUFFER_MEM_ALLOCED(b)  (((GstBufferImpl *)(b))->alloced)
+#define GST_BUFFER_MEM_INLINED(b)  (((GstBufferImpl *)(b))->mem_inline)
 #define GST_BUFFER_MEM_ARRAY(b)    (((GstBufferImpl *)(b))->mem)
 #define GST_BUFFER_MEM_PTR(b,i)    (((GstBufferImpl *)(b))->mem[i])
 #define GST_BUFFER_BUFMEM(b)       (((GstBufferImpl *)(b))->bufmem)
+#define GST_BUFFER_MERGED(b)       (((GstBufferImpl *)(b))->merged)
 #define GST_BUFFER_META(b)         (((GstBufferImpl *)(b))->item)
+#define GST_BUFFER_META_BITS(b)    (((GstBufferImpl *)(b))->meta_bits)
+
+/* a bit for a meta API in the meta_bits of a buffer. APIs can share a bit,
+ * a zero bit means that no meta of the API is on the buffer */
+#define META_API_BIT(api) \
+    (G_GUINT64_CONSTANT (1) << ((((api) >> 4) ^ ((api) >> 10)) & 63))
 
 typedef struct
 {
@@ -157,18 +181,64 @@ typedef struct
 
   gsize slice_size;
 
-  /* the memory blocks */
+  /* the memory blocks, mem points to mem_inline or to an allocated array
+   * of alloced entries */
   guint len;
-  GstMemory *mem[GST_BUFFER_MEM_MAX];
+  guint alloced;
+  GstMemory **mem;
+  GstMemory *mem_inline[GST_BUFFER_MEM_INLINE];
 
   /* memory of the buffer when allocated from 1 chunk */
   GstMemory *bufmem;
 
+  /* all memory merged by a read map while the buffer was not writable, the
+   * next read maps reuse it until the memory can change again */
+  GstMemory *merged;
+
   /* FIXME, make metadata allocation more efficient by using part of the
    * GstBufferImpl */
   GstMetaItem *item;
+  /* META_API_BIT of the API of every meta in item */
+  guint64 meta_bits;
+
+  /* storage for one meta item. Buffers from a pool get the same metas
+   * every time they are used, this storage then stays with the buffer */
+  union
+  {
+    GstMetaItem item;
+    guint64 align;
+    guint8 data[ITEM_INLINE_SIZE];
+  } meta_inline;
+  gboolean meta_inline_used;
 } GstBufferImpl;
 
+#define GST_BUFFER_META_INLINE(b)      (&((GstBufferImpl *)(b))->meta_inline.item)
+#define GST_BUFFER_META_INLINE_USED(b) (((GstBufferImpl *)(b))->meta_inline_used)
+
+static inline GstMetaItem *
+_meta_item_alloc (GstBuffer * buffer, gsize size)
+{
+  if (size <= ITEM_INLINE_SIZE && !GST_BUFFER_META_INLINE_USED (buffer)) {
+    GST_BUFFER_META_INLINE_USED (buffer) = TRUE;
+    return GST_BUFFER_META_INLINE (buffer);
+  }
+  if (size <= ITEM_CACHED_SIZE)
+    return _priv_gst_free_list_alloc (GST_FREE_LIST_META);
+
+  return g_slice_alloc (size);
+}
+
+static inline void
+_meta_item_free (GstBuffer * buffer, GstMetaItem * item, gsize size)
+{
+  if (item == GST_BUFFER_META_INLINE (buffer))
+    GST_BUFFER_META_INLINE_USED (buffer) = FALSE;
+  else if (size <= ITEM_CACHED_SIZE)
+    _priv_gst_free_list_free (GST_FREE_LIST_META, item);
+  else
+    g_slice_free1 (size, item);
+}
+
 
 static gboolean
 _is_span (GstMemory ** mem, gsize len, gsize * poffset, GstMemory ** parent)
@@ -271,12 +341,27 @@ _get_merged_memory (GstBuffer * buffer, guint idx, guint length)
   return result;
 }
 
+/* drop the cached merged memory, called on writable buffers before their
+ * memory can change */
+static inline void
+_clear_merged (GstBuffer * buffer)
+{
+  GstMemory *merged = GST_BUFFER_MERGED (buffer);
+
+  if (G_UNLIKELY (merged != NULL)) {
+    GST_BUFFER_MERGED (buffer) = NULL;
+    gst_memory_unref (merged);
+  }
+}
+
 static void
 _replace_memory (GstBuffer * buffer, guint len, guint idx, guint length,
     GstMemory * mem)
 {
   gsize end, i;
 
+  _clear_merged (buffer);
+
   end = idx + length;
 
   GST_CAT_LOG (GST_CAT_BUFFER,
@@ -406,6 +491,38 @@ _memory_get_exclusive_reference (GstMemory * mem)
   return ret;
 }
 
+/* make room for at least one more memory block, returns FALSE when the
+ * maximum is reached */
+static gboolean
+_memory_array_grow (GstBuffer * buffer)
+{
+  guint len = GST_BUFFER_MEM_LEN (buffer);
+  guint alloced = GST_BUFFER_MEM_ALLOCED (buffer);
+
+  if (len < alloced)
+    return TRUE;
+
+  if (alloced >= GST_BUFFER_MEM_MAX)
+    return FALSE;
+
+  alloced = MIN (alloced * 2, GST_BUFFER_MEM_MAX);
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "growing memory array of buffer %p "
+      "to %u", buffer, alloced);
+
+  if (GST_BUFFER_MEM_ARRAY (buffer) == GST_BUFFER_MEM_INLINED (buffer)) {
+    GST_BUFFER_MEM_ARRAY (buffer) = g_new (GstMemory *, alloced);
+    memcpy (GST_BUFFER_MEM_ARRAY (buffer), GST_BUFFER_MEM_INLINED (buffer),
+        len * sizeof (gpointer));
+  } else {
+    GST_BUFFER_MEM_ARRAY (buffer) =
+        g_renew (GstMemory *, GST_BUFFER_MEM_ARRAY (buffer), alloced);
+  }
+  GST_BUFFER_MEM_ALLOCED (buffer) = alloced;
+
+  return TRUE;
+}
+
 static inline void
 _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem)
 {
@@ -413,7 +530,10 @@ _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem)
 
   GST_CAT_LOG (GST_CAT_BUFFER, "buffer %p, idx %d, mem %p", buffer, idx, mem);
 
-  if (G_UNLIKELY (len >= GST_BUFFER_MEM_MAX)) {
+  _clear_merged (buffer);
+
+  if (G_UNLIKELY (len >= GST_BUFFER_MEM_ALLOCED (buffer)
+          && !_memory_array_grow (buffer))) {
     /* too many buffer, span them. */
     /* FIXME, there is room for improvement here: We could only try to merge
      * 2 buffers to make some room. If we can't efficiently merge 2 buffers we
@@ -445,6 +565,10 @@ void
 _priv_gst_buffer_initialize (void)
 {
   _gst_buffer_type = gst_buffer_get_type ();
+
+  _priv_gst_free_list_set_block_size (GST_FREE_LIST_BUFFER,
+      sizeof (GstBufferImpl));
+  _priv_gst_free_list_set_block_size (GST_FREE_LIST_META, ITEM_CACHED_SIZE);
 }
 
 /**
@@ -456,6 +580,9 @@ _priv_gst_buffer_initialize (void)
  * When more memory blocks are added, existing memory blocks will be merged
  * together to make room for the new block.
  *
+ * Since 1.14 buffers can hold more memory blocks than before without merging,
+ * the value returned by this function increased accordingly.
+ *
  * Returns: the maximum amount of memory blocks that a buffer can hold.
  *
  * Since: 1.2
@@ -735,7 +862,7 @@ _gst_buffer_free (GstBuffer * buffer)
 
     next = walk->next;
     /* and free the slice */
-    g_slice_free1 (ITEM_SIZE (info), walk);
+    _meta_item_free (buffer, walk, ITEM_SIZE (info));
   }
 
   /* get the size, when unreffing the memory, we could also unref the buffer
@@ -743,18 +870,24 @@ _gst_buffer_free (GstBuffer * buffer)
   msize = GST_BUFFER_SLICE_SIZE (buffer);
 
   /* free our memory */
+  _clear_merged (buffer);
   len = GST_BUFFER_MEM_LEN (buffer);
   for (i = 0; i < len; i++) {
     gst_memory_unlock (GST_BUFFER_MEM_PTR (buffer, i), GST_LOCK_FLAG_EXCLUSIVE);
     gst_memory_unref (GST_BUFFER_MEM_PTR (buffer, i));
   }
+  if (GST_BUFFER_MEM_ARRAY (buffer) != GST_BUFFER_MEM_INLINED (buffer))
+    g_free (GST_BUFFER_MEM_ARRAY (buffer));
 
   /* we set msize to 0 when the buffer is part of the memory block */
   if (msize) {
 #ifdef USE_POISONING
     memset (buffer, 0xff, msize);
 #endif
-    g_slice_free1 (msize, buffer);
+    if (msize == sizeof (GstBufferImpl))
+      _priv_gst_free_list_free (GST_FREE_LIST_BUFFER, buffer);
+    else
+      g_slice_free1 (msize, buffer);
   } else {
     gst_memory_unref (GST_BUFFER_BUFMEM (buffer));
   }
@@ -778,7 +911,12 @@ gst_buffer_init (GstBufferImpl * buffer, gsize size)
   GST_BUFFER_OFFSET_END (buffer) = GST_BUFFER_OFFSET_NONE;
 
   GST_BUFFER_MEM_LEN (buffer) = 0;
+  GST_BUFFER_MEM_ALLOCED (buffer) = GST_BUFFER_MEM_INLINE;
+  GST_BUFFER_MEM_ARRAY (buffer) = GST_BUFFER_MEM_INLINED (buffer);
   GST_BUFFER_META (buffer) = NULL;
+  GST_BUFFER_META_BITS (buffer) = 0;
+  GST_BUFFER_MERGED (buffer) = NULL;
+  GST_BUFFER_META_INLINE_USED (buffer) = FALSE;
 }
 
 /**
@@ -795,7 +933,7 @@ gst_buffer_new (void)
 {
   GstBufferImpl *newbuf;
 
-  newbuf = g_slice_new (GstBufferImpl);
+  newbuf = _priv_gst_free_list_alloc (GST_FREE_LIST_BUFFER);
   GST_CAT_LOG (GST_CAT_BUFFER, "new %p", newbuf);
 
   gst_buffer_init (newbuf, sizeof (GstBufferImpl));
@@ -1054,6 +1192,9 @@ _get_mapped (GstBuffer * buffer, guint idx, GstMapInfo * info,
 {
   GstMemory *mem, *mapped;
 
+  if (flags & GST_MAP_WRITE)
+    _clear_merged (buffer);
+
   mem = gst_memory_ref (GST_BUFFER_MEM_PTR (buffer, idx));
 
   mapped = gst_memory_make_mapped (mem, info, flags);
@@ -1091,6 +1232,10 @@ gst_buffer_peek_memory (GstBuffer * buffer, guint idx)
   len = GST_BUFFER_MEM_LEN (buffer);
   g_return_val_if_fail (idx < len, NULL);
 
+  /* the caller might write to the memory */
+  if (gst_buffer_is_writable (buffer))
+    _clear_merged (buffer);
+
   return GST_BUFFER_MEM_PTR (buffer, idx);
 }
 
@@ -1155,6 +1300,9 @@ gst_buffer_get_memory_range (GstBuffer * buffer, guint idx, gint length)
   if (length == -1)
     length = len - idx;
 
+  if (gst_buffer_is_writable (buffer))
+    _clear_merged (buffer);
+
   return _get_merged_memory (buffer, idx, length);
 }
 
@@ -1595,6 +1743,8 @@ gst_buffer_resize_range (GstBuffer * buffer, guint idx, gint length,
   if (offset == 0 && size == bufsize)
     return TRUE;
 
+  _clear_merged (buffer);
+
   end = idx + length;
   /* copy and trim */
   for (i = idx; i < end; i++) {
@@ -1706,8 +1856,8 @@ gboolean
 gst_buffer_map_range (GstBuffer * buffer, guint idx, gint length,
     GstMapInfo * info, GstMapFlags flags)
 {
-  GstMemory *mem, *nmem;
-  gboolean write, writable;
+  GstMemory *mem, *nmem, *merged;
+  gboolean write, writable, cached = FALSE;
   gsize len;
 
   g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
@@ -1730,7 +1880,20 @@ gst_buffer_map_range (GstBuffer * buffer, guint idx, gint length,
   if (length == -1)
     length = len - idx;
 
-  mem = _get_merged_memory (buffer, idx, length);
+  if (writable) {
+    _clear_merged (buffer);
+  } else if (length > 1 && length == len) {
+    /* the memory of a buffer that is not writable can't change, reuse the
+     * memory merged by a previous map */
+    merged = g_atomic_pointer_get (&GST_BUFFER_MERGED (buffer));
+    if (merged != NULL) {
+      mem = gst_memory_ref (merged);
+      cached = TRUE;
+    }
+  }
+
+  if (!cached)
+    mem = _get_merged_memory (buffer, idx, length);
   if (G_UNLIKELY (mem == NULL))
     goto no_memory;
 
@@ -1745,11 +1908,17 @@ gst_buffer_map_range (GstBuffer * buffer, guint idx, gint length,
     /* if the buffer is writable, replace the memory */
     if (writable) {
       _replace_memory (buffer, len, idx, length, gst_memory_ref (nmem));
-    } else {
-      if (len > 1) {
+    } else if (!cached && length > 1 && length == len) {
+      /* keep it for the next maps, another thread might have been faster */
+      if (g_atomic_pointer_compare_and_exchange (&GST_BUFFER_MERGED (buffer),
+              NULL, nmem)) {
+        gst_memory_ref (nmem);
         GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
-            "temporary mapping for memory %p in buffer %p", nmem, buffer);
+            "cached mapping for memory %p in buffer %p", nmem, buffer);
       }
+    } else if (!cached && len > 1) {
+      GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+          "temporary mapping for memory %p in buffer %p", nmem, buffer);
     }
   }
   return TRUE;
@@ -1798,6 +1967,24 @@ gst_buffer_unmap (GstBuffer * buffer, GstMapInfo * info)
   }
 }
 
+/* find the first memory with data after @offset and make @offset relative
+ * to it. The memory before it is skipped without mapping it. */
+static guint
+_find_memory_at (GstBuffer * buffer, gsize * offset)
+{
+  guint i, len;
+
+  len = GST_BUFFER_MEM_LEN (buffer);
+  for (i = 0; i < len; i++) {
+    gsize size = GST_BUFFER_MEM_PTR (buffer, i)->size;
+
+    if (size > *offset)
+      break;
+    *offset -= size;
+  }
+  return i;
+}
+
 /**
  * gst_buffer_fill:
  * @buffer: a #GstBuffer.
@@ -1828,7 +2015,7 @@ gst_buffer_fill (GstBuffer * buffer, gsize offset, gconstpointer src,
   len = GST_BUFFER_MEM_LEN (buffer);
   left = size;
 
-  for (i = 0; i < len && left > 0; i++) {
+  for (i = _find_memory_at (buffer, &offset); i < len && left > 0; i++) {
     GstMapInfo info;
     gsize tocopy;
     GstMemory *mem;
@@ -1878,7 +2065,7 @@ gst_buffer_extract (GstBuffer * buffer, gsize offset, gpointer dest, gsize size)
   len = GST_BUFFER_MEM_LEN (buffer);
   left = size;
 
-  for (i = 0; i < len && left > 0; i++) {
+  for (i = _find_memory_at (buffer, &offset); i < len && left > 0; i++) {
     GstMapInfo info;
     gsize tocopy;
     GstMemory *mem;
@@ -1931,7 +2118,8 @@ gst_buffer_memcmp (GstBuffer * buffer, gsize offset, gconstpointer mem,
 
   len = GST_BUFFER_MEM_LEN (buffer);
 
-  for (i = 0; i < len && size > 0 && res == 0; i++) {
+  for (i = _find_memory_at (buffer, &offset); i < len && size > 0 && res == 0;
+      i++) {
     GstMapInfo info;
     gsize tocmp;
     GstMemory *mem;
@@ -1980,7 +2168,7 @@ gst_buffer_memset (GstBuffer * buffer, gsize offset, guint8 val, gsize size)
   len = GST_BUFFER_MEM_LEN (buffer);
   left = size;
 
-  for (i = 0; i < len && left > 0; i++) {
+  for (i = _find_memory_at (buffer, &offset); i < len && left > 0; i++) {
     GstMapInfo info;
     gsize toset;
     GstMemory *mem;
@@ -2105,6 +2293,19 @@ gst_buffer_append_region (GstBuffer * buf1, GstBuffer * buf2, gssize offset,
   return buf1;
 }
 
+/* recalculate the meta bits after metadata was removed */
+static void
+_update_meta_bits (GstBuffer * buffer)
+{
+  GstMetaItem *walk;
+  guint64 bits = 0;
+
+  for (walk = GST_BUFFER_META (buffer); walk; walk = walk->next)
+    bits |= META_API_BIT (walk->meta.info->api);
+
+  GST_BUFFER_META_BITS (buffer) = bits;
+}
+
 /**
  * gst_buffer_get_meta:
  * @buffer: a #GstBuffer
@@ -2128,6 +2329,9 @@ gst_buffer_get_meta (GstBuffer * buffer, GType api)
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (api != 0, NULL);
 
+  if (!(GST_BUFFER_META_BITS (buffer) & META_API_BIT (api)))
+    return NULL;
+
   /* find GstMeta of the requested API */
   for (item = GST_BUFFER_META (buffer); item; item = item->next) {
     GstMeta *meta = &item->meta;
@@ -2167,10 +2371,9 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
    * init function but let's play safe here and prevent
    * uninitialized memory
    */
+  item = _meta_item_alloc (buffer, size);
   if (!info->init_func)
-    item = g_slice_alloc0 (size);
-  else
-    item = g_slice_alloc (size);
+    memset (item, 0, size);
   result = &item->meta;
   result->info = info;
   result->flags = GST_META_FLAG_NONE;
@@ -2186,12 +2389,13 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
   /* and add to the list of metadata */
   item->next = GST_BUFFER_META (buffer);
   GST_BUFFER_META (buffer) = item;
+  GST_BUFFER_META_BITS (buffer) |= META_API_BIT (info->api);
 
   return result;
 
 init_failed:
   {
-    g_slice_free1 (size, item);
+    _meta_item_free (buffer, item, size);
     return NULL;
   }
 }
@@ -2234,7 +2438,8 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      _meta_item_free (buffer, walk, ITEM_SIZE (info));
+      _update_meta_bits (buffer);
       break;
     }
     prev = walk;
@@ -2304,12 +2509,15 @@ gst_buffer_iterate_meta_filtered (GstBuffer * buffer, gpointer * state,
   g_return_val_if_fail (state != NULL, NULL);
 
   meta = (GstMetaItem **) state;
-  if (*meta == NULL)
+  if (*meta == NULL) {
     /* state NULL, move to first item */
+    if (!(GST_BUFFER_META_BITS (buffer) & META_API_BIT (meta_api_type)))
+      return NULL;
     *meta = GST_BUFFER_META (buffer);
-  else
+  } else {
     /* state !NULL, move to next item in list */
     *meta = (*meta)->next;
+  }
 
   while (*meta != NULL && (*meta)->meta.info->api != meta_api_type)
     *meta = (*meta)->next;
@@ -2340,6 +2548,7 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
 {
   GstMetaItem *walk, *prev, *next;
   gboolean res = TRUE;
+  gboolean removed = FALSE;
 
   g_return_val_if_fail (buffer != NULL, FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
@@ -2377,13 +2586,17 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      _meta_item_free (buffer, walk, ITEM_SIZE (info));
+      removed = TRUE;
     } else {
       prev = walk;
     }
     if (!res)
       break;
   }
+  if (removed)
+    _update_meta_bits (buffer);
+
   return res;
 }
 
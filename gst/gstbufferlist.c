@@ -35,6 +35,12 @@
  * Buffer lists can be pushed on a srcpad with gst_pad_push_list(). This is
  * interesting when multiple buffers need to be pushed in one go because it
  * can reduce the amount of overhead for pushing each buffer individually.
+ *
+ * Lists with room for up to 32 buffers are taken from and returned to the
+ * same per-thread free-lists as buffers, so a thread that keeps creating and
+ * freeing lists doesn't allocate memory for them. Removing buffers from the
+ * front of a list doesn't move the remaining buffers, which makes it cheap to
+ * consume a list buffer by buffer with gst_buffer_list_take().
  */
 #include "gst_private.h"
 
@@ -44,8 +50,19 @@
 
 #define GST_CAT_DEFAULT GST_CAT_BUFFER_LIST
 
+/* the start of the array, buffers removed from the front leave unused slots
+ * before list->buffers */
+#define GST_BUFFER_LIST_ARRAY(list) ((list)->buffers - (list)->n_skipped)
+
 #define GST_BUFFER_LIST_IS_USING_DYNAMIC_ARRAY(list) \
-    ((list)->buffers != &(list)->arr[0])
+    (GST_BUFFER_LIST_ARRAY (list) != &(list)->arr[0])
+
+/* lists with up to this many buffers are allocated with the size for this
+ * many from the free-list */
+#define GST_BUFFER_LIST_CACHED_LEN 32
+#define GST_BUFFER_LIST_CACHED_SIZE \
+    (sizeof (GstBufferList) + (GST_BUFFER_LIST_CACHED_LEN - 1) * \
+        sizeof (gpointer))
 
 /**
  * GstBufferList:
@@ -58,7 +75,10 @@ struct _GstBufferList
 
   GstBuffer **buffers;
   guint n_buffers;
+  /* available slots starting at buffers */
   guint n_allocated;
+  /* unused slots before buffers */
+  guint n_skipped;
 
   gsize slice_size;
 
@@ -76,6 +96,9 @@ void
 _priv_gst_buffer_list_initialize (void)
 {
   _gst_buffer_list_type = gst_buffer_list_get_type ();
+
+  _priv_gst_free_list_set_block_size (GST_FREE_LIST_BUFFER_LIST,
+      GST_BUFFER_LIST_CACHED_SIZE);
 }
 
 static GstBufferList *
@@ -109,9 +132,12 @@ _gst_buffer_list_free (GstBufferList * list)
     gst_buffer_unref (list->buffers[i]);
 
   if (GST_BUFFER_LIST_IS_USING_DYNAMIC_ARRAY (list))
-    g_free (list->buffers);
+    g_free (GST_BUFFER_LIST_ARRAY (list));
 
-  g_slice_free1 (list->slice_size, list);
+  if (list->slice_size == GST_BUFFER_LIST_CACHED_SIZE)
+    _priv_gst_free_list_free (GST_FREE_LIST_BUFFER_LIST, list);
+  else
+    g_slice_free1 (list->slice_size, list);
 }
 
 static void
@@ -124,6 +150,7 @@ gst_buffer_list_init (GstBufferList * list, guint n_allocated, gsize slice_size)
   list->buffers = &list->arr[0];
   list->n_buffers = 0;
   list->n_allocated = n_allocated;
+  list->n_skipped = 0;
   list->slice_size = slice_size;
 
   GST_LOG ("init %p", list);
@@ -149,11 +176,16 @@ gst_buffer_list_new_sized (guint size)
   gsize slice_size;
   guint n_allocated;
 
-  n_allocated = GST_ROUND_UP_16 (size);
-
-  slice_size = sizeof (GstBufferList) + (n_allocated - 1) * sizeof (gpointer);
-
-  list = g_slice_alloc0 (slice_size);
+  if (size <= GST_BUFFER_LIST_CACHED_LEN) {
+    n_allocated = GST_BUFFER_LIST_CACHED_LEN;
+    slice_size = GST_BUFFER_LIST_CACHED_SIZE;
+    list = _priv_gst_free_list_alloc (GST_FREE_LIST_BUFFER_LIST);
+  } else {
+    n_allocated = GST_ROUND_UP_16 (size);
+    slice_size =
+        sizeof (GstBufferList) + (n_allocated - 1) * sizeof (gpointer);
+    list = g_slice_alloc0 (slice_size);
+  }
 
   GST_LOG ("new %p", list);
 
@@ -206,12 +238,23 @@ gst_buffer_list_remove_range_internal (GstBufferList * list, guint idx,
       gst_buffer_unref (list->buffers[i]);
   }
 
-  if (idx + length != list->n_buffers) {
+  if (idx == 0 && length < list->n_buffers) {
+    /* skip the slots instead of moving all the following buffers */
+    list->buffers += length;
+    list->n_allocated -= length;
+    list->n_skipped += length;
+  } else if (idx + length != list->n_buffers) {
     memmove (&list->buffers[idx], &list->buffers[idx + length],
         (list->n_buffers - (idx + length)) * sizeof (void *));
   }
 
   list->n_buffers -= length;
+
+  if (list->n_buffers == 0 && list->n_skipped > 0) {
+    list->buffers = GST_BUFFER_LIST_ARRAY (list);
+    list->n_allocated += list->n_skipped;
+    list->n_skipped = 0;
+  }
 }
 
 /**
@@ -353,8 +396,27 @@ gst_buffer_list_insert (GstBufferList * list, gint idx, GstBuffer * buffer)
   if (idx == -1 || idx > list->n_buffers)
     idx = list->n_buffers;
 
+  /* reuse a slot that was skipped when removing from the front */
+  if (idx == 0 && list->n_skipped > 0) {
+    list->buffers--;
+    list->n_allocated++;
+    list->n_skipped--;
+    list->n_buffers++;
+    list->buffers[0] = buffer;
+    return;
+  }
+
   want_alloc = list->n_buffers + 1;
 
+  if (want_alloc > list->n_allocated && list->n_skipped > 0) {
+    /* move the buffers back to the start of the array first */
+    memmove (GST_BUFFER_LIST_ARRAY (list), list->buffers,
+        list->n_buffers * sizeof (void *));
+    list->buffers = GST_BUFFER_LIST_ARRAY (list);
+    list->n_allocated += list->n_skipped;
+    list->n_skipped = 0;
+  }
+
   if (want_alloc > list->n_allocated) {
     want_alloc = MAX (GST_ROUND_UP_16 (want_alloc), list->n_allocated * 2);
 
@@ -398,6 +460,36 @@ gst_buffer_list_remove (GstBufferList * list, guint idx, guint length)
   gst_buffer_list_remove_range_internal (list, idx, length, TRUE);
 }
 
+/**
+ * gst_buffer_list_take:
+ * @list: a writable #GstBufferList
+ * @idx: the index
+ *
+ * Remove the buffer at @idx from @list and return it. The reference that
+ * @list had on the buffer is handed over to the caller, so unlike
+ * gst_buffer_list_get() followed by gst_buffer_ref() and
+ * gst_buffer_list_remove() this doesn't change the refcount of the buffer
+ * and a buffer that was only in @list stays writable.
+ *
+ * Returns: (transfer full): the buffer at @idx in @list.
+ *
+ * Since: 1.14
+ */
+GstBuffer *
+gst_buffer_list_take (GstBufferList * list, guint idx)
+{
+  GstBuffer *buf;
+
+  g_return_val_if_fail (GST_IS_BUFFER_LIST (list), NULL);
+  g_return_val_if_fail (idx < list->n_buffers, NULL);
+  g_return_val_if_fail (gst_buffer_list_is_writable (list), NULL);
+
+  buf = list->buffers[idx];
+  gst_buffer_list_remove_range_internal (list, idx, 1, FALSE);
+
+  return buf;
+}
+
 /**
  * gst_buffer_list_copy_deep:
  * @list: a #GstBufferList
@@ -157,6 +157,9 @@ void                     gst_buffer_list_insert                (GstBufferList *l
 GST_EXPORT
 void                     gst_buffer_list_remove                (GstBufferList *list, guint idx, guint length);
 
+GST_EXPORT
+GstBuffer *              gst_buffer_list_take                  (GstBufferList *list, guint idx);
+
 GST_EXPORT
 gboolean                 gst_buffer_list_foreach               (GstBufferList *list,
                                                                 GstBufferListFunc func,
@@ -64,17 +64,24 @@
  * refcount of the pool reaches 0, the pool will be freed.
  */
 
+/* for sched_getcpu() */
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE 1
+#endif
+
 #include "gst_private.h"
 #include "glib-compat-private.h"
 
-#include <errno.h>
+#include <stdlib.h>
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
 #endif
 #include <sys/types.h>
+#ifdef HAVE_SCHED_GETCPU
+#  include <sched.h>
+#endif
 
 #include "gstatomicqueue.h"
-#include "gstpoll.h"
 #include "gstinfo.h"
 #include "gstquark.h"
 #include "gstvalue.h"
@@ -96,10 +103,31 @@ GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 #define GST_BUFFER_POOL_LOCK(pool)   (g_rec_mutex_lock(&pool->priv->rec_lock))
 #define GST_BUFFER_POOL_UNLOCK(pool) (g_rec_mutex_unlock(&pool->priv->rec_lock))
 
+/* the number of NUMA nodes we keep separate free queues for, buffers of
+ * higher nodes share the queues */
+#define MAX_NUMA_NODES 8
+
+/* pools with a maximum up to this keep their free buffers in a ring */
+#define MAX_RING_BUFFERS 4096
+
 struct _GstBufferPoolPrivate
 {
+  /* free buffers, with GST_BUFFER_POOL_OPTION_NUMA_LOCAL only the buffers
+   * that were never acquired yet */
   GstAtomicQueue *queue;
-  GstPoll *poll;
+
+  /* free buffers per NUMA node, with GST_BUFFER_POOL_OPTION_NUMA_LOCAL */
+  gboolean numa_local;
+  GstAtomicQueue *node_queues[MAX_NUMA_NODES];
+  gint local_acquires;
+  gint remote_acquires;
+
+  /* to wait for buffers to be released, only used when the queue is empty.
+   * Releasing threads only take the lock when there are waiters. */
+  GMutex wait_lock;
+  GCond wait_cond;
+  gint waiters;
+  gint wakeups;                 /* incremented for every wakeup */
 
   GRecMutex rec_lock;
 
@@ -133,6 +161,10 @@ static GstFlowReturn default_acquire_buffer (GstBufferPool * pool,
 static void default_reset_buffer (GstBufferPool * pool, GstBuffer * buffer);
 static void default_free_buffer (GstBufferPool * pool, GstBuffer * buffer);
 static void default_release_buffer (GstBufferPool * pool, GstBuffer * buffer);
+static const gchar **default_get_options (GstBufferPool * pool);
+
+/* the NUMA node of a pooled buffer, plus one */
+static GQuark numa_node_quark;
 
 static void
 gst_buffer_pool_class_init (GstBufferPoolClass * klass)
@@ -151,6 +183,9 @@ gst_buffer_pool_class_init (GstBufferPoolClass * klass)
   klass->alloc_buffer = default_alloc_buffer;
   klass->release_buffer = default_release_buffer;
   klass->free_buffer = default_free_buffer;
+  klass->get_options = default_get_options;
+
+  numa_node_quark = g_quark_from_static_string ("GstBufferPoolNumaNode");
 
   GST_DEBUG_CATEGORY_INIT (gst_buffer_pool_debug, "bufferpool", 0,
       "bufferpool debug");
@@ -165,7 +200,10 @@ gst_buffer_pool_init (GstBufferPool * pool)
 
   g_rec_mutex_init (&priv->rec_lock);
 
-  priv->poll = gst_poll_new_timer ();
+  g_mutex_init (&priv->wait_lock);
+  g_cond_init (&priv->wait_cond);
+  priv->waiters = 0;
+  priv->wakeups = 0;
   priv->queue = gst_atomic_queue_new (16);
   pool->flushing = 1;
   priv->active = FALSE;
@@ -177,10 +215,6 @@ gst_buffer_pool_init (GstBufferPool * pool)
   gst_allocation_params_init (&priv->params);
   gst_buffer_pool_config_set_allocator (priv->config, priv->allocator,
       &priv->params);
-  /* 1 control write for flushing - the flush token */
-  gst_poll_write_control (priv->poll);
-  /* 1 control write for marking that we are not waiting for poll - the wait token */
-  gst_poll_write_control (priv->poll);
 
   GST_DEBUG_OBJECT (pool, "created");
 }
@@ -190,6 +224,7 @@ gst_buffer_pool_finalize (GObject * object)
 {
   GstBufferPool *pool;
   GstBufferPoolPrivate *priv;
+  guint i;
 
   pool = GST_BUFFER_POOL_CAST (object);
   priv = pool->priv;
@@ -198,7 +233,12 @@ gst_buffer_pool_finalize (GObject * object)
 
   gst_buffer_pool_set_active (pool, FALSE);
   gst_atomic_queue_unref (priv->queue);
-  gst_poll_free (priv->poll);
+  for (i = 0; i < MAX_NUMA_NODES; i++) {
+    if (priv->node_queues[i])
+      gst_atomic_queue_unref (priv->node_queues[i]);
+  }
+  g_mutex_clear (&priv->wait_lock);
+  g_cond_clear (&priv->wait_cond);
   gst_structure_free (priv->config);
   g_rec_mutex_clear (&priv->rec_lock);
   if (priv->allocator)
@@ -228,6 +268,138 @@ gst_buffer_pool_new (void)
   return result;
 }
 
+/* the NUMA node of each cpu, read from sysfs once */
+static gint8 *cpu_nodes = NULL;
+static guint n_cpu_nodes = 0;
+
+static void
+read_cpu_nodes (void)
+{
+#if defined(HAVE_SCHED_GETCPU) && defined(__linux__)
+  GArray *nodes;
+  guint cpu;
+
+  nodes = g_array_new (FALSE, TRUE, sizeof (gint8));
+  for (cpu = 0;; cpu++) {
+    gchar *path;
+    GDir *dir;
+    const gchar *name;
+    gint8 node = 0;
+
+    path = g_strdup_printf ("/sys/devices/system/cpu/cpu%u", cpu);
+    dir = g_dir_open (path, 0, NULL);
+    g_free (path);
+    if (dir == NULL)
+      break;
+
+    while ((name = g_dir_read_name (dir))) {
+      if (g_str_has_prefix (name, "node")
+          && g_ascii_isdigit (name[strlen ("node")])) {
+        node = MIN (atoi (name + strlen ("node")), G_MAXINT8);
+        break;
+      }
+    }
+    g_dir_close (dir);
+
+    g_array_append_val (nodes, node);
+  }
+  n_cpu_nodes = nodes->len;
+  cpu_nodes = (gint8 *) g_array_free (nodes, FALSE);
+
+  GST_DEBUG ("read the NUMA node of %u cpus", n_cpu_nodes);
+#endif
+}
+
+/* the NUMA node the calling thread runs on, or -1 when unknown */
+static gint
+get_current_numa_node (void)
+{
+#if defined(HAVE_SCHED_GETCPU) && defined(__linux__)
+  static gsize init = 0;
+  gint cpu;
+
+  if (g_once_init_enter (&init)) {
+    read_cpu_nodes ();
+    g_once_init_leave (&init, 1);
+  }
+
+  cpu = sched_getcpu ();
+  if (cpu < 0 || (guint) cpu >= n_cpu_nodes)
+    return -1;
+
+  return cpu_nodes[cpu];
+#else
+  return -1;
+#endif
+}
+
+static inline void
+set_buffer_node (GstBuffer * buffer, gint node)
+{
+  gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (buffer), numa_node_quark,
+      GINT_TO_POINTER (node + 1), NULL);
+}
+
+static GstBuffer *
+pop_buffer (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBuffer *buffer;
+  gint node, i;
+
+  if (G_LIKELY (!priv->numa_local))
+    return gst_atomic_queue_pop (priv->queue);
+
+  node = get_current_numa_node ();
+  if (G_UNLIKELY (node < 0))
+    return gst_atomic_queue_pop (priv->queue);
+  node %= MAX_NUMA_NODES;
+
+  if ((buffer = gst_atomic_queue_pop (priv->node_queues[node])))
+    goto local;
+
+  /* buffers that were never acquired get their memory on our node when we
+   * first write to them */
+  if ((buffer = gst_atomic_queue_pop (priv->queue))) {
+    set_buffer_node (buffer, node);
+    goto local;
+  }
+
+  for (i = 1; i < MAX_NUMA_NODES; i++) {
+    if ((buffer =
+            gst_atomic_queue_pop (priv->node_queues[(node + i) %
+                    MAX_NUMA_NODES]))) {
+      g_atomic_int_inc (&priv->remote_acquires);
+      GST_CAT_LOG_OBJECT (GST_CAT_PERFORMANCE, pool,
+          "acquired buffer %p of node %d on node %d", buffer,
+          (node + i) % MAX_NUMA_NODES, node);
+      return buffer;
+    }
+  }
+  return NULL;
+
+local:
+  g_atomic_int_inc (&priv->local_acquires);
+  return buffer;
+}
+
+static void
+push_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  gint node;
+
+  if (G_UNLIKELY (priv->numa_local)) {
+    node = GPOINTER_TO_INT (gst_mini_object_get_qdata (GST_MINI_OBJECT_CAST
+            (buffer), numa_node_quark));
+    if (node > 0) {
+      gst_atomic_queue_push (priv->node_queues[node - 1], buffer);
+      return;
+    }
+  }
+  gst_atomic_queue_push (priv->queue, buffer);
+}
+
 static GstFlowReturn
 default_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
@@ -397,22 +569,23 @@ default_stop (GstBufferPool * pool)
 {
   GstBufferPoolPrivate *priv = pool->priv;
   GstBuffer *buffer;
+  guint i;
 
   /* clear the pool */
-  while ((buffer = gst_atomic_queue_pop (priv->queue))) {
-    while (!gst_poll_read_control (priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* We put the buffer into the queue but did not finish writing control
-         * yet, let's wait a bit and retry */
-        g_thread_yield ();
-        continue;
-      } else {
-        /* Critical error but GstPoll already complained */
-        break;
-      }
-    }
+  while ((buffer = gst_atomic_queue_pop (priv->queue)))
     do_free_buffer (pool, buffer);
+
+  if (priv->numa_local) {
+    for (i = 0; i < MAX_NUMA_NODES; i++) {
+      while ((buffer = gst_atomic_queue_pop (priv->node_queues[i])))
+        do_free_buffer (pool, buffer);
+    }
+    GST_CAT_INFO_OBJECT (GST_CAT_PERFORMANCE, pool, "%d of %d acquisitions "
+        "used a buffer of another NUMA node", priv->remote_acquires,
+        priv->local_acquires + priv->remote_acquires);
+    priv->local_acquires = priv->remote_acquires = 0;
   }
+
   return priv->cur_buffers == 0;
 }
 
@@ -437,6 +610,21 @@ do_stop (GstBufferPool * pool)
   return TRUE;
 }
 
+/* wake up threads waiting in acquire, must be called after making a buffer
+ * available or changing the flushing state */
+static inline void
+wake_waiters (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  g_atomic_int_inc (&priv->wakeups);
+  if (g_atomic_int_get (&priv->waiters) > 0) {
+    g_mutex_lock (&priv->wait_lock);
+    g_cond_broadcast (&priv->wait_cond);
+    g_mutex_unlock (&priv->wait_lock);
+  }
+}
+
 /* must be called with the lock */
 static void
 do_set_flushing (GstBufferPool * pool, gboolean flushing)
@@ -451,8 +639,7 @@ do_set_flushing (GstBufferPool * pool, gboolean flushing)
 
   if (flushing) {
     g_atomic_int_set (&pool->flushing, 1);
-    /* Write the flush token to wake up any waiters */
-    gst_poll_write_control (priv->poll);
+    wake_waiters (pool);
 
     if (pclass->flush_start)
       pclass->flush_start (pool);
@@ -460,19 +647,6 @@ do_set_flushing (GstBufferPool * pool, gboolean flushing)
     if (pclass->flush_stop)
       pclass->flush_stop (pool);
 
-    while (!gst_poll_read_control (priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* This should not really happen unless flushing and unflushing
-         * happens on different threads. Let's wait a bit to get back flush
-         * token from the thread that was setting it to flushing */
-        g_thread_yield ();
-        continue;
-      } else {
-        /* Critical error but GstPoll already complained */
-        break;
-      }
-    }
-
     g_atomic_int_set (&pool->flushing, 0);
   }
 }
@@ -602,6 +776,7 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   guint size, min_buffers, max_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+  guint i, capacity, ring_size;
 
   /* parse the config and keep around */
   if (!gst_buffer_pool_config_get_params (config, &caps, &size, &min_buffers,
@@ -618,6 +793,33 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   priv->max_buffers = max_buffers;
   priv->cur_buffers = 0;
 
+  /* a pool with a maximum never has more free buffers than that, they fit in
+   * a ring that doesn't allocate and scales better with many threads. The
+   * ring is allocated up front so very large maximums use the growing queue
+   * like pools without a maximum. The queue is empty here because there are
+   * no outstanding buffers and the pool is stopped. */
+  ring_size = max_buffers <= MAX_RING_BUFFERS ? max_buffers : 0;
+  capacity = gst_atomic_queue_get_capacity (priv->queue);
+  if (((ring_size == 0) != (capacity == 0) || capacity < ring_size) &&
+      gst_atomic_queue_length (priv->queue) == 0) {
+    gst_atomic_queue_unref (priv->queue);
+    if (ring_size > 0)
+      priv->queue = gst_atomic_queue_new_bounded (ring_size);
+    else
+      priv->queue = gst_atomic_queue_new (16);
+  }
+
+  priv->numa_local =
+      gst_buffer_pool_config_has_option (config,
+      GST_BUFFER_POOL_OPTION_NUMA_LOCAL)
+      && gst_buffer_pool_has_option (pool, GST_BUFFER_POOL_OPTION_NUMA_LOCAL);
+  if (priv->numa_local) {
+    for (i = 0; i < MAX_NUMA_NODES; i++) {
+      if (!priv->node_queues[i])
+        priv->node_queues[i] = gst_atomic_queue_new (16);
+    }
+  }
+
   if (priv->allocator)
     gst_object_unref (priv->allocator);
   if ((priv->allocator = allocator))
@@ -755,6 +957,14 @@ gst_buffer_pool_get_config (GstBufferPool * pool)
 
 static const gchar *empty_option[] = { NULL };
 
+static const gchar **
+default_get_options (GstBufferPool * pool)
+{
+  static const gchar *options[] = { GST_BUFFER_POOL_OPTION_NUMA_LOCAL, NULL };
+
+  return options;
+}
+
 /**
  * gst_buffer_pool_get_options:
  * @pool: a #GstBufferPool
@@ -1105,25 +1315,17 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
 {
   GstFlowReturn result;
   GstBufferPoolPrivate *priv = pool->priv;
+  gint wakeups;
 
   while (TRUE) {
     if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
       goto flushing;
 
+    wakeups = g_atomic_int_get (&priv->wakeups);
+
     /* try to get a buffer from the queue */
-    *buffer = gst_atomic_queue_pop (priv->queue);
+    *buffer = pop_buffer (pool);
     if (G_LIKELY (*buffer)) {
-      while (!gst_poll_read_control (priv->poll)) {
-        if (errno == EWOULDBLOCK) {
-          /* We put the buffer into the queue but did not finish writing control
-           * yet, let's wait a bit and retry */
-          g_thread_yield ();
-          continue;
-        } else {
-          /* Critical error but GstPoll already complained */
-          break;
-        }
-      }
       result = GST_FLOW_OK;
       GST_LOG_OBJECT (pool, "acquired buffer %p", *buffer);
       break;
@@ -1132,9 +1334,16 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     /* no buffer, try to allocate some more */
     GST_LOG_OBJECT (pool, "no buffer, trying to allocate");
     result = do_alloc_buffer (pool, buffer, params);
-    if (G_LIKELY (result == GST_FLOW_OK))
+    if (G_LIKELY (result == GST_FLOW_OK)) {
       /* we have a buffer, return it */
+      if (G_UNLIKELY (priv->numa_local)) {
+        gint node = get_current_numa_node ();
+
+        if (node >= 0)
+          set_buffer_node (*buffer, node % MAX_NUMA_NODES);
+      }
       break;
+    }
 
     if (G_UNLIKELY (result != GST_FLOW_EOS))
       /* something went wrong, return error */
@@ -1146,35 +1355,19 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       break;
     }
 
-    /* now we release the control socket, we wait for a buffer release or
-     * flushing */
-    if (!gst_poll_read_control (pool->priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* This means that we have two threads trying to allocate buffers
-         * already, and the other one already got the wait token. This
-         * means that we only have to wait for the poll now and not write the
-         * token afterwards: we will be woken up once the other thread is
-         * woken up and that one will write the wait token it removed */
-        GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
-        gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
-      } else {
-        /* This is a critical error, GstPoll already gave a warning */
-        result = GST_FLOW_ERROR;
-        break;
-      }
-    } else {
-      /* We're the first thread waiting, we got the wait token and have to
-       * write it again later
-       * OR
-       * We're a second thread and just consumed the flush token and block all
-       * other threads, in which case we must not wait and give it back
-       * immediately */
-      if (!GST_BUFFER_POOL_IS_FLUSHING (pool)) {
-        GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
-        gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
-      }
-      gst_poll_write_control (pool->priv->poll);
+    /* wait for a buffer release or flushing. We announce ourselves as a
+     * waiter before checking for wakeups again so that a concurrent release
+     * either sees us and wakes us up, or we see its wakeup. This never
+     * needs a syscall when buffers are available. */
+    g_mutex_lock (&priv->wait_lock);
+    g_atomic_int_inc (&priv->waiters);
+    if (wakeups == g_atomic_int_get (&priv->wakeups)
+        && !GST_BUFFER_POOL_IS_FLUSHING (pool)) {
+      GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
+      g_cond_wait (&priv->wait_cond, &priv->wait_lock);
     }
+    g_atomic_int_add (&priv->waiters, -1);
+    g_mutex_unlock (&priv->wait_lock);
   }
 
   return result;
@@ -1297,8 +1490,8 @@ default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
     goto not_writable;
 
   /* keep it around in our queue */
-  gst_atomic_queue_push (pool->priv->queue, buffer);
-  gst_poll_write_control (pool->priv->poll);
+  push_buffer (pool, buffer);
+  wake_waiters (pool);
 
   return;
 
@@ -1324,6 +1517,8 @@ not_writable:
 discard:
   {
     do_free_buffer (pool, buffer);
+    /* there is room to allocate a new buffer now */
+    wake_waiters (pool);
     return;
   }
 }
@@ -96,6 +96,23 @@ struct _GstBufferPoolAcquireParams {
  */
 #define GST_BUFFER_POOL_IS_FLUSHING(pool)  (g_atomic_int_get (&pool->flushing))
 
+/**
+ * GST_BUFFER_POOL_OPTION_NUMA_LOCAL:
+ *
+ * A bufferpool option to keep the free buffers of the pool per NUMA node.
+ * The memory of a buffer is placed on the node of the thread that first
+ * acquires it, and gst_buffer_pool_acquire_buffer() prefers the buffers of
+ * the node of the calling thread. Buffers of other nodes are only handed out
+ * when there are no local buffers left.
+ *
+ * Buffer pools that don't want this behaviour should not advertise the
+ * option in their #GstBufferPoolClass.get_options() vmethod. On systems
+ * without NUMA the option has no effect.
+ *
+ * Since: 1.14
+ */
+#define GST_BUFFER_POOL_OPTION_NUMA_LOCAL "GstBufferPoolOptionNumaLocal"
+
 /**
  * GstBufferPool:
  *
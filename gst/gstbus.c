@@ -124,8 +124,18 @@ struct _GstBusPrivate
   GSource *signal_watch;
 
   gboolean enable_async;
+  /* created when the bus is first polled, until then posting only wakes up
+   * the threads waiting on cond. with queue_lock */
   GstPoll *poll;
   GPollFD pollfd;
+  GCond cond;
+  guint num_waiters;
+
+  /* with LOCK */
+  GstMessageType message_types;
+  GstMessageType coalesce_types;
+  /* queued messages that newer ones can replace, with queue_lock */
+  GHashTable *coalesce;
 };
 
 #define gst_bus_parent_class parent_class
@@ -147,19 +157,6 @@ gst_bus_set_property (GObject * object,
   }
 }
 
-static void
-gst_bus_constructed (GObject * object)
-{
-  GstBus *bus = GST_BUS_CAST (object);
-
-  if (bus->priv->enable_async) {
-    bus->priv->poll = gst_poll_new_timer ();
-    gst_poll_get_read_gpollfd (bus->priv->poll, &bus->priv->pollfd);
-  }
-
-  G_OBJECT_CLASS (gst_bus_parent_class)->constructed (object);
-}
-
 static void
 gst_bus_class_init (GstBusClass * klass)
 {
@@ -168,7 +165,6 @@ gst_bus_class_init (GstBusClass * klass)
   gobject_class->dispose = gst_bus_dispose;
   gobject_class->finalize = gst_bus_finalize;
   gobject_class->set_property = gst_bus_set_property;
-  gobject_class->constructed = gst_bus_constructed;
 
   /**
    * GstBus::enable-async:
@@ -227,7 +223,10 @@ gst_bus_init (GstBus * bus)
   bus->priv = G_TYPE_INSTANCE_GET_PRIVATE (bus, GST_TYPE_BUS, GstBusPrivate);
   bus->priv->enable_async = DEFAULT_ENABLE_ASYNC;
   g_mutex_init (&bus->priv->queue_lock);
+  g_cond_init (&bus->priv->cond);
   bus->priv->queue = gst_atomic_queue_new (32);
+  bus->priv->message_types = GST_MESSAGE_ANY;
+  bus->priv->coalesce_types = 0;
 
   GST_DEBUG_OBJECT (bus, "created");
 }
@@ -248,8 +247,13 @@ gst_bus_dispose (GObject * object)
     } while (message != NULL);
     gst_atomic_queue_unref (bus->priv->queue);
     bus->priv->queue = NULL;
+    if (bus->priv->coalesce) {
+      g_hash_table_destroy (bus->priv->coalesce);
+      bus->priv->coalesce = NULL;
+    }
     g_mutex_unlock (&bus->priv->queue_lock);
     g_mutex_clear (&bus->priv->queue_lock);
+    g_cond_clear (&bus->priv->cond);
 
     if (bus->priv->poll)
       gst_poll_free (bus->priv->poll);
@@ -291,6 +295,146 @@ gst_bus_new (void)
   return result;
 }
 
+/* create the poll when it is needed for the first time, with one control
+ * for each queued message. should be called with the queue_lock */
+static void
+gst_bus_ensure_poll (GstBus * bus)
+{
+  GstPoll *poll;
+  guint i, len;
+
+  if (bus->priv->poll)
+    return;
+
+  GST_DEBUG_OBJECT (bus, "creating poll");
+  poll = gst_poll_new_timer ();
+  gst_poll_get_read_gpollfd (poll, &bus->priv->pollfd);
+  len = gst_atomic_queue_length (bus->priv->queue);
+  for (i = 0; i < len; i++)
+    gst_poll_write_control (poll);
+  g_atomic_pointer_set (&bus->priv->poll, poll);
+
+  /* the waiters have to wait on the poll from now on */
+  g_cond_broadcast (&bus->priv->cond);
+}
+
+/* wake up the threads waiting for a message. should be called with the
+ * queue_lock */
+static inline void
+gst_bus_wakeup (GstBus * bus)
+{
+  if (bus->priv->poll)
+    gst_poll_write_control (bus->priv->poll);
+  else if (bus->priv->num_waiters)
+    g_cond_broadcast (&bus->priv->cond);
+}
+
+/* push @message on the queue and wake up the waiters */
+static void
+gst_bus_push (GstBus * bus, GstMessage * message)
+{
+  GstPoll *poll;
+
+  /* once there is a poll, it never goes away and we don't need the lock */
+  if (G_LIKELY ((poll = g_atomic_pointer_get (&bus->priv->poll)))) {
+    gst_atomic_queue_push (bus->priv->queue, message);
+    gst_poll_write_control (poll);
+    return;
+  }
+
+  g_mutex_lock (&bus->priv->queue_lock);
+  gst_atomic_queue_push (bus->priv->queue, message);
+  gst_bus_wakeup (bus);
+  g_mutex_unlock (&bus->priv->queue_lock);
+}
+
+static inline gboolean
+message_type_matches (GstMessageType type, GstMessageType types)
+{
+  /* extended types only match when asked for, like in
+   * gst_bus_timed_pop_filtered() */
+  return (type & types) != 0 && (!(type & GST_MESSAGE_EXTENDED)
+      || (types & GST_MESSAGE_EXTENDED));
+}
+
+gboolean
+_priv_gst_bus_accepts_message_type (GstBus * bus, GstMessageType type)
+{
+  gboolean res;
+
+  GST_OBJECT_LOCK (bus);
+  res = message_type_matches (type, bus->priv->message_types);
+  GST_OBJECT_UNLOCK (bus);
+
+  return res;
+}
+
+/* only these message types have structures with different names */
+#define NAMED_MESSAGES (GST_MESSAGE_APPLICATION | GST_MESSAGE_ELEMENT)
+
+/* messages that can replace each other */
+static guint
+coalesce_hash (gconstpointer key)
+{
+  GstMessage *message = (GstMessage *) key;
+  const GstStructure *s;
+  guint hash;
+
+  hash = g_direct_hash (GST_MESSAGE_SRC (message)) ^ GST_MESSAGE_TYPE (message);
+  if ((GST_MESSAGE_TYPE (message) & NAMED_MESSAGES) &&
+      (s = gst_message_get_structure (message)))
+    hash ^= gst_structure_get_name_id (s);
+
+  return hash;
+}
+
+static gboolean
+coalesce_equal (gconstpointer a, gconstpointer b)
+{
+  GstMessage *ma = (GstMessage *) a, *mb = (GstMessage *) b;
+  const GstStructure *sa, *sb;
+
+  if (GST_MESSAGE_SRC (ma) != GST_MESSAGE_SRC (mb) ||
+      GST_MESSAGE_TYPE (ma) != GST_MESSAGE_TYPE (mb))
+    return FALSE;
+
+  /* don't create the structures of the other messages, their name only
+   * depends on the type */
+  if (!(GST_MESSAGE_TYPE (ma) & NAMED_MESSAGES))
+    return TRUE;
+
+  sa = gst_message_get_structure (ma);
+  sb = gst_message_get_structure (mb);
+  if (sa == NULL || sb == NULL)
+    return sa == sb;
+
+  return gst_structure_get_name_id (sa) == gst_structure_get_name_id (sb);
+}
+
+/* queue @message or let it replace a queued message of the same kind that
+ * nobody looked at yet */
+static void
+gst_bus_push_coalesced (GstBus * bus, GstMessage * message)
+{
+  GstMessage *queued;
+
+  g_mutex_lock (&bus->priv->queue_lock);
+  queued = g_hash_table_lookup (bus->priv->coalesce, message);
+  if (queued && gst_message_is_writable (queued)) {
+    GST_DEBUG_OBJECT (bus, "[msg %p] replacing queued message %p", message,
+        queued);
+    _priv_gst_message_take_contents (queued, message);
+    g_mutex_unlock (&bus->priv->queue_lock);
+    gst_message_unref (message);
+    return;
+  }
+  GST_DEBUG_OBJECT (bus, "[msg %p] pushing on async queue", message);
+  gst_atomic_queue_push (bus->priv->queue, message);
+  g_hash_table_add (bus->priv->coalesce, message);
+  gst_bus_wakeup (bus);
+  g_mutex_unlock (&bus->priv->queue_lock);
+}
+
 /**
  * gst_bus_post:
  * @bus: a #GstBus to post on
@@ -309,6 +453,7 @@ gst_bus_post (GstBus * bus, GstMessage * message)
   GstBusSyncReply reply = GST_BUS_PASS;
   GstBusSyncHandler handler;
   gboolean emit_sync_message;
+  gboolean coalesce;
   gpointer handler_data;
 
   g_return_val_if_fail (GST_IS_BUS (bus), FALSE);
@@ -321,11 +466,17 @@ gst_bus_post (GstBus * bus, GstMessage * message)
   g_assert (!GST_MINI_OBJECT_FLAG_IS_SET (message,
           GST_MESSAGE_FLAG_ASYNC_DELIVERY));
 
-  GST_OBJECT_LOCK (bus);
+  GST_OBJECT_LOCK_TRACED (bus);
   /* check if the bus is flushing */
   if (GST_OBJECT_FLAG_IS_SET (bus, GST_BUS_FLUSHING))
     goto is_flushing;
 
+  if (!message_type_matches (GST_MESSAGE_TYPE (message),
+          bus->priv->message_types))
+    goto filtered;
+
+  coalesce = message_type_matches (GST_MESSAGE_TYPE (message),
+      bus->priv->coalesce_types);
   handler = bus->priv->sync_handler;
   handler_data = bus->priv->sync_handler_data;
   emit_sync_message = bus->priv->num_sync_message_emitters > 0;
@@ -343,7 +494,7 @@ gst_bus_post (GstBus * bus, GstMessage * message)
 
   /* If this is a bus without async message delivery
    * always drop the message */
-  if (!bus->priv->poll)
+  if (!bus->priv->enable_async)
     reply = GST_BUS_DROP;
 
   /* now see what we should do with the message */
@@ -353,10 +504,13 @@ gst_bus_post (GstBus * bus, GstMessage * message)
       GST_DEBUG_OBJECT (bus, "[msg %p] dropped", message);
       break;
     case GST_BUS_PASS:
+      if (coalesce) {
+        gst_bus_push_coalesced (bus, message);
+        break;
+      }
       /* pass the message to the async queue, refcount passed in the queue */
       GST_DEBUG_OBJECT (bus, "[msg %p] pushing on async queue", message);
-      gst_atomic_queue_push (bus->priv->queue, message);
-      gst_poll_write_control (bus->priv->poll);
+      gst_bus_push (bus, message);
       GST_DEBUG_OBJECT (bus, "[msg %p] pushed on async queue", message);
 
       break;
@@ -379,8 +533,7 @@ gst_bus_post (GstBus * bus, GstMessage * message)
        * the cond will be signalled and we can continue */
       g_mutex_lock (lock);
 
-      gst_atomic_queue_push (bus->priv->queue, message);
-      gst_poll_write_control (bus->priv->poll);
+      gst_bus_push (bus, message);
 
       /* now block till the message is freed */
       g_cond_wait (cond, lock);
@@ -413,6 +566,121 @@ is_flushing:
 
     return FALSE;
   }
+filtered:
+  {
+    GST_DEBUG_OBJECT (bus, "[msg %p] filtered", message);
+    GST_OBJECT_UNLOCK (bus);
+    gst_message_unref (message);
+
+    return TRUE;
+  }
+}
+
+/**
+ * gst_bus_set_message_types:
+ * @bus: a #GstBus
+ * @types: the message types to accept
+ *
+ * Sets the types of the messages @bus accepts. Messages of other types are
+ * dropped by gst_bus_post() before the sync handler is called, the default is
+ * to accept all messages.
+ *
+ * Elements can check with gst_element_accepts_message_type() if a message
+ * would be delivered before they create it.
+ *
+ * Since: 1.14
+ */
+void
+gst_bus_set_message_types (GstBus * bus, GstMessageType types)
+{
+  g_return_if_fail (GST_IS_BUS (bus));
+
+  GST_OBJECT_LOCK (bus);
+  bus->priv->message_types = types;
+  GST_OBJECT_UNLOCK (bus);
+}
+
+/**
+ * gst_bus_get_message_types:
+ * @bus: a #GstBus
+ *
+ * Gets the types of the messages @bus accepts, see
+ * gst_bus_set_message_types().
+ *
+ * Returns: the accepted message types.
+ *
+ * Since: 1.14
+ */
+GstMessageType
+gst_bus_get_message_types (GstBus * bus)
+{
+  GstMessageType types;
+
+  g_return_val_if_fail (GST_IS_BUS (bus), 0);
+
+  GST_OBJECT_LOCK (bus);
+  types = bus->priv->message_types;
+  GST_OBJECT_UNLOCK (bus);
+
+  return types;
+}
+
+/**
+ * gst_bus_set_coalesce_types:
+ * @bus: a #GstBus
+ * @types: the message types to coalesce
+ *
+ * Sets the types of the messages that are coalesced on @bus. When a message
+ * of one of these types is posted while a message of the same type, with the
+ * same source and structure name, is still queued and was not peeked, the
+ * queued message gets the contents of the new one instead of queueing
+ * another message.
+ *
+ * This is useful for messages that report a current value, like
+ * #GST_MESSAGE_QOS, #GST_MESSAGE_BUFFERING or #GST_MESSAGE_PROGRESS, when the
+ * application handles them slower than they are posted. The newer message
+ * then takes the place of the queued one in the order of the messages.
+ *
+ * Since: 1.14
+ */
+void
+gst_bus_set_coalesce_types (GstBus * bus, GstMessageType types)
+{
+  g_return_if_fail (GST_IS_BUS (bus));
+
+  g_mutex_lock (&bus->priv->queue_lock);
+  if (types && !bus->priv->coalesce)
+    bus->priv->coalesce = g_hash_table_new (coalesce_hash, coalesce_equal);
+  g_mutex_unlock (&bus->priv->queue_lock);
+
+  GST_OBJECT_LOCK (bus);
+  bus->priv->coalesce_types = types;
+  GST_OBJECT_UNLOCK (bus);
+}
+
+/**
+ * gst_bus_get_coalesce_types:
+ * @bus: a #GstBus
+ *
+ * Gets the types of the messages that are coalesced on @bus, see
+ * gst_bus_set_coalesce_types().
+ *
+ * Returns: the coalesced message types.
+ *
+ * Since: 1.14
+ */
+GstMessageType
+gst_bus_get_coalesce_types (GstBus * bus)
+{
+  GstMessageType types;
+
+  g_return_val_if_fail (GST_IS_BUS (bus), 0);
+
+  GST_OBJECT_LOCK (bus);
+  types = bus->priv->coalesce_types;
+  GST_OBJECT_UNLOCK (bus);
+
+  return types;
 }
 
 /**
@@ -511,7 +779,7 @@ gst_bus_timed_pop_filtered (GstBus * bus, GstClockTime timeout,
 
   g_return_val_if_fail (GST_IS_BUS (bus), NULL);
   g_return_val_if_fail (types != 0, NULL);
-  g_return_val_if_fail (timeout == 0 || bus->priv->poll != NULL, NULL);
+  g_return_val_if_fail (timeout == 0 || bus->priv->enable_async, NULL);
 
   g_mutex_lock (&bus->priv->queue_lock);
 
@@ -522,6 +790,14 @@ gst_bus_timed_pop_filtered (GstBus * bus, GstClockTime timeout,
         gst_atomic_queue_length (bus->priv->queue));
 
     while ((message = gst_atomic_queue_pop (bus->priv->queue))) {
+      if (bus->priv->coalesce) {
+        gpointer key;
+
+        /* a newer message of the same kind can't replace this one anymore */
+        if (g_hash_table_lookup_extended (bus->priv->coalesce, message, &key,
+                NULL) && key == message)
+          g_hash_table_remove (bus->priv->coalesce, message);
+      }
       if (bus->priv->poll) {
         while (!gst_poll_read_control (bus->priv->poll)) {
           if (errno == EWOULDBLOCK) {
@@ -578,10 +854,22 @@ gst_bus_timed_pop_filtered (GstBus * bus, GstClockTime timeout,
     }
 
     /* only here in timeout case */
-    g_assert (bus->priv->poll);
-    g_mutex_unlock (&bus->priv->queue_lock);
-    ret = gst_poll_wait (bus->priv->poll, timeout - elapsed);
-    g_mutex_lock (&bus->priv->queue_lock);
+    if (bus->priv->poll) {
+      g_mutex_unlock (&bus->priv->queue_lock);
+      ret = gst_poll_wait (bus->priv->poll, timeout - elapsed);
+      g_mutex_lock (&bus->priv->queue_lock);
+    } else {
+      /* nobody polls the bus, posting signals the cond */
+      bus->priv->num_waiters++;
+      if (timeout == GST_CLOCK_TIME_NONE) {
+        g_cond_wait (&bus->priv->cond, &bus->priv->queue_lock);
+        ret = 1;
+      } else {
+        ret = g_cond_wait_until (&bus->priv->cond, &bus->priv->queue_lock,
+            g_get_monotonic_time () + (timeout - elapsed) / GST_USECOND);
+      }
+      bus->priv->num_waiters--;
+    }
 
     if (ret == 0) {
       GST_INFO_OBJECT (bus, "timed out, breaking loop");
@@ -771,6 +1059,10 @@ no_replace:
  * into other event loops based on file descriptors.
  * Whenever a message is available, the %POLLIN / %G_IO_IN event is set.
  *
+ * The file descriptor is only created by the first call of this function or
+ * of gst_bus_create_watch(), buses that are only used with gst_bus_pop() and
+ * similar functions don't need one.
+ *
  * Warning: NEVER read or write anything to the returned fd but only use it
  * for getting notifications via g_poll() or similar and then use the normal
  * GstBus API, e.g. gst_bus_pop().
@@ -781,9 +1073,12 @@ void
 gst_bus_get_pollfd (GstBus * bus, GPollFD * fd)
 {
   g_return_if_fail (GST_IS_BUS (bus));
-  g_return_if_fail (bus->priv->poll != NULL);
+  g_return_if_fail (bus->priv->enable_async);
 
+  g_mutex_lock (&bus->priv->queue_lock);
+  gst_bus_ensure_poll (bus);
   *fd = bus->priv->pollfd;
+  g_mutex_unlock (&bus->priv->queue_lock);
 }
 
 /* GSource for the bus
@@ -792,6 +1087,11 @@ typedef struct
 {
   GSource source;
   GstBus *bus;
+
+  /* for batch watches, the maximum number of messages per dispatch or 0 for
+   * no limit and the array of popped messages */
+  guint max_messages;
+  GPtrArray *batch;
 } GstBusSource;
 
 static gboolean
@@ -854,6 +1154,60 @@ no_handler:
   }
 }
 
+static gboolean
+gst_bus_batch_source_dispatch (GSource * source, GSourceFunc callback,
+    gpointer user_data)
+{
+  GstBusBatchFunc handler = (GstBusBatchFunc) callback;
+  GstBusSource *bsource = (GstBusSource *) source;
+  GstMessage *message;
+  gboolean keep;
+  GstBus *bus;
+  guint i, max;
+
+  g_return_val_if_fail (bsource != NULL, FALSE);
+
+  bus = bsource->bus;
+
+  g_return_val_if_fail (GST_IS_BUS (bus), FALSE);
+
+  /* don't take the messages that are posted while we pop, or the dispatch
+   * might never end */
+  max = gst_atomic_queue_length (bus->priv->queue);
+  if (bsource->max_messages)
+    max = MIN (max, bsource->max_messages);
+
+  for (i = 0; i < max && (message = gst_bus_pop (bus)); i++)
+    g_ptr_array_add (bsource->batch, message);
+
+  /* The message queue might be empty if some other thread or callback set
+   * the bus to flushing between check/prepare and dispatch */
+  if (G_UNLIKELY (bsource->batch->len == 0))
+    return TRUE;
+
+  if (!handler)
+    goto no_handler;
+
+  GST_DEBUG_OBJECT (bus, "source %p calling dispatch with %u messages",
+      source, bsource->batch->len);
+
+  keep = handler (bus, (GstMessage **) bsource->batch->pdata,
+      bsource->batch->len, user_data);
+  g_ptr_array_set_size (bsource->batch, 0);
+
+  GST_DEBUG_OBJECT (bus, "source %p handler returns %d", source, keep);
+
+  return keep;
+
+no_handler:
+  {
+    g_warning ("GstBus watch dispatched without callback\n"
+        "You must call g_source_set_callback().");
+    g_ptr_array_set_size (bsource->batch, 0);
+    return FALSE;
+  }
+}
+
 static void
 gst_bus_source_finalize (GSource * source)
 {
@@ -871,6 +1225,10 @@ gst_bus_source_finalize (GSource * source)
 
   gst_object_unref (bsource->bus);
   bsource->bus = NULL;
+  if (bsource->batch) {
+    g_ptr_array_unref (bsource->batch);
+    bsource->batch = NULL;
+  }
 }
 
 static GSourceFuncs gst_bus_source_funcs = {
@@ -880,6 +1238,32 @@ static GSourceFuncs gst_bus_source_funcs = {
   gst_bus_source_finalize
 };
 
+static GSourceFuncs gst_bus_batch_source_funcs = {
+  gst_bus_source_prepare,
+  gst_bus_source_check,
+  gst_bus_batch_source_dispatch,
+  gst_bus_source_finalize
+};
+
+static GSource *
+gst_bus_create_watch_with_funcs (GstBus * bus, GSourceFuncs * funcs)
+{
+  GstBusSource *source;
+
+  g_mutex_lock (&bus->priv->queue_lock);
+  gst_bus_ensure_poll (bus);
+  g_mutex_unlock (&bus->priv->queue_lock);
+
+  source = (GstBusSource *) g_source_new (funcs, sizeof (GstBusSource));
+
+  g_source_set_name ((GSource *) source, "GStreamer message bus watch");
+
+  source->bus = gst_object_ref (bus);
+  g_source_add_poll ((GSource *) source, &bus->priv->pollfd);
+
+  return (GSource *) source;
+}
+
 /**
  * gst_bus_create_watch:
  * @bus: a #GstBus to create the watch for
@@ -893,47 +1277,62 @@ static GSourceFuncs gst_bus_source_funcs = {
 GSource *
 gst_bus_create_watch (GstBus * bus)
 {
-  GstBusSource *source;
-
   g_return_val_if_fail (GST_IS_BUS (bus), NULL);
-  g_return_val_if_fail (bus->priv->poll != NULL, NULL);
+  g_return_val_if_fail (bus->priv->enable_async, NULL);
 
-  source = (GstBusSource *) g_source_new (&gst_bus_source_funcs,
-      sizeof (GstBusSource));
+  return gst_bus_create_watch_with_funcs (bus, &gst_bus_source_funcs);
+}
 
-  g_source_set_name ((GSource *) source, "GStreamer message bus watch");
+/**
+ * gst_bus_create_batch_watch:
+ * @bus: a #GstBus to create the watch for
+ * @max_messages: the maximum number of messages per dispatch, or 0
+ *
+ * Create a watch for this bus that dispatches all messages that are queued
+ * on the bus at once, up to @max_messages, instead of one message per main
+ * loop iteration. The callback of the GSource is a #GstBusBatchFunc. After
+ * it returns, the messages are unreffed.
+ *
+ * Returns: (transfer full): a #GSource that can be added to a mainloop.
+ *
+ * Since: 1.14
+ */
+GSource *
+gst_bus_create_batch_watch (GstBus * bus, guint max_messages)
+{
+  GstBusSource *source;
 
-  source->bus = gst_object_ref (bus);
-  g_source_add_poll ((GSource *) source, &bus->priv->pollfd);
+  g_return_val_if_fail (GST_IS_BUS (bus), NULL);
+  g_return_val_if_fail (bus->priv->enable_async, NULL);
+
+  source = (GstBusSource *) gst_bus_create_watch_with_funcs (bus,
+      &gst_bus_batch_source_funcs);
+  source->max_messages = max_messages;
+  source->batch = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_message_unref);
 
   return (GSource *) source;
 }
 
 /* must be called with the bus OBJECT LOCK */
 static guint
-gst_bus_add_watch_full_unlocked (GstBus * bus, gint priority,
-    GstBusFunc func, gpointer user_data, GDestroyNotify notify)
+gst_bus_attach_watch_unlocked (GstBus * bus, GSource * source, gint priority,
+    GSourceFunc func, gpointer user_data, GDestroyNotify notify)
 {
   GMainContext *ctx;
   guint id;
-  GSource *source;
 
   if (bus->priv->signal_watch) {
     GST_ERROR_OBJECT (bus,
         "Tried to add new watch while one was already there");
-    return 0;
-  }
-
-  source = gst_bus_create_watch (bus);
-  if (!source) {
-    g_critical ("Creating bus watch failed");
+    g_source_unref (source);
     return 0;
   }
 
   if (priority != G_PRIORITY_DEFAULT)
     g_source_set_priority (source, priority);
 
-  g_source_set_callback (source, (GSourceFunc) func, user_data, notify);
+  g_source_set_callback (source, func, user_data, notify);
 
   ctx = g_main_context_get_thread_default ();
   id = g_source_attach (source, ctx);
@@ -947,6 +1346,29 @@ gst_bus_add_watch_full_unlocked (GstBus * bus, gint priority,
   return id;
 }
 
+/* must be called with the bus OBJECT LOCK */
+static guint
+gst_bus_add_watch_full_unlocked (GstBus * bus, gint priority,
+    GstBusFunc func, gpointer user_data, GDestroyNotify notify)
+{
+  GSource *source;
+
+  if (bus->priv->signal_watch) {
+    GST_ERROR_OBJECT (bus,
+        "Tried to add new watch while one was already there");
+    return 0;
+  }
+
+  source = gst_bus_create_watch (bus);
+  if (!source) {
+    g_critical ("Creating bus watch failed");
+    return 0;
+  }
+
+  return gst_bus_attach_watch_unlocked (bus, source, priority,
+      (GSourceFunc) func, user_data, notify);
+}
+
 /**
  * gst_bus_add_watch_full: (rename-to gst_bus_add_watch)
  * @bus: a #GstBus to create the watch for.
@@ -993,6 +1415,48 @@ gst_bus_add_watch_full (GstBus * bus, gint priority,
   return id;
 }
 
+/**
+ * gst_bus_add_batch_watch_full:
+ * @bus: a #GstBus to create the watch for.
+ * @priority: The priority of the watch.
+ * @max_messages: the maximum number of messages per call of @func, or 0
+ * @func: A function to call when messages are received.
+ * @user_data: user data passed to @func.
+ * @notify: the function to call when the source is removed.
+ *
+ * Like gst_bus_add_watch_full() but @func is called with all messages that
+ * are queued on the bus, up to @max_messages, at once. This takes fewer main
+ * loop iterations when many messages are posted in a short time.
+ *
+ * There can only be a single bus watch per bus, this includes the watches
+ * added with gst_bus_add_watch_full(). The watch can be removed using
+ * gst_bus_remove_watch() or by returning %FALSE from @func.
+ *
+ * MT safe.
+ *
+ * Returns: The event source id or 0 if @bus already got an event source.
+ *
+ * Since: 1.14
+ */
+guint
+gst_bus_add_batch_watch_full (GstBus * bus, gint priority, guint max_messages,
+    GstBusBatchFunc func, gpointer user_data, GDestroyNotify notify)
+{
+  GSource *source;
+  guint id;
+
+  g_return_val_if_fail (GST_IS_BUS (bus), 0);
+  g_return_val_if_fail (bus->priv->enable_async, 0);
+
+  GST_OBJECT_LOCK (bus);
+  source = gst_bus_create_batch_watch (bus, max_messages);
+  id = gst_bus_attach_watch_unlocked (bus, source, priority,
+      (GSourceFunc) func, user_data, notify);
+  GST_OBJECT_UNLOCK (bus);
+
+  return id;
+}
+
 /**
  * gst_bus_add_watch: (skip)
  * @bus: a #GstBus to create the watch for
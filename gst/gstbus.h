@@ -105,6 +105,26 @@ typedef GstBusSyncReply (*GstBusSyncHandler)    (GstBus * bus, GstMessage * mess
  */
 typedef gboolean        (*GstBusFunc)           (GstBus * bus, GstMessage * message, gpointer user_data);
 
+/**
+ * GstBusBatchFunc:
+ * @bus: the #GstBus that sent the messages
+ * @messages: (array length=n_messages): the #GstMessage<!-- -->s
+ * @n_messages: the number of messages
+ * @user_data: user data that has been given, when registering the handler
+ *
+ * Specifies the type of function passed to gst_bus_add_batch_watch_full(),
+ * which is called from the mainloop with the messages that are available on
+ * the bus, in the order they were posted.
+ *
+ * The messages will be unreffed after execution of this function so they
+ * should not be freed in the function.
+ *
+ * Returns: %FALSE if the event source should be removed.
+ *
+ * Since: 1.14
+ */
+typedef gboolean        (*GstBusBatchFunc)      (GstBus * bus, GstMessage ** messages, guint n_messages, gpointer user_data);
+
 /**
  * GstBus:
  *
@@ -162,6 +182,18 @@ GstMessage *            gst_bus_timed_pop_filtered      (GstBus * bus, GstClockT
 GST_EXPORT
 void                    gst_bus_set_flushing            (GstBus * bus, gboolean flushing);
 
+GST_EXPORT
+void                    gst_bus_set_message_types       (GstBus * bus, GstMessageType types);
+
+GST_EXPORT
+GstMessageType          gst_bus_get_message_types       (GstBus * bus);
+
+GST_EXPORT
+void                    gst_bus_set_coalesce_types      (GstBus * bus, GstMessageType types);
+
+GST_EXPORT
+GstMessageType          gst_bus_get_coalesce_types      (GstBus * bus);
+
 /* synchronous dispatching */
 
 GST_EXPORT
@@ -191,6 +223,17 @@ guint                   gst_bus_add_watch               (GstBus * bus,
 GST_EXPORT
 gboolean                gst_bus_remove_watch            (GstBus * bus);
 
+GST_EXPORT
+GSource *               gst_bus_create_batch_watch      (GstBus * bus, guint max_messages);
+
+GST_EXPORT
+guint                   gst_bus_add_batch_watch_full    (GstBus * bus,
+                                                         gint priority,
+                                                         guint max_messages,
+                                                         GstBusBatchFunc func,
+                                                         gpointer user_data,
+                                                         GDestroyNotify notify);
+
 /* polling the bus */
 
 GST_EXPORT
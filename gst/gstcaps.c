@@ -63,6 +63,7 @@
 #include "config.h"
 #endif
 #include <string.h>
+#include <stdlib.h>
 #include <signal.h>
 
 #include "gst_private.h"
@@ -102,6 +103,21 @@ typedef struct _GstCapsImpl
 #define CAPS_IS_EMPTY_SIMPLE(caps)					\
   ((GST_CAPS_ARRAY (caps) == NULL) || (GST_CAPS_LEN (caps) == 0))
 
+/* set on caps that are used as input of an entry in the caps cache */
+#define CAPS_FLAG_CACHED (GST_MINI_OBJECT_FLAG_LAST << 15)
+/* set on caps that are in the table of static caps */
+#define CAPS_FLAG_INTERNED (GST_MINI_OBJECT_FLAG_LAST << 14)
+/* private flags that are not copied */
+#define CAPS_FLAGS_PRIVATE (CAPS_FLAG_CACHED | CAPS_FLAG_INTERNED)
+
+/* call before modifying @caps, removes the cached results computed from the
+ * previous content of @caps */
+#define CAPS_CACHE_CHECK(caps) G_STMT_START {                            \
+  if (G_UNLIKELY (GST_CAPS_FLAGS (caps) & CAPS_FLAG_CACHED) &&           \
+      IS_WRITABLE (caps))                                                \
+    gst_caps_cache_remove_caps (caps);                                   \
+}G_STMT_END
+
 #define gst_caps_features_copy_conditional(f) ((f && (gst_caps_features_is_any (f) || !gst_caps_features_is_equal (f, GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY))) ? gst_caps_features_copy (f) : NULL)
 
 /* quick way to get a caps structure at an index without doing a type or array
@@ -115,6 +131,7 @@ typedef struct _GstCapsImpl
 /* quick way to append a structure without checking the args */
 #define gst_caps_append_structure_unchecked(caps, s, f) G_STMT_START{\
   GstCapsArrayElement __e={s, f};                                      \
+  CAPS_CACHE_CHECK (caps);                                             \
   if (gst_structure_set_parent_refcount (__e.structure, &GST_MINI_OBJECT_REFCOUNT(caps)) && \
       (!__e.features || gst_caps_features_set_parent_refcount (__e.features, &GST_MINI_OBJECT_REFCOUNT(caps))))         \
     g_array_append_val (GST_CAPS_ARRAY (caps), __e);                             \
@@ -122,6 +139,11 @@ typedef struct _GstCapsImpl
 
 /* lock to protect multiple invocations of static caps to caps conversion */
 G_LOCK_DEFINE_STATIC (static_caps_lock);
+/* caps string -> caps, shared by all static caps with the same string. The
+ * table does not own a reference, caps remove themselves when freed. */
+static GHashTable *static_caps_table = NULL;
+/* caps -> caps string, to remove the caps from the table */
+static GHashTable *static_caps_strings = NULL;
 
 static void gst_caps_transform_to_string (const GValue * src_value,
     GValue * dest_value);
@@ -134,11 +156,251 @@ GstCaps *_gst_caps_none;
 
 GST_DEFINE_MINI_OBJECT_TYPE (GstCaps, gst_caps);
 
+/* Cache for the results of intersecting and comparing caps. During
+ * negotiation the same (template) caps are intersected over and over again.
+ * The cache is keyed on the identity of the caps, which is only valid as long
+ * as the caps are not modified, so only caps that are not writable are used
+ * as keys and their entries are removed again when the caps are freed or
+ * modified after becoming writable again.
+ *
+ * The cache is disabled by default and enabled by setting the
+ * GST_CAPS_CACHE_SIZE environment variable to the number of results to keep.
+ * Note that cached intersections are returned as a new reference to a shared
+ * caps that is not writable. */
+typedef enum
+{
+  CAPS_CACHE_INTERSECT_ZIG_ZAG,
+  CAPS_CACHE_INTERSECT_FIRST,
+  CAPS_CACHE_CAN_INTERSECT,
+  CAPS_CACHE_IS_SUBSET
+} GstCapsCacheOp;
+
+typedef struct
+{
+  /* link in the LRU queue, data points to the entry */
+  GList link;
+
+  GstCapsCacheOp op;
+  const GstCaps *caps1;
+  const GstCaps *caps2;
+
+  GstCaps *result;
+  gboolean bool_result;
+} GstCapsCacheEntry;
+
+static GMutex caps_cache_lock;
+static GHashTable *caps_cache = NULL;
+static GQueue caps_cache_lru = G_QUEUE_INIT;
+static guint caps_cache_size = 0;
+
+/* caps -> serialized caps for the debug log, only for caps that are not
+ * writable. Also protected by the caps cache lock and always enabled */
+static GHashTable *caps_descriptions = NULL;
+
+#define CAPS_CACHE_ENABLED(caps1, caps2) \
+  (G_UNLIKELY (caps_cache_size > 0) && \
+   !IS_WRITABLE (caps1) && !IS_WRITABLE (caps2))
+
+static guint
+gst_caps_cache_entry_hash (gconstpointer key)
+{
+  const GstCapsCacheEntry *entry = key;
+
+  return (g_direct_hash (entry->caps1) * 31 +
+      g_direct_hash (entry->caps2)) * 31 + entry->op;
+}
+
+static gboolean
+gst_caps_cache_entry_equal (gconstpointer a, gconstpointer b)
+{
+  const GstCapsCacheEntry *entry1 = a, *entry2 = b;
+
+  return entry1->op == entry2->op && entry1->caps1 == entry2->caps1 &&
+      entry1->caps2 == entry2->caps2;
+}
+
+/* call with the caps cache lock, returns the result caps of the entry that
+ * must be unreffed after releasing the lock */
+static GstCaps *
+gst_caps_cache_remove_entry (GstCapsCacheEntry * entry)
+{
+  GstCaps *result = entry->result;
+
+  g_queue_unlink (&caps_cache_lru, &entry->link);
+  g_hash_table_remove (caps_cache, entry);
+  g_slice_free (GstCapsCacheEntry, entry);
+
+  return result;
+}
+
+/* remove all entries that use @caps as input */
+static void
+gst_caps_cache_remove_caps (const GstCaps * caps)
+{
+  GList *l, *next;
+  GSList *results = NULL;
+
+  g_mutex_lock (&caps_cache_lock);
+  for (l = caps_cache_lru.head; l; l = next) {
+    GstCapsCacheEntry *entry = l->data;
+
+    next = l->next;
+    if (entry->caps1 == caps || entry->caps2 == caps) {
+      GstCaps *result = gst_caps_cache_remove_entry (entry);
+
+      if (result)
+        results = g_slist_prepend (results, result);
+    }
+  }
+  if (caps_descriptions)
+    g_hash_table_remove (caps_descriptions, caps);
+  GST_CAPS_FLAGS (caps) &= ~CAPS_FLAG_CACHED;
+  g_mutex_unlock (&caps_cache_lock);
+
+  /* the results can be used as input of other entries as well */
+  g_slist_free_full (results, (GDestroyNotify) gst_caps_unref);
+}
+
+static gboolean
+gst_caps_cache_lookup (GstCapsCacheOp op, const GstCaps * caps1,
+    const GstCaps * caps2, GstCaps ** result, gboolean * bool_result)
+{
+  GstCapsCacheEntry key, *entry;
+
+  key.op = op;
+  key.caps1 = caps1;
+  key.caps2 = caps2;
+
+  g_mutex_lock (&caps_cache_lock);
+  entry = g_hash_table_lookup (caps_cache, &key);
+  if (entry) {
+    /* move to the front of the LRU queue */
+    g_queue_unlink (&caps_cache_lru, &entry->link);
+    g_queue_push_head_link (&caps_cache_lru, &entry->link);
+
+    if (result)
+      *result = gst_caps_ref (entry->result);
+    if (bool_result)
+      *bool_result = entry->bool_result;
+  }
+  g_mutex_unlock (&caps_cache_lock);
+
+  return entry != NULL;
+}
+
+static void
+gst_caps_cache_insert (GstCapsCacheOp op, const GstCaps * caps1,
+    const GstCaps * caps2, GstCaps * result, gboolean bool_result)
+{
+  GstCapsCacheEntry *entry;
+  GstCaps *evicted = NULL;
+
+  entry = g_slice_new (GstCapsCacheEntry);
+  entry->link.data = entry;
+  entry->link.prev = entry->link.next = NULL;
+  entry->op = op;
+  entry->caps1 = caps1;
+  entry->caps2 = caps2;
+  entry->result = result ? gst_caps_ref (result) : NULL;
+  entry->bool_result = bool_result;
+
+  g_mutex_lock (&caps_cache_lock);
+  if (g_hash_table_contains (caps_cache, entry)) {
+    /* another thread was faster */
+    g_mutex_unlock (&caps_cache_lock);
+    if (entry->result)
+      gst_caps_unref (entry->result);
+    g_slice_free (GstCapsCacheEntry, entry);
+    return;
+  }
+
+  if (caps_cache_lru.length >= caps_cache_size)
+    evicted = gst_caps_cache_remove_entry (caps_cache_lru.tail->data);
+
+  g_hash_table_add (caps_cache, entry);
+  g_queue_push_head_link (&caps_cache_lru, &entry->link);
+  GST_CAPS_FLAGS (caps1) |= CAPS_FLAG_CACHED;
+  GST_CAPS_FLAGS (caps2) |= CAPS_FLAG_CACHED;
+  g_mutex_unlock (&caps_cache_lock);
+
+  if (evicted)
+    gst_caps_unref (evicted);
+}
+
+static void
+gst_caps_cache_clear (void)
+{
+  GstCaps *result;
+
+  g_mutex_lock (&caps_cache_lock);
+  while (caps_cache_lru.length > 0) {
+    result = gst_caps_cache_remove_entry (caps_cache_lru.tail->data);
+    if (result) {
+      g_mutex_unlock (&caps_cache_lock);
+      gst_caps_unref (result);
+      g_mutex_lock (&caps_cache_lock);
+    }
+  }
+  g_mutex_unlock (&caps_cache_lock);
+}
+
+/*
+ * _priv_gst_caps_describe:
+ * @caps: a #GstCaps
+ *
+ * Serializes @caps like gst_caps_to_string() for the debug log. The string
+ * of caps that are not writable is kept until the caps are freed or modified
+ * after becoming writable again, so that logging the same caps over and over
+ * again only copies the string.
+ *
+ * Returns: a newly allocated string, free with g_free()
+ */
+gchar *
+_priv_gst_caps_describe (const GstCaps * caps)
+{
+  gchar *desc;
+
+  if (IS_WRITABLE (caps))
+    return gst_caps_to_string (caps);
+
+  g_mutex_lock (&caps_cache_lock);
+  desc = caps_descriptions ?
+      g_strdup (g_hash_table_lookup (caps_descriptions, caps)) : NULL;
+  g_mutex_unlock (&caps_cache_lock);
+  if (desc)
+    return desc;
+
+  desc = gst_caps_to_string (caps);
+
+  g_mutex_lock (&caps_cache_lock);
+  /* the caps might have become writable in the meantime */
+  if (!IS_WRITABLE (caps)) {
+    if (caps_descriptions == NULL)
+      caps_descriptions = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+    g_hash_table_insert (caps_descriptions, (gpointer) caps, g_strdup (desc));
+    GST_CAPS_FLAGS (caps) |= CAPS_FLAG_CACHED;
+  }
+  g_mutex_unlock (&caps_cache_lock);
+
+  return desc;
+}
+
 void
 _priv_gst_caps_initialize (void)
 {
+  const gchar *env;
+
   _gst_caps_type = gst_caps_get_type ();
 
+  if ((env = g_getenv ("GST_CAPS_CACHE_SIZE")) != NULL)
+    caps_cache_size = strtoul (env, NULL, 10);
+  if (caps_cache_size > 0) {
+    caps_cache = g_hash_table_new (gst_caps_cache_entry_hash,
+        gst_caps_cache_entry_equal);
+    GST_CAT_INFO (GST_CAT_PERFORMANCE, "using caps cache of %u entries",
+        caps_cache_size);
+  }
+
   _gst_caps_any = gst_caps_new_any ();
   _gst_caps_none = gst_caps_new_empty ();
 
@@ -149,6 +411,29 @@ _priv_gst_caps_initialize (void)
 void
 _priv_gst_caps_cleanup (void)
 {
+  if (caps_cache) {
+    gst_caps_cache_clear ();
+    g_hash_table_unref (caps_cache);
+    caps_cache = NULL;
+  }
+  caps_cache_size = 0;
+
+  g_mutex_lock (&caps_cache_lock);
+  if (caps_descriptions) {
+    g_hash_table_destroy (caps_descriptions);
+    caps_descriptions = NULL;
+  }
+  g_mutex_unlock (&caps_cache_lock);
+
+  G_LOCK (static_caps_lock);
+  if (static_caps_table) {
+    g_hash_table_destroy (static_caps_table);
+    static_caps_table = NULL;
+    g_hash_table_destroy (static_caps_strings);
+    static_caps_strings = NULL;
+  }
+  G_UNLOCK (static_caps_lock);
+
   gst_caps_unref (_gst_caps_any);
   _gst_caps_any = NULL;
   gst_caps_unref (_gst_caps_none);
@@ -161,6 +446,48 @@ __gst_caps_get_features_unchecked (const GstCaps * caps, guint idx)
   return gst_caps_get_features_unchecked (caps, idx);
 }
 
+static void
+gst_static_caps_table_remove (GstCaps * caps)
+{
+  const gchar *string;
+
+  G_LOCK (static_caps_lock);
+  if (static_caps_strings &&
+      (string = g_hash_table_lookup (static_caps_strings, caps))) {
+    /* the string might already map to newer caps */
+    if (g_hash_table_lookup (static_caps_table, string) == caps)
+      g_hash_table_remove (static_caps_table, string);
+    g_hash_table_remove (static_caps_strings, caps);
+  }
+  G_UNLOCK (static_caps_lock);
+}
+
+/* call with the static caps lock. Returns a new reference to the caps for
+ * @string or %NULL when there are none or they are being freed. */
+static GstCaps *
+gst_static_caps_table_lookup (const gchar * string)
+{
+  GstCaps *caps;
+  gint refcount;
+
+  if (static_caps_table == NULL)
+    return NULL;
+
+  caps = g_hash_table_lookup (static_caps_table, string);
+  if (caps == NULL)
+    return NULL;
+
+  /* only take a reference when the caps are not being freed */
+  do {
+    refcount = g_atomic_int_get (&GST_CAPS_REFCOUNT (caps));
+    if (refcount == 0)
+      return NULL;
+  } while (!g_atomic_int_compare_and_exchange (&GST_CAPS_REFCOUNT (caps),
+          refcount, refcount + 1));
+
+  return caps;
+}
+
 static GstCaps *
 _gst_caps_copy (const GstCaps * caps)
 {
@@ -172,7 +499,7 @@ _gst_caps_copy (const GstCaps * caps)
   g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
 
   newcaps = gst_caps_new_empty ();
-  GST_CAPS_FLAGS (newcaps) = GST_CAPS_FLAGS (caps);
+  GST_CAPS_FLAGS (newcaps) = GST_CAPS_FLAGS (caps) & ~CAPS_FLAGS_PRIVATE;
   n = GST_CAPS_LEN (caps);
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_PERFORMANCE, caps, "doing copy %p -> %p",
@@ -198,6 +525,11 @@ _gst_caps_free (GstCaps * caps)
 
   /* The refcount must be 0, but since we're only called by gst_caps_unref,
    * don't bother testing. */
+  if (G_UNLIKELY (GST_CAPS_FLAGS (caps) & CAPS_FLAG_CACHED))
+    gst_caps_cache_remove_caps (caps);
+  if (G_UNLIKELY (GST_CAPS_FLAGS (caps) & CAPS_FLAG_INTERNED))
+    gst_static_caps_table_remove (caps);
+
   len = GST_CAPS_LEN (caps);
   /* This can be used to get statistics about caps sizes */
   /*GST_CAT_INFO (GST_CAT_CAPS, "caps size: %d", len); */
@@ -422,6 +754,14 @@ gst_static_caps_get (GstStaticCaps * static_caps)
     if (G_UNLIKELY (string == NULL))
       goto no_string;
 
+    /* share the caps with other static caps of the same string, pad
+     * templates of many elements use the same caps */
+    if ((*caps = gst_static_caps_table_lookup (string))) {
+      GST_CAT_TRACE (GST_CAT_CAPS, "reusing %p for %p from string %s", *caps,
+          static_caps, string);
+      goto done;
+    }
+
     *caps = gst_caps_from_string (string);
 
     /* convert to string */
@@ -433,6 +773,15 @@ gst_static_caps_get (GstStaticCaps * static_caps)
     /* Caps generated from static caps are usually leaked */
     GST_MINI_OBJECT_FLAG_SET (*caps, GST_MINI_OBJECT_FLAG_MAY_BE_LEAKED);
 
+    if (G_UNLIKELY (static_caps_table == NULL)) {
+      static_caps_table = g_hash_table_new_full (g_str_hash, g_str_equal,
+          g_free, NULL);
+      static_caps_strings = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+    }
+    g_hash_table_replace (static_caps_table, g_strdup (string), *caps);
+    g_hash_table_insert (static_caps_strings, *caps, g_strdup (string));
+    GST_MINI_OBJECT_FLAG_SET (*caps, CAPS_FLAG_INTERNED);
+
     GST_CAT_TRACE (GST_CAT_CAPS, "created %p from string %s", static_caps,
         string);
   done:
@@ -462,9 +811,16 @@ no_string:
 void
 gst_static_caps_cleanup (GstStaticCaps * static_caps)
 {
+  GstCaps *caps;
+
   G_LOCK (static_caps_lock);
-  gst_caps_replace (&static_caps->caps, NULL);
+  caps = static_caps->caps;
+  static_caps->caps = NULL;
   G_UNLOCK (static_caps_lock);
+
+  /* unref without the lock, freeing removes the caps from the table */
+  if (caps)
+    gst_caps_unref (caps);
 }
 
 /* manipulation */
@@ -476,6 +832,8 @@ gst_caps_remove_and_get_structure_and_features (GstCaps * caps, guint idx,
   GstStructure *s_;
   GstCapsFeatures *f_;
 
+  CAPS_CACHE_CHECK (caps);
+
   s_ = gst_caps_get_structure_unchecked (caps, idx);
   f_ = gst_caps_get_features_unchecked (caps, idx);
 
@@ -548,6 +906,8 @@ gst_caps_append (GstCaps * caps1, GstCaps * caps2)
   g_return_if_fail (GST_IS_CAPS (caps2));
   g_return_if_fail (IS_WRITABLE (caps1));
 
+  CAPS_CACHE_CHECK (caps1);
+
   if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2))) {
     GST_CAPS_FLAGS (caps1) |= GST_CAPS_FLAG_ANY;
     gst_caps_unref (caps2);
@@ -833,6 +1193,8 @@ gst_caps_get_structure (const GstCaps * caps, guint index)
   g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
   g_return_val_if_fail (index < GST_CAPS_LEN (caps), NULL);
 
+  CAPS_CACHE_CHECK (caps);
+
   return gst_caps_get_structure_unchecked (caps, index);
 }
 
@@ -869,6 +1231,8 @@ gst_caps_get_features (const GstCaps * caps, guint index)
   g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
   g_return_val_if_fail (index < GST_CAPS_LEN (caps), NULL);
 
+  CAPS_CACHE_CHECK (caps);
+
   features = gst_caps_get_features_unchecked (caps, index);
   if (!features) {
     GstCapsFeatures **storage;
@@ -912,6 +1276,8 @@ gst_caps_set_features (GstCaps * caps, guint index, GstCapsFeatures * features)
   g_return_if_fail (index <= gst_caps_get_size (caps));
   g_return_if_fail (IS_WRITABLE (caps));
 
+  CAPS_CACHE_CHECK (caps);
+
   storage = gst_caps_get_features_storage_unchecked (caps, index);
   /* Not much problem here as caps are writable */
   old = g_atomic_pointer_get (storage);
@@ -946,7 +1312,7 @@ gst_caps_copy_nth (const GstCaps * caps, guint nth)
   g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
 
   newcaps = gst_caps_new_empty ();
-  GST_CAPS_FLAGS (newcaps) = GST_CAPS_FLAGS (caps);
+  GST_CAPS_FLAGS (newcaps) = GST_CAPS_FLAGS (caps) & ~CAPS_FLAGS_PRIVATE;
 
   if (G_LIKELY (GST_CAPS_LEN (caps) > nth)) {
     structure = gst_caps_get_structure_unchecked (caps, nth);
@@ -983,6 +1349,19 @@ gst_caps_truncate (GstCaps * caps)
   if (i == 0)
     return caps;
 
+  /* don't copy all structures just to free them again */
+  if (i > 0 && !IS_WRITABLE (caps)) {
+    GstCaps *first = gst_caps_new_empty ();
+
+    gst_caps_append_structure_unchecked (first,
+        gst_structure_copy (gst_caps_get_structure_unchecked (caps, 0)),
+        gst_caps_features_copy_conditional (gst_caps_get_features_unchecked
+            (caps, 0)));
+    gst_caps_unref (caps);
+
+    return first;
+  }
+
   caps = gst_caps_make_writable (caps);
   while (i > 0)
     gst_caps_remove_structure (caps, i--);
@@ -1010,6 +1389,8 @@ gst_caps_set_value (GstCaps * caps, const char *field, const GValue * value)
   g_return_if_fail (field != NULL);
   g_return_if_fail (G_IS_VALUE (value));
 
+  CAPS_CACHE_CHECK (caps);
+
   len = GST_CAPS_LEN (caps);
   for (i = 0; i < len; i++) {
     GstStructure *structure = gst_caps_get_structure_unchecked (caps, i);
@@ -1217,16 +1598,27 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   GstStructure *s1, *s2;
   GstCapsFeatures *f1, *f2;
   gboolean ret = TRUE;
+  gboolean cache = FALSE;
   gint i, j;
 
   g_return_val_if_fail (subset != NULL, FALSE);
   g_return_val_if_fail (superset != NULL, FALSE);
 
+  /* same caps, e.g. shared static caps */
+  if (G_UNLIKELY (subset == superset))
+    return TRUE;
   if (CAPS_IS_EMPTY (subset) || CAPS_IS_ANY (superset))
     return TRUE;
   if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
     return FALSE;
 
+  if (CAPS_CACHE_ENABLED (subset, superset)) {
+    if (gst_caps_cache_lookup (CAPS_CACHE_IS_SUBSET, subset, superset, NULL,
+            &ret))
+      return ret;
+    cache = TRUE;
+  }
+
   for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
     for (j = GST_CAPS_LEN (superset) - 1; j >= 0; j--) {
       s1 = gst_caps_get_structure_unchecked (subset, i);
@@ -1253,6 +1645,9 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
     }
   }
 
+  if (cache)
+    gst_caps_cache_insert (CAPS_CACHE_IS_SUBSET, subset, superset, NULL, ret);
+
   return ret;
 }
 
@@ -1410,18 +1805,8 @@ gst_caps_is_strictly_equal (const GstCaps * caps1, const GstCaps * caps2)
 
 /* intersect operation */
 
-/**
- * gst_caps_can_intersect:
- * @caps1: a #GstCaps to intersect
- * @caps2: a #GstCaps to intersect
- *
- * Tries intersecting @caps1 and @caps2 and reports whether the result would not
- * be empty
- *
- * Returns: %TRUE if intersection would be not empty
- */
-gboolean
-gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
+static gboolean
+gst_caps_can_intersect_uncached (const GstCaps * caps1, const GstCaps * caps2)
 {
   guint64 i;                    /* index can be up to 2 * G_MAX_UINT */
   guint j, k, len1, len2;
@@ -1430,21 +1815,6 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   GstCapsFeatures *features1;
   GstCapsFeatures *features2;
 
-  g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
-  g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
-
-  /* caps are exactly the same pointers */
-  if (G_UNLIKELY (caps1 == caps2))
-    return TRUE;
-
-  /* empty caps on either side, return empty */
-  if (G_UNLIKELY (CAPS_IS_EMPTY (caps1) || CAPS_IS_EMPTY (caps2)))
-    return FALSE;
-
-  /* one of the caps is any */
-  if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
-    return TRUE;
-
   /* run zigzag on top line then right line, this preserves the caps order
    * much better than a simple loop.
    *
@@ -1496,6 +1866,49 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   return FALSE;
 }
 
+/**
+ * gst_caps_can_intersect:
+ * @caps1: a #GstCaps to intersect
+ * @caps2: a #GstCaps to intersect
+ *
+ * Tries intersecting @caps1 and @caps2 and reports whether the result would not
+ * be empty
+ *
+ * Returns: %TRUE if intersection would be not empty
+ */
+gboolean
+gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
+{
+  gboolean ret;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
+  g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
+
+  /* caps are exactly the same pointers */
+  if (G_UNLIKELY (caps1 == caps2))
+    return TRUE;
+
+  /* empty caps on either side, return empty */
+  if (G_UNLIKELY (CAPS_IS_EMPTY (caps1) || CAPS_IS_EMPTY (caps2)))
+    return FALSE;
+
+  /* one of the caps is any */
+  if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
+    return TRUE;
+
+  if (!CAPS_CACHE_ENABLED (caps1, caps2))
+    return gst_caps_can_intersect_uncached (caps1, caps2);
+
+  if (gst_caps_cache_lookup (CAPS_CACHE_CAN_INTERSECT, caps1, caps2, NULL,
+          &ret))
+    return ret;
+
+  ret = gst_caps_can_intersect_uncached (caps1, caps2);
+  gst_caps_cache_insert (CAPS_CACHE_CAN_INTERSECT, caps1, caps2, NULL, ret);
+
+  return ret;
+}
+
 static GstCaps *
 gst_caps_intersect_zig_zag (GstCaps * caps1, GstCaps * caps2)
 {
@@ -1670,18 +2083,39 @@ GstCaps *
 gst_caps_intersect_full (GstCaps * caps1, GstCaps * caps2,
     GstCapsIntersectMode mode)
 {
+  GstCapsCacheOp op;
+  GstCaps *result;
+
   g_return_val_if_fail (GST_IS_CAPS (caps1), NULL);
   g_return_val_if_fail (GST_IS_CAPS (caps2), NULL);
 
   switch (mode) {
     case GST_CAPS_INTERSECT_FIRST:
-      return gst_caps_intersect_first (caps1, caps2);
+      op = CAPS_CACHE_INTERSECT_FIRST;
+      break;
     default:
       g_warning ("Unknown caps intersect mode: %d", mode);
       /* fallthrough */
     case GST_CAPS_INTERSECT_ZIG_ZAG:
-      return gst_caps_intersect_zig_zag (caps1, caps2);
+      op = CAPS_CACHE_INTERSECT_ZIG_ZAG;
+      break;
   }
+
+  if (CAPS_CACHE_ENABLED (caps1, caps2) && caps1 != caps2) {
+    if (gst_caps_cache_lookup (op, caps1, caps2, &result, NULL))
+      return result;
+  }
+
+  if (op == CAPS_CACHE_INTERSECT_FIRST)
+    result = gst_caps_intersect_first (caps1, caps2);
+  else
+    result = gst_caps_intersect_zig_zag (caps1, caps2);
+
+  /* only cache real intersections, not references to the input caps */
+  if (CAPS_CACHE_ENABLED (caps1, caps2) && result != caps1 && result != caps2)
+    gst_caps_cache_insert (op, caps1, caps2, result, FALSE);
+
+  return result;
 }
 
 /**
@@ -1920,6 +2354,7 @@ gst_caps_normalize (GstCaps * caps)
   g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
 
   caps = gst_caps_make_writable (caps);
+  CAPS_CACHE_CHECK (caps);
   nf.caps = caps;
 
   for (i = 0; i < gst_caps_get_size (nf.caps); i++) {
@@ -2045,6 +2480,107 @@ gst_caps_structure_simplify (GstStructure ** result,
   return FALSE;
 }
 
+/* compare the structures, which have the same name and number of fields.
+ * Returns 0 if they are equal, 1 if they only differ in one field, which
+ * holds fixed values in both and is returned in @field, or 2 otherwise */
+static gint
+gst_caps_structure_count_differences (const GstStructure * s1,
+    const GstStructure * s2, GQuark * field)
+{
+  guint i, n_fields;
+  gint res = 0;
+
+  n_fields = gst_structure_n_fields (s1);
+  for (i = 0; i < n_fields; i++) {
+    GQuark id = gst_structure_nth_field_id (s1, i);
+    const GValue *v1 = gst_structure_id_get_value (s1, id);
+    const GValue *v2 = gst_structure_id_get_value (s2, id);
+
+    if (v2 == NULL)
+      return 2;
+    if (gst_value_compare (v1, v2) == GST_VALUE_EQUAL)
+      continue;
+    if (res > 0 || !gst_value_is_fixed (v1) || !gst_value_is_fixed (v2))
+      return 2;
+    res = 1;
+    *field = id;
+  }
+
+  return res;
+}
+
+static void
+gst_caps_free_element (GstCapsArrayElement * elem)
+{
+  gst_structure_set_parent_refcount (elem->structure, NULL);
+  gst_structure_free (elem->structure);
+  if (elem->features) {
+    gst_caps_features_set_parent_refcount (elem->features, NULL);
+    gst_caps_features_free (elem->features);
+  }
+}
+
+/* one pass over the sorted structures of @caps that drops duplicates and
+ * merges runs of structures that only differ in the same fixed field into
+ * one structure with a list. This handles the common caps with one structure
+ * per format in linear time, before the quadratic general simplification. */
+static void
+gst_caps_merge_structure_runs (GstCaps * caps)
+{
+  GArray *array = GST_CAPS_ARRAY (caps);
+  guint i, j, out;
+
+  out = 0;
+  for (i = 0; i < array->len; i = j) {
+    GstCapsArrayElement *acc = &g_array_index (array, GstCapsArrayElement, i);
+    GstCapsFeatures *acc_f =
+        acc->features ? acc->features : GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
+    GValue list = G_VALUE_INIT;
+    GQuark list_field = 0;
+
+    for (j = i + 1; j < array->len; j++) {
+      GstCapsArrayElement *elem =
+          &g_array_index (array, GstCapsArrayElement, j);
+      GstCapsFeatures *f = elem->features ? elem->features :
+          GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
+      GQuark field = 0;
+      gint diff;
+
+      if (gst_structure_get_name_id (acc->structure) !=
+          gst_structure_get_name_id (elem->structure) ||
+          gst_structure_n_fields (acc->structure) !=
+          gst_structure_n_fields (elem->structure) ||
+          !gst_caps_features_is_equal (acc_f, f))
+        break;
+
+      diff = gst_caps_structure_count_differences (acc->structure,
+          elem->structure, &field);
+      if (diff == 2 || (diff == 1 && list_field != 0 && field != list_field))
+        break;
+
+      if (diff == 1) {
+        if (list_field == 0) {
+          list_field = field;
+          g_value_init (&list, GST_TYPE_LIST);
+          gst_value_list_append_value (&list,
+              gst_structure_id_get_value (acc->structure, field));
+        }
+        gst_value_list_append_value (&list,
+            gst_structure_id_get_value (elem->structure, field));
+      }
+      gst_caps_free_element (elem);
+    }
+
+    if (list_field != 0)
+      gst_structure_id_take_value (acc->structure, list_field, &list);
+
+    if (out != i)
+      g_array_index (array, GstCapsArrayElement, out) = *acc;
+    out++;
+  }
+  g_array_set_size (array, out);
+}
+
 static void
 gst_caps_switch_structures (GstCaps * caps, GstStructure * old,
     GstStructure * new, gint i)
@@ -2087,9 +2623,13 @@ gst_caps_simplify (GstCaps * caps)
     return caps;
 
   caps = gst_caps_make_writable (caps);
+  CAPS_CACHE_CHECK (caps);
 
   g_array_sort (GST_CAPS_ARRAY (caps), gst_caps_compare_structures);
 
+  gst_caps_merge_structure_runs (caps);
+  start = GST_CAPS_LEN (caps) - 1;
+
   for (i = start; i >= 0; i--) {
     simplify = gst_caps_get_structure_unchecked (caps, i);
     simplify_f = gst_caps_get_features_unchecked (caps, i);
@@ -2379,6 +2919,156 @@ gst_caps_from_string (const gchar * string)
   }
 }
 
+gboolean
+_priv_gst_caps_write_binary (GByteArray * array, const GstCaps * caps)
+{
+  GstStructure *structure;
+  GstCapsFeatures *features;
+  gchar *str;
+  guint i, n;
+
+  n = GST_CAPS_LEN (caps);
+
+  _priv_gst_binary_write_uint8 (array, CAPS_IS_ANY (caps));
+  _priv_gst_binary_write_uint32 (array, n);
+
+  for (i = 0; i < n; i++) {
+    structure = gst_caps_get_structure_unchecked (caps, i);
+    features = gst_caps_get_features_unchecked (caps, i);
+
+    str = features ? gst_caps_features_to_string (features) : NULL;
+    _priv_gst_binary_write_string (array, str);
+    g_free (str);
+
+    if (!_priv_gst_structure_write_binary (array, structure))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+GstCaps *
+_priv_gst_caps_read_binary (GstBinaryReader * reader)
+{
+  GstCaps *caps;
+  GstStructure *structure;
+  GstCapsFeatures *features;
+  guint8 any;
+  guint32 i, n;
+  gchar *str;
+
+  if (!_priv_gst_binary_read_uint8 (reader, &any) ||
+      !_priv_gst_binary_read_uint32 (reader, &n))
+    return NULL;
+
+  caps = gst_caps_new_empty ();
+  if (any)
+    GST_CAPS_FLAG_SET (caps, GST_CAPS_FLAG_ANY);
+
+  for (i = 0; i < n; i++) {
+    if (!_priv_gst_binary_read_string (reader, &str))
+      goto error;
+
+    features = NULL;
+    if (str) {
+      features = gst_caps_features_from_string (str);
+      g_free (str);
+      if (!features)
+        goto error;
+    }
+
+    if (!(structure = _priv_gst_structure_read_binary (reader))) {
+      if (features)
+        gst_caps_features_free (features);
+      goto error;
+    }
+
+    gst_caps_append_structure_unchecked (caps, structure, features);
+  }
+
+  return caps;
+
+  /* ERRORS */
+error:
+  {
+    GST_WARNING ("invalid caps in binary data");
+    gst_caps_unref (caps);
+    return NULL;
+  }
+}
+
+/**
+ * gst_caps_to_binary:
+ * @caps: a #GstCaps
+ * @size: (out): the size of the returned data
+ *
+ * Serializes @caps into a compact binary representation that can be turned
+ * back into a #GstCaps with gst_caps_from_binary(), also in another process.
+ * This is faster than gst_caps_to_string() as values of the common types are
+ * stored directly without converting them to strings, and nested caps and
+ * structures are supported at any depth.
+ *
+ * Free-function: g_free
+ *
+ * Returns: (transfer full) (array length=size) (nullable): the binary
+ *     representation of @caps or %NULL if one of the values can't
+ *     be serialized.
+ *
+ * Since: 1.14
+ */
+guint8 *
+gst_caps_to_binary (const GstCaps * caps, gsize * size)
+{
+  GByteArray *array;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  array = g_byte_array_new ();
+  _priv_gst_binary_write_header (array, GST_BINARY_KIND_CAPS);
+  if (!_priv_gst_caps_write_binary (array, caps)) {
+    g_byte_array_free (array, TRUE);
+    *size = 0;
+    return NULL;
+  }
+
+  *size = array->len;
+  return g_byte_array_free (array, FALSE);
+}
+
+/**
+ * gst_caps_from_binary:
+ * @data: (array length=size): data created with gst_caps_to_binary()
+ * @size: the size of @data
+ *
+ * Creates a #GstCaps from its binary representation created with
+ * gst_caps_to_binary().
+ *
+ * Returns: (transfer full) (nullable): a newly allocated #GstCaps or %NULL
+ *     when @data could not be deserialized.
+ *
+ * Since: 1.14
+ */
+GstCaps *
+gst_caps_from_binary (const guint8 * data, gsize size)
+{
+  GstBinaryReader reader = GST_BINARY_READER_INIT (data, size);
+  GstCaps *caps;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_binary_read_header (&reader, GST_BINARY_KIND_CAPS))
+    return NULL;
+
+  caps = _priv_gst_caps_read_binary (&reader);
+  if (caps && reader.offset != reader.size) {
+    GST_WARNING ("trailing data after binary caps");
+    gst_caps_unref (caps);
+    caps = NULL;
+  }
+
+  return caps;
+}
+
 static void
 gst_caps_transform_to_string (const GValue * src_value, GValue * dest_value)
 {
@@ -2460,6 +3150,8 @@ gst_caps_map_in_place (GstCaps * caps, GstCapsMapFunc func, gpointer user_data)
   g_return_val_if_fail (gst_caps_is_writable (caps), FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
 
+  CAPS_CACHE_CHECK (caps);
+
   n = GST_CAPS_LEN (caps);
 
   for (i = 0; i < n; i++) {
@@ -2509,6 +3201,8 @@ gst_caps_filter_and_map_in_place (GstCaps * caps, GstCapsFilterMapFunc func,
   g_return_if_fail (gst_caps_is_writable (caps));
   g_return_if_fail (func != NULL);
 
+  CAPS_CACHE_CHECK (caps);
+
   n = GST_CAPS_LEN (caps);
 
   for (i = 0; i < n;) {
@@ -566,6 +566,13 @@ gchar *           gst_caps_to_string               (const GstCaps *caps) G_GNUC_
 GST_EXPORT
 GstCaps *         gst_caps_from_string             (const gchar   *string) G_GNUC_WARN_UNUSED_RESULT;
 
+GST_EXPORT
+guint8 *          gst_caps_to_binary               (const GstCaps *caps,
+                                                    gsize         *size) G_GNUC_MALLOC;
+GST_EXPORT
+GstCaps *         gst_caps_from_binary             (const guint8  *data,
+                                                    gsize          size) G_GNUC_WARN_UNUSED_RESULT;
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstCaps, gst_caps_unref)
 #endif
@@ -103,6 +103,7 @@
 
 #include "gst_private.h"
 #include <time.h>
+#include <math.h>
 
 #include "gstclock.h"
 #include "gstinfo.h"
@@ -120,7 +121,8 @@ enum
   PROP_0,
   PROP_WINDOW_SIZE,
   PROP_WINDOW_THRESHOLD,
-  PROP_TIMEOUT
+  PROP_TIMEOUT,
+  PROP_STATISTICS
 };
 
 enum
@@ -158,9 +160,17 @@ struct _GstClockPrivate
   gint time_index;
   GstClockTime timeout;
   GstClockTime *times;
-  GstClockTime *times_temp;
   GstClockID clockid;
 
+  /* with SLAVE_LOCK, running sums of the observations in the window relative
+   * to the anchor observation, see gst_clock_regression_add() */
+  GstClockTime anchor_x, anchor_y;
+  gdouble sum_x, sum_y, sum_xx, sum_xy, sum_yy;
+  gint sums_updates;
+  /* result of the last regression */
+  guint stat_n;
+  gdouble stat_rate, stat_r_squared, stat_residual;
+
   gint pre_count;
   gint post_count;
 
@@ -241,7 +251,7 @@ gst_clock_entry_new (GstClock * clock, GstClockTime time,
 {
   GstClockEntry *entry;
 
-  entry = g_slice_new (GstClockEntry);
+  entry = (GstClockEntry *) g_slice_new (GstClockEntryImpl);
 
   /* FIXME: add tracer hook for struct allocations such as clock entries */
 
@@ -259,6 +269,8 @@ gst_clock_entry_new (GstClock * clock, GstClockTime time,
   entry->destroy_data = NULL;
   entry->unscheduled = FALSE;
   entry->woken_up = FALSE;
+  GST_CLOCK_ENTRY_IMPL (entry)->heap_index = -1;
+  GST_CLOCK_ENTRY_IMPL (entry)->heap_seqnum = 0;
 
   return (GstClockID) entry;
 }
@@ -323,6 +335,86 @@ gst_clock_periodic_id_reinit (GstClock * clock, GstClockID id,
       interval, GST_CLOCK_ENTRY_PERIODIC);
 }
 
+static GstClockID
+gst_clock_entry_rearm (GstClock * clock, GstClockID * id, GstClockTime time,
+    GstClockTime interval, GstClockEntryType type)
+{
+  GstClockEntry *entry = (GstClockEntry *) * id;
+
+  /* an entry that is not waited for can be reused */
+  if (G_LIKELY (entry != NULL && entry->clock == clock
+          && entry->status != GST_CLOCK_BUSY
+          && GST_CLOCK_ENTRY_IMPL (entry)->heap_index == -1)) {
+    gst_clock_entry_reinit (clock, entry, time, interval, type);
+    return *id;
+  }
+
+  if (entry)
+    gst_clock_id_unref (entry);
+  *id = gst_clock_entry_new (clock, time, interval, type);
+
+  return *id;
+}
+
+/**
+ * gst_clock_single_shot_id_rearm:
+ * @clock: a #GstClock
+ * @id: (inout) (allow-none): a location holding a #GstClockID or %NULL
+ * @time: The requested time.
+ *
+ * Makes the #GstClockID in @id a single shot id of @clock for @time. The id
+ * is reinitialized when it can be reused, otherwise it is replaced with a
+ * new id. Code that waits repeatedly can keep one id around this way, and
+ * doesn't allocate an id for every wait.
+ *
+ * The id in @id must not be waited for when calling this function. The
+ * caller owns a reference to the id in @id and releases it with
+ * gst_clock_id_unref() when done.
+ *
+ * Returns: (transfer none): the #GstClockID in @id.
+ *
+ * Since: 1.14
+ */
+GstClockID
+gst_clock_single_shot_id_rearm (GstClock * clock, GstClockID * id,
+    GstClockTime time)
+{
+  g_return_val_if_fail (GST_IS_CLOCK (clock), NULL);
+  g_return_val_if_fail (id != NULL, NULL);
+
+  return gst_clock_entry_rearm (clock, id, time, GST_CLOCK_TIME_NONE,
+      GST_CLOCK_ENTRY_SINGLE);
+}
+
+/**
+ * gst_clock_periodic_id_rearm:
+ * @clock: a #GstClock
+ * @id: (inout) (allow-none): a location holding a #GstClockID or %NULL
+ * @start_time: the requested start time
+ * @interval: the requested interval
+ *
+ * Makes the #GstClockID in @id a periodic id of @clock that fires first at
+ * @start_time and then every @interval, like
+ * gst_clock_single_shot_id_rearm() does for single shot ids.
+ *
+ * Returns: (transfer none): the #GstClockID in @id.
+ *
+ * Since: 1.14
+ */
+GstClockID
+gst_clock_periodic_id_rearm (GstClock * clock, GstClockID * id,
+    GstClockTime start_time, GstClockTime interval)
+{
+  g_return_val_if_fail (GST_IS_CLOCK (clock), NULL);
+  g_return_val_if_fail (id != NULL, NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (start_time), NULL);
+  g_return_val_if_fail (interval != 0, NULL);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (interval), NULL);
+
+  return gst_clock_entry_rearm (clock, id, start_time, interval,
+      GST_CLOCK_ENTRY_PERIODIC);
+}
+
 /**
  * gst_clock_id_ref:
  * @id: The #GstClockID to ref
@@ -356,7 +448,7 @@ _gst_clock_id_free (GstClockID id)
 
   /* FIXME: add tracer hook for struct allocations such as clock entries */
 
-  g_slice_free (GstClockEntry, id);
+  g_slice_free (GstClockEntryImpl, id);
 }
 
 /**
@@ -695,6 +787,24 @@ gst_clock_class_init (GstClockClass * klass)
           0, G_MAXUINT64, DEFAULT_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstClock:statistics:
+   *
+   * The result of the last regression over the observations of the window
+   * as a #GstStructure with the number of observations ("n-observations"),
+   * the estimated rate between slave and master ("rate"), the coefficient
+   * of determination ("r-squared") and the standard deviation of the master
+   * times from the regression line in nanoseconds ("residual").
+   *
+   * The fields are 0 until the first regression was done.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_STATISTICS,
+      g_param_spec_boxed ("statistics", "Statistics",
+          "Statistics of the regression over the window of observations",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstClock::synced:
    * @clock: the clock
@@ -739,8 +849,7 @@ gst_clock_init (GstClock * clock)
   priv->filling = TRUE;
   priv->time_index = 0;
   priv->timeout = DEFAULT_TIMEOUT;
-  priv->times = g_new0 (GstClockTime, 4 * priv->window_size);
-  priv->times_temp = priv->times + 2 * priv->window_size;
+  priv->times = g_new0 (GstClockTime, 2 * priv->window_size);
 }
 
 static void
@@ -770,7 +879,6 @@ gst_clock_finalize (GObject * object)
   }
   g_free (clock->priv->times);
   clock->priv->times = NULL;
-  clock->priv->times_temp = NULL;
   GST_CLOCK_SLAVE_UNLOCK (clock);
 
   g_mutex_clear (&clock->priv->slave_lock);
@@ -1380,6 +1488,131 @@ gst_clock_add_observation (GstClock * clock, GstClockTime slave,
   return TRUE;
 }
 
+#define SUM_X(priv,x) ((gdouble) GST_CLOCK_DIFF ((priv)->anchor_x, (x)))
+#define SUM_Y(priv,y) ((gdouble) GST_CLOCK_DIFF ((priv)->anchor_y, (y)))
+
+/* with SLAVE_LOCK. Recomputes the sums of the @n observations in the window,
+ * relative to the oldest one, which limits the rounding errors of adding and
+ * removing observations */
+static void
+gst_clock_regression_rebase (GstClockPrivate * priv, gint n)
+{
+  gint i, start;
+
+  start = priv->filling ? 0 : priv->time_index;
+
+  priv->anchor_x = priv->times[2 * start];
+  priv->anchor_y = priv->times[2 * start + 1];
+  priv->sum_x = priv->sum_y = priv->sum_xx = priv->sum_xy = priv->sum_yy = 0;
+
+  for (i = 0; i < n; i++) {
+    gint idx = (start + i) % priv->window_size;
+    gdouble x = SUM_X (priv, priv->times[2 * idx]);
+    gdouble y = SUM_Y (priv, priv->times[2 * idx + 1]);
+
+    priv->sum_x += x;
+    priv->sum_y += y;
+    priv->sum_xx += x * x;
+    priv->sum_xy += x * y;
+    priv->sum_yy += y * y;
+  }
+  priv->sums_updates = 0;
+}
+
+/* with SLAVE_LOCK. Adds an observation to the window, replacing the oldest
+ * one once the window is full, and updates the sums in O(1). The sums are
+ * recomputed once per window size updates. */
+static void
+gst_clock_regression_add (GstClockPrivate * priv, GstClockTime slave,
+    GstClockTime master)
+{
+  gint idx = priv->time_index;
+  gdouble x, y;
+
+  if (priv->filling && idx == 0) {
+    /* first observation after a restart */
+    priv->anchor_x = slave;
+    priv->anchor_y = master;
+    priv->sum_x = priv->sum_y = priv->sum_xx = priv->sum_xy = priv->sum_yy = 0;
+    priv->sums_updates = 0;
+  } else if (!priv->filling) {
+    x = SUM_X (priv, priv->times[2 * idx]);
+    y = SUM_Y (priv, priv->times[2 * idx + 1]);
+    priv->sum_x -= x;
+    priv->sum_y -= y;
+    priv->sum_xx -= x * x;
+    priv->sum_xy -= x * y;
+    priv->sum_yy -= y * y;
+  }
+
+  priv->times[2 * idx] = slave;
+  priv->times[2 * idx + 1] = master;
+
+  x = SUM_X (priv, slave);
+  y = SUM_Y (priv, master);
+  priv->sum_x += x;
+  priv->sum_y += y;
+  priv->sum_xx += x * x;
+  priv->sum_xy += x * y;
+  priv->sum_yy += y * y;
+
+  priv->time_index++;
+  if (G_UNLIKELY (priv->time_index == priv->window_size)) {
+    priv->filling = FALSE;
+    priv->time_index = 0;
+  }
+
+  if (!priv->filling && ++priv->sums_updates >= priv->window_size)
+    gst_clock_regression_rebase (priv, priv->window_size);
+}
+
+/* with SLAVE_LOCK. Does the linear regression of the @n observations in the
+ * window from the sums. @xbase is @last_slave, the slave time of the most
+ * recent observation, and @b the master time at @xbase. */
+static gboolean
+gst_clock_regression_calculate (GstClockPrivate * priv, gint n,
+    GstClockTime last_slave, GstClockTime * m_num, GstClockTime * m_denom,
+    GstClockTime * b, GstClockTime * xbase, gdouble * r_squared)
+{
+  gdouble xbar, ybar, sxx, sxy, syy, m;
+  GstClockTimeDiff offset;
+
+  xbar = priv->sum_x / n;
+  ybar = priv->sum_y / n;
+  sxx = priv->sum_xx - priv->sum_x * xbar;
+  sxy = priv->sum_xy - priv->sum_x * ybar;
+  syy = priv->sum_yy - priv->sum_y * ybar;
+
+  if (G_UNLIKELY (sxx <= 0 || sxy <= 0)) {
+    GST_CAT_DEBUG (GST_CAT_CLOCK, "sxx %g, sxy %g, regression failed", sxx,
+        sxy);
+    return FALSE;
+  }
+
+  m = sxy / sxx;
+  *r_squared = syy > 0 ? (sxy * sxy) / (sxx * syy) : 1.0;
+
+  /* the rate as a fraction with 40 bits of precision */
+  *m_denom = G_GUINT64_CONSTANT (1) << 40;
+  *m_num = (GstClockTime) (m * *m_denom + 0.5);
+
+  /* Report base starting from the most recent observation */
+  *xbase = last_slave;
+  offset = (GstClockTimeDiff) floor (ybar + m * (SUM_X (priv,
+              last_slave) - xbar) + 0.5);
+  if (offset < 0 && priv->anchor_y < -offset)
+    *b = 0;
+  else
+    *b = priv->anchor_y + offset;
+
+  priv->stat_n = n;
+  priv->stat_rate = m;
+  priv->stat_r_squared = *r_squared;
+  priv->stat_residual = sqrt (MAX (syy - m * sxy, 0) / n);
+
+  return TRUE;
+}
+
 /**
  * gst_clock_add_observation_unapplied:
  * @clock: a #GstClock
@@ -1421,21 +1654,14 @@ gst_clock_add_observation_unapplied (GstClock * clock, GstClockTime slave,
       "adding observation slave %" GST_TIME_FORMAT ", master %" GST_TIME_FORMAT,
       GST_TIME_ARGS (slave), GST_TIME_ARGS (master));
 
-  priv->times[(2 * priv->time_index)] = slave;
-  priv->times[(2 * priv->time_index) + 1] = master;
-
-  priv->time_index++;
-  if (G_UNLIKELY (priv->time_index == priv->window_size)) {
-    priv->filling = FALSE;
-    priv->time_index = 0;
-  }
+  gst_clock_regression_add (priv, slave, master);
 
   if (G_UNLIKELY (priv->filling && priv->time_index < priv->window_threshold))
     goto filling;
 
   n = priv->filling ? priv->time_index : priv->window_size;
-  if (!gst_calculate_linear_regression (priv->times, priv->times_temp, n,
-          &m_num, &m_denom, &b, &xbase, r_squared))
+  if (!gst_clock_regression_calculate (priv, n, slave, &m_num, &m_denom, &b,
+          &xbase, r_squared))
     goto invalid;
 
   GST_CLOCK_SLAVE_UNLOCK (clock);
@@ -1523,8 +1749,7 @@ gst_clock_set_property (GObject * object, guint prop_id,
       GST_CLOCK_SLAVE_LOCK (clock);
       priv->window_size = g_value_get_int (value);
       priv->window_threshold = MIN (priv->window_threshold, priv->window_size);
-      priv->times = g_renew (GstClockTime, priv->times, 4 * priv->window_size);
-      priv->times_temp = priv->times + 2 * priv->window_size;
+      priv->times = g_renew (GstClockTime, priv->times, 2 * priv->window_size);
       /* restart calibration */
       priv->filling = TRUE;
       priv->time_index = 0;
@@ -1568,6 +1793,16 @@ gst_clock_get_property (GObject * object, guint prop_id,
     case PROP_TIMEOUT:
       g_value_set_uint64 (value, gst_clock_get_timeout (clock));
       break;
+    case PROP_STATISTICS:
+      GST_CLOCK_SLAVE_LOCK (clock);
+      g_value_take_boxed (value,
+          gst_structure_new ("application/x-gst-clock-stats",
+              "n-observations", G_TYPE_UINT, priv->stat_n,
+              "rate", G_TYPE_DOUBLE, priv->stat_rate,
+              "r-squared", G_TYPE_DOUBLE, priv->stat_r_squared,
+              "residual", G_TYPE_DOUBLE, priv->stat_residual, NULL));
+      GST_CLOCK_SLAVE_UNLOCK (clock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -623,6 +623,15 @@ gboolean                gst_clock_periodic_id_reinit    (GstClock * clock,
                                                          GstClockID id,
                                                          GstClockTime start_time,
                                                          GstClockTime interval);
+GST_EXPORT
+GstClockID              gst_clock_single_shot_id_rearm  (GstClock * clock,
+                                                         GstClockID * id,
+                                                         GstClockTime time);
+GST_EXPORT
+GstClockID              gst_clock_periodic_id_rearm     (GstClock * clock,
+                                                         GstClockID * id,
+                                                         GstClockTime start_time,
+                                                         GstClockTime interval);
 
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstClock, gst_object_unref)
@@ -55,9 +55,22 @@
 /*** PIPELINE GRAPHS **********************************************************/
 
 extern const gchar *priv_gst_dump_dot_dir;      /* NULL *//* set from gst.c */
+extern gboolean priv_gst_dump_dot_async;        /* FALSE *//* set from gst.c */
 
 #define PARAM_MAX_LENGTH 80
 
+/* write the graph to the file whenever this much is collected */
+#define FLUSH_THRESHOLD (64 * 1024)
+
+typedef struct
+{
+  GString *str;
+  /* the file to write to, or NULL to collect the whole graph in str */
+  FILE *out;
+  /* GstCaps -> description, caps are often shared by many pads */
+  GHashTable *caps_cache;
+} DebugDumpContext;
+
 static const gchar spaces[] = {
   "                                "    /* 32 */
       "                                "        /* 64 */
@@ -221,6 +234,89 @@ debug_dump_get_object_params (GObject * object,
   return param_name;
 }
 
+static gboolean
+debug_dump_show_stats (GstDebugGraphDetails details)
+{
+  /* -1 is how GST_DEBUG_GRAPH_SHOW_VERBOSE used to be defined */
+  return (details & GST_DEBUG_GRAPH_SHOW_STATS) &&
+      details != (GstDebugGraphDetails) - 1;
+}
+
+/* ask the tracers for the statistics of @object */
+static GstStructure *
+debug_dump_get_stats (GstObject * object, GstDebugGraphDetails details)
+{
+  GstStructure *stats;
+
+  if (!debug_dump_show_stats (details))
+    return NULL;
+
+  stats = gst_structure_new_empty ("stats");
+  GST_TRACER_GRAPH_STATS (object, stats);
+  if (gst_structure_n_fields (stats) == 0) {
+    gst_structure_free (stats);
+    return NULL;
+  }
+  return stats;
+}
+
+static gchar *
+debug_dump_describe_element_stats (GstStructure * stats,
+    gchar ** fill_color)
+{
+  GString *str = g_string_new (NULL);
+  gdouble busy;
+  guint buffers;
+  guint64 bytes, time;
+
+  if (gst_structure_get_double (stats, "busy", &busy)) {
+    guint level;
+
+    busy = CLAMP (busy, 0.0, 1.0);
+    g_string_append_printf (str, "\\n%.1f%% busy", busy * 100.0);
+    /* from white for idle to red for always busy */
+    level = (guint) ((1.0 - busy) * 255.0);
+    *fill_color = g_strdup_printf ("#ff%02x%02x", level, level);
+  }
+  if (gst_structure_get_uint (stats, "level-buffers", &buffers) &&
+      gst_structure_get_uint64 (stats, "level-bytes", &bytes) &&
+      gst_structure_get_uint64 (stats, "level-time", &time)) {
+    g_string_append_printf (str, "\\nlevel: %u buffers, %" G_GUINT64_FORMAT
+        " bytes, %" GST_TIME_FORMAT, buffers, bytes, GST_TIME_ARGS (time));
+  }
+  return g_string_free (str, FALSE);
+}
+
+static gchar *
+debug_dump_describe_pad_stats (GstStructure * stats)
+{
+  GString *str = g_string_new (NULL);
+  const gchar *pool;
+  gdouble buffers, bytes;
+
+  if (gst_structure_get_double (stats, "buffers-per-second", &buffers))
+    g_string_append_printf (str, "%.1f buffers/s", buffers);
+  if (gst_structure_get_double (stats, "bytes-per-second", &bytes)) {
+    if (str->len > 0)
+      g_string_append (str, "\\n");
+    if (bytes >= 1000000.0)
+      g_string_append_printf (str, "%.1f MB/s", bytes / 1000000.0);
+    else if (bytes >= 1000.0)
+      g_string_append_printf (str, "%.1f kB/s", bytes / 1000.0);
+    else
+      g_string_append_printf (str, "%.0f B/s", bytes);
+  }
+  if ((pool = gst_structure_get_string (stats, "allocation-pool"))) {
+    gchar *esc_pool = g_strescape (pool, NULL);
+
+    if (str->len > 0)
+      g_string_append (str, "\\n");
+    g_string_append_printf (str, "pool: %s", esc_pool);
+    g_free (esc_pool);
+  }
+  return g_string_free (str, FALSE);
+}
+
 static void
 debug_dump_pad (GstPad * pad, const gchar * color_name,
     const gchar * element_name, GstDebugGraphDetails details, GString * str,
@@ -462,15 +558,35 @@ debug_dump_describe_caps (GstCaps * caps, GstDebugGraphDetails details)
   return media;
 }
 
+/* the cache keeps a ref on the caps so that they can't change or be freed
+ * and the pointer reused */
+static gchar *
+debug_dump_describe_caps_cached (DebugDumpContext * ctx, GstCaps * caps,
+    GstDebugGraphDetails details)
+{
+  const gchar *media;
+
+  if (!(media = g_hash_table_lookup (ctx->caps_cache, caps))) {
+    gchar *tmp = debug_dump_describe_caps (caps, details);
+
+    g_hash_table_insert (ctx->caps_cache, gst_caps_ref (caps), tmp);
+    media = tmp;
+  }
+  return g_strdup (media);
+}
+
 static void
 debug_dump_element_pad_link (GstPad * pad, GstElement * element,
-    GstDebugGraphDetails details, GString * str, const gint indent)
+    GstDebugGraphDetails details, DebugDumpContext * ctx, const gint indent)
 {
+  GString *str = ctx->str;
   GstElement *peer_element;
   GstPad *peer_pad;
   GstCaps *caps, *peer_caps;
+  GstStructure *stats;
   gchar *media = NULL;
   gchar *media_src = NULL, *media_sink = NULL;
+  gchar *stats_str = NULL;
   gchar *pad_name, *element_name;
   gchar *peer_pad_name, *peer_element_name;
   const gchar *spc = MAKE_INDENT (indent);
@@ -486,12 +602,12 @@ debug_dump_element_pad_link (GstPad * pad, GstElement * element,
       if (!peer_caps)
         peer_caps = gst_pad_get_pad_template_caps (peer_pad);
 
-      media = debug_dump_describe_caps (caps, details);
+      media = debug_dump_describe_caps_cached (ctx, caps, details);
       /* check if peer caps are different */
       if (peer_caps && !gst_caps_is_equal (caps, peer_caps)) {
         gchar *tmp;
 
-        tmp = debug_dump_describe_caps (peer_caps, details);
+        tmp = debug_dump_describe_caps_cached (ctx, peer_caps, details);
         if (gst_pad_get_direction (pad) == GST_PAD_SRC) {
           media_src = media;
           media_sink = tmp;
@@ -505,6 +621,11 @@ debug_dump_element_pad_link (GstPad * pad, GstElement * element,
       gst_caps_unref (caps);
     }
 
+    if ((stats = debug_dump_get_stats (GST_OBJECT (pad), details))) {
+      stats_str = debug_dump_describe_pad_stats (stats);
+      gst_structure_free (stats);
+    }
+
     pad_name = debug_dump_make_object_name (GST_OBJECT (pad));
     if (element) {
       element_name = debug_dump_make_object_name (GST_OBJECT (element));
@@ -521,24 +642,30 @@ debug_dump_element_pad_link (GstPad * pad, GstElement * element,
 
     /* pad link */
     if (media) {
-      g_string_append_printf (str, "%s%s_%s -> %s_%s [label=\"%s\"]\n", spc,
-          element_name, pad_name, peer_element_name, peer_pad_name, media);
+      g_string_append_printf (str, "%s%s_%s -> %s_%s [label=\"%s%s%s\"]\n",
+          spc, element_name, pad_name, peer_element_name, peer_pad_name, media,
+          (stats_str ? "\\n" : ""), (stats_str ? stats_str : ""));
       g_free (media);
     } else if (media_src && media_sink) {
       /* dot has some issues with placement of head and taillabels,
        * we need an empty label to make space */
       g_string_append_printf (str,
           "%s%s_%s -> %s_%s [labeldistance=\"10\", labelangle=\"0\", "
-          "label=\"                                                  \", "
-          "taillabel=\"%s\", headlabel=\"%s\"]\n",
+          "label=\"%s\", taillabel=\"%s\", headlabel=\"%s\"]\n",
           spc, element_name, pad_name, peer_element_name, peer_pad_name,
+          (stats_str ? stats_str :
+              "                                                  "),
           media_src, media_sink);
       g_free (media_src);
       g_free (media_sink);
+    } else if (stats_str) {
+      g_string_append_printf (str, "%s%s_%s -> %s_%s [label=\"%s\"]\n", spc,
+          element_name, pad_name, peer_element_name, peer_pad_name, stats_str);
     } else {
       g_string_append_printf (str, "%s%s_%s -> %s_%s\n", spc,
           element_name, pad_name, peer_element_name, peer_pad_name);
     }
+    g_free (stats_str);
 
     g_free (pad_name);
     g_free (element_name);
@@ -598,10 +725,20 @@ debug_dump_element_pads (GstIterator * pad_iter, GstPad * pad,
  *
  * Helper for gst_debug_bin_to_dot_file() to recursively dump a pipeline.
  */
+static void
+debug_dump_flush (DebugDumpContext * ctx, gboolean force)
+{
+  if (ctx->out && (force || ctx->str->len >= FLUSH_THRESHOLD)) {
+    fwrite (ctx->str->str, 1, ctx->str->len, ctx->out);
+    g_string_truncate (ctx->str, 0);
+  }
+}
+
 static void
 debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
-    GString * str, const gint indent)
+    DebugDumpContext * ctx, const gint indent)
 {
+  GString *str = ctx->str;
   GstIterator *element_iter, *pad_iter;
   gboolean elements_done, pads_done;
   GValue item = { 0, };
@@ -613,6 +750,8 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
   gchar *element_name;
   gchar *state_name = NULL;
   gchar *param_name = NULL;
+  gchar *stats_name = NULL, *fill_color = NULL;
+  GstStructure *stats;
   const gchar *spc = MAKE_INDENT (indent);
 
   element_iter = gst_bin_iterate_elements (bin);
@@ -630,6 +769,10 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
           param_name = debug_dump_get_object_params (G_OBJECT (element),
               details, NULL);
         }
+        if ((stats = debug_dump_get_stats (GST_OBJECT (element), details))) {
+          stats_name = debug_dump_describe_element_stats (stats, &fill_color);
+          gst_structure_free (stats);
+        }
         /* elements */
         g_string_append_printf (str, "%ssubgraph cluster_%s {\n", spc,
             element_name);
@@ -638,9 +781,10 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
         g_string_append_printf (str, "%s  fontsize=\"8\";\n", spc);
         g_string_append_printf (str, "%s  style=\"filled,rounded\";\n", spc);
         g_string_append_printf (str, "%s  color=black;\n", spc);
-        g_string_append_printf (str, "%s  label=\"%s\\n%s%s%s\";\n", spc,
+        g_string_append_printf (str, "%s  label=\"%s\\n%s%s%s%s\";\n", spc,
             G_OBJECT_TYPE_NAME (element), GST_OBJECT_NAME (element),
-            (state_name ? state_name : ""), (param_name ? param_name : "")
+            (state_name ? state_name : ""), (stats_name ? stats_name : ""),
+            (param_name ? param_name : "")
             );
         if (state_name) {
           g_free (state_name);
@@ -650,6 +794,8 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
           g_free (param_name);
           param_name = NULL;
         }
+        g_free (stats_name);
+        stats_name = NULL;
 
         src_pads = sink_pads = 0;
         if ((pad_iter = gst_element_iterate_sink_pads (element))) {
@@ -679,7 +825,11 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
         if (GST_IS_BIN (element)) {
           g_string_append_printf (str, "%s  fillcolor=\"#ffffff\";\n", spc);
           /* recurse */
-          debug_dump_element (GST_BIN (element), details, str, indent + 1);
+          debug_dump_element (GST_BIN (element), details, ctx, indent + 1);
+        } else if (fill_color) {
+          /* busy elements stand out */
+          g_string_append_printf (str, "%s  fillcolor=\"%s\";\n", spc,
+              fill_color);
         } else {
           if (src_pads && !sink_pads)
             g_string_append_printf (str, "%s  fillcolor=\"#ffaaaa\";\n", spc);
@@ -690,6 +840,8 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
           else
             g_string_append_printf (str, "%s  fillcolor=\"#ffffff\";\n", spc);
         }
+        g_free (fill_color);
+        fill_color = NULL;
         g_string_append_printf (str, "%s}\n\n", spc);
         if ((pad_iter = gst_element_iterate_pads (element))) {
           pads_done = FALSE;
@@ -699,7 +851,7 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
                 pad = g_value_get_object (&item2);
                 if (gst_pad_is_linked (pad)) {
                   if (gst_pad_get_direction (pad) == GST_PAD_SRC) {
-                    debug_dump_element_pad_link (pad, element, details, str,
+                    debug_dump_element_pad_link (pad, element, details, ctx,
                         indent);
                   } else {
                     GstPad *peer_pad = gst_pad_get_peer (pad);
@@ -708,7 +860,7 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
                       if (!GST_IS_GHOST_PAD (peer_pad)
                           && GST_IS_PROXY_PAD (peer_pad)) {
                         debug_dump_element_pad_link (peer_pad, NULL, details,
-                            str, indent);
+                            ctx, indent);
                       }
                       gst_object_unref (peer_pad);
                     }
@@ -728,6 +880,7 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details,
           g_value_unset (&item2);
           gst_iterator_free (pad_iter);
         }
+        debug_dump_flush (ctx, FALSE);
         g_value_reset (&item);
         break;
       case GST_ITERATOR_RESYNC:
@@ -774,10 +927,13 @@ debug_dump_header (GstBin * bin, GstDebugGraphDetails details, GString * str)
       "    pos=\"0,0!\",\n"
       "    margin=\"0.05,0.05\",\n"
       "    style=\"filled\",\n"
-      "    label=\"Legend\\lElement-States: [~] void-pending, [0] null, [-] ready, [=] paused, [>] playing\\lPad-Activation: [-] none, [>] push, [<] pull\\lPad-Flags: [b]locked, [f]lushing, [b]locking, [E]OS; upper-case is set\\lPad-Task: [T] has started task, [t] has paused task\\l\",\n"
+      "    label=\"Legend\\lElement-States: [~] void-pending, [0] null, [-] ready, [=] paused, [>] playing\\lPad-Activation: [-] none, [>] push, [<] pull\\lPad-Flags: [b]locked, [f]lushing, [b]locking, [E]OS; upper-case is set\\lPad-Task: [T] has started task, [t] has paused task\\l%s\",\n"
       "  ];"
       "\n", G_OBJECT_TYPE_NAME (bin), GST_OBJECT_NAME (bin),
-      (state_name ? state_name : ""), (param_name ? param_name : "")
+      (state_name ? state_name : ""), (param_name ? param_name : ""),
+      (debug_dump_show_stats (details) ?
+          "Element-Busy: time share since the previous graph, from white (idle) to red\\l" :
+          "")
       );
 
   if (state_name)
@@ -792,6 +948,22 @@ debug_dump_footer (GString * str)
   g_string_append_printf (str, "}\n");
 }
 
+static void
+debug_dump_bin (GstBin * bin, GstDebugGraphDetails details,
+    DebugDumpContext * ctx)
+{
+  ctx->caps_cache = g_hash_table_new_full (NULL, NULL,
+      (GDestroyNotify) gst_caps_unref, g_free);
+
+  debug_dump_header (bin, details, ctx->str);
+  debug_dump_element (bin, details, ctx, 1);
+  debug_dump_footer (ctx->str);
+  debug_dump_flush (ctx, TRUE);
+
+  g_hash_table_destroy (ctx->caps_cache);
+  ctx->caps_cache = NULL;
+}
+
 /*
  * gst_debug_bin_to_dot_data:
  * @bin: the top-level pipeline that should be analyzed
@@ -806,17 +978,101 @@ debug_dump_footer (GString * str)
 gchar *
 gst_debug_bin_to_dot_data (GstBin * bin, GstDebugGraphDetails details)
 {
-  GString *str;
+  DebugDumpContext ctx = { NULL, };
 
   g_return_val_if_fail (GST_IS_BIN (bin), NULL);
 
-  str = g_string_new (NULL);
+  ctx.str = g_string_new (NULL);
+  debug_dump_bin (bin, details, &ctx);
 
-  debug_dump_header (bin, details, str);
-  debug_dump_element (bin, details, str, 1);
-  debug_dump_footer (str);
+  return g_string_free (ctx.str, FALSE);
+}
 
-  return g_string_free (str, FALSE);
+static void
+debug_dump_to_file (GstBin * bin, GstDebugGraphDetails details,
+    const gchar * full_file_name)
+{
+  FILE *out;
+
+  if ((out = fopen (full_file_name, "wb"))) {
+    DebugDumpContext ctx = { NULL, };
+
+    /* write the graph while it is made instead of collecting it first */
+    ctx.str = g_string_sized_new (FLUSH_THRESHOLD);
+    ctx.out = out;
+    debug_dump_bin (bin, details, &ctx);
+    g_string_free (ctx.str, TRUE);
+    fclose (out);
+
+    GST_INFO ("wrote bin graph to : '%s'", full_file_name);
+  } else {
+    GST_WARNING ("Failed to open file '%s' for writing: %s", full_file_name,
+        g_strerror (errno));
+  }
+}
+
+/* dumps that are made in the background when GST_DEBUG_DUMP_DOT_ASYNC is
+ * set, one at a time so that they are written in order */
+typedef struct
+{
+  GstBin *bin;
+  GstDebugGraphDetails details;
+  gchar *full_file_name;
+} DebugDumpJob;
+
+static GMutex dump_lock;
+static GThreadPool *dump_pool;
+
+static void
+debug_dump_job_func (DebugDumpJob * job, gpointer user_data)
+{
+  debug_dump_to_file (job->bin, job->details, job->full_file_name);
+
+  gst_object_unref (job->bin);
+  g_free (job->full_file_name);
+  g_slice_free (DebugDumpJob, job);
+}
+
+static gboolean
+debug_dump_push_job (GstBin * bin, GstDebugGraphDetails details,
+    gchar * full_file_name)
+{
+  DebugDumpJob *job;
+  gboolean res = FALSE;
+
+  g_mutex_lock (&dump_lock);
+  if (dump_pool == NULL)
+    dump_pool = g_thread_pool_new ((GFunc) debug_dump_job_func, NULL, 1,
+        FALSE, NULL);
+  if (dump_pool != NULL) {
+    job = g_slice_new (DebugDumpJob);
+    job->bin = gst_object_ref (bin);
+    job->details = details;
+    job->full_file_name = full_file_name;
+    res = g_thread_pool_push (dump_pool, job, NULL);
+    if (!res) {
+      gst_object_unref (bin);
+      g_slice_free (DebugDumpJob, job);
+    }
+  }
+  g_mutex_unlock (&dump_lock);
+
+  return res;
+}
+
+/* waits for the dumps that are still pending */
+void
+_priv_gst_debug_utils_cleanup (void)
+{
+  GThreadPool *pool;
+
+  g_mutex_lock (&dump_lock);
+  pool = dump_pool;
+  dump_pool = NULL;
+  g_mutex_unlock (&dump_lock);
+
+  if (pool)
+    g_thread_pool_free (pool, FALSE, TRUE);
 }
 
 /*
@@ -830,13 +1086,16 @@ gst_debug_bin_to_dot_data (GstBin * bin, GstDebugGraphDetails details)
  * <informalexample><programlisting>
  *  dot -Tpng -oimage.png graph_lowlevel.dot
  * </programlisting></informalexample>
+ *
+ * When the GST_DEBUG_DUMP_DOT_ASYNC environment variable is set, the file is
+ * written by a background thread and this function returns right away. The
+ * graph then shows the pipeline as it is when the thread gets to it.
  */
 void
 gst_debug_bin_to_dot_file (GstBin * bin, GstDebugGraphDetails details,
     const gchar * file_name)
 {
   gchar *full_file_name = NULL;
-  FILE *out;
 
   g_return_if_fail (GST_IS_BIN (bin));
 
@@ -852,20 +1111,13 @@ gst_debug_bin_to_dot_file (GstBin * bin, GstDebugGraphDetails details,
   full_file_name = g_strdup_printf ("%s" G_DIR_SEPARATOR_S "%s.dot",
       priv_gst_dump_dot_dir, file_name);
 
-  if ((out = fopen (full_file_name, "wb"))) {
-    gchar *buf;
-
-    buf = gst_debug_bin_to_dot_data (bin, details);
-    fputs (buf, out);
-
-    g_free (buf);
-    fclose (out);
-
-    GST_INFO ("wrote bin graph to : '%s'", full_file_name);
-  } else {
-    GST_WARNING ("Failed to open file '%s' for writing: %s", full_file_name,
-        g_strerror (errno));
+  if (priv_gst_dump_dot_async) {
+    /* the job takes the file name */
+    if (debug_dump_push_job (bin, details, full_file_name))
+      return;
   }
+
+  debug_dump_to_file (bin, details, full_file_name);
   g_free (full_file_name);
 }
 
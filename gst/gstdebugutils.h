@@ -38,6 +38,13 @@ G_BEGIN_DECLS
  * @GST_DEBUG_GRAPH_SHOW_STATES: show element states
  * @GST_DEBUG_GRAPH_SHOW_FULL_PARAMS: show full element parameter values even
  *                                    if they are very long
+ * @GST_DEBUG_GRAPH_SHOW_STATS: show the buffer rates, queue levels, busy
+ *                              share and buffer pools measured by tracers
+ *                              such as "graphstats". This is not part of
+ *                              @GST_DEBUG_GRAPH_SHOW_ALL and
+ *                              @GST_DEBUG_GRAPH_SHOW_VERBOSE because getting
+ *                              the statistics starts a new measurement
+ *                              interval in the tracers (Since: 1.14)
  * @GST_DEBUG_GRAPH_SHOW_ALL: show all the typical details that one might want
  * @GST_DEBUG_GRAPH_SHOW_VERBOSE: show all details regardless of how large or
  *                                verbose they make the resulting output
@@ -51,8 +58,9 @@ typedef enum {
   GST_DEBUG_GRAPH_SHOW_NON_DEFAULT_PARAMS = (1<<2),
   GST_DEBUG_GRAPH_SHOW_STATES             = (1<<3),
   GST_DEBUG_GRAPH_SHOW_FULL_PARAMS        = (1<<4),
+  GST_DEBUG_GRAPH_SHOW_STATS              = (1<<5),
   GST_DEBUG_GRAPH_SHOW_ALL                = ((1<<4)-1),
-  GST_DEBUG_GRAPH_SHOW_VERBOSE            = (-1)
+  GST_DEBUG_GRAPH_SHOW_VERBOSE            = (~GST_DEBUG_GRAPH_SHOW_STATS)
 } GstDebugGraphDetails;
 
 
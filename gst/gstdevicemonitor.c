@@ -112,6 +112,16 @@ struct _GstDeviceMonitorPrivate
   guint last_id;
   GList *hidden;
   gboolean show_all;
+
+  /* the matching devices of the started providers. Kept up to date with the
+   * device messages while devices_active, returned by
+   * gst_device_monitor_get_devices() when devices_valid */
+  GList *devices;
+  gboolean devices_active;
+  gboolean devices_valid;
+
+  /* starts the providers concurrently */
+  GstTaskPool *start_pool;
 };
 
 #define DEFAULT_SHOW_ALL        FALSE
@@ -229,6 +239,52 @@ update_hidden_providers_list (GList ** hidden, GstDeviceProvider * provider)
   }
 }
 
+/* must be called with monitor lock */
+static gboolean
+device_matches_filters (GstDeviceMonitor * monitor, GstDevice * device)
+{
+  GstCaps *caps;
+  gboolean matches = FALSE;
+  guint i;
+
+  caps = gst_device_get_caps (device);
+  for (i = 0; i < monitor->priv->filters->len; i++) {
+    struct DeviceFilter *filter =
+        g_ptr_array_index (monitor->priv->filters, i);
+
+    if (gst_caps_can_intersect (filter->caps, caps) &&
+        gst_device_has_classesv (device, filter->classesv)) {
+      matches = TRUE;
+      break;
+    }
+  }
+  gst_caps_unref (caps);
+
+  return matches;
+}
+
+/* must be called with monitor lock, returns the device to unref when it was
+ * removed from the cached devices */
+static GstDevice *
+update_cached_devices (GstDeviceMonitor * monitor, GstMessageType type,
+    GstDevice * device)
+{
+  GList *find;
+
+  if (!monitor->priv->devices_active)
+    return NULL;
+
+  find = g_list_find (monitor->priv->devices, device);
+  if (type == GST_MESSAGE_DEVICE_ADDED && !find) {
+    monitor->priv->devices = g_list_append (monitor->priv->devices,
+        gst_object_ref (device));
+  } else if (type == GST_MESSAGE_DEVICE_REMOVED && find) {
+    monitor->priv->devices = g_list_delete_link (monitor->priv->devices, find);
+    return device;
+  }
+  return NULL;
+}
+
 static void
 bus_sync_message (GstBus * bus, GstMessage * message,
     GstDeviceMonitor * monitor)
@@ -237,7 +293,7 @@ bus_sync_message (GstBus * bus, GstMessage * message,
 
   if (type == GST_MESSAGE_DEVICE_ADDED || type == GST_MESSAGE_DEVICE_REMOVED) {
     gboolean matches;
-    GstDevice *device;
+    GstDevice *device, *removed = NULL;
     GstDeviceProvider *provider;
 
     if (type == GST_MESSAGE_DEVICE_ADDED)
@@ -251,27 +307,18 @@ bus_sync_message (GstBus * bus, GstMessage * message,
     if (is_provider_hidden (monitor, monitor->priv->hidden, provider)) {
       matches = FALSE;
     } else if (monitor->priv->filters->len) {
-      guint i;
-
-      for (i = 0; i < monitor->priv->filters->len; i++) {
-        struct DeviceFilter *filter =
-            g_ptr_array_index (monitor->priv->filters, i);
-        GstCaps *caps;
-
-        caps = gst_device_get_caps (device);
-        matches = gst_caps_can_intersect (filter->caps, caps) &&
-            gst_device_has_classesv (device, filter->classesv);
-        gst_caps_unref (caps);
-        if (matches)
-          break;
-      }
+      matches = device_matches_filters (monitor, device);
     } else {
       matches = TRUE;
     }
+    if (matches)
+      removed = update_cached_devices (monitor, type, device);
     GST_OBJECT_UNLOCK (monitor);
 
     gst_object_unref (provider);
     gst_object_unref (device);
+    if (removed)
+      gst_object_unref (removed);
 
     if (matches)
       gst_bus_post (monitor->priv->bus, gst_message_ref (message));
@@ -332,6 +379,12 @@ gst_device_monitor_dispose (GObject * object)
     self->priv->filters = NULL;
   }
 
+  if (self->priv->start_pool) {
+    gst_task_pool_cleanup (self->priv->start_pool);
+    gst_object_unref (self->priv->start_pool);
+    self->priv->start_pool = NULL;
+  }
+
   gst_object_replace ((GstObject **) & self->priv->bus, NULL);
 
   G_OBJECT_CLASS (gst_device_monitor_parent_class)->dispose (object);
@@ -344,6 +397,10 @@ gst_device_monitor_dispose (GObject * object)
  * Gets a list of devices from all of the relevant monitors. This may actually
  * probe the hardware if the monitor is not currently started.
  *
+ * When the monitor is started, this returns the devices found when it was
+ * started, updated with the devices that were added and removed since then,
+ * without calling the providers.
+ *
  * Returns: (transfer full) (element-type GstDevice): a #GList of
  *   #GstDevice
  *
@@ -353,7 +410,7 @@ gst_device_monitor_dispose (GObject * object)
 GList *
 gst_device_monitor_get_devices (GstDeviceMonitor * monitor)
 {
-  GList *devices = NULL, *hidden = NULL;
+  GList *devices = NULL, *hidden = NULL, *old = NULL;
   guint i;
   guint cookie;
 
@@ -373,6 +430,13 @@ gst_device_monitor_get_devices (GstDeviceMonitor * monitor)
     return FALSE;
   }
 
+  if (monitor->priv->devices_valid) {
+    devices = g_list_copy_deep (monitor->priv->devices,
+        (GCopyFunc) gst_object_ref, NULL);
+    GST_OBJECT_UNLOCK (monitor);
+    return devices;
+  }
+
 again:
 
   g_list_free_full (devices, gst_object_unref);
@@ -402,20 +466,9 @@ again:
 
     for (item = tmpdev; item; item = item->next) {
       GstDevice *dev = GST_DEVICE (item->data);
-      GstCaps *caps = gst_device_get_caps (dev);
-      guint j;
-
-      for (j = 0; j < monitor->priv->filters->len; j++) {
-        struct DeviceFilter *filter =
-            g_ptr_array_index (monitor->priv->filters, j);
 
-        if (gst_caps_can_intersect (filter->caps, caps) &&
-            gst_device_has_classesv (dev, filter->classesv)) {
-          devices = g_list_prepend (devices, gst_object_ref (dev));
-          break;
-        }
-      }
-      gst_caps_unref (caps);
+      if (device_matches_filters (monitor, dev))
+        devices = g_list_prepend (devices, gst_object_ref (dev));
     }
 
     g_list_free_full (tmpdev, gst_object_unref);
@@ -425,10 +478,179 @@ again:
       goto again;
   }
   g_list_free_full (hidden, g_free);
+  devices = g_list_reverse (devices);
+
+  /* the cache was invalidated by a change of the hidden providers */
+  if (monitor->priv->devices_active) {
+    old = monitor->priv->devices;
+    monitor->priv->devices = g_list_copy_deep (devices,
+        (GCopyFunc) gst_object_ref, NULL);
+    monitor->priv->devices_valid = TRUE;
+  }
 
   GST_OBJECT_UNLOCK (monitor);
 
-  return g_list_reverse (devices);
+  g_list_free_full (old, gst_object_unref);
+
+  return devices;
+}
+
+typedef struct
+{
+  GstDeviceProvider *provider;
+  gboolean ret;
+  gboolean started;
+  GList *devices;
+
+  /* the default task pool can't join its tasks, the pushed jobs count
+   * down n_pending when they are done */
+  GMutex *lock;
+  GCond *cond;
+  guint *n_pending;
+} ProviderStart;
+
+static void
+provider_start_free (ProviderStart * job)
+{
+  g_list_free_full (job->devices, gst_object_unref);
+  gst_object_unref (job->provider);
+  g_slice_free (ProviderStart, job);
+}
+
+static void
+provider_start_func (ProviderStart * job)
+{
+  if (gst_device_provider_can_monitor (job->provider)) {
+    job->ret = job->started = gst_device_provider_start (job->provider);
+  } else {
+    job->ret = TRUE;
+  }
+  /* only copies the list of started providers, probes the others */
+  if (job->ret)
+    job->devices = gst_device_provider_get_devices (job->provider);
+
+  if (job->n_pending) {
+    g_mutex_lock (job->lock);
+    if (--(*job->n_pending) == 0)
+      g_cond_signal (job->cond);
+    g_mutex_unlock (job->lock);
+  }
+}
+
+/* start @providers concurrently on @pool, the results are added to @results.
+ * Returns FALSE when a provider could not be started. Must be called without
+ * the monitor lock. */
+static gboolean
+start_providers (GstDeviceMonitor * monitor, GstTaskPool * pool,
+    GList * providers, GHashTable * results)
+{
+  GMutex lock;
+  GCond cond;
+  guint n_pending = 0;
+  ProviderStart *last = NULL;
+  gboolean ret = TRUE;
+  GList *walk;
+
+  g_mutex_init (&lock);
+  g_cond_init (&cond);
+
+  /* start all providers but the last one in the pool, the last one is started
+   * in this thread */
+  for (walk = providers; walk; walk = walk->next) {
+    ProviderStart *job = g_slice_new0 (ProviderStart);
+
+    job->provider = gst_object_ref (walk->data);
+    g_hash_table_insert (results, job->provider, job);
+
+    if (last && pool) {
+      GError *err = NULL;
+
+      last->lock = &lock;
+      last->cond = &cond;
+      last->n_pending = &n_pending;
+      g_mutex_lock (&lock);
+      n_pending++;
+      g_mutex_unlock (&lock);
+
+      gst_task_pool_push (pool, (GstTaskPoolFunction) provider_start_func,
+          last, &err);
+      if (err) {
+        GST_WARNING_OBJECT (monitor, "failed to push to pool: %s",
+            err->message);
+        g_clear_error (&err);
+        g_mutex_lock (&lock);
+        n_pending--;
+        g_mutex_unlock (&lock);
+        last->n_pending = NULL;
+        provider_start_func (last);
+      }
+    } else if (last) {
+      provider_start_func (last);
+    }
+    last = job;
+  }
+  if (last)
+    provider_start_func (last);
+
+  g_mutex_lock (&lock);
+  while (n_pending > 0)
+    g_cond_wait (&cond, &lock);
+  g_mutex_unlock (&lock);
+
+  g_mutex_clear (&lock);
+  g_cond_clear (&cond);
+
+  for (walk = providers; walk; walk = walk->next) {
+    ProviderStart *job = g_hash_table_lookup (results, walk->data);
+
+    if (!job->ret) {
+      GST_WARNING_OBJECT (monitor, "provider %" GST_PTR_FORMAT
+          " failed to start", job->provider);
+      ret = FALSE;
+    }
+  }
+
+  return ret;
+}
+
+/* must be called with monitor lock, put the devices found while starting in
+ * the cache */
+static void
+fill_cached_devices (GstDeviceMonitor * monitor, GHashTable * results)
+{
+  GList *devices = NULL, *hidden = NULL, *item;
+  guint i;
+
+  for (i = 0; i < monitor->priv->providers->len; i++) {
+    GstDeviceProvider *provider =
+        g_ptr_array_index (monitor->priv->providers, i);
+    ProviderStart *job = g_hash_table_lookup (results, provider);
+
+    if (job == NULL || is_provider_hidden (monitor, hidden, provider))
+      continue;
+
+    update_hidden_providers_list (&hidden, provider);
+
+    for (item = job->devices; item; item = item->next) {
+      GstDevice *dev = GST_DEVICE (item->data);
+
+      /* removed again before the cache was filled */
+      if (job->started && !gst_object_has_as_parent (GST_OBJECT_CAST (dev),
+              GST_OBJECT_CAST (provider)))
+        continue;
+      /* already added by a message */
+      if (g_list_find (monitor->priv->devices, dev))
+        continue;
+
+      if (device_matches_filters (monitor, dev))
+        devices = g_list_prepend (devices, gst_object_ref (dev));
+    }
+  }
+  g_list_free_full (hidden, g_free);
+
+  monitor->priv->devices = g_list_concat (g_list_reverse (devices),
+      monitor->priv->devices);
+  monitor->priv->devices_valid = TRUE;
 }
 
 /**
@@ -449,6 +671,9 @@ gst_device_monitor_start (GstDeviceMonitor * monitor)
 {
   guint cookie, i;
   GList *pending = NULL, *started = NULL, *removed = NULL;
+  GHashTable *results;
+  GstTaskPool *pool;
+  gboolean ret;
 
   g_return_val_if_fail (GST_IS_DEVICE_MONITOR (monitor), FALSE);
 
@@ -470,6 +695,11 @@ gst_device_monitor_start (GstDeviceMonitor * monitor)
 
   gst_bus_set_flushing (monitor->priv->bus, FALSE);
 
+  /* from now on the device messages update the cache */
+  monitor->priv->devices_active = TRUE;
+  results = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) provider_start_free);
+
 again:
   cookie = monitor->priv->cookie;
 
@@ -497,44 +727,71 @@ again:
   g_list_free_full (removed, gst_object_unref);
   removed = NULL;
 
-  while (pending) {
-    GstDeviceProvider *provider = pending->data;
+  if (pending) {
+    if (pending->next && !monitor->priv->start_pool) {
+      GError *err = NULL;
+
+      monitor->priv->start_pool = gst_task_pool_new ();
+      gst_task_pool_prepare (monitor->priv->start_pool, &err);
+      if (err) {
+        /* the providers are started in this thread then */
+        GST_WARNING_OBJECT (monitor, "failed to prepare pool: %s",
+            err->message);
+        g_clear_error (&err);
+        gst_object_unref (monitor->priv->start_pool);
+        monitor->priv->start_pool = NULL;
+      }
+    }
+    pool = monitor->priv->start_pool ?
+        gst_object_ref (monitor->priv->start_pool) : NULL;
+    GST_OBJECT_UNLOCK (monitor);
 
-    if (gst_device_provider_can_monitor (provider)) {
-      GST_OBJECT_UNLOCK (monitor);
+    ret = start_providers (monitor, pool, pending, results);
+    if (pool)
+      gst_object_unref (pool);
 
-      if (!gst_device_provider_start (provider))
-        goto start_failed;
+    GST_OBJECT_LOCK (monitor);
+    started = g_list_concat (started, pending);
+    pending = NULL;
 
-      GST_OBJECT_LOCK (monitor);
-    }
-    started = g_list_prepend (started, provider);
-    pending = g_list_delete_link (pending, pending);
+    if (!ret)
+      goto start_failed;
 
     if (monitor->priv->cookie != cookie)
       goto again;
   }
+  fill_cached_devices (monitor, results);
   monitor->priv->started = TRUE;
   GST_OBJECT_UNLOCK (monitor);
 
   g_list_free_full (started, gst_object_unref);
+  g_hash_table_unref (results);
 
   return TRUE;
 
 start_failed:
   {
-    GST_OBJECT_LOCK (monitor);
+    GList *devices;
+
     gst_bus_set_flushing (monitor->priv->bus, TRUE);
+    devices = monitor->priv->devices;
+    monitor->priv->devices = NULL;
+    monitor->priv->devices_active = FALSE;
     GST_OBJECT_UNLOCK (monitor);
 
+    g_list_free_full (devices, gst_object_unref);
+
     while (started) {
       GstDeviceProvider *provider = started->data;
+      ProviderStart *job = g_hash_table_lookup (results, provider);
 
-      gst_device_provider_stop (provider);
+      if (job && job->started)
+        gst_device_provider_stop (provider);
       gst_object_unref (provider);
 
       started = g_list_delete_link (started, started);
     }
+    g_hash_table_unref (results);
     return FALSE;
   }
 }
@@ -551,7 +808,7 @@ void
 gst_device_monitor_stop (GstDeviceMonitor * monitor)
 {
   guint i;
-  GList *started = NULL;
+  GList *started = NULL, *devices;
 
   g_return_if_fail (GST_IS_DEVICE_MONITOR (monitor));
 
@@ -578,8 +835,13 @@ gst_device_monitor_stop (GstDeviceMonitor * monitor)
 
   GST_OBJECT_LOCK (monitor);
   monitor->priv->started = FALSE;
+  devices = monitor->priv->devices;
+  monitor->priv->devices = NULL;
+  monitor->priv->devices_active = FALSE;
+  monitor->priv->devices_valid = FALSE;
   GST_OBJECT_UNLOCK (monitor);
 
+  g_list_free_full (devices, gst_object_unref);
 }
 
 static void
@@ -589,6 +851,7 @@ provider_hidden (GstDeviceProvider * provider, const gchar * hidden,
   GST_OBJECT_LOCK (monitor);
   monitor->priv->hidden =
       g_list_prepend (monitor->priv->hidden, g_strdup (hidden));
+  monitor->priv->devices_valid = FALSE;
   GST_OBJECT_UNLOCK (monitor);
 }
 
@@ -606,6 +869,7 @@ provider_unhidden (GstDeviceProvider * provider, const gchar * hidden,
     g_free (find->data);
     monitor->priv->hidden = g_list_delete_link (monitor->priv->hidden, find);
   }
+  monitor->priv->devices_valid = FALSE;
   GST_OBJECT_UNLOCK (monitor);
 }
 
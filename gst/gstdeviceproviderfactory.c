@@ -131,6 +131,31 @@ gst_device_provider_factory_find (const gchar * name)
   return NULL;
 }
 
+/* the metadata of factories loaded from the registry cache is only parsed
+ * the first time it is needed */
+static GstStructure *
+gst_device_provider_factory_get_metadata_structure (GstDeviceProviderFactory * factory)
+{
+  GstStructure *metadata;
+
+  metadata = g_atomic_pointer_get (&factory->metadata);
+  if (G_UNLIKELY (metadata == NULL && factory->metadata_string != NULL)) {
+    metadata = gst_structure_from_string (factory->metadata_string, NULL);
+    if (metadata == NULL) {
+      GST_WARNING_OBJECT (factory, "invalid metadata '%s'",
+          factory->metadata_string);
+      return NULL;
+    }
+    if (!g_atomic_pointer_compare_and_exchange (&factory->metadata, NULL,
+            metadata)) {
+      /* someone else was faster */
+      gst_structure_free (metadata);
+      metadata = g_atomic_pointer_get (&factory->metadata);
+    }
+  }
+  return metadata;
+}
+
 static void
 gst_device_provider_factory_cleanup (GstDeviceProviderFactory * factory)
 {
@@ -138,6 +163,7 @@ gst_device_provider_factory_cleanup (GstDeviceProviderFactory * factory)
     gst_structure_free ((GstStructure *) factory->metadata);
     factory->metadata = NULL;
   }
+  factory->metadata_string = NULL;
   if (factory->type) {
     factory->type = G_TYPE_INVALID;
   }
@@ -422,7 +448,13 @@ const gchar *
 gst_device_provider_factory_get_metadata (GstDeviceProviderFactory * factory,
     const gchar * key)
 {
-  return gst_structure_get_string ((GstStructure *) factory->metadata, key);
+  GstStructure *metadata;
+
+  metadata = gst_device_provider_factory_get_metadata_structure (factory);
+  if (metadata == NULL)
+    return NULL;
+
+  return gst_structure_get_string (metadata, key);
 }
 
 /**
@@ -447,7 +479,7 @@ gst_device_provider_factory_get_metadata_keys (GstDeviceProviderFactory *
 
   g_return_val_if_fail (GST_IS_DEVICE_PROVIDER_FACTORY (factory), NULL);
 
-  metadata = (GstStructure *) factory->metadata;
+  metadata = gst_device_provider_factory_get_metadata_structure (factory);
   if (metadata == NULL)
     return NULL;
 
@@ -571,14 +603,9 @@ device_provider_filter (GstPluginFeature * feature, GstRank * minrank)
 GList *
 gst_device_provider_factory_list_get_device_providers (GstRank minrank)
 {
-  GList *result;
-
-  /* get the feature list using the filter */
-  result = gst_registry_feature_filter (gst_registry_get (),
-      (GstPluginFeatureFilter) device_provider_filter, FALSE, &minrank);
-
-  /* sort on rank and name */
-  result = g_list_sort (result, gst_plugin_feature_rank_compare_func);
-
-  return result;
+  /* get the sorted feature list using the filter, the registry remembers
+   * the result for each minrank */
+  return _priv_gst_registry_get_feature_view (gst_registry_get (),
+      GST_TYPE_DEVICE_PROVIDER_FACTORY, 0, minrank,
+      (GstPluginFeatureFilter) device_provider_filter, &minrank);
 }
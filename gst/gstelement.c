@@ -85,6 +85,7 @@
 #include "gstelement.h"
 #include "gstelementmetadata.h"
 #include "gstenumtypes.h"
+#include "gstbin.h"
 #include "gstbus.h"
 #include "gsterror.h"
 #include "gstevent.h"
@@ -137,6 +138,7 @@ static gboolean gst_element_post_message_default (GstElement * element,
     GstMessage * message);
 static void gst_element_set_context_default (GstElement * element,
     GstContext * context);
+static gboolean gst_element_reset_default (GstElement * element);
 
 static gboolean gst_element_default_send_event (GstElement * element,
     GstEvent * event);
@@ -148,6 +150,7 @@ static GstPadTemplate
     element_class, const gchar * name);
 
 static void gst_element_call_async_func (gpointer data, gpointer user_data);
+static void gst_element_invalidate_pads_snapshot (GstElement * element);
 
 static GstObjectClass *parent_class = NULL;
 static guint gst_element_signals[LAST_SIGNAL] = { 0 };
@@ -157,6 +160,10 @@ static GThreadPool *gst_element_pool = NULL;
 /* this is used in gstelementfactory.c:gst_element_register() */
 GQuark __gst_elementclass_factory = 0;
 
+/* pristine instance of a type, used by gst_element_reset_default() */
+static GQuark __gst_element_prototype = 0;
+static GMutex prototype_lock;
+
 GType
 gst_element_get_type (void)
 {
@@ -182,6 +189,8 @@ gst_element_get_type (void)
 
     __gst_elementclass_factory =
         g_quark_from_static_string ("GST_ELEMENTCLASS_FACTORY");
+    __gst_element_prototype =
+        g_quark_from_static_string ("GST_ELEMENT_PROTOTYPE");
     g_once_init_leave (&gst_element_type, _type);
   }
   return gst_element_type;
@@ -264,6 +273,7 @@ gst_element_class_init (GstElementClass * klass)
   klass->numpadtemplates = 0;
   klass->post_message = GST_DEBUG_FUNCPTR (gst_element_post_message_default);
   klass->set_context = GST_DEBUG_FUNCPTR (gst_element_set_context_default);
+  klass->reset = GST_DEBUG_FUNCPTR (gst_element_reset_default);
 
   klass->elementfactory = NULL;
 
@@ -310,6 +320,7 @@ gst_element_init (GstElement * element)
   GST_STATE_NEXT (element) = GST_STATE_VOID_PENDING;
   GST_STATE_PENDING (element) = GST_STATE_VOID_PENDING;
   GST_STATE_RETURN (element) = GST_STATE_CHANGE_SUCCESS;
+  gst_element_publish_state (element);
 
   g_rec_mutex_init (&element->state_lock);
   g_cond_init (&element->state_cond);
@@ -709,6 +720,7 @@ gst_element_add_pad (GstElement * element, GstPad * pad)
   element->pads = g_list_append (element->pads, pad);
   element->numpads++;
   element->pads_cookie++;
+  gst_element_invalidate_pads_snapshot (element);
   GST_OBJECT_UNLOCK (element);
 
   /* emit the PAD_ADDED signal */
@@ -823,6 +835,7 @@ gst_element_remove_pad (GstElement * element, GstPad * pad)
   element->pads = g_list_remove (element->pads, pad);
   element->numpads--;
   element->pads_cookie++;
+  gst_element_invalidate_pads_snapshot (element);
   GST_OBJECT_UNLOCK (element);
 
   /* emit the PAD_REMOVED signal before unparenting and losing the last ref. */
@@ -1168,6 +1181,17 @@ gst_element_request_pad (GstElement * element,
   return _gst_element_request_pad (element, templ, name, caps);
 }
 
+/* with LOCK. The snapshot only holds refs to current pads, so this never
+ * drops the last ref of a pad */
+static void
+gst_element_invalidate_pads_snapshot (GstElement * element)
+{
+  if (element->ABI.abi.pads_snapshot) {
+    g_ptr_array_unref (element->ABI.abi.pads_snapshot);
+    element->ABI.abi.pads_snapshot = NULL;
+  }
+}
+
 static GstIterator *
 gst_element_iterate_pad_list (GstElement * element, GList ** padlist)
 {
@@ -1205,6 +1229,48 @@ gst_element_iterate_pads (GstElement * element)
   return gst_element_iterate_pad_list (element, &element->pads);
 }
 
+/**
+ * gst_element_iterate_pads_snapshot:
+ * @element: a #GstElement to iterate pads of.
+ *
+ * Retrieves an iterator of the pads @element has at the time of the call,
+ * in the order in which they were added.
+ *
+ * Unlike gst_element_iterate_pads(), the iterator never returns
+ * %GST_ITERATOR_RESYNC and does not take the lock of @element while
+ * iterating, pads added or removed after this call are not seen. The
+ * snapshot is shared between all iterators made while the pads don't
+ * change.
+ *
+ * Returns: (transfer full): the #GstIterator of #GstPad.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+GstIterator *
+gst_element_iterate_pads_snapshot (GstElement * element)
+{
+  GstIterator *result;
+  GPtrArray *array;
+  GList *walk;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), NULL);
+
+  GST_OBJECT_LOCK (element);
+  if (!(array = element->ABI.abi.pads_snapshot)) {
+    array = g_ptr_array_new_full (element->numpads,
+        (GDestroyNotify) gst_object_unref);
+    for (walk = element->pads; walk; walk = walk->next)
+      g_ptr_array_add (array, gst_object_ref (walk->data));
+    element->ABI.abi.pads_snapshot = array;
+  }
+  result = _priv_gst_iterator_new_array (GST_TYPE_PAD, array);
+  GST_OBJECT_UNLOCK (element);
+
+  return result;
+}
+
 /**
  * gst_element_iterate_src_pads:
  * @element: a #GstElement.
@@ -1828,7 +1894,7 @@ gst_element_send_event (GstElement * element, GstEvent * event)
 
   oclass = GST_ELEMENT_GET_CLASS (element);
 
-  GST_STATE_LOCK (element);
+  GST_STATE_LOCK_TRACED (element);
   if (oclass->send_event) {
     GST_CAT_DEBUG (GST_CAT_ELEMENT_PADS, "send %s event on element %s",
         GST_EVENT_TYPE_NAME (event), GST_ELEMENT_NAME (element));
@@ -2016,6 +2082,84 @@ gst_element_post_message (GstElement * element, GstMessage * message)
   return res;
 }
 
+/* check if @element passes its messages to its bus unchanged */
+static gboolean
+post_message_is_default (GstElement * element)
+{
+  GstElementClass *klass = GST_ELEMENT_GET_CLASS (element);
+  GstElementClass *bin_class;
+
+  if (klass->post_message == gst_element_post_message_default)
+    return TRUE;
+
+  /* GstBin only looks at its own state changes */
+  if (GST_IS_BIN (element)) {
+    bin_class = GST_ELEMENT_CLASS (g_type_class_peek (GST_TYPE_BIN));
+    return klass->post_message == bin_class->post_message;
+  }
+  return FALSE;
+}
+
+/**
+ * gst_element_accepts_message_type:
+ * @element: a #GstElement
+ * @type: a #GstMessageType
+ *
+ * Checks if a message of @type posted by @element would reach anyone. This
+ * is %FALSE when @element has no bus or when the message would be dropped
+ * by the message types of the bus of the toplevel bin, see
+ * gst_bus_set_message_types(). Elements can use this to avoid creating
+ * messages that nobody receives.
+ *
+ * This function is conservative, it returns %TRUE when @element or one of
+ * its parent bins could handle the message itself.
+ *
+ * Returns: %TRUE if a message of @type posted by @element could be used.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_element_accepts_message_type (GstElement * element, GstMessageType type)
+{
+  GstObject *parent;
+  GstBus *bus;
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), FALSE);
+
+  /* subclasses could do anything with the message */
+  if (!post_message_is_default (element))
+    return TRUE;
+
+  GST_OBJECT_LOCK (element);
+  if ((bus = GST_ELEMENT_BUS (element)))
+    gst_object_ref (bus);
+  if ((parent = GST_OBJECT_PARENT (element)))
+    gst_object_ref (parent);
+  GST_OBJECT_UNLOCK (element);
+
+  if (bus == NULL) {
+    res = FALSE;
+  } else if (!_priv_gst_bus_accepts_message_type (bus, type)) {
+    res = FALSE;
+  } else if (parent && GST_IS_BIN (parent)
+      && GST_BIN_CAST (parent)->child_bus == bus) {
+    /* the parent bin either handles the message or posts it itself */
+    res = _priv_gst_bin_accepts_message_type (GST_ELEMENT_CAST (parent), type);
+  } else {
+    res = TRUE;
+  }
+
+  if (bus)
+    gst_object_unref (bus);
+  if (parent)
+    gst_object_unref (parent);
+
+  return res;
+}
+
 /**
  * _gst_element_error_printf:
  * @format: (allow-none): the printf-like format to use, or %NULL
@@ -2529,6 +2673,7 @@ gst_element_abort_state (GstElement * element)
 
   /* flag error */
   GST_STATE_RETURN (element) = GST_STATE_CHANGE_FAILURE;
+  gst_element_publish_state (element);
 
   GST_STATE_BROADCAST (element);
   GST_OBJECT_UNLOCK (element);
@@ -2620,6 +2765,7 @@ gst_element_continue_state (GstElement * element, GstStateChangeReturn ret)
   GST_STATE_NEXT (element) = next;
   /* mark busy */
   GST_STATE_RETURN (element) = GST_STATE_CHANGE_ASYNC;
+  gst_element_publish_state (element);
   GST_OBJECT_UNLOCK (element);
 
   GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
@@ -2642,6 +2788,8 @@ gst_element_continue_state (GstElement * element, GstStateChangeReturn ret)
 nothing_pending:
   {
     GST_CAT_INFO_OBJECT (GST_CAT_STATES, element, "nothing pending");
+    /* the return value was still updated */
+    gst_element_publish_state (element);
     GST_OBJECT_UNLOCK (element);
     return ret;
   }
@@ -2649,6 +2797,7 @@ complete:
   {
     GST_STATE_PENDING (element) = GST_STATE_VOID_PENDING;
     GST_STATE_NEXT (element) = GST_STATE_VOID_PENDING;
+    gst_element_publish_state (element);
 
     GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
         "completed state change to %s", gst_element_state_get_name (pending));
@@ -2724,6 +2873,7 @@ gst_element_lost_state (GstElement * element)
   GST_STATE_NEXT (element) = new_state;
   GST_STATE_PENDING (element) = new_state;
   GST_STATE_RETURN (element) = GST_STATE_CHANGE_ASYNC;
+  gst_element_publish_state (element);
   GST_OBJECT_UNLOCK (element);
 
   _priv_gst_element_state_changed (element, new_state, new_state, new_state);
@@ -2748,6 +2898,92 @@ only_async_start:
   }
 }
 
+#define STATE_SNAPSHOT_SEQNUM_SHIFT 12
+#define STATE_SNAPSHOT_SEQNUM_MASK  0xfffff
+
+/**
+ * gst_element_publish_state:
+ * @element: a #GstElement
+ *
+ * Publish the current state, the pending state and the last return of
+ * @element so that they can be read with gst_element_get_state_snapshot()
+ * without taking any lock.
+ *
+ * The core state handling functions publish the state whenever they change
+ * it, this function only needs to be called by elements that modify the
+ * state fields of the #GstElement structure directly.
+ *
+ * This function must be called with the OBJECT_LOCK.
+ *
+ * Since: 1.14
+ */
+void
+gst_element_publish_state (GstElement * element)
+{
+  guint32 snapshot, seqnum;
+
+  g_return_if_fail (GST_IS_ELEMENT (element));
+
+  /* all writers hold the object lock, only the readers are lock-free */
+  snapshot = (guint32) g_atomic_int_get (&element->ABI.abi.state_snapshot);
+  seqnum = ((snapshot >> STATE_SNAPSHOT_SEQNUM_SHIFT) + 1) &
+      STATE_SNAPSHOT_SEQNUM_MASK;
+
+  snapshot = (seqnum << STATE_SNAPSHOT_SEQNUM_SHIFT) |
+      ((GST_STATE_RETURN (element) & 0xf) << 8) |
+      ((GST_STATE_PENDING (element) & 0xf) << 4) |
+      (GST_STATE (element) & 0xf);
+
+  g_atomic_int_set (&element->ABI.abi.state_snapshot, (gint) snapshot);
+}
+
+/**
+ * gst_element_get_state_snapshot:
+ * @element: a #GstElement to get the state of.
+ * @state: (out) (allow-none): a pointer to #GstState to hold the state.
+ *     Can be %NULL.
+ * @pending: (out) (allow-none): a pointer to #GstState to hold the pending
+ *     state. Can be %NULL.
+ * @seqnum: (out) (allow-none): a pointer to hold the sequence number of the
+ *     snapshot. Can be %NULL.
+ *
+ * Gets the last published state of @element without taking any lock and
+ * without waiting for an ongoing asynchronous state change, unlike
+ * gst_element_get_state() with a timeout of 0. This is meant for monitoring
+ * many elements periodically.
+ *
+ * @state, @pending and the returned value are always consistent with each
+ * other. @seqnum is incremented every time the state is published and wraps
+ * around after 2^20 updates, it can be used to detect that nothing changed
+ * since the previous snapshot.
+ *
+ * Returns: the last state change return of @element, %GST_STATE_CHANGE_ASYNC
+ *     when a state change is in progress.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+GstStateChangeReturn
+gst_element_get_state_snapshot (GstElement * element, GstState * state,
+    GstState * pending, guint32 * seqnum)
+{
+  guint32 snapshot;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), GST_STATE_CHANGE_FAILURE);
+
+  snapshot = (guint32) g_atomic_int_get (&element->ABI.abi.state_snapshot);
+
+  if (state)
+    *state = (GstState) (snapshot & 0xf);
+  if (pending)
+    *pending = (GstState) ((snapshot >> 4) & 0xf);
+  if (seqnum)
+    *seqnum = snapshot >> STATE_SNAPSHOT_SEQNUM_SHIFT;
+
+  return (GstStateChangeReturn) ((snapshot >> 8) & 0xf);
+}
+
 /**
  * gst_element_set_state:
  * @element: a #GstElement to change state of.
@@ -2806,7 +3042,7 @@ gst_element_set_state_func (GstElement * element, GstState state)
 
   /* state lock is taken to protect the set_state() and get_state()
    * procedures, it does not lock any variables. */
-  GST_STATE_LOCK (element);
+  GST_STATE_LOCK_TRACED (element);
 
   /* now calculate how to get to the new state */
   GST_OBJECT_LOCK (element);
@@ -2876,6 +3112,8 @@ gst_element_set_state_func (GstElement * element, GstState state)
       (next != state ? "intermediate" : "final"),
       gst_element_state_get_name (current), gst_element_state_get_name (next));
 
+  gst_element_publish_state (element);
+
   /* now signal any waiters, they will error since the cookie was incremented */
   GST_STATE_BROADCAST (element);
 
@@ -2893,6 +3131,7 @@ gst_element_set_state_func (GstElement * element, GstState state)
 was_busy:
   {
     GST_STATE_RETURN (element) = GST_STATE_CHANGE_ASYNC;
+    gst_element_publish_state (element);
     GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element,
         "element was busy with async state change");
     GST_OBJECT_UNLOCK (element);
@@ -3000,6 +3239,7 @@ invalid_return:
     /* we are in error now */
     ret = GST_STATE_CHANGE_FAILURE;
     GST_STATE_RETURN (element) = ret;
+    gst_element_publish_state (element);
     GST_OBJECT_UNLOCK (element);
 
     return ret;
@@ -3215,6 +3455,144 @@ gst_element_get_factory (GstElement * element)
   return GST_ELEMENT_GET_CLASS (element)->elementfactory;
 }
 
+static GstElement *
+gst_element_get_prototype (GType type)
+{
+  GstElement *prototype;
+
+  g_mutex_lock (&prototype_lock);
+  prototype = g_type_get_qdata (type, __gst_element_prototype);
+  if (prototype == NULL) {
+    prototype = gst_object_ref_sink (g_object_new (type, NULL));
+    /* kept for the lifetime of the type */
+    GST_OBJECT_FLAG_SET (prototype, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+    g_type_set_qdata (type, __gst_element_prototype, prototype);
+  }
+  g_mutex_unlock (&prototype_lock);
+
+  return prototype;
+}
+
+/* restore all properties of the subclasses to the values of a newly created
+ * instance, the properties of GstObject, like the name, are left alone.
+ * Instance init functions often override the default of the param spec, so
+ * take the values from a pristine instance. Objects can't be shared with that
+ * instance and get the default of the param spec instead. */
+static gboolean
+gst_element_reset_default (GstElement * element)
+{
+  GstElement *prototype = NULL;
+  GParamSpec **pspecs;
+  guint i, n_pspecs;
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (element),
+      &n_pspecs);
+
+  g_object_freeze_notify (G_OBJECT (element));
+  for (i = 0; i < n_pspecs; i++) {
+    GParamSpec *pspec = pspecs[i];
+    GValue value = G_VALUE_INIT;
+
+    if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+        (pspec->flags & (G_PARAM_CONSTRUCT_ONLY | G_PARAM_DEPRECATED)))
+      continue;
+    if (g_type_is_a (GST_TYPE_ELEMENT, pspec->owner_type))
+      continue;
+
+    g_value_init (&value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+    if (G_VALUE_HOLDS_OBJECT (&value)) {
+      g_param_value_set_default (pspec, &value);
+    } else {
+      if (prototype == NULL)
+        prototype = gst_element_get_prototype (G_OBJECT_TYPE (element));
+      g_object_get_property (G_OBJECT (prototype), pspec->name, &value);
+    }
+    g_object_set_property (G_OBJECT (element), pspec->name, &value);
+    g_value_unset (&value);
+  }
+  g_object_thaw_notify (G_OBJECT (element));
+  g_free (pspecs);
+
+  return TRUE;
+}
+
+/**
+ * gst_element_reset:
+ * @element: a #GstElement in the NULL state
+ *
+ * Restore @element to the condition of a newly created instance so that it
+ * can be used again, for example in another pipeline. This releases all
+ * request pads, removes the contexts, the clock, the base and start time and
+ * the locked state flag and then calls the reset vmethod of the element.
+ *
+ * The default implementation sets all writable properties of the element
+ * back to the values of a newly created instance. Elements that keep other state beyond the
+ * NULL state should override it and chain up, or return %FALSE if they can't
+ * be reused.
+ *
+ * The name, the parent and the links of @element are not changed.
+ *
+ * Returns: %TRUE if @element was reset and can be reused.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_element_reset (GstElement * element)
+{
+  GstElementClass *oclass;
+  GList *pads = NULL, *l;
+  gboolean res = TRUE;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), FALSE);
+
+  GST_STATE_LOCK_TRACED (element);
+  if (GST_STATE (element) != GST_STATE_NULL ||
+      GST_STATE_PENDING (element) != GST_STATE_VOID_PENDING)
+    goto wrong_state;
+
+  GST_OBJECT_LOCK (element);
+  for (l = element->pads; l; l = l->next) {
+    GstPadTemplate *templ = GST_PAD_PAD_TEMPLATE (l->data);
+
+    if (templ && GST_PAD_TEMPLATE_PRESENCE (templ) == GST_PAD_REQUEST)
+      pads = g_list_prepend (pads, gst_object_ref (l->data));
+  }
+  element->base_time = 0;
+  element->start_time = 0;
+  GST_OBJECT_FLAG_UNSET (element, GST_ELEMENT_FLAG_LOCKED_STATE);
+  g_list_free_full (element->contexts, (GDestroyNotify) gst_context_unref);
+  element->contexts = NULL;
+  GST_OBJECT_UNLOCK (element);
+
+  for (l = pads; l; l = l->next) {
+    /* releasing a pad can remove others */
+    if (GST_PAD_PARENT (l->data) == element)
+      gst_element_release_request_pad (element, l->data);
+  }
+  g_list_free_full (pads, gst_object_unref);
+
+  gst_element_set_clock (element, NULL);
+
+  oclass = GST_ELEMENT_GET_CLASS (element);
+  if (oclass->reset)
+    res = oclass->reset (element);
+  GST_STATE_UNLOCK (element);
+
+  GST_DEBUG_OBJECT (element, "reset: %d", res);
+
+  return res;
+
+  /* ERRORS */
+wrong_state:
+  {
+    GST_STATE_UNLOCK (element);
+    GST_WARNING_OBJECT (element, "can only reset elements in the NULL state");
+    return FALSE;
+  }
+}
+
 static void
 gst_element_dispose (GObject * object)
 {
@@ -3269,6 +3647,7 @@ gst_element_dispose (GObject * object)
   gst_object_replace ((GstObject **) clock_p, NULL);
   gst_object_replace ((GstObject **) bus_p, NULL);
   g_list_free_full (element->contexts, (GDestroyNotify) gst_context_unref);
+  gst_element_invalidate_pads_snapshot (element);
   GST_OBJECT_UNLOCK (element);
 
   GST_CAT_INFO_OBJECT (GST_CAT_REFCOUNTING, element, "%p parent class dispose",
@@ -654,7 +654,16 @@ struct _GstElement
   GList                *contexts;
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING-1];
+  union {
+    gpointer _gst_reserved[GST_PADDING-1];
+    struct {
+      /* current, pending and last return with a sequence number, see
+       * gst_element_publish_state() */
+      gint state_snapshot;
+      /* see gst_element_iterate_pads_snapshot() */
+      GPtrArray *pads_snapshot;
+    } abi;
+  } ABI;
 };
 
 /**
@@ -679,6 +688,8 @@ struct _GstElement
  * @post_message: called when a message is posted on the element. Chain up to
  *                the parent class' handler to have it posted on the bus.
  * @set_context: set a #GstContext on the element
+ * @reset: called by gst_element_reset() in the NULL state to restore the
+ *         element to the condition of a newly created instance. Since: 1.14
  *
  * GStreamer element class. Override the vmethods to implement the element
  * functionality.
@@ -739,8 +750,10 @@ struct _GstElementClass
 
   void                  (*set_context)          (GstElement *element, GstContext *context);
 
+  gboolean              (*reset)                (GstElement *element);
+
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING_LARGE-2];
+  gpointer _gst_reserved[GST_PADDING_LARGE-3];
 };
 
 /* element class pad templates */
@@ -903,6 +916,9 @@ void                    gst_element_release_request_pad (GstElement *element, Gs
 GST_EXPORT
 GstIterator *           gst_element_iterate_pads        (GstElement * element);
 
+GST_EXPORT
+GstIterator *           gst_element_iterate_pads_snapshot (GstElement * element);
+
 GST_EXPORT
 GstIterator *           gst_element_iterate_src_pads    (GstElement * element);
 
@@ -956,6 +972,9 @@ gboolean                gst_element_query               (GstElement *element, Gs
 GST_EXPORT
 gboolean                gst_element_post_message        (GstElement * element, GstMessage * message);
 
+GST_EXPORT
+gboolean                gst_element_accepts_message_type (GstElement * element, GstMessageType type);
+
 /* error handling */
 /* gcc versions < 3.3 warn about NULL being passed as format to printf */
 #if (!defined(__GNUC__) || (__GNUC__ < 3) || (__GNUC__ == 3 && __GNUC_MINOR__ < 3))
@@ -1010,6 +1029,15 @@ GstStateChangeReturn    gst_element_continue_state      (GstElement * element,
 GST_EXPORT
 void                    gst_element_lost_state          (GstElement * element);
 
+GST_EXPORT
+void                    gst_element_publish_state       (GstElement * element);
+
+GST_EXPORT
+GstStateChangeReturn    gst_element_get_state_snapshot  (GstElement * element,
+                                                         GstState * state,
+                                                         GstState * pending,
+                                                         guint32 * seqnum);
+
 
 typedef void          (*GstElementCallAsyncFunc)        (GstElement * element,
                                                          gpointer     user_data);
@@ -1023,6 +1051,9 @@ void                    gst_element_call_async          (GstElement * element,
 GST_EXPORT
 GstElementFactory*      gst_element_get_factory         (GstElement *element);
 
+GST_EXPORT
+gboolean                gst_element_reset               (GstElement *element);
+
 /* utility functions */
 
 GST_EXPORT
@@ -56,6 +56,8 @@
 
 #include "gst_private.h"
 
+#include <stdlib.h>
+
 #include "gstelement.h"
 #include "gstelementmetadata.h"
 #include "gstinfo.h"
@@ -104,6 +106,11 @@ gst_element_factory_init (GstElementFactory * factory)
   factory->uri_protocols = NULL;
 
   factory->interfaces = NULL;
+
+  factory->caps_matcher = NULL;
+
+  g_queue_init (&factory->pool);
+  factory->pool_size = 0;
 }
 
 static void
@@ -111,6 +118,8 @@ gst_element_factory_finalize (GObject * object)
 {
   GstElementFactory *factory = GST_ELEMENT_FACTORY (object);
 
+  g_queue_foreach (&factory->pool, (GFunc) gst_object_unref, NULL);
+  g_queue_clear (&factory->pool);
   gst_element_factory_cleanup (factory);
   G_OBJECT_CLASS (gst_element_factory_parent_class)->finalize (object);
 }
@@ -143,15 +152,220 @@ gst_element_factory_find (const gchar * name)
   return NULL;
 }
 
+/* The caps matcher contains the media types of the caps of each static pad
+ * template so that templates that can't match some caps can be rejected
+ * without doing a full caps intersection. Structures can only intersect when
+ * they have the same name. */
+typedef struct
+{
+  /* template caps are ANY, no quick rejection possible */
+  gboolean any;
+
+  /* sorted structure name quarks of the template caps */
+  GQuark *names;
+  guint n_names;
+} GstCapsMatcherTemplate;
+
+typedef struct
+{
+  guint n_templates;
+  GstCapsMatcherTemplate templates[1];
+} GstCapsMatcher;
+
+static gint
+compare_quarks (gconstpointer a, gconstpointer b)
+{
+  GQuark qa = *(const GQuark *) a, qb = *(const GQuark *) b;
+
+  return (qa > qb) - (qa < qb);
+}
+
+static gboolean
+caps_matcher_template_has_name (const GstCapsMatcherTemplate * mtempl,
+    GQuark name)
+{
+  return bsearch (&name, mtempl->names, mtempl->n_names, sizeof (GQuark),
+      compare_quarks) != NULL;
+}
+
+static GstCapsMatcher *
+caps_matcher_new (GstElementFactory * factory)
+{
+  GstCapsMatcher *matcher;
+  GList *item;
+  guint i, j, n;
+
+  n = g_list_length (factory->staticpadtemplates);
+  matcher = g_malloc0 (sizeof (GstCapsMatcher) +
+      MAX (n, 1) * sizeof (GstCapsMatcherTemplate));
+  matcher->n_templates = n;
+
+  for (i = 0, item = factory->staticpadtemplates; item; item = item->next, i++) {
+    GstStaticPadTemplate *templ = item->data;
+    GstCapsMatcherTemplate *mtempl = &matcher->templates[i];
+    GstCaps *caps;
+    guint len;
+
+    caps = gst_static_caps_get (&templ->static_caps);
+    if (caps == NULL || gst_caps_is_any (caps)) {
+      mtempl->any = TRUE;
+    } else {
+      len = gst_caps_get_size (caps);
+      mtempl->names = g_new (GQuark, MAX (len, 1));
+      for (j = 0; j < len; j++) {
+        mtempl->names[j] =
+            gst_structure_get_name_id (gst_caps_get_structure (caps, j));
+      }
+      qsort (mtempl->names, len, sizeof (GQuark), compare_quarks);
+      mtempl->n_names = len;
+    }
+    if (caps)
+      gst_caps_unref (caps);
+  }
+
+  return matcher;
+}
+
+static void
+caps_matcher_free (GstCapsMatcher * matcher)
+{
+  guint i;
+
+  for (i = 0; i < matcher->n_templates; i++)
+    g_free (matcher->templates[i].names);
+  g_free (matcher);
+}
+
+static GstCapsMatcher *
+caps_matcher_get (GstElementFactory * factory)
+{
+  GstCapsMatcher *matcher;
+
+  matcher = g_atomic_pointer_get (&factory->caps_matcher);
+  if (G_UNLIKELY (matcher == NULL)) {
+    matcher = caps_matcher_new (factory);
+    if (!g_atomic_pointer_compare_and_exchange (&factory->caps_matcher, NULL,
+            matcher)) {
+      /* someone else was faster */
+      caps_matcher_free (matcher);
+      matcher = g_atomic_pointer_get (&factory->caps_matcher);
+    }
+  }
+  return matcher;
+}
+
+static void
+caps_matcher_clear (GstElementFactory * factory)
+{
+  GstCapsMatcher *matcher;
+
+  matcher = g_atomic_pointer_get (&factory->caps_matcher);
+  if (matcher) {
+    g_atomic_pointer_set (&factory->caps_matcher, NULL);
+    caps_matcher_free (matcher);
+  }
+}
+
+/* check if one of the static pad templates of @factory in @direction can
+ * intersect with @caps, or has @caps as a subset when @subsetonly is %TRUE */
+gboolean
+__gst_element_factory_can_accept_caps (GstElementFactory * factory,
+    const GstCaps * caps, GstPadDirection direction, gboolean subsetonly)
+{
+  GstCapsMatcher *matcher;
+  GList *item;
+  GQuark *names = NULL;
+  guint i, j, n_names = 0;
+  gboolean res = FALSE;
+
+  /* ANY and empty caps are handled by the caps functions directly */
+  if (!gst_caps_is_any (caps) && !gst_caps_is_empty (caps)) {
+    n_names = gst_caps_get_size (caps);
+    names = g_newa (GQuark, n_names);
+    for (j = 0; j < n_names; j++)
+      names[j] = gst_structure_get_name_id (gst_caps_get_structure (caps, j));
+  }
+
+  matcher = caps_matcher_get (factory);
+
+  for (i = 0, item = factory->staticpadtemplates;
+      item && i < matcher->n_templates; item = item->next, i++) {
+    GstStaticPadTemplate *templ = item->data;
+    GstCapsMatcherTemplate *mtempl = &matcher->templates[i];
+    GstCaps *tmpl_caps;
+
+    if (templ->direction != direction)
+      continue;
+
+    if (names && !mtempl->any) {
+      gboolean found_any = FALSE, found_all = TRUE;
+
+      for (j = 0; j < n_names; j++) {
+        if (caps_matcher_template_has_name (mtempl, names[j]))
+          found_any = TRUE;
+        else
+          found_all = FALSE;
+      }
+      /* for a subset all structures need a template structure with the same
+       * name, for an intersection one of them is enough */
+      if (subsetonly ? !found_all : !found_any) {
+        GST_TRACE_OBJECT (factory, "template %s rejected by media type",
+            templ->name_template);
+        continue;
+      }
+    }
+
+    tmpl_caps = gst_static_caps_get (&templ->static_caps);
+    if (subsetonly)
+      res = gst_caps_is_subset (caps, tmpl_caps);
+    else
+      res = gst_caps_can_intersect (caps, tmpl_caps);
+    gst_caps_unref (tmpl_caps);
+
+    if (res)
+      break;
+  }
+
+  return res;
+}
+
+/* the metadata of factories loaded from the registry cache is only parsed
+ * the first time it is needed */
+static GstStructure *
+gst_element_factory_get_metadata_structure (GstElementFactory * factory)
+{
+  GstStructure *metadata;
+
+  metadata = g_atomic_pointer_get (&factory->metadata);
+  if (G_UNLIKELY (metadata == NULL && factory->metadata_string != NULL)) {
+    metadata = gst_structure_from_string (factory->metadata_string, NULL);
+    if (metadata == NULL) {
+      GST_WARNING_OBJECT (factory, "invalid metadata '%s'",
+          factory->metadata_string);
+      return NULL;
+    }
+    if (!g_atomic_pointer_compare_and_exchange (&factory->metadata, NULL,
+            metadata)) {
+      /* someone else was faster */
+      gst_structure_free (metadata);
+      metadata = g_atomic_pointer_get (&factory->metadata);
+    }
+  }
+  return metadata;
+}
+
 static void
 gst_element_factory_cleanup (GstElementFactory * factory)
 {
   GList *item;
 
+  caps_matcher_clear (factory);
+
   if (factory->metadata) {
     gst_structure_free ((GstStructure *) factory->metadata);
     factory->metadata = NULL;
   }
+  factory->metadata_string = NULL;
   if (factory->type) {
     factory->type = G_TYPE_INVALID;
   }
@@ -333,6 +547,9 @@ detailserror:
  * It will be given the name supplied, since all elements require a name as
  * their first argument.
  *
+ * When the pool of @factory contains recycled elements, one of them is
+ * returned instead of a new instance, see gst_element_factory_set_pool_size().
+ *
  * Returns: (transfer floating) (nullable): new #GstElement or %NULL
  *     if the element couldn't be created
  */
@@ -354,6 +571,21 @@ gst_element_factory_create (GstElementFactory * factory, const gchar * name)
 
   factory = newfactory;
 
+  GST_OBJECT_LOCK (factory);
+  element = g_queue_pop_head (&factory->pool);
+  GST_OBJECT_UNLOCK (factory);
+
+  if (element) {
+    GST_INFO ("reusing element %" GST_PTR_FORMAT " of \"%s\"", element,
+        GST_OBJECT_NAME (factory));
+    /* nobody else can own the element, update the name before handing
+     * it out again. A NULL name creates a new default name */
+    gst_object_set_name (GST_OBJECT_CAST (element), name);
+    g_object_force_floating (G_OBJECT (element));
+    gst_object_unref (factory);
+    return element;
+  }
+
   if (name)
     GST_INFO ("creating element \"%s\" named \"%s\"",
         GST_OBJECT_NAME (factory), GST_STR_NULL (name));
@@ -411,6 +643,150 @@ no_element:
   }
 }
 
+/**
+ * gst_element_factory_set_pool_size:
+ * @factory: a #GstElementFactory
+ * @size: the maximum number of recycled elements to keep
+ *
+ * Configure how many elements recycled with gst_element_recycle() @factory
+ * keeps around for reuse by gst_element_factory_create(). A @size of 0, the
+ * default, disables the pool. Lowering the size frees the elements that no
+ * longer fit in the pool.
+ *
+ * Reusing elements avoids the cost of constructing and disposing them, which
+ * matters for applications that build many short lived pipelines.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+void
+gst_element_factory_set_pool_size (GstElementFactory * factory, guint size)
+{
+  GList *drop = NULL;
+
+  g_return_if_fail (GST_IS_ELEMENT_FACTORY (factory));
+
+  GST_OBJECT_LOCK (factory);
+  factory->pool_size = size;
+  while (factory->pool.length > size)
+    drop = g_list_prepend (drop, g_queue_pop_tail (&factory->pool));
+  GST_OBJECT_UNLOCK (factory);
+
+  g_list_free_full (drop, gst_object_unref);
+}
+
+/**
+ * gst_element_factory_get_pool_size:
+ * @factory: a #GstElementFactory
+ *
+ * Get the maximum number of recycled elements kept by @factory.
+ *
+ * Returns: the pool size of @factory.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+guint
+gst_element_factory_get_pool_size (GstElementFactory * factory)
+{
+  guint size;
+
+  g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), 0);
+
+  GST_OBJECT_LOCK (factory);
+  size = factory->pool_size;
+  GST_OBJECT_UNLOCK (factory);
+
+  return size;
+}
+
+static gboolean
+gst_element_is_unlinked (GstElement * element)
+{
+  gboolean res = TRUE;
+  GList *l;
+
+  GST_OBJECT_LOCK (element);
+  for (l = element->pads; l && res; l = l->next) {
+    if (GST_PAD_IS_LINKED (l->data))
+      res = FALSE;
+  }
+  GST_OBJECT_UNLOCK (element);
+
+  return res;
+}
+
+/**
+ * gst_element_recycle:
+ * @element: (transfer full): a #GstElement
+ *
+ * Give @element back to the factory that created it so that
+ * gst_element_factory_create() can reuse it, see
+ * gst_element_factory_set_pool_size().
+ *
+ * The element is only kept when it is in the NULL state, has no parent, no
+ * linked pads, no other references and when gst_element_reset() succeeds.
+ * Otherwise, or when the pool is full, @element is unreffed.
+ *
+ * Bins are recycled together with their children, this is only useful for
+ * bins that create their children themselves.
+ *
+ * Returns: %TRUE if @element was added to the pool.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_element_recycle (GstElement * element)
+{
+  GstElementFactory *factory;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), FALSE);
+
+  factory = GST_ELEMENT_GET_CLASS (element)->elementfactory;
+  if (factory == NULL || gst_element_factory_get_pool_size (factory) == 0)
+    goto drop;
+
+  if (GST_OBJECT_REFCOUNT_VALUE (element) != 1 ||
+      GST_OBJECT_PARENT (element) != NULL || !gst_element_is_unlinked (element))
+    goto in_use;
+
+  if (!gst_element_reset (element))
+    goto reset_failed;
+
+  GST_OBJECT_LOCK (factory);
+  if (factory->pool.length >= factory->pool_size) {
+    GST_OBJECT_UNLOCK (factory);
+    goto drop;
+  }
+  g_queue_push_tail (&factory->pool, element);
+  GST_OBJECT_UNLOCK (factory);
+
+  GST_DEBUG_OBJECT (element, "recycled");
+
+  return TRUE;
+
+  /* ERRORS */
+in_use:
+  {
+    GST_DEBUG_OBJECT (element, "element is still in use, not recycling");
+    goto drop;
+  }
+reset_failed:
+  {
+    GST_DEBUG_OBJECT (element, "element could not be reset, not recycling");
+    goto drop;
+  }
+drop:
+  {
+    gst_object_unref (element);
+    return FALSE;
+  }
+}
+
 /**
  * gst_element_factory_make:
  * @factoryname: a named factory to instantiate
@@ -471,6 +847,7 @@ __gst_element_factory_add_static_pad_template (GstElementFactory * factory,
   g_return_if_fail (factory != NULL);
   g_return_if_fail (templ != NULL);
 
+  caps_matcher_clear (factory);
   factory->staticpadtemplates =
       g_list_append (factory->staticpadtemplates, templ);
   factory->numpadtemplates++;
@@ -509,7 +886,13 @@ const gchar *
 gst_element_factory_get_metadata (GstElementFactory * factory,
     const gchar * key)
 {
-  return gst_structure_get_string ((GstStructure *) factory->metadata, key);
+  GstStructure *metadata;
+
+  metadata = gst_element_factory_get_metadata_structure (factory);
+  if (metadata == NULL)
+    return NULL;
+
+  return gst_structure_get_string (metadata, key);
 }
 
 /**
@@ -531,7 +914,7 @@ gst_element_factory_get_metadata_keys (GstElementFactory * factory)
 
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
 
-  metadata = (GstStructure *) factory->metadata;
+  metadata = gst_element_factory_get_metadata_structure (factory);
   if (metadata == NULL)
     return NULL;
 
@@ -791,21 +1174,17 @@ GList *
 gst_element_factory_list_get_elements (GstElementFactoryListType type,
     GstRank minrank)
 {
-  GList *result;
   FilterData data;
 
   /* prepare type */
   data.type = type;
   data.minrank = minrank;
 
-  /* get the feature list using the filter */
-  result = gst_registry_feature_filter (gst_registry_get (),
-      (GstPluginFeatureFilter) element_filter, FALSE, &data);
-
-  /* sort on rank and name */
-  result = g_list_sort (result, gst_plugin_feature_rank_compare_func);
-
-  return result;
+  /* get the sorted feature list using the filter, the registry remembers
+   * the result for each type and minrank */
+  return _priv_gst_registry_get_feature_view (gst_registry_get (),
+      GST_TYPE_ELEMENT_FACTORY, type, minrank,
+      (GstPluginFeatureFilter) element_filter, &data);
 }
 
 /**
@@ -838,39 +1217,16 @@ gst_element_factory_list_filter (GList * list,
   /* loop over all the factories */
   for (; list; list = list->next) {
     GstElementFactory *factory;
-    const GList *templates;
-    GList *walk;
 
     factory = (GstElementFactory *) list->data;
 
     GST_DEBUG ("Trying %s",
         gst_plugin_feature_get_name ((GstPluginFeature *) factory));
 
-    /* get the templates from the element factory */
-    templates = gst_element_factory_get_static_pad_templates (factory);
-    for (walk = (GList *) templates; walk; walk = g_list_next (walk)) {
-      GstStaticPadTemplate *templ = walk->data;
-
-      /* we only care about the sink templates */
-      if (templ->direction == direction) {
-        GstCaps *tmpl_caps;
-
-        /* try to intersect the caps with the caps of the template */
-        tmpl_caps = gst_static_caps_get (&templ->static_caps);
-
-        /* FIXME, intersect is not the right method, we ideally want to check
-         * for a subset here */
-
-        /* check if the intersection is empty */
-        if ((subsetonly && gst_caps_is_subset (caps, tmpl_caps)) ||
-            (!subsetonly && gst_caps_can_intersect (caps, tmpl_caps))) {
-          /* non empty intersection, we can use this element */
-          g_queue_push_tail (&results, gst_object_ref (factory));
-          gst_caps_unref (tmpl_caps);
-          break;
-        }
-        gst_caps_unref (tmpl_caps);
-      }
+    /* check if one of the templates in the direction can handle the caps */
+    if (__gst_element_factory_can_accept_caps (factory, caps, direction,
+            subsetonly)) {
+      g_queue_push_tail (&results, gst_object_ref (factory));
     }
   }
   return results.head;
@@ -86,6 +86,15 @@ GstElement*             gst_element_factory_create              (GstElementFacto
 GST_EXPORT
 GstElement*             gst_element_factory_make                (const gchar *factoryname, const gchar *name) G_GNUC_MALLOC;
 
+GST_EXPORT
+void                    gst_element_factory_set_pool_size       (GstElementFactory *factory, guint size);
+
+GST_EXPORT
+guint                   gst_element_factory_get_pool_size       (GstElementFactory *factory);
+
+GST_EXPORT
+gboolean                gst_element_recycle                     (GstElement *element);
+
 GST_EXPORT
 gboolean                gst_element_register                    (GstPlugin *plugin, const gchar *name,
                                                                  guint rank, GType type);
@@ -90,9 +90,27 @@ typedef struct
 
   GstStructure *structure;
   gint64 running_time_offset;
+
+  /* the frequently sent events keep their values here and only create the
+   * structure when it is asked for. The structure is used instead of the
+   * fields once it exists. */
+  gboolean has_fields;
+  union
+  {
+    GstSegment segment;
+    struct
+    {
+      GstQOSType type;
+      gdouble proportion;
+      GstClockTimeDiff diff;
+      GstClockTime timestamp;
+    } qos;
+    GstClockTime latency;
+  } fields;
 } GstEventImpl;
 
 #define GST_EVENT_STRUCTURE(e)  (((GstEventImpl *)(e))->structure)
+#define GST_EVENT_FIELDS(e)     (((GstEventImpl *)(e))->fields)
 
 typedef struct
 {
@@ -145,6 +163,9 @@ _priv_gst_event_initialize (void)
 
   _gst_event_type = gst_event_get_type ();
 
+  _priv_gst_free_list_set_block_size (GST_FREE_LIST_EVENT,
+      sizeof (GstEventImpl));
+
   g_type_class_ref (gst_seek_flags_get_type ());
   g_type_class_ref (gst_seek_type_get_type ());
 
@@ -211,6 +232,62 @@ gst_event_type_get_flags (GstEventType type)
   return ret;
 }
 
+/* check if the values of @event are in the fields */
+static inline gboolean
+event_uses_fields (GstEvent * event)
+{
+  return ((GstEventImpl *) event)->has_fields &&
+      g_atomic_pointer_get (&GST_EVENT_STRUCTURE (event)) == NULL;
+}
+
+static GstStructure *
+event_fields_to_structure (GstEvent * event)
+{
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEGMENT:
+      return gst_structure_new_id (GST_QUARK (EVENT_SEGMENT),
+          GST_QUARK (SEGMENT), GST_TYPE_SEGMENT,
+          &GST_EVENT_FIELDS (event).segment, NULL);
+    case GST_EVENT_QOS:
+      return gst_structure_new_id (GST_QUARK (EVENT_QOS),
+          GST_QUARK (TYPE), GST_TYPE_QOS_TYPE, GST_EVENT_FIELDS (event).qos.type,
+          GST_QUARK (PROPORTION), G_TYPE_DOUBLE,
+          GST_EVENT_FIELDS (event).qos.proportion,
+          GST_QUARK (DIFF), G_TYPE_INT64, GST_EVENT_FIELDS (event).qos.diff,
+          GST_QUARK (TIMESTAMP), G_TYPE_UINT64,
+          GST_EVENT_FIELDS (event).qos.timestamp, NULL);
+    case GST_EVENT_LATENCY:
+      return gst_structure_new_id (GST_QUARK (EVENT_LATENCY),
+          GST_QUARK (LATENCY), G_TYPE_UINT64, GST_EVENT_FIELDS (event).latency,
+          NULL);
+    default:
+      g_assert_not_reached ();
+      return NULL;
+  }
+}
+
+/* get the structure of @event, creating it from the fields if needed.
+ * Several threads can do this for the same event at the same time. */
+static GstStructure *
+event_ensure_structure (GstEvent * event)
+{
+  GstStructure *structure;
+
+  if (G_LIKELY (!event_uses_fields (event)))
+    return GST_EVENT_STRUCTURE (event);
+
+  structure = event_fields_to_structure (event);
+  gst_structure_set_parent_refcount (structure, &event->mini_object.refcount);
+  if (!g_atomic_pointer_compare_and_exchange (&GST_EVENT_STRUCTURE (event),
+          NULL, structure)) {
+    /* another thread was faster */
+    gst_structure_set_parent_refcount (structure, NULL);
+    gst_structure_free (structure);
+  }
+
+  return GST_EVENT_STRUCTURE (event);
+}
+
 static void
 _gst_event_free (GstEvent * event)
 {
@@ -229,7 +306,7 @@ _gst_event_free (GstEvent * event)
     gst_structure_free (s);
   }
 
-  g_slice_free1 (sizeof (GstEventImpl), event);
+  _priv_gst_free_list_free (GST_FREE_LIST_EVENT, event);
 }
 
 static void gst_event_init (GstEventImpl * event, GstEventType type);
@@ -240,7 +317,8 @@ _gst_event_copy (GstEvent * event)
   GstEventImpl *copy;
   GstStructure *s;
 
-  copy = g_slice_new0 (GstEventImpl);
+  copy = _priv_gst_free_list_alloc (GST_FREE_LIST_EVENT);
+  memset (copy, 0, sizeof (GstEventImpl));
 
   gst_event_init (copy, GST_EVENT_TYPE (event));
 
@@ -258,6 +336,8 @@ _gst_event_copy (GstEvent * event)
 
   ((GstEventImpl *) copy)->running_time_offset =
       ((GstEventImpl *) event)->running_time_offset;
+  copy->has_fields = ((GstEventImpl *) event)->has_fields;
+  copy->fields = GST_EVENT_FIELDS (event);
 
   return GST_EVENT_CAST (copy);
 }
@@ -300,7 +380,8 @@ gst_event_new_custom (GstEventType type, GstStructure * structure)
 {
   GstEventImpl *event;
 
-  event = g_slice_new0 (GstEventImpl);
+  event = _priv_gst_free_list_alloc (GST_FREE_LIST_EVENT);
+  memset (event, 0, sizeof (GstEventImpl));
 
   GST_CAT_DEBUG (GST_CAT_EVENT, "creating new event %p %s %d", event,
       gst_event_type_get_name (type), type);
@@ -321,7 +402,7 @@ gst_event_new_custom (GstEventType type, GstStructure * structure)
   /* ERRORS */
 had_parent:
   {
-    g_slice_free1 (sizeof (GstEventImpl), event);
+    _priv_gst_free_list_free (GST_FREE_LIST_EVENT, event);
     g_warning ("structure is already owned by another object");
     return NULL;
   }
@@ -344,7 +425,7 @@ gst_event_get_structure (GstEvent * event)
 {
   g_return_val_if_fail (GST_IS_EVENT (event), NULL);
 
-  return GST_EVENT_STRUCTURE (event);
+  return event_ensure_structure (event);
 }
 
 /**
@@ -369,7 +450,7 @@ gst_event_writable_structure (GstEvent * event)
   g_return_val_if_fail (GST_IS_EVENT (event), NULL);
   g_return_val_if_fail (gst_event_is_writable (event), NULL);
 
-  structure = GST_EVENT_STRUCTURE (event);
+  structure = event_ensure_structure (event);
 
   if (structure == NULL) {
     structure =
@@ -394,12 +475,15 @@ gst_event_writable_structure (GstEvent * event)
 gboolean
 gst_event_has_name (GstEvent * event, const gchar * name)
 {
+  GstStructure *structure;
+
   g_return_val_if_fail (GST_IS_EVENT (event), FALSE);
 
-  if (GST_EVENT_STRUCTURE (event) == NULL)
+  structure = event_ensure_structure (event);
+  if (structure == NULL)
     return FALSE;
 
-  return gst_structure_has_name (GST_EVENT_STRUCTURE (event), name);
+  return gst_structure_has_name (structure, name);
 }
 
 /**
@@ -500,6 +584,247 @@ gst_event_set_running_time_offset (GstEvent * event, gint64 offset)
   ((GstEventImpl *) event)->running_time_offset = offset;
 }
 
+/* an event of @type as its constructor creates it, the structure of an event
+ * read from binary data must have all its fields as the parse functions
+ * don't check them. Returns %NULL for unknown types. */
+static GstEvent *
+event_new_reference (GstEventType type)
+{
+  GstEvent *event;
+
+  switch (type) {
+    case GST_EVENT_FLUSH_START:
+      return gst_event_new_flush_start ();
+    case GST_EVENT_FLUSH_STOP:
+      return gst_event_new_flush_stop (FALSE);
+    case GST_EVENT_STREAM_START:
+      return gst_event_new_stream_start ("");
+    case GST_EVENT_CAPS:{
+      GstCaps *caps = gst_caps_new_empty_simple ("x");
+
+      event = gst_event_new_caps (caps);
+      gst_caps_unref (caps);
+      return event;
+    }
+    case GST_EVENT_SEGMENT:{
+      GstSegment segment;
+
+      gst_segment_init (&segment, GST_FORMAT_TIME);
+      return gst_event_new_segment (&segment);
+    }
+    case GST_EVENT_STREAM_COLLECTION:{
+      GstStreamCollection *collection = gst_stream_collection_new (NULL);
+
+      event = gst_event_new_stream_collection (collection);
+      gst_object_unref (collection);
+      return event;
+    }
+    case GST_EVENT_TAG:
+      return gst_event_new_tag (gst_tag_list_new_empty ());
+    case GST_EVENT_BUFFERSIZE:
+      return gst_event_new_buffer_size (GST_FORMAT_BYTES, 0, 0, FALSE);
+    case GST_EVENT_SINK_MESSAGE:{
+      GstMessage *msg = gst_message_new_eos (NULL);
+
+      event = gst_event_new_sink_message ("x", msg);
+      gst_message_unref (msg);
+      return event;
+    }
+    case GST_EVENT_STREAM_GROUP_DONE:
+      return gst_event_new_stream_group_done (0);
+    case GST_EVENT_EOS:
+      return gst_event_new_eos ();
+    case GST_EVENT_TOC:{
+      GstToc *toc = gst_toc_new (GST_TOC_SCOPE_GLOBAL);
+
+      event = gst_event_new_toc (toc, FALSE);
+      gst_toc_unref (toc);
+      return event;
+    }
+    case GST_EVENT_PROTECTION:{
+      GstBuffer *data = gst_buffer_new ();
+
+      event = gst_event_new_protection ("x", data, "x");
+      gst_buffer_unref (data);
+      return event;
+    }
+    case GST_EVENT_SEGMENT_DONE:
+      return gst_event_new_segment_done (GST_FORMAT_TIME, 0);
+    case GST_EVENT_GAP:
+      return gst_event_new_gap (0, 0);
+    case GST_EVENT_QOS:
+      return gst_event_new_qos (GST_QOS_TYPE_OVERFLOW, 1.0, 0, 0);
+    case GST_EVENT_SEEK:
+      return gst_event_new_seek (1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_NONE,
+          GST_SEEK_TYPE_NONE, 0, GST_SEEK_TYPE_NONE, 0);
+    case GST_EVENT_LATENCY:
+      return gst_event_new_latency (0);
+    case GST_EVENT_STEP:
+      return gst_event_new_step (GST_FORMAT_BUFFERS, 0, 1.0, FALSE, FALSE);
+    case GST_EVENT_RECONFIGURE:
+      return gst_event_new_reconfigure ();
+    case GST_EVENT_TOC_SELECT:
+      return gst_event_new_toc_select ("");
+    case GST_EVENT_SELECT_STREAMS:{
+      GList streams = { (gpointer) "", NULL, NULL };
+
+      return gst_event_new_select_streams (&streams);
+    }
+    case GST_EVENT_NAVIGATION:
+    case GST_EVENT_CUSTOM_UPSTREAM:
+    case GST_EVENT_CUSTOM_DOWNSTREAM:
+    case GST_EVENT_CUSTOM_DOWNSTREAM_OOB:
+    case GST_EVENT_CUSTOM_DOWNSTREAM_STICKY:
+    case GST_EVENT_CUSTOM_BOTH:
+    case GST_EVENT_CUSTOM_BOTH_OOB:
+      /* any structure, but there has to be one */
+      return gst_event_new_custom (type, gst_structure_new_empty ("x"));
+    default:
+      return NULL;
+  }
+}
+
+/* check that the structure @s read from binary data is valid for an event of
+ * @type */
+static gboolean
+event_structure_is_valid (GstEventType type, const GstStructure * s)
+{
+  GstEvent *reference;
+  gboolean res;
+
+  if (!(reference = event_new_reference (type))) {
+    GST_CAT_WARNING (GST_CAT_EVENT, "unknown event type %d", type);
+    return FALSE;
+  }
+
+  res = _priv_gst_structure_has_fields_of (s,
+      event_ensure_structure (reference));
+  gst_event_unref (reference);
+
+  if (res && type == GST_EVENT_SEGMENT) {
+    const GstSegment *segment = g_value_get_boxed (gst_structure_id_get_value
+        (s, GST_QUARK (SEGMENT)));
+
+    /* what gst_event_new_segment() checks */
+    res = segment->rate != 0.0 && segment->applied_rate != 0.0 &&
+        segment->format != GST_FORMAT_UNDEFINED;
+  } else if (res && type == GST_EVENT_SELECT_STREAMS) {
+    const GValue *streams = gst_structure_id_get_value (s,
+        GST_QUARK (STREAMS));
+    guint i;
+
+    for (i = 0; res && i < gst_value_list_get_size (streams); i++)
+      res = G_VALUE_HOLDS_STRING (gst_value_list_get_value (streams, i));
+  }
+
+  if (!res)
+    GST_CAT_WARNING (GST_CAT_EVENT, "invalid structure for %s event",
+        gst_event_type_get_name (type));
+
+  return res;
+}
+
+/**
+ * gst_event_to_binary:
+ * @event: a #GstEvent
+ * @size: (out): the size of the returned data
+ *
+ * Serializes @event into a compact binary representation that can be turned
+ * back into an event with gst_event_new_from_binary(), also in another
+ * process. The type, seqnum, timestamp, running time offset and structure of
+ * the event are stored, see gst_structure_to_binary().
+ *
+ * Returns: (transfer full) (array length=size) (nullable): the binary data,
+ *     or %NULL if the event contains values that can't be serialized, like
+ *     objects. Free with g_free() when no longer needed.
+ *
+ * Since: 1.14
+ */
+guint8 *
+gst_event_to_binary (GstEvent * event, gsize * size)
+{
+  GstStructure *s;
+  GByteArray *array;
+
+  g_return_val_if_fail (GST_IS_EVENT (event), NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  s = event_ensure_structure (event);
+
+  array = g_byte_array_new ();
+  _priv_gst_binary_write_header (array, GST_BINARY_KIND_EVENT);
+  _priv_gst_binary_write_uint32 (array, GST_EVENT_TYPE (event));
+  _priv_gst_binary_write_uint32 (array, GST_EVENT_SEQNUM (event));
+  _priv_gst_binary_write_uint64 (array, GST_EVENT_TIMESTAMP (event));
+  _priv_gst_binary_write_uint64 (array,
+      ((GstEventImpl *) event)->running_time_offset);
+  _priv_gst_binary_write_uint8 (array, s != NULL);
+  if (s && !_priv_gst_structure_write_binary (array, s)) {
+    g_byte_array_free (array, TRUE);
+    *size = 0;
+    return NULL;
+  }
+
+  *size = array->len;
+  return g_byte_array_free (array, FALSE);
+}
+
+/**
+ * gst_event_new_from_binary:
+ * @data: (array length=size): data created with gst_event_to_binary()
+ * @size: the size of @data
+ *
+ * Creates an event from its binary representation.
+ *
+ * Returns: (transfer full) (nullable): the new event, or %NULL when @data
+ *     could not be deserialized.
+ *
+ * Since: 1.14
+ */
+GstEvent *
+gst_event_new_from_binary (const guint8 * data, gsize size)
+{
+  GstBinaryReader reader = GST_BINARY_READER_INIT (data, size);
+  GstStructure *s = NULL;
+  GstEvent *event;
+  guint32 type, seqnum;
+  guint64 timestamp, offset;
+  guint8 has_structure;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_binary_read_header (&reader, GST_BINARY_KIND_EVENT) ||
+      !_priv_gst_binary_read_uint32 (&reader, &type) ||
+      !_priv_gst_binary_read_uint32 (&reader, &seqnum) ||
+      !_priv_gst_binary_read_uint64 (&reader, &timestamp) ||
+      !_priv_gst_binary_read_uint64 (&reader, &offset) ||
+      !_priv_gst_binary_read_uint8 (&reader, &has_structure))
+    goto error;
+
+  if (has_structure && !(s = _priv_gst_structure_read_binary (&reader)))
+    goto error;
+
+  if (reader.offset != reader.size || !event_structure_is_valid (type, s)) {
+    if (s)
+      gst_structure_free (s);
+    goto error;
+  }
+
+  event = gst_event_new_custom (type, s);
+  GST_EVENT_SEQNUM (event) = seqnum;
+  GST_EVENT_TIMESTAMP (event) = timestamp;
+  ((GstEventImpl *) event)->running_time_offset = offset;
+
+  return event;
+
+  /* ERRORS */
+error:
+  {
+    GST_CAT_WARNING (GST_CAT_EVENT, "invalid event in binary data");
+    return NULL;
+  }
+}
+
 /**
  * gst_event_new_flush_start:
  *
@@ -894,9 +1219,10 @@ gst_event_new_segment (const GstSegment * segment)
   GST_CAT_INFO (GST_CAT_EVENT, "creating segment event %" GST_SEGMENT_FORMAT,
       segment);
 
-  event = gst_event_new_custom (GST_EVENT_SEGMENT,
-      gst_structure_new_id (GST_QUARK (EVENT_SEGMENT),
-          GST_QUARK (SEGMENT), GST_TYPE_SEGMENT, segment, NULL));
+  /* the structure is only created when it is needed */
+  event = gst_event_new_custom (GST_EVENT_SEGMENT, NULL);
+  ((GstEventImpl *) event)->has_fields = TRUE;
+  gst_segment_copy_into (segment, &GST_EVENT_FIELDS (event).segment);
 
   return event;
 }
@@ -919,6 +1245,10 @@ gst_event_parse_segment (GstEvent * event, const GstSegment ** segment)
   g_return_if_fail (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT);
 
   if (segment) {
+    if (event_uses_fields (event)) {
+      *segment = &GST_EVENT_FIELDS (event).segment;
+      return;
+    }
     structure = GST_EVENT_STRUCTURE (event);
     *segment = g_value_get_boxed (gst_structure_id_get_value (structure,
             GST_QUARK (SEGMENT)));
@@ -1135,7 +1465,6 @@ gst_event_new_qos (GstQOSType type, gdouble proportion,
     GstClockTimeDiff diff, GstClockTime timestamp)
 {
   GstEvent *event;
-  GstStructure *structure;
 
   /* diff must be positive or timestamp + diff must be positive */
   g_return_val_if_fail (diff >= 0 || -diff <= timestamp, NULL);
@@ -1145,12 +1474,12 @@ gst_event_new_qos (GstQOSType type, gdouble proportion,
       ", timestamp %" GST_TIME_FORMAT, type, proportion,
       diff, GST_TIME_ARGS (timestamp));
 
-  structure = gst_structure_new_id (GST_QUARK (EVENT_QOS),
-      GST_QUARK (TYPE), GST_TYPE_QOS_TYPE, type,
-      GST_QUARK (PROPORTION), G_TYPE_DOUBLE, proportion,
-      GST_QUARK (DIFF), G_TYPE_INT64, diff,
-      GST_QUARK (TIMESTAMP), G_TYPE_UINT64, timestamp, NULL);
-  event = gst_event_new_custom (GST_EVENT_QOS, structure);
+  event = gst_event_new_custom (GST_EVENT_QOS, NULL);
+  ((GstEventImpl *) event)->has_fields = TRUE;
+  GST_EVENT_FIELDS (event).qos.type = type;
+  GST_EVENT_FIELDS (event).qos.proportion = proportion;
+  GST_EVENT_FIELDS (event).qos.diff = diff;
+  GST_EVENT_FIELDS (event).qos.timestamp = timestamp;
 
   return event;
 }
@@ -1173,32 +1502,45 @@ gst_event_parse_qos (GstEvent * event, GstQOSType * type,
     gdouble * proportion, GstClockTimeDiff * diff, GstClockTime * timestamp)
 {
   const GstStructure *structure;
+  GstQOSType type_;
+  gdouble proportion_;
+  GstClockTimeDiff diff_;
+  GstClockTime timestamp_;
 
   g_return_if_fail (GST_IS_EVENT (event));
   g_return_if_fail (GST_EVENT_TYPE (event) == GST_EVENT_QOS);
 
-  structure = GST_EVENT_STRUCTURE (event);
-  if (type)
-    *type = (GstQOSType)
+  if (event_uses_fields (event)) {
+    type_ = GST_EVENT_FIELDS (event).qos.type;
+    proportion_ = GST_EVENT_FIELDS (event).qos.proportion;
+    diff_ = GST_EVENT_FIELDS (event).qos.diff;
+    timestamp_ = GST_EVENT_FIELDS (event).qos.timestamp;
+  } else {
+    structure = GST_EVENT_STRUCTURE (event);
+    type_ = (GstQOSType)
         g_value_get_enum (gst_structure_id_get_value (structure,
             GST_QUARK (TYPE)));
-  if (proportion)
-    *proportion =
+    proportion_ =
         g_value_get_double (gst_structure_id_get_value (structure,
             GST_QUARK (PROPORTION)));
-  if (diff)
-    *diff =
+    diff_ =
         g_value_get_int64 (gst_structure_id_get_value (structure,
             GST_QUARK (DIFF)));
+    timestamp_ =
+        g_value_get_uint64 (gst_structure_id_get_value (structure,
+            GST_QUARK (TIMESTAMP)));
+  }
+
+  if (type)
+    *type = type_;
+  if (proportion)
+    *proportion = proportion_;
+  if (diff)
+    *diff = diff_;
   if (timestamp) {
     gint64 offset = gst_event_get_running_time_offset (event);
-    GstClockTimeDiff diff_ =
-        g_value_get_int64 (gst_structure_id_get_value (structure,
-            GST_QUARK (DIFF)));
 
-    *timestamp =
-        g_value_get_uint64 (gst_structure_id_get_value (structure,
-            GST_QUARK (TIMESTAMP)));
+    *timestamp = timestamp_;
     /* Catch underflows */
     if (*timestamp > -offset)
       *timestamp += offset;
@@ -1382,14 +1724,13 @@ GstEvent *
 gst_event_new_latency (GstClockTime latency)
 {
   GstEvent *event;
-  GstStructure *structure;
 
   GST_CAT_INFO (GST_CAT_EVENT,
       "creating latency event %" GST_TIME_FORMAT, GST_TIME_ARGS (latency));
 
-  structure = gst_structure_new_id (GST_QUARK (EVENT_LATENCY),
-      GST_QUARK (LATENCY), G_TYPE_UINT64, latency, NULL);
-  event = gst_event_new_custom (GST_EVENT_LATENCY, structure);
+  event = gst_event_new_custom (GST_EVENT_LATENCY, NULL);
+  ((GstEventImpl *) event)->has_fields = TRUE;
+  GST_EVENT_FIELDS (event).latency = latency;
 
   return event;
 }
@@ -1407,7 +1748,9 @@ gst_event_parse_latency (GstEvent * event, GstClockTime * latency)
   g_return_if_fail (GST_IS_EVENT (event));
   g_return_if_fail (GST_EVENT_TYPE (event) == GST_EVENT_LATENCY);
 
-  if (latency)
+  if (latency && event_uses_fields (event))
+    *latency = GST_EVENT_FIELDS (event).latency;
+  else if (latency)
     *latency =
         g_value_get_uint64 (gst_structure_id_get_value (GST_EVENT_STRUCTURE
             (event), GST_QUARK (LATENCY)));
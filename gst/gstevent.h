@@ -497,6 +497,14 @@ gint64          gst_event_get_running_time_offset (GstEvent *event);
 GST_EXPORT
 void            gst_event_set_running_time_offset (GstEvent *event, gint64 offset);
 
+/* binary serialization */
+
+GST_EXPORT
+guint8 *        gst_event_to_binary             (GstEvent *event, gsize *size) G_GNUC_MALLOC;
+
+GST_EXPORT
+GstEvent *      gst_event_new_from_binary       (const guint8 *data, gsize size) G_GNUC_MALLOC;
+
 /* Stream start event */
 
 GST_EXPORT
@@ -0,0 +1,304 @@
+/* GStreamer
+ *
+ * gstfreelist.c: per-thread free-lists for fixed size core objects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstfreelist
+ * @title: GstFreeList
+ * @short_description: Statistics of the per-thread free-lists
+ *
+ * Buffers, events, buffer lists, samples and small meta items are recycled
+ * through per-thread free-lists. gst_free_list_get_stats() tells how often
+ * an allocation could reuse a block, which helps to tune the size of the
+ * free-lists with the GST_FREE_LIST_SIZE environment variable.
+ */
+
+/* Buffers, events and small meta items are allocated and freed at a very
+ * high rate from the streaming threads. Instead of going through g_slice for
+ * each of them, every thread keeps a small list of freed blocks of each type
+ * that it hands out again on the next allocation of the same type.
+ *
+ * Blocks freed in one thread can be reused by another thread, they are all
+ * allocated with g_slice and have a fixed size per type.
+ *
+ * The amount of blocks kept per type and thread can be configured with the
+ * GST_FREE_LIST_SIZE environment variable, setting it to 0 disables the
+ * free-lists completely. They are disabled by default when running in
+ * valgrind so that leaks are reported correctly.
+ */
+
+#include "gst_private.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gstinfo.h"
+#include "gstfreelist.h"
+
+#define DEFAULT_FREE_LIST_SIZE 64
+
+typedef struct _GstFreeBlock GstFreeBlock;
+
+struct _GstFreeBlock
+{
+  GstFreeBlock *next;
+};
+
+typedef struct
+{
+  GstFreeBlock *head;
+  guint len;
+
+  GstFreeListStats stats;
+} GstFreeListEntry;
+
+typedef struct
+{
+  GstFreeListEntry entries[GST_FREE_LIST_LAST];
+} GstFreeListCache;
+
+static void free_list_cache_free (GstFreeListCache * cache);
+
+static GPrivate cache_key = G_PRIVATE_INIT ((GDestroyNotify)
+    free_list_cache_free);
+
+static guint free_list_size = 0;
+static gsize block_sizes[GST_FREE_LIST_LAST] = { 0, };
+
+/* stats of all threads that exited and the caches of the running threads */
+static GMutex stats_lock;
+static GstFreeListStats exited_stats[GST_FREE_LIST_LAST];
+static GList *caches = NULL;
+
+static const gchar *type_names[GST_FREE_LIST_LAST] = {
+  "buffer", "event", "meta", "buffer-list", "sample"
+};
+
+static void
+free_list_cache_free (GstFreeListCache * cache)
+{
+  guint i;
+
+  g_mutex_lock (&stats_lock);
+  caches = g_list_remove (caches, cache);
+  for (i = 0; i < GST_FREE_LIST_LAST; i++) {
+    GstFreeListEntry *entry = &cache->entries[i];
+    GstFreeBlock *block;
+
+    GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "%s free-list of thread %p: %"
+        G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses, %"
+        G_GUINT64_FORMAT " overflows", type_names[i], g_thread_self (),
+        entry->stats.hits, entry->stats.misses, entry->stats.overflows);
+
+    exited_stats[i].hits += entry->stats.hits;
+    exited_stats[i].misses += entry->stats.misses;
+    exited_stats[i].overflows += entry->stats.overflows;
+
+    while ((block = entry->head)) {
+      entry->head = block->next;
+      g_slice_free1 (block_sizes[i], block);
+    }
+  }
+  g_mutex_unlock (&stats_lock);
+
+  g_slice_free (GstFreeListCache, cache);
+}
+
+static inline GstFreeListCache *
+free_list_cache_get (void)
+{
+  GstFreeListCache *cache;
+
+  cache = g_private_get (&cache_key);
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_slice_new0 (GstFreeListCache);
+    g_private_set (&cache_key, cache);
+
+    g_mutex_lock (&stats_lock);
+    caches = g_list_prepend (caches, cache);
+    g_mutex_unlock (&stats_lock);
+  }
+  return cache;
+}
+
+void
+_priv_gst_free_list_initialize (void)
+{
+  const gchar *env;
+
+  free_list_size = DEFAULT_FREE_LIST_SIZE;
+
+  if ((env = g_getenv ("GST_FREE_LIST_SIZE")) != NULL) {
+    free_list_size = strtoul (env, NULL, 10);
+  } else if (_priv_gst_in_valgrind ()) {
+    free_list_size = 0;
+  }
+
+  GST_CAT_INFO (GST_CAT_PERFORMANCE, "using free-lists of %u blocks",
+      free_list_size);
+}
+
+void
+_priv_gst_free_list_set_block_size (GstFreeListType type, gsize size)
+{
+  g_assert (size >= sizeof (GstFreeBlock));
+
+  block_sizes[type] = size;
+}
+
+void
+_priv_gst_free_list_cleanup (void)
+{
+  GstFreeListStats stats;
+  guint i;
+
+  for (i = 0; i < GST_FREE_LIST_LAST; i++) {
+    _priv_gst_free_list_get_stats (i, &stats);
+    GST_CAT_INFO (GST_CAT_PERFORMANCE, "%s free-list: %" G_GUINT64_FORMAT
+        " hits, %" G_GUINT64_FORMAT " misses, %" G_GUINT64_FORMAT
+        " overflows", type_names[i], stats.hits, stats.misses,
+        stats.overflows);
+  }
+
+  /* release the blocks of the calling thread, other threads release theirs
+   * when they exit */
+  g_private_replace (&cache_key, NULL);
+}
+
+/* allocate a block of the size configured for @type */
+gpointer
+_priv_gst_free_list_alloc (GstFreeListType type)
+{
+  GstFreeListCache *cache;
+  GstFreeListEntry *entry;
+  GstFreeBlock *block;
+
+  if (G_UNLIKELY (free_list_size == 0))
+    return g_slice_alloc (block_sizes[type]);
+
+  cache = free_list_cache_get ();
+  entry = &cache->entries[type];
+
+  if (G_LIKELY ((block = entry->head) != NULL)) {
+    entry->head = block->next;
+    entry->len--;
+    entry->stats.hits++;
+    return block;
+  }
+
+  entry->stats.misses++;
+
+  return g_slice_alloc (block_sizes[type]);
+}
+
+/* release a block allocated with _priv_gst_free_list_alloc() */
+void
+_priv_gst_free_list_free (GstFreeListType type, gpointer mem)
+{
+  GstFreeListCache *cache;
+  GstFreeListEntry *entry;
+  GstFreeBlock *block;
+
+  if (G_UNLIKELY (free_list_size == 0))
+    goto slice_free;
+
+  cache = free_list_cache_get ();
+  entry = &cache->entries[type];
+
+  if (G_UNLIKELY (entry->len >= free_list_size)) {
+    entry->stats.overflows++;
+    goto slice_free;
+  }
+
+  block = mem;
+  block->next = entry->head;
+  entry->head = block;
+  entry->len++;
+
+  return;
+
+slice_free:
+  g_slice_free1 (block_sizes[type], mem);
+}
+
+/* stats of all threads, the counters of the other running threads are read
+ * without synchronizing with them and can be slightly behind */
+void
+_priv_gst_free_list_get_stats (GstFreeListType type, GstFreeListStats * stats)
+{
+  GList *walk;
+
+  g_mutex_lock (&stats_lock);
+  *stats = exited_stats[type];
+  for (walk = caches; walk; walk = g_list_next (walk)) {
+    GstFreeListCache *cache = walk->data;
+
+    stats->hits += cache->entries[type].stats.hits;
+    stats->misses += cache->entries[type].stats.misses;
+    stats->overflows += cache->entries[type].stats.overflows;
+  }
+  g_mutex_unlock (&stats_lock);
+}
+
+/**
+ * gst_free_list_get_stats:
+ * @name: the name of a free-list, one of "buffer", "event", "meta",
+ *     "buffer-list" or "sample"
+ * @hits: (out) (allow-none): the number of allocations that reused a block
+ * @misses: (out) (allow-none): the number of allocations that found the
+ *     free-list empty
+ * @overflows: (out) (allow-none): the number of blocks that were released
+ *     because the free-list was full
+ *
+ * Get the statistics of the free-list @name, summed over all threads. The
+ * counters of other threads that are still running can be slightly behind.
+ *
+ * When the free-lists are disabled, all counters stay 0.
+ *
+ * Returns: %TRUE when @name is a known free-list.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_free_list_get_stats (const gchar * name, guint64 * hits,
+    guint64 * misses, guint64 * overflows)
+{
+  GstFreeListStats stats;
+  guint i;
+
+  g_return_val_if_fail (name != NULL, FALSE);
+
+  for (i = 0; i < GST_FREE_LIST_LAST; i++) {
+    if (strcmp (type_names[i], name) == 0)
+      break;
+  }
+  if (i == GST_FREE_LIST_LAST)
+    return FALSE;
+
+  _priv_gst_free_list_get_stats (i, &stats);
+
+  if (hits)
+    *hits = stats.hits;
+  if (misses)
+    *misses = stats.misses;
+  if (overflows)
+    *overflows = stats.overflows;
+
+  return TRUE;
+}
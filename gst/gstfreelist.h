@@ -0,0 +1,37 @@
+/* GStreamer
+ *
+ * gstfreelist.h: per-thread free-lists for fixed size core objects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_FREE_LIST_H__
+#define __GST_FREE_LIST_H__
+
+#include <glib.h>
+#include <gst/gstconfig.h>
+
+G_BEGIN_DECLS
+
+GST_EXPORT
+gboolean        gst_free_list_get_stats         (const gchar * name,
+                                                 guint64 * hits,
+                                                 guint64 * misses,
+                                                 guint64 * overflows);
+
+G_END_DECLS
+
+#endif /* __GST_FREE_LIST_H__ */
@@ -41,6 +41,8 @@
  * association later on.
  *
  * Note that GhostPads add overhead to the data processing of a pipeline.
+ * When a proxy pad has no probes, data pushed to it is directly pushed on
+ * its internal pad, which leaves out one pad of the two per ghost pad.
  */
 
 #include "gst_private.h"
@@ -130,6 +132,55 @@ gst_proxy_pad_chain_default (GstPad * pad, GstObject * parent,
   return res;
 }
 
+/* Called by gst_pad_push_data() for its peer @pad. When @pad is a proxy pad
+ * with the default chain functions and without probes, chaining on it would
+ * only push @data on its internal pad. Push it there directly, with the
+ * stream lock of @pad held like gst_pad_chain() does, but without the
+ * probe and parent handling of the chain. Returns %FALSE when @pad must be
+ * chained as usual, @data is then not consumed. */
+gboolean
+_priv_gst_proxy_pad_push_through (GstPad * pad, GstPadProbeType type,
+    gpointer data, GstFlowReturn * ret)
+{
+  GstPad *internal;
+
+  if (type & GST_PAD_PROBE_TYPE_BUFFER) {
+    if (G_LIKELY (GST_PAD_CHAINFUNC (pad) != gst_proxy_pad_chain_default))
+      return FALSE;
+  } else if (GST_PAD_CHAINLISTFUNC (pad) != gst_proxy_pad_chain_list_default) {
+    return FALSE;
+  }
+
+  if (!GST_IS_PROXY_PAD (pad))
+    return FALSE;
+
+  GST_PAD_STREAM_LOCK_TRACED (pad);
+  GST_OBJECT_LOCK (pad);
+  if (pad->num_probes || GST_PAD_IS_FLUSHING (pad) || GST_PAD_IS_EOS (pad)
+      || GST_PAD_MODE (pad) != GST_PAD_MODE_PUSH
+      || GST_OBJECT_PARENT (pad) == NULL
+      || (internal = GST_PROXY_PAD_INTERNAL (pad)) == NULL) {
+    GST_OBJECT_UNLOCK (pad);
+    GST_PAD_STREAM_UNLOCK (pad);
+    return FALSE;
+  }
+  gst_object_ref (internal);
+  GST_OBJECT_UNLOCK (pad);
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "pushing through to %s:%s",
+      GST_DEBUG_PAD_NAME (internal));
+
+  if (type & GST_PAD_PROBE_TYPE_BUFFER)
+    *ret = gst_pad_push (internal, GST_BUFFER_CAST (data));
+  else
+    *ret = gst_pad_push_list (internal, GST_BUFFER_LIST_CAST (data));
+
+  gst_object_unref (internal);
+  GST_PAD_STREAM_UNLOCK (pad);
+
+  return TRUE;
+}
+
 /**
  * gst_proxy_pad_chain_list_default:
  * @pad: a sink #GstPad, returns GST_FLOW_ERROR if not.
@@ -244,12 +244,16 @@ static const gchar *_gst_debug_filter = NULL;
 
 static void gst_debug_reset_threshold (gpointer category, gpointer unused);
 static void gst_debug_reset_all_thresholds (void);
+static void gst_debug_bump_min_level (GstDebugLevel level);
 
 struct _GstDebugMessage
 {
   gchar *message;
   const gchar *format;
   va_list arguments;
+
+  /* most messages are formatted in here instead of a new allocation */
+  gchar buffer[256];
 };
 
 /* list of all name/level pairs from --gst-debug and GST_DEBUG */
@@ -259,6 +263,8 @@ typedef struct
 {
   GPatternSpec *pat;
   GstDebugLevel level;
+  /* generation the pattern was added in */
+  gint generation;
 }
 LevelNameEntry;
 
@@ -266,6 +272,27 @@ LevelNameEntry;
 static GMutex __cat_mutex;
 static GSList *__categories = NULL;
 
+/* Changing the thresholds only bumps the generation, categories compute their
+ * threshold again the next time it is checked. This keeps the check a load
+ * and a compare and changes don't need to walk all categories. */
+static volatile gint __threshold_generation = 1;
+/* generation of the last change that also resets the thresholds that were
+ * set with gst_debug_category_set_threshold(), protected by
+ * __level_name_mutex */
+static gint __reset_generation = 1;
+
+typedef struct
+{
+  GstDebugCategory category;
+
+  /* generation the threshold was computed for */
+  volatile gint generation;
+  /* the threshold was set with gst_debug_category_set_threshold(), only
+   * patterns added later or a reset of all thresholds override it.
+   * Protected by __level_name_mutex */
+  gboolean explicit;
+} GstDebugCategoryEntry;
+
 static GstDebugCategory *_gst_debug_get_category_locked (const gchar * name);
 
 
@@ -283,6 +310,14 @@ static GSList *__log_functions = NULL;
 /* whether to add the default log function in gst_init() */
 static gboolean add_default_log_func = TRUE;
 
+/* where the default log function writes to */
+static FILE *default_log_file = NULL;
+
+#define DEFAULT_ASYNC_MAX_PENDING 16384
+static void gst_debug_add_async_logger_for_file (FILE * log_file,
+    guint max_pending);
+static gboolean gst_debug_add_binary_logger_for_file (FILE * log_file);
+
 #define PRETTY_TAGS_DEFAULT  TRUE
 static gboolean pretty_tags = PRETTY_TAGS_DEFAULT;
 
@@ -352,7 +387,7 @@ void
 _priv_gst_debug_init (void)
 {
   const gchar *env;
-  FILE *log_file;
+  FILE *log_file, *binary_file = NULL;
 
   if (add_default_log_func) {
     env = g_getenv ("GST_DEBUG_FILE");
@@ -372,8 +407,34 @@ _priv_gst_debug_init (void)
     } else {
       log_file = stderr;
     }
+    default_log_file = log_file;
 
-    gst_debug_add_log_function (gst_debug_log_default, log_file, NULL);
+    /* the binary logger replaces the default log function */
+    env = g_getenv ("GST_DEBUG_BINARY_FILE");
+    if (env != NULL && *env != '\0') {
+      gchar *name = _priv_gst_debug_file_name (env);
+
+      binary_file = g_fopen (name, "wb");
+      g_free (name);
+      if (binary_file == NULL) {
+        g_printerr ("Could not open log file '%s' for writing: %s\n", env,
+            g_strerror (errno));
+      } else if (!gst_debug_add_binary_logger_for_file (binary_file)) {
+        fclose (binary_file);
+        binary_file = NULL;
+      }
+    }
+
+    if (binary_file != NULL) {
+      /* nothing else to add */
+    } else if ((env = g_getenv ("GST_DEBUG_ASYNC")) && *env != '\0') {
+      guint max_pending = strtoul (env, NULL, 10);
+
+      gst_debug_add_async_logger_for_file (log_file,
+          max_pending > 1 ? max_pending : DEFAULT_ASYNC_MAX_PENDING);
+    } else {
+      gst_debug_add_log_function (gst_debug_log_default, log_file, NULL);
+    }
   }
 
   __gst_printf_pointer_extension_set_func
@@ -566,7 +627,8 @@ gst_debug_log_valist (GstDebugCategory * category, GstDebugLevel level,
     entry->func (category, level, file, function, line, object, &message,
         entry->user_data);
   }
-  g_free (message.message);
+  if (message.message != message.buffer)
+    g_free (message.message);
   va_end (message.arguments);
 }
 
@@ -585,8 +647,8 @@ gst_debug_message_get (GstDebugMessage * message)
   if (message->message == NULL) {
     int len;
 
-    len = __gst_vasprintf (&message->message, message->format,
-        message->arguments);
+    len = __gst_vasnprintf_buf (&message->message, message->buffer,
+        sizeof (message->buffer), message->format, message->arguments);
 
     if (len < 0)
       message->message = NULL;
@@ -815,7 +877,7 @@ gst_debug_print_object (gpointer ptr)
     return g_strdup ("(NULL)");
   }
   if (GST_IS_CAPS (ptr)) {
-    return gst_caps_to_string ((const GstCaps *) ptr);
+    return _priv_gst_caps_describe ((const GstCaps *) ptr);
   }
   if (GST_IS_STRUCTURE (ptr)) {
     return gst_info_structure_to_string ((const GstStructure *) ptr);
@@ -1564,6 +1626,7 @@ void
 gst_debug_set_default_threshold (GstDebugLevel level)
 {
   g_atomic_int_set (&__default_level, level);
+  gst_debug_bump_min_level (level);
   gst_debug_reset_all_thresholds ();
 }
 
@@ -1580,52 +1643,90 @@ gst_debug_get_default_threshold (void)
   return (GstDebugLevel) g_atomic_int_get (&__default_level);
 }
 
+static void
+gst_debug_bump_min_level (GstDebugLevel level)
+{
+  if (level > _gst_debug_min) {
+    _gst_debug_enabled = TRUE;
+    _gst_debug_min = level;
+  }
+}
+
+/* computes the threshold of @cat from the patterns and the default level */
 static void
 gst_debug_reset_threshold (gpointer category, gpointer unused)
 {
   GstDebugCategory *cat = (GstDebugCategory *) category;
+  GstDebugCategoryEntry *cat_entry = (GstDebugCategoryEntry *) category;
+  GPatternSpec *pat = NULL;
+  GstDebugLevel level;
+  gint generation;
   GSList *walk;
 
   g_mutex_lock (&__level_name_mutex);
-  walk = __level_name;
-  while (walk) {
-    LevelNameEntry *entry = walk->data;
+  generation = g_atomic_int_get (&__threshold_generation);
 
-    walk = g_slist_next (walk);
-    if (g_pattern_match_string (entry->pat, cat->name)) {
-      if (gst_is_initialized ())
-        GST_LOG ("category %s matches pattern %p - gets set to level %d",
-            cat->name, entry->pat, entry->level);
-      gst_debug_category_set_threshold (cat, entry->level);
-      goto exit;
+  if (cat_entry->explicit && cat_entry->generation >= __reset_generation) {
+    /* keep the explicit threshold unless a pattern added after it matches,
+     * the newest patterns are first in the list */
+    level = (GstDebugLevel) g_atomic_int_get (&cat->threshold);
+    for (walk = __level_name; walk; walk = g_slist_next (walk)) {
+      LevelNameEntry *entry = walk->data;
+
+      if (entry->generation <= cat_entry->generation)
+        break;
+      if (g_pattern_match_string (entry->pat, cat->name)) {
+        pat = entry->pat;
+        level = entry->level;
+        cat_entry->explicit = FALSE;
+        break;
+      }
+    }
+  } else {
+    cat_entry->explicit = FALSE;
+    level = gst_debug_get_default_threshold ();
+    for (walk = __level_name; walk; walk = g_slist_next (walk)) {
+      LevelNameEntry *entry = walk->data;
+
+      if (g_pattern_match_string (entry->pat, cat->name)) {
+        pat = entry->pat;
+        level = entry->level;
+        break;
+      }
     }
   }
-  gst_debug_category_set_threshold (cat, gst_debug_get_default_threshold ());
 
-exit:
+  g_atomic_int_set (&cat->threshold, level);
+  g_atomic_int_set (&cat_entry->generation, generation);
   g_mutex_unlock (&__level_name_mutex);
+
+  /* only log without the lock, this can update the default category */
+  if (pat && gst_is_initialized ())
+    GST_LOG ("category %s matches pattern %p - gets set to level %d",
+        cat->name, pat, level);
 }
 
-static void
-gst_debug_reset_all_thresholds (void)
+/* must be called with __level_name_mutex, returns the new generation */
+static gint
+gst_debug_bump_generation_locked (gboolean reset_explicit)
 {
-  g_mutex_lock (&__cat_mutex);
-  g_slist_foreach (__categories, gst_debug_reset_threshold, NULL);
-  g_mutex_unlock (&__cat_mutex);
+  gint generation;
+
+  generation = g_atomic_int_add (&__threshold_generation, 1) + 1;
+  if (reset_explicit)
+    __reset_generation = generation;
+
+  return generation;
 }
 
+/* makes all categories compute their threshold again, also the ones with a
+ * threshold that was set explicitly */
 static void
-for_each_threshold_by_entry (gpointer data, gpointer user_data)
+gst_debug_reset_all_thresholds (void)
 {
-  GstDebugCategory *cat = (GstDebugCategory *) data;
-  LevelNameEntry *entry = (LevelNameEntry *) user_data;
-
-  if (g_pattern_match_string (entry->pat, cat->name)) {
-    if (gst_is_initialized ())
-      GST_TRACE ("category %s matches pattern %p - gets set to level %d",
-          cat->name, entry->pat, entry->level);
-    gst_debug_category_set_threshold (cat, entry->level);
-  }
+  g_mutex_lock (&__level_name_mutex);
+  gst_debug_bump_generation_locked (TRUE);
+  g_mutex_unlock (&__level_name_mutex);
 }
 
 /**
@@ -1648,12 +1749,14 @@ gst_debug_set_threshold_for_name (const gchar * name, GstDebugLevel level)
   entry = g_slice_new (LevelNameEntry);
   entry->pat = pat;
   entry->level = level;
+
+  gst_debug_bump_min_level (level);
+
+  /* explicit thresholds of categories that don't match are kept */
   g_mutex_lock (&__level_name_mutex);
+  entry->generation = gst_debug_bump_generation_locked (FALSE);
   __level_name = g_slist_prepend (__level_name, entry);
   g_mutex_unlock (&__level_name_mutex);
-  g_mutex_lock (&__cat_mutex);
-  g_slist_foreach (__categories, for_each_threshold_by_entry, entry);
-  g_mutex_unlock (&__cat_mutex);
 }
 
 /**
@@ -1700,7 +1803,7 @@ _gst_debug_category_new (const gchar * name, guint color,
 
   g_return_val_if_fail (name != NULL, NULL);
 
-  cat = g_slice_new (GstDebugCategory);
+  cat = (GstDebugCategory *) g_slice_new (GstDebugCategoryEntry);
   cat->name = g_strdup (name);
   cat->color = color;
   if (description != NULL) {
@@ -1709,6 +1812,7 @@ _gst_debug_category_new (const gchar * name, guint color,
     cat->description = g_strdup ("no description");
   }
   g_atomic_int_set (&cat->threshold, 0);
+  ((GstDebugCategoryEntry *) cat)->explicit = FALSE;
   gst_debug_reset_threshold (cat, NULL);
 
   /* add to category list */
@@ -1717,7 +1821,7 @@ _gst_debug_category_new (const gchar * name, guint color,
   if (catfound) {
     g_free ((gpointer) cat->name);
     g_free ((gpointer) cat->description);
-    g_slice_free (GstDebugCategory, cat);
+    g_slice_free (GstDebugCategoryEntry, (GstDebugCategoryEntry *) cat);
     cat = catfound;
   } else {
     __categories = g_slist_prepend (__categories, cat);
@@ -1751,7 +1855,7 @@ gst_debug_category_free (GstDebugCategory * category)
 
   g_free ((gpointer) category->name);
   g_free ((gpointer) category->description);
-  g_slice_free (GstDebugCategory, category);
+  g_slice_free (GstDebugCategoryEntry, (GstDebugCategoryEntry *) category);
 }
 
 /**
@@ -1770,14 +1874,19 @@ void
 gst_debug_category_set_threshold (GstDebugCategory * category,
     GstDebugLevel level)
 {
+  GstDebugCategoryEntry *cat_entry = (GstDebugCategoryEntry *) category;
+
   g_return_if_fail (category != NULL);
 
-  if (level > _gst_debug_min) {
-    _gst_debug_enabled = TRUE;
-    _gst_debug_min = level;
-  }
+  gst_debug_bump_min_level (level);
 
+  /* stays until a matching pattern is added or all thresholds are reset */
+  g_mutex_lock (&__level_name_mutex);
+  cat_entry->explicit = TRUE;
   g_atomic_int_set (&category->threshold, level);
+  g_atomic_int_set (&cat_entry->generation,
+      g_atomic_int_get (&__threshold_generation));
+  g_mutex_unlock (&__level_name_mutex);
 }
 
 /**
@@ -1793,6 +1902,10 @@ gst_debug_category_set_threshold (GstDebugCategory * category,
 void
 gst_debug_category_reset_threshold (GstDebugCategory * category)
 {
+  g_mutex_lock (&__level_name_mutex);
+  ((GstDebugCategoryEntry *) category)->explicit = FALSE;
+  g_mutex_unlock (&__level_name_mutex);
+
   gst_debug_reset_threshold (category, NULL);
 }
 
@@ -1807,6 +1920,11 @@ gst_debug_category_reset_threshold (GstDebugCategory * category)
 GstDebugLevel
 gst_debug_category_get_threshold (GstDebugCategory * category)
 {
+  if (G_UNLIKELY (g_atomic_int_get (&((GstDebugCategoryEntry *)
+                  category)->generation) !=
+          g_atomic_int_get (&__threshold_generation)))
+    gst_debug_reset_threshold (category, NULL);
+
   return (GstDebugLevel) g_atomic_int_get (&category->threshold);
 }
 
@@ -3073,6 +3191,455 @@ gst_debug_remove_ring_buffer_logger (void)
   gst_debug_remove_log_function (gst_ring_buffer_logger_log);
 }
 
+typedef struct
+{
+  FILE *log_file;
+  guint max_pending;
+
+  /* preformatted lines, pushed by all threads without locking. The queue
+   * grows, max_pending is a soft limit checked before formatting */
+  GstAtomicQueue *lines;
+  volatile gint dropped;
+
+  /* only used to wake up the writer thread */
+  GMutex lock;
+  GCond cond;
+  volatile gint waiting;
+  gboolean stop;
+
+  GThread *thread;
+} GstAsyncLogger;
+
+G_LOCK_DEFINE_STATIC (async_logger);
+static GstAsyncLogger *async_logger = NULL;
+
+static gpointer
+gst_async_logger_thread (GstAsyncLogger * logger)
+{
+  gint reported = 0, dropped;
+  gpointer output[64];
+  guint i, n;
+
+  while (TRUE) {
+    while ((n = gst_atomic_queue_pop_many (logger->lines, output,
+                G_N_ELEMENTS (output)))) {
+      for (i = 0; i < n; i++) {
+        fputs (output[i], logger->log_file);
+        g_free (output[i]);
+      }
+    }
+
+    dropped = g_atomic_int_get (&logger->dropped);
+    if (dropped != reported) {
+      fprintf (logger->log_file, "*** %d debug lines dropped ***\n",
+          dropped - reported);
+      reported = dropped;
+    }
+    fflush (logger->log_file);
+
+    g_mutex_lock (&logger->lock);
+    g_atomic_int_set (&logger->waiting, 1);
+    if (gst_atomic_queue_length (logger->lines) == 0) {
+      if (logger->stop) {
+        g_mutex_unlock (&logger->lock);
+        break;
+      }
+      g_cond_wait (&logger->cond, &logger->lock);
+    }
+    g_atomic_int_set (&logger->waiting, 0);
+    g_mutex_unlock (&logger->lock);
+  }
+
+  return NULL;
+}
+
+static void
+gst_async_logger_log (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer user_data)
+{
+  GstAsyncLogger *logger = user_data;
+  GstClockTime elapsed;
+  gchar *obj, *output;
+  gchar c;
+
+  /* don't even format the line when the writer can't keep up */
+  if (gst_atomic_queue_length (logger->lines) >= logger->max_pending) {
+    g_atomic_int_inc (&logger->dropped);
+    return;
+  }
+
+  c = file[0];
+  if (c == '.' || c == '/' || c == '\\' || (c != '\0' && file[1] == ':')) {
+    file = gst_path_basename (file);
+  }
+
+  if (object) {
+    obj = gst_debug_print_object (object);
+  } else {
+    obj = (gchar *) "";
+  }
+
+  elapsed = GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ());
+
+#define PRINT_FMT " "PID_FMT" "PTR_FMT" %s "CAT_FMT" %s\n"
+  output =
+      g_strdup_printf ("%" GST_TIME_FORMAT PRINT_FMT, GST_TIME_ARGS (elapsed),
+      getpid (), g_thread_self (), gst_debug_level_get_name (level),
+      gst_debug_category_get_name (category), file, line, function, obj,
+      gst_debug_message_get (message));
+#undef PRINT_FMT
+
+  if (object != NULL)
+    g_free (obj);
+
+  gst_atomic_queue_push (logger->lines, output);
+
+  /* only take the lock when the writer is sleeping */
+  if (g_atomic_int_get (&logger->waiting)) {
+    g_mutex_lock (&logger->lock);
+    g_cond_signal (&logger->cond);
+    g_mutex_unlock (&logger->lock);
+  }
+}
+
+static void
+gst_async_logger_free (GstAsyncLogger * logger)
+{
+  G_LOCK (async_logger);
+  if (async_logger == logger)
+    async_logger = NULL;
+  G_UNLOCK (async_logger);
+
+  /* the writer thread writes out everything that is still pending */
+  g_mutex_lock (&logger->lock);
+  logger->stop = TRUE;
+  g_cond_signal (&logger->cond);
+  g_mutex_unlock (&logger->lock);
+  g_thread_join (logger->thread);
+
+  gst_atomic_queue_unref (logger->lines);
+  g_mutex_clear (&logger->lock);
+  g_cond_clear (&logger->cond);
+  g_free (logger);
+}
+
+static void
+gst_debug_add_async_logger_for_file (FILE * log_file, guint max_pending)
+{
+  GstAsyncLogger *logger;
+
+  G_LOCK (async_logger);
+
+  if (async_logger) {
+    g_warn_if_reached ();
+    G_UNLOCK (async_logger);
+    return;
+  }
+
+  logger = g_new0 (GstAsyncLogger, 1);
+  logger->log_file = log_file;
+  logger->max_pending = max_pending;
+  logger->lines = gst_atomic_queue_new (MIN (max_pending, 1024));
+  g_mutex_init (&logger->lock);
+  g_cond_init (&logger->cond);
+
+  logger->thread = g_thread_try_new ("gst-debug-log",
+      (GThreadFunc) gst_async_logger_thread, logger, NULL);
+  if (logger->thread == NULL) {
+    gst_atomic_queue_unref (logger->lines);
+    g_mutex_clear (&logger->lock);
+    g_cond_clear (&logger->cond);
+    g_free (logger);
+    G_UNLOCK (async_logger);
+
+    /* log synchronously then */
+    gst_debug_add_log_function (gst_debug_log_default, log_file, NULL);
+    return;
+  }
+  async_logger = logger;
+
+  gst_debug_add_log_function (gst_async_logger_log, logger,
+      (GDestroyNotify) gst_async_logger_free);
+  G_UNLOCK (async_logger);
+}
+
+/**
+ * gst_debug_add_async_logger:
+ * @max_pending: Maximum number of lines waiting to be written
+ *
+ * Adds a debug logger that writes the same output as gst_debug_log_default()
+ * from a separate thread. The lines are formatted in the thread that logs
+ * them and then queued without taking any locks, so logging doesn't block on
+ * the output. If more than @max_pending lines are waiting, further lines are
+ * dropped and the number of dropped lines is written to the log instead.
+ *
+ * The logger can also be enabled with the GST_DEBUG_ASYNC environment
+ * variable, set to the maximum number of pending lines or to 1 for a
+ * default, in which case it replaces the default log function. It can be
+ * removed again with gst_debug_remove_async_logger(), which writes out all
+ * pending lines. Only one logger at a time is possible.
+ *
+ * Since: 1.14
+ */
+void
+gst_debug_add_async_logger (guint max_pending)
+{
+  g_return_if_fail (max_pending > 0);
+
+  gst_debug_add_async_logger_for_file (default_log_file ? default_log_file :
+      stderr, max_pending);
+}
+
+/**
+ * gst_debug_remove_async_logger:
+ *
+ * Removes any previously added logger with gst_debug_add_async_logger() after
+ * writing out the pending lines.
+ *
+ * Since: 1.14
+ */
+void
+gst_debug_remove_async_logger (void)
+{
+  gst_debug_remove_log_function (gst_async_logger_log);
+}
+
+/**
+ * gst_debug_async_logger_get_dropped:
+ *
+ * Gets the number of lines the logger added with
+ * gst_debug_add_async_logger() dropped because it couldn't write them out
+ * fast enough.
+ *
+ * Returns: the number of dropped lines, or 0 when there is no such logger
+ *
+ * Since: 1.14
+ */
+guint
+gst_debug_async_logger_get_dropped (void)
+{
+  guint dropped = 0;
+
+  G_LOCK (async_logger);
+  if (async_logger)
+    dropped = g_atomic_int_get (&async_logger->dropped);
+  G_UNLOCK (async_logger);
+
+  return dropped;
+}
+
+/* Binary log format, all numbers in host byte order:
+ *
+ * header:  "GSTBLOG1", guint32 0x01020304 (byte order), guint32 pid
+ * string:  'S', guint32 id, guint32 length, bytes
+ * line:    'L', guint8 level, guint32 line, guint32 category id,
+ *          guint32 file id, guint32 function id, guint64 timestamp,
+ *          guint64 thread, guint32 object length, guint32 message length,
+ *          object bytes, message bytes
+ *
+ * Categories, files and functions are written once as string records and
+ * then referenced by their id. "gst-stats --decode" converts the log back
+ * to text. */
+#define BINARY_LOG_MAGIC "GSTBLOG1"
+#define BINARY_LOG_LINE_SIZE (1 + 1 + 4 * 4 + 8 * 2 + 4 * 2)
+
+typedef struct
+{
+  FILE *log_file;
+  GMutex lock;
+  GHashTable *strings;
+  guint32 next_id;
+} GstBinaryLogger;
+
+G_LOCK_DEFINE_STATIC (binary_logger);
+static GstBinaryLogger *binary_logger = NULL;
+
+/* must be called with the logger lock */
+static guint32
+gst_binary_logger_intern (GstBinaryLogger * logger, const gchar * str)
+{
+  gpointer id;
+  guint32 header[2];
+
+  if (g_hash_table_lookup_extended (logger->strings, str, NULL, &id))
+    return GPOINTER_TO_UINT (id);
+
+  header[0] = logger->next_id++;
+  header[1] = strlen (str);
+  g_hash_table_insert (logger->strings, g_strdup (str),
+      GUINT_TO_POINTER (header[0]));
+
+  fputc ('S', logger->log_file);
+  fwrite (header, sizeof (header), 1, logger->log_file);
+  fwrite (str, 1, header[1], logger->log_file);
+
+  return header[0];
+}
+
+static void
+gst_binary_logger_log (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer user_data)
+{
+  GstBinaryLogger *logger = user_data;
+  guint8 record[BINARY_LOG_LINE_SIZE], *p;
+  const gchar *message_str;
+  gchar *obj = NULL;
+  guint32 v32;
+  guint64 v64;
+  gsize obj_len;
+  gchar c;
+
+  c = file[0];
+  if (c == '.' || c == '/' || c == '\\' || (c != '\0' && file[1] == ':')) {
+    file = gst_path_basename (file);
+  }
+
+  if (object)
+    obj = gst_debug_print_object (object);
+  obj_len = obj ? strlen (obj) : 0;
+  message_str = gst_debug_message_get (message);
+
+#define PUT(v) G_STMT_START {                 \
+    memcpy (p, &(v), sizeof (v));               \
+    p += sizeof (v);                            \
+  } G_STMT_END
+  g_mutex_lock (&logger->lock);
+  p = record;
+  *p++ = 'L';
+  *p++ = level;
+  v32 = line;
+  PUT (v32);
+  v32 = gst_binary_logger_intern (logger,
+      gst_debug_category_get_name (category));
+  PUT (v32);
+  v32 = gst_binary_logger_intern (logger, file);
+  PUT (v32);
+  v32 = gst_binary_logger_intern (logger, function);
+  PUT (v32);
+  v64 = GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ());
+  PUT (v64);
+  v64 = (guint64) (guintptr) g_thread_self ();
+  PUT (v64);
+  v32 = obj_len;
+  PUT (v32);
+  v32 = strlen (message_str);
+  PUT (v32);
+#undef PUT
+
+  fwrite (record, sizeof (record), 1, logger->log_file);
+  if (obj_len)
+    fwrite (obj, 1, obj_len, logger->log_file);
+  fwrite (message_str, 1, v32, logger->log_file);
+  g_mutex_unlock (&logger->lock);
+
+  g_free (obj);
+}
+
+static void
+gst_binary_logger_free (GstBinaryLogger * logger)
+{
+  G_LOCK (binary_logger);
+  if (binary_logger == logger)
+    binary_logger = NULL;
+  G_UNLOCK (binary_logger);
+
+  fclose (logger->log_file);
+  g_hash_table_unref (logger->strings);
+  g_mutex_clear (&logger->lock);
+  g_free (logger);
+}
+
+/* takes ownership of @log_file when successful */
+static gboolean
+gst_debug_add_binary_logger_for_file (FILE * log_file)
+{
+  GstBinaryLogger *logger;
+  guint32 header[2];
+
+  G_LOCK (binary_logger);
+
+  if (binary_logger) {
+    G_UNLOCK (binary_logger);
+    return FALSE;
+  }
+
+  header[0] = 0x01020304;
+  header[1] = getpid ();
+  if (fwrite (BINARY_LOG_MAGIC, 8, 1, log_file) != 1
+      || fwrite (header, sizeof (header), 1, log_file) != 1) {
+    G_UNLOCK (binary_logger);
+    return FALSE;
+  }
+
+  logger = binary_logger = g_new0 (GstBinaryLogger, 1);
+  logger->log_file = log_file;
+  logger->strings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      NULL);
+  g_mutex_init (&logger->lock);
+
+  gst_debug_add_log_function (gst_binary_logger_log, logger,
+      (GDestroyNotify) gst_binary_logger_free);
+  G_UNLOCK (binary_logger);
+
+  return TRUE;
+}
+
+/**
+ * gst_debug_add_binary_logger:
+ * @filename: the file to write the log to
+ *
+ * Adds a debug logger that writes a compact binary log to @filename. Instead
+ * of formatting every line as text, the category, file and function names
+ * are only written once and referenced by an id afterwards, and the
+ * timestamp and thread are stored as raw numbers. Only the message itself is
+ * still formatted.
+ *
+ * The log can be converted to the text format of gst_debug_log_default()
+ * with "gst-stats-1.0 --decode", and gst-stats-1.0 also reads the tracer
+ * records from it directly.
+ *
+ * The logger can also be enabled with the GST_DEBUG_BINARY_FILE environment
+ * variable, in which case it replaces the default log function. It can be
+ * removed again with gst_debug_remove_binary_logger(). Only one logger at a
+ * time is possible.
+ *
+ * Returns: %TRUE if the logger was added
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_debug_add_binary_logger (const gchar * filename)
+{
+  FILE *log_file;
+
+  g_return_val_if_fail (filename != NULL, FALSE);
+
+  if (!(log_file = g_fopen (filename, "wb")))
+    return FALSE;
+
+  if (!gst_debug_add_binary_logger_for_file (log_file)) {
+    fclose (log_file);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+ * gst_debug_remove_binary_logger:
+ *
+ * Removes any previously added logger with gst_debug_add_binary_logger() and
+ * closes its file.
+ *
+ * Since: 1.14
+ */
+void
+gst_debug_remove_binary_logger (void)
+{
+  gst_debug_remove_log_function (gst_binary_logger_log);
+}
+
 #else /* GST_DISABLE_GST_DEBUG */
 #ifndef GST_REMOVE_DISABLED
 
@@ -3093,5 +3660,32 @@ gst_debug_remove_ring_buffer_logger (void)
 {
 }
 
+void
+gst_debug_add_async_logger (guint max_pending)
+{
+}
+
+void
+gst_debug_remove_async_logger (void)
+{
+}
+
+guint
+gst_debug_async_logger_get_dropped (void)
+{
+  return 0;
+}
+
+gboolean
+gst_debug_add_binary_logger (const gchar * filename)
+{
+  return FALSE;
+}
+
+void
+gst_debug_remove_binary_logger (void)
+{
+}
+
 #endif /* GST_REMOVE_DISABLED */
 #endif /* GST_DISABLE_GST_DEBUG */
@@ -1753,6 +1753,18 @@ void                  gst_debug_remove_ring_buffer_logger   (void);
 GST_EXPORT
 gchar **              gst_debug_ring_buffer_logger_get_logs (void);
 
+GST_EXPORT
+void                  gst_debug_add_async_logger            (guint max_pending);
+GST_EXPORT
+void                  gst_debug_remove_async_logger         (void);
+GST_EXPORT
+guint                 gst_debug_async_logger_get_dropped    (void);
+
+GST_EXPORT
+gboolean              gst_debug_add_binary_logger           (const gchar * filename);
+GST_EXPORT
+void                  gst_debug_remove_binary_logger        (void);
+
 G_END_DECLS
 
 #endif /* __GSTINFO_H__ */
@@ -835,3 +835,65 @@ gst_iterator_new_single (GType type, const GValue * object)
 
   return GST_ITERATOR (result);
 }
+
+typedef struct
+{
+  GstIterator parent;
+  GPtrArray *array;
+  guint index;
+} GstArrayIterator;
+
+static guint32 _array_dummy_cookie = 0;
+
+static void
+gst_array_iterator_copy (const GstArrayIterator * it, GstArrayIterator * copy)
+{
+  g_ptr_array_ref (copy->array);
+}
+
+static GstIteratorResult
+gst_array_iterator_next (GstArrayIterator * it, GValue * result)
+{
+  if (it->index >= it->array->len)
+    return GST_ITERATOR_DONE;
+
+  g_value_set_object (result, g_ptr_array_index (it->array, it->index));
+  it->index++;
+
+  return GST_ITERATOR_OK;
+}
+
+static void
+gst_array_iterator_resync (GstArrayIterator * it)
+{
+  it->index = 0;
+}
+
+static void
+gst_array_iterator_free (GstArrayIterator * it)
+{
+  g_ptr_array_unref (it->array);
+}
+
+/* Make an iterator over the objects in @array without a lock. @array must
+ * not be changed anymore, the iterator keeps a ref to it so it never needs
+ * a resync. */
+GstIterator *
+_priv_gst_iterator_new_array (GType type, GPtrArray * array)
+{
+  GstArrayIterator *result;
+
+  result = (GstArrayIterator *)
+      gst_iterator_new (sizeof (GstArrayIterator),
+      type, NULL, &_array_dummy_cookie,
+      (GstIteratorCopyFunction) gst_array_iterator_copy,
+      (GstIteratorNextFunction) gst_array_iterator_next,
+      (GstIteratorItemFunction) NULL,
+      (GstIteratorResyncFunction) gst_array_iterator_resync,
+      (GstIteratorFreeFunction) gst_array_iterator_free);
+
+  result->array = g_ptr_array_ref (array);
+  result->index = 0;
+
+  return GST_ITERATOR (result);
+}
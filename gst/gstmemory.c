@@ -73,6 +73,13 @@
 GType _gst_memory_type = 0;
 GST_DEFINE_MINI_OBJECT_TYPE (GstMemory, gst_memory);
 
+/* read maps of plain pointer memory don't update the lock state, which
+ * avoids an atomic operation on memory that is read by many threads */
+#define NEEDS_MAP_LOCK(mem,flags) \
+  (((flags) & GST_MAP_WRITE) != 0 || \
+   !GST_OBJECT_FLAG_IS_SET ((mem)->allocator, \
+       GST_ALLOCATOR_FLAG_UNLOCKED_READ_MAP))
+
 static GstMemory *
 _gst_memory_copy (GstMemory * mem)
 {
@@ -284,6 +291,12 @@ cannot_map:
  * For each gst_memory_map() call, a corresponding gst_memory_unmap() call
  * should be done.
  *
+ * When the allocator of @mem has the %GST_ALLOCATOR_FLAG_UNLOCKED_READ_MAP
+ * flag, mapping for reading does not lock @mem. A read mapping then does not
+ * make a write mapping of @mem fail, @mem must not be written while it is
+ * mapped for reading, as is already the case for memory in a buffer that is
+ * not writable.
+ *
  * Returns: %TRUE if the map operation was successful.
  */
 gboolean
@@ -292,7 +305,8 @@ gst_memory_map (GstMemory * mem, GstMapInfo * info, GstMapFlags flags)
   g_return_val_if_fail (mem != NULL, FALSE);
   g_return_val_if_fail (info != NULL, FALSE);
 
-  if (!gst_memory_lock (mem, (GstLockFlags) flags))
+  if (NEEDS_MAP_LOCK (mem, flags) &&
+      !gst_memory_lock (mem, (GstLockFlags) flags))
     goto lock_failed;
 
   info->flags = flags;
@@ -324,7 +338,8 @@ error:
     /* something went wrong, restore the orginal state again
      * it is up to the subclass to log an error if needed. */
     GST_CAT_INFO (GST_CAT_MEMORY, "mem %p: subclass map failed", mem);
-    gst_memory_unlock (mem, (GstLockFlags) flags);
+    if (NEEDS_MAP_LOCK (mem, flags))
+      gst_memory_unlock (mem, (GstLockFlags) flags);
     memset (info, 0, sizeof (GstMapInfo));
     return FALSE;
   }
@@ -348,7 +363,9 @@ gst_memory_unmap (GstMemory * mem, GstMapInfo * info)
     mem->allocator->mem_unmap_full (mem, info);
   else
     mem->allocator->mem_unmap (mem);
-  gst_memory_unlock (mem, (GstLockFlags) info->flags);
+
+  if (NEEDS_MAP_LOCK (mem, info->flags))
+    gst_memory_unlock (mem, (GstLockFlags) info->flags);
 }
 
 /**
@@ -61,9 +61,39 @@ typedef struct
   GstMessage message;
 
   GstStructure *structure;
+
+  /* the frequently posted messages keep their values here and only create
+   * the structure when it is asked for. The structure is used instead of the
+   * fields once it exists. */
+  gboolean has_fields;
+  union
+  {
+    struct
+    {
+      gint percent;
+      GstBufferingMode mode;
+      gint avg_in, avg_out;
+      gint64 left;
+    } buffering;
+    struct
+    {
+      GstClockTime running_time;
+    } async_done;
+    struct
+    {
+      gboolean live;
+      guint64 running_time, stream_time, timestamp, duration;
+      gint64 jitter;
+      gdouble proportion;
+      gint quality;
+      GstFormat format;
+      guint64 processed, dropped;
+    } qos;
+  } fields;
 } GstMessageImpl;
 
 #define GST_MESSAGE_STRUCTURE(m)  (((GstMessageImpl *)(m))->structure)
+#define GST_MESSAGE_FIELDS(m)     (((GstMessageImpl *)(m))->fields)
 
 typedef struct
 {
@@ -197,6 +227,87 @@ _gst_message_dispose (GstMessage * message)
   return do_free;
 }
 
+/* check if the values of @message are in the fields */
+static inline gboolean
+message_uses_fields (GstMessage * message)
+{
+  return ((GstMessageImpl *) message)->has_fields &&
+      g_atomic_pointer_get (&GST_MESSAGE_STRUCTURE (message)) == NULL;
+}
+
+static GstStructure *
+message_fields_to_structure (GstMessage * message)
+{
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_BUFFERING:
+      return gst_structure_new_id (GST_QUARK (MESSAGE_BUFFERING),
+          GST_QUARK (BUFFER_PERCENT), G_TYPE_INT,
+          GST_MESSAGE_FIELDS (message).buffering.percent,
+          GST_QUARK (BUFFERING_MODE), GST_TYPE_BUFFERING_MODE,
+          GST_MESSAGE_FIELDS (message).buffering.mode,
+          GST_QUARK (AVG_IN_RATE), G_TYPE_INT,
+          GST_MESSAGE_FIELDS (message).buffering.avg_in,
+          GST_QUARK (AVG_OUT_RATE), G_TYPE_INT,
+          GST_MESSAGE_FIELDS (message).buffering.avg_out,
+          GST_QUARK (BUFFERING_LEFT), G_TYPE_INT64,
+          GST_MESSAGE_FIELDS (message).buffering.left, NULL);
+    case GST_MESSAGE_ASYNC_DONE:
+      return gst_structure_new_id (GST_QUARK (MESSAGE_ASYNC_DONE),
+          GST_QUARK (RUNNING_TIME), G_TYPE_UINT64,
+          GST_MESSAGE_FIELDS (message).async_done.running_time, NULL);
+    case GST_MESSAGE_QOS:
+      return gst_structure_new_id (GST_QUARK (MESSAGE_QOS),
+          GST_QUARK (LIVE), G_TYPE_BOOLEAN,
+          GST_MESSAGE_FIELDS (message).qos.live,
+          GST_QUARK (RUNNING_TIME), G_TYPE_UINT64,
+          GST_MESSAGE_FIELDS (message).qos.running_time,
+          GST_QUARK (STREAM_TIME), G_TYPE_UINT64,
+          GST_MESSAGE_FIELDS (message).qos.stream_time,
+          GST_QUARK (TIMESTAMP), G_TYPE_UINT64,
+          GST_MESSAGE_FIELDS (message).qos.timestamp,
+          GST_QUARK (DURATION), G_TYPE_UINT64,
+          GST_MESSAGE_FIELDS (message).qos.duration,
+          GST_QUARK (JITTER), G_TYPE_INT64,
+          GST_MESSAGE_FIELDS (message).qos.jitter,
+          GST_QUARK (PROPORTION), G_TYPE_DOUBLE,
+          GST_MESSAGE_FIELDS (message).qos.proportion,
+          GST_QUARK (QUALITY), G_TYPE_INT,
+          GST_MESSAGE_FIELDS (message).qos.quality,
+          GST_QUARK (FORMAT), GST_TYPE_FORMAT,
+          GST_MESSAGE_FIELDS (message).qos.format,
+          GST_QUARK (PROCESSED), G_TYPE_UINT64,
+          GST_MESSAGE_FIELDS (message).qos.processed,
+          GST_QUARK (DROPPED), G_TYPE_UINT64,
+          GST_MESSAGE_FIELDS (message).qos.dropped, NULL);
+    default:
+      g_assert_not_reached ();
+      return NULL;
+  }
+}
+
+/* get the structure of @message, creating it from the fields if needed.
+ * Several threads can do this for the same message at the same time. */
+static GstStructure *
+message_ensure_structure (GstMessage * message)
+{
+  GstStructure *structure;
+
+  if (G_LIKELY (!message_uses_fields (message)))
+    return GST_MESSAGE_STRUCTURE (message);
+
+  structure = message_fields_to_structure (message);
+  gst_structure_set_parent_refcount (structure,
+      &message->mini_object.refcount);
+  if (!g_atomic_pointer_compare_and_exchange (&GST_MESSAGE_STRUCTURE
+          (message), NULL, structure)) {
+    /* another thread was faster */
+    gst_structure_set_parent_refcount (structure, NULL);
+    gst_structure_free (structure);
+  }
+
+  return GST_MESSAGE_STRUCTURE (message);
+}
+
 static void
 _gst_message_free (GstMessage * message)
 {
@@ -225,6 +336,35 @@ static void
 gst_message_init (GstMessageImpl * message, GstMessageType type,
     GstObject * src);
 
+/* replace the structure, timestamp and seqnum of the writable @message with
+ * the ones of @other, the structure of @other is taken. Used by the bus to
+ * coalesce queued messages. */
+void
+_priv_gst_message_take_contents (GstMessage * message, GstMessage * other)
+{
+  GstStructure *structure;
+
+  g_return_if_fail (gst_message_is_writable (message));
+
+  if ((structure = GST_MESSAGE_STRUCTURE (message))) {
+    gst_structure_set_parent_refcount (structure, NULL);
+    gst_structure_free (structure);
+  }
+  if ((structure = GST_MESSAGE_STRUCTURE (other))) {
+    gst_structure_set_parent_refcount (structure, NULL);
+    gst_structure_set_parent_refcount (structure,
+        &message->mini_object.refcount);
+  }
+  GST_MESSAGE_STRUCTURE (message) = structure;
+  GST_MESSAGE_STRUCTURE (other) = NULL;
+  ((GstMessageImpl *) message)->has_fields =
+      ((GstMessageImpl *) other)->has_fields;
+  GST_MESSAGE_FIELDS (message) = GST_MESSAGE_FIELDS (other);
+
+  GST_MESSAGE_TIMESTAMP (message) = GST_MESSAGE_TIMESTAMP (other);
+  GST_MESSAGE_SEQNUM (message) = GST_MESSAGE_SEQNUM (other);
+}
+
 static GstMessage *
 _gst_message_copy (GstMessage * message)
 {
@@ -251,6 +391,8 @@ _gst_message_copy (GstMessage * message)
   } else {
     GST_MESSAGE_STRUCTURE (copy) = NULL;
   }
+  copy->has_fields = ((GstMessageImpl *) message)->has_fields;
+  copy->fields = GST_MESSAGE_FIELDS (message);
 
   return GST_MESSAGE_CAST (copy);
 }
@@ -720,20 +862,17 @@ GstMessage *
 gst_message_new_buffering (GstObject * src, gint percent)
 {
   GstMessage *message;
-  GstStructure *structure;
-  gint64 buffering_left;
 
   g_return_val_if_fail (percent >= 0 && percent <= 100, NULL);
 
-  buffering_left = (percent == 100 ? 0 : -1);
-
-  structure = gst_structure_new_id (GST_QUARK (MESSAGE_BUFFERING),
-      GST_QUARK (BUFFER_PERCENT), G_TYPE_INT, percent,
-      GST_QUARK (BUFFERING_MODE), GST_TYPE_BUFFERING_MODE, GST_BUFFERING_STREAM,
-      GST_QUARK (AVG_IN_RATE), G_TYPE_INT, -1,
-      GST_QUARK (AVG_OUT_RATE), G_TYPE_INT, -1,
-      GST_QUARK (BUFFERING_LEFT), G_TYPE_INT64, buffering_left, NULL);
-  message = gst_message_new_custom (GST_MESSAGE_BUFFERING, src, structure);
+  /* the structure is only created when it is needed */
+  message = gst_message_new_custom (GST_MESSAGE_BUFFERING, src, NULL);
+  ((GstMessageImpl *) message)->has_fields = TRUE;
+  GST_MESSAGE_FIELDS (message).buffering.percent = percent;
+  GST_MESSAGE_FIELDS (message).buffering.mode = GST_BUFFERING_STREAM;
+  GST_MESSAGE_FIELDS (message).buffering.avg_in = -1;
+  GST_MESSAGE_FIELDS (message).buffering.avg_out = -1;
+  GST_MESSAGE_FIELDS (message).buffering.left = (percent == 100 ? 0 : -1);
 
   return message;
 }
@@ -1082,11 +1221,10 @@ GstMessage *
 gst_message_new_async_done (GstObject * src, GstClockTime running_time)
 {
   GstMessage *message;
-  GstStructure *structure;
 
-  structure = gst_structure_new_id (GST_QUARK (MESSAGE_ASYNC_DONE),
-      GST_QUARK (RUNNING_TIME), G_TYPE_UINT64, running_time, NULL);
-  message = gst_message_new_custom (GST_MESSAGE_ASYNC_DONE, src, structure);
+  message = gst_message_new_custom (GST_MESSAGE_ASYNC_DONE, src, NULL);
+  ((GstMessageImpl *) message)->has_fields = TRUE;
+  GST_MESSAGE_FIELDS (message).async_done.running_time = running_time;
 
   return message;
 }
@@ -1155,7 +1293,31 @@ gst_message_get_structure (GstMessage * message)
 {
   g_return_val_if_fail (GST_IS_MESSAGE (message), NULL);
 
-  return GST_MESSAGE_STRUCTURE (message);
+  return message_ensure_structure (message);
+}
+
+/**
+ * gst_message_writable_structure:
+ * @message: The #GstMessage.
+ *
+ * Get a writable version of the structure, to add extra fields to a message
+ * before posting it. This method should be called with a writable @message.
+ *
+ * Returns: (transfer none): The structure of the message. The structure
+ * is still owned by the message, which means that you should not free
+ * it and that the pointer becomes invalid when you free the message.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+GstStructure *
+gst_message_writable_structure (GstMessage * message)
+{
+  g_return_val_if_fail (GST_IS_MESSAGE (message), NULL);
+  g_return_val_if_fail (gst_message_is_writable (message), NULL);
+
+  return message_ensure_structure (message);
 }
 
 /**
@@ -1175,7 +1337,7 @@ gst_message_has_name (GstMessage * message, const gchar * name)
 
   g_return_val_if_fail (GST_IS_MESSAGE (message), FALSE);
 
-  structure = GST_MESSAGE_STRUCTURE (message);
+  structure = message_ensure_structure (message);
   if (structure == NULL)
     return FALSE;
 
@@ -1237,6 +1399,12 @@ gst_message_parse_buffering (GstMessage * message, gint * percent)
   g_return_if_fail (GST_IS_MESSAGE (message));
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_BUFFERING);
 
+  if (message_uses_fields (message)) {
+    if (percent)
+      *percent = GST_MESSAGE_FIELDS (message).buffering.percent;
+    return;
+  }
+
   if (percent)
     *percent =
         g_value_get_int (gst_structure_id_get_value (GST_MESSAGE_STRUCTURE
@@ -1260,6 +1428,14 @@ gst_message_set_buffering_stats (GstMessage * message, GstBufferingMode mode,
   g_return_if_fail (GST_IS_MESSAGE (message));
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_BUFFERING);
 
+  if (message_uses_fields (message)) {
+    GST_MESSAGE_FIELDS (message).buffering.mode = mode;
+    GST_MESSAGE_FIELDS (message).buffering.avg_in = avg_in;
+    GST_MESSAGE_FIELDS (message).buffering.avg_out = avg_out;
+    GST_MESSAGE_FIELDS (message).buffering.left = buffering_left;
+    return;
+  }
+
   gst_structure_id_set (GST_MESSAGE_STRUCTURE (message),
       GST_QUARK (BUFFERING_MODE), GST_TYPE_BUFFERING_MODE, mode,
       GST_QUARK (AVG_IN_RATE), G_TYPE_INT, avg_in,
@@ -1287,6 +1463,18 @@ gst_message_parse_buffering_stats (GstMessage * message,
 
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_BUFFERING);
 
+  if (message_uses_fields (message)) {
+    if (mode)
+      *mode = GST_MESSAGE_FIELDS (message).buffering.mode;
+    if (avg_in)
+      *avg_in = GST_MESSAGE_FIELDS (message).buffering.avg_in;
+    if (avg_out)
+      *avg_out = GST_MESSAGE_FIELDS (message).buffering.avg_out;
+    if (buffering_left)
+      *buffering_left = GST_MESSAGE_FIELDS (message).buffering.left;
+    return;
+  }
+
   structure = GST_MESSAGE_STRUCTURE (message);
   if (mode)
     *mode = (GstBufferingMode)
@@ -1658,6 +1846,12 @@ gst_message_parse_async_done (GstMessage * message, GstClockTime * running_time)
   g_return_if_fail (GST_IS_MESSAGE (message));
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ASYNC_DONE);
 
+  if (message_uses_fields (message)) {
+    if (running_time)
+      *running_time = GST_MESSAGE_FIELDS (message).async_done.running_time;
+    return;
+  }
+
   structure = GST_MESSAGE_STRUCTURE (message);
   if (running_time)
     *running_time =
@@ -1986,21 +2180,20 @@ gst_message_new_qos (GstObject * src, gboolean live, guint64 running_time,
     guint64 stream_time, guint64 timestamp, guint64 duration)
 {
   GstMessage *message;
-  GstStructure *structure;
 
-  structure = gst_structure_new_id (GST_QUARK (MESSAGE_QOS),
-      GST_QUARK (LIVE), G_TYPE_BOOLEAN, live,
-      GST_QUARK (RUNNING_TIME), G_TYPE_UINT64, running_time,
-      GST_QUARK (STREAM_TIME), G_TYPE_UINT64, stream_time,
-      GST_QUARK (TIMESTAMP), G_TYPE_UINT64, timestamp,
-      GST_QUARK (DURATION), G_TYPE_UINT64, duration,
-      GST_QUARK (JITTER), G_TYPE_INT64, (gint64) 0,
-      GST_QUARK (PROPORTION), G_TYPE_DOUBLE, (gdouble) 1.0,
-      GST_QUARK (QUALITY), G_TYPE_INT, (gint) 1000000,
-      GST_QUARK (FORMAT), GST_TYPE_FORMAT, GST_FORMAT_UNDEFINED,
-      GST_QUARK (PROCESSED), G_TYPE_UINT64, (guint64) - 1,
-      GST_QUARK (DROPPED), G_TYPE_UINT64, (guint64) - 1, NULL);
-  message = gst_message_new_custom (GST_MESSAGE_QOS, src, structure);
+  message = gst_message_new_custom (GST_MESSAGE_QOS, src, NULL);
+  ((GstMessageImpl *) message)->has_fields = TRUE;
+  GST_MESSAGE_FIELDS (message).qos.live = live;
+  GST_MESSAGE_FIELDS (message).qos.running_time = running_time;
+  GST_MESSAGE_FIELDS (message).qos.stream_time = stream_time;
+  GST_MESSAGE_FIELDS (message).qos.timestamp = timestamp;
+  GST_MESSAGE_FIELDS (message).qos.duration = duration;
+  GST_MESSAGE_FIELDS (message).qos.jitter = 0;
+  GST_MESSAGE_FIELDS (message).qos.proportion = 1.0;
+  GST_MESSAGE_FIELDS (message).qos.quality = 1000000;
+  GST_MESSAGE_FIELDS (message).qos.format = GST_FORMAT_UNDEFINED;
+  GST_MESSAGE_FIELDS (message).qos.processed = -1;
+  GST_MESSAGE_FIELDS (message).qos.dropped = -1;
 
   return message;
 }
@@ -2027,6 +2220,13 @@ gst_message_set_qos_values (GstMessage * message, gint64 jitter,
   g_return_if_fail (GST_IS_MESSAGE (message));
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_QOS);
 
+  if (message_uses_fields (message)) {
+    GST_MESSAGE_FIELDS (message).qos.jitter = jitter;
+    GST_MESSAGE_FIELDS (message).qos.proportion = proportion;
+    GST_MESSAGE_FIELDS (message).qos.quality = quality;
+    return;
+  }
+
   structure = GST_MESSAGE_STRUCTURE (message);
   gst_structure_id_set (structure,
       GST_QUARK (JITTER), G_TYPE_INT64, jitter,
@@ -2062,6 +2262,13 @@ gst_message_set_qos_stats (GstMessage * message, GstFormat format,
   g_return_if_fail (GST_IS_MESSAGE (message));
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_QOS);
 
+  if (message_uses_fields (message)) {
+    GST_MESSAGE_FIELDS (message).qos.format = format;
+    GST_MESSAGE_FIELDS (message).qos.processed = processed;
+    GST_MESSAGE_FIELDS (message).qos.dropped = dropped;
+    return;
+  }
+
   structure = GST_MESSAGE_STRUCTURE (message);
   gst_structure_id_set (structure,
       GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
@@ -2100,6 +2307,20 @@ gst_message_parse_qos (GstMessage * message, gboolean * live,
   g_return_if_fail (GST_IS_MESSAGE (message));
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_QOS);
 
+  if (message_uses_fields (message)) {
+    if (live)
+      *live = GST_MESSAGE_FIELDS (message).qos.live;
+    if (running_time)
+      *running_time = GST_MESSAGE_FIELDS (message).qos.running_time;
+    if (stream_time)
+      *stream_time = GST_MESSAGE_FIELDS (message).qos.stream_time;
+    if (timestamp)
+      *timestamp = GST_MESSAGE_FIELDS (message).qos.timestamp;
+    if (duration)
+      *duration = GST_MESSAGE_FIELDS (message).qos.duration;
+    return;
+  }
+
   structure = GST_MESSAGE_STRUCTURE (message);
   gst_structure_id_get (structure,
       GST_QUARK (LIVE), G_TYPE_BOOLEAN, live,
@@ -2133,6 +2354,16 @@ gst_message_parse_qos_values (GstMessage * message, gint64 * jitter,
   g_return_if_fail (GST_IS_MESSAGE (message));
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_QOS);
 
+  if (message_uses_fields (message)) {
+    if (jitter)
+      *jitter = GST_MESSAGE_FIELDS (message).qos.jitter;
+    if (proportion)
+      *proportion = GST_MESSAGE_FIELDS (message).qos.proportion;
+    if (quality)
+      *quality = GST_MESSAGE_FIELDS (message).qos.quality;
+    return;
+  }
+
   structure = GST_MESSAGE_STRUCTURE (message);
   gst_structure_id_get (structure,
       GST_QUARK (JITTER), G_TYPE_INT64, jitter,
@@ -2169,6 +2400,16 @@ gst_message_parse_qos_stats (GstMessage * message, GstFormat * format,
   g_return_if_fail (GST_IS_MESSAGE (message));
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_QOS);
 
+  if (message_uses_fields (message)) {
+    if (format)
+      *format = GST_MESSAGE_FIELDS (message).qos.format;
+    if (processed)
+      *processed = GST_MESSAGE_FIELDS (message).qos.processed;
+    if (dropped)
+      *dropped = GST_MESSAGE_FIELDS (message).qos.dropped;
+    return;
+  }
+
   structure = GST_MESSAGE_STRUCTURE (message);
   gst_structure_id_get (structure,
       GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
@@ -448,6 +448,8 @@ GstMessage *    gst_message_new_custom          (GstMessageType type,
 GST_EXPORT
 const GstStructure *
                 gst_message_get_structure       (GstMessage *message);
+GST_EXPORT
+GstStructure *  gst_message_writable_structure  (GstMessage *message);
 
 GST_EXPORT
 gboolean        gst_message_has_name            (GstMessage *message, const gchar *name);
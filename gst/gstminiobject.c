@@ -58,8 +58,6 @@
 #include "gst/gstinfo.h"
 #include <gobject/gvaluecollector.h>
 
-/* Mutex used for weak referencing */
-G_LOCK_DEFINE_STATIC (qdata_mutex);
 static GQuark weak_ref_quark;
 
 #define SHARE_ONE (1 << 16)
@@ -85,6 +83,13 @@ typedef struct
 #define QDATA_DATA(o,i)     (QDATA(o,i).data)
 #define QDATA_DESTROY(o,i)  (QDATA(o,i).destroy)
 
+/* the highest bit of n_qdata locks the weak refs and qdata of the object, so
+ * that threads using different objects don't contend on a global lock */
+#define QDATA_LOCK_BIT      31
+#define QDATA_LOCK(o)       g_bit_lock ((volatile gint *) &(o)->n_qdata, QDATA_LOCK_BIT)
+#define QDATA_UNLOCK(o)     g_bit_unlock ((volatile gint *) &(o)->n_qdata, QDATA_LOCK_BIT)
+#define N_QDATA(o)          ((o)->n_qdata & ~(1U << QDATA_LOCK_BIT))
+
 void
 _priv_gst_mini_object_initialize (void)
 {
@@ -364,7 +369,7 @@ find_notify (GstMiniObject * object, GQuark quark, gboolean match_notify,
 {
   guint i;
 
-  for (i = 0; i < object->n_qdata; i++) {
+  for (i = 0; i < N_QDATA (object); i++) {
     if (QDATA_QUARK (object, i) == quark) {
       /* check if we need to match the callback too */
       if (!match_notify || (QDATA_NOTIFY (object, i) == notify &&
@@ -378,13 +383,18 @@ find_notify (GstMiniObject * object, GQuark quark, gboolean match_notify,
 static void
 remove_notify (GstMiniObject * object, gint index)
 {
-  /* remove item */
-  if (--object->n_qdata == 0) {
+  guint n_qdata;
+
+  /* remove item, the count is changed atomically because it shares its bits
+   * with the lock */
+  g_atomic_int_add ((volatile gint *) &object->n_qdata, -1);
+  n_qdata = N_QDATA (object);
+  if (n_qdata == 0) {
     /* we don't shrink but free when everything is gone */
     g_free (object->qdata);
     object->qdata = NULL;
-  } else if (index != object->n_qdata)
-    QDATA (object, index) = QDATA (object, object->n_qdata);
+  } else if (index != n_qdata)
+    QDATA (object, index) = QDATA (object, n_qdata);
 }
 
 static void
@@ -393,9 +403,9 @@ set_notify (GstMiniObject * object, gint index, GQuark quark,
 {
   if (index == -1) {
     /* add item */
-    index = object->n_qdata++;
-    object->qdata =
-        g_realloc (object->qdata, sizeof (GstQData) * object->n_qdata);
+    index = N_QDATA (object);
+    g_atomic_int_add ((volatile gint *) &object->n_qdata, 1);
+    object->qdata = g_realloc (object->qdata, sizeof (GstQData) * (index + 1));
   }
   QDATA_QUARK (object, index) = quark;
   QDATA_NOTIFY (object, index) = notify;
@@ -408,7 +418,7 @@ call_finalize_notify (GstMiniObject * obj)
 {
   guint i;
 
-  for (i = 0; i < obj->n_qdata; i++) {
+  for (i = 0; i < N_QDATA (obj); i++) {
     if (QDATA_QUARK (obj, i) == weak_ref_quark)
       QDATA_NOTIFY (obj, i) (QDATA_DATA (obj, i), obj);
     if (QDATA_DESTROY (obj, i))
@@ -456,7 +466,7 @@ gst_mini_object_unref (GstMiniObject * mini_object)
       g_return_if_fail ((g_atomic_int_get (&mini_object->lockstate) & LOCK_MASK)
           < 4);
 
-      if (mini_object->n_qdata) {
+      if (N_QDATA (mini_object)) {
         call_finalize_notify (mini_object);
         g_free (mini_object->qdata);
       }
@@ -603,9 +613,9 @@ gst_mini_object_weak_ref (GstMiniObject * object,
   g_return_if_fail (notify != NULL);
   g_return_if_fail (GST_MINI_OBJECT_REFCOUNT_VALUE (object) >= 1);
 
-  G_LOCK (qdata_mutex);
+  QDATA_LOCK (object);
   set_notify (object, -1, weak_ref_quark, notify, data, NULL);
-  G_UNLOCK (qdata_mutex);
+  QDATA_UNLOCK (object);
 }
 
 /**
@@ -625,14 +635,14 @@ gst_mini_object_weak_unref (GstMiniObject * object,
   g_return_if_fail (object != NULL);
   g_return_if_fail (notify != NULL);
 
-  G_LOCK (qdata_mutex);
+  QDATA_LOCK (object);
   if ((i = find_notify (object, weak_ref_quark, TRUE, notify, data)) != -1) {
     remove_notify (object, i);
   } else {
     g_warning ("%s: couldn't find weak ref %p (object:%p data:%p)", G_STRFUNC,
         notify, object, data);
   }
-  G_UNLOCK (qdata_mutex);
+  QDATA_UNLOCK (object);
 }
 
 /**
@@ -667,7 +677,7 @@ gst_mini_object_set_qdata (GstMiniObject * object, GQuark quark,
   g_return_if_fail (object != NULL);
   g_return_if_fail (quark > 0);
 
-  G_LOCK (qdata_mutex);
+  QDATA_LOCK (object);
   if ((i = find_notify (object, quark, FALSE, NULL, NULL)) != -1) {
 
     old_data = QDATA_DATA (object, i);
@@ -678,7 +688,7 @@ gst_mini_object_set_qdata (GstMiniObject * object, GQuark quark,
   }
   if (data != NULL)
     set_notify (object, i, quark, NULL, data, destroy);
-  G_UNLOCK (qdata_mutex);
+  QDATA_UNLOCK (object);
 
   if (old_notify)
     old_notify (old_data);
@@ -704,12 +714,17 @@ gst_mini_object_get_qdata (GstMiniObject * object, GQuark quark)
   g_return_val_if_fail (object != NULL, NULL);
   g_return_val_if_fail (quark > 0, NULL);
 
-  G_LOCK (qdata_mutex);
+  /* nothing to look for, this is the common case */
+  if ((g_atomic_int_get ((volatile gint *) &object->n_qdata) &
+          ~(1U << QDATA_LOCK_BIT)) == 0)
+    return NULL;
+
+  QDATA_LOCK (object);
   if ((i = find_notify (object, quark, FALSE, NULL, NULL)) != -1)
     result = QDATA_DATA (object, i);
   else
     result = NULL;
-  G_UNLOCK (qdata_mutex);
+  QDATA_UNLOCK (object);
 
   return result;
 }
@@ -735,14 +750,14 @@ gst_mini_object_steal_qdata (GstMiniObject * object, GQuark quark)
   g_return_val_if_fail (object != NULL, NULL);
   g_return_val_if_fail (quark > 0, NULL);
 
-  G_LOCK (qdata_mutex);
+  QDATA_LOCK (object);
   if ((i = find_notify (object, quark, FALSE, NULL, NULL)) != -1) {
     result = QDATA_DATA (object, i);
     remove_notify (object, i);
   } else {
     result = NULL;
   }
-  G_UNLOCK (qdata_mutex);
+  QDATA_UNLOCK (object);
 
   return result;
 }
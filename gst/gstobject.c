@@ -404,12 +404,26 @@ gst_object_finalize (GObject * object)
   ((GObjectClass *) gst_object_parent_class)->finalize (object);
 }
 
+/* check if emitting deep-notify for @detail on @object calls anything */
+static inline gboolean
+gst_object_has_deep_notify_handler (GstObject * object, GQuark detail)
+{
+  if (GST_OBJECT_GET_CLASS (object)->deep_notify != NULL)
+    return TRUE;
+
+  return g_signal_has_handler_pending (object, gst_object_signals[DEEP_NOTIFY],
+      detail, FALSE);
+}
+
 /* Changing a GObject property of a GstObject will result in "deep-notify"
  * signals being emitted by the object itself, as well as in each parent
  * object. This is so that an application can connect a listener to the
  * top-level bin to catch property-change notifications for all contained
  * elements.
  *
+ * Parents without handlers for the property are skipped and bins can stop
+ * the propagation with gst_bin_set_deep_notify_filter().
+ *
  * MT safe.
  */
 static void
@@ -437,20 +451,32 @@ gst_object_dispatch_properties_changed (GObject * object,
     debug_name = "";
 #endif
 
-  /* now let the parent dispatch those, too */
-  parent = gst_object_get_parent (gst_object);
-  while (parent) {
-    for (i = 0; i < n_pspecs; i++) {
-      GST_CAT_LOG_OBJECT (GST_CAT_PROPERTIES, parent,
-          "deep notification from %s (%s)", debug_name, pspecs[i]->name);
+  /* now let the parents dispatch those, too */
+  for (i = 0; i < n_pspecs; i++) {
+    GQuark detail = g_quark_from_string (pspecs[i]->name);
+
+    parent = gst_object_get_parent (gst_object);
+    while (parent) {
+      if (!_priv_gst_bin_accepts_deep_notify (parent, gst_object, detail)) {
+        GST_CAT_LOG_OBJECT (GST_CAT_PROPERTIES, parent,
+            "deep notification from %s (%s) filtered", debug_name,
+            pspecs[i]->name);
+        gst_object_unref (parent);
+        break;
+      }
 
-      g_signal_emit (parent, gst_object_signals[DEEP_NOTIFY],
-          g_quark_from_string (pspecs[i]->name), gst_object, pspecs[i]);
-    }
+      if (gst_object_has_deep_notify_handler (parent, detail)) {
+        GST_CAT_LOG_OBJECT (GST_CAT_PROPERTIES, parent,
+            "deep notification from %s (%s)", debug_name, pspecs[i]->name);
 
-    old_parent = parent;
-    parent = gst_object_get_parent (old_parent);
-    gst_object_unref (old_parent);
+        g_signal_emit (parent, gst_object_signals[DEEP_NOTIFY], detail,
+            gst_object, pspecs[i]);
+      }
+
+      old_parent = parent;
+      parent = gst_object_get_parent (old_parent);
+      gst_object_unref (old_parent);
+    }
   }
 #ifndef GST_DISABLE_GST_DEBUG
   g_free (name);
@@ -1099,7 +1125,8 @@ gboolean
 gst_object_sync_values (GstObject * object, GstClockTime timestamp)
 {
   GList *node;
-  gboolean ret = TRUE;
+  GstControlBinding *binding;
+  gboolean ret = TRUE, frozen = FALSE;
 
   g_return_val_if_fail (GST_IS_OBJECT (object), FALSE);
   g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (timestamp), FALSE);
@@ -1110,13 +1137,22 @@ gst_object_sync_values (GstObject * object, GstClockTime timestamp)
 
   /* FIXME: this deadlocks */
   /* GST_OBJECT_LOCK (object); */
-  g_object_freeze_notify ((GObject *) object);
   for (node = object->control_bindings; node; node = g_list_next (node)) {
-    ret &= gst_control_binding_sync_values ((GstControlBinding *) node->data,
-        object, timestamp, object->last_sync);
+    binding = node->data;
+    if (binding->disabled)
+      continue;
+    /* freeze once for all bindings so that their notifications are sent
+     * together, and not at all when every binding is disabled */
+    if (!frozen) {
+      g_object_freeze_notify ((GObject *) object);
+      frozen = TRUE;
+    }
+    ret &= gst_control_binding_sync_values (binding, object, timestamp,
+        object->last_sync);
   }
   object->last_sync = timestamp;
-  g_object_thaw_notify ((GObject *) object);
+  if (frozen)
+    g_object_thaw_notify ((GObject *) object);
   /* GST_OBJECT_UNLOCK (object); */
 
   return ret;
@@ -1460,3 +1496,38 @@ gst_object_set_control_rate (GstObject * object, GstClockTime control_rate)
 
   object->control_rate = control_rate;
 }
+
+/* the traced lock macros in gst_private.h only get here when the lock is
+ * contended, it is only timed when tracers are active */
+void
+_priv_gst_object_lock_contended (GstObject * object, GMutex * lock)
+{
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  if (G_UNLIKELY (GST_TRACER_IS_ENABLED)) {
+    GstClockTime start = gst_util_get_timestamp ();
+
+    g_mutex_lock (lock);
+    GST_TRACER_OBJECT_LOCK_WAIT (object, "object",
+        gst_util_get_timestamp () - start);
+    return;
+  }
+#endif
+  g_mutex_lock (lock);
+}
+
+void
+_priv_gst_object_rec_lock_contended (GstObject * object, GRecMutex * lock,
+    const gchar * name)
+{
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  if (G_UNLIKELY (GST_TRACER_IS_ENABLED)) {
+    GstClockTime start = gst_util_get_timestamp ();
+
+    g_rec_mutex_lock (lock);
+    GST_TRACER_OBJECT_LOCK_WAIT (object, name,
+        gst_util_get_timestamp () - start);
+    return;
+  }
+#endif
+  g_rec_mutex_lock (lock);
+}
@@ -135,20 +135,50 @@ typedef struct
   GstEvent *event;
 } PadEvent;
 
+/* a bit for an event type in the event masks below. The sticky event types
+ * have different numbers modulo 64, other types can share a bit, which only
+ * makes the masks less precise */
+#define EVENT_TYPE_BIT(type) \
+    (G_GUINT64_CONSTANT (1) << (((type) >> GST_EVENT_NUM_SHIFT) & 63))
+
+/* the caps are kept alive by the cache, so their pointers are not reused and
+ * they can't be modified */
+#define ACCEPT_CAPS_CACHE_SIZE 4
+
+typedef struct
+{
+  GstCaps *caps;
+  gboolean intersect;
+  gboolean result;
+} GstPadAcceptCapsEntry;
+
 struct _GstPadPrivate
 {
   guint events_cookie;
   GArray *events;
   guint last_cookie;
+  /* the types of the stored events and the types of the events that are not
+   * received yet. The masks can have bits of removed events set but never
+   * miss a bit, so a zero bit means there is no such event */
+  guint64 events_mask;
+  guint64 pending_mask;
 
   gint using;
   guint probe_list_cookie;
   guint probe_cookie;
+  /* the types of all probes, to skip the probes quickly for data they can't
+   * match */
+  GstPadProbeType probe_mask;
 
   /* counter of how many idle probes are running directly from the add_probe
    * call. Used to block any data flowing in the pad while the idle callback
    * Doesn't finish its work */
   gint idle_running;
+
+  /* the results of the last ACCEPT_CAPS queries against the template caps,
+   * protected by the object lock */
+  GstPadAcceptCapsEntry accept_caps_cache[ACCEPT_CAPS_CACHE_SIZE];
+  guint accept_caps_next;
 };
 
 typedef struct
@@ -447,6 +477,8 @@ remove_events (GstPad * pad)
   GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_PENDING_EVENTS);
   g_array_set_size (events, 0);
   pad->priv->events_cookie++;
+  pad->priv->events_mask = 0;
+  pad->priv->pending_mask = 0;
 
   if (notify) {
     GST_OBJECT_UNLOCK (pad);
@@ -466,6 +498,10 @@ find_event_by_type (GstPad * pad, GstEventType type, guint idx)
   GArray *events;
   PadEvent *ev;
 
+  /* the common case of an event that was never stored */
+  if (!(pad->priv->events_mask & EVENT_TYPE_BIT (type)))
+    return NULL;
+
   events = pad->priv->events;
   len = events->len;
 
@@ -543,6 +579,32 @@ remove_event_by_type (GstPad * pad, GstEventType type)
   }
 }
 
+/* recalculate the event masks from the stored events.
+ * should be called with OBJECT lock */
+static void
+update_events_mask (GstPad * pad)
+{
+  guint i, len;
+  GArray *events;
+  PadEvent *ev;
+  guint64 events_mask = 0, pending_mask = 0;
+
+  events = pad->priv->events;
+  len = events->len;
+
+  for (i = 0; i < len; i++) {
+    ev = &g_array_index (events, PadEvent, i);
+    if (ev->event == NULL)
+      continue;
+
+    events_mask |= EVENT_TYPE_BIT (GST_EVENT_TYPE (ev->event));
+    if (!ev->received)
+      pending_mask |= EVENT_TYPE_BIT (GST_EVENT_TYPE (ev->event));
+  }
+  pad->priv->events_mask = events_mask;
+  pad->priv->pending_mask = pending_mask;
+}
+
 /* check all events on srcpad against those on sinkpad. All events that are not
  * on sinkpad are marked as received=%FALSE and the PENDING_EVENTS is set on the
  * srcpad so that the events will be sent next time */
@@ -565,6 +627,7 @@ schedule_events (GstPad * srcpad, GstPad * sinkpad)
 
     if (sinkpad == NULL || !find_event (sinkpad, ev->event)) {
       ev->received = FALSE;
+      srcpad->priv->pending_mask |= EVENT_TYPE_BIT (GST_EVENT_TYPE (ev->event));
       pending = TRUE;
     }
   }
@@ -613,6 +676,8 @@ restart:
 
     /* store the received state */
     ev->received = ev_ret.received;
+    if (!ev->received)
+      pad->priv->pending_mask |= EVENT_TYPE_BIT (GST_EVENT_TYPE (ev->event));
 
     /* if the event changed, we need to do something */
     if (G_UNLIKELY (ev->event != ev_ret.event)) {
@@ -626,6 +691,10 @@ restart:
       } else {
         /* function gave a new event for us */
         gst_event_take (&ev->event, ev_ret.event);
+        pad->priv->events_mask |= EVENT_TYPE_BIT (GST_EVENT_TYPE (ev->event));
+        if (!ev->received)
+          pad->priv->pending_mask |=
+              EVENT_TYPE_BIT (GST_EVENT_TYPE (ev->event));
       }
     } else {
       /* just unref, nothing changed */
@@ -722,6 +791,7 @@ gst_pad_dispose (GObject * object)
   GST_OBJECT_UNLOCK (pad);
 
   g_hook_list_clear (&pad->probes);
+  pad->priv->probe_mask = 0;
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
@@ -1012,7 +1082,7 @@ post_activate (GstPad * pad, GstPadMode new_mode)
   switch (new_mode) {
     case GST_PAD_MODE_NONE:
       /* ensures that streaming stops */
-      GST_PAD_STREAM_LOCK (pad);
+      GST_PAD_STREAM_LOCK_TRACED (pad);
       GST_DEBUG_OBJECT (pad, "stopped streaming");
       GST_OBJECT_LOCK (pad);
       remove_events (pad);
@@ -1334,6 +1404,13 @@ cleanup_hook (GstPad * pad, GHook * hook)
   }
   g_hook_destroy_link (&pad->probes, hook);
   pad->num_probes--;
+
+  /* recalculate the mask from the remaining probes */
+  pad->priv->probe_mask = 0;
+  for (hook = pad->probes.hooks; hook; hook = hook->next) {
+    if (G_HOOK_IS_VALID (hook))
+      pad->priv->probe_mask |= (hook->flags >> G_HOOK_FLAG_USER_SHIFT);
+  }
 }
 
 /**
@@ -1398,6 +1475,7 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
   /* add the probe */
   g_hook_append (&pad->probes, hook);
   pad->num_probes++;
+  pad->priv->probe_mask |= mask;
   /* incremenent cookie so that the new hook get's called */
   pad->priv->probe_list_cookie++;
 
@@ -2583,6 +2661,53 @@ gst_pad_link (GstPad * srcpad, GstPad * sinkpad)
   return gst_pad_link_full (srcpad, sinkpad, GST_PAD_LINK_CHECK_DEFAULT);
 }
 
+/* call with the OBJECT_LOCK */
+static void
+clear_accept_caps_cache (GstPad * pad)
+{
+  guint i;
+
+  for (i = 0; i < ACCEPT_CAPS_CACHE_SIZE; i++)
+    gst_caps_replace (&pad->priv->accept_caps_cache[i].caps, NULL);
+}
+
+static gboolean
+lookup_accept_caps_cache (GstPad * pad, GstCaps * caps, gboolean * result)
+{
+  gboolean intersect = GST_PAD_IS_ACCEPT_INTERSECT (pad);
+  gboolean found = FALSE;
+  guint i;
+
+  GST_OBJECT_LOCK (pad);
+  for (i = 0; i < ACCEPT_CAPS_CACHE_SIZE; i++) {
+    GstPadAcceptCapsEntry *entry = &pad->priv->accept_caps_cache[i];
+
+    if (entry->caps == caps && entry->intersect == intersect) {
+      *result = entry->result;
+      found = TRUE;
+      break;
+    }
+  }
+  GST_OBJECT_UNLOCK (pad);
+
+  return found;
+}
+
+static void
+store_accept_caps_cache (GstPad * pad, GstCaps * caps, gboolean result)
+{
+  GstPadAcceptCapsEntry *entry;
+
+  GST_OBJECT_LOCK (pad);
+  entry = &pad->priv->accept_caps_cache[pad->priv->accept_caps_next];
+  pad->priv->accept_caps_next =
+      (pad->priv->accept_caps_next + 1) % ACCEPT_CAPS_CACHE_SIZE;
+  gst_caps_replace (&entry->caps, caps);
+  entry->intersect = GST_PAD_IS_ACCEPT_INTERSECT (pad);
+  entry->result = result;
+  GST_OBJECT_UNLOCK (pad);
+}
+
 static void
 gst_pad_set_pad_template (GstPad * pad, GstPadTemplate * templ)
 {
@@ -2593,6 +2718,7 @@ gst_pad_set_pad_template (GstPad * pad, GstPadTemplate * templ)
   GST_OBJECT_LOCK (pad);
   template_p = &pad->padtemplate;
   gst_object_replace ((GstObject **) template_p, (GstObject *) templ);
+  clear_accept_caps_cache (pad);
   GST_OBJECT_UNLOCK (pad);
 
   if (templ)
@@ -3062,7 +3188,7 @@ gst_pad_query_accept_caps_default (GstPad * pad, GstQuery * query)
 {
   /* get the caps and see if it intersects to something not empty */
   GstCaps *caps, *allowed = NULL;
-  gboolean result;
+  gboolean result, cache = FALSE;
 
   GST_DEBUG_OBJECT (pad, "query accept-caps %" GST_PTR_FORMAT, query);
 
@@ -3079,7 +3205,16 @@ gst_pad_query_accept_caps_default (GstPad * pad, GstQuery * query)
   gst_query_parse_accept_caps (query, &caps);
   if (!allowed) {
     if (GST_PAD_IS_ACCEPT_TEMPLATE (pad)) {
+      /* the template caps don't change, so the result for the same caps is
+       * the same */
+      if (lookup_accept_caps_cache (pad, caps, &result)) {
+        GST_DEBUG_OBJECT (pad, "cached result %d for caps %" GST_PTR_FORMAT,
+            result, caps);
+        gst_query_set_accept_caps_result (query, result);
+        goto done;
+      }
       allowed = gst_pad_get_pad_template_caps (pad);
+      cache = TRUE;
     } else {
       GST_CAT_DEBUG_OBJECT (GST_CAT_PERFORMANCE, pad,
           "fallback ACCEPT_CAPS query, consider implementing a specialized version");
@@ -3099,6 +3234,9 @@ gst_pad_query_accept_caps_default (GstPad * pad, GstQuery * query)
       result = gst_caps_is_subset (caps, allowed);
     }
     gst_caps_unref (allowed);
+
+    if (cache)
+      store_accept_caps_cache (pad, caps, result);
   } else {
     GST_DEBUG_OBJECT (pad, "no compatible caps allowed on the pad");
     result = FALSE;
@@ -3526,10 +3664,40 @@ no_match:
   }
 }
 
+/* check if any probe of @pad could match @type, using the mask of all its
+ * probes. This is a shortcut for the checks in probe_hook_marshal(), when no
+ * probe matches do_probe_callbacks() lets the data pass anyway. A serialized
+ * item still has to wait for a running idle probe though. */
+static inline gboolean
+probe_mask_can_match (GstPad * pad, GstPadProbeType type)
+{
+  GstPadProbeType mask = pad->priv->probe_mask;
+  gboolean check_data;
+
+  if (G_UNLIKELY (GST_PAD_IS_RUNNING_IDLE_PROBE (pad)))
+    return TRUE;
+
+  if ((mask & GST_PAD_PROBE_TYPE_SCHEDULING & type) == 0)
+    return FALSE;
+  if ((type & GST_PAD_PROBE_TYPE_BLOCKING) &&
+      (mask & GST_PAD_PROBE_TYPE_BLOCKING & type) == 0)
+    return FALSE;
+
+  if (type & GST_PAD_PROBE_TYPE_PUSH)
+    check_data = (type & GST_PAD_PROBE_TYPE_IDLE) == 0;
+  else
+    check_data = (type & GST_PAD_PROBE_TYPE_BLOCKING) == 0;
+  if (check_data && (mask & _PAD_PROBE_TYPE_ALL_BOTH_AND_FLUSH & type) == 0)
+    return FALSE;
+
+  return TRUE;
+}
+
 /* a probe that does not take or return any data */
 #define PROBE_NO_DATA(pad,mask,label,defaultval)                \
   G_STMT_START {						\
-    if (G_UNLIKELY (pad->num_probes)) {				\
+    if (G_UNLIKELY (pad->num_probes) &&				\
+        probe_mask_can_match (pad, mask)) {			\
       GstFlowReturn pval = defaultval;				\
       /* pass NULL as the data item */                          \
       GstPadProbeInfo info = { mask, 0, NULL, 0, 0 };		\
@@ -3542,7 +3710,8 @@ no_match:
 
 #define PROBE_FULL(pad,mask,data,offs,size,label,handleable,handle_label) \
   G_STMT_START {							\
-    if (G_UNLIKELY (pad->num_probes)) {					\
+    if (G_UNLIKELY (pad->num_probes) &&					\
+        probe_mask_can_match (pad, mask)) {				\
       /* pass the data item */						\
       GstPadProbeInfo info = { mask, 0, data, offs, size };		\
       info.ABI.abi.flow_ret = GST_FLOW_OK;				\
@@ -3870,6 +4039,11 @@ check_sticky (GstPad * pad, GstEvent * event)
   if (G_UNLIKELY (GST_PAD_HAS_PENDING_EVENTS (pad))) {
     GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_PENDING_EVENTS);
 
+    /* the flag is also set after a failed push, there is nothing to send
+     * when all events were received */
+    if (pad->priv->pending_mask == 0)
+      return GST_FLOW_OK;
+
     GST_DEBUG_OBJECT (pad, "pushing all sticky events");
     events_foreach (pad, push_sticky, &data);
 
@@ -3892,6 +4066,7 @@ check_sticky (GstPad * pad, GstEvent * event)
           data.ret = GST_FLOW_OK;
       }
     }
+    update_events_mask (pad);
   }
   return data.ret;
 }
@@ -3944,7 +4119,7 @@ gst_pad_query (GstPad * pad, GstQuery * query)
 
   serialized = GST_QUERY_IS_SERIALIZED (query);
   if (G_UNLIKELY (serialized))
-    GST_PAD_STREAM_LOCK (pad);
+    GST_PAD_STREAM_LOCK_TRACED (pad);
 
   GST_OBJECT_LOCK (pad);
   PROBE_PUSH (pad, type | GST_PAD_PROBE_TYPE_PUSH |
@@ -4161,7 +4336,7 @@ gst_pad_chain_data_unchecked (GstPad * pad, GstPadProbeType type, void *data)
   GstObject *parent;
   gboolean handled = FALSE;
 
-  GST_PAD_STREAM_LOCK (pad);
+  GST_PAD_STREAM_LOCK_TRACED (pad);
 
   GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
@@ -4353,18 +4528,25 @@ gst_pad_chain_list_default (GstPad * pad, GstObject * parent,
   guint i, len;
   GstBuffer *buffer;
   GstFlowReturn ret;
+  gboolean writable;
 
   GST_INFO_OBJECT (pad, "chaining each buffer in list individually");
 
   len = gst_buffer_list_length (list);
+  /* when we have the only reference to the list we can hand its buffers
+   * over instead of taking new references */
+  writable = gst_buffer_list_is_writable (list);
 
   ret = GST_FLOW_OK;
   for (i = 0; i < len; i++) {
-    buffer = gst_buffer_list_get (list, i);
+    if (writable)
+      buffer = gst_buffer_list_take (list, 0);
+    else
+      buffer = gst_buffer_ref (gst_buffer_list_get (list, i));
+
     ret =
         gst_pad_chain_data_unchecked (pad,
-        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH,
-        gst_buffer_ref (buffer));
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
     if (ret != GST_FLOW_OK)
       break;
   }
@@ -4416,7 +4598,7 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
   GstFlowReturn ret;
   gboolean handled = FALSE;
 
-  GST_OBJECT_LOCK (pad);
+  GST_OBJECT_LOCK_TRACED (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
     goto flushing;
 
@@ -4445,20 +4627,24 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
   if (G_UNLIKELY ((ret = check_sticky (pad, NULL))) != GST_FLOW_OK)
     goto events_error;
 
-  /* do block probes */
-  PROBE_HANDLE (pad, type | GST_PAD_PROBE_TYPE_BLOCK, data, probe_stopped,
-      probe_handled);
+  /* without probes nothing can block or relink the pad below, we can go
+   * straight to the peer */
+  if (G_UNLIKELY (pad->num_probes)) {
+    /* do block probes */
+    PROBE_HANDLE (pad, type | GST_PAD_PROBE_TYPE_BLOCK, data, probe_stopped,
+        probe_handled);
 
-  /* recheck sticky events because the probe might have cause a relink */
-  if (G_UNLIKELY ((ret = check_sticky (pad, NULL))) != GST_FLOW_OK)
-    goto events_error;
+    /* recheck sticky events because the probe might have cause a relink */
+    if (G_UNLIKELY ((ret = check_sticky (pad, NULL))) != GST_FLOW_OK)
+      goto events_error;
 
-  /* do post-blocking probes */
-  PROBE_HANDLE (pad, type, data, probe_stopped, probe_handled);
+    /* do post-blocking probes */
+    PROBE_HANDLE (pad, type, data, probe_stopped, probe_handled);
 
-  /* recheck sticky events because the probe might have cause a relink */
-  if (G_UNLIKELY ((ret = check_sticky (pad, NULL))) != GST_FLOW_OK)
-    goto events_error;
+    /* recheck sticky events because the probe might have cause a relink */
+    if (G_UNLIKELY ((ret = check_sticky (pad, NULL))) != GST_FLOW_OK)
+      goto events_error;
+  }
 
   if (G_UNLIKELY ((peer = GST_PAD_PEER (pad)) == NULL))
     goto not_linked;
@@ -4468,7 +4654,12 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
   pad->priv->using++;
   GST_OBJECT_UNLOCK (pad);
 
-  ret = gst_pad_chain_data_unchecked (peer, type, data);
+#ifndef GST_ENABLE_EXTRA_CHECKS
+  /* ghost pads without probes are skipped, the extra checks of the sticky
+   * events need the chain */
+  if (!_priv_gst_proxy_pad_push_through (peer, type, data, &ret))
+#endif
+    ret = gst_pad_chain_data_unchecked (peer, type, data);
   data = NULL;
 
   gst_object_unref (peer);
@@ -4581,15 +4772,16 @@ GstFlowReturn
 gst_pad_push (GstPad * pad, GstBuffer * buffer)
 {
   GstFlowReturn res;
+  GST_TRACER_SAMPLE_DECLARE (sampled);
 
   g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
-  GST_TRACER_PAD_PUSH_PRE (pad, buffer);
+  GST_TRACER_PAD_PUSH_PRE (pad, buffer, sampled);
   res = gst_pad_push_data (pad,
       GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
-  GST_TRACER_PAD_PUSH_POST (pad, res);
+  GST_TRACER_PAD_PUSH_POST (pad, res, sampled);
   return res;
 }
 
@@ -4621,15 +4813,16 @@ GstFlowReturn
 gst_pad_push_list (GstPad * pad, GstBufferList * list)
 {
   GstFlowReturn res;
+  GST_TRACER_SAMPLE_DECLARE (sampled);
 
   g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER_LIST (list), GST_FLOW_ERROR);
 
-  GST_TRACER_PAD_PUSH_LIST_PRE (pad, list);
+  GST_TRACER_PAD_PUSH_LIST_PRE (pad, list, sampled);
   res = gst_pad_push_data (pad,
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
-  GST_TRACER_PAD_PUSH_LIST_POST (pad, res);
+  GST_TRACER_PAD_PUSH_LIST_POST (pad, res, sampled);
   return res;
 }
 
@@ -4642,7 +4835,7 @@ gst_pad_get_range_unchecked (GstPad * pad, guint64 offset, guint size,
   GstObject *parent;
   GstBuffer *res_buf;
 
-  GST_PAD_STREAM_LOCK (pad);
+  GST_PAD_STREAM_LOCK_TRACED (pad);
 
   GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
@@ -4887,6 +5080,7 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
   GstPad *peer;
   GstFlowReturn ret;
   GstBuffer *res_buf;
+  GST_TRACER_SAMPLE_DECLARE (sampled);
 
   g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_PAD_IS_SINK (pad), GST_FLOW_ERROR);
@@ -4894,7 +5088,7 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
   g_return_val_if_fail (*buffer == NULL || (GST_IS_BUFFER (*buffer)
           && gst_buffer_get_size (*buffer) >= size), GST_FLOW_ERROR);
 
-  GST_TRACER_PAD_PULL_RANGE_PRE (pad, offset, size);
+  GST_TRACER_PAD_PULL_RANGE_PRE (pad, offset, size, sampled);
 
   GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
@@ -4942,7 +5136,7 @@ probed_data:
 
   *buffer = res_buf;
 
-  GST_TRACER_PAD_PULL_RANGE_POST (pad, *buffer, ret);
+  GST_TRACER_PAD_PULL_RANGE_POST (pad, *buffer, ret, sampled);
   return ret;
 
   /* ERROR recovery here */
@@ -5020,7 +5214,7 @@ probe_stopped_unref:
     goto done;
   }
 done:
-  GST_TRACER_PAD_PULL_RANGE_POST (pad, NULL, ret);
+  GST_TRACER_PAD_PULL_RANGE_POST (pad, NULL, ret, sampled);
   return ret;
 }
 
@@ -5076,8 +5270,10 @@ store_sticky_event (GstPad * pad, GstEvent * event)
         continue;
 
       /* overwrite */
-      if ((res = gst_event_replace (&ev->event, event)))
+      if ((res = gst_event_replace (&ev->event, event))) {
         ev->received = FALSE;
+        pad->priv->pending_mask |= EVENT_TYPE_BIT (type);
+      }
 
       insert = FALSE;
       break;
@@ -5102,6 +5298,8 @@ store_sticky_event (GstPad * pad, GstEvent * event)
     ev.event = gst_event_ref (event);
     ev.received = FALSE;
     g_array_insert_val (events, i, ev);
+    pad->priv->events_mask |= EVENT_TYPE_BIT (type);
+    pad->priv->pending_mask |= EVENT_TYPE_BIT (type);
     res = TRUE;
   }
 
@@ -5253,7 +5451,10 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
 
         /* Push all sticky events before our current one
          * that have changed */
-        events_foreach (pad, sticky_changed, &data);
+        if (pad->priv->pending_mask) {
+          events_foreach (pad, sticky_changed, &data);
+          update_events_mask (pad);
+        }
       }
       break;
     }
@@ -5271,7 +5472,10 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
 
     /* Push all sticky events before our current one
      * that have changed */
-    events_foreach (pad, sticky_changed, &data);
+    if (pad->priv->pending_mask) {
+      events_foreach (pad, sticky_changed, &data);
+      update_events_mask (pad);
+    }
   }
 
   /* now check the peer pad */
@@ -5560,7 +5764,7 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
 
       GST_OBJECT_UNLOCK (pad);
       /* grab stream lock */
-      GST_PAD_STREAM_LOCK (pad);
+      GST_PAD_STREAM_LOCK_TRACED (pad);
       need_unlock = TRUE;
       GST_OBJECT_LOCK (pad);
       if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
@@ -5594,7 +5798,7 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
 
         /* lock order: STREAM_LOCK, LOCK, recheck flushing. */
         GST_OBJECT_UNLOCK (pad);
-        GST_PAD_STREAM_LOCK (pad);
+        GST_PAD_STREAM_LOCK_TRACED (pad);
         need_unlock = TRUE;
         GST_OBJECT_LOCK (pad);
         if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
@@ -6081,7 +6285,7 @@ gst_pad_pause_task (GstPad * pad)
 
   /* wait for task function to finish, this lock is recursive so it does nothing
    * when the pause is called from the task itself */
-  GST_PAD_STREAM_LOCK (pad);
+  GST_PAD_STREAM_LOCK_TRACED (pad);
   GST_PAD_STREAM_UNLOCK (pad);
 
   return res;
@@ -6164,7 +6368,7 @@ gst_pad_stop_task (GstPad * pad)
   res = gst_task_set_state (task, GST_TASK_STOPPED);
   GST_OBJECT_UNLOCK (pad);
 
-  GST_PAD_STREAM_LOCK (pad);
+  GST_PAD_STREAM_LOCK_TRACED (pad);
   GST_PAD_STREAM_UNLOCK (pad);
 
   if (!gst_task_join (task))
@@ -6179,7 +6383,7 @@ no_task:
     GST_DEBUG_OBJECT (pad, "no task");
     GST_OBJECT_UNLOCK (pad);
 
-    GST_PAD_STREAM_LOCK (pad);
+    GST_PAD_STREAM_LOCK_TRACED (pad);
     GST_PAD_STREAM_UNLOCK (pad);
 
     /* this is not an error */
@@ -33,22 +33,45 @@
  * Please note that these functions take several measures to create
  * somewhat dynamic pipelines. Due to that such pipelines are not always
  * reusable (set the state to NULL and back to PLAYING).
+ *
+ * When the same description is used to create many pipelines, a
+ * #GstParseTemplate can be created once with gst_parse_template_new() and
+ * instantiated with gst_parse_template_instantiate(). The template resolves
+ * the element factories of the description once, so instantiating it does
+ * not look up the factories in the registry again.
  */
 
 #include "gst_private.h"
 #include <string.h>
 
 #include "gstparse.h"
+#include "gst-i18n-lib.h"
+#include "gstchildproxy.h"
 #include "gsterror.h"
 #include "gstinfo.h"
+#include "gstvalue.h"
 #ifndef GST_DISABLE_PARSE
 #include "parse/types.h"
 #endif
 
+struct _GstParseTemplate
+{
+  gint refcount;
+
+  gchar *description;
+  GstParseFlags flags;
+  /* factory name -> GstElementFactory, read-only after creation */
+  GHashTable *factories;
+};
+
 G_DEFINE_BOXED_TYPE (GstParseContext, gst_parse_context,
     (GBoxedCopyFunc) gst_parse_context_copy,
     (GBoxedFreeFunc) gst_parse_context_free);
 
+G_DEFINE_BOXED_TYPE (GstParseTemplate, gst_parse_template,
+    (GBoxedCopyFunc) gst_parse_template_ref,
+    (GBoxedFreeFunc) gst_parse_template_unref);
+
 /**
  * gst_parse_error_quark:
  *
@@ -334,7 +357,7 @@ gst_parse_launch_full (const gchar * pipeline_description,
       pipeline_description);
 
   element = priv_gst_parse_launch (pipeline_description, &myerror, context,
-      flags);
+      flags, NULL, FALSE);
 
   /* don't return partially constructed pipeline if FATAL_ERRORS was given */
   if (G_UNLIKELY (myerror != NULL && element != NULL)) {
@@ -360,3 +383,273 @@ gst_parse_launch_full (const gchar * pipeline_description,
   return NULL;
 #endif
 }
+
+/**
+ * gst_parse_template_new:
+ * @pipeline_description: the command line describing the pipeline
+ * @flags: parsing options, or #GST_PARSE_FLAG_NONE
+ * @error: the error message in case of an erroneous pipeline.
+ *
+ * Create a template for the pipelines described by @pipeline_description.
+ * The description is parsed and instantiated once to check it and to
+ * resolve its element factories. Unlike gst_parse_launch_full(), any error
+ * is fatal.
+ *
+ * Free-function: gst_parse_template_unref
+ *
+ * Returns: (transfer full) (nullable): a new #GstParseTemplate or %NULL on
+ *     failure.
+ *
+ * Since: 1.14
+ */
+GstParseTemplate *
+gst_parse_template_new (const gchar * pipeline_description,
+    GstParseFlags flags, GError ** error)
+{
+#ifndef GST_DISABLE_PARSE
+  GstParseTemplate *tmpl;
+  GstElement *element;
+  GError *myerror = NULL;
+
+  g_return_val_if_fail (pipeline_description != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  GST_CAT_INFO (GST_CAT_PIPELINE, "creating template for '%s'",
+      pipeline_description);
+
+  tmpl = g_slice_new (GstParseTemplate);
+  tmpl->refcount = 1;
+  tmpl->description = g_strdup (pipeline_description);
+  tmpl->flags = flags;
+  tmpl->factories = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      gst_object_unref);
+
+  element = priv_gst_parse_launch (pipeline_description, &myerror, NULL,
+      flags, tmpl->factories, FALSE);
+  if (element)
+    gst_object_unref (element);
+
+  if (G_UNLIKELY (myerror != NULL || element == NULL)) {
+    gst_parse_template_unref (tmpl);
+    if (myerror)
+      g_propagate_error (error, myerror);
+    return NULL;
+  }
+
+  return tmpl;
+#else
+  gchar *msg;
+
+  GST_WARNING ("Disabled API called");
+
+  msg = gst_error_get_message (GST_CORE_ERROR, GST_CORE_ERROR_DISABLED);
+  g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_DISABLED, "%s", msg);
+  g_free (msg);
+
+  return NULL;
+#endif
+}
+
+/**
+ * gst_parse_template_ref:
+ * @tmpl: a #GstParseTemplate
+ *
+ * Increase the refcount of @tmpl.
+ *
+ * Returns: (transfer full): @tmpl
+ *
+ * Since: 1.14
+ */
+GstParseTemplate *
+gst_parse_template_ref (GstParseTemplate * tmpl)
+{
+  g_return_val_if_fail (tmpl != NULL, NULL);
+
+  g_atomic_int_inc (&tmpl->refcount);
+
+  return tmpl;
+}
+
+/**
+ * gst_parse_template_unref:
+ * @tmpl: (transfer full): a #GstParseTemplate
+ *
+ * Decrease the refcount of @tmpl and free it when the refcount reaches 0.
+ *
+ * Since: 1.14
+ */
+void
+gst_parse_template_unref (GstParseTemplate * tmpl)
+{
+  g_return_if_fail (tmpl != NULL);
+
+  if (g_atomic_int_dec_and_test (&tmpl->refcount)) {
+    g_hash_table_unref (tmpl->factories);
+    g_free (tmpl->description);
+    g_slice_free (GstParseTemplate, tmpl);
+  }
+}
+
+/**
+ * gst_parse_template_get_description:
+ * @tmpl: a #GstParseTemplate
+ *
+ * Returns: the pipeline description of @tmpl.
+ *
+ * Since: 1.14
+ */
+const gchar *
+gst_parse_template_get_description (GstParseTemplate * tmpl)
+{
+  g_return_val_if_fail (tmpl != NULL, NULL);
+
+  return tmpl->description;
+}
+
+#ifndef GST_DISABLE_PARSE
+typedef struct
+{
+  GstElement *element;
+  GError **error;
+} OverrideData;
+
+static gboolean
+set_override (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  OverrideData *data = user_data;
+  const gchar *name = g_quark_to_string (field_id);
+  GObject *target = NULL;
+  GParamSpec *pspec = NULL;
+  GValue v = G_VALUE_INIT;
+
+  if (GST_IS_CHILD_PROXY (data->element)) {
+    if (!gst_child_proxy_lookup (GST_CHILD_PROXY (data->element), name,
+            &target, &pspec))
+      goto no_property;
+  } else {
+    const gchar *ename = GST_ELEMENT_NAME (data->element);
+    gsize len = strlen (ename);
+
+    /* a single element can be addressed with or without its name */
+    if (strncmp (name, ename, len) == 0 && strncmp (name + len, "::", 2) == 0)
+      name += len + 2;
+    if (!(pspec = g_object_class_find_property (G_OBJECT_GET_CLASS
+                (data->element), name)))
+      goto no_property;
+    target = g_object_ref (data->element);
+  }
+
+  if (!(pspec->flags & G_PARAM_WRITABLE))
+    goto wrong_value;
+
+  g_value_init (&v, G_PARAM_SPEC_VALUE_TYPE (pspec));
+  if (G_VALUE_TYPE (value) == G_VALUE_TYPE (&v)) {
+    g_value_copy (value, &v);
+  } else if (G_VALUE_HOLDS_STRING (value)) {
+    if (!gst_value_deserialize (&v, g_value_get_string (value)))
+      goto wrong_value;
+  } else if (!g_value_transform (value, &v)) {
+    goto wrong_value;
+  }
+
+  g_object_set_property (target, pspec->name, &v);
+  g_value_unset (&v);
+  g_object_unref (target);
+
+  return TRUE;
+
+  /* ERRORS */
+no_property:
+  {
+    g_set_error (data->error, GST_PARSE_ERROR, GST_PARSE_ERROR_NO_SUCH_PROPERTY,
+        _("no property \"%s\" in element \"%s\""), g_quark_to_string (field_id),
+        GST_ELEMENT_NAME (data->element));
+    return FALSE;
+  }
+wrong_value:
+  {
+    gchar *str = gst_value_serialize (value);
+
+    g_set_error (data->error, GST_PARSE_ERROR,
+        GST_PARSE_ERROR_COULD_NOT_SET_PROPERTY,
+        _("could not set property \"%s\" in element \"%s\" to \"%s\""),
+        g_quark_to_string (field_id), GST_ELEMENT_NAME (data->element),
+        GST_STR_NULL (str));
+    g_free (str);
+    if (G_IS_VALUE (&v))
+      g_value_unset (&v);
+    g_object_unref (target);
+    return FALSE;
+  }
+}
+#endif
+
+/**
+ * gst_parse_template_instantiate:
+ * @tmpl: a #GstParseTemplate
+ * @overrides: (allow-none): property values to set, or %NULL
+ * @error: the error message in case of an erroneous pipeline.
+ *
+ * Create a new pipeline from @tmpl, like gst_parse_launch_full() with the
+ * description and flags of @tmpl would do, but with the element factories
+ * that were resolved when @tmpl was created.
+ *
+ * Each field of @overrides sets a property after the pipeline is created.
+ * The field names use the syntax of gst_child_proxy_set_property(), like
+ * "sink::sync" for the sync property of the element named sink. Values that
+ * are strings are deserialized to the type of the property.
+ *
+ * This function can be called from multiple threads at the same time.
+ *
+ * Returns: (transfer floating) (nullable): a new element on success, %NULL
+ *     on failure.
+ *
+ * Since: 1.14
+ */
+GstElement *
+gst_parse_template_instantiate (GstParseTemplate * tmpl,
+    const GstStructure * overrides, GError ** error)
+{
+#ifndef GST_DISABLE_PARSE
+  GstElement *element;
+  GError *myerror = NULL;
+
+  g_return_val_if_fail (tmpl != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  element = priv_gst_parse_launch (tmpl->description, &myerror, NULL,
+      tmpl->flags, tmpl->factories, TRUE);
+
+  if (G_UNLIKELY (myerror != NULL))
+    goto error;
+
+  if (overrides) {
+    OverrideData data;
+
+    data.element = element;
+    data.error = &myerror;
+    if (!gst_structure_foreach (overrides, set_override, &data))
+      goto error;
+  }
+
+  return element;
+
+error:
+  {
+    if (element)
+      gst_object_unref (element);
+    g_propagate_error (error, myerror);
+    return NULL;
+  }
+#else
+  gchar *msg;
+
+  GST_WARNING ("Disabled API called");
+
+  msg = gst_error_get_message (GST_CORE_ERROR, GST_CORE_ERROR_DISABLED);
+  g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_DISABLED, "%s", msg);
+  g_free (msg);
+
+  return NULL;
+#endif
+}
@@ -111,6 +111,40 @@ void              gst_parse_context_free (GstParseContext * context);
 GST_EXPORT
 GstParseContext * gst_parse_context_copy (const GstParseContext * context);
 
+#define GST_TYPE_PARSE_TEMPLATE (gst_parse_template_get_type())
+
+/**
+ * GstParseTemplate:
+ *
+ * Opaque structure.
+ *
+ * Since: 1.14
+ */
+typedef struct _GstParseTemplate GstParseTemplate;
+
+/* parse a description once and instantiate it many times */
+
+GST_EXPORT
+GType              gst_parse_template_get_type (void);
+
+GST_EXPORT
+GstParseTemplate * gst_parse_template_new (const gchar   * pipeline_description,
+                                           GstParseFlags   flags,
+                                           GError       ** error) G_GNUC_MALLOC;
+GST_EXPORT
+GstParseTemplate * gst_parse_template_ref (GstParseTemplate * tmpl);
+
+GST_EXPORT
+void               gst_parse_template_unref (GstParseTemplate * tmpl);
+
+GST_EXPORT
+const gchar      * gst_parse_template_get_description (GstParseTemplate * tmpl);
+
+GST_EXPORT
+GstElement       * gst_parse_template_instantiate (GstParseTemplate   * tmpl,
+                                                   const GstStructure * overrides,
+                                                   GError            ** error) G_GNUC_MALLOC;
+
 
 /* parse functions */
 
@@ -133,6 +167,7 @@ GstElement      * gst_parse_launchv_full (const gchar     ** argv,
 
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstParseContext, gst_parse_context_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstParseTemplate, gst_parse_template_unref)
 #endif
 
 G_END_DECLS
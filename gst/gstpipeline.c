@@ -102,7 +102,8 @@ enum
   PROP_0,
   PROP_DELAY,
   PROP_AUTO_FLUSH_BUS,
-  PROP_LATENCY
+  PROP_LATENCY,
+  PROP_THREAD_POLICY
 };
 
 #define GST_PIPELINE_GET_PRIVATE(obj)  \
@@ -119,6 +120,8 @@ struct _GstPipelinePrivate
   gboolean update_clock;
 
   GstClockTime latency;
+
+  GstThreadPolicy *thread_policy;
 };
 
 
@@ -196,6 +199,19 @@ gst_pipeline_class_init (GstPipelineClass * klass)
           "Latency to configure on the pipeline", 0, G_MAXUINT64,
           DEFAULT_LATENCY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPipeline:thread-policy:
+   *
+   * The #GstThreadPolicy applied to the streaming threads of the pipeline.
+   * See gst_pipeline_set_thread_policy().
+   *
+   * Since: 1.14
+   **/
+  g_object_class_install_property (gobject_class, PROP_THREAD_POLICY,
+      g_param_spec_object ("thread-policy", "Thread Policy",
+          "The policy applied to the streaming threads of the pipeline",
+          GST_TYPE_THREAD_POLICY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->dispose = gst_pipeline_dispose;
 
   gst_element_class_set_static_metadata (gstelement_class, "Pipeline object",
@@ -248,6 +264,7 @@ gst_pipeline_dispose (GObject * object)
 
   /* clear and unref any fixed clock */
   gst_object_replace ((GstObject **) clock_p, NULL);
+  gst_object_replace ((GstObject **) & pipeline->priv->thread_policy, NULL);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
@@ -268,6 +285,9 @@ gst_pipeline_set_property (GObject * object, guint prop_id,
     case PROP_LATENCY:
       gst_pipeline_set_latency (pipeline, g_value_get_uint64 (value));
       break;
+    case PROP_THREAD_POLICY:
+      gst_pipeline_set_thread_policy (pipeline, g_value_get_object (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -290,6 +310,9 @@ gst_pipeline_get_property (GObject * object, guint prop_id,
     case PROP_LATENCY:
       g_value_set_uint64 (value, gst_pipeline_get_latency (pipeline));
       break;
+    case PROP_THREAD_POLICY:
+      g_value_take_object (value, gst_pipeline_get_thread_policy (pipeline));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -573,6 +596,90 @@ invalid_clock:
   }
 }
 
+/* find the policy for the tasks of @owner: the override of the nearest
+ * element between @owner and the pipeline or the policy of the pipeline */
+static GstThreadPolicy *
+gst_pipeline_find_thread_policy (GstPipeline * pipeline, GstElement * owner)
+{
+  GstThreadPolicy *policy, *result = NULL;
+  GstObject *object, *parent;
+
+  GST_OBJECT_LOCK (pipeline);
+  if ((policy = pipeline->priv->thread_policy))
+    gst_object_ref (policy);
+  GST_OBJECT_UNLOCK (pipeline);
+
+  if (policy == NULL)
+    return NULL;
+
+  object = owner ? gst_object_ref (owner) : NULL;
+  while (object && object != GST_OBJECT_CAST (pipeline)) {
+    gchar *name = gst_object_get_name (object);
+
+    result = gst_thread_policy_get_element_policy (policy, name);
+    g_free (name);
+    if (result)
+      break;
+
+    parent = gst_object_get_parent (object);
+    gst_object_unref (object);
+    object = parent;
+  }
+  if (object)
+    gst_object_unref (object);
+
+  if (result) {
+    gst_object_unref (policy);
+    return result;
+  }
+  return policy;
+}
+
+/* configure the task of a stream-status CREATE message with the thread
+ * policy, the task applies the CPU set and priority from its own thread */
+static void
+gst_pipeline_apply_thread_policy (GstPipeline * pipeline, GstMessage * message)
+{
+  GstStreamStatusType type;
+  GstElement *owner;
+  GstThreadPolicy *policy;
+  GstTaskPool *pool;
+  const GValue *val;
+  GstTask *task;
+  guint *cpus, n_cpus;
+  gint priority;
+
+  gst_message_parse_stream_status (message, &type, &owner);
+  if (type != GST_STREAM_STATUS_TYPE_CREATE)
+    return;
+
+  val = gst_message_get_stream_status_object (message);
+  if (!val || !G_VALUE_HOLDS (val, GST_TYPE_TASK)
+      || !(task = g_value_get_object (val)))
+    return;
+
+  if (!(policy = gst_pipeline_find_thread_policy (pipeline, owner)))
+    return;
+
+  GST_DEBUG_OBJECT (pipeline, "applying %" GST_PTR_FORMAT " to task %"
+      GST_PTR_FORMAT " of %" GST_PTR_FORMAT, policy, task, owner);
+
+  if ((pool = gst_thread_policy_get_task_pool (policy))) {
+    gst_task_set_pool (task, pool);
+    gst_object_unref (pool);
+  }
+
+  if ((cpus = gst_thread_policy_get_cpus (policy, &n_cpus))) {
+    gst_task_set_cpus (task, cpus, n_cpus);
+    g_free (cpus);
+  }
+
+  if ((priority = gst_thread_policy_get_priority (policy)) > 0)
+    gst_task_set_scheduling (task, GST_TASK_SCHEDULING_FIFO, priority);
+
+  gst_object_unref (policy);
+}
+
 /* intercept the bus messages from our children. We watch for the ASYNC_START
  * message with is posted by the elements (sinks) that require a reset of the
  * running_time after a flush. ASYNC_START also brings the pipeline back into
@@ -596,6 +703,9 @@ gst_pipeline_handle_message (GstBin * bin, GstMessage * message)
       reset_start_time (pipeline, running_time);
       break;
     }
+    case GST_MESSAGE_STREAM_STATUS:
+      gst_pipeline_apply_thread_policy (pipeline, message);
+      break;
     case GST_MESSAGE_CLOCK_LOST:
     {
       GstClock *clock;
@@ -1030,3 +1140,58 @@ gst_pipeline_get_latency (GstPipeline * pipeline)
 
   return latency;
 }
+
+/**
+ * gst_pipeline_set_thread_policy:
+ * @pipeline: a #GstPipeline
+ * @policy: (transfer none) (allow-none): a #GstThreadPolicy
+ *
+ * Set the policy for the streaming threads of the pipeline. The pool, CPU
+ * set and priority of @policy are configured on the tasks that are created
+ * after this call, so the policy should be set before the pipeline goes to
+ * the PAUSED state.
+ *
+ * The policy is applied before the stream-status messages reach the bus of
+ * the pipeline, so a sync handler on the bus can still change the
+ * configuration of a task.
+ *
+ * Since: 1.14
+ */
+void
+gst_pipeline_set_thread_policy (GstPipeline * pipeline,
+    GstThreadPolicy * policy)
+{
+  g_return_if_fail (GST_IS_PIPELINE (pipeline));
+  g_return_if_fail (policy == NULL || GST_IS_THREAD_POLICY (policy));
+
+  GST_OBJECT_LOCK (pipeline);
+  gst_object_replace ((GstObject **) & pipeline->priv->thread_policy,
+      (GstObject *) policy);
+  GST_OBJECT_UNLOCK (pipeline);
+}
+
+/**
+ * gst_pipeline_get_thread_policy:
+ * @pipeline: a #GstPipeline
+ *
+ * Get the policy for the streaming threads of the pipeline.
+ *
+ * Returns: (transfer full) (nullable): the #GstThreadPolicy of @pipeline.
+ * Unref after usage.
+ *
+ * Since: 1.14
+ */
+GstThreadPolicy *
+gst_pipeline_get_thread_policy (GstPipeline * pipeline)
+{
+  GstThreadPolicy *policy;
+
+  g_return_val_if_fail (GST_IS_PIPELINE (pipeline), NULL);
+
+  GST_OBJECT_LOCK (pipeline);
+  if ((policy = pipeline->priv->thread_policy))
+    gst_object_ref (policy);
+  GST_OBJECT_UNLOCK (pipeline);
+
+  return policy;
+}
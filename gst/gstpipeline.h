@@ -25,6 +25,7 @@
 #define __GST_PIPELINE_H__
 
 #include <gst/gstbin.h>
+#include <gst/gstthreadpolicy.h>
 
 G_BEGIN_DECLS
 
@@ -130,6 +131,12 @@ void            gst_pipeline_set_auto_flush_bus (GstPipeline *pipeline, gboolean
 GST_EXPORT
 gboolean        gst_pipeline_get_auto_flush_bus (GstPipeline *pipeline);
 
+GST_EXPORT
+void            gst_pipeline_set_thread_policy  (GstPipeline *pipeline, GstThreadPolicy *policy);
+
+GST_EXPORT
+GstThreadPolicy * gst_pipeline_get_thread_policy (GstPipeline *pipeline);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstPipeline, gst_object_unref)
 #endif
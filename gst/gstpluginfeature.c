@@ -45,6 +45,9 @@ static void gst_plugin_feature_finalize (GObject * object);
 
 /* static guint gst_plugin_feature_signals[LAST_SIGNAL] = { 0 }; */
 
+/* incremented whenever a rank changes */
+static gint rank_cookie = 0;
+
 G_DEFINE_ABSTRACT_TYPE (GstPluginFeature, gst_plugin_feature, GST_TYPE_OBJECT);
 
 static void
@@ -163,6 +166,15 @@ gst_plugin_feature_set_rank (GstPluginFeature * feature, guint rank)
   g_return_if_fail (GST_IS_PLUGIN_FEATURE (feature));
 
   feature->rank = rank;
+
+  /* the registry views are sorted by rank */
+  g_atomic_int_inc (&rank_cookie);
+}
+
+guint
+_priv_gst_plugin_feature_get_rank_cookie (void)
+{
+  return g_atomic_int_get (&rank_cookie);
 }
 
 /**
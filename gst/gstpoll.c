@@ -51,6 +51,10 @@
  * descriptor, and gst_poll_fd_can_write() to see if it is possible to
  * write to it.
  *
+ * On Linux, sets with many file descriptors are automatically waited on
+ * with epoll, so that the cost of a wait does not depend on the number of
+ * file descriptors in the set anymore.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -83,6 +87,10 @@
 #endif
 #include <sys/time.h>
 #include <sys/socket.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#define HAVE_EPOLL 1
+#endif
 #endif
 
 #ifdef G_OS_WIN32
@@ -124,9 +132,15 @@ typedef enum
   GST_POLL_MODE_PSELECT,
   GST_POLL_MODE_POLL,
   GST_POLL_MODE_PPOLL,
+  GST_POLL_MODE_EPOLL,
   GST_POLL_MODE_WINDOWS
 } GstPollMode;
 
+#ifdef HAVE_EPOLL
+/* switch non-timer sets with at least this many fds to epoll */
+#define EPOLL_MIN_FDS 32
+#endif
+
 struct _GstPoll
 {
   GstPollMode mode;
@@ -150,6 +164,17 @@ struct _GstPoll
   HANDLE wakeup_event;
 #endif
 
+#ifdef HAVE_EPOLL
+  /* epoll instance with all fds registered, -1 when not used */
+  gint epoll_fd;
+  gboolean epoll_failed;
+  /* fd -> index + 1 in fds */
+  GHashTable *epoll_index;
+  /* indices in active_fds with revents set by the last wait */
+  GArray *epoll_ready;
+  GArray *epoll_events;
+#endif
+
   gboolean controllable;
   volatile gint waiting;
   volatile gint control_pending;
@@ -275,16 +300,12 @@ release_event (GstPoll * set)
 
 #endif
 
-/* the poll/select call is also performed on a control socket, that way
- * we can send special commands to control it */
+/* must be called with the lock */
 static inline gboolean
-raise_wakeup (GstPoll * set)
+raise_wakeup_unlocked (GstPoll * set)
 {
   gboolean result = TRUE;
 
-  /* makes testing control_pending and WAKE_EVENT() atomic. */
-  g_mutex_lock (&set->lock);
-
   if (set->control_pending == 0) {
     /* raise when nothing pending */
     GST_LOG ("%p: raise", set);
@@ -295,6 +316,19 @@ raise_wakeup (GstPoll * set)
     set->control_pending++;
   }
 
+  return result;
+}
+
+/* the poll/select call is also performed on a control socket, that way
+ * we can send special commands to control it */
+static inline gboolean
+raise_wakeup (GstPoll * set)
+{
+  gboolean result;
+
+  /* makes testing control_pending and WAKE_EVENT() atomic. */
+  g_mutex_lock (&set->lock);
+  result = raise_wakeup_unlocked (set);
   g_mutex_unlock (&set->lock);
 
   return result;
@@ -392,6 +426,191 @@ find_index (GArray * array, GstPollFD * fd)
   return fd->idx;
 }
 
+#ifdef HAVE_EPOLL
+static guint32
+pollfd_to_epoll_events (gshort events)
+{
+  guint32 res = 0;
+
+  if (events & POLLIN)
+    res |= EPOLLIN;
+  if (events & POLLPRI)
+    res |= EPOLLPRI;
+  if (events & POLLOUT)
+    res |= EPOLLOUT;
+
+  /* EPOLLERR and EPOLLHUP are always reported, like with poll() */
+  return res;
+}
+
+static gshort
+epoll_events_to_pollfd (guint32 events)
+{
+  gshort res = 0;
+
+  if (events & EPOLLIN)
+    res |= POLLIN;
+  if (events & EPOLLPRI)
+    res |= POLLPRI;
+  if (events & EPOLLOUT)
+    res |= POLLOUT;
+  if (events & EPOLLERR)
+    res |= POLLERR;
+  if (events & EPOLLHUP)
+    res |= POLLHUP;
+
+  return res;
+}
+
+/* must be called with the lock from the waiting thread or when freeing the
+ * set, other threads could still be in epoll_wait() on the fd otherwise */
+static void
+epoll_disable (GstPoll * set)
+{
+  if (set->epoll_fd < 0)
+    return;
+
+  GST_DEBUG ("%p: not using epoll anymore", set);
+
+  close (set->epoll_fd);
+  set->epoll_fd = -1;
+  g_hash_table_destroy (set->epoll_index);
+  set->epoll_index = NULL;
+  g_array_set_size (set->epoll_ready, 0);
+}
+
+/* must be called with the lock, @op is one of EPOLL_CTL_ADD, EPOLL_CTL_MOD or
+ * EPOLL_CTL_DEL. Falls back to poll() for the whole set when the fd can't be
+ * handled by epoll, as is the case for regular files. The epoll fd is only
+ * marked as failed here, the waiting thread closes it. */
+static void
+epoll_update (GstPoll * set, gint idx, gint op)
+{
+  struct pollfd *pfd = &g_array_index (set->fds, struct pollfd, idx);
+  struct epoll_event ev;
+
+  if (set->epoll_fd < 0 || set->epoll_failed)
+    return;
+
+  ev.events = pollfd_to_epoll_events (pfd->events);
+  ev.data.fd = pfd->fd;
+
+  if (op == EPOLL_CTL_ADD)
+    g_hash_table_insert (set->epoll_index, GINT_TO_POINTER (pfd->fd),
+        GINT_TO_POINTER (idx + 1));
+
+  if (epoll_ctl (set->epoll_fd, op, pfd->fd, &ev) < 0) {
+    GST_WARNING ("%p: epoll_ctl %d failed for fd %d: %s", set, op, pfd->fd,
+        g_strerror (errno));
+    set->epoll_failed = TRUE;
+    MARK_REBUILD (set);
+    /* make a waiter switch to poll() */
+    if (set->controllable && GET_WAITING (set) > 0)
+      raise_wakeup_unlocked (set);
+  }
+}
+
+/* must be called with the lock, the fd at @idx is going to be removed with
+ * g_array_remove_index_fast() */
+static void
+epoll_remove (GstPoll * set, gint idx)
+{
+  struct pollfd *pfd;
+  guint last;
+
+  if (set->epoll_fd < 0 || set->epoll_failed)
+    return;
+
+  pfd = &g_array_index (set->fds, struct pollfd, idx);
+  /* the fd might be closed already, then it's removed automatically */
+  epoll_ctl (set->epoll_fd, EPOLL_CTL_DEL, pfd->fd, NULL);
+  g_hash_table_remove (set->epoll_index, GINT_TO_POINTER (pfd->fd));
+
+  /* the last fd moves to the removed index */
+  last = set->fds->len - 1;
+  if ((guint) idx != last) {
+    pfd = &g_array_index (set->fds, struct pollfd, last);
+    g_hash_table_insert (set->epoll_index, GINT_TO_POINTER (pfd->fd),
+        GINT_TO_POINTER (idx + 1));
+  }
+}
+
+/* must be called with the lock from the waiting thread, registers all fds
+ * with a new epoll instance when the set became big enough */
+static void
+epoll_check_enable (GstPoll * set)
+{
+  guint i;
+
+  if (set->epoll_fd >= 0 || set->epoll_failed || set->timer
+      || set->mode != GST_POLL_MODE_AUTO || set->fds->len < EPOLL_MIN_FDS)
+    return;
+
+  set->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+  if (set->epoll_fd < 0) {
+    GST_WARNING ("%p: can't create epoll instance: %s", set,
+        g_strerror (errno));
+    set->epoll_failed = TRUE;
+    return;
+  }
+
+  GST_DEBUG ("%p: using epoll for %u fds", set, set->fds->len);
+
+  set->epoll_index = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < set->fds->len && !set->epoll_failed; i++)
+    epoll_update (set, i, EPOLL_CTL_ADD);
+
+  /* nobody else can be waiting on the new fd yet */
+  if (set->epoll_failed)
+    epoll_disable (set);
+}
+
+/* must be called with the lock from the waiting thread */
+static void
+epoll_collect (GstPoll * set, gint n_events)
+{
+  guint i;
+
+  for (i = 0; i < n_events; i++) {
+    struct epoll_event *ev =
+        &g_array_index (set->epoll_events, struct epoll_event, i);
+    GstPollFD tmp;
+    gint idx;
+
+    tmp.fd = ev->data.fd;
+    tmp.idx = GPOINTER_TO_INT (g_hash_table_lookup (set->epoll_index,
+            GINT_TO_POINTER (tmp.fd))) - 1;
+
+    /* validates the index, active_fds only differs from fds when fds were
+     * changed while we were waiting */
+    idx = find_index (set->active_fds, &tmp);
+    if (idx >= 0) {
+      struct pollfd *pfd =
+          &g_array_index (set->active_fds, struct pollfd, idx);
+
+      pfd->revents = epoll_events_to_pollfd (ev->events);
+      g_array_append_val (set->epoll_ready, idx);
+    }
+  }
+}
+
+/* must be called with the lock from the waiting thread, clears the revents
+ * of the previous wait */
+static void
+epoll_clear_ready (GstPoll * set)
+{
+  guint i;
+
+  for (i = 0; i < set->epoll_ready->len; i++) {
+    gint idx = g_array_index (set->epoll_ready, gint, i);
+
+    if (idx < set->active_fds->len)
+      g_array_index (set->active_fds, struct pollfd, idx).revents = 0;
+  }
+  g_array_set_size (set->epoll_ready, 0);
+}
+#endif
+
 #if !defined(HAVE_PPOLL) && defined(HAVE_POLL)
 /* check if all file descriptors will fit in an fd_set */
 static gboolean
@@ -440,6 +659,10 @@ choose_mode (GstPoll * set, GstClockTime timeout)
   GstPollMode mode;
 
   if (set->mode == GST_POLL_MODE_AUTO) {
+#ifdef HAVE_EPOLL
+    if (set->epoll_fd >= 0)
+      return GST_POLL_MODE_EPOLL;
+#endif
 #ifdef HAVE_PPOLL
     mode = GST_POLL_MODE_PPOLL;
 #elif defined(HAVE_POLL)
@@ -686,6 +909,11 @@ gst_poll_new (gboolean controllable)
   nset->active_fds = g_array_new (FALSE, FALSE, sizeof (struct pollfd));
   nset->control_read_fd.fd = -1;
   nset->control_write_fd.fd = -1;
+#ifdef HAVE_EPOLL
+  nset->epoll_fd = -1;
+  nset->epoll_ready = g_array_new (FALSE, FALSE, sizeof (gint));
+  nset->epoll_events = g_array_new (FALSE, FALSE, sizeof (struct epoll_event));
+#endif
   {
     gint control_sock[2];
 
@@ -772,6 +1000,11 @@ gst_poll_free (GstPoll * set)
   GST_DEBUG ("%p: freeing", set);
 
 #ifndef G_OS_WIN32
+#ifdef HAVE_EPOLL
+  epoll_disable (set);
+  g_array_free (set->epoll_ready, TRUE);
+  g_array_free (set->epoll_events, TRUE);
+#endif
   if (set->control_write_fd.fd >= 0)
     close (set->control_write_fd.fd);
   if (set->control_read_fd.fd >= 0)
@@ -859,6 +1092,9 @@ gst_poll_add_fd_unlocked (GstPoll * set, GstPollFD * fd)
     g_array_append_val (set->fds, nfd);
 
     fd->idx = set->fds->len - 1;
+#ifdef HAVE_EPOLL
+    epoll_update (set, fd->idx, EPOLL_CTL_ADD);
+#endif
 #else
     WinsockFd wfd;
     HANDLE event;
@@ -938,6 +1174,8 @@ gst_poll_remove_fd (GstPoll * set, GstPollFD * fd)
 #ifdef G_OS_WIN32
     gst_poll_free_winsock_event (set, idx);
     g_array_remove_index_fast (set->events, idx);
+#elif defined (HAVE_EPOLL)
+    epoll_remove (set, idx);
 #endif
 
     /* remove the fd at index, we use _remove_index_fast, which copies the last
@@ -992,6 +1230,9 @@ gst_poll_fd_ctl_write (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events &= ~POLLOUT;
 
     GST_LOG ("%p: pfd->events now %d (POLLOUT:%d)", set, pfd->events, POLLOUT);
+#ifdef HAVE_EPOLL
+    epoll_update (set, idx, EPOLL_CTL_MOD);
+#endif
 #else
     gst_poll_update_winsock_event_mask (set, idx, FD_WRITE | FD_CONNECT,
         active);
@@ -1024,6 +1265,9 @@ gst_poll_fd_ctl_read_unlocked (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events |= (POLLIN | POLLPRI);
     else
       pfd->events &= ~(POLLIN | POLLPRI);
+#ifdef HAVE_EPOLL
+    epoll_update (set, idx, EPOLL_CTL_MOD);
+#endif
 #else
     gst_poll_update_winsock_event_mask (set, idx, FD_READ | FD_ACCEPT, active);
 #endif
@@ -1335,11 +1579,17 @@ gst_poll_wait (GstPoll * set, GstClockTime timeout)
     res = -1;
     restarting = FALSE;
 
-    mode = choose_mode (set, timeout);
-
     if (TEST_REBUILD (set)) {
       g_mutex_lock (&set->lock);
 #ifndef G_OS_WIN32
+#ifdef HAVE_EPOLL
+      /* closed here because we are the only thread that waits on it */
+      if (set->epoll_failed)
+        epoll_disable (set);
+      epoll_check_enable (set);
+      g_array_set_size (set->epoll_ready, 0);
+      g_array_set_size (set->epoll_events, MAX (set->fds->len, 1));
+#endif
       g_array_set_size (set->active_fds, set->fds->len);
       memcpy (set->active_fds->data, set->fds->data,
           set->fds->len * sizeof (struct pollfd));
@@ -1350,6 +1600,8 @@ gst_poll_wait (GstPoll * set, GstClockTime timeout)
       g_mutex_unlock (&set->lock);
     }
 
+    mode = choose_mode (set, timeout);
+
     switch (mode) {
       case GST_POLL_MODE_AUTO:
         g_assert_not_reached ();
@@ -1373,6 +1625,45 @@ gst_poll_wait (GstPoll * set, GstClockTime timeout)
 #else
         g_assert_not_reached ();
         errno = ENOSYS;
+#endif
+        break;
+      }
+      case GST_POLL_MODE_EPOLL:
+      {
+#ifdef HAVE_EPOLL
+        gint t, epfd;
+
+        if (timeout != GST_CLOCK_TIME_NONE) {
+          /* round up, we don't want to wake up too early */
+          t = MIN (GST_TIME_AS_MSECONDS (timeout + GST_MSECOND - 1), G_MAXINT);
+        } else {
+          t = -1;
+        }
+
+        g_mutex_lock (&set->lock);
+        epoll_clear_ready (set);
+        epfd = set->epoll_failed ? -1 : set->epoll_fd;
+        g_mutex_unlock (&set->lock);
+
+        if (G_UNLIKELY (epfd < 0)) {
+          /* we fell back to poll() after an epoll error, try again */
+          res = 0;
+          restarting = TRUE;
+          break;
+        }
+
+        res = epoll_wait (epfd,
+            (struct epoll_event *) set->epoll_events->data,
+            set->epoll_events->len, t);
+
+        if (res > 0) {
+          g_mutex_lock (&set->lock);
+          epoll_collect (set, res);
+          g_mutex_unlock (&set->lock);
+        }
+#else
+        g_assert_not_reached ();
+        errno = ENOSYS;
 #endif
         break;
       }
@@ -46,6 +46,10 @@
  * later entries will be updated. Since 1.8 you can also provide extra paths
  * where to find presets through the GST_PRESET_PATH environment variable.
  * Presets found in those paths will be concidered as "app presets".
+ *
+ * The default implementation parses the preset files once per type. The
+ * property values of a loaded preset are remembered, so that loading the same
+ * preset into more instances of the type doesn't parse the values again.
  */
 /* FIXME:
  * - non racyness
@@ -105,6 +109,21 @@ static GQuark preset_user_path_quark = 0;
 static GQuark preset_app_path_quark = 0;
 static GQuark preset_system_path_quark = 0;
 static GQuark preset_quark = 0;
+static GQuark preset_values_quark = 0;
+static GQuark preset_saved_quark = 0;
+
+/* protects the creation of the presets of a type and the cached preset
+ * values */
+static GMutex preset_lock;
+/* increased whenever any presets are modified */
+static guint preset_generation = 0;
+
+/* a deserialized property value of a preset */
+typedef struct
+{
+  GParamSpec *property;
+  GValue value;
+} PresetValue;
 
 /* the application can set a custom path that is checked in addition to standard
  * system and user dirs. This helps to develop new presets first local to the
@@ -249,15 +268,23 @@ preset_open_and_parse_header (GstPreset * preset, const gchar * preset_path,
     guint64 * preset_version)
 {
   GKeyFile *in;
+  GMappedFile *mapped;
   GError *error = NULL;
   gboolean res;
-  const gchar *element_name;
+  const gchar *element_name, *contents;
   gchar *name;
 
   in = g_key_file_new ();
 
-  res = g_key_file_load_from_file (in, preset_path,
+  /* parse the file from the mapped pages instead of reading a copy */
+  if (!(mapped = g_mapped_file_new (preset_path, FALSE, &error)))
+    goto load_error;
+
+  contents = g_mapped_file_get_contents (mapped);
+  res = g_key_file_load_from_data (in, contents ? contents : "",
+      g_mapped_file_get_length (mapped),
       G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, &error);
+  g_mapped_file_unref (mapped);
   if (!res || error != NULL)
     goto load_error;
 
@@ -380,6 +407,11 @@ preset_get_keyfile (GstPreset * preset)
   GType type = G_TYPE_FROM_INSTANCE (preset);
 
   /* first see if the have a cached version for the type */
+  if (G_LIKELY ((presets = g_type_get_qdata (type, preset_quark))))
+    return presets;
+
+  /* only one instance parses the files of a type */
+  g_mutex_lock (&preset_lock);
   if (!(presets = g_type_get_qdata (type, preset_quark))) {
     const gchar *preset_user_path, *preset_app_path, *preset_system_path;
     guint64 version_system = G_GUINT64_CONSTANT (0);
@@ -497,14 +529,78 @@ preset_get_keyfile (GstPreset * preset)
 
     /* attach the preset to the type */
     g_type_set_qdata (type, preset_quark, (gpointer) presets);
+    g_mutex_unlock (&preset_lock);
 
     if (merged) {
       gst_preset_default_save_presets_file (preset);
     }
+    return presets;
   }
+  g_mutex_unlock (&preset_lock);
+
   return presets;
 }
 
+static void
+preset_value_clear (PresetValue * pv)
+{
+  g_value_unset (&pv->value);
+}
+
+/* forget the cached values of the presets of @preset, must be called after
+ * the presets were changed */
+static void
+preset_values_invalidate (GstPreset * preset)
+{
+  GHashTable *values;
+
+  g_mutex_lock (&preset_lock);
+  preset_generation++;
+  values = g_type_get_qdata (G_TYPE_FROM_INSTANCE (preset),
+      preset_values_quark);
+  if (values)
+    g_hash_table_remove_all (values);
+  g_mutex_unlock (&preset_lock);
+}
+
+/* returns a ref to the cached values of the preset @name or %NULL */
+static GArray *
+preset_values_lookup (GstPreset * preset, const gchar * name)
+{
+  GHashTable *values;
+  GArray *result = NULL;
+
+  g_mutex_lock (&preset_lock);
+  values = g_type_get_qdata (G_TYPE_FROM_INSTANCE (preset),
+      preset_values_quark);
+  if (values && (result = g_hash_table_lookup (values, name)))
+    g_array_ref (result);
+  g_mutex_unlock (&preset_lock);
+
+  return result;
+}
+
+/* remembers @array for the preset @name unless the presets were changed
+ * since @generation */
+static void
+preset_values_store (GstPreset * preset, const gchar * name, GArray * array,
+    guint generation)
+{
+  GHashTable *values;
+  GType type = G_TYPE_FROM_INSTANCE (preset);
+
+  g_mutex_lock (&preset_lock);
+  if (generation == preset_generation) {
+    if (!(values = g_type_get_qdata (type, preset_values_quark))) {
+      values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+          (GDestroyNotify) g_array_unref);
+      g_type_set_qdata (type, preset_values_quark, values);
+    }
+    g_hash_table_replace (values, g_strdup (name), g_array_ref (array));
+  }
+  g_mutex_unlock (&preset_lock);
+}
+
 static gint
 compare_strings (gchar ** a, gchar ** b, gpointer user_data)
 {
@@ -640,9 +736,30 @@ gst_preset_default_load_preset (GstPreset * preset, const gchar * name)
 {
   GKeyFile *presets;
   gchar **props;
-  guint i;
+  guint i, generation;
   GObjectClass *gclass;
   gboolean is_child_proxy;
+  GArray *values = NULL;
+
+  is_child_proxy = GST_IS_CHILD_PROXY (preset);
+
+  /* the properties of children depend on the instance, the others are
+   * deserialized only once */
+  if (!is_child_proxy && (values = preset_values_lookup (preset, name))) {
+    GST_DEBUG_OBJECT (preset, "loading cached preset : '%s'", name);
+    for (i = 0; i < values->len; i++) {
+      PresetValue *pv = &g_array_index (values, PresetValue, i);
+
+      g_object_set_property ((GObject *) preset, pv->property->name,
+          &pv->value);
+    }
+    g_array_unref (values);
+    return TRUE;
+  }
+
+  g_mutex_lock (&preset_lock);
+  generation = preset_generation;
+  g_mutex_unlock (&preset_lock);
 
   /* get the presets from the type */
   if (!(presets = preset_get_keyfile (preset)))
@@ -659,7 +776,11 @@ gst_preset_default_load_preset (GstPreset * preset, const gchar * name)
     goto no_properties;
 
   gclass = G_OBJECT_CLASS (GST_ELEMENT_GET_CLASS (preset));
-  is_child_proxy = GST_IS_CHILD_PROXY (preset);
+
+  if (!is_child_proxy) {
+    values = g_array_new (FALSE, TRUE, sizeof (PresetValue));
+    g_array_set_clear_func (values, (GDestroyNotify) preset_value_clear);
+  }
 
   /* for each of the property names, find the preset parameter and try to
    * configure the property with its value */
@@ -700,18 +821,32 @@ gst_preset_default_load_preset (GstPreset * preset, const gchar * name)
         gst_child_proxy_set_property ((GstChildProxy *) preset, props[i],
             &gvalue);
       } else {
+        PresetValue pv;
+
         g_object_set_property ((GObject *) preset, props[i], &gvalue);
+
+        /* the array takes the value */
+        pv.property = property;
+        pv.value = gvalue;
+        g_array_append_val (values, pv);
+        memset (&gvalue, 0, sizeof (gvalue));
       }
     } else {
       GST_WARNING_OBJECT (preset,
           "deserialization of value '%s' for property '%s' failed", str,
           props[i]);
     }
-    g_value_unset (&gvalue);
+    if (G_IS_VALUE (&gvalue))
+      g_value_unset (&gvalue);
     g_free (str);
   }
   g_strfreev (props);
 
+  if (values) {
+    preset_values_store (preset, name, values, generation);
+    g_array_unref (values);
+  }
+
   return TRUE;
 
   /* ERRORS */
@@ -742,15 +877,36 @@ gst_preset_default_save_presets_file (GstPreset * preset)
   GError *error = NULL;
   gchar *bak_file_name;
   gboolean backup = TRUE;
-  gchar *data;
+  gchar *data, *saved;
   gsize data_size;
+  GType type = G_TYPE_FROM_INSTANCE (preset);
 
   preset_get_paths (preset, &preset_path, NULL, NULL);
 
+  /* all changes end up here */
+  preset_values_invalidate (preset);
+
   /* get the presets from the type */
   if (!(presets = preset_get_keyfile (preset)))
     goto no_presets;
 
+  /* update gstreamer version */
+  g_key_file_set_string (presets, PRESET_HEADER, PRESET_HEADER_VERSION,
+      PACKAGE_VERSION);
+
+  /* get new contents, wee need this to save it */
+  if (!(data = g_key_file_to_data (presets, &data_size, &error)))
+    goto convert_failed;
+
+  /* don't rewrite the file when nothing changed since we last wrote it */
+  saved = g_type_get_qdata (type, preset_saved_quark);
+  if (saved && strcmp (saved, data) == 0 &&
+      g_file_test (preset_path, G_FILE_TEST_EXISTS)) {
+    GST_DEBUG_OBJECT (preset, "preset file '%s' is unchanged", preset_path);
+    g_free (data);
+    return TRUE;
+  }
+
   GST_DEBUG_OBJECT (preset, "saving preset file: '%s'", preset_path);
 
   /* create backup if possible */
@@ -770,19 +926,13 @@ gst_preset_default_save_presets_file (GstPreset * preset)
   }
   g_free (bak_file_name);
 
-  /* update gstreamer version */
-  g_key_file_set_string (presets, PRESET_HEADER, PRESET_HEADER_VERSION,
-      PACKAGE_VERSION);
-
-  /* get new contents, wee need this to save it */
-  if (!(data = g_key_file_to_data (presets, &data_size, &error)))
-    goto convert_failed;
-
   /* write presets */
   if (!g_file_set_contents (preset_path, data, data_size, &error))
     goto write_failed;
 
-  g_free (data);
+  /* keep what we wrote to compare the next time */
+  g_free (g_type_get_qdata (type, preset_saved_quark));
+  g_type_set_qdata (type, preset_saved_quark, data);
 
   return TRUE;
 
@@ -1287,6 +1437,8 @@ gst_preset_base_init (gpointer g_class)
 
     /* create quarks for use with g_type_{g,s}et_qdata() */
     preset_quark = g_quark_from_static_string ("GstPreset::presets");
+    preset_values_quark = g_quark_from_static_string ("GstPreset::values");
+    preset_saved_quark = g_quark_from_static_string ("GstPreset::saved");
     preset_user_path_quark =
         g_quark_from_static_string ("GstPreset::user_path");
     preset_app_path_quark = g_quark_from_static_string ("GstPreset::app_path");
@@ -0,0 +1,87 @@
+/* GStreamer
+ *
+ * gstproctimestack.h: processing time of nested elements, not installed
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PROC_TIME_STACK_H__
+#define __GST_PROC_TIME_STACK_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Shared by the graphstats tracer and the --stats mode of gst-launch. A
+ * stack, one per thread, of the elements that are processing data. When an
+ * element pushes to or pulls from another element, the time until the
+ * other element returns is charged to that other one, so each element gets
+ * its self time. The entries point to the processing time to add to, or
+ * NULL for things that are not measured such as bins. */
+typedef struct
+{
+  GstClockTime *proc_time;
+  GstClockTime since;
+} GstProcTimeStackEntry;
+
+static inline GArray *
+proc_time_stack_new (void)
+{
+  return g_array_new (FALSE, FALSE, sizeof (GstProcTimeStackEntry));
+}
+
+/* the element with @proc_time starts processing data at @ts */
+static inline void
+proc_time_stack_push (GArray * stack, GstClockTime * proc_time,
+    GstClockTime ts)
+{
+  GstProcTimeStackEntry entry;
+
+  if (stack->len > 0) {
+    GstProcTimeStackEntry *top =
+        &g_array_index (stack, GstProcTimeStackEntry, stack->len - 1);
+
+    if (top->proc_time)
+      *top->proc_time += GST_CLOCK_DIFF (top->since, ts);
+  }
+  entry.proc_time = proc_time;
+  entry.since = ts;
+  g_array_append_val (stack, entry);
+}
+
+/* the innermost element is done at @ts, the one below it continues */
+static inline void
+proc_time_stack_pop (GArray * stack, GstClockTime ts)
+{
+  GstProcTimeStackEntry *top;
+
+  if (stack->len == 0)
+    return;
+
+  top = &g_array_index (stack, GstProcTimeStackEntry, stack->len - 1);
+  if (top->proc_time)
+    *top->proc_time += GST_CLOCK_DIFF (top->since, ts);
+  g_array_set_size (stack, stack->len - 1);
+
+  if (stack->len > 0) {
+    top = &g_array_index (stack, GstProcTimeStackEntry, stack->len - 1);
+    top->since = ts;
+  }
+}
+
+G_END_DECLS
+
+#endif /* __GST_PROC_TIME_STACK_H__ */
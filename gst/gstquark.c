@@ -24,6 +24,8 @@
 #include "gstquark.h"
 #include "gstelementmetadata.h"
 
+#include <string.h>
+
 /* These strings must match order and number declared in the GstQuarkId
  * enum in gstquark.h! */
 static const gchar *_quark_strings[] = {
@@ -80,10 +82,115 @@ static const gchar *_quark_strings[] = {
 
 GQuark _priv_gst_quark_table[GST_QUARK_MAX];
 
+/* Common media types and caps fields that are looked up for every caps
+ * negotiation, added to the cache at init time */
+static const gchar *_media_strings[] = {
+  "video/x-raw", "audio/x-raw", "video/x-h264", "video/x-h265",
+  "audio/mpeg", "audio/x-opus", "video/x-vp8", "video/x-vp9",
+  "text/x-raw", "application/x-rtp", "ANY", "EMPTY",
+  "width", "height", "framerate", "pixel-aspect-ratio", "interlace-mode",
+  "colorimetry", "chroma-site", "multiview-mode", "multiview-flags",
+  "views", "channels", "channel-mask", "layout", "stream-format",
+  "alignment", "profile", "level", "tier", "parsed", "codec_data",
+  "mpegversion", "media", "clock-rate", "encoding-name", "payload"
+};
+
+/* Lock-free cache of string to quark mappings.
+ *
+ * g_quark_from_string() takes a global lock for every lookup, which
+ * serializes all threads that create structures. The cache is an open
+ * addressing hash table of pointers into an array of entries, entries are
+ * filled before they are published with a compare-and-exchange and are
+ * never changed or removed after that, so lookups only need atomic loads.
+ * When the cache is full we fall back to g_quark_from_string(). */
+#define QUARK_CACHE_SIZE        2048    /* must be a power of 2 */
+#define QUARK_CACHE_MAX_ENTRIES (QUARK_CACHE_SIZE / 2)
+#define QUARK_CACHE_MAX_PROBES  16
+
+typedef struct
+{
+  guint hash;
+  GQuark quark;
+  const gchar *string;          /* owned by GLib and never freed */
+} GstQuarkCacheEntry;
+
+static GstQuarkCacheEntry quark_cache_entries[QUARK_CACHE_MAX_ENTRIES];
+static gint quark_cache_n_entries;
+static GstQuarkCacheEntry *quark_cache[QUARK_CACHE_SIZE];
+
+static GQuark
+quark_cache_lookup (const gchar * string, guint hash)
+{
+  GstQuarkCacheEntry *entry;
+  guint i;
+
+  for (i = 0; i < QUARK_CACHE_MAX_PROBES; i++) {
+    entry = g_atomic_pointer_get (&quark_cache[(hash + i) &
+            (QUARK_CACHE_SIZE - 1)]);
+    if (entry == NULL)
+      break;
+    if (entry->hash == hash && strcmp (entry->string, string) == 0)
+      return entry->quark;
+  }
+  return 0;
+}
+
+static void
+quark_cache_insert (GQuark quark, guint hash)
+{
+  GstQuarkCacheEntry *entry, *other;
+  guint i, idx;
+  gint n;
+
+  n = g_atomic_int_add (&quark_cache_n_entries, 1);
+  if (n >= QUARK_CACHE_MAX_ENTRIES) {
+    /* full, keep the counter from wrapping around */
+    g_atomic_int_set (&quark_cache_n_entries, QUARK_CACHE_MAX_ENTRIES);
+    return;
+  }
+
+  entry = &quark_cache_entries[n];
+  entry->hash = hash;
+  entry->quark = quark;
+  entry->string = g_quark_to_string (quark);
+
+  for (i = 0; i < QUARK_CACHE_MAX_PROBES; i++) {
+    idx = (hash + i) & (QUARK_CACHE_SIZE - 1);
+    if (g_atomic_pointer_compare_and_exchange (&quark_cache[idx], NULL,
+            entry))
+      return;
+    /* another thread could have added the same quark, the entry is then
+     * wasted but that is rare enough */
+    other = g_atomic_pointer_get (&quark_cache[idx]);
+    if (other->quark == quark)
+      return;
+  }
+}
+
+GQuark
+_priv_gst_quark_from_string (const gchar * string)
+{
+  GQuark quark;
+  guint hash;
+
+  if (string == NULL)
+    return 0;
+
+  hash = g_str_hash (string);
+  quark = quark_cache_lookup (string, hash);
+  if (G_LIKELY (quark != 0))
+    return quark;
+
+  quark = g_quark_from_string (string);
+  quark_cache_insert (quark, hash);
+
+  return quark;
+}
+
 void
 _priv_gst_quarks_initialize (void)
 {
-  gint i;
+  guint i;
 
   if (G_N_ELEMENTS (_quark_strings) != GST_QUARK_MAX)
     g_warning ("the quark table is not consistent! %d != %d",
@@ -91,5 +198,10 @@ _priv_gst_quarks_initialize (void)
 
   for (i = 0; i < GST_QUARK_MAX; i++) {
     _priv_gst_quark_table[i] = g_quark_from_static_string (_quark_strings[i]);
+    quark_cache_insert (_priv_gst_quark_table[i],
+        g_str_hash (_quark_strings[i]));
   }
+
+  for (i = 0; i < G_N_ELEMENTS (_media_strings); i++)
+    _priv_gst_quark_from_string (_media_strings[i]);
 }
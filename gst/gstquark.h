@@ -224,4 +224,8 @@ extern GQuark _priv_gst_quark_table[GST_QUARK_MAX];
 
 #define GST_QUARK(q) _priv_gst_quark_table[GST_QUARK_##q]
 
+/* like g_quark_from_string() but without taking the global quark lock for
+ * the strings that were seen before */
+G_GNUC_INTERNAL GQuark _priv_gst_quark_from_string (const gchar * string);
+
 #endif
@@ -73,9 +73,28 @@ typedef struct
   GstQuery query;
 
   GstStructure *structure;
+
+  /* the frequently sent queries keep their values here and only create the
+   * structure when it is asked for. The structure is used instead of the
+   * fields once it exists. */
+  gboolean has_fields;
+  union
+  {
+    struct
+    {
+      GstFormat format;
+      gint64 value;
+    } position, duration;
+    struct
+    {
+      gboolean live;
+      GstClockTime min, max;
+    } latency;
+  } fields;
 } GstQueryImpl;
 
 #define GST_QUERY_STRUCTURE(q)  (((GstQueryImpl *)(q))->structure)
+#define GST_QUERY_FIELDS(q)     (((GstQueryImpl *)(q))->fields)
 
 
 typedef struct
@@ -183,6 +202,64 @@ gst_query_type_get_flags (GstQueryType type)
   return ret;
 }
 
+/* check if the values of @query are in the fields */
+static inline gboolean
+query_uses_fields (GstQuery * query)
+{
+  return ((GstQueryImpl *) query)->has_fields &&
+      g_atomic_pointer_get (&GST_QUERY_STRUCTURE (query)) == NULL;
+}
+
+static GstStructure *
+query_fields_to_structure (GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_POSITION:
+      return gst_structure_new_id (GST_QUARK (QUERY_POSITION),
+          GST_QUARK (FORMAT), GST_TYPE_FORMAT,
+          GST_QUERY_FIELDS (query).position.format,
+          GST_QUARK (CURRENT), G_TYPE_INT64,
+          GST_QUERY_FIELDS (query).position.value, NULL);
+    case GST_QUERY_DURATION:
+      return gst_structure_new_id (GST_QUARK (QUERY_DURATION),
+          GST_QUARK (FORMAT), GST_TYPE_FORMAT,
+          GST_QUERY_FIELDS (query).duration.format,
+          GST_QUARK (DURATION), G_TYPE_INT64,
+          GST_QUERY_FIELDS (query).duration.value, NULL);
+    case GST_QUERY_LATENCY:
+      return gst_structure_new_id (GST_QUARK (QUERY_LATENCY),
+          GST_QUARK (LIVE), G_TYPE_BOOLEAN, GST_QUERY_FIELDS (query).latency.live,
+          GST_QUARK (MIN_LATENCY), G_TYPE_UINT64,
+          GST_QUERY_FIELDS (query).latency.min,
+          GST_QUARK (MAX_LATENCY), G_TYPE_UINT64,
+          GST_QUERY_FIELDS (query).latency.max, NULL);
+    default:
+      g_assert_not_reached ();
+      return NULL;
+  }
+}
+
+/* get the structure of @query, creating it from the fields if needed */
+static GstStructure *
+query_ensure_structure (GstQuery * query)
+{
+  GstStructure *structure;
+
+  if (G_LIKELY (!query_uses_fields (query)))
+    return GST_QUERY_STRUCTURE (query);
+
+  structure = query_fields_to_structure (query);
+  gst_structure_set_parent_refcount (structure, &query->mini_object.refcount);
+  if (!g_atomic_pointer_compare_and_exchange (&GST_QUERY_STRUCTURE (query),
+          NULL, structure)) {
+    /* another thread was faster */
+    gst_structure_set_parent_refcount (structure, NULL);
+    gst_structure_free (structure);
+  }
+
+  return GST_QUERY_STRUCTURE (query);
+}
+
 static void
 _gst_query_free (GstQuery * query)
 {
@@ -210,6 +287,8 @@ _gst_query_copy (GstQuery * query)
     s = gst_structure_copy (s);
   }
   copy = gst_query_new_custom (query->type, s);
+  ((GstQueryImpl *) copy)->has_fields = ((GstQueryImpl *) query)->has_fields;
+  GST_QUERY_FIELDS (copy) = GST_QUERY_FIELDS (query);
 
   return copy;
 }
@@ -230,13 +309,12 @@ GstQuery *
 gst_query_new_position (GstFormat format)
 {
   GstQuery *query;
-  GstStructure *structure;
 
-  structure = gst_structure_new_id (GST_QUARK (QUERY_POSITION),
-      GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
-      GST_QUARK (CURRENT), G_TYPE_INT64, G_GINT64_CONSTANT (-1), NULL);
-
-  query = gst_query_new_custom (GST_QUERY_POSITION, structure);
+  /* the structure is only created when it is needed */
+  query = gst_query_new_custom (GST_QUERY_POSITION, NULL);
+  ((GstQueryImpl *) query)->has_fields = TRUE;
+  GST_QUERY_FIELDS (query).position.format = format;
+  GST_QUERY_FIELDS (query).position.value = -1;
 
   return query;
 }
@@ -256,6 +334,12 @@ gst_query_set_position (GstQuery * query, GstFormat format, gint64 cur)
 
   g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_POSITION);
 
+  if (query_uses_fields (query)) {
+    g_return_if_fail (format == GST_QUERY_FIELDS (query).position.format);
+    GST_QUERY_FIELDS (query).position.value = cur;
+    return;
+  }
+
   s = GST_QUERY_STRUCTURE (query);
   g_return_if_fail (format == g_value_get_enum (gst_structure_id_get_value (s,
               GST_QUARK (FORMAT))));
@@ -282,6 +366,14 @@ gst_query_parse_position (GstQuery * query, GstFormat * format, gint64 * cur)
 
   g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_POSITION);
 
+  if (query_uses_fields (query)) {
+    if (format)
+      *format = GST_QUERY_FIELDS (query).position.format;
+    if (cur)
+      *cur = GST_QUERY_FIELDS (query).position.value;
+    return;
+  }
+
   structure = GST_QUERY_STRUCTURE (query);
   if (format)
     *format =
@@ -309,13 +401,11 @@ GstQuery *
 gst_query_new_duration (GstFormat format)
 {
   GstQuery *query;
-  GstStructure *structure;
-
-  structure = gst_structure_new_id (GST_QUARK (QUERY_DURATION),
-      GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
-      GST_QUARK (DURATION), G_TYPE_INT64, G_GINT64_CONSTANT (-1), NULL);
 
-  query = gst_query_new_custom (GST_QUERY_DURATION, structure);
+  query = gst_query_new_custom (GST_QUERY_DURATION, NULL);
+  ((GstQueryImpl *) query)->has_fields = TRUE;
+  GST_QUERY_FIELDS (query).duration.format = format;
+  GST_QUERY_FIELDS (query).duration.value = -1;
 
   return query;
 }
@@ -335,6 +425,12 @@ gst_query_set_duration (GstQuery * query, GstFormat format, gint64 duration)
 
   g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_DURATION);
 
+  if (query_uses_fields (query)) {
+    g_return_if_fail (format == GST_QUERY_FIELDS (query).duration.format);
+    GST_QUERY_FIELDS (query).duration.value = duration;
+    return;
+  }
+
   s = GST_QUERY_STRUCTURE (query);
   g_return_if_fail (format == g_value_get_enum (gst_structure_id_get_value (s,
               GST_QUARK (FORMAT))));
@@ -360,6 +456,14 @@ gst_query_parse_duration (GstQuery * query, GstFormat * format,
 
   g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_DURATION);
 
+  if (query_uses_fields (query)) {
+    if (format)
+      *format = GST_QUERY_FIELDS (query).duration.format;
+    if (duration)
+      *duration = GST_QUERY_FIELDS (query).duration.value;
+    return;
+  }
+
   structure = GST_QUERY_STRUCTURE (query);
   if (format)
     *format =
@@ -386,14 +490,12 @@ GstQuery *
 gst_query_new_latency (void)
 {
   GstQuery *query;
-  GstStructure *structure;
-
-  structure = gst_structure_new_id (GST_QUARK (QUERY_LATENCY),
-      GST_QUARK (LIVE), G_TYPE_BOOLEAN, FALSE,
-      GST_QUARK (MIN_LATENCY), G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
-      GST_QUARK (MAX_LATENCY), G_TYPE_UINT64, GST_CLOCK_TIME_NONE, NULL);
 
-  query = gst_query_new_custom (GST_QUERY_LATENCY, structure);
+  query = gst_query_new_custom (GST_QUERY_LATENCY, NULL);
+  ((GstQueryImpl *) query)->has_fields = TRUE;
+  GST_QUERY_FIELDS (query).latency.live = FALSE;
+  GST_QUERY_FIELDS (query).latency.min = 0;
+  GST_QUERY_FIELDS (query).latency.max = GST_CLOCK_TIME_NONE;
 
   return query;
 }
@@ -416,6 +518,13 @@ gst_query_set_latency (GstQuery * query, gboolean live,
   g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_LATENCY);
   g_return_if_fail (GST_CLOCK_TIME_IS_VALID (min_latency));
 
+  if (query_uses_fields (query)) {
+    GST_QUERY_FIELDS (query).latency.live = live;
+    GST_QUERY_FIELDS (query).latency.min = min_latency;
+    GST_QUERY_FIELDS (query).latency.max = max_latency;
+    return;
+  }
+
   structure = GST_QUERY_STRUCTURE (query);
   gst_structure_id_set (structure,
       GST_QUARK (LIVE), G_TYPE_BOOLEAN, live,
@@ -440,6 +549,16 @@ gst_query_parse_latency (GstQuery * query, gboolean * live,
 
   g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_LATENCY);
 
+  if (query_uses_fields (query)) {
+    if (live)
+      *live = GST_QUERY_FIELDS (query).latency.live;
+    if (min_latency)
+      *min_latency = GST_QUERY_FIELDS (query).latency.min;
+    if (max_latency)
+      *max_latency = GST_QUERY_FIELDS (query).latency.max;
+    return;
+  }
+
   structure = GST_QUERY_STRUCTURE (query);
   if (live)
     *live =
@@ -699,6 +818,222 @@ had_parent:
   }
 }
 
+/**
+ * gst_query_to_binary:
+ * @query: a #GstQuery
+ * @size: (out): the size of the returned data
+ *
+ * Serializes @query into a compact binary representation that can be turned
+ * back into a query with gst_query_new_from_binary(), also in another
+ * process. The type and structure of the query are stored, see
+ * gst_structure_to_binary().
+ *
+ * Returns: (transfer full) (array length=size) (nullable): the binary data,
+ *     or %NULL if the query contains values that can't be serialized, like
+ *     objects. Free with g_free() when no longer needed.
+ *
+ * Since: 1.14
+ */
+guint8 *
+gst_query_to_binary (GstQuery * query, gsize * size)
+{
+  GstStructure *s;
+  GByteArray *array;
+
+  g_return_val_if_fail (GST_IS_QUERY (query), NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  s = query_ensure_structure (query);
+
+  array = g_byte_array_new ();
+  _priv_gst_binary_write_header (array, GST_BINARY_KIND_QUERY);
+  _priv_gst_binary_write_uint32 (array, GST_QUERY_TYPE (query));
+  _priv_gst_binary_write_uint8 (array, s != NULL);
+  if (s && !_priv_gst_structure_write_binary (array, s)) {
+    g_byte_array_free (array, TRUE);
+    *size = 0;
+    return NULL;
+  }
+
+  *size = array->len;
+  return g_byte_array_free (array, FALSE);
+}
+
+/* a query of @type as its constructor creates it, the structure of a query
+ * read from binary data must have all its fields as the parse functions
+ * don't check them. Returns %NULL for unknown types. */
+static GstQuery *
+query_new_reference (GstQueryType type)
+{
+  GstQuery *query;
+
+  switch (type) {
+    case GST_QUERY_POSITION:
+      return gst_query_new_position (GST_FORMAT_TIME);
+    case GST_QUERY_DURATION:
+      return gst_query_new_duration (GST_FORMAT_TIME);
+    case GST_QUERY_LATENCY:
+      return gst_query_new_latency ();
+    case GST_QUERY_SEEKING:
+      return gst_query_new_seeking (GST_FORMAT_TIME);
+    case GST_QUERY_SEGMENT:
+      return gst_query_new_segment (GST_FORMAT_TIME);
+    case GST_QUERY_CONVERT:
+      return gst_query_new_convert (GST_FORMAT_TIME, 0, GST_FORMAT_BYTES);
+    case GST_QUERY_FORMATS:
+      return gst_query_new_formats ();
+    case GST_QUERY_BUFFERING:
+      return gst_query_new_buffering (GST_FORMAT_TIME);
+    case GST_QUERY_CUSTOM:
+      /* any structure, but there has to be one */
+      return gst_query_new_custom (type, gst_structure_new_empty ("x"));
+    case GST_QUERY_URI:
+      return gst_query_new_uri ();
+    case GST_QUERY_ALLOCATION:
+      return gst_query_new_allocation (NULL, FALSE);
+    case GST_QUERY_SCHEDULING:
+      return gst_query_new_scheduling ();
+    case GST_QUERY_ACCEPT_CAPS:{
+      GstCaps *caps = gst_caps_new_empty_simple ("x");
+
+      query = gst_query_new_accept_caps (caps);
+      gst_caps_unref (caps);
+      return query;
+    }
+    case GST_QUERY_CAPS:
+      return gst_query_new_caps (NULL);
+    case GST_QUERY_DRAIN:
+      return gst_query_new_drain ();
+    case GST_QUERY_CONTEXT:
+      return gst_query_new_context ("");
+    default:
+      return NULL;
+  }
+}
+
+/* @field of @s has @type when it is there */
+static gboolean
+query_optional_field_is_valid (const GstStructure * s, GQuark field,
+    GType type)
+{
+  const GValue *value = gst_structure_id_get_value (s, field);
+
+  return value == NULL || G_VALUE_TYPE (value) == type;
+}
+
+/* check that the structure @s read from binary data is valid for a query of
+ * @type */
+static gboolean
+query_structure_is_valid (GstQueryType type, const GstStructure * s)
+{
+  GstQuery *reference;
+  gboolean res;
+
+  if (!(reference = query_new_reference (type))) {
+    GST_WARNING ("unknown query type %d", type);
+    return FALSE;
+  }
+
+  res = _priv_gst_structure_has_fields_of (s,
+      query_ensure_structure (reference));
+  gst_query_unref (reference);
+
+  /* the fields that are only added by the setters. The arrays can't be
+   * read from binary data and are rejected */
+  switch (type) {
+    case GST_QUERY_FORMATS:{
+      const GValue *formats;
+      guint i;
+
+      if (!res || !(formats = gst_structure_get_value (s, "formats")))
+        break;
+      res = GST_VALUE_HOLDS_LIST (formats);
+      for (i = 0; res && i < gst_value_list_get_size (formats); i++)
+        res = G_VALUE_TYPE (gst_value_list_get_value (formats, i)) ==
+            GST_TYPE_FORMAT;
+      break;
+    }
+    case GST_QUERY_BUFFERING:
+      res = res && query_optional_field_is_valid (s,
+          GST_QUARK (BUFFERING_RANGES), G_TYPE_ARRAY);
+      break;
+    case GST_QUERY_URI:
+      res = res && query_optional_field_is_valid (s,
+          GST_QUARK (URI_REDIRECTION), G_TYPE_STRING) &&
+          query_optional_field_is_valid (s,
+          GST_QUARK (URI_REDIRECTION_PERMANENT), G_TYPE_BOOLEAN);
+      break;
+    case GST_QUERY_ALLOCATION:
+      res = res && query_optional_field_is_valid (s, GST_QUARK (POOL),
+          G_TYPE_ARRAY) && query_optional_field_is_valid (s, GST_QUARK (META),
+          G_TYPE_ARRAY) && query_optional_field_is_valid (s,
+          GST_QUARK (ALLOCATOR), G_TYPE_ARRAY);
+      break;
+    case GST_QUERY_SCHEDULING:
+      res = res && query_optional_field_is_valid (s, GST_QUARK (MODES),
+          G_TYPE_ARRAY);
+      break;
+    case GST_QUERY_CONTEXT:
+      res = res && query_optional_field_is_valid (s, GST_QUARK (CONTEXT),
+          GST_TYPE_CONTEXT);
+      break;
+    default:
+      break;
+  }
+
+  if (!res)
+    GST_WARNING ("invalid structure for %s query",
+        gst_query_type_get_name (type));
+
+  return res;
+}
+
+/**
+ * gst_query_new_from_binary:
+ * @data: (array length=size): data created with gst_query_to_binary()
+ * @size: the size of @data
+ *
+ * Creates a query from its binary representation.
+ *
+ * Returns: (transfer full) (nullable): the new query, or %NULL when @data
+ *     could not be deserialized.
+ *
+ * Since: 1.14
+ */
+GstQuery *
+gst_query_new_from_binary (const guint8 * data, gsize size)
+{
+  GstBinaryReader reader = GST_BINARY_READER_INIT (data, size);
+  GstStructure *s = NULL;
+  guint32 type;
+  guint8 has_structure;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_binary_read_header (&reader, GST_BINARY_KIND_QUERY) ||
+      !_priv_gst_binary_read_uint32 (&reader, &type) ||
+      !_priv_gst_binary_read_uint8 (&reader, &has_structure))
+    goto error;
+
+  if (has_structure && !(s = _priv_gst_structure_read_binary (&reader)))
+    goto error;
+
+  if (reader.offset != reader.size || !query_structure_is_valid (type, s)) {
+    if (s)
+      gst_structure_free (s);
+    goto error;
+  }
+
+  return gst_query_new_custom (type, s);
+
+  /* ERRORS */
+error:
+  {
+    GST_WARNING ("invalid query in binary data");
+    return NULL;
+  }
+}
+
 /**
  * gst_query_get_structure:
  * @query: a #GstQuery
@@ -714,7 +1049,7 @@ gst_query_get_structure (GstQuery * query)
 {
   g_return_val_if_fail (GST_IS_QUERY (query), NULL);
 
-  return GST_QUERY_STRUCTURE (query);
+  return query_ensure_structure (query);
 }
 
 /**
@@ -734,7 +1069,7 @@ gst_query_writable_structure (GstQuery * query)
   g_return_val_if_fail (GST_IS_QUERY (query), NULL);
   g_return_val_if_fail (gst_query_is_writable (query), NULL);
 
-  return GST_QUERY_STRUCTURE (query);
+  return query_ensure_structure (query);
 }
 
 /**
@@ -314,6 +314,12 @@ gst_query_replace (GstQuery **old_query, GstQuery *new_query)
 GST_EXPORT
 GstQuery *      gst_query_new_custom            (GstQueryType type, GstStructure *structure) G_GNUC_MALLOC;
 
+GST_EXPORT
+guint8 *        gst_query_to_binary             (GstQuery *query, gsize *size) G_GNUC_MALLOC;
+
+GST_EXPORT
+GstQuery *      gst_query_new_from_binary       (const guint8 *data, gsize size) G_GNUC_MALLOC;
+
 GST_EXPORT
 const GstStructure *
                 gst_query_get_structure         (GstQuery *query);
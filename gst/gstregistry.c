@@ -100,6 +100,9 @@
 #endif
 #include <errno.h>
 #include <stdio.h>
+#ifdef HAVE_PTHREAD_ATFORK
+#include <pthread.h>
+#endif
 #include <string.h>
 
 /* For g_stat () */
@@ -150,8 +153,39 @@ struct _GstRegistryPrivate
   guint32 tfl_cookie;
   GList *device_provider_factory_list;
   guint32 dmfl_cookie;
+  /* plugin name -> GQueue with the features of the plugin */
+  GHashTable *plugin_features;
+  guint32 pf_cookie;
+
+  /* filtered and sorted feature lists, see
+   * _priv_gst_registry_get_feature_view() */
+  GHashTable *feature_views;
+
+  /* lower case protocol -> GList with the element factories handling it,
+   * sorted by rank, for sinks and sources. See
+   * _priv_gst_registry_get_uri_factories() */
+  GHashTable *uri_index[2];
+  guint32 uri_cookie;
+  guint uri_rank_cookie;
+
+  /* path -> gint64 mtime of the plugin directories of the last scan */
+  GHashTable *directories;
+
+  /* no more scanning, see gst_registry_freeze() */
+  gboolean frozen;
 };
 
+typedef struct
+{
+  GType type;
+  guint64 key;
+  guint minrank;
+
+  GList *features;
+  guint32 cookie;
+  guint rank_cookie;
+} GstRegistryFeatureView;
+
 /* the one instance of the default registry and the mutex protecting the
  * variable. */
 static GMutex _gst_registry_mutex;
@@ -198,6 +232,37 @@ static GstPlugin *gst_registry_lookup_bn_locked (GstRegistry * registry,
 #define gst_registry_parent_class parent_class
 G_DEFINE_TYPE (GstRegistry, gst_registry, GST_TYPE_OBJECT);
 
+static guint
+gst_registry_feature_view_hash (gconstpointer key)
+{
+  const GstRegistryFeatureView *view = key;
+
+  return (guint) view->type ^ (guint) view->key ^ (guint) (view->key >> 32) ^
+      (view->minrank << 16);
+}
+
+static gboolean
+gst_registry_feature_view_equal (gconstpointer a, gconstpointer b)
+{
+  const GstRegistryFeatureView *view1 = a, *view2 = b;
+
+  return view1->type == view2->type && view1->key == view2->key &&
+      view1->minrank == view2->minrank;
+}
+
+static void
+gst_registry_feature_view_free (GstRegistryFeatureView * view)
+{
+  gst_plugin_feature_list_free (view->features);
+  g_slice_free (GstRegistryFeatureView, view);
+}
+
+static void
+gst_registry_plugin_features_free (GQueue * queue)
+{
+  g_queue_free_full (queue, (GDestroyNotify) gst_object_unref);
+}
+
 static void
 gst_registry_class_init (GstRegistryClass * klass)
 {
@@ -236,6 +301,25 @@ gst_registry_class_init (GstRegistryClass * klass)
   gobject_class->finalize = gst_registry_finalize;
 }
 
+static void
+gst_registry_uri_index_free (GHashTable ** index)
+{
+  GHashTableIter iter;
+  gpointer value;
+  guint i;
+
+  for (i = 0; i < 2; i++) {
+    if (index[i] == NULL)
+      continue;
+
+    g_hash_table_iter_init (&iter, index[i]);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+      gst_plugin_feature_list_free (value);
+    g_hash_table_destroy (index[i]);
+    index[i] = NULL;
+  }
+}
+
 static void
 gst_registry_init (GstRegistry * registry)
 {
@@ -244,6 +328,15 @@ gst_registry_init (GstRegistry * registry)
       GstRegistryPrivate);
   registry->priv->feature_hash = g_hash_table_new (g_str_hash, g_str_equal);
   registry->priv->basename_hash = g_hash_table_new (g_str_hash, g_str_equal);
+  registry->priv->plugin_features =
+      g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) gst_registry_plugin_features_free);
+  registry->priv->feature_views =
+      g_hash_table_new_full (gst_registry_feature_view_hash,
+      gst_registry_feature_view_equal, NULL,
+      (GDestroyNotify) gst_registry_feature_view_free);
+  registry->priv->directories =
+      g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static void
@@ -308,6 +401,14 @@ gst_registry_finalize (GObject * object)
     gst_plugin_feature_list_free (registry->priv->device_provider_factory_list);
   }
 
+  g_hash_table_destroy (registry->priv->plugin_features);
+  registry->priv->plugin_features = NULL;
+  g_hash_table_destroy (registry->priv->feature_views);
+  registry->priv->feature_views = NULL;
+  gst_registry_uri_index_free (registry->priv->uri_index);
+  g_hash_table_destroy (registry->priv->directories);
+  registry->priv->directories = NULL;
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -967,6 +1068,202 @@ gst_registry_get_feature_list (GstRegistry * registry, GType type)
       FALSE, &data);
 }
 
+/*
+ * _priv_gst_registry_get_feature_view:
+ * @registry: a #GstRegistry
+ * @type: a #GType
+ * @key: identifies @filter and @user_data
+ * @minrank: the minimum rank
+ * @filter: (allow-none): the filter to use
+ * @user_data: user data passed to @filter
+ *
+ * Retrieves the features of @type with a rank of at least @minrank for which
+ * @filter returns %TRUE, sorted by rank and name. The result is remembered
+ * for @type, @key and @minrank, and only filtered again when the features
+ * in the registry or their ranks changed, so @filter must only depend on
+ * @key and the properties of the feature.
+ *
+ * Returns: a #GList of #GstPluginFeature. Use gst_plugin_feature_list_free()
+ *     after use
+ */
+GList *
+_priv_gst_registry_get_feature_view (GstRegistry * registry, GType type,
+    guint64 key, guint minrank, GstPluginFeatureFilter filter,
+    gpointer user_data)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GstRegistryFeatureView lookup, *view;
+  GList *features, *walk, *result = NULL;
+  guint32 cookie;
+  guint rank_cookie;
+
+  lookup.type = type;
+  lookup.key = key;
+  lookup.minrank = minrank;
+
+  rank_cookie = _priv_gst_plugin_feature_get_rank_cookie ();
+
+  GST_OBJECT_LOCK (registry);
+  view = g_hash_table_lookup (priv->feature_views, &lookup);
+  if (view && view->cookie == priv->cookie &&
+      view->rank_cookie == rank_cookie) {
+    result = gst_plugin_feature_list_copy (view->features);
+    GST_OBJECT_UNLOCK (registry);
+    return result;
+  }
+  cookie = priv->cookie;
+  GST_OBJECT_UNLOCK (registry);
+
+  /* filter without the lock, the filter might need the registry */
+  features = gst_registry_get_feature_list (registry, type);
+  for (walk = features; walk; walk = walk->next) {
+    GstPluginFeature *feature = walk->data;
+
+    if (feature->rank >= minrank && (filter == NULL
+            || filter (feature, user_data)))
+      result = g_list_prepend (result, gst_object_ref (feature));
+  }
+  gst_plugin_feature_list_free (features);
+
+  result = g_list_sort (result, gst_plugin_feature_rank_compare_func);
+
+  GST_OBJECT_LOCK (registry);
+  /* only remember the result if nothing changed in the meantime */
+  if (cookie == priv->cookie &&
+      rank_cookie == _priv_gst_plugin_feature_get_rank_cookie ()) {
+    view = g_hash_table_lookup (priv->feature_views, &lookup);
+    if (view == NULL) {
+      view = g_slice_new0 (GstRegistryFeatureView);
+      view->type = type;
+      view->key = key;
+      view->minrank = minrank;
+      g_hash_table_insert (priv->feature_views, view, view);
+    } else {
+      gst_plugin_feature_list_free (view->features);
+    }
+    view->features = gst_plugin_feature_list_copy (result);
+    view->cookie = cookie;
+    view->rank_cookie = rank_cookie;
+  }
+  GST_OBJECT_UNLOCK (registry);
+
+  return result;
+}
+
+static void
+gst_registry_uri_index_add (GHashTable * index, const gchar * protocol,
+    GstPluginFeature * feature)
+{
+  gchar *key;
+  GList *list;
+
+  key = g_ascii_strdown (protocol, -1);
+  list = g_hash_table_lookup (index, key);
+
+  /* a factory can list a protocol twice */
+  if (g_list_find (list, feature)) {
+    g_free (key);
+    return;
+  }
+
+  list = g_list_insert_sorted (list, gst_object_ref (feature),
+      gst_plugin_feature_rank_compare_func);
+  /* keeps the old key if there was one already */
+  g_hash_table_insert (index, key, list);
+}
+
+static void
+gst_registry_uri_index_build (GstRegistry * registry, GHashTable ** index)
+{
+  GList *factories, *walk;
+
+  index[0] = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  index[1] = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  factories = gst_registry_get_element_factory_list (registry);
+  for (walk = factories; walk; walk = walk->next) {
+    GstElementFactory *factory = walk->data;
+    const gchar *const *protocols;
+
+    if (factory->uri_type != GST_URI_SINK && factory->uri_type != GST_URI_SRC)
+      continue;
+
+    protocols = gst_element_factory_get_uri_protocols (factory);
+    if (protocols == NULL) {
+      g_warning ("Factory '%s' implements GstUriHandler interface but "
+          "returned no supported protocols!", GST_OBJECT_NAME (factory));
+      continue;
+    }
+
+    for (; *protocols != NULL; protocols++)
+      gst_registry_uri_index_add (index[factory->uri_type - GST_URI_SINK],
+          *protocols, GST_PLUGIN_FEATURE_CAST (factory));
+  }
+  gst_plugin_feature_list_free (factories);
+}
+
+/*
+ * _priv_gst_registry_get_uri_factories:
+ * @registry: a #GstRegistry
+ * @type: %GST_URI_SINK or %GST_URI_SRC
+ * @protocol: a lower case protocol
+ *
+ * Retrieves the element factories of @type that handle @protocol, sorted by
+ * rank and name. The factories of all protocols are indexed at once and only
+ * indexed again when the features in the registry or their ranks changed.
+ *
+ * Returns: a #GList of #GstElementFactory. Use gst_plugin_feature_list_free()
+ *     after use
+ */
+GList *
+_priv_gst_registry_get_uri_factories (GstRegistry * registry,
+    GstURIType type, const gchar * protocol)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GHashTable *index[2];
+  GList *result;
+  guint32 cookie;
+  guint rank_cookie;
+
+  g_return_val_if_fail (type == GST_URI_SINK || type == GST_URI_SRC, NULL);
+
+  rank_cookie = _priv_gst_plugin_feature_get_rank_cookie ();
+
+  GST_OBJECT_LOCK (registry);
+  if (priv->uri_index[0] && priv->uri_cookie == priv->cookie &&
+      priv->uri_rank_cookie == rank_cookie) {
+    result = gst_plugin_feature_list_copy (g_hash_table_lookup
+        (priv->uri_index[type - GST_URI_SINK], protocol));
+    GST_OBJECT_UNLOCK (registry);
+    return result;
+  }
+  cookie = priv->cookie;
+  GST_OBJECT_UNLOCK (registry);
+
+  /* index without the lock, getting the protocols might load a plugin */
+  GST_DEBUG_OBJECT (registry, "indexing URI handlers");
+  gst_registry_uri_index_build (registry, index);
+  result = gst_plugin_feature_list_copy (g_hash_table_lookup
+      (index[type - GST_URI_SINK], protocol));
+
+  GST_OBJECT_LOCK (registry);
+  /* only keep the index if nothing changed in the meantime */
+  if (cookie == priv->cookie &&
+      rank_cookie == _priv_gst_plugin_feature_get_rank_cookie ()) {
+    gst_registry_uri_index_free (priv->uri_index);
+    priv->uri_index[0] = index[0];
+    priv->uri_index[1] = index[1];
+    priv->uri_cookie = cookie;
+    priv->uri_rank_cookie = rank_cookie;
+    index[0] = index[1] = NULL;
+  }
+  GST_OBJECT_UNLOCK (registry);
+
+  gst_registry_uri_index_free (index);
+
+  return result;
+}
+
 /**
  * gst_registry_get_plugin_list:
  * @registry: the registry to search
@@ -1090,17 +1387,29 @@ typedef enum
   REGISTRY_SCAN_HELPER_RUNNING
 } GstRegistryScanHelperState;
 
+/* maximum number of scan helpers running in parallel */
+#define MAX_SCAN_HELPERS 64
+
 typedef struct
 {
   GstRegistry *registry;
   GstRegistryScanHelperState helper_state;
-  GstPluginLoader *helper;
+  /* the plugin files are distributed round-robin over the helpers, they
+   * are started on demand */
+  GstPluginLoader *helpers[MAX_SCAN_HELPERS];
+  guint n_helpers;
+  guint next_helper;
   gboolean changed;
+  /* directories seen during this scan, path -> gint64 mtime */
+  GHashTable *directories;
+  /* don't stat plugin files in unchanged directories */
+  gboolean trust_cache;
 } GstRegistryScanContext;
 
 static void
 init_scan_context (GstRegistryScanContext * context, GstRegistry * registry)
 {
+  const gchar *trust_env;
   gboolean do_fork;
 
   context->registry = registry;
@@ -1122,17 +1431,104 @@ init_scan_context (GstRegistryScanContext * context, GstRegistry * registry)
   else
     context->helper_state = REGISTRY_SCAN_HELPER_DISABLED;
 
-  context->helper = NULL;
+  /* number of helpers scanning in parallel */
+  context->n_helpers = 1;
+  if (do_fork) {
+    const gchar *jobs_env;
+
+    if ((jobs_env = g_getenv ("GST_REGISTRY_SCAN_JOBS"))) {
+      guint64 jobs = g_ascii_strtoull (jobs_env, NULL, 10);
+
+      context->n_helpers = CLAMP (jobs, 1, MAX_SCAN_HELPERS);
+    }
+  }
+
+  memset (context->helpers, 0, sizeof (context->helpers));
+  context->next_helper = 0;
   context->changed = FALSE;
+
+  context->directories =
+      g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  trust_env = g_getenv ("GST_REGISTRY_TRUST_CACHE");
+  context->trust_cache = trust_env != NULL && strcmp (trust_env, "yes") == 0;
 }
 
 static void
 clear_scan_context (GstRegistryScanContext * context)
 {
-  if (context->helper) {
-    context->changed |= _priv_gst_plugin_loader_funcs.destroy (context->helper);
-    context->helper = NULL;
+  guint i;
+
+  /* this waits for each helper to finish its pending plugins and merges
+   * their details into the registry */
+  for (i = 0; i < context->n_helpers; i++) {
+    if (context->helpers[i]) {
+      context->changed |=
+          _priv_gst_plugin_loader_funcs.destroy (context->helpers[i]);
+      context->helpers[i] = NULL;
+    }
   }
+  context->next_helper = 0;
+}
+
+/* Moves the directories seen in the scan to the registry, either replacing
+ * the known ones or adding to them. Returns %TRUE if this changed them. */
+static gboolean
+gst_registry_update_directories (GstRegistryScanContext * context,
+    gboolean replace)
+{
+  GstRegistryPrivate *priv = context->registry->priv;
+  GHashTableIter iter;
+  gpointer key, value;
+  gboolean changed = FALSE;
+
+  GST_OBJECT_LOCK (context->registry);
+  if (replace &&
+      g_hash_table_size (priv->directories) !=
+      g_hash_table_size (context->directories))
+    changed = TRUE;
+
+  g_hash_table_iter_init (&iter, context->directories);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    gint64 *known_mtime = g_hash_table_lookup (priv->directories, key);
+
+    if (!known_mtime || *known_mtime != *(gint64 *) value) {
+      changed = TRUE;
+      if (!replace) {
+        g_hash_table_iter_steal (&iter);
+        g_hash_table_insert (priv->directories, key, value);
+      }
+    }
+  }
+
+  if (replace) {
+    g_hash_table_destroy (priv->directories);
+    priv->directories = context->directories;
+  } else {
+    g_hash_table_destroy (context->directories);
+  }
+  context->directories = NULL;
+  GST_OBJECT_UNLOCK (context->registry);
+
+  return changed;
+}
+
+GHashTable *
+_priv_gst_registry_get_directories (GstRegistry * registry)
+{
+  return registry->priv->directories;
+}
+
+void
+_priv_gst_registry_set_directory (GstRegistry * registry, const gchar * path,
+    gint64 mtime)
+{
+  gint64 *val = g_new (gint64, 1);
+
+  *val = mtime;
+
+  GST_OBJECT_LOCK (registry);
+  g_hash_table_insert (registry->priv->directories, g_strdup (path), val);
+  GST_OBJECT_UNLOCK (registry);
 }
 
 static gboolean
@@ -1141,6 +1537,7 @@ gst_registry_scan_plugin_file (GstRegistryScanContext * context,
 {
   gboolean changed = FALSE;
   GstPlugin *newplugin = NULL;
+  guint i;
 
 #ifdef G_OS_WIN32
   /* Disable external plugin loader on Windows until it is ported properly. */
@@ -1151,8 +1548,10 @@ gst_registry_scan_plugin_file (GstRegistryScanContext * context,
   /* Have a plugin to load - see if the scan-helper needs starting */
   if (context->helper_state == REGISTRY_SCAN_HELPER_NOT_STARTED) {
     GST_DEBUG ("Starting plugin scanner for file %s", filename);
-    context->helper = _priv_gst_plugin_loader_funcs.create (context->registry);
-    if (context->helper != NULL)
+    context->helpers[0] =
+        _priv_gst_plugin_loader_funcs.create (context->registry);
+    context->next_helper = 0;
+    if (context->helpers[0] != NULL)
       context->helper_state = REGISTRY_SCAN_HELPER_RUNNING;
     else {
       GST_WARNING ("Failed starting plugin scanner. Scanning in-process");
@@ -1161,8 +1560,22 @@ gst_registry_scan_plugin_file (GstRegistryScanContext * context,
   }
 
   if (context->helper_state == REGISTRY_SCAN_HELPER_RUNNING) {
-    GST_DEBUG ("Using scan-helper to load plugin %s", filename);
-    if (!_priv_gst_plugin_loader_funcs.load (context->helper,
+    i = context->next_helper;
+    if (context->helpers[i] == NULL) {
+      GST_DEBUG ("Starting plugin scanner %u for file %s", i, filename);
+      context->helpers[i] =
+          _priv_gst_plugin_loader_funcs.create (context->registry);
+      if (context->helpers[i] == NULL) {
+        /* continue with the ones we have, helper 0 always exists */
+        GST_WARNING ("Failed starting plugin scanner %u", i);
+        context->n_helpers = i;
+        i = 0;
+      }
+    }
+    context->next_helper = (i + 1) % context->n_helpers;
+
+    GST_DEBUG ("Using scan-helper %u to load plugin %s", i, filename);
+    if (!_priv_gst_plugin_loader_funcs.load (context->helpers[i],
             filename, file_size, file_mtime)) {
       g_warning ("External plugin loader failed. This most likely means that "
           "the plugin loader helper binary was not found or could not be run. "
@@ -1220,6 +1633,185 @@ is_blacklisted_hidden_directory (const gchar * dirent)
   return FALSE;
 }
 
+/* checks the regular file @filename with basename @dirent against the
+ * registry and (re)scans it if needed */
+static gboolean
+gst_registry_scan_file (GstRegistryScanContext * context,
+    const gchar * filename, const gchar * dirent, GStatBuf * file_status)
+{
+  GstPlugin *plugin;
+  gboolean changed = FALSE;
+
+  if (!g_str_has_suffix (dirent, "." G_MODULE_SUFFIX)
+#ifdef GST_EXTRA_MODULE_SUFFIX
+      && !g_str_has_suffix (dirent, GST_EXTRA_MODULE_SUFFIX)
+#endif
+      ) {
+    GST_TRACE_OBJECT (context->registry,
+        "extension is not recognized as module file, ignoring file %s",
+        filename);
+    return FALSE;
+  }
+
+  GST_LOG_OBJECT (context->registry, "file %s looks like a possible module",
+      filename);
+
+  /* try to avoid unnecessary plugin-move pain */
+  if (g_str_has_prefix (dirent, "libgstvalve") ||
+      g_str_has_prefix (dirent, "libgstselector")) {
+    GST_WARNING_OBJECT (context->registry, "ignoring old plugin %s which "
+        "has been merged into the corelements plugin", filename);
+    /* Plugin will be removed from cache after the scan completes if it
+     * is still marked 'cached' */
+    return FALSE;
+  }
+
+  /* plug-ins are considered unique by basename; if the given name
+   * was already seen by the registry, we ignore it */
+  plugin = gst_registry_lookup_bn (context->registry, dirent);
+  if (plugin) {
+    gboolean env_vars_changed, deps_changed = FALSE;
+
+    if (plugin->registered) {
+      gchar *dirname;
+      gint64 *mtime;
+
+      GST_DEBUG_OBJECT (context->registry,
+          "plugin already registered from path \"%s\"",
+          GST_STR_NULL (plugin->filename));
+      gst_object_unref (plugin);
+
+      /* the shadowed file is not in the cache, always read its directory
+       * so that it is found when the other one goes away */
+      dirname = g_path_get_dirname (filename);
+      if ((mtime = g_hash_table_lookup (context->directories, dirname)))
+        *mtime = -1;
+      g_free (dirname);
+      return FALSE;
+    }
+
+    env_vars_changed = _priv_plugin_deps_env_vars_changed (plugin);
+
+    /* If a file with a certain basename is seen on a different path,
+     * update the plugin to ensure the registry cache will reflect up
+     * to date information */
+
+    if (plugin->file_mtime == file_status->st_mtime &&
+        plugin->file_size == file_status->st_size && !env_vars_changed &&
+        !(deps_changed = _priv_plugin_deps_files_changed (plugin)) &&
+        !strcmp (plugin->filename, filename)) {
+      GST_LOG_OBJECT (context->registry, "file %s cached", filename);
+      GST_OBJECT_FLAG_UNSET (plugin, GST_PLUGIN_FLAG_CACHED);
+      GST_LOG_OBJECT (context->registry,
+          "marking plugin %p as registered as %s", plugin, filename);
+      plugin->registered = TRUE;
+    } else {
+      GST_INFO_OBJECT (context->registry, "cached info for %s is stale",
+          filename);
+      GST_DEBUG_OBJECT (context->registry, "mtime %" G_GINT64_FORMAT " != %"
+          G_GINT64_FORMAT " or size %" G_GINT64_FORMAT " != %"
+          G_GINT64_FORMAT " or external dependency env_vars changed: %d or"
+          " external dependencies changed: %d or old path %s != new path %s",
+          (gint64) plugin->file_mtime, (gint64) file_status->st_mtime,
+          (gint64) plugin->file_size, (gint64) file_status->st_size,
+          env_vars_changed, deps_changed, plugin->filename, filename);
+      gst_registry_remove_plugin (context->registry, plugin);
+      changed |= gst_registry_scan_plugin_file (context, filename,
+          file_status->st_size, file_status->st_mtime);
+    }
+    gst_object_unref (plugin);
+
+  } else {
+    GST_DEBUG_OBJECT (context->registry, "file %s not yet in registry",
+        filename);
+    changed |= gst_registry_scan_plugin_file (context, filename,
+        file_status->st_size, file_status->st_mtime);
+  }
+
+  return changed;
+}
+
+static gboolean gst_registry_scan_path_level (GstRegistryScanContext * context,
+    const gchar * path, int level);
+
+/* Validates the cached plugins of a directory that did not change since the
+ * last scan without reading the directory. Files can still be replaced in
+ * place without changing the directory mtime, so the plugin files are
+ * stat'ed unless GST_REGISTRY_TRUST_CACHE=yes. */
+static gboolean
+gst_registry_scan_unchanged_path (GstRegistryScanContext * context,
+    const gchar * path, int level)
+{
+  GstRegistry *registry = context->registry;
+  GList *plugins = NULL, *subdirs = NULL, *l;
+  GHashTableIter iter;
+  gpointer key;
+  gchar *tmp, *dirpath;
+  gboolean changed = FALSE;
+
+  /* compare against the path as the scan builds it, without trailing
+   * separators */
+  tmp = g_build_filename (path, "x", NULL);
+  dirpath = g_path_get_dirname (tmp);
+  g_free (tmp);
+
+  GST_OBJECT_LOCK (registry);
+  for (l = registry->priv->plugins; l; l = l->next) {
+    GstPlugin *plugin = l->data;
+    gchar *dirname;
+
+    if (plugin->registered || plugin->filename == NULL)
+      continue;
+
+    dirname = g_path_get_dirname (plugin->filename);
+    if (strcmp (dirname, dirpath) == 0)
+      plugins = g_list_prepend (plugins, gst_object_ref (plugin));
+    g_free (dirname);
+  }
+  g_hash_table_iter_init (&iter, registry->priv->directories);
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    gchar *dirname = g_path_get_dirname ((gchar *) key);
+
+    if (strcmp (dirname, dirpath) == 0 && strcmp (key, dirpath) != 0)
+      subdirs = g_list_prepend (subdirs, g_strdup (key));
+    g_free (dirname);
+  }
+  GST_OBJECT_UNLOCK (registry);
+
+  for (l = plugins; l; l = l->next) {
+    GstPlugin *plugin = l->data;
+    GStatBuf file_status;
+
+    if (context->trust_cache) {
+      file_status.st_size = plugin->file_size;
+      file_status.st_mtime = plugin->file_mtime;
+    } else if (g_stat (plugin->filename, &file_status) < 0 ||
+        !(file_status.st_mode & S_IFREG)) {
+      /* Plugin will be removed from cache after the scan completes if it
+       * is still marked 'cached' */
+      continue;
+    }
+    changed |= gst_registry_scan_file (context, plugin->filename,
+        plugin->basename, &file_status);
+  }
+  g_list_free_full (plugins, (GDestroyNotify) gst_object_unref);
+
+  /* FIXME 2.0: Don't recurse into directories, this behaviour
+   * is inconsistent with other PATH environment variables
+   */
+  for (l = subdirs; l; l = l->next) {
+    if (level > 0) {
+      GST_LOG_OBJECT (registry, "recursing into directory %s",
+          (gchar *) l->data);
+      changed |= gst_registry_scan_path_level (context, l->data, level - 1);
+    }
+  }
+  g_list_free_full (subdirs, g_free);
+  g_free (dirpath);
+
+  return changed;
+}
+
 static gboolean
 gst_registry_scan_path_level (GstRegistryScanContext * context,
     const gchar * path, int level)
@@ -1227,8 +1819,37 @@ gst_registry_scan_path_level (GstRegistryScanContext * context,
   GDir *dir;
   const gchar *dirent;
   gchar *filename;
-  GstPlugin *plugin;
   gboolean changed = FALSE;
+  GStatBuf dir_status;
+  gint64 mtime, *known_mtime;
+
+  /* already seen in this scan */
+  if (g_hash_table_contains (context->directories, path))
+    return FALSE;
+
+  if (g_stat (path, &dir_status) < 0)
+    return FALSE;
+
+  /* A directory that was modified within the last second could still get
+   * new entries with the same mtime after we read it, never trust it on the
+   * next scan. */
+  mtime = dir_status.st_mtime;
+  if (mtime + 1 >= g_get_real_time () / G_USEC_PER_SEC)
+    mtime = -1;
+
+  known_mtime = g_new (gint64, 1);
+  *known_mtime = mtime;
+  g_hash_table_insert (context->directories, g_strdup (path), known_mtime);
+
+  GST_OBJECT_LOCK (context->registry);
+  known_mtime = g_hash_table_lookup (context->registry->priv->directories,
+      path);
+  if (known_mtime && *known_mtime != -1 && *known_mtime == dir_status.st_mtime) {
+    GST_OBJECT_UNLOCK (context->registry);
+    GST_LOG_OBJECT (context->registry, "directory %s unchanged", path);
+    return gst_registry_scan_unchanged_path (context, path, level);
+  }
+  GST_OBJECT_UNLOCK (context->registry);
 
   dir = g_dir_open (path, 0, NULL);
   if (!dir)
@@ -1271,84 +1892,9 @@ gst_registry_scan_path_level (GstRegistryScanContext * context,
       g_free (filename);
       continue;
     }
-    if (!g_str_has_suffix (dirent, "." G_MODULE_SUFFIX)
-#ifdef GST_EXTRA_MODULE_SUFFIX
-        && !g_str_has_suffix (dirent, GST_EXTRA_MODULE_SUFFIX)
-#endif
-        ) {
-      GST_TRACE_OBJECT (context->registry,
-          "extension is not recognized as module file, ignoring file %s",
-          filename);
-      g_free (filename);
-      continue;
-    }
 
-    GST_LOG_OBJECT (context->registry, "file %s looks like a possible module",
-        filename);
-
-    /* try to avoid unnecessary plugin-move pain */
-    if (g_str_has_prefix (dirent, "libgstvalve") ||
-        g_str_has_prefix (dirent, "libgstselector")) {
-      GST_WARNING_OBJECT (context->registry, "ignoring old plugin %s which "
-          "has been merged into the corelements plugin", filename);
-      /* Plugin will be removed from cache after the scan completes if it
-       * is still marked 'cached' */
-      g_free (filename);
-      continue;
-    }
-
-    /* plug-ins are considered unique by basename; if the given name
-     * was already seen by the registry, we ignore it */
-    plugin = gst_registry_lookup_bn (context->registry, dirent);
-    if (plugin) {
-      gboolean env_vars_changed, deps_changed = FALSE;
-
-      if (plugin->registered) {
-        GST_DEBUG_OBJECT (context->registry,
-            "plugin already registered from path \"%s\"",
-            GST_STR_NULL (plugin->filename));
-        g_free (filename);
-        gst_object_unref (plugin);
-        continue;
-      }
-
-      env_vars_changed = _priv_plugin_deps_env_vars_changed (plugin);
-
-      /* If a file with a certain basename is seen on a different path,
-       * update the plugin to ensure the registry cache will reflect up
-       * to date information */
-
-      if (plugin->file_mtime == file_status.st_mtime &&
-          plugin->file_size == file_status.st_size && !env_vars_changed &&
-          !(deps_changed = _priv_plugin_deps_files_changed (plugin)) &&
-          !strcmp (plugin->filename, filename)) {
-        GST_LOG_OBJECT (context->registry, "file %s cached", filename);
-        GST_OBJECT_FLAG_UNSET (plugin, GST_PLUGIN_FLAG_CACHED);
-        GST_LOG_OBJECT (context->registry,
-            "marking plugin %p as registered as %s", plugin, filename);
-        plugin->registered = TRUE;
-      } else {
-        GST_INFO_OBJECT (context->registry, "cached info for %s is stale",
-            filename);
-        GST_DEBUG_OBJECT (context->registry, "mtime %" G_GINT64_FORMAT " != %"
-            G_GINT64_FORMAT " or size %" G_GINT64_FORMAT " != %"
-            G_GINT64_FORMAT " or external dependency env_vars changed: %d or"
-            " external dependencies changed: %d or old path %s != new path %s",
-            (gint64) plugin->file_mtime, (gint64) file_status.st_mtime,
-            (gint64) plugin->file_size, (gint64) file_status.st_size,
-            env_vars_changed, deps_changed, plugin->filename, filename);
-        gst_registry_remove_plugin (context->registry, plugin);
-        changed |= gst_registry_scan_plugin_file (context, filename,
-            file_status.st_size, file_status.st_mtime);
-      }
-      gst_object_unref (plugin);
-
-    } else {
-      GST_DEBUG_OBJECT (context->registry, "file %s not yet in registry",
-          filename);
-      changed |= gst_registry_scan_plugin_file (context, filename,
-          file_status.st_size, file_status.st_mtime);
-    }
+    changed |= gst_registry_scan_file (context, filename, dirent,
+        &file_status);
 
     g_free (filename);
   }
@@ -1391,21 +1937,52 @@ gst_registry_scan_path (GstRegistry * registry, const gchar * path)
   g_return_val_if_fail (GST_IS_REGISTRY (registry), FALSE);
   g_return_val_if_fail (path != NULL, FALSE);
 
+  if (gst_registry_is_frozen (registry)) {
+    GST_INFO_OBJECT (registry, "registry is frozen, not scanning %s", path);
+    return FALSE;
+  }
+
   init_scan_context (&context, registry);
 
   result = gst_registry_scan_path_internal (&context, path);
 
   clear_scan_context (&context);
   result |= context.changed;
+  result |= gst_registry_update_directories (&context, FALSE);
 
   return result;
 }
 
-static gboolean
-_gst_plugin_feature_filter_plugin_name (GstPluginFeature * feature,
-    gpointer user_data)
+/* Must be called with the object lock taken. Groups the features by plugin
+ * name in one pass so that listing the features of every plugin does not
+ * walk all features for each plugin */
+static void
+gst_registry_update_plugin_features (GstRegistry * registry)
 {
-  return (strcmp (feature->plugin_name, (gchar *) user_data) == 0);
+  GstRegistryPrivate *priv = registry->priv;
+  const GList *walk;
+
+  if (G_LIKELY (priv->pf_cookie == priv->cookie &&
+          g_hash_table_size (priv->plugin_features) > 0))
+    return;
+
+  g_hash_table_remove_all (priv->plugin_features);
+
+  for (walk = priv->features; walk != NULL; walk = walk->next) {
+    GstPluginFeature *feature = walk->data;
+    GQueue *queue;
+
+    queue = g_hash_table_lookup (priv->plugin_features, feature->plugin_name);
+    if (queue == NULL) {
+      queue = g_queue_new ();
+      g_hash_table_insert (priv->plugin_features,
+          g_strdup (feature->plugin_name), queue);
+    }
+    /* same order as gst_registry_feature_filter() */
+    g_queue_push_head (queue, gst_object_ref (feature));
+  }
+
+  priv->pf_cookie = priv->cookie;
 }
 
 /**
@@ -1422,11 +1999,21 @@ GList *
 gst_registry_get_feature_list_by_plugin (GstRegistry * registry,
     const gchar * name)
 {
+  GQueue *queue;
+  GList *list = NULL;
+
   g_return_val_if_fail (GST_IS_REGISTRY (registry), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  return gst_registry_feature_filter (registry,
-      _gst_plugin_feature_filter_plugin_name, FALSE, (gpointer) name);
+  GST_OBJECT_LOCK (registry);
+  gst_registry_update_plugin_features (registry);
+  queue = g_hash_table_lookup (registry->priv->plugin_features, name);
+  /* Return reffed copy */
+  if (queue != NULL)
+    list = gst_plugin_feature_list_copy (queue->head);
+  GST_OBJECT_UNLOCK (registry);
+
+  return list;
 }
 
 /* Unref and delete the default registry */
@@ -1444,6 +2031,11 @@ _priv_gst_registry_cleanup (void)
   /* unref outside of the lock because we can. */
   if (registry)
     gst_object_unref (registry);
+
+#ifndef GST_DISABLE_REGISTRY
+  /* the features are gone now, release the cache contents they referenced */
+  priv_gst_registry_binary_cleanup ();
+#endif
 }
 
 /**
@@ -1485,6 +2077,152 @@ gst_registry_check_feature_version (GstRegistry * registry,
   return ret;
 }
 
+/**
+ * gst_registry_preload:
+ * @registry: a #GstRegistry
+ * @names: (array zero-terminated=1): %NULL terminated array of plugin or
+ *     feature names
+ *
+ * Load the plugins and features in @names so that their first use doesn't
+ * need to open the plugin. Names are first looked up as plugin names and
+ * then as feature names. For element factories, the element class is
+ * initialized too.
+ *
+ * This is meant for applications that fork worker processes from a
+ * prepared parent, together with gst_registry_freeze().
+ *
+ * Returns: %TRUE if all plugins and features were found and loaded.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_registry_preload (GstRegistry * registry, const gchar * const *names)
+{
+  gboolean res = TRUE;
+  guint i;
+
+  g_return_val_if_fail (GST_IS_REGISTRY (registry), FALSE);
+  g_return_val_if_fail (names != NULL, FALSE);
+
+  for (i = 0; names[i]; i++) {
+    GstPlugin *plugin, *loaded;
+    GstPluginFeature *feature, *loaded_feature;
+
+    if ((plugin = gst_registry_find_plugin (registry, names[i]))) {
+      loaded = gst_plugin_load (plugin);
+      gst_object_unref (plugin);
+      if (loaded == NULL) {
+        GST_WARNING_OBJECT (registry, "could not load plugin %s", names[i]);
+        res = FALSE;
+        continue;
+      }
+      gst_object_unref (loaded);
+      GST_DEBUG_OBJECT (registry, "preloaded plugin %s", names[i]);
+      continue;
+    }
+
+    if (!(feature = gst_registry_lookup_feature (registry, names[i]))) {
+      GST_WARNING_OBJECT (registry, "no plugin or feature %s", names[i]);
+      res = FALSE;
+      continue;
+    }
+
+    loaded_feature = gst_plugin_feature_load (feature);
+    gst_object_unref (feature);
+    if (loaded_feature == NULL) {
+      GST_WARNING_OBJECT (registry, "could not load feature %s", names[i]);
+      res = FALSE;
+      continue;
+    }
+
+    /* element classes are never freed, the reference is never dropped */
+    if (GST_IS_ELEMENT_FACTORY (loaded_feature)) {
+      GType type = gst_element_factory_get_element_type
+          (GST_ELEMENT_FACTORY_CAST (loaded_feature));
+
+      if (type != 0)
+        g_type_class_ref (type);
+    }
+    gst_object_unref (loaded_feature);
+    GST_DEBUG_OBJECT (registry, "preloaded feature %s", names[i]);
+  }
+
+  return res;
+}
+
+#ifdef HAVE_PTHREAD_ATFORK
+static void
+gst_registry_after_fork_child (void)
+{
+  _priv_gst_system_clock_after_fork ();
+}
+#endif
+
+/**
+ * gst_registry_freeze:
+ * @registry: a #GstRegistry
+ *
+ * Stop all scanning of plugin paths for @registry: gst_registry_scan_path()
+ * and gst_update_registry() will not change it anymore. The registry can
+ * still be used to find and load plugins and features.
+ *
+ * A frozen default registry never starts the plugin scanner helper process,
+ * which makes it possible to fork worker processes that share the plugins
+ * loaded by the parent, see gst_registry_preload(). Freezing the default
+ * registry also makes the default system clock recreate its wakeup file
+ * descriptors in the child, as these would otherwise be shared with the
+ * parent. Only the forking thread exists in the child, so no pipeline
+ * should run while forking.
+ *
+ * Since: 1.14
+ */
+void
+gst_registry_freeze (GstRegistry * registry)
+{
+  g_return_if_fail (GST_IS_REGISTRY (registry));
+
+  GST_INFO_OBJECT (registry, "freezing registry");
+
+  GST_OBJECT_LOCK (registry);
+  registry->priv->frozen = TRUE;
+  GST_OBJECT_UNLOCK (registry);
+
+#ifdef HAVE_PTHREAD_ATFORK
+  if (registry == gst_registry_get ()) {
+    static gsize atfork_installed = 0;
+
+    if (g_once_init_enter (&atfork_installed)) {
+      pthread_atfork (NULL, NULL, gst_registry_after_fork_child);
+      g_once_init_leave (&atfork_installed, 1);
+    }
+  }
+#endif
+}
+
+/**
+ * gst_registry_is_frozen:
+ * @registry: a #GstRegistry
+ *
+ * Check if @registry was frozen with gst_registry_freeze().
+ *
+ * Returns: %TRUE if @registry is frozen.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_registry_is_frozen (GstRegistry * registry)
+{
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_REGISTRY (registry), FALSE);
+
+  GST_OBJECT_LOCK (registry);
+  res = registry->priv->frozen;
+  GST_OBJECT_UNLOCK (registry);
+
+  return res;
+}
+
 static void
 load_plugin_func (gpointer data, gpointer user_data)
 {
@@ -1586,7 +2324,9 @@ scan_and_update_registry (GstRegistry * default_registry,
 
   /* It sounds tempting to just compare the mtime of directories with the mtime
    * of the registry cache, but it does not work. It would not catch updated
-   * plugins, which might bring more or less features.
+   * plugins, which might bring more or less features. The directory mtimes
+   * are only used to avoid reading directories without new or removed files,
+   * see gst_registry_scan_path_level().
    */
 
   /* scan paths specified via --gst-plugin-path */
@@ -1677,6 +2417,7 @@ scan_and_update_registry (GstRegistry * default_registry,
 
   clear_scan_context (&context);
   changed |= context.changed;
+  changed |= gst_registry_update_directories (&context, TRUE);
 
   /* Remove cached plugins so stale info is cleared. */
   changed |= gst_registry_remove_cache_plugins (default_registry);
@@ -1827,7 +2568,10 @@ gst_update_registry (void)
   gboolean res;
 
 #ifndef GST_DISABLE_REGISTRY
-  if (!_priv_gst_disable_registry) {
+  if (gst_registry_is_frozen (gst_registry_get ())) {
+    GST_INFO ("registry is frozen, not updating");
+    res = TRUE;
+  } else if (!_priv_gst_disable_registry) {
     GError *err = NULL;
 
     res = ensure_current_registry (&err);
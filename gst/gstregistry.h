@@ -124,6 +124,16 @@ gboolean                gst_registry_check_feature_version (GstRegistry *registr
                                                             guint        min_minor,
                                                             guint        min_micro);
 
+GST_EXPORT
+gboolean                gst_registry_preload            (GstRegistry *registry,
+                                                         const gchar * const *names);
+
+GST_EXPORT
+void                    gst_registry_freeze             (GstRegistry *registry);
+
+GST_EXPORT
+gboolean                gst_registry_is_frozen          (GstRegistry *registry);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstRegistry, gst_object_unref)
 #endif
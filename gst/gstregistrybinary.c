@@ -23,9 +23,7 @@
  */
 
 /* FIXME:
- * - keep registry binary blob and reference strings
- *   - don't free/unmmap contents when leaving gst_registry_binary_read_cache()
- *     - free at gst_deinit() / _priv_gst_registry_cleanup() ?
+ * - reference more strings from the kept registry binary blob
  *   - GstPlugin:
  *     - GST_PLUGIN_FLAG_CONST
  *   - GstPluginFeature, GstIndexFactory, GstElementFactory
@@ -73,6 +71,12 @@
 
 #define GST_CAT_DEFAULT GST_CAT_REGISTRY
 
+/* contents of the loaded registry caches. The loaded features reference
+ * their pad template caps and metadata strings in them, so they are only
+ * released in priv_gst_registry_binary_cleanup() */
+static GMutex cache_contents_lock;
+static GSList *cache_contents;
+
 /* reading macros */
 #define unpack_element(inptr, outptr, element, endptr, error_label) G_STMT_START{ \
   if (inptr + sizeof(element) >= endptr) \
@@ -517,6 +521,8 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
   gsize size;
   GError *err = NULL;
   gboolean res = FALSE;
+  gboolean in_place = TRUE;
+  gboolean keep = FALSE;
   guint32 filter_env_hash = 0;
   gint check_magic_result;
 #ifndef GST_DISABLE_GST_DEBUG
@@ -557,6 +563,11 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
     /* This can't fail if g_mapped_file_new() succeeded */
     contents = g_mapped_file_get_contents (mapped);
     size = g_mapped_file_get_length (mapped);
+#ifdef G_OS_WIN32
+    /* a mapped file can't be replaced on win32, which would break writing
+     * an updated registry later */
+    in_place = FALSE;
+#endif
   }
 
   /* in is a cursor pointer, we initialize it with the begin of registry and is updated on each read */
@@ -587,6 +598,7 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
   if (filter_env_hash != priv_gst_plugin_loading_get_whitelist_hash ()) {
     GST_INFO_OBJECT (registry, "Plugin loading filter environment changed, "
         "ignoring plugin cache to force update with new filter environment");
+    g_hash_table_remove_all (_priv_gst_registry_get_directories (registry));
     goto done;
   }
 
@@ -597,6 +609,10 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
     /* empty file, this is not an error */
   } else {
     gchar *end = contents + size;
+
+    /* from here on features might reference the contents */
+    keep = in_place;
+
     /* read as long as we still have space for a GstRegistryChunkPluginElement */
     for (;
         ((gsize) in + sizeof (GstRegistryChunkPluginElement)) <
@@ -604,7 +620,8 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
       GST_DEBUG ("reading binary registry %" G_GSIZE_FORMAT "(%x)/%"
           G_GSIZE_FORMAT, (gsize) in - (gsize) contents,
           (guint) ((gsize) in - (gsize) contents), size);
-      if (!_priv_gst_registry_chunks_load_plugin (registry, &in, end, NULL)) {
+      if (!_priv_gst_registry_chunks_load_plugin (registry, &in, end,
+              in_place, NULL)) {
         GST_ERROR ("Problem while reading binary registry %s", location);
         goto Error;
       }
@@ -621,16 +638,47 @@ done:
   GST_INFO ("loaded %s in %lf seconds", location, seconds);
 
   res = TRUE;
-  /* TODO: once we re-use the pointers to registry contents, return here */
 
 Error:
 #ifndef GST_DISABLE_GST_DEBUG
   g_timer_destroy (timer);
 #endif
-  if (mapped) {
+  /* the directories can't be trusted without all of their plugins */
+  if (!res)
+    g_hash_table_remove_all (_priv_gst_registry_get_directories (registry));
+
+  if (keep) {
+    GBytes *bytes;
+
+    if (mapped) {
+      bytes = g_mapped_file_get_bytes (mapped);
+      g_mapped_file_unref (mapped);
+    } else {
+      bytes = g_bytes_new_take (contents, size);
+    }
+
+    g_mutex_lock (&cache_contents_lock);
+    cache_contents = g_slist_prepend (cache_contents, bytes);
+    g_mutex_unlock (&cache_contents_lock);
+  } else if (mapped) {
     g_mapped_file_unref (mapped);
   } else {
     g_free (contents);
   }
   return res;
 }
+
+/* releases the contents of the loaded registry caches, must only be called
+ * after the features loaded from them are gone */
+void
+priv_gst_registry_binary_cleanup (void)
+{
+  GSList *contents;
+
+  g_mutex_lock (&cache_contents_lock);
+  contents = cache_contents;
+  cache_contents = NULL;
+  g_mutex_unlock (&cache_contents_lock);
+
+  g_slist_free_full (contents, (GDestroyNotify) g_bytes_unref);
+}
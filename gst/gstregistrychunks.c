@@ -288,8 +288,12 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     }
 
     /* pack element metadata strings */
-    gst_registry_chunks_save_string (list,
-        gst_structure_to_string (factory->metadata));
+    if (factory->metadata)
+      gst_registry_chunks_save_string (list,
+          gst_structure_to_string (factory->metadata));
+    else
+      gst_registry_chunks_save_const_string (list,
+          GST_STR_NULL (factory->metadata_string));
   } else if (GST_IS_TYPE_FIND_FACTORY (feature)) {
     GstRegistryChunkTypeFindFactory *tff;
     GstTypeFindFactory *factory = GST_TYPE_FIND_FACTORY (feature);
@@ -302,8 +306,16 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     pf_size = sizeof (GstRegistryChunkTypeFindFactory);
     chk = gst_registry_chunks_make_data (tff, pf_size);
     tff->nextensions = 0;
+    tff->nprefixes = 0;
     pf = (GstRegistryChunkPluginFeature *) tff;
 
+    /* save prefixes */
+    if (factory->prefixes) {
+      while (factory->prefixes[tff->nprefixes]) {
+        gst_registry_chunks_save_const_string (list,
+            factory->prefixes[tff->nprefixes++]);
+      }
+    }
     /* save extensions */
     if (factory->extensions) {
       while (factory->extensions[tff->nextensions]) {
@@ -322,6 +334,9 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
       gst_caps_unref (fcaps);
 
       gst_registry_chunks_save_string (list, str);
+    } else if (factory->caps_string) {
+      /* not parsed since it was loaded, and already simplified */
+      gst_registry_chunks_save_const_string (list, factory->caps_string);
     } else {
       gst_registry_chunks_save_const_string (list, "");
     }
@@ -340,8 +355,12 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
 
 
     /* pack element metadata strings */
-    gst_registry_chunks_save_string (list,
-        gst_structure_to_string (factory->metadata));
+    if (factory->metadata)
+      gst_registry_chunks_save_string (list,
+          gst_structure_to_string (factory->metadata));
+    else
+      gst_registry_chunks_save_const_string (list,
+          GST_STR_NULL (factory->metadata_string));
   } else if (GST_IS_TRACER_FACTORY (feature)) {
     /* Initialize with zeroes because of struct padding and
      * valgrind complaining about copying unitialized memory
@@ -499,13 +518,13 @@ fail:
  * gst_registry_chunks_load_pad_template:
  *
  * Make a new GstStaticPadTemplate from current GstRegistryChunkPadTemplate
- * structure.
+ * structure. With @in_place the caps string is used from the registry data.
  *
  * Returns: new GstStaticPadTemplate
  */
 static gboolean
 gst_registry_chunks_load_pad_template (GstElementFactory * factory, gchar ** in,
-    gchar * end)
+    gchar * end, gboolean in_place)
 {
   GstRegistryChunkPadTemplate *pt;
   GstStaticPadTemplate *template = NULL;
@@ -522,7 +541,10 @@ gst_registry_chunks_load_pad_template (GstElementFactory * factory, gchar ** in,
 
   /* unpack pad template strings */
   unpack_const_string (*in, template->name_template, end, fail);
-  unpack_const_string (*in, template->static_caps.string, end, fail);
+  if (in_place)
+    unpack_string_nocopy (*in, template->static_caps.string, end, fail);
+  else
+    unpack_const_string (*in, template->static_caps.string, end, fail);
 
   __gst_element_factory_add_static_pad_template (factory, template);
   GST_DEBUG ("Added pad_template %s", template->name_template);
@@ -538,13 +560,15 @@ fail:
 /*
  * gst_registry_chunks_load_feature:
  *
- * Make a new GstPluginFeature from current binary plugin feature structure
+ * Make a new GstPluginFeature from current binary plugin feature structure.
+ * With @in_place the metadata and caps strings are used from the registry
+ * data and only parsed when they are needed.
  *
  * Returns: new GstPluginFeature
  */
 static gboolean
 gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin * plugin)
+    gchar * end, GstPlugin * plugin, gboolean in_place)
 {
   GstRegistryChunkPluginFeature *pf = NULL;
   GstPluginFeature *feature = NULL;
@@ -602,7 +626,10 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
     /* unpack element factory strings */
     unpack_string_nocopy (*in, meta_data_str, end, fail);
-    if (meta_data_str && *meta_data_str) {
+    if (in_place) {
+      if (meta_data_str && *meta_data_str)
+        factory->metadata_string = meta_data_str;
+    } else if (meta_data_str && *meta_data_str) {
       factory->metadata = gst_structure_from_string (meta_data_str, NULL);
       if (!factory->metadata) {
         GST_ERROR
@@ -617,7 +644,7 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     /* load pad templates */
     for (i = 0; i < n; i++) {
       if (G_UNLIKELY (!gst_registry_chunks_load_pad_template (factory, in,
-                  end))) {
+                  end, in_place))) {
         GST_ERROR ("Error while loading binary pad template");
         goto fail;
       }
@@ -659,10 +686,12 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
     /* load typefinder caps */
     unpack_string_nocopy (*in, const_str, end, fail);
-    if (const_str != NULL && *const_str != '\0')
-      factory->caps = gst_caps_from_string (const_str);
-    else
+    if (const_str == NULL || *const_str == '\0')
       factory->caps = NULL;
+    else if (in_place)
+      factory->caps_string = const_str;
+    else
+      factory->caps = gst_caps_from_string (const_str);
 
     /* load extensions */
     if (tff->nextensions) {
@@ -675,6 +704,15 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
         factory->extensions[i - 1] = str;
       }
     }
+
+    /* load prefixes */
+    if (tff->nprefixes) {
+      factory->prefixes = g_new0 (gchar *, tff->nprefixes + 1);
+      for (i = tff->nprefixes; i > 0; i--) {
+        unpack_string (*in, str, end, fail);
+        factory->prefixes[i - 1] = str;
+      }
+    }
   } else if (GST_IS_DEVICE_PROVIDER_FACTORY (feature)) {
     GstRegistryChunkDeviceProviderFactory *dmf;
     GstDeviceProviderFactory *factory = GST_DEVICE_PROVIDER_FACTORY (feature);
@@ -691,7 +729,10 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
     /* unpack element factory strings */
     unpack_string_nocopy (*in, meta_data_str, end, fail);
-    if (meta_data_str && *meta_data_str) {
+    if (in_place) {
+      if (meta_data_str && *meta_data_str)
+        factory->metadata_string = meta_data_str;
+    } else if (meta_data_str && *meta_data_str) {
       factory->metadata = gst_structure_from_string (meta_data_str, NULL);
       if (!factory->metadata) {
         GST_ERROR
@@ -810,10 +851,13 @@ fail:
  * Make a new GstPlugin from current GstRegistryChunkPluginElement structure
  * and add it to the GstRegistry. Return an offset to the next
  * GstRegistryChunkPluginElement structure.
+ *
+ * With @in_place the data stays valid as long as the loaded features and
+ * larger strings are referenced instead of copied.
  */
 gboolean
 _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin ** out_plugin)
+    gchar * end, gboolean in_place, GstPlugin ** out_plugin)
 {
 #ifndef GST_DISABLE_GST_DEBUG
   gchar *start = *in;
@@ -880,7 +924,7 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
   /* Load plugin features */
   for (i = 0; i < n; i++) {
     if (G_UNLIKELY (!gst_registry_chunks_load_feature (registry, in, end,
-                plugin))) {
+                plugin, in_place))) {
       GST_ERROR ("Error while loading binary feature for plugin '%s'",
           GST_STR_NULL (plugin->desc.name));
       gst_registry_remove_plugin (registry, plugin);
@@ -915,16 +959,36 @@ _priv_gst_registry_chunks_save_global_header (GList ** list,
 {
   GstRegistryChunkGlobalHeader *hdr;
   GstRegistryChunk *chk;
+  GHashTable *dirs;
+  GHashTableIter iter;
+  gpointer key, value;
 
-  hdr = g_slice_new (GstRegistryChunkGlobalHeader);
+  hdr = g_slice_new0 (GstRegistryChunkGlobalHeader);
   chk = gst_registry_chunks_make_data (hdr,
       sizeof (GstRegistryChunkGlobalHeader));
 
   hdr->filter_env_hash = filter_env_hash;
 
+  /* pack the scanned directories, the header is prepended last so they end
+   * up after it */
+  dirs = _priv_gst_registry_get_directories (registry);
+  g_hash_table_iter_init (&iter, dirs);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    GstRegistryChunkDirectory *d;
+
+    d = g_slice_new0 (GstRegistryChunkDirectory);
+    d->mtime = *(gint64 *) value;
+
+    gst_registry_chunks_save_string (list, g_strdup ((gchar *) key));
+    *list = g_list_prepend (*list, gst_registry_chunks_make_data (d,
+            sizeof (GstRegistryChunkDirectory)));
+    hdr->n_dirs++;
+  }
+
   *list = g_list_prepend (*list, chk);
 
-  GST_LOG ("Saved global header (filter_env_hash=0x%08x)", filter_env_hash);
+  GST_LOG ("Saved global header (filter_env_hash=0x%08x, %u directories)",
+      filter_env_hash, hdr->n_dirs);
 }
 
 gboolean
@@ -932,11 +996,24 @@ _priv_gst_registry_chunks_load_global_header (GstRegistry * registry,
     gchar ** in, gchar * end, guint32 * filter_env_hash)
 {
   GstRegistryChunkGlobalHeader *hdr;
+  guint i;
 
   align (*in);
   GST_LOG ("Reading/casting for GstRegistryChunkGlobalHeader at %p", *in);
   unpack_element (*in, hdr, GstRegistryChunkGlobalHeader, end, fail);
   *filter_env_hash = hdr->filter_env_hash;
+
+  for (i = 0; i < hdr->n_dirs; i++) {
+    GstRegistryChunkDirectory *d;
+    const gchar *path;
+
+    align (*in);
+    unpack_element (*in, d, GstRegistryChunkDirectory, end, fail);
+    unpack_string_nocopy (*in, path, end, fail);
+
+    _priv_gst_registry_set_directory (registry, path, d->mtime);
+  }
+
   return TRUE;
 
   /* Errors */
@@ -50,11 +50,28 @@ typedef struct _GstRegistryChunk
   gboolean align;
 } GstRegistryChunk;
 
+/*
+ * GstRegistryChunkGlobalHeader:
+ *
+ * @n_dirs: Says how many directory structures follow.
+ */
 typedef struct _GstRegistryChunkGlobalHeader
 {
   guint32  filter_env_hash;
+  guint32  n_dirs;
 } GstRegistryChunkGlobalHeader;
 
+/*
+ * GstRegistryChunkDirectory:
+ *
+ * A scanned plugin directory and its modification time, followed by the
+ * path string. An mtime of -1 means the directory has to be read again.
+ */
+typedef struct _GstRegistryChunkDirectory
+{
+  gint64  mtime;
+} GstRegistryChunkDirectory;
+
 /*
  * GstRegistryChunkPluginElement:
  *
@@ -121,6 +138,7 @@ typedef struct _GstRegistryChunkElementFactory
 /*
  * GstRegistryChunkTypeFindFactory:
  * @nextensions: stores the number of typefind extensions
+ * @nprefixes: stores the number of typefind prefixes
  *
  * A structure containing the type find factory fields
  */
@@ -129,6 +147,7 @@ typedef struct _GstRegistryChunkTypeFindFactory
   GstRegistryChunkPluginFeature plugin_feature;
 
   guint nextensions;
+  guint nprefixes;
 } GstRegistryChunkTypeFindFactory;
 
 /*
@@ -173,7 +192,7 @@ _priv_gst_registry_chunks_save_plugin (GList ** list, GstRegistry * registry,
 
 gboolean
 _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar *end, GstPlugin **out_plugin);
+    gchar *end, gboolean in_place, GstPlugin **out_plugin);
 
 void
 _priv_gst_registry_chunks_save_global_header (GList ** list,
@@ -27,6 +27,11 @@
  *
  * A #GstSample is a small object containing data, a type, timing and
  * extra arbitrary information.
+ *
+ * Samples are allocated from per-thread free-lists. A consumer that pulls
+ * many samples can also keep one writable sample around and update it with
+ * gst_sample_set_buffer() and friends, setting the same caps again then
+ * doesn't change any refcount.
  */
 #include "gst_private.h"
 
@@ -55,6 +60,9 @@ _priv_gst_sample_initialize (void)
 {
   _gst_sample_type = gst_sample_get_type ();
 
+  _priv_gst_free_list_set_block_size (GST_FREE_LIST_SAMPLE,
+      sizeof (GstSample));
+
   GST_DEBUG_CATEGORY_INIT (gst_sample_debug, "sample", 0, "GstSample debug");
 }
 
@@ -89,7 +97,7 @@ _gst_sample_free (GstSample * sample)
   if (sample->buffer_list)
     gst_mini_object_unref (GST_MINI_OBJECT_CAST (sample->buffer_list));
 
-  g_slice_free1 (sizeof (GstSample), sample);
+  _priv_gst_free_list_free (GST_FREE_LIST_SAMPLE, sample);
 }
 
 /**
@@ -112,7 +120,7 @@ gst_sample_new (GstBuffer * buffer, GstCaps * caps, const GstSegment * segment,
 {
   GstSample *sample;
 
-  sample = g_slice_new0 (GstSample);
+  sample = _priv_gst_free_list_alloc (GST_FREE_LIST_SAMPLE);
 
   GST_LOG ("new %p", sample);
 
@@ -122,6 +130,8 @@ gst_sample_new (GstBuffer * buffer, GstCaps * caps, const GstSegment * segment,
 
   sample->buffer = buffer ? gst_buffer_ref (buffer) : NULL;
   sample->caps = caps ? gst_caps_ref (caps) : NULL;
+  sample->info = NULL;
+  sample->buffer_list = NULL;
 
   if (segment)
     gst_segment_copy_into (segment, &sample->segment);
@@ -260,3 +270,104 @@ gst_sample_set_buffer_list (GstSample * sample, GstBufferList * buffer_list)
   if (old)
     gst_mini_object_unref (GST_MINI_OBJECT_CAST (old));
 }
+
+/**
+ * gst_sample_set_buffer:
+ * @sample: a writable #GstSample
+ * @buffer: (transfer none) (allow-none): a #GstBuffer, or %NULL
+ *
+ * Set the buffer associated with @sample. @sample must be writable.
+ *
+ * Since: 1.14
+ */
+void
+gst_sample_set_buffer (GstSample * sample, GstBuffer * buffer)
+{
+  g_return_if_fail (GST_IS_SAMPLE (sample));
+  g_return_if_fail (gst_sample_is_writable (sample));
+
+  gst_buffer_replace (&sample->buffer, buffer);
+}
+
+/**
+ * gst_sample_set_caps:
+ * @sample: a writable #GstSample
+ * @caps: (transfer none) (allow-none): a #GstCaps, or %NULL
+ *
+ * Set the caps associated with @sample. @sample must be writable. Nothing
+ * is done when @caps are already the caps of @sample.
+ *
+ * Since: 1.14
+ */
+void
+gst_sample_set_caps (GstSample * sample, GstCaps * caps)
+{
+  g_return_if_fail (GST_IS_SAMPLE (sample));
+  g_return_if_fail (gst_sample_is_writable (sample));
+
+  gst_caps_replace (&sample->caps, caps);
+}
+
+/**
+ * gst_sample_set_segment:
+ * @sample: a writable #GstSample
+ * @segment: (transfer none) (allow-none): a #GstSegment, or %NULL
+ *
+ * Set the segment associated with @sample. @sample must be writable. A
+ * %NULL @segment resets the segment of @sample to an empty
+ * %GST_FORMAT_TIME segment.
+ *
+ * Since: 1.14
+ */
+void
+gst_sample_set_segment (GstSample * sample, const GstSegment * segment)
+{
+  g_return_if_fail (GST_IS_SAMPLE (sample));
+  g_return_if_fail (gst_sample_is_writable (sample));
+
+  if (segment)
+    gst_segment_copy_into (segment, &sample->segment);
+  else
+    gst_segment_init (&sample->segment, GST_FORMAT_TIME);
+}
+
+/**
+ * gst_sample_set_info:
+ * @sample: a writable #GstSample
+ * @info: (transfer full) (allow-none): a #GstStructure, or %NULL
+ *
+ * Set the info structure associated with @sample. @sample must be writable,
+ * and @info must not have a parent set already.
+ *
+ * Returns: %TRUE if @info was set, %FALSE if it already had a parent.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_sample_set_info (GstSample * sample, GstStructure * info)
+{
+  g_return_val_if_fail (GST_IS_SAMPLE (sample), FALSE);
+  g_return_val_if_fail (gst_sample_is_writable (sample), FALSE);
+
+  if (info) {
+    if (!gst_structure_set_parent_refcount (info,
+            &sample->mini_object.refcount))
+      goto had_parent;
+  }
+
+  if (sample->info) {
+    gst_structure_set_parent_refcount (sample->info, NULL);
+    gst_structure_free (sample->info);
+  }
+
+  sample->info = info;
+
+  return TRUE;
+
+  /* ERRORS */
+had_parent:
+  {
+    g_warning ("structure is already owned by another object");
+    return FALSE;
+  }
+}
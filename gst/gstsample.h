@@ -75,6 +75,18 @@ GstBufferList *      gst_sample_get_buffer_list (GstSample *sample);
 GST_EXPORT
 void                 gst_sample_set_buffer_list (GstSample *sample, GstBufferList *buffer_list);
 
+GST_EXPORT
+void                 gst_sample_set_buffer    (GstSample *sample, GstBuffer *buffer);
+
+GST_EXPORT
+void                 gst_sample_set_caps      (GstSample *sample, GstCaps *caps);
+
+GST_EXPORT
+void                 gst_sample_set_segment   (GstSample *sample, const GstSegment *segment);
+
+GST_EXPORT
+gboolean             gst_sample_set_info      (GstSample *sample, GstStructure *info);
+
 /* refcounting */
 /**
  * gst_sample_ref:
@@ -122,6 +134,31 @@ gst_sample_copy (const GstSample * buf)
   return GST_SAMPLE_CAST (gst_mini_object_copy (GST_MINI_OBJECT_CONST_CAST (buf)));
 }
 
+/**
+ * gst_sample_is_writable:
+ * @sample: a #GstSample
+ *
+ * Tests if you can safely set the buffer, caps, segment and info of
+ * @sample.
+ *
+ * Since: 1.14
+ */
+#define         gst_sample_is_writable(sample)     gst_mini_object_is_writable (GST_MINI_OBJECT_CAST (sample))
+
+/**
+ * gst_sample_make_writable:
+ * @sample: (transfer full): a #GstSample
+ *
+ * Returns a writable copy of @sample. If the source sample is already
+ * writable, this will simply return the same sample.
+ *
+ * Returns: (transfer full): a writable sample which may or may not be the
+ *     same as @sample
+ *
+ * Since: 1.14
+ */
+#define         gst_sample_make_writable(sample)   GST_SAMPLE_CAST (gst_mini_object_make_writable (GST_MINI_OBJECT_CAST (sample)))
+
 /**
  * gst_value_set_sample:
  * @v: a #GValue to receive the data
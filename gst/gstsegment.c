@@ -849,6 +849,174 @@ gst_segment_to_running_time (const GstSegment * segment, GstFormat format,
   return -1;
 }
 
+/**
+ * gst_segment_to_running_time_n:
+ * @segment: a #GstSegment structure.
+ * @format: the format of the segment.
+ * @positions: (array length=n): the positions in the segment
+ * @running_times: (array length=n) (out caller-allocates): the resulting
+ *     running times
+ * @n: the number of positions
+ *
+ * Translate the @n values in @positions to running time like
+ * gst_segment_to_running_time() does for each of them, and store the results
+ * in @running_times. The segment values are looked up only once for all
+ * positions, which makes this cheaper than converting them one by one, e.g.
+ * for the buffers of a #GstBufferList. @positions and @running_times can
+ * be the same array.
+ *
+ * A value in @running_times is -1 when the position was outside of @segment
+ * or invalid.
+ *
+ * Since: 1.14
+ */
+void
+gst_segment_to_running_time_n (const GstSegment * segment, GstFormat format,
+    const guint64 * positions, guint64 * running_times, guint n)
+{
+  guint64 start, stop, base, offset;
+  gdouble abs_rate;
+  gboolean forward;
+  guint i;
+
+  g_return_if_fail (segment != NULL);
+  g_return_if_fail (positions != NULL || n == 0);
+  g_return_if_fail (running_times != NULL || n == 0);
+
+  if (G_UNLIKELY (segment->format != format))
+    goto invalid;
+
+  start = segment->start;
+  stop = segment->stop;
+  base = segment->base;
+  offset = segment->offset;
+  forward = segment->rate > 0.0;
+  abs_rate = ABS (segment->rate);
+
+  /* the point in the segment where the running time is base */
+  if (G_LIKELY (forward)) {
+    offset += start;
+  } else {
+    /* cannot continue if no stop position set or invalid offset */
+    if (G_UNLIKELY (stop == -1 || stop < offset))
+      goto invalid;
+    offset = stop - offset;
+  }
+
+  for (i = 0; i < n; i++) {
+    guint64 position = positions[i], result;
+    gboolean negative;
+
+    /* outside of the segment boundaries */
+    if (G_UNLIKELY (position == -1 || position < start ||
+            (stop != -1 && position > stop))) {
+      running_times[i] = -1;
+      continue;
+    }
+
+    /* bring to uncorrected position in segment */
+    if (G_LIKELY (forward)) {
+      negative = position < offset;
+      result = negative ? offset - position : position - offset;
+    } else {
+      negative = position > offset;
+      result = negative ? position - offset : offset - position;
+    }
+
+    /* scale based on the rate, avoid division by and conversion to
+     * float when not needed */
+    if (G_UNLIKELY (abs_rate != 1.0))
+      result /= abs_rate;
+
+    /* correct for base of the segment */
+    if (G_LIKELY (!negative))
+      running_times[i] = result + base;
+    else if (base >= result)
+      running_times[i] = base - result;
+    else
+      running_times[i] = -1;
+  }
+  return;
+
+invalid:
+  {
+    GST_DEBUG ("invalid segment or format");
+    for (i = 0; i < n; i++)
+      running_times[i] = -1;
+  }
+}
+
+/**
+ * gst_segment_to_stream_time_n:
+ * @segment: a #GstSegment structure.
+ * @format: the format of the segment.
+ * @positions: (array length=n): the positions in the segment
+ * @stream_times: (array length=n) (out caller-allocates): the resulting
+ *     stream times
+ * @n: the number of positions
+ *
+ * Translate the @n values in @positions to stream time like
+ * gst_segment_to_stream_time() does for each of them, and store the results
+ * in @stream_times. @positions and @stream_times can be the same array.
+ *
+ * A value in @stream_times is -1 when the position was outside of @segment
+ * or invalid.
+ *
+ * Since: 1.14
+ */
+void
+gst_segment_to_stream_time_n (const GstSegment * segment, GstFormat format,
+    const guint64 * positions, guint64 * stream_times, guint n)
+{
+  guint64 start, stop, time;
+  gdouble abs_applied_rate;
+  gboolean forward;
+  guint i;
+
+  g_return_if_fail (segment != NULL);
+  g_return_if_fail (positions != NULL || n == 0);
+  g_return_if_fail (stream_times != NULL || n == 0);
+
+  if (G_UNLIKELY (segment->format != format))
+    goto invalid;
+
+  start = segment->start;
+  stop = segment->stop;
+  time = segment->time;
+  forward = segment->applied_rate > 0.0;
+  abs_applied_rate = ABS (segment->applied_rate);
+
+  /* time must be known, and the stop for a negative applied rate */
+  if (G_UNLIKELY (time == -1 || (!forward && stop == -1)))
+    goto invalid;
+
+  for (i = 0; i < n; i++) {
+    guint64 position = positions[i], result;
+
+    /* outside of the segment boundaries */
+    if (G_UNLIKELY (position == -1 || position < start ||
+            (stop != -1 && position > stop))) {
+      stream_times[i] = -1;
+      continue;
+    }
+
+    /* streams with a negative applied_rate have the time member starting
+     * high and going backwards */
+    result = forward ? position - start : stop - position;
+    if (G_UNLIKELY (abs_applied_rate != 1.0))
+      result *= abs_applied_rate;
+    stream_times[i] = result + time;
+  }
+  return;
+
+invalid:
+  {
+    GST_DEBUG ("invalid segment or format");
+    for (i = 0; i < n; i++)
+      stream_times[i] = -1;
+  }
+}
+
 /**
  * gst_segment_clip:
  * @segment: a #GstSegment structure.
@@ -246,6 +246,14 @@ GST_EXPORT
 gint         gst_segment_to_running_time_full (const GstSegment *segment, GstFormat format, guint64 position,
                                                guint64 * running_time);
 
+GST_EXPORT
+void         gst_segment_to_running_time_n   (const GstSegment *segment, GstFormat format,
+                                              const guint64 *positions, guint64 *running_times, guint n);
+
+GST_EXPORT
+void         gst_segment_to_stream_time_n    (const GstSegment *segment, GstFormat format,
+                                              const guint64 *positions, guint64 *stream_times, guint n);
+
 GST_DEPRECATED_FOR(gst_segment_position_from_running_time)
 guint64      gst_segment_to_position         (const GstSegment *segment, GstFormat format, guint64 running_time);
 
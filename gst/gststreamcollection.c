@@ -46,9 +46,11 @@ GST_DEBUG_CATEGORY_STATIC (stream_collection_debug);
 
 struct _GstStreamCollectionPrivate
 {
-  /* Maybe switch this to a GArray if performance is
-   * ever an issue? */
-  GQueue *streams;
+  GPtrArray *streams;
+
+  /* stream-id to the first #GstStream with that id, the keys are owned by
+   * the streams */
+  GHashTable *streams_by_id;
 };
 
 /* stream signals and properties */
@@ -137,7 +139,8 @@ static void
 gst_stream_collection_init (GstStreamCollection * collection)
 {
   collection->priv = GST_STREAM_COLLECTION_GET_PRIVATE (collection);
-  collection->priv->streams = g_queue_new ();
+  collection->priv->streams = g_ptr_array_new ();
+  collection->priv->streams_by_id = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static void
@@ -158,10 +161,13 @@ gst_stream_collection_dispose (GObject * object)
     collection->upstream_id = NULL;
   }
 
+  if (collection->priv->streams_by_id)
+    g_hash_table_remove_all (collection->priv->streams_by_id);
+
   if (collection->priv->streams) {
-    g_queue_foreach (collection->priv->streams,
+    g_ptr_array_foreach (collection->priv->streams,
         (GFunc) release_gst_stream, collection);
-    g_queue_clear (collection->priv->streams);
+    g_ptr_array_set_size (collection->priv->streams, 0);
   }
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -173,7 +179,9 @@ gst_stream_collection_finalize (GObject * object)
   GstStreamCollection *collection = GST_STREAM_COLLECTION_CAST (object);
 
   if (collection->priv->streams)
-    g_queue_free (collection->priv->streams);
+    g_ptr_array_free (collection->priv->streams, TRUE);
+  if (collection->priv->streams_by_id)
+    g_hash_table_destroy (collection->priv->streams_by_id);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -307,7 +315,11 @@ gst_stream_collection_add_stream (GstStreamCollection * collection,
 
   GST_DEBUG_OBJECT (collection, "Adding stream %" GST_PTR_FORMAT, stream);
 
-  g_queue_push_tail (collection->priv->streams, stream);
+  g_ptr_array_add (collection->priv->streams, stream);
+  if (stream->stream_id && !g_hash_table_contains
+      (collection->priv->streams_by_id, stream->stream_id))
+    g_hash_table_insert (collection->priv->streams_by_id,
+        (gpointer) stream->stream_id, stream);
   g_signal_connect (stream, "notify", (GCallback) proxy_stream_notify_cb,
       collection);
 
@@ -330,7 +342,7 @@ gst_stream_collection_get_size (GstStreamCollection * collection)
   g_return_val_if_fail (GST_IS_STREAM_COLLECTION (collection), 0);
   g_return_val_if_fail (collection->priv->streams, 0);
 
-  return g_queue_get_length (collection->priv->streams);
+  return collection->priv->streams->len;
 }
 
 /**
@@ -352,5 +364,35 @@ gst_stream_collection_get_stream (GstStreamCollection * collection, guint index)
   g_return_val_if_fail (GST_IS_STREAM_COLLECTION (collection), NULL);
   g_return_val_if_fail (collection->priv->streams, NULL);
 
-  return g_queue_peek_nth (collection->priv->streams, index);
+  if (index >= collection->priv->streams->len)
+    return NULL;
+
+  return g_ptr_array_index (collection->priv->streams, index);
+}
+
+/**
+ * gst_stream_collection_find_stream:
+ * @collection: a #GstStreamCollection
+ * @stream_id: the stream-id of the stream to retrieve
+ *
+ * Retrieve the #GstStream with stream-id @stream_id from the collection.
+ * When several streams have the same stream-id, the first one added is
+ * returned.
+ *
+ * The caller should not modify the returned #GstStream
+ *
+ * Returns: (transfer none) (nullable): A #GstStream or %NULL when the
+ * collection has no stream with @stream_id.
+ *
+ * Since: 1.14
+ */
+GstStream *
+gst_stream_collection_find_stream (GstStreamCollection * collection,
+    const gchar * stream_id)
+{
+  g_return_val_if_fail (GST_IS_STREAM_COLLECTION (collection), NULL);
+  g_return_val_if_fail (stream_id != NULL, NULL);
+  g_return_val_if_fail (collection->priv->streams_by_id, NULL);
+
+  return g_hash_table_lookup (collection->priv->streams_by_id, stream_id);
 }
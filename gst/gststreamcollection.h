@@ -108,6 +108,10 @@ guint gst_stream_collection_get_size (GstStreamCollection *collection);
 GST_EXPORT
 GstStream *gst_stream_collection_get_stream (GstStreamCollection *collection, guint index);
 
+GST_EXPORT
+GstStream *gst_stream_collection_find_stream (GstStreamCollection *collection,
+                                              const gchar *stream_id);
+
 GST_EXPORT
 gboolean gst_stream_collection_add_stream (GstStreamCollection *collection,
                                            GstStream *stream);
@@ -95,10 +95,21 @@ typedef struct
   gint *parent_refcount;
 
   GArray *fields;
+
+  /* hash index from field name to position in fields, only for structures
+   * with many fields, NULL otherwise. The index is maintained when fields are
+   * added or removed so that lookups never modify the structure. */
+  guint *index;
+  guint index_mask;
 } GstStructureImpl;
 
 #define GST_STRUCTURE_REFCOUNT(s) (((GstStructureImpl*)(s))->parent_refcount)
 #define GST_STRUCTURE_FIELDS(s) (((GstStructureImpl*)(s))->fields)
+#define GST_STRUCTURE_INDEX(s) (((GstStructureImpl*)(s))->index)
+#define GST_STRUCTURE_INDEX_MASK(s) (((GstStructureImpl*)(s))->index_mask)
+
+/* structures with more fields than this get a hash index */
+#define GST_STRUCTURE_INDEX_MIN_FIELDS 8
 
 #define GST_STRUCTURE_FIELD(structure, index) \
     &g_array_index(GST_STRUCTURE_FIELDS(structure), GstStructureField, (index))
@@ -110,6 +121,8 @@ typedef struct
 #define IS_TAGLIST(structure) \
     (structure->name == GST_QUARK (TAGLIST))
 
+static void gst_structure_index_update (GstStructure * structure);
+static void gst_structure_index_rebuild (GstStructure * structure);
 static void gst_structure_set_field (GstStructure * structure,
     GstStructureField * field);
 static GstStructureField *gst_structure_get_field (const GstStructure *
@@ -150,6 +163,8 @@ gst_structure_new_id_empty_with_size (GQuark quark, guint prealloc)
   GST_STRUCTURE_REFCOUNT (structure) = NULL;
   GST_STRUCTURE_FIELDS (structure) =
       g_array_sized_new (FALSE, FALSE, sizeof (GstStructureField), prealloc);
+  GST_STRUCTURE_INDEX (structure) = NULL;
+  GST_STRUCTURE_INDEX_MASK (structure) = 0;
 
   GST_TRACE ("created structure %p", structure);
 
@@ -174,7 +189,7 @@ gst_structure_new_id_empty (GQuark quark)
   return gst_structure_new_id_empty_with_size (quark, 0);
 }
 
-#ifndef G_DISABLE_CHECKS
+/* also used to check the names in binary data, so always compiled in */
 static gboolean
 gst_structure_validate_name (const gchar * name)
 {
@@ -208,7 +223,6 @@ gst_structure_validate_name (const gchar * name)
 
   return TRUE;
 }
-#endif
 
 /**
  * gst_structure_new_empty:
@@ -227,7 +241,8 @@ gst_structure_new_empty (const gchar * name)
 {
   g_return_val_if_fail (gst_structure_validate_name (name), NULL);
 
-  return gst_structure_new_id_empty_with_size (g_quark_from_string (name), 0);
+  return gst_structure_new_id_empty_with_size (_priv_gst_quark_from_string
+      (name), 0);
 }
 
 /**
@@ -355,6 +370,7 @@ gst_structure_copy (const GstStructure * structure)
     gst_value_init_and_copy (&new_field.value, &field->value);
     g_array_append_val (GST_STRUCTURE_FIELDS (new_structure), new_field);
   }
+  gst_structure_index_rebuild (new_structure);
   GST_CAT_TRACE (GST_CAT_PERFORMANCE, "doing copy %p -> %p",
       structure, new_structure);
 
@@ -386,6 +402,7 @@ gst_structure_free (GstStructure * structure)
     }
   }
   g_array_free (GST_STRUCTURE_FIELDS (structure), TRUE);
+  g_free (GST_STRUCTURE_INDEX (structure));
 #ifdef USE_POISONING
   memset (structure, 0xff, sizeof (GstStructure));
 #endif
@@ -467,7 +484,7 @@ gst_structure_set_name (GstStructure * structure, const gchar * name)
   g_return_if_fail (IS_MUTABLE (structure));
   g_return_if_fail (gst_structure_validate_name (name));
 
-  structure->name = g_quark_from_string (name);
+  structure->name = _priv_gst_quark_from_string (name);
 }
 
 static inline void
@@ -524,7 +541,7 @@ gst_structure_set_value (GstStructure * structure,
   g_return_if_fail (IS_MUTABLE (structure));
 
   gst_structure_id_set_value_internal (structure,
-      g_quark_from_string (fieldname), value);
+      _priv_gst_quark_from_string (fieldname), value);
 }
 
 static inline void
@@ -587,7 +604,7 @@ gst_structure_take_value (GstStructure * structure, const gchar * fieldname,
   g_return_if_fail (IS_MUTABLE (structure));
 
   gst_structure_id_take_value_internal (structure,
-      g_quark_from_string (fieldname), value);
+      _priv_gst_quark_from_string (fieldname), value);
 }
 
 static void
@@ -600,7 +617,7 @@ gst_structure_set_valist_internal (GstStructure * structure,
   while (fieldname) {
     GstStructureField field = { 0 };
 
-    field.name = g_quark_from_string (fieldname);
+    field.name = _priv_gst_quark_from_string (fieldname);
 
     type = va_arg (varargs, GType);
 
@@ -773,9 +790,6 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
 {
   GstStructureField *f;
   GType field_value_type;
-  guint i, len;
-
-  len = GST_STRUCTURE_FIELDS (structure)->len;
 
   field_value_type = G_VALUE_TYPE (&field->value);
   if (field_value_type == G_TYPE_STRING) {
@@ -826,17 +840,75 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
     }
   }
 
-  for (i = 0; i < len; i++) {
-    f = GST_STRUCTURE_FIELD (structure, i);
-
-    if (G_UNLIKELY (f->name == field->name)) {
-      g_value_unset (&f->value);
-      memcpy (f, field, sizeof (GstStructureField));
-      return;
-    }
+  f = gst_structure_id_get_field (structure, field->name);
+  if (G_UNLIKELY (f != NULL)) {
+    g_value_unset (&f->value);
+    memcpy (f, field, sizeof (GstStructureField));
+    return;
   }
 
   g_array_append_val (GST_STRUCTURE_FIELDS (structure), *field);
+  gst_structure_index_update (structure);
+}
+
+/* insert the field at @pos in the index, which must have a free slot */
+static void
+gst_structure_index_insert (GstStructure * structure, guint pos)
+{
+  guint *index = GST_STRUCTURE_INDEX (structure);
+  guint mask = GST_STRUCTURE_INDEX_MASK (structure);
+  guint slot;
+
+  /* quarks are small consecutive numbers, they are good enough as hash */
+  slot = GST_STRUCTURE_FIELD (structure, pos)->name & mask;
+  while (index[slot] != 0)
+    slot = (slot + 1) & mask;
+
+  /* 0 marks free slots */
+  index[slot] = pos + 1;
+}
+
+/* recreate the index for the current fields, or remove it when the
+ * structure has only few fields */
+static void
+gst_structure_index_rebuild (GstStructure * structure)
+{
+  guint i, len, size;
+
+  g_free (GST_STRUCTURE_INDEX (structure));
+  GST_STRUCTURE_INDEX (structure) = NULL;
+  GST_STRUCTURE_INDEX_MASK (structure) = 0;
+
+  len = GST_STRUCTURE_FIELDS (structure)->len;
+  if (len <= GST_STRUCTURE_INDEX_MIN_FIELDS)
+    return;
+
+  /* keep the index at most half full */
+  size = 1;
+  while (size < 4 * len)
+    size <<= 1;
+
+  GST_STRUCTURE_INDEX (structure) = g_new0 (guint, size);
+  GST_STRUCTURE_INDEX_MASK (structure) = size - 1;
+
+  for (i = 0; i < len; i++)
+    gst_structure_index_insert (structure, i);
+}
+
+/* update the index after a field was appended */
+static void
+gst_structure_index_update (GstStructure * structure)
+{
+  guint len = GST_STRUCTURE_FIELDS (structure)->len;
+
+  if (len <= GST_STRUCTURE_INDEX_MIN_FIELDS)
+    return;
+
+  if (GST_STRUCTURE_INDEX (structure) == NULL ||
+      2 * len > GST_STRUCTURE_INDEX_MASK (structure) + 1)
+    gst_structure_index_rebuild (structure);
+  else
+    gst_structure_index_insert (structure, len - 1);
 }
 
 /* If there is no field with the given ID, NULL is returned.
@@ -845,8 +917,23 @@ static GstStructureField *
 gst_structure_id_get_field (const GstStructure * structure, GQuark field_id)
 {
   GstStructureField *field;
+  const guint *index;
   guint i, len;
 
+  index = GST_STRUCTURE_INDEX (structure);
+  if (index != NULL) {
+    guint mask = GST_STRUCTURE_INDEX_MASK (structure);
+    guint slot = field_id & mask;
+
+    while ((i = index[slot]) != 0) {
+      field = GST_STRUCTURE_FIELD (structure, i - 1);
+      if (field->name == field_id)
+        return field;
+      slot = (slot + 1) & mask;
+    }
+    return NULL;
+  }
+
   len = GST_STRUCTURE_FIELDS (structure)->len;
 
   for (i = 0; i < len; i++) {
@@ -869,7 +956,7 @@ gst_structure_get_field (const GstStructure * structure,
   g_return_val_if_fail (fieldname != NULL, NULL);
 
   return gst_structure_id_get_field (structure,
-      g_quark_from_string (fieldname));
+      _priv_gst_quark_from_string (fieldname));
 }
 
 /**
@@ -940,7 +1027,7 @@ gst_structure_remove_field (GstStructure * structure, const gchar * fieldname)
   g_return_if_fail (fieldname != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
 
-  id = g_quark_from_string (fieldname);
+  id = _priv_gst_quark_from_string (fieldname);
   len = GST_STRUCTURE_FIELDS (structure)->len;
 
   for (i = 0; i < len; i++) {
@@ -952,6 +1039,7 @@ gst_structure_remove_field (GstStructure * structure, const gchar * fieldname)
       }
       GST_STRUCTURE_FIELDS (structure) =
           g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
+      gst_structure_index_rebuild (structure);
       return;
     }
   }
@@ -1029,6 +1117,7 @@ gst_structure_remove_all_fields (GstStructure * structure)
     GST_STRUCTURE_FIELDS (structure) =
         g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
   }
+  gst_structure_index_rebuild (structure);
 }
 
 /**
@@ -1213,6 +1302,7 @@ gst_structure_filter_and_map_in_place (GstStructure * structure,
       i++;
     }
   }
+  gst_structure_index_rebuild (structure);
 }
 
 /**
@@ -1254,7 +1344,7 @@ gst_structure_has_field (const GstStructure * structure,
   g_return_val_if_fail (fieldname != NULL, FALSE);
 
   return gst_structure_id_has_field (structure,
-      g_quark_from_string (fieldname));
+      _priv_gst_quark_from_string (fieldname));
 }
 
 /**
@@ -1301,7 +1391,7 @@ gst_structure_has_field_typed (const GstStructure * structure,
   g_return_val_if_fail (fieldname != NULL, FALSE);
 
   return gst_structure_id_has_field_typed (structure,
-      g_quark_from_string (fieldname), type);
+      _priv_gst_quark_from_string (fieldname), type);
 }
 
 /* utility functions */
@@ -1959,7 +2049,7 @@ gst_structure_parse_field (gchar * str,
 
   c = *name_end;
   *name_end = '\0';
-  field->name = g_quark_from_string (name);
+  field->name = _priv_gst_quark_from_string (name);
   GST_DEBUG ("trying field name '%s'", name);
   *name_end = c;
 
@@ -2129,6 +2219,196 @@ error:
   return NULL;
 }
 
+gboolean
+_priv_gst_structure_write_binary (GByteArray * array,
+    const GstStructure * structure)
+{
+  GstStructureField *field;
+  guint i, len;
+
+  len = GST_STRUCTURE_FIELDS (structure)->len;
+
+  _priv_gst_binary_write_string (array, g_quark_to_string (structure->name));
+  _priv_gst_binary_write_uint32 (array, len);
+
+  for (i = 0; i < len; i++) {
+    field = GST_STRUCTURE_FIELD (structure, i);
+
+    _priv_gst_binary_write_string (array, g_quark_to_string (field->name));
+    if (!_priv_gst_value_write_binary (array, &field->value))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static gboolean
+structure_has_field_of (GQuark field_id, const GValue * value,
+    gpointer user_data)
+{
+  const GstStructure *structure = user_data;
+  const GValue *v;
+
+  v = gst_structure_id_get_value (structure, field_id);
+  if (v == NULL || G_VALUE_TYPE (v) != G_VALUE_TYPE (value))
+    return FALSE;
+
+  /* the parse functions return boxed values and objects without checking,
+   * they must be there when the reference has them */
+  if ((G_VALUE_HOLDS_BOXED (value) || G_VALUE_HOLDS_OBJECT (value)) &&
+      g_value_peek_pointer (value) != NULL && g_value_peek_pointer (v) == NULL)
+    return FALSE;
+
+  return TRUE;
+}
+
+/* check that @structure, read from binary data, has every field of
+ * @reference with the same type. Used for the structures of events and
+ * queries, whose parse functions don't check their fields */
+gboolean
+_priv_gst_structure_has_fields_of (const GstStructure * structure,
+    const GstStructure * reference)
+{
+  if (structure == NULL)
+    return reference == NULL;
+  if (reference == NULL)
+    return TRUE;
+
+  return gst_structure_foreach (reference, structure_has_field_of,
+      (gpointer) structure);
+}
+
+GstStructure *
+_priv_gst_structure_read_binary (GstBinaryReader * reader)
+{
+  GstStructure *structure = NULL;
+  gchar *name = NULL;
+  guint32 i, len;
+
+  if (!_priv_gst_binary_read_string (reader, &name) || name == NULL ||
+      !gst_structure_validate_name (name) ||
+      !_priv_gst_binary_read_uint32 (reader, &len))
+    goto error;
+
+  /* every field needs at least 5 bytes */
+  if (len > (reader->size - reader->offset) / 5)
+    goto error;
+
+  structure =
+      gst_structure_new_id_empty_with_size (_priv_gst_quark_from_string
+      (name), len);
+  g_free (name);
+  name = NULL;
+
+  for (i = 0; i < len; i++) {
+    GValue value = G_VALUE_INIT;
+
+    if (!_priv_gst_binary_read_string (reader, &name) || name == NULL ||
+        !gst_structure_validate_name (name))
+      goto error;
+
+    if (!_priv_gst_value_read_binary (reader, &value)) {
+      if (G_IS_VALUE (&value))
+        g_value_unset (&value);
+      goto error;
+    }
+
+    gst_structure_id_take_value (structure,
+        _priv_gst_quark_from_string (name), &value);
+    g_free (name);
+    name = NULL;
+  }
+
+  return structure;
+
+  /* ERRORS */
+error:
+  {
+    GST_WARNING ("invalid structure in binary data");
+    if (structure)
+      gst_structure_free (structure);
+    g_free (name);
+    return NULL;
+  }
+}
+
+/**
+ * gst_structure_to_binary:
+ * @structure: a #GstStructure
+ * @size: (out): the size of the returned data
+ *
+ * Serializes @structure into a compact binary representation that can be
+ * turned back into a #GstStructure with gst_structure_from_binary(), also in
+ * another process. This is faster than gst_structure_to_string() as values of
+ * the common types are stored directly without converting them to strings.
+ *
+ * The data contains a version of the format and is only meant to be read
+ * back by the same or newer versions of GStreamer.
+ *
+ * Free-function: g_free
+ *
+ * Returns: (transfer full) (array length=size) (nullable): the binary
+ *     representation of @structure or %NULL if one of the values can't
+ *     be serialized.
+ *
+ * Since: 1.14
+ */
+guint8 *
+gst_structure_to_binary (const GstStructure * structure, gsize * size)
+{
+  GByteArray *array;
+
+  g_return_val_if_fail (structure != NULL, NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  array = g_byte_array_new ();
+  _priv_gst_binary_write_header (array, GST_BINARY_KIND_STRUCTURE);
+  if (!_priv_gst_structure_write_binary (array, structure)) {
+    g_byte_array_free (array, TRUE);
+    *size = 0;
+    return NULL;
+  }
+
+  *size = array->len;
+  return g_byte_array_free (array, FALSE);
+}
+
+/**
+ * gst_structure_from_binary:
+ * @data: (array length=size): data created with gst_structure_to_binary()
+ * @size: the size of @data
+ *
+ * Creates a #GstStructure from its binary representation created with
+ * gst_structure_to_binary().
+ *
+ * Free-function: gst_structure_free
+ *
+ * Returns: (transfer full) (nullable): a new #GstStructure or %NULL
+ *     when @data could not be deserialized. Free with
+ *     gst_structure_free() after use.
+ *
+ * Since: 1.14
+ */
+GstStructure *
+gst_structure_from_binary (const guint8 * data, gsize size)
+{
+  GstBinaryReader reader = GST_BINARY_READER_INIT (data, size);
+  GstStructure *structure;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_binary_read_header (&reader, GST_BINARY_KIND_STRUCTURE))
+    return NULL;
+
+  structure = _priv_gst_structure_read_binary (&reader);
+  if (structure && reader.offset != reader.size) {
+    GST_WARNING ("trailing data after binary structure");
+    gst_structure_free (structure);
+    structure = NULL;
+  }
+
+  return structure;
+}
+
 static void
 gst_structure_transform_to_string (const GValue * src_value,
     GValue * dest_value)
@@ -3091,7 +3371,7 @@ _gst_structure_set_any_list (GstStructure * structure, GType type,
 
   if (g_value_transform (&arval, &value)) {
     gst_structure_id_set_value_internal (structure,
-        g_quark_from_string (fieldname), &value);
+        _priv_gst_quark_from_string (fieldname), &value);
   } else {
     g_warning ("Failed to convert a GValueArray");
   }
@@ -328,6 +328,12 @@ GST_EXPORT
 GstStructure *        gst_structure_from_string  (const gchar * string,
                                                   gchar      ** end) G_GNUC_MALLOC;
 GST_EXPORT
+guint8 *              gst_structure_to_binary    (const GstStructure * structure,
+                                                  gsize              * size) G_GNUC_MALLOC;
+GST_EXPORT
+GstStructure *        gst_structure_from_binary  (const guint8 * data,
+                                                  gsize          size) G_GNUC_MALLOC;
+GST_EXPORT
 gboolean              gst_structure_fixate_field_nearest_int      (GstStructure * structure,
                                                                    const char   * field_name,
                                                                    int            target);
@@ -78,10 +78,13 @@ struct _GstSystemClockPrivate
   GThread *thread;              /* thread for async notify */
   gboolean stopping;
 
-  GList *entries;
+  GPtrArray *entries;           /* min-heap of pending async entries */
+  guint64 heap_seqnum;
+  GstClockEntry *async_entry;   /* entry handled by the async thread */
   GCond entries_changed;
 
   GstClockType clock_type;
+  GstClockTime spin_time;
   GstPoll *timer;
   gint wakeup_count;            /* the number of entries with a pending wakeup */
   gboolean async_wakeup;        /* if the wakeup was because of a async list change */
@@ -109,10 +112,13 @@ struct _GstSystemClockPrivate
 #define DEFAULT_CLOCK_TYPE GST_CLOCK_TYPE_REALTIME
 #endif
 
+#define DEFAULT_SPIN_TIME 0
+
 enum
 {
   PROP_0,
   PROP_CLOCK_TYPE,
+  PROP_SPIN_TIME,
   /* FILL ME */
 };
 
@@ -169,6 +175,22 @@ gst_system_clock_class_init (GstSystemClockClass * klass)
           GST_TYPE_CLOCK_TYPE, DEFAULT_CLOCK_TYPE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstSystemClock:spin-time:
+   *
+   * The last part of a wait that is shorter than this time is not done by
+   * polling on the timer but by busy-waiting on the clock. This reduces the
+   * wakeup jitter of the waits at the expense of CPU usage. 0 disables
+   * busy-waiting.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_TIME,
+      g_param_spec_uint64 ("spin-time", "Spin time",
+          "Busy-wait for the last part of waits shorter than this time "
+          "in nanoseconds (0 = disabled)", 0, G_MAXINT64, DEFAULT_SPIN_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstclock_class->get_internal_time = gst_system_clock_get_internal_time;
   gstclock_class->get_resolution = gst_system_clock_get_resolution;
   gstclock_class->wait = gst_system_clock_id_wait_jitter;
@@ -190,9 +212,10 @@ gst_system_clock_init (GstSystemClock * clock)
   clock->priv = priv = GST_SYSTEM_CLOCK_GET_PRIVATE (clock);
 
   priv->clock_type = DEFAULT_CLOCK_TYPE;
+  priv->spin_time = DEFAULT_SPIN_TIME;
   priv->timer = gst_poll_new_timer ();
 
-  priv->entries = NULL;
+  priv->entries = g_ptr_array_new ();
   g_cond_init (&priv->entries_changed);
 
 #ifdef G_OS_WIN32
@@ -221,14 +244,14 @@ gst_system_clock_dispose (GObject * object)
   GstClock *clock = (GstClock *) object;
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   GstSystemClockPrivate *priv = sysclock->priv;
-  GList *entries;
+  guint i;
 
   /* else we have to stop the thread */
   GST_OBJECT_LOCK (clock);
   priv->stopping = TRUE;
   /* unschedule all entries */
-  for (entries = priv->entries; entries; entries = g_list_next (entries)) {
-    GstClockEntry *entry = (GstClockEntry *) entries->data;
+  for (i = 0; i < priv->entries->len; i++) {
+    GstClockEntry *entry = g_ptr_array_index (priv->entries, i);
 
     GST_CAT_DEBUG (GST_CAT_CLOCK, "unscheduling entry %p", entry);
     SET_ENTRY_STATUS (entry, GST_CLOCK_UNSCHEDULED);
@@ -242,8 +265,13 @@ gst_system_clock_dispose (GObject * object)
   priv->thread = NULL;
   GST_CAT_DEBUG (GST_CAT_CLOCK, "joined thread");
 
-  g_list_foreach (priv->entries, (GFunc) gst_clock_id_unref, NULL);
-  g_list_free (priv->entries);
+  for (i = 0; i < priv->entries->len; i++) {
+    GstClockEntry *entry = g_ptr_array_index (priv->entries, i);
+
+    GST_CLOCK_ENTRY_IMPL (entry)->heap_index = -1;
+    gst_clock_id_unref (entry);
+  }
+  g_ptr_array_free (priv->entries, TRUE);
   priv->entries = NULL;
 
   gst_poll_free (priv->timer);
@@ -269,6 +297,13 @@ gst_system_clock_set_property (GObject * object, guint prop_id,
       GST_CAT_DEBUG (GST_CAT_CLOCK, "clock-type set to %d",
           sysclock->priv->clock_type);
       break;
+    case PROP_SPIN_TIME:
+      GST_OBJECT_LOCK (sysclock);
+      sysclock->priv->spin_time = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (sysclock);
+      GST_CAT_DEBUG (GST_CAT_CLOCK, "spin-time set to %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (sysclock->priv->spin_time));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -285,6 +320,11 @@ gst_system_clock_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_CLOCK_TYPE:
       g_value_set_enum (value, sysclock->priv->clock_type);
       break;
+    case PROP_SPIN_TIME:
+      GST_OBJECT_LOCK (sysclock);
+      g_value_set_uint64 (value, sysclock->priv->spin_time);
+      GST_OBJECT_UNLOCK (sysclock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -369,6 +409,29 @@ gst_system_clock_obtain (void)
   return clock;
 }
 
+/* called in the child after a fork with a frozen registry. The file
+ * descriptors of the timer are shared with the parent, where they wake up
+ * the waiting threads, and the async thread does not exist in the child.
+ * Only the forking thread runs, so no locking is done here. */
+void
+_priv_gst_system_clock_after_fork (void)
+{
+  GstSystemClockPrivate *priv;
+
+  if (_the_system_clock == NULL || !GST_IS_SYSTEM_CLOCK (_the_system_clock))
+    return;
+
+  priv = GST_SYSTEM_CLOCK_CAST (_the_system_clock)->priv;
+
+  gst_poll_free (priv->timer);
+  priv->timer = gst_poll_new_timer ();
+  priv->wakeup_count = 0;
+  priv->async_wakeup = FALSE;
+
+  priv->thread = NULL;
+  priv->stopping = FALSE;
+}
+
 static void
 gst_system_clock_remove_wakeup (GstSystemClock * sysclock)
 {
@@ -409,6 +472,129 @@ gst_system_clock_wait_wakeup (GstSystemClock * sysclock)
   }
 }
 
+/* The pending async entries are kept in a binary min-heap ordered on the
+ * entry time, entries with the same time are kept in the order they were
+ * added. Each entry stores its position in the heap so that it can be
+ * moved or removed in O(log n) when it is rescheduled or unscheduled.
+ *
+ * All these functions must be called with the object lock held. */
+static inline gboolean
+gst_system_clock_heap_less (GstClockEntry * a, GstClockEntry * b)
+{
+  if (a->time != b->time)
+    return a->time < b->time;
+
+  return GST_CLOCK_ENTRY_IMPL (a)->heap_seqnum <
+      GST_CLOCK_ENTRY_IMPL (b)->heap_seqnum;
+}
+
+static inline void
+gst_system_clock_heap_set (GPtrArray * heap, guint idx, GstClockEntry * entry)
+{
+  g_ptr_array_index (heap, idx) = entry;
+  GST_CLOCK_ENTRY_IMPL (entry)->heap_index = idx;
+}
+
+static void
+gst_system_clock_heap_sift_up (GPtrArray * heap, guint idx)
+{
+  GstClockEntry *entry = g_ptr_array_index (heap, idx);
+
+  while (idx > 0) {
+    guint parent = (idx - 1) / 2;
+    GstClockEntry *pentry = g_ptr_array_index (heap, parent);
+
+    if (!gst_system_clock_heap_less (entry, pentry))
+      break;
+
+    gst_system_clock_heap_set (heap, idx, pentry);
+    idx = parent;
+  }
+  gst_system_clock_heap_set (heap, idx, entry);
+}
+
+static void
+gst_system_clock_heap_sift_down (GPtrArray * heap, guint idx)
+{
+  GstClockEntry *entry = g_ptr_array_index (heap, idx);
+  guint len = heap->len;
+
+  while (TRUE) {
+    guint child = 2 * idx + 1;
+    GstClockEntry *centry;
+
+    if (child >= len)
+      break;
+
+    centry = g_ptr_array_index (heap, child);
+    if (child + 1 < len &&
+        gst_system_clock_heap_less (g_ptr_array_index (heap, child + 1),
+            centry)) {
+      child++;
+      centry = g_ptr_array_index (heap, child);
+    }
+
+    if (!gst_system_clock_heap_less (centry, entry))
+      break;
+
+    gst_system_clock_heap_set (heap, idx, centry);
+    idx = child;
+  }
+  gst_system_clock_heap_set (heap, idx, entry);
+}
+
+static inline GstClockEntry *
+gst_system_clock_heap_peek (GstSystemClockPrivate * priv)
+{
+  if (priv->entries->len == 0)
+    return NULL;
+
+  return g_ptr_array_index (priv->entries, 0);
+}
+
+static void
+gst_system_clock_heap_push (GstSystemClockPrivate * priv,
+    GstClockEntry * entry)
+{
+  GST_CLOCK_ENTRY_IMPL (entry)->heap_seqnum = priv->heap_seqnum++;
+  g_ptr_array_add (priv->entries, entry);
+  gst_system_clock_heap_sift_up (priv->entries, priv->entries->len - 1);
+}
+
+/* move @entry to its new position after its time changed, it is placed
+ * after the entries that have the same time */
+static void
+gst_system_clock_heap_update (GstSystemClockPrivate * priv,
+    GstClockEntry * entry)
+{
+  GST_CLOCK_ENTRY_IMPL (entry)->heap_seqnum = priv->heap_seqnum++;
+  gst_system_clock_heap_sift_up (priv->entries,
+      GST_CLOCK_ENTRY_IMPL (entry)->heap_index);
+  gst_system_clock_heap_sift_down (priv->entries,
+      GST_CLOCK_ENTRY_IMPL (entry)->heap_index);
+}
+
+static void
+gst_system_clock_heap_remove (GstSystemClockPrivate * priv,
+    GstClockEntry * entry)
+{
+  GPtrArray *heap = priv->entries;
+  guint idx = GST_CLOCK_ENTRY_IMPL (entry)->heap_index;
+  GstClockEntry *last;
+
+  last = g_ptr_array_index (heap, heap->len - 1);
+  g_ptr_array_remove_index_fast (heap, heap->len - 1);
+  GST_CLOCK_ENTRY_IMPL (entry)->heap_index = -1;
+
+  if (last != entry) {
+    /* fill the hole with the last entry and restore the heap order */
+    gst_system_clock_heap_set (heap, idx, last);
+    gst_system_clock_heap_sift_up (heap, idx);
+    gst_system_clock_heap_sift_down (heap,
+        GST_CLOCK_ENTRY_IMPL (last)->heap_index);
+  }
+}
+
 /* this thread reads the sorted clock entries from the queue.
  *
  * It waits on each of them and fires the callback when the timeout occurs.
@@ -438,8 +624,10 @@ gst_system_clock_async_thread (GstClock * clock)
     GstClockTime requested;
     GstClockReturn res;
 
+    priv->async_entry = NULL;
+
     /* check if something to be done */
-    while (priv->entries == NULL) {
+    while (priv->entries->len == 0) {
       GST_CAT_DEBUG (GST_CAT_CLOCK, "no clock entries, waiting..");
       /* wait for work to do */
       GST_SYSTEM_CLOCK_WAIT (clock);
@@ -457,8 +645,9 @@ gst_system_clock_async_thread (GstClock * clock)
       priv->async_wakeup = FALSE;
     }
 
-    /* pick the next entry */
-    entry = priv->entries->data;
+    /* pick the next entry, it stays in the heap while we handle it */
+    entry = gst_system_clock_heap_peek (priv);
+    priv->async_entry = entry;
 
     /* set entry status to busy before we release the clock lock */
     do {
@@ -513,9 +702,8 @@ gst_system_clock_async_thread (GstClock * clock)
           GST_CAT_DEBUG (GST_CAT_CLOCK, "updating periodic entry %p", entry);
           /* adjust time now */
           entry->time = requested + entry->interval;
-          /* and resort the list now */
-          priv->entries =
-              g_list_sort (priv->entries, gst_clock_id_compare_func);
+          /* and move it to its new place in the heap */
+          gst_system_clock_heap_update (priv, entry);
           /* and restart */
           continue;
         } else {
@@ -544,7 +732,7 @@ gst_system_clock_async_thread (GstClock * clock)
     }
   next_entry:
     /* we remove the current entry and unref it */
-    priv->entries = g_list_remove (priv->entries, entry);
+    gst_system_clock_heap_remove (priv, entry);
     gst_clock_id_unref ((GstClockID) entry);
   }
 exit:
@@ -669,6 +857,21 @@ gst_system_clock_cleanup_unscheduled (GstSystemClock * sysclock,
   GST_OBJECT_UNLOCK (sysclock);
 }
 
+/* busy-wait until the clock reaches @entryt or until the entry is not BUSY
+ * anymore because it got unscheduled.
+ *
+ * Entries added to the head of the async queue meanwhile are only picked up
+ * after the spin, which is at most the spin-time later. */
+static void
+gst_system_clock_spin_until (GstClock * clock, GstClockEntry * entry,
+    GstClockTime entryt)
+{
+  while (GET_ENTRY_STATUS (entry) == GST_CLOCK_BUSY) {
+    if (GST_CLOCK_DIFF (gst_clock_get_time (clock), entryt) <= 0)
+      break;
+  }
+}
+
 /* synchronously wait on the given GstClockEntry.
  *
  * We do this by blocking on the global GstPoll timer with
@@ -681,6 +884,9 @@ gst_system_clock_cleanup_unscheduled (GstSystemClock * sysclock,
  * Entries that arrive too late are simply not waited on and a
  * GST_CLOCK_EARLY result is returned.
  *
+ * When a spin-time is configured, the poll only waits until the entry is
+ * within the spin-time and the rest of the wait is done by busy-waiting.
+ *
  * MT safe.
  */
 static GstClockReturn
@@ -723,11 +929,18 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
 #endif
 
     while (TRUE) {
+      GstClockTime spin_time = sysclock->priv->spin_time;
       gint pollret;
 
       /* now wait on the entry, it either times out or the fd is written. The
        * status of the entry is BUSY only around the poll. */
-      pollret = gst_poll_wait (sysclock->priv->timer, diff);
+      if (G_UNLIKELY (spin_time > 0)
+          && diff <= (GstClockTimeDiff) spin_time) {
+        gst_system_clock_spin_until (clock, entry, entryt);
+        pollret = 0;
+      } else {
+        pollret = gst_poll_wait (sysclock->priv->timer, diff - spin_time);
+      }
 
       /* get the new status, mark as DONE. We do this so that the unschedule
        * function knows when we left the poll and doesn't need to wakeup the
@@ -903,10 +1116,9 @@ no_thread:
   return FALSE;
 }
 
-/* Add an entry to the list of pending async waits. The entry is inserted
- * in sorted order. If we inserted the entry at the head of the list, we
- * need to signal the thread as it might either be waiting on it or waiting
- * for a new entry.
+/* Add an entry to the heap of pending async waits. If the entry became the
+ * head of the heap, we need to signal the thread as it might either be
+ * waiting on the previous head or waiting for a new entry.
  *
  * MT safe.
  */
@@ -930,21 +1142,22 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
   if (G_UNLIKELY (GET_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED))
     goto was_unscheduled;
 
-  if (priv->entries)
-    head = priv->entries->data;
-  else
-    head = NULL;
+  head = gst_system_clock_heap_peek (priv);
 
-  /* need to take a ref */
-  gst_clock_id_ref ((GstClockID) entry);
-  /* insert the entry in sorted order */
-  priv->entries = g_list_insert_sorted (priv->entries, entry,
-      gst_clock_id_compare_func);
+  if (G_UNLIKELY (GST_CLOCK_ENTRY_IMPL (entry)->heap_index != -1)) {
+    /* the entry is already pending, only move it to its new place */
+    GST_CAT_DEBUG (GST_CAT_CLOCK, "async entry %p already queued", entry);
+    gst_system_clock_heap_update (priv, entry);
+  } else {
+    /* need to take a ref */
+    gst_clock_id_ref ((GstClockID) entry);
+    gst_system_clock_heap_push (priv, entry);
+  }
 
   /* only need to send the signal if the entry was added to the
    * front, else the thread is just waiting for another entry and
    * will get to this entry automatically. */
-  if (priv->entries->data == entry) {
+  if (head != entry && gst_system_clock_heap_peek (priv) == entry) {
     GST_CAT_DEBUG (GST_CAT_CLOCK, "async entry added to head %p", head);
     if (head == NULL) {
       /* the list was empty before, signal the cond so that the async thread can
@@ -1022,5 +1235,14 @@ gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
       entry->woken_up = TRUE;
     }
   }
+
+  /* drop the entry from the async heap right away unless the async thread is
+   * currently handling it, it will remove the entry itself then */
+  if (GST_CLOCK_ENTRY_IMPL (entry)->heap_index != -1 &&
+      entry != sysclock->priv->async_entry) {
+    GST_CAT_DEBUG (GST_CAT_CLOCK, "removing async entry %p", entry);
+    gst_system_clock_heap_remove (sysclock->priv, entry);
+    gst_clock_id_unref ((GstClockID) entry);
+  }
   GST_OBJECT_UNLOCK (clock);
 }
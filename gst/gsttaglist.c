@@ -52,15 +52,23 @@
 
 #define GST_TAG_IS_VALID(tag)           (gst_tag_get_info (tag) != NULL)
 
+/* the structure of a tag list is shared with its copies until one of them
+ * is modified */
+typedef struct
+{
+  gint refcount;
+  GstStructure *structure;
+} GstTagListData;
+
 typedef struct _GstTagListImpl
 {
   GstTagList taglist;
 
-  GstStructure *structure;
+  GstTagListData *data;
   GstTagScope scope;
 } GstTagListImpl;
 
-#define GST_TAG_LIST_STRUCTURE(taglist)  ((GstTagListImpl*)(taglist))->structure
+#define GST_TAG_LIST_STRUCTURE(taglist)  ((GstTagListImpl*)(taglist))->data->structure
 #define GST_TAG_LIST_SCOPE(taglist)  ((GstTagListImpl*)(taglist))->scope
 
 typedef struct
@@ -82,8 +90,13 @@ static GMutex __tag_mutex;
 #define TAG_LOCK g_mutex_lock (&__tag_mutex)
 #define TAG_UNLOCK g_mutex_unlock (&__tag_mutex)
 
-/* tags hash table: maps tag name string => GstTagInfo */
+/* tags hash table: maps tag name string => GstTagInfo. The table is never
+ * modified once published so it can be read without locking, registering a
+ * tag publishes a new table. Old tables are kept in __retired_tags as they
+ * might still be read. */
 static GHashTable *__tags;
+static GSList *__retired_tags;
+static gboolean __tags_published;
 
 GType _gst_tag_list_type = 0;
 GST_DEFINE_MINI_OBJECT_TYPE (GstTagList, gst_tag_list);
@@ -91,6 +104,10 @@ GST_DEFINE_MINI_OBJECT_TYPE (GstTagList, gst_tag_list);
 static void __gst_tag_list_free (GstTagList * list);
 static GstTagList *__gst_tag_list_copy (const GstTagList * list);
 
+static void gst_tag_register_intern (const gchar * name, GstTagFlag flag,
+    GType type, const gchar * nick, const gchar * blurb,
+    GstTagMergeFunc func);
+
 /* FIXME: had code:
  *    g_value_register_transform_func (_gst_tag_list_type, G_TYPE_STRING,
  *      _gst_structure_transform_to_string);
@@ -103,313 +120,330 @@ _priv_gst_tag_initialize (void)
   _gst_tag_list_type = gst_tag_list_get_type ();
 
   __tags = g_hash_table_new (g_str_hash, g_str_equal);
-  gst_tag_register_static (GST_TAG_TITLE, GST_TAG_FLAG_META,
+}
+
+/* the core tags are registered when the tag system is first used, this
+ * saves gst_init() the translation lookups of all their descriptions */
+static GOnce core_tags_once = G_ONCE_INIT;
+#define ENSURE_CORE_TAGS \
+    g_once (&core_tags_once, gst_tag_register_core_tags, NULL)
+
+static gpointer
+gst_tag_register_core_tags (gpointer data)
+{
+  gst_tag_register_intern (GST_TAG_TITLE, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("title"), _("commonly used title"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_TITLE_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_TITLE_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("title sortname"), _("commonly used title for sorting purposes"), NULL);
-  gst_tag_register_static (GST_TAG_ARTIST, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ARTIST, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("artist"),
       _("person(s) responsible for the recording"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_ARTIST_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ARTIST_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("artist sortname"),
       _("person(s) responsible for the recording for sorting purposes"), NULL);
-  gst_tag_register_static (GST_TAG_ALBUM, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ALBUM, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("album"),
       _("album containing this data"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_ALBUM_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ALBUM_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("album sortname"),
       _("album containing this data for sorting purposes"), NULL);
-  gst_tag_register_static (GST_TAG_ALBUM_ARTIST, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ALBUM_ARTIST, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("album artist"),
       _("The artist of the entire album, as it should be displayed"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_ALBUM_ARTIST_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ALBUM_ARTIST_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("album artist sortname"),
       _("The artist of the entire album, as it should be sorted"), NULL);
-  gst_tag_register_static (GST_TAG_DATE, GST_TAG_FLAG_META, G_TYPE_DATE,
+  gst_tag_register_intern (GST_TAG_DATE, GST_TAG_FLAG_META, G_TYPE_DATE,
       _("date"), _("date the data was created (as a GDate structure)"), NULL);
-  gst_tag_register_static (GST_TAG_DATE_TIME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_DATE_TIME, GST_TAG_FLAG_META,
       GST_TYPE_DATE_TIME, _("datetime"),
       _("date and time the data was created (as a GstDateTime structure)"),
       NULL);
-  gst_tag_register_static (GST_TAG_GENRE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_GENRE, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("genre"),
       _("genre this data belongs to"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_COMMENT, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_COMMENT, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("comment"),
       _("free text commenting the data"), gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_EXTENDED_COMMENT, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_EXTENDED_COMMENT, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("extended comment"),
       _("free text commenting the data in key=value or key[en]=comment form"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_TRACK_NUMBER, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_TRACK_NUMBER, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("track number"),
       _("track number inside a collection"), gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_TRACK_COUNT, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_TRACK_COUNT, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("track count"),
       _("count of tracks inside collection this track belongs to"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_ALBUM_VOLUME_NUMBER, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ALBUM_VOLUME_NUMBER, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("disc number"),
       _("disc number inside a collection"), gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_ALBUM_VOLUME_COUNT, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ALBUM_VOLUME_COUNT, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("disc count"),
       _("count of discs inside collection this disc belongs to"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_LOCATION, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_LOCATION, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("location"), _("Origin of media as a URI (location, where the "
           "original of the file or stream is hosted)"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_HOMEPAGE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_HOMEPAGE, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("homepage"),
       _("Homepage for this media (i.e. artist or movie homepage)"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_DESCRIPTION, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_DESCRIPTION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("description"),
       _("short text describing the content of the data"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_VERSION, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_intern (GST_TAG_VERSION, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("version"), _("version of this data"), NULL);
-  gst_tag_register_static (GST_TAG_ISRC, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_intern (GST_TAG_ISRC, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("ISRC"),
       _
       ("International Standard Recording Code - see http://www.ifpi.org/isrc/"),
       NULL);
   /* FIXME: organization (fix what? tpm) */
-  gst_tag_register_static (GST_TAG_ORGANIZATION, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ORGANIZATION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("organization"), _("organization"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_COPYRIGHT, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_COPYRIGHT, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("copyright"), _("copyright notice of the data"), NULL);
-  gst_tag_register_static (GST_TAG_COPYRIGHT_URI, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_COPYRIGHT_URI, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("copyright uri"),
       _("URI to the copyright notice of the data"), NULL);
-  gst_tag_register_static (GST_TAG_ENCODED_BY, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_intern (GST_TAG_ENCODED_BY, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("encoded by"), _("name of the encoding person or organization"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_CONTACT, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_CONTACT, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("contact"), _("contact information"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_LICENSE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_LICENSE, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("license"), _("license of data"), NULL);
-  gst_tag_register_static (GST_TAG_LICENSE_URI, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_LICENSE_URI, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("license uri"),
       _("URI to the license of the data"), NULL);
-  gst_tag_register_static (GST_TAG_PERFORMER, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_PERFORMER, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("performer"),
       _("person(s) performing"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_COMPOSER, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_COMPOSER, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("composer"),
       _("person(s) who composed the recording"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_CONDUCTOR, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_CONDUCTOR, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("conductor"),
       _("conductor/performer refinement"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_DURATION, GST_TAG_FLAG_DECODED,
+  gst_tag_register_intern (GST_TAG_DURATION, GST_TAG_FLAG_DECODED,
       G_TYPE_UINT64,
       _("duration"), _("length in GStreamer time units (nanoseconds)"), NULL);
-  gst_tag_register_static (GST_TAG_CODEC, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_CODEC, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("codec"),
       _("codec the data is stored in"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_VIDEO_CODEC, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_VIDEO_CODEC, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("video codec"), _("codec the video data is stored in"), NULL);
-  gst_tag_register_static (GST_TAG_AUDIO_CODEC, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_AUDIO_CODEC, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("audio codec"), _("codec the audio data is stored in"), NULL);
-  gst_tag_register_static (GST_TAG_SUBTITLE_CODEC, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_SUBTITLE_CODEC, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("subtitle codec"), _("codec the subtitle data is stored in"), NULL);
-  gst_tag_register_static (GST_TAG_CONTAINER_FORMAT, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_CONTAINER_FORMAT, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING, _("container format"),
       _("container format the data is stored in"), NULL);
-  gst_tag_register_static (GST_TAG_BITRATE, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_BITRATE, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("bitrate"), _("exact or average bitrate in bits/s"), NULL);
-  gst_tag_register_static (GST_TAG_NOMINAL_BITRATE, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_NOMINAL_BITRATE, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("nominal bitrate"), _("nominal bitrate in bits/s"), NULL);
-  gst_tag_register_static (GST_TAG_MINIMUM_BITRATE, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_MINIMUM_BITRATE, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("minimum bitrate"), _("minimum bitrate in bits/s"), NULL);
-  gst_tag_register_static (GST_TAG_MAXIMUM_BITRATE, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_MAXIMUM_BITRATE, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("maximum bitrate"), _("maximum bitrate in bits/s"), NULL);
-  gst_tag_register_static (GST_TAG_ENCODER, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_ENCODER, GST_TAG_FLAG_ENCODED,
       G_TYPE_STRING,
       _("encoder"), _("encoder used to encode this stream"), NULL);
-  gst_tag_register_static (GST_TAG_ENCODER_VERSION, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_ENCODER_VERSION, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT,
       _("encoder version"),
       _("version of the encoder used to encode this stream"), NULL);
-  gst_tag_register_static (GST_TAG_SERIAL, GST_TAG_FLAG_ENCODED,
+  gst_tag_register_intern (GST_TAG_SERIAL, GST_TAG_FLAG_ENCODED,
       G_TYPE_UINT, _("serial"), _("serial number of track"), NULL);
-  gst_tag_register_static (GST_TAG_TRACK_GAIN, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_TRACK_GAIN, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain track gain"), _("track gain in db"), NULL);
-  gst_tag_register_static (GST_TAG_TRACK_PEAK, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_TRACK_PEAK, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain track peak"), _("peak of the track"), NULL);
-  gst_tag_register_static (GST_TAG_ALBUM_GAIN, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ALBUM_GAIN, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain album gain"), _("album gain in db"), NULL);
-  gst_tag_register_static (GST_TAG_ALBUM_PEAK, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ALBUM_PEAK, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain album peak"), _("peak of the album"), NULL);
-  gst_tag_register_static (GST_TAG_REFERENCE_LEVEL, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_REFERENCE_LEVEL, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("replaygain reference level"),
       _("reference level of track and album gain values"), NULL);
-  gst_tag_register_static (GST_TAG_LANGUAGE_CODE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_LANGUAGE_CODE, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("language code"),
       _("language code for this stream, conforming to ISO-639-1 or ISO-639-2"),
       NULL);
-  gst_tag_register_static (GST_TAG_LANGUAGE_NAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_LANGUAGE_NAME, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("language name"),
       _("freeform name of the language this stream is in"), NULL);
-  gst_tag_register_static (GST_TAG_IMAGE, GST_TAG_FLAG_META, GST_TYPE_SAMPLE,
+  gst_tag_register_intern (GST_TAG_IMAGE, GST_TAG_FLAG_META, GST_TYPE_SAMPLE,
       _("image"), _("image related to this stream"), gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_PREVIEW_IMAGE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_PREVIEW_IMAGE, GST_TAG_FLAG_META,
       GST_TYPE_SAMPLE,
       /* TRANSLATORS: 'preview image' = image that shows a preview of the full image */
       _("preview image"), _("preview image related to this stream"), NULL);
-  gst_tag_register_static (GST_TAG_ATTACHMENT, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_ATTACHMENT, GST_TAG_FLAG_META,
       GST_TYPE_SAMPLE, _("attachment"), _("file attached to this stream"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_BEATS_PER_MINUTE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_BEATS_PER_MINUTE, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("beats per minute"),
       _("number of beats per minute in audio"), NULL);
-  gst_tag_register_static (GST_TAG_KEYWORDS, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_intern (GST_TAG_KEYWORDS, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("keywords"), _("comma separated keywords describing the content"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_NAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_NAME, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("geo location name"),
       _("human readable descriptive location of where "
           "the media has been recorded or produced"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_LATITUDE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_LATITUDE, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("geo location latitude"),
       _("geo latitude location of where the media has been recorded or "
           "produced in degrees according to WGS84 (zero at the equator, "
           "negative values for southern latitudes)"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_LONGITUDE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_LONGITUDE, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("geo location longitude"),
       _("geo longitude location of where the media has been recorded or "
           "produced in degrees according to WGS84 (zero at the prime meridian "
           "in Greenwich/UK,  negative values for western longitudes)"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_ELEVATION, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_ELEVATION, GST_TAG_FLAG_META,
       G_TYPE_DOUBLE, _("geo location elevation"),
       _("geo elevation of where the media has been recorded or produced in "
           "meters according to WGS84 (zero is average sea level)"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_COUNTRY, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_COUNTRY, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("geo location country"),
       _("country (english name) where the media has been recorded "
           "or produced"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_CITY, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_CITY, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("geo location city"),
       _("city (english name) where the media has been recorded "
           "or produced"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_SUBLOCATION, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_SUBLOCATION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("geo location sublocation"),
       _("a location within a city where the media has been produced "
           "or created (e.g. the neighborhood)"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_HORIZONTAL_ERROR,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_HORIZONTAL_ERROR,
       GST_TAG_FLAG_META, G_TYPE_DOUBLE, _("geo location horizontal error"),
       _("expected error of the horizontal positioning measures (in meters)"),
       NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_MOVEMENT_SPEED,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_MOVEMENT_SPEED,
       GST_TAG_FLAG_META, G_TYPE_DOUBLE, _("geo location movement speed"),
       _("movement speed of the capturing device while performing the capture "
           "in m/s"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_MOVEMENT_DIRECTION,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_MOVEMENT_DIRECTION,
       GST_TAG_FLAG_META, G_TYPE_DOUBLE, _("geo location movement direction"),
       _("indicates the movement direction of the device performing the capture"
           " of a media. It is represented as degrees in floating point "
           "representation, 0 means the geographic north, and increases "
           "clockwise"), NULL);
-  gst_tag_register_static (GST_TAG_GEO_LOCATION_CAPTURE_DIRECTION,
+  gst_tag_register_intern (GST_TAG_GEO_LOCATION_CAPTURE_DIRECTION,
       GST_TAG_FLAG_META, G_TYPE_DOUBLE, _("geo location capture direction"),
       _("indicates the direction the device is pointing to when capturing "
           " a media. It is represented as degrees in floating point "
           " representation, 0 means the geographic north, and increases "
           "clockwise"), NULL);
-  gst_tag_register_static (GST_TAG_SHOW_NAME, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_intern (GST_TAG_SHOW_NAME, GST_TAG_FLAG_META, G_TYPE_STRING,
       /* TRANSLATORS: 'show name' = 'TV/radio/podcast show name' here */
       _("show name"),
       _("Name of the tv/podcast/series show the media is from"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_SHOW_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_SHOW_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       /* TRANSLATORS: 'show sortname' = 'TV/radio/podcast show name as used for sorting purposes' here */
       _("show sortname"),
       _("Name of the tv/podcast/series show the media is from, for sorting "
           "purposes"), NULL);
-  gst_tag_register_static (GST_TAG_SHOW_EPISODE_NUMBER, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_SHOW_EPISODE_NUMBER, GST_TAG_FLAG_META,
       G_TYPE_UINT, _("episode number"),
       _("The episode number in the season the media is part of"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_SHOW_SEASON_NUMBER, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_SHOW_SEASON_NUMBER, GST_TAG_FLAG_META,
       G_TYPE_UINT, _("season number"),
       _("The season number of the show the media is part of"),
       gst_tag_merge_use_first);
-  gst_tag_register_static (GST_TAG_LYRICS, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_intern (GST_TAG_LYRICS, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("lyrics"), _("The lyrics of the media, commonly used for songs"),
       gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_COMPOSER_SORTNAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_COMPOSER_SORTNAME, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("composer sortname"),
       _("person(s) who composed the recording, for sorting purposes"), NULL);
-  gst_tag_register_static (GST_TAG_GROUPING, GST_TAG_FLAG_META, G_TYPE_STRING,
+  gst_tag_register_intern (GST_TAG_GROUPING, GST_TAG_FLAG_META, G_TYPE_STRING,
       _("grouping"),
       _("Groups related media that spans multiple tracks, like the different "
           "pieces of a concerto. It is a higher level than a track, "
           "but lower than an album"), NULL);
-  gst_tag_register_static (GST_TAG_USER_RATING, GST_TAG_FLAG_META, G_TYPE_UINT,
+  gst_tag_register_intern (GST_TAG_USER_RATING, GST_TAG_FLAG_META, G_TYPE_UINT,
       _("user rating"),
       _("Rating attributed by a user. The higher the rank, "
           "the more the user likes this media"), NULL);
-  gst_tag_register_static (GST_TAG_DEVICE_MANUFACTURER, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_DEVICE_MANUFACTURER, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("device manufacturer"),
       _("Manufacturer of the device used to create this media"), NULL);
-  gst_tag_register_static (GST_TAG_DEVICE_MODEL, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_DEVICE_MODEL, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("device model"),
       _("Model of the device used to create this media"), NULL);
-  gst_tag_register_static (GST_TAG_APPLICATION_NAME, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_APPLICATION_NAME, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("application name"),
       _("Application used to create the media"), NULL);
-  gst_tag_register_static (GST_TAG_APPLICATION_DATA, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_APPLICATION_DATA, GST_TAG_FLAG_META,
       GST_TYPE_SAMPLE, _("application data"),
       _("Arbitrary application data to be serialized into the media"), NULL);
-  gst_tag_register_static (GST_TAG_IMAGE_ORIENTATION, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_IMAGE_ORIENTATION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("image orientation"),
       _("How the image should be rotated or flipped before display"), NULL);
-  gst_tag_register_static (GST_TAG_PUBLISHER, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_PUBLISHER, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("publisher"),
       _("Name of the label or publisher"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_INTERPRETED_BY, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_INTERPRETED_BY, GST_TAG_FLAG_META,
       G_TYPE_STRING,
       _("interpreted-by"),
       _("Information about the people behind a remix and similar "
           "interpretations"), gst_tag_merge_strings_with_comma);
-  gst_tag_register_static (GST_TAG_MIDI_BASE_NOTE, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_MIDI_BASE_NOTE, GST_TAG_FLAG_META,
       G_TYPE_UINT,
       _("midi-base-note"), _("Midi note number of the audio track."), NULL);
-  gst_tag_register_static (GST_TAG_PRIVATE_DATA, GST_TAG_FLAG_META,
+  gst_tag_register_intern (GST_TAG_PRIVATE_DATA, GST_TAG_FLAG_META,
       GST_TYPE_SAMPLE,
       _("private-data"), _("Private data"), gst_tag_merge_use_first);
 
+  /* nobody could read the table before, from now on it must not change */
+  TAG_LOCK;
+  __tags_published = TRUE;
+  TAG_UNLOCK;
+
+  return NULL;
 }
 
 /**
@@ -461,13 +495,9 @@ gst_tag_merge_strings_with_comma (GValue * dest, const GValue * src)
 static GstTagInfo *
 gst_tag_lookup (const gchar * tag_name)
 {
-  GstTagInfo *ret;
+  ENSURE_CORE_TAGS;
 
-  TAG_LOCK;
-  ret = g_hash_table_lookup (__tags, (gpointer) tag_name);
-  TAG_UNLOCK;
-
-  return ret;
+  return g_hash_table_lookup (g_atomic_pointer_get (&__tags), tag_name);
 }
 
 /**
@@ -534,16 +564,28 @@ void
 gst_tag_register_static (const gchar * name, GstTagFlag flag, GType type,
     const gchar * nick, const gchar * blurb, GstTagMergeFunc func)
 {
-  GstTagInfo *info;
-
   g_return_if_fail (name != NULL);
   g_return_if_fail (nick != NULL);
   g_return_if_fail (blurb != NULL);
   g_return_if_fail (type != 0 && type != GST_TYPE_LIST);
 
-  info = gst_tag_lookup (name);
+  ENSURE_CORE_TAGS;
+
+  gst_tag_register_intern (name, flag, type, nick, blurb, func);
+}
+
+static void
+gst_tag_register_intern (const gchar * name, GstTagFlag flag, GType type,
+    const gchar * nick, const gchar * blurb, GstTagMergeFunc func)
+{
+  GstTagInfo *info;
+  GHashTable *tags;
+
+  TAG_LOCK;
+  info = g_hash_table_lookup (__tags, name);
 
   if (info) {
+    TAG_UNLOCK;
     g_return_if_fail (info->type == type);
     return;
   }
@@ -556,8 +598,21 @@ gst_tag_register_static (const gchar * name, GstTagFlag flag, GType type,
   info->blurb = blurb;
   info->merge_func = func;
 
-  TAG_LOCK;
-  g_hash_table_insert (__tags, (gpointer) name, info);
+  if (__tags_published) {
+    GHashTableIter iter;
+    gpointer key, value;
+
+    tags = g_hash_table_new (g_str_hash, g_str_equal);
+    g_hash_table_iter_init (&iter, __tags);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+      g_hash_table_insert (tags, key, value);
+    g_hash_table_insert (tags, (gpointer) name, info);
+
+    __retired_tags = g_slist_prepend (__retired_tags, __tags);
+    g_atomic_pointer_set (&__tags, tags);
+  } else {
+    g_hash_table_insert (__tags, (gpointer) name, info);
+  }
   TAG_UNLOCK;
 }
 
@@ -680,6 +735,34 @@ gst_tag_is_fixed (const gchar * tag)
   return info->merge_func == NULL;
 }
 
+static GstTagListData *
+gst_tag_list_data_new (GstStructure * s)
+{
+  GstTagListData *data = g_slice_new (GstTagListData);
+
+  data->refcount = 1;
+  data->structure = s;
+
+  return data;
+}
+
+static GstTagListData *
+gst_tag_list_data_ref (GstTagListData * data)
+{
+  g_atomic_int_inc (&data->refcount);
+
+  return data;
+}
+
+static void
+gst_tag_list_data_unref (GstTagListData * data)
+{
+  if (g_atomic_int_dec_and_test (&data->refcount)) {
+    gst_structure_free (data->structure);
+    g_slice_free (GstTagListData, data);
+  }
+}
+
 /* takes ownership of the structure */
 static GstTagList *
 gst_tag_list_new_internal (GstStructure * s, GstTagScope scope)
@@ -694,7 +777,7 @@ gst_tag_list_new_internal (GstStructure * s, GstTagScope scope)
       (GstMiniObjectCopyFunction) __gst_tag_list_copy, NULL,
       (GstMiniObjectFreeFunction) __gst_tag_list_free);
 
-  GST_TAG_LIST_STRUCTURE (tag_list) = s;
+  ((GstTagListImpl *) tag_list)->data = gst_tag_list_data_new (s);
   GST_TAG_LIST_SCOPE (tag_list) = scope;
 
 #ifdef DEBUG_REFCOUNT
@@ -713,21 +796,47 @@ __gst_tag_list_free (GstTagList * list)
   GST_CAT_TRACE (GST_CAT_TAGS, "freeing taglist %p", list);
 #endif
 
-  gst_structure_free (GST_TAG_LIST_STRUCTURE (list));
+  gst_tag_list_data_unref (((GstTagListImpl *) list)->data);
 
   g_slice_free1 (sizeof (GstTagListImpl), list);
 }
 
+/* copies share the structure */
 static GstTagList *
 __gst_tag_list_copy (const GstTagList * list)
 {
-  const GstStructure *s;
+  GstTagList *tag_list;
 
   g_return_val_if_fail (GST_IS_TAG_LIST (list), NULL);
 
-  s = GST_TAG_LIST_STRUCTURE (list);
-  return gst_tag_list_new_internal (gst_structure_copy (s),
-      GST_TAG_LIST_SCOPE (list));
+  tag_list = (GstTagList *) g_slice_new (GstTagListImpl);
+
+  gst_mini_object_init (GST_MINI_OBJECT_CAST (tag_list), 0, GST_TYPE_TAG_LIST,
+      (GstMiniObjectCopyFunction) __gst_tag_list_copy, NULL,
+      (GstMiniObjectFreeFunction) __gst_tag_list_free);
+
+  ((GstTagListImpl *) tag_list)->data =
+      gst_tag_list_data_ref (((GstTagListImpl *) list)->data);
+  GST_TAG_LIST_SCOPE (tag_list) = GST_TAG_LIST_SCOPE (list);
+
+  return tag_list;
+}
+
+/* the structure of a writable @list for modifying it, copies it when it is
+ * shared with other lists */
+static GstStructure *
+gst_tag_list_get_writable_structure (GstTagList * list)
+{
+  GstTagListImpl *impl = (GstTagListImpl *) list;
+
+  if (g_atomic_int_get (&impl->data->refcount) > 1) {
+    GstTagListData *data = impl->data;
+
+    impl->data = gst_tag_list_data_new (gst_structure_copy (data->structure));
+    gst_tag_list_data_unref (data);
+  }
+
+  return impl->data->structure;
 }
 
 /**
@@ -893,6 +1002,82 @@ gst_tag_list_new_from_string (const gchar * str)
   return tag_list;
 }
 
+/**
+ * gst_tag_list_to_binary:
+ * @list: a #GstTagList
+ * @size: (out): the size of the returned data
+ *
+ * Serializes a tag list, including its scope, into a compact binary
+ * representation. See gst_structure_to_binary().
+ *
+ * Returns: (transfer full) (array length=size) (nullable): the binary data,
+ *     or %NULL in case of an error. Free with g_free() when no longer
+ *     needed.
+ *
+ * Since: 1.14
+ */
+guint8 *
+gst_tag_list_to_binary (const GstTagList * list, gsize * size)
+{
+  GByteArray *array;
+
+  g_return_val_if_fail (GST_IS_TAG_LIST (list), NULL);
+  g_return_val_if_fail (size != NULL, NULL);
+
+  array = g_byte_array_new ();
+  _priv_gst_binary_write_header (array, GST_BINARY_KIND_TAG_LIST);
+  _priv_gst_binary_write_uint32 (array, GST_TAG_LIST_SCOPE (list));
+  if (!_priv_gst_structure_write_binary (array, GST_TAG_LIST_STRUCTURE (list))) {
+    g_byte_array_free (array, TRUE);
+    *size = 0;
+    return NULL;
+  }
+
+  *size = array->len;
+  return g_byte_array_free (array, FALSE);
+}
+
+/**
+ * gst_tag_list_new_from_binary:
+ * @data: (array length=size): data created with gst_tag_list_to_binary()
+ * @size: the size of @data
+ *
+ * Deserializes a tag list from its binary representation.
+ *
+ * Returns: (nullable): a new #GstTagList, or %NULL in case of an
+ * error.
+ *
+ * Since: 1.14
+ */
+GstTagList *
+gst_tag_list_new_from_binary (const guint8 * data, gsize size)
+{
+  GstBinaryReader reader = GST_BINARY_READER_INIT (data, size);
+  GstStructure *s;
+  guint32 scope;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_binary_read_header (&reader, GST_BINARY_KIND_TAG_LIST) ||
+      !_priv_gst_binary_read_uint32 (&reader, &scope))
+    return NULL;
+
+  if (scope != GST_TAG_SCOPE_STREAM && scope != GST_TAG_SCOPE_GLOBAL)
+    return NULL;
+
+  s = _priv_gst_structure_read_binary (&reader);
+  if (s == NULL)
+    return NULL;
+
+  if (reader.offset != reader.size || !gst_structure_has_name (s, "taglist")) {
+    GST_WARNING ("invalid tag list in binary data");
+    gst_structure_free (s);
+    return NULL;
+  }
+
+  return gst_tag_list_new_internal (s, scope);
+}
+
 /**
  * gst_tag_list_n_tags:
  * @list: A #GstTagList.
@@ -1025,7 +1210,7 @@ static void
 gst_tag_list_add_value_internal (GstTagList * tag_list, GstTagMergeMode mode,
     const gchar * tag, const GValue * value, GstTagInfo * info)
 {
-  GstStructure *list = GST_TAG_LIST_STRUCTURE (tag_list);
+  GstStructure *list;
   const GValue *value2;
   GQuark tag_quark;
 
@@ -1046,6 +1231,7 @@ gst_tag_list_add_value_internal (GstTagList * tag_list, GstTagMergeMode mode,
   }
 
   tag_quark = info->name_quark;
+  list = gst_tag_list_get_writable_structure (tag_list);
 
   if (info->merge_func
       && (value2 = gst_structure_id_get_value (list, tag_quark)) != NULL) {
@@ -1135,8 +1321,20 @@ gst_tag_list_insert (GstTagList * into, const GstTagList * from,
   data.list = into;
   data.mode = mode;
   if (mode == GST_TAG_MERGE_REPLACE_ALL) {
-    gst_structure_remove_all_fields (GST_TAG_LIST_STRUCTURE (into));
+    gst_structure_remove_all_fields (gst_tag_list_get_writable_structure
+        (into));
+  }
+
+  /* inserting into an empty list gives the same tags as @from in all modes
+   * except KEEP_ALL, share the structure of @from */
+  if (mode != GST_TAG_MERGE_KEEP_ALL && gst_tag_list_is_empty (into)) {
+    GstTagListImpl *impl = (GstTagListImpl *) into;
+
+    gst_tag_list_data_unref (impl->data);
+    impl->data = gst_tag_list_data_ref (((GstTagListImpl *) from)->data);
+    return;
   }
+
   gst_structure_foreach (GST_TAG_LIST_STRUCTURE (from),
       gst_tag_list_copy_foreach, &data);
 }
@@ -1279,7 +1477,8 @@ gst_tag_list_add_valist (GstTagList * list, GstTagMergeMode mode,
   g_return_if_fail (tag != NULL);
 
   if (mode == GST_TAG_MERGE_REPLACE_ALL) {
-    gst_structure_remove_all_fields (GST_TAG_LIST_STRUCTURE (list));
+    gst_structure_remove_all_fields (gst_tag_list_get_writable_structure
+        (list));
   }
 
   while (tag != NULL) {
@@ -1330,7 +1529,8 @@ gst_tag_list_add_valist_values (GstTagList * list, GstTagMergeMode mode,
   g_return_if_fail (tag != NULL);
 
   if (mode == GST_TAG_MERGE_REPLACE_ALL) {
-    gst_structure_remove_all_fields (GST_TAG_LIST_STRUCTURE (list));
+    gst_structure_remove_all_fields (gst_tag_list_get_writable_structure
+        (list));
   }
 
   while (tag != NULL) {
@@ -1382,7 +1582,8 @@ gst_tag_list_remove_tag (GstTagList * list, const gchar * tag)
   g_return_if_fail (gst_tag_list_is_writable (list));
   g_return_if_fail (tag != NULL);
 
-  gst_structure_remove_field (GST_TAG_LIST_STRUCTURE (list), tag);
+  gst_structure_remove_field (gst_tag_list_get_writable_structure (list),
+      tag);
 }
 
 typedef struct
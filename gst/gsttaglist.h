@@ -267,6 +267,13 @@ gchar      * gst_tag_list_to_string         (const GstTagList * list) G_GNUC_MAL
 GST_EXPORT
 GstTagList * gst_tag_list_new_from_string   (const gchar      * str) G_GNUC_MALLOC;
 
+GST_EXPORT
+guint8     * gst_tag_list_to_binary         (const GstTagList * list,
+                                             gsize            * size) G_GNUC_MALLOC;
+GST_EXPORT
+GstTagList * gst_tag_list_new_from_binary   (const guint8     * data,
+                                             gsize              size) G_GNUC_MALLOC;
+
 GST_EXPORT
 gint         gst_tag_list_n_tags            (const GstTagList * list);
 
@@ -57,32 +57,61 @@
  * After creating a #GstTask, use gst_object_unref() to free its resources. This can
  * only be done when the task is not running anymore.
  *
+ * A task can be made cooperative with gst_task_set_cooperative(). When the
+ * function of a cooperative task would have to wait, it can call
+ * gst_task_suspend() and return. The task then gives its thread back to the
+ * #GstTaskPool until gst_task_wakeup() is called, so that a small number of
+ * pool threads can run many mostly idle tasks. A cooperative task also gives
+ * its thread back while it is paused.
+ *
  * Task functions can send a #GstMessage to send out-of-band data to the
  * application. The application can receive messages from the #GstBus in its
  * mainloop.
  *
+ * The thread of a task can be given a realtime scheduling policy and priority
+ * with gst_task_set_scheduling() and be restricted to a set of CPUs with
+ * gst_task_set_cpus(). The task applies the configuration from its own thread
+ * and restores the previous configuration of the thread when it gives the
+ * thread back to its pool.
+ *
  * For debugging purposes, the task will configure its object name as the thread
  * name on Linux. Please note that the object name should be configured before the
  * task is started; changing the object name after the task has been started, has
  * no effect on the thread name.
  */
 
+/* for sched_setaffinity() */
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE 1
+#endif
+
 #include "gst_private.h"
 
 #include "gstinfo.h"
 #include "gsttask.h"
 #include "glib-compat-private.h"
 
+#include <errno.h>
 #include <stdio.h>
+#include <string.h>
 
 #ifdef HAVE_SYS_PRCTL_H
 #include <sys/prctl.h>
 #endif
 
-#ifdef HAVE_PTHREAD_SETNAME_NP_WITHOUT_TID
+#if defined(HAVE_PTHREAD_SETNAME_NP_WITHOUT_TID) || defined(HAVE_PTHREAD_SETSCHEDPARAM)
 #include <pthread.h>
 #endif
 
+#if defined(HAVE_PTHREAD_SETSCHEDPARAM) || defined(HAVE_SCHED_SETAFFINITY)
+#include <sched.h>
+#endif
+
+#ifdef G_OS_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (task_debug);
 #define GST_CAT_DEFAULT (task_debug)
 
@@ -109,11 +138,42 @@ struct _GstTaskPrivate
   /* remember the pool and id that is currently running. */
   gpointer id;
   GstTaskPool *pool_id;
+
+  /* cooperative scheduling, protected by the object lock */
+  gboolean cooperative;
+  gboolean suspended;           /* waiting for gst_task_wakeup() */
+  gboolean parked;              /* gave back its thread, must be pushed again */
+  gboolean resumed;             /* pushed again after being parked */
+
+  /* thread scheduling, protected by the object lock */
+  GstTaskSchedulingPolicy sched_policy;
+  gint sched_priority;
+  guint *cpus;
+  guint n_cpus;
+  gboolean sched_changed;       /* must be applied again by the thread */
 };
 
+/* the configuration a task thread had before the task changed it, on the
+ * stack of gst_task_func() */
+typedef struct
+{
+  gboolean sched_saved;
+  gboolean cpus_saved;
+#ifdef HAVE_PTHREAD_SETSCHEDPARAM
+  int policy;
+  struct sched_param param;
+#endif
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(__linux__)
+  cpu_set_t cpus;
+#endif
+#ifdef G_OS_WIN32
+  HANDLE mmcss;
+  int priority;
+  DWORD_PTR affinity;
+#endif
+} GstTaskThreadState;
+
 #ifdef _MSC_VER
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
 
 struct _THREADNAME_INFO
 {
@@ -223,6 +283,7 @@ gst_task_finalize (GObject * object)
     task->notify (task->user_data);
 
   gst_object_unref (priv->pool);
+  g_free (priv->cpus);
 
   /* task thread cannot be running here since it holds a ref
    * to the task so that the finalize could not have happened */
@@ -273,14 +334,248 @@ gst_task_configure_name (GstTask * task)
 #endif
 }
 
+#ifdef G_OS_WIN32
+/* MMCSS lives in avrt.dll, which is not available everywhere */
+typedef HANDLE (WINAPI * AvSetMmThreadCharacteristicsFunc) (LPCWSTR, LPDWORD);
+typedef BOOL (WINAPI * AvRevertMmThreadCharacteristicsFunc) (HANDLE);
+
+static AvSetMmThreadCharacteristicsFunc av_set_mm_thread_characteristics;
+static AvRevertMmThreadCharacteristicsFunc av_revert_mm_thread_characteristics;
+
+static gpointer
+load_avrt (gpointer data)
+{
+  HMODULE avrt = LoadLibraryW (L"avrt.dll");
+
+  if (avrt) {
+    av_set_mm_thread_characteristics = (AvSetMmThreadCharacteristicsFunc)
+        GetProcAddress (avrt, "AvSetMmThreadCharacteristicsW");
+    av_revert_mm_thread_characteristics =
+        (AvRevertMmThreadCharacteristicsFunc) GetProcAddress (avrt,
+        "AvRevertMmThreadCharacteristics");
+  }
+  return NULL;
+}
+#endif
+
+/* give the calling thread the scheduling policy and priority of @task */
+static void
+gst_task_thread_set_scheduling (GstTask * task, GstTaskThreadState * state,
+    GstTaskSchedulingPolicy policy, gint priority)
+{
+#ifdef HAVE_PTHREAD_SETSCHEDPARAM
+  struct sched_param param;
+  int res;
+
+  if (!state->sched_saved) {
+    pthread_getschedparam (pthread_self (), &state->policy, &state->param);
+    state->sched_saved = TRUE;
+  }
+
+  memset (&param, 0, sizeof (param));
+  param.sched_priority = priority;
+  res = pthread_setschedparam (pthread_self (),
+      policy == GST_TASK_SCHEDULING_RR ? SCHED_RR : SCHED_FIFO, &param);
+  if (res != 0)
+    GST_WARNING_OBJECT (task, "failed to set realtime priority %d: %s",
+        priority, g_strerror (res));
+#elif defined(G_OS_WIN32)
+  static GOnce avrt_once = G_ONCE_INIT;
+  DWORD index = 0;
+
+  g_once (&avrt_once, load_avrt, NULL);
+
+  if (!state->sched_saved) {
+    state->mmcss = NULL;
+    state->priority = GetThreadPriority (GetCurrentThread ());
+    state->sched_saved = TRUE;
+  }
+
+  /* MMCSS boosts the thread with the priority of the "Pro Audio" task, fall
+   * back to the highest thread priority without it */
+  if (state->mmcss == NULL && av_set_mm_thread_characteristics)
+    state->mmcss = av_set_mm_thread_characteristics (L"Pro Audio", &index);
+  if (state->mmcss == NULL
+      && !SetThreadPriority (GetCurrentThread (),
+          THREAD_PRIORITY_TIME_CRITICAL))
+    GST_WARNING_OBJECT (task, "failed to set realtime priority");
+#else
+  GST_WARNING_OBJECT (task, "realtime scheduling is not supported");
+#endif
+}
+
+static void
+gst_task_thread_restore_scheduling (GstTask * task, GstTaskThreadState * state)
+{
+  if (!state->sched_saved)
+    return;
+
+#ifdef HAVE_PTHREAD_SETSCHEDPARAM
+  pthread_setschedparam (pthread_self (), state->policy, &state->param);
+#elif defined(G_OS_WIN32)
+  if (state->mmcss) {
+    av_revert_mm_thread_characteristics (state->mmcss);
+    state->mmcss = NULL;
+  }
+  SetThreadPriority (GetCurrentThread (), state->priority);
+#endif
+  state->sched_saved = FALSE;
+}
+
+/* restrict the calling thread to the CPUs of @task */
+static void
+gst_task_thread_set_cpus (GstTask * task, GstTaskThreadState * state,
+    const guint * cpus, guint n_cpus)
+{
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(__linux__)
+  cpu_set_t set;
+  guint i;
+
+  if (!state->cpus_saved) {
+    if (sched_getaffinity (0, sizeof (state->cpus), &state->cpus) != 0)
+      return;
+    state->cpus_saved = TRUE;
+  }
+
+  CPU_ZERO (&set);
+  for (i = 0; i < n_cpus; i++) {
+    if (cpus[i] < CPU_SETSIZE)
+      CPU_SET (cpus[i], &set);
+  }
+  if (sched_setaffinity (0, sizeof (set), &set) != 0)
+    GST_WARNING_OBJECT (task, "failed to set the CPU affinity: %s",
+        g_strerror (errno));
+#elif defined(G_OS_WIN32)
+  DWORD_PTR mask = 0, old;
+  guint i;
+
+  for (i = 0; i < n_cpus; i++) {
+    if (cpus[i] < sizeof (DWORD_PTR) * 8)
+      mask |= ((DWORD_PTR) 1) << cpus[i];
+  }
+  if ((old = SetThreadAffinityMask (GetCurrentThread (), mask)) == 0) {
+    GST_WARNING_OBJECT (task, "failed to set the CPU affinity");
+  } else if (!state->cpus_saved) {
+    state->affinity = old;
+    state->cpus_saved = TRUE;
+  }
+#else
+  GST_WARNING_OBJECT (task, "setting the CPU affinity is not supported");
+#endif
+}
+
+static void
+gst_task_thread_restore_cpus (GstTask * task, GstTaskThreadState * state)
+{
+  if (!state->cpus_saved)
+    return;
+
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(__linux__)
+  sched_setaffinity (0, sizeof (state->cpus), &state->cpus);
+#elif defined(G_OS_WIN32)
+  SetThreadAffinityMask (GetCurrentThread (), state->affinity);
+#endif
+  state->cpus_saved = FALSE;
+}
+
+/* apply the scheduling configuration of @task to the calling thread, should
+ * be called without the object lock */
+static void
+gst_task_apply_scheduling (GstTask * task, GstTaskThreadState * state)
+{
+  GstTaskPrivate *priv = task->priv;
+  GstTaskSchedulingPolicy policy;
+  gint priority;
+  guint *cpus;
+  guint n_cpus;
+
+  GST_OBJECT_LOCK (task);
+  priv->sched_changed = FALSE;
+  policy = priv->sched_policy;
+  priority = priv->sched_priority;
+  n_cpus = priv->n_cpus;
+  cpus = n_cpus ? g_memdup (priv->cpus, n_cpus * sizeof (guint)) : NULL;
+  GST_OBJECT_UNLOCK (task);
+
+  if (policy != GST_TASK_SCHEDULING_DEFAULT) {
+    GST_DEBUG_OBJECT (task, "setting scheduling policy %d, priority %d",
+        policy, priority);
+    gst_task_thread_set_scheduling (task, state, policy, priority);
+  } else {
+    gst_task_thread_restore_scheduling (task, state);
+  }
+
+  if (n_cpus > 0) {
+    GST_DEBUG_OBJECT (task, "restricting thread to %u CPUs", n_cpus);
+    gst_task_thread_set_cpus (task, state, cpus, n_cpus);
+  } else {
+    gst_task_thread_restore_cpus (task, state);
+  }
+
+  g_free (cpus);
+}
+
+/* give the thread back to its pool with its original configuration */
+static void
+gst_task_restore_scheduling (GstTask * task, GstTaskThreadState * state)
+{
+  gst_task_thread_restore_scheduling (task, state);
+  gst_task_thread_restore_cpus (task, state);
+}
+
+/* if a cooperative task can give back its thread, with the object lock */
+static inline gboolean
+gst_task_can_park (GstTask * task)
+{
+  switch (GET_TASK_STATE (task)) {
+    case GST_TASK_STARTED:
+      return task->priv->suspended;
+    case GST_TASK_PAUSED:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+/* push a parked task on its pool again when it has to run, with the object
+ * lock */
+static void
+gst_task_maybe_resume (GstTask * task)
+{
+  GstTaskPrivate *priv = task->priv;
+  GError *error = NULL;
+
+  if (G_LIKELY (!priv->parked))
+    return;
+
+  if (priv->cooperative && gst_task_can_park (task))
+    return;
+
+  GST_DEBUG_OBJECT (task, "resuming parked task");
+
+  priv->parked = FALSE;
+  priv->resumed = TRUE;
+  priv->id =
+      gst_task_pool_push (priv->pool_id, (GstTaskPoolFunction) gst_task_func,
+      task, &error);
+
+  if (error != NULL) {
+    g_warning ("failed to resume task: %s", error->message);
+    g_error_free (error);
+  }
+}
+
 static void
 gst_task_func (GstTask * task)
 {
   GRecMutex *lock;
   GThread *tself;
   GstTaskPrivate *priv;
+  GstTaskThreadState tstate;
+  gboolean resumed;
 
   priv = task->priv;
+  memset (&tstate, 0, sizeof (tstate));
 
   tself = g_thread_self ();
 
@@ -290,6 +585,8 @@ gst_task_func (GstTask * task)
    * mark our state running so that nobody can mess with
    * the mutex. */
   GST_OBJECT_LOCK (task);
+  resumed = priv->resumed;
+  priv->resumed = FALSE;
   if (GET_TASK_STATE (task) == GST_TASK_STOPPED)
     goto exit;
   lock = GST_TASK_GET_LOCK (task);
@@ -298,17 +595,28 @@ gst_task_func (GstTask * task)
   task->thread = tself;
   GST_OBJECT_UNLOCK (task);
 
-  /* fire the enter_func callback when we need to */
-  if (priv->enter_func)
+  /* fire the enter_func callback when we need to, a resumed cooperative task
+   * already did that when it was started */
+  if (priv->enter_func && !resumed)
     priv->enter_func (task, tself, priv->enter_user_data);
 
   /* locking order is TASK_LOCK, LOCK */
   g_rec_mutex_lock (lock);
   /* configure the thread name now */
   gst_task_configure_name (task);
+  gst_task_apply_scheduling (task, &tstate);
 
   while (G_LIKELY (GET_TASK_STATE (task) != GST_TASK_STOPPED)) {
     GST_OBJECT_LOCK (task);
+    if (G_UNLIKELY (priv->cooperative) && gst_task_can_park (task))
+      goto park;
+
+    if (G_UNLIKELY (priv->sched_changed)) {
+      GST_OBJECT_UNLOCK (task);
+      gst_task_apply_scheduling (task, &tstate);
+      GST_OBJECT_LOCK (task);
+    }
+
     while (G_UNLIKELY (GST_TASK_STATE (task) == GST_TASK_PAUSED)) {
       g_rec_mutex_unlock (lock);
 
@@ -334,6 +642,8 @@ gst_task_func (GstTask * task)
 
   g_rec_mutex_unlock (lock);
 
+  gst_task_restore_scheduling (task, &tstate);
+
   GST_OBJECT_LOCK (task);
   task->thread = NULL;
 
@@ -353,6 +663,7 @@ exit:
    * before releasing the lock as we can be sure that a ref is held by the
    * caller of the join(). */
   task->running = FALSE;
+  priv->suspended = FALSE;
   GST_TASK_SIGNAL (task);
   GST_OBJECT_UNLOCK (task);
 
@@ -361,6 +672,21 @@ exit:
   gst_object_unref (task);
   return;
 
+park:
+  {
+    /* give the thread back to the pool, we keep the ref and the running flag
+     * until the task is pushed again and exits */
+    priv->parked = TRUE;
+    task->thread = NULL;
+    GST_TASK_SIGNAL (task);
+    GST_OBJECT_UNLOCK (task);
+    g_rec_mutex_unlock (lock);
+
+    gst_task_restore_scheduling (task, &tstate);
+
+    GST_DEBUG ("Park task %p, thread %p", task, tself);
+    return;
+  }
 no_lock:
   {
     g_warning ("starting task without a lock");
@@ -712,6 +1038,11 @@ gst_task_set_state (GstTask * task, GstTaskState state)
          * iteration. */
         break;
     }
+    /* a parked cooperative task needs a thread again to handle the new
+     * state, also when it was suspended before, the element could have
+     * discarded the state it was waiting on, for example on a flush */
+    task->priv->suspended = FALSE;
+    gst_task_maybe_resume (task);
   }
   GST_OBJECT_UNLOCK (task);
 
@@ -822,6 +1153,8 @@ gst_task_join (GstTask * task)
   SET_TASK_STATE (task, GST_TASK_STOPPED);
   /* signal the state change for when it was blocked in PAUSED. */
   GST_TASK_SIGNAL (task);
+  /* and let a parked task exit */
+  gst_task_maybe_resume (task);
   /* we set the running flag when pushing the task on the thread pool.
    * This means that the task function might not be called when we try
    * to join it here. */
@@ -858,3 +1191,241 @@ joining_self:
     return FALSE;
   }
 }
+
+/**
+ * gst_task_set_cooperative:
+ * @task: a #GstTask
+ * @cooperative: %TRUE to make @task cooperative
+ *
+ * Makes @task cooperative. A cooperative task gives its thread back to
+ * the #GstTaskPool while it is paused and when its function returns after
+ * calling gst_task_suspend(). It gets a thread from the pool again when it
+ * is woken up with gst_task_wakeup() or when its state changes.
+ *
+ * The enter and leave callbacks of a cooperative task are only called when
+ * the task is started and stopped, not every time it gets a new thread.
+ *
+ * This should be configured before the task is started.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+void
+gst_task_set_cooperative (GstTask * task, gboolean cooperative)
+{
+  g_return_if_fail (GST_IS_TASK (task));
+
+  GST_OBJECT_LOCK (task);
+  task->priv->cooperative = cooperative;
+  gst_task_maybe_resume (task);
+  GST_OBJECT_UNLOCK (task);
+}
+
+/**
+ * gst_task_get_cooperative:
+ * @task: a #GstTask
+ *
+ * Returns: %TRUE if @task is cooperative.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_task_get_cooperative (GstTask * task)
+{
+  gboolean result;
+
+  g_return_val_if_fail (GST_IS_TASK (task), FALSE);
+
+  GST_OBJECT_LOCK (task);
+  result = task->priv->cooperative;
+  GST_OBJECT_UNLOCK (task);
+
+  return result;
+}
+
+/**
+ * gst_task_suspend:
+ * @task: a #GstTask
+ *
+ * Suspends the cooperative @task after the current call of its function.
+ * This should be called from the task function when it cannot make
+ * progress, the function should then return instead of blocking. The task
+ * function is called again after gst_task_wakeup(), which can also happen
+ * before the current call returned.
+ *
+ * Returns: %TRUE if @task will be suspended, %FALSE if @task is not
+ * cooperative and the task function has to wait itself.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_task_suspend (GstTask * task)
+{
+  gboolean result;
+
+  g_return_val_if_fail (GST_IS_TASK (task), FALSE);
+
+  GST_OBJECT_LOCK (task);
+  if ((result = task->priv->cooperative)) {
+    GST_LOG_OBJECT (task, "suspending task");
+    task->priv->suspended = TRUE;
+  }
+  GST_OBJECT_UNLOCK (task);
+
+  return result;
+}
+
+/**
+ * gst_task_wakeup:
+ * @task: a #GstTask
+ *
+ * Wakes up @task after gst_task_suspend(), its function will be called
+ * again.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+void
+gst_task_wakeup (GstTask * task)
+{
+  g_return_if_fail (GST_IS_TASK (task));
+
+  GST_OBJECT_LOCK (task);
+  if (task->priv->suspended) {
+    GST_LOG_OBJECT (task, "waking up task");
+    task->priv->suspended = FALSE;
+    gst_task_maybe_resume (task);
+  }
+  GST_OBJECT_UNLOCK (task);
+}
+
+/**
+ * gst_task_set_scheduling:
+ * @task: a #GstTask
+ * @policy: a #GstTaskSchedulingPolicy
+ * @priority: the realtime priority for @policy
+ *
+ * Configure the scheduling policy and priority of the thread of @task. With
+ * %GST_TASK_SCHEDULING_FIFO and %GST_TASK_SCHEDULING_RR the thread is
+ * scheduled with the matching realtime policy at @priority, which usually
+ * requires extra privileges. On Windows the thread is registered with the
+ * "Pro Audio" task of the multimedia class scheduler service instead.
+ * %GST_TASK_SCHEDULING_DEFAULT keeps the configuration of the thread and
+ * ignores @priority.
+ *
+ * The configuration is applied by the thread of @task, when it enters the
+ * task or before the next call of the task function when @task is already
+ * running. Failures are only logged.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+void
+gst_task_set_scheduling (GstTask * task, GstTaskSchedulingPolicy policy,
+    gint priority)
+{
+  g_return_if_fail (GST_IS_TASK (task));
+  g_return_if_fail (priority >= 0);
+
+  GST_OBJECT_LOCK (task);
+  task->priv->sched_policy = policy;
+  task->priv->sched_priority = priority;
+  task->priv->sched_changed = TRUE;
+  GST_OBJECT_UNLOCK (task);
+}
+
+/**
+ * gst_task_get_scheduling:
+ * @task: a #GstTask
+ * @priority: (out) (allow-none): the realtime priority
+ *
+ * Get the scheduling policy and priority configured with
+ * gst_task_set_scheduling().
+ *
+ * Returns: the #GstTaskSchedulingPolicy of @task.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+GstTaskSchedulingPolicy
+gst_task_get_scheduling (GstTask * task, gint * priority)
+{
+  GstTaskSchedulingPolicy policy;
+
+  g_return_val_if_fail (GST_IS_TASK (task), GST_TASK_SCHEDULING_DEFAULT);
+
+  GST_OBJECT_LOCK (task);
+  policy = task->priv->sched_policy;
+  if (priority)
+    *priority = task->priv->sched_priority;
+  GST_OBJECT_UNLOCK (task);
+
+  return policy;
+}
+
+/**
+ * gst_task_set_cpus:
+ * @task: a #GstTask
+ * @cpus: (array length=n_cpus) (allow-none): the CPU numbers
+ * @n_cpus: the number of CPUs in @cpus
+ *
+ * Restrict the thread of @task to the CPUs in @cpus. When @n_cpus is 0 the
+ * thread may run on the CPUs it was allowed to run on before. Like
+ * gst_task_set_scheduling(), this is applied by the thread of @task.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+void
+gst_task_set_cpus (GstTask * task, const guint * cpus, guint n_cpus)
+{
+  g_return_if_fail (GST_IS_TASK (task));
+  g_return_if_fail (n_cpus == 0 || cpus != NULL);
+
+  GST_OBJECT_LOCK (task);
+  g_free (task->priv->cpus);
+  task->priv->cpus = n_cpus ? g_memdup (cpus, n_cpus * sizeof (guint)) : NULL;
+  task->priv->n_cpus = n_cpus;
+  task->priv->sched_changed = TRUE;
+  GST_OBJECT_UNLOCK (task);
+}
+
+/**
+ * gst_task_get_cpus:
+ * @task: a #GstTask
+ * @n_cpus: (out): the number of CPUs
+ *
+ * Get the CPUs configured with gst_task_set_cpus().
+ *
+ * Returns: (transfer full) (array length=n_cpus) (nullable): the CPU numbers.
+ * g_free() after usage.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+guint *
+gst_task_get_cpus (GstTask * task, guint * n_cpus)
+{
+  guint *cpus;
+
+  g_return_val_if_fail (GST_IS_TASK (task), NULL);
+  g_return_val_if_fail (n_cpus != NULL, NULL);
+
+  GST_OBJECT_LOCK (task);
+  *n_cpus = task->priv->n_cpus;
+  cpus = *n_cpus ? g_memdup (task->priv->cpus, *n_cpus * sizeof (guint))
+      : NULL;
+  GST_OBJECT_UNLOCK (task);
+
+  return cpus;
+}
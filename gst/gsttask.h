@@ -64,6 +64,23 @@ typedef enum {
   GST_TASK_PAUSED
 } GstTaskState;
 
+/**
+ * GstTaskSchedulingPolicy:
+ * @GST_TASK_SCHEDULING_DEFAULT: keep the scheduling of the thread
+ * @GST_TASK_SCHEDULING_FIFO: first in, first out realtime scheduling
+ * @GST_TASK_SCHEDULING_RR: round robin realtime scheduling
+ *
+ * The scheduling policies for the thread of a task, see
+ * gst_task_set_scheduling().
+ *
+ * Since: 1.14
+ */
+typedef enum {
+  GST_TASK_SCHEDULING_DEFAULT,
+  GST_TASK_SCHEDULING_FIFO,
+  GST_TASK_SCHEDULING_RR
+} GstTaskSchedulingPolicy;
+
 /**
  * GST_TASK_STATE:
  * @task: Task to get the state of
@@ -210,6 +227,30 @@ gboolean        gst_task_pause          (GstTask *task);
 GST_EXPORT
 gboolean        gst_task_join           (GstTask *task);
 
+GST_EXPORT
+void            gst_task_set_cooperative (GstTask *task, gboolean cooperative);
+
+GST_EXPORT
+gboolean        gst_task_get_cooperative (GstTask *task);
+
+GST_EXPORT
+gboolean        gst_task_suspend        (GstTask *task);
+
+GST_EXPORT
+void            gst_task_wakeup         (GstTask *task);
+
+GST_EXPORT
+void            gst_task_set_scheduling (GstTask *task, GstTaskSchedulingPolicy policy,
+                                         gint priority);
+GST_EXPORT
+GstTaskSchedulingPolicy gst_task_get_scheduling (GstTask *task, gint *priority);
+
+GST_EXPORT
+void            gst_task_set_cpus       (GstTask *task, const guint *cpus, guint n_cpus);
+
+GST_EXPORT
+guint *         gst_task_get_cpus       (GstTask *task, guint *n_cpus);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstTask, gst_object_unref)
 #endif
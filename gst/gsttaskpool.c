@@ -29,6 +29,13 @@
  * implementation uses a regular GThreadPool to start tasks.
  *
  * Subclasses can be made to create custom threads.
+ *
+ * #GstWorkStealingTaskPool runs the pushed functions on a fixed number of
+ * worker threads. Each worker has its own queue of functions and idle
+ * workers take functions from the queues of busy workers. Functions pushed
+ * from a worker thread are queued on that worker first. Note that the
+ * function of a #GstTask only returns when the task is stopped, so such a
+ * pool needs at least as many threads as tasks that run at the same time.
  */
 
 #include "gst_private.h"
@@ -272,3 +279,419 @@ gst_task_pool_join (GstTaskPool * pool, gpointer id)
   if (klass->join)
     klass->join (pool, id);
 }
+
+/* --- work stealing task pool --- */
+
+enum
+{
+  PROP_0,
+  PROP_N_THREADS
+};
+
+typedef struct
+{
+  GstWorkStealingTaskPool *pool;
+  guint index;
+  GThread *thread;
+
+  /* queue of TaskData, the worker pops from the head, other workers steal
+   * from the tail */
+  GMutex lock;
+  GQueue jobs;
+} GstTaskPoolWorker;
+
+struct _GstWorkStealingTaskPoolPrivate
+{
+  guint n_threads;
+
+  /* protected by the object lock */
+  GstTaskPoolWorker *workers;
+  guint next_worker;
+  gboolean shutdown;
+
+  /* number of queued functions, workers sleep on cond while it is 0 */
+  gint pending;
+  GMutex lock;
+  GCond cond;
+  gint n_idle;
+};
+
+/* the worker of the calling thread */
+static GPrivate current_worker;
+
+#define gst_work_stealing_task_pool_parent_class ws_parent_class
+G_DEFINE_TYPE (GstWorkStealingTaskPool, gst_work_stealing_task_pool,
+    GST_TYPE_TASK_POOL);
+
+static TaskData *
+ws_worker_pop (GstTaskPoolWorker * worker)
+{
+  GstWorkStealingTaskPoolPrivate *priv = worker->pool->priv;
+  TaskData *tdata;
+  guint i;
+
+  g_mutex_lock (&worker->lock);
+  tdata = g_queue_pop_head (&worker->jobs);
+  g_mutex_unlock (&worker->lock);
+
+  if (tdata)
+    return tdata;
+
+  /* nothing to do ourselves, try to steal from the other workers */
+  for (i = 1; i < priv->n_threads; i++) {
+    GstTaskPoolWorker *victim =
+        &priv->workers[(worker->index + i) % priv->n_threads];
+
+    g_mutex_lock (&victim->lock);
+    tdata = g_queue_pop_tail (&victim->jobs);
+    g_mutex_unlock (&victim->lock);
+
+    if (tdata) {
+      GST_LOG_OBJECT (worker->pool, "worker %u stole from worker %u",
+          worker->index, victim->index);
+      return tdata;
+    }
+  }
+  return NULL;
+}
+
+static gpointer
+ws_worker_func (GstTaskPoolWorker * worker)
+{
+  GstWorkStealingTaskPool *pool = worker->pool;
+  GstWorkStealingTaskPoolPrivate *priv = pool->priv;
+  GstWorkStealingTaskPoolClass *klass;
+
+  klass = GST_WORK_STEALING_TASK_POOL_GET_CLASS (pool);
+
+  g_private_set (&current_worker, worker);
+
+  if (klass->thread_started)
+    klass->thread_started (pool, worker->index);
+
+  GST_DEBUG_OBJECT (pool, "worker %u started", worker->index);
+
+  while (TRUE) {
+    TaskData *tdata;
+
+    g_mutex_lock (&priv->lock);
+    while (g_atomic_int_get (&priv->pending) == 0 && !priv->shutdown) {
+      priv->n_idle++;
+      g_cond_wait (&priv->cond, &priv->lock);
+      priv->n_idle--;
+    }
+    /* when shutting down, we still run all queued functions */
+    if (g_atomic_int_get (&priv->pending) == 0) {
+      g_mutex_unlock (&priv->lock);
+      break;
+    }
+    g_mutex_unlock (&priv->lock);
+
+    if ((tdata = ws_worker_pop (worker))) {
+      g_atomic_int_add (&priv->pending, -1);
+      default_func (tdata, GST_TASK_POOL_CAST (pool));
+    } else {
+      /* another worker is taking the queued function */
+      g_thread_yield ();
+    }
+  }
+
+  GST_DEBUG_OBJECT (pool, "worker %u stopped", worker->index);
+
+  if (klass->thread_stopped)
+    klass->thread_stopped (pool, worker->index);
+
+  g_private_set (&current_worker, NULL);
+
+  return NULL;
+}
+
+static void
+ws_join_workers (GstWorkStealingTaskPool * pool, GstTaskPoolWorker * workers)
+{
+  GstWorkStealingTaskPoolPrivate *priv = pool->priv;
+  guint i;
+
+  g_mutex_lock (&priv->lock);
+  priv->shutdown = TRUE;
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+
+  for (i = 0; i < priv->n_threads; i++) {
+    if (workers[i].thread)
+      g_thread_join (workers[i].thread);
+    g_mutex_clear (&workers[i].lock);
+    g_queue_clear (&workers[i].jobs);
+  }
+  g_free (workers);
+}
+
+static void ws_cleanup (GstTaskPool * pool);
+
+static void
+ws_prepare (GstTaskPool * pool, GError ** error)
+{
+  GstWorkStealingTaskPool *wspool = GST_WORK_STEALING_TASK_POOL_CAST (pool);
+  GstWorkStealingTaskPoolPrivate *priv = wspool->priv;
+  GstTaskPoolWorker *workers;
+  guint i;
+
+  GST_OBJECT_LOCK (pool);
+  if (priv->workers != NULL)
+    goto already_prepared;
+
+  workers = g_new0 (GstTaskPoolWorker, priv->n_threads);
+  for (i = 0; i < priv->n_threads; i++) {
+    workers[i].pool = wspool;
+    workers[i].index = i;
+    g_mutex_init (&workers[i].lock);
+    g_queue_init (&workers[i].jobs);
+  }
+  priv->workers = workers;
+  priv->next_worker = 0;
+  priv->shutdown = FALSE;
+
+  for (i = 0; i < priv->n_threads; i++) {
+    gchar *name = g_strdup_printf ("taskpool-%u", i);
+
+    workers[i].thread = g_thread_try_new (name,
+        (GThreadFunc) ws_worker_func, &workers[i], error);
+    g_free (name);
+
+    if (workers[i].thread == NULL)
+      goto no_thread;
+  }
+  GST_OBJECT_UNLOCK (pool);
+
+  GST_DEBUG_OBJECT (pool, "started %u worker threads", priv->n_threads);
+
+  return;
+
+  /* ERRORS */
+already_prepared:
+  {
+    GST_OBJECT_UNLOCK (pool);
+    return;
+  }
+no_thread:
+  {
+    GST_WARNING_OBJECT (pool, "failed to start worker %u", i);
+    GST_OBJECT_UNLOCK (pool);
+
+    /* stop the workers that were already started */
+    ws_cleanup (pool);
+    return;
+  }
+}
+
+static void
+ws_cleanup (GstTaskPool * pool)
+{
+  GstWorkStealingTaskPool *wspool = GST_WORK_STEALING_TASK_POOL_CAST (pool);
+  GstWorkStealingTaskPoolPrivate *priv = wspool->priv;
+  GstTaskPoolWorker *workers;
+
+  GST_OBJECT_LOCK (pool);
+  if ((workers = priv->workers) == NULL || priv->shutdown) {
+    GST_OBJECT_UNLOCK (pool);
+    return;
+  }
+  /* stop accepting new functions */
+  priv->shutdown = TRUE;
+  GST_OBJECT_UNLOCK (pool);
+
+  /* wait for the workers without the object lock so that the functions
+   * that are still running can push to the pool */
+  ws_join_workers (wspool, workers);
+
+  GST_OBJECT_LOCK (pool);
+  priv->workers = NULL;
+  GST_OBJECT_UNLOCK (pool);
+}
+
+static gpointer
+ws_push (GstTaskPool * pool, GstTaskPoolFunction func,
+    gpointer user_data, GError ** error)
+{
+  GstWorkStealingTaskPool *wspool = GST_WORK_STEALING_TASK_POOL_CAST (pool);
+  GstWorkStealingTaskPoolPrivate *priv = wspool->priv;
+  GstTaskPoolWorker *worker;
+  TaskData *tdata;
+
+  tdata = g_slice_new (TaskData);
+  tdata->func = func;
+  tdata->user_data = user_data;
+
+  worker = g_private_get (&current_worker);
+  if (worker != NULL && worker->pool != wspool)
+    worker = NULL;
+
+  GST_OBJECT_LOCK (pool);
+  /* when shutting down, only our own workers can still push, they run the
+   * function before they exit */
+  if (G_UNLIKELY (priv->workers == NULL || (priv->shutdown && !worker))) {
+    GST_OBJECT_UNLOCK (pool);
+    g_slice_free (TaskData, tdata);
+    return NULL;
+  }
+
+  if (worker != NULL) {
+    /* pushed from one of our workers, keep it on the same thread */
+    g_mutex_lock (&worker->lock);
+    g_queue_push_head (&worker->jobs, tdata);
+    g_mutex_unlock (&worker->lock);
+  } else {
+    worker = &priv->workers[priv->next_worker];
+    priv->next_worker = (priv->next_worker + 1) % priv->n_threads;
+
+    g_mutex_lock (&worker->lock);
+    g_queue_push_tail (&worker->jobs, tdata);
+    g_mutex_unlock (&worker->lock);
+  }
+
+  g_atomic_int_inc (&priv->pending);
+  g_mutex_lock (&priv->lock);
+  if (priv->n_idle > 0)
+    g_cond_signal (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+  GST_OBJECT_UNLOCK (pool);
+
+  return NULL;
+}
+
+static void
+ws_set_property (GObject * object, guint prop_id, const GValue * value,
+    GParamSpec * pspec)
+{
+  GstWorkStealingTaskPool *pool = GST_WORK_STEALING_TASK_POOL (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      pool->priv->n_threads = g_value_get_uint (value);
+      if (pool->priv->n_threads == 0)
+        pool->priv->n_threads = g_get_num_processors ();
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+ws_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstWorkStealingTaskPool *pool = GST_WORK_STEALING_TASK_POOL (object);
+
+  switch (prop_id) {
+    case PROP_N_THREADS:
+      g_value_set_uint (value, pool->priv->n_threads);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+ws_finalize (GObject * object)
+{
+  GstWorkStealingTaskPool *pool = GST_WORK_STEALING_TASK_POOL (object);
+
+  ws_cleanup (GST_TASK_POOL_CAST (pool));
+
+  g_mutex_clear (&pool->priv->lock);
+  g_cond_clear (&pool->priv->cond);
+
+  G_OBJECT_CLASS (ws_parent_class)->finalize (object);
+}
+
+static void
+gst_work_stealing_task_pool_class_init (GstWorkStealingTaskPoolClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstTaskPoolClass *gsttaskpool_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gsttaskpool_class = (GstTaskPoolClass *) klass;
+
+  g_type_class_add_private (klass, sizeof (GstWorkStealingTaskPoolPrivate));
+
+  gobject_class->set_property = ws_set_property;
+  gobject_class->get_property = ws_get_property;
+  gobject_class->finalize = ws_finalize;
+
+  /**
+   * GstWorkStealingTaskPool:n-threads:
+   *
+   * The number of worker threads, 0 uses one thread per CPU.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "The number of worker threads (0 = number of CPUs)", 0, G_MAXUINT,
+          0, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+          G_PARAM_STATIC_STRINGS));
+
+  gsttaskpool_class->prepare = ws_prepare;
+  gsttaskpool_class->cleanup = ws_cleanup;
+  gsttaskpool_class->push = ws_push;
+}
+
+static void
+gst_work_stealing_task_pool_init (GstWorkStealingTaskPool * pool)
+{
+  pool->priv = G_TYPE_INSTANCE_GET_PRIVATE (pool,
+      GST_TYPE_WORK_STEALING_TASK_POOL, GstWorkStealingTaskPoolPrivate);
+
+  pool->priv->n_threads = g_get_num_processors ();
+  g_mutex_init (&pool->priv->lock);
+  g_cond_init (&pool->priv->cond);
+}
+
+/**
+ * gst_work_stealing_task_pool_new:
+ * @n_threads: the number of worker threads, 0 for one thread per CPU
+ *
+ * Create a new work stealing task pool that runs the pushed functions on
+ * @n_threads worker threads. The threads are started in
+ * gst_task_pool_prepare() and can be given a CPU affinity or priority by
+ * subclasses in the #GstWorkStealingTaskPoolClass.thread_started() vfunc.
+ *
+ * The pool can be set on a #GstTask with gst_task_set_pool(). Keep in mind
+ * that each task occupies a worker thread for as long as it is started.
+ *
+ * Returns: (transfer full): a new #GstTaskPool. gst_object_unref() after usage.
+ *
+ * Since: 1.14
+ */
+GstTaskPool *
+gst_work_stealing_task_pool_new (guint n_threads)
+{
+  GstTaskPool *pool;
+
+  pool = g_object_new (GST_TYPE_WORK_STEALING_TASK_POOL, "n-threads",
+      n_threads, NULL);
+
+  /* clear floating flag */
+  gst_object_ref_sink (pool);
+
+  return pool;
+}
+
+/**
+ * gst_work_stealing_task_pool_get_n_threads:
+ * @pool: a #GstWorkStealingTaskPool
+ *
+ * Returns: the number of worker threads of @pool
+ *
+ * Since: 1.14
+ */
+guint
+gst_work_stealing_task_pool_get_n_threads (GstWorkStealingTaskPool * pool)
+{
+  g_return_val_if_fail (GST_IS_WORK_STEALING_TASK_POOL (pool), 0);
+
+  return pool->priv->n_threads;
+}
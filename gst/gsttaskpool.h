@@ -103,8 +103,70 @@ void            gst_task_pool_join        (GstTaskPool *pool, gpointer id);
 GST_EXPORT
 void		gst_task_pool_cleanup     (GstTaskPool *pool);
 
+/* --- work stealing task pool --- */
+#define GST_TYPE_WORK_STEALING_TASK_POOL             (gst_work_stealing_task_pool_get_type ())
+#define GST_WORK_STEALING_TASK_POOL(pool)            (G_TYPE_CHECK_INSTANCE_CAST ((pool), GST_TYPE_WORK_STEALING_TASK_POOL, GstWorkStealingTaskPool))
+#define GST_IS_WORK_STEALING_TASK_POOL(pool)         (G_TYPE_CHECK_INSTANCE_TYPE ((pool), GST_TYPE_WORK_STEALING_TASK_POOL))
+#define GST_WORK_STEALING_TASK_POOL_CLASS(pclass)    (G_TYPE_CHECK_CLASS_CAST ((pclass), GST_TYPE_WORK_STEALING_TASK_POOL, GstWorkStealingTaskPoolClass))
+#define GST_IS_WORK_STEALING_TASK_POOL_CLASS(pclass) (G_TYPE_CHECK_CLASS_TYPE ((pclass), GST_TYPE_WORK_STEALING_TASK_POOL))
+#define GST_WORK_STEALING_TASK_POOL_GET_CLASS(pool)  (G_TYPE_INSTANCE_GET_CLASS ((pool), GST_TYPE_WORK_STEALING_TASK_POOL, GstWorkStealingTaskPoolClass))
+#define GST_WORK_STEALING_TASK_POOL_CAST(pool)       ((GstWorkStealingTaskPool*)(pool))
+
+typedef struct _GstWorkStealingTaskPool GstWorkStealingTaskPool;
+typedef struct _GstWorkStealingTaskPoolClass GstWorkStealingTaskPoolClass;
+typedef struct _GstWorkStealingTaskPoolPrivate GstWorkStealingTaskPoolPrivate;
+
+/**
+ * GstWorkStealingTaskPool:
+ *
+ * The #GstWorkStealingTaskPool object.
+ *
+ * Since: 1.14
+ */
+struct _GstWorkStealingTaskPool {
+  GstTaskPool    parent;
+
+  /*< private >*/
+  GstWorkStealingTaskPoolPrivate *priv;
+
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+/**
+ * GstWorkStealingTaskPoolClass:
+ * @parent_class: the parent class structure
+ * @thread_started: called from a worker thread when it starts, before it
+ *     runs any function. Can be used to set the CPU affinity or the
+ *     priority of the thread.
+ * @thread_stopped: called from a worker thread before it exits
+ *
+ * The #GstWorkStealingTaskPoolClass object.
+ *
+ * Since: 1.14
+ */
+struct _GstWorkStealingTaskPoolClass {
+  GstTaskPoolClass parent_class;
+
+  /*< public >*/
+  void      (*thread_started)  (GstWorkStealingTaskPool *pool, guint index);
+  void      (*thread_stopped)  (GstWorkStealingTaskPool *pool, guint index);
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+GST_EXPORT
+GType           gst_work_stealing_task_pool_get_type      (void);
+
+GST_EXPORT
+GstTaskPool *   gst_work_stealing_task_pool_new           (guint n_threads);
+
+GST_EXPORT
+guint           gst_work_stealing_task_pool_get_n_threads (GstWorkStealingTaskPool *pool);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstTaskPool, gst_object_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstWorkStealingTaskPool, gst_object_unref)
 #endif
 
 G_END_DECLS
@@ -0,0 +1,425 @@
+/* GStreamer
+ *
+ * gstthreadpolicy.c: Threading policy for the streaming threads of a pipeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstthreadpolicy
+ * @title: GstThreadPolicy
+ * @short_description: Configure the streaming threads of a pipeline
+ * @see_also: #GstPipeline, #GstTask, #GstTaskPool
+ *
+ * A #GstThreadPolicy describes how the streaming threads of a pipeline are
+ * created and scheduled. It contains the #GstTaskPool the threads are taken
+ * from, the set of CPUs the threads may run on and a realtime priority.
+ *
+ * The policy is configured on a pipeline with
+ * gst_pipeline_set_thread_policy(). The pipeline then applies it to every
+ * #GstTask that is announced with a %GST_MESSAGE_STREAM_STATUS message by an
+ * element in the pipeline. The pool, the CPU set and the priority are
+ * configured on the task when it is created, see gst_task_set_pool(),
+ * gst_task_set_cpus() and gst_task_set_scheduling().
+ *
+ * Elements, or the bins containing them, can use a different policy
+ * configured with gst_thread_policy_set_element_policy(). The policy of the
+ * nearest element with an override is used.
+ *
+ * Since: 1.14
+ */
+
+/* for sched_setaffinity() */
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE 1
+#endif
+
+#include "gst_private.h"
+
+#include <errno.h>
+#if defined(HAVE_SCHED_SETAFFINITY) || defined(HAVE_SCHED_SETSCHEDULER)
+#  include <sched.h>
+#endif
+
+#include "gstinfo.h"
+#include "gstthreadpolicy.h"
+
+GST_DEBUG_CATEGORY_STATIC (thread_policy_debug);
+#define GST_CAT_DEFAULT (thread_policy_debug)
+
+#define GST_THREAD_POLICY_GET_PRIVATE(obj) \
+    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_THREAD_POLICY, GstThreadPolicyPrivate))
+
+struct _GstThreadPolicyPrivate
+{
+  /* with LOCK */
+  GstTaskPool *pool;
+  guint *cpus;
+  guint n_cpus;
+  gint priority;
+  /* element name -> GstThreadPolicy */
+  GHashTable *overrides;
+};
+
+static void gst_thread_policy_finalize (GObject * object);
+
+#define _do_init \
+{ \
+  GST_DEBUG_CATEGORY_INIT (thread_policy_debug, "threadpolicy", 0, \
+      "Thread policy"); \
+}
+
+#define gst_thread_policy_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstThreadPolicy, gst_thread_policy, GST_TYPE_OBJECT,
+    _do_init);
+
+static void
+gst_thread_policy_class_init (GstThreadPolicyClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (GstThreadPolicyPrivate));
+
+  gobject_class->finalize = gst_thread_policy_finalize;
+}
+
+static void
+gst_thread_policy_init (GstThreadPolicy * policy)
+{
+  policy->priv = GST_THREAD_POLICY_GET_PRIVATE (policy);
+
+  policy->priv->overrides = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, gst_object_unref);
+}
+
+static void
+gst_thread_policy_finalize (GObject * object)
+{
+  GstThreadPolicy *policy = GST_THREAD_POLICY (object);
+  GstThreadPolicyPrivate *priv = policy->priv;
+
+  if (priv->pool)
+    gst_object_unref (priv->pool);
+  g_free (priv->cpus);
+  g_hash_table_unref (priv->overrides);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/**
+ * gst_thread_policy_new:
+ *
+ * Create a new empty thread policy. The tasks the policy is applied to keep
+ * their pool, may run on all CPUs and keep their scheduling priority until
+ * the policy is configured.
+ *
+ * Returns: (transfer full): a new #GstThreadPolicy.
+ *
+ * Since: 1.14
+ */
+GstThreadPolicy *
+gst_thread_policy_new (void)
+{
+  GstThreadPolicy *policy;
+
+  policy = g_object_new (GST_TYPE_THREAD_POLICY, NULL);
+
+  /* clear floating flag */
+  gst_object_ref_sink (policy);
+
+  return policy;
+}
+
+/**
+ * gst_thread_policy_set_task_pool:
+ * @policy: a #GstThreadPolicy
+ * @pool: (transfer none) (allow-none): a #GstTaskPool
+ *
+ * Set the pool the tasks get their threads from. When @pool is %NULL, the
+ * tasks keep the pool they were created with. The caller should prepare
+ * @pool with gst_task_pool_prepare() before the tasks are started.
+ *
+ * Since: 1.14
+ */
+void
+gst_thread_policy_set_task_pool (GstThreadPolicy * policy, GstTaskPool * pool)
+{
+  g_return_if_fail (GST_IS_THREAD_POLICY (policy));
+  g_return_if_fail (pool == NULL || GST_IS_TASK_POOL (pool));
+
+  GST_OBJECT_LOCK (policy);
+  gst_object_replace ((GstObject **) & policy->priv->pool, (GstObject *) pool);
+  GST_OBJECT_UNLOCK (policy);
+}
+
+/**
+ * gst_thread_policy_get_task_pool:
+ * @policy: a #GstThreadPolicy
+ *
+ * Get the pool the tasks get their threads from.
+ *
+ * Returns: (transfer full) (nullable): the #GstTaskPool of @policy. Unref
+ * after usage.
+ *
+ * Since: 1.14
+ */
+GstTaskPool *
+gst_thread_policy_get_task_pool (GstThreadPolicy * policy)
+{
+  GstTaskPool *pool;
+
+  g_return_val_if_fail (GST_IS_THREAD_POLICY (policy), NULL);
+
+  GST_OBJECT_LOCK (policy);
+  if ((pool = policy->priv->pool))
+    gst_object_ref (pool);
+  GST_OBJECT_UNLOCK (policy);
+
+  return pool;
+}
+
+/**
+ * gst_thread_policy_set_cpus:
+ * @policy: a #GstThreadPolicy
+ * @cpus: (array length=n_cpus) (allow-none): the CPU numbers
+ * @n_cpus: the number of CPUs in @cpus
+ *
+ * Set the CPUs the threads may run on. When @n_cpus is 0, the affinity of
+ * the threads is not changed.
+ *
+ * Since: 1.14
+ */
+void
+gst_thread_policy_set_cpus (GstThreadPolicy * policy, const guint * cpus,
+    guint n_cpus)
+{
+  g_return_if_fail (GST_IS_THREAD_POLICY (policy));
+  g_return_if_fail (n_cpus == 0 || cpus != NULL);
+
+  GST_OBJECT_LOCK (policy);
+  g_free (policy->priv->cpus);
+  policy->priv->cpus = n_cpus ? g_memdup (cpus, n_cpus * sizeof (guint)) : NULL;
+  policy->priv->n_cpus = n_cpus;
+  GST_OBJECT_UNLOCK (policy);
+}
+
+/**
+ * gst_thread_policy_get_cpus:
+ * @policy: a #GstThreadPolicy
+ * @n_cpus: (out): the number of CPUs
+ *
+ * Get the CPUs the threads may run on.
+ *
+ * Returns: (transfer full) (array length=n_cpus) (nullable): the CPU numbers.
+ * g_free() after usage.
+ *
+ * Since: 1.14
+ */
+guint *
+gst_thread_policy_get_cpus (GstThreadPolicy * policy, guint * n_cpus)
+{
+  guint *cpus;
+
+  g_return_val_if_fail (GST_IS_THREAD_POLICY (policy), NULL);
+  g_return_val_if_fail (n_cpus != NULL, NULL);
+
+  GST_OBJECT_LOCK (policy);
+  *n_cpus = policy->priv->n_cpus;
+  cpus = *n_cpus ? g_memdup (policy->priv->cpus, *n_cpus * sizeof (guint))
+      : NULL;
+  GST_OBJECT_UNLOCK (policy);
+
+  return cpus;
+}
+
+/**
+ * gst_thread_policy_set_priority:
+ * @policy: a #GstThreadPolicy
+ * @priority: a realtime priority or 0
+ *
+ * Set the realtime priority of the threads. The threads are scheduled with
+ * the FIFO realtime policy of the system at @priority, which usually requires
+ * extra privileges. When @priority is 0, the scheduling of the threads is
+ * not changed.
+ *
+ * Since: 1.14
+ */
+void
+gst_thread_policy_set_priority (GstThreadPolicy * policy, gint priority)
+{
+  g_return_if_fail (GST_IS_THREAD_POLICY (policy));
+  g_return_if_fail (priority >= 0);
+
+  GST_OBJECT_LOCK (policy);
+  policy->priv->priority = priority;
+  GST_OBJECT_UNLOCK (policy);
+}
+
+/**
+ * gst_thread_policy_get_priority:
+ * @policy: a #GstThreadPolicy
+ *
+ * Get the realtime priority of the threads.
+ *
+ * Returns: the realtime priority or 0.
+ *
+ * Since: 1.14
+ */
+gint
+gst_thread_policy_get_priority (GstThreadPolicy * policy)
+{
+  gint priority;
+
+  g_return_val_if_fail (GST_IS_THREAD_POLICY (policy), 0);
+
+  GST_OBJECT_LOCK (policy);
+  priority = policy->priv->priority;
+  GST_OBJECT_UNLOCK (policy);
+
+  return priority;
+}
+
+/**
+ * gst_thread_policy_set_element_policy:
+ * @policy: a #GstThreadPolicy
+ * @element_name: the name of an element
+ * @element_policy: (transfer none) (allow-none): a #GstThreadPolicy
+ *
+ * Use @element_policy instead of @policy for the tasks of the element named
+ * @element_name and of the elements inside it when it is a bin. Overrides
+ * are only looked up in the policy configured on the pipeline. A %NULL
+ * @element_policy removes the override.
+ *
+ * Since: 1.14
+ */
+void
+gst_thread_policy_set_element_policy (GstThreadPolicy * policy,
+    const gchar * element_name, GstThreadPolicy * element_policy)
+{
+  g_return_if_fail (GST_IS_THREAD_POLICY (policy));
+  g_return_if_fail (element_name != NULL);
+  g_return_if_fail (element_policy == NULL
+      || GST_IS_THREAD_POLICY (element_policy));
+  g_return_if_fail (element_policy != policy);
+
+  GST_OBJECT_LOCK (policy);
+  if (element_policy)
+    g_hash_table_insert (policy->priv->overrides, g_strdup (element_name),
+        gst_object_ref (element_policy));
+  else
+    g_hash_table_remove (policy->priv->overrides, element_name);
+  GST_OBJECT_UNLOCK (policy);
+}
+
+/**
+ * gst_thread_policy_get_element_policy:
+ * @policy: a #GstThreadPolicy
+ * @element_name: the name of an element
+ *
+ * Get the policy configured for the element named @element_name with
+ * gst_thread_policy_set_element_policy().
+ *
+ * Returns: (transfer full) (nullable): the #GstThreadPolicy of the element or
+ * %NULL. Unref after usage.
+ *
+ * Since: 1.14
+ */
+GstThreadPolicy *
+gst_thread_policy_get_element_policy (GstThreadPolicy * policy,
+    const gchar * element_name)
+{
+  GstThreadPolicy *result;
+
+  g_return_val_if_fail (GST_IS_THREAD_POLICY (policy), NULL);
+  g_return_val_if_fail (element_name != NULL, NULL);
+
+  GST_OBJECT_LOCK (policy);
+  if ((result = g_hash_table_lookup (policy->priv->overrides, element_name)))
+    gst_object_ref (result);
+  GST_OBJECT_UNLOCK (policy);
+
+  return result;
+}
+
+/**
+ * gst_thread_policy_apply:
+ * @policy: a #GstThreadPolicy
+ *
+ * Apply the CPU set and the priority of @policy to the calling thread. This
+ * can be used for the threads an application or element creates itself,
+ * the tasks of a pipeline configure their threads themselves.
+ *
+ * Returns: %TRUE when the policy could be applied, %FALSE when the system
+ * refused it or does not support it.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_thread_policy_apply (GstThreadPolicy * policy)
+{
+  gboolean res = TRUE;
+  guint *cpus;
+  guint n_cpus;
+  gint priority;
+
+  g_return_val_if_fail (GST_IS_THREAD_POLICY (policy), FALSE);
+
+  cpus = gst_thread_policy_get_cpus (policy, &n_cpus);
+  priority = gst_thread_policy_get_priority (policy);
+
+  if (n_cpus > 0) {
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(__linux__)
+    cpu_set_t set;
+    guint i;
+
+    CPU_ZERO (&set);
+    for (i = 0; i < n_cpus; i++) {
+      if (cpus[i] < CPU_SETSIZE)
+        CPU_SET (cpus[i], &set);
+      else
+        GST_WARNING_OBJECT (policy, "ignoring invalid CPU %u", cpus[i]);
+    }
+    if (sched_setaffinity (0, sizeof (set), &set) != 0) {
+      GST_WARNING_OBJECT (policy, "failed to set the CPU affinity: %s",
+          g_strerror (errno));
+      res = FALSE;
+    }
+#else
+    GST_WARNING_OBJECT (policy, "setting the CPU affinity is not supported");
+    res = FALSE;
+#endif
+  }
+
+  if (priority > 0) {
+#if defined(HAVE_SCHED_SETSCHEDULER) && defined(__linux__)
+    struct sched_param param = { 0, };
+
+    param.sched_priority = priority;
+    if (sched_setscheduler (0, SCHED_FIFO, &param) != 0) {
+      GST_WARNING_OBJECT (policy, "failed to set realtime priority %d: %s",
+          priority, g_strerror (errno));
+      res = FALSE;
+    }
+#else
+    GST_WARNING_OBJECT (policy, "realtime priorities are not supported");
+    res = FALSE;
+#endif
+  }
+
+  g_free (cpus);
+
+  return res;
+}
@@ -0,0 +1,115 @@
+/* GStreamer
+ *
+ * gstthreadpolicy.h: Threading policy for the streaming threads of a pipeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_THREAD_POLICY_H__
+#define __GST_THREAD_POLICY_H__
+
+#include <gst/gstobject.h>
+#include <gst/gsttaskpool.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_THREAD_POLICY             (gst_thread_policy_get_type ())
+#define GST_THREAD_POLICY(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), GST_TYPE_THREAD_POLICY, GstThreadPolicy))
+#define GST_IS_THREAD_POLICY(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GST_TYPE_THREAD_POLICY))
+#define GST_THREAD_POLICY_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), GST_TYPE_THREAD_POLICY, GstThreadPolicyClass))
+#define GST_IS_THREAD_POLICY_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), GST_TYPE_THREAD_POLICY))
+#define GST_THREAD_POLICY_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), GST_TYPE_THREAD_POLICY, GstThreadPolicyClass))
+#define GST_THREAD_POLICY_CAST(obj)        ((GstThreadPolicy*)(obj))
+
+typedef struct _GstThreadPolicy GstThreadPolicy;
+typedef struct _GstThreadPolicyClass GstThreadPolicyClass;
+typedef struct _GstThreadPolicyPrivate GstThreadPolicyPrivate;
+
+/**
+ * GstThreadPolicy:
+ *
+ * The #GstThreadPolicy object.
+ *
+ * Since: 1.14
+ */
+struct _GstThreadPolicy {
+  GstObject               object;
+
+  /*< private >*/
+  GstThreadPolicyPrivate *priv;
+
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+/**
+ * GstThreadPolicyClass:
+ * @parent_class: the parent class structure
+ *
+ * The #GstThreadPolicyClass object.
+ *
+ * Since: 1.14
+ */
+struct _GstThreadPolicyClass {
+  GstObjectClass parent_class;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+GST_EXPORT
+GType             gst_thread_policy_get_type          (void);
+
+GST_EXPORT
+GstThreadPolicy * gst_thread_policy_new               (void);
+
+GST_EXPORT
+void              gst_thread_policy_set_task_pool     (GstThreadPolicy * policy,
+                                                       GstTaskPool     * pool);
+GST_EXPORT
+GstTaskPool *     gst_thread_policy_get_task_pool     (GstThreadPolicy * policy);
+
+GST_EXPORT
+void              gst_thread_policy_set_cpus          (GstThreadPolicy * policy,
+                                                       const guint     * cpus,
+                                                       guint             n_cpus);
+GST_EXPORT
+guint *           gst_thread_policy_get_cpus          (GstThreadPolicy * policy,
+                                                       guint           * n_cpus);
+
+GST_EXPORT
+void              gst_thread_policy_set_priority      (GstThreadPolicy * policy,
+                                                       gint              priority);
+GST_EXPORT
+gint              gst_thread_policy_get_priority      (GstThreadPolicy * policy);
+
+GST_EXPORT
+void              gst_thread_policy_set_element_policy (GstThreadPolicy * policy,
+                                                        const gchar     * element_name,
+                                                        GstThreadPolicy * element_policy);
+GST_EXPORT
+GstThreadPolicy * gst_thread_policy_get_element_policy (GstThreadPolicy * policy,
+                                                        const gchar     * element_name);
+
+GST_EXPORT
+gboolean          gst_thread_policy_apply             (GstThreadPolicy * policy);
+
+#ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstThreadPolicy, gst_object_unref)
+#endif
+
+G_END_DECLS
+
+#endif /* __GST_THREAD_POLICY_H__ */
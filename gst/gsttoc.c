@@ -108,6 +108,10 @@ struct _GstToc
   GstTocScope scope;
   GList *entries;
   GstTagList *tags;
+
+  /* uid to the first #GstTocEntry with that uid, built on the first lookup
+   * and dropped when entries are added */
+  GHashTable *uids;
 };
 
 #undef gst_toc_copy
@@ -123,6 +127,16 @@ GType _gst_toc_entry_type = 0;
 GST_DEFINE_MINI_OBJECT_TYPE (GstToc, gst_toc);
 GST_DEFINE_MINI_OBJECT_TYPE (GstTocEntry, gst_toc_entry);
 
+static void
+gst_toc_invalidate_uids (GstToc * toc)
+{
+  GHashTable *uids;
+
+  uids = g_atomic_pointer_get (&toc->uids);
+  if (uids && g_atomic_pointer_compare_and_exchange (&toc->uids, uids, NULL))
+    g_hash_table_destroy (uids);
+}
+
 /**
  * gst_toc_new:
  * @scope: scope of this TOC
@@ -241,6 +255,7 @@ gst_toc_append_entry (GstToc * toc, GstTocEntry * entry)
 
   toc->entries = g_list_append (toc->entries, entry);
   entry->toc = toc;
+  gst_toc_invalidate_uids (toc);
 
   GST_LOG ("appended %s entry with uid %s to toc %p",
       gst_toc_entry_type_get_nick (entry->type), entry->uid, toc);
@@ -309,6 +324,9 @@ gst_toc_free (GstToc * toc)
   if (toc->tags != NULL)
     gst_tag_list_unref (toc->tags);
 
+  if (toc->uids != NULL)
+    g_hash_table_destroy (toc->uids);
+
   g_slice_free (GstToc, toc);
 }
 
@@ -328,30 +346,21 @@ gst_toc_entry_free (GstTocEntry * entry)
   g_slice_free (GstTocEntry, entry);
 }
 
-static GstTocEntry *
-gst_toc_entry_find_sub_entry (const GstTocEntry * entry, const gchar * uid)
+/* adds the entries of @entries and their sub-entries in depth-first order,
+ * so that the first entry with a uid is found like a recursive search */
+static void
+gst_toc_index_entries (GHashTable * uids, GList * entries)
 {
   GList *cur;
-  GstTocEntry *subentry, *subsubentry;
 
-  g_return_val_if_fail (entry != NULL, NULL);
-  g_return_val_if_fail (uid != NULL, NULL);
+  for (cur = entries; cur != NULL; cur = cur->next) {
+    GstTocEntry *entry = cur->data;
 
-  cur = entry->subentries;
-  while (cur != NULL) {
-    subentry = cur->data;
+    if (entry->uid && !g_hash_table_contains (uids, entry->uid))
+      g_hash_table_insert (uids, entry->uid, entry);
 
-    if (g_strcmp0 (subentry->uid, uid) == 0)
-      return subentry;
-
-    subsubentry = gst_toc_entry_find_sub_entry (subentry, uid);
-    if (subsubentry != NULL)
-      return subsubentry;
-
-    cur = cur->next;
+    gst_toc_index_entries (uids, entry->subentries);
   }
-
-  return NULL;
 }
 
 /**
@@ -361,42 +370,61 @@ gst_toc_entry_find_sub_entry (const GstTocEntry * entry, const gchar * uid)
  *
  * Find #GstTocEntry with given @uid in the @toc.
  *
+ * The first lookup indexes all entries of @toc, the following lookups don't
+ * depend on the number of entries until entries are added to @toc.
+ *
  * Returns: (transfer none) (nullable): #GstTocEntry with specified
  * @uid from the @toc, or %NULL if not found.
  */
 GstTocEntry *
 gst_toc_find_entry (const GstToc * toc, const gchar * uid)
 {
-  GList *cur;
-  GstTocEntry *entry, *subentry;
+  GstToc *self = (GstToc *) toc;
+  GHashTable *uids;
 
   g_return_val_if_fail (toc != NULL, NULL);
   g_return_val_if_fail (uid != NULL, NULL);
 
-  cur = toc->entries;
-  while (cur != NULL) {
-    entry = cur->data;
+  uids = g_atomic_pointer_get (&self->uids);
+  if (uids == NULL) {
+    /* a shared TOC can be searched from multiple threads, the first index
+     * that is stored wins */
+    uids = g_hash_table_new (g_str_hash, g_str_equal);
+    gst_toc_index_entries (uids, toc->entries);
+    if (!g_atomic_pointer_compare_and_exchange (&self->uids, NULL, uids)) {
+      g_hash_table_destroy (uids);
+      uids = g_atomic_pointer_get (&self->uids);
+    }
+  }
 
-    if (g_strcmp0 (entry->uid, uid) == 0)
-      return entry;
+  return g_hash_table_lookup (uids, uid);
+}
 
-    subentry = gst_toc_entry_find_sub_entry (entry, uid);
-    if (subentry != NULL)
-      return subentry;
-    cur = cur->next;
-  }
+static void
+gst_toc_entries_set_toc (GList * entries, GstToc * toc)
+{
+  GList *l;
+
+  for (l = entries; l != NULL; l = l->next) {
+    GstTocEntry *entry = l->data;
 
-  return NULL;
+    entry->toc = toc;
+    gst_toc_entries_set_toc (entry->subentries, toc);
+  }
 }
 
 static GList *
-gst_toc_deep_copy_toc_entries (GList * entry_list)
+gst_toc_deep_copy_toc_entries (GList * entry_list, GstTocEntry * parent)
 {
   GQueue new_entries = G_QUEUE_INIT;
   GList *l;
 
-  for (l = entry_list; l != NULL; l = l->next)
-    g_queue_push_tail (&new_entries, gst_toc_entry_copy (l->data));
+  for (l = entry_list; l != NULL; l = l->next) {
+    GstTocEntry *entry = gst_toc_entry_copy (l->data);
+
+    entry->parent = parent;
+    g_queue_push_tail (&new_entries, entry);
+  }
 
   return new_entries.head;
 }
@@ -405,7 +433,9 @@ gst_toc_deep_copy_toc_entries (GList * entry_list)
  * gst_toc_entry_copy:
  * @entry: #GstTocEntry to copy.
  *
- * Copy #GstTocEntry with all subentries (deep copy).
+ * Copy #GstTocEntry with all subentries (deep copy). The tags are shared
+ * with @entry, they are only copied when they are changed with
+ * gst_toc_entry_merge_tags().
  *
  * Returns: (nullable): newly allocated #GstTocEntry in case of
  * success, %NULL otherwise; free it when done with
@@ -415,7 +445,6 @@ static GstTocEntry *
 gst_toc_entry_copy (const GstTocEntry * entry)
 {
   GstTocEntry *ret;
-  GstTagList *list;
 
   g_return_val_if_fail (entry != NULL, NULL);
 
@@ -423,15 +452,13 @@ gst_toc_entry_copy (const GstTocEntry * entry)
 
   ret->start = entry->start;
   ret->stop = entry->stop;
+  ret->loop_type = entry->loop_type;
+  ret->repeat_count = entry->repeat_count;
 
-  if (GST_IS_TAG_LIST (entry->tags)) {
-    list = gst_tag_list_copy (entry->tags);
-    if (ret->tags)
-      gst_tag_list_unref (ret->tags);
-    ret->tags = list;
-  }
+  if (GST_IS_TAG_LIST (entry->tags))
+    ret->tags = gst_tag_list_ref (entry->tags);
 
-  ret->subentries = gst_toc_deep_copy_toc_entries (entry->subentries);
+  ret->subentries = gst_toc_deep_copy_toc_entries (entry->subentries, ret);
 
   return ret;
 }
@@ -440,7 +467,8 @@ gst_toc_entry_copy (const GstTocEntry * entry)
  * gst_toc_copy:
  * @toc: #GstToc to copy.
  *
- * Copy #GstToc with all subentries (deep copy).
+ * Copy #GstToc with all subentries (deep copy). The tags of the TOC and of
+ * the entries are shared with @toc until they are changed.
  *
  * Returns: (nullable): newly allocated #GstToc in case of success,
  * %NULL otherwise; free it when done with gst_toc_unref().
@@ -449,19 +477,18 @@ static GstToc *
 gst_toc_copy (const GstToc * toc)
 {
   GstToc *ret;
-  GstTagList *list;
 
   g_return_val_if_fail (toc != NULL, NULL);
 
   ret = gst_toc_new (toc->scope);
 
   if (GST_IS_TAG_LIST (toc->tags)) {
-    list = gst_tag_list_copy (toc->tags);
     gst_tag_list_unref (ret->tags);
-    ret->tags = list;
+    ret->tags = gst_tag_list_ref (toc->tags);
   }
 
-  ret->entries = gst_toc_deep_copy_toc_entries (toc->entries);
+  ret->entries = gst_toc_deep_copy_toc_entries (toc->entries, NULL);
+  gst_toc_entries_set_toc (ret->entries, ret);
 
   return ret;
 }
@@ -677,6 +704,13 @@ gst_toc_entry_append_sub_entry (GstTocEntry * entry, GstTocEntry * subentry)
   subentry->toc = entry->toc;
   subentry->parent = entry;
 
+  /* sub-entries added before their parent was added to a TOC don't know
+   * the TOC, the top-level entry does */
+  while (entry->parent)
+    entry = entry->parent;
+  if (entry->toc)
+    gst_toc_invalidate_uids (entry->toc);
+
   GST_LOG ("appended %s subentry with uid %s to entry %s",
       gst_toc_entry_type_get_nick (subentry->type), subentry->uid, entry->uid);
 }
@@ -25,6 +25,7 @@
 #include <glib.h>
 #include <glib-object.h>
 #include <gst/gstobject.h>
+#include <gst/gstelement.h>
 #include <gst/gstconfig.h>
 
 G_BEGIN_DECLS
@@ -58,12 +59,33 @@ struct _GstTracerClass {
 GST_EXPORT
 GType gst_tracer_get_type          (void);
 
+/* hooks for elements */
+
+GST_EXPORT
+void gst_tracing_queue_level (GstElement *queue, GstPad *pad, guint buffers,
+  guint64 bytes, guint64 time);
+
+GST_EXPORT
+void gst_tracing_queue_wait_pre (GstElement *queue, GstPad *pad,
+  gboolean full);
+
+GST_EXPORT
+void gst_tracing_queue_wait_post (GstElement *queue, GstPad *pad,
+  gboolean full);
+
 #ifdef GST_USE_UNSTABLE_API
 
 GST_EXPORT
 void gst_tracing_register_hook (GstTracer *tracer, const gchar *detail,
   GCallback func);
 
+GST_EXPORT
+void gst_tracing_register_sampled_hook (GstTracer *tracer, const gchar *detail,
+  GCallback func);
+
+GST_EXPORT
+void gst_tracing_set_sampling (guint interval, GstClockTime period);
+
 /* tracing modules */
 
 GST_EXPORT
@@ -27,6 +27,11 @@
  * The user can activate tracers by setting the environment variable GST_TRACE
  * to a ';' separated list of tracers.
  *
+ * Tracers can register hooks that are only called for a sample of the buffer
+ * flow with gst_tracing_register_sampled_hook(). The environment variable
+ * GST_TRACERS_SAMPLING configures the rate, as "N" to sample 1 in N buffers or
+ * as "Nms" to sample one buffer every N milliseconds.
+ *
  * Note that instanciating tracers at runtime is possible but is not thread safe
  * and needs to be done before any pipeline state is set to PAUSED.
  */
@@ -56,7 +61,8 @@ static const gchar *_quark_strings[] = {
   "element-change-state-pre", "element-change-state-post",
   "mini-object-created", "mini-object-destroyed", "object-created",
   "object-destroyed", "mini-object-reffed", "mini-object-unreffed",
-  "object-reffed", "object-unreffed",
+  "object-reffed", "object-unreffed", "queue-level", "queue-wait-pre",
+  "queue-wait-post", "object-lock-wait", "graph-stats"
 };
 
 GQuark _priv_gst_tracer_quark_table[GST_TRACER_QUARK_MAX];
@@ -65,6 +71,35 @@ GQuark _priv_gst_tracer_quark_table[GST_TRACER_QUARK_MAX];
 
 gboolean _priv_tracer_enabled = FALSE;
 GHashTable *_priv_tracers = NULL;
+gint _priv_tracer_n_unsampled[GST_TRACER_QUARK_MAX] = { 0, };
+
+/* sample everything by default */
+static guint sample_interval = 1;
+static GstClockTime sample_period = 0;
+static volatile gint sample_count = 0;
+static volatile gint sample_slot = -1;
+
+/* Decides if the next buffer is sampled, this is called for every buffer
+ * flow hook once any tracer is active */
+gboolean
+_priv_gst_tracer_sample (void)
+{
+  if (sample_period != 0) {
+    gint slot, last;
+
+    /* the first buffer of each period is sampled */
+    slot = (gint) (gst_util_get_timestamp () / sample_period);
+    last = g_atomic_int_get (&sample_slot);
+
+    return slot != last &&
+        g_atomic_int_compare_and_exchange (&sample_slot, last, slot);
+  }
+
+  if (sample_interval > 1)
+    return ((guint) g_atomic_int_add (&sample_count, 1)) % sample_interval == 0;
+
+  return TRUE;
+}
 
 /* Initialize the tracing system */
 void
@@ -72,6 +107,7 @@ _priv_gst_tracing_init (void)
 {
   gint i = 0;
   const gchar *env = g_getenv ("GST_TRACERS");
+  const gchar *sampling = g_getenv ("GST_TRACERS_SAMPLING");
 
   /* We initialize the tracer sub system even if the end
    * user did not activate it through the env variable
@@ -88,6 +124,18 @@ _priv_gst_tracing_init (void)
         g_quark_from_static_string (_quark_strings[i]);
   }
 
+  if (sampling != NULL && *sampling != '\0') {
+    gchar *end;
+    guint64 val = g_ascii_strtoull (sampling, &end, 10);
+
+    if (g_str_equal (end, "ms"))
+      gst_tracing_set_sampling (1, val * GST_MSECOND);
+    else if (*end == '\0' && val <= G_MAXUINT)
+      gst_tracing_set_sampling (val, 0);
+    else
+      GST_WARNING ("invalid tracer sampling '%s'", sampling);
+  }
+
   if (env != NULL && *env != '\0') {
     GstRegistry *registry = gst_registry_get ();
     GstPluginFeature *feature;
@@ -162,21 +210,35 @@ _priv_gst_tracing_deinit (void)
   g_list_free (h_list);
   g_hash_table_destroy (_priv_tracers);
   _priv_tracers = NULL;
+  memset (_priv_tracer_n_unsampled, 0, sizeof (_priv_tracer_n_unsampled));
 }
 
 static void
-gst_tracing_register_hook_id (GstTracer * tracer, GQuark detail, GCallback func)
+gst_tracing_register_hook_id (GstTracer * tracer, GQuark detail, GCallback func,
+    gboolean sampled)
 {
   gpointer key = GINT_TO_POINTER (detail);
   GList *list = g_hash_table_lookup (_priv_tracers, key);
   GstTracerHook *hook = g_slice_new0 (GstTracerHook);
   hook->tracer = gst_object_ref (tracer);
   hook->func = func;
+  hook->sampled = sampled;
 
   list = g_list_prepend (list, hook);
   g_hash_table_replace (_priv_tracers, key, list);
-  GST_DEBUG ("registering tracer for '%s', list.len=%d",
+  GST_DEBUG ("registering %stracer for '%s', list.len=%d",
+      (sampled ? "sampled " : ""),
       (detail ? g_quark_to_string (detail) : "*"), g_list_length (list));
+  if (!sampled) {
+    gint i;
+
+    /* count the hook per hook-id, so that unsampled buffers of other hooks
+     * still skip the dispatch */
+    for (i = 0; i < GST_TRACER_QUARK_MAX; i++) {
+      if (!detail || _priv_gst_tracer_quark_table[i] == detail)
+        _priv_tracer_n_unsampled[i]++;
+    }
+  }
   _priv_tracer_enabled = TRUE;
 }
 
@@ -193,7 +255,112 @@ void
 gst_tracing_register_hook (GstTracer * tracer, const gchar * detail,
     GCallback func)
 {
-  gst_tracing_register_hook_id (tracer, g_quark_try_string (detail), func);
+  gst_tracing_register_hook_id (tracer, g_quark_try_string (detail), func,
+      FALSE);
+}
+
+/**
+ * gst_tracing_register_sampled_hook:
+ * @tracer: the tracer
+ * @detail: the detailed hook
+ * @func: (scope async): the callback
+ *
+ * Like gst_tracing_register_hook(), but the buffer flow hooks "pad-push-pre",
+ * "pad-push-post", "pad-push-list-pre", "pad-push-list-post",
+ * "pad-pull-range-pre" and "pad-pull-range-post" only call @func for the
+ * buffers that are sampled, see gst_tracing_set_sampling(). The pre- and
+ * post-hooks of one call are either both called or both skipped. All other
+ * hooks are always called.
+ *
+ * Since: 1.14
+ */
+void
+gst_tracing_register_sampled_hook (GstTracer * tracer, const gchar * detail,
+    GCallback func)
+{
+  gst_tracing_register_hook_id (tracer, g_quark_try_string (detail), func,
+      TRUE);
+}
+
+/**
+ * gst_tracing_set_sampling:
+ * @interval: sample 1 in @interval buffers
+ * @period: sample one buffer per @period, or 0
+ *
+ * Configures which buffers are passed to the hooks registered with
+ * gst_tracing_register_sampled_hook(). If @period is not 0 the first buffer
+ * of every @period is sampled and @interval is ignored, otherwise every
+ * @interval-th buffer is sampled. An @interval of 0 or 1 samples all buffers.
+ *
+ * The default can be set with the GST_TRACERS_SAMPLING environment variable.
+ *
+ * Since: 1.14
+ */
+void
+gst_tracing_set_sampling (guint interval, GstClockTime period)
+{
+  GST_DEBUG ("sampling 1 in %u buffers, period %" GST_TIME_FORMAT, interval,
+      GST_TIME_ARGS (period));
+
+  sample_interval = MAX (interval, 1);
+  sample_period = GST_CLOCK_TIME_IS_VALID (period) ? period : 0;
 }
 
 #endif /* GST_DISABLE_GST_TRACER_HOOKS */
+
+/* hooks for elements outside of the core */
+
+/**
+ * gst_tracing_queue_level:
+ * @queue: the queue element
+ * @pad: the src pad of @queue that the level belongs to
+ * @buffers: the number of queued buffers
+ * @bytes: the number of queued bytes
+ * @time: the amount of queued data in ns
+ *
+ * Queue elements call this after their level changed, to run the
+ * "queue-level" tracer hooks.
+ *
+ * Since: 1.14
+ */
+void
+gst_tracing_queue_level (GstElement * queue, GstPad * pad, guint buffers,
+    guint64 bytes, guint64 time)
+{
+  GST_TRACER_QUEUE_LEVEL (queue, pad, buffers, bytes, time);
+}
+
+/**
+ * gst_tracing_queue_wait_pre:
+ * @queue: the queue element
+ * @pad: the src pad of @queue that waits
+ * @full: %TRUE if the upstream side waits for space, %FALSE if the downstream
+ *   side waits for data
+ *
+ * Queue elements call this before they block, to run the "queue-wait-pre"
+ * tracer hooks.
+ *
+ * Since: 1.14
+ */
+void
+gst_tracing_queue_wait_pre (GstElement * queue, GstPad * pad, gboolean full)
+{
+  GST_TRACER_QUEUE_WAIT_PRE (queue, pad, full);
+}
+
+/**
+ * gst_tracing_queue_wait_post:
+ * @queue: the queue element
+ * @pad: the src pad of @queue that waited
+ * @full: the same as for gst_tracing_queue_wait_pre()
+ *
+ * Queue elements call this after they stopped blocking, to run the
+ * "queue-wait-post" tracer hooks.
+ *
+ * Since: 1.14
+ */
+void
+gst_tracing_queue_wait_post (GstElement * queue, GstPad * pad, gboolean full)
+{
+  GST_TRACER_QUEUE_WAIT_POST (queue, pad, full);
+}
@@ -79,6 +79,11 @@ typedef enum /*< skip >*/
   GST_TRACER_QUARK_HOOK_MINI_OBJECT_UNREFFED,
   GST_TRACER_QUARK_HOOK_OBJECT_REFFED,
   GST_TRACER_QUARK_HOOK_OBJECT_UNREFFED,
+  GST_TRACER_QUARK_HOOK_QUEUE_LEVEL,
+  GST_TRACER_QUARK_HOOK_QUEUE_WAIT_PRE,
+  GST_TRACER_QUARK_HOOK_QUEUE_WAIT_POST,
+  GST_TRACER_QUARK_HOOK_OBJECT_LOCK_WAIT,
+  GST_TRACER_QUARK_HOOK_GRAPH_STATS,
   GST_TRACER_QUARK_MAX
 } GstTracerQuarkId;
 
@@ -91,36 +96,60 @@ extern GQuark _priv_gst_tracer_quark_table[GST_TRACER_QUARK_MAX];
 typedef struct {
   GObject *tracer;
   GCallback func;
+  /* only called for sampled buffers */
+  gboolean sampled;
 } GstTracerHook;
 
 extern gboolean _priv_tracer_enabled;
 /* key are hook-id quarks, values are GstTracerHook */
 extern GHashTable *_priv_tracers;
+/* number of hooks per hook-id that are called for all buffers, hooks
+ * registered for all hook-ids are counted in every slot */
+extern gint _priv_tracer_n_unsampled[GST_TRACER_QUARK_MAX];
+
+gboolean _priv_gst_tracer_sample (void);
 
 #define GST_TRACER_IS_ENABLED (_priv_tracer_enabled)
 
+/* decides if the hooks of a buffer, buffer-list or pull-range call are
+ * sampled, the decision is kept in a local for the pre- and post-hooks */
+#define GST_TRACER_SAMPLE_DECLARE(sampled) gboolean sampled = FALSE
+#define GST_TRACER_SAMPLE(sampled) \
+  sampled = GST_TRACER_IS_ENABLED && _priv_gst_tracer_sample ()
+
 #define GST_TRACER_TS \
   GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ())
 
 /* tracing hooks */
 
 #define GST_TRACER_ARGS h->tracer, ts
-#define GST_TRACER_DISPATCH(key,type,args) G_STMT_START{ \
-  if (GST_TRACER_IS_ENABLED) {                                         \
+#define GST_TRACER_DISPATCH_HOOKS(key,is_sampled,type,args) G_STMT_START{ \
     GstClockTime ts = GST_TRACER_TS;                                   \
     GList *__l, *__n;                                                  \
     GstTracerHook *h;                                                  \
     __l = g_hash_table_lookup (_priv_tracers, GINT_TO_POINTER (key));  \
     for (__n = __l; __n; __n = g_list_next (__n)) {                    \
       h = (GstTracerHook *) __n->data;                                 \
-      ((type)(h->func)) args;                                          \
+      if (is_sampled || !h->sampled)                                   \
+        ((type)(h->func)) args;                                        \
     }                                                                  \
     __l = g_hash_table_lookup (_priv_tracers, NULL);                   \
     for (__n = __l; __n; __n = g_list_next (__n)) {                    \
       h = (GstTracerHook *) __n->data;                                 \
-      ((type)(h->func)) args;                                          \
+      if (is_sampled || !h->sampled)                                   \
+        ((type)(h->func)) args;                                        \
     }                                                                  \
-  }                                                                    \
+}G_STMT_END
+#define GST_TRACER_DISPATCH(key,type,args) G_STMT_START{ \
+  if (GST_TRACER_IS_ENABLED)                                           \
+    GST_TRACER_DISPATCH_HOOKS(key,TRUE,type,args);                     \
+}G_STMT_END
+/* @id is the hook-id without the GST_TRACER_QUARK_ prefix, unsampled calls
+ * are skipped unless a hook for this id wants to see all buffers */
+#define GST_TRACER_DISPATCH_SAMPLED(id,is_sampled,type,args) G_STMT_START{ \
+  if (GST_TRACER_IS_ENABLED && (is_sampled ||                          \
+          _priv_tracer_n_unsampled[GST_TRACER_QUARK_##id]))            \
+    GST_TRACER_DISPATCH_HOOKS(GST_TRACER_QUARK(id),is_sampled,type,args); \
 }G_STMT_END
 
 /**
@@ -134,8 +163,9 @@ extern GHashTable *_priv_tracers;
  */
 typedef void (*GstTracerHookPadPushPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBuffer *buffer);
-#define GST_TRACER_PAD_PUSH_PRE(pad, buffer) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_PRE), \
+#define GST_TRACER_PAD_PUSH_PRE(pad, buffer, sampled) G_STMT_START{ \
+  GST_TRACER_SAMPLE (sampled); \
+  GST_TRACER_DISPATCH_SAMPLED(HOOK_PAD_PUSH_PRE, sampled, \
     GstTracerHookPadPushPre, (GST_TRACER_ARGS, pad, buffer)); \
 }G_STMT_END
 
@@ -150,8 +180,8 @@ typedef void (*GstTracerHookPadPushPre) (GObject *self, GstClockTime ts,
  */
 typedef void (*GstTracerHookPadPushPost) (GObject * self, GstClockTime ts,
     GstPad *pad, GstFlowReturn res);
-#define GST_TRACER_PAD_PUSH_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_POST), \
+#define GST_TRACER_PAD_PUSH_POST(pad, res, sampled) G_STMT_START{ \
+  GST_TRACER_DISPATCH_SAMPLED(HOOK_PAD_PUSH_POST, sampled, \
     GstTracerHookPadPushPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
@@ -166,9 +196,10 @@ typedef void (*GstTracerHookPadPushPost) (GObject * self, GstClockTime ts,
  */
 typedef void (*GstTracerHookPadPushListPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBufferList *list);
-#define GST_TRACER_PAD_PUSH_LIST_PRE(pad, list) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_LIST_PRE), \
-    GstTracerHookPadPushListPre, (GST_TRACER_ARGS, pad, list)); \
+#define GST_TRACER_PAD_PUSH_LIST_PRE(pad, list, sampled) G_STMT_START{ \
+  GST_TRACER_SAMPLE (sampled); \
+  GST_TRACER_DISPATCH_SAMPLED(HOOK_PAD_PUSH_LIST_PRE, \
+    sampled, GstTracerHookPadPushListPre, (GST_TRACER_ARGS, pad, list)); \
 }G_STMT_END
 
 /**
@@ -183,9 +214,9 @@ typedef void (*GstTracerHookPadPushListPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushListPost) (GObject *self, GstClockTime ts,
     GstPad *pad,
     GstFlowReturn res);
-#define GST_TRACER_PAD_PUSH_LIST_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_LIST_POST), \
-    GstTracerHookPadPushListPost, (GST_TRACER_ARGS, pad, res)); \
+#define GST_TRACER_PAD_PUSH_LIST_POST(pad, res, sampled) G_STMT_START{ \
+  GST_TRACER_DISPATCH_SAMPLED(HOOK_PAD_PUSH_LIST_POST, \
+    sampled, GstTracerHookPadPushListPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
 /**
@@ -200,9 +231,10 @@ typedef void (*GstTracerHookPadPushListPost) (GObject *self, GstClockTime ts,
  */
 typedef void (*GstTracerHookPadPullRangePre) (GObject *self, GstClockTime ts,
     GstPad *pad, guint64 offset, guint size);
-#define GST_TRACER_PAD_PULL_RANGE_PRE(pad, offset, size) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PULL_RANGE_PRE), \
-    GstTracerHookPadPullRangePre, (GST_TRACER_ARGS, pad, offset, size)); \
+#define GST_TRACER_PAD_PULL_RANGE_PRE(pad, offset, size, sampled) G_STMT_START{ \
+  GST_TRACER_SAMPLE (sampled); \
+  GST_TRACER_DISPATCH_SAMPLED(HOOK_PAD_PULL_RANGE_PRE, \
+    sampled, GstTracerHookPadPullRangePre, (GST_TRACER_ARGS, pad, offset, size)); \
 }G_STMT_END
 
 /**
@@ -217,9 +249,9 @@ typedef void (*GstTracerHookPadPullRangePre) (GObject *self, GstClockTime ts,
  */
 typedef void (*GstTracerHookPadPullRangePost) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBuffer *buffer, GstFlowReturn res);
-#define GST_TRACER_PAD_PULL_RANGE_POST(pad, buffer, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PULL_RANGE_POST), \
-    GstTracerHookPadPullRangePost, (GST_TRACER_ARGS, pad, buffer, res)); \
+#define GST_TRACER_PAD_PULL_RANGE_POST(pad, buffer, res, sampled) G_STMT_START{ \
+  GST_TRACER_DISPATCH_SAMPLED(HOOK_PAD_PULL_RANGE_POST, \
+    sampled, GstTracerHookPadPullRangePost, (GST_TRACER_ARGS, pad, buffer, res)); \
 }G_STMT_END
 
 /**
@@ -694,15 +726,121 @@ typedef void (*GstTracerHookObjectDestroyed) (GObject *self, GstClockTime ts,
     GstTracerHookObjectDestroyed, (GST_TRACER_ARGS, object)); \
 }G_STMT_END
 
+/**
+ * GstTracerHookQueueLevel:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @queue: the queue element
+ * @pad: the src pad of the queue
+ * @buffers: the number of queued buffers
+ * @bytes: the number of queued bytes
+ * @time: the amount of queued data in ns
+ *
+ * Hook called by queue elements after their level changed named
+ * "queue-level". The queue lock can be held while it is called.
+ */
+typedef void (*GstTracerHookQueueLevel) (GObject *self, GstClockTime ts,
+    GstElement *queue, GstPad *pad, guint buffers, guint64 bytes,
+    guint64 time);
+#define GST_TRACER_QUEUE_LEVEL(queue, pad, buffers, bytes, time) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_QUEUE_LEVEL), \
+    GstTracerHookQueueLevel, (GST_TRACER_ARGS, queue, pad, buffers, bytes, \
+        time)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookQueueWaitPre:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @queue: the queue element
+ * @pad: the src pad of the queue
+ * @full: %TRUE if the upstream side waits for space, %FALSE if the
+ *   downstream side waits for data
+ *
+ * Hook called by queue elements before they block named "queue-wait-pre".
+ */
+typedef void (*GstTracerHookQueueWaitPre) (GObject *self, GstClockTime ts,
+    GstElement *queue, GstPad *pad, gboolean full);
+#define GST_TRACER_QUEUE_WAIT_PRE(queue, pad, full) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_QUEUE_WAIT_PRE), \
+    GstTracerHookQueueWaitPre, (GST_TRACER_ARGS, queue, pad, full)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookQueueWaitPost:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @queue: the queue element
+ * @pad: the src pad of the queue
+ * @full: the same as for the "queue-wait-pre" hook
+ *
+ * Hook called by queue elements after they were woken up named
+ * "queue-wait-post". It can also be called without a matching pre-hook.
+ */
+typedef void (*GstTracerHookQueueWaitPost) (GObject *self, GstClockTime ts,
+    GstElement *queue, GstPad *pad, gboolean full);
+#define GST_TRACER_QUEUE_WAIT_POST(queue, pad, full) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_QUEUE_WAIT_POST), \
+    GstTracerHookQueueWaitPost, (GST_TRACER_ARGS, queue, pad, full)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookObjectLockWait:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @object: the object that owns the lock
+ * @lock: the name of the lock, "object" for GST_OBJECT_LOCK(), "stream" for
+ *   GST_PAD_STREAM_LOCK() and "state" for GST_STATE_LOCK()
+ * @wait: how long it took to take the lock
+ *
+ * Hook called after a contended lock was taken named "object-lock-wait".
+ * The lock is held while the hook runs, so it must not take it again. Only
+ * the locks the core takes in the data flow, state changes and bus posts
+ * are reported, uses of the lock macros outside the core are not.
+ */
+typedef void (*GstTracerHookObjectLockWait) (GObject *self, GstClockTime ts,
+    GstObject *object, const gchar *lock, GstClockTime wait);
+#define GST_TRACER_OBJECT_LOCK_WAIT(object, lock, wait) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_OBJECT_LOCK_WAIT), \
+    GstTracerHookObjectLockWait, (GST_TRACER_ARGS, object, lock, wait)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookGraphStats:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @object: the element or the src pad of a link
+ * @stats: the structure to add the statistics of @object to
+ *
+ * Hook called named "graph-stats" when gst_debug_bin_to_dot_data() is asked
+ * for #GST_DEBUG_GRAPH_SHOW_STATS. Tracers add what they measured for
+ * @object as fields to @stats, the fields that are shown in the graph are:
+ *
+ * For elements, "busy" (#G_TYPE_DOUBLE), the share of the time since the
+ * previous graph that the element was processing data, and for queues
+ * "level-buffers" (#G_TYPE_UINT), "level-bytes" (#G_TYPE_UINT64) and
+ * "level-time" (#G_TYPE_UINT64).
+ *
+ * For pads, "buffers-per-second" and "bytes-per-second" (#G_TYPE_DOUBLE)
+ * and "allocation-pool" (#G_TYPE_STRING), a description of the negotiated
+ * buffer pool.
+ */
+typedef void (*GstTracerHookGraphStats) (GObject *self, GstClockTime ts,
+    GstObject *object, GstStructure *stats);
+#define GST_TRACER_GRAPH_STATS(object, stats) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_GRAPH_STATS), \
+    GstTracerHookGraphStats, (GST_TRACER_ARGS, object, stats)); \
+}G_STMT_END
 
 #else /* !GST_DISABLE_GST_TRACER_HOOKS */
 
-#define GST_TRACER_PAD_PUSH_PRE(pad, buffer)
-#define GST_TRACER_PAD_PUSH_POST(pad, res)
-#define GST_TRACER_PAD_PUSH_LIST_PRE(pad, list)
-#define GST_TRACER_PAD_PUSH_LIST_POST(pad, res)
-#define GST_TRACER_PAD_PULL_RANGE_PRE(pad, offset, size)
-#define GST_TRACER_PAD_PULL_RANGE_POST(pad, buffer, res)
+#define GST_TRACER_SAMPLE_DECLARE(sampled)
+#define GST_TRACER_PAD_PUSH_PRE(pad, buffer, sampled)
+#define GST_TRACER_PAD_PUSH_POST(pad, res, sampled)
+#define GST_TRACER_PAD_PUSH_LIST_PRE(pad, list, sampled)
+#define GST_TRACER_PAD_PUSH_LIST_POST(pad, res, sampled)
+#define GST_TRACER_PAD_PULL_RANGE_PRE(pad, offset, size, sampled)
+#define GST_TRACER_PAD_PULL_RANGE_POST(pad, buffer, res, sampled)
 #define GST_TRACER_PAD_PUSH_EVENT_PRE(pad, event)
 #define GST_TRACER_PAD_PUSH_EVENT_POST(pad, res)
 #define GST_TRACER_PAD_QUERY_PRE(pad, query)
@@ -732,6 +870,11 @@ typedef void (*GstTracerHookObjectDestroyed) (GObject *self, GstClockTime ts,
 #define GST_TRACER_OBJECT_DESTROYED(object)
 #define GST_TRACER_OBJECT_REFFED(object, new_refcount)
 #define GST_TRACER_OBJECT_UNREFFED(object, new_refcount)
+#define GST_TRACER_QUEUE_LEVEL(queue, pad, buffers, bytes, time)
+#define GST_TRACER_QUEUE_WAIT_PRE(queue, pad, full)
+#define GST_TRACER_QUEUE_WAIT_POST(queue, pad, full)
+#define GST_TRACER_OBJECT_LOCK_WAIT(object, lock, wait)
+#define GST_TRACER_GRAPH_STATS(object, stats)
 
 #endif /* GST_DISABLE_GST_TRACER_HOOKS */
 
@@ -64,6 +64,58 @@ gboolean
 gst_type_find_register (GstPlugin * plugin, const gchar * name, guint rank,
     GstTypeFindFunction func, const gchar * extensions,
     GstCaps * possible_caps, gpointer data, GDestroyNotify data_notify)
+{
+  return gst_type_find_register_with_prefixes (plugin, name, rank, func,
+      extensions, NULL, possible_caps, data, data_notify);
+}
+
+static gboolean
+gst_type_find_prefix_is_valid (const gchar * prefix)
+{
+  gsize i, len = strlen (prefix);
+
+  if (len == 0 || len % 2 != 0)
+    return FALSE;
+
+  for (i = 0; i < len; i++) {
+    if (!g_ascii_isxdigit (prefix[i]))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+ * gst_type_find_register_with_prefixes:
+ * @plugin: (allow-none): A #GstPlugin, or %NULL for a static typefind function
+ * @name: The name for registering
+ * @rank: The rank (or importance) of this typefind function
+ * @func: The #GstTypeFindFunction to use
+ * @extensions: (allow-none): Optional comma-separated list of extensions
+ *     that could belong to this type
+ * @prefixes: (allow-none): Optional comma-separated list of byte sequences,
+ *     written as hexadecimal digits like "1a45dfa3", that streams of this
+ *     type start with
+ * @possible_caps: Optionally the caps that could be returned when typefinding
+ *                 succeeds
+ * @data: Optional user data. This user data must be available until the plugin
+ *        is unloaded.
+ * @data_notify: a #GDestroyNotify that will be called on @data when the plugin
+ *        is unloaded.
+ *
+ * Registers a new typefind function like gst_type_find_register(). Typefind
+ * helpers first try the functions whose @prefixes match the start of the
+ * data and only then all others, so only types that can always be recognized
+ * by their first bytes should declare prefixes.
+ *
+ * Returns: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_type_find_register_with_prefixes (GstPlugin * plugin, const gchar * name,
+    guint rank, GstTypeFindFunction func, const gchar * extensions,
+    const gchar * prefixes, GstCaps * possible_caps, gpointer data,
+    GDestroyNotify data_notify)
 {
   GstTypeFindFactory *factory;
 
@@ -80,6 +132,26 @@ gst_type_find_register (GstPlugin * plugin, const gchar * name, guint rank,
   if (extensions)
     factory->extensions = g_strsplit (extensions, ",", -1);
 
+  if (prefixes) {
+    gchar **list = g_strsplit (prefixes, ",", -1);
+    guint i, n = 0;
+
+    for (i = 0; list[i]; i++) {
+      if (gst_type_find_prefix_is_valid (list[i])) {
+        list[n++] = list[i];
+      } else {
+        GST_WARNING_OBJECT (factory, "ignoring invalid prefix '%s'", list[i]);
+        g_free (list[i]);
+      }
+    }
+    list[n] = NULL;
+
+    if (n > 0)
+      factory->prefixes = list;
+    else
+      g_free (list);
+  }
+
   gst_caps_replace (&factory->caps, possible_caps);
   factory->function = func;
   factory->user_data = data;
@@ -124,6 +124,17 @@ gboolean  gst_type_find_register   (GstPlugin            * plugin,
                                     gpointer               data,
                                     GDestroyNotify         data_notify);
 
+GST_EXPORT
+gboolean  gst_type_find_register_with_prefixes (GstPlugin            * plugin,
+                                                const gchar          * name,
+                                                guint                  rank,
+                                                GstTypeFindFunction    func,
+                                                const gchar          * extensions,
+                                                const gchar          * prefixes,
+                                                GstCaps              * possible_caps,
+                                                gpointer               data,
+                                                GDestroyNotify         data_notify);
+
 G_END_DECLS
 
 #endif /* __GST_TYPE_FIND_H__ */
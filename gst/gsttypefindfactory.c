@@ -120,10 +120,15 @@ gst_type_find_factory_dispose (GObject * object)
     gst_caps_unref (factory->caps);
     factory->caps = NULL;
   }
+  factory->caps_string = NULL;
   if (factory->extensions) {
     g_strfreev (factory->extensions);
     factory->extensions = NULL;
   }
+  if (factory->prefixes) {
+    g_strfreev (factory->prefixes);
+    factory->prefixes = NULL;
+  }
   if (factory->user_data_notify && factory->user_data) {
     factory->user_data_notify (factory->user_data);
     factory->user_data = NULL;
@@ -164,9 +169,27 @@ gst_type_find_factory_get_list (void)
 GstCaps *
 gst_type_find_factory_get_caps (GstTypeFindFactory * factory)
 {
+  GstCaps *caps;
+
   g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), NULL);
 
-  return factory->caps;
+  caps = g_atomic_pointer_get (&factory->caps);
+
+  /* the caps of factories loaded from the registry cache are only parsed
+   * the first time they are needed */
+  if (G_UNLIKELY (caps == NULL && factory->caps_string != NULL)) {
+    caps = gst_caps_from_string (factory->caps_string);
+    if (caps == NULL) {
+      GST_WARNING_OBJECT (factory, "invalid caps '%s'", factory->caps_string);
+      return NULL;
+    }
+    if (!g_atomic_pointer_compare_and_exchange (&factory->caps, NULL, caps)) {
+      /* someone else was faster */
+      gst_caps_unref (caps);
+      caps = g_atomic_pointer_get (&factory->caps);
+    }
+  }
+  return caps;
 }
 
 /**
@@ -189,6 +212,78 @@ gst_type_find_factory_get_extensions (GstTypeFindFactory * factory)
   return (const gchar * const *) factory->extensions;
 }
 
+/**
+ * gst_type_find_factory_get_prefixes:
+ * @factory: A #GstTypeFindFactory
+ *
+ * Gets the byte sequences that streams handled by the typefind function of
+ * @factory start with, in hexadecimal notation. See
+ * gst_type_find_register_with_prefixes().  This function may return %NULL
+ * to indicate a 0-length list.
+ *
+ * Returns: (transfer none) (array zero-terminated=1) (element-type utf8) (nullable):
+ *     a %NULL-terminated array of prefixes associated with this factory
+ *
+ * Since: 1.14
+ */
+const gchar *const *
+gst_type_find_factory_get_prefixes (GstTypeFindFactory * factory)
+{
+  g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), NULL);
+
+  return (const gchar * const *) factory->prefixes;
+}
+
+/**
+ * gst_type_find_factory_match_prefixes:
+ * @factory: A #GstTypeFindFactory
+ * @find: (transfer none): a properly setup #GstTypeFind entry. The get_data
+ *     member must be set.
+ *
+ * Checks if the data of @find starts with one of the prefixes of @factory,
+ * without loading the plugin of @factory.
+ *
+ * Returns: %TRUE if one of the prefixes matches, %FALSE if none does or
+ *     @factory has no prefixes
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_type_find_factory_match_prefixes (GstTypeFindFactory * factory,
+    GstTypeFind * find)
+{
+  gchar **prefix;
+
+  g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), FALSE);
+  g_return_val_if_fail (find != NULL, FALSE);
+  g_return_val_if_fail (find->peek != NULL, FALSE);
+
+  if (factory->prefixes == NULL)
+    return FALSE;
+
+  for (prefix = factory->prefixes; *prefix; prefix++) {
+    const gchar *hex = *prefix;
+    guint i, len = strlen (hex) / 2;
+    const guint8 *data;
+
+    data = gst_type_find_peek (find, 0, len);
+    if (data == NULL)
+      continue;
+
+    /* the prefixes were validated on registration */
+    for (i = 0; i < len; i++) {
+      guint8 val = (g_ascii_xdigit_value (hex[2 * i]) << 4) |
+          g_ascii_xdigit_value (hex[2 * i + 1]);
+
+      if (data[i] != val)
+        break;
+    }
+    if (i == len)
+      return TRUE;
+  }
+  return FALSE;
+}
+
 /**
  * gst_type_find_factory_call_function:
  * @factory: A #GstTypeFindFactory
@@ -58,6 +58,13 @@ const gchar * const * gst_type_find_factory_get_extensions (GstTypeFindFactory *
 GST_EXPORT
 GstCaps *       gst_type_find_factory_get_caps          (GstTypeFindFactory *factory);
 
+GST_EXPORT
+const gchar * const * gst_type_find_factory_get_prefixes (GstTypeFindFactory *factory);
+
+GST_EXPORT
+gboolean        gst_type_find_factory_match_prefixes    (GstTypeFindFactory *factory,
+                                                         GstTypeFind *find);
+
 GST_EXPORT
 gboolean        gst_type_find_factory_has_function      (GstTypeFindFactory *factory);
 
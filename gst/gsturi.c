@@ -519,63 +519,33 @@ gst_uri_construct (const gchar * protocol, const gchar * location)
 }
 #endif
 
-typedef struct
-{
-  GstURIType type;
-  const gchar *protocol;
-}
-SearchEntry;
-
-static gboolean
-search_by_entry (GstPluginFeature * feature, gpointer search_entry)
-{
-  const gchar *const *protocols;
-  GstElementFactory *factory;
-  SearchEntry *entry = (SearchEntry *) search_entry;
-
-  if (!GST_IS_ELEMENT_FACTORY (feature))
-    return FALSE;
-  factory = GST_ELEMENT_FACTORY_CAST (feature);
-
-  if (factory->uri_type != entry->type)
-    return FALSE;
-
-  protocols = gst_element_factory_get_uri_protocols (factory);
-
-  if (protocols == NULL) {
-    g_warning ("Factory '%s' implements GstUriHandler interface but returned "
-        "no supported protocols!", gst_plugin_feature_get_name (feature));
-    return FALSE;
-  }
-
-  while (*protocols != NULL) {
-    if (g_ascii_strcasecmp (*protocols, entry->protocol) == 0)
-      return TRUE;
-    protocols++;
-  }
-  return FALSE;
-}
-
-static gint
-sort_by_rank (GstPluginFeature * first, GstPluginFeature * second)
-{
-  return gst_plugin_feature_get_rank (second) -
-      gst_plugin_feature_get_rank (first);
-}
-
+/* looks up the factories in the index of the registry, which is sorted by
+ * rank already */
 static GList *
 get_element_factories_from_uri_protocol (const GstURIType type,
-    const gchar * protocol)
+    const gchar * protocol, gsize len)
 {
   GList *possibilities;
-  SearchEntry entry;
+  gchar buf[32], *lower = NULL;
+  const gchar *key;
+  gsize i;
+
+  if (type != GST_URI_SINK && type != GST_URI_SRC)
+    return NULL;
 
-  g_return_val_if_fail (protocol, NULL);
+  /* the index uses lower case protocols, convert short ones on the stack */
+  if (len < sizeof (buf)) {
+    for (i = 0; i < len; i++)
+      buf[i] = g_ascii_tolower (protocol[i]);
+    buf[len] = '\0';
+    key = buf;
+  } else {
+    key = lower = g_ascii_strdown (protocol, len);
+  }
 
-  entry.type = type;
-  entry.protocol = protocol;
-  possibilities = gst_registry_feature_filter (gst_registry_get (),
-      search_by_entry, FALSE, &entry);
+  possibilities =
+      _priv_gst_registry_get_uri_factories (gst_registry_get (), type, key);
+  g_free (lower);
 
   return possibilities;
 }
@@ -598,7 +568,8 @@ gst_uri_protocol_is_supported (const GstURIType type, const gchar * protocol)
 
   g_return_val_if_fail (protocol, FALSE);
 
-  possibilities = get_element_factories_from_uri_protocol (type, protocol);
+  possibilities = get_element_factories_from_uri_protocol (type, protocol,
+      strlen (protocol));
 
   if (possibilities) {
     g_list_free (possibilities);
@@ -623,7 +594,7 @@ gst_element_make_from_uri (const GstURIType type, const gchar * uri,
     const gchar * elementname, GError ** error)
 {
   GList *possibilities, *walk;
-  gchar *protocol;
+  const gchar *colon;
   GstElement *ret = NULL;
 
   g_return_val_if_fail (gst_is_initialized (), NULL);
@@ -633,10 +604,14 @@ gst_element_make_from_uri (const GstURIType type, const gchar * uri,
 
   GST_DEBUG ("type:%d, uri:%s, elementname:%s", type, uri, elementname);
 
-  protocol = gst_uri_get_protocol (uri);
-  possibilities = get_element_factories_from_uri_protocol (type, protocol);
+  /* the protocol is only copied for the error message */
+  colon = strchr (uri, ':');
+  possibilities = get_element_factories_from_uri_protocol (type, uri,
+      colon - uri);
 
   if (!possibilities) {
+    gchar *protocol = gst_uri_get_protocol (uri);
+
     GST_DEBUG ("No %s for URI '%s'", type == GST_URI_SINK ? "sink" : "source",
         uri);
     /* The error message isn't great, but we don't expect applications to
@@ -646,9 +621,7 @@ gst_element_make_from_uri (const GstURIType type, const gchar * uri,
     g_free (protocol);
     return NULL;
   }
-  g_free (protocol);
 
-  possibilities = g_list_sort (possibilities, (GCompareFunc) sort_by_rank);
   walk = possibilities;
   while (walk) {
     GstElementFactory *factory = walk->data;
@@ -1272,12 +1245,45 @@ _gst_uri_escape_fragment (const gchar * fragment)
       G_URI_RESERVED_CHARS_ALLOWED_IN_PATH "?", FALSE);
 }
 
+/* splits the string from @str to @end at every @sep and unescapes the
+ * parts in one pass, without copying the string first */
+static GList *
+_gst_uri_unescape_to_list (const gchar * str, const gchar * end, gchar sep)
+{
+  GList *new_list = NULL;
+  const gchar *next;
+
+  if (str == end)
+    return NULL;
+
+  while (TRUE) {
+    next = memchr (str, sep, end - str);
+    if (next == NULL)
+      next = end;
+
+    if (next == str)
+      new_list = g_list_prepend (new_list, NULL);
+    else
+      new_list = g_list_prepend (new_list, g_uri_unescape_segment (str, next,
+              NULL));
+
+    if (next == end)
+      break;
+    str = next + 1;
+  }
+
+  return g_list_reverse (new_list);
+}
+
 static GList *
 _gst_uri_string_to_list (const gchar * str, const gchar * sep, gboolean convert,
     gboolean unescape)
 {
   GList *new_list = NULL;
 
+  if (str && unescape && sep[0] != '\0' && sep[1] == '\0')
+    return _gst_uri_unescape_to_list (str, str + strlen (str), sep[0]);
+
   if (str) {
     guint pct_sep_len = 0;
     gchar *pct_sep = NULL;
@@ -1583,17 +1589,11 @@ gst_uri_from_string (const gchar * uri)
       /* get path */
       size_t len;
       len = strcspn (uri, "?#");
-      if (uri[len] == '\0') {
-        uri_obj->path = _gst_uri_string_to_list (uri, "/", FALSE, TRUE);
+      uri_obj->path = _gst_uri_unescape_to_list (uri, uri + len, '/');
+      if (uri[len] == '\0')
         uri = NULL;
-      } else {
-        if (len > 0) {
-          gchar *path_str = g_strndup (uri, len);
-          uri_obj->path = _gst_uri_string_to_list (path_str, "/", FALSE, TRUE);
-          g_free (path_str);
-        }
+      else
         uri += len;
-      }
     }
     if (uri != NULL && uri[0] == '?') {
       /* get query */
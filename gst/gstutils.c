@@ -760,6 +760,177 @@ gst_util_uint64_scale_int_ceil (guint64 val, gint num, gint denom)
   return _gst_util_uint64_scale_int (val, num, denom, denom - 1);
 }
 
+/* the high 64 bits of @a * @b */
+static inline guint64
+gst_util_uint64_mul_high (guint64 a, guint64 b)
+{
+#ifdef HAVE_UINT128_T
+  return (guint64) ((((__uint128_t) a) * ((__uint128_t) b)) >> 64);
+#else
+  GstUInt64 c1, c0;
+
+  gst_util_uint64_mul_uint64 (&c1, &c0, a, b);
+
+  return c1.ll;
+#endif
+}
+
+/**
+ * gst_util_uint64_scaler_init:
+ * @scaler: a #GstUInt64Scaler
+ * @num: the numerator of the scale ratio
+ * @denom: the denominator of the scale ratio
+ *
+ * Prepare @scaler for scaling values by the rational number @num / @denom.
+ *
+ * gst_util_uint64_scaler_scale() and its variants then give the same
+ * results as gst_util_uint64_scale() and its variants, but replace the
+ * division by a multiplication and a shift as long as @val * @num fits in
+ * 64 bits. This is useful when converting many values with the same ratio,
+ * like timestamps with a fixed sample rate.
+ *
+ * Since: 1.14
+ */
+void
+gst_util_uint64_scaler_init (GstUInt64Scaler * scaler, guint64 num,
+    guint64 denom)
+{
+  guint64 a, b, t, d, x, q, r;
+  guint l;
+
+  g_return_if_fail (scaler != NULL);
+  g_return_if_fail (denom != 0);
+
+  memset (scaler, 0, sizeof (GstUInt64Scaler));
+
+  /* work with the reduced fraction, the rounding corrections derived from
+   * the reduced denominator give the same results */
+  a = num;
+  b = denom;
+  while (b) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  scaler->num = num / a;
+  scaler->denom = d = denom / a;
+  scaler->max_val = scaler->num ? G_MAXUINT64 / scaler->num : G_MAXUINT64;
+
+  if ((d & (d - 1)) == 0) {
+    /* power of two, just shift */
+    while (d > 1) {
+      d >>= 1;
+      scaler->shift++;
+    }
+    return;
+  }
+
+  /* division by an invariant integer, see Granlund and Montgomery.
+   * l = ceil (log2 (d)) and mul = floor (2^64 * (2^l - d) / d) + 1 */
+  for (l = 0; l < 64 && (G_GUINT64_CONSTANT (1) << l) < d; l++);
+  x = (l == 64 ? 0 : G_GUINT64_CONSTANT (1) << l) - d;
+
+  /* x < d, so x * 2^63 / d fits and the remainder can be computed with
+   * wrapping arithmetic */
+  q = gst_util_uint64_scale (x, G_GUINT64_CONSTANT (1) << 63, d);
+  r = ((x & 1) << 63) - q * d;
+
+  scaler->mul = 2 * q + (r >= d - r ? 1 : 0) + 1;
+  scaler->shift = l - 1;
+}
+
+static inline guint64
+_gst_util_uint64_scaler_scale (const GstUInt64Scaler * scaler, guint64 val,
+    guint64 correct)
+{
+  guint64 tmp, t;
+
+  if (G_UNLIKELY (val > scaler->max_val))
+    goto slow_path;
+
+  tmp = val * scaler->num;
+  if (G_UNLIKELY (tmp > G_MAXUINT64 - correct))
+    goto slow_path;
+  tmp += correct;
+
+  if (scaler->mul == 0)
+    return tmp >> scaler->shift;
+
+  t = gst_util_uint64_mul_high (scaler->mul, tmp);
+  return (t + ((tmp - t) >> 1)) >> scaler->shift;
+
+slow_path:
+  return _gst_util_uint64_scale (val, scaler->num, scaler->denom, correct);
+}
+
+/**
+ * gst_util_uint64_scaler_scale:
+ * @scaler: a #GstUInt64Scaler
+ * @val: the number to scale
+ *
+ * Scale @val by the rational number of @scaler, like
+ * gst_util_uint64_scale().
+ *
+ * Returns: @val * @num / @denom, truncated. In the case of an overflow,
+ * this function returns G_MAXUINT64.
+ *
+ * Since: 1.14
+ */
+guint64
+gst_util_uint64_scaler_scale (const GstUInt64Scaler * scaler, guint64 val)
+{
+  g_return_val_if_fail (scaler != NULL, G_MAXUINT64);
+  g_return_val_if_fail (scaler->denom != 0, G_MAXUINT64);
+
+  return _gst_util_uint64_scaler_scale (scaler, val, 0);
+}
+
+/**
+ * gst_util_uint64_scaler_scale_round:
+ * @scaler: a #GstUInt64Scaler
+ * @val: the number to scale
+ *
+ * Scale @val by the rational number of @scaler, like
+ * gst_util_uint64_scale_round().
+ *
+ * Returns: @val * @num / @denom, rounded to the nearest integer. In the case
+ * of an overflow, this function returns G_MAXUINT64.
+ *
+ * Since: 1.14
+ */
+guint64
+gst_util_uint64_scaler_scale_round (const GstUInt64Scaler * scaler,
+    guint64 val)
+{
+  g_return_val_if_fail (scaler != NULL, G_MAXUINT64);
+  g_return_val_if_fail (scaler->denom != 0, G_MAXUINT64);
+
+  return _gst_util_uint64_scaler_scale (scaler, val, scaler->denom >> 1);
+}
+
+/**
+ * gst_util_uint64_scaler_scale_ceil:
+ * @scaler: a #GstUInt64Scaler
+ * @val: the number to scale
+ *
+ * Scale @val by the rational number of @scaler, like
+ * gst_util_uint64_scale_ceil().
+ *
+ * Returns: @val * @num / @denom, rounded up. In the case of an overflow,
+ * this function returns G_MAXUINT64.
+ *
+ * Since: 1.14
+ */
+guint64
+gst_util_uint64_scaler_scale_ceil (const GstUInt64Scaler * scaler,
+    guint64 val)
+{
+  g_return_val_if_fail (scaler != NULL, G_MAXUINT64);
+  g_return_val_if_fail (scaler->denom != 0, G_MAXUINT64);
+
+  return _gst_util_uint64_scaler_scale (scaler, val, scaler->denom - 1);
+}
+
 /**
  * gst_util_seqnum_next:
  *
@@ -1310,58 +1481,22 @@ static gboolean
 gst_element_factory_can_accept_all_caps_in_direction (GstElementFactory *
     factory, const GstCaps * caps, GstPadDirection direction)
 {
-  GList *templates;
-
   g_return_val_if_fail (factory != NULL, FALSE);
   g_return_val_if_fail (caps != NULL, FALSE);
 
-  templates = factory->staticpadtemplates;
-
-  while (templates) {
-    GstStaticPadTemplate *template = (GstStaticPadTemplate *) templates->data;
-
-    if (template->direction == direction) {
-      GstCaps *templcaps = gst_static_caps_get (&template->static_caps);
-
-      if (gst_caps_is_always_compatible (caps, templcaps)) {
-        gst_caps_unref (templcaps);
-        return TRUE;
-      }
-      gst_caps_unref (templcaps);
-    }
-    templates = g_list_next (templates);
-  }
-
-  return FALSE;
+  return __gst_element_factory_can_accept_caps (factory, caps, direction,
+      TRUE);
 }
 
 static gboolean
 gst_element_factory_can_accept_any_caps_in_direction (GstElementFactory *
     factory, const GstCaps * caps, GstPadDirection direction)
 {
-  GList *templates;
-
   g_return_val_if_fail (factory != NULL, FALSE);
   g_return_val_if_fail (caps != NULL, FALSE);
 
-  templates = factory->staticpadtemplates;
-
-  while (templates) {
-    GstStaticPadTemplate *template = (GstStaticPadTemplate *) templates->data;
-
-    if (template->direction == direction) {
-      GstCaps *templcaps = gst_static_caps_get (&template->static_caps);
-
-      if (gst_caps_can_intersect (caps, templcaps)) {
-        gst_caps_unref (templcaps);
-        return TRUE;
-      }
-      gst_caps_unref (templcaps);
-    }
-    templates = g_list_next (templates);
-  }
-
-  return FALSE;
+  return __gst_element_factory_can_accept_caps (factory, caps, direction,
+      FALSE);
 }
 
 /**
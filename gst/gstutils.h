@@ -96,6 +96,41 @@ guint64         gst_util_uint64_scale_int_round (guint64 val, gint num, gint den
 GST_EXPORT
 guint64         gst_util_uint64_scale_int_ceil  (guint64 val, gint num, gint denom);
 
+/**
+ * GstUInt64Scaler:
+ *
+ * Precomputed state for scaling many values by the same rational number,
+ * initialize with gst_util_uint64_scaler_init().
+ *
+ * Since: 1.14
+ */
+typedef struct {
+  /*< private >*/
+  guint64 num;
+  guint64 denom;
+  guint64 max_val;
+  guint64 mul;
+  guint   shift;
+
+  gpointer _gst_reserved[GST_PADDING];
+} GstUInt64Scaler;
+
+GST_EXPORT
+void            gst_util_uint64_scaler_init       (GstUInt64Scaler * scaler,
+                                                   guint64 num, guint64 denom);
+
+GST_EXPORT
+guint64         gst_util_uint64_scaler_scale      (const GstUInt64Scaler * scaler,
+                                                   guint64 val);
+
+GST_EXPORT
+guint64         gst_util_uint64_scaler_scale_round (const GstUInt64Scaler * scaler,
+                                                    guint64 val);
+
+GST_EXPORT
+guint64         gst_util_uint64_scaler_scale_ceil (const GstUInt64Scaler * scaler,
+                                                   guint64 val);
+
 #define GST_SEQNUM_INVALID (0)
 
 GST_EXPORT
@@ -157,6 +157,25 @@ static GArray *gst_value_union_funcs;
 static GArray *gst_value_intersect_funcs;
 static GArray *gst_value_subtract_funcs;
 
+/* The union, intersect and subtract functions are looked up for every pair
+ * of values during caps operations. Once all functions are registered, every
+ * type that appears in one of them gets a small dispatch id and the functions
+ * are stored in a two-dimensional table indexed by the ids of both types */
+typedef struct _GstValueDispatch GstValueDispatch;
+struct _GstValueDispatch
+{
+  gpointer func;
+  /* call func with the values swapped */
+  gboolean swap;
+};
+
+static GHashTable *gst_value_dispatch_ids;
+static guint gst_value_dispatch_ids_fundamental[FUNDAMENTAL_TYPE_ID_MAX + 1];
+static guint gst_value_dispatch_n_types;
+static GstValueDispatch *gst_value_union_dispatch;
+static GstValueDispatch *gst_value_intersect_dispatch;
+static GstValueDispatch *gst_value_subtract_dispatch;
+
 /* Forward declarations */
 static gchar *gst_value_serialize_fraction (const GValue * value);
 
@@ -191,6 +210,143 @@ gst_value_hash_add_type (GType type, const GstValueTable * table)
   g_hash_table_insert (gst_value_hash, (gpointer) type, (gpointer) table);
 }
 
+/* returns the dispatch id of @type or -1 when no union, intersect or
+ * subtract function is registered for it */
+static inline gint
+gst_value_dispatch_id (GType type)
+{
+  guint id;
+
+  if (G_LIKELY (G_TYPE_IS_FUNDAMENTAL (type)))
+    id = gst_value_dispatch_ids_fundamental[FUNDAMENTAL_TYPE_ID (type)];
+  else
+    id = GPOINTER_TO_UINT (g_hash_table_lookup (gst_value_dispatch_ids,
+            (gpointer) type));
+
+  return (gint) id - 1;
+}
+
+static inline const GstValueDispatch *
+gst_value_dispatch_lookup (const GstValueDispatch * table, GType type1,
+    GType type2)
+{
+  const GstValueDispatch *entry;
+  gint id1, id2;
+
+  if ((id1 = gst_value_dispatch_id (type1)) < 0)
+    return NULL;
+  if ((id2 = gst_value_dispatch_id (type2)) < 0)
+    return NULL;
+
+  entry = &table[id1 * gst_value_dispatch_n_types + id2];
+
+  return entry->func ? entry : NULL;
+}
+
+static void
+gst_value_dispatch_add_type (GType type)
+{
+  guint id;
+
+  if (gst_value_dispatch_id (type) >= 0)
+    return;
+
+  id = ++gst_value_dispatch_n_types;
+  if (G_TYPE_IS_FUNDAMENTAL (type))
+    gst_value_dispatch_ids_fundamental[FUNDAMENTAL_TYPE_ID (type)] = id;
+  else
+    g_hash_table_insert (gst_value_dispatch_ids, (gpointer) type,
+        GUINT_TO_POINTER (id));
+}
+
+static void
+gst_value_dispatch_set (GstValueDispatch * table, GType type1, GType type2,
+    gpointer func, gboolean swap)
+{
+  GstValueDispatch *entry;
+
+  entry = &table[gst_value_dispatch_id (type1) * gst_value_dispatch_n_types +
+      gst_value_dispatch_id (type2)];
+
+  /* the first registered function wins, like it did with the linear scan */
+  if (entry->func == NULL) {
+    entry->func = func;
+    entry->swap = swap;
+  }
+}
+
+/* Builds the dispatch tables from the registered functions. Called once
+ * all functions of _priv_gst_value_initialize() are registered and again for
+ * every function registered after that */
+static void
+gst_value_dispatch_build (void)
+{
+  guint i, n;
+
+  if (gst_value_dispatch_ids == NULL) {
+    gst_value_dispatch_ids = g_hash_table_new (NULL, NULL);
+  } else {
+    g_hash_table_remove_all (gst_value_dispatch_ids);
+    memset (gst_value_dispatch_ids_fundamental, 0,
+        sizeof (gst_value_dispatch_ids_fundamental));
+    gst_value_dispatch_n_types = 0;
+    g_free (gst_value_union_dispatch);
+    g_free (gst_value_intersect_dispatch);
+    g_free (gst_value_subtract_dispatch);
+  }
+
+  for (i = 0; i < gst_value_union_funcs->len; i++) {
+    GstValueUnionInfo *info =
+        &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
+    gst_value_dispatch_add_type (info->type1);
+    gst_value_dispatch_add_type (info->type2);
+  }
+  for (i = 0; i < gst_value_intersect_funcs->len; i++) {
+    GstValueIntersectInfo *info =
+        &g_array_index (gst_value_intersect_funcs, GstValueIntersectInfo, i);
+    gst_value_dispatch_add_type (info->type1);
+    gst_value_dispatch_add_type (info->type2);
+  }
+  for (i = 0; i < gst_value_subtract_funcs->len; i++) {
+    GstValueSubtractInfo *info =
+        &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
+    gst_value_dispatch_add_type (info->minuend);
+    gst_value_dispatch_add_type (info->subtrahend);
+  }
+
+  n = gst_value_dispatch_n_types;
+  gst_value_union_dispatch = g_new0 (GstValueDispatch, n * n);
+  gst_value_intersect_dispatch = g_new0 (GstValueDispatch, n * n);
+  gst_value_subtract_dispatch = g_new0 (GstValueDispatch, n * n);
+
+  /* union and intersection are commutative, also store the functions for
+   * the swapped types */
+  for (i = 0; i < gst_value_union_funcs->len; i++) {
+    GstValueUnionInfo *info =
+        &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
+    gst_value_dispatch_set (gst_value_union_dispatch, info->type1,
+        info->type2, (gpointer) info->func, FALSE);
+    gst_value_dispatch_set (gst_value_union_dispatch, info->type2,
+        info->type1, (gpointer) info->func, TRUE);
+  }
+  for (i = 0; i < gst_value_intersect_funcs->len; i++) {
+    GstValueIntersectInfo *info =
+        &g_array_index (gst_value_intersect_funcs, GstValueIntersectInfo, i);
+    gst_value_dispatch_set (gst_value_intersect_dispatch, info->type1,
+        info->type2, (gpointer) info->func, FALSE);
+    gst_value_dispatch_set (gst_value_intersect_dispatch, info->type2,
+        info->type1, (gpointer) info->func, TRUE);
+  }
+  for (i = 0; i < gst_value_subtract_funcs->len; i++) {
+    GstValueSubtractInfo *info =
+        &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
+    gst_value_dispatch_set (gst_value_subtract_dispatch, info->minuend,
+        info->subtrahend, (gpointer) info->func, FALSE);
+  }
+
+  GST_DEBUG ("built value dispatch tables for %u types", n);
+}
+
 /********
  * list *
  ********/
@@ -366,11 +522,16 @@ gst_type_is_fixed (GType type)
   return FALSE;
 }
 
+/* room for the common short lists of caps fields, like formats, rates or
+ * channels, so that appending their items doesn't reallocate */
+#define VALUE_LIST_PREALLOC 4
+
 /* GValue functions usable for both regular lists and arrays */
 static void
 gst_value_init_list_or_array (GValue * value)
 {
-  value->data[0].v_pointer = g_array_new (FALSE, TRUE, sizeof (GValue));
+  value->data[0].v_pointer = g_array_sized_new (FALSE, TRUE, sizeof (GValue),
+      VALUE_LIST_PREALLOC);
 }
 
 static GArray *
@@ -5639,25 +5800,11 @@ gst_value_compare_with_func (const GValue * value1, const GValue * value2,
 gboolean
 gst_value_can_union (const GValue * value1, const GValue * value2)
 {
-  GstValueUnionInfo *union_info;
-  guint i, len;
-
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
 
-  len = gst_value_union_funcs->len;
-
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == G_VALUE_TYPE (value1) &&
-        union_info->type2 == G_VALUE_TYPE (value2))
-      return TRUE;
-    if (union_info->type1 == G_VALUE_TYPE (value2) &&
-        union_info->type2 == G_VALUE_TYPE (value1))
-      return TRUE;
-  }
-
-  return FALSE;
+  return gst_value_dispatch_lookup (gst_value_union_dispatch,
+      G_VALUE_TYPE (value1), G_VALUE_TYPE (value2)) != NULL;
 }
 
 /**
@@ -5673,9 +5820,7 @@ gst_value_can_union (const GValue * value1, const GValue * value2)
 gboolean
 gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
 {
-  const GstValueUnionInfo *union_info;
-  guint i, len;
-  GType type1, type2;
+  const GstValueDispatch *dispatch;
 
   g_return_val_if_fail (dest != NULL, FALSE);
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -5683,18 +5828,14 @@ gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
   g_return_val_if_fail (gst_value_list_or_array_are_compatible (value1, value2),
       FALSE);
 
-  len = gst_value_union_funcs->len;
-  type1 = G_VALUE_TYPE (value1);
-  type2 = G_VALUE_TYPE (value2);
+  dispatch = gst_value_dispatch_lookup (gst_value_union_dispatch,
+      G_VALUE_TYPE (value1), G_VALUE_TYPE (value2));
+  if (dispatch) {
+    GstValueUnionFunc func = (GstValueUnionFunc) dispatch->func;
 
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == type1 && union_info->type2 == type2) {
-      return union_info->func (dest, value1, value2);
-    }
-    if (union_info->type1 == type2 && union_info->type2 == type1) {
-      return union_info->func (dest, value2, value1);
-    }
+    if (dispatch->swap)
+      return func (dest, value2, value1);
+    return func (dest, value1, value2);
   }
 
   gst_value_list_concat (dest, value1, value2);
@@ -5723,6 +5864,10 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
   union_info.func = func;
 
   g_array_append_val (gst_value_union_funcs, union_info);
+
+  /* registered after the dispatch tables were built */
+  if (gst_value_union_dispatch)
+    gst_value_dispatch_build ();
 }
 
 /* intersection */
@@ -5741,8 +5886,6 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
 gboolean
 gst_value_can_intersect (const GValue * value1, const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
   GType type1, type2;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -5775,14 +5918,8 @@ gst_value_can_intersect (const GValue * value1, const GValue * value2)
   }
 
   /* check registered intersect functions */
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if ((intersect_info->type1 == type1 && intersect_info->type2 == type2) ||
-        (intersect_info->type1 == type2 && intersect_info->type2 == type1))
-      return TRUE;
-  }
+  if (gst_value_dispatch_lookup (gst_value_intersect_dispatch, type1, type2))
+    return TRUE;
 
   return gst_value_can_compare_unchecked (value1, value2);
 }
@@ -5807,8 +5944,7 @@ gboolean
 gst_value_intersect (GValue * dest, const GValue * value1,
     const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
+  const GstValueDispatch *dispatch;
   GType type1, type2;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -5829,16 +5965,14 @@ gst_value_intersect (GValue * dest, const GValue * value1,
     return TRUE;
   }
 
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if (intersect_info->type1 == type1 && intersect_info->type2 == type2) {
-      return intersect_info->func (dest, value1, value2);
-    }
-    if (intersect_info->type1 == type2 && intersect_info->type2 == type1) {
-      return intersect_info->func (dest, value2, value1);
-    }
+  dispatch = gst_value_dispatch_lookup (gst_value_intersect_dispatch, type1,
+      type2);
+  if (dispatch) {
+    GstValueIntersectFunc func = (GstValueIntersectFunc) dispatch->func;
+
+    if (dispatch->swap)
+      return func (dest, value2, value1);
+    return func (dest, value1, value2);
   }
 
   /* Failed to find a direct intersection, check if these are
@@ -5877,6 +6011,9 @@ gst_value_register_intersect_func (GType type1, GType type2,
   intersect_info.func = func;
 
   g_array_append_val (gst_value_intersect_funcs, intersect_info);
+
+  if (gst_value_intersect_dispatch)
+    gst_value_dispatch_build ();
 }
 
 
@@ -5900,8 +6037,7 @@ gboolean
 gst_value_subtract (GValue * dest, const GValue * minuend,
     const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
+  const GstValueDispatch *dispatch;
   GType mtype, stype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
@@ -5916,13 +6052,10 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
   if (stype == GST_TYPE_LIST)
     return gst_value_subtract_list (dest, minuend, subtrahend);
 
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype) {
-      return info->func (dest, minuend, subtrahend);
-    }
-  }
+  dispatch = gst_value_dispatch_lookup (gst_value_subtract_dispatch, mtype,
+      stype);
+  if (dispatch)
+    return ((GstValueSubtractFunc) dispatch->func) (dest, minuend, subtrahend);
 
   if (_gst_value_compare_nolist (minuend, subtrahend) != GST_VALUE_EQUAL) {
     if (dest)
@@ -5959,8 +6092,6 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
 gboolean
 gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
   GType mtype, stype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
@@ -5975,12 +6106,8 @@ gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
   if (mtype == GST_TYPE_STRUCTURE || stype == GST_TYPE_STRUCTURE)
     return FALSE;
 
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype)
-      return TRUE;
-  }
+  if (gst_value_dispatch_lookup (gst_value_subtract_dispatch, mtype, stype))
+    return TRUE;
 
   return gst_value_can_compare_unchecked (minuend, subtrahend);
 }
@@ -6011,6 +6138,9 @@ gst_value_register_subtract_func (GType minuend_type, GType subtrahend_type,
   info.func = func;
 
   g_array_append_val (gst_value_subtract_funcs, info);
+
+  if (gst_value_subtract_dispatch)
+    gst_value_dispatch_build ();
 }
 
 /**
@@ -6160,6 +6290,706 @@ gst_value_deserialize (GValue * dest, const gchar * src)
   return FALSE;
 }
 
+/* binary serialization
+ *
+ * All numbers are stored in little endian, strings as their length + 1
+ * followed by the characters without the terminating zero, with a length of
+ * 0 for %NULL strings. Every top-level blob starts with a header of the magic
+ * "GSTB", the format version and the kind of object that follows. Values
+ * are stored as a tag followed by the tag specific data. Field names and
+ * types are stored by name, as quarks and type ids are only valid inside one
+ * process. */
+#define GST_BINARY_MAGIC "GSTB"
+#define GST_BINARY_VERSION 1
+/* maximum nesting of lists, structures and caps */
+#define GST_BINARY_MAX_DEPTH 64
+
+typedef enum
+{
+  /* type name and gst_value_serialize() string */
+  BINARY_VALUE_SERIALIZED = 0,
+  BINARY_VALUE_BOOLEAN,
+  BINARY_VALUE_INT,
+  BINARY_VALUE_UINT,
+  BINARY_VALUE_INT64,
+  BINARY_VALUE_UINT64,
+  BINARY_VALUE_FLOAT,
+  BINARY_VALUE_DOUBLE,
+  BINARY_VALUE_STRING,
+  BINARY_VALUE_ENUM,
+  BINARY_VALUE_FLAGS,
+  BINARY_VALUE_FRACTION,
+  BINARY_VALUE_INT_RANGE,
+  BINARY_VALUE_INT64_RANGE,
+  BINARY_VALUE_DOUBLE_RANGE,
+  BINARY_VALUE_FRACTION_RANGE,
+  BINARY_VALUE_LIST,
+  BINARY_VALUE_ARRAY,
+  BINARY_VALUE_BITMASK,
+  BINARY_VALUE_FLAG_SET,
+  BINARY_VALUE_STRUCTURE,
+  BINARY_VALUE_CAPS,
+  BINARY_VALUE_CAPS_FEATURES,
+  BINARY_VALUE_BUFFER,
+  BINARY_VALUE_DATE
+} GstBinaryValueTag;
+
+void
+_priv_gst_binary_write_header (GByteArray * array, GstBinaryKind kind)
+{
+  g_byte_array_append (array, (const guint8 *) GST_BINARY_MAGIC, 4);
+  _priv_gst_binary_write_uint8 (array, GST_BINARY_VERSION);
+  _priv_gst_binary_write_uint8 (array, kind);
+}
+
+gboolean
+_priv_gst_binary_read_header (GstBinaryReader * reader, GstBinaryKind kind)
+{
+  guint8 version, k;
+
+  if (reader->size - reader->offset < 4 ||
+      memcmp (reader->data + reader->offset, GST_BINARY_MAGIC, 4) != 0)
+    goto wrong_magic;
+  reader->offset += 4;
+
+  if (!_priv_gst_binary_read_uint8 (reader, &version) ||
+      !_priv_gst_binary_read_uint8 (reader, &k))
+    return FALSE;
+
+  if (version != GST_BINARY_VERSION)
+    goto wrong_version;
+  if (k != kind)
+    goto wrong_kind;
+
+  return TRUE;
+
+  /* ERRORS */
+wrong_magic:
+  {
+    GST_WARNING ("data is not in the binary serialization format");
+    return FALSE;
+  }
+wrong_version:
+  {
+    GST_WARNING ("unsupported binary serialization version %u", version);
+    return FALSE;
+  }
+wrong_kind:
+  {
+    GST_WARNING ("binary data contains kind %u instead of %u", k, kind);
+    return FALSE;
+  }
+}
+
+void
+_priv_gst_binary_write_uint8 (GByteArray * array, guint8 val)
+{
+  g_byte_array_append (array, &val, 1);
+}
+
+gboolean
+_priv_gst_binary_read_uint8 (GstBinaryReader * reader, guint8 * val)
+{
+  if (reader->size - reader->offset < 1)
+    return FALSE;
+
+  *val = reader->data[reader->offset];
+  reader->offset += 1;
+  return TRUE;
+}
+
+void
+_priv_gst_binary_write_uint32 (GByteArray * array, guint32 val)
+{
+  val = GUINT32_TO_LE (val);
+  g_byte_array_append (array, (const guint8 *) &val, 4);
+}
+
+gboolean
+_priv_gst_binary_read_uint32 (GstBinaryReader * reader, guint32 * val)
+{
+  guint32 v;
+
+  if (reader->size - reader->offset < 4)
+    return FALSE;
+
+  memcpy (&v, reader->data + reader->offset, 4);
+  *val = GUINT32_FROM_LE (v);
+  reader->offset += 4;
+  return TRUE;
+}
+
+void
+_priv_gst_binary_write_uint64 (GByteArray * array, guint64 val)
+{
+  val = GUINT64_TO_LE (val);
+  g_byte_array_append (array, (const guint8 *) &val, 8);
+}
+
+gboolean
+_priv_gst_binary_read_uint64 (GstBinaryReader * reader, guint64 * val)
+{
+  guint64 v;
+
+  if (reader->size - reader->offset < 8)
+    return FALSE;
+
+  memcpy (&v, reader->data + reader->offset, 8);
+  *val = GUINT64_FROM_LE (v);
+  reader->offset += 8;
+  return TRUE;
+}
+
+void
+_priv_gst_binary_write_string (GByteArray * array, const gchar * str)
+{
+  guint32 len;
+
+  if (str == NULL) {
+    _priv_gst_binary_write_uint32 (array, 0);
+    return;
+  }
+
+  len = strlen (str);
+  _priv_gst_binary_write_uint32 (array, len + 1);
+  g_byte_array_append (array, (const guint8 *) str, len);
+}
+
+/* the string must be valid UTF-8 */
+gboolean
+_priv_gst_binary_read_string (GstBinaryReader * reader, gchar ** str)
+{
+  guint32 len;
+  const gchar *data;
+
+  if (!_priv_gst_binary_read_uint32 (reader, &len))
+    return FALSE;
+
+  if (len == 0) {
+    *str = NULL;
+    return TRUE;
+  }
+  len--;
+
+  if (reader->size - reader->offset < len)
+    return FALSE;
+
+  data = (const gchar *) reader->data + reader->offset;
+  if (!g_utf8_validate (data, len, NULL))
+    return FALSE;
+
+  *str = g_strndup (data, len);
+  reader->offset += len;
+  return TRUE;
+}
+
+static void
+gst_binary_write_double (GByteArray * array, gdouble val)
+{
+  union
+  {
+    gdouble d;
+    guint64 u;
+  } v;
+
+  v.d = val;
+  _priv_gst_binary_write_uint64 (array, v.u);
+}
+
+static gboolean
+gst_binary_read_double (GstBinaryReader * reader, gdouble * val)
+{
+  union
+  {
+    gdouble d;
+    guint64 u;
+  } v;
+
+  if (!_priv_gst_binary_read_uint64 (reader, &v.u))
+    return FALSE;
+
+  *val = v.d;
+  return TRUE;
+}
+
+static gboolean
+gst_binary_read_int32 (GstBinaryReader * reader, gint * val)
+{
+  guint32 v;
+
+  if (!_priv_gst_binary_read_uint32 (reader, &v))
+    return FALSE;
+
+  *val = (gint32) v;
+  return TRUE;
+}
+
+static GType
+gst_binary_read_type (GstBinaryReader * reader, GType fundamental)
+{
+  gchar *name;
+  GType type;
+
+  if (!_priv_gst_binary_read_string (reader, &name) || name == NULL)
+    return G_TYPE_INVALID;
+
+  type = g_type_from_name (name);
+  if (type == G_TYPE_INVALID || (fundamental != G_TYPE_INVALID &&
+          !g_type_is_a (type, fundamental))) {
+    GST_WARNING ("unknown type %s in binary data", name);
+    type = G_TYPE_INVALID;
+  } else if (!G_TYPE_IS_VALUE_TYPE (type) || G_TYPE_IS_ABSTRACT (type)) {
+    /* g_value_init() would fail on these */
+    GST_WARNING ("type %s in binary data can't hold a value", name);
+    type = G_TYPE_INVALID;
+  }
+  g_free (name);
+
+  return type;
+}
+
+static gboolean
+gst_binary_write_list (GByteArray * array, const GValue * value)
+{
+  guint i, n;
+
+  n = gst_value_list_get_size (value);
+  _priv_gst_binary_write_uint32 (array, n);
+  for (i = 0; i < n; i++) {
+    if (!_priv_gst_value_write_binary (array,
+            gst_value_list_get_value (value, i)))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+static gboolean
+gst_binary_write_array (GByteArray * array, const GValue * value)
+{
+  guint i, n;
+
+  n = gst_value_array_get_size (value);
+  _priv_gst_binary_write_uint32 (array, n);
+  for (i = 0; i < n; i++) {
+    if (!_priv_gst_value_write_binary (array,
+            gst_value_array_get_value (value, i)))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/* append @value to @array, returns %FALSE if the value can't be serialized */
+gboolean
+_priv_gst_value_write_binary (GByteArray * array, const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+  gchar *str;
+
+  if (type == G_TYPE_BOOLEAN) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_BOOLEAN);
+    _priv_gst_binary_write_uint8 (array, g_value_get_boolean (value) ? 1 : 0);
+  } else if (type == G_TYPE_INT) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_INT);
+    _priv_gst_binary_write_uint32 (array, g_value_get_int (value));
+  } else if (type == G_TYPE_UINT) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_UINT);
+    _priv_gst_binary_write_uint32 (array, g_value_get_uint (value));
+  } else if (type == G_TYPE_INT64) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_INT64);
+    _priv_gst_binary_write_uint64 (array, g_value_get_int64 (value));
+  } else if (type == G_TYPE_UINT64) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_UINT64);
+    _priv_gst_binary_write_uint64 (array, g_value_get_uint64 (value));
+  } else if (type == G_TYPE_FLOAT) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_FLOAT);
+    gst_binary_write_double (array, g_value_get_float (value));
+  } else if (type == G_TYPE_DOUBLE) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_DOUBLE);
+    gst_binary_write_double (array, g_value_get_double (value));
+  } else if (type == G_TYPE_STRING) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_STRING);
+    _priv_gst_binary_write_string (array, g_value_get_string (value));
+  } else if (G_TYPE_IS_ENUM (type)) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_ENUM);
+    _priv_gst_binary_write_string (array, g_type_name (type));
+    _priv_gst_binary_write_uint32 (array, g_value_get_enum (value));
+  } else if (G_TYPE_IS_FLAGS (type)) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_FLAGS);
+    _priv_gst_binary_write_string (array, g_type_name (type));
+    _priv_gst_binary_write_uint32 (array, g_value_get_flags (value));
+  } else if (type == GST_TYPE_FRACTION) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_FRACTION);
+    _priv_gst_binary_write_uint32 (array,
+        gst_value_get_fraction_numerator (value));
+    _priv_gst_binary_write_uint32 (array,
+        gst_value_get_fraction_denominator (value));
+  } else if (type == GST_TYPE_INT_RANGE) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_INT_RANGE);
+    _priv_gst_binary_write_uint32 (array, gst_value_get_int_range_min (value));
+    _priv_gst_binary_write_uint32 (array, gst_value_get_int_range_max (value));
+    _priv_gst_binary_write_uint32 (array,
+        gst_value_get_int_range_step (value));
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_INT64_RANGE);
+    _priv_gst_binary_write_uint64 (array,
+        gst_value_get_int64_range_min (value));
+    _priv_gst_binary_write_uint64 (array,
+        gst_value_get_int64_range_max (value));
+    _priv_gst_binary_write_uint64 (array,
+        gst_value_get_int64_range_step (value));
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_DOUBLE_RANGE);
+    gst_binary_write_double (array, gst_value_get_double_range_min (value));
+    gst_binary_write_double (array, gst_value_get_double_range_max (value));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    const GValue *min, *max;
+
+    min = gst_value_get_fraction_range_min (value);
+    max = gst_value_get_fraction_range_max (value);
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_FRACTION_RANGE);
+    _priv_gst_binary_write_uint32 (array,
+        gst_value_get_fraction_numerator (min));
+    _priv_gst_binary_write_uint32 (array,
+        gst_value_get_fraction_denominator (min));
+    _priv_gst_binary_write_uint32 (array,
+        gst_value_get_fraction_numerator (max));
+    _priv_gst_binary_write_uint32 (array,
+        gst_value_get_fraction_denominator (max));
+  } else if (type == GST_TYPE_LIST) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_LIST);
+    return gst_binary_write_list (array, value);
+  } else if (type == GST_TYPE_ARRAY) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_ARRAY);
+    return gst_binary_write_array (array, value);
+  } else if (type == GST_TYPE_BITMASK) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_BITMASK);
+    _priv_gst_binary_write_uint64 (array, gst_value_get_bitmask (value));
+  } else if (g_type_is_a (type, GST_TYPE_FLAG_SET)) {
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_FLAG_SET);
+    _priv_gst_binary_write_string (array, g_type_name (type));
+    _priv_gst_binary_write_uint32 (array, gst_value_get_flagset_flags (value));
+    _priv_gst_binary_write_uint32 (array, gst_value_get_flagset_mask (value));
+  } else if (type == GST_TYPE_STRUCTURE) {
+    const GstStructure *structure = gst_value_get_structure (value);
+
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_STRUCTURE);
+    _priv_gst_binary_write_uint8 (array, structure != NULL);
+    if (structure)
+      return _priv_gst_structure_write_binary (array, structure);
+  } else if (type == GST_TYPE_CAPS) {
+    const GstCaps *caps = gst_value_get_caps (value);
+
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_CAPS);
+    _priv_gst_binary_write_uint8 (array, caps != NULL);
+    if (caps)
+      return _priv_gst_caps_write_binary (array, caps);
+  } else if (type == GST_TYPE_CAPS_FEATURES) {
+    const GstCapsFeatures *features = gst_value_get_caps_features (value);
+
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_CAPS_FEATURES);
+    str = features ? gst_caps_features_to_string (features) : NULL;
+    _priv_gst_binary_write_string (array, str);
+    g_free (str);
+  } else if (type == GST_TYPE_BUFFER) {
+    GstBuffer *buffer = gst_value_get_buffer (value);
+    GstMapInfo info;
+
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_BUFFER);
+    _priv_gst_binary_write_uint8 (array, buffer != NULL);
+    if (buffer) {
+      if (!gst_buffer_map (buffer, &info, GST_MAP_READ))
+        return FALSE;
+      _priv_gst_binary_write_uint32 (array, info.size);
+      g_byte_array_append (array, info.data, info.size);
+      gst_buffer_unmap (buffer, &info);
+    }
+  } else if (type == G_TYPE_DATE) {
+    const GDate *date = g_value_get_boxed (value);
+
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_DATE);
+    _priv_gst_binary_write_uint32 (array,
+        date && g_date_valid (date) ? g_date_get_julian (date) : 0);
+  } else {
+    /* everything else goes through the string serialization */
+    if (!(str = gst_value_serialize (value)))
+      goto no_serialize;
+
+    _priv_gst_binary_write_uint8 (array, BINARY_VALUE_SERIALIZED);
+    _priv_gst_binary_write_string (array, g_type_name (type));
+    _priv_gst_binary_write_string (array, str);
+    g_free (str);
+  }
+
+  return TRUE;
+
+  /* ERRORS */
+no_serialize:
+  {
+    GST_WARNING ("can't serialize value of type %s", g_type_name (type));
+    return FALSE;
+  }
+}
+
+static gboolean
+gst_binary_read_list (GstBinaryReader * reader, GValue * value,
+    void (*append) (GValue * value, GValue * append_value))
+{
+  guint32 i, n;
+
+  if (!_priv_gst_binary_read_uint32 (reader, &n))
+    return FALSE;
+
+  for (i = 0; i < n; i++) {
+    GValue v = G_VALUE_INIT;
+
+    if (!_priv_gst_value_read_binary (reader, &v)) {
+      if (G_IS_VALUE (&v))
+        g_value_unset (&v);
+      return FALSE;
+    }
+    append (value, &v);
+  }
+  return TRUE;
+}
+
+/* read a value from @reader into the uninitialized @value. On errors @value
+ * might be initialized and needs to be unset by the caller. */
+gboolean
+_priv_gst_value_read_binary (GstBinaryReader * reader, GValue * value)
+{
+  guint8 tag, b;
+  guint32 u1, u2;
+  gint i1, i2, i3, i4;
+  guint64 l1, l2, l3;
+  gdouble d1, d2;
+  gchar *str;
+  GType type;
+  gboolean res = TRUE;
+
+  if (!_priv_gst_binary_read_uint8 (reader, &tag))
+    return FALSE;
+
+  switch (tag) {
+    case BINARY_VALUE_BOOLEAN:
+      if (!_priv_gst_binary_read_uint8 (reader, &b))
+        return FALSE;
+      g_value_init (value, G_TYPE_BOOLEAN);
+      g_value_set_boolean (value, b != 0);
+      break;
+    case BINARY_VALUE_INT:
+      if (!gst_binary_read_int32 (reader, &i1))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT);
+      g_value_set_int (value, i1);
+      break;
+    case BINARY_VALUE_UINT:
+      if (!_priv_gst_binary_read_uint32 (reader, &u1))
+        return FALSE;
+      g_value_init (value, G_TYPE_UINT);
+      g_value_set_uint (value, u1);
+      break;
+    case BINARY_VALUE_INT64:
+      if (!_priv_gst_binary_read_uint64 (reader, &l1))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT64);
+      g_value_set_int64 (value, (gint64) l1);
+      break;
+    case BINARY_VALUE_UINT64:
+      if (!_priv_gst_binary_read_uint64 (reader, &l1))
+        return FALSE;
+      g_value_init (value, G_TYPE_UINT64);
+      g_value_set_uint64 (value, l1);
+      break;
+    case BINARY_VALUE_FLOAT:
+      if (!gst_binary_read_double (reader, &d1))
+        return FALSE;
+      g_value_init (value, G_TYPE_FLOAT);
+      g_value_set_float (value, d1);
+      break;
+    case BINARY_VALUE_DOUBLE:
+      if (!gst_binary_read_double (reader, &d1))
+        return FALSE;
+      g_value_init (value, G_TYPE_DOUBLE);
+      g_value_set_double (value, d1);
+      break;
+    case BINARY_VALUE_STRING:
+      if (!_priv_gst_binary_read_string (reader, &str))
+        return FALSE;
+      g_value_init (value, G_TYPE_STRING);
+      g_value_take_string (value, str);
+      break;
+    case BINARY_VALUE_ENUM:
+      if (!(type = gst_binary_read_type (reader, G_TYPE_ENUM)) ||
+          !_priv_gst_binary_read_uint32 (reader, &u1))
+        return FALSE;
+      g_value_init (value, type);
+      g_value_set_enum (value, (gint) u1);
+      break;
+    case BINARY_VALUE_FLAGS:
+      if (!(type = gst_binary_read_type (reader, G_TYPE_FLAGS)) ||
+          !_priv_gst_binary_read_uint32 (reader, &u1))
+        return FALSE;
+      g_value_init (value, type);
+      g_value_set_flags (value, u1);
+      break;
+    case BINARY_VALUE_FRACTION:
+      /* gst_value_set_fraction() only accepts -G_MAXINT..G_MAXINT */
+      if (!gst_binary_read_int32 (reader, &i1) ||
+          !gst_binary_read_int32 (reader, &i2) || i2 == 0 ||
+          i1 == G_MININT || i2 == G_MININT)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION);
+      gst_value_set_fraction (value, i1, i2);
+      break;
+    case BINARY_VALUE_INT_RANGE:
+      if (!gst_binary_read_int32 (reader, &i1) ||
+          !gst_binary_read_int32 (reader, &i2) ||
+          !gst_binary_read_int32 (reader, &i3) || i3 <= 0 || i1 >= i2 ||
+          i1 % i3 != 0 || i2 % i3 != 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT_RANGE);
+      gst_value_set_int_range_step (value, i1, i2, i3);
+      break;
+    case BINARY_VALUE_INT64_RANGE:
+      if (!_priv_gst_binary_read_uint64 (reader, &l1) ||
+          !_priv_gst_binary_read_uint64 (reader, &l2) ||
+          !_priv_gst_binary_read_uint64 (reader, &l3) || (gint64) l3 <= 0 ||
+          (gint64) l1 >= (gint64) l2 || (gint64) l1 % (gint64) l3 != 0 ||
+          (gint64) l2 % (gint64) l3 != 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT64_RANGE);
+      gst_value_set_int64_range_step (value, l1, l2, l3);
+      break;
+    case BINARY_VALUE_DOUBLE_RANGE:
+      if (!gst_binary_read_double (reader, &d1) ||
+          !gst_binary_read_double (reader, &d2) || !(d1 < d2))
+        return FALSE;
+      g_value_init (value, GST_TYPE_DOUBLE_RANGE);
+      gst_value_set_double_range (value, d1, d2);
+      break;
+    case BINARY_VALUE_FRACTION_RANGE:
+      if (!gst_binary_read_int32 (reader, &i1) ||
+          !gst_binary_read_int32 (reader, &i2) ||
+          !gst_binary_read_int32 (reader, &i3) ||
+          !gst_binary_read_int32 (reader, &i4) || i2 == 0 || i4 == 0 ||
+          i1 == G_MININT || i2 == G_MININT || i3 == G_MININT ||
+          i4 == G_MININT || gst_util_fraction_compare (i1, i2, i3, i4) >= 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION_RANGE);
+      gst_value_set_fraction_range_full (value, i1, i2, i3, i4);
+      break;
+    case BINARY_VALUE_LIST:
+    case BINARY_VALUE_ARRAY:
+      if (reader->depth >= GST_BINARY_MAX_DEPTH)
+        return FALSE;
+      reader->depth++;
+      if (tag == BINARY_VALUE_LIST) {
+        g_value_init (value, GST_TYPE_LIST);
+        res = gst_binary_read_list (reader, value,
+            gst_value_list_append_and_take_value);
+      } else {
+        g_value_init (value, GST_TYPE_ARRAY);
+        res = gst_binary_read_list (reader, value,
+            gst_value_array_append_and_take_value);
+      }
+      reader->depth--;
+      break;
+    case BINARY_VALUE_BITMASK:
+      if (!_priv_gst_binary_read_uint64 (reader, &l1))
+        return FALSE;
+      g_value_init (value, GST_TYPE_BITMASK);
+      gst_value_set_bitmask (value, l1);
+      break;
+    case BINARY_VALUE_FLAG_SET:
+      if (!(type = gst_binary_read_type (reader, GST_TYPE_FLAG_SET)) ||
+          !_priv_gst_binary_read_uint32 (reader, &u1) ||
+          !_priv_gst_binary_read_uint32 (reader, &u2))
+        return FALSE;
+      g_value_init (value, type);
+      gst_value_set_flagset (value, u1, u2);
+      break;
+    case BINARY_VALUE_STRUCTURE:
+    case BINARY_VALUE_CAPS:
+      if (!_priv_gst_binary_read_uint8 (reader, &b))
+        return FALSE;
+      if (reader->depth >= GST_BINARY_MAX_DEPTH)
+        return FALSE;
+      reader->depth++;
+      if (tag == BINARY_VALUE_STRUCTURE) {
+        GstStructure *structure = NULL;
+
+        if (b && !(structure = _priv_gst_structure_read_binary (reader)))
+          res = FALSE;
+        g_value_init (value, GST_TYPE_STRUCTURE);
+        g_value_take_boxed (value, structure);
+      } else {
+        GstCaps *caps = NULL;
+
+        if (b && !(caps = _priv_gst_caps_read_binary (reader)))
+          res = FALSE;
+        g_value_init (value, GST_TYPE_CAPS);
+        g_value_take_boxed (value, caps);
+      }
+      reader->depth--;
+      break;
+    case BINARY_VALUE_CAPS_FEATURES:{
+      GstCapsFeatures *features = NULL;
+
+      if (!_priv_gst_binary_read_string (reader, &str))
+        return FALSE;
+      if (str && !(features = gst_caps_features_from_string (str))) {
+        g_free (str);
+        return FALSE;
+      }
+      g_free (str);
+      g_value_init (value, GST_TYPE_CAPS_FEATURES);
+      g_value_take_boxed (value, features);
+      break;
+    }
+    case BINARY_VALUE_BUFFER:{
+      GstBuffer *buffer = NULL;
+
+      if (!_priv_gst_binary_read_uint8 (reader, &b))
+        return FALSE;
+      if (b) {
+        if (!_priv_gst_binary_read_uint32 (reader, &u1) ||
+            reader->size - reader->offset < u1)
+          return FALSE;
+        buffer = gst_buffer_new_allocate (NULL, u1, NULL);
+        gst_buffer_fill (buffer, 0, reader->data + reader->offset, u1);
+        reader->offset += u1;
+      }
+      g_value_init (value, GST_TYPE_BUFFER);
+      g_value_take_boxed (value, buffer);
+      break;
+    }
+    case BINARY_VALUE_DATE:
+      if (!_priv_gst_binary_read_uint32 (reader, &u1))
+        return FALSE;
+      g_value_init (value, G_TYPE_DATE);
+      if (u1 != 0) {
+        if (!g_date_valid_julian (u1))
+          return FALSE;
+        g_value_take_boxed (value, g_date_new_julian (u1));
+      }
+      break;
+    case BINARY_VALUE_SERIALIZED:
+      if (!(type = gst_binary_read_type (reader, G_TYPE_INVALID)))
+        return FALSE;
+      if (!_priv_gst_binary_read_string (reader, &str) || str == NULL)
+        return FALSE;
+      g_value_init (value, type);
+      res = gst_value_deserialize (value, str);
+      g_free (str);
+      break;
+    default:
+      GST_WARNING ("unknown value tag %u in binary data", tag);
+      return FALSE;
+  }
+
+  return res;
+}
+
 static gboolean
 structure_field_is_fixed (GQuark field_id, const GValue * val,
     gpointer user_data)
@@ -7683,6 +8513,8 @@ _priv_gst_value_initialize (void)
   gst_value_register_union_func (GST_TYPE_STRUCTURE, GST_TYPE_STRUCTURE,
       gst_value_union_structure_structure);
 
+  gst_value_dispatch_build ();
+
 #if GST_VERSION_NANO == 1
   /* If building from git master, check starting array sizes matched actual size
    * so we can keep the defines in sync and save a few reallocs on startup */
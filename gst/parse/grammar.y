@@ -206,6 +206,29 @@ static void  add_missing_element(graph_t *graph,gchar *name){
     }
 }
 
+/* create an element, with the factories of the template when parsing for a
+ * GstParseTemplate. This skips the registry lookups of
+ * gst_element_factory_make() */
+static GstElement *
+gst_parse_element_make (graph_t * graph, const gchar * factory_name)
+{
+  GstElementFactory *factory;
+
+  if (graph->factories == NULL)
+    return gst_element_factory_make (factory_name, NULL);
+
+  factory = g_hash_table_lookup (graph->factories, factory_name);
+  if (factory == NULL) {
+    if (graph->factories_frozen)
+      return gst_element_factory_make (factory_name, NULL);
+    if (!(factory = gst_element_factory_find (factory_name)))
+      return NULL;
+    g_hash_table_insert (graph->factories, g_strdup (factory_name), factory);
+  }
+
+  return gst_element_factory_create (factory, NULL);
+}
+
 
 /*******************************************************************************************
 *** helpers for pipeline-setup
@@ -810,7 +833,7 @@ static int yyerror (void *scanner, graph_t *graph, const char *s);
 *	identity silence=false name=frodo
 *   (cont'd)
 **************************************************************/
-element:	IDENTIFIER     		      { $$ = gst_element_factory_make ($1, NULL);
+element:	IDENTIFIER     		      { $$ = gst_parse_element_make (graph, $1);
 						if ($$ == NULL) {
 						  add_missing_element(graph, $1);
 						  SET_ERROR (graph->error, GST_PARSE_ERROR_NO_SUCH_ELEMENT, _("no element \"%s\""), $1);
@@ -1078,7 +1101,7 @@ binopener:	'('			      { $$ = gst_parse_strdup("bin"); }
 bin:	binopener assignments chainlist ')'   {
 						chain_t *chain = $3;
 						GSList *walk;
-						GstBin *bin = (GstBin *) gst_element_factory_make ($1, NULL);
+						GstBin *bin = (GstBin *) gst_parse_element_make (graph, $1);
 						if (!chain) {
 						  SET_ERROR (graph->error, GST_PARSE_ERROR_EMPTY_BIN,
 						    _("specified empty bin \"%s\", not allowed"), $1);
@@ -1141,7 +1164,7 @@ yyerror (void *scanner, graph_t *graph, const char *s)
 
 GstElement *
 priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
-    GstParseFlags flags)
+    GstParseFlags flags, GHashTable *factories, gboolean factories_frozen)
 {
   graph_t g;
   gchar *dstr;
@@ -1158,6 +1181,8 @@ priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
   g.error = error;
   g.ctx = ctx;
   g.flags = flags;
+  g.factories = factories;
+  g.factories_frozen = factories_frozen;
 
 #ifdef __GST_PARSE_TRACE
   GST_CAT_DEBUG (GST_CAT_PIPELINE, "TRACE: tracing enabled");
@@ -1210,9 +1235,9 @@ priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
   /* put all elements in our bin if necessary */
   if(g.chain->elements->next){
     if (flags & GST_PARSE_FLAG_PLACE_IN_BIN)
-      bin = GST_BIN (gst_element_factory_make ("bin", NULL));
+      bin = GST_BIN (gst_parse_element_make (&g, "bin"));
     else
-      bin = GST_BIN (gst_element_factory_make ("pipeline", NULL));
+      bin = GST_BIN (gst_parse_element_make (&g, "pipeline"));
     g_assert (bin);
 
     for (walk = g.chain->elements; walk; walk = walk->next) {
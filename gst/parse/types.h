@@ -31,6 +31,10 @@ struct _graph_t {
   GError **error;
   GstParseContext *ctx; /* may be NULL */
   GstParseFlags flags;
+  /* factory name -> GstElementFactory of a GstParseTemplate, may be NULL.
+   * Only filled while the template is created, read-only afterwards */
+  GHashTable *factories;
+  gboolean factories_frozen;
 };
 
 
@@ -105,6 +109,8 @@ gst_parse_unescape (gchar *str)
 G_GNUC_INTERNAL GstElement *priv_gst_parse_launch (const gchar      * str,
                                                    GError          ** err,
                                                    GstParseContext  * ctx,
-                                                   GstParseFlags      flags);
+                                                   GstParseFlags      flags,
+                                                   GHashTable       * factories,
+                                                   gboolean           factories_frozen);
 
 #endif /* __GST_PARSE_TYPES_H__ */
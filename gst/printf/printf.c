@@ -157,3 +157,18 @@ __gst_vasprintf (char **result, char const *format, va_list args)
 
   return length;
 }
+
+/* like __gst_vasprintf() but uses the SIZE bytes at BUF for the result when
+ * it fits, *RESULT is BUF then and must not be freed */
+int
+__gst_vasnprintf_buf (char **result, char *buf, size_t size,
+    char const *format, va_list args)
+{
+  size_t length = size;
+
+  *result = vasnprintf (buf, &length, format, args);
+  if (*result == NULL)
+    return -1;
+
+  return length;
+}
@@ -60,5 +60,11 @@ int __gst_vasprintf (char       **result,
                      char const *format,
                      va_list      args);
 
+int __gst_vasnprintf_buf (char       **result,
+                          char        *buf,
+                          size_t       size,
+                          char const *format,
+                          va_list      args);
+
 
 #endif /* __GNULIB_PRINTF_H__ */
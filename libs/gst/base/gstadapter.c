@@ -113,6 +113,13 @@
  * gst_adapter_copy() can be used to copy data into a (statically allocated)
  * user provided buffer.
  *
+ * Parsers that receive many small buffers, like the 188 byte packets of an
+ * MPEG-TS stream, can call gst_adapter_set_coalesce_size(). The adapter then
+ * copies small untimestamped buffers into larger buffers it allocates itself,
+ * so that the data can later be mapped and taken without merging and flushing
+ * can release many packets at once. Buffers that are larger than the coalesce
+ * size are still queued without copying.
+ *
  * #GstAdapter is not MT safe. All operations on an adapter must be serialized by
  * the caller. This is not normally a problem, however, as the normal use case
  * of #GstAdapter is inside one pad's chain function, in which case access is
@@ -126,10 +133,13 @@
 
 #include <gst/gst_private.h>
 #include "gstadapter.h"
+#include "gstscan-private.h"
 #include <string.h>
 
 /* default size for the assembled data buffer */
 #define DEFAULT_SIZE 4096
+/* minimum size of the buffers small pushes are coalesced into */
+#define ARENA_SIZE (64 * 1024)
 
 static void gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush);
 
@@ -169,6 +179,15 @@ struct _GstAdapter
   guint64 distance_from_discont;
 
   GstMapInfo info;
+
+  /* memories mapped with gst_adapter_map_segments() */
+  GArray *segments;
+  GArray *segment_maps;
+
+  /* buffers up to this size are copied into the arena */
+  gsize coalesce_size;
+  /* the last buffer of buflist if allocated by us, not reffed */
+  GstBuffer *arena;
 };
 
 struct _GstAdapterClass
@@ -227,6 +246,11 @@ gst_adapter_finalize (GObject * object)
 
   g_free (adapter->assembled_data);
 
+  if (adapter->segments) {
+    g_array_free (adapter->segments, TRUE);
+    g_array_free (adapter->segment_maps, TRUE);
+  }
+
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
 }
 
@@ -256,6 +280,8 @@ gst_adapter_clear (GstAdapter * adapter)
 
   if (adapter->info.memory)
     gst_adapter_unmap (adapter);
+  if (adapter->segment_maps && adapter->segment_maps->len)
+    gst_adapter_unmap_segments (adapter);
 
   g_slist_foreach (adapter->buflist, (GFunc) gst_mini_object_unref, NULL);
   g_slist_free (adapter->buflist);
@@ -264,6 +290,7 @@ gst_adapter_clear (GstAdapter * adapter)
   adapter->count = 0;
   adapter->size = 0;
   adapter->skip = 0;
+  adapter->arena = NULL;
   adapter->assembled_len = 0;
   adapter->pts = GST_CLOCK_TIME_NONE;
   adapter->pts_distance = 0;
@@ -364,6 +391,86 @@ copy_into_unchecked (GstAdapter * adapter, guint8 * dest, gsize skip,
   }
 }
 
+/**
+ * gst_adapter_set_coalesce_size:
+ * @adapter: a #GstAdapter
+ * @size: the maximum size of the buffers to coalesce, or 0
+ *
+ * Makes @adapter copy pushed buffers of at most @size bytes into larger
+ * buffers that it allocates itself. This avoids merging when mapping or
+ * taking data that spans many small buffers, at the cost of one copy per
+ * pushed byte.
+ *
+ * Only buffers without timestamps, offset, flags and metadata are copied,
+ * all other buffers are queued as they are. A @size of 0, the default,
+ * disables coalescing.
+ *
+ * Since: 1.14
+ */
+void
+gst_adapter_set_coalesce_size (GstAdapter * adapter, gsize size)
+{
+  g_return_if_fail (GST_IS_ADAPTER (adapter));
+
+  adapter->coalesce_size = size;
+}
+
+/* only plain data can be copied, the timestamps, offset, flags and metadata
+ * of the pushed buffers have to be preserved */
+static inline gboolean
+gst_adapter_can_coalesce (GstAdapter * adapter, GstBuffer * buf, gsize size)
+{
+  gpointer state = NULL;
+
+  return size > 0 && size <= adapter->coalesce_size &&
+      !GST_BUFFER_PTS_IS_VALID (buf) && !GST_BUFFER_DTS_IS_VALID (buf) &&
+      GST_BUFFER_OFFSET (buf) == GST_BUFFER_OFFSET_NONE &&
+      GST_BUFFER_FLAGS (buf) == 0 && !gst_buffer_iterate_meta (buf, &state);
+}
+
+/* checks if @size more bytes can be copied into the arena */
+static gboolean
+gst_adapter_arena_has_room (GstAdapter * adapter, gsize size)
+{
+  GstBuffer *arena = adapter->arena;
+  gsize cursize, offset, maxsize;
+
+  if (arena == NULL)
+    return FALSE;
+
+  /* the arena can only grow while nothing else refers to its memory */
+  if (adapter->info.memory || (adapter->segment_maps
+          && adapter->segment_maps->len) || !gst_buffer_is_writable (arena)
+      || !gst_buffer_is_memory_range_writable (arena, 0, -1))
+    return FALSE;
+
+  cursize = gst_buffer_get_sizes (arena, &offset, &maxsize);
+
+  return cursize + size <= maxsize - offset;
+}
+
+/* queues a new empty arena with room for at least @size bytes */
+static void
+gst_adapter_push_arena (GstAdapter * adapter, gsize size)
+{
+  GstBuffer *arena;
+
+  arena = gst_buffer_new_allocate (NULL, MAX (ARENA_SIZE, size), NULL);
+  gst_buffer_set_size (arena, 0);
+
+  GST_LOG_OBJECT (adapter, "pushing new arena %p", arena);
+
+  if (G_UNLIKELY (adapter->buflist == NULL)) {
+    adapter->buflist = adapter->buflist_end = g_slist_append (NULL, arena);
+    update_timestamps_and_offset (adapter, arena);
+  } else {
+    adapter->buflist_end = g_slist_append (adapter->buflist_end, arena);
+    adapter->buflist_end = g_slist_next (adapter->buflist_end);
+  }
+  ++adapter->count;
+  adapter->arena = arena;
+}
+
 /**
  * gst_adapter_push:
  * @adapter: a #GstAdapter
@@ -383,6 +490,27 @@ gst_adapter_push (GstAdapter * adapter, GstBuffer * buf)
   size = gst_buffer_get_size (buf);
   adapter->size += size;
 
+  if (gst_adapter_can_coalesce (adapter, buf, size)) {
+    GstMapInfo map;
+    gsize offset;
+
+    if (!gst_adapter_arena_has_room (adapter, size))
+      gst_adapter_push_arena (adapter, size);
+
+    offset = gst_buffer_get_size (adapter->arena);
+    gst_buffer_set_size (adapter->arena, offset + size);
+
+    GST_LOG_OBJECT (adapter, "copying %p %" G_GSIZE_FORMAT " bytes into arena "
+        "%p, size now %" G_GSIZE_FORMAT, buf, size, adapter->arena,
+        adapter->size);
+    gst_buffer_map (adapter->arena, &map, GST_MAP_WRITE);
+    gst_buffer_extract (buf, 0, map.data + offset, size);
+    gst_buffer_unmap (adapter->arena, &map);
+    gst_buffer_unref (buf);
+    return;
+  }
+  adapter->arena = NULL;
+
   /* Note: merging buffers at this point is premature. */
   if (G_UNLIKELY (adapter->buflist == NULL)) {
     GST_LOG_OBJECT (adapter, "pushing %p first %" G_GSIZE_FORMAT " bytes",
@@ -574,6 +702,115 @@ gst_adapter_unmap (GstAdapter * adapter)
   }
 }
 
+/**
+ * gst_adapter_map_segments:
+ * @adapter: a #GstAdapter
+ * @size: the number of bytes to map
+ * @n_segments: (out): the number of returned segments
+ *
+ * Gets the first @size bytes stored in the @adapter as a list of contiguous
+ * segments, one for each memory the bytes are stored in. Unlike
+ * gst_adapter_map(), data spanning several memories is not copied.
+ *
+ * The segments are valid until the next function is called on the adapter.
+ * Call gst_adapter_unmap_segments() when done with them.
+ *
+ * Returns %NULL if @size bytes are not available.
+ *
+ * Returns: (transfer none) (array length=n_segments) (nullable): the segments
+ *     covering the first @size bytes of data, or %NULL
+ *
+ * Since: 1.14
+ */
+const GstAdapterSegment *
+gst_adapter_map_segments (GstAdapter * adapter, gsize size, guint * n_segments)
+{
+  GSList *g;
+  gsize skip;
+
+  g_return_val_if_fail (GST_IS_ADAPTER (adapter), NULL);
+  g_return_val_if_fail (size > 0, NULL);
+  g_return_val_if_fail (n_segments != NULL, NULL);
+
+  *n_segments = 0;
+
+  gst_adapter_unmap_segments (adapter);
+
+  if (G_UNLIKELY (size > adapter->size))
+    return NULL;
+
+  if (adapter->segments == NULL) {
+    adapter->segments = g_array_new (FALSE, TRUE, sizeof (GstAdapterSegment));
+    adapter->segment_maps = g_array_new (FALSE, FALSE, sizeof (GstMapInfo));
+  }
+
+  skip = adapter->skip;
+  for (g = adapter->buflist; size > 0; g = g->next) {
+    GstBuffer *cur = g->data;
+    guint i, n = gst_buffer_n_memory (cur);
+
+    for (i = 0; i < n && size > 0; i++) {
+      GstMemory *mem = gst_buffer_peek_memory (cur, i);
+      GstAdapterSegment segment = { NULL, };
+      GstMapInfo info;
+
+      if (skip >= mem->size) {
+        skip -= mem->size;
+        continue;
+      }
+
+      if (!gst_memory_map (mem, &info, GST_MAP_READ))
+        goto map_failed;
+      g_array_append_val (adapter->segment_maps, info);
+
+      segment.data = info.data + skip;
+      segment.size = MIN (info.size - skip, size);
+      g_array_append_val (adapter->segments, segment);
+
+      size -= segment.size;
+      skip = 0;
+    }
+  }
+
+  *n_segments = adapter->segments->len;
+
+  return (const GstAdapterSegment *) adapter->segments->data;
+
+map_failed:
+  {
+    GST_WARNING_OBJECT (adapter, "failed to map memory");
+    gst_adapter_unmap_segments (adapter);
+    return NULL;
+  }
+}
+
+/**
+ * gst_adapter_unmap_segments:
+ * @adapter: a #GstAdapter
+ *
+ * Releases the memory obtained with the last gst_adapter_map_segments().
+ *
+ * Since: 1.14
+ */
+void
+gst_adapter_unmap_segments (GstAdapter * adapter)
+{
+  guint i;
+
+  g_return_if_fail (GST_IS_ADAPTER (adapter));
+
+  if (adapter->segment_maps == NULL)
+    return;
+
+  for (i = 0; i < adapter->segment_maps->len; i++) {
+    GstMapInfo *info = &g_array_index (adapter->segment_maps, GstMapInfo, i);
+
+    gst_memory_unmap (info->memory, info);
+  }
+  g_array_set_size (adapter->segment_maps, 0);
+  g_array_set_size (adapter->segments, 0);
+}
+
 /**
  * gst_adapter_copy: (skip)
  * @adapter: a #GstAdapter
@@ -635,6 +872,8 @@ gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
 
   if (adapter->info.memory)
     gst_adapter_unmap (adapter);
+  if (adapter->segment_maps && adapter->segment_maps->len)
+    gst_adapter_unmap_segments (adapter);
 
   /* clear state */
   adapter->size -= flush;
@@ -660,6 +899,8 @@ gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
     adapter->distance_from_discont += size;
     flush -= size;
 
+    if (cur == adapter->arena)
+      adapter->arena = NULL;
     gst_buffer_unref (cur);
     g = g_slist_delete_link (g, g);
     --adapter->count;
@@ -1659,11 +1900,15 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
   GstMapInfo info;
   guint8 *bdata;
   GstBuffer *buf;
+  gboolean start_code;
 
   g_return_val_if_fail (size > 0, -1);
   g_return_val_if_fail (offset + size <= adapter->size, -1);
   g_return_val_if_fail (((~mask) & pattern) == 0, -1);
 
+  /* special case found in MPEG and H264 */
+  start_code = (pattern == 0x00000100) && (mask == 0xffffff00);
+
   /* we can't find the pattern with less than 4 bytes */
   if (G_UNLIKELY (size < 4))
     return -1;
@@ -1703,8 +1948,15 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
 
   /* now find data */
   do {
+    guint end;
+
     bsize = MIN (bsize, size);
-    for (i = 0; i < bsize; i++) {
+
+    /* with the start code scan, only the matches that began in the previous
+     * buffers are found byte by byte */
+    end = (start_code && bsize >= 4) ? 3 : bsize;
+
+    for (i = 0; i < end; i++) {
       state = ((state << 8) | bdata[i]);
       if (G_UNLIKELY ((state & mask) == pattern)) {
         /* we have a match but we need to have skipped at
@@ -1717,6 +1969,17 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
         }
       }
     }
+    if (end < bsize) {
+      gint ret = _gst_scan_for_start_code (bdata, bsize);
+
+      if (ret != -1) {
+        if (G_LIKELY (value))
+          *value = GST_READ_UINT32_BE (bdata + ret);
+        gst_buffer_unmap (buf, &info);
+        return offset + skip + ret;
+      }
+      state = GST_READ_UINT32_BE (bdata + bsize - 4);
+    }
     size -= bsize;
     if (size == 0)
       break;
@@ -46,6 +46,24 @@ G_BEGIN_DECLS
 typedef struct _GstAdapter GstAdapter;
 typedef struct _GstAdapterClass GstAdapterClass;
 
+/**
+ * GstAdapterSegment:
+ * @data: (array length=size): the data of the segment
+ * @size: the number of bytes in @data
+ *
+ * A contiguous piece of the data in a #GstAdapter, see
+ * gst_adapter_map_segments().
+ *
+ * Since: 1.14
+ */
+typedef struct {
+  const guint8 *data;
+  gsize         size;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+} GstAdapterSegment;
+
 GST_EXPORT
 GType                   gst_adapter_get_type            (void);
 
@@ -58,12 +76,21 @@ void                    gst_adapter_clear               (GstAdapter *adapter);
 GST_EXPORT
 void                    gst_adapter_push                (GstAdapter *adapter, GstBuffer* buf);
 
+GST_EXPORT
+void                    gst_adapter_set_coalesce_size   (GstAdapter *adapter, gsize size);
+
 GST_EXPORT
 gconstpointer           gst_adapter_map                 (GstAdapter *adapter, gsize size);
 
 GST_EXPORT
 void                    gst_adapter_unmap               (GstAdapter *adapter);
 
+GST_EXPORT
+const GstAdapterSegment * gst_adapter_map_segments      (GstAdapter *adapter, gsize size,
+                                                         guint *n_segments);
+GST_EXPORT
+void                    gst_adapter_unmap_segments      (GstAdapter *adapter);
+
 GST_EXPORT
 void                    gst_adapter_copy                (GstAdapter *adapter, gpointer dest,
                                                          gsize offset, gsize size);
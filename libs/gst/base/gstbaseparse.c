@@ -170,21 +170,21 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include <gst/base/gstadapter.h>
 
 #include "gstbaseparse.h"
 
-/* FIXME: get rid of old GstIndex code */
-#include "gstindex.h"
-#include "gstindex.c"
-#include "gstmemindex.c"
+#include "gstseekindex.h"
 
 #define GST_BASE_PARSE_FRAME_PRIVATE_FLAG_NOALLOC  (1 << 0)
 
 #define MIN_FRAMES_TO_POST_BITRATE 10
 #define TARGET_DIFFERENCE          (20 * GST_SECOND)
 #define MAX_INDEX_ENTRIES          4096
+/* frames parsed in a row for each window of the bitrate sampling */
+#define SAMPLE_FRAMES              8
 #define UPDATE_THRESHOLD           2
 
 #define ABSDIFF(a,b) (((a) > (b)) ? ((a) - (b)) : ((b) - (a)))
@@ -213,6 +213,10 @@ struct _GstBaseParsePrivate
   GstFormat duration_fmt;
   gint64 estimated_duration;
   gint64 estimated_drift;
+  /* frames sampled over the stream to estimate the bitrate */
+  guint sample_windows;
+  guint64 sampled_bytes;
+  GstClockTime sampled_duration;
 
   guint min_frame_size;
   gboolean disable_passthrough;
@@ -267,11 +271,12 @@ struct _GstBaseParsePrivate
 
   GstBuffer *cache;
 
-  /* index entry storage, either ours or provided */
-  GstIndex *index;
-  gint index_id;
-  gboolean own_index;
+  /* key unit index entry storage */
+  GstSeekIndex *index;
   GMutex index_lock;
+  /* file to load the index from and save it to */
+  gchar *index_location;
+  gboolean index_loaded;
 
   /* seek table entries only maintained if upstream is BYTE seekable */
   gboolean upstream_seekable;
@@ -336,6 +341,15 @@ struct _GstBaseParsePrivate
   GstTagList *parser_tags;
   GstTagMergeMode parser_tags_merge_mode;
   gboolean tags_changed;
+
+  /* frames handed to process_frame in a task pool, oldest first */
+  guint max_parallel_frames;
+  GstTaskPool *task_pool;
+  GQueue parallel_frames;
+  GMutex parallel_lock;
+  GCond parallel_cond;
+  /* a frame dropped by process_frame was a discont */
+  gboolean process_discont;
 };
 
 typedef struct _GstBaseParseSeek
@@ -347,11 +361,13 @@ typedef struct _GstBaseParseSeek
 } GstBaseParseSeek;
 
 #define DEFAULT_DISABLE_PASSTHROUGH        FALSE
+#define DEFAULT_INDEX_LOCATION             NULL
 
 enum
 {
   PROP_0,
   PROP_DISABLE_PASSTHROUGH,
+  PROP_INDEX_LOCATION,
   PROP_LAST
 };
 
@@ -398,11 +414,6 @@ static GstStateChangeReturn gst_base_parse_change_state (GstElement * element,
     GstStateChange transition);
 static void gst_base_parse_reset (GstBaseParse * parse);
 
-#if 0
-static void gst_base_parse_set_index (GstElement * element, GstIndex * index);
-static GstIndex *gst_base_parse_get_index (GstElement * element);
-#endif
-
 static gboolean gst_base_parse_sink_activate (GstPad * sinkpad,
     GstObject * parent);
 static gboolean gst_base_parse_sink_activate_mode (GstPad * pad,
@@ -449,6 +460,7 @@ static gint64 gst_base_parse_find_offset (GstBaseParse * parse,
     GstClockTime time, gboolean before, GstClockTime * _ts);
 static GstFlowReturn gst_base_parse_locate_time (GstBaseParse * parse,
     GstClockTime * _time, gint64 * _offset);
+static void gst_base_parse_sample_bitrate (GstBaseParse * parse);
 
 static GstFlowReturn gst_base_parse_start_fragment (GstBaseParse * parse);
 static GstFlowReturn gst_base_parse_finish_fragment (GstBaseParse * parse,
@@ -461,9 +473,15 @@ static gboolean gst_base_parse_is_seekable (GstBaseParse * parse);
 
 static void gst_base_parse_push_pending_events (GstBaseParse * parse);
 
+static GstFlowReturn gst_base_parse_push_parallel_frames (GstBaseParse * parse,
+    guint max_pending);
+static void gst_base_parse_discard_parallel_frames (GstBaseParse * parse);
+
 static void
 gst_base_parse_clear_queues (GstBaseParse * parse)
 {
+  gst_base_parse_discard_parallel_frames (parse);
+
   g_slist_foreach (parse->priv->buffers_queued, (GFunc) gst_buffer_unref, NULL);
   g_slist_free (parse->priv->buffers_queued);
   parse->priv->buffers_queued = NULL;
@@ -503,14 +521,20 @@ gst_base_parse_finalize (GObject * object)
 
   g_object_unref (parse->priv->adapter);
 
-  if (parse->priv->index) {
-    gst_object_unref (parse->priv->index);
-    parse->priv->index = NULL;
-  }
+  gst_seek_index_free (parse->priv->index);
   g_mutex_clear (&parse->priv->index_lock);
+  g_free (parse->priv->index_location);
 
   gst_base_parse_clear_queues (parse);
 
+  if (parse->priv->task_pool) {
+    gst_task_pool_cleanup (parse->priv->task_pool);
+    gst_object_unref (parse->priv->task_pool);
+    parse->priv->task_pool = NULL;
+  }
+  g_mutex_clear (&parse->priv->parallel_lock);
+  g_cond_clear (&parse->priv->parallel_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -544,15 +568,26 @@ gst_base_parse_class_init (GstBaseParseClass * klass)
           DEFAULT_DISABLE_PASSTHROUGH,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBaseParse:index-location:
+   *
+   * A file to keep the seek index of the stream in. If set, the index is
+   * loaded from this file when the parser starts on a seekable stream of the
+   * same size as the stream it was saved for, so seeking is accurate right
+   * away, and the index is saved to it when the parser stops.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_LOCATION,
+      g_param_spec_string ("index-location", "Index location",
+          "File to load the seek index from and save it to",
+          DEFAULT_INDEX_LOCATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class = (GstElementClass *) klass;
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_base_parse_change_state);
 
-#if 0
-  gstelement_class->set_index = GST_DEBUG_FUNCPTR (gst_base_parse_set_index);
-  gstelement_class->get_index = GST_DEBUG_FUNCPTR (gst_base_parse_get_index);
-#endif
-
   /* Default handlers */
   klass->sink_event = gst_base_parse_sink_event_default;
   klass->src_event = gst_base_parse_src_event_default;
@@ -610,8 +645,13 @@ gst_base_parse_init (GstBaseParse * parse, GstBaseParseClass * bclass)
 
   parse->priv->pad_mode = GST_PAD_MODE_NONE;
 
+  parse->priv->index = gst_seek_index_new ();
   g_mutex_init (&parse->priv->index_lock);
 
+  g_queue_init (&parse->priv->parallel_frames);
+  g_mutex_init (&parse->priv->parallel_lock);
+  g_cond_init (&parse->priv->parallel_cond);
+
   /* init state */
   gst_base_parse_reset (parse);
   GST_DEBUG_OBJECT (parse, "init ok");
@@ -633,6 +673,12 @@ gst_base_parse_set_property (GObject * object, guint prop_id,
     case PROP_DISABLE_PASSTHROUGH:
       parse->priv->disable_passthrough = g_value_get_boolean (value);
       break;
+    case PROP_INDEX_LOCATION:
+      GST_BASE_PARSE_INDEX_LOCK (parse);
+      g_free (parse->priv->index_location);
+      parse->priv->index_location = g_value_dup_string (value);
+      GST_BASE_PARSE_INDEX_UNLOCK (parse);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -649,6 +695,11 @@ gst_base_parse_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DISABLE_PASSTHROUGH:
       g_value_set_boolean (value, parse->priv->disable_passthrough);
       break;
+    case PROP_INDEX_LOCATION:
+      GST_BASE_PARSE_INDEX_LOCK (parse);
+      g_value_set_string (value, parse->priv->index_location);
+      GST_BASE_PARSE_INDEX_UNLOCK (parse);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -794,6 +845,8 @@ gst_base_parse_reset (GstBaseParse * parse)
   parse->priv->first_frame_offset = -1;
   parse->priv->estimated_duration = -1;
   parse->priv->estimated_drift = 0;
+  parse->priv->sampled_bytes = 0;
+  parse->priv->sampled_duration = 0;
   parse->priv->next_pts = GST_CLOCK_TIME_NONE;
   parse->priv->next_dts = 0;
   parse->priv->syncable = TRUE;
@@ -1115,6 +1168,11 @@ gst_base_parse_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
   GstBaseParseClass *bclass = GST_BASE_PARSE_GET_CLASS (parse);
   gboolean ret;
 
+  /* frames that are still being processed go before serialized events */
+  if (GST_EVENT_IS_SERIALIZED (event)
+      && GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP)
+    gst_base_parse_push_parallel_frames (parse, 0);
+
   ret = bclass->sink_event (parse, event);
 
   return ret;
@@ -1687,11 +1745,13 @@ gst_base_parse_convert_default (GstBaseParse * parse,
   }
 
   /* need at least some frames */
-  if (!parse->priv->framecount)
+  if (!parse->priv->framecount && !parse->priv->sampled_duration)
     goto no_framecount;
 
-  duration = parse->priv->acc_duration / GST_MSECOND;
-  bytes = parse->priv->bytecount;
+  /* the sampled frames are refined with the frames pushed so far */
+  duration = (parse->priv->acc_duration + parse->priv->sampled_duration) /
+      GST_MSECOND;
+  bytes = parse->priv->bytecount + parse->priv->sampled_bytes;
 
   if (G_UNLIKELY (!duration || !bytes))
     goto no_duration_bytes;
@@ -1877,7 +1937,8 @@ gst_base_parse_update_bitrates (GstBaseParse * parse, GstBaseParseFrame * frame)
  * @force: add entry disregarding sanity checks
  *
  * Adds an entry to the index associating @offset to @ts.  It is recommended
- * to only add keyframe entries.  @force allows to bypass checks, such as
+ * to only add keyframe entries, other entries are not used for seeking and
+ * are not kept.  @force allows to bypass checks, such as
  * whether the stream is (upstream) seekable, another entry is already "close"
  * to the new entry, etc.
  *
@@ -1888,7 +1949,6 @@ gst_base_parse_add_index_entry (GstBaseParse * parse, guint64 offset,
     GstClockTime ts, gboolean key, gboolean force)
 {
   gboolean ret = FALSE;
-  GstIndexAssociation associations[2];
 
   GST_LOG_OBJECT (parse, "Adding key=%d index entry %" GST_TIME_FORMAT
       " @ offset 0x%08" G_GINT64_MODIFIER "x", key, GST_TIME_ARGS (ts), offset);
@@ -1934,20 +1994,11 @@ gst_base_parse_add_index_entry (GstBaseParse * parse, guint64 offset,
     }
   }
 
-  associations[0].format = GST_FORMAT_TIME;
-  associations[0].value = ts;
-  associations[1].format = GST_FORMAT_BYTES;
-  associations[1].value = offset;
-
-  /* index might change on-the-fly, although that would be nutty app ... */
-  GST_BASE_PARSE_INDEX_LOCK (parse);
-  gst_index_add_associationv (parse->priv->index, parse->priv->index_id,
-      (key) ? GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT :
-      GST_INDEX_ASSOCIATION_FLAG_DELTA_UNIT, 2,
-      (const GstIndexAssociation *) &associations);
-  GST_BASE_PARSE_INDEX_UNLOCK (parse);
-
   if (key) {
+    GST_BASE_PARSE_INDEX_LOCK (parse);
+    gst_seek_index_add (parse->priv->index, ts, offset);
+    GST_BASE_PARSE_INDEX_UNLOCK (parse);
+
     parse->priv->index_last_offset = offset;
     parse->priv->index_last_ts = ts;
   }
@@ -1958,6 +2009,53 @@ exit:
   return ret;
 }
 
+/* loads the index from the index-location, once the upstream size is known */
+static void
+gst_base_parse_load_index (GstBaseParse * parse)
+{
+  GError *err = NULL;
+  gboolean loaded = FALSE;
+
+  GST_BASE_PARSE_INDEX_LOCK (parse);
+  if (parse->priv->index_location && !parse->priv->index_loaded) {
+    loaded = gst_seek_index_load (parse->priv->index,
+        parse->priv->index_location, parse->priv->upstream_size, &err);
+    parse->priv->index_loaded = TRUE;
+  }
+  GST_BASE_PARSE_INDEX_UNLOCK (parse);
+
+  if (err) {
+    GST_DEBUG_OBJECT (parse, "not using index file: %s", err->message);
+    g_clear_error (&err);
+  }
+
+  if (loaded) {
+    GST_DEBUG_OBJECT (parse, "loaded %u index entries",
+        gst_seek_index_get_size (parse->priv->index));
+    /* the index now has entries after the current position */
+    parse->priv->index_last_valid = FALSE;
+    parse->priv->index_last_offset = 0;
+    parse->priv->index_last_ts = 0;
+  }
+}
+
+static void
+gst_base_parse_save_index (GstBaseParse * parse)
+{
+  GError *err = NULL;
+
+  GST_BASE_PARSE_INDEX_LOCK (parse);
+  if (parse->priv->index_location && parse->priv->upstream_seekable &&
+      gst_seek_index_get_size (parse->priv->index) > 0) {
+    if (!gst_seek_index_save (parse->priv->index,
+            parse->priv->index_location, parse->priv->upstream_size, &err)) {
+      GST_WARNING_OBJECT (parse, "failed to save index: %s", err->message);
+      g_clear_error (&err);
+    }
+  }
+  GST_BASE_PARSE_INDEX_UNLOCK (parse);
+}
+
 /* check for seekable upstream, above and beyond a mere query */
 static void
 gst_base_parse_check_seekability (GstBaseParse * parse)
@@ -2018,6 +2116,9 @@ done:
   GST_DEBUG_OBJECT (parse, "idx_interval: %ums", idx_interval);
   parse->priv->idx_interval = idx_interval * GST_MSECOND;
   parse->priv->idx_byte_interval = idx_byte_interval;
+
+  if (seekable)
+    gst_base_parse_load_index (parse);
 }
 
 /* some misc checks on upstream */
@@ -2235,6 +2336,200 @@ gst_base_parse_push_pending_events (GstBaseParse * parse)
   }
 }
 
+typedef struct
+{
+  GstBaseParse *parse;
+  GstBaseParseFrame *frame;
+  GstFlowReturn ret;
+  gboolean done;
+} GstBaseParseJob;
+
+static void
+gst_base_parse_job_free (GstBaseParseJob * job)
+{
+  gst_buffer_replace (&job->frame->out_buffer, NULL);
+  gst_base_parse_frame_free (job->frame);
+  g_slice_free (GstBaseParseJob, job);
+}
+
+/* runs in a thread of the task pool */
+static void
+gst_base_parse_process_job (GstBaseParseJob * job)
+{
+  GstBaseParse *parse = job->parse;
+  GstBaseParseClass *klass = GST_BASE_PARSE_GET_CLASS (parse);
+  GstFlowReturn ret;
+
+  ret = klass->process_frame (parse, job->frame);
+
+  g_mutex_lock (&parse->priv->parallel_lock);
+  job->ret = ret;
+  job->done = TRUE;
+  g_cond_broadcast (&parse->priv->parallel_cond);
+  g_mutex_unlock (&parse->priv->parallel_lock);
+}
+
+/* pushes a frame after process_frame returned @ret for it. Takes ownership
+ * of the frame's buffers like gst_base_parse_push_frame() */
+static GstFlowReturn
+gst_base_parse_push_processed_frame (GstBaseParse * parse,
+    GstBaseParseFrame * frame, GstFlowReturn ret)
+{
+  if (ret == GST_FLOW_OK) {
+    if (G_UNLIKELY (parse->priv->process_discont)) {
+      GstBuffer **buffer = frame->out_buffer ? &frame->out_buffer :
+          &frame->buffer;
+
+      *buffer = gst_buffer_make_writable (*buffer);
+      GST_BUFFER_FLAG_SET (*buffer, GST_BUFFER_FLAG_DISCONT);
+      parse->priv->process_discont = FALSE;
+    }
+    return gst_base_parse_push_frame (parse, frame);
+  }
+
+  if (ret == GST_BASE_PARSE_FLOW_DROPPED) {
+    GST_LOG_OBJECT (parse, "frame dropped by subclass");
+    if (GST_BUFFER_FLAG_IS_SET (frame->buffer, GST_BUFFER_FLAG_DISCONT))
+      parse->priv->process_discont = TRUE;
+    ret = GST_FLOW_OK;
+  } else {
+    GST_LOG_OBJECT (parse, "frame not processed: %s", gst_flow_get_name (ret));
+  }
+  gst_buffer_replace (&frame->out_buffer, NULL);
+  gst_buffer_replace (&frame->buffer, NULL);
+
+  return ret;
+}
+
+/* pushes the frames of the finished jobs in order, waiting for the oldest
+ * job while more than @max_pending jobs are left. After a flow error, the
+ * remaining jobs are waited for and discarded.
+ *
+ * Must be called from the streaming thread, which is the only one that
+ * adds or removes jobs. */
+static GstFlowReturn
+gst_base_parse_push_parallel_frames (GstBaseParse * parse, guint max_pending)
+{
+  GstBaseParsePrivate *priv = parse->priv;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBaseParseJob *job;
+
+  if (g_queue_is_empty (&priv->parallel_frames))
+    return GST_FLOW_OK;
+
+  g_mutex_lock (&priv->parallel_lock);
+  while ((job = g_queue_peek_head (&priv->parallel_frames))) {
+    if (!job->done) {
+      if (g_queue_get_length (&priv->parallel_frames) <= max_pending)
+        break;
+      g_cond_wait (&priv->parallel_cond, &priv->parallel_lock);
+      continue;
+    }
+    g_queue_pop_head (&priv->parallel_frames);
+    g_mutex_unlock (&priv->parallel_lock);
+
+    if (ret == GST_FLOW_OK)
+      ret = gst_base_parse_push_processed_frame (parse, job->frame, job->ret);
+    gst_base_parse_job_free (job);
+
+    if (ret != GST_FLOW_OK)
+      max_pending = 0;
+    g_mutex_lock (&priv->parallel_lock);
+  }
+  g_mutex_unlock (&priv->parallel_lock);
+
+  return ret;
+}
+
+static void
+gst_base_parse_discard_parallel_frames (GstBaseParse * parse)
+{
+  GstBaseParsePrivate *priv = parse->priv;
+  GstBaseParseJob *job;
+
+  g_mutex_lock (&priv->parallel_lock);
+  while ((job = g_queue_peek_head (&priv->parallel_frames))) {
+    if (!job->done) {
+      g_cond_wait (&priv->parallel_cond, &priv->parallel_lock);
+      continue;
+    }
+    g_queue_pop_head (&priv->parallel_frames);
+    gst_base_parse_job_free (job);
+  }
+  g_mutex_unlock (&priv->parallel_lock);
+
+  priv->process_discont = FALSE;
+}
+
+/* gst_base_parse_process_and_push_frame:
+ * @parse: #GstBaseParse.
+ * @frame: (transfer none): a #GstBaseParseFrame
+ *
+ * Runs the process_frame vfunc of the subclass, if any, and pushes the
+ * frame. With more than one parallel frame allowed, the frame is processed in
+ * the task pool and pushed once it and all frames before it are done.
+ * Takes ownership of the frame's buffers like gst_base_parse_push_frame().
+ *
+ * Returns: #GstFlowReturn of the frames pushed
+ */
+static GstFlowReturn
+gst_base_parse_process_and_push_frame (GstBaseParse * parse,
+    GstBaseParseFrame * frame)
+{
+  GstBaseParseClass *klass = GST_BASE_PARSE_GET_CLASS (parse);
+  GstBaseParsePrivate *priv = parse->priv;
+  GstBaseParseJob *job;
+  GError *err = NULL;
+  GstFlowReturn ret;
+
+  if (!klass->process_frame)
+    return gst_base_parse_push_frame (parse, frame);
+
+  /* order is only kept in forward push mode */
+  if (priv->max_parallel_frames <= 1 || parse->segment.rate <= 0.0
+      || priv->pad_mode != GST_PAD_MODE_PUSH) {
+    ret = gst_base_parse_push_parallel_frames (parse, 0);
+    if (ret != GST_FLOW_OK) {
+      gst_buffer_replace (&frame->out_buffer, NULL);
+      gst_buffer_replace (&frame->buffer, NULL);
+      return ret;
+    }
+    ret = klass->process_frame (parse, frame);
+    return gst_base_parse_push_processed_frame (parse, frame, ret);
+  }
+
+  if (G_UNLIKELY (priv->task_pool == NULL)) {
+    priv->task_pool = gst_task_pool_new ();
+    gst_task_pool_prepare (priv->task_pool, &err);
+    if (err) {
+      GST_WARNING_OBJECT (parse, "failed to prepare task pool: %s",
+          err->message);
+      g_clear_error (&err);
+    }
+  }
+
+  /* the job owns the buffers now so that process_frame can write to them */
+  job = g_slice_new0 (GstBaseParseJob);
+  job->parse = parse;
+  job->frame = gst_base_parse_frame_copy (frame);
+  frame->out_buffer = NULL;
+  gst_buffer_replace (&frame->buffer, NULL);
+
+  g_queue_push_tail (&priv->parallel_frames, job);
+
+  gst_task_pool_push (priv->task_pool,
+      (GstTaskPoolFunction) gst_base_parse_process_job, job, &err);
+  if (err) {
+    GST_DEBUG_OBJECT (parse, "processing frame in streaming thread: %s",
+        err->message);
+    g_clear_error (&err);
+    gst_base_parse_process_job (job);
+  }
+
+  return gst_base_parse_push_parallel_frames (parse,
+      priv->max_parallel_frames - 1);
+}
+
 /* gst_base_parse_handle_and_push_frame:
  * @parse: #GstBaseParse.
  * @klass: #GstBaseParseClass.
@@ -2284,6 +2579,11 @@ gst_base_parse_handle_and_push_frame (GstBaseParse * parse,
     } else {
       /* disable further checks */
       parse->priv->first_frame_offset = 0;
+
+      if (parse->priv->sample_windows > 0 &&
+          parse->priv->pad_mode == GST_PAD_MODE_PULL &&
+          parse->priv->upstream_seekable && parse->priv->duration == -1)
+        gst_base_parse_sample_bitrate (parse);
     }
   }
 
@@ -2331,12 +2631,12 @@ gst_base_parse_handle_and_push_frame (GstBaseParse * parse,
     GstBaseParseFrame *queued_frame;
 
     while ((queued_frame = g_queue_pop_head (&parse->priv->queued_frames))) {
-      gst_base_parse_push_frame (parse, queued_frame);
+      gst_base_parse_process_and_push_frame (parse, queued_frame);
       gst_base_parse_frame_free (queued_frame);
     }
   }
 
-  return gst_base_parse_push_frame (parse, frame);
+  return gst_base_parse_process_and_push_frame (parse, frame);
 }
 
 /**
@@ -2633,6 +2933,7 @@ gst_base_parse_finish_frame (GstBaseParse * parse, GstBaseParseFrame * frame,
   if (parse->priv->scanning && frame->buffer) {
     if (!parse->priv->scanned_frame) {
       parse->priv->scanned_frame = gst_base_parse_frame_copy (frame);
+      parse->priv->scanned_frame->size = size;
     }
     goto exit;
   }
@@ -2718,6 +3019,8 @@ gst_base_parse_drain (GstBaseParse * parse)
     }
   }
 
+  gst_base_parse_push_parallel_frames (parse, 0);
+
   parse->priv->drain = FALSE;
 }
 
@@ -3987,6 +4290,59 @@ gst_base_parse_set_latency (GstBaseParse * parse, GstClockTime min_latency,
       GST_TIME_ARGS (max_latency));
 }
 
+/**
+ * gst_base_parse_set_bitrate_sampling:
+ * @parse: a #GstBaseParse
+ * @n_windows: number of places in the stream to sample, or 0
+ *
+ * Without timing info from the subclass or upstream, the duration of the
+ * stream is estimated from the bitrate of the frames pushed so far, which is
+ * far off for variable bitrate streams until much of the stream was played.
+ * With @n_windows > 0 the parser parses a few frames at each of @n_windows
+ * places spread over the stream when it starts in pull mode and estimates
+ * the duration from their bitrate right away. The estimate is then refined
+ * with the frames that are pushed. This only reads a small part of the
+ * stream.
+ *
+ * The default is 0, which disables the sampling.
+ *
+ * Since: 1.14
+ */
+void
+gst_base_parse_set_bitrate_sampling (GstBaseParse * parse, guint n_windows)
+{
+  g_return_if_fail (GST_IS_BASE_PARSE (parse));
+
+  parse->priv->sample_windows = n_windows;
+  GST_INFO_OBJECT (parse, "bitrate sampling windows: %u", n_windows);
+}
+
+/**
+ * gst_base_parse_set_max_parallel_frames:
+ * @parse: a #GstBaseParse
+ * @max_frames: maximum number of frames processed at the same time
+ *
+ * Allows up to @max_frames frames to be passed to the @process_frame
+ * vfunc of the subclass at the same time, from the threads of a task pool.
+ * The frames are still pushed downstream in their original order. With 0 or
+ * 1, each frame is processed in the streaming thread right before it is
+ * pushed, which is the default.
+ *
+ * Frames are always processed one at a time in pull mode and during reverse
+ * playback. This has no effect if the subclass doesn't implement
+ * @process_frame.
+ *
+ * Since: 1.14
+ */
+void
+gst_base_parse_set_max_parallel_frames (GstBaseParse * parse, guint max_frames)
+{
+  g_return_if_fail (GST_IS_BASE_PARSE (parse));
+
+  parse->priv->max_parallel_frames = max_frames;
+  GST_INFO_OBJECT (parse, "max parallel frames: %u", max_frames);
+}
+
 static gboolean
 gst_base_parse_get_duration (GstBaseParse * parse, GstFormat format,
     GstClockTime * duration)
@@ -4189,10 +4545,11 @@ gst_base_parse_src_query_default (GstBaseParse * parse, GstQuery * query)
 }
 
 /* scans for a cluster start from @pos,
- * return GST_FLOW_OK and frame position/time in @pos/@time if found */
+ * return GST_FLOW_OK and frame position/time/size in @pos/@time/@size
+ * if found */
 static GstFlowReturn
 gst_base_parse_find_frame (GstBaseParse * parse, gint64 * pos,
-    GstClockTime * time, GstClockTime * duration)
+    GstClockTime * time, GstClockTime * duration, guint * size)
 {
   GstBaseParseClass *klass;
   gint64 orig_offset;
@@ -4209,6 +4566,8 @@ gst_base_parse_find_frame (GstBaseParse * parse, gint64 * pos,
 
   *time = GST_CLOCK_TIME_NONE;
   *duration = GST_CLOCK_TIME_NONE;
+  if (size)
+    *size = 0;
 
   /* save state */
   orig_offset = parse->priv->offset;
@@ -4239,6 +4598,8 @@ gst_base_parse_find_frame (GstBaseParse * parse, gint64 * pos,
   /* but it should provide proper time */
   *time = GST_BUFFER_TIMESTAMP (buf);
   *duration = GST_BUFFER_DURATION (buf);
+  if (size)
+    *size = sframe->size;
 
   GST_LOG_OBJECT (parse,
       "frame with time %" GST_TIME_FORMAT " at offset %" G_GINT64_FORMAT,
@@ -4360,7 +4721,7 @@ gst_base_parse_locate_time (GstBaseParse * parse, GstClockTime * _time,
         "estimated _offset for %" GST_TIME_FORMAT ": %" G_GINT64_FORMAT,
         GST_TIME_ARGS (time), newpos);
 
-    ret = gst_base_parse_find_frame (parse, &newpos, &newtime, &dur);
+    ret = gst_base_parse_find_frame (parse, &newpos, &newtime, &dur, NULL);
     if (ret == GST_FLOW_EOS) {
       /* heuristic HACK */
       hpos = MAX (lpos, hpos - chunk);
@@ -4407,12 +4768,92 @@ exit:
   return ret;
 }
 
+/* parses SAMPLE_FRAMES frames at each of the sample windows spread over the
+ * stream to estimate the bitrate, instead of having to wait for enough frames
+ * from all over the stream. The sampled frames count in the conversions from
+ * then on, together with the frames that are pushed.
+ *
+ * Only used in pull mode */
+static void
+gst_base_parse_sample_bitrate (GstBaseParse * parse)
+{
+  guint n_windows = parse->priv->sample_windows;
+  guint64 total_bytes = 0;
+  GstClockTime total_duration = 0;
+  gdouble rate, sum = 0.0, sum_sq = 0.0, mean, error;
+  guint i, j, n = 0;
+
+  GST_DEBUG_OBJECT (parse, "sampling bitrate in %u windows", n_windows);
+
+  for (i = 0; i < n_windows; i++) {
+    gint64 pos;
+    guint64 bytes = 0;
+    GstClockTime duration = 0;
+
+    /* the middle of each of n_windows equal parts */
+    pos = gst_util_uint64_scale (parse->priv->upstream_size, 2 * i + 1,
+        2 * n_windows);
+
+    for (j = 0; j < SAMPLE_FRAMES; j++) {
+      GstClockTime time, dur;
+      guint size;
+
+      if (gst_base_parse_find_frame (parse, &pos, &time, &dur,
+              &size) != GST_FLOW_OK || !GST_CLOCK_TIME_IS_VALID (dur)
+          || size == 0)
+        break;
+
+      bytes += size;
+      duration += dur;
+      pos += size;
+    }
+
+    GST_LOG_OBJECT (parse, "window %u: %" G_GUINT64_FORMAT " bytes in %"
+        GST_TIME_FORMAT, i, bytes, GST_TIME_ARGS (duration));
+    if (duration == 0)
+      continue;
+
+    rate = (gdouble) bytes * GST_SECOND / duration;
+    sum += rate;
+    sum_sq += rate * rate;
+    total_bytes += bytes;
+    total_duration += duration;
+    n++;
+  }
+
+  if (n == 0) {
+    GST_DEBUG_OBJECT (parse, "no frames found for bitrate sampling");
+    return;
+  }
+
+  /* 95% confidence interval of the mean byte rate of the windows */
+  mean = sum / n;
+  if (n > 1)
+    error = 1.96 * sqrt (MAX (sum_sq - sum * mean, 0.0) / (n - 1) / n);
+  else
+    error = mean;
+
+  GST_DEBUG_OBJECT (parse, "sampled %u windows: %.0f +- %.0f bytes/s, "
+      "duration %" GST_TIME_FORMAT " - %" GST_TIME_FORMAT, n, mean, error,
+      GST_TIME_ARGS ((GstClockTime) (parse->priv->upstream_size * GST_SECOND /
+              (mean + error))), GST_TIME_ARGS (mean > error ?
+          (GstClockTime) (parse->priv->upstream_size * GST_SECOND / (mean -
+                  error)) : GST_CLOCK_TIME_NONE));
+
+  parse->priv->sampled_bytes = total_bytes;
+  parse->priv->sampled_duration = total_duration;
+
+  gst_base_parse_update_duration (parse);
+}
+
 static gint64
 gst_base_parse_find_offset (GstBaseParse * parse, GstClockTime time,
     gboolean before, GstClockTime * _ts)
 {
   gint64 bytes = 0, ts = 0;
-  GstIndexEntry *entry = NULL;
+  GstClockTime entry_ts;
+  guint64 entry_offset;
+  gboolean found;
 
   if (time == GST_CLOCK_TIME_NONE) {
     ts = time;
@@ -4421,17 +4862,13 @@ gst_base_parse_find_offset (GstBaseParse * parse, GstClockTime time,
   }
 
   GST_BASE_PARSE_INDEX_LOCK (parse);
-  if (parse->priv->index) {
-    /* Let's check if we have an index entry for that time */
-    entry = gst_index_get_assoc_entry (parse->priv->index,
-        parse->priv->index_id,
-        before ? GST_INDEX_LOOKUP_BEFORE : GST_INDEX_LOOKUP_AFTER,
-        GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT, GST_FORMAT_TIME, time);
-  }
+  /* Let's check if we have an index entry for that time */
+  found = gst_seek_index_lookup (parse->priv->index, time, before,
+      &entry_ts, &entry_offset);
 
-  if (entry) {
-    gst_index_entry_assoc_map (entry, GST_FORMAT_BYTES, &bytes);
-    gst_index_entry_assoc_map (entry, GST_FORMAT_TIME, &ts);
+  if (found) {
+    bytes = entry_offset;
+    ts = entry_ts;
 
     GST_DEBUG_OBJECT (parse, "found index entry for %" GST_TIME_FORMAT
         " at %" GST_TIME_FORMAT ", offset %" G_GINT64_FORMAT,
@@ -4765,41 +5202,6 @@ gst_base_parse_set_upstream_tags (GstBaseParse * parse, GstTagList * taglist)
   gst_base_parse_check_bitrate_tags (parse);
 }
 
-#if 0
-static void
-gst_base_parse_set_index (GstElement * element, GstIndex * index)
-{
-  GstBaseParse *parse = GST_BASE_PARSE (element);
-
-  GST_BASE_PARSE_INDEX_LOCK (parse);
-  if (parse->priv->index)
-    gst_object_unref (parse->priv->index);
-  if (index) {
-    parse->priv->index = gst_object_ref (index);
-    gst_index_get_writer_id (index, GST_OBJECT_CAST (element),
-        &parse->priv->index_id);
-    parse->priv->own_index = FALSE;
-  } else {
-    parse->priv->index = NULL;
-  }
-  GST_BASE_PARSE_INDEX_UNLOCK (parse);
-}
-
-static GstIndex *
-gst_base_parse_get_index (GstElement * element)
-{
-  GstBaseParse *parse = GST_BASE_PARSE (element);
-  GstIndex *result = NULL;
-
-  GST_BASE_PARSE_INDEX_LOCK (parse);
-  if (parse->priv->index)
-    result = gst_object_ref (parse->priv->index);
-  GST_BASE_PARSE_INDEX_UNLOCK (parse);
-
-  return result;
-}
-#endif
-
 static GstStateChangeReturn
 gst_base_parse_change_state (GstElement * element, GstStateChange transition)
 {
@@ -4810,24 +5212,10 @@ gst_base_parse_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_READY_TO_PAUSED:
-      /* If this is our own index destroy it as the
-       * old entries might be wrong for the new stream */
+      /* the old entries might be wrong for the new stream */
       GST_BASE_PARSE_INDEX_LOCK (parse);
-      if (parse->priv->own_index) {
-        gst_object_unref (parse->priv->index);
-        parse->priv->index = NULL;
-        parse->priv->own_index = FALSE;
-      }
-
-      /* If no index was created, generate one */
-      if (G_UNLIKELY (!parse->priv->index)) {
-        GST_DEBUG_OBJECT (parse, "no index provided creating our own");
-
-        parse->priv->index = g_object_new (gst_mem_index_get_type (), NULL);
-        gst_index_get_writer_id (parse->priv->index, GST_OBJECT (parse),
-            &parse->priv->index_id);
-        parse->priv->own_index = TRUE;
-      }
+      gst_seek_index_clear (parse->priv->index);
+      parse->priv->index_loaded = FALSE;
       GST_BASE_PARSE_INDEX_UNLOCK (parse);
       break;
     default:
@@ -4838,6 +5226,7 @@ gst_base_parse_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_base_parse_save_index (parse);
       gst_base_parse_reset (parse);
       break;
     default:
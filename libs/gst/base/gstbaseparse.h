@@ -223,6 +223,16 @@ struct _GstBaseParse {
  * @src_query:      Optional.
  *                   Query handler on the source pad. Should chain up to the
  *                   parent to let the default handler run (Since 1.2)
+ * @process_frame:  Optional.
+ *                   Called for each frame before @pre_push_frame to do
+ *                   work on the frame that doesn't depend on the state of
+ *                   the parser, like checksumming or rewriting headers. The
+ *                   frame's buffers are writable. After
+ *                   gst_base_parse_set_max_parallel_frames() this is called
+ *                   for several frames at the same time from other threads,
+ *                   so it must not access the parser. Can return
+ *                   GST_BASE_PARSE_FLOW_DROPPED to drop the frame
+ *                   (Since 1.14)
  *
  * Subclasses can override any of the available virtual methods or not, as
  * needed. At minimum @handle_frame needs to be overridden.
@@ -271,8 +281,11 @@ struct _GstBaseParseClass {
   gboolean      (*src_query)          (GstBaseParse * parse,
                                        GstQuery     * query);
 
+  GstFlowReturn (*process_frame)      (GstBaseParse      * parse,
+                                       GstBaseParseFrame * frame);
+
   /*< private >*/
-  gpointer       _gst_reserved[GST_PADDING_LARGE - 2];
+  gpointer       _gst_reserved[GST_PADDING_LARGE - 3];
 };
 
 GST_EXPORT
@@ -340,6 +353,12 @@ void            gst_base_parse_set_latency     (GstBaseParse * parse,
                                                 GstClockTime min_latency,
                                                 GstClockTime max_latency);
 GST_EXPORT
+void            gst_base_parse_set_bitrate_sampling (GstBaseParse * parse,
+                                                     guint          n_windows);
+GST_EXPORT
+void            gst_base_parse_set_max_parallel_frames (GstBaseParse * parse,
+                                                        guint          max_frames);
+GST_EXPORT
 gboolean        gst_base_parse_convert_default (GstBaseParse * parse,
                                                 GstFormat      src_format,
                                                 gint64         src_value,
@@ -178,6 +178,7 @@ typedef struct
 struct _GstBaseSinkPrivate
 {
   gint qos_enabled;             /* ATOMIC */
+  gint predictive_qos;          /* ATOMIC */
   gboolean async_enabled;
   GstClockTimeDiff ts_offset;
   GstClockTime render_delay;
@@ -223,11 +224,17 @@ struct _GstBaseSinkPrivate
   /* when we are prerolled and able to report latency */
   gboolean have_latency;
 
-  /* the last buffer we prerolled or rendered. Useful for making snapshots */
+  /* the last buffer we prerolled or rendered. Useful for making snapshots.
+   * The buffer and list are replaced without a lock, the old ones are
+   * unreffed when there are no last_readers anymore, see
+   * gst_base_sink_replace_last(). last_caps and last_retired, the old
+   * objects that still had readers, are protected by the LOCK */
   gint enable_last_sample;      /* atomic */
-  GstBuffer *last_buffer;
+  GstBuffer *last_buffer;       /* atomic */
   GstCaps *last_caps;
-  GstBufferList *last_buffer_list;
+  GstBufferList *last_buffer_list;      /* atomic */
+  gint last_readers;            /* atomic */
+  GSList *last_retired;
 
   /* negotiated caps */
   GstCaps *caps;
@@ -261,6 +268,12 @@ struct _GstBaseSinkPrivate
   gsize rc_accumulated;
 
   gboolean drop_out_of_segment;
+
+  /* objects due less than sync_window after the start of the last clock wait
+   * are rendered without waiting */
+  GstClockTime sync_window;
+  GstClockTime window_start;
+  GstClockTimeDiff window_jitter;
 };
 
 #define DO_RUNNING_AVG(avg,val,size) (((val) + ((size)-1) * (avg)) / (size))
@@ -290,6 +303,8 @@ struct _GstBaseSinkPrivate
 #define DEFAULT_THROTTLE_TIME       0
 #define DEFAULT_MAX_BITRATE         0
 #define DEFAULT_DROP_OUT_OF_SEGMENT TRUE
+#define DEFAULT_SYNC_WINDOW         0
+#define DEFAULT_PREDICTIVE_QOS      FALSE
 
 enum
 {
@@ -305,6 +320,8 @@ enum
   PROP_RENDER_DELAY,
   PROP_THROTTLE_TIME,
   PROP_MAX_BITRATE,
+  PROP_SYNC_WINDOW,
+  PROP_PREDICTIVE_QOS,
   PROP_LAST
 };
 
@@ -527,6 +544,37 @@ gst_base_sink_class_init (GstBaseSinkClass * klass)
           "The maximum bits per second to render (0 = disabled)", 0,
           G_MAXUINT64, DEFAULT_MAX_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:sync-window:
+   *
+   * Buffers that are due less than this time after the buffer the sink last
+   * waited for on the clock are rendered right away, without waiting for the
+   * clock again. This saves a clock wait for most buffers of sinks that
+   * receive many small buffers, at the cost of rendering some buffers up to
+   * this time early.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SYNC_WINDOW,
+      g_param_spec_uint64 ("sync-window", "Sync Window",
+          "Render buffers due within this time after the last clock wait "
+          "without waiting in nanoseconds (0 = disabled)", 0, G_MAXUINT64,
+          DEFAULT_SYNC_WINDOW, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:predictive-qos:
+   *
+   * When upstream takes longer to produce a buffer than the buffer lasts,
+   * include the average upstream processing time in the Quality-of-Service
+   * events. Upstream then skips the buffers that would be too late by the
+   * time they reach the sink, instead of only the buffers that are
+   * already late. Only has an effect when #GstBaseSink:qos is enabled.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_PREDICTIVE_QOS,
+      g_param_spec_boolean ("predictive-qos", "Predictive QoS",
+          "Make upstream skip the buffers that will be late when they arrive",
+          DEFAULT_PREDICTIVE_QOS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_base_sink_change_state);
@@ -650,6 +698,7 @@ gst_base_sink_init (GstBaseSink * basesink, gpointer g_class)
   basesink->sync = DEFAULT_SYNC;
   basesink->max_lateness = DEFAULT_MAX_LATENESS;
   g_atomic_int_set (&priv->qos_enabled, DEFAULT_QOS);
+  g_atomic_int_set (&priv->predictive_qos, DEFAULT_PREDICTIVE_QOS);
   priv->async_enabled = DEFAULT_ASYNC;
   priv->ts_offset = DEFAULT_TS_OFFSET;
   priv->render_delay = DEFAULT_RENDER_DELAY;
@@ -658,6 +707,8 @@ gst_base_sink_init (GstBaseSink * basesink, gpointer g_class)
   g_atomic_int_set (&priv->enable_last_sample, DEFAULT_ENABLE_LAST_SAMPLE);
   priv->throttle_time = DEFAULT_THROTTLE_TIME;
   priv->max_bitrate = DEFAULT_MAX_BITRATE;
+  priv->sync_window = DEFAULT_SYNC_WINDOW;
+  priv->window_start = GST_CLOCK_TIME_NONE;
 
   priv->drop_out_of_segment = DEFAULT_DROP_OUT_OF_SEGMENT;
 
@@ -673,6 +724,8 @@ gst_base_sink_finalize (GObject * object)
 
   g_mutex_clear (&basesink->preroll_lock);
   g_cond_clear (&basesink->preroll_cond);
+  g_slist_free_full (basesink->priv->last_retired,
+      (GDestroyNotify) gst_mini_object_unref);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -856,6 +909,44 @@ gst_base_sink_is_qos_enabled (GstBaseSink * sink)
   return res;
 }
 
+/**
+ * gst_base_sink_set_predictive_qos:
+ * @sink: the sink
+ * @enabled: the new predictive qos value.
+ *
+ * Configures @sink to make upstream skip the buffers that will be late by
+ * the time they reach @sink. See #GstBaseSink:predictive-qos.
+ *
+ * Since: 1.14
+ */
+void
+gst_base_sink_set_predictive_qos (GstBaseSink * sink, gboolean enabled)
+{
+  g_return_if_fail (GST_IS_BASE_SINK (sink));
+
+  g_atomic_int_set (&sink->priv->predictive_qos, enabled);
+}
+
+/**
+ * gst_base_sink_get_predictive_qos:
+ * @sink: the sink
+ *
+ * Checks if @sink is configured to make upstream skip the buffers that will
+ * be late by the time they reach @sink.
+ *
+ * Returns: %TRUE if the sink is configured to perform predictive
+ * Quality-of-Service.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_base_sink_get_predictive_qos (GstBaseSink * sink)
+{
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), FALSE);
+
+  return g_atomic_int_get (&sink->priv->predictive_qos);
+}
+
 /**
  * gst_base_sink_set_async_enabled:
  * @sink: the sink
@@ -942,6 +1033,83 @@ gst_base_sink_get_ts_offset (GstBaseSink * sink)
   return res;
 }
 
+/* get a ref to the object in @slot without a lock, see
+ * gst_base_sink_replace_last() */
+static GstMiniObject *
+gst_base_sink_acquire_last (GstBaseSink * sink, gpointer * slot)
+{
+  GstMiniObject *obj;
+
+  g_atomic_int_inc (&sink->priv->last_readers);
+  obj = g_atomic_pointer_get (slot);
+  if (obj)
+    gst_mini_object_ref (obj);
+  g_atomic_int_add (&sink->priv->last_readers, -1);
+
+  return obj;
+}
+
+/* put @obj in @slot and return the old object, which must be given to
+ * gst_base_sink_release_last() */
+static GstMiniObject *
+gst_base_sink_swap_last (gpointer * slot, GstMiniObject * obj)
+{
+  GstMiniObject *old;
+
+  if (obj)
+    gst_mini_object_ref (obj);
+
+  do {
+    old = g_atomic_pointer_get (slot);
+  } while (!g_atomic_pointer_compare_and_exchange (slot, old, obj));
+
+  return old;
+}
+
+/* Unref @old, which was just swapped out of its slot. A reader might have
+ * loaded it right before the swap and not have reffed it yet, so when there
+ * are readers it is kept in last_retired. The retired objects are unreffed
+ * by a later call that sees no readers: those readers are then done and
+ * new readers only load the new objects. */
+static void
+gst_base_sink_release_last (GstBaseSink * sink, GstMiniObject * old)
+{
+  GstBaseSinkPrivate *priv = sink->priv;
+  GSList *retired = NULL;
+
+  if (G_UNLIKELY (g_atomic_int_get (&priv->last_readers) > 0)) {
+    if (old) {
+      GST_OBJECT_LOCK (sink);
+      priv->last_retired = g_slist_prepend (priv->last_retired, old);
+      GST_OBJECT_UNLOCK (sink);
+    }
+    return;
+  }
+
+  if (G_UNLIKELY (g_atomic_pointer_get (&priv->last_retired) != NULL)) {
+    GST_OBJECT_LOCK (sink);
+    if (g_atomic_int_get (&priv->last_readers) == 0) {
+      retired = priv->last_retired;
+      priv->last_retired = NULL;
+    }
+    GST_OBJECT_UNLOCK (sink);
+  }
+
+  /* without the lock, cleanup code might want to take it */
+  if (old)
+    gst_mini_object_unref (old);
+  g_slist_free_full (retired, (GDestroyNotify) gst_mini_object_unref);
+}
+
+/* Replace the object in @slot with @obj without a lock. When nobody is
+ * reading the cost is a pointer swap. */
+static void
+gst_base_sink_replace_last (GstBaseSink * sink, gpointer * slot,
+    GstMiniObject * obj)
+{
+  gst_base_sink_release_last (sink, gst_base_sink_swap_last (slot, obj));
+}
+
 /**
  * gst_base_sink_get_last_sample:
  * @sink: the sink
@@ -961,81 +1129,81 @@ GstSample *
 gst_base_sink_get_last_sample (GstBaseSink * sink)
 {
   GstSample *res = NULL;
+  GstBufferList *buffer_list;
+  GstBuffer *buffer = NULL;
 
   g_return_val_if_fail (GST_IS_BASE_SINK (sink), NULL);
 
   GST_OBJECT_LOCK (sink);
-  if (sink->priv->last_buffer_list) {
+  buffer_list = (GstBufferList *) gst_base_sink_acquire_last (sink,
+      (gpointer *) & sink->priv->last_buffer_list);
+  if (buffer_list) {
     GstBuffer *first_buffer = NULL;
 
     /* Set the first buffer in the list to last sample's buffer */
-    first_buffer = gst_buffer_list_get (sink->priv->last_buffer_list, 0);
+    first_buffer = gst_buffer_list_get (buffer_list, 0);
     res =
         gst_sample_new (first_buffer, sink->priv->last_caps, &sink->segment,
         NULL);
-    gst_sample_set_buffer_list (res, sink->priv->last_buffer_list);
-  } else if (sink->priv->last_buffer) {
-    res = gst_sample_new (sink->priv->last_buffer,
-        sink->priv->last_caps, &sink->segment, NULL);
+    gst_sample_set_buffer_list (res, buffer_list);
+  } else {
+    buffer = (GstBuffer *) gst_base_sink_acquire_last (sink,
+        (gpointer *) & sink->priv->last_buffer);
+    if (buffer)
+      res = gst_sample_new (buffer, sink->priv->last_caps, &sink->segment,
+          NULL);
   }
   GST_OBJECT_UNLOCK (sink);
 
+  /* avoid unreffing with the lock because cleanup code might want to take the
+   * lock too */
+  if (buffer_list)
+    gst_buffer_list_unref (buffer_list);
+  if (buffer)
+    gst_buffer_unref (buffer);
+
   return res;
 }
 
-/* with OBJECT_LOCK */
 static void
-gst_base_sink_set_last_buffer_unlocked (GstBaseSink * sink, GstBuffer * buffer)
+gst_base_sink_update_last_buffer (GstBaseSink * sink, GstBuffer * buffer)
 {
-  GstBuffer *old;
-
-  old = sink->priv->last_buffer;
-  if (G_LIKELY (old != buffer)) {
-    GST_DEBUG_OBJECT (sink, "setting last buffer to %p", buffer);
-    if (G_LIKELY (buffer))
-      gst_buffer_ref (buffer);
-    sink->priv->last_buffer = buffer;
-    if (buffer)
-      /* copy over the caps */
-      gst_caps_replace (&sink->priv->last_caps, sink->priv->caps);
-    else
-      gst_caps_replace (&sink->priv->last_caps, NULL);
-  } else {
-    old = NULL;
-  }
-  /* avoid unreffing with the lock because cleanup code might want to take the
-   * lock too */
-  if (G_LIKELY (old)) {
-    GST_OBJECT_UNLOCK (sink);
-    gst_buffer_unref (old);
+  GstBaseSinkPrivate *priv = sink->priv;
+  GstMiniObject *old;
+
+  if (g_atomic_pointer_get (&priv->last_buffer) == buffer)
+    return;
+
+  GST_DEBUG_OBJECT (sink, "setting last buffer to %p", buffer);
+
+  /* the caps rarely change, only take the lock when they are different.
+   * The buffer is then swapped with the lock too so that
+   * gst_base_sink_get_last_sample() never pairs it with the old caps */
+  if (G_UNLIKELY (priv->last_caps != (buffer ? priv->caps : NULL))) {
     GST_OBJECT_LOCK (sink);
+    gst_caps_replace (&priv->last_caps, buffer ? priv->caps : NULL);
+    old = gst_base_sink_swap_last ((gpointer *) & priv->last_buffer,
+        GST_MINI_OBJECT_CAST (buffer));
+    GST_OBJECT_UNLOCK (sink);
+  } else {
+    old = gst_base_sink_swap_last ((gpointer *) & priv->last_buffer,
+        GST_MINI_OBJECT_CAST (buffer));
   }
+
+  gst_base_sink_release_last (sink, old);
 }
 
-/* with OBJECT_LOCK */
 static void
-gst_base_sink_set_last_buffer_list_unlocked (GstBaseSink * sink,
+gst_base_sink_update_last_buffer_list (GstBaseSink * sink,
     GstBufferList * buffer_list)
 {
-  GstBufferList *old;
-
-  old = sink->priv->last_buffer_list;
-  if (G_LIKELY (old != buffer_list)) {
-    GST_DEBUG_OBJECT (sink, "setting last buffer list to %p", buffer_list);
-    if (G_LIKELY (buffer_list))
-      gst_mini_object_ref (GST_MINI_OBJECT_CAST (buffer_list));
-    sink->priv->last_buffer_list = buffer_list;
-  } else {
-    old = NULL;
-  }
+  if (g_atomic_pointer_get (&sink->priv->last_buffer_list) == buffer_list)
+    return;
 
-  /* avoid unreffing with the lock because cleanup code might want to take the
-   * lock too */
-  if (G_LIKELY (old)) {
-    GST_OBJECT_UNLOCK (sink);
-    gst_mini_object_unref (GST_MINI_OBJECT_CAST (old));
-    GST_OBJECT_LOCK (sink);
-  }
+  GST_DEBUG_OBJECT (sink, "setting last buffer list to %p", buffer_list);
+
+  gst_base_sink_replace_last (sink, (gpointer *) & sink->priv->last_buffer_list,
+      GST_MINI_OBJECT_CAST (buffer_list));
 }
 
 static void
@@ -1044,9 +1212,7 @@ gst_base_sink_set_last_buffer (GstBaseSink * sink, GstBuffer * buffer)
   if (!g_atomic_int_get (&sink->priv->enable_last_sample))
     return;
 
-  GST_OBJECT_LOCK (sink);
-  gst_base_sink_set_last_buffer_unlocked (sink, buffer);
-  GST_OBJECT_UNLOCK (sink);
+  gst_base_sink_update_last_buffer (sink, buffer);
 }
 
 static void
@@ -1056,9 +1222,7 @@ gst_base_sink_set_last_buffer_list (GstBaseSink * sink,
   if (!g_atomic_int_get (&sink->priv->enable_last_sample))
     return;
 
-  GST_OBJECT_LOCK (sink);
-  gst_base_sink_set_last_buffer_list_unlocked (sink, buffer_list);
-  GST_OBJECT_UNLOCK (sink);
+  gst_base_sink_update_last_buffer_list (sink, buffer_list);
 }
 
 /**
@@ -1074,13 +1238,11 @@ gst_base_sink_set_last_sample_enabled (GstBaseSink * sink, gboolean enabled)
 {
   g_return_if_fail (GST_IS_BASE_SINK (sink));
 
-  /* Only take lock if we change the value */
+  /* Only clear the last buffer if we change the value */
   if (g_atomic_int_compare_and_exchange (&sink->priv->enable_last_sample,
           !enabled, enabled) && !enabled) {
-    GST_OBJECT_LOCK (sink);
-    gst_base_sink_set_last_buffer_unlocked (sink, NULL);
-    gst_base_sink_set_last_buffer_list_unlocked (sink, NULL);
-    GST_OBJECT_UNLOCK (sink);
+    gst_base_sink_update_last_buffer (sink, NULL);
+    gst_base_sink_update_last_buffer_list (sink, NULL);
   }
 }
 
@@ -1411,6 +1573,53 @@ gst_base_sink_get_max_bitrate (GstBaseSink * sink)
   return res;
 }
 
+/**
+ * gst_base_sink_set_sync_window:
+ * @sink: a #GstBaseSink
+ * @window: the sync window
+ *
+ * Set the time after a clock wait in which @sink renders buffers without
+ * waiting for the clock again. See #GstBaseSink:sync-window.
+ *
+ * Since: 1.14
+ */
+void
+gst_base_sink_set_sync_window (GstBaseSink * sink, GstClockTime window)
+{
+  g_return_if_fail (GST_IS_BASE_SINK (sink));
+
+  GST_OBJECT_LOCK (sink);
+  sink->priv->sync_window = window;
+  GST_LOG_OBJECT (sink, "set sync window to %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (window));
+  GST_OBJECT_UNLOCK (sink);
+}
+
+/**
+ * gst_base_sink_get_sync_window:
+ * @sink: a #GstBaseSink
+ *
+ * Get the time after a clock wait in which @sink renders buffers without
+ * waiting for the clock again. See #GstBaseSink:sync-window.
+ *
+ * Returns: the sync window of @sink.
+ *
+ * Since: 1.14
+ */
+GstClockTime
+gst_base_sink_get_sync_window (GstBaseSink * sink)
+{
+  GstClockTime res;
+
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), 0);
+
+  GST_OBJECT_LOCK (sink);
+  res = sink->priv->sync_window;
+  GST_OBJECT_UNLOCK (sink);
+
+  return res;
+}
+
 static void
 gst_base_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -1427,6 +1636,9 @@ gst_base_sink_set_property (GObject * object, guint prop_id,
     case PROP_QOS:
       gst_base_sink_set_qos_enabled (sink, g_value_get_boolean (value));
       break;
+    case PROP_PREDICTIVE_QOS:
+      gst_base_sink_set_predictive_qos (sink, g_value_get_boolean (value));
+      break;
     case PROP_ASYNC:
       gst_base_sink_set_async_enabled (sink, g_value_get_boolean (value));
       break;
@@ -1448,6 +1660,9 @@ gst_base_sink_set_property (GObject * object, guint prop_id,
     case PROP_MAX_BITRATE:
       gst_base_sink_set_max_bitrate (sink, g_value_get_uint64 (value));
       break;
+    case PROP_SYNC_WINDOW:
+      gst_base_sink_set_sync_window (sink, g_value_get_uint64 (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1470,6 +1685,9 @@ gst_base_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_QOS:
       g_value_set_boolean (value, gst_base_sink_is_qos_enabled (sink));
       break;
+    case PROP_PREDICTIVE_QOS:
+      g_value_set_boolean (value, gst_base_sink_get_predictive_qos (sink));
+      break;
     case PROP_ASYNC:
       g_value_set_boolean (value, gst_base_sink_is_async_enabled (sink));
       break;
@@ -1494,6 +1712,9 @@ gst_base_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_MAX_BITRATE:
       g_value_set_uint64 (value, gst_base_sink_get_max_bitrate (sink));
       break;
+    case PROP_SYNC_WINDOW:
+      g_value_set_uint64 (value, gst_base_sink_get_sync_window (sink));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1570,6 +1791,7 @@ gst_base_sink_commit_state (GstBaseSink * basesink)
   GST_STATE_NEXT (basesink) = GST_STATE_VOID_PENDING;
   GST_STATE_PENDING (basesink) = GST_STATE_VOID_PENDING;
   GST_STATE_RETURN (basesink) = GST_STATE_CHANGE_SUCCESS;
+  gst_element_publish_state (GST_ELEMENT_CAST (basesink));
   GST_OBJECT_UNLOCK (basesink);
 
   if (post_paused) {
@@ -2180,21 +2402,7 @@ gst_base_sink_wait_clock (GstBaseSink * sink, GstClockTime time,
   time += base_time;
 
   /* Re-use existing clockid if available */
-  /* FIXME: Casting to GstClockEntry only works because the types
-   * are the same */
-  if (G_LIKELY (sink->priv->cached_clock_id != NULL
-          && GST_CLOCK_ENTRY_CLOCK ((GstClockEntry *) sink->
-              priv->cached_clock_id) == clock)) {
-    if (!gst_clock_single_shot_id_reinit (clock, sink->priv->cached_clock_id,
-            time)) {
-      gst_clock_id_unref (sink->priv->cached_clock_id);
-      sink->priv->cached_clock_id = gst_clock_new_single_shot_id (clock, time);
-    }
-  } else {
-    if (sink->priv->cached_clock_id != NULL)
-      gst_clock_id_unref (sink->priv->cached_clock_id);
-    sink->priv->cached_clock_id = gst_clock_new_single_shot_id (clock, time);
-  }
+  gst_clock_single_shot_id_rearm (clock, &sink->priv->cached_clock_id, time);
   GST_OBJECT_UNLOCK (sink);
 
   /* A blocking wait is performed on the clock. We save the ClockID
@@ -2602,6 +2810,21 @@ again:
       GST_TIME_FORMAT ", adjusted %" GST_TIME_FORMAT,
       GST_TIME_ARGS (rstart), GST_TIME_ARGS (stime));
 
+  /* buffers due shortly after the start of the last clock wait don't wait
+   * again, the clock was at least at the start of the window */
+  if (G_UNLIKELY (priv->sync_window > 0) && !GST_IS_EVENT (obj)
+      && GST_CLOCK_TIME_IS_VALID (stime)
+      && GST_CLOCK_TIME_IS_VALID (priv->window_start)
+      && stime >= priv->window_start
+      && stime - priv->window_start < priv->sync_window) {
+    jitter = GST_CLOCK_DIFF (stime, priv->window_start) +
+        MAX (priv->window_jitter, 0);
+    status = jitter > 0 ? GST_CLOCK_EARLY : GST_CLOCK_OK;
+    GST_LOG_OBJECT (basesink, "in sync window of %" GST_TIME_FORMAT
+        ", not waiting", GST_TIME_ARGS (priv->window_start));
+    goto synced;
+  }
+
   /* This function will return immediately if start == -1, no clock
    * or sync is disabled with GST_CLOCK_BADTIME. */
   status = gst_base_sink_wait_clock (basesink, stime, &jitter);
@@ -2625,6 +2848,11 @@ again:
     goto again;
   }
 
+  /* the next buffers in the window don't need to wait */
+  priv->window_start = stime;
+  priv->window_jitter = jitter;
+
+synced:
   /* successful syncing done, record observation */
   priv->current_jitter = jitter;
 
@@ -2802,6 +3030,20 @@ gst_base_sink_perform_qos (GstBaseSink * sink, gboolean dropped)
       type = GST_QOS_TYPE_THROTTLE;
     } else {
       diff = priv->current_jitter;
+
+      /* when upstream is slower than realtime, the next buffers arrive one
+       * processing time after this one left. Announce the running time
+       * they need to have to still be rendered, so that upstream skips the
+       * buffers before it without processing them. */
+      if (g_atomic_int_get (&priv->predictive_qos) && priv->avg_rate > 1.0
+          && GST_CLOCK_TIME_IS_VALID (priv->avg_pt)) {
+        diff = MAX (diff, 0) + priv->avg_pt;
+        if (sink->max_lateness > 0)
+          diff -= MIN (sink->max_lateness, diff);
+        GST_CAT_DEBUG_OBJECT (GST_CAT_QOS, sink, "predicted diff %"
+            G_GINT64_FORMAT, diff);
+      }
+
       if (diff <= 0)
         type = GST_QOS_TYPE_OVERFLOW;
       else
@@ -2833,7 +3075,7 @@ gst_base_sink_reset_qos (GstBaseSink * sink)
   priv->avg_in_diff = GST_CLOCK_TIME_NONE;
   priv->rendered = 0;
   priv->dropped = 0;
-
+  priv->window_start = GST_CLOCK_TIME_NONE;
 }
 
 /* Checks if the object was scheduled too late.
@@ -4934,21 +5176,29 @@ default_element_query (GstElement * element, GstQuery * query)
 static void
 gst_base_sink_drain (GstBaseSink * basesink)
 {
-  GstBuffer *old;
-  GstBufferList *old_list;
-
-  GST_OBJECT_LOCK (basesink);
-  if ((old = basesink->priv->last_buffer))
-    basesink->priv->last_buffer = gst_buffer_copy_deep (old);
-
-  if ((old_list = basesink->priv->last_buffer_list))
-    basesink->priv->last_buffer_list = gst_buffer_list_copy_deep (old_list);
-  GST_OBJECT_UNLOCK (basesink);
-
-  if (old)
-    gst_buffer_unref (old);
-  if (old_list)
-    gst_mini_object_unref (GST_MINI_OBJECT_CAST (old_list));
+  GstBaseSinkPrivate *priv = basesink->priv;
+  GstMiniObject *old, *copy;
+
+  /* this runs on the streaming thread, the only one setting a new last
+   * buffer, so the copies can't replace a newer buffer */
+  if ((old = gst_base_sink_acquire_last (basesink,
+              (gpointer *) & priv->last_buffer))) {
+    copy = GST_MINI_OBJECT_CAST (gst_buffer_copy_deep (GST_BUFFER_CAST (old)));
+    gst_base_sink_replace_last (basesink, (gpointer *) & priv->last_buffer,
+        copy);
+    gst_mini_object_unref (copy);
+    gst_mini_object_unref (old);
+  }
+
+  if ((old = gst_base_sink_acquire_last (basesink,
+              (gpointer *) & priv->last_buffer_list))) {
+    copy = GST_MINI_OBJECT_CAST (gst_buffer_list_copy_deep
+        (GST_BUFFER_LIST_CAST (old)));
+    gst_base_sink_replace_last (basesink,
+        (gpointer *) & priv->last_buffer_list, copy);
+    gst_mini_object_unref (copy);
+    gst_mini_object_unref (old);
+  }
 }
 
 static gboolean
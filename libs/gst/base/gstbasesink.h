@@ -309,6 +309,22 @@ void            gst_base_sink_set_max_bitrate   (GstBaseSink *sink, guint64 max_
 GST_EXPORT
 guint64         gst_base_sink_get_max_bitrate   (GstBaseSink *sink);
 
+/* predictive-qos */
+
+GST_EXPORT
+void            gst_base_sink_set_predictive_qos (GstBaseSink *sink, gboolean enabled);
+
+GST_EXPORT
+gboolean        gst_base_sink_get_predictive_qos (GstBaseSink *sink);
+
+/* sync-window */
+
+GST_EXPORT
+void            gst_base_sink_set_sync_window   (GstBaseSink *sink, GstClockTime window);
+
+GST_EXPORT
+GstClockTime    gst_base_sink_get_sync_window   (GstBaseSink *sink);
+
 GST_EXPORT
 GstClockReturn  gst_base_sink_wait_clock        (GstBaseSink *sink, GstClockTime time,
                                                  GstClockTimeDiff * jitter);
@@ -147,6 +147,9 @@
 
 #include <stdlib.h>
 #include <string.h>
+#ifdef HAVE_CLOCK_GETTIME
+#include <time.h>
+#endif
 
 #include <gst/gst_private.h>
 #include <gst/glib-compat-private.h>
@@ -261,8 +264,32 @@ struct _GstBaseSrcPrivate
   GstAllocationParams params;   /* OBJECT_LOCK */
 
   GCond async_cond;             /* OBJECT_LOCK */
+
+  /* blocks read ahead for small pull mode reads, most recently used first */
+  guint cache_block_size;       /* LIVE_LOCK */
+  guint cache_n_blocks;         /* LIVE_LOCK */
+  GQueue cache;                 /* LIVE_LOCK */
+
+  /* reused for every clock wait */
+  GstClockID cached_clock_id;   /* LIVE_LOCK */
+
+  /* submitted by the create function, pushed instead of its buffer */
+  GstBufferList *pending_list;  /* LIVE_LOCK */
+
+  /* the element clock when it is the plain monotonic system clock, its time
+   * can then be read without going through the clock. The clock is checked
+   * again when its clock-type changes */
+  GstClock *fast_clock;         /* STREAM_LOCK */
+  gulong fast_clock_notify;     /* STREAM_LOCK */
+  gint fast_clock_dirty;        /* atomic */
 };
 
+typedef struct
+{
+  guint64 offset;
+  GstBuffer *buffer;
+} GstBaseSrcCacheBlock;
+
 static GstElementClass *parent_class = NULL;
 
 static void gst_base_src_class_init (GstBaseSrcClass * klass);
@@ -333,6 +360,9 @@ static gboolean gst_base_src_decide_allocation_default (GstBaseSrc * basesrc,
 
 static gboolean gst_base_src_set_flushing (GstBaseSrc * basesrc,
     gboolean flushing);
+static void gst_base_src_clear_cache (GstBaseSrc * src);
+static void gst_base_src_set_fast_clock (GstBaseSrc * basesrc,
+    GstClock * clock);
 
 static gboolean gst_base_src_start (GstBaseSrc * basesrc);
 static gboolean gst_base_src_stop (GstBaseSrc * basesrc);
@@ -486,6 +516,12 @@ gst_base_src_finalize (GObject * object)
     g_list_free (basesrc->priv->pending_events);
   }
 
+  gst_base_src_clear_cache (basesrc);
+
+  if (basesrc->priv->cached_clock_id)
+    gst_clock_id_unref (basesrc->priv->cached_clock_id);
+  gst_base_src_set_fast_clock (basesrc, NULL);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -651,6 +687,77 @@ gst_base_src_set_automatic_eos (GstBaseSrc * src, gboolean automatic_eos)
   g_atomic_int_set (&src->priv->automatic_eos, automatic_eos);
 }
 
+/**
+ * gst_base_src_set_read_cache:
+ * @src: base source instance
+ * @block_size: size of the cached blocks in bytes, or 0
+ * @n_blocks: number of blocks to keep
+ *
+ * Configure @src to serve pull mode reads that are smaller than @block_size
+ * from a cache of up to @n_blocks blocks. On a cache miss the block aligned
+ * range around the requested data is read with a single call to the create
+ * function, so that many small reads near each other, as done by demuxers
+ * parsing an index, only reach the subclass once.
+ *
+ * The cache is dropped when @src is flushed or stopped and is never used in
+ * push mode, for live sources or when the caller provides the buffer to fill.
+ * Setting @block_size or @n_blocks to 0, the default, disables the cache.
+ *
+ * Since: 1.14
+ */
+void
+gst_base_src_set_read_cache (GstBaseSrc * src, guint block_size,
+    guint n_blocks)
+{
+  g_return_if_fail (GST_IS_BASE_SRC (src));
+
+  GST_LIVE_LOCK (src);
+  gst_base_src_clear_cache (src);
+  src->priv->cache_block_size = n_blocks > 0 ? block_size : 0;
+  src->priv->cache_n_blocks = n_blocks;
+  GST_LIVE_UNLOCK (src);
+}
+
+/**
+ * gst_base_src_submit_buffer_list:
+ * @src: base source instance
+ * @buffer_list: (transfer full): a #GstBufferList
+ *
+ * Subclasses can call this from their #GstBaseSrcClass.create() function to
+ * push all the buffers of @buffer_list downstream in one go, which has much
+ * less overhead than producing them one by one. The create function must then
+ * return %GST_FLOW_OK without a buffer.
+ *
+ * The first buffer of @buffer_list is used to synchronise against the clock
+ * and the position is updated from the last one. Buffer lists can only be
+ * submitted once per create() call and when @src operates in push mode.
+ *
+ * Since: 1.14
+ */
+void
+gst_base_src_submit_buffer_list (GstBaseSrc * src, GstBufferList * buffer_list)
+{
+  g_return_if_fail (GST_IS_BASE_SRC (src));
+  g_return_if_fail (GST_IS_BUFFER_LIST (buffer_list));
+  g_return_if_fail (src->priv->pending_list == NULL);
+
+  /* the first buffer may be modified when syncing and marking discont */
+  src->priv->pending_list = gst_buffer_list_make_writable (buffer_list);
+}
+
+/* free what the create function returned when it is not pushed */
+static void
+gst_base_src_drop_created (GstBaseSrc * src, GstBuffer * buf)
+{
+  if (src->priv->pending_list) {
+    /* buf is borrowed from the list */
+    gst_buffer_list_unref (src->priv->pending_list);
+    src->priv->pending_list = NULL;
+  } else if (buf) {
+    gst_buffer_unref (buf);
+  }
+}
+
 /**
  * gst_base_src_set_async:
  * @src: base source instance
@@ -2160,7 +2267,8 @@ gst_base_src_wait (GstBaseSrc * basesrc, GstClock * clock, GstClockTime time)
   GstClockReturn ret;
   GstClockID id;
 
-  id = gst_clock_new_single_shot_id (clock, time);
+  id = gst_clock_single_shot_id_rearm (clock, &basesrc->priv->cached_clock_id,
+      time);
 
   basesrc->clock_id = id;
   /* release the live lock while waiting */
@@ -2169,12 +2277,108 @@ gst_base_src_wait (GstBaseSrc * basesrc, GstClock * clock, GstClockTime time)
   ret = gst_clock_id_wait (id, NULL);
 
   GST_LIVE_LOCK (basesrc);
-  gst_clock_id_unref (id);
   basesrc->clock_id = NULL;
 
   return ret;
 }
 
+/* the same order as gst_system_clock_get_internal_time(), which uses other
+ * time sources on macOS and Windows */
+#if !defined (__APPLE__) && !defined (G_OS_WIN32) && \
+    defined (HAVE_POSIX_TIMERS) && defined (HAVE_MONOTONIC_CLOCK) && \
+    defined (HAVE_CLOCK_GETTIME)
+#define HAVE_FAST_CLOCK 1
+#endif
+
+/* TRUE when @clock doesn't change its internal time, checked for every
+ * buffer. A master changes the time only through the calibration */
+static gboolean
+gst_base_src_is_uncalibrated (GstClock * clock)
+{
+  GstClockTime internal, external, num, denom;
+
+  gst_clock_get_calibration (clock, &internal, &external, &num, &denom);
+  return internal == external && num == denom;
+}
+
+/* check if the time of @clock is the time of the monotonic clock, which is
+ * true for the default system clock as long as it is not slaved or
+ * calibrated */
+static gboolean
+gst_base_src_is_fast_clock (GstClock * clock)
+{
+#ifdef HAVE_FAST_CLOCK
+  GstClockType clock_type;
+  GstClock *master;
+
+  if (G_OBJECT_TYPE (clock) != GST_TYPE_SYSTEM_CLOCK)
+    return FALSE;
+
+  g_object_get (clock, "clock-type", &clock_type, NULL);
+  if (clock_type != GST_CLOCK_TYPE_MONOTONIC)
+    return FALSE;
+
+  if ((master = gst_clock_get_master (clock))) {
+    gst_object_unref (master);
+    return FALSE;
+  }
+
+  return gst_base_src_is_uncalibrated (clock);
+#else
+  return FALSE;
+#endif
+}
+
+static void
+gst_base_src_fast_clock_type_changed (GstClock * clock, GParamSpec * pspec,
+    GstBaseSrc * basesrc)
+{
+  g_atomic_int_set (&basesrc->priv->fast_clock_dirty, 1);
+}
+
+/* with STREAM_LOCK */
+static void
+gst_base_src_set_fast_clock (GstBaseSrc * basesrc, GstClock * clock)
+{
+  GstBaseSrcPrivate *priv = basesrc->priv;
+
+  if (priv->fast_clock) {
+    g_signal_handler_disconnect (priv->fast_clock, priv->fast_clock_notify);
+    gst_object_unref (priv->fast_clock);
+    priv->fast_clock = NULL;
+    priv->fast_clock_notify = 0;
+  }
+  g_atomic_int_set (&priv->fast_clock_dirty, 0);
+
+  if (clock == NULL || G_OBJECT_TYPE (clock) != GST_TYPE_SYSTEM_CLOCK)
+    return;
+
+  /* connect first so that a change during the check is not missed */
+  priv->fast_clock_notify = g_signal_connect (clock, "notify::clock-type",
+      G_CALLBACK (gst_base_src_fast_clock_type_changed), basesrc);
+  if (!gst_base_src_is_fast_clock (clock)) {
+    g_signal_handler_disconnect (clock, priv->fast_clock_notify);
+    priv->fast_clock_notify = 0;
+    return;
+  }
+  priv->fast_clock = gst_object_ref (clock);
+}
+
+static GstClockTime
+gst_base_src_get_fast_time (void)
+{
+#ifdef HAVE_FAST_CLOCK
+  struct timespec ts;
+
+  if (G_UNLIKELY (clock_gettime (CLOCK_MONOTONIC, &ts)))
+    return GST_CLOCK_TIME_NONE;
+
+  return GST_TIMESPEC_TO_TIME (ts);
+#else
+  return GST_CLOCK_TIME_NONE;
+#endif
+}
+
 /* perform synchronisation on a buffer.
  * with STREAM_LOCK.
  */
@@ -2242,6 +2446,28 @@ gst_base_src_do_sync (GstBaseSrc * basesrc, GstBuffer * buffer)
     basesrc->priv->latency = 0;
   }
 
+  /* without syncing we only need the time of the plain system clock, which
+   * can be read directly instead of through the clock that other elements
+   * use too */
+  if (!first && start == -1 && basesrc->priv->fast_clock != NULL
+      && basesrc->priv->fast_clock == GST_ELEMENT_CLOCK (basesrc)
+      && !g_atomic_int_get (&basesrc->priv->fast_clock_dirty)
+      && gst_base_src_is_uncalibrated (basesrc->priv->fast_clock)) {
+    base_time = GST_ELEMENT_CAST (basesrc)->base_time;
+    do_timestamp = basesrc->priv->do_timestamp;
+    GST_OBJECT_UNLOCK (basesrc);
+
+    clock = NULL;
+    if (do_timestamp && !GST_CLOCK_TIME_IS_VALID (dts)) {
+      dts = gst_base_src_get_fast_time () - base_time;
+      GST_BUFFER_DTS (buffer) = dts;
+
+      GST_LOG_OBJECT (basesrc, "created DTS %" GST_TIME_FORMAT
+          " from the monotonic clock", GST_TIME_ARGS (dts));
+    }
+    goto timestamped;
+  }
+
   /* get clock, if no clock, we can't sync or do timestamps */
   if ((clock = GST_ELEMENT_CLOCK (basesrc)) == NULL)
     goto no_clock;
@@ -2253,10 +2479,16 @@ gst_base_src_do_sync (GstBaseSrc * basesrc, GstBuffer * buffer)
   do_timestamp = basesrc->priv->do_timestamp;
   GST_OBJECT_UNLOCK (basesrc);
 
+  /* the clock-type of the fast clock changed, check it again */
+  if (!first && g_atomic_int_get (&basesrc->priv->fast_clock_dirty))
+    gst_base_src_set_fast_clock (basesrc, clock);
+
   /* first buffer, calculate the timestamp offset */
   if (first) {
     GstClockTime running_time;
 
+    gst_base_src_set_fast_clock (basesrc, clock);
+
     now = gst_clock_get_time (clock);
     running_time = now - base_time;
 
@@ -2306,6 +2538,7 @@ gst_base_src_do_sync (GstBaseSrc * basesrc, GstBuffer * buffer)
           GST_TIME_ARGS (dts));
     }
   }
+timestamped:
   if (!GST_CLOCK_TIME_IS_VALID (pts)) {
     if (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT))
       pts = dts;
@@ -2352,11 +2585,64 @@ no_clock:
 no_sync:
   {
     GST_DEBUG_OBJECT (basesrc, "no sync needed");
-    gst_object_unref (clock);
+    if (clock)
+      gst_object_unref (clock);
     return GST_CLOCK_OK;
   }
 }
 
+/* only the first buffer of a submitted list was synced, give the others
+ * the same treatment without waiting for the clock again */
+static void
+gst_base_src_timestamp_list (GstBaseSrc * basesrc, GstBufferList * list)
+{
+  GstBaseSrcClass *bclass;
+  GstClockTime first_dts;
+  GstClockTimeDiff ts_offset;
+  gboolean do_timestamp, is_live;
+  guint i, len;
+
+  bclass = GST_BASE_SRC_GET_CLASS (basesrc);
+
+  GST_OBJECT_LOCK (basesrc);
+  is_live = basesrc->is_live;
+  do_timestamp = basesrc->priv->do_timestamp;
+  ts_offset = basesrc->priv->ts_offset;
+  GST_OBJECT_UNLOCK (basesrc);
+
+  first_dts = GST_BUFFER_DTS (gst_buffer_list_get (list, 0));
+  len = gst_buffer_list_length (list);
+
+  for (i = 1; i < len; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+    GstClockTime start = -1, end = -1;
+
+    if (!GST_BUFFER_DTS_IS_VALID (buffer)
+        && !GST_BUFFER_PTS_IS_VALID (buffer)) {
+      /* the buffers of a burst were all captured by now */
+      if (do_timestamp && GST_CLOCK_TIME_IS_VALID (first_dts)) {
+        buffer = gst_buffer_list_get_writable (list, i);
+        GST_BUFFER_DTS (buffer) = GST_BUFFER_PTS (buffer) = first_dts;
+      }
+      continue;
+    }
+
+    if (!is_live || ts_offset == 0 || bclass->get_times == NULL)
+      continue;
+
+    /* pseudo live sources add the startup latency to all timestamps */
+    bclass->get_times (basesrc, buffer, &start, &end);
+    if (!GST_CLOCK_TIME_IS_VALID (start))
+      continue;
+
+    buffer = gst_buffer_list_get_writable (list, i);
+    if (GST_BUFFER_PTS_IS_VALID (buffer))
+      GST_BUFFER_PTS (buffer) += ts_offset;
+    if (GST_BUFFER_DTS_IS_VALID (buffer))
+      GST_BUFFER_DTS (buffer) += ts_offset;
+  }
+}
+
 /* Called with STREAM_LOCK and LIVE_LOCK */
 static gboolean
 gst_base_src_update_length (GstBaseSrc * src, guint64 offset, guint * length,
@@ -2511,7 +2797,7 @@ again:
       wait_ret = gst_base_src_wait_playing_unlocked (src);
       if (wait_ret != GST_FLOW_OK) {
         if (ret == GST_FLOW_OK && *buf == NULL)
-          gst_buffer_unref (res_buf);
+          gst_base_src_drop_created (src, res_buf);
         ret = wait_ret;
         goto stopped;
       }
@@ -2524,7 +2810,7 @@ again:
   if (G_UNLIKELY (g_atomic_int_get (&src->priv->has_pending_eos))) {
     if (ret == GST_FLOW_OK) {
       if (*buf == NULL)
-        gst_buffer_unref (res_buf);
+        gst_base_src_drop_created (src, res_buf);
     }
     src->priv->forced_eos = TRUE;
     goto eos;
@@ -2533,6 +2819,17 @@ again:
   if (G_UNLIKELY (ret != GST_FLOW_OK))
     goto not_ok;
 
+  if (G_UNLIKELY (src->priv->pending_list)) {
+    /* only the streaming thread in push mode can push the list */
+    if (res_buf != NULL || in_buf != NULL
+        || GST_PAD_MODE (src->srcpad) != GST_PAD_MODE_PUSH
+        || gst_buffer_list_length (src->priv->pending_list) == 0)
+      goto invalid_list;
+
+    /* the list keeps the ownership of its first buffer */
+    res_buf = gst_buffer_list_get_writable (src->priv->pending_list, 0);
+  }
+
   /* fallback in case the create function didn't fill a provided buffer */
   if (in_buf != NULL && res_buf != in_buf) {
     GstMapInfo info;
@@ -2573,17 +2870,21 @@ again:
     case GST_CLOCK_EARLY:
       /* the buffer is too late. We currently don't drop the buffer. */
       GST_DEBUG_OBJECT (src, "buffer too late!, returning anyway");
+      if (src->priv->pending_list)
+        gst_base_src_timestamp_list (src, src->priv->pending_list);
       break;
     case GST_CLOCK_OK:
       /* buffer synchronised properly */
       GST_DEBUG_OBJECT (src, "buffer ok");
+      if (src->priv->pending_list)
+        gst_base_src_timestamp_list (src, src->priv->pending_list);
       break;
     case GST_CLOCK_UNSCHEDULED:
       /* this case is triggered when we were waiting for the clock and
        * it got unlocked because we did a state change. In any case, get rid of
        * the buffer. */
       if (*buf == NULL)
-        gst_buffer_unref (res_buf);
+        gst_base_src_drop_created (src, res_buf);
 
       if (!src->live_running) {
         /* We return FLUSHING when we are not running to stop the dataflow also
@@ -2605,7 +2906,7 @@ again:
           (_("Internal clock error.")),
           ("clock returned unexpected return value %d", status));
       if (*buf == NULL)
-        gst_buffer_unref (res_buf);
+        gst_base_src_drop_created (src, res_buf);
       ret = GST_FLOW_ERROR;
       break;
   }
@@ -2625,8 +2926,20 @@ not_ok:
   {
     GST_DEBUG_OBJECT (src, "create returned %d (%s)", ret,
         gst_flow_get_name (ret));
+    gst_base_src_drop_created (src, NULL);
     return ret;
   }
+invalid_list:
+  {
+    GST_ELEMENT_ERROR (src, CORE, NOT_IMPLEMENTED, (NULL),
+        ("buffer list submitted while not streaming in push mode or "
+            "together with a buffer"));
+    gst_buffer_list_unref (src->priv->pending_list);
+    src->priv->pending_list = NULL;
+    if (res_buf != NULL && res_buf != in_buf)
+      gst_buffer_unref (res_buf);
+    return GST_FLOW_ERROR;
+  }
 map_failed:
   {
     GST_ELEMENT_ERROR (src, RESOURCE, BUSY,
@@ -2661,7 +2974,7 @@ flushing:
   {
     GST_DEBUG_OBJECT (src, "we are flushing");
     if (*buf == NULL)
-      gst_buffer_unref (res_buf);
+      gst_base_src_drop_created (src, res_buf);
     return GST_FLOW_FLUSHING;
   }
 eos:
@@ -2671,6 +2984,87 @@ eos:
   }
 }
 
+/* must be called with LIVE_LOCK */
+static void
+gst_base_src_clear_cache (GstBaseSrc * src)
+{
+  GstBaseSrcCacheBlock *block;
+
+  while ((block = g_queue_pop_head (&src->priv->cache))) {
+    gst_buffer_unref (block->buffer);
+    g_slice_free (GstBaseSrcCacheBlock, block);
+  }
+}
+
+/* must be called with LIVE_LOCK */
+static GstFlowReturn
+gst_base_src_get_range_cached (GstBaseSrc * src, guint64 offset, guint length,
+    GstBuffer ** buf)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+  GstBaseSrcCacheBlock *block = NULL;
+  GstFlowReturn ret;
+  GstBuffer *res_buf = NULL;
+  guint64 start, end;
+  GList *l;
+
+  for (l = priv->cache.head; l; l = l->next) {
+    GstBaseSrcCacheBlock *b = l->data;
+
+    if (b->offset <= offset &&
+        offset + length <= b->offset + gst_buffer_get_size (b->buffer)) {
+      block = b;
+      g_queue_unlink (&priv->cache, l);
+      g_list_free_1 (l);
+      break;
+    }
+  }
+
+  if (block == NULL) {
+    /* read the block aligned range around the requested data */
+    start = offset - offset % priv->cache_block_size;
+    end = offset + length + priv->cache_block_size - 1;
+    end -= end % priv->cache_block_size;
+    if (end - start > G_MAXUINT)
+      return gst_base_src_get_range (src, offset, length, buf);
+
+    ret = gst_base_src_get_range (src, start, end - start, &res_buf);
+    if (ret != GST_FLOW_OK)
+      return ret;
+
+    GST_CAT_LOG_OBJECT (GST_CAT_PERFORMANCE, src, "cached %" G_GSIZE_FORMAT
+        " bytes at offset %" G_GUINT64_FORMAT, gst_buffer_get_size (res_buf),
+        start);
+
+    block = g_slice_new (GstBaseSrcCacheBlock);
+    block->offset = start;
+    block->buffer = res_buf;
+
+    if (g_queue_get_length (&priv->cache) >= priv->cache_n_blocks) {
+      GstBaseSrcCacheBlock *last = g_queue_pop_tail (&priv->cache);
+
+      gst_buffer_unref (last->buffer);
+      g_slice_free (GstBaseSrcCacheBlock, last);
+    }
+  }
+  g_queue_push_head (&priv->cache, block);
+
+  /* the block was cut short, let the subclass handle the end of the data */
+  if (offset + length > block->offset + gst_buffer_get_size (block->buffer))
+    return gst_base_src_get_range (src, offset, length, buf);
+
+  res_buf = gst_buffer_copy_region (block->buffer, GST_BUFFER_COPY_MEMORY,
+      offset - block->offset, length);
+  GST_BUFFER_OFFSET (res_buf) = offset;
+  GST_BUFFER_OFFSET_END (res_buf) = offset + length;
+  if (offset == 0 && src->segment.time == 0)
+    GST_BUFFER_DTS (res_buf) = 0;
+
+  *buf = res_buf;
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_base_src_getrange (GstPad * pad, GstObject * parent, guint64 offset,
     guint length, GstBuffer ** buf)
@@ -2684,7 +3078,12 @@ gst_base_src_getrange (GstPad * pad, GstObject * parent, guint64 offset,
   if (G_UNLIKELY (src->priv->flushing))
     goto flushing;
 
-  res = gst_base_src_get_range (src, offset, length, buf);
+  if (src->priv->cache_block_size > 0 && length < src->priv->cache_block_size
+      && *buf == NULL && !src->is_live
+      && src->segment.format == GST_FORMAT_BYTES)
+    res = gst_base_src_get_range_cached (src, offset, length, buf);
+  else
+    res = gst_base_src_get_range (src, offset, length, buf);
 
 done:
   GST_LIVE_UNLOCK (src);
@@ -2728,7 +3127,8 @@ static void
 gst_base_src_loop (GstPad * pad)
 {
   GstBaseSrc *src;
-  GstBuffer *buf = NULL;
+  GstBuffer *buf = NULL, *last;
+  GstBufferList *list;
   GstFlowReturn ret;
   gint64 position;
   gboolean eos;
@@ -2812,6 +3212,14 @@ gst_base_src_loop (GstPad * pad)
   if (G_UNLIKELY (buf == NULL))
     goto null_buffer;
 
+  /* buf is the first buffer of the list if one was submitted */
+  list = src->priv->pending_list;
+  src->priv->pending_list = NULL;
+  if (G_UNLIKELY (list != NULL))
+    last = gst_buffer_list_get (list, gst_buffer_list_length (list) - 1);
+  else
+    last = buf;
+
   /* push events to close/start our segment before we push the buffer. */
   if (G_UNLIKELY (src->priv->segment_pending)) {
     GstEvent *seg_event = gst_event_new_segment (&src->segment);
@@ -2844,7 +3252,8 @@ gst_base_src_loop (GstPad * pad)
   switch (src->segment.format) {
     case GST_FORMAT_BYTES:
     {
-      guint bufsize = gst_buffer_get_size (buf);
+      gsize bufsize = list ? gst_buffer_list_calculate_size (list) :
+          gst_buffer_get_size (buf);
 
       /* we subtracted above for negative rates */
       if (src->segment.rate >= 0.0)
@@ -2855,8 +3264,8 @@ gst_base_src_loop (GstPad * pad)
     {
       GstClockTime start, duration;
 
-      start = GST_BUFFER_TIMESTAMP (buf);
-      duration = GST_BUFFER_DURATION (buf);
+      start = GST_BUFFER_TIMESTAMP (last);
+      duration = GST_BUFFER_DURATION (last);
 
       if (GST_CLOCK_TIME_IS_VALID (start))
         position = start;
@@ -2875,7 +3284,7 @@ gst_base_src_loop (GstPad * pad)
     }
     case GST_FORMAT_DEFAULT:
       if (src->segment.rate >= 0.0)
-        position = GST_BUFFER_OFFSET_END (buf);
+        position = GST_BUFFER_OFFSET_END (last);
       else
         position = GST_BUFFER_OFFSET (buf);
       break;
@@ -2915,7 +3324,10 @@ gst_base_src_loop (GstPad * pad)
   }
   GST_LIVE_UNLOCK (src);
 
-  ret = gst_pad_push (pad, buf);
+  if (G_UNLIKELY (list != NULL))
+    ret = gst_pad_push_list (pad, list);
+  else
+    ret = gst_pad_push (pad, buf);
   if (G_UNLIKELY (ret != GST_FLOW_OK)) {
     if (ret == GST_FLOW_NOT_NEGOTIATED) {
       goto not_negotiated;
@@ -3096,11 +3508,63 @@ gst_base_src_set_pool_flushing (GstBaseSrc * basesrc, gboolean flushing)
 }
 
 
+/* The current pool can be kept when downstream offers no pool or the same
+ * pool again and the pool config only differs in the caps, so that buffers
+ * in flight stay valid across renegotiation. Only plain #GstBufferPool are
+ * kept, their buffers don't depend on the caps. Returns the pool to keep. */
+static GstBufferPool *
+gst_base_src_get_reusable_pool (GstBaseSrc * basesrc, GstBufferPool * pool,
+    guint size, guint min, guint max, GstAllocator * allocator,
+    const GstAllocationParams * params)
+{
+  GstBufferPool *current;
+  GstStructure *config;
+  GstAllocator *cur_allocator = NULL;
+  GstAllocationParams cur_params;
+  guint cur_size, cur_min, cur_max;
+  gboolean reuse;
+
+  GST_OBJECT_LOCK (basesrc);
+  if ((current = basesrc->priv->pool))
+    gst_object_ref (current);
+  GST_OBJECT_UNLOCK (basesrc);
+
+  if (current == NULL)
+    return NULL;
+
+  if ((pool != NULL && pool != current) ||
+      G_OBJECT_TYPE (current) != GST_TYPE_BUFFER_POOL)
+    goto no_reuse;
+
+  gst_allocation_params_init (&cur_params);
+  config = gst_buffer_pool_get_config (current);
+  reuse = gst_buffer_pool_config_get_params (config, NULL, &cur_size,
+      &cur_min, &cur_max) &&
+      gst_buffer_pool_config_get_allocator (config, &cur_allocator,
+      &cur_params) && cur_size == size && cur_min == min && cur_max == max
+      && cur_allocator == allocator && cur_params.flags == params->flags
+      && cur_params.align == params->align
+      && cur_params.prefix == params->prefix
+      && cur_params.padding == params->padding;
+  gst_structure_free (config);
+
+  if (!reuse)
+    goto no_reuse;
+
+  GST_DEBUG_OBJECT (basesrc, "reusing pool %" GST_PTR_FORMAT, current);
+
+  return current;
+
+no_reuse:
+  gst_object_unref (current);
+  return NULL;
+}
+
 static gboolean
 gst_base_src_decide_allocation_default (GstBaseSrc * basesrc, GstQuery * query)
 {
   GstCaps *outcaps;
-  GstBufferPool *pool;
+  GstBufferPool *pool, *reuse_pool = NULL;
   guint size, min, max;
   GstAllocator *allocator;
   GstAllocationParams params;
@@ -3124,7 +3588,13 @@ gst_base_src_decide_allocation_default (GstBaseSrc * basesrc, GstQuery * query)
   if (gst_query_get_n_allocation_pools (query) > 0) {
     gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
 
-    if (pool == NULL) {
+    reuse_pool = gst_base_src_get_reusable_pool (basesrc, pool, size, min,
+        max, allocator, &params);
+    if (reuse_pool) {
+      if (pool)
+        gst_object_unref (pool);
+      pool = reuse_pool;
+    } else if (pool == NULL) {
       /* no pool, we can make our own */
       GST_DEBUG_OBJECT (basesrc, "no pool, making new pool");
       pool = gst_buffer_pool_new ();
@@ -3134,8 +3604,8 @@ gst_base_src_decide_allocation_default (GstBaseSrc * basesrc, GstQuery * query)
     size = min = max = 0;
   }
 
-  /* now configure */
-  if (pool) {
+  /* now configure, a reused pool keeps its config */
+  if (pool && !reuse_pool) {
     config = gst_buffer_pool_get_config (pool);
     gst_buffer_pool_config_set_params (config, outcaps, size, min, max);
     gst_buffer_pool_config_set_allocator (config, allocator, &params);
@@ -3652,6 +4122,8 @@ gst_base_src_set_flushing (GstBaseSrc * basesrc, gboolean flushing)
   GST_LIVE_LOCK (basesrc);
   basesrc->priv->flushing = flushing;
   if (flushing) {
+    gst_base_src_clear_cache (basesrc);
+
     /* clear pending EOS if any */
     if (g_atomic_int_get (&basesrc->priv->has_pending_eos)) {
       GST_OBJECT_LOCK (basesrc);
@@ -3886,6 +4358,13 @@ gst_base_src_change_state (GstElement * element, GstStateChange transition)
         GST_OBJECT_UNLOCK (basesrc);
       }
       gst_event_replace (&basesrc->pending_seek, NULL);
+      GST_LIVE_LOCK (basesrc);
+      if (basesrc->priv->cached_clock_id) {
+        gst_clock_id_unref (basesrc->priv->cached_clock_id);
+        basesrc->priv->cached_clock_id = NULL;
+      }
+      GST_LIVE_UNLOCK (basesrc);
+      gst_base_src_set_fast_clock (basesrc, NULL);
       break;
     }
     case GST_STATE_CHANGE_READY_TO_NULL:
@@ -157,7 +157,9 @@ struct _GstBaseSrc {
  *   buffer should be returned when the return value is different from
  *   GST_FLOW_OK. A return value of GST_FLOW_EOS signifies that the end of
  *   stream is reached. The default implementation will call
- *   #GstBaseSrcClass.alloc() and then call #GstBaseSrcClass.fill().
+ *   #GstBaseSrcClass.alloc() and then call #GstBaseSrcClass.fill(). In push
+ *   mode the subclass can instead submit several buffers at once with
+ *   gst_base_src_submit_buffer_list() and return no buffer.
  * @alloc: Ask the subclass to allocate a buffer with for offset and size. The
  *   default implementation will create a new buffer from the negotiated allocator.
  * @fill: Ask the subclass to fill the buffer with data for offset and size. The
@@ -257,6 +259,14 @@ void            gst_base_src_set_dynamic_size (GstBaseSrc * src, gboolean dynami
 GST_EXPORT
 void            gst_base_src_set_automatic_eos (GstBaseSrc * src, gboolean automatic_eos);
 
+GST_EXPORT
+void            gst_base_src_set_read_cache    (GstBaseSrc * src, guint block_size,
+                                                guint n_blocks);
+
+GST_EXPORT
+void            gst_base_src_submit_buffer_list (GstBaseSrc    * src,
+                                                 GstBufferList * buffer_list);
+
 GST_EXPORT
 void            gst_base_src_set_async        (GstBaseSrc *src, gboolean async);
 
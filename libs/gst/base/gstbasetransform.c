@@ -191,6 +191,7 @@ struct _GstBaseTransformPrivate
 
   gboolean gap_aware;
   gboolean prefer_passthrough;
+  gboolean keep_lists;
 
   /* QoS stats */
   guint64 processed;
@@ -203,8 +204,18 @@ struct _GstBaseTransformPrivate
   GstAllocator *allocator;
   GstAllocationParams params;
   GstQuery *query;
+
+  /* MetaPlanEntry, the copy decision of the default transform_meta for each
+   * meta API seen. It only depends on the API tags. with STREAM_LOCK */
+  GArray *meta_plan;
 };
 
+typedef struct
+{
+  GType api;
+  gboolean copy;
+} MetaPlanEntry;
+
 
 static GstElementClass *parent_class = NULL;
 
@@ -270,6 +281,8 @@ static GstFlowReturn gst_base_transform_getrange (GstPad * pad,
     GstObject * parent, guint64 offset, guint length, GstBuffer ** buffer);
 static GstFlowReturn gst_base_transform_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_base_transform_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static GstCaps *gst_base_transform_default_transform_caps (GstBaseTransform *
     trans, GstPadDirection direction, GstCaps * caps, GstCaps * filter);
 static GstCaps *gst_base_transform_default_fixate_caps (GstBaseTransform *
@@ -306,6 +319,10 @@ gst_base_transform_default_transform_meta (GstBaseTransform * trans,
 static void
 gst_base_transform_finalize (GObject * object)
 {
+  GstBaseTransform *trans = GST_BASE_TRANSFORM (object);
+
+  g_array_free (trans->priv->meta_plan, TRUE);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -381,6 +398,8 @@ gst_base_transform_init (GstBaseTransform * trans,
       GST_DEBUG_FUNCPTR (gst_base_transform_sink_event));
   gst_pad_set_chain_function (trans->sinkpad,
       GST_DEBUG_FUNCPTR (gst_base_transform_chain));
+  gst_pad_set_chain_list_function (trans->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_base_transform_chain_list));
   gst_pad_set_activatemode_function (trans->sinkpad,
       GST_DEBUG_FUNCPTR (gst_base_transform_sink_activate_mode));
   gst_pad_set_query_function (trans->sinkpad,
@@ -407,6 +426,7 @@ gst_base_transform_init (GstBaseTransform * trans,
   priv->pad_mode = GST_PAD_MODE_NONE;
   priv->gap_aware = FALSE;
   priv->prefer_passthrough = TRUE;
+  priv->meta_plan = g_array_new (FALSE, FALSE, sizeof (MetaPlanEntry));
 
   priv->passthrough = FALSE;
   if (bclass->transform == NULL) {
@@ -744,7 +764,9 @@ gst_base_transform_set_allocation (GstBaseTransform * trans,
   GST_OBJECT_LOCK (trans);
   oldpool = priv->pool;
   priv->pool = pool;
-  priv->pool_active = FALSE;
+  /* a reused pool stays active */
+  if (pool != oldpool)
+    priv->pool_active = FALSE;
 
   oldalloc = priv->allocator;
   priv->allocator = allocator;
@@ -759,8 +781,10 @@ gst_base_transform_set_allocation (GstBaseTransform * trans,
   GST_OBJECT_UNLOCK (trans);
 
   if (oldpool) {
-    GST_DEBUG_OBJECT (trans, "deactivating old pool %p", oldpool);
-    gst_buffer_pool_set_active (oldpool, FALSE);
+    if (oldpool != pool) {
+      GST_DEBUG_OBJECT (trans, "deactivating old pool %p", oldpool);
+      gst_buffer_pool_set_active (oldpool, FALSE);
+    }
     gst_object_unref (oldpool);
   }
   if (oldalloc) {
@@ -772,6 +796,58 @@ gst_base_transform_set_allocation (GstBaseTransform * trans,
   return TRUE;
 }
 
+/* The current pool can be kept when downstream offers no pool or the same
+ * pool again and the pool config only differs in the caps, so that buffers
+ * in flight stay valid across renegotiation. Only plain #GstBufferPool are
+ * kept, their buffers don't depend on the caps. Returns the pool to keep. */
+static GstBufferPool *
+gst_base_transform_get_reusable_pool (GstBaseTransform * trans, GstBufferPool * pool,
+    guint size, guint min, guint max, GstAllocator * allocator,
+    const GstAllocationParams * params)
+{
+  GstBufferPool *current;
+  GstStructure *config;
+  GstAllocator *cur_allocator = NULL;
+  GstAllocationParams cur_params;
+  guint cur_size, cur_min, cur_max;
+  gboolean reuse;
+
+  GST_OBJECT_LOCK (trans);
+  if ((current = trans->priv->pool))
+    gst_object_ref (current);
+  GST_OBJECT_UNLOCK (trans);
+
+  if (current == NULL)
+    return NULL;
+
+  if ((pool != NULL && pool != current) ||
+      G_OBJECT_TYPE (current) != GST_TYPE_BUFFER_POOL)
+    goto no_reuse;
+
+  gst_allocation_params_init (&cur_params);
+  config = gst_buffer_pool_get_config (current);
+  reuse = gst_buffer_pool_config_get_params (config, NULL, &cur_size,
+      &cur_min, &cur_max) &&
+      gst_buffer_pool_config_get_allocator (config, &cur_allocator,
+      &cur_params) && cur_size == size && cur_min == min && cur_max == max
+      && cur_allocator == allocator && cur_params.flags == params->flags
+      && cur_params.align == params->align
+      && cur_params.prefix == params->prefix
+      && cur_params.padding == params->padding;
+  gst_structure_free (config);
+
+  if (!reuse)
+    goto no_reuse;
+
+  GST_DEBUG_OBJECT (trans, "reusing pool %" GST_PTR_FORMAT, current);
+
+  return current;
+
+no_reuse:
+  gst_object_unref (current);
+  return NULL;
+}
+
 static gboolean
 gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
     GstQuery * query)
@@ -779,7 +855,7 @@ gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
   guint i, n_metas;
   GstBaseTransformClass *klass;
   GstCaps *outcaps;
-  GstBufferPool *pool;
+  GstBufferPool *pool, *reuse_pool = NULL;
   guint size, min, max;
   GstAllocator *allocator;
   GstAllocationParams params;
@@ -838,7 +914,13 @@ gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
   if (gst_query_get_n_allocation_pools (query) > 0) {
     gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
 
-    if (pool == NULL) {
+    reuse_pool = gst_base_transform_get_reusable_pool (trans, pool, size,
+        min, max, allocator, &params);
+    if (reuse_pool) {
+      if (pool)
+        gst_object_unref (pool);
+      pool = reuse_pool;
+    } else if (pool == NULL) {
       /* no pool, we can make our own */
       GST_DEBUG_OBJECT (trans, "no pool, making new pool");
       pool = gst_buffer_pool_new ();
@@ -848,8 +930,8 @@ gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
     size = min = max = 0;
   }
 
-  /* now configure */
-  if (pool) {
+  /* now configure, a reused pool keeps its config */
+  if (pool && !reuse_pool) {
     config = gst_buffer_pool_get_config (pool);
     gst_buffer_pool_config_set_params (config, outcaps, size, min, max);
     gst_buffer_pool_config_set_allocator (config, allocator, &params);
@@ -1685,6 +1767,33 @@ typedef struct
   GstBuffer *outbuf;
 } CopyMetaData;
 
+/* the decision of the default transform_meta, without looking up the tags of
+ * the API for every buffer */
+static gboolean
+default_meta_copy (GstBaseTransform * trans, GType api)
+{
+  GArray *plan = trans->priv->meta_plan;
+  MetaPlanEntry entry;
+  guint i;
+
+  for (i = 0; i < plan->len; i++) {
+    MetaPlanEntry *e = &g_array_index (plan, MetaPlanEntry, i);
+
+    if (e->api == api)
+      return e->copy;
+  }
+
+  entry.api = api;
+  entry.copy = !gst_meta_api_type_has_tag (api, _gst_meta_tag_memory)
+      && gst_meta_api_type_get_tags (api) == NULL;
+  g_array_append_val (plan, entry);
+
+  GST_DEBUG_OBJECT (trans, "metadata %s: copy: %d", g_type_name (api),
+      entry.copy);
+
+  return entry.copy;
+}
+
 static gboolean
 foreach_metadata (GstBuffer * inbuf, GstMeta ** meta, gpointer user_data)
 {
@@ -1697,7 +1806,9 @@ foreach_metadata (GstBuffer * inbuf, GstMeta ** meta, gpointer user_data)
 
   klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
 
-  if (gst_meta_api_type_has_tag (info->api, _gst_meta_tag_memory)) {
+  if (klass->transform_meta == gst_base_transform_default_transform_meta) {
+    do_copy = default_meta_copy (trans, info->api);
+  } else if (gst_meta_api_type_has_tag (info->api, _gst_meta_tag_memory)) {
     /* never call the transform_meta with memory specific metadata */
     GST_DEBUG_OBJECT (trans, "not copying memory specific metadata %s",
         g_type_name (info->api));
@@ -2233,11 +2344,12 @@ pull_error:
 /* The flow of the chain function is the reverse of the
  * getrange() function - we have data, feed it to the sub-class
  * and then iterate, pushing buffers it generates until it either
- * wants more data or returns an error */
+ * wants more data or returns an error. When @outlist is not %NULL the
+ * generated buffers are added to it instead of pushed. */
 static GstFlowReturn
-gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_base_transform_handle_buffer (GstBaseTransform * trans,
+    GstBuffer * buffer, GstBufferList * outlist)
 {
-  GstBaseTransform *trans = GST_BASE_TRANSFORM (parent);
   GstBaseTransformClass *klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
   GstBaseTransformPrivate *priv = trans->priv;
   GstFlowReturn ret;
@@ -2309,7 +2421,10 @@ gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
         }
         priv->processed++;
 
-        ret = gst_pad_push (trans->srcpad, outbuf);
+        if (outlist)
+          gst_buffer_list_add (outlist, outbuf);
+        else
+          ret = gst_pad_push (trans->srcpad, outbuf);
       } else {
         GST_DEBUG_OBJECT (trans, "we got return %s", gst_flow_get_name (ret));
         gst_buffer_unref (outbuf);
@@ -2328,6 +2443,95 @@ done:
   return ret;
 }
 
+static GstFlowReturn
+gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  return gst_base_transform_handle_buffer (GST_BASE_TRANSFORM (parent), buffer,
+      NULL);
+}
+
+typedef struct
+{
+  GstBaseTransform *trans;
+  GstBufferList *outlist;
+  GstFlowReturn ret;
+} ChainListData;
+
+static gboolean
+chain_list_func (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  ChainListData *data = user_data;
+  GstBaseTransform *trans = data->trans;
+  GstBuffer *inbuf = *buffer;
+
+  /* a renegotiation pushes the new caps right away, the buffers with the
+   * previous caps must go first */
+  if (gst_buffer_list_length (data->outlist) > 0 &&
+      gst_pad_needs_reconfigure (trans->srcpad)) {
+    GST_DEBUG_OBJECT (trans, "pushing list before renegotiation");
+    data->ret = gst_pad_push_list (trans->srcpad, data->outlist);
+    data->outlist = gst_buffer_list_new ();
+    if (data->ret != GST_FLOW_OK)
+      return FALSE;
+  }
+
+  /* take the buffer from the list, so that it stays writable */
+  *buffer = NULL;
+  data->ret = gst_base_transform_handle_buffer (trans, inbuf, data->outlist);
+
+  return data->ret == GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_base_transform_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM (parent);
+  ChainListData data;
+  GstFlowReturn ret;
+  gboolean keep_lists;
+  guint i, len;
+
+  GST_OBJECT_LOCK (trans);
+  keep_lists = trans->priv->keep_lists;
+  GST_OBJECT_UNLOCK (trans);
+
+  if (!keep_lists) {
+    GST_LOG_OBJECT (trans, "chaining each buffer in list individually");
+
+    ret = GST_FLOW_OK;
+    len = gst_buffer_list_length (list);
+    for (i = 0; i < len && ret == GST_FLOW_OK; i++)
+      ret = gst_pad_chain (pad, gst_buffer_ref (gst_buffer_list_get (list, i)));
+    gst_buffer_list_unref (list);
+
+    return ret;
+  }
+
+  list = gst_buffer_list_make_writable (list);
+
+  data.trans = trans;
+  data.outlist = gst_buffer_list_new_sized (gst_buffer_list_length (list));
+  data.ret = GST_FLOW_OK;
+
+  gst_buffer_list_foreach (list, chain_list_func, &data);
+  gst_buffer_list_unref (list);
+
+  /* push what was generated before an error too */
+  ret = data.ret;
+  if (gst_buffer_list_length (data.outlist) > 0) {
+    GstFlowReturn push_ret;
+
+    push_ret = gst_pad_push_list (trans->srcpad, data.outlist);
+    if (ret == GST_FLOW_OK)
+      ret = push_ret;
+  } else {
+    gst_buffer_list_unref (data.outlist);
+  }
+
+  return ret;
+}
+
 static void
 gst_base_transform_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -2742,6 +2946,65 @@ gst_base_transform_set_prefer_passthrough (GstBaseTransform * trans,
   GST_OBJECT_UNLOCK (trans);
 }
 
+/**
+ * gst_base_transform_set_keep_lists:
+ * @trans: a #GstBaseTransform
+ * @keep_lists: New state
+ *
+ * If @keep_lists is %TRUE, @trans transforms the buffers of an incoming
+ * #GstBufferList one by one and pushes the results downstream as a single
+ * #GstBufferList. This keeps the batching of upstream elements intact.
+ *
+ * If set to %FALSE (the default), the buffers of a list are handled and
+ * pushed as separate buffers.
+ *
+ * Only enable this when the transform functions of the element push no
+ * events or buffers on the source pad themselves, those would overtake the
+ * buffers that are collected for the list.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+void
+gst_base_transform_set_keep_lists (GstBaseTransform * trans,
+    gboolean keep_lists)
+{
+  g_return_if_fail (GST_IS_BASE_TRANSFORM (trans));
+
+  GST_OBJECT_LOCK (trans);
+  trans->priv->keep_lists = keep_lists;
+  GST_DEBUG_OBJECT (trans, "keep lists %d", keep_lists);
+  GST_OBJECT_UNLOCK (trans);
+}
+
+/**
+ * gst_base_transform_get_keep_lists:
+ * @trans: a #GstBaseTransform
+ *
+ * Queries if @trans pushes the results of an incoming #GstBufferList as a
+ * single list.
+ *
+ * Returns: %TRUE if buffer lists are kept.
+ *
+ * MT safe.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_base_transform_get_keep_lists (GstBaseTransform * trans)
+{
+  gboolean result;
+
+  g_return_val_if_fail (GST_IS_BASE_TRANSFORM (trans), FALSE);
+
+  GST_OBJECT_LOCK (trans);
+  result = trans->priv->keep_lists;
+  GST_OBJECT_UNLOCK (trans);
+
+  return result;
+}
+
 /**
  * gst_base_transform_reconfigure_sink:
  * @trans: a #GstBaseTransform
@@ -316,6 +316,12 @@ void            gst_base_transform_set_gap_aware    (GstBaseTransform *trans,
 GST_EXPORT
 void            gst_base_transform_set_prefer_passthrough (GstBaseTransform *trans,
                                                            gboolean prefer_passthrough);
+GST_EXPORT
+void            gst_base_transform_set_keep_lists   (GstBaseTransform *trans,
+                                                     gboolean keep_lists);
+GST_EXPORT
+gboolean        gst_base_transform_get_keep_lists   (GstBaseTransform *trans);
+
 GST_EXPORT
 GstBufferPool * gst_base_transform_get_buffer_pool  (GstBaseTransform *trans);
 
@@ -294,3 +294,39 @@ GST_BIT_READER_READ_BITS (8);
 GST_BIT_READER_READ_BITS (16);
 GST_BIT_READER_READ_BITS (32);
 GST_BIT_READER_READ_BITS (64);
+
+/**
+ * gst_bit_reader_get_exp_golomb_uint32:
+ * @reader: a #GstBitReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned Exp-Golomb code, as used by H.264 and H.265 for ue(v)
+ * syntax elements, into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_bit_reader_get_exp_golomb_uint32 (GstBitReader * reader, guint32 * val)
+{
+  return _gst_bit_reader_get_exp_golomb_uint32_inline (reader, val);
+}
+
+/**
+ * gst_bit_reader_get_exp_golomb_int32:
+ * @reader: a #GstBitReader instance
+ * @val: (out): Pointer to a #gint32 to store the result
+ *
+ * Read a signed Exp-Golomb code, as used by H.264 and H.265 for se(v)
+ * syntax elements, into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_bit_reader_get_exp_golomb_int32 (GstBitReader * reader, gint32 * val)
+{
+  return _gst_bit_reader_get_exp_golomb_int32_inline (reader, val);
+}
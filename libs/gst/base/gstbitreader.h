@@ -101,6 +101,12 @@ gboolean        gst_bit_reader_peek_bits_uint32 (const GstBitReader *reader, gui
 GST_EXPORT
 gboolean        gst_bit_reader_peek_bits_uint64 (const GstBitReader *reader, guint64 *val, guint nbits);
 
+GST_EXPORT
+gboolean        gst_bit_reader_get_exp_golomb_uint32 (GstBitReader *reader, guint32 *val);
+
+GST_EXPORT
+gboolean        gst_bit_reader_get_exp_golomb_int32  (GstBitReader *reader, gint32 *val);
+
 /**
  * GST_BIT_READER_INIT:
  * @data: Data from which the #GstBitReader should read
@@ -144,6 +150,11 @@ gst_bit_reader_peek_bits_uint##bits##_unchecked (const GstBitReader *reader, gui
   byte = reader->byte; \
   bit = reader->bit; \
   \
+  /* load 64 bits at once if the data is long enough */ \
+  if (G_LIKELY (nbits > 0 && nbits + bit <= 64 && byte + 8 <= reader->size)) \
+    return (guint##bits) ((GST_READ_UINT64_BE (data + byte) << bit) >> \
+        (64 - nbits)); \
+  \
   while (nbits > 0) { \
     guint toread = MIN (nbits, 8 - bit); \
     \
@@ -287,6 +298,60 @@ __GST_BIT_READER_READ_BITS_INLINE (64)
 
 #undef __GST_BIT_READER_READ_BITS_INLINE
 
+static inline gboolean
+_gst_bit_reader_get_exp_golomb_uint32_inline (GstBitReader * reader,
+    guint32 * val)
+{
+  guint remaining, n, leading_zeros;
+  guint32 bits;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (val != NULL, FALSE);
+
+  remaining = _gst_bit_reader_get_remaining_unchecked (reader);
+  if (remaining == 0)
+    return FALSE;
+
+  /* codes with more than 31 leading zeros don't fit into 32 bits */
+  n = MIN (remaining, 32);
+  bits = gst_bit_reader_peek_bits_uint32_unchecked (reader, n) << (32 - n);
+  if (bits == 0)
+    return FALSE;
+
+  leading_zeros = 31 - g_bit_nth_msf (bits, -1);
+  if (remaining < 2 * leading_zeros + 1)
+    return FALSE;
+
+  gst_bit_reader_skip_unchecked (reader, leading_zeros + 1);
+  if (leading_zeros == 0)
+    *val = 0;
+  else
+    *val = (G_GUINT64_CONSTANT (1) << leading_zeros) - 1 +
+        gst_bit_reader_get_bits_uint32_unchecked (reader, leading_zeros);
+
+  return TRUE;
+}
+
+static inline gboolean
+_gst_bit_reader_get_exp_golomb_int32_inline (GstBitReader * reader,
+    gint32 * val)
+{
+  guint32 code;
+
+  g_return_val_if_fail (val != NULL, FALSE);
+
+  if (!_gst_bit_reader_get_exp_golomb_uint32_inline (reader, &code))
+    return FALSE;
+
+  /* 0, 1, -1, 2, -2, ... */
+  if (code & 1)
+    *val = (gint32) ((code >> 1) + 1);
+  else
+    *val = -(gint32) (code >> 1);
+
+  return TRUE;
+}
+
 #ifndef GST_BIT_READER_DISABLE_INLINES
 
 #define gst_bit_reader_get_size(reader) \
@@ -320,6 +385,11 @@ __GST_BIT_READER_READ_BITS_INLINE (64)
     G_LIKELY (_gst_bit_reader_peek_bits_uint32_inline (reader, val, nbits))
 #define gst_bit_reader_peek_bits_uint64(reader, val, nbits) \
     G_LIKELY (_gst_bit_reader_peek_bits_uint64_inline (reader, val, nbits))
+
+#define gst_bit_reader_get_exp_golomb_uint32(reader, val) \
+    G_LIKELY (_gst_bit_reader_get_exp_golomb_uint32_inline (reader, val))
+#define gst_bit_reader_get_exp_golomb_int32(reader, val) \
+    G_LIKELY (_gst_bit_reader_get_exp_golomb_int32_inline (reader, val))
 #endif
 
 G_END_DECLS
@@ -25,6 +25,8 @@
 
 #define GST_BYTE_READER_DISABLE_INLINES
 #include "gstbytereader.h"
+#include "gstscan-private.h"
+#include "gstbyteswap-private.h"
 
 #include <string.h>
 
@@ -820,29 +822,125 @@ gst_byte_reader_dup_data (GstByteReader * reader, guint size, guint8 ** val)
   return _gst_byte_reader_dup_data_inline (reader, size, val);
 }
 
-/* Special optimized scan for mask 0xffffff00 and pattern 0x00000100 */
-static inline gint
-_scan_for_start_code (const guint8 * data, guint size)
-{
-  guint8 *pdata = (guint8 *) data;
-  guint8 *pend = (guint8 *) (data + size - 4);
-
-  while (pdata <= pend) {
-    if (pdata[2] > 1) {
-      pdata += 3;
-    } else if (pdata[1]) {
-      pdata += 2;
-    } else if (pdata[0] || pdata[2] != 1) {
-      pdata++;
-    } else {
-      return (pdata - data);
-    }
-  }
+/**
+ * gst_byte_reader_get_uint16_le_array:
+ * @reader: a #GstByteReader instance
+ * @vals: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint16 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 16 bit little endian integers into @vals and update the
+ * current position. This is faster than reading them one by one.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.14
+ */
 
-  /* nothing found */
-  return -1;
+/**
+ * gst_byte_reader_get_uint16_be_array:
+ * @reader: a #GstByteReader instance
+ * @vals: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint16 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 16 bit big endian integers into @vals and update the
+ * current position. This is faster than reading them one by one.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_reader_get_uint32_le_array:
+ * @reader: a #GstByteReader instance
+ * @vals: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint32 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 32 bit little endian integers into @vals and update the
+ * current position. This is faster than reading them one by one.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_reader_get_uint32_be_array:
+ * @reader: a #GstByteReader instance
+ * @vals: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint32 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 32 bit big endian integers into @vals and update the
+ * current position. This is faster than reading them one by one.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_reader_get_uint64_le_array:
+ * @reader: a #GstByteReader instance
+ * @vals: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint64 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 64 bit little endian integers into @vals and update the
+ * current position. This is faster than reading them one by one.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_reader_get_uint64_be_array:
+ * @reader: a #GstByteReader instance
+ * @vals: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint64 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 64 bit big endian integers into @vals and update the
+ * current position. This is faster than reading them one by one.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.14
+ */
+
+#define GST_BYTE_READER_GET_ARRAY(bits,name,endian) \
+gboolean \
+gst_byte_reader_get_##name##_array (GstByteReader * reader, \
+    guint##bits * vals, guint n) \
+{ \
+  g_return_val_if_fail (reader != NULL, FALSE); \
+  g_return_val_if_fail (vals != NULL || n == 0, FALSE); \
+  \
+  if (G_UNLIKELY (n > _gst_byte_reader_get_remaining_unchecked (reader) / \
+              (bits / 8))) \
+    return FALSE; \
+  \
+  _gst_byte_swap_copy (bits, endian, vals, reader->data + reader->byte, n); \
+  reader->byte += n * (bits / 8); \
+  \
+  return TRUE; \
 }
 
+/* *INDENT-OFF* */
+
+GST_BYTE_READER_GET_ARRAY(16,uint16_le,G_LITTLE_ENDIAN)
+GST_BYTE_READER_GET_ARRAY(16,uint16_be,G_BIG_ENDIAN)
+GST_BYTE_READER_GET_ARRAY(32,uint32_le,G_LITTLE_ENDIAN)
+GST_BYTE_READER_GET_ARRAY(32,uint32_be,G_BIG_ENDIAN)
+GST_BYTE_READER_GET_ARRAY(64,uint64_le,G_LITTLE_ENDIAN)
+GST_BYTE_READER_GET_ARRAY(64,uint64_be,G_BIG_ENDIAN)
+
+/* *INDENT-ON* */
+
 static inline guint
 _masked_scan_uint32_peek (const GstByteReader * reader,
     guint32 mask, guint32 pattern, guint offset, guint size, guint32 * value)
@@ -863,7 +961,7 @@ _masked_scan_uint32_peek (const GstByteReader * reader,
 
   /* Handle special case found in MPEG and H264 */
   if ((pattern == 0x00000100) && (mask == 0xffffff00)) {
-    gint ret = _scan_for_start_code (data, size);
+    gint ret = _gst_scan_for_start_code (data, size);
 
     if (ret == -1)
       return ret;
@@ -220,6 +220,24 @@ gboolean        gst_byte_reader_get_data        (GstByteReader * reader, guint s
 GST_EXPORT
 gboolean        gst_byte_reader_peek_data       (const GstByteReader * reader, guint size, const guint8 ** val);
 
+GST_EXPORT
+gboolean        gst_byte_reader_get_uint16_le_array (GstByteReader * reader, guint16 * vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_reader_get_uint16_be_array (GstByteReader * reader, guint16 * vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_reader_get_uint32_le_array (GstByteReader * reader, guint32 * vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_reader_get_uint32_be_array (GstByteReader * reader, guint32 * vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_reader_get_uint64_le_array (GstByteReader * reader, guint64 * vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_reader_get_uint64_be_array (GstByteReader * reader, guint64 * vals, guint n);
+
 #define gst_byte_reader_dup_string(reader,str) \
     gst_byte_reader_dup_string_utf8(reader,str)
 
@@ -0,0 +1,63 @@
+/* GStreamer
+ *
+ * gstbyteswap-private.h: byte swapping array copies shared by GstByteReader
+ *                        and GstByteWriter
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BYTE_SWAP_PRIVATE_H__
+#define __GST_BYTE_SWAP_PRIVATE_H__
+
+#include <glib.h>
+#include <string.h>
+
+G_BEGIN_DECLS
+
+/* Copy @n values of @bits bits from @src to @dest, swapping the byte order of
+ * each. Neither pointer needs to be aligned. The loop is simple enough for
+ * the compiler to turn it into vector shuffles. */
+#define __GST_BYTE_SWAP_COPY(bits) \
+static inline void \
+_gst_byte_swap_copy_##bits (guint8 * dest, const guint8 * src, guint n) \
+{ \
+  guint##bits v; \
+  guint i; \
+  \
+  for (i = 0; i < n; i++) { \
+    memcpy (&v, src + i * (bits / 8), sizeof (v)); \
+    v = GUINT##bits##_SWAP_LE_BE (v); \
+    memcpy (dest + i * (bits / 8), &v, sizeof (v)); \
+  } \
+}
+
+__GST_BYTE_SWAP_COPY (16)
+__GST_BYTE_SWAP_COPY (32)
+__GST_BYTE_SWAP_COPY (64)
+
+#undef __GST_BYTE_SWAP_COPY
+
+/* copies @n values of @bits bits stored with byte order @endian */
+#define _gst_byte_swap_copy(bits,endian,dest,src,n) G_STMT_START { \
+  if (G_BYTE_ORDER == endian) \
+    memcpy (dest, src, (gsize) (n) * (bits / 8)); \
+  else \
+    _gst_byte_swap_copy_##bits ((guint8 *) (dest), (const guint8 *) (src), n); \
+} G_STMT_END
+
+G_END_DECLS
+
+#endif /* __GST_BYTE_SWAP_PRIVATE_H__ */
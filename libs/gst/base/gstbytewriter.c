@@ -24,6 +24,7 @@
 
 #define GST_BYTE_WRITER_DISABLE_INLINES
 #include "gstbytewriter.h"
+#include "gstbyteswap-private.h"
 
 /**
  * SECTION:gstbytewriter
@@ -395,6 +396,120 @@ gst_byte_writer_fill (GstByteWriter * writer, guint8 value, guint size)
   return _gst_byte_writer_fill_inline (writer, value, size);
 }
 
+/**
+ * gst_byte_writer_put_uint16_le_array:
+ * @writer: #GstByteWriter instance
+ * @vals: (array length=n): values to write
+ * @n: number of values in @vals
+ *
+ * Writes @n unsigned little endian 16 bit integers to @writer. This is faster
+ * than writing them one by one.
+ *
+ * Returns: %TRUE if the values could be written
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_writer_put_uint16_be_array:
+ * @writer: #GstByteWriter instance
+ * @vals: (array length=n): values to write
+ * @n: number of values in @vals
+ *
+ * Writes @n unsigned big endian 16 bit integers to @writer. This is faster
+ * than writing them one by one.
+ *
+ * Returns: %TRUE if the values could be written
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_writer_put_uint32_le_array:
+ * @writer: #GstByteWriter instance
+ * @vals: (array length=n): values to write
+ * @n: number of values in @vals
+ *
+ * Writes @n unsigned little endian 32 bit integers to @writer. This is faster
+ * than writing them one by one.
+ *
+ * Returns: %TRUE if the values could be written
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_writer_put_uint32_be_array:
+ * @writer: #GstByteWriter instance
+ * @vals: (array length=n): values to write
+ * @n: number of values in @vals
+ *
+ * Writes @n unsigned big endian 32 bit integers to @writer. This is faster
+ * than writing them one by one.
+ *
+ * Returns: %TRUE if the values could be written
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_writer_put_uint64_le_array:
+ * @writer: #GstByteWriter instance
+ * @vals: (array length=n): values to write
+ * @n: number of values in @vals
+ *
+ * Writes @n unsigned little endian 64 bit integers to @writer. This is faster
+ * than writing them one by one.
+ *
+ * Returns: %TRUE if the values could be written
+ *
+ * Since: 1.14
+ */
+
+/**
+ * gst_byte_writer_put_uint64_be_array:
+ * @writer: #GstByteWriter instance
+ * @vals: (array length=n): values to write
+ * @n: number of values in @vals
+ *
+ * Writes @n unsigned big endian 64 bit integers to @writer. This is faster
+ * than writing them one by one.
+ *
+ * Returns: %TRUE if the values could be written
+ *
+ * Since: 1.14
+ */
+
+#define CREATE_WRITE_ARRAY_FUNC(bits,name,endian) \
+gboolean \
+gst_byte_writer_put_##name##_array (GstByteWriter *writer, \
+    const guint##bits * vals, guint n) \
+{ \
+  guint8 *dest; \
+  \
+  g_return_val_if_fail (writer != NULL, FALSE); \
+  g_return_val_if_fail (vals != NULL || n == 0, FALSE); \
+  \
+  if (G_UNLIKELY (n > G_MAXUINT / (bits / 8))) \
+    return FALSE; \
+  if (G_UNLIKELY (!_gst_byte_writer_ensure_free_space_inline (writer, n * (bits / 8)))) \
+    return FALSE; \
+  \
+  dest = (guint8 *) writer->parent.data + writer->parent.byte; \
+  _gst_byte_swap_copy (bits, endian, dest, vals, n); \
+  writer->parent.byte += n * (bits / 8); \
+  writer->parent.size = MAX (writer->parent.size, writer->parent.byte); \
+  \
+  return TRUE; \
+}
+
+CREATE_WRITE_ARRAY_FUNC (16, uint16_le, G_LITTLE_ENDIAN);
+CREATE_WRITE_ARRAY_FUNC (16, uint16_be, G_BIG_ENDIAN);
+CREATE_WRITE_ARRAY_FUNC (32, uint32_le, G_LITTLE_ENDIAN);
+CREATE_WRITE_ARRAY_FUNC (32, uint32_be, G_BIG_ENDIAN);
+CREATE_WRITE_ARRAY_FUNC (64, uint64_le, G_LITTLE_ENDIAN);
+CREATE_WRITE_ARRAY_FUNC (64, uint64_be, G_BIG_ENDIAN);
+
 #define CREATE_WRITE_STRING_FUNC(bits,type) \
 gboolean \
 gst_byte_writer_put_string_utf##bits (GstByteWriter *writer, const type * data) \
@@ -205,6 +205,24 @@ gboolean        gst_byte_writer_put_data          (GstByteWriter *writer, const
 GST_EXPORT
 gboolean        gst_byte_writer_fill              (GstByteWriter *writer, guint8 value, guint size);
 
+GST_EXPORT
+gboolean        gst_byte_writer_put_uint16_le_array (GstByteWriter *writer, const guint16 *vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_writer_put_uint16_be_array (GstByteWriter *writer, const guint16 *vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_writer_put_uint32_le_array (GstByteWriter *writer, const guint32 *vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_writer_put_uint32_be_array (GstByteWriter *writer, const guint32 *vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_writer_put_uint64_le_array (GstByteWriter *writer, const guint64 *vals, guint n);
+
+GST_EXPORT
+gboolean        gst_byte_writer_put_uint64_be_array (GstByteWriter *writer, const guint64 *vals, guint n);
+
 GST_EXPORT
 gboolean        gst_byte_writer_put_string_utf8   (GstByteWriter *writer, const gchar *data);
 
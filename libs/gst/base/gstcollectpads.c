@@ -86,6 +86,12 @@ struct _GstCollectDataPrivate
   /* refcounting for struct, and destroy callback */
   GstCollectDataDestroyNotify destroy_notify;
   gint refcount;
+
+  /* with STREAM_LOCK */
+  gint heap_index;              /* position in the heap or -1 */
+  GstBuffer *heap_buffer;       /* the buffer the entry was added for */
+  GstClockTime heap_time;       /* and its timestamp */
+  guint order;                  /* position in the pads->data list */
 };
 
 struct _GstCollectPadsPrivate
@@ -100,6 +106,8 @@ struct _GstCollectPadsPrivate
   guint eospads;                /* number of pads that are EOS */
   GstClockTime earliest_time;   /* Current earliest time */
   GstCollectData *earliest_data;        /* Pad data for current earliest time */
+  GPtrArray *heap;              /* pads with a buffer, the earliest first */
+  gboolean heap_dirty;          /* heap must be rebuilt */
 
   /* with LOCK */
   GSList *pad_list;             /* list of GstCollectData* */
@@ -147,6 +155,11 @@ static gint gst_collect_pads_default_compare_func (GstCollectPads * pads,
 static gboolean gst_collect_pads_recalculate_full (GstCollectPads * pads);
 static void ref_data (GstCollectData * data);
 static void unref_data (GstCollectData * data);
+static void gst_collect_pads_heap_add (GstCollectPads * pads,
+    GstCollectData * data);
+static void gst_collect_pads_heap_remove (GstCollectPads * pads,
+    GstCollectData * data);
+static void gst_collect_pads_heap_clear (GstCollectPads * pads);
 
 static gboolean gst_collect_pads_event_default_internal (GstCollectPads *
     pads, GstCollectData * data, GstEvent * event, gpointer user_data);
@@ -224,6 +237,8 @@ gst_collect_pads_init (GstCollectPads * pads)
   pads->priv->queuedpads = 0;
   pads->priv->eospads = 0;
   pads->priv->started = FALSE;
+  pads->priv->heap = g_ptr_array_new ();
+  pads->priv->heap_dirty = FALSE;
 
   g_rec_mutex_init (&pads->stream_lock);
 
@@ -269,6 +284,9 @@ gst_collect_pads_finalize (GObject * object)
   g_cond_clear (&pads->priv->evt_cond);
   g_mutex_clear (&pads->priv->evt_lock);
 
+  gst_collect_pads_heap_clear (pads);
+  g_ptr_array_free (pads->priv->heap, TRUE);
+
   /* Remove pads and free pads list */
   g_slist_foreach (pads->priv->pad_list, (GFunc) unref_data, NULL);
   g_slist_foreach (pads->data, (GFunc) unref_data, NULL);
@@ -358,6 +376,8 @@ gst_collect_pads_set_compare_function (GstCollectPads * pads,
   GST_OBJECT_LOCK (pads);
   pads->priv->compare_func = func;
   pads->priv->compare_user_data = user_data;
+  /* the heap is ordered with the old function */
+  pads->priv->heap_dirty = TRUE;
   GST_OBJECT_UNLOCK (pads);
 }
 
@@ -421,6 +441,142 @@ unref_data (GstCollectData * data)
   g_free (data);
 }
 
+/* The pads with a queued buffer are kept in a binary min-heap ordered with
+ * the compare function, so that the default collection algorithm finds the
+ * earliest buffer without comparing the buffers of all pads every time.
+ * Buffers with the same time are ordered like the pads in pads->data.
+ *
+ * All heap functions must be called with STREAM_LOCK. */
+static inline gboolean
+gst_collect_pads_heap_less (GstCollectPads * pads, GstCollectData * a,
+    GstCollectData * b)
+{
+  gint cmp;
+
+  cmp = pads->priv->compare_func (pads, a, a->priv->heap_time, b,
+      b->priv->heap_time, pads->priv->compare_user_data);
+
+  return cmp < 0 || (cmp == 0 && a->priv->order < b->priv->order);
+}
+
+static inline void
+gst_collect_pads_heap_set (GstCollectPads * pads, guint i,
+    GstCollectData * data)
+{
+  g_ptr_array_index (pads->priv->heap, i) = data;
+  data->priv->heap_index = i;
+}
+
+static void
+gst_collect_pads_heap_sift_up (GstCollectPads * pads, guint i)
+{
+  GPtrArray *heap = pads->priv->heap;
+  GstCollectData *data = g_ptr_array_index (heap, i);
+
+  while (i > 0) {
+    GstCollectData *parent = g_ptr_array_index (heap, (i - 1) / 2);
+
+    if (!gst_collect_pads_heap_less (pads, data, parent))
+      break;
+    gst_collect_pads_heap_set (pads, i, parent);
+    i = (i - 1) / 2;
+  }
+  gst_collect_pads_heap_set (pads, i, data);
+}
+
+static void
+gst_collect_pads_heap_sift_down (GstCollectPads * pads, guint i)
+{
+  GPtrArray *heap = pads->priv->heap;
+  GstCollectData *data = g_ptr_array_index (heap, i);
+
+  while (2 * i + 1 < heap->len) {
+    GstCollectData *child;
+    guint c = 2 * i + 1;
+
+    if (c + 1 < heap->len &&
+        gst_collect_pads_heap_less (pads, g_ptr_array_index (heap, c + 1),
+            g_ptr_array_index (heap, c)))
+      c++;
+    child = g_ptr_array_index (heap, c);
+    if (!gst_collect_pads_heap_less (pads, child, data))
+      break;
+    gst_collect_pads_heap_set (pads, i, child);
+    i = c;
+  }
+  gst_collect_pads_heap_set (pads, i, data);
+}
+
+/* (re)adds @data for its currently queued buffer */
+static void
+gst_collect_pads_heap_add (GstCollectPads * pads, GstCollectData * data)
+{
+  gst_collect_pads_heap_remove (pads, data);
+
+  if (data->buffer == NULL)
+    return;
+
+  data->priv->heap_buffer = data->buffer;
+  data->priv->heap_time = GST_BUFFER_DTS_OR_PTS (data->buffer);
+  ref_data (data);
+  g_ptr_array_add (pads->priv->heap, data);
+  gst_collect_pads_heap_sift_up (pads, pads->priv->heap->len - 1);
+}
+
+static void
+gst_collect_pads_heap_remove (GstCollectPads * pads, GstCollectData * data)
+{
+  GPtrArray *heap = pads->priv->heap;
+  GstCollectData *last;
+  gint i = data->priv->heap_index;
+
+  if (i < 0)
+    return;
+
+  data->priv->heap_index = -1;
+  data->priv->heap_buffer = NULL;
+  last = g_ptr_array_remove_index (heap, heap->len - 1);
+  if (last != data) {
+    gst_collect_pads_heap_set (pads, i, last);
+    gst_collect_pads_heap_sift_down (pads, i);
+    gst_collect_pads_heap_sift_up (pads, last->priv->heap_index);
+  }
+  unref_data (data);
+}
+
+static void
+gst_collect_pads_heap_clear (GstCollectPads * pads)
+{
+  GPtrArray *heap = pads->priv->heap;
+  guint i;
+
+  for (i = 0; i < heap->len; i++) {
+    GstCollectData *data = g_ptr_array_index (heap, i);
+
+    data->priv->heap_index = -1;
+    data->priv->heap_buffer = NULL;
+    unref_data (data);
+  }
+  g_ptr_array_set_size (heap, 0);
+}
+
+/* rebuild the heap from the pads in pads->data */
+static void
+gst_collect_pads_heap_rebuild (GstCollectPads * pads)
+{
+  GSList *collected;
+  guint order = 0;
+
+  gst_collect_pads_heap_clear (pads);
+  for (collected = pads->data; collected; collected = g_slist_next (collected)) {
+    GstCollectData *data = collected->data;
+
+    data->priv->order = order++;
+    gst_collect_pads_heap_add (pads, data);
+  }
+  pads->priv->heap_dirty = FALSE;
+}
+
 /**
  * gst_collect_pads_set_event_function:
  * @pads: the collectpads to use
@@ -653,6 +809,7 @@ gst_collect_pads_add_pad (GstCollectPads * pads, GstPad * pad, guint size,
   data->state |= lock ? GST_COLLECT_PADS_STATE_LOCKED : 0;
   data->priv->refcount = 1;
   data->priv->destroy_notify = destroy_notify;
+  data->priv->heap_index = -1;
   data->ABI.abi.dts = G_MININT64;
 
   GST_OBJECT_LOCK (pads);
@@ -922,6 +1079,7 @@ gst_collect_pads_stop (GstCollectPads * pads)
     }
     GST_COLLECT_PADS_STATE_UNSET (data, GST_COLLECT_PADS_STATE_EOS);
   }
+  gst_collect_pads_heap_clear (pads);
 
   if (pads->priv->earliest_data)
     unref_data (pads->priv->earliest_data);
@@ -993,6 +1151,7 @@ gst_collect_pads_pop (GstCollectPads * pads, GstCollectData * data)
   if ((result = data->buffer)) {
     data->buffer = NULL;
     data->pos = 0;
+    gst_collect_pads_heap_remove (pads, data);
     /* one less pad with queued data now */
     if (GST_COLLECT_PADS_STATE_IS_SET (data, GST_COLLECT_PADS_STATE_WAITING))
       pads->priv->queuedpads--;
@@ -1302,6 +1461,8 @@ gst_collect_pads_check_pads (GstCollectPads * pads)
     }
     /* and update the cookie */
     pads->priv->cookie = pads->priv->pad_cookie;
+
+    gst_collect_pads_heap_rebuild (pads);
   }
   GST_OBJECT_UNLOCK (pads);
 }
@@ -1397,16 +1558,24 @@ gst_collect_pads_recalculate_waiting (GstCollectPads * pads)
 {
   GSList *collected;
   gboolean result = FALSE;
+  gboolean default_collect;
 
   /* If earliest time is not known, there is nothing to do. */
   if (pads->priv->earliest_data == NULL)
     return FALSE;
 
+  default_collect = pads->priv->func == gst_collect_pads_default_collected;
+
   for (collected = pads->data; collected; collected = g_slist_next (collected)) {
     GstCollectData *data = (GstCollectData *) collected->data;
     int cmp_res;
     GstClockTime comp_time;
 
+    /* the waiting state of a pad only matters once its buffer is taken, and
+     * the default algorithm makes the pad waiting before that anyway */
+    if (data->buffer && default_collect)
+      continue;
+
     /* check if pad has a segment */
     if (data->segment.format == GST_FORMAT_UNDEFINED) {
       GST_WARNING_OBJECT (pads,
@@ -1457,29 +1626,26 @@ static void
 gst_collect_pads_find_best_pad (GstCollectPads * pads,
     GstCollectData ** data, GstClockTime * time)
 {
-  GSList *collected;
+  GPtrArray *heap = pads->priv->heap;
   GstCollectData *best = NULL;
   GstClockTime best_time = GST_CLOCK_TIME_NONE;
 
   g_return_if_fail (data != NULL);
   g_return_if_fail (time != NULL);
 
-  for (collected = pads->data; collected; collected = g_slist_next (collected)) {
-    GstBuffer *buffer;
-    GstCollectData *data = (GstCollectData *) collected->data;
-    GstClockTime timestamp;
+  if (G_UNLIKELY (pads->priv->heap_dirty))
+    gst_collect_pads_heap_rebuild (pads);
 
-    buffer = gst_collect_pads_peek (pads, data);
-    /* if we have a buffer check if it is better then the current best one */
-    if (buffer != NULL) {
-      timestamp = GST_BUFFER_DTS_OR_PTS (buffer);
-      gst_buffer_unref (buffer);
-      if (best == NULL || pads->priv->compare_func (pads, data, timestamp,
-              best, best_time, pads->priv->compare_user_data) < 0) {
-        best = data;
-        best_time = timestamp;
-      }
+  /* the earliest pad is on top of the heap, fix up the entries of
+   * buffers that were changed behind our back */
+  while (heap->len > 0) {
+    best = g_ptr_array_index (heap, 0);
+    if (G_LIKELY (best->buffer && best->buffer == best->priv->heap_buffer)) {
+      best_time = best->priv->heap_time;
+      break;
     }
+    gst_collect_pads_heap_add (pads, best);
+    best = NULL;
   }
 
   /* set earliest time */
@@ -2199,6 +2365,7 @@ gst_collect_pads_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     pads->priv->queuedpads++;
   buffer_p = &data->buffer;
   gst_buffer_replace (buffer_p, buffer);
+  gst_collect_pads_heap_add (pads, data);
 
   /* update segment last position if in TIME */
   if (G_LIKELY (data->segment.format == GST_FORMAT_TIME)) {
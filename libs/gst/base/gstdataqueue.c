@@ -53,10 +53,15 @@ enum
   PROP_0,
   PROP_CUR_LEVEL_VISIBLE,
   PROP_CUR_LEVEL_BYTES,
-  PROP_CUR_LEVEL_TIME
+  PROP_CUR_LEVEL_TIME,
+  PROP_SPIN_TIME,
+  PROP_SPIN_HITS,
+  PROP_SPIN_BLOCKS
       /* FILL ME */
 };
 
+#define DEFAULT_SPIN_TIME 0
+
 struct _GstDataQueuePrivate
 {
   /* the array of data we're keeping our grubby hands on */
@@ -75,6 +80,11 @@ struct _GstDataQueuePrivate
                                  * of external flushing */
   GstDataQueueFullCallback fullcallback;
   GstDataQueueEmptyCallback emptycallback;
+
+  GstClockTime spin_time;       /* time to spin before waiting for an item */
+  gint add_cookie;              /* incremented atomically on every push */
+  guint64 spin_hits;            /* waits for an item that ended while spinning */
+  guint64 spin_blocks;          /* waits for an item that blocked */
 };
 
 #define GST_DATA_QUEUE_MUTEX_LOCK(q) G_STMT_START {                     \
@@ -185,6 +195,46 @@ gst_data_queue_class_init (GstDataQueueClass * klass)
           "Current amount of data in the queue (in ns)", 0, G_MAXUINT64, 0,
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDataQueue:spin-time:
+   *
+   * When popping from an empty queue, busy-wait up to this time for an item
+   * to be pushed before blocking on the queue. This trades CPU usage for a
+   * lower wakeup latency when items arrive at a high rate. 0 disables
+   * spinning.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_TIME,
+      g_param_spec_uint64 ("spin-time", "Spin time",
+          "Time to busy-wait for an item before blocking in nanoseconds "
+          "(0 = disabled)", 0, G_MAXINT64, DEFAULT_SPIN_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDataQueue:spin-hits:
+   *
+   * The number of waits for an item that ended while spinning.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_HITS,
+      g_param_spec_uint64 ("spin-hits", "Spin hits",
+          "Number of waits for an item that ended while spinning", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDataQueue:spin-blocks:
+   *
+   * The number of waits for an item that had to block on the queue.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_BLOCKS,
+      g_param_spec_uint64 ("spin-blocks", "Spin blocks",
+          "Number of waits for an item that had to block", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_data_queue_finalize;
 }
 
@@ -200,6 +250,7 @@ gst_data_queue_init (GstDataQueue * queue)
   queue->priv->cur_level.time = 0;      /* no content */
 
   queue->priv->checkfull = NULL;
+  queue->priv->spin_time = DEFAULT_SPIN_TIME;
 
   g_mutex_init (&queue->priv->qlock);
   g_cond_init (&queue->priv->item_add);
@@ -404,6 +455,8 @@ gst_data_queue_set_flushing (GstDataQueue * queue, gboolean flushing)
   GST_DATA_QUEUE_MUTEX_LOCK (queue);
   priv->flushing = flushing;
   if (flushing) {
+    /* stop spinning pop functions */
+    g_atomic_int_inc (&priv->add_cookie);
     /* release push/pop functions */
     if (priv->waiting_add)
       g_cond_signal (&priv->item_add);
@@ -425,6 +478,8 @@ gst_data_queue_push_force_unlocked (GstDataQueue * queue,
     priv->cur_level.visible++;
   priv->cur_level.bytes += item->size;
   priv->cur_level.time += item->duration;
+
+  g_atomic_int_inc (&priv->add_cookie);
 }
 
 /**
@@ -544,11 +599,42 @@ flushing:
   }
 }
 
+/* busy-wait for at most the spin-time until something is pushed or the
+ * queue is set to flushing. Returns with the lock taken again. */
+static void
+_gst_data_queue_spin (GstDataQueue * queue)
+{
+  GstDataQueuePrivate *priv = queue->priv;
+  GstClockTime end;
+  gint cookie;
+
+  cookie = priv->add_cookie;
+  end = gst_util_get_timestamp () + priv->spin_time;
+
+  GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+  while (g_atomic_int_get (&priv->add_cookie) == cookie
+      && gst_util_get_timestamp () < end);
+  GST_DATA_QUEUE_MUTEX_LOCK (queue);
+}
+
 static gboolean
 _gst_data_queue_wait_non_empty (GstDataQueue * queue)
 {
   GstDataQueuePrivate *priv = queue->priv;
 
+  if (priv->spin_time > 0) {
+    _gst_data_queue_spin (queue);
+    if (priv->flushing)
+      return FALSE;
+    if (!gst_data_queue_locked_is_empty (queue)) {
+      priv->spin_hits++;
+      return TRUE;
+    }
+  }
+
+  if (gst_data_queue_locked_is_empty (queue))
+    priv->spin_blocks++;
+
   while (gst_data_queue_locked_is_empty (queue)) {
     priv->waiting_add = TRUE;
     g_cond_wait (&priv->item_add, &priv->qlock);
@@ -559,6 +645,24 @@ _gst_data_queue_wait_non_empty (GstDataQueue * queue)
   return TRUE;
 }
 
+static inline GstDataQueueItem *
+gst_data_queue_locked_pop_head (GstDataQueue * queue)
+{
+  GstDataQueuePrivate *priv = queue->priv;
+  GstDataQueueItem *item;
+
+  /* Get the item from the GQueue */
+  item = gst_queue_array_pop_head (priv->queue);
+
+  /* update current level counter */
+  if (item->visible)
+    priv->cur_level.visible--;
+  priv->cur_level.bytes -= item->size;
+  priv->cur_level.time -= item->duration;
+
+  return item;
+}
+
 /**
  * gst_data_queue_pop: (skip)
  * @queue: a #GstDataQueue.
@@ -597,14 +701,7 @@ gst_data_queue_pop (GstDataQueue * queue, GstDataQueueItem ** item)
       goto flushing;
   }
 
-  /* Get the item from the GQueue */
-  *item = gst_queue_array_pop_head (priv->queue);
-
-  /* update current level counter */
-  if ((*item)->visible)
-    priv->cur_level.visible--;
-  priv->cur_level.bytes -= (*item)->size;
-  priv->cur_level.time -= (*item)->duration;
+  *item = gst_data_queue_locked_pop_head (queue);
 
   STATUS (queue, "after popping");
   if (priv->waiting_del)
@@ -623,6 +720,74 @@ flushing:
   }
 }
 
+/**
+ * gst_data_queue_pop_many: (skip)
+ * @queue: a #GstDataQueue.
+ * @items: array to store the returned #GstDataQueueItem in.
+ * @n_items: the size of @items.
+ *
+ * Retrieves up to @n_items of the items available on the @queue, in the
+ * order they were pushed. If the queue is currently empty, the call will
+ * block until at least one item is available, OR the @queue is set to the
+ * flushing state.
+ *
+ * This takes the lock of the @queue and wakes up a blocked writer only once
+ * for all the items, which is cheaper than popping them one by one with
+ * gst_data_queue_pop() when the reader is slower than the writer.
+ * MT safe.
+ *
+ * Returns: the number of items stored in @items, 0 if the @queue is flushing.
+ *
+ * Since: 1.14
+ */
+guint
+gst_data_queue_pop_many (GstDataQueue * queue, GstDataQueueItem ** items,
+    guint n_items)
+{
+  GstDataQueuePrivate *priv = queue->priv;
+  guint i, len;
+
+  g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), 0);
+  g_return_val_if_fail (items != NULL, 0);
+  g_return_val_if_fail (n_items > 0, 0);
+
+  GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing);
+
+  STATUS (queue, "before popping");
+
+  if (gst_data_queue_locked_is_empty (queue)) {
+    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+    if (G_LIKELY (priv->emptycallback))
+      priv->emptycallback (queue, priv->checkdata);
+    else
+      g_signal_emit (queue, gst_data_queue_signals[SIGNAL_EMPTY], 0);
+    GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing);
+
+    if (!_gst_data_queue_wait_non_empty (queue))
+      goto flushing;
+  }
+
+  len = MIN (n_items, gst_queue_array_get_length (priv->queue));
+  for (i = 0; i < len; i++)
+    items[i] = gst_data_queue_locked_pop_head (queue);
+
+  STATUS (queue, "after popping");
+  if (priv->waiting_del)
+    g_cond_signal (&priv->item_del);
+
+  GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+
+  return len;
+
+  /* ERRORS */
+flushing:
+  {
+    GST_DEBUG ("queue:%p, we are flushing", queue);
+    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+    return 0;
+  }
+}
+
 static gint
 is_of_type (gconstpointer a, gconstpointer b)
 {
@@ -777,7 +942,14 @@ static void
 gst_data_queue_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
 {
+  GstDataQueue *queue = GST_DATA_QUEUE (object);
+
   switch (prop_id) {
+    case PROP_SPIN_TIME:
+      GST_DATA_QUEUE_MUTEX_LOCK (queue);
+      queue->priv->spin_time = g_value_get_uint64 (value);
+      GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -803,6 +975,15 @@ gst_data_queue_get_property (GObject * object,
     case PROP_CUR_LEVEL_TIME:
       g_value_set_uint64 (value, priv->cur_level.time);
       break;
+    case PROP_SPIN_TIME:
+      g_value_set_uint64 (value, priv->spin_time);
+      break;
+    case PROP_SPIN_HITS:
+      g_value_set_uint64 (value, priv->spin_hits);
+      break;
+    case PROP_SPIN_BLOCKS:
+      g_value_set_uint64 (value, priv->spin_blocks);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -152,6 +152,10 @@ gboolean       gst_data_queue_push_force     (GstDataQueue * queue, GstDataQueue
 GST_EXPORT
 gboolean       gst_data_queue_pop            (GstDataQueue * queue, GstDataQueueItem ** item);
 
+GST_EXPORT
+guint          gst_data_queue_pop_many       (GstDataQueue * queue, GstDataQueueItem ** items,
+                                              guint n_items);
+
 GST_EXPORT
 gboolean       gst_data_queue_peek           (GstDataQueue * queue, GstDataQueueItem ** item);
 
@@ -44,6 +44,10 @@
  *
  * These functions will take refs on the passed #GstPad<!-- -->s.
  *
+ * The combiner keeps count of how many of its pads have each kind of
+ * #GstFlowReturn, so that gst_flow_combiner_update_pad_flow() can combine
+ * them without looking at all the pads again.
+ *
  * Aside from reducing the user's code size, the main advantage of using this
  * helper struct is to follow the standard rules for #GstFlowReturn combination.
  * These rules are:
@@ -68,6 +72,13 @@ struct _GstFlowCombiner
 {
   GQueue pads;
 
+  /* pad -> the last flow return of the pad as known to the combiner */
+  GHashTable *flows;
+  /* number of pads with an error (or flushing), not-linked and eos */
+  guint n_error;
+  guint n_not_linked;
+  guint n_eos;
+
   GstFlowReturn last_ret;
   volatile gint ref_count;
 };
@@ -95,6 +106,8 @@ gst_flow_combiner_new (void)
   GstFlowCombiner *combiner = g_slice_new (GstFlowCombiner);
 
   g_queue_init (&combiner->pads);
+  combiner->flows = g_hash_table_new (NULL, NULL);
+  combiner->n_error = combiner->n_not_linked = combiner->n_eos = 0;
   combiner->last_ret = GST_FLOW_OK;
   combiner->ref_count = 1;
 
@@ -157,6 +170,7 @@ gst_flow_combiner_unref (GstFlowCombiner * combiner)
 
     while ((pad = g_queue_pop_head (&combiner->pads)))
       gst_object_unref (pad);
+    g_hash_table_destroy (combiner->flows);
 
     g_slice_free (GstFlowCombiner, combiner);
   }
@@ -179,6 +193,8 @@ gst_flow_combiner_clear (GstFlowCombiner * combiner)
 
   while ((pad = g_queue_pop_head (&combiner->pads)))
     gst_object_unref (pad);
+  g_hash_table_remove_all (combiner->flows);
+  combiner->n_error = combiner->n_not_linked = combiner->n_eos = 0;
   combiner->last_ret = GST_FLOW_OK;
 }
 
@@ -201,39 +217,83 @@ gst_flow_combiner_reset (GstFlowCombiner * combiner)
 
   for (iter = combiner->pads.head; iter; iter = iter->next) {
     GST_PAD_LAST_FLOW_RETURN (iter->data) = GST_FLOW_OK;
+    g_hash_table_insert (combiner->flows, iter->data,
+        GINT_TO_POINTER (GST_FLOW_OK));
   }
+  combiner->n_error = combiner->n_not_linked = combiner->n_eos = 0;
 
   combiner->last_ret = GST_FLOW_OK;
 }
 
+#define IS_ERROR_FLOW(fret) \
+    ((fret) <= GST_FLOW_NOT_NEGOTIATED || (fret) == GST_FLOW_FLUSHING)
+
+static void
+gst_flow_combiner_count (GstFlowCombiner * combiner, GstFlowReturn fret,
+    gint delta)
+{
+  if (IS_ERROR_FLOW (fret))
+    combiner->n_error += delta;
+  else if (fret == GST_FLOW_NOT_LINKED)
+    combiner->n_not_linked += delta;
+  else if (fret == GST_FLOW_EOS)
+    combiner->n_eos += delta;
+}
+
+static void
+gst_flow_combiner_set_flow (GstFlowCombiner * combiner, GstPad * pad,
+    GstFlowReturn old_ret, GstFlowReturn fret)
+{
+  if (old_ret == fret)
+    return;
+
+  gst_flow_combiner_count (combiner, old_ret, -1);
+  gst_flow_combiner_count (combiner, fret, 1);
+  g_hash_table_insert (combiner->flows, pad, GINT_TO_POINTER (fret));
+}
+
+/* picks up the flow returns that were set on the pads directly, like
+ * gst_pad_push() does */
+static void
+gst_flow_combiner_sync (GstFlowCombiner * combiner)
+{
+  GList *iter;
+
+  for (iter = combiner->pads.head; iter; iter = iter->next) {
+    GstFlowReturn old_ret =
+        GPOINTER_TO_INT (g_hash_table_lookup (combiner->flows, iter->data));
+
+    gst_flow_combiner_set_flow (combiner, iter->data, old_ret,
+        GST_PAD_LAST_FLOW_RETURN (iter->data));
+  }
+}
+
 static GstFlowReturn
 gst_flow_combiner_get_flow (GstFlowCombiner * combiner)
 {
   GstFlowReturn cret = GST_FLOW_OK;
-  gboolean all_eos = TRUE;
-  gboolean all_notlinked = TRUE;
+  guint n_pads = combiner->pads.length;
   GList *iter;
 
   GST_DEBUG ("Combining flow returns");
 
-  for (iter = combiner->pads.head; iter; iter = iter->next) {
-    GstFlowReturn fret = GST_PAD_LAST_FLOW_RETURN (iter->data);
-
-    if (fret <= GST_FLOW_NOT_NEGOTIATED || fret == GST_FLOW_FLUSHING) {
-      GST_DEBUG ("Error flow return found, returning");
-      cret = fret;
-      goto done;
-    }
-
-    if (fret != GST_FLOW_NOT_LINKED) {
-      all_notlinked = FALSE;
-      if (fret != GST_FLOW_EOS)
-        all_eos = FALSE;
+  /* the first pad in the list with an error wins */
+  if (combiner->n_error > 0) {
+    for (iter = combiner->pads.head; iter; iter = iter->next) {
+      GstFlowReturn fret =
+          GPOINTER_TO_INT (g_hash_table_lookup (combiner->flows, iter->data));
+
+      if (IS_ERROR_FLOW (fret)) {
+        GST_DEBUG ("Error flow return found, returning");
+        cret = fret;
+        goto done;
+      }
     }
   }
-  if (all_notlinked)
+
+  if (combiner->n_not_linked == n_pads)
     cret = GST_FLOW_NOT_LINKED;
-  else if (all_eos)
+  else if (combiner->n_not_linked + combiner->n_eos == n_pads)
     cret = GST_FLOW_EOS;
 
 done:
@@ -267,9 +327,10 @@ gst_flow_combiner_update_flow (GstFlowCombiner * combiner, GstFlowReturn fret)
     return fret;
   }
 
-  if (fret <= GST_FLOW_NOT_NEGOTIATED || fret == GST_FLOW_FLUSHING) {
+  if (IS_ERROR_FLOW (fret)) {
     ret = fret;
   } else {
+    gst_flow_combiner_sync (combiner);
     ret = gst_flow_combiner_get_flow (combiner);
   }
   combiner->last_ret = ret;
@@ -290,6 +351,10 @@ gst_flow_combiner_update_flow (GstFlowCombiner * combiner, GstFlowReturn fret)
  * combinations and avoid looking over all pads again. e.g. The last combined
  * return is the same as the latest obtained #GstFlowReturn.
  *
+ * While all pads are %GST_FLOW_OK this doesn't look at the other pads. When
+ * a pad had an error, EOS or was not linked, the current flow returns of all
+ * pads are picked up like gst_flow_combiner_update_flow() does.
+ *
  * Returns: The combined #GstFlowReturn
  * Since: 1.6
  */
@@ -297,11 +362,32 @@ GstFlowReturn
 gst_flow_combiner_update_pad_flow (GstFlowCombiner * combiner, GstPad * pad,
     GstFlowReturn fret)
 {
+  GstFlowReturn ret;
+  gpointer old_ret;
+
+  g_return_val_if_fail (combiner != NULL, GST_FLOW_ERROR);
   g_return_val_if_fail (pad != NULL, GST_FLOW_ERROR);
 
   GST_PAD_LAST_FLOW_RETURN (pad) = fret;
 
-  return gst_flow_combiner_update_flow (combiner, fret);
+  if (!g_hash_table_lookup_extended (combiner->flows, pad, NULL, &old_ret))
+    return gst_flow_combiner_update_flow (combiner, fret);
+
+  gst_flow_combiner_set_flow (combiner, pad, GPOINTER_TO_INT (old_ret), fret);
+
+  /* the recorded flows of the other pads may be stale, like after an EOS
+   * that gst_pad_push() set on them, when they are not all OK */
+  if (combiner->n_error || combiner->n_not_linked || combiner->n_eos)
+    gst_flow_combiner_sync (combiner);
+  else if (combiner->last_ret == fret)
+    return fret;
+
+  if (IS_ERROR_FLOW (fret))
+    ret = fret;
+  else
+    ret = gst_flow_combiner_get_flow (combiner);
+  combiner->last_ret = ret;
+  return ret;
 }
 
 /**
@@ -319,7 +405,15 @@ gst_flow_combiner_add_pad (GstFlowCombiner * combiner, GstPad * pad)
   g_return_if_fail (combiner != NULL);
   g_return_if_fail (pad != NULL);
 
+  if (g_hash_table_contains (combiner->flows, pad)) {
+    GST_DEBUG ("pad %" GST_PTR_FORMAT " was already added", pad);
+    return;
+  }
+
   g_queue_push_head (&combiner->pads, gst_object_ref (pad));
+  g_hash_table_insert (combiner->flows, pad,
+      GINT_TO_POINTER (GST_PAD_LAST_FLOW_RETURN (pad)));
+  gst_flow_combiner_count (combiner, GST_PAD_LAST_FLOW_RETURN (pad), 1);
 }
 
 /**
@@ -334,9 +428,16 @@ gst_flow_combiner_add_pad (GstFlowCombiner * combiner, GstPad * pad)
 void
 gst_flow_combiner_remove_pad (GstFlowCombiner * combiner, GstPad * pad)
 {
+  gpointer old_ret;
+
   g_return_if_fail (combiner != NULL);
   g_return_if_fail (pad != NULL);
 
-  if (g_queue_remove (&combiner->pads, pad))
-    gst_object_unref (pad);
+  if (!g_hash_table_lookup_extended (combiner->flows, pad, NULL, &old_ret))
+    return;
+
+  gst_flow_combiner_count (combiner, GPOINTER_TO_INT (old_ret), -1);
+  g_hash_table_remove (combiner->flows, pad);
+  g_queue_remove (&combiner->pads, pad);
+  gst_object_unref (pad);
 }
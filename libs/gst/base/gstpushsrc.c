@@ -43,6 +43,11 @@
  * The subclass should extend the methods from the baseclass in
  * addition to the ::create method.
  *
+ * Sources that receive data in bursts, like network sources or capture
+ * devices with several frames queued, can implement ::create_list instead
+ * to push everything that is available in one go. This only works in push
+ * mode.
+ *
  * Seeking, flushing, scheduling and sync is all handled by this
  * base class.
  */
@@ -127,13 +132,33 @@ gst_push_src_create (GstBaseSrc * bsrc, guint64 offset, guint length,
 
   src = GST_PUSH_SRC (bsrc);
   pclass = GST_PUSH_SRC_GET_CLASS (src);
-  if (pclass->create)
+  if (pclass->create_list) {
+    GstBufferList *list = NULL;
+
+    fret = pclass->create_list (src, &list);
+    if (fret == GST_FLOW_OK) {
+      if (G_UNLIKELY (list == NULL))
+        goto no_list;
+      gst_base_src_submit_buffer_list (bsrc, list);
+    } else if (list) {
+      gst_buffer_list_unref (list);
+    }
+    *ret = NULL;
+  } else if (pclass->create)
     fret = pclass->create (src, ret);
   else
     fret =
         GST_BASE_SRC_CLASS (parent_class)->create (bsrc, offset, length, ret);
 
   return fret;
+
+  /* ERRORS */
+no_list:
+  {
+    GST_ELEMENT_ERROR (src, CORE, FAILED, (NULL),
+        ("create_list returned OK without a buffer list"));
+    return GST_FLOW_ERROR;
+  }
 }
 
 static GstFlowReturn
@@ -62,6 +62,11 @@ struct _GstPushSrc {
  *         size this buffer should be. The default implementation will create
  *         a new buffer from the negotiated allocator.
  * @fill: Ask the subclass to fill the buffer with data.
+ * @create_list: Ask the subclass to create a list of buffers, for example
+ *          all the packets or frames that are queued already. When set it is
+ *          used instead of @create and @fill. All buffers of the list are
+ *          pushed at once after the first one is synchronised against the
+ *          clock. Since: 1.14
  *
  * Subclasses can override any of the available virtual methods or not, as
  * needed. At the minimum, the @fill method should be overridden to produce
@@ -78,8 +83,11 @@ struct _GstPushSrcClass {
   /* ask the subclass to fill a buffer */
   GstFlowReturn (*fill)   (GstPushSrc *src, GstBuffer *buf);
 
+  /* ask the subclass to create a list of buffers */
+  GstFlowReturn (*create_list) (GstPushSrc *src, GstBufferList **list);
+
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  gpointer _gst_reserved[GST_PADDING - 1];
 };
 
 GST_EXPORT
@@ -216,18 +216,18 @@ gst_queue_array_peek_head (GstQueueArray * array)
   return *(gpointer *) (array->array + (sizeof (gpointer) * array->head));
 }
 
+/* changes the size of the array to @newsize, which must be at least the
+ * length. */
 static void
-gst_queue_array_do_expand (GstQueueArray * array)
+gst_queue_array_resize (GstQueueArray * array, guint newsize)
 {
   guint elt_size = array->elt_size;
-  /* newsize is 50% bigger */
   guint oldsize = array->size;
-  guint newsize = MAX ((3 * oldsize) / 2, oldsize + 1);
 
   /* copy over data */
-  if (array->tail != 0) {
+  if (array->head + array->length > oldsize) {
     guint8 *array2 = g_malloc0 (elt_size * newsize);
-    guint t1 = array->head;
+    guint t1 = array->tail;
     guint t2 = oldsize - array->head;
 
     /* [0-----TAIL][HEAD------SIZE]
@@ -244,17 +244,30 @@ gst_queue_array_do_expand (GstQueueArray * array)
 
     g_free (array->array);
     array->array = array2;
-    array->head = 0;
   } else {
-    /* Fast path, we just need to grow the array */
+    /* Fast path, the data is in one piece already */
+    if (array->head != 0)
+      memmove (array->array, array->array + elt_size * array->head,
+          elt_size * array->length);
     array->array = g_realloc (array->array, elt_size * newsize);
-    memset (array->array + elt_size * oldsize, 0,
-        elt_size * (newsize - oldsize));
+    if (newsize > oldsize)
+      memset (array->array + elt_size * oldsize, 0,
+          elt_size * (newsize - oldsize));
   }
-  array->tail = oldsize;
+  array->head = 0;
+  array->tail = array->length % newsize;
   array->size = newsize;
 }
 
+static void
+gst_queue_array_do_expand (GstQueueArray * array)
+{
+  /* newsize is 50% bigger */
+  guint oldsize = array->size;
+
+  gst_queue_array_resize (array, MAX ((3 * oldsize) / 2, oldsize + 1));
+}
+
 /**
  * gst_queue_array_push_element_tail: (skip)
  * @array: a #GstQueueArray object
@@ -308,6 +321,151 @@ gst_queue_array_push_tail (GstQueueArray * array, gpointer data)
   array->length++;
 }
 
+/**
+ * gst_queue_array_reserve: (skip)
+ * @array: a #GstQueueArray object
+ * @n: number of elements
+ *
+ * Makes sure that @n more elements can be pushed on the queue @array
+ * without growing it.
+ *
+ * Since: 1.14
+ */
+void
+gst_queue_array_reserve (GstQueueArray * array, guint n)
+{
+  guint oldsize;
+
+  g_return_if_fail (array != NULL);
+
+  oldsize = array->size;
+  if (G_LIKELY (array->length + n <= oldsize))
+    return;
+
+  /* grow by at least 50% so that repeated small reservations stay cheap */
+  gst_queue_array_resize (array, MAX (array->length + n, (3 * oldsize) / 2));
+}
+
+/**
+ * gst_queue_array_push_tail_n: (skip)
+ * @array: a #GstQueueArray object
+ * @data: (array length=n): the elements to push
+ * @n: number of elements in @data
+ *
+ * Pushes the @n elements in @data to the tail of the queue @array, in one
+ * go. For a queue created with gst_queue_array_new() @data is an array of
+ * pointers, for a queue created with gst_queue_array_new_for_struct() an
+ * array of structures.
+ *
+ * Since: 1.14
+ */
+void
+gst_queue_array_push_tail_n (GstQueueArray * array, gconstpointer data,
+    guint n)
+{
+  guint elt_size, n1;
+
+  g_return_if_fail (array != NULL);
+  g_return_if_fail (data != NULL || n == 0);
+
+  if (n == 0)
+    return;
+
+  gst_queue_array_reserve (array, n);
+  elt_size = array->elt_size;
+
+  /* up to the end of the array and the rest at the start */
+  n1 = MIN (n, array->size - array->tail);
+  memcpy (array->array + elt_size * array->tail, data, elt_size * n1);
+  memcpy (array->array, (const guint8 *) data + elt_size * n1,
+      elt_size * (n - n1));
+
+  array->tail = (array->tail + n) % array->size;
+  array->length += n;
+}
+
+/**
+ * gst_queue_array_pop_head_n: (skip)
+ * @array: a #GstQueueArray object
+ * @data: (array length=n) (allow-none): location for the elements
+ * @n: maximum number of elements to pop
+ *
+ * Removes up to @n elements from the head of the queue @array and copies
+ * them to @data, if not %NULL. See gst_queue_array_push_tail_n() for the
+ * layout of @data.
+ *
+ * Returns: the number of elements that were removed
+ *
+ * Since: 1.14
+ */
+guint
+gst_queue_array_pop_head_n (GstQueueArray * array, gpointer data, guint n)
+{
+  guint elt_size, n1;
+
+  g_return_val_if_fail (array != NULL, 0);
+
+  n = MIN (n, array->length);
+  if (n == 0)
+    return 0;
+
+  elt_size = array->elt_size;
+  if (data) {
+    n1 = MIN (n, array->size - array->head);
+    memcpy (data, array->array + elt_size * array->head, elt_size * n1);
+    memcpy ((guint8 *) data + elt_size * n1, array->array,
+        elt_size * (n - n1));
+  }
+
+  array->head = (array->head + n) % array->size;
+  array->length -= n;
+
+  return n;
+}
+
+/**
+ * gst_queue_array_clear: (skip)
+ * @array: a #GstQueueArray object
+ *
+ * Removes all elements from the queue @array. The memory of the queue is
+ * kept for the elements that are pushed next, use
+ * gst_queue_array_shrink() to release it.
+ *
+ * Since: 1.14
+ */
+void
+gst_queue_array_clear (GstQueueArray * array)
+{
+  g_return_if_fail (array != NULL);
+
+  array->head = 0;
+  array->tail = 0;
+  array->length = 0;
+}
+
+/**
+ * gst_queue_array_shrink: (skip)
+ * @array: a #GstQueueArray object
+ * @min_size: the minimum number of elements to keep memory for
+ *
+ * Releases the memory the queue @array does not need for its current
+ * elements, or @min_size elements if that is more. Call this when a queue
+ * that grew large is expected to stay short, e.g. after a flush.
+ *
+ * Since: 1.14
+ */
+void
+gst_queue_array_shrink (GstQueueArray * array, guint min_size)
+{
+  guint newsize;
+
+  g_return_if_fail (array != NULL);
+
+  newsize = MAX (MAX (array->length, min_size), 1);
+  if (newsize < array->size)
+    gst_queue_array_resize (array, newsize);
+}
+
 /**
  * gst_queue_array_is_empty: (skip)
  * @array: a #GstQueueArray object
@@ -59,6 +59,24 @@ guint           gst_queue_array_find (GstQueueArray * array,
 GST_EXPORT
 guint           gst_queue_array_get_length (GstQueueArray * array);
 
+GST_EXPORT
+void            gst_queue_array_push_tail_n (GstQueueArray * array,
+                                             gconstpointer   data,
+                                             guint           n);
+GST_EXPORT
+guint           gst_queue_array_pop_head_n  (GstQueueArray * array,
+                                             gpointer        data,
+                                             guint           n);
+GST_EXPORT
+void            gst_queue_array_reserve     (GstQueueArray * array,
+                                             guint           n);
+GST_EXPORT
+void            gst_queue_array_clear       (GstQueueArray * array);
+
+GST_EXPORT
+void            gst_queue_array_shrink      (GstQueueArray * array,
+                                             guint           min_size);
+
 /* Functions for use with structures */
 
 GST_EXPORT
@@ -0,0 +1,109 @@
+/* GStreamer
+ *
+ * gstscan-private.h: start code scanning shared by GstAdapter and
+ *                    GstByteReader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_SCAN_PRIVATE_H__
+#define __GST_SCAN_PRIVATE_H__
+
+#include <glib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+G_BEGIN_DECLS
+
+/* The scan for the 0x00 0x00 0x01 start codes of MPEG and H.264 with mask
+ * 0xffffff00 and pattern 0x00000100. Returns the position of the first start
+ * code that is followed by at least one more byte in the @size bytes of
+ * @data, or -1. */
+static inline gint
+_gst_scan_for_start_code (const guint8 * data, guint size)
+{
+  const guint8 *pdata = data;
+  const guint8 *pend;
+
+  if (G_UNLIKELY (size < 4))
+    return -1;
+
+  /* last position a start code can begin at */
+  pend = data + size - 4;
+
+#ifdef __SSE2__
+  {
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i one = _mm_set1_epi8 (1);
+
+    /* check 16 positions at once, this reads 18 bytes */
+    while (pend - pdata >= 15) {
+      __m128i b0 = _mm_loadu_si128 ((const __m128i *) pdata);
+      __m128i b1 = _mm_loadu_si128 ((const __m128i *) (pdata + 1));
+      __m128i b2 = _mm_loadu_si128 ((const __m128i *) (pdata + 2));
+      gint mask;
+
+      mask = _mm_movemask_epi8 (_mm_and_si128 (_mm_and_si128 (_mm_cmpeq_epi8
+                  (b0, zero), _mm_cmpeq_epi8 (b1, zero)), _mm_cmpeq_epi8 (b2,
+                  one)));
+      if (mask)
+        return (pdata - data) + g_bit_nth_lsf (mask, -1);
+
+      pdata += 16;
+    }
+  }
+#else
+  /* a start code can only begin at a zero byte, skip 8 bytes at a time as
+   * long as they contain none */
+  while (pend - pdata >= 7) {
+    guint64 v;
+
+    memcpy (&v, pdata, sizeof (v));
+    if (((v - G_GUINT64_CONSTANT (0x0101010101010101)) & ~v &
+            G_GUINT64_CONSTANT (0x8080808080808080)) != 0) {
+      guint i;
+
+      for (i = 0; i < 8; i++) {
+        if (pdata[i] == 0 && pdata[i + 1] == 0 && pdata[i + 2] == 1)
+          return (pdata - data) + i;
+      }
+    }
+    pdata += 8;
+  }
+#endif
+
+  while (pdata <= pend) {
+    if (pdata[2] > 1) {
+      pdata += 3;
+    } else if (pdata[1]) {
+      pdata += 2;
+    } else if (pdata[0] || pdata[2] != 1) {
+      pdata++;
+    } else {
+      return (pdata - data);
+    }
+  }
+
+  /* nothing found */
+  return -1;
+}
+
+G_END_DECLS
+
+#endif /* __GST_SCAN_PRIVATE_H__ */
@@ -0,0 +1,476 @@
+/* GStreamer
+ *
+ * gstseekindex.c: compact time to byte offset index for seeking
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gstseekindex.h"
+#include "gstbytereader.h"
+#include "gstbytewriter.h"
+
+/* The index keeps the key unit entries sorted by timestamp, in blocks of at
+ * most BLOCK_ENTRIES entries. A block has its first and last entry in full,
+ * the entries after the first are stored as the difference to the previous
+ * entry in a variable length encoding, which takes a few bytes per entry.
+ * Lookups do a binary search on the first entries of the blocks and then
+ * decode at most one block.
+ *
+ * Entries are normally added in order and appended to the last block. An
+ * entry before the end, after a seek, is inserted by encoding its block
+ * again, which is split in two when it gets too large.
+ *
+ * The file format is the stream size and the blocks as they are in memory,
+ * all integers in little endian. */
+
+#define BLOCK_ENTRIES 64
+
+#define INDEX_MAGIC "GSTSIDX"
+#define INDEX_MAGIC_LEN 7
+#define INDEX_VERSION 1
+
+/* the difference of two offsets can be negative */
+#define ZIGZAG_ENCODE(v) \
+    (((guint64) (v) << 1) ^ (guint64) ((gint64) (v) >> 63))
+#define ZIGZAG_DECODE(v) ((gint64) ((v) >> 1) ^ -(gint64) ((v) & 1))
+
+typedef struct
+{
+  GstClockTime ts;
+  guint64 offset;
+} GstSeekIndexEntry;
+
+typedef struct
+{
+  GstSeekIndexEntry first;
+  GstSeekIndexEntry last;
+  guint n_entries;
+
+  /* encoded entries after the first */
+  guint8 *data;
+  guint size;
+  guint alloc;
+} GstSeekIndexBlock;
+
+struct _GstSeekIndex
+{
+  GArray *blocks;
+  guint n_entries;
+};
+
+static void
+block_clear (GstSeekIndexBlock * block)
+{
+  g_free (block->data);
+}
+
+static void
+block_put_varint (GstSeekIndexBlock * block, guint64 val)
+{
+  /* at most 10 bytes for 64 bits */
+  if (block->size + 10 > block->alloc) {
+    block->alloc = MAX (block->alloc * 2, 64);
+    block->data = g_realloc (block->data, block->alloc);
+  }
+
+  while (val >= 0x80) {
+    block->data[block->size++] = (val & 0x7f) | 0x80;
+    val >>= 7;
+  }
+  block->data[block->size++] = val;
+}
+
+static gboolean
+get_varint (const guint8 ** data, const guint8 * end, guint64 * val)
+{
+  guint64 res = 0;
+  guint shift = 0;
+
+  while (*data < end && shift < 64) {
+    guint8 b = *(*data)++;
+
+    res |= (guint64) (b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      *val = res;
+      return TRUE;
+    }
+    shift += 7;
+  }
+  return FALSE;
+}
+
+static void
+block_append (GstSeekIndexBlock * block, const GstSeekIndexEntry * entry)
+{
+  if (block->n_entries == 0) {
+    block->first = *entry;
+  } else {
+    block_put_varint (block, entry->ts - block->last.ts);
+    block_put_varint (block,
+        ZIGZAG_ENCODE ((gint64) (entry->offset - block->last.offset)));
+  }
+  block->last = *entry;
+  block->n_entries++;
+}
+
+static void
+block_encode (GstSeekIndexBlock * block, const GstSeekIndexEntry * entries,
+    guint n_entries)
+{
+  guint i;
+
+  block->size = 0;
+  block->n_entries = 0;
+  for (i = 0; i < n_entries; i++)
+    block_append (block, &entries[i]);
+}
+
+/* fills @entries with the n_entries entries of @block, returns FALSE if the
+ * data of the block is not valid */
+static gboolean
+block_decode (const GstSeekIndexBlock * block, GstSeekIndexEntry * entries)
+{
+  const guint8 *data = block->data, *end = block->data + block->size;
+  GstSeekIndexEntry entry = block->first;
+  guint64 ts_diff, offset_diff;
+  guint i;
+
+  entries[0] = entry;
+  for (i = 1; i < block->n_entries; i++) {
+    if (!get_varint (&data, end, &ts_diff) ||
+        !get_varint (&data, end, &offset_diff))
+      return FALSE;
+    if (entry.ts + ts_diff < entry.ts)
+      return FALSE;
+
+    entry.ts += ts_diff;
+    entry.offset += ZIGZAG_DECODE (offset_diff);
+    entries[i] = entry;
+  }
+  return data == end;
+}
+
+/* returns the last block that starts at or before @ts, or -1 */
+static gint
+find_block (GstSeekIndex * index, GstClockTime ts)
+{
+  guint lo = 0, hi = index->blocks->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (index->blocks, GstSeekIndexBlock, mid).first.ts <= ts)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return (gint) lo - 1;
+}
+
+GstSeekIndex *
+gst_seek_index_new (void)
+{
+  GstSeekIndex *index;
+
+  index = g_slice_new0 (GstSeekIndex);
+  index->blocks = g_array_new (FALSE, FALSE, sizeof (GstSeekIndexBlock));
+  g_array_set_clear_func (index->blocks, (GDestroyNotify) block_clear);
+
+  return index;
+}
+
+void
+gst_seek_index_free (GstSeekIndex * index)
+{
+  g_array_free (index->blocks, TRUE);
+  g_slice_free (GstSeekIndex, index);
+}
+
+void
+gst_seek_index_clear (GstSeekIndex * index)
+{
+  g_array_set_size (index->blocks, 0);
+  index->n_entries = 0;
+}
+
+guint
+gst_seek_index_get_size (GstSeekIndex * index)
+{
+  return index->n_entries;
+}
+
+/* adds a key unit at @offset with timestamp @ts. An existing entry with the
+ * same timestamp gets the new offset */
+void
+gst_seek_index_add (GstSeekIndex * index, GstClockTime ts, guint64 offset)
+{
+  GstSeekIndexEntry entries[BLOCK_ENTRIES + 1];
+  GstSeekIndexEntry entry;
+  GstSeekIndexBlock *block = NULL;
+  gint b;
+  guint i, n;
+
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (ts));
+
+  entry.ts = ts;
+  entry.offset = offset;
+
+  if (index->blocks->len > 0)
+    block = &g_array_index (index->blocks, GstSeekIndexBlock,
+        index->blocks->len - 1);
+
+  /* the common case, after the last entry */
+  if (block == NULL || ts > block->last.ts) {
+    if (block == NULL || block->n_entries == BLOCK_ENTRIES) {
+      GstSeekIndexBlock new_block = { {0,}, };
+
+      g_array_append_val (index->blocks, new_block);
+      block = &g_array_index (index->blocks, GstSeekIndexBlock,
+          index->blocks->len - 1);
+    }
+    block_append (block, &entry);
+    index->n_entries++;
+    return;
+  }
+
+  b = MAX (find_block (index, ts), 0);
+  block = &g_array_index (index->blocks, GstSeekIndexBlock, b);
+  block_decode (block, entries);
+  n = block->n_entries;
+
+  for (i = 0; i < n && entries[i].ts < ts; i++);
+  if (i < n && entries[i].ts == ts) {
+    entries[i].offset = offset;
+  } else {
+    memmove (&entries[i + 1], &entries[i], (n - i) * sizeof (entry));
+    entries[i] = entry;
+    index->n_entries++;
+    n++;
+  }
+
+  if (n > BLOCK_ENTRIES) {
+    GstSeekIndexBlock new_block = { {0,}, };
+
+    block_encode (block, entries, n / 2);
+    block_encode (&new_block, entries + n / 2, n - n / 2);
+    g_array_insert_val (index->blocks, b + 1, new_block);
+  } else {
+    block_encode (block, entries, n);
+  }
+}
+
+/* finds the last entry at or before @ts if @before is %TRUE, else the first
+ * entry at or after @ts */
+gboolean
+gst_seek_index_lookup (GstSeekIndex * index, GstClockTime ts,
+    gboolean before, GstClockTime * entry_ts, guint64 * entry_offset)
+{
+  GstSeekIndexEntry entries[BLOCK_ENTRIES];
+  const GstSeekIndexEntry *found;
+  GstSeekIndexBlock *block;
+  gint b;
+  guint i;
+
+  if (index->blocks->len == 0)
+    return FALSE;
+
+  b = find_block (index, ts);
+  if (b < 0) {
+    if (before)
+      return FALSE;
+    found = &g_array_index (index->blocks, GstSeekIndexBlock, 0).first;
+    goto done;
+  }
+
+  block = &g_array_index (index->blocks, GstSeekIndexBlock, b);
+  if (ts >= block->last.ts) {
+    if (before || ts == block->last.ts) {
+      found = &block->last;
+    } else if ((guint) b + 1 < index->blocks->len) {
+      found = &g_array_index (index->blocks, GstSeekIndexBlock, b + 1).first;
+    } else {
+      return FALSE;
+    }
+    goto done;
+  }
+
+  /* first.ts <= ts < last.ts */
+  block_decode (block, entries);
+  if (before) {
+    for (i = block->n_entries - 1; entries[i].ts > ts; i--);
+  } else {
+    for (i = 0; entries[i].ts < ts; i++);
+  }
+  found = &entries[i];
+
+done:
+  if (entry_ts)
+    *entry_ts = found->ts;
+  if (entry_offset)
+    *entry_offset = found->offset;
+
+  return TRUE;
+}
+
+/* writes the index of a stream of @stream_size bytes to @filename */
+gboolean
+gst_seek_index_save (GstSeekIndex * index, const gchar * filename,
+    guint64 stream_size, GError ** error)
+{
+  GstByteWriter writer;
+  guint8 *data;
+  guint i, size;
+  gboolean ret;
+
+  gst_byte_writer_init (&writer);
+
+  gst_byte_writer_put_data (&writer, (const guint8 *) INDEX_MAGIC,
+      INDEX_MAGIC_LEN);
+  gst_byte_writer_put_uint8 (&writer, INDEX_VERSION);
+  gst_byte_writer_put_uint64_le (&writer, stream_size);
+  gst_byte_writer_put_uint32_le (&writer, index->blocks->len);
+
+  for (i = 0; i < index->blocks->len; i++) {
+    GstSeekIndexBlock *block =
+        &g_array_index (index->blocks, GstSeekIndexBlock, i);
+
+    gst_byte_writer_put_uint64_le (&writer, block->first.ts);
+    gst_byte_writer_put_uint64_le (&writer, block->first.offset);
+    gst_byte_writer_put_uint32_le (&writer, block->n_entries);
+    gst_byte_writer_put_uint32_le (&writer, block->size);
+    gst_byte_writer_put_data (&writer, block->data, block->size);
+  }
+
+  size = gst_byte_writer_get_size (&writer);
+  data = gst_byte_writer_reset_and_get_data (&writer);
+
+  ret = g_file_set_contents (filename, (const gchar *) data, size, error);
+  g_free (data);
+
+  return ret;
+}
+
+/* replaces the entries of @index with the ones in @filename, if that is the
+ * index of a stream of @stream_size bytes */
+gboolean
+gst_seek_index_load (GstSeekIndex * index, const gchar * filename,
+    guint64 stream_size, GError ** error)
+{
+  GstSeekIndexEntry entries[BLOCK_ENTRIES];
+  GstByteReader reader;
+  GArray *blocks = NULL;
+  const guint8 *data;
+  gchar *contents;
+  gsize length;
+  guint8 version;
+  guint64 size;
+  guint32 n_blocks, i;
+  guint n_entries = 0;
+
+  if (!g_file_get_contents (filename, &contents, &length, error))
+    return FALSE;
+
+  gst_byte_reader_init (&reader, (const guint8 *) contents, length);
+
+  if (!gst_byte_reader_get_data (&reader, INDEX_MAGIC_LEN, &data) ||
+      memcmp (data, INDEX_MAGIC, INDEX_MAGIC_LEN) != 0 ||
+      !gst_byte_reader_get_uint8 (&reader, &version) ||
+      version != INDEX_VERSION ||
+      !gst_byte_reader_get_uint64_le (&reader, &size) ||
+      !gst_byte_reader_get_uint32_le (&reader, &n_blocks))
+    goto invalid;
+
+  if (size != stream_size)
+    goto wrong_stream;
+
+  /* a block takes at least 24 bytes */
+  if (n_blocks > gst_byte_reader_get_remaining (&reader) / 24)
+    goto invalid;
+
+  blocks = g_array_sized_new (FALSE, FALSE, sizeof (GstSeekIndexBlock),
+      n_blocks);
+  g_array_set_clear_func (blocks, (GDestroyNotify) block_clear);
+
+  for (i = 0; i < n_blocks; i++) {
+    GstSeekIndexBlock block = { {0,}, };
+    GstSeekIndexBlock *b;
+    guint32 n, data_size;
+
+    if (!gst_byte_reader_get_uint64_le (&reader, &block.first.ts) ||
+        !gst_byte_reader_get_uint64_le (&reader, &block.first.offset) ||
+        !gst_byte_reader_get_uint32_le (&reader, &n) ||
+        !gst_byte_reader_get_uint32_le (&reader, &data_size) ||
+        !gst_byte_reader_get_data (&reader, data_size, &data))
+      goto invalid;
+
+    if (n == 0 || n > BLOCK_ENTRIES ||
+        !GST_CLOCK_TIME_IS_VALID (block.first.ts))
+      goto invalid;
+
+    block.n_entries = n;
+    block.data = g_memdup (data, data_size);
+    block.size = block.alloc = data_size;
+    g_array_append_val (blocks, block);
+    b = &g_array_index (blocks, GstSeekIndexBlock, i);
+
+    if (!block_decode (b, entries))
+      goto invalid;
+    b->last = entries[n - 1];
+
+    /* blocks are sorted and don't overlap */
+    if (i > 0 && b->first.ts <= g_array_index (blocks, GstSeekIndexBlock,
+            i - 1).last.ts)
+      goto invalid;
+
+    n_entries += n;
+  }
+
+  if (gst_byte_reader_get_remaining (&reader) != 0)
+    goto invalid;
+
+  g_free (contents);
+
+  g_array_free (index->blocks, TRUE);
+  index->blocks = blocks;
+  index->n_entries = n_entries;
+
+  return TRUE;
+
+  /* ERRORS */
+invalid:
+  {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+        "'%s' is not a valid index file", filename);
+    if (blocks)
+      g_array_free (blocks, TRUE);
+    g_free (contents);
+    return FALSE;
+  }
+wrong_stream:
+  {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+        "'%s' is the index of a stream of %" G_GUINT64_FORMAT " bytes, not %"
+        G_GUINT64_FORMAT, filename, size, stream_size);
+    g_free (contents);
+    return FALSE;
+  }
+}
@@ -0,0 +1,65 @@
+/* GStreamer
+ *
+ * gstseekindex.h: compact time to byte offset index for seeking
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_SEEK_INDEX_H__
+#define __GST_SEEK_INDEX_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* not public API, only used by GstBaseParse for now */
+typedef struct _GstSeekIndex GstSeekIndex;
+
+G_GNUC_INTERNAL
+GstSeekIndex *  gst_seek_index_new      (void);
+G_GNUC_INTERNAL
+void            gst_seek_index_free     (GstSeekIndex * index);
+
+G_GNUC_INTERNAL
+void            gst_seek_index_clear    (GstSeekIndex * index);
+G_GNUC_INTERNAL
+guint           gst_seek_index_get_size (GstSeekIndex * index);
+
+G_GNUC_INTERNAL
+void            gst_seek_index_add      (GstSeekIndex * index,
+                                         GstClockTime   ts,
+                                         guint64        offset);
+G_GNUC_INTERNAL
+gboolean        gst_seek_index_lookup   (GstSeekIndex * index,
+                                         GstClockTime   ts,
+                                         gboolean       before,
+                                         GstClockTime * entry_ts,
+                                         guint64      * entry_offset);
+
+G_GNUC_INTERNAL
+gboolean        gst_seek_index_save     (GstSeekIndex * index,
+                                         const gchar  * filename,
+                                         guint64        stream_size,
+                                         GError      ** error);
+G_GNUC_INTERNAL
+gboolean        gst_seek_index_load     (GstSeekIndex * index,
+                                         const gchar  * filename,
+                                         guint64        stream_size,
+                                         GError      ** error);
+
+G_END_DECLS
+
+#endif /* __GST_SEEK_INDEX_H__ */
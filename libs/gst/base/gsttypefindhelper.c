@@ -41,6 +41,41 @@
 
 #include "gsttypefindhelper.h"
 
+/*
+ * sort_by_prefixes:
+ * @obj: object doing the typefinding, or %NULL (used for logging)
+ * @type_list: (transfer full): the typefind factories to try, in order
+ * @find: a #GstTypeFind set up for the data
+ * @factory: location of the factory that is logged when @find peeks
+ *
+ * Moves the factories with a prefix matching the start of the data to the
+ * head of @type_list, keeping the order of the others. They are the most
+ * probable candidates and the remaining ones are only tried as a fallback.
+ *
+ * Returns: (transfer full): the sorted list
+ */
+static GList *
+sort_by_prefixes (GstObject * obj, GList * type_list, GstTypeFind * find,
+    GstTypeFindFactory ** factory)
+{
+  GList *l, *next, *matches = NULL;
+
+  for (l = type_list; l; l = next) {
+    next = l->next;
+
+    *factory = GST_TYPE_FIND_FACTORY (l->data);
+    if (gst_type_find_factory_match_prefixes (*factory, find)) {
+      GST_LOG_OBJECT (obj, "prefix of %s matches, moving to head",
+          GST_OBJECT_NAME (*factory));
+      type_list = g_list_remove_link (type_list, l);
+      matches = g_list_concat (l, matches);
+    }
+  }
+  *factory = NULL;
+
+  return g_list_concat (g_list_reverse (matches), type_list);
+}
+
 /* ********************** typefinding in pull mode ************************ */
 
 static void
@@ -349,6 +384,8 @@ gst_type_find_helper_get_range (GstObject * obj, GstObject * parent,
     }
   }
 
+  type_list = sort_by_prefixes (obj, type_list, &find, &helper.factory);
+
   for (l = type_list; l; l = l->next) {
     helper.factory = GST_TYPE_FIND_FACTORY (l->data);
     gst_type_find_factory_call_function (helper.factory, &find);
@@ -527,6 +564,7 @@ gst_type_find_helper_for_data (GstObject * obj, const guint8 * data, gsize size,
   find.get_length = NULL;
 
   type_list = gst_type_find_factory_get_list ();
+  type_list = sort_by_prefixes (obj, type_list, &find, &helper.factory);
 
   for (l = type_list; l; l = l->next) {
     helper.factory = GST_TYPE_FIND_FACTORY (l->data);
@@ -548,6 +586,209 @@ gst_type_find_helper_for_data (GstObject * obj, const guint8 * data, gsize size,
   return result;
 }
 
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+  GstObject *obj;
+
+  GstTypeFindFactory **factories;
+  gint n_factories;
+  /* results of each factory */
+  GstTypeFindProbability *probabilities;
+  GstCaps **caps;
+
+  /* index of the next factory to call */
+  gint next;
+  /* lowest index of a factory that returned the maximum probability */
+  gint first_maximum;
+
+  GMutex lock;
+  GCond cond;
+  guint n_workers;
+} GstTypeFindParallelHelper;
+
+static void
+parallel_helper_run (GstTypeFindParallelHelper * ph)
+{
+  gint idx;
+
+  while ((idx = g_atomic_int_add (&ph->next, 1)) < ph->n_factories) {
+    GstTypeFindBufHelper helper;
+    GstTypeFind find;
+    gint first;
+
+    /* a factory that comes first already returned the maximum */
+    if (idx > g_atomic_int_get (&ph->first_maximum))
+      break;
+
+    helper.data = ph->data;
+    helper.size = ph->size;
+    helper.best_probability = GST_TYPE_FIND_NONE;
+    helper.caps = NULL;
+    helper.obj = ph->obj;
+    helper.factory = ph->factories[idx];
+
+    find.data = &helper;
+    find.peek = buf_helper_find_peek;
+    find.suggest = buf_helper_find_suggest;
+    find.get_length = NULL;
+
+    gst_type_find_factory_call_function (helper.factory, &find);
+
+    ph->probabilities[idx] = helper.best_probability;
+    ph->caps[idx] = helper.caps;
+
+    if (helper.best_probability >= GST_TYPE_FIND_MAXIMUM) {
+      do {
+        first = g_atomic_int_get (&ph->first_maximum);
+      } while (idx < first &&
+          !g_atomic_int_compare_and_exchange (&ph->first_maximum, first, idx));
+    }
+  }
+}
+
+static void
+parallel_helper_worker (gpointer user_data)
+{
+  GstTypeFindParallelHelper *ph = user_data;
+
+  parallel_helper_run (ph);
+
+  g_mutex_lock (&ph->lock);
+  ph->n_workers--;
+  g_cond_signal (&ph->cond);
+  g_mutex_unlock (&ph->lock);
+}
+
+/**
+ * gst_type_find_helper_for_data_with_pool:
+ * @obj: (allow-none): object doing the typefinding, or %NULL (used for logging)
+ * @data: (in) (transfer none): a pointer with data to typefind
+ * @size: (in): the size of @data
+ * @pool: a prepared #GstTaskPool to run the typefind functions on
+ * @prob: (out) (allow-none): location to store the probability of the found
+ *     caps, or %NULL
+ *
+ * Like gst_type_find_helper_for_data(), but calls the typefind functions
+ * concurrently from the threads of @pool and the calling thread, using up
+ * to one thread per processor.
+ *
+ * The result is the same as that of gst_type_find_helper_for_data(): the
+ * caps with the highest probability are returned, and of several typefinders
+ * with the same probability the one with the highest rank wins.
+ *
+ * Free-function: gst_caps_unref
+ *
+ * Returns: (transfer full) (nullable): the #GstCaps corresponding to the data,
+ *     or %NULL if no type could be found. The caller should free the caps
+ *     returned with gst_caps_unref().
+ *
+ * Since: 1.14
+ */
+GstCaps *
+gst_type_find_helper_for_data_with_pool (GstObject * obj, const guint8 * data,
+    gsize size, GstTaskPool * pool, GstTypeFindProbability * prob)
+{
+  GstTypeFindParallelHelper ph;
+  GstTypeFindBufHelper helper;
+  GstTypeFind find;
+  GstTypeFindProbability best_probability = GST_TYPE_FIND_NONE;
+  GList *l, *type_list;
+  GstCaps *result = NULL;
+  guint i, n_jobs;
+
+  g_return_val_if_fail (data != NULL, NULL);
+  g_return_val_if_fail (GST_IS_TASK_POOL (pool), NULL);
+
+  if (size == 0)
+    return NULL;
+
+  helper.data = data;
+  helper.size = size;
+  helper.best_probability = GST_TYPE_FIND_NONE;
+  helper.caps = NULL;
+  helper.obj = obj;
+
+  find.data = &helper;
+  find.peek = buf_helper_find_peek;
+  find.suggest = buf_helper_find_suggest;
+  find.get_length = NULL;
+
+  type_list = gst_type_find_factory_get_list ();
+  type_list = sort_by_prefixes (obj, type_list, &find, &helper.factory);
+
+  ph.data = data;
+  ph.size = size;
+  ph.obj = obj;
+  ph.n_factories = g_list_length (type_list);
+  ph.factories = g_new (GstTypeFindFactory *, ph.n_factories);
+  ph.probabilities = g_new0 (GstTypeFindProbability, ph.n_factories);
+  ph.caps = g_new0 (GstCaps *, ph.n_factories);
+  ph.next = 0;
+  ph.first_maximum = G_MAXINT;
+  g_mutex_init (&ph.lock);
+  g_cond_init (&ph.cond);
+  ph.n_workers = 0;
+
+  for (i = 0, l = type_list; l; l = l->next, i++)
+    ph.factories[i] = GST_TYPE_FIND_FACTORY (l->data);
+
+  /* the calling thread works on the factories too */
+  n_jobs = MIN (g_get_num_processors (), ph.n_factories);
+  for (i = 1; i < n_jobs; i++) {
+    GError *err = NULL;
+
+    g_mutex_lock (&ph.lock);
+    ph.n_workers++;
+    g_mutex_unlock (&ph.lock);
+
+    gst_task_pool_push (pool, parallel_helper_worker, &ph, &err);
+    if (err) {
+      GST_WARNING_OBJECT (obj, "failed to push typefind job: %s",
+          err->message);
+      g_error_free (err);
+      g_mutex_lock (&ph.lock);
+      ph.n_workers--;
+      g_mutex_unlock (&ph.lock);
+      break;
+    }
+  }
+
+  parallel_helper_run (&ph);
+
+  g_mutex_lock (&ph.lock);
+  while (ph.n_workers > 0)
+    g_cond_wait (&ph.cond, &ph.lock);
+  g_mutex_unlock (&ph.lock);
+
+  /* the factories are in order of preference, only replace the result with
+   * one of a strictly higher probability */
+  for (i = 0; i < ph.n_factories; i++) {
+    if (ph.probabilities[i] > best_probability) {
+      gst_caps_replace (&result, ph.caps[i]);
+      best_probability = ph.probabilities[i];
+    }
+    if (ph.caps[i])
+      gst_caps_unref (ph.caps[i]);
+  }
+
+  g_mutex_clear (&ph.lock);
+  g_cond_clear (&ph.cond);
+  g_free (ph.factories);
+  g_free (ph.probabilities);
+  g_free (ph.caps);
+  gst_plugin_feature_list_free (type_list);
+
+  if (prob)
+    *prob = best_probability;
+
+  GST_LOG_OBJECT (obj, "Returning %" GST_PTR_FORMAT " (probability = %u)",
+      result, (guint) best_probability);
+
+  return result;
+}
+
 /**
  * gst_type_find_helper_for_buffer:
  * @obj: (allow-none): object doing the typefinding, or %NULL (used for logging)
@@ -37,6 +37,12 @@ GstCaps * gst_type_find_helper_for_data   (GstObject              *obj,
                                            gsize                   size,
                                            GstTypeFindProbability *prob);
 GST_EXPORT
+GstCaps * gst_type_find_helper_for_data_with_pool (GstObject              *obj,
+                                                   const guint8           *data,
+                                                   gsize                   size,
+                                                   GstTaskPool            *pool,
+                                                   GstTypeFindProbability *prob);
+GST_EXPORT
 GstCaps * gst_type_find_helper_for_buffer (GstObject              *obj,
                                            GstBuffer              *buf,
                                            GstTypeFindProbability *prob);
@@ -1246,6 +1246,137 @@ gst_check_object_destroyed_on_unref (gpointer object_to_unref)
   gst_check_objects_destroyed_on_unref (object_to_unref, NULL, NULL);
 }
 
+/* allocation counting, with a tracer that is notified of every new mini
+ * object. GstMemory is a mini object too, so this also counts memory
+ * allocations */
+static GMutex alloc_lock;
+static gboolean alloc_counting;
+/* GType => number of allocations while counting */
+static GHashTable *alloc_counts;
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+typedef GstTracer GstCheckAllocTracer;
+typedef GstTracerClass GstCheckAllocTracerClass;
+
+static GType gst_check_alloc_tracer_get_type (void);
+G_DEFINE_TYPE (GstCheckAllocTracer, gst_check_alloc_tracer, GST_TYPE_TRACER);
+
+static void
+do_mini_object_created (GstTracer * tracer, GstClockTime ts,
+    GstMiniObject * object)
+{
+  gpointer key = GSIZE_TO_POINTER (GST_MINI_OBJECT_TYPE (object));
+
+  g_mutex_lock (&alloc_lock);
+  if (alloc_counting) {
+    g_hash_table_insert (alloc_counts, key,
+        GUINT_TO_POINTER (GPOINTER_TO_UINT (g_hash_table_lookup (alloc_counts,
+                    key)) + 1));
+  }
+  g_mutex_unlock (&alloc_lock);
+}
+
+static void
+gst_check_alloc_tracer_class_init (GstCheckAllocTracerClass * klass)
+{
+}
+
+static void
+gst_check_alloc_tracer_init (GstCheckAllocTracer * self)
+{
+  gst_tracing_register_hook (self, "mini-object-created",
+      G_CALLBACK (do_mini_object_created));
+}
+#endif
+
+/**
+ * gst_check_allocations_start:
+ *
+ * Starts counting the mini objects, like #GstBuffer, #GstMemory and
+ * #GstEvent, that are created in any thread. The counts of a previous call
+ * are cleared.
+ *
+ * The counting uses the tracer hooks, when they are disabled in the build
+ * nothing can be counted and %FALSE is returned.
+ *
+ * Returns: %TRUE if allocations are counted.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_check_allocations_start (void)
+{
+#ifdef GST_DISABLE_GST_TRACER_HOOKS
+  return FALSE;
+#else
+  static gsize tracer = 0;
+
+  if (g_once_init_enter (&tracer)) {
+    /* the tracer is owned by the tracing subsystem from now on */
+    GstTracer *t = g_object_new (gst_check_alloc_tracer_get_type (), NULL);
+
+    g_once_init_leave (&tracer, (gsize) t);
+  }
+
+  g_mutex_lock (&alloc_lock);
+  if (alloc_counts)
+    g_hash_table_remove_all (alloc_counts);
+  else
+    alloc_counts = g_hash_table_new (NULL, NULL);
+  alloc_counting = TRUE;
+  g_mutex_unlock (&alloc_lock);
+
+  return TRUE;
+#endif
+}
+
+/**
+ * gst_check_allocations_stop:
+ *
+ * Stops counting allocations, the counts stay available with
+ * gst_check_allocations_get() until the next gst_check_allocations_start().
+ *
+ * Since: 1.14
+ */
+void
+gst_check_allocations_stop (void)
+{
+  g_mutex_lock (&alloc_lock);
+  alloc_counting = FALSE;
+  g_mutex_unlock (&alloc_lock);
+}
+
+/**
+ * gst_check_allocations_get:
+ * @type: the #GType of mini objects to count, or %G_TYPE_NONE for all
+ *
+ * Get the number of mini objects of @type that were created since
+ * gst_check_allocations_start().
+ *
+ * Returns: the number of allocations
+ *
+ * Since: 1.14
+ */
+guint
+gst_check_allocations_get (GType type)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  guint res = 0;
+
+  g_mutex_lock (&alloc_lock);
+  if (alloc_counts) {
+    g_hash_table_iter_init (&iter, alloc_counts);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+      if (type == G_TYPE_NONE || (GType) GPOINTER_TO_SIZE (key) == type)
+        res += GPOINTER_TO_UINT (value);
+    }
+  }
+  g_mutex_unlock (&alloc_lock);
+
+  return res;
+}
+
 /* For ABI compatibility with GStreamer < 1.5 */
 /* *INDENT-OFF* */
 void
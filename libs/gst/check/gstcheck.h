@@ -193,6 +193,35 @@ void gst_check_objects_destroyed_on_unref (gpointer object_to_unref, gpointer fi
 GST_EXPORT
 void gst_check_object_destroyed_on_unref (gpointer object_to_unref);
 
+GST_EXPORT
+gboolean gst_check_allocations_start (void);
+
+GST_EXPORT
+void gst_check_allocations_stop (void);
+
+GST_EXPORT
+guint gst_check_allocations_get (GType type);
+
+/**
+ * fail_unless_allocations_per_buffer:
+ * @h: a #GstHarness
+ * @buffer: the #GstBuffer to push
+ * @expected: the expected number of mini object allocations per buffer
+ *
+ * Pushes @buffer through @h a number of times and fails if the element did
+ * not allocate exactly @expected mini objects, like buffers, memories or
+ * events, for each buffer. See gst_harness_allocations_per_buffer().
+ *
+ * Since: 1.14
+ */
+#define fail_unless_allocations_per_buffer(h, buffer, expected)         \
+G_STMT_START {                                                          \
+  gdouble __allocs = gst_harness_allocations_per_buffer (h, buffer, 10); \
+  fail_unless (__allocs < 0 || __allocs == (expected),                  \
+    "'%lf' allocations per buffer, expected '%d'", __allocs,            \
+    (gint) (expected));                                                 \
+} G_STMT_END
+
 #define fail_unless_message_error(msg, domain, code)            \
 gst_check_message_error (msg, GST_MESSAGE_ERROR,                \
   GST_ ## domain ## _ERROR, GST_ ## domain ## _ERROR_ ## code)
@@ -126,6 +126,7 @@
 #endif
 
 #include "gstharness.h"
+#include "gstcheck.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -138,6 +139,19 @@ static void gst_harness_stress_free (GstHarnessThread * t);
 #define HARNESS_LOCK(h) g_mutex_lock (&(h)->priv->priv_mutex)
 #define HARNESS_UNLOCK(h) g_mutex_unlock (&(h)->priv->priv_mutex)
 
+/* the reference of the timestamps that the load threads put on the buffers */
+static GstStaticCaps load_ts_caps =
+GST_STATIC_CAPS ("timestamp/x-gst-harness-load");
+
+/* at most this many latency samples are kept for the percentiles */
+#define MAX_LATENCY_SAMPLES 4096
+
+typedef struct
+{
+  GArray *values;
+  guint next;
+} GstHarnessSamples;
+
 static GstStaticPadTemplate hsrctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
@@ -185,8 +199,109 @@ struct _GstHarnessPrivate
   GMutex priv_mutex;
 
   GPtrArray *stress;
+
+  /* latency of the buffers of the load threads */
+  GMutex load_mutex;
+  GstHarnessSamples latencies;
+  guint64 load_buffers;
+  GstClockTime first_load_ts;
+  GstClockTime last_load_ts;
 };
 
+static void
+gst_harness_samples_init (GstHarnessSamples * samples)
+{
+  samples->values = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  samples->next = 0;
+}
+
+static void
+gst_harness_samples_clear (GstHarnessSamples * samples)
+{
+  g_array_free (samples->values, TRUE);
+  samples->values = NULL;
+}
+
+static void
+gst_harness_samples_add (GstHarnessSamples * samples, GstClockTime value)
+{
+  /* keep the most recent samples */
+  if (samples->values->len < MAX_LATENCY_SAMPLES) {
+    g_array_append_val (samples->values, value);
+  } else {
+    g_array_index (samples->values, GstClockTime, samples->next) = value;
+    samples->next = (samples->next + 1) % MAX_LATENCY_SAMPLES;
+  }
+}
+
+static gint
+gst_harness_compare_time (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a;
+  GstClockTime tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : ta > tb ? 1 : 0;
+}
+
+/* set @prefix-min, @prefix-p50, @prefix-p90, @prefix-p99 and @prefix-max
+ * in @s, all are 0 without samples */
+static void
+gst_harness_samples_set_percentiles (GstHarnessSamples * samples,
+    GstStructure * s, const gchar * prefix)
+{
+  static const guint percentiles[] = { 0, 50, 90, 99, 100 };
+  static const gchar *names[] = { "min", "p50", "p90", "p99", "max" };
+  GArray *sorted;
+  guint i;
+
+  sorted = g_array_sized_new (FALSE, FALSE, sizeof (GstClockTime),
+      samples->values->len);
+  g_array_append_vals (sorted, samples->values->data, samples->values->len);
+  g_array_sort (sorted, gst_harness_compare_time);
+
+  for (i = 0; i < G_N_ELEMENTS (percentiles); i++) {
+    GstClockTime value = 0;
+    gchar *name;
+
+    if (sorted->len > 0) {
+      /* nearest rank */
+      guint idx = (percentiles[i] * sorted->len + 99) / 100;
+
+      value = g_array_index (sorted, GstClockTime, idx > 0 ? idx - 1 : 0);
+    }
+
+    name = g_strdup_printf ("%s-%s", prefix, names[i]);
+    gst_structure_set (s, name, G_TYPE_UINT64, value, NULL);
+    g_free (name);
+  }
+
+  g_array_free (sorted, TRUE);
+}
+
+static void
+gst_harness_track_latency (GstHarness * h, GstBuffer * buffer)
+{
+  GstHarnessPrivate *priv = h->priv;
+  GstReferenceTimestampMeta *meta;
+  GstCaps *caps;
+
+  caps = gst_static_caps_get (&load_ts_caps);
+  meta = gst_buffer_get_reference_timestamp_meta (buffer, caps);
+  gst_caps_unref (caps);
+
+  if (meta != NULL) {
+    GstClockTime now = gst_util_get_timestamp ();
+
+    g_mutex_lock (&priv->load_mutex);
+    gst_harness_samples_add (&priv->latencies, now - meta->timestamp);
+    if (priv->load_buffers == 0)
+      priv->first_load_ts = now;
+    priv->last_load_ts = now;
+    priv->load_buffers++;
+    g_mutex_unlock (&priv->load_mutex);
+  }
+}
+
 static GstFlowReturn
 gst_harness_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
@@ -194,6 +309,9 @@ gst_harness_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GstHarnessPrivate *priv = h->priv;
   (void) parent;
   g_assert (h != NULL);
+
+  gst_harness_track_latency (h, buffer);
+
   g_mutex_lock (&priv->blocking_push_mutex);
   g_atomic_int_inc (&priv->recv_buffers);
 
@@ -650,6 +768,8 @@ gst_harness_new_empty (void)
   g_mutex_init (&priv->blocking_push_mutex);
   g_cond_init (&priv->blocking_push_cond);
   g_mutex_init (&priv->priv_mutex);
+  g_mutex_init (&priv->load_mutex);
+  gst_harness_samples_init (&priv->latencies);
 
   priv->stress = g_ptr_array_new_with_free_func (
       (GDestroyNotify) gst_harness_stress_free);
@@ -1069,6 +1189,9 @@ gst_harness_teardown (GstHarness * h)
 
   g_ptr_array_unref (priv->stress);
 
+  g_mutex_clear (&priv->load_mutex);
+  gst_harness_samples_clear (&priv->latencies);
+
   gst_object_unref (h->element);
 
   gst_object_replace ((GstObject **) & priv->testclock, NULL);
@@ -1662,6 +1785,58 @@ gst_harness_push_and_pull (GstHarness * h, GstBuffer * buffer)
   return gst_harness_pull (h);
 }
 
+static void
+gst_harness_push_and_drop (GstHarness * h, GstBuffer * buffer)
+{
+  GstBuffer *out;
+
+  gst_harness_push (h, gst_buffer_ref (buffer));
+  while ((out = gst_harness_try_pull (h)))
+    gst_buffer_unref (out);
+}
+
+/**
+ * gst_harness_allocations_per_buffer:
+ * @h: a #GstHarness
+ * @buffer: (transfer none): a #GstBuffer to push
+ * @n_buffers: the number of times to push @buffer
+ *
+ * Pushes @buffer @n_buffers times and counts the mini objects, like
+ * #GstBuffer, #GstMemory and #GstEvent, that are created meanwhile in any
+ * thread. @buffer is pushed once more before counting so that things that
+ * happen only once, like allocating a pool, are not counted.
+ *
+ * The output buffers are pulled and freed after every push, so this is
+ * meant for elements that output their buffers from the pushing thread.
+ * Use it with fail_unless_allocations_per_buffer() to test that elements
+ * do not copy or allocate buffers.
+ *
+ * MT safe.
+ *
+ * Returns: the number of allocations per pushed buffer, or -1 if
+ * allocations can not be counted because the tracer hooks are disabled.
+ *
+ * Since: 1.14
+ */
+gdouble
+gst_harness_allocations_per_buffer (GstHarness * h, GstBuffer * buffer,
+    guint n_buffers)
+{
+  guint i;
+
+  g_return_val_if_fail (n_buffers > 0, -1);
+
+  gst_harness_push_and_drop (h, buffer);
+
+  if (!gst_check_allocations_start ())
+    return -1;
+  for (i = 0; i < n_buffers; i++)
+    gst_harness_push_and_drop (h, buffer);
+  gst_check_allocations_stop ();
+
+  return (gdouble) gst_check_allocations_get (G_TYPE_NONE) / n_buffers;
+}
+
 /**
  * gst_harness_buffers_received:
  * @h: a #GstHarness
@@ -2597,6 +2772,30 @@ typedef struct
   GSList *pads;
 } GstHarnessReqPadThread;
 
+typedef struct
+{
+  GstHarnessThread t;
+
+  GstCaps *caps;
+  GstSegment segment;
+  GstHarnessPrepareBufferFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+
+  guint rate;
+  guint list_size;
+  guint caps_interval;
+
+  /* statistics, protected by the lock */
+  GMutex lock;
+  guint64 buffers;
+  guint64 bytes;
+  guint64 pushes;
+  GstClockTime start;
+  GstClockTime stop;
+  GstHarnessSamples push_latencies;
+} GstHarnessLoadThread;
+
 static void
 gst_harness_thread_init (GstHarnessThread * t, GDestroyNotify freefunc,
     GstHarness * h, gulong sleep)
@@ -2651,6 +2850,19 @@ gst_harness_property_thread_free (GstHarnessPropThread * t)
   }
 }
 
+static void
+gst_harness_load_thread_free (GstHarnessLoadThread * t)
+{
+  if (t != NULL) {
+    gst_caps_replace (&t->caps, NULL);
+    if (t->notify != NULL)
+      t->notify (t->data);
+    g_mutex_clear (&t->lock);
+    gst_harness_samples_clear (&t->push_latencies);
+    g_slice_free (GstHarnessLoadThread, t);
+  }
+}
+
 static void
 gst_harness_requestpad_release (GstPad * pad, GstElement * element)
 {
@@ -2772,11 +2984,10 @@ gst_harness_stress_statechange_func (GstHarnessThread * t)
   return GUINT_TO_POINTER (count);
 }
 
-static gpointer
-gst_harness_stress_buffer_func (GstHarnessThread * t)
+static void
+gst_harness_stress_push_sticky_events (GstHarnessThread * t, GstCaps * caps,
+    const GstSegment * segment)
 {
-  GstHarnessPushBufferThread *pt = (GstHarnessPushBufferThread *) t;
-  guint count = 0;
   gchar *sid;
   gboolean handled;
 
@@ -2785,11 +2996,19 @@ gst_harness_stress_buffer_func (GstHarnessThread * t)
   handled = gst_pad_push_event (t->h->srcpad, gst_event_new_stream_start (sid));
   g_assert (handled);
   g_free (sid);
-  handled = gst_pad_push_event (t->h->srcpad, gst_event_new_caps (pt->caps));
+  handled = gst_pad_push_event (t->h->srcpad, gst_event_new_caps (caps));
   g_assert (handled);
-  handled = gst_pad_push_event (t->h->srcpad,
-      gst_event_new_segment (&pt->segment));
+  handled = gst_pad_push_event (t->h->srcpad, gst_event_new_segment (segment));
   g_assert (handled);
+}
+
+static gpointer
+gst_harness_stress_buffer_func (GstHarnessThread * t)
+{
+  GstHarnessPushBufferThread *pt = (GstHarnessPushBufferThread *) t;
+  guint count = 0;
+
+  gst_harness_stress_push_sticky_events (t, pt->caps, &pt->segment);
 
   while (t->running) {
     gst_harness_push (t->h, pt->func (t->h, pt->data));
@@ -2800,6 +3019,115 @@ gst_harness_stress_buffer_func (GstHarnessThread * t)
   return GUINT_TO_POINTER (count);
 }
 
+static GstBuffer *
+gst_harness_stress_load_prepare (GstHarnessLoadThread * lt, GstCaps * ts_caps)
+{
+  GstBuffer *buf = lt->func (lt->t.h, lt->data);
+
+  /* the timestamp is set right before pushing */
+  buf = gst_buffer_make_writable (buf);
+  gst_buffer_add_reference_timestamp_meta (buf, ts_caps, GST_CLOCK_TIME_NONE,
+      GST_CLOCK_TIME_NONE);
+
+  return buf;
+}
+
+static void
+gst_harness_stress_load_stamp (GstBuffer * buf, GstCaps * ts_caps,
+    GstClockTime ts)
+{
+  GstReferenceTimestampMeta *meta;
+
+  meta = gst_buffer_get_reference_timestamp_meta (buf, ts_caps);
+  meta->timestamp = ts;
+}
+
+static gpointer
+gst_harness_stress_load_func (GstHarnessThread * t)
+{
+  GstHarnessLoadThread *lt = (GstHarnessLoadThread *) t;
+  GstCaps *ts_caps = gst_static_caps_get (&load_ts_caps);
+  guint n_buffers = MAX (lt->list_size, 1);
+  guint64 total = 0;
+  guint count = 0;
+  GstClockTime start;
+
+  gst_harness_stress_push_sticky_events (t, lt->caps, &lt->segment);
+
+  start = gst_util_get_timestamp ();
+  g_mutex_lock (&lt->lock);
+  lt->start = lt->stop = start;
+  g_mutex_unlock (&lt->lock);
+
+  while (t->running) {
+    GstBufferList *list = NULL;
+    GstBuffer *buf = NULL;
+    GstClockTime ts, now;
+    gsize bytes = 0;
+    guint i;
+
+    if (lt->caps_interval > 0 && count > 0 && count % lt->caps_interval == 0) {
+      gboolean handled;
+
+      handled = gst_pad_push_event (t->h->srcpad,
+          gst_event_new_caps (lt->caps));
+      g_assert (handled);
+    }
+
+    if (lt->list_size > 0) {
+      list = gst_buffer_list_new_sized (n_buffers);
+      for (i = 0; i < n_buffers; i++) {
+        buf = gst_harness_stress_load_prepare (lt, ts_caps);
+        bytes += gst_buffer_get_size (buf);
+        gst_buffer_list_add (list, buf);
+      }
+    } else {
+      buf = gst_harness_stress_load_prepare (lt, ts_caps);
+      bytes = gst_buffer_get_size (buf);
+    }
+
+    ts = gst_util_get_timestamp ();
+    if (list != NULL) {
+      for (i = 0; i < n_buffers; i++)
+        gst_harness_stress_load_stamp (gst_buffer_list_get (list, i), ts_caps,
+            ts);
+      gst_pad_push_list (t->h->srcpad, list);
+    } else {
+      gst_harness_stress_load_stamp (buf, ts_caps, ts);
+      gst_harness_push (t->h, buf);
+    }
+    now = gst_util_get_timestamp ();
+
+    g_mutex_lock (&lt->lock);
+    lt->buffers += n_buffers;
+    lt->bytes += bytes;
+    lt->pushes++;
+    lt->stop = now;
+    gst_harness_samples_add (&lt->push_latencies, now - ts);
+    g_mutex_unlock (&lt->lock);
+
+    count++;
+    total += n_buffers;
+
+    /* sleep until the time of the next push at the requested rate, this
+     * also makes up for pushes that took longer */
+    if (lt->rate > 0) {
+      GstClockTime next = start + gst_util_uint64_scale (total, GST_SECOND,
+          lt->rate);
+
+      now = gst_util_get_timestamp ();
+      if (next > now)
+        g_usleep ((next - now) / GST_USECOND);
+    } else {
+      g_thread_yield ();
+    }
+  }
+
+  gst_caps_unref (ts_caps);
+
+  return GUINT_TO_POINTER (count);
+}
+
 static gpointer
 gst_harness_stress_event_func (GstHarnessThread * t)
 {
@@ -3228,3 +3556,161 @@ gst_harness_stress_requestpad_start_full (GstHarness * h,
   GST_HARNESS_THREAD_START (requestpad, t);
   return &t->t;
 }
+
+/**
+ * gst_harness_stress_push_load_start_full: (skip)
+ * @h: a #GstHarness
+ * @caps: a #GstCaps for the #GstBuffer
+ * @segment: a #GstSegment
+ * @func: a #GstHarnessPrepareBufferFunc function called to prepare / create
+ * every #GstBuffer for pushing
+ * @data: a #gpointer with data to the #GstHarnessPrepareBufferFunc function
+ * @notify: a #GDestroyNotify that is called when thread is stopped
+ * @rate: the number of buffers to push per second, 0 to push as fast as
+ * possible
+ * @list_size: the number of buffers to push together in a #GstBufferList,
+ * 0 to push the buffers one by one
+ * @caps_interval: push the caps event again after every @caps_interval
+ * pushes, 0 to only push it once
+ *
+ * Start a producer thread that pushes the buffers returned by @func at @rate
+ * buffers per second and collects statistics about it. Several producers
+ * can push into the same #GstHarness or into several harnesses around the
+ * same element, such as the request pads of a funnel, to generate a
+ * concurrent load. Other stress threads, like the ones of
+ * gst_harness_stress_push_event_start(), can be started next to them to
+ * interleave events.
+ *
+ * The buffers get a #GstReferenceTimestampMeta with the time they were
+ * pushed so that the harness that receives them can measure their latency
+ * through the element, see gst_harness_get_load_stats().
+ * gst_harness_stress_thread_get_stats() gives the throughput of the
+ * producer and the time the pushes took.
+ *
+ * MT safe.
+ *
+ * Returns: a #GstHarnessThread
+ *
+ * Since: 1.14
+ */
+GstHarnessThread *
+gst_harness_stress_push_load_start_full (GstHarness * h,
+    GstCaps * caps, const GstSegment * segment,
+    GstHarnessPrepareBufferFunc func, gpointer data, GDestroyNotify notify,
+    guint rate, guint list_size, guint caps_interval)
+{
+  GstHarnessLoadThread *t = g_slice_new0 (GstHarnessLoadThread);
+  gst_harness_thread_init (&t->t,
+      (GDestroyNotify) gst_harness_load_thread_free, h, 0);
+
+  gst_caps_replace (&t->caps, caps);
+  t->segment = *segment;
+  t->func = func;
+  t->data = data;
+  t->notify = notify;
+  t->rate = rate;
+  t->list_size = list_size;
+  t->caps_interval = caps_interval;
+
+  g_mutex_init (&t->lock);
+  gst_harness_samples_init (&t->push_latencies);
+
+  GST_HARNESS_THREAD_START (load, t);
+  return &t->t;
+}
+
+/**
+ * gst_harness_stress_thread_get_stats:
+ * @t: a #GstHarnessThread started with
+ * gst_harness_stress_push_load_start_full()
+ *
+ * Get the statistics of the load thread @t so far. This has to be called
+ * before stopping the thread with gst_harness_stress_thread_stop().
+ *
+ * The #GstStructure has the number of "buffers" and "bytes" that were
+ * pushed, the number of "pushes", the "duration" of the pushing in
+ * nanoseconds and the resulting "buffers-per-second" and
+ * "bytes-per-second" as #gdouble. The "push-latency-min",
+ * "push-latency-p50", "push-latency-p90", "push-latency-p99" and
+ * "push-latency-max" fields are the nanoseconds the recent pushes took,
+ * which shows how much the element blocked the producer. All integer fields
+ * are #guint64.
+ *
+ * MT safe.
+ *
+ * Returns: (transfer full): a #GstStructure with the statistics, free
+ * with gst_structure_free()
+ *
+ * Since: 1.14
+ */
+GstStructure *
+gst_harness_stress_thread_get_stats (GstHarnessThread * t)
+{
+  GstHarnessLoadThread *lt = (GstHarnessLoadThread *) t;
+  GstStructure *s;
+  gdouble duration;
+
+  g_return_val_if_fail (t != NULL, NULL);
+  g_return_val_if_fail (t->freefunc ==
+      (GDestroyNotify) gst_harness_load_thread_free, NULL);
+
+  g_mutex_lock (&lt->lock);
+  duration = (gdouble) (lt->stop - lt->start) / GST_SECOND;
+  s = gst_structure_new ("stress-stats",
+      "buffers", G_TYPE_UINT64, lt->buffers,
+      "bytes", G_TYPE_UINT64, lt->bytes,
+      "pushes", G_TYPE_UINT64, lt->pushes,
+      "duration", G_TYPE_UINT64, lt->stop - lt->start,
+      "buffers-per-second", G_TYPE_DOUBLE,
+      duration > 0.0 ? lt->buffers / duration : 0.0,
+      "bytes-per-second", G_TYPE_DOUBLE,
+      duration > 0.0 ? lt->bytes / duration : 0.0, NULL);
+  gst_harness_samples_set_percentiles (&lt->push_latencies, s,
+      "push-latency");
+  g_mutex_unlock (&lt->lock);
+
+  return s;
+}
+
+/**
+ * gst_harness_get_load_stats:
+ * @h: a #GstHarness
+ *
+ * Get the statistics of the buffers pushed by the load threads of
+ * gst_harness_stress_push_load_start_full() that @h received from its
+ * element, from any harness around the element.
+ *
+ * The #GstStructure has the "element" name, the number of "buffers" that
+ * were received and the rate at which they were received as
+ * "buffers-per-second" #gdouble. The "latency-min", "latency-p50",
+ * "latency-p90", "latency-p99" and "latency-max" fields are the
+ * nanoseconds between pushing the recent buffers and receiving them. All
+ * integer fields are #guint64.
+ *
+ * MT safe.
+ *
+ * Returns: (transfer full): a #GstStructure with the statistics, free
+ * with gst_structure_free()
+ *
+ * Since: 1.14
+ */
+GstStructure *
+gst_harness_get_load_stats (GstHarness * h)
+{
+  GstHarnessPrivate *priv = h->priv;
+  GstStructure *s;
+  gdouble duration;
+
+  g_mutex_lock (&priv->load_mutex);
+  duration = priv->load_buffers > 1 ?
+      (gdouble) (priv->last_load_ts - priv->first_load_ts) / GST_SECOND : 0.0;
+  s = gst_structure_new ("load-stats",
+      "element", G_TYPE_STRING, GST_OBJECT_NAME (h->element),
+      "buffers", G_TYPE_UINT64, priv->load_buffers,
+      "buffers-per-second", G_TYPE_DOUBLE,
+      duration > 0.0 ? (priv->load_buffers - 1) / duration : 0.0, NULL);
+  gst_harness_samples_set_percentiles (&priv->latencies, s, "latency");
+  g_mutex_unlock (&priv->load_mutex);
+
+  return s;
+}
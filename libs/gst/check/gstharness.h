@@ -190,6 +190,11 @@ GstBuffer *    gst_harness_try_pull (GstHarness * h);
 GST_EXPORT
 GstBuffer *    gst_harness_push_and_pull (GstHarness * h, GstBuffer * buffer);
 
+GST_EXPORT
+gdouble        gst_harness_allocations_per_buffer (GstHarness * h,
+                                                   GstBuffer  * buffer,
+                                                   guint        n_buffers);
+
 GST_EXPORT
 guint          gst_harness_buffers_received (GstHarness * h);
 
@@ -382,6 +387,26 @@ GstHarnessThread * gst_harness_stress_push_buffer_with_cb_start_full (GstHarness
                                                                       GDestroyNotify notify,
                                                                       gulong         sleep);
 
+#define gst_harness_stress_push_load_start(h, c, s, f, d, n, r)               \
+  gst_harness_stress_push_load_start_full (h, c, s, f, d, n, r, 0, 0)
+
+GST_EXPORT
+GstHarnessThread * gst_harness_stress_push_load_start_full (GstHarness   * h,
+                                                            GstCaps      * caps,
+                                                            const GstSegment * segment,
+                                                            GstHarnessPrepareBufferFunc func,
+                                                            gpointer       data,
+                                                            GDestroyNotify notify,
+                                                            guint          rate,
+                                                            guint          list_size,
+                                                            guint          caps_interval);
+
+GST_EXPORT
+GstStructure *     gst_harness_stress_thread_get_stats (GstHarnessThread * t);
+
+GST_EXPORT
+GstStructure *     gst_harness_get_load_stats (GstHarness * h);
+
 #define gst_harness_stress_push_event_start(h, e)                              \
   gst_harness_stress_push_event_start_full (h, e, 0)
 
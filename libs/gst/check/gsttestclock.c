@@ -192,6 +192,10 @@ struct _GstClockEntryContext
 {
   GstClockEntry *clock_entry;
   GstClockTimeDiff time_diff;
+  /* insertion order, keeps entries with the same time in order */
+  guint64 seqnum;
+  /* position in the entry heap */
+  guint index;
 };
 
 struct _GstTestClockPrivate
@@ -199,7 +203,11 @@ struct _GstTestClockPrivate
   GstClockType clock_type;
   GstClockTime start_time;
   GstClockTime internal_time;
-  GList *entry_contexts;
+  /* binary min-heap of GstClockEntryContext ordered by time and seqnum,
+   * with a table from GstClockEntry to its context for the lookups */
+  GPtrArray *entry_heap;
+  GHashTable *entry_table;
+  guint64 next_seqnum;
   GCond entry_added_cond;
   GCond entry_processed_cond;
 };
@@ -309,6 +317,8 @@ gst_test_clock_init (GstTestClock * test_clock)
 
   priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
 
+  priv->entry_heap = g_ptr_array_new ();
+  priv->entry_table = g_hash_table_new (NULL, NULL);
   g_cond_init (&priv->entry_added_cond);
   g_cond_init (&priv->entry_processed_cond);
   priv->clock_type = DEFAULT_CLOCK_TYPE;
@@ -339,8 +349,8 @@ gst_test_clock_dispose (GObject * object)
 
   GST_OBJECT_LOCK (test_clock);
 
-  while (priv->entry_contexts != NULL) {
-    GstClockEntryContext *ctx = priv->entry_contexts->data;
+  while (priv->entry_heap->len > 0) {
+    GstClockEntryContext *ctx = g_ptr_array_index (priv->entry_heap, 0);
     gst_test_clock_remove_entry (test_clock, ctx->clock_entry);
   }
 
@@ -355,6 +365,8 @@ gst_test_clock_finalize (GObject * object)
   GstTestClock *test_clock = GST_TEST_CLOCK (object);
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
 
+  g_ptr_array_unref (priv->entry_heap);
+  g_hash_table_unref (priv->entry_table);
   g_cond_clear (&priv->entry_added_cond);
   g_cond_clear (&priv->entry_processed_cond);
 
@@ -522,11 +534,10 @@ gst_test_clock_peek_next_pending_id_unlocked (GstTestClock * test_clock,
     GstClockID * pending_id)
 {
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
-  GList *imminent_clock_id = g_list_first (priv->entry_contexts);
   gboolean result = FALSE;
 
-  if (imminent_clock_id != NULL) {
-    GstClockEntryContext *ctx = imminent_clock_id->data;
+  if (priv->entry_heap->len > 0) {
+    GstClockEntryContext *ctx = g_ptr_array_index (priv->entry_heap, 0);
 
     if (pending_id != NULL) {
       *pending_id = gst_clock_id_ref (ctx->clock_entry);
@@ -543,7 +554,63 @@ gst_test_clock_peek_id_count_unlocked (GstTestClock * test_clock)
 {
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
 
-  return g_list_length (priv->entry_contexts);
+  return priv->entry_heap->len;
+}
+
+static gboolean
+gst_clock_entry_context_is_before (const GstClockEntryContext * a,
+    const GstClockEntryContext * b)
+{
+  gint res = gst_clock_entry_context_compare_func (a, b);
+
+  return res < 0 || (res == 0 && a->seqnum < b->seqnum);
+}
+
+static void
+gst_test_clock_heap_set (GstTestClock * test_clock, guint index,
+    GstClockEntryContext * ctx)
+{
+  GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
+
+  g_ptr_array_index (priv->entry_heap, index) = ctx;
+  ctx->index = index;
+}
+
+/* move the context at @index to its place in the heap */
+static void
+gst_test_clock_heap_update (GstTestClock * test_clock, guint index)
+{
+  GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
+  GPtrArray *heap = priv->entry_heap;
+  GstClockEntryContext *ctx = g_ptr_array_index (heap, index);
+
+  while (index > 0) {
+    guint parent = (index - 1) / 2;
+    GstClockEntryContext *p = g_ptr_array_index (heap, parent);
+
+    if (!gst_clock_entry_context_is_before (ctx, p))
+      break;
+    gst_test_clock_heap_set (test_clock, index, p);
+    index = parent;
+  }
+
+  while (2 * index + 1 < heap->len) {
+    guint child = 2 * index + 1;
+    GstClockEntryContext *c = g_ptr_array_index (heap, child);
+
+    if (child + 1 < heap->len &&
+        gst_clock_entry_context_is_before (g_ptr_array_index (heap,
+                child + 1), c)) {
+      child++;
+      c = g_ptr_array_index (heap, child);
+    }
+    if (!gst_clock_entry_context_is_before (c, ctx))
+      break;
+    gst_test_clock_heap_set (test_clock, index, c);
+    index = child;
+  }
+
+  gst_test_clock_heap_set (test_clock, index, ctx);
 }
 
 static void
@@ -562,9 +629,11 @@ gst_test_clock_add_entry (GstTestClock * test_clock,
   ctx = g_slice_new (GstClockEntryContext);
   ctx->clock_entry = GST_CLOCK_ENTRY (gst_clock_id_ref (entry));
   ctx->time_diff = GST_CLOCK_DIFF (now, GST_CLOCK_ENTRY_TIME (entry));
+  ctx->seqnum = priv->next_seqnum++;
 
-  priv->entry_contexts = g_list_insert_sorted (priv->entry_contexts, ctx,
-      gst_clock_entry_context_compare_func);
+  g_hash_table_insert (priv->entry_table, entry, ctx);
+  g_ptr_array_add (priv->entry_heap, ctx);
+  gst_test_clock_heap_update (test_clock, priv->entry_heap->len - 1);
 
   g_cond_broadcast (&priv->entry_added_cond);
 }
@@ -577,8 +646,19 @@ gst_test_clock_remove_entry (GstTestClock * test_clock, GstClockEntry * entry)
 
   ctx = gst_test_clock_lookup_entry_context (test_clock, entry);
   if (ctx != NULL) {
+    GstClockEntryContext *last;
+
+    g_hash_table_remove (priv->entry_table, entry);
+
+    /* put the last context in the hole and restore the heap order */
+    last = g_ptr_array_remove_index (priv->entry_heap,
+        priv->entry_heap->len - 1);
+    if (last != ctx) {
+      gst_test_clock_heap_set (test_clock, ctx->index, last);
+      gst_test_clock_heap_update (test_clock, last->index);
+    }
+
     gst_clock_id_unref (ctx->clock_entry);
-    priv->entry_contexts = g_list_remove (priv->entry_contexts, ctx);
     g_slice_free (GstClockEntryContext, ctx);
 
     g_cond_broadcast (&priv->entry_processed_cond);
@@ -590,19 +670,8 @@ gst_test_clock_lookup_entry_context (GstTestClock * test_clock,
     GstClockEntry * clock_entry)
 {
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
-  GstClockEntryContext *result = NULL;
-  GList *cur;
-
-  for (cur = priv->entry_contexts; cur != NULL; cur = cur->next) {
-    GstClockEntryContext *ctx = cur->data;
-
-    if (ctx->clock_entry == clock_entry) {
-      result = ctx;
-      break;
-    }
-  }
 
-  return result;
+  return g_hash_table_lookup (priv->entry_table, clock_entry);
 }
 
 static gint
@@ -614,6 +683,19 @@ gst_clock_entry_context_compare_func (gconstpointer a, gconstpointer b)
   return gst_clock_id_compare_func (ctx_a->clock_entry, ctx_b->clock_entry);
 }
 
+static gint
+gst_clock_entry_context_sort_func (gconstpointer a, gconstpointer b)
+{
+  const GstClockEntryContext *ctx_a = *(GstClockEntryContext **) a;
+  const GstClockEntryContext *ctx_b = *(GstClockEntryContext **) b;
+
+  if (gst_clock_entry_context_is_before (ctx_a, ctx_b))
+    return -1;
+  if (gst_clock_entry_context_is_before (ctx_b, ctx_a))
+    return 1;
+  return 0;
+}
+
 static void
 process_entry_context_unlocked (GstTestClock * test_clock,
     GstClockEntryContext * ctx)
@@ -647,16 +729,24 @@ static GList *
 gst_test_clock_get_pending_id_list_unlocked (GstTestClock * test_clock)
 {
   GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
-  GQueue queue = G_QUEUE_INIT;
-  GList *cur;
+  GPtrArray *sorted;
+  GList *result = NULL;
+  guint i;
+
+  /* the heap is only partially ordered, sort a copy of it */
+  sorted = g_ptr_array_sized_new (priv->entry_heap->len);
+  for (i = 0; i < priv->entry_heap->len; i++)
+    g_ptr_array_add (sorted, g_ptr_array_index (priv->entry_heap, i));
+  g_ptr_array_sort (sorted, gst_clock_entry_context_sort_func);
 
-  for (cur = priv->entry_contexts; cur != NULL; cur = cur->next) {
-    GstClockEntryContext *ctx = cur->data;
+  for (i = sorted->len; i > 0; i--) {
+    GstClockEntryContext *ctx = g_ptr_array_index (sorted, i - 1);
 
-    g_queue_push_tail (&queue, gst_clock_id_ref (ctx->clock_entry));
+    result = g_list_prepend (result, gst_clock_id_ref (ctx->clock_entry));
   }
+  g_ptr_array_unref (sorted);
 
-  return queue.head;
+  return result;
 }
 
 /**
@@ -888,7 +978,7 @@ gst_test_clock_wait_for_next_pending_id (GstTestClock * test_clock,
 
   GST_OBJECT_LOCK (test_clock);
 
-  while (priv->entry_contexts == NULL)
+  while (priv->entry_heap->len == 0)
     g_cond_wait (&priv->entry_added_cond, GST_OBJECT_GET_LOCK (test_clock));
 
   if (!gst_test_clock_peek_next_pending_id_unlocked (test_clock, pending_id))
@@ -936,8 +1026,7 @@ gst_test_clock_process_next_clock_id (GstTestClock * test_clock)
 {
   GstTestClockPrivate *priv;
   GstClockID result = NULL;
-  GstClockEntryContext *ctx = NULL;
-  GList *cur;
+  GstClockEntryContext *ctx;
 
   g_return_val_if_fail (GST_IS_TEST_CLOCK (test_clock), NULL);
 
@@ -945,17 +1034,16 @@ gst_test_clock_process_next_clock_id (GstTestClock * test_clock)
 
   GST_OBJECT_LOCK (test_clock);
 
-  for (cur = priv->entry_contexts; cur != NULL && result == NULL;
-      cur = cur->next) {
-    ctx = cur->data;
+  /* the most imminent entry is at the top of the heap */
+  if (priv->entry_heap->len > 0) {
+    ctx = g_ptr_array_index (priv->entry_heap, 0);
 
-    if (priv->internal_time >= GST_CLOCK_ENTRY_TIME (ctx->clock_entry))
+    if (priv->internal_time >= GST_CLOCK_ENTRY_TIME (ctx->clock_entry)) {
       result = gst_clock_id_ref (ctx->clock_entry);
+      process_entry_context_unlocked (test_clock, ctx);
+    }
   }
 
-  if (result != NULL)
-    process_entry_context_unlocked (test_clock, ctx);
-
   GST_OBJECT_UNLOCK (test_clock);
 
   return result;
@@ -980,7 +1068,6 @@ gst_test_clock_get_next_entry_time (GstTestClock * test_clock)
 {
   GstTestClockPrivate *priv;
   GstClockTime result = GST_CLOCK_TIME_NONE;
-  GList *imminent_clock_id;
 
   g_return_val_if_fail (GST_IS_TEST_CLOCK (test_clock), GST_CLOCK_TIME_NONE);
 
@@ -988,11 +1075,10 @@ gst_test_clock_get_next_entry_time (GstTestClock * test_clock)
 
   GST_OBJECT_LOCK (test_clock);
 
-  /* The list of pending clock notifications is sorted by time,
-     so the most imminent one is the first one in the list. */
-  imminent_clock_id = g_list_first (priv->entry_contexts);
-  if (imminent_clock_id != NULL) {
-    GstClockEntryContext *ctx = imminent_clock_id->data;
+  /* The pending clock notifications are kept in a heap ordered by time,
+     so the most imminent one is at the top of it. */
+  if (priv->entry_heap->len > 0) {
+    GstClockEntryContext *ctx = g_ptr_array_index (priv->entry_heap, 0);
     result = GST_CLOCK_ENTRY_TIME (ctx->clock_entry);
   }
 
@@ -1028,7 +1114,7 @@ gst_test_clock_wait_for_multiple_pending_ids (GstTestClock * test_clock,
 
   GST_OBJECT_LOCK (test_clock);
 
-  while (g_list_length (priv->entry_contexts) < count)
+  while (priv->entry_heap->len < count)
     g_cond_wait (&priv->entry_added_cond, GST_OBJECT_GET_LOCK (test_clock));
 
   if (pending_list)
@@ -1145,3 +1231,61 @@ gst_test_clock_crank (GstTestClock * test_clock)
 
   return result;
 }
+
+/**
+ * gst_test_clock_set_time_and_process:
+ * @test_clock: a #GstTestClock
+ * @new_time: a #GstClockTime later than that returned by gst_clock_get_time()
+ *
+ * Sets the time of @test_clock to @new_time like gst_test_clock_set_time()
+ * and processes all the pending clock notifications that are due at
+ * @new_time, in the order of their time. Periodic notifications are
+ * processed as many times as they expire until @new_time.
+ *
+ * This is a lot faster than cranking the clock when there are many pending
+ * clock notifications.
+ *
+ * MT safe.
+ *
+ * Returns: the number of processed clock notifications
+ *
+ * Since: 1.14
+ */
+guint
+gst_test_clock_set_time_and_process (GstTestClock * test_clock,
+    GstClockTime new_time)
+{
+  GstTestClockPrivate *priv;
+  guint result = 0;
+
+  g_return_val_if_fail (GST_IS_TEST_CLOCK (test_clock), 0);
+
+  priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
+
+  g_assert_cmpuint (new_time, !=, GST_CLOCK_TIME_NONE);
+
+  GST_OBJECT_LOCK (test_clock);
+
+  g_assert_cmpuint (new_time, >=, priv->internal_time);
+
+  priv->internal_time = new_time;
+  GST_CAT_DEBUG_OBJECT (GST_CAT_TEST_CLOCK, test_clock,
+      "clock set to %" GST_TIME_FORMAT, GST_TIME_ARGS (new_time));
+
+  while (priv->entry_heap->len > 0) {
+    GstClockEntryContext *ctx = g_ptr_array_index (priv->entry_heap, 0);
+
+    if (GST_CLOCK_ENTRY_TIME (ctx->clock_entry) > new_time)
+      break;
+
+    process_entry_context_unlocked (test_clock, ctx);
+    result++;
+  }
+
+  GST_OBJECT_UNLOCK (test_clock);
+
+  GST_CAT_DEBUG_OBJECT (GST_CAT_TEST_CLOCK, test_clock,
+      "processed %u clock notifications", result);
+
+  return result;
+}
@@ -130,6 +130,10 @@ GstClockTime  gst_test_clock_id_list_get_latest_time (const GList * pending_list
 GST_EXPORT
 gboolean      gst_test_clock_crank (GstTestClock * test_clock);
 
+GST_EXPORT
+guint         gst_test_clock_set_time_and_process (GstTestClock * test_clock,
+                                                   GstClockTime   new_time);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstTestClock, gst_object_unref)
 #endif
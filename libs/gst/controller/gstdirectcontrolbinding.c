@@ -32,6 +32,8 @@
  * transformations.
  */
 
+#include <string.h>
+
 #include <glib-object.h>
 #include <gst/gst.h>
 
@@ -376,6 +378,23 @@ gst_direct_control_binding_sync_values (GstControlBinding * _self,
      */
     if ((timestamp < last_sync) || (src_val != self->last_value)) {
       GValue *dst_val = &self->cur_value;
+      guint8 converted[8];
+      gboolean force = (timestamp < last_sync)
+          || !self->ABI.abi.have_last_converted;
+
+      self->last_value = src_val;
+
+      /* convert to the property's type first, integer, boolean and enum
+       * properties often keep their value while the control value moves and
+       * setting the property is by far the most expensive part */
+      self->convert_value (self, src_val, converted);
+      if (!force && memcmp (converted, self->ABI.abi.last_converted,
+              self->byte_size) == 0) {
+        GST_LOG_OBJECT (object, "  %s unchanged", _self->name);
+        return TRUE;
+      }
+      memcpy (self->ABI.abi.last_converted, converted, self->byte_size);
+      self->ABI.abi.have_last_converted = TRUE;
 
       GST_LOG_OBJECT (object, "  mapping %s to value of type %s", _self->name,
           G_VALUE_TYPE_NAME (dst_val));
@@ -385,7 +404,6 @@ gst_direct_control_binding_sync_values (GstControlBinding * _self,
        * http://bugzilla.gnome.org/show_bug.cgi?id=536939
        */
       g_object_set_property ((GObject *) object, _self->name, dst_val);
-      self->last_value = src_val;
     }
   } else {
     GST_DEBUG_OBJECT (object, "no control value for param %s", _self->name);
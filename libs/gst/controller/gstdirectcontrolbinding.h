@@ -89,6 +89,9 @@ struct _GstDirectControlBinding {
     gpointer _gst_reserved[GST_PADDING];
     struct {
       gboolean want_absolute;
+      /* the last value set on the property, in the property's type */
+      gboolean have_last_converted;
+      guint8 last_converted[8];
     } abi;
   } ABI;
 };
@@ -103,6 +103,56 @@ _get_nearest_control_points2 (GstTimedValueControlSource * self,
 }
 
 
+/* Fills @n values starting at @ts with the segment from @cp1 to @cp2, where
+ * @cp2 is %NULL for the segment after the last control point */
+typedef void (*GstInterpolateFillFunc) (GstTimedValueControlSource * self,
+    GstControlPoint * cp1, GstControlPoint * cp2, GstClockTime ts,
+    GstClockTime interval, guint n, gdouble * values);
+
+/* Walks the segments between the control points once for the whole array
+ * and lets @fill compute the values of each segment in a single loop */
+static gboolean
+_get_value_array (GstTimedValueControlSource * self, GstClockTime timestamp,
+    GstClockTime interval, guint n_values, gdouble * values,
+    GstInterpolateFillFunc fill)
+{
+  gboolean ret = FALSE;
+  guint i = 0, j, n;
+  GstClockTime ts = timestamp;
+  GstClockTime next_ts;
+  GstControlPoint *cp1, *cp2;
+
+  g_mutex_lock (&self->lock);
+
+  while (i < n_values) {
+    _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
+
+    /* number of values before the next control point */
+    n = n_values - i;
+    if (GST_CLOCK_TIME_IS_VALID (next_ts) && interval > 0)
+      n = MIN (n, (next_ts - ts + interval - 1) / interval);
+
+    GST_LOG ("values[%3d..%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%"
+        GST_TIME_FORMAT, i, i + n - 1, GST_TIME_ARGS (ts),
+        GST_TIME_ARGS (next_ts));
+
+    if (cp1) {
+      fill (self, cp1, cp2, ts, interval, n, values);
+      ret = TRUE;
+    } else {
+      for (j = 0; j < n; j++)
+        values[j] = NAN;
+    }
+
+    i += n;
+    ts += n * interval;
+    values += n;
+  }
+  g_mutex_unlock (&self->lock);
+  return ret;
+}
+
+
 /*  steps-like (no-)interpolation, default */
 /*  just returns the value for the most recent key-frame */
 static inline gdouble
@@ -132,38 +182,25 @@ interpolate_none_get (GstTimedValueControlSource * self, GstClockTime timestamp,
   return ret;
 }
 
+static void
+_interpolate_none_fill (GstTimedValueControlSource * self,
+    GstControlPoint * cp1, GstControlPoint * cp2, GstClockTime ts,
+    GstClockTime interval, guint n, gdouble * values)
+{
+  gdouble value = _interpolate_none (self, cp1);
+  guint i;
+
+  for (i = 0; i < n; i++)
+    values[i] = value;
+}
+
 static gboolean
 interpolate_none_get_value_array (GstTimedValueControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  gboolean ret = FALSE;
-  guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
-
-  g_mutex_lock (&self->lock);
-
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    if (ts >= next_ts) {
-      _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
-    }
-    if (cp1) {
-      *values = _interpolate_none (self, cp1);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, *values);
-    } else {
-      *values = NAN;
-      GST_LOG ("values[%3d]=-", i);
-    }
-    ts += interval;
-    values++;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _interpolate_none_fill);
 }
 
 
@@ -204,40 +241,38 @@ interpolate_linear_get (GstTimedValueControlSource * self,
   return ret;
 }
 
-static gboolean
-interpolate_linear_get_value_array (GstTimedValueControlSource * self,
-    GstClockTime timestamp, GstClockTime interval, guint n_values,
-    gdouble * values)
+/* same as _interpolate_linear() for each value */
+static void
+_interpolate_linear_fill (GstTimedValueControlSource * self,
+    GstControlPoint * cp1, GstControlPoint * cp2, GstClockTime ts,
+    GstClockTime interval, guint n, gdouble * values)
 {
-  gboolean ret = FALSE;
+  GstClockTime timestamp1 = cp1->timestamp;
+  gdouble value1 = cp1->value;
+  gdouble slope;
   guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
 
-  g_mutex_lock (&self->lock);
+  if (!cp2) {
+    for (i = 0; i < n; i++)
+      values[i] = value1;
+    return;
+  }
 
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    if (ts >= next_ts) {
-      _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
-    }
-    if (cp1) {
-      *values = _interpolate_linear (cp1->timestamp, cp1->value,
-          (cp2 ? cp2->timestamp : GST_CLOCK_TIME_NONE),
-          (cp2 ? cp2->value : 0.0), ts);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, *values);
-    } else {
-      *values = NAN;
-      GST_LOG ("values[%3d]=-", i);
-    }
+  slope = (cp2->value - value1) /
+      gst_guint64_to_gdouble (cp2->timestamp - timestamp1);
+  for (i = 0; i < n; i++) {
+    values[i] = value1 + (gst_guint64_to_gdouble (ts - timestamp1) * slope);
     ts += interval;
-    values++;
   }
-  g_mutex_unlock (&self->lock);
-  return ret;
+}
+
+static gboolean
+interpolate_linear_get_value_array (GstTimedValueControlSource * self,
+    GstClockTime timestamp, GstClockTime interval, guint n_values,
+    gdouble * values)
+{
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _interpolate_linear_fill);
 }
 
 
@@ -389,43 +424,58 @@ interpolate_cubic_get (GstTimedValueControlSource * self,
   return ret;
 }
 
+/* same as _interpolate_cubic() for each value */
+static void
+_interpolate_cubic_fill (GstTimedValueControlSource * self,
+    GstControlPoint * cp1, GstControlPoint * cp2, GstClockTime ts,
+    GstClockTime interval, guint n, gdouble * values)
+{
+  gdouble h, z1, z2, c1, c2;
+  guint i;
+
+  if (!self->valid_cache) {
+    _interpolate_cubic_update_cache (self);
+    self->valid_cache = TRUE;
+  }
+
+  if (!cp2) {
+    for (i = 0; i < n; i++)
+      values[i] = cp1->value;
+    return;
+  }
+
+  h = cp1->cache.cubic.h;
+  z1 = cp1->cache.cubic.z;
+  z2 = cp2->cache.cubic.z;
+  c2 = cp2->value / h - h * z2;
+  c1 = cp1->value / h - h * z1;
+
+  for (i = 0; i < n; i++) {
+    gdouble diff1, diff2;
+    gdouble out;
+
+    diff1 = gst_guint64_to_gdouble (ts - cp1->timestamp);
+    diff2 = gst_guint64_to_gdouble (cp2->timestamp - ts);
+
+    out = (z2 * diff1 * diff1 * diff1 + z1 * diff2 * diff2 * diff2) / h;
+    out += c2 * diff1;
+    out += c1 * diff2;
+    values[i] = out;
+    ts += interval;
+  }
+}
+
 static gboolean
 interpolate_cubic_get_value_array (GstTimedValueControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  gboolean ret = FALSE;
-  guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
-
   if (self->nvalues <= 2)
     return interpolate_linear_get_value_array (self, timestamp, interval,
         n_values, values);
 
-  g_mutex_lock (&self->lock);
-
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    if (ts >= next_ts) {
-      _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
-    }
-    if (cp1) {
-      *values = _interpolate_cubic (self, cp1, cp1->value, cp2,
-          (cp2 ? cp2->value : 0.0), ts);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, *values);
-    } else {
-      *values = NAN;
-      GST_LOG ("values[%3d]=-", i);
-    }
-    ts += interval;
-    values++;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _interpolate_cubic_fill);
 }
 
 
@@ -558,43 +608,54 @@ interpolate_cubic_monotonic_get (GstTimedValueControlSource * self,
   return ret;
 }
 
+/* same as _interpolate_cubic_monotonic() for each value */
+static void
+_interpolate_cubic_monotonic_fill (GstTimedValueControlSource * self,
+    GstControlPoint * cp1, GstControlPoint * cp2, GstClockTime ts,
+    GstClockTime interval, guint n, gdouble * values)
+{
+  gdouble value1 = cp1->value, c1s, c2s, c3s;
+  guint i;
+
+  if (!self->valid_cache) {
+    _interpolate_cubic_monotonic_update_cache (self);
+    self->valid_cache = TRUE;
+  }
+
+  if (!cp2) {
+    for (i = 0; i < n; i++)
+      values[i] = value1;
+    return;
+  }
+
+  c1s = cp1->cache.cubic_monotonic.c1s;
+  c2s = cp1->cache.cubic_monotonic.c2s;
+  c3s = cp1->cache.cubic_monotonic.c3s;
+
+  for (i = 0; i < n; i++) {
+    gdouble diff = gst_guint64_to_gdouble (ts - cp1->timestamp);
+    gdouble diff2 = diff * diff;
+    gdouble out;
+
+    out = value1 + c1s * diff;
+    out += c2s * diff2;
+    out += c3s * diff * diff2;
+    values[i] = out;
+    ts += interval;
+  }
+}
+
 static gboolean
 interpolate_cubic_monotonic_get_value_array (GstTimedValueControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  gboolean ret = FALSE;
-  guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
-
   if (self->nvalues <= 2)
     return interpolate_linear_get_value_array (self, timestamp, interval,
         n_values, values);
 
-  g_mutex_lock (&self->lock);
-
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    if (ts >= next_ts) {
-      _get_nearest_control_points2 (self, ts, &cp1, &cp2, &next_ts);
-    }
-    if (cp1) {
-      *values = _interpolate_cubic_monotonic (self, cp1, cp1->value, cp2,
-          (cp2 ? cp2->value : 0.0), ts);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, *values);
-    } else {
-      *values = NAN;
-      GST_LOG ("values[%3d]=-", i);
-    }
-    ts += interval;
-    values++;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _interpolate_cubic_monotonic_fill);
 }
 
 
@@ -75,71 +75,146 @@ _calculate_pos (GstClockTime timestamp, GstClockTime timeshift,
   return timestamp % period;
 }
 
-static inline gdouble
-_sine_get (GstLFOControlSource * self, gdouble amp, gdouble off,
-    GstClockTime timeshift, GstClockTime period, gdouble frequency,
-    GstClockTime timestamp)
-{
-  gdouble pos =
-      gst_guint64_to_gdouble (_calculate_pos (timestamp, timeshift, period));
-  gdouble ret;
+/* returns the value at position @pos inside the period */
+typedef gdouble (*GstLFOWaveformGet) (GstLFOControlSourcePrivate * priv,
+    GstClockTime pos);
 
-  ret = sin (2.0 * M_PI * (frequency / GST_SECOND) * pos);
-  ret *= amp;
-  ret += off;
-
-  return ret;
-}
+/* fills @n_values values starting at position @pos, @step is the interval
+ * between two values modulo the period */
+typedef void (*GstLFOWaveformFill) (GstLFOControlSourcePrivate * priv,
+    GstClockTime pos, GstClockTime step, guint n_values, gdouble * values);
 
 static gboolean
-waveform_sine_get (GstLFOControlSource * self, GstClockTime timestamp,
-    gdouble * value)
+_get_value (GstLFOControlSource * self, GstClockTime timestamp,
+    gdouble * value, GstLFOWaveformGet get)
 {
   GstLFOControlSourcePrivate *priv = self->priv;
 
   gst_object_sync_values (GST_OBJECT (self), timestamp);
   g_mutex_lock (&self->lock);
-  *value = _sine_get (self, priv->amplitude, priv->offset, priv->timeshift,
-      priv->period, priv->frequency, timestamp);
+  *value = get (priv, _calculate_pos (timestamp, priv->timeshift,
+          priv->period));
   g_mutex_unlock (&self->lock);
   return TRUE;
 }
 
 static gboolean
-waveform_sine_get_value_array (GstLFOControlSource * self,
-    GstClockTime timestamp, GstClockTime interval, guint n_values,
-    gdouble * values)
+_get_value_array (GstLFOControlSource * self, GstClockTime timestamp,
+    GstClockTime interval, guint n_values, gdouble * values,
+    GstLFOWaveformGet get, GstLFOWaveformFill fill)
 {
   GstLFOControlSourcePrivate *priv = self->priv;
+  GstClockTime pos, step;
   guint i;
-  GstClockTime ts = timestamp;
 
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values = _sine_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
+  /* with controlled properties the waveform can change for every value */
+  if (gst_object_has_active_control_bindings (GST_OBJECT (self))) {
+    for (i = 0; i < n_values; i++) {
+      _get_value (self, timestamp, &values[i], get);
+      timestamp += interval;
+    }
+    return TRUE;
   }
+
+  /* otherwise the position is advanced by the interval, the same as
+   * calculating it for every timestamp but without the divisions */
+  g_mutex_lock (&self->lock);
+  pos = _calculate_pos (timestamp, priv->timeshift, priv->period);
+  step = interval % priv->period;
+  if (fill) {
+    fill (priv, pos, step, n_values, values);
+  } else {
+    for (i = 0; i < n_values; i++) {
+      values[i] = get (priv, pos);
+      pos += step;
+      if (pos >= priv->period)
+        pos -= priv->period;
+    }
+  }
+  g_mutex_unlock (&self->lock);
+
   return TRUE;
 }
 
+static inline gdouble
+_sine_get (GstLFOControlSourcePrivate * priv, GstClockTime pos)
+{
+  gdouble ret;
+
+  ret = sin (2.0 * M_PI * (priv->frequency / GST_SECOND) *
+      gst_guint64_to_gdouble (pos));
+  ret *= priv->amplitude;
+  ret += priv->offset;
+
+  return ret;
+}
+
+/* number of values that are calculated by rotating the previous one before
+ * starting again from sin() to keep the rounding errors small */
+#define SINE_ROTATIONS 64
+
+static void
+_sine_fill (GstLFOControlSourcePrivate * priv, GstClockTime pos,
+    GstClockTime step, guint n_values, gdouble * values)
+{
+  gdouble w = 2.0 * M_PI * (priv->frequency / GST_SECOND);
+  gdouble step_sin, step_cos, s = 0.0, c = 0.0, tmp;
+  guint i, left = 0;
+
+  /* sin (x + step) and cos (x + step) from sin (x) and cos (x), which is
+   * only valid while the position does not wrap around */
+  step_sin = sin (w * gst_guint64_to_gdouble (step));
+  step_cos = cos (w * gst_guint64_to_gdouble (step));
+
+  for (i = 0; i < n_values; i++) {
+    if (left == 0) {
+      tmp = w * gst_guint64_to_gdouble (pos);
+      s = sin (tmp);
+      c = cos (tmp);
+      left = SINE_ROTATIONS;
+    } else {
+      tmp = s * step_cos + c * step_sin;
+      c = c * step_cos - s * step_sin;
+      s = tmp;
+    }
+    values[i] = s * priv->amplitude + priv->offset;
+    left--;
+
+    pos += step;
+    if (pos >= priv->period) {
+      pos -= priv->period;
+      left = 0;
+    }
+  }
+}
+
+static gboolean
+waveform_sine_get (GstLFOControlSource * self, GstClockTime timestamp,
+    gdouble * value)
+{
+  return _get_value (self, timestamp, value, _sine_get);
+}
+
+static gboolean
+waveform_sine_get_value_array (GstLFOControlSource * self,
+    GstClockTime timestamp, GstClockTime interval, guint n_values,
+    gdouble * values)
+{
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _sine_get, _sine_fill);
+}
+
 
 static inline gdouble
-_square_get (GstLFOControlSource * self, gdouble amp, gdouble off,
-    GstClockTime timeshift, GstClockTime period, gdouble frequency,
-    GstClockTime timestamp)
+_square_get (GstLFOControlSourcePrivate * priv, GstClockTime pos)
 {
-  GstClockTime pos = _calculate_pos (timestamp, timeshift, period);
   gdouble ret;
 
-  if (pos >= period / 2)
-    ret = amp;
+  if (pos >= priv->period / 2)
+    ret = priv->amplitude;
   else
-    ret = -amp;
-  ret += off;
+    ret = -priv->amplitude;
+  ret += priv->offset;
 
   return ret;
 }
@@ -148,14 +223,7 @@ static gboolean
 waveform_square_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-
-  gst_object_sync_values (GST_OBJECT (self), timestamp);
-  g_mutex_lock (&self->lock);
-  *value = _square_get (self, priv->amplitude, priv->offset, priv->timeshift,
-      priv->period, priv->frequency, timestamp);
-  g_mutex_unlock (&self->lock);
-  return TRUE;
+  return _get_value (self, timestamp, value, _square_get);
 }
 
 static gboolean
@@ -163,34 +231,19 @@ waveform_square_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values = _square_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _square_get, NULL);
 }
 
 static inline gdouble
-_saw_get (GstLFOControlSource * self, gdouble amp, gdouble off,
-    GstClockTime timeshift, GstClockTime period, gdouble frequency,
-    GstClockTime timestamp)
+_saw_get (GstLFOControlSourcePrivate * priv, GstClockTime pos)
 {
-  gdouble pos =
-      gst_guint64_to_gdouble (_calculate_pos (timestamp, timeshift, period));
-  gdouble per = gst_guint64_to_gdouble (period);
+  gdouble p = gst_guint64_to_gdouble (pos);
+  gdouble per = gst_guint64_to_gdouble (priv->period);
   gdouble ret;
 
-  ret = -((pos - per / 2.0) * ((2.0 * amp) / per));
-  ret += off;
+  ret = -((p - per / 2.0) * ((2.0 * priv->amplitude) / per));
+  ret += priv->offset;
 
   return ret;
 }
@@ -199,14 +252,7 @@ static gboolean
 waveform_saw_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-
-  gst_object_sync_values (GST_OBJECT (self), timestamp);
-  g_mutex_lock (&self->lock);
-  *value = _saw_get (self, priv->amplitude, priv->offset, priv->timeshift,
-      priv->period, priv->frequency, timestamp);
-  g_mutex_unlock (&self->lock);
-  return TRUE;
+  return _get_value (self, timestamp, value, _saw_get);
 }
 
 static gboolean
@@ -214,34 +260,19 @@ waveform_saw_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values = _saw_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _saw_get, NULL);
 }
 
 static inline gdouble
-_rsaw_get (GstLFOControlSource * self, gdouble amp, gdouble off,
-    GstClockTime timeshift, GstClockTime period, gdouble frequency,
-    GstClockTime timestamp)
+_rsaw_get (GstLFOControlSourcePrivate * priv, GstClockTime pos)
 {
-  gdouble pos =
-      gst_guint64_to_gdouble (_calculate_pos (timestamp, timeshift, period));
-  gdouble per = gst_guint64_to_gdouble (period);
+  gdouble p = gst_guint64_to_gdouble (pos);
+  gdouble per = gst_guint64_to_gdouble (priv->period);
   gdouble ret;
 
-  ret = (pos - per / 2.0) * ((2.0 * amp) / per);
-  ret += off;
+  ret = (p - per / 2.0) * ((2.0 * priv->amplitude) / per);
+  ret += priv->offset;
 
   return ret;
 }
@@ -250,14 +281,7 @@ static gboolean
 waveform_rsaw_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-
-  gst_object_sync_values (GST_OBJECT (self), timestamp);
-  g_mutex_lock (&self->lock);
-  *value = _rsaw_get (self, priv->amplitude, priv->offset, priv->timeshift,
-      priv->period, priv->frequency, timestamp);
-  g_mutex_unlock (&self->lock);
-  return TRUE;
+  return _get_value (self, timestamp, value, _rsaw_get);
 }
 
 static gboolean
@@ -265,44 +289,30 @@ waveform_rsaw_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values = _rsaw_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _rsaw_get, NULL);
 }
 
 
 static inline gdouble
-_triangle_get (GstLFOControlSource * self, gdouble amp, gdouble off,
-    GstClockTime timeshift, GstClockTime period, gdouble frequency,
-    GstClockTime timestamp)
+_triangle_get (GstLFOControlSourcePrivate * priv, GstClockTime pos)
 {
-  gdouble pos =
-      gst_guint64_to_gdouble (_calculate_pos (timestamp, timeshift, period));
-  gdouble per = gst_guint64_to_gdouble (period);
+  gdouble p = gst_guint64_to_gdouble (pos);
+  gdouble per = gst_guint64_to_gdouble (priv->period);
+  gdouble amp = priv->amplitude;
   gdouble ret;
 
-  if (pos <= 0.25 * per)
+  if (p <= 0.25 * per)
     /* 1st quarter */
-    ret = pos * ((4.0 * amp) / per);
-  else if (pos <= 0.75 * per)
+    ret = p * ((4.0 * amp) / per);
+  else if (p <= 0.75 * per)
     /* 2nd & 3rd quarter */
-    ret = -(pos - per / 2.0) * ((4.0 * amp) / per);
+    ret = -(p - per / 2.0) * ((4.0 * amp) / per);
   else
     /* 4th quarter */
-    ret = -(per - pos) * ((4.0 * amp) / per);
+    ret = -(per - p) * ((4.0 * amp) / per);
 
-  ret += off;
+  ret += priv->offset;
 
   return ret;
 }
@@ -311,14 +321,7 @@ static gboolean
 waveform_triangle_get (GstLFOControlSource * self, GstClockTime timestamp,
     gdouble * value)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-
-  gst_object_sync_values (GST_OBJECT (self), timestamp);
-  g_mutex_lock (&self->lock);
-  *value = _triangle_get (self, priv->amplitude, priv->offset, priv->timeshift,
-      priv->period, priv->frequency, timestamp);
-  g_mutex_unlock (&self->lock);
-  return TRUE;
+  return _get_value (self, timestamp, value, _triangle_get);
 }
 
 static gboolean
@@ -326,21 +329,8 @@ waveform_triangle_get_value_array (GstLFOControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  GstLFOControlSourcePrivate *priv = self->priv;
-  guint i;
-  GstClockTime ts = timestamp;
-
-  for (i = 0; i < n_values; i++) {
-    gst_object_sync_values (GST_OBJECT (self), ts);
-    g_mutex_lock (&self->lock);
-    *values =
-        _triangle_get (self, priv->amplitude, priv->offset, priv->timeshift,
-        priv->period, priv->frequency, ts);
-    g_mutex_unlock (&self->lock);
-    ts += interval;
-    values++;
-  }
-  return TRUE;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _triangle_get, NULL);
 }
 
 static struct
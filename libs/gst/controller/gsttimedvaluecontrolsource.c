@@ -49,6 +49,17 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
   GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, "timed value control source", 0, \
     "timed value control source base class")
 
+#define GST_TIMED_VALUE_CONTROL_SOURCE_GET_PRIVATE(obj) \
+  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_TIMED_VALUE_CONTROL_SOURCE, \
+    GstTimedValueControlSourcePrivate))
+
+struct _GstTimedValueControlSourcePrivate
+{
+  /* control point returned by the last lookup, most lookups are for the
+   * same or the next segment */
+  GSequenceIter *cursor;
+};
+
 #define gst_timed_value_control_source_parent_class parent_class
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GstTimedValueControlSource,
     gst_timed_value_control_source, GST_TYPE_CONTROL_SOURCE, _do_init);
@@ -116,6 +127,7 @@ gst_timed_value_control_source_reset (GstTimedValueControlSource * self)
 
   self->nvalues = 0;
   self->valid_cache = FALSE;
+  self->priv->cursor = NULL;
 }
 
 /*
@@ -167,46 +179,74 @@ _make_new_cp (GstTimedValueControlSource * self, GstClockTime timestamp,
   return cp;
 }
 
-static void
-gst_timed_value_control_source_set_internal (GstTimedValueControlSource *
-    self, GstClockTime timestamp, const gdouble value)
+/* must be called with the lock, returns the signal to emit for @cp */
+static guint
+gst_timed_value_control_source_set_locked (GstTimedValueControlSource *
+    self, GstClockTime timestamp, const gdouble value, GstControlPoint ** cp)
 {
-  GstControlPoint *cp;
-
-  g_mutex_lock (&self->lock);
-
-  /* check if a control point for the timestamp already exists */
-  if (G_LIKELY (self->values)) {
-    GSequenceIter *iter = g_sequence_lookup (self->values, &timestamp,
-        (GCompareDataFunc) gst_control_point_find, NULL);
+  GSequenceIter *last;
 
-    if (iter) {
-      GstControlPoint *cp = g_sequence_get (iter);
+  if (G_UNLIKELY (!self->values)) {
+    self->values = g_sequence_new ((GDestroyNotify) gst_control_point_free);
+    GST_INFO ("create new timed value sequence");
+  }
 
-      /* update control point */
-      cp->value = value;
-      g_mutex_unlock (&self->lock);
+  /* control points are mostly added in order, so new points after the last
+   * one are appended without searching */
+  last = g_sequence_get_end_iter (self->values);
+  if (!g_sequence_iter_is_begin (last)) {
+    GstControlPoint *last_cp;
+
+    last = g_sequence_iter_prev (last);
+    last_cp = g_sequence_get (last);
+    if (timestamp > last_cp->timestamp)
+      goto append;
+    if (timestamp == last_cp->timestamp) {
+      *cp = last_cp;
+      goto update;
+    }
 
-      g_signal_emit (self,
-          gst_timed_value_control_source_signals[VALUE_CHANGED_SIGNAL], 0, cp);
-      goto done;
+    /* check if a control point for the timestamp already exists */
+    last = g_sequence_lookup (self->values, &timestamp,
+        (GCompareDataFunc) gst_control_point_find, NULL);
+    if (last) {
+      *cp = g_sequence_get (last);
+      goto update;
     }
-  } else {
-    self->values = g_sequence_new ((GDestroyNotify) gst_control_point_free);
-    GST_INFO ("create new timed value sequence");
+
+    /* sort new cp into the prop->values list */
+    *cp = _make_new_cp (self, timestamp, value);
+    g_sequence_insert_sorted (self->values, *cp,
+        (GCompareDataFunc) gst_control_point_compare, NULL);
+    self->nvalues++;
+    return VALUE_ADDED_SIGNAL;
   }
 
-  /* sort new cp into the prop->values list */
-  cp = _make_new_cp (self, timestamp, value);
-  g_sequence_insert_sorted (self->values, cp,
-      (GCompareDataFunc) gst_control_point_compare, NULL);
+append:
+  *cp = _make_new_cp (self, timestamp, value);
+  g_sequence_append (self->values, *cp);
   self->nvalues++;
+  return VALUE_ADDED_SIGNAL;
+
+update:
+  (*cp)->value = value;
+  return VALUE_CHANGED_SIGNAL;
+}
+
+static void
+gst_timed_value_control_source_set_internal (GstTimedValueControlSource *
+    self, GstClockTime timestamp, const gdouble value)
+{
+  GstControlPoint *cp;
+  guint signal;
+
+  g_mutex_lock (&self->lock);
+  signal = gst_timed_value_control_source_set_locked (self, timestamp, value,
+      &cp);
   g_mutex_unlock (&self->lock);
 
-  g_signal_emit (self,
-      gst_timed_value_control_source_signals[VALUE_ADDED_SIGNAL], 0, cp);
+  g_signal_emit (self, gst_timed_value_control_source_signals[signal], 0, cp);
 
-done:
   self->valid_cache = FALSE;
 }
 
@@ -226,11 +266,26 @@ done:
 GSequenceIter *gst_timed_value_control_source_find_control_point_iter
     (GstTimedValueControlSource * self, GstClockTime timestamp)
 {
-  GSequenceIter *iter;
+  GstTimedValueControlSourcePrivate *priv = self->priv;
+  GSequenceIter *iter, *next;
+  guint i;
 
   if (!self->values)
     return NULL;
 
+  /* playback and value arrays look up the same or the following segments,
+   * try the segment of the last lookup and the next one before searching */
+  iter = priv->cursor;
+  for (i = 0; iter && i < 2; i++) {
+    if (((GstControlPoint *) g_sequence_get (iter))->timestamp > timestamp)
+      break;
+    next = g_sequence_iter_next (iter);
+    if (g_sequence_iter_is_end (next)
+        || ((GstControlPoint *) g_sequence_get (next))->timestamp > timestamp)
+      return iter;
+    iter = next;
+  }
+
   iter =
       g_sequence_search (self->values, &timestamp,
       (GCompareDataFunc) gst_control_point_find, NULL);
@@ -242,7 +297,8 @@ GSequenceIter *gst_timed_value_control_source_find_control_point_iter
   if (g_sequence_iter_is_begin (iter))
     return NULL;
 
-  return g_sequence_iter_prev (iter);
+  priv->cursor = g_sequence_iter_prev (iter);
+  return priv->cursor;
 }
 
 
@@ -284,21 +340,44 @@ gst_timed_value_control_source_set_from_list (GstTimedValueControlSource *
 {
   const GSList *node;
   GstTimedValue *tv;
-  gboolean res = FALSE;
+  GPtrArray *cps;
+  GArray *signals;
+  guint i, signal;
+  GstControlPoint *cp;
+  gboolean res;
 
   g_return_val_if_fail (GST_IS_TIMED_VALUE_CONTROL_SOURCE (self), FALSE);
 
+  cps = g_ptr_array_new ();
+  signals = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  /* insert all values under one lock and emit the signals afterwards */
+  g_mutex_lock (&self->lock);
   for (node = timedvalues; node; node = g_slist_next (node)) {
     tv = node->data;
     if (!GST_CLOCK_TIME_IS_VALID (tv->timestamp)) {
       GST_WARNING ("GstTimedValued with invalid timestamp passed to %s",
           GST_FUNCTION);
     } else {
-      gst_timed_value_control_source_set_internal (self, tv->timestamp,
-          tv->value);
-      res = TRUE;
+      signal = gst_timed_value_control_source_set_locked (self, tv->timestamp,
+          tv->value, &cp);
+      g_ptr_array_add (cps, cp);
+      g_array_append_val (signals, signal);
     }
   }
+  g_mutex_unlock (&self->lock);
+
+  for (i = 0; i < cps->len; i++) {
+    g_signal_emit (self, gst_timed_value_control_source_signals[g_array_index
+            (signals, guint, i)], 0, g_ptr_array_index (cps, i));
+  }
+  if (cps->len)
+    self->valid_cache = FALSE;
+
+  res = cps->len > 0;
+  g_array_free (signals, TRUE);
+  g_ptr_array_free (cps, TRUE);
+
   return res;
 }
 
@@ -333,6 +412,8 @@ gst_timed_value_control_source_unset (GstTimedValueControlSource * self,
      * we need to get the previous one and check the timestamp
      */
     cp = g_slice_dup (GstControlPoint, g_sequence_get (iter));
+    if (self->priv->cursor == iter)
+      self->priv->cursor = NULL;
     g_sequence_remove (iter);
     self->nvalues--;
     self->valid_cache = FALSE;
@@ -369,6 +450,7 @@ gst_timed_value_control_source_unset_all (GstTimedValueControlSource * self)
   }
   self->nvalues = 0;
   self->valid_cache = FALSE;
+  self->priv->cursor = NULL;
 
   g_mutex_unlock (&self->lock);
 }
@@ -435,6 +517,7 @@ gst_timed_value_control_invalidate_cache (GstTimedValueControlSource * self)
 static void
 gst_timed_value_control_source_init (GstTimedValueControlSource * self)
 {
+  self->priv = GST_TIMED_VALUE_CONTROL_SOURCE_GET_PRIVATE (self);
   g_mutex_init (&self->lock);
 }
 
@@ -458,6 +541,8 @@ gst_timed_value_control_source_class_init (GstTimedValueControlSourceClass
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   //GstControlSourceClass *csource_class = GST_CONTROL_SOURCE_CLASS (klass);
 
+  g_type_class_add_private (klass, sizeof (GstTimedValueControlSourcePrivate));
+
   /**
    * GstTimedValueControlSource::value-changed
    * @self: The #GstTimedValueControlSource on which a #GstTimedValue has changed
@@ -26,6 +26,10 @@
  * everything received there to stdout, while forwarding everything received
  * on stdout to those sockets.
  * Additionally it provides the MAC address of a network interface via stdout
+ *
+ * Where supported, each received packet is preceded by the time the kernel
+ * or the network card received it, so that the time spent forwarding it
+ * does not add to the measured delays.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -41,6 +45,15 @@
 #include <net/if.h>
 #include <netinet/in.h>
 #include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#if defined(SO_TIMESTAMPNS) && defined(SO_TIMESTAMPING)
+#define HAVE_RX_TIMESTAMPS 1
+#endif
+#endif
 
 #ifdef HAVE_GETIFADDRS_AF_LINK
 #include <ifaddrs.h>
@@ -70,6 +83,7 @@ static gchar **ifaces = NULL;
 static gboolean verbose = FALSE;
 static guint64 clock_id = (guint64) - 1;
 static guint8 clock_id_array[8];
+static gboolean hardware_timestamps = FALSE;
 
 static GOptionEntry opt_entries[] = {
   {"interface", 'i', 0, G_OPTION_ARG_STRING_ARRAY, &ifaces,
@@ -78,6 +92,8 @@ static GOptionEntry opt_entries[] = {
       "PTP clock id", NULL},
   {"verbose", 'v', 0, G_OPTION_ARG_NONE, &verbose,
       "Be verbose", NULL},
+  {"hardware-timestamps", 'H', 0, G_OPTION_ARG_NONE, &hardware_timestamps,
+      "Use the receive timestamps of the network card", NULL},
   {NULL}
 };
 
@@ -85,46 +101,150 @@ static GSocketAddress *event_saddr, *general_saddr;
 static GSocket *socket_event, *socket_general;
 static GIOChannel *stdin_channel, *stdout_channel;
 
+#ifdef HAVE_RX_TIMESTAMPS
+static void
+enable_timestamps (GSocket * socket)
+{
+  gint fd = g_socket_get_fd (socket);
+  gint on = 1;
+
+  /* Hardware timestamps are only usable if the clock of the network card is
+   * synchronized to the system time, e.g. with phc2sys, and hardware
+   * timestamping was enabled on the interface */
+  if (hardware_timestamps) {
+    gint flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+        | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+
+    if (setsockopt (fd, SOL_SOCKET, SO_TIMESTAMPING, &flags,
+            sizeof (flags)) == 0)
+      return;
+    g_warning ("Failed to enable hardware timestamps: %s",
+        g_strerror (errno));
+  }
+
+  if (setsockopt (fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof (on)) != 0)
+    g_warning ("Failed to enable receive timestamps: %s", g_strerror (errno));
+}
+
+static inline GstClockTime
+timespec_to_clock_time (const struct timespec *ts)
+{
+  return GST_TIMESPEC_TO_TIME (*ts);
+}
+
+/* Translates the realtime receive timestamp @ts to @mono, the monotonic
+ * time at @real. A timestamp that is not from a short time ago is from a
+ * clock that is not synchronized to the system time, FALSE is returned
+ * then */
 static gboolean
-have_socket_data_cb (GSocket * socket, GIOCondition condition,
-    gpointer user_data)
+translate_receive_time (const struct timespec *ts, GstClockTime real,
+    GstClockTime mono, GstClockTime * receive_time)
 {
-  gchar buffer[8192];
+  GstClockTimeDiff age;
+
+  if (ts->tv_sec == 0 && ts->tv_nsec == 0)
+    return FALSE;
+
+  age = GST_CLOCK_DIFF (timespec_to_clock_time (ts), real);
+  if (ABS (age) >= GST_SECOND || (age > 0 && age > mono))
+    return FALSE;
+
+  *receive_time = mono - age;
+  return TRUE;
+}
+
+/* Receives a packet together with the time the kernel or the network card
+ * received it, translated to the monotonic clock the PTP clock uses for its
+ * observations */
+static gssize
+receive_packet (GSocket * socket, gchar * buffer, gsize size,
+    GstClockTime * receive_time)
+{
+  gchar control[512];
+  struct iovec iov = { buffer, size };
+  struct msghdr msg = { 0, };
+  struct cmsghdr *cmsg;
+  struct timespec now_real, now_mono;
+  GstClockTime real, mono;
   gssize read;
-  gsize written;
+
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof (control);
+
+  do {
+    read = recvmsg (g_socket_get_fd (socket), &msg, 0);
+  } while (read == -1 && errno == EINTR);
+  if (read == -1)
+    g_error ("Failed to read from socket: %s", g_strerror (errno));
+
+  clock_gettime (CLOCK_REALTIME, &now_real);
+  clock_gettime (CLOCK_MONOTONIC, &now_mono);
+  real = timespec_to_clock_time (&now_real);
+  mono = timespec_to_clock_time (&now_mono);
+
+  /* without a usable timestamp the caller reads the clock itself */
+  *receive_time = GST_CLOCK_TIME_NONE;
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET)
+      continue;
+
+    if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      translate_receive_time ((struct timespec *) CMSG_DATA (cmsg), real,
+          mono, receive_time);
+    } else if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+      struct scm_timestamping *tss =
+          (struct scm_timestamping *) CMSG_DATA (cmsg);
+
+      /* the raw hardware timestamp if there is a usable one, the software
+       * timestamp of the kernel otherwise */
+      if (!translate_receive_time (&tss->ts[2], real, mono, receive_time))
+        translate_receive_time (&tss->ts[0], real, mono, receive_time);
+    }
+  }
+
+  return read;
+}
+#else
+static gssize
+receive_packet (GSocket * socket, gchar * buffer, gsize size,
+    GstClockTime * receive_time)
+{
   GError *err = NULL;
-  GIOStatus status;
-  StdIOHeader header = { 0, };
+  gssize read;
 
-  read = g_socket_receive (socket, buffer, sizeof (buffer), NULL, &err);
+  read = g_socket_receive (socket, buffer, size, NULL, &err);
   if (read == -1)
     g_error ("Failed to read from socket: %s", err->message);
   g_clear_error (&err);
 
-  if (verbose)
-    g_message ("Received %" G_GSSIZE_FORMAT " bytes from %s socket", read,
-        (socket == socket_event ? "event" : "general"));
+  /* the PTP clock takes the time itself */
+  *receive_time = GST_CLOCK_TIME_NONE;
 
-  header.size = read;
-  header.type = (socket == socket_event) ? TYPE_EVENT : TYPE_GENERAL;
+  return read;
+}
+#endif
 
-  status =
-      g_io_channel_write_chars (stdout_channel, (gchar *) & header,
-      sizeof (header), &written, &err);
-  if (status == G_IO_STATUS_ERROR) {
-    g_error ("Failed to write to stdout: %s", err->message);
-    g_clear_error (&err);
-  } else if (status == G_IO_STATUS_EOF) {
-    g_message ("EOF on stdout");
-    exit (0);
-  } else if (status != G_IO_STATUS_NORMAL) {
-    g_error ("Unexpected stdout write status: %d", status);
-  } else if (written != sizeof (header)) {
-    g_error ("Unexpected write size: %" G_GSIZE_FORMAT, written);
-  }
+/* Writes the header and the message in @buffer, which has room for the
+ * header in front of the message, with a single write so that the reader
+ * is woken up only once for it */
+static void
+write_message (guint8 type, gchar * buffer, gsize size)
+{
+  StdIOHeader header = { 0, };
+  GError *err = NULL;
+  GIOStatus status;
+  gsize written;
+
+  header.size = size;
+  header.type = type;
+  memcpy (buffer, &header, sizeof (header));
+  size += sizeof (header);
 
   status =
-      g_io_channel_write_chars (stdout_channel, buffer, read, &written, &err);
+      g_io_channel_write_chars (stdout_channel, buffer, size, &written, &err);
   if (status == G_IO_STATUS_ERROR) {
     g_error ("Failed to write to stdout: %s", err->message);
     g_clear_error (&err);
@@ -133,9 +253,32 @@ have_socket_data_cb (GSocket * socket, GIOCondition condition,
     exit (0);
   } else if (status != G_IO_STATUS_NORMAL) {
     g_error ("Unexpected stdout write status: %d", status);
-  } else if (written != read) {
+  } else if (written != size) {
     g_error ("Unexpected write size: %" G_GSIZE_FORMAT, written);
   }
+}
+
+static gboolean
+have_socket_data_cb (GSocket * socket, GIOCondition condition,
+    gpointer user_data)
+{
+  gchar buffer[sizeof (StdIOHeader) + 8192];
+  gchar *data = buffer + sizeof (StdIOHeader);
+  GstClockTime receive_time;
+  gssize read;
+
+  read = receive_packet (socket, data + sizeof (receive_time),
+      8192 - sizeof (receive_time), &receive_time);
+
+  if (verbose)
+    g_message ("Received %" G_GSSIZE_FORMAT " bytes from %s socket", read,
+        (socket == socket_event ? "event" : "general"));
+
+  /* the receive time goes in front of the packet */
+  memcpy (data, &receive_time, sizeof (receive_time));
+
+  write_message ((socket == socket_event) ? TYPE_EVENT : TYPE_GENERAL, buffer,
+      read + sizeof (receive_time));
 
   return G_SOURCE_CONTINUE;
 }
@@ -236,6 +379,14 @@ setup_sockets (void)
   g_clear_error (&err);
   g_socket_set_multicast_loopback (socket_general, FALSE);
 
+#ifdef HAVE_RX_TIMESTAMPS
+  enable_timestamps (socket_event);
+  enable_timestamps (socket_general);
+#else
+  if (hardware_timestamps)
+    g_warning ("Hardware timestamps are not supported on this platform");
+#endif
+
   /* Bind sockets */
   bind_addr = g_inet_address_new_any (G_SOCKET_FAMILY_IPV4);
   bind_saddr = g_inet_socket_address_new (bind_addr, PTP_EVENT_PORT);
@@ -592,44 +743,12 @@ setup_stdio_channels (void)
 static void
 write_clock_id (void)
 {
-  GError *err = NULL;
-  GIOStatus status;
-  StdIOHeader header = { 0, };
-  gsize written;
+  gchar buffer[sizeof (StdIOHeader) + sizeof (clock_id_array)];
 
   /* Write clock id to stdout */
-
-  header.type = TYPE_CLOCK_ID;
-  header.size = 8;
-  status =
-      g_io_channel_write_chars (stdout_channel, (gchar *) & header,
-      sizeof (header), &written, &err);
-  if (status == G_IO_STATUS_ERROR) {
-    g_error ("Failed to write to stdout: %s", err->message);
-    g_clear_error (&err);
-  } else if (status == G_IO_STATUS_EOF) {
-    g_message ("EOF on stdout");
-    exit (0);
-  } else if (status != G_IO_STATUS_NORMAL) {
-    g_error ("Unexpected stdout write status: %d", status);
-  } else if (written != sizeof (header)) {
-    g_error ("Unexpected write size: %" G_GSIZE_FORMAT, written);
-  }
-
-  status =
-      g_io_channel_write_chars (stdout_channel,
-      (const gchar *) clock_id_array, sizeof (clock_id_array), &written, &err);
-  if (status == G_IO_STATUS_ERROR) {
-    g_error ("Failed to write to stdout: %s", err->message);
-    g_clear_error (&err);
-  } else if (status == G_IO_STATUS_EOF) {
-    g_message ("EOF on stdout");
-    exit (0);
-  } else if (status != G_IO_STATUS_NORMAL) {
-    g_error ("Unexpected stdout write status: %d", status);
-  } else if (written != sizeof (clock_id_array)) {
-    g_error ("Unexpected write size: %" G_GSIZE_FORMAT, written);
-  }
+  memcpy (buffer + sizeof (StdIOHeader), clock_id_array,
+      sizeof (clock_id_array));
+  write_message (TYPE_CLOCK_ID, buffer, sizeof (clock_id_array));
 }
 
 #ifdef __APPLE__
@@ -25,12 +25,90 @@
  * #GstNetAddressMeta can be used to store a network address (a #GSocketAddress)
  * in a #GstBuffer so that it network elements can track the to and from address
  * of the buffer.
+ *
+ * Elements that receive many packets from the same peers can use
+ * gst_buffer_add_net_address_meta_from_native(), which shares one
+ * #GSocketAddress between all the buffers from the same address instead of
+ * creating a new one for every packet. All the buffers of a #GstBufferList
+ * from a single peer can be tagged at once with
+ * gst_buffer_list_add_net_address_meta().
  */
 
 #include <string.h>
 
 #include "gstnetaddressmeta.h"
 
+/* recurring addresses share one GSocketAddress, at most this many are kept */
+#define MAX_INTERNED_ADDRESSES 256
+
+typedef struct
+{
+  gsize len;
+  gconstpointer data;
+} NativeAddress;
+
+static GMutex interned_lock;
+static GHashTable *interned_addresses;
+
+static guint
+native_address_hash (gconstpointer key)
+{
+  const NativeAddress *native = key;
+  const guint8 *data = native->data;
+  guint hash = 2166136261u;
+  gsize i;
+
+  for (i = 0; i < native->len; i++)
+    hash = (hash ^ data[i]) * 16777619u;
+
+  return hash;
+}
+
+static gboolean
+native_address_equal (gconstpointer a, gconstpointer b)
+{
+  const NativeAddress *native_a = a;
+  const NativeAddress *native_b = b;
+
+  return native_a->len == native_b->len &&
+      memcmp (native_a->data, native_b->data, native_a->len) == 0;
+}
+
+static GSocketAddress *
+intern_native_address (gconstpointer data, gsize len)
+{
+  NativeAddress key = { len, data };
+  GSocketAddress *addr;
+
+  g_mutex_lock (&interned_lock);
+  if (interned_addresses == NULL)
+    interned_addresses = g_hash_table_new_full (native_address_hash,
+        native_address_equal, g_free, g_object_unref);
+
+  addr = g_hash_table_lookup (interned_addresses, &key);
+  if (addr != NULL) {
+    g_object_ref (addr);
+  } else {
+    addr = g_socket_address_new_from_native ((gpointer) data, len);
+    if (addr != NULL) {
+      NativeAddress *copy;
+
+      /* forget all when full, the recurring peers are added again soon */
+      if (g_hash_table_size (interned_addresses) >= MAX_INTERNED_ADDRESSES)
+        g_hash_table_remove_all (interned_addresses);
+
+      copy = g_malloc (sizeof (NativeAddress) + len);
+      copy->len = len;
+      copy->data = copy + 1;
+      memcpy (copy + 1, data, len);
+      g_hash_table_insert (interned_addresses, copy, g_object_ref (addr));
+    }
+  }
+  g_mutex_unlock (&interned_lock);
+
+  return addr;
+}
+
 static gboolean
 net_address_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
 {
@@ -136,3 +214,114 @@ gst_buffer_get_net_address_meta (GstBuffer * buffer)
   return (GstNetAddressMeta *)
       gst_buffer_get_meta (buffer, GST_NET_ADDRESS_META_API_TYPE);
 }
+
+/**
+ * gst_buffer_add_net_address_meta_from_native:
+ * @buffer: a #GstBuffer
+ * @native: (array length=len) (element-type guint8): a native
+ *     struct sockaddr
+ * @len: the size of @native
+ *
+ * Attaches the address in @native as metadata in a #GstNetAddressMeta to
+ * @buffer. Buffers with the same native address, such as the ones received
+ * from the same peer, share the same #GSocketAddress so that no new object
+ * is made for every buffer.
+ *
+ * Returns: (transfer none): a #GstNetAddressMeta connected to @buffer or
+ * %NULL when @native is not a valid address.
+ *
+ * Since: 1.14
+ */
+GstNetAddressMeta *
+gst_buffer_add_net_address_meta_from_native (GstBuffer * buffer,
+    gconstpointer native, gsize len)
+{
+  GstNetAddressMeta *meta;
+  GSocketAddress *addr;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (native != NULL, NULL);
+
+  addr = intern_native_address (native, len);
+  if (addr == NULL)
+    return NULL;
+
+  meta =
+      (GstNetAddressMeta *) gst_buffer_add_meta (buffer,
+      GST_NET_ADDRESS_META_INFO, NULL);
+
+  meta->addr = addr;
+
+  return meta;
+}
+
+static gboolean
+add_net_address_meta (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  GSocketAddress *addr = user_data;
+
+  *buffer = gst_buffer_make_writable (*buffer);
+  gst_buffer_add_net_address_meta (*buffer, addr);
+
+  return TRUE;
+}
+
+/**
+ * gst_buffer_list_add_net_address_meta:
+ * @list: a writable #GstBufferList
+ * @addr: a @GSocketAddress to connect to the buffers in @list
+ *
+ * Attaches @addr as metadata in a #GstNetAddressMeta to all buffers in
+ * @list, for a list of buffers from or to a single peer. The buffers are
+ * made writable when needed and share @addr.
+ *
+ * Since: 1.14
+ */
+void
+gst_buffer_list_add_net_address_meta (GstBufferList * list,
+    GSocketAddress * addr)
+{
+  g_return_if_fail (GST_IS_BUFFER_LIST (list));
+  g_return_if_fail (gst_buffer_list_is_writable (list));
+  g_return_if_fail (G_IS_SOCKET_ADDRESS (addr));
+
+  gst_buffer_list_foreach (list, add_net_address_meta, addr);
+}
+
+/**
+ * gst_buffer_list_get_net_address:
+ * @list: a #GstBufferList
+ *
+ * Get the address of the #GstNetAddressMeta that all buffers in @list
+ * share, as they do after gst_buffer_list_add_net_address_meta() or when
+ * they got their address from the same native address with
+ * gst_buffer_add_net_address_meta_from_native(). This allows sending or
+ * handling the whole list at once for a single peer.
+ *
+ * Returns: (transfer none) (nullable): the #GSocketAddress of all buffers
+ * in @list or %NULL when the list is empty or not all buffers have the same
+ * address.
+ *
+ * Since: 1.14
+ */
+GSocketAddress *
+gst_buffer_list_get_net_address (GstBufferList * list)
+{
+  GSocketAddress *addr = NULL;
+  guint i, len;
+
+  g_return_val_if_fail (GST_IS_BUFFER_LIST (list), NULL);
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++) {
+    GstNetAddressMeta *meta;
+
+    meta = gst_buffer_get_net_address_meta (gst_buffer_list_get (list, i));
+    if (meta == NULL || (addr != NULL && meta->addr != addr))
+      return NULL;
+
+    addr = meta->addr;
+  }
+
+  return addr;
+}
@@ -56,6 +56,17 @@ GstNetAddressMeta * gst_buffer_add_net_address_meta (GstBuffer      *buffer,
 GST_EXPORT
 GstNetAddressMeta * gst_buffer_get_net_address_meta (GstBuffer      *buffer);
 
+GST_EXPORT
+GstNetAddressMeta * gst_buffer_add_net_address_meta_from_native (GstBuffer     *buffer,
+                                                                 gconstpointer  native,
+                                                                 gsize          len);
+
+GST_EXPORT
+void                gst_buffer_list_add_net_address_meta (GstBufferList  *list,
+                                                          GSocketAddress *addr);
+GST_EXPORT
+GSocketAddress *    gst_buffer_list_get_net_address      (GstBufferList  *list);
+
 G_END_DECLS
 
 #endif /* __GST_NET_ADDRESS_META_H__ */
@@ -41,6 +41,12 @@
  * This clock will poll the time provider and will update its calibration
  * parameters based on the local and remote observations.
  *
+ * The address can also be a comma separated list of time providers, where
+ * each entry can have its own port as in "host:port" or "[address]:port".
+ * All of them are then polled at the same time and the reply with the
+ * shortest round trip of those that agree with the majority of the time
+ * providers is used. Time providers that are off are ignored this way.
+ *
  * The "round-trip" property limits the maximum round trip packets can take.
  *
  * Various parameters of the clock can be configured with the parent #GstClock
@@ -113,6 +119,13 @@ G_GNUC_INTERNAL GType gst_net_client_internal_clock_get_type (void);
 
 #define MEDIAN_PRE_FILTERING_WINDOW 9
 
+/* A reply of one of the time providers in the current poll round */
+typedef struct
+{
+  gboolean valid;
+  GstClockTime local_1, remote_1, remote_2, local_2;
+} ServerReply;
+
 enum
 {
   PROP_0,
@@ -134,7 +147,9 @@ struct _GstNetClientInternalClock
   GThread *thread;
 
   GSocket *socket;
-  GSocketAddress *servaddr;
+  /* more than one if the address is a comma separated list */
+  GSocketAddress **servaddrs;
+  guint n_servaddrs;
   GCancellable *cancel;
   gboolean made_cancel_fd;
 
@@ -147,6 +162,12 @@ struct _GstNetClientInternalClock
   GstClockTime last_rtts[MEDIAN_PRE_FILTERING_WINDOW];
   gint last_rtts_missing;
 
+  /* replies of the current round when polling several time providers,
+   * round_expiration is GST_CLOCK_TIME_NONE if no round is in progress */
+  ServerReply *replies;
+  guint n_replies;
+  GstClockTime round_start, round_expiration;
+
   gchar *address;
   gint port;
   gboolean is_ntp;
@@ -221,7 +242,9 @@ gst_net_client_internal_clock_init (GstNetClientInternalClock * self)
 
   self->thread = NULL;
 
-  self->servaddr = NULL;
+  self->servaddrs = NULL;
+  self->n_servaddrs = 0;
+  self->round_expiration = GST_CLOCK_TIME_NONE;
   self->rtt_avg = GST_CLOCK_TIME_NONE;
   self->roundtrip_limit = DEFAULT_ROUNDTRIP_LIMIT;
   self->minimum_update_interval = DEFAULT_MINIMUM_UPDATE_INTERVAL;
@@ -230,6 +253,23 @@ gst_net_client_internal_clock_init (GstNetClientInternalClock * self)
   self->last_rtts_missing = MEDIAN_PRE_FILTERING_WINDOW;
 }
 
+static void
+free_servaddrs (GstNetClientInternalClock * self)
+{
+  guint i;
+
+  for (i = 0; i < self->n_servaddrs; i++)
+    g_object_unref (self->servaddrs[i]);
+  g_free (self->servaddrs);
+  self->servaddrs = NULL;
+  self->n_servaddrs = 0;
+
+  g_free (self->replies);
+  self->replies = NULL;
+  self->n_replies = 0;
+  self->round_expiration = GST_CLOCK_TIME_NONE;
+}
+
 static void
 gst_net_client_internal_clock_finalize (GObject * object)
 {
@@ -242,10 +282,7 @@ gst_net_client_internal_clock_finalize (GObject * object)
   g_free (self->address);
   self->address = NULL;
 
-  if (self->servaddr != NULL) {
-    g_object_unref (self->servaddr);
-    self->servaddr = NULL;
-  }
+  free_servaddrs (self);
 
   if (self->socket != NULL) {
     if (!g_socket_close (self->socket, NULL))
@@ -634,6 +671,227 @@ bogus_observation:
   return;
 }
 
+static gint
+compare_clock_time_diff (const GstClockTimeDiff * a,
+    const GstClockTimeDiff * b)
+{
+  if (*a < *b)
+    return -1;
+  else if (*a > *b)
+    return 1;
+  return 0;
+}
+
+/* median of the @values of the valid replies, of which there is at least
+ * one, @tmp has room for all of them */
+static GstClockTimeDiff
+median_of_valid (GstNetClientInternalClock * self,
+    const GstClockTimeDiff * values, GstClockTimeDiff * tmp)
+{
+  guint i, n = 0;
+
+  for (i = 0; i < self->n_servaddrs; i++) {
+    if (self->replies[i].valid)
+      tmp[n++] = values[i];
+  }
+
+  g_qsort_with_data (tmp, n, sizeof (GstClockTimeDiff),
+      (GCompareDataFunc) compare_clock_time_diff, NULL);
+
+  if (n % 2)
+    return tmp[n / 2];
+
+  return tmp[n / 2 - 1] + (tmp[n / 2] - tmp[n / 2 - 1]) / 2;
+}
+
+/* Selects one of the replies of the current round and feeds it to
+ * gst_net_client_internal_clock_observe_times().
+ *
+ * The true offset to the remote clock is within half a round trip of the
+ * offset measured with each reply. Time providers whose offset is further
+ * away from the median offset of all replies than their round trip plus the
+ * median round trip are considered wrong and ignored, and the reply with the
+ * shortest round trip of the remaining ones is used. If no majority of the
+ * time providers agrees, the round is dropped. */
+static void
+gst_net_client_internal_clock_process_round (GstNetClientInternalClock * self)
+{
+  GstClockTimeDiff *offsets, *rtts, *sorted, median, median_rtt;
+  GstClockTimeDiff best_rtt = 0;
+  ServerReply *reply;
+  guint i, n_valid = 0, n_agree = 0;
+  gint best = -1;
+
+  self->round_expiration = GST_CLOCK_TIME_NONE;
+
+  offsets = g_newa (GstClockTimeDiff, self->n_servaddrs);
+  rtts = g_newa (GstClockTimeDiff, self->n_servaddrs);
+  sorted = g_newa (GstClockTimeDiff, self->n_servaddrs);
+
+  for (i = 0; i < self->n_servaddrs; i++) {
+    reply = &self->replies[i];
+    if (!reply->valid)
+      continue;
+
+    /* broken replies are rejected by observe_times() */
+    if (reply->local_2 < reply->local_1 || reply->remote_2 < reply->remote_1) {
+      reply->valid = FALSE;
+      continue;
+    }
+
+    offsets[i] = GST_CLOCK_DIFF ((reply->local_1 + reply->local_2) / 2,
+        (reply->remote_1 + reply->remote_2) / 2);
+    rtts[i] = MAX (0, GST_CLOCK_DIFF (reply->local_1, reply->local_2) -
+        GST_CLOCK_DIFF (reply->remote_1, reply->remote_2));
+    n_valid++;
+  }
+
+  if (n_valid == 0) {
+    GST_DEBUG_OBJECT (self, "no valid replies in this round");
+    goto drop_round;
+  }
+
+  median = median_of_valid (self, offsets, sorted);
+  median_rtt = median_of_valid (self, rtts, sorted);
+
+  for (i = 0; i < self->n_servaddrs; i++) {
+    if (!self->replies[i].valid)
+      continue;
+
+    if (ABS (offsets[i] - median) > rtts[i] + median_rtt) {
+      GST_DEBUG_OBJECT (self, "time provider %u is off by %" G_GINT64_FORMAT
+          "ns from the median, ignoring it", i, offsets[i] - median);
+      continue;
+    }
+
+    n_agree++;
+    if (best == -1 || rtts[i] < best_rtt) {
+      best = i;
+      best_rtt = rtts[i];
+    }
+  }
+
+  if (n_agree * 2 <= n_valid) {
+    GST_WARNING_OBJECT (self, "only %u of %u time providers agree", n_agree,
+        n_valid);
+    goto drop_round;
+  }
+
+  GST_LOG_OBJECT (self, "using time provider %d, %u of %u agree", best,
+      n_agree, n_valid);
+
+  reply = &self->replies[best];
+  gst_net_client_internal_clock_observe_times (self, reply->local_1,
+      reply->remote_1, reply->remote_2, reply->local_2);
+  return;
+
+drop_round:
+  self->timeout_expiration = gst_util_get_timestamp () + (GST_SECOND / 4);
+  return;
+}
+
+static gint
+gst_net_client_internal_clock_find_server (GstNetClientInternalClock * self,
+    GSocketAddress * address)
+{
+  GInetSocketAddress *inet_address;
+  guint i;
+
+  if (!G_IS_INET_SOCKET_ADDRESS (address))
+    return -1;
+  inet_address = G_INET_SOCKET_ADDRESS (address);
+
+  for (i = 0; i < self->n_servaddrs; i++) {
+    GInetSocketAddress *servaddr = G_INET_SOCKET_ADDRESS (self->servaddrs[i]);
+
+    if (g_inet_socket_address_get_port (servaddr) ==
+        g_inet_socket_address_get_port (inet_address)
+        && g_inet_address_equal (g_inet_socket_address_get_address (servaddr),
+            g_inet_socket_address_get_address (inet_address)))
+      return i;
+  }
+
+  return -1;
+}
+
+/* With a single time provider the reply is used directly, otherwise it is
+ * kept until all time providers replied or the round expired */
+static void
+gst_net_client_internal_clock_handle_reply (GstNetClientInternalClock * self,
+    GSocketAddress * src_address, GstClockTime local_1, GstClockTime remote_1,
+    GstClockTime remote_2, GstClockTime local_2)
+{
+  ServerReply *reply;
+  gint idx;
+
+  if (self->n_servaddrs == 1) {
+    gst_net_client_internal_clock_observe_times (self, local_1, remote_1,
+        remote_2, local_2);
+    return;
+  }
+
+  idx = gst_net_client_internal_clock_find_server (self, src_address);
+  if (idx == -1) {
+    GST_LOG_OBJECT (self, "ignoring reply from unknown address");
+    return;
+  }
+
+  /* replies to the packets of an earlier round */
+  if (!GST_CLOCK_TIME_IS_VALID (self->round_expiration)
+      || local_1 < self->round_start) {
+    GST_LOG_OBJECT (self, "ignoring late reply of time provider %d", idx);
+    return;
+  }
+
+  reply = &self->replies[idx];
+  if (reply->valid)
+    return;
+
+  reply->valid = TRUE;
+  reply->local_1 = local_1;
+  reply->remote_1 = remote_1;
+  reply->remote_2 = remote_2;
+  reply->local_2 = local_2;
+
+  if (++self->n_replies == self->n_servaddrs)
+    gst_net_client_internal_clock_process_round (self);
+}
+
+static void
+gst_net_client_internal_clock_send (GstNetClientInternalClock * self,
+    GSocketAddress * servaddr)
+{
+  if (self->is_ntp) {
+    GstNtpPacket *packet;
+
+    packet = gst_ntp_packet_new (NULL, NULL);
+
+    packet->transmit_time = gst_clock_get_internal_time (GST_CLOCK_CAST (self));
+
+    GST_DEBUG_OBJECT (self,
+        "sending packet, local time = %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (packet->transmit_time));
+
+    gst_ntp_packet_send (packet, self->socket, servaddr, NULL);
+
+    g_free (packet);
+  } else {
+    GstNetTimePacket *packet;
+
+    packet = gst_net_time_packet_new (NULL);
+
+    packet->local_time = gst_clock_get_internal_time (GST_CLOCK_CAST (self));
+
+    GST_DEBUG_OBJECT (self,
+        "sending packet, local time = %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (packet->local_time));
+
+    gst_net_time_packet_send (packet, self->socket, servaddr, NULL);
+
+    g_free (packet);
+  }
+}
+
 static gpointer
 gst_net_client_internal_clock_thread (gpointer data)
 {
@@ -650,8 +908,16 @@ gst_net_client_internal_clock_thread (gpointer data)
   while (!g_cancellable_is_cancelled (self->cancel)) {
     GstClockTime expiration_time = self->timeout_expiration;
     GstClockTime now = gst_util_get_timestamp ();
+    GSocketAddress *src_address = NULL;
+    /* storage for the native sender address, big enough for any family */
+    guint64 native_address[16];
+    gsize native_address_len = sizeof (native_address);
     gint64 socket_timeout;
 
+    /* the round of replies is completed before the next packets are sent */
+    if (GST_CLOCK_TIME_IS_VALID (self->round_expiration))
+      expiration_time = MIN (expiration_time, self->round_expiration);
+
     if (now >= expiration_time || (expiration_time - now) <= GST_MSECOND) {
       socket_timeout = 0;
     } else {
@@ -668,7 +934,18 @@ gst_net_client_internal_clock_thread (gpointer data)
         g_clear_error (&err);
         break;
       } else if (err->code == G_IO_ERROR_TIMED_OUT) {
+        GstClockTime round_timeout;
         gint new_qos_dscp;
+        guint i;
+
+        if (GST_CLOCK_TIME_IS_VALID (self->round_expiration) &&
+            gst_util_get_timestamp () + GST_MSECOND >= self->round_expiration) {
+          GST_DEBUG_OBJECT (self, "round timed out with %u of %u replies",
+              self->n_replies, self->n_servaddrs);
+          gst_net_client_internal_clock_process_round (self);
+          g_clear_error (&err);
+          continue;
+        }
 
         /* timed out, let's send another packet */
         GST_DEBUG_OBJECT (self, "timed out");
@@ -681,38 +958,25 @@ gst_net_client_internal_clock_thread (gpointer data)
           cur_qos_dscp = new_qos_dscp;
         }
 
-        if (self->is_ntp) {
-          GstNtpPacket *packet;
-
-          packet = gst_ntp_packet_new (NULL, NULL);
-
-          packet->transmit_time =
-              gst_clock_get_internal_time (GST_CLOCK_CAST (self));
-
-          GST_DEBUG_OBJECT (self,
-              "sending packet, local time = %" GST_TIME_FORMAT,
-              GST_TIME_ARGS (packet->transmit_time));
-
-          gst_ntp_packet_send (packet, self->socket, self->servaddr, NULL);
-
-          g_free (packet);
-        } else {
-          GstNetTimePacket *packet;
-
-          packet = gst_net_time_packet_new (NULL);
-
-          packet->local_time =
+        if (self->n_servaddrs > 1) {
+          /* start a new round, the replies are collected for at most the
+           * round-trip limit */
+          memset (self->replies, 0, self->n_servaddrs * sizeof (ServerReply));
+          self->n_replies = 0;
+          self->round_start =
               gst_clock_get_internal_time (GST_CLOCK_CAST (self));
 
-          GST_DEBUG_OBJECT (self,
-              "sending packet, local time = %" GST_TIME_FORMAT,
-              GST_TIME_ARGS (packet->local_time));
-
-          gst_net_time_packet_send (packet, self->socket, self->servaddr, NULL);
-
-          g_free (packet);
+          round_timeout = gst_clock_get_timeout (GST_CLOCK_CAST (self));
+          GST_OBJECT_LOCK (self);
+          if (self->roundtrip_limit > 0)
+            round_timeout = MIN (round_timeout, self->roundtrip_limit);
+          GST_OBJECT_UNLOCK (self);
+          self->round_expiration = gst_util_get_timestamp () + round_timeout;
         }
 
+        for (i = 0; i < self->n_servaddrs; i++)
+          gst_net_client_internal_clock_send (self, self->servaddrs[i]);
+
         /* reset timeout (but are expecting a response sooner anyway) */
         self->timeout_expiration =
             gst_util_get_timestamp () +
@@ -730,38 +994,41 @@ gst_net_client_internal_clock_thread (gpointer data)
       new_local = gst_clock_get_internal_time (GST_CLOCK_CAST (self));
 
       if (self->is_ntp) {
-        GstNtpPacket *packet;
+        GstNtpPacket packet;
 
-        packet = gst_ntp_packet_receive (socket, NULL, &err);
-
-        if (packet != NULL) {
+        if (gst_ntp_packet_receive_into (socket, &packet, native_address,
+                &native_address_len, &err)) {
           GST_LOG_OBJECT (self, "got packet back");
           GST_LOG_OBJECT (self, "local_1 = %" GST_TIME_FORMAT,
-              GST_TIME_ARGS (packet->origin_time));
+              GST_TIME_ARGS (packet.origin_time));
           GST_LOG_OBJECT (self, "remote_1 = %" GST_TIME_FORMAT,
-              GST_TIME_ARGS (packet->receive_time));
+              GST_TIME_ARGS (packet.receive_time));
           GST_LOG_OBJECT (self, "remote_2 = %" GST_TIME_FORMAT,
-              GST_TIME_ARGS (packet->transmit_time));
+              GST_TIME_ARGS (packet.transmit_time));
           GST_LOG_OBJECT (self, "local_2 = %" GST_TIME_FORMAT,
               GST_TIME_ARGS (new_local));
           GST_LOG_OBJECT (self, "poll_interval = %" GST_TIME_FORMAT,
-              GST_TIME_ARGS (packet->poll_interval));
+              GST_TIME_ARGS (packet.poll_interval));
 
           /* Remember the last poll interval we ever got from the server */
-          if (packet->poll_interval != GST_CLOCK_TIME_NONE)
-            self->last_remote_poll_interval = packet->poll_interval;
+          if (packet.poll_interval != GST_CLOCK_TIME_NONE)
+            self->last_remote_poll_interval = packet.poll_interval;
+
+          /* the sender only matters to tell several servers apart */
+          if (self->n_servaddrs > 1 && native_address_len > 0)
+            src_address = g_socket_address_new_from_native (native_address,
+                native_address_len);
 
           /* observe_times will reset the timeout */
-          gst_net_client_internal_clock_observe_times (self,
-              packet->origin_time, packet->receive_time, packet->transmit_time,
+          gst_net_client_internal_clock_handle_reply (self, src_address,
+              packet.origin_time, packet.receive_time, packet.transmit_time,
               new_local);
-
-          g_free (packet);
         } else if (err != NULL) {
           if (g_error_matches (err, GST_NTP_ERROR, GST_NTP_ERROR_WRONG_VERSION)
               || g_error_matches (err, GST_NTP_ERROR, GST_NTP_ERROR_KOD_DENY)) {
             GST_ERROR_OBJECT (self, "fatal receive error: %s", err->message);
             g_clear_error (&err);
+            g_clear_object (&src_address);
             break;
           } else if (g_error_matches (err, GST_NTP_ERROR,
                   GST_NTP_ERROR_KOD_RATE)) {
@@ -785,35 +1052,102 @@ gst_net_client_internal_clock_thread (gpointer data)
           g_clear_error (&err);
         }
       } else {
-        GstNetTimePacket *packet;
+        GstNetTimePacket packet;
 
-        packet = gst_net_time_packet_receive (socket, NULL, &err);
-
-        if (packet != NULL) {
+        if (gst_net_time_packet_receive_into (socket, &packet, native_address,
+                &native_address_len, &err)) {
           GST_LOG_OBJECT (self, "got packet back");
           GST_LOG_OBJECT (self, "local_1 = %" GST_TIME_FORMAT,
-              GST_TIME_ARGS (packet->local_time));
+              GST_TIME_ARGS (packet.local_time));
           GST_LOG_OBJECT (self, "remote = %" GST_TIME_FORMAT,
-              GST_TIME_ARGS (packet->remote_time));
+              GST_TIME_ARGS (packet.remote_time));
           GST_LOG_OBJECT (self, "local_2 = %" GST_TIME_FORMAT,
               GST_TIME_ARGS (new_local));
 
-          /* observe_times will reset the timeout */
-          gst_net_client_internal_clock_observe_times (self, packet->local_time,
-              packet->remote_time, packet->remote_time, new_local);
+          if (self->n_servaddrs > 1 && native_address_len > 0)
+            src_address = g_socket_address_new_from_native (native_address,
+                native_address_len);
 
-          g_free (packet);
+          /* observe_times will reset the timeout */
+          gst_net_client_internal_clock_handle_reply (self, src_address,
+              packet.local_time, packet.remote_time, packet.remote_time,
+              new_local);
         } else if (err != NULL) {
           GST_WARNING_OBJECT (self, "receive error: %s", err->message);
           g_clear_error (&err);
         }
       }
+
+      g_clear_object (&src_address);
     }
   }
   GST_INFO_OBJECT (self, "shutting down net client clock thread");
   return NULL;
 }
 
+/* Resolves one entry of the address list, which is an address or hostname
+ * that is optionally followed by a port as in "host:port" or "[addr]:port" */
+static GSocketAddress *
+resolve_server_address (const gchar * entry, gint default_port,
+    GError ** err)
+{
+  GInetAddress *inetaddr;
+  GSocketAddress *servaddr;
+  const gchar *colon = NULL;
+  gchar *host;
+  guint64 port = default_port;
+
+  if (entry[0] == '[' && strchr (entry, ']')) {
+    const gchar *end = strchr (entry, ']');
+
+    host = g_strndup (entry + 1, end - entry - 1);
+    if (end[1] == ':')
+      colon = end + 1;
+  } else if ((colon = strchr (entry, ':')) && colon == strrchr (entry, ':')) {
+    host = g_strndup (entry, colon - entry);
+  } else {
+    /* an IPv6 address without port */
+    colon = NULL;
+    host = g_strdup (entry);
+  }
+
+  if (colon) {
+    gchar *end;
+
+    port = g_ascii_strtoull (colon + 1, &end, 10);
+    if (colon[1] == '\0' || *end != '\0' || port == 0 || port > G_MAXUINT16) {
+      g_set_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+          "Invalid port in '%s'", entry);
+      g_free (host);
+      return NULL;
+    }
+  }
+
+  inetaddr = g_inet_address_new_from_string (host);
+  if (inetaddr == NULL) {
+    GResolver *resolver;
+    GList *results;
+
+    resolver = g_resolver_get_default ();
+    results = g_resolver_lookup_by_name (resolver, host, NULL, err);
+    g_object_unref (resolver);
+
+    if (!results) {
+      g_free (host);
+      return NULL;
+    }
+
+    inetaddr = G_INET_ADDRESS (g_object_ref (results->data));
+    g_resolver_free_addresses (results);
+  }
+  g_free (host);
+
+  servaddr = g_inet_socket_address_new (inetaddr, port);
+  g_object_unref (inetaddr);
+
+  return servaddr;
+}
+
 static gboolean
 gst_net_client_internal_clock_start (GstNetClientInternalClock * self)
 {
@@ -823,39 +1157,53 @@ gst_net_client_internal_clock_start (GstNetClientInternalClock * self)
   GInetAddress *inetaddr;
   GSocket *socket;
   GError *error = NULL;
-  GSocketFamily family;
+  GSocketFamily family = G_SOCKET_FAMILY_INVALID;
   GPollFD dummy_pollfd;
-  GResolver *resolver = NULL;
   GError *err = NULL;
+  gchar **entries;
+  guint i, n_entries;
 
   g_return_val_if_fail (self->address != NULL, FALSE);
-  g_return_val_if_fail (self->servaddr == NULL, FALSE);
+  g_return_val_if_fail (self->servaddrs == NULL, FALSE);
 
-  /* create target address */
-  inetaddr = g_inet_address_new_from_string (self->address);
-  if (inetaddr == NULL) {
-    GList *results;
+  /* create target addresses, all of them must be of the same family as the
+   * first one as they are polled over a single socket */
+  entries = g_strsplit (self->address, ",", -1);
+  n_entries = g_strv_length (entries);
+  self->servaddrs = g_new0 (GSocketAddress *, MAX (n_entries, 1));
 
-    resolver = g_resolver_get_default ();
+  for (i = 0; i < n_entries; i++) {
+    gchar *entry = g_strstrip (entries[i]);
 
-    results = g_resolver_lookup_by_name (resolver, self->address, NULL, &err);
-    if (!results)
-      goto failed_to_resolve;
+    if (*entry == '\0')
+      continue;
 
-    inetaddr = G_INET_ADDRESS (g_object_ref (results->data));
-    g_resolver_free_addresses (results);
-    g_object_unref (resolver);
-  }
+    servaddr = resolve_server_address (entry, self->port, &err);
+    if (servaddr == NULL) {
+      GST_WARNING_OBJECT (self, "resolving '%s' failed: %s", entry,
+          err->message);
+      g_clear_error (&err);
+      continue;
+    }
 
-  family = g_inet_address_get_family (inetaddr);
+    if (family == G_SOCKET_FAMILY_INVALID) {
+      family = g_socket_address_get_family (servaddr);
+    } else if (g_socket_address_get_family (servaddr) != family) {
+      GST_WARNING_OBJECT (self, "ignoring '%s' of another address family",
+          entry);
+      g_object_unref (servaddr);
+      continue;
+    }
 
-  servaddr = g_inet_socket_address_new (inetaddr, self->port);
-  g_object_unref (inetaddr);
+    GST_DEBUG_OBJECT (self, "will communicate with %s", entry);
+    self->servaddrs[self->n_servaddrs++] = servaddr;
+  }
+  g_strfreev (entries);
 
-  g_assert (servaddr != NULL);
+  if (self->n_servaddrs == 0)
+    goto failed_to_resolve;
 
-  GST_DEBUG_OBJECT (self, "will communicate with %s:%d", self->address,
-      self->port);
+  self->replies = g_new0 (ServerReply, self->n_servaddrs);
 
   socket = g_socket_new (family, G_SOCKET_TYPE_DATAGRAM,
       G_SOCKET_PROTOCOL_UDP, &error);
@@ -889,7 +1237,6 @@ gst_net_client_internal_clock_start (GstNetClientInternalClock * self)
       g_cancellable_make_pollfd (self->cancel, &dummy_pollfd);
 
   self->socket = socket;
-  self->servaddr = G_SOCKET_ADDRESS (servaddr);
 
   self->thread = g_thread_try_new ("GstNetClientInternalClock",
       gst_net_client_internal_clock_thread, self, &error);
@@ -904,6 +1251,7 @@ no_socket:
   {
     GST_ERROR_OBJECT (self, "socket_new() failed: %s", error->message);
     g_error_free (error);
+    free_servaddrs (self);
     return FALSE;
   }
 bind_error:
@@ -911,6 +1259,7 @@ bind_error:
     GST_ERROR_OBJECT (self, "bind failed: %s", error->message);
     g_error_free (error);
     g_object_unref (socket);
+    free_servaddrs (self);
     return FALSE;
   }
 getsockname_error:
@@ -918,21 +1267,20 @@ getsockname_error:
     GST_ERROR_OBJECT (self, "get_local_address() failed: %s", error->message);
     g_error_free (error);
     g_object_unref (socket);
+    free_servaddrs (self);
     return FALSE;
   }
 failed_to_resolve:
   {
-    GST_ERROR_OBJECT (self, "resolving '%s' failed: %s",
-        self->address, err->message);
-    g_clear_error (&err);
-    g_object_unref (resolver);
+    GST_ERROR_OBJECT (self, "could not resolve any address of '%s'",
+        self->address);
+    free_servaddrs (self);
     return FALSE;
   }
 no_thread:
   {
     GST_ERROR_OBJECT (self, "could not create thread: %s", error->message);
-    g_object_unref (self->servaddr);
-    self->servaddr = NULL;
+    free_servaddrs (self);
     g_object_unref (self->socket);
     self->socket = NULL;
     g_error_free (error);
@@ -958,8 +1306,7 @@ gst_net_client_internal_clock_stop (GstNetClientInternalClock * self)
   g_object_unref (self->cancel);
   self->cancel = NULL;
 
-  g_object_unref (self->servaddr);
-  self->servaddr = NULL;
+  free_servaddrs (self);
 
   g_object_unref (self->socket);
   self->socket = NULL;
@@ -1019,8 +1366,8 @@ gst_net_client_clock_class_init (GstNetClientClockClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_ADDRESS,
       g_param_spec_string ("address", "address",
-          "The IP address of the machine providing a time server",
-          DEFAULT_ADDRESS,
+          "The IP address of the machine providing a time server, or a comma "
+          "separated list of them", DEFAULT_ADDRESS,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (gobject_class, PROP_PORT,
       g_param_spec_int ("port", "port",
@@ -1422,6 +1769,10 @@ gst_net_client_clock_get_internal_time (GstClock * clock)
  * provided by the #GstNetTimeProvider on @remote_address and
  * @remote_port.
  *
+ * Since 1.14 @remote_address can also be a comma separated list of time
+ * providers, optionally with their port as in "host:port", which are then
+ * all polled.
+ *
  * Returns: (transfer full): a new #GstClock that receives a time from the remote
  * clock.
  */
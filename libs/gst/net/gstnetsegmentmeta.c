@@ -0,0 +1,270 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstnetsegmentmeta
+ * @title: GstNetSegmentMeta
+ * @short_description: Network segmentation metadata
+ *
+ * #GstNetSegmentMeta marks a #GstBuffer that contains several network
+ * packets of the same size back to back, as they are given by a socket
+ * with generic receive offload or as they can be sent in one go with
+ * generic segmentation offload, such as with the UDP_SEGMENT socket option.
+ *
+ * A sink that supports segmentation offload can turn a #GstBufferList of
+ * packets into one such buffer with gst_buffer_list_merge_net_segments(),
+ * which does not copy the data. Elements that need the separate packets
+ * can get them with gst_buffer_split_net_segments().
+ *
+ * Since: 1.14
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstnetsegmentmeta.h"
+
+static gboolean
+net_segment_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  GstNetSegmentMeta *smeta = (GstNetSegmentMeta *) meta;
+
+  smeta->segment_size = 0;
+  smeta->n_segments = 0;
+
+  return TRUE;
+}
+
+static gboolean
+net_segment_meta_transform (GstBuffer * transbuf, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  GstNetSegmentMeta *smeta, *dmeta;
+  smeta = (GstNetSegmentMeta *) meta;
+
+  if (GST_META_TRANSFORM_IS_COPY (type)) {
+    GstMetaTransformCopy *copy = data;
+
+    /* a part of the buffer has other segments */
+    if (copy->region && (copy->offset != 0 ||
+            copy->size != gst_buffer_get_size (buffer)))
+      return TRUE;
+
+    dmeta = (GstNetSegmentMeta *) gst_buffer_add_meta (transbuf,
+        GST_NET_SEGMENT_META_INFO, NULL);
+    if (!dmeta)
+      return FALSE;
+
+    dmeta->segment_size = smeta->segment_size;
+    dmeta->n_segments = smeta->n_segments;
+  }
+
+  return TRUE;
+}
+
+GType
+gst_net_segment_meta_api_get_type (void)
+{
+  static volatile GType type;
+  static const gchar *tags[] = { GST_META_TAG_MEMORY_STR, NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstNetSegmentMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+const GstMetaInfo *
+gst_net_segment_meta_get_info (void)
+{
+  static const GstMetaInfo *meta_info = NULL;
+
+  if (g_once_init_enter ((GstMetaInfo **) & meta_info)) {
+    const GstMetaInfo *mi = gst_meta_register (GST_NET_SEGMENT_META_API_TYPE,
+        "GstNetSegmentMeta",
+        sizeof (GstNetSegmentMeta),
+        net_segment_meta_init, NULL, net_segment_meta_transform);
+    g_once_init_leave ((GstMetaInfo **) & meta_info, (GstMetaInfo *) mi);
+  }
+  return meta_info;
+}
+
+/**
+ * gst_buffer_add_net_segment_meta:
+ * @buffer: a #GstBuffer
+ * @segment_size: the size of the packets in @buffer
+ *
+ * Marks @buffer as containing packets of @segment_size bytes, only the last
+ * one can be smaller. The number of segments is taken from the current size
+ * of @buffer.
+ *
+ * Returns: (transfer none): a #GstNetSegmentMeta connected to @buffer
+ *
+ * Since: 1.14
+ */
+GstNetSegmentMeta *
+gst_buffer_add_net_segment_meta (GstBuffer * buffer, guint segment_size)
+{
+  GstNetSegmentMeta *meta;
+  gsize size;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (segment_size > 0, NULL);
+
+  size = gst_buffer_get_size (buffer);
+
+  meta =
+      (GstNetSegmentMeta *) gst_buffer_add_meta (buffer,
+      GST_NET_SEGMENT_META_INFO, NULL);
+
+  meta->segment_size = segment_size;
+  meta->n_segments = (size + segment_size - 1) / segment_size;
+
+  return meta;
+}
+
+/**
+ * gst_buffer_get_net_segment_meta:
+ * @buffer: a #GstBuffer
+ *
+ * Find the #GstNetSegmentMeta on @buffer.
+ *
+ * Returns: (transfer none): the #GstNetSegmentMeta or %NULL when there
+ * is no such metadata on @buffer.
+ *
+ * Since: 1.14
+ */
+GstNetSegmentMeta *
+gst_buffer_get_net_segment_meta (GstBuffer * buffer)
+{
+  return (GstNetSegmentMeta *)
+      gst_buffer_get_meta (buffer, GST_NET_SEGMENT_META_API_TYPE);
+}
+
+/**
+ * gst_buffer_list_merge_net_segments:
+ * @list: a #GstBufferList
+ *
+ * Make one buffer with all the packets in @list and a #GstNetSegmentMeta,
+ * so that it can be sent with segmentation offload. This is only possible
+ * when all buffers have the same size, only the last one can be smaller.
+ * The memory of the buffers is shared, the metadata and timestamps are the
+ * ones of the first buffer.
+ *
+ * A #GstBuffer can only hold gst_buffer_get_max_memory() memories without
+ * merging them into a copy, lists of buffers with more memories than that
+ * are not merged.
+ *
+ * Returns: (transfer full) (nullable): a new #GstBuffer or %NULL when the
+ * buffers of @list can not be merged.
+ *
+ * Since: 1.14
+ */
+GstBuffer *
+gst_buffer_list_merge_net_segments (GstBufferList * list)
+{
+  GstNetSegmentMeta *meta;
+  GstBuffer *first, *merged;
+  gsize segment_size;
+  guint i, len, n_mem;
+
+  g_return_val_if_fail (GST_IS_BUFFER_LIST (list), NULL);
+
+  len = gst_buffer_list_length (list);
+  if (len == 0)
+    return NULL;
+
+  first = gst_buffer_list_get (list, 0);
+  segment_size = gst_buffer_get_size (first);
+  if (segment_size == 0 || segment_size > G_MAXUINT)
+    return NULL;
+
+  n_mem = gst_buffer_n_memory (first);
+  for (i = 1; i < len; i++) {
+    GstBuffer *buf = gst_buffer_list_get (list, i);
+    gsize size = gst_buffer_get_size (buf);
+
+    if (size == 0 || size > segment_size ||
+        (size != segment_size && i != len - 1))
+      return NULL;
+
+    /* more memory would be merged into a copy */
+    n_mem += gst_buffer_n_memory (buf);
+    if (n_mem > gst_buffer_get_max_memory ())
+      return NULL;
+  }
+
+  merged = gst_buffer_copy (first);
+  for (i = 1; i < len; i++)
+    gst_buffer_copy_into (merged, gst_buffer_list_get (list, i),
+        GST_BUFFER_COPY_MEMORY, 0, -1);
+
+  meta = gst_buffer_get_net_segment_meta (merged);
+  if (meta != NULL) {
+    meta->segment_size = segment_size;
+    meta->n_segments = len;
+  } else {
+    gst_buffer_add_net_segment_meta (merged, segment_size);
+  }
+
+  return merged;
+}
+
+/**
+ * gst_buffer_split_net_segments:
+ * @buffer: a #GstBuffer
+ *
+ * Split @buffer into its packets as described by its #GstNetSegmentMeta,
+ * for elements that need the separate packets. The new buffers share the
+ * memory of @buffer and get its other metadata, the first one also gets its
+ * timestamps.
+ *
+ * Returns: (transfer full): a new #GstBufferList with the packets, or with
+ * only @buffer when it has no #GstNetSegmentMeta.
+ *
+ * Since: 1.14
+ */
+GstBufferList *
+gst_buffer_split_net_segments (GstBuffer * buffer)
+{
+  GstNetSegmentMeta *meta;
+  GstBufferList *list;
+  gsize offset, size;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+
+  meta = gst_buffer_get_net_segment_meta (buffer);
+  if (meta == NULL || meta->segment_size == 0) {
+    list = gst_buffer_list_new_sized (1);
+    gst_buffer_list_add (list, gst_buffer_ref (buffer));
+    return list;
+  }
+
+  size = gst_buffer_get_size (buffer);
+  list = gst_buffer_list_new_sized (meta->n_segments);
+  for (offset = 0; offset < size; offset += meta->segment_size) {
+    gsize len = MIN (meta->segment_size, size - offset);
+
+    gst_buffer_list_add (list, gst_buffer_copy_region (buffer,
+            GST_BUFFER_COPY_ALL, offset, len));
+  }
+
+  return list;
+}
@@ -0,0 +1,70 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_NET_SEGMENT_META_H__
+#define __GST_NET_SEGMENT_META_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstNetSegmentMeta GstNetSegmentMeta;
+
+/**
+ * GstNetSegmentMeta:
+ * @meta: the parent type
+ * @segment_size: the size of the segments
+ * @n_segments: the number of segments
+ *
+ * Buffer metadata for a buffer that contains @n_segments network packets of
+ * @segment_size bytes each, only the last one can be smaller.
+ *
+ * Since: 1.14
+ */
+struct _GstNetSegmentMeta {
+  GstMeta       meta;
+
+  guint         segment_size;
+  guint         n_segments;
+};
+
+GST_EXPORT
+GType gst_net_segment_meta_api_get_type (void);
+#define GST_NET_SEGMENT_META_API_TYPE (gst_net_segment_meta_api_get_type())
+
+/* implementation */
+
+GST_EXPORT
+const GstMetaInfo *gst_net_segment_meta_get_info (void);
+#define GST_NET_SEGMENT_META_INFO (gst_net_segment_meta_get_info())
+
+GST_EXPORT
+GstNetSegmentMeta * gst_buffer_add_net_segment_meta (GstBuffer * buffer,
+                                                     guint       segment_size);
+GST_EXPORT
+GstNetSegmentMeta * gst_buffer_get_net_segment_meta (GstBuffer * buffer);
+
+GST_EXPORT
+GstBuffer *         gst_buffer_list_merge_net_segments (GstBufferList * list);
+
+GST_EXPORT
+GstBufferList *     gst_buffer_split_net_segments      (GstBuffer     * buffer);
+
+G_END_DECLS
+
+#endif /* __GST_NET_SEGMENT_META_H__ */
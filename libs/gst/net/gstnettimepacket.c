@@ -41,10 +41,18 @@
 #endif
 
 #include "gstnettimepacket.h"
+#include "gstnetutils.h"
 
 G_DEFINE_BOXED_TYPE (GstNetTimePacket, gst_net_time_packet,
     gst_net_time_packet_copy, gst_net_time_packet_free);
 
+static void
+gst_net_time_packet_parse (GstNetTimePacket * packet, const guint8 * buffer)
+{
+  packet->local_time = GST_READ_UINT64_BE (buffer);
+  packet->remote_time = GST_READ_UINT64_BE (buffer + sizeof (GstClockTime));
+}
+
 /**
  * gst_net_time_packet_new:
  * @buffer: (array): a buffer from which to construct the packet, or NULL
@@ -70,8 +78,7 @@ gst_net_time_packet_new (const guint8 * buffer)
   ret = g_new0 (GstNetTimePacket, 1);
 
   if (buffer) {
-    ret->local_time = GST_READ_UINT64_BE (buffer);
-    ret->remote_time = GST_READ_UINT64_BE (buffer + sizeof (GstClockTime));
+    gst_net_time_packet_parse (ret, buffer);
   } else {
     ret->local_time = GST_CLOCK_TIME_NONE;
     ret->remote_time = GST_CLOCK_TIME_NONE;
@@ -198,6 +205,66 @@ short_packet:
   }
 }
 
+/**
+ * gst_net_time_packet_receive_into:
+ * @socket: socket to receive the time packet on
+ * @packet: the #GstNetTimePacket to fill
+ * @src_address: (allow-none): storage for the sender address as a native
+ *    struct sockaddr
+ * @src_address_len: (allow-none) (inout): the size of @src_address, set to
+ *    the size of the sender address
+ * @error: return address for a #GError, or NULL
+ *
+ * Receives a #GstNetTimePacket over a socket into @packet. Unlike
+ * gst_net_time_packet_receive() this allocates neither a packet nor a
+ * #GSocketAddress, so the same storage can be used for every packet. The
+ * sender address can be turned into a #GSocketAddress when needed with
+ * g_socket_address_new_from_native().
+ *
+ * MT safe.
+ *
+ * Returns: %TRUE if a packet was received, %FALSE on error.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_net_time_packet_receive_into (GSocket * socket,
+    GstNetTimePacket * packet, gpointer src_address, gsize * src_address_len,
+    GError ** error)
+{
+  guint8 buffer[GST_NET_TIME_PACKET_SIZE];
+  gssize ret;
+
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+  g_return_val_if_fail (packet != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  ret = gst_net_utils_receive_from (socket, buffer, GST_NET_TIME_PACKET_SIZE,
+      src_address, src_address_len, error);
+  if (ret < 0)
+    goto receive_error;
+  else if (ret < GST_NET_TIME_PACKET_SIZE)
+    goto short_packet;
+
+  gst_net_time_packet_parse (packet, buffer);
+
+  return TRUE;
+
+receive_error:
+  {
+    GST_DEBUG ("receive error");
+    return FALSE;
+  }
+short_packet:
+  {
+    GST_DEBUG ("someone sent us a short packet (%" G_GSSIZE_FORMAT " < %d)",
+        ret, GST_NET_TIME_PACKET_SIZE);
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+        "short time packet (%d < %d)", (int) ret, GST_NET_TIME_PACKET_SIZE);
+    return FALSE;
+  }
+}
+
 /**
  * gst_net_time_packet_send:
  * @packet: the #GstNetTimePacket to send
@@ -67,6 +67,12 @@ GstNetTimePacket*	gst_net_time_packet_receive     (GSocket         * socket,
                                                          GSocketAddress ** src_address,
                                                          GError         ** error);
 GST_EXPORT
+gboolean                gst_net_time_packet_receive_into (GSocket          * socket,
+                                                          GstNetTimePacket * packet,
+                                                          gpointer           src_address,
+                                                          gsize            * src_address_len,
+                                                          GError          ** error);
+GST_EXPORT
 gboolean                gst_net_time_packet_send        (const GstNetTimePacket * packet,
                                                          GSocket                * socket,
                                                          GSocketAddress         * dest_address,
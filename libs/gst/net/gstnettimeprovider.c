@@ -32,6 +32,10 @@
  * query the exposed clock over the network for its values.
  *
  * The #GstNetTimeProvider typically wraps the clock used by a #GstPipeline.
+ *
+ * The packets that arrived together are answered in batches, and several
+ * threads can serve the same socket with the "n-threads" property when a
+ * large number of clients is polling the provider.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -42,12 +46,18 @@
 #include "gstnettimepacket.h"
 #include "gstnetutils.h"
 
+#include <string.h>
+
 GST_DEBUG_CATEGORY_STATIC (ntp_debug);
 #define GST_CAT_DEFAULT (ntp_debug)
 
 #define DEFAULT_ADDRESS         "0.0.0.0"
 #define DEFAULT_PORT            5637
 #define DEFAULT_QOS_DSCP        -1
+#define DEFAULT_N_THREADS       1
+
+/* maximum number of packets that are received and answered at once */
+#define BATCH_SIZE 32
 
 #define IS_ACTIVE(self) (g_atomic_int_get (&((self)->priv->active)))
 
@@ -58,7 +68,8 @@ enum
   PROP_ADDRESS,
   PROP_CLOCK,
   PROP_ACTIVE,
-  PROP_QOS_DSCP
+  PROP_QOS_DSCP,
+  PROP_N_THREADS
 };
 
 #define GST_NET_TIME_PROVIDER_GET_PRIVATE(obj)  \
@@ -70,7 +81,8 @@ struct _GstNetTimeProviderPrivate
   int port;
   gint qos_dscp;                /* ATOMIC */
 
-  GThread *thread;
+  GThread **threads;
+  guint n_threads;
 
   GstClock *clock;
 
@@ -140,6 +152,20 @@ gst_net_time_provider_class_init (GstNetTimeProviderClass * klass)
           "Quality of Service, differentiated services code point (-1 default)",
           -1, 63, DEFAULT_QOS_DSCP,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetTimeProvider:n-threads:
+   *
+   * The number of threads that answer the packets of the clients, or 0 to use
+   * one per processor. All the threads serve the same socket.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads serving the clients (0 = number of processors)",
+          0, 1024, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -150,7 +176,8 @@ gst_net_time_provider_init (GstNetTimeProvider * self)
   self->priv->port = DEFAULT_PORT;
   self->priv->address = g_strdup (DEFAULT_ADDRESS);
   self->priv->qos_dscp = DEFAULT_QOS_DSCP;
-  self->priv->thread = NULL;
+  self->priv->threads = NULL;
+  self->priv->n_threads = DEFAULT_N_THREADS;
   self->priv->active = TRUE;
 }
 
@@ -159,9 +186,9 @@ gst_net_time_provider_finalize (GObject * object)
 {
   GstNetTimeProvider *self = GST_NET_TIME_PROVIDER (object);
 
-  if (self->priv->thread) {
+  if (self->priv->threads) {
     gst_net_time_provider_stop (self);
-    g_assert (self->priv->thread == NULL);
+    g_assert (self->priv->threads == NULL);
   }
 
   g_free (self->priv->address);
@@ -174,13 +201,136 @@ gst_net_time_provider_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* puts the time of the clock into a packet that is sent back */
+static inline void
+gst_net_time_provider_fill_packet (GstNetTimeProvider * self, guint8 * data)
+{
+  GST_WRITE_UINT64_BE (data + sizeof (GstClockTime),
+      gst_clock_get_time (self->priv->clock));
+}
+
+#if GLIB_CHECK_VERSION (2, 48, 0)
+/* Receives and answers the packets that are available, up to BATCH_SIZE at
+ * once. This uses recvmmsg() and sendmmsg() where available. */
+static gboolean
+gst_net_time_provider_serve (GstNetTimeProvider * self, GSocket * socket,
+    GError ** err)
+{
+  guint8 buffers[BATCH_SIZE][GST_NET_TIME_PACKET_SIZE];
+  GSocketAddress *addresses[BATCH_SIZE] = { NULL, };
+  GInputVector in_vectors[BATCH_SIZE];
+  GInputMessage in_msgs[BATCH_SIZE];
+  GOutputVector out_vectors[BATCH_SIZE];
+  GOutputMessage out_msgs[BATCH_SIZE];
+  gint n_received, n_out = 0, n_sent = 0, ret, i;
+
+  memset (in_msgs, 0, sizeof (in_msgs));
+  memset (out_msgs, 0, sizeof (out_msgs));
+
+  for (i = 0; i < BATCH_SIZE; i++) {
+    in_vectors[i].buffer = buffers[i];
+    in_vectors[i].size = GST_NET_TIME_PACKET_SIZE;
+    in_msgs[i].address = &addresses[i];
+    in_msgs[i].vectors = &in_vectors[i];
+    in_msgs[i].num_vectors = 1;
+  }
+
+  n_received = g_socket_receive_messages (socket, in_msgs, BATCH_SIZE, 0,
+      NULL, err);
+  if (n_received < 0)
+    return FALSE;
+
+  GST_LOG_OBJECT (self, "received %d packets", n_received);
+
+  for (i = 0; i < n_received; i++) {
+    if (in_msgs[i].bytes_received < GST_NET_TIME_PACKET_SIZE) {
+      GST_DEBUG_OBJECT (self, "someone sent us a short packet (%"
+          G_GSIZE_FORMAT " < %d)", in_msgs[i].bytes_received,
+          GST_NET_TIME_PACKET_SIZE);
+      continue;
+    }
+    if (addresses[i] == NULL || !IS_ACTIVE (self))
+      continue;
+
+    /* do what we were asked to and send the packet back */
+    gst_net_time_provider_fill_packet (self, buffers[i]);
+
+    out_vectors[n_out].buffer = buffers[i];
+    out_vectors[n_out].size = GST_NET_TIME_PACKET_SIZE;
+    out_msgs[n_out].address = addresses[i];
+    out_msgs[n_out].vectors = &out_vectors[n_out];
+    out_msgs[n_out].num_vectors = 1;
+    n_out++;
+  }
+
+  /* ignore errors */
+  while (n_sent < n_out) {
+    ret = g_socket_send_messages (socket, out_msgs + n_sent, n_out - n_sent,
+        0, NULL, NULL);
+    if (ret <= 0)
+      break;
+    n_sent += ret;
+  }
+
+  for (i = 0; i < n_received; i++)
+    g_clear_object (&addresses[i]);
+
+  return TRUE;
+}
+#else
+/* Receives and answers the packets that are available, up to BATCH_SIZE at
+ * once */
+static gboolean
+gst_net_time_provider_serve (GstNetTimeProvider * self, GSocket * socket,
+    GError ** err)
+{
+  guint8 buffer[GST_NET_TIME_PACKET_SIZE];
+  GSocketAddress *sender_addr;
+  GError *recv_err = NULL;
+  gssize ret;
+  guint i;
+
+  for (i = 0; i < BATCH_SIZE; i++) {
+    sender_addr = NULL;
+    ret = g_socket_receive_from (socket, &sender_addr, (gchar *) buffer,
+        GST_NET_TIME_PACKET_SIZE, NULL, &recv_err);
+
+    if (ret < 0) {
+      /* the packets that arrived so far were all answered */
+      if (i > 0 && g_error_matches (recv_err, G_IO_ERROR,
+              G_IO_ERROR_WOULD_BLOCK)) {
+        g_clear_error (&recv_err);
+        break;
+      }
+      g_propagate_error (err, recv_err);
+      return FALSE;
+    }
+
+    if (ret < GST_NET_TIME_PACKET_SIZE) {
+      GST_DEBUG_OBJECT (self, "someone sent us a short packet (%"
+          G_GSSIZE_FORMAT " < %d)", ret, GST_NET_TIME_PACKET_SIZE);
+    } else if (IS_ACTIVE (self)) {
+      /* do what we were asked to and send the packet back */
+      gst_net_time_provider_fill_packet (self, buffer);
+
+      /* ignore errors */
+      g_socket_send_to (socket, sender_addr, (const gchar *) buffer,
+          GST_NET_TIME_PACKET_SIZE, NULL, NULL);
+    }
+
+    g_clear_object (&sender_addr);
+  }
+
+  return TRUE;
+}
+#endif
+
 static gpointer
 gst_net_time_provider_thread (gpointer data)
 {
   GstNetTimeProvider *self = data;
   GCancellable *cancel = self->priv->cancel;
   GSocket *socket = self->priv->socket;
-  GstNetTimePacket *packet;
   GError *err = NULL;
   gint cur_qos_dscp = DEFAULT_QOS_DSCP;
   gint new_qos_dscp;
@@ -188,9 +338,6 @@ gst_net_time_provider_thread (gpointer data)
   GST_INFO_OBJECT (self, "time provider thread is running");
 
   while (TRUE) {
-    GSocketAddress *sender_addr = NULL;
-
-
     GST_LOG_OBJECT (self, "waiting on socket");
     if (!g_socket_condition_wait (socket, G_IO_IN, cancel, &err)) {
       GST_INFO_OBJECT (self, "socket error: %s", err->message);
@@ -205,33 +352,23 @@ gst_net_time_provider_thread (gpointer data)
       continue;
     }
 
-    /* got data in */
-    packet = gst_net_time_packet_receive (socket, &sender_addr, &err);
-
-    if (err != NULL) {
-      GST_DEBUG_OBJECT (self, "receive error: %s", err->message);
-      g_usleep (G_USEC_PER_SEC / 10);
-      g_error_free (err);
-      err = NULL;
-      continue;
-    }
-
     /* before next sending check if need to change QoS */
-    new_qos_dscp = self->priv->qos_dscp;
+    new_qos_dscp = g_atomic_int_get (&self->priv->qos_dscp);
     if (cur_qos_dscp != new_qos_dscp &&
         gst_net_utils_set_socket_dscp (socket, new_qos_dscp)) {
       GST_DEBUG_OBJECT (self, "changed QoS DSCP to: %d", new_qos_dscp);
       cur_qos_dscp = new_qos_dscp;
     }
 
-    if (IS_ACTIVE (self)) {
-      /* do what we were asked to and send the packet back */
-      packet->remote_time = gst_clock_get_time (self->priv->clock);
-
-      /* ignore errors */
-      gst_net_time_packet_send (packet, socket, sender_addr, NULL);
-      g_object_unref (sender_addr);
-      g_free (packet);
+    /* got data in */
+    if (!gst_net_time_provider_serve (self, socket, &err)) {
+      /* another thread was faster */
+      if (err->code != G_IO_ERROR_WOULD_BLOCK) {
+        GST_DEBUG_OBJECT (self, "receive error: %s", err->message);
+        g_usleep (G_USEC_PER_SEC / 10);
+      }
+      g_error_free (err);
+      err = NULL;
     }
   }
 
@@ -269,6 +406,9 @@ gst_net_time_provider_set_property (GObject * object, guint prop_id,
     case PROP_QOS_DSCP:
       g_atomic_int_set (&self->priv->qos_dscp, g_value_get_int (value));
       break;
+    case PROP_N_THREADS:
+      self->priv->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -297,12 +437,28 @@ gst_net_time_provider_get_property (GObject * object, guint prop_id,
     case PROP_QOS_DSCP:
       g_value_set_int (value, self->priv->qos_dscp);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, self->priv->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* joins the threads, the array is terminated by the first thread that was
+ * not created */
+static void
+join_threads (GstNetTimeProvider * self)
+{
+  guint i;
+
+  for (i = 0; self->priv->threads[i]; i++)
+    g_thread_join (self->priv->threads[i]);
+  g_free (self->priv->threads);
+  self->priv->threads = NULL;
+}
+
 static gboolean
 gst_net_time_provider_start (GstNetTimeProvider * self, GError ** error)
 {
@@ -313,6 +469,7 @@ gst_net_time_provider_start (GstNetTimeProvider * self, GError ** error)
   int port;
   gchar *address;
   GError *err = NULL;
+  guint i, n_threads;
 
   if (self->priv->address) {
     inet_addr = g_inet_address_new_from_string (self->priv->address);
@@ -366,16 +523,28 @@ gst_net_time_provider_start (GstNetTimeProvider * self, GError ** error)
       self->priv->address, port);
   g_object_unref (bound_addr);
 
+  /* the threads only receive the packets that are available */
+  g_socket_set_blocking (socket, FALSE);
+
   self->priv->socket = socket;
   self->priv->cancel = g_cancellable_new ();
   self->priv->made_cancel_fd =
       g_cancellable_make_pollfd (self->priv->cancel, &dummy_pollfd);
 
-  self->priv->thread = g_thread_try_new ("GstNetTimeProvider",
-      gst_net_time_provider_thread, self, &err);
+  n_threads = self->priv->n_threads;
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+  self->priv->threads = g_new0 (GThread *, n_threads + 1);
+
+  for (i = 0; i < n_threads; i++) {
+    self->priv->threads[i] = g_thread_try_new ("GstNetTimeProvider",
+        gst_net_time_provider_thread, self, &err);
+
+    if (!self->priv->threads[i])
+      goto no_thread;
+  }
 
-  if (!self->priv->thread)
-    goto no_thread;
+  GST_DEBUG_OBJECT (self, "serving with %u threads", n_threads);
 
   return TRUE;
 
@@ -404,6 +573,10 @@ no_thread:
   {
     GST_ERROR_OBJECT (self, "could not create thread: %s", err->message);
     g_propagate_error (error, err);
+    g_cancellable_cancel (self->priv->cancel);
+    join_threads (self);
+    if (self->priv->made_cancel_fd)
+      g_cancellable_release_fd (self->priv->cancel);
     g_object_unref (self->priv->socket);
     self->priv->socket = NULL;
     g_object_unref (self->priv->cancel);
@@ -415,13 +588,12 @@ no_thread:
 static void
 gst_net_time_provider_stop (GstNetTimeProvider * self)
 {
-  g_return_if_fail (self->priv->thread != NULL);
+  g_return_if_fail (self->priv->threads != NULL);
 
   GST_INFO_OBJECT (self, "stopping..");
   g_cancellable_cancel (self->priv->cancel);
 
-  g_thread_join (self->priv->thread);
-  self->priv->thread = NULL;
+  join_threads (self);
 
   if (self->priv->made_cancel_fd)
     g_cancellable_release_fd (self->priv->cancel);
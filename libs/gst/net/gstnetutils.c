@@ -64,3 +64,90 @@ gst_net_utils_set_socket_dscp (GSocket * socket, gint qos_dscp)
 
   return ret;
 }
+
+/**
+ * gst_net_utils_receive_from:
+ * @socket: Socket to receive from
+ * @buffer: Buffer for the data
+ * @size: Size of @buffer
+ * @address: (allow-none): Storage for the native address of the sender
+ * @address_len: (allow-none): Size of @address, set to the size of the
+ *     sender address
+ * @error: return address for a #GError, or NULL
+ *
+ * Receives one datagram like g_socket_receive_from() but stores the sender
+ * address in @address instead of making a new #GSocketAddress. Waits for
+ * data on sockets that would block.
+ *
+ * Returns: the number of bytes received or -1 in case an error occurred.
+ */
+gssize
+gst_net_utils_receive_from (GSocket * socket, gpointer buffer, gsize size,
+    gpointer address, gsize * address_len, GError ** error)
+{
+#ifndef G_OS_WIN32
+  gint fd = g_socket_get_fd (socket);
+
+  while (TRUE) {
+    socklen_t len = address_len != NULL ? *address_len : 0;
+    gssize ret;
+    gint errsv;
+
+    ret = recvfrom (fd, buffer, size, 0, address,
+        address != NULL ? &len : NULL);
+    if (ret >= 0) {
+      if (address_len != NULL)
+        *address_len = address != NULL ? len : 0;
+      return ret;
+    }
+
+    errsv = errno;
+    if (errsv == EINTR)
+      continue;
+
+    if (errsv == EWOULDBLOCK || errsv == EAGAIN) {
+      if (!g_socket_condition_wait (socket, G_IO_IN, NULL, error))
+        return -1;
+      continue;
+    }
+
+    g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+        "Error receiving data: %s", g_strerror (errsv));
+    return -1;
+  }
+#else
+  GSocketAddress *src_address = NULL;
+  gssize ret;
+
+  do {
+    GError *err = NULL;
+
+    ret = g_socket_receive_from (socket, address ? &src_address : NULL,
+        buffer, size, NULL, &err);
+    if (ret < 0) {
+      if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+        g_propagate_error (error, err);
+        return -1;
+      }
+      g_error_free (err);
+      if (!g_socket_condition_wait (socket, G_IO_IN, NULL, error))
+        return -1;
+    }
+  } while (ret < 0);
+
+  if (address_len != NULL) {
+    gsize len = 0;
+
+    if (src_address != NULL) {
+      len = g_socket_address_get_native_size (src_address);
+      if (len > *address_len ||
+          !g_socket_address_to_native (src_address, address, len, NULL))
+        len = 0;
+    }
+    *address_len = len;
+  }
+  g_clear_object (&src_address);
+
+  return ret;
+#endif
+}
@@ -31,6 +31,14 @@ G_GNUC_INTERNAL
 gboolean    gst_net_utils_set_socket_dscp (GSocket  * socket,
                                            gint       qos_dscp);
 
+G_GNUC_INTERNAL
+gssize      gst_net_utils_receive_from    (GSocket  * socket,
+                                           gpointer   buffer,
+                                           gsize      size,
+                                           gpointer   address,
+                                           gsize    * address_len,
+                                           GError  ** error);
+
 G_END_DECLS
 
 #endif /* __GST_NET_UTILS_H__ */
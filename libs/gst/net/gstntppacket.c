@@ -46,6 +46,7 @@
 #include <string.h>
 
 #include "gstntppacket.h"
+#include "gstnetutils.h"
 
 G_DEFINE_BOXED_TYPE (GstNtpPacket, gst_ntp_packet,
     gst_ntp_packet_copy, gst_ntp_packet_free);
@@ -76,6 +77,66 @@ gst_clock_time_to_ntp_timestamp_fraction (GstClockTime gst)
       GST_SECOND);
 }
 
+static gboolean
+gst_ntp_packet_parse (GstNtpPacket * packet, const guint8 * buffer,
+    GError ** error)
+{
+  guint8 version = (buffer[0] >> 3) & 0x7;
+  guint8 stratum = buffer[1];
+  gint8 poll_interval = buffer[2];
+
+  if (version != 4) {
+    g_set_error (error, GST_NTP_ERROR, GST_NTP_ERROR_WRONG_VERSION,
+        "Invalid NTP version %d", version);
+    return FALSE;
+  }
+
+  /* Kiss-o'-Death packet! */
+  if (stratum == 0) {
+    gchar code[5] = { buffer[3 * 4 + 0], buffer[3 * 4 + 1], buffer[3 * 4 + 2],
+      buffer[3 * 4 + 3], 0
+    };
+
+    /* AUTH, AUTO, CRYP, DENY, RSTR, NKEY => DENY */
+    if (strcmp (code, "AUTH") == 0 ||
+        strcmp (code, "AUTO") == 0 ||
+        strcmp (code, "CRYP") == 0 ||
+        strcmp (code, "DENY") == 0 ||
+        strcmp (code, "RSTR") == 0 || strcmp (code, "NKEY") == 0) {
+      g_set_error (error, GST_NTP_ERROR, GST_NTP_ERROR_KOD_DENY,
+          "Kiss-o'-Death denied '%s'", code);
+    } else if (strcmp (code, "RATE") == 0) {
+      g_set_error (error, GST_NTP_ERROR, GST_NTP_ERROR_KOD_RATE,
+          "Kiss-o'-Death '%s'", code);
+    } else {
+      g_set_error (error, GST_NTP_ERROR, GST_NTP_ERROR_KOD_UNKNOWN,
+          "Kiss-o'-Death unknown '%s'", code);
+    }
+
+    return FALSE;
+  }
+
+  packet->origin_time =
+      ntp_timestamp_to_gst_clock_time (GST_READ_UINT32_BE (buffer + 6 * 4),
+      GST_READ_UINT32_BE (buffer + 7 * 4));
+  packet->receive_time =
+      ntp_timestamp_to_gst_clock_time (GST_READ_UINT32_BE (buffer + 8 * 4),
+      GST_READ_UINT32_BE (buffer + 9 * 4));
+  packet->transmit_time =
+      ntp_timestamp_to_gst_clock_time (GST_READ_UINT32_BE (buffer + 10 * 4),
+      GST_READ_UINT32_BE (buffer + 11 * 4));
+
+  /* Wireshark considers everything >= 3 as invalid */
+  if (poll_interval >= 3)
+    packet->poll_interval = GST_CLOCK_TIME_NONE;
+  else if (poll_interval >= 0)
+    packet->poll_interval = GST_SECOND << poll_interval;
+  else
+    packet->poll_interval = GST_SECOND >> (-poll_interval);
+
+  return TRUE;
+}
+
 /**
  * gst_ntp_packet_new:
  * @buffer: (array): a buffer from which to construct the packet, or NULL
@@ -100,59 +161,11 @@ gst_ntp_packet_new (const guint8 * buffer, GError ** error)
   g_assert (sizeof (GstClockTime) == 8);
 
   if (buffer) {
-    guint8 version = (buffer[0] >> 3) & 0x7;
-    guint8 stratum = buffer[1];
-    gint8 poll_interval = buffer[2];
-
-    if (version != 4) {
-      g_set_error (error, GST_NTP_ERROR, GST_NTP_ERROR_WRONG_VERSION,
-          "Invalid NTP version %d", version);
-      return NULL;
-    }
-
-    /* Kiss-o'-Death packet! */
-    if (stratum == 0) {
-      gchar code[5] = { buffer[3 * 4 + 0], buffer[3 * 4 + 1], buffer[3 * 4 + 2],
-        buffer[3 * 4 + 3], 0
-      };
-
-      /* AUTH, AUTO, CRYP, DENY, RSTR, NKEY => DENY */
-      if (strcmp (code, "AUTH") == 0 ||
-          strcmp (code, "AUTO") == 0 ||
-          strcmp (code, "CRYP") == 0 ||
-          strcmp (code, "DENY") == 0 ||
-          strcmp (code, "RSTR") == 0 || strcmp (code, "NKEY") == 0) {
-        g_set_error (error, GST_NTP_ERROR, GST_NTP_ERROR_KOD_DENY,
-            "Kiss-o'-Death denied '%s'", code);
-      } else if (strcmp (code, "RATE") == 0) {
-        g_set_error (error, GST_NTP_ERROR, GST_NTP_ERROR_KOD_RATE,
-            "Kiss-o'-Death '%s'", code);
-      } else {
-        g_set_error (error, GST_NTP_ERROR, GST_NTP_ERROR_KOD_UNKNOWN,
-            "Kiss-o'-Death unknown '%s'", code);
-      }
-
+    ret = g_new0 (GstNtpPacket, 1);
+    if (!gst_ntp_packet_parse (ret, buffer, error)) {
+      g_free (ret);
       return NULL;
     }
-
-    ret = g_new0 (GstNtpPacket, 1);
-    ret->origin_time =
-        ntp_timestamp_to_gst_clock_time (GST_READ_UINT32_BE (buffer + 6 * 4),
-        GST_READ_UINT32_BE (buffer + 7 * 4));
-    ret->receive_time =
-        ntp_timestamp_to_gst_clock_time (GST_READ_UINT32_BE (buffer + 8 * 4),
-        GST_READ_UINT32_BE (buffer + 9 * 4));
-    ret->transmit_time =
-        ntp_timestamp_to_gst_clock_time (GST_READ_UINT32_BE (buffer + 10 * 4),
-        GST_READ_UINT32_BE (buffer + 11 * 4));
-
-    /* Wireshark considers everything >= 3 as invalid */
-    if (poll_interval >= 3)
-      ret->poll_interval = GST_CLOCK_TIME_NONE;
-    else if (poll_interval >= 0)
-      ret->poll_interval = GST_SECOND << poll_interval;
-    else
-      ret->poll_interval = GST_SECOND >> (-poll_interval);
   } else {
     ret = g_new0 (GstNtpPacket, 1);
     ret->origin_time = 0;
@@ -315,6 +328,55 @@ short_packet:
   }
 }
 
+/**
+ * gst_ntp_packet_receive_into:
+ * @socket: socket to receive the time packet on
+ * @packet: the #GstNtpPacket to fill
+ * @src_address: (allow-none): storage for the native address of the sender
+ * @src_address_len: (allow-none): the size of @src_address, set to the size
+ *    of the sender address
+ * @error: return address for a #GError, or NULL
+ *
+ * Receives a #GstNtpPacket over a socket into @packet, without allocating
+ * a packet or a #GSocketAddress.
+ *
+ * Returns: %TRUE if a packet was received, %FALSE on error.
+ */
+gboolean
+gst_ntp_packet_receive_into (GSocket * socket, GstNtpPacket * packet,
+    gpointer src_address, gsize * src_address_len, GError ** error)
+{
+  guint8 buffer[GST_NTP_PACKET_SIZE];
+  gssize ret;
+
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+  g_return_val_if_fail (packet != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  ret = gst_net_utils_receive_from (socket, buffer, GST_NTP_PACKET_SIZE,
+      src_address, src_address_len, error);
+  if (ret < 0)
+    goto receive_error;
+  else if (ret < GST_NTP_PACKET_SIZE)
+    goto short_packet;
+
+  return gst_ntp_packet_parse (packet, buffer, error);
+
+receive_error:
+  {
+    GST_DEBUG ("receive error");
+    return FALSE;
+  }
+short_packet:
+  {
+    GST_DEBUG ("someone sent us a short packet (%" G_GSSIZE_FORMAT " < %d)",
+        ret, GST_NTP_PACKET_SIZE);
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+        "short time packet (%d < %d)", (int) ret, GST_NTP_PACKET_SIZE);
+    return FALSE;
+  }
+}
+
 /**
  * gst_ntp_packet_send:
  * @packet: the #GstNtpPacket to send
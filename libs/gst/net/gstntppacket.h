@@ -76,6 +76,12 @@ GstNtpPacket*           gst_ntp_packet_receive     (GSocket         * socket,
                                                     GSocketAddress ** src_address,
                                                     GError         ** error) G_GNUC_INTERNAL;
 
+gboolean                gst_ntp_packet_receive_into (GSocket       * socket,
+                                                    GstNtpPacket   * packet,
+                                                    gpointer         src_address,
+                                                    gsize          * src_address_len,
+                                                    GError        ** error) G_GNUC_INTERNAL;
+
 gboolean                gst_ntp_packet_send        (const GstNtpPacket * packet,
                                                     GSocket            * socket,
                                                     GSocketAddress     * dest_address,
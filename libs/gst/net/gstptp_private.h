@@ -3,6 +3,9 @@
 
 #include <glib.h>
 
+/* Messages of TYPE_EVENT and TYPE_GENERAL from the helper start with the
+ * GstClockTime at which the packet was received on the observation clock,
+ * in host byte order, or GST_CLOCK_TIME_NONE if it is not known */
 enum
 {
   TYPE_EVENT,
@@ -35,6 +35,14 @@
  * synchronize to all PTP domains that are detected on the selected
  * interfaces.
  *
+ * Where the platform supports it, the helper process passes on the time the
+ * kernel received each PTP packet, so that forwarding the packets does not
+ * add to the measured delays. If the environment variable
+ * GST_PTP_HARDWARE_TIMESTAMPS is set, the receive timestamps of the network
+ * card are used instead. This needs hardware timestamping to be enabled on
+ * the interface and the clock of the network card to be synchronized to the
+ * system time, e.g. with phc2sys.
+ *
  * gst_ptp_clock_new() then allows to create a GstClock that provides the PTP
  * time from a master clock inside a specific PTP domain. This clock will only
  * return valid timestamps once the timestamps in the PTP domain are known. To
@@ -72,6 +80,8 @@
 #include <io.h>
 #endif
 
+#include <string.h>
+
 #include <gst/base/base.h>
 
 GST_DEBUG_CATEGORY_STATIC (ptp_debug);
@@ -938,7 +948,8 @@ static gboolean
 send_delay_req_timeout (PtpPendingSync * sync)
 {
   StdIOHeader header = { 0, };
-  guint8 delay_req[44];
+  /* header and message are written at once to wake up the helper only once */
+  guint8 buffer[sizeof (StdIOHeader) + 44];
   GstByteWriter writer;
   GIOStatus status;
   gsize written;
@@ -947,7 +958,9 @@ send_delay_req_timeout (PtpPendingSync * sync)
   header.type = TYPE_EVENT;
   header.size = 44;
 
-  gst_byte_writer_init_with_data (&writer, delay_req, 44, FALSE);
+  memcpy (buffer, &header, sizeof (header));
+
+  gst_byte_writer_init_with_data (&writer, buffer + sizeof (header), 44, FALSE);
   gst_byte_writer_put_uint8_unchecked (&writer, PTP_MESSAGE_TYPE_DELAY_REQ);
   gst_byte_writer_put_uint8_unchecked (&writer, 2);
   gst_byte_writer_put_uint16_be_unchecked (&writer, 44);
@@ -965,33 +978,12 @@ send_delay_req_timeout (PtpPendingSync * sync)
   gst_byte_writer_put_uint64_be_unchecked (&writer, 0);
   gst_byte_writer_put_uint16_be_unchecked (&writer, 0);
 
-  status =
-      g_io_channel_write_chars (stdout_channel, (gchar *) & header,
-      sizeof (header), &written, &err);
-  if (status == G_IO_STATUS_ERROR) {
-    g_warning ("Failed to write to stdout: %s", err->message);
-    g_clear_error (&err);
-    return G_SOURCE_REMOVE;
-  } else if (status == G_IO_STATUS_EOF) {
-    g_message ("EOF on stdout");
-    g_main_loop_quit (main_loop);
-    return G_SOURCE_REMOVE;
-  } else if (status != G_IO_STATUS_NORMAL) {
-    g_warning ("Unexpected stdout write status: %d", status);
-    g_main_loop_quit (main_loop);
-    return G_SOURCE_REMOVE;
-  } else if (written != sizeof (header)) {
-    g_warning ("Unexpected write size: %" G_GSIZE_FORMAT, written);
-    g_main_loop_quit (main_loop);
-    return G_SOURCE_REMOVE;
-  }
-
   sync->delay_req_send_time_local =
       gst_clock_get_time (observation_system_clock);
 
   status =
       g_io_channel_write_chars (stdout_channel,
-      (const gchar *) delay_req, 44, &written, &err);
+      (const gchar *) buffer, sizeof (buffer), &written, &err);
   if (status == G_IO_STATUS_ERROR) {
     g_warning ("Failed to write to stdout: %s", err->message);
     g_clear_error (&err);
@@ -1005,7 +997,7 @@ send_delay_req_timeout (PtpPendingSync * sync)
     g_warning ("Unexpected stdout write status: %d", status);
     g_main_loop_quit (main_loop);
     return G_SOURCE_REMOVE;
-  } else if (written != 44) {
+  } else if (written != sizeof (buffer)) {
     g_warning ("Unexpected write size: %" G_GSIZE_FORMAT, written);
     g_main_loop_quit (main_loop);
     return G_SOURCE_REMOVE;
@@ -1804,10 +1796,30 @@ have_stdin_data_cb (GIOChannel * channel, GIOCondition condition,
   switch (header.type) {
     case TYPE_EVENT:
     case TYPE_GENERAL:{
-      GstClockTime receive_time = gst_clock_get_time (observation_system_clock);
+      GstClockTime receive_time, now;
       PtpMessage msg;
 
-      if (parse_ptp_message (&msg, (const guint8 *) buffer, header.size)) {
+      now = gst_clock_get_time (observation_system_clock);
+
+      if (header.size < sizeof (receive_time)) {
+        GST_ERROR ("Unexpected message size (%u)", header.size);
+        g_main_loop_quit (main_loop);
+        return G_SOURCE_REMOVE;
+      }
+
+      /* prefer the time the packet was received by the kernel or the network
+       * card over the time it arrived here, after being forwarded by the
+       * helper process */
+      memcpy (&receive_time, buffer, sizeof (receive_time));
+      if (GST_CLOCK_TIME_IS_VALID (receive_time) && receive_time <= now) {
+        GST_TRACE ("Packet received %" GST_TIME_FORMAT " ago",
+            GST_TIME_ARGS (now - receive_time));
+      } else {
+        receive_time = now;
+      }
+
+      if (parse_ptp_message (&msg, (const guint8 *) buffer +
+              sizeof (receive_time), header.size - sizeof (receive_time))) {
         dump_ptp_message (&msg);
         handle_ptp_message (&msg, receive_time);
       }
@@ -2041,6 +2053,8 @@ gst_ptp_init (guint64 clock_id, gchar ** interfaces)
   argc = 1;
   if (clock_id != GST_PTP_CLOCK_ID_NONE)
     argc += 2;
+  if (g_getenv ("GST_PTP_HARDWARE_TIMESTAMPS"))
+    argc += 1;
   if (interfaces != NULL)
     argc += 2 * g_strv_length (interfaces);
 
@@ -2062,6 +2076,9 @@ gst_ptp_init (guint64 clock_id, gchar ** interfaces)
     argv[argc_c++] = g_strdup_printf ("0x%016" G_GINT64_MODIFIER "x", clock_id);
   }
 
+  if (g_getenv ("GST_PTP_HARDWARE_TIMESTAMPS"))
+    argv[argc_c++] = g_strdup ("-H");
+
   if (interfaces != NULL) {
     gchar **ptr = interfaces;
 
@@ -2112,9 +2129,10 @@ gst_ptp_init (guint64 clock_id, gchar ** interfaces)
   g_io_channel_set_buffered (stdout_channel, FALSE);
 
   delay_req_rand = g_rand_new ();
+  /* the helper translates receive timestamps to the monotonic clock */
   observation_system_clock =
       g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", "ptp-observation-clock",
-      NULL);
+      "clock-type", GST_CLOCK_TYPE_MONOTONIC, NULL);
   gst_object_ref_sink (observation_system_clock);
 
   initted = TRUE;
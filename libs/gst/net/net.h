@@ -25,6 +25,7 @@
 #include <gst/net/gstnet.h>
 #include <gst/net/gstnetaddressmeta.h>
 #include <gst/net/gstnetclientclock.h>
+#include <gst/net/gstnetsegmentmeta.h>
 #include <gst/net/gstnettimepacket.h>
 #include <gst/net/gstnettimeprovider.h>
 #include <gst/net/gstptpclock.h>
@@ -0,0 +1,255 @@
+/* GStreamer
+ *
+ * gstbandwidthestimator.c: estimate the data rate of a stream
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gstbandwidthestimator.h"
+
+struct _GstBandwidthEstimator
+{
+  gdouble half_life;
+
+  /* exponentially weighted moving average and the time it covers */
+  gdouble average;
+  gdouble elapsed;
+
+  /* ring buffer with the last rates */
+  gdouble *samples;
+  guint window;
+  guint n_samples;
+  guint next;
+
+  /* sorted copy of the samples, made when a percentile is asked */
+  gdouble *sorted;
+  gboolean sorted_valid;
+};
+
+/**
+ * gst_bandwidth_estimator_new:
+ * @half_life: the time in seconds after which a sample weighs half
+ * @window: the number of samples to keep for the percentiles
+ *
+ * Make a new estimator. The average is an exponentially weighted moving
+ * average of the rate of the samples, the weight of a sample halves every
+ * @half_life seconds. The percentiles are taken from the last @window
+ * samples.
+ *
+ * Returns: a new #GstBandwidthEstimator, free with
+ * gst_bandwidth_estimator_free().
+ */
+GstBandwidthEstimator *
+gst_bandwidth_estimator_new (gdouble half_life, guint window)
+{
+  GstBandwidthEstimator *est;
+
+  g_return_val_if_fail (half_life > 0.0, NULL);
+  g_return_val_if_fail (window > 0, NULL);
+
+  est = g_slice_new0 (GstBandwidthEstimator);
+  est->half_life = half_life;
+  est->window = window;
+  est->samples = g_new0 (gdouble, window);
+  est->sorted = g_new0 (gdouble, window);
+
+  return est;
+}
+
+/**
+ * gst_bandwidth_estimator_free:
+ * @est: a #GstBandwidthEstimator
+ *
+ * Free @est.
+ */
+void
+gst_bandwidth_estimator_free (GstBandwidthEstimator * est)
+{
+  g_return_if_fail (est != NULL);
+
+  g_free (est->samples);
+  g_free (est->sorted);
+  g_slice_free (GstBandwidthEstimator, est);
+}
+
+/**
+ * gst_bandwidth_estimator_reset:
+ * @est: a #GstBandwidthEstimator
+ *
+ * Forget all samples.
+ */
+void
+gst_bandwidth_estimator_reset (GstBandwidthEstimator * est)
+{
+  g_return_if_fail (est != NULL);
+
+  est->average = 0.0;
+  est->elapsed = 0.0;
+  est->n_samples = 0;
+  est->next = 0;
+  est->sorted_valid = FALSE;
+}
+
+/**
+ * gst_bandwidth_estimator_set_half_life:
+ * @est: a #GstBandwidthEstimator
+ * @half_life: the time in seconds after which a sample weighs half
+ *
+ * Change the half life of the average, the samples already added are kept.
+ */
+void
+gst_bandwidth_estimator_set_half_life (GstBandwidthEstimator * est,
+    gdouble half_life)
+{
+  g_return_if_fail (est != NULL);
+  g_return_if_fail (half_life > 0.0);
+
+  est->half_life = half_life;
+}
+
+/**
+ * gst_bandwidth_estimator_get_half_life:
+ * @est: a #GstBandwidthEstimator
+ *
+ * Returns: the half life of the average of @est in seconds
+ */
+gdouble
+gst_bandwidth_estimator_get_half_life (GstBandwidthEstimator * est)
+{
+  g_return_val_if_fail (est != NULL, 0.0);
+
+  return est->half_life;
+}
+
+/**
+ * gst_bandwidth_estimator_add_sample:
+ * @est: a #GstBandwidthEstimator
+ * @bytes: the number of bytes
+ * @period: the time in seconds it took to transfer @bytes
+ *
+ * Add a sample of @bytes transferred in @period seconds.
+ */
+void
+gst_bandwidth_estimator_add_sample (GstBandwidthEstimator * est,
+    guint64 bytes, gdouble period)
+{
+  gdouble rate, alpha;
+
+  g_return_if_fail (est != NULL);
+
+  if (period <= 0.0)
+    return;
+
+  rate = bytes / period;
+
+  /* the weight of the new sample for its duration, but never less than its
+   * share of the total time so that the first samples are not averaged
+   * with the initial 0 */
+  alpha = 1.0 - exp2 (-period / est->half_life);
+  alpha = MAX (alpha, period / (est->elapsed + period));
+
+  est->average += alpha * (rate - est->average);
+  est->elapsed += period;
+
+  est->samples[est->next] = rate;
+  est->next = (est->next + 1) % est->window;
+  if (est->n_samples < est->window)
+    est->n_samples++;
+  est->sorted_valid = FALSE;
+}
+
+/**
+ * gst_bandwidth_estimator_get_n_samples:
+ * @est: a #GstBandwidthEstimator
+ *
+ * Returns: the number of samples used for the percentiles
+ */
+guint
+gst_bandwidth_estimator_get_n_samples (GstBandwidthEstimator * est)
+{
+  g_return_val_if_fail (est != NULL, 0);
+
+  return est->n_samples;
+}
+
+/**
+ * gst_bandwidth_estimator_get_average:
+ * @est: a #GstBandwidthEstimator
+ *
+ * Returns: the weighted average rate in bytes per second or 0 when there
+ * are no samples.
+ */
+gdouble
+gst_bandwidth_estimator_get_average (GstBandwidthEstimator * est)
+{
+  g_return_val_if_fail (est != NULL, 0.0);
+
+  return est->average;
+}
+
+static gint
+compare_rate (gconstpointer a, gconstpointer b)
+{
+  gdouble ra = *(const gdouble *) a;
+  gdouble rb = *(const gdouble *) b;
+
+  return ra < rb ? -1 : ra > rb ? 1 : 0;
+}
+
+/**
+ * gst_bandwidth_estimator_get_percentile:
+ * @est: a #GstBandwidthEstimator
+ * @percentile: a percentile between 0 and 100
+ *
+ * Get the rate that @percentile percent of the recent samples are below.
+ * The 10th percentile gives a pessimistic estimate that is only rarely not
+ * reached.
+ *
+ * Returns: the rate in bytes per second or 0 when there are no samples.
+ */
+gdouble
+gst_bandwidth_estimator_get_percentile (GstBandwidthEstimator * est,
+    guint percentile)
+{
+  guint idx;
+
+  g_return_val_if_fail (est != NULL, 0.0);
+  g_return_val_if_fail (percentile <= 100, 0.0);
+
+  if (est->n_samples == 0)
+    return 0.0;
+
+  if (!est->sorted_valid) {
+    memcpy (est->sorted, est->samples, est->n_samples * sizeof (gdouble));
+    qsort (est->sorted, est->n_samples, sizeof (gdouble), compare_rate);
+    est->sorted_valid = TRUE;
+  }
+
+  /* nearest rank */
+  idx = (percentile * est->n_samples + 99) / 100;
+  if (idx > 0)
+    idx--;
+
+  return est->sorted[idx];
+}
@@ -0,0 +1,55 @@
+/* GStreamer
+ *
+ * gstbandwidthestimator.h: estimate the data rate of a stream
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BANDWIDTH_ESTIMATOR_H__
+#define __GST_BANDWIDTH_ESTIMATOR_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstBandwidthEstimator GstBandwidthEstimator;
+
+/* the default number of rate samples kept for the percentiles */
+#define GST_BANDWIDTH_ESTIMATOR_WINDOW   64
+
+GstBandwidthEstimator * gst_bandwidth_estimator_new    (gdouble half_life,
+                                                        guint window);
+void                    gst_bandwidth_estimator_free   (GstBandwidthEstimator * est);
+
+void                    gst_bandwidth_estimator_reset  (GstBandwidthEstimator * est);
+
+void                    gst_bandwidth_estimator_set_half_life (GstBandwidthEstimator * est,
+                                                        gdouble half_life);
+gdouble                 gst_bandwidth_estimator_get_half_life (GstBandwidthEstimator * est);
+
+void                    gst_bandwidth_estimator_add_sample (GstBandwidthEstimator * est,
+                                                        guint64 bytes,
+                                                        gdouble period);
+
+guint                   gst_bandwidth_estimator_get_n_samples (GstBandwidthEstimator * est);
+
+gdouble                 gst_bandwidth_estimator_get_average (GstBandwidthEstimator * est);
+gdouble                 gst_bandwidth_estimator_get_percentile (GstBandwidthEstimator * est,
+                                                        guint percentile);
+
+G_END_DECLS
+
+#endif /* __GST_BANDWIDTH_ESTIMATOR_H__ */
@@ -404,6 +404,10 @@ gst_capsfilter_prepare_buf (GstBaseTransform * trans, GstBuffer * input,
   /* always return the input as output buffer */
   *buf = input;
 
+  /* steady state, caps are negotiated and all events were forwarded */
+  if (G_LIKELY (filter->got_sink_caps && filter->pending_events == NULL))
+    return GST_FLOW_OK;
+
   if (GST_PAD_MODE (trans->srcpad) == GST_PAD_MODE_PUSH
       && !filter->got_sink_caps) {
 
@@ -459,7 +463,7 @@ gst_capsfilter_prepare_buf (GstBaseTransform * trans, GstBuffer * input,
 
       ret = GST_FLOW_ERROR;
     }
-  } else if (G_UNLIKELY (filter->pending_events)) {
+  } else if (filter->pending_events) {
     GList *events = filter->pending_events;
 
     filter->pending_events = NULL;
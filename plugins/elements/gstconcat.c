@@ -38,6 +38,13 @@
  * another downstream element like a streamsynchronizer adjusts the base
  * values on its own). The adjust-base property can be used for this purpose.
  *
+ * To avoid a gap while the next stream starts up, the
+ * #GstConcat:lookahead-bytes property allows the next stream to already queue
+ * data while the current one is still playing. Its upstream elements can then
+ * preroll in the meantime and the queued data is pushed directly after the
+ * current stream finished. Serialized queries of the next stream still wait
+ * until it is the current one.
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 concat name=c ! xvimagesink  videotestsrc num-buffers=100 ! c.   videotestsrc num-buffers=100 pattern=ball ! c.
@@ -74,6 +81,13 @@ struct _GstConcatPad
 
   /* Protected by the concat lock */
   gboolean flushing;
+
+  /* Items queued while this is the next pad in lookahead mode, also
+   * protected by the concat lock */
+  GQueue queue;
+  guint64 queued_bytes;
+  gboolean draining;
+  GstFlowReturn last_flow;
 };
 
 struct _GstConcatPadClass
@@ -93,6 +107,19 @@ gst_concat_pad_init (GstConcatPad * self)
 {
   gst_segment_init (&self->segment, GST_FORMAT_UNDEFINED);
   self->flushing = FALSE;
+  g_queue_init (&self->queue);
+  self->last_flow = GST_FLOW_OK;
+}
+
+/* Must be called with the concat lock */
+static void
+gst_concat_pad_clear_queue (GstConcatPad * spad)
+{
+  GstMiniObject *item;
+
+  while ((item = g_queue_pop_head (&spad->queue)))
+    gst_mini_object_unref (item);
+  spad->queued_bytes = 0;
 }
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink_%u",
@@ -109,10 +136,12 @@ enum
 {
   PROP_0,
   PROP_ACTIVE_PAD,
-  PROP_ADJUST_BASE
+  PROP_ADJUST_BASE,
+  PROP_LOOKAHEAD_BYTES
 };
 
 #define DEFAULT_ADJUST_BASE TRUE
+#define DEFAULT_LOOKAHEAD_BYTES 0
 
 #define _do_init \
   GST_DEBUG_CATEGORY_INIT (gst_concat_debug, "concat", 0, "concat element");
@@ -145,6 +174,7 @@ static gboolean gst_concat_src_query (GstPad * pad, GstObject * parent,
     GstQuery * query);
 
 static gboolean gst_concat_switch_pad (GstConcat * self);
+static void gst_concat_drain_pad (GstConcat * self);
 
 static void gst_concat_notify_active_pad (GstConcat * self);
 
@@ -172,6 +202,21 @@ gst_concat_class_init (GstConcatClass * klass)
           "Adjust the base value of segments to ensure they are adjacent",
           DEFAULT_ADJUST_BASE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstConcat:lookahead-bytes:
+   *
+   * The amount of data the next stream can queue while the current stream
+   * is still playing. 0 disables queueing, the next stream is then blocked
+   * until the current one finished.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_LOOKAHEAD_BYTES,
+      g_param_spec_uint ("lookahead-bytes", "Lookahead bytes",
+          "Amount of data the next stream can queue (bytes, 0=disable)",
+          0, G_MAXUINT, DEFAULT_LOOKAHEAD_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Concat", "Generic", "Concatenate multiple streams",
       "Sebastian Dröge <sebastian@centricular.com>");
@@ -201,6 +246,7 @@ gst_concat_init (GstConcat * self)
   gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
 
   self->adjust_base = DEFAULT_ADJUST_BASE;
+  self->lookahead_bytes = DEFAULT_LOOKAHEAD_BYTES;
 }
 
 static void
@@ -254,6 +300,12 @@ gst_concat_get_property (GObject * object, guint prop_id, GValue * value,
       g_mutex_unlock (&self->lock);
       break;
     }
+    case PROP_LOOKAHEAD_BYTES:{
+      g_mutex_lock (&self->lock);
+      g_value_set_uint (value, self->lookahead_bytes);
+      g_mutex_unlock (&self->lock);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -273,6 +325,13 @@ gst_concat_set_property (GObject * object, guint prop_id, const GValue * value,
       g_mutex_unlock (&self->lock);
       break;
     }
+    case PROP_LOOKAHEAD_BYTES:{
+      g_mutex_lock (&self->lock);
+      self->lookahead_bytes = g_value_get_uint (value);
+      g_cond_broadcast (&self->cond);
+      g_mutex_unlock (&self->lock);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -341,6 +400,7 @@ gst_concat_release_pad (GstElement * element, GstPad * pad)
 
   g_mutex_lock (&self->lock);
   spad->flushing = TRUE;
+  gst_concat_pad_clear_queue (spad);
   g_cond_broadcast (&self->cond);
   g_mutex_unlock (&self->lock);
 
@@ -370,9 +430,14 @@ gst_concat_release_pad (GstElement * element, GstPad * pad)
     gst_concat_notify_active_pad (self);
 
   if (GST_STATE (self) > GST_STATE_READY) {
-    if (current_pad_removed && !eos)
+    if (current_pad_removed && !eos) {
       gst_element_post_message (GST_ELEMENT_CAST (self),
           gst_message_new_duration_changed (GST_OBJECT_CAST (self)));
+      /* the streaming thread of the next pad might be done already and
+       * nothing else would push what it queued. Its streaming thread waits
+       * while the queue is pushed from here, which keeps the order */
+      gst_concat_drain_pad (self);
+    }
 
     /* FIXME: Sending EOS from application thread */
     if (eos)
@@ -380,12 +445,48 @@ gst_concat_release_pad (GstElement * element, GstPad * pad)
   }
 }
 
+/* Returns TRUE if @spad follows the current pad, must be called with
+ * concat lock */
+static gboolean
+gst_concat_is_next_pad (GstConcat * self, GstConcatPad * spad)
+{
+  GList *l;
+
+  for (l = self->sinkpads; l; l = l->next) {
+    if ((gpointer) self->current_sinkpad == l->data)
+      return l->prev && l->prev->data == (gpointer) spad;
+  }
+  return FALSE;
+}
+
+/* Returns TRUE if @spad can queue an item of @size bytes, must be called
+ * with concat lock */
+static gboolean
+gst_concat_pad_can_queue (GstConcat * self, GstConcatPad * spad, gsize size)
+{
+  /* once the pad is the current one it waits until its queue is pushed */
+  if (self->lookahead_bytes == 0 || !gst_concat_is_next_pad (self, spad))
+    return FALSE;
+
+  /* always allow one item so that big buffers do not block forever */
+  return g_queue_is_empty (&spad->queue)
+      || spad->queued_bytes + size <= self->lookahead_bytes;
+}
+
 /* Returns FALSE if flushing
  * Must be called from the pad's streaming thread
+ *
+ * When @item is not %NULL and @spad is the next pad in lookahead mode, the
+ * item is queued instead of waiting as long as there is room. @queued is
+ * then set to %TRUE and the item is pushed once the pad is the current one.
  */
 static gboolean
-gst_concat_pad_wait (GstConcatPad * spad, GstConcat * self)
+gst_concat_pad_wait_or_queue (GstConcatPad * spad, GstConcat * self,
+    GstMiniObject * item, gsize size, gboolean * queued)
 {
+  if (queued)
+    *queued = FALSE;
+
   g_mutex_lock (&self->lock);
   if (spad->flushing) {
     g_mutex_unlock (&self->lock);
@@ -393,7 +494,17 @@ gst_concat_pad_wait (GstConcatPad * spad, GstConcat * self)
     return FALSE;
   }
 
-  while (spad != GST_CONCAT_PAD_CAST (self->current_sinkpad)) {
+  while (spad != GST_CONCAT_PAD_CAST (self->current_sinkpad)
+      || spad->draining || !g_queue_is_empty (&spad->queue)) {
+    if (item && gst_concat_pad_can_queue (self, spad, size)) {
+      GST_TRACE_OBJECT (spad, "Not the current sinkpad - queueing %"
+          GST_PTR_FORMAT, item);
+      g_queue_push_tail (&spad->queue, item);
+      spad->queued_bytes += size;
+      g_mutex_unlock (&self->lock);
+      *queued = TRUE;
+      return TRUE;
+    }
     GST_TRACE_OBJECT (spad, "Not the current sinkpad - waiting");
     g_cond_wait (&self->cond, &self->lock);
     if (spad->flushing) {
@@ -415,17 +526,21 @@ gst_concat_pad_wait (GstConcatPad * spad, GstConcat * self)
   return TRUE;
 }
 
+/* Returns FALSE if flushing
+ * Must be called from the pad's streaming thread
+ */
+static gboolean
+gst_concat_pad_wait (GstConcatPad * spad, GstConcat * self)
+{
+  return gst_concat_pad_wait_or_queue (spad, self, NULL, 0, NULL);
+}
+
+/* Must be called when @spad is the current pad */
 static GstFlowReturn
-gst_concat_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_concat_push_buffer (GstConcat * self, GstConcatPad * spad,
+    GstBuffer * buffer)
 {
   GstFlowReturn ret;
-  GstConcat *self = GST_CONCAT (parent);
-  GstConcatPad *spad = GST_CONCAT_PAD (pad);
-
-  GST_LOG_OBJECT (pad, "received buffer %p", buffer);
-
-  if (!gst_concat_pad_wait (spad, self))
-    return GST_FLOW_FLUSHING;
 
   if (self->last_stop == GST_CLOCK_TIME_NONE)
     self->last_stop = spad->segment.start;
@@ -447,11 +562,38 @@ gst_concat_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
   ret = gst_pad_push (self->srcpad, buffer);
 
-  GST_LOG_OBJECT (pad, "handled buffer %s", gst_flow_get_name (ret));
+  GST_LOG_OBJECT (spad, "handled buffer %s", gst_flow_get_name (ret));
 
   return ret;
 }
 
+static GstFlowReturn
+gst_concat_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstFlowReturn ret;
+  GstConcat *self = GST_CONCAT (parent);
+  GstConcatPad *spad = GST_CONCAT_PAD (pad);
+  gboolean queued;
+
+  GST_LOG_OBJECT (pad, "received buffer %p", buffer);
+
+  if (!gst_concat_pad_wait_or_queue (spad, self, GST_MINI_OBJECT_CAST (buffer),
+          gst_buffer_get_size (buffer), &queued)) {
+    gst_buffer_unref (buffer);
+    return GST_FLOW_FLUSHING;
+  }
+
+  if (queued) {
+    /* report errors of pushing the previously queued data */
+    g_mutex_lock (&self->lock);
+    ret = spad->last_flow;
+    g_mutex_unlock (&self->lock);
+    return ret;
+  }
+
+  return gst_concat_push_buffer (self, spad, buffer);
+}
+
 /* Returns FALSE if no further pad, must be called with concat lock */
 static gboolean
 gst_concat_switch_pad (GstConcat * self)
@@ -507,40 +649,132 @@ gst_concat_notify_active_pad (GstConcat * self)
   g_object_notify_by_pspec ((GObject *) self, pspec_active_pad);
 }
 
+/* Handles a serialized event, must be called when @spad is the current
+ * pad */
+static gboolean
+gst_concat_push_event (GstConcat * self, GstConcatPad * spad, GstEvent * event)
+{
+  GstPad *pad = GST_PAD_CAST (spad);
+  gboolean ret = TRUE;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEGMENT:{
+      GstSegment segment;
+      gboolean adjust_base;
+
+      /* Drop segment event, we create our own one */
+      gst_event_copy_segment (event, &segment);
+      gst_event_unref (event);
+
+      g_mutex_lock (&self->lock);
+      adjust_base = self->adjust_base;
+      g_mutex_unlock (&self->lock);
+
+      if (adjust_base) {
+        /* We know no duration */
+        segment.duration = -1;
+
+        /* Update segment values to be continous with last stream */
+        if (self->format == GST_FORMAT_TIME) {
+          segment.base += self->current_start_offset;
+        } else {
+          /* Shift start/stop byte position */
+          segment.start += self->current_start_offset;
+          if (segment.stop != -1)
+            segment.stop += self->current_start_offset;
+        }
+      }
+
+      gst_pad_push_event (self->srcpad, gst_event_new_segment (&segment));
+      break;
+    }
+    case GST_EVENT_EOS:{
+      gboolean next;
+
+      gst_event_unref (event);
+
+      g_mutex_lock (&self->lock);
+      next = gst_concat_switch_pad (self);
+      g_mutex_unlock (&self->lock);
+
+      gst_concat_notify_active_pad (self);
+
+      if (!next) {
+        gst_pad_push_event (self->srcpad, gst_event_new_eos ());
+      } else {
+        gst_element_post_message (GST_ELEMENT_CAST (self),
+            gst_message_new_duration_changed (GST_OBJECT_CAST (self)));
+      }
+      break;
+    }
+    default:
+      ret = gst_pad_event_default (pad, GST_OBJECT_CAST (self), event);
+      break;
+  }
+
+  return ret;
+}
+
+/* Pushes what the current pad queued while it was the next pad, must be
+ * called without concat lock after switching pads */
+static void
+gst_concat_drain_pad (GstConcat * self)
+{
+  GstConcatPad *spad;
+  GstMiniObject *item;
+
+  g_mutex_lock (&self->lock);
+  while ((spad = GST_CONCAT_PAD_CAST (self->current_sinkpad))
+      && (item = g_queue_pop_head (&spad->queue))) {
+    GstFlowReturn ret = GST_FLOW_OK;
+
+    if (GST_IS_BUFFER (item))
+      spad->queued_bytes -= gst_buffer_get_size (GST_BUFFER_CAST (item));
+    spad->draining = TRUE;
+    gst_object_ref (spad);
+    g_mutex_unlock (&self->lock);
+
+    GST_LOG_OBJECT (spad, "pushing queued %" GST_PTR_FORMAT, item);
+    if (GST_IS_BUFFER (item))
+      ret = gst_concat_push_buffer (self, spad, GST_BUFFER_CAST (item));
+    else
+      gst_concat_push_event (self, spad, GST_EVENT_CAST (item));
+
+    g_mutex_lock (&self->lock);
+    spad->draining = FALSE;
+    if (ret != GST_FLOW_OK) {
+      /* upstream gets the error with its next buffer */
+      spad->last_flow = ret;
+      gst_concat_pad_clear_queue (spad);
+    }
+    g_cond_broadcast (&self->cond);
+    gst_object_unref (spad);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
 static gboolean
 gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
   GstConcat *self = GST_CONCAT (parent);
   GstConcatPad *spad = GST_CONCAT_PAD_CAST (pad);
   gboolean ret = TRUE;
+  gboolean queued;
 
   GST_LOG_OBJECT (pad, "received event %" GST_PTR_FORMAT, event);
 
   switch (GST_EVENT_TYPE (event)) {
-    case GST_EVENT_STREAM_START:{
-      if (!gst_concat_pad_wait (spad, self)) {
-        ret = FALSE;
-        gst_event_unref (event);
-      } else {
-        ret = gst_pad_event_default (pad, parent, event);
-      }
-      break;
-    }
     case GST_EVENT_SEGMENT:{
-      gboolean adjust_base;
-
-      /* Drop segment event, we create our own one */
       gst_event_copy_segment (event, &spad->segment);
-      gst_event_unref (event);
 
       g_mutex_lock (&self->lock);
-      adjust_base = self->adjust_base;
       if (self->format == GST_FORMAT_UNDEFINED) {
         if (spad->segment.format != GST_FORMAT_TIME
             && spad->segment.format != GST_FORMAT_BYTES) {
           g_mutex_unlock (&self->lock);
           GST_ELEMENT_ERROR (self, CORE, FAILED, (NULL),
               ("Can only operate in TIME or BYTES format"));
+          gst_event_unref (event);
           ret = FALSE;
           break;
         }
@@ -554,56 +788,31 @@ gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
             ("Operating in %s format but new pad has %s",
                 gst_format_get_name (self->format),
                 gst_format_get_name (spad->segment.format)));
+        gst_event_unref (event);
         ret = FALSE;
+        break;
       } else {
         g_mutex_unlock (&self->lock);
       }
 
-      if (!gst_concat_pad_wait (spad, self)) {
+      if (!gst_concat_pad_wait_or_queue (spad, self,
+              GST_MINI_OBJECT_CAST (event), 0, &queued)) {
+        gst_event_unref (event);
         ret = FALSE;
-      } else {
-        GstSegment segment = spad->segment;
-
-        if (adjust_base) {
-          /* We know no duration */
-          segment.duration = -1;
-
-          /* Update segment values to be continous with last stream */
-          if (self->format == GST_FORMAT_TIME) {
-            segment.base += self->current_start_offset;
-          } else {
-            /* Shift start/stop byte position */
-            segment.start += self->current_start_offset;
-            if (segment.stop != -1)
-              segment.stop += self->current_start_offset;
-          }
-        }
-
-        gst_pad_push_event (self->srcpad, gst_event_new_segment (&segment));
+      } else if (!queued) {
+        ret = gst_concat_push_event (self, spad, event);
       }
       break;
     }
     case GST_EVENT_EOS:{
-      gst_event_unref (event);
-
-      if (!gst_concat_pad_wait (spad, self)) {
+      if (!gst_concat_pad_wait_or_queue (spad, self,
+              GST_MINI_OBJECT_CAST (event), 0, &queued)) {
+        gst_event_unref (event);
         ret = FALSE;
-      } else {
-        gboolean next;
-
-        g_mutex_lock (&self->lock);
-        next = gst_concat_switch_pad (self);
-        g_mutex_unlock (&self->lock);
-        ret = TRUE;
-
-        gst_concat_notify_active_pad (self);
-
-        if (!next) {
-          gst_pad_push_event (self->srcpad, gst_event_new_eos ());
-        } else {
-          gst_element_post_message (GST_ELEMENT_CAST (self),
-              gst_message_new_duration_changed (GST_OBJECT_CAST (self)));
-        }
+      } else if (!queued) {
+        ret = gst_concat_push_event (self, spad, event);
+        /* the next pad might already have data */
+        gst_concat_drain_pad (self);
       }
       break;
     }
@@ -612,6 +821,7 @@ gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
       g_mutex_lock (&self->lock);
       spad->flushing = TRUE;
+      gst_concat_pad_clear_queue (spad);
       g_cond_broadcast (&self->cond);
       forward = (self->current_sinkpad == GST_PAD_CAST (spad));
       g_mutex_unlock (&self->lock);
@@ -629,6 +839,7 @@ gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       spad->flushing = FALSE;
 
       g_mutex_lock (&self->lock);
+      spad->last_flow = GST_FLOW_OK;
       forward = (self->current_sinkpad == GST_PAD_CAST (spad));
       g_mutex_unlock (&self->lock);
 
@@ -649,11 +860,14 @@ gst_concat_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
     }
     default:{
       /* Wait for other serialized events before forwarding */
-      if (GST_EVENT_IS_SERIALIZED (event) && !gst_concat_pad_wait (spad, self)) {
+      if (!GST_EVENT_IS_SERIALIZED (event)) {
+        ret = gst_pad_event_default (pad, parent, event);
+      } else if (!gst_concat_pad_wait_or_queue (spad, self,
+              GST_MINI_OBJECT_CAST (event), 0, &queued)) {
         gst_event_unref (event);
         ret = FALSE;
-      } else {
-        ret = gst_pad_event_default (pad, parent, event);
+      } else if (!queued) {
+        ret = gst_concat_push_event (self, spad, event);
       }
       break;
     }
@@ -774,6 +988,7 @@ reset_pad (const GValue * data, gpointer user_data)
 
   gst_segment_init (&spad->segment, GST_FORMAT_UNDEFINED);
   spad->flushing = FALSE;
+  spad->last_flow = GST_FLOW_OK;
 }
 
 static void
@@ -783,6 +998,7 @@ unblock_pad (const GValue * data, gpointer user_data)
   GstConcatPad *spad = GST_CONCAT_PAD_CAST (pad);
 
   spad->flushing = TRUE;
+  gst_concat_pad_clear_queue (spad);
 }
 
 static GstStateChangeReturn
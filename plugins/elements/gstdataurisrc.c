@@ -31,6 +31,9 @@
  * ]|
  *
  * This pipeline displays a small 16x16 PNG image from the data URI.
+ *
+ * Base64 encoded data is decoded in blocks while it is read, only the data
+ * URI itself is kept in memory.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -56,6 +59,12 @@ enum
   PROP_URI,
 };
 
+/* amount of data to decode up front for typefinding */
+#define TYPEFIND_SIZE (64 * 1024)
+
+/* value of each base64 character, 0xff for invalid characters */
+static guint8 base64_values[256];
+
 static void gst_data_uri_src_finalize (GObject * object);
 static void gst_data_uri_src_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec);
@@ -89,6 +98,15 @@ gst_data_uri_src_class_init (GstDataURISrcClass * klass)
   GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *element_class = (GstElementClass *) klass;
   GstBaseSrcClass *basesrc_class = (GstBaseSrcClass *) klass;
+  static const gchar alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  guint i;
+
+  memset (base64_values, 0xff, sizeof (base64_values));
+  for (i = 0; i < 64; i++)
+    base64_values[(guchar) alphabet[i]] = i;
+  /* padding decodes to zero bits */
+  base64_values['='] = 0;
 
   gobject_class->finalize = gst_data_uri_src_finalize;
   gobject_class->set_property = gst_data_uri_src_set_property;
@@ -192,7 +210,10 @@ gst_data_uri_src_get_size (GstBaseSrc * basesrc, guint64 * size)
   gboolean ret;
 
   GST_OBJECT_LOCK (src);
-  if (!src->buffer) {
+  if (src->base64_data) {
+    ret = TRUE;
+    *size = src->base64_size;
+  } else if (!src->buffer) {
     ret = FALSE;
     *size = -1;
   } else {
@@ -210,6 +231,64 @@ gst_data_uri_src_is_seekable (GstBaseSrc * basesrc)
   return TRUE;
 }
 
+/* Returns TRUE if @data only has base64 characters and complete padding,
+ * which allows decoding any part of it. @size is set to the size of the
+ * decoded data. */
+static gboolean
+base64_get_decoded_size (const gchar * data, guint64 * size)
+{
+  const guchar *p;
+  guint64 len = 0;
+  guint pad = 0;
+
+  for (p = (const guchar *) data; *p; p++, len++) {
+    if (*p == '=')
+      pad++;
+    else if (pad > 0 || base64_values[*p] == 0xff)
+      return FALSE;
+  }
+
+  if (len == 0 || len % 4 != 0 || pad > 2)
+    return FALSE;
+
+  *size = len / 4 * 3 - pad;
+
+  return TRUE;
+}
+
+/* Decodes @size bytes at @offset of the base64 @data into @dest. The data
+ * must have been checked with base64_get_decoded_size() and the range must
+ * be inside the decoded data. Every 4 characters make 3 bytes. */
+static void
+base64_decode_range (const gchar * data, guint64 offset, gsize size,
+    guint8 * dest)
+{
+  const guchar *in = (const guchar *) data + offset / 3 * 4;
+  guint skip = offset % 3;
+
+  while (size > 0) {
+    guint32 v = base64_values[in[0]] << 18 | base64_values[in[1]] << 12 |
+        base64_values[in[2]] << 6 | base64_values[in[3]];
+
+    in += 4;
+    if (G_LIKELY (skip == 0 && size >= 3)) {
+      dest[0] = v >> 16;
+      dest[1] = v >> 8;
+      dest[2] = v;
+      dest += 3;
+      size -= 3;
+    } else {
+      guint8 tmp[3] = { v >> 16, v >> 8, v };
+      gsize n = MIN (3 - skip, size);
+
+      memcpy (dest, tmp + skip, n);
+      dest += n;
+      size -= n;
+      skip = 0;
+    }
+  }
+}
+
 static GstFlowReturn
 gst_data_uri_src_create (GstBaseSrc * basesrc, guint64 offset, guint size,
     GstBuffer ** buf)
@@ -219,6 +298,27 @@ gst_data_uri_src_create (GstBaseSrc * basesrc, guint64 offset, guint size,
 
   GST_OBJECT_LOCK (src);
 
+  if (src->base64_data) {
+    GstMapInfo info;
+
+    if (offset + size > src->base64_size) {
+      GST_OBJECT_UNLOCK (src);
+      return GST_FLOW_EOS;
+    }
+
+    if (*buf == NULL)
+      *buf = gst_buffer_new_allocate (NULL, size, NULL);
+    else
+      gst_buffer_set_size (*buf, size);
+
+    gst_buffer_map (*buf, &info, GST_MAP_WRITE);
+    base64_decode_range (src->base64_data, offset, size, info.data);
+    gst_buffer_unmap (*buf, &info);
+    GST_OBJECT_UNLOCK (src);
+
+    return GST_FLOW_OK;
+  }
+
   if (!src->buffer)
     goto no_buffer;
 
@@ -265,7 +365,8 @@ gst_data_uri_src_start (GstBaseSrc * basesrc)
 
   GST_OBJECT_LOCK (src);
 
-  if (src->uri == NULL || *src->uri == '\0' || src->buffer == NULL)
+  if (src->uri == NULL || *src->uri == '\0' || (src->buffer == NULL
+          && src->base64_data == NULL))
     goto no_uri;
 
   GST_OBJECT_UNLOCK (src);
@@ -322,9 +423,11 @@ gst_data_uri_src_set_uri (GstURIHandler * handler, const gchar * uri,
   GstCaps *caps;
   GstBuffer *buffer;
   gboolean base64 = FALSE;
+  gboolean convert;
   gchar *charset = NULL;
   gpointer bdata;
   gsize bsize;
+  guint64 base64_size = 0;
 
   GST_OBJECT_LOCK (src);
   if (GST_STATE (src) >= GST_STATE_PAUSED)
@@ -376,36 +479,52 @@ gst_data_uri_src_set_uri (GstURIHandler * handler, const gchar * uri,
     g_strfreev (parameters_strv);
   }
 
+  convert = strcmp ("text/plain", mimetype) == 0 &&
+      charset && g_ascii_strcasecmp ("US-ASCII", charset) != 0
+      && g_ascii_strcasecmp ("UTF-8", charset) != 0;
+
   /* Skip comma */
   data_start += 1;
-  if (base64) {
-    bdata = g_base64_decode (data_start, &bsize);
-  } else {
-    /* URI encoded, i.e. "percent" encoding */
-    bdata = g_uri_unescape_string (data_start, NULL);
-    if (bdata == NULL)
-      goto invalid_uri_encoded_data;
-    bsize = strlen (bdata) + 1;
-  }
-  /* Convert to UTF8 */
-  if (strcmp ("text/plain", mimetype) == 0 &&
-      charset && g_ascii_strcasecmp ("US-ASCII", charset) != 0
-      && g_ascii_strcasecmp ("UTF-8", charset) != 0) {
-    gsize read;
-    gsize written;
-    gpointer data;
-
-    data =
-        g_convert_with_fallback (bdata, -1, "UTF-8", charset, (char *) "*",
-        &read, &written, NULL);
+  if (base64 && !convert
+      && base64_get_decoded_size (data_start, &base64_size)) {
+    /* decoded while reading, only decode the start for typefinding */
+    bsize = MIN (base64_size, TYPEFIND_SIZE);
+    bdata = g_malloc (bsize);
+    base64_decode_range (data_start, 0, bsize, bdata);
+    caps = gst_type_find_helper_for_data (GST_OBJECT (src), bdata, bsize,
+        NULL);
     g_free (bdata);
+    buffer = NULL;
+  } else {
+    if (base64) {
+      bdata = g_base64_decode (data_start, &bsize);
+    } else {
+      /* URI encoded, i.e. "percent" encoding */
+      bdata = g_uri_unescape_string (data_start, NULL);
+      if (bdata == NULL)
+        goto invalid_uri_encoded_data;
+      bsize = strlen (bdata) + 1;
+    }
+    /* Convert to UTF8 */
+    if (convert) {
+      gsize read;
+      gsize written;
+      gpointer data;
+
+      data =
+          g_convert_with_fallback (bdata, -1, "UTF-8", charset, (char *) "*",
+          &read, &written, NULL);
+      g_free (bdata);
+
+      bdata = data;
+      bsize = written;
+    }
+    buffer = gst_buffer_new_wrapped (bdata, bsize);
+    base64_size = 0;
 
-    bdata = data;
-    bsize = written;
+    caps = gst_type_find_helper_for_buffer (GST_OBJECT (src), buffer, NULL);
   }
-  buffer = gst_buffer_new_wrapped (bdata, bsize);
 
-  caps = gst_type_find_helper_for_buffer (GST_OBJECT (src), buffer, NULL);
   if (!caps)
     caps = gst_caps_new_empty_simple (mimetype);
   gst_base_src_set_caps (GST_BASE_SRC_CAST (src), caps);
@@ -413,9 +532,17 @@ gst_data_uri_src_set_uri (GstURIHandler * handler, const gchar * uri,
 
   GST_OBJECT_LOCK (src);
   gst_buffer_replace (&src->buffer, buffer);
-  gst_buffer_unref (buffer);
+  if (buffer)
+    gst_buffer_unref (buffer);
   g_free (src->uri);
   src->uri = g_strdup (orig_uri);
+  if (base64_size > 0) {
+    src->base64_data = src->uri + (data_start - orig_uri);
+    src->base64_size = base64_size;
+  } else {
+    src->base64_data = NULL;
+    src->base64_size = 0;
+  }
   GST_OBJECT_UNLOCK (src);
 
   ret = TRUE;
@@ -47,6 +47,11 @@ struct _GstDataURISrc
   /* <private> */
   gchar *uri;
   GstBuffer *buffer;
+
+  /* base64 data inside uri that is decoded on demand, used instead of
+   * buffer */
+  const gchar *base64_data;
+  guint64 base64_size;
 };
 
 struct _GstDataURISrcClass
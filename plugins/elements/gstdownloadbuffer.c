@@ -40,6 +40,16 @@
  * The temp-location property will be used to notify the application of the
  * allocated filename.
  *
+ * When #GstDownloadBuffer:shared-cache is enabled, the data is stored in a
+ * file that is shared with all other downloadbuffer elements of the process
+ * that download the same URI, as reported by the URI query upstream. Data
+ * that another element already downloaded is not downloaded again and when
+ * two elements download the same part at the same time, the one that is
+ * behind waits for the other one. The shared files are kept after use until
+ * the total size of the files is larger than
+ * #GstDownloadBuffer:shared-cache-max-size, then the least recently used
+ * files that are not in use are removed.
+ *
  * When the downloadbuffer has completely downloaded the media, it will
  * post an application message named  <classname>&quot;GstCacheDownloadComplete&quot;</classname>
  * with the following information:
@@ -103,6 +113,8 @@ enum
 #define DEFAULT_LOW_PERCENT        10
 #define DEFAULT_HIGH_PERCENT       99
 #define DEFAULT_TEMP_REMOVE        TRUE
+#define DEFAULT_SHARED_CACHE       FALSE
+#define DEFAULT_SHARED_CACHE_MAX_SIZE (512 * 1024 * 1024)       /* 512 MB */
 
 enum
 {
@@ -114,6 +126,8 @@ enum
   PROP_TEMP_TEMPLATE,
   PROP_TEMP_LOCATION,
   PROP_TEMP_REMOVE,
+  PROP_SHARED_CACHE,
+  PROP_SHARED_CACHE_MAX_SIZE,
   PROP_LAST
 };
 
@@ -166,6 +180,22 @@ enum
   }                                                                     \
 } G_STMT_END
 
+#define GST_DOWNLOAD_BUFFER_SIGNAL_FILL(q) G_STMT_START {                       \
+  if (q->waiting_fill)                                                  \
+    g_cond_signal (&q->fill_cond);                                      \
+} G_STMT_END
+
+/* the file is shared with other elements when using the shared cache */
+#define GST_DOWNLOAD_BUFFER_FILE_LOCK(q) G_STMT_START {                          \
+  if (q->cache)                                                         \
+    gst_download_cache_lock (q->cache);                                 \
+} G_STMT_END
+
+#define GST_DOWNLOAD_BUFFER_FILE_UNLOCK(q) G_STMT_START {                        \
+  if (q->cache)                                                         \
+    gst_download_cache_unlock (q->cache);                               \
+} G_STMT_END
+
 #define _do_init \
     GST_DEBUG_CATEGORY_INIT (downloadbuffer_debug, "downloadbuffer", 0, \
         "downloadbuffer element");
@@ -266,6 +296,35 @@ gst_download_buffer_class_init (GstDownloadBufferClass * klass)
           "Remove the temp-location after use",
           DEFAULT_TEMP_REMOVE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstDownloadBuffer:shared-cache:
+   *
+   * Store the data in a file that is shared with the other downloadbuffer
+   * elements that download the same URI. The file is created with
+   * temp-template and removed when the cache is evicted. With temp-remove
+   * it is unlinked right away where the platform allows it.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SHARED_CACHE,
+      g_param_spec_boolean ("shared-cache", "Shared cache",
+          "Share the downloaded data with other elements for the same URI",
+          DEFAULT_SHARED_CACHE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstDownloadBuffer:shared-cache-max-size:
+   *
+   * The maximum size of all the shared files together. Files that are in
+   * use are never removed.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SHARED_CACHE_MAX_SIZE,
+      g_param_spec_uint64 ("shared-cache-max-size", "Shared cache max. size",
+          "Max. amount of data to keep in the shared cache (bytes)",
+          0, G_MAXUINT64, DEFAULT_SHARED_CACHE_MAX_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* set several parent class virtual functions */
   gobject_class->finalize = gst_download_buffer_finalize;
 
@@ -326,11 +385,15 @@ gst_download_buffer_init (GstDownloadBuffer * dlbuf)
   g_mutex_init (&dlbuf->qlock);
   dlbuf->waiting_add = FALSE;
   g_cond_init (&dlbuf->item_add);
+  dlbuf->waiting_fill = FALSE;
+  g_cond_init (&dlbuf->fill_cond);
 
   /* tempfile related */
   dlbuf->temp_template = NULL;
   dlbuf->temp_location = NULL;
   dlbuf->temp_remove = DEFAULT_TEMP_REMOVE;
+  dlbuf->shared_cache = DEFAULT_SHARED_CACHE;
+  dlbuf->shared_cache_max_size = DEFAULT_SHARED_CACHE_MAX_SIZE;
 }
 
 /* called only once, as opposed to dispose */
@@ -341,6 +404,7 @@ gst_download_buffer_finalize (GObject * object)
 
   g_mutex_clear (&dlbuf->qlock);
   g_cond_clear (&dlbuf->item_add);
+  g_cond_clear (&dlbuf->fill_cond);
   g_timer_destroy (dlbuf->in_timer);
   g_timer_destroy (dlbuf->out_timer);
 
@@ -669,6 +733,7 @@ gst_download_buffer_wait_for_data (GstDownloadBuffer * dlbuf, guint64 offset,
   gsize start, stop;
   guint64 wanted;
   gboolean started;
+  gboolean other_fill = FALSE;
 
   GST_DEBUG_OBJECT (dlbuf, "wait for %" G_GUINT64_FORMAT ", length %u",
       offset, length);
@@ -681,6 +746,7 @@ gst_download_buffer_wait_for_data (GstDownloadBuffer * dlbuf, guint64 offset,
     g_timer_stop (dlbuf->out_timer);
 
   /* check range before us */
+  GST_DOWNLOAD_BUFFER_FILE_LOCK (dlbuf);
   if (gst_sparse_file_get_range_before (dlbuf->file, offset, &start, &stop)) {
     GST_DEBUG_OBJECT (dlbuf,
         "range before %" G_GSIZE_FORMAT " - %" G_GSIZE_FORMAT, start, stop);
@@ -703,7 +769,16 @@ gst_download_buffer_wait_for_data (GstDownloadBuffer * dlbuf, guint64 offset,
     }
   }
 
-  if (dlbuf->write_pos != offset)
+  /* another element is downloading this part, wait for it instead of
+   * downloading it again */
+  if (dlbuf->cache)
+    other_fill = gst_download_cache_is_filled_by_other (dlbuf->cache,
+        GST_OBJECT_CAST (dlbuf), offset, get_seek_threshold (dlbuf));
+  GST_DOWNLOAD_BUFFER_FILE_UNLOCK (dlbuf);
+
+  if (other_fill)
+    GST_DEBUG_OBJECT (dlbuf, "data is being downloaded by another element");
+  else if (dlbuf->write_pos != offset)
     perform_seek_to_offset (dlbuf, offset);
 
   dlbuf->filling = TRUE;
@@ -714,8 +789,22 @@ gst_download_buffer_wait_for_data (GstDownloadBuffer * dlbuf, guint64 offset,
 
   /* now wait for more data */
   GST_DEBUG_OBJECT (dlbuf, "waiting for more data");
-  GST_DOWNLOAD_BUFFER_WAIT_ADD_CHECK (dlbuf, dlbuf->srcresult, wanted,
-      out_flushing);
+  if (other_fill) {
+    gint64 end_time;
+
+    /* don't wait forever when the other element stops downloading, we'll
+     * download the data ourselves then */
+    end_time = g_get_monotonic_time () + GST_DOWNLOAD_CACHE_FILL_TIMEOUT;
+    dlbuf->waiting_add = TRUE;
+    dlbuf->waiting_offset = wanted;
+    g_cond_wait_until (&dlbuf->item_add, &dlbuf->qlock, end_time);
+    dlbuf->waiting_add = FALSE;
+    if (dlbuf->srcresult != GST_FLOW_OK)
+      goto out_flushing;
+  } else {
+    GST_DOWNLOAD_BUFFER_WAIT_ADD_CHECK (dlbuf, dlbuf->srcresult, wanted,
+        out_flushing);
+  }
   GST_DEBUG_OBJECT (dlbuf, "got more data");
 
   /* and continue if we were running before */
@@ -789,9 +878,11 @@ gst_download_buffer_read_buffer (GstDownloadBuffer * dlbuf, guint64 offset,
   dlbuf->read_pos = offset;
 
   do {
+    GST_DOWNLOAD_BUFFER_FILE_LOCK (dlbuf);
     res =
         gst_sparse_file_read (dlbuf->file, offset, info.data, length,
         &remaining, &error);
+    GST_DOWNLOAD_BUFFER_FILE_UNLOCK (dlbuf);
     if (G_UNLIKELY (res == 0)) {
       switch (error->code) {
         case GST_SPARSE_FILE_IO_ERROR_WOULD_BLOCK:
@@ -864,6 +955,36 @@ read_error:
   }
 }
 
+/* called when another element wrote to the shared cache */
+static void
+gst_download_buffer_cache_notify (GstObject * owner)
+{
+  GstDownloadBuffer *dlbuf = GST_DOWNLOAD_BUFFER_CAST (owner);
+
+  GST_DOWNLOAD_BUFFER_MUTEX_LOCK (dlbuf);
+  GST_DOWNLOAD_BUFFER_SIGNAL_ADD (dlbuf, -1);
+  GST_DOWNLOAD_BUFFER_SIGNAL_FILL (dlbuf);
+  GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
+}
+
+/* must be called with MUTEX_LOCK. Will briefly release the lock while doing
+ * the query. */
+static gchar *
+gst_download_buffer_get_upstream_uri (GstDownloadBuffer * dlbuf)
+{
+  GstQuery *query;
+  gchar *uri = NULL;
+
+  GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
+  query = gst_query_new_uri ();
+  if (gst_pad_peer_query (dlbuf->sinkpad, query))
+    gst_query_parse_uri (query, &uri);
+  gst_query_unref (query);
+  GST_DOWNLOAD_BUFFER_MUTEX_LOCK (dlbuf);
+
+  return uri;
+}
+
 /* must be called with MUTEX_LOCK. Will briefly release the lock when notifying
  * the temp filename. */
 static gboolean
@@ -871,6 +992,8 @@ gst_download_buffer_open_temp_location_file (GstDownloadBuffer * dlbuf)
 {
   gint fd = -1;
   gchar *name = NULL;
+  gchar *uri = NULL;
+  GError *err = NULL;
 
   if (dlbuf->file)
     goto already_opened;
@@ -883,6 +1006,24 @@ gst_download_buffer_open_temp_location_file (GstDownloadBuffer * dlbuf)
   if (dlbuf->temp_template == NULL)
     goto no_directory;
 
+  if (dlbuf->shared_cache) {
+    if ((uri = gst_download_buffer_get_upstream_uri (dlbuf))) {
+      GST_DEBUG_OBJECT (dlbuf, "using shared cache for %s", uri);
+      dlbuf->cache = gst_download_cache_acquire (uri, dlbuf->temp_template,
+          dlbuf->temp_remove, dlbuf->shared_cache_max_size,
+          GST_OBJECT_CAST (dlbuf), gst_download_buffer_cache_notify, &err);
+      g_free (uri);
+      if (dlbuf->cache == NULL)
+        goto cache_failed;
+
+      dlbuf->file = gst_download_cache_get_file (dlbuf->cache);
+      name = g_strdup (gst_download_cache_get_location (dlbuf->cache));
+      dlbuf->temp_fd = -1;
+      goto opened;
+    }
+    GST_WARNING_OBJECT (dlbuf, "no upstream URI, not using the shared cache");
+  }
+
   /* make copy of the template, we don't want to change this */
   name = g_strdup (dlbuf->temp_template);
 #ifdef __BIONIC__
@@ -898,10 +1039,11 @@ gst_download_buffer_open_temp_location_file (GstDownloadBuffer * dlbuf)
   /* error creating file */
   if (!gst_sparse_file_set_fd (dlbuf->file, fd))
     goto open_failed;
+  dlbuf->temp_fd = fd;
 
+opened:
   g_free (dlbuf->temp_location);
   dlbuf->temp_location = name;
-  dlbuf->temp_fd = fd;
   reset_positions (dlbuf);
 
   GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
@@ -935,6 +1077,14 @@ mkstemp_failed:
     g_free (name);
     return FALSE;
   }
+cache_failed:
+  {
+    GST_ELEMENT_ERROR (dlbuf, RESOURCE, OPEN_READ,
+        (_("Could not create temp file \"%s\"."), dlbuf->temp_template),
+        ("%s", err->message));
+    g_clear_error (&err);
+    return FALSE;
+  }
 open_failed:
   {
     GST_ELEMENT_ERROR (dlbuf, RESOURCE, OPEN_READ,
@@ -946,6 +1096,8 @@ open_failed:
   }
 }
 
+/* must be called with MUTEX_LOCK. Will briefly release the lock when releasing
+ * the shared cache. */
 static void
 gst_download_buffer_close_temp_location_file (GstDownloadBuffer * dlbuf)
 {
@@ -955,6 +1107,19 @@ gst_download_buffer_close_temp_location_file (GstDownloadBuffer * dlbuf)
 
   GST_DEBUG_OBJECT (dlbuf, "closing sparse file");
 
+  /* the shared cache keeps the file for the next user. Releasing it wakes
+   * up the other users so it's done without our lock */
+  if (dlbuf->cache) {
+    GstDownloadCache *cache = dlbuf->cache;
+
+    dlbuf->cache = NULL;
+    dlbuf->file = NULL;
+    GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
+    gst_download_cache_release (cache, GST_OBJECT_CAST (dlbuf));
+    GST_DOWNLOAD_BUFFER_MUTEX_LOCK (dlbuf);
+    return;
+  }
+
   if (dlbuf->temp_remove) {
     if (remove (dlbuf->temp_location) < 0) {
       GST_WARNING_OBJECT (dlbuf, "Failed to remove temporary file %s: %s",
@@ -969,7 +1134,8 @@ gst_download_buffer_close_temp_location_file (GstDownloadBuffer * dlbuf)
 static void
 gst_download_buffer_flush_temp_file (GstDownloadBuffer * dlbuf)
 {
-  if (dlbuf->file == NULL)
+  /* the data of the shared cache is still valid for the other users */
+  if (dlbuf->file == NULL || dlbuf->cache)
     return;
 
   GST_DEBUG_OBJECT (dlbuf, "flushing temp file");
@@ -1011,6 +1177,7 @@ gst_download_buffer_handle_sink_event (GstPad * pad, GstObject * parent,
         dlbuf->sinkresult = GST_FLOW_FLUSHING;
         /* unblock the loop and chain functions */
         GST_DOWNLOAD_BUFFER_SIGNAL_ADD (dlbuf, -1);
+        GST_DOWNLOAD_BUFFER_SIGNAL_FILL (dlbuf);
         GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
 
         /* make sure it pauses, this should happen since we sent
@@ -1021,6 +1188,7 @@ gst_download_buffer_handle_sink_event (GstPad * pad, GstObject * parent,
         GST_DOWNLOAD_BUFFER_MUTEX_LOCK (dlbuf);
         /* flush the sink pad */
         dlbuf->sinkresult = GST_FLOW_FLUSHING;
+        GST_DOWNLOAD_BUFFER_SIGNAL_FILL (dlbuf);
         GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
 
         gst_event_unref (event);
@@ -1132,10 +1300,39 @@ gst_download_buffer_handle_sink_query (GstPad * pad, GstObject * parent,
   return res;
 }
 
+/* called with DOWNLOAD_BUFFER_MUTEX. Waits while another element that uses
+ * the shared cache downloads the data right after our write position */
+static void
+gst_download_buffer_wait_for_other_fill (GstDownloadBuffer * dlbuf)
+{
+  guint64 threshold = get_seek_threshold (dlbuf);
+  gboolean other_fill;
+
+  while (dlbuf->sinkresult == GST_FLOW_OK && !dlbuf->seeking) {
+    gint64 end_time;
+
+    /* only wait for elements that are strictly ahead of us, two elements at
+     * the same position must not wait for each other */
+    GST_DOWNLOAD_BUFFER_FILE_LOCK (dlbuf);
+    other_fill = gst_download_cache_is_filled_by_other (dlbuf->cache,
+        GST_OBJECT_CAST (dlbuf), dlbuf->write_pos + 1, threshold);
+    GST_DOWNLOAD_BUFFER_FILE_UNLOCK (dlbuf);
+    if (!other_fill)
+      break;
+
+    GST_LOG_OBJECT (dlbuf, "waiting for another element to move ahead");
+    end_time = g_get_monotonic_time () + GST_DOWNLOAD_CACHE_FILL_TIMEOUT;
+    dlbuf->waiting_fill = TRUE;
+    g_cond_wait_until (&dlbuf->fill_cond, &dlbuf->qlock, end_time);
+    dlbuf->waiting_fill = FALSE;
+  }
+}
+
 static GstFlowReturn
 gst_download_buffer_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
   GstDownloadBuffer *dlbuf;
+  GstDownloadCache *cache;
   GstMapInfo info;
   guint64 offset;
   gsize res, available;
@@ -1160,6 +1357,16 @@ gst_download_buffer_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   if (dlbuf->seeking)
     goto out_seeking;
 
+  /* when another element downloads the same data, we let it do that and skip
+   * over its data once it is far enough ahead */
+  if ((cache = dlbuf->cache)) {
+    gst_download_buffer_wait_for_other_fill (dlbuf);
+    if (dlbuf->sinkresult != GST_FLOW_OK)
+      goto out_flushing;
+    if (dlbuf->seeking)
+      goto out_seeking;
+  }
+
   /* put buffer in dlbuf now */
   offset = dlbuf->write_pos;
 
@@ -1177,9 +1384,11 @@ gst_download_buffer_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GST_DEBUG_OBJECT (dlbuf, "Writing %" G_GSIZE_FORMAT " bytes to %"
       G_GUINT64_FORMAT, info.size, offset);
 
+  GST_DOWNLOAD_BUFFER_FILE_LOCK (dlbuf);
   res =
       gst_sparse_file_write (dlbuf->file, offset, info.data, info.size,
       &available, &error);
+  GST_DOWNLOAD_BUFFER_FILE_UNLOCK (dlbuf);
   if (res == 0)
     goto write_error;
 
@@ -1189,14 +1398,22 @@ gst_download_buffer_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   dlbuf->write_pos = offset + info.size;
   dlbuf->bytes_in += info.size;
 
+  if (cache)
+    gst_download_cache_written (cache, GST_OBJECT_CAST (dlbuf),
+        dlbuf->write_pos);
+
   GST_DOWNLOAD_BUFFER_SIGNAL_ADD (dlbuf, dlbuf->write_pos + available);
 
   /* we hit the end, see what to do */
   if (dlbuf->write_pos + available == dlbuf->upstream_size) {
     gsize start, stop;
+    gboolean found;
 
     /* we have everything up to the end, find a region to fill */
-    if (gst_sparse_file_get_range_after (dlbuf->file, 0, &start, &stop)) {
+    GST_DOWNLOAD_BUFFER_FILE_LOCK (dlbuf);
+    found = gst_sparse_file_get_range_after (dlbuf->file, 0, &start, &stop);
+    GST_DOWNLOAD_BUFFER_FILE_UNLOCK (dlbuf);
+    if (found) {
       if (stop < dlbuf->upstream_size) {
         /* a hole to fill, seek to its end */
         perform_seek_to_offset (dlbuf, stop);
@@ -1228,6 +1445,9 @@ gst_download_buffer_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
   GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
 
+  if (cache)
+    gst_download_cache_notify (cache, GST_OBJECT_CAST (dlbuf));
+
   if (msg != NULL)
     gst_element_post_message (GST_ELEMENT_CAST (dlbuf), msg);
 
@@ -1290,6 +1510,9 @@ completed:
 
     GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
 
+    if (cache)
+      gst_download_cache_notify (cache, GST_OBJECT_CAST (dlbuf));
+
     if (msg != NULL)
       gst_element_post_message (GST_ELEMENT_CAST (dlbuf), msg);
 
@@ -1424,6 +1647,20 @@ gst_download_buffer_handle_src_event (GstPad * pad, GstObject * parent,
   return res;
 }
 
+/* called with DOWNLOAD_BUFFER_MUTEX */
+static gboolean
+gst_download_buffer_get_range_after (GstDownloadBuffer * dlbuf, gsize offset,
+    gsize * start, gsize * stop)
+{
+  gboolean res;
+
+  GST_DOWNLOAD_BUFFER_FILE_LOCK (dlbuf);
+  res = gst_sparse_file_get_range_after (dlbuf->file, offset, start, stop);
+  GST_DOWNLOAD_BUFFER_FILE_UNLOCK (dlbuf);
+
+  return res;
+}
+
 static gboolean
 gst_download_buffer_handle_src_query (GstPad * pad, GstObject * parent,
     GstQuery * query)
@@ -1518,7 +1755,7 @@ gst_download_buffer_handle_src_query (GstPad * pad, GstObject * parent,
         start = offset = 0;
         stop = -1;
         estimated_total = -1;
-        while (gst_sparse_file_get_range_after (dlbuf->file, offset,
+        while (gst_download_buffer_get_range_after (dlbuf, offset,
                 &range_start, &range_stop)) {
           gboolean current_range;
 
@@ -1685,6 +1922,7 @@ gst_download_buffer_sink_activate_mode (GstPad * pad, GstObject * parent,
         GST_DEBUG_OBJECT (dlbuf, "deactivating push mode");
         dlbuf->srcresult = GST_FLOW_FLUSHING;
         dlbuf->sinkresult = GST_FLOW_FLUSHING;
+        GST_DOWNLOAD_BUFFER_SIGNAL_FILL (dlbuf);
         GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
 
         /* wait until it is unblocked and clean up */
@@ -1732,6 +1970,7 @@ gst_download_buffer_src_activate_push (GstPad * pad, GstObject * parent,
     dlbuf->sinkresult = GST_FLOW_FLUSHING;
     /* the item add signal will unblock */
     GST_DOWNLOAD_BUFFER_SIGNAL_ADD (dlbuf, -1);
+    GST_DOWNLOAD_BUFFER_SIGNAL_FILL (dlbuf);
     GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
 
     /* step 2, make sure streaming finishes */
@@ -1768,6 +2007,7 @@ gst_download_buffer_src_activate_pull (GstPad * pad, GstObject * parent,
     dlbuf->sinkresult = GST_FLOW_FLUSHING;
     /* this will unlock getrange */
     GST_DOWNLOAD_BUFFER_SIGNAL_ADD (dlbuf, -1);
+    GST_DOWNLOAD_BUFFER_SIGNAL_FILL (dlbuf);
     result = TRUE;
     GST_DOWNLOAD_BUFFER_MUTEX_UNLOCK (dlbuf);
   }
@@ -1911,6 +2151,12 @@ gst_download_buffer_set_property (GObject * object,
     case PROP_TEMP_REMOVE:
       dlbuf->temp_remove = g_value_get_boolean (value);
       break;
+    case PROP_SHARED_CACHE:
+      dlbuf->shared_cache = g_value_get_boolean (value);
+      break;
+    case PROP_SHARED_CACHE_MAX_SIZE:
+      dlbuf->shared_cache_max_size = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1953,6 +2199,12 @@ gst_download_buffer_get_property (GObject * object,
     case PROP_TEMP_REMOVE:
       g_value_set_boolean (value, dlbuf->temp_remove);
       break;
+    case PROP_SHARED_CACHE:
+      g_value_set_boolean (value, dlbuf->shared_cache);
+      break;
+    case PROP_SHARED_CACHE_MAX_SIZE:
+      g_value_set_uint64 (value, dlbuf->shared_cache_max_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -25,6 +25,7 @@
 #include <stdio.h>
 
 #include "gstsparsefile.h"
+#include "gstdownloadcache.h"
 
 G_BEGIN_DECLS
 
@@ -110,6 +111,13 @@ struct _GstDownloadBuffer
   gint temp_fd;
   gboolean seeking;
 
+  /* shared cache stuff */
+  gboolean shared_cache;
+  guint64 shared_cache_max_size;
+  GstDownloadCache *cache;
+  gboolean waiting_fill;
+  GCond fill_cond;             /* signals when another element wrote data */
+
   GstEvent *stream_start_event;
   GstEvent *segment_event;
 };
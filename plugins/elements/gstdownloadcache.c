@@ -0,0 +1,477 @@
+/* GStreamer
+ *
+ * gstdownloadcache.c: download cache shared between elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#include <glib/gstdio.h>
+
+#include "gstdownloadcache.h"
+
+#ifdef G_OS_WIN32
+#include <io.h>                 /* close */
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __BIONIC__
+#include <fcntl.h>
+#endif
+
+typedef struct _GstDownloadCacheUser GstDownloadCacheUser;
+
+struct _GstDownloadCacheUser
+{
+  GstObject *owner;
+  GstDownloadCacheNotify notify;
+
+  /* the position after the last write of this user */
+  guint64 position;
+  gint64 last_write;
+};
+
+struct _GstDownloadCache
+{
+  gchar *uri;
+  gchar *location;
+  /* the file was unlinked right after it was created */
+  gboolean unlinked;
+  GstSparseFile *file;
+
+  /* protects the file and the users */
+  GMutex lock;
+  GList *users;
+
+  /* protected by caches_lock */
+  GList link;
+  guint n_users;
+  guint64 size;
+};
+
+/* all the caches by URI and in least recently used order, with the most
+ * recently used first */
+static GMutex caches_lock;
+static GHashTable *caches;
+static GQueue lru = G_QUEUE_INIT;
+static guint64 total_size;
+static guint64 max_total_size;
+
+static GstDownloadCache *
+cache_new (const gchar * uri, const gchar * temp_template,
+    gboolean temp_remove, GError ** error)
+{
+  GstDownloadCache *cache;
+  GstSparseFile *file;
+  gchar *name;
+  gint fd;
+
+  name = g_strdup (temp_template);
+#ifdef __BIONIC__
+  fd = g_mkstemp_full (name, O_RDWR | O_LARGEFILE, S_IRUSR | S_IWUSR);
+#else
+  fd = g_mkstemp (name);
+#endif
+  if (fd == -1)
+    goto mkstemp_failed;
+
+  file = gst_sparse_file_new ();
+  if (!gst_sparse_file_set_fd (file, fd))
+    goto open_failed;
+
+  cache = g_slice_new0 (GstDownloadCache);
+  cache->uri = g_strdup (uri);
+  cache->location = name;
+  cache->file = file;
+  g_mutex_init (&cache->lock);
+  cache->link.data = cache;
+
+#ifndef G_OS_WIN32
+  /* the fd keeps the data, so nothing is left behind when the process exits
+   * before the cache is evicted */
+  if (temp_remove && g_unlink (name) == 0)
+    cache->unlinked = TRUE;
+#endif
+
+  return cache;
+
+  /* ERRORS */
+mkstemp_failed:
+  {
+    gint errsv = errno;
+
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+        "Could not create temp file \"%s\": %s", temp_template,
+        g_strerror (errsv));
+    g_free (name);
+    return NULL;
+  }
+open_failed:
+  {
+    gint errsv = errno;
+
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+        "Could not open file \"%s\": %s", name, g_strerror (errsv));
+    gst_sparse_file_free (file);
+    close (fd);
+    g_remove (name);
+    g_free (name);
+    return NULL;
+  }
+}
+
+static void
+cache_free (GstDownloadCache * cache)
+{
+  gst_sparse_file_free (cache->file);
+  if (!cache->unlinked)
+    g_remove (cache->location);
+  g_mutex_clear (&cache->lock);
+  g_free (cache->location);
+  g_free (cache->uri);
+  g_slice_free (GstDownloadCache, cache);
+}
+
+/* called with caches_lock. Removes the least recently used caches until we
+ * are below the maximum size, caches that are in use are kept. Unused caches
+ * without data are always removed. */
+static void
+evict_unused (void)
+{
+  GList *walk, *prev;
+
+  for (walk = lru.tail; walk; walk = prev) {
+    GstDownloadCache *cache = walk->data;
+
+    prev = walk->prev;
+    if (cache->n_users > 0)
+      continue;
+    if (cache->size > 0 && total_size <= max_total_size)
+      continue;
+
+    g_queue_unlink (&lru, walk);
+    g_hash_table_remove (caches, cache->uri);
+    total_size -= cache->size;
+    cache_free (cache);
+  }
+}
+
+/* called with the cache lock */
+static GstDownloadCacheUser *
+find_user (GstDownloadCache * cache, GstObject * owner)
+{
+  GList *walk;
+
+  for (walk = cache->users; walk; walk = walk->next) {
+    GstDownloadCacheUser *user = walk->data;
+
+    if (user->owner == owner)
+      return user;
+  }
+  return NULL;
+}
+
+/* called with the cache lock, makes a list of the users to notify */
+static GList *
+collect_others (GstDownloadCache * cache, GstObject * owner)
+{
+  GList *walk, *result = NULL;
+
+  for (walk = cache->users; walk; walk = walk->next) {
+    GstDownloadCacheUser *user = walk->data;
+
+    if (user->owner == owner || user->notify == NULL)
+      continue;
+
+    user = g_slice_dup (GstDownloadCacheUser, user);
+    gst_object_ref (user->owner);
+    result = g_list_prepend (result, user);
+  }
+  return result;
+}
+
+static void
+notify_users (GList * users)
+{
+  GList *walk;
+
+  for (walk = users; walk; walk = walk->next) {
+    GstDownloadCacheUser *user = walk->data;
+
+    user->notify (user->owner);
+    gst_object_unref (user->owner);
+    g_slice_free (GstDownloadCacheUser, user);
+  }
+  g_list_free (users);
+}
+
+/**
+ * gst_download_cache_acquire:
+ * @uri: the URI of the data
+ * @temp_template: template for the file to store the data in
+ * @temp_remove: don't keep the file on disk
+ * @max_size: maximum size of all caches
+ * @owner: the user of the cache
+ * @notify: called when other users wrote to the cache
+ * @error: a #GError
+ *
+ * Get the cache for @uri, a new cache is made with an empty file created
+ * from @temp_template when there is none yet. With @temp_remove the file is
+ * unlinked right after it was created where the platform allows that.
+ * Otherwise it stays on disk until the cache is evicted. The user that
+ * creates the cache decides.
+ *
+ * When the caches together are bigger than @max_size, the least recently
+ * used caches without users are removed.
+ *
+ * Returns: a #GstDownloadCache or %NULL when the file could not be created.
+ * Release with gst_download_cache_release().
+ */
+GstDownloadCache *
+gst_download_cache_acquire (const gchar * uri, const gchar * temp_template,
+    gboolean temp_remove, guint64 max_size, GstObject * owner,
+    GstDownloadCacheNotify notify, GError ** error)
+{
+  GstDownloadCache *cache;
+  GstDownloadCacheUser *user;
+
+  g_return_val_if_fail (uri != NULL, NULL);
+  g_return_val_if_fail (temp_template != NULL, NULL);
+  g_return_val_if_fail (GST_IS_OBJECT (owner), NULL);
+
+  g_mutex_lock (&caches_lock);
+  if (caches == NULL)
+    caches = g_hash_table_new (g_str_hash, g_str_equal);
+  max_total_size = max_size;
+
+  cache = g_hash_table_lookup (caches, uri);
+  if (cache == NULL) {
+    if (!(cache = cache_new (uri, temp_template, temp_remove, error)))
+      goto done;
+    g_hash_table_insert (caches, cache->uri, cache);
+  } else {
+    g_queue_unlink (&lru, &cache->link);
+  }
+  g_queue_push_head_link (&lru, &cache->link);
+  cache->n_users++;
+
+  user = g_slice_new0 (GstDownloadCacheUser);
+  user->owner = owner;
+  user->notify = notify;
+
+  g_mutex_lock (&cache->lock);
+  cache->users = g_list_prepend (cache->users, user);
+  g_mutex_unlock (&cache->lock);
+
+  evict_unused ();
+
+done:
+  g_mutex_unlock (&caches_lock);
+
+  return cache;
+}
+
+/**
+ * gst_download_cache_release:
+ * @cache: a #GstDownloadCache
+ * @owner: the user of the cache
+ *
+ * Stop using @cache. The data stays available for the next user of the
+ * same URI until the cache is evicted. Must be called without any locks,
+ * the other users are notified.
+ */
+void
+gst_download_cache_release (GstDownloadCache * cache, GstObject * owner)
+{
+  GstDownloadCacheUser *user;
+  GList *others;
+
+  g_return_if_fail (cache != NULL);
+
+  g_mutex_lock (&caches_lock);
+  g_mutex_lock (&cache->lock);
+  if ((user = find_user (cache, owner))) {
+    cache->users = g_list_remove (cache->users, user);
+    g_slice_free (GstDownloadCacheUser, user);
+  }
+  /* the others might be waiting for our writes */
+  others = collect_others (cache, owner);
+  g_mutex_unlock (&cache->lock);
+
+  g_queue_unlink (&lru, &cache->link);
+  g_queue_push_head_link (&lru, &cache->link);
+  cache->n_users--;
+  evict_unused ();
+  g_mutex_unlock (&caches_lock);
+
+  notify_users (others);
+}
+
+/**
+ * gst_download_cache_get_file:
+ * @cache: a #GstDownloadCache
+ *
+ * Get the file with the data of @cache. The file should be used with the
+ * cache lock taken.
+ *
+ * Returns: the #GstSparseFile of @cache
+ */
+GstSparseFile *
+gst_download_cache_get_file (GstDownloadCache * cache)
+{
+  g_return_val_if_fail (cache != NULL, NULL);
+
+  return cache->file;
+}
+
+/**
+ * gst_download_cache_get_location:
+ * @cache: a #GstDownloadCache
+ *
+ * Returns: the location of the file of @cache
+ */
+const gchar *
+gst_download_cache_get_location (GstDownloadCache * cache)
+{
+  g_return_val_if_fail (cache != NULL, NULL);
+
+  return cache->location;
+}
+
+/**
+ * gst_download_cache_lock:
+ * @cache: a #GstDownloadCache
+ *
+ * Take the lock of @cache, it protects the file.
+ */
+void
+gst_download_cache_lock (GstDownloadCache * cache)
+{
+  g_mutex_lock (&cache->lock);
+}
+
+/**
+ * gst_download_cache_unlock:
+ * @cache: a #GstDownloadCache
+ *
+ * Release the lock of @cache.
+ */
+void
+gst_download_cache_unlock (GstDownloadCache * cache)
+{
+  g_mutex_unlock (&cache->lock);
+}
+
+/**
+ * gst_download_cache_written:
+ * @cache: a #GstDownloadCache
+ * @owner: the user of the cache
+ * @position: the position after the written data
+ *
+ * Let @cache know that @owner wrote data up to @position. Must be called
+ * without the cache lock.
+ */
+void
+gst_download_cache_written (GstDownloadCache * cache, GstObject * owner,
+    guint64 position)
+{
+  GstDownloadCacheUser *user;
+
+  g_return_if_fail (cache != NULL);
+
+  g_mutex_lock (&cache->lock);
+  if ((user = find_user (cache, owner))) {
+    user->position = position;
+    user->last_write = g_get_monotonic_time ();
+  }
+  g_mutex_unlock (&cache->lock);
+
+  g_mutex_lock (&caches_lock);
+  if (position > cache->size) {
+    total_size += position - cache->size;
+    cache->size = position;
+    if (total_size > max_total_size)
+      evict_unused ();
+  }
+  g_mutex_unlock (&caches_lock);
+}
+
+/**
+ * gst_download_cache_notify:
+ * @cache: a #GstDownloadCache
+ * @owner: the user of the cache
+ *
+ * Call the notify function of the other users of @cache. Must be called
+ * without any locks.
+ */
+void
+gst_download_cache_notify (GstDownloadCache * cache, GstObject * owner)
+{
+  GList *others;
+
+  g_return_if_fail (cache != NULL);
+
+  g_mutex_lock (&cache->lock);
+  others = collect_others (cache, owner);
+  g_mutex_unlock (&cache->lock);
+
+  notify_users (others);
+}
+
+/**
+ * gst_download_cache_is_filled_by_other:
+ * @cache: a #GstDownloadCache
+ * @owner: the user of the cache
+ * @offset: an offset
+ * @threshold: the maximum distance
+ *
+ * Check if another user of @cache recently wrote data up to a position
+ * between @offset and @offset + @threshold. In that case the data after
+ * @offset will soon be available without downloading it again. Must be
+ * called with the cache lock.
+ *
+ * Returns: %TRUE when another user is filling the data after @offset.
+ */
+gboolean
+gst_download_cache_is_filled_by_other (GstDownloadCache * cache,
+    GstObject * owner, guint64 offset, guint64 threshold)
+{
+  GList *walk;
+  gint64 now;
+
+  g_return_val_if_fail (cache != NULL, FALSE);
+
+  now = g_get_monotonic_time ();
+
+  for (walk = cache->users; walk; walk = walk->next) {
+    GstDownloadCacheUser *user = walk->data;
+
+    if (user->owner == owner || user->last_write == 0)
+      continue;
+
+    if (now - user->last_write < GST_DOWNLOAD_CACHE_FILL_TIMEOUT &&
+        user->position >= offset && user->position <= offset + threshold)
+      return TRUE;
+  }
+  return FALSE;
+}
@@ -0,0 +1,68 @@
+/* GStreamer
+ *
+ * gstdownloadcache.h: download cache shared between elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_DOWNLOAD_CACHE_H__
+#define __GST_DOWNLOAD_CACHE_H__
+
+#include <gst/gst.h>
+
+#include "gstsparsefile.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GstDownloadCache GstDownloadCache;
+
+/* how long, in microseconds, a user that stopped writing is still
+ * considered to be filling the cache */
+#define GST_DOWNLOAD_CACHE_FILL_TIMEOUT   (G_USEC_PER_SEC)
+
+/* called without locks when another user of the cache wrote data */
+typedef void (*GstDownloadCacheNotify) (GstObject * owner);
+
+GstDownloadCache * gst_download_cache_acquire   (const gchar * uri,
+                                                 const gchar * temp_template,
+                                                 gboolean temp_remove,
+                                                 guint64 max_size,
+                                                 GstObject * owner,
+                                                 GstDownloadCacheNotify notify,
+                                                 GError ** error);
+void               gst_download_cache_release   (GstDownloadCache * cache,
+                                                 GstObject * owner);
+
+GstSparseFile *    gst_download_cache_get_file  (GstDownloadCache * cache);
+const gchar *      gst_download_cache_get_location (GstDownloadCache * cache);
+
+void               gst_download_cache_lock      (GstDownloadCache * cache);
+void               gst_download_cache_unlock    (GstDownloadCache * cache);
+
+void               gst_download_cache_written   (GstDownloadCache * cache,
+                                                 GstObject * owner,
+                                                 guint64 position);
+void               gst_download_cache_notify    (GstDownloadCache * cache,
+                                                 GstObject * owner);
+
+gboolean           gst_download_cache_is_filled_by_other (GstDownloadCache * cache,
+                                                 GstObject * owner,
+                                                 guint64 offset,
+                                                 guint64 threshold);
+
+G_END_DECLS
+
+#endif /* __GST_DOWNLOAD_CACHE_H__ */
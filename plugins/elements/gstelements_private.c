@@ -38,6 +38,11 @@
 #include "gst/gst.h"
 #include "gstelements_private.h"
 
+#if defined (HAVE_SYS_SENDFILE_H) && defined (HAVE_SENDFILE) && defined (__linux__)
+#include <sys/sendfile.h>
+#define HAVE_LINUX_SENDFILE 1
+#endif
+
 #ifdef G_OS_WIN32
 #  define WIN32_LEAN_AND_MEAN   /* prevents from including too many things */
 #  include <windows.h>
@@ -350,3 +355,183 @@ write_error:
     goto out;
   }
 }
+
+/* Memories that contain an unmodified range of a file carry the descriptor
+ * and the file offset of their maxsize area as qdata, so that sinks can
+ * pass the data on without touching it. The descriptor has to stay open as
+ * long as the memory exists. */
+typedef struct
+{
+  gint fd;
+  guint64 offset;
+} GstFileRange;
+
+static GQuark
+gst_file_range_quark (void)
+{
+  static GQuark quark = 0;
+
+  if (G_UNLIKELY (quark == 0))
+    quark = g_quark_from_static_string ("GstFileRange");
+
+  return quark;
+}
+
+static void
+gst_file_range_free (GstFileRange * range)
+{
+  g_slice_free (GstFileRange, range);
+}
+
+/* @mem must be read-only, @offset is the file offset of the start of its
+ * maxsize area */
+void
+gst_memory_set_file_range (GstMemory * mem, gint fd, guint64 offset)
+{
+  GstFileRange *range;
+
+  g_return_if_fail (GST_MEMORY_IS_READONLY (mem));
+
+  range = g_slice_new (GstFileRange);
+  range->fd = fd;
+  range->offset = offset;
+
+  gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (mem),
+      gst_file_range_quark (), range, (GDestroyNotify) gst_file_range_free);
+}
+
+/* get the descriptor and the file offset of the visible data of @mem, this
+ * also works for memories shared from a file memory */
+gboolean
+gst_memory_get_file_range (GstMemory * mem, gint * fd, guint64 * offset)
+{
+  GstFileRange *range;
+  GstMemory *root;
+
+  for (root = mem; root->parent; root = root->parent);
+
+  range = gst_mini_object_get_qdata (GST_MINI_OBJECT_CAST (root),
+      gst_file_range_quark ());
+  if (range == NULL)
+    return FALSE;
+
+  *fd = range->fd;
+  *offset = range->offset + mem->offset;
+
+  return TRUE;
+}
+
+/* Writes the buffers with sendfile() from the files their memories come
+ * from. Returns GST_FLOW_NOT_SUPPORTED without writing anything when not all
+ * memories are file ranges or @fd doesn't support it. */
+GstFlowReturn
+gst_sendfile_buffers (GstObject * sink, gint fd, GstPoll * fdset,
+    GstBuffer ** buffers, guint num_buffers, guint64 * bytes_written,
+    guint64 skip)
+{
+#ifdef HAVE_LINUX_SENDFILE
+  gboolean written = FALSE;
+  guint64 offset;
+  gint in_fd;
+  guint i, j, n;
+
+  for (i = 0; i < num_buffers; i++) {
+    n = gst_buffer_n_memory (buffers[i]);
+    for (j = 0; j < n; j++) {
+      if (!gst_memory_get_file_range (gst_buffer_peek_memory (buffers[i], j),
+              &in_fd, &offset))
+        return GST_FLOW_NOT_SUPPORTED;
+    }
+  }
+
+  GST_LOG_OBJECT (sink, "sending %u buffers from file", num_buffers);
+
+  for (i = 0; i < num_buffers; i++) {
+    n = gst_buffer_n_memory (buffers[i]);
+    for (j = 0; j < n; j++) {
+      GstMemory *mem = gst_buffer_peek_memory (buffers[i], j);
+      gsize left = mem->size;
+      off_t pos;
+      gssize ret;
+
+      if (skip >= left) {
+        skip -= left;
+        continue;
+      }
+
+      gst_memory_get_file_range (mem, &in_fd, &offset);
+      pos = offset + skip;
+      left -= skip;
+      skip = 0;
+
+      while (left > 0) {
+        if (fdset != NULL) {
+          do {
+            ret = gst_poll_wait (fdset, GST_CLOCK_TIME_NONE);
+          } while (ret == -1 && (errno == EINTR || errno == EAGAIN));
+
+          if (ret == -1) {
+            if (errno == EBUSY)
+              goto stopped;
+            else
+              goto select_error;
+          }
+        }
+
+        ret = sendfile (fd, in_fd, &pos, left);
+
+        if (ret > 0) {
+          if (bytes_written)
+            *bytes_written += ret;
+          left -= ret;
+          written = TRUE;
+        } else if (ret < 0 && (errno == EINTR || errno == EAGAIN
+                || errno == EWOULDBLOCK)) {
+          /* do nothing, try again */
+        } else if (ret < 0 && !written && (errno == EINVAL
+                || errno == ENOSYS)) {
+          GST_DEBUG_OBJECT (sink, "sendfile not supported: %s",
+              g_strerror (errno));
+          return GST_FLOW_NOT_SUPPORTED;
+        } else {
+          /* 0 means the file was truncated under us */
+          if (ret == 0)
+            errno = EIO;
+          goto write_error;
+        }
+      }
+    }
+  }
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+select_error:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, READ, (NULL),
+        ("select on file descriptor: %s", g_strerror (errno)));
+    return GST_FLOW_ERROR;
+  }
+stopped:
+  {
+    GST_DEBUG_OBJECT (sink, "Select stopped");
+    return GST_FLOW_FLUSHING;
+  }
+write_error:
+  {
+    switch (errno) {
+      case ENOSPC:
+        GST_ELEMENT_ERROR (sink, RESOURCE, NO_SPACE_LEFT, (NULL), (NULL));
+        break;
+      default:
+        GST_ELEMENT_ERROR (sink, RESOURCE, WRITE, (NULL),
+            ("Error while writing to file descriptor %d: %s",
+                fd, g_strerror (errno)));
+        break;
+    }
+    return GST_FLOW_ERROR;
+  }
+#else
+  return GST_FLOW_NOT_SUPPORTED;
+#endif
+}
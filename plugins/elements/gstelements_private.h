@@ -39,6 +39,18 @@ GstFlowReturn  gst_writev_buffers (GstObject * sink, gint fd, GstPoll * fdset,
                                    guint8 * mem_nums, guint total_mem_num,
                                    guint64 * bytes_written, guint64 skip);
 
+G_GNUC_INTERNAL
+void      gst_memory_set_file_range (GstMemory * mem, gint fd, guint64 offset);
+
+G_GNUC_INTERNAL
+gboolean  gst_memory_get_file_range (GstMemory * mem, gint * fd,
+                                     guint64 * offset);
+
+G_GNUC_INTERNAL
+GstFlowReturn  gst_sendfile_buffers (GstObject * sink, gint fd, GstPoll * fdset,
+                                     GstBuffer ** buffers, guint num_buffers,
+                                     guint64 * bytes_written, guint64 skip);
+
 G_END_DECLS
 
 #endif /* __GST_ELEMENTS_PRIVATE_H__ */
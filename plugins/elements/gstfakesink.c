@@ -31,6 +31,26 @@
  * gst-launch-1.0 audiotestsrc num-buffers=1000 ! fakesink sync=false
  * ]| Render 1000 audio buffers (of default size) as fast as possible.
  *
+ * When #GstFakeSink:stats-interval is set, fakesink posts an element message
+ * with a "GstFakeSinkStats" structure at that interval and on EOS. It
+ * describes the buffers received since the previous message:
+ *
+ * * "interval" (#guint64): the duration of the interval in nanoseconds
+ * * "buffers" (#guint64), "bytes" (#guint64): the amount of data received
+ * * "buffers-per-second" (#gdouble), "bytes-per-second" (#gdouble): the
+ *   throughput
+ * * "min-latency" (#guint64), "max-latency" (#guint64): the extremes of the
+ *   time between the running time of the buffers and the running time of the
+ *   clock when they were received, or GST_CLOCK_TIME_NONE
+ * * "latency-histogram" (#GstValueArray of #guint64): the number of buffers
+ *   with a latency below 1 microsecond in the first entry and between 2^(i-1)
+ *   and 2^i microseconds in entry i, the last one collecting all the longer
+ *   latencies
+ *
+ * Unlike the #GstFakeSink::handoff signal this has no per buffer overhead
+ * beyond reading the clock. The latency is meaningful when the buffers are
+ * timestamped with the running time of the pipeline clock, for example by a
+ * live source.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -69,6 +89,7 @@ enum
 #define DEFAULT_CAN_ACTIVATE_PUSH TRUE
 #define DEFAULT_CAN_ACTIVATE_PULL FALSE
 #define DEFAULT_NUM_BUFFERS -1
+#define DEFAULT_STATS_INTERVAL 0
 
 enum
 {
@@ -81,7 +102,8 @@ enum
   PROP_LAST_MESSAGE,
   PROP_CAN_ACTIVATE_PUSH,
   PROP_CAN_ACTIVATE_PULL,
-  PROP_NUM_BUFFERS
+  PROP_NUM_BUFFERS,
+  PROP_STATS_INTERVAL
 };
 
 #define GST_TYPE_FAKE_SINK_STATE_ERROR (gst_fake_sink_state_error_get_type())
@@ -195,6 +217,19 @@ gst_fake_sink_class_init (GstFakeSinkClass * klass)
       g_param_spec_int ("num-buffers", "num-buffers",
           "Number of buffers to accept going EOS", -1, G_MAXINT,
           DEFAULT_NUM_BUFFERS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSink:stats-interval:
+   *
+   * Interval in milliseconds between the messages with the throughput and
+   * latency statistics, or 0 to disable them.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS_INTERVAL,
+      g_param_spec_uint ("stats-interval", "Stats interval",
+          "Interval in ms between statistics messages (0 = disabled)", 0,
+          G_MAXUINT, DEFAULT_STATS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   /**
    * GstFakeSink::handoff:
@@ -252,6 +287,8 @@ gst_fake_sink_init (GstFakeSink * fakesink)
   fakesink->state_error = DEFAULT_STATE_ERROR;
   fakesink->signal_handoffs = DEFAULT_SIGNAL_HANDOFFS;
   fakesink->num_buffers = DEFAULT_NUM_BUFFERS;
+  fakesink->stats_interval = DEFAULT_STATS_INTERVAL;
+  fakesink->stats_start = GST_CLOCK_TIME_NONE;
 
   gst_base_sink_set_sync (GST_BASE_SINK (fakesink), DEFAULT_SYNC);
   gst_base_sink_set_drop_out_of_segment (GST_BASE_SINK (fakesink),
@@ -298,6 +335,9 @@ gst_fake_sink_set_property (GObject * object, guint prop_id,
     case PROP_NUM_BUFFERS:
       sink->num_buffers = g_value_get_int (value);
       break;
+    case PROP_STATS_INTERVAL:
+      sink->stats_interval = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -343,6 +383,9 @@ gst_fake_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_NUM_BUFFERS:
       g_value_set_int (value, sink->num_buffers);
       break;
+    case PROP_STATS_INTERVAL:
+      g_value_set_uint (value, sink->stats_interval);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -355,11 +398,127 @@ gst_fake_sink_notify_last_message (GstFakeSink * sink)
   g_object_notify_by_pspec ((GObject *) sink, pspec_last_message);
 }
 
+static void
+gst_fake_sink_reset_stats (GstFakeSink * sink, GstClockTime now)
+{
+  sink->stats_start = now;
+  sink->stats_buffers = 0;
+  sink->stats_bytes = 0;
+  sink->min_latency = GST_CLOCK_TIME_NONE;
+  sink->max_latency = GST_CLOCK_TIME_NONE;
+  memset (sink->latency_histogram, 0, sizeof (sink->latency_histogram));
+}
+
+static void
+gst_fake_sink_post_stats (GstFakeSink * sink, GstClockTime now)
+{
+  GstClockTime interval = now - sink->stats_start;
+  GValue histogram = G_VALUE_INIT, count = G_VALUE_INIT;
+  GstStructure *s;
+  gdouble secs;
+  guint i;
+
+  g_value_init (&histogram, GST_TYPE_ARRAY);
+  g_value_init (&count, G_TYPE_UINT64);
+  for (i = 0; i < FAKE_SINK_LATENCY_BUCKETS; i++) {
+    g_value_set_uint64 (&count, sink->latency_histogram[i]);
+    gst_value_array_append_value (&histogram, &count);
+  }
+  g_value_unset (&count);
+
+  secs = (gdouble) interval / GST_SECOND;
+  s = gst_structure_new ("GstFakeSinkStats",
+      "interval", G_TYPE_UINT64, interval,
+      "buffers", G_TYPE_UINT64, sink->stats_buffers,
+      "bytes", G_TYPE_UINT64, sink->stats_bytes,
+      "buffers-per-second", G_TYPE_DOUBLE,
+      secs > 0 ? sink->stats_buffers / secs : 0.0,
+      "bytes-per-second", G_TYPE_DOUBLE,
+      secs > 0 ? sink->stats_bytes / secs : 0.0,
+      "min-latency", G_TYPE_UINT64, sink->min_latency,
+      "max-latency", G_TYPE_UINT64, sink->max_latency, NULL);
+  gst_structure_take_value (s, "latency-histogram", &histogram);
+
+  gst_element_post_message (GST_ELEMENT_CAST (sink),
+      gst_message_new_element (GST_OBJECT_CAST (sink), s));
+
+  gst_fake_sink_reset_stats (sink, now);
+}
+
+/* the time between the running time of @buf and the one of the clock */
+static GstClockTime
+gst_fake_sink_get_latency (GstFakeSink * sink, GstBuffer * buf)
+{
+  GstBaseSink *bsink = GST_BASE_SINK_CAST (sink);
+  GstClockTime ts, base_time, now;
+  GstClock *clock;
+
+  ts = GST_BUFFER_PTS (buf);
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    ts = GST_BUFFER_DTS (buf);
+  if (!GST_CLOCK_TIME_IS_VALID (ts) || bsink->segment.format != GST_FORMAT_TIME)
+    return GST_CLOCK_TIME_NONE;
+
+  ts = gst_segment_to_running_time (&bsink->segment, GST_FORMAT_TIME, ts);
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    return GST_CLOCK_TIME_NONE;
+
+  GST_OBJECT_LOCK (sink);
+  if ((clock = GST_ELEMENT_CLOCK (sink)))
+    gst_object_ref (clock);
+  base_time = GST_ELEMENT_CAST (sink)->base_time;
+  GST_OBJECT_UNLOCK (sink);
+
+  if (clock == NULL)
+    return GST_CLOCK_TIME_NONE;
+
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+  now = now > base_time ? now - base_time : 0;
+
+  return now > ts ? now - ts : 0;
+}
+
+static void
+gst_fake_sink_update_stats (GstFakeSink * sink, GstBuffer * buf)
+{
+  GstClockTime now = gst_util_get_timestamp ();
+  GstClockTime latency;
+
+  if (!GST_CLOCK_TIME_IS_VALID (sink->stats_start))
+    gst_fake_sink_reset_stats (sink, now);
+
+  sink->stats_buffers++;
+  sink->stats_bytes += gst_buffer_get_size (buf);
+
+  latency = gst_fake_sink_get_latency (sink, buf);
+  if (GST_CLOCK_TIME_IS_VALID (latency)) {
+    guint64 us = latency / GST_USECOND;
+    guint bucket = us > 0 ? g_bit_storage (us) : 0;
+
+    sink->latency_histogram[MIN (bucket, FAKE_SINK_LATENCY_BUCKETS - 1)]++;
+    if (!GST_CLOCK_TIME_IS_VALID (sink->min_latency)
+        || latency < sink->min_latency)
+      sink->min_latency = latency;
+    if (!GST_CLOCK_TIME_IS_VALID (sink->max_latency)
+        || latency > sink->max_latency)
+      sink->max_latency = latency;
+  }
+
+  if (now - sink->stats_start >= sink->stats_interval * GST_MSECOND)
+    gst_fake_sink_post_stats (sink, now);
+}
+
 static gboolean
 gst_fake_sink_event (GstBaseSink * bsink, GstEvent * event)
 {
   GstFakeSink *sink = GST_FAKE_SINK (bsink);
 
+  /* report the last partial interval */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS && sink->stats_interval > 0
+      && GST_CLOCK_TIME_IS_VALID (sink->stats_start))
+    gst_fake_sink_post_stats (sink, gst_util_get_timestamp ());
+
   if (!sink->silent) {
     const GstStructure *s;
     const gchar *tstr;
@@ -446,6 +605,9 @@ gst_fake_sink_render (GstBaseSink * bsink, GstBuffer * buf)
   if (sink->num_buffers_left != -1)
     sink->num_buffers_left--;
 
+  if (sink->stats_interval > 0)
+    gst_fake_sink_update_stats (sink, buf);
+
   if (!sink->silent) {
     gchar dts_str[64], pts_str[64], dur_str[64];
     gchar *flag_str, *meta_str;
@@ -555,6 +717,7 @@ gst_fake_sink_change_state (GstElement * element, GstStateChange transition)
       if (fakesink->state_error == FAKE_SINK_STATE_ERROR_READY_PAUSED)
         goto error;
       fakesink->num_buffers_left = fakesink->num_buffers;
+      fakesink->stats_start = GST_CLOCK_TIME_NONE;
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
       if (fakesink->state_error == FAKE_SINK_STATE_ERROR_PAUSED_PLAYING)
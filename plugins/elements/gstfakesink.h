@@ -64,6 +64,9 @@ typedef enum {
   FAKE_SINK_STATE_ERROR_READY_NULL
 } GstFakeSinkStateError;
 
+/* the number of power of two buckets of the latency histogram */
+#define FAKE_SINK_LATENCY_BUCKETS 24
+
 typedef struct _GstFakeSink GstFakeSink;
 typedef struct _GstFakeSinkClass GstFakeSinkClass;
 
@@ -82,6 +85,15 @@ struct _GstFakeSink {
   gchar			*last_message;
   gint                  num_buffers;
   gint                  num_buffers_left;
+
+  /* statistics of the current interval */
+  guint                 stats_interval;
+  GstClockTime          stats_start;
+  guint64               stats_buffers;
+  guint64               stats_bytes;
+  GstClockTime          min_latency;
+  GstClockTime          max_latency;
+  guint64               latency_histogram[FAKE_SINK_LATENCY_BUCKETS];
 };
 
 struct _GstFakeSinkClass {
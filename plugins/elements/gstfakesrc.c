@@ -36,6 +36,18 @@
  * ]| This pipeline will push 5 empty buffers to the fakesink element and then
  * sends an EOS.
  *
+ * To generate as much load as possible for the downstream elements, fakesrc
+ * can reuse its buffers from a pool with #GstFakeSrc:data set to "pool" and
+ * push them in buffer lists of #GstFakeSrc:buffer-list-size buffers. The
+ * memory of pooled buffers is only zeroed when it is allocated, so only the
+ * "random" and "pattern" fill types touch the data of every buffer. Several
+ * fakesrc instances stream from their own threads:
+ * |[
+ * gst-launch-1.0 funnel name=f ! fakesink stats-interval=1000 \
+ *     fakesrc data=pool sizetype=fixed buffer-list-size=32 ! queue ! f. \
+ *     fakesrc data=pool sizetype=fixed buffer-list-size=32 ! queue ! f.
+ * ]| This pipeline pushes buffers of 4096 bytes from two threads and reports
+ * the throughput every second.
  */
 
 /* FIXME: this ignores basesrc::blocksize property, which could be used as an
@@ -85,6 +97,7 @@ enum
 #define DEFAULT_CAN_ACTIVATE_PULL TRUE
 #define DEFAULT_CAN_ACTIVATE_PUSH TRUE
 #define DEFAULT_FORMAT          GST_FORMAT_BYTES
+#define DEFAULT_BUFFER_LIST_SIZE 0
 
 enum
 {
@@ -108,6 +121,7 @@ enum
   PROP_CAN_ACTIVATE_PUSH,
   PROP_IS_LIVE,
   PROP_FORMAT,
+  PROP_BUFFER_LIST_SIZE,
   PROP_LAST,
 };
 
@@ -145,6 +159,7 @@ gst_fake_src_data_get_type (void)
   static const GEnumValue fakesrc_data[] = {
     {FAKE_SRC_DATA_ALLOCATE, "Allocate data", "allocate"},
     {FAKE_SRC_DATA_SUBBUFFER, "Subbuffer data", "subbuffer"},
+    {FAKE_SRC_DATA_POOL, "Reuse buffers from a pool", "pool"},
     {0, NULL, NULL},
   };
 
@@ -220,6 +235,8 @@ static void gst_fake_src_get_times (GstBaseSrc * basesrc, GstBuffer * buffer,
 static GstFlowReturn gst_fake_src_create (GstBaseSrc * src, guint64 offset,
     guint length, GstBuffer ** buf);
 
+static void gst_fake_src_free_pool (GstFakeSrc * src);
+
 static guint gst_fake_src_signals[LAST_SIGNAL] = { 0 };
 
 static GParamSpec *pspec_last_message = NULL;
@@ -321,6 +338,20 @@ gst_fake_src_class_init (GstFakeSrcClass * klass)
           "The format of the segment events", GST_TYPE_FORMAT,
           DEFAULT_FORMAT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstFakeSrc:buffer-list-size:
+   *
+   * Push the buffers in buffer lists of this size when operating in push
+   * mode. Each buffer list counts as one buffer for #GstBaseSrc:num-buffers.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_BUFFER_LIST_SIZE,
+      g_param_spec_uint ("buffer-list-size", "Buffer list size",
+          "Number of buffers to push at once in a buffer list (0 = no lists)",
+          0, G_MAXUINT, DEFAULT_BUFFER_LIST_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstFakeSrc::handoff:
    * @fakesrc: the fakesrc instance
@@ -369,6 +400,7 @@ gst_fake_src_init (GstFakeSrc * fakesrc)
   fakesrc->datarate = DEFAULT_DATARATE;
   fakesrc->sync = DEFAULT_SYNC;
   fakesrc->format = DEFAULT_FORMAT;
+  fakesrc->buffer_list_size = DEFAULT_BUFFER_LIST_SIZE;
 }
 
 static void
@@ -383,6 +415,7 @@ gst_fake_src_finalize (GObject * object)
     gst_buffer_unref (src->parent);
     src->parent = NULL;
   }
+  gst_fake_src_free_pool (src);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -433,6 +466,136 @@ gst_fake_src_alloc_parent (GstFakeSrc * src)
   src->parentoffset = 0;
 }
 
+/* a pool that zeroes its memory once and restores the size of the buffers
+ * when they are released, so that randomly sized buffers are reused too */
+typedef struct
+{
+  GstBufferPool parent;
+  guint size;
+} GstFakeSrcBufferPool;
+
+typedef GstBufferPoolClass GstFakeSrcBufferPoolClass;
+
+static GType gst_fake_src_buffer_pool_get_type (void);
+
+G_DEFINE_TYPE (GstFakeSrcBufferPool, gst_fake_src_buffer_pool,
+    GST_TYPE_BUFFER_POOL);
+
+static gboolean
+gst_fake_src_buffer_pool_set_config (GstBufferPool * pool,
+    GstStructure * config)
+{
+  GstFakeSrcBufferPool *self = (GstFakeSrcBufferPool *) pool;
+
+  if (!gst_buffer_pool_config_get_params (config, NULL, &self->size, NULL,
+          NULL))
+    return FALSE;
+
+  return GST_BUFFER_POOL_CLASS (gst_fake_src_buffer_pool_parent_class)
+      ->set_config (pool, config);
+}
+
+static GstFlowReturn
+gst_fake_src_buffer_pool_alloc_buffer (GstBufferPool * pool,
+    GstBuffer ** buffer, GstBufferPoolAcquireParams * params)
+{
+  GstFlowReturn ret;
+  GstMapInfo info;
+
+  ret = GST_BUFFER_POOL_CLASS (gst_fake_src_buffer_pool_parent_class)
+      ->alloc_buffer (pool, buffer, params);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  if (gst_buffer_map (*buffer, &info, GST_MAP_WRITE)) {
+    memset (info.data, 0, info.size);
+    gst_buffer_unmap (*buffer, &info);
+  }
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_fake_src_buffer_pool_reset_buffer (GstBufferPool * pool,
+    GstBuffer * buffer)
+{
+  GstFakeSrcBufferPool *self = (GstFakeSrcBufferPool *) pool;
+
+  gst_buffer_resize (buffer, 0, self->size);
+
+  GST_BUFFER_POOL_CLASS (gst_fake_src_buffer_pool_parent_class)
+      ->reset_buffer (pool, buffer);
+}
+
+static void
+gst_fake_src_buffer_pool_class_init (GstFakeSrcBufferPoolClass * klass)
+{
+  klass->set_config = gst_fake_src_buffer_pool_set_config;
+  klass->alloc_buffer = gst_fake_src_buffer_pool_alloc_buffer;
+  klass->reset_buffer = gst_fake_src_buffer_pool_reset_buffer;
+}
+
+static void
+gst_fake_src_buffer_pool_init (GstFakeSrcBufferPool * pool)
+{
+}
+
+static void
+gst_fake_src_free_pool (GstFakeSrc * src)
+{
+  if (src->pool) {
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
+}
+
+static gboolean
+gst_fake_src_alloc_pool (GstFakeSrc * src, guint size)
+{
+  GstStructure *config;
+
+  gst_fake_src_free_pool (src);
+
+  src->pool = g_object_new (gst_fake_src_buffer_pool_get_type (), NULL);
+  src->pool_size = size;
+
+  /* no maximum, the pool grows to the number of buffers in flight */
+  config = gst_buffer_pool_get_config (src->pool);
+  gst_buffer_pool_config_set_params (config, NULL, size, 0, 0);
+  if (!gst_buffer_pool_set_config (src->pool, config) ||
+      !gst_buffer_pool_set_active (src->pool, TRUE)) {
+    gst_fake_src_free_pool (src);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static GstBuffer *
+gst_fake_src_acquire_buffer (GstFakeSrc * src, guint size)
+{
+  GstBuffer *buf = NULL;
+  guint pool_size;
+
+  pool_size = src->sizetype == FAKE_SRC_SIZETYPE_EMPTY ? 0 : src->sizemax;
+  pool_size = MAX (pool_size, size);
+
+  if (!src->pool || src->pool_size != pool_size) {
+    GST_DEBUG_OBJECT (src, "allocating pool of %u bytes buffers", pool_size);
+    if (!gst_fake_src_alloc_pool (src, pool_size))
+      return NULL;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (src->pool, &buf, NULL) != GST_FLOW_OK)
+    return NULL;
+
+  if (size != pool_size)
+    gst_buffer_resize (buf, 0, size);
+
+  return buf;
+}
+
 static void
 gst_fake_src_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -508,6 +671,9 @@ gst_fake_src_set_property (GObject * object, guint prop_id,
     case PROP_FORMAT:
       src->format = (GstFormat) g_value_get_enum (value);
       break;
+    case PROP_BUFFER_LIST_SIZE:
+      src->buffer_list_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -582,6 +748,9 @@ gst_fake_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_FORMAT:
       g_value_set_enum (value, src->format);
       break;
+    case PROP_BUFFER_LIST_SIZE:
+      g_value_set_uint (value, src->buffer_list_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -722,6 +891,19 @@ gst_fake_src_create_buffer (GstFakeSrc * src, gsize * bufsize)
       gst_fake_src_prepare_buffer (src, info.data, info.size);
       gst_buffer_unmap (buf, &info);
       break;
+    case FAKE_SRC_DATA_POOL:
+      buf = gst_fake_src_acquire_buffer (src, size);
+      if (buf == NULL)
+        goto buffer_create_fail;
+      /* the memory of the pool is already zeroed */
+      if (size > 0 && src->filltype != FAKE_SRC_FILLTYPE_NOTHING
+          && src->filltype != FAKE_SRC_FILLTYPE_ZERO) {
+        if (!gst_buffer_map (buf, &info, GST_MAP_WRITE))
+          goto buffer_write_fail;
+        gst_fake_src_prepare_buffer (src, info.data, info.size);
+        gst_buffer_unmap (buf, &info);
+      }
+      break;
     default:
       g_warning ("fakesrc: dunno how to allocate buffers !");
       buf = gst_buffer_new ();
@@ -783,18 +965,17 @@ gst_fake_src_get_times (GstBaseSrc * basesrc, GstBuffer * buffer,
   }
 }
 
-static GstFlowReturn
-gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
-    GstBuffer ** ret)
+static GstBuffer *
+gst_fake_src_create_one (GstFakeSrc * src, guint64 offset)
 {
-  GstFakeSrc *src;
+  GstBaseSrc *basesrc = GST_BASE_SRC_CAST (src);
   GstBuffer *buf;
   GstClockTime time;
   gsize size;
 
-  src = GST_FAKE_SRC (basesrc);
-
   buf = gst_fake_src_create_buffer (src, &size);
+  if (buf == NULL)
+    return NULL;
   GST_BUFFER_OFFSET (buf) = offset;
 
   if (src->datarate > 0) {
@@ -871,7 +1052,46 @@ gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
 
   src->bytes_sent += size;
 
-  *ret = buf;
+  return buf;
+}
+
+static GstFlowReturn
+gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
+    GstBuffer ** ret)
+{
+  GstFakeSrc *src;
+  GstBufferList *list;
+  GstBuffer *buf;
+  guint i, n;
+
+  src = GST_FAKE_SRC (basesrc);
+
+  /* basesrc can only push buffer lists from its own streaming thread */
+  n = src->buffer_list_size;
+  if (n <= 1 || GST_PAD_MODE (basesrc->srcpad) != GST_PAD_MODE_PUSH) {
+    buf = gst_fake_src_create_one (src, offset);
+    if (buf == NULL)
+      return GST_FLOW_ERROR;
+
+    *ret = buf;
+    return GST_FLOW_OK;
+  }
+
+  list = gst_buffer_list_new_sized (n);
+  for (i = 0; i < n; i++) {
+    buf = gst_fake_src_create_one (src, offset);
+    if (buf == NULL) {
+      gst_buffer_list_unref (list);
+      return GST_FLOW_ERROR;
+    }
+    if (offset != -1)
+      offset += gst_buffer_get_size (buf);
+
+    gst_buffer_list_add (list, buf);
+  }
+  gst_base_src_submit_buffer_list (basesrc, list);
+
+  *ret = NULL;
   return GST_FLOW_OK;
 }
 
@@ -906,6 +1126,8 @@ gst_fake_src_stop (GstBaseSrc * basesrc)
   src->last_message = NULL;
   GST_OBJECT_UNLOCK (src);
 
+  gst_fake_src_free_pool (src);
+
   return TRUE;
 }
 
@@ -250,8 +250,12 @@ gst_fd_sink_render_buffers (GstFdSink * sink, GstBuffer ** buffers,
   for (;;) {
     guint64 bytes_written = 0;
 
-    ret = gst_writev_buffers (GST_OBJECT_CAST (sink), sink->fd, sink->fdset,
-        buffers, num_buffers, mem_nums, total_mems, &bytes_written, skip);
+    /* data that comes straight from a file is passed on by the kernel */
+    ret = gst_sendfile_buffers (GST_OBJECT_CAST (sink), sink->fd, sink->fdset,
+        buffers, num_buffers, &bytes_written, skip);
+    if (ret == GST_FLOW_NOT_SUPPORTED)
+      ret = gst_writev_buffers (GST_OBJECT_CAST (sink), sink->fd, sink->fdset,
+          buffers, num_buffers, mem_nums, total_mems, &bytes_written, skip);
 
     sink->bytes_written += bytes_written;
     sink->current_pos += bytes_written;
@@ -66,6 +66,10 @@ struct _GstFdSrc {
   /* poll timeout */
   guint64 timeout;
 
+  /* bytes to read per wakeup, pipe buffer size */
+  guint max_batch_size;
+  guint pipe_size;
+
   gchar *uri;
 
   GstPoll *fdset;
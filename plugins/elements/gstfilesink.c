@@ -80,6 +80,10 @@
 #include "gstelements_private.h"
 #include "gstfilesink.h"
 
+#if defined (HAVE_POSIX_FALLOCATE) && !defined (G_OS_WIN32)
+#define HAVE_FILESINK_FALLOCATE 1
+#endif
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -112,6 +116,14 @@ GST_DEBUG_CATEGORY_STATIC (gst_file_sink_debug);
 #define DEFAULT_BUFFER_MODE 	GST_FILE_SINK_BUFFER_MODE_DEFAULT
 #define DEFAULT_BUFFER_SIZE 	64 * 1024
 #define DEFAULT_APPEND		FALSE
+#define DEFAULT_WRITE_BEHIND	0
+#define DEFAULT_SYNC_INTERVAL	0
+
+#define DEFAULT_PREALLOCATE	0
+
+/* maximum number of buffers written with one writev() by the write-behind
+ * thread */
+#define WRITE_BEHIND_BATCH	64
 
 enum
 {
@@ -120,6 +132,9 @@ enum
   PROP_BUFFER_MODE,
   PROP_BUFFER_SIZE,
   PROP_APPEND,
+  PROP_WRITE_BEHIND,
+  PROP_SYNC_INTERVAL,
+  PROP_PREALLOCATE,
   PROP_LAST
 };
 
@@ -162,6 +177,7 @@ gst_fopen (const gchar * filename, const gchar * mode)
 }
 
 static void gst_file_sink_dispose (GObject * object);
+static void gst_file_sink_finalize (GObject * object);
 
 static void gst_file_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -173,6 +189,8 @@ static void gst_file_sink_close_file (GstFileSink * sink);
 
 static gboolean gst_file_sink_start (GstBaseSink * sink);
 static gboolean gst_file_sink_stop (GstBaseSink * sink);
+static gboolean gst_file_sink_unlock (GstBaseSink * sink);
+static gboolean gst_file_sink_unlock_stop (GstBaseSink * sink);
 static gboolean gst_file_sink_event (GstBaseSink * sink, GstEvent * event);
 static GstFlowReturn gst_file_sink_render (GstBaseSink * sink,
     GstBuffer * buffer);
@@ -186,6 +204,12 @@ static gboolean gst_file_sink_get_current_offset (GstFileSink * filesink,
 
 static gboolean gst_file_sink_query (GstBaseSink * bsink, GstQuery * query);
 
+static void gst_file_sink_start_write_behind (GstFileSink * sink);
+static void gst_file_sink_stop_write_behind (GstFileSink * sink);
+static GstFlowReturn gst_file_sink_drain (GstFileSink * sink);
+static gboolean gst_file_sink_truncate_preallocated (GstFileSink * sink);
+static void gst_file_sink_discard (GstFileSink * sink);
+
 static void gst_file_sink_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
 
@@ -204,6 +228,7 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
   GstBaseSinkClass *gstbasesink_class = GST_BASE_SINK_CLASS (klass);
 
   gobject_class->dispose = gst_file_sink_dispose;
+  gobject_class->finalize = gst_file_sink_finalize;
 
   gobject_class->set_property = gst_file_sink_set_property;
   gobject_class->get_property = gst_file_sink_get_property;
@@ -234,6 +259,57 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
           "Append to an already existing file", DEFAULT_APPEND,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstFileSink:write-behind:
+   *
+   * Number of bytes that can be queued for a separate thread to write. When
+   * set, the streaming thread only waits for the disk once this many bytes
+   * are waiting to be written and then posts a "GstFileSinkBackpressure"
+   * element message with the "queued-bytes" and the "write-latency" of the
+   * last write. 0 writes from the streaming thread.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_WRITE_BEHIND,
+      g_param_spec_uint ("write-behind", "Write behind",
+          "Bytes to queue for writing from a separate thread (0 = disabled)",
+          0, G_MAXUINT, DEFAULT_WRITE_BEHIND,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:sync-interval:
+   *
+   * With #GstFileSink:write-behind, the minimum time between syncing the
+   * written data to disk. All data written in between is synced at once.
+   * 0 only syncs for buffers with the %GST_BUFFER_FLAG_SYNC_AFTER flag.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL,
+      g_param_spec_uint64 ("sync-interval", "Sync interval",
+          "Minimum time between syncs to disk in write-behind mode "
+          "(0 = disabled)", 0, G_MAXUINT64, DEFAULT_SYNC_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:preallocate:
+   *
+   * Allocate disk space for the file in extents of this many bytes ahead of
+   * the write position, which avoids fragmentation of large recordings. The
+   * file is truncated to the size of the written data at EOS and when it is
+   * closed. 0 disables preallocation. Not used in append mode.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_PREALLOCATE,
+      g_param_spec_uint64 ("preallocate", "Preallocate",
+          "Bytes of disk space to allocate ahead of the write position "
+          "(0 = disabled)", 0, G_MAXUINT64, DEFAULT_PREALLOCATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "File Sink",
       "Sink/File", "Write stream to a file",
@@ -242,6 +318,9 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
 
   gstbasesink_class->start = GST_DEBUG_FUNCPTR (gst_file_sink_start);
   gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_file_sink_stop);
+  gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_file_sink_unlock);
+  gstbasesink_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_file_sink_unlock_stop);
   gstbasesink_class->query = GST_DEBUG_FUNCPTR (gst_file_sink_query);
   gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_file_sink_render);
   gstbasesink_class->render_list =
@@ -264,10 +343,28 @@ gst_file_sink_init (GstFileSink * filesink)
   filesink->buffer_size = DEFAULT_BUFFER_SIZE;
   filesink->buffer = NULL;
   filesink->append = FALSE;
+  filesink->write_behind = DEFAULT_WRITE_BEHIND;
+  filesink->sync_interval = DEFAULT_SYNC_INTERVAL;
+  filesink->preallocate = DEFAULT_PREALLOCATE;
+
+  g_mutex_init (&filesink->wb_lock);
+  g_cond_init (&filesink->wb_cond);
+  g_queue_init (&filesink->wb_queue);
 
   gst_base_sink_set_sync (GST_BASE_SINK (filesink), FALSE);
 }
 
+static void
+gst_file_sink_finalize (GObject * object)
+{
+  GstFileSink *sink = GST_FILE_SINK (object);
+
+  g_mutex_clear (&sink->wb_lock);
+  g_cond_clear (&sink->wb_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_file_sink_dispose (GObject * object)
 {
@@ -338,6 +435,15 @@ gst_file_sink_set_property (GObject * object, guint prop_id,
     case PROP_APPEND:
       sink->append = g_value_get_boolean (value);
       break;
+    case PROP_WRITE_BEHIND:
+      sink->write_behind = g_value_get_uint (value);
+      break;
+    case PROP_SYNC_INTERVAL:
+      sink->sync_interval = g_value_get_uint64 (value);
+      break;
+    case PROP_PREALLOCATE:
+      sink->preallocate = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -363,6 +469,15 @@ gst_file_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_APPEND:
       g_value_set_boolean (value, sink->append);
       break;
+    case PROP_WRITE_BEHIND:
+      g_value_set_uint (value, sink->write_behind);
+      break;
+    case PROP_SYNC_INTERVAL:
+      g_value_set_uint64 (value, sink->sync_interval);
+      break;
+    case PROP_PREALLOCATE:
+      g_value_set_uint64 (value, sink->preallocate);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -419,6 +534,12 @@ gst_file_sink_open_file (GstFileSink * sink)
   /* try to seek in the file to figure out if it is seekable */
   sink->seekable = gst_file_sink_do_seek (sink, 0);
 
+  sink->prealloc_end = 0;
+  sink->written_end = sink->current_pos;
+
+  if (sink->write_behind > 0)
+    gst_file_sink_start_write_behind (sink);
+
   GST_DEBUG_OBJECT (sink, "opened file %s, seekable %d",
       sink->filename, sink->seekable);
 
@@ -444,6 +565,9 @@ static void
 gst_file_sink_close_file (GstFileSink * sink)
 {
   if (sink->file) {
+    gst_file_sink_stop_write_behind (sink);
+    gst_file_sink_truncate_preallocated (sink);
+
     if (fclose (sink->file) != 0)
       GST_ELEMENT_ERROR (sink, RESOURCE, CLOSE,
           (_("Error closing file \"%s\"."), sink->filename), GST_ERROR_SYSTEM);
@@ -472,7 +596,10 @@ gst_file_sink_query (GstBaseSink * bsink, GstQuery * query)
       switch (format) {
         case GST_FORMAT_DEFAULT:
         case GST_FORMAT_BYTES:
-          gst_query_set_position (query, GST_FORMAT_BYTES, self->current_pos);
+          g_mutex_lock (&self->wb_lock);
+          gst_query_set_position (query, GST_FORMAT_BYTES,
+              self->current_pos + self->wb_queued);
+          g_mutex_unlock (&self->wb_lock);
           res = TRUE;
           break;
         default:
@@ -567,6 +694,13 @@ gst_file_sink_event (GstBaseSink * sink, GstEvent * event)
 
   type = GST_EVENT_TYPE (event);
 
+  /* the queued data has to be written before the file position changes */
+  if (type == GST_EVENT_FLUSH_STOP)
+    gst_file_sink_discard (filesink);
+  else if (GST_EVENT_IS_SERIALIZED (event)
+      && gst_file_sink_drain (filesink) == GST_FLOW_ERROR)
+    goto drain_failed;
+
   switch (type) {
     case GST_EVENT_SEGMENT:
     {
@@ -599,11 +733,15 @@ gst_file_sink_event (GstBaseSink * sink, GstEvent * event)
         gst_file_sink_do_seek (filesink, 0);
         if (ftruncate (fileno (filesink->file), 0))
           goto flush_failed;
+        filesink->prealloc_end = 0;
+        filesink->written_end = 0;
       }
       break;
     case GST_EVENT_EOS:
       if (fflush (filesink->file))
         goto flush_failed;
+      if (!gst_file_sink_truncate_preallocated (filesink))
+        goto flush_failed;
       break;
     default:
       break;
@@ -612,6 +750,12 @@ gst_file_sink_event (GstBaseSink * sink, GstEvent * event)
   return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
 
   /* ERRORS */
+drain_failed:
+  {
+    /* the write-behind thread posted the error */
+    gst_event_unref (event);
+    return FALSE;
+  }
 seek_failed:
   {
     GST_ELEMENT_ERROR (filesink, RESOURCE, SEEK,
@@ -653,16 +797,280 @@ gst_file_sink_get_current_offset (GstFileSink * filesink, guint64 * p_pos)
   return (ret != (off_t) - 1);
 }
 
+/* called after writing up to @pos, allocates the next extent once half of
+ * the preallocated space is used */
+static void
+gst_file_sink_preallocate (GstFileSink * sink, guint64 pos)
+{
+  sink->written_end = MAX (sink->written_end, pos);
+
+#ifdef HAVE_FILESINK_FALLOCATE
+  if (sink->preallocate == 0 || sink->append || !sink->seekable)
+    return;
+  if (pos + sink->preallocate / 2 <= sink->prealloc_end)
+    return;
+
+  GST_LOG_OBJECT (sink, "allocating %" G_GUINT64_FORMAT " bytes at offset %"
+      G_GUINT64_FORMAT, sink->preallocate, pos);
+
+  /* not all file systems support this, only warn as the data is still
+   * written fine */
+  if (posix_fallocate (fileno (sink->file), pos, sink->preallocate) != 0) {
+    GST_WARNING_OBJECT (sink, "preallocation failed, disabling");
+    sink->preallocate = 0;
+    return;
+  }
+  sink->prealloc_end = pos + sink->preallocate;
+#endif
+}
+
+/* removes the preallocated space after the written data again */
+static gboolean
+gst_file_sink_truncate_preallocated (GstFileSink * sink)
+{
+  if (sink->prealloc_end <= sink->written_end)
+    return TRUE;
+
+  GST_DEBUG_OBJECT (sink, "truncating to %" G_GUINT64_FORMAT " bytes",
+      sink->written_end);
+
+  if (fflush (sink->file)
+      || ftruncate (fileno (sink->file), sink->written_end) != 0)
+    return FALSE;
+
+  sink->prealloc_end = 0;
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_file_sink_render_buffers (GstFileSink * sink, GstBuffer ** buffers,
     guint num_buffers, guint8 * mem_nums, guint total_mems)
 {
+  GstFlowReturn flow;
+
   GST_DEBUG_OBJECT (sink,
       "writing %u buffers (%u memories) at position %" G_GUINT64_FORMAT,
       num_buffers, total_mems, sink->current_pos);
 
-  return gst_writev_buffers (GST_OBJECT_CAST (sink), fileno (sink->file), NULL,
+  flow = gst_writev_buffers (GST_OBJECT_CAST (sink), fileno (sink->file), NULL,
       buffers, num_buffers, mem_nums, total_mems, &sink->current_pos, 0);
+
+  if (flow == GST_FLOW_OK)
+    gst_file_sink_preallocate (sink, sink->current_pos);
+
+  return flow;
+}
+
+static GstFlowReturn
+gst_file_sink_sync (GstFileSink * sink)
+{
+  if (fflush (sink->file) || fsync (fileno (sink->file))) {
+    GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+        (_("Error while writing to file \"%s\"."), sink->filename),
+        ("%s", g_strerror (errno)));
+    return GST_FLOW_ERROR;
+  }
+  return GST_FLOW_OK;
+}
+
+static gpointer
+gst_file_sink_write_behind_thread (GstFileSink * sink)
+{
+  GstBuffer *buffers[WRITE_BEHIND_BATCH];
+  guint8 mem_nums[WRITE_BEHIND_BATCH];
+
+  g_mutex_lock (&sink->wb_lock);
+  while (TRUE) {
+    GstFlowReturn flow;
+    guint i, num_buffers = 0, total_mems = 0;
+    guint64 bytes = 0, pos;
+    gboolean sync_after = FALSE;
+    gint64 start, now;
+
+    while (g_queue_is_empty (&sink->wb_queue) && !sink->wb_stop)
+      g_cond_wait (&sink->wb_cond, &sink->wb_lock);
+    if (g_queue_is_empty (&sink->wb_queue))
+      break;
+
+    while (num_buffers < WRITE_BEHIND_BATCH
+        && !g_queue_is_empty (&sink->wb_queue)) {
+      GstBuffer *buf = g_queue_pop_head (&sink->wb_queue);
+
+      buffers[num_buffers] = buf;
+      mem_nums[num_buffers] = gst_buffer_n_memory (buf);
+      total_mems += mem_nums[num_buffers];
+      bytes += gst_buffer_get_size (buf);
+      if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_SYNC_AFTER))
+        sync_after = TRUE;
+      num_buffers++;
+    }
+    sink->wb_busy = TRUE;
+    pos = sink->current_pos;
+    g_mutex_unlock (&sink->wb_lock);
+
+    /* the position is only updated together with the queued bytes so that
+     * position queries stay consistent */
+    start = g_get_monotonic_time ();
+    flow = gst_writev_buffers (GST_OBJECT_CAST (sink), fileno (sink->file),
+        NULL, buffers, num_buffers, mem_nums, total_mems, &pos, 0);
+    if (flow == GST_FLOW_OK)
+      gst_file_sink_preallocate (sink, pos);
+    now = g_get_monotonic_time ();
+
+    /* batch the syncs of everything written since the last one */
+    if (flow == GST_FLOW_OK && (sync_after || (sink->sync_interval > 0
+                && (now - sink->wb_last_sync) * GST_USECOND >=
+                sink->sync_interval))) {
+      flow = gst_file_sink_sync (sink);
+      sink->wb_last_sync = now = g_get_monotonic_time ();
+    }
+
+    GST_LOG_OBJECT (sink, "wrote %" G_GUINT64_FORMAT " bytes in %"
+        GST_TIME_FORMAT, bytes, GST_TIME_ARGS ((now - start) * GST_USECOND));
+
+    for (i = 0; i < num_buffers; i++)
+      gst_buffer_unref (buffers[i]);
+
+    g_mutex_lock (&sink->wb_lock);
+    sink->wb_busy = FALSE;
+    sink->current_pos = pos;
+    sink->wb_queued -= bytes;
+    sink->wb_latency = (now - start) * GST_USECOND;
+    if (flow != GST_FLOW_OK && sink->wb_ret == GST_FLOW_OK)
+      sink->wb_ret = flow;
+    g_cond_broadcast (&sink->wb_cond);
+  }
+  g_mutex_unlock (&sink->wb_lock);
+
+  return NULL;
+}
+
+static void
+gst_file_sink_start_write_behind (GstFileSink * sink)
+{
+  GError *err = NULL;
+
+  sink->wb_queued = 0;
+  sink->wb_busy = FALSE;
+  sink->wb_flushing = FALSE;
+  sink->wb_stop = FALSE;
+  sink->wb_ret = GST_FLOW_OK;
+  sink->wb_latency = 0;
+  sink->wb_last_sync = g_get_monotonic_time ();
+
+  sink->wb_thread = g_thread_try_new ("filesink-write",
+      (GThreadFunc) gst_file_sink_write_behind_thread, sink, &err);
+  if (sink->wb_thread == NULL) {
+    GST_WARNING_OBJECT (sink, "could not start write-behind thread, writing "
+        "synchronously: %s", err->message);
+    g_error_free (err);
+  }
+}
+
+/* writes out everything that was queued and stops the thread */
+static void
+gst_file_sink_stop_write_behind (GstFileSink * sink)
+{
+  if (sink->wb_thread == NULL)
+    return;
+
+  g_mutex_lock (&sink->wb_lock);
+  sink->wb_stop = TRUE;
+  g_cond_broadcast (&sink->wb_cond);
+  g_mutex_unlock (&sink->wb_lock);
+
+  g_thread_join (sink->wb_thread);
+  sink->wb_thread = NULL;
+}
+
+/* waits for all queued data to be written */
+static GstFlowReturn
+gst_file_sink_drain (GstFileSink * sink)
+{
+  GstFlowReturn ret;
+
+  if (sink->wb_thread == NULL)
+    return GST_FLOW_OK;
+
+  g_mutex_lock (&sink->wb_lock);
+  while (sink->wb_queued > 0 && sink->wb_ret == GST_FLOW_OK
+      && !sink->wb_flushing)
+    g_cond_wait (&sink->wb_cond, &sink->wb_lock);
+  if (sink->wb_ret != GST_FLOW_OK)
+    ret = sink->wb_ret;
+  else if (sink->wb_flushing)
+    ret = GST_FLOW_FLUSHING;
+  else
+    ret = GST_FLOW_OK;
+  g_mutex_unlock (&sink->wb_lock);
+
+  return ret;
+}
+
+/* drops the queued data and waits for the current write to finish */
+static void
+gst_file_sink_discard (GstFileSink * sink)
+{
+  GstBuffer *buf;
+
+  if (sink->wb_thread == NULL)
+    return;
+
+  g_mutex_lock (&sink->wb_lock);
+  while ((buf = g_queue_pop_head (&sink->wb_queue))) {
+    sink->wb_queued -= gst_buffer_get_size (buf);
+    gst_buffer_unref (buf);
+  }
+  while (sink->wb_busy)
+    g_cond_wait (&sink->wb_cond, &sink->wb_lock);
+  sink->wb_ret = GST_FLOW_OK;
+  g_mutex_unlock (&sink->wb_lock);
+}
+
+/* hands @buffer to the write-behind thread, waiting while the queue is full */
+static GstFlowReturn
+gst_file_sink_queue_buffer (GstFileSink * sink, GstBuffer * buffer)
+{
+  GstFlowReturn ret;
+  gsize size;
+  gboolean posted = FALSE;
+
+  size = gst_buffer_get_size (buffer);
+
+  g_mutex_lock (&sink->wb_lock);
+  while (sink->wb_queued > 0 && sink->wb_queued + size > sink->write_behind
+      && sink->wb_ret == GST_FLOW_OK && !sink->wb_flushing) {
+    if (!posted) {
+      GstStructure *s;
+
+      s = gst_structure_new ("GstFileSinkBackpressure",
+          "queued-bytes", G_TYPE_UINT64, sink->wb_queued,
+          "write-latency", G_TYPE_UINT64, sink->wb_latency, NULL);
+      posted = TRUE;
+
+      g_mutex_unlock (&sink->wb_lock);
+      GST_DEBUG_OBJECT (sink, "write-behind queue full, waiting");
+      gst_element_post_message (GST_ELEMENT_CAST (sink),
+          gst_message_new_element (GST_OBJECT_CAST (sink), s));
+      g_mutex_lock (&sink->wb_lock);
+      continue;
+    }
+    g_cond_wait (&sink->wb_cond, &sink->wb_lock);
+  }
+
+  if (sink->wb_ret != GST_FLOW_OK) {
+    ret = sink->wb_ret;
+  } else if (sink->wb_flushing) {
+    ret = GST_FLOW_FLUSHING;
+  } else {
+    g_queue_push_tail (&sink->wb_queue, gst_buffer_ref (buffer));
+    sink->wb_queued += size;
+    g_cond_broadcast (&sink->wb_cond);
+    ret = GST_FLOW_OK;
+  }
+  g_mutex_unlock (&sink->wb_lock);
+
+  return ret;
 }
 
 static GstFlowReturn
@@ -682,6 +1090,14 @@ gst_file_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
   if (num_buffers == 0)
     goto no_data;
 
+  if (sink->wb_thread) {
+    for (i = 0, flow = GST_FLOW_OK; i < num_buffers && flow == GST_FLOW_OK;
+        i++)
+      flow = gst_file_sink_queue_buffer (sink,
+          gst_buffer_list_get (buffer_list, i));
+    return flow;
+  }
+
   /* extract buffers from list and count memories */
   buffers = g_newa (GstBuffer *, num_buffers);
   mem_nums = g_newa (guint8, num_buffers);
@@ -697,14 +1113,8 @@ gst_file_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
       gst_file_sink_render_buffers (sink, buffers, num_buffers, mem_nums,
       total_mems);
 
-  if (flow == GST_FLOW_OK && sync_after) {
-    if (fflush (sink->file) || fsync (fileno (sink->file))) {
-      GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
-          (_("Error while writing to file \"%s\"."), sink->filename),
-          ("%s", g_strerror (errno)));
-      flow = GST_FLOW_ERROR;
-    }
-  }
+  if (flow == GST_FLOW_OK && sync_after)
+    flow = gst_file_sink_sync (sink);
 
   return flow;
 
@@ -724,6 +1134,9 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 
   filesink = GST_FILE_SINK_CAST (sink);
 
+  if (filesink->wb_thread)
+    return gst_file_sink_queue_buffer (filesink, buffer);
+
   n_mem = gst_buffer_n_memory (buffer);
 
   if (n_mem > 0)
@@ -732,14 +1145,8 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
     flow = GST_FLOW_OK;
 
   if (flow == GST_FLOW_OK &&
-      GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_SYNC_AFTER)) {
-    if (fflush (filesink->file) || fsync (fileno (filesink->file))) {
-      GST_ELEMENT_ERROR (filesink, RESOURCE, WRITE,
-          (_("Error while writing to file \"%s\"."), filesink->filename),
-          ("%s", g_strerror (errno)));
-      flow = GST_FLOW_ERROR;
-    }
-  }
+      GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_SYNC_AFTER))
+    flow = gst_file_sink_sync (filesink);
 
   return flow;
 }
@@ -757,6 +1164,31 @@ gst_file_sink_stop (GstBaseSink * basesink)
   return TRUE;
 }
 
+static gboolean
+gst_file_sink_unlock (GstBaseSink * basesink)
+{
+  GstFileSink *sink = GST_FILE_SINK_CAST (basesink);
+
+  g_mutex_lock (&sink->wb_lock);
+  sink->wb_flushing = TRUE;
+  g_cond_broadcast (&sink->wb_cond);
+  g_mutex_unlock (&sink->wb_lock);
+
+  return TRUE;
+}
+
+static gboolean
+gst_file_sink_unlock_stop (GstBaseSink * basesink)
+{
+  GstFileSink *sink = GST_FILE_SINK_CAST (basesink);
+
+  g_mutex_lock (&sink->wb_lock);
+  sink->wb_flushing = FALSE;
+  g_mutex_unlock (&sink->wb_lock);
+
+  return TRUE;
+}
+
 /*** GSTURIHANDLER INTERFACE *************************************************/
 
 static GstURIType
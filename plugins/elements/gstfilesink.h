@@ -83,6 +83,26 @@ struct _GstFileSink {
   gchar  *buffer;
 
   gboolean append;
+
+  guint write_behind;
+  GstClockTime sync_interval;
+
+  /* write-behind thread and the buffers it still has to write */
+  GThread *wb_thread;
+  GMutex wb_lock;
+  GCond wb_cond;
+  GQueue wb_queue;
+  guint64 wb_queued;            /* bytes queued or being written */
+  gboolean wb_busy;             /* a batch is being written */
+  gboolean wb_flushing;
+  gboolean wb_stop;
+  GstFlowReturn wb_ret;
+  GstClockTime wb_latency;      /* duration of the last write */
+  gint64 wb_last_sync;
+
+  guint64 preallocate;
+  guint64 prealloc_end;         /* end of the preallocated range */
+  guint64 written_end;          /* end of the data written so far */
 };
 
 struct _GstFileSinkClass {
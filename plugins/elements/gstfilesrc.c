@@ -31,6 +31,10 @@
  * gst-launch-1.0 filesrc location=song.ogg ! decodebin ! audioconvert ! audioresample ! autoaudiosink
  * ]| Play song.ogg audio file which must be in the current working directory.
  *
+ * When #GstFileSrc:use-mmap is enabled and the file is a regular file, the
+ * file is mapped into memory once and buffers are handed out as read-only
+ * memories that share the mapping, avoiding a copy for every block. Readers
+ * of the same file then share the page cache pages directly.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -39,6 +43,7 @@
 
 #include <gst/gst.h>
 #include "gstfilesrc.h"
+#include "gstelements_private.h"
 
 #include <stdio.h>
 #include <sys/types.h>
@@ -61,10 +66,22 @@
 #endif
 #include <fcntl.h>
 
+#if defined (HAVE_SYS_MMAN_H) && defined (HAVE_MMAP) && !defined (G_OS_WIN32)
+#include <sys/mman.h>
+#define HAVE_FILESRC_MMAP 1
+#ifdef HAVE_MADVISE
+#define HAVE_FILESRC_MADVISE 1
+#endif
+#endif
+
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
 #endif
 
+#if defined (HAVE_POSIX_FADVISE) && !defined (G_OS_WIN32)
+#define HAVE_FILESRC_FADVISE 1
+#endif
+
 #ifdef __BIONIC__               /* Android */
 #undef lseek
 #define lseek lseek64
@@ -138,11 +155,29 @@ enum
 };
 
 #define DEFAULT_BLOCKSIZE       4*1024
+#define DEFAULT_USE_MMAP        FALSE
+#define DEFAULT_READAHEAD       0
 
 enum
 {
   PROP_0,
-  PROP_LOCATION
+  PROP_LOCATION,
+  PROP_USE_MMAP,
+  PROP_READAHEAD
+};
+
+/* a mapping of the whole file, shared by all memories we hand out. It stays
+ * alive until the last memory referencing it is freed, which may be after
+ * the element was stopped. */
+struct _GstFileSrcMapping
+{
+  gint refcount;
+
+  gpointer data;
+  gsize size;
+
+  /* our own descriptor for sinks that send the memories from the file */
+  gint fd;
 };
 
 static void gst_file_src_finalize (GObject * object);
@@ -159,6 +194,8 @@ static gboolean gst_file_src_is_seekable (GstBaseSrc * src);
 static gboolean gst_file_src_get_size (GstBaseSrc * src, guint64 * size);
 static GstFlowReturn gst_file_src_fill (GstBaseSrc * src, guint64 offset,
     guint length, GstBuffer * buf);
+static GstFlowReturn gst_file_src_create (GstBaseSrc * src, guint64 offset,
+    guint length, GstBuffer ** buffer);
 
 static void gst_file_src_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
@@ -189,6 +226,37 @@ gst_file_src_class_init (GstFileSrcClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstFileSrc:use-mmap:
+   *
+   * Map regular files into memory and push buffers that directly reference
+   * the mapping instead of read()ing into newly allocated memory. Note that
+   * truncating the file while it is mapped will crash the application.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Whether to mmap() regular files and push zero-copy buffers",
+          DEFAULT_USE_MMAP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSrc:readahead:
+   *
+   * Number of bytes after the current read position that the kernel is asked
+   * to read into the page cache in the background, or 0 to leave readahead
+   * to the kernel defaults. Larger values hide the latency of slow or busy
+   * disks when reading regular files sequentially.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_READAHEAD,
+      g_param_spec_uint ("readahead", "Readahead",
+          "Bytes to read ahead in the background (0 = kernel default)", 0,
+          G_MAXUINT, DEFAULT_READAHEAD, G_PARAM_READWRITE |
+          G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
   gobject_class->finalize = gst_file_src_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -203,6 +271,7 @@ gst_file_src_class_init (GstFileSrcClass * klass)
   gstbasesrc_class->is_seekable = GST_DEBUG_FUNCPTR (gst_file_src_is_seekable);
   gstbasesrc_class->get_size = GST_DEBUG_FUNCPTR (gst_file_src_get_size);
   gstbasesrc_class->fill = GST_DEBUG_FUNCPTR (gst_file_src_fill);
+  gstbasesrc_class->create = GST_DEBUG_FUNCPTR (gst_file_src_create);
 
   if (sizeof (off_t) < 8) {
     GST_LOG ("No large file support, sizeof (off_t) = %" G_GSIZE_FORMAT "!",
@@ -219,6 +288,15 @@ gst_file_src_init (GstFileSrc * src)
 
   src->is_regular = FALSE;
 
+  src->use_mmap = DEFAULT_USE_MMAP;
+  src->mapping = NULL;
+  src->readahead = DEFAULT_READAHEAD;
+#if defined (HAVE_FILESRC_MMAP) && defined (_SC_PAGESIZE)
+  src->pagesize = sysconf (_SC_PAGESIZE);
+#else
+  src->pagesize = 4096;
+#endif
+
   gst_base_src_set_blocksize (GST_BASE_SRC (src), DEFAULT_BLOCKSIZE);
 }
 
@@ -296,6 +374,12 @@ gst_file_src_set_property (GObject * object, guint prop_id,
     case PROP_LOCATION:
       gst_file_src_set_location (src, g_value_get_string (value), NULL);
       break;
+    case PROP_USE_MMAP:
+      src->use_mmap = g_value_get_boolean (value);
+      break;
+    case PROP_READAHEAD:
+      src->readahead = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -316,12 +400,43 @@ gst_file_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LOCATION:
       g_value_set_string (value, src->filename);
       break;
+    case PROP_USE_MMAP:
+      g_value_set_boolean (value, src->use_mmap);
+      break;
+    case PROP_READAHEAD:
+      g_value_set_uint (value, src->readahead);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* asks the kernel to read the data after the current position into the page
+ * cache in the background, this is only done when half of the previous
+ * window was consumed to not make a syscall for every read */
+static void
+gst_file_src_readahead (GstFileSrc * src)
+{
+#ifdef HAVE_FILESRC_FADVISE
+  guint64 start, end;
+
+  if (src->readahead == 0 || !src->is_regular)
+    return;
+
+  end = src->read_position + src->readahead;
+  if (src->readahead_end > src->read_position + src->readahead / 2)
+    return;
+
+  start = MAX (src->readahead_end, src->read_position);
+
+  GST_LOG_OBJECT (src, "reading ahead %" G_GUINT64_FORMAT " bytes at offset %"
+      G_GUINT64_FORMAT, end - start, start);
+  posix_fadvise (src->fd, start, end - start, POSIX_FADV_WILLNEED);
+  src->readahead_end = end;
+#endif
+}
+
 /***
  * read code below
  * that is to say, you shouldn't read the code below, but the code that reads
@@ -352,6 +467,7 @@ gst_file_src_fill (GstBaseSrc * basesrc, guint64 offset, guint length,
       goto seek_failed;
 
     src->read_position = offset;
+    src->readahead_end = offset;
   }
 
   if (!gst_buffer_map (buf, &info, GST_MAP_WRITE))
@@ -389,6 +505,8 @@ gst_file_src_fill (GstBaseSrc * basesrc, guint64 offset, guint length,
   if (bytes_read != length)
     gst_buffer_resize (buf, 0, bytes_read);
 
+  gst_file_src_readahead (src);
+
   GST_BUFFER_OFFSET (buf) = offset;
   GST_BUFFER_OFFSET_END (buf) = offset + bytes_read;
 
@@ -421,6 +539,127 @@ buffer_write_fail:
   }
 }
 
+static GstFileSrcMapping *
+gst_file_src_mapping_ref (GstFileSrcMapping * mapping)
+{
+  g_atomic_int_inc (&mapping->refcount);
+
+  return mapping;
+}
+
+static void
+gst_file_src_mapping_unref (GstFileSrcMapping * mapping)
+{
+  if (!g_atomic_int_dec_and_test (&mapping->refcount))
+    return;
+
+#ifdef HAVE_FILESRC_MMAP
+  munmap (mapping->data, mapping->size);
+#endif
+  if (mapping->fd >= 0)
+    close (mapping->fd);
+  g_slice_free (GstFileSrcMapping, mapping);
+}
+
+/* map the complete file, returns NULL when mmap() is not possible and we
+ * should use read() instead */
+static GstFileSrcMapping *
+gst_file_src_map_file (GstFileSrc * src, guint64 size)
+{
+#ifdef HAVE_FILESRC_MMAP
+  GstFileSrcMapping *mapping;
+  gpointer data;
+
+  if (size == 0 || size > G_MAXSIZE)
+    return NULL;
+
+  data = mmap (NULL, size, PROT_READ, MAP_SHARED, src->fd, 0);
+  if (data == MAP_FAILED) {
+    GST_WARNING_OBJECT (src, "mmap failed, using read(): %s",
+        g_strerror (errno));
+    return NULL;
+  }
+#if defined (HAVE_FILESRC_MADVISE) && defined (MADV_SEQUENTIAL)
+  /* we mostly go forward, let the kernel read ahead aggressively */
+  madvise (data, size, MADV_SEQUENTIAL);
+#endif
+
+  GST_DEBUG_OBJECT (src, "mapped %" G_GUINT64_FORMAT " bytes at %p", size,
+      data);
+
+  mapping = g_slice_new (GstFileSrcMapping);
+  mapping->refcount = 1;
+  mapping->data = data;
+  mapping->size = size;
+  mapping->fd = dup (src->fd);
+
+  return mapping;
+#else
+  GST_WARNING_OBJECT (src, "mmap not supported on this platform");
+  return NULL;
+#endif
+}
+
+static GstFlowReturn
+gst_file_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  GstFileSrc *src;
+  GstFileSrcMapping *mapping;
+  GstMemory *mem;
+  GstBuffer *buf;
+  gsize size, start, end;
+
+  src = GST_FILE_SRC_CAST (basesrc);
+  mapping = src->mapping;
+
+  /* use the default alloc + read() when we did not map the file, when
+   * we need to fill a buffer provided downstream or when reading past the
+   * mapped region because the file grew since we started */
+  if (mapping == NULL || *buffer != NULL || offset == -1
+      || offset >= mapping->size)
+    return GST_BASE_SRC_CLASS (parent_class)->create (basesrc, offset, length,
+        buffer);
+
+  size = MIN (length, mapping->size - offset);
+
+  if (G_UNLIKELY (size == 0)) {
+    buf = gst_buffer_new ();
+  } else {
+    /* wrap the page aligned region around the requested data */
+    start = offset & ~(src->pagesize - 1);
+    end = MIN ((offset + size + src->pagesize - 1) & ~(src->pagesize - 1),
+        mapping->size);
+
+    GST_LOG_OBJECT (src, "Mapping %" G_GSIZE_FORMAT " bytes at offset 0x%"
+        G_GINT64_MODIFIER "x", size, offset);
+
+    mem = gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+        (guint8 *) mapping->data + start, end - start, offset - start, size,
+        gst_file_src_mapping_ref (mapping),
+        (GDestroyNotify) gst_file_src_mapping_unref);
+    if (mapping->fd >= 0)
+      gst_memory_set_file_range (mem, mapping->fd, start);
+
+#if defined (HAVE_FILESRC_MADVISE) && defined (MADV_WILLNEED)
+    /* and ask to have the next block paged in while this one is processed */
+    if (end < mapping->size)
+      madvise ((guint8 *) mapping->data + end, MIN (end - start,
+              mapping->size - end), MADV_WILLNEED);
+#endif
+
+    buf = gst_buffer_new ();
+    gst_buffer_append_memory (buf, mem);
+  }
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + size;
+
+  *buffer = buf;
+
+  return GST_FLOW_OK;
+}
+
 static gboolean
 gst_file_src_is_seekable (GstBaseSrc * basesrc)
 {
@@ -486,6 +725,7 @@ gst_file_src_start (GstBaseSrc * basesrc)
     goto was_socket;
 
   src->read_position = 0;
+  src->readahead_end = 0;
 
   /* record if it's a regular (hence seekable and lengthable) file */
   if (S_ISREG (stat_results.st_mode))
@@ -518,6 +758,9 @@ gst_file_src_start (GstBaseSrc * basesrc)
 
   gst_base_src_set_dynamic_size (basesrc, src->seekable);
 
+  if (src->use_mmap && src->is_regular)
+    src->mapping = gst_file_src_map_file (src, stat_results.st_size);
+
   return TRUE;
 
   /* ERROR */
@@ -579,6 +822,12 @@ gst_file_src_stop (GstBaseSrc * basesrc)
 {
   GstFileSrc *src = GST_FILE_SRC (basesrc);
 
+  /* drop our ref, memories still in flight keep the mapping alive */
+  if (src->mapping) {
+    gst_file_src_mapping_unref (src->mapping);
+    src->mapping = NULL;
+  }
+
   /* close the file */
   close (src->fd);
 
@@ -45,6 +45,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstFileSrc GstFileSrc;
 typedef struct _GstFileSrcClass GstFileSrcClass;
+typedef struct _GstFileSrcMapping GstFileSrcMapping;
 
 /**
  * GstFileSrc:
@@ -63,6 +64,13 @@ struct _GstFileSrc {
   gboolean seekable;                    /* whether the file is seekable */
   gboolean is_regular;                  /* whether it's a (symlink to a)
                                            regular file */
+
+  gboolean use_mmap;                    /* whether to try mmap()ing the file */
+  GstFileSrcMapping *mapping;           /* shared mapping of the file, or NULL */
+  gsize pagesize;                       /* system page size */
+
+  guint readahead;                      /* bytes to read ahead in the background */
+  guint64 readahead_end;                /* end of the last readahead window */
 };
 
 struct _GstFileSrcClass {
@@ -35,6 +35,14 @@
  * the different input streams but simply forwards all buffers
  * immediately when they arrive.
  *
+ * With many inputs the sink pads all contend for the lock of the source
+ * pad. Setting #GstFunnel:output-thread makes the sink pads only append
+ * their data to a lock-free queue that a single thread pushes downstream,
+ * combining consecutive buffers of the same input into buffer lists. Each
+ * sink pad can then have at most #GstFunnel:max-queued buffers and events
+ * waiting so a fast input can not delay the others. In this mode the sticky
+ * events of an input are only sent again when they differ from the ones
+ * that were last sent downstream.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -68,6 +76,11 @@ struct _GstFunnelPad
   GstPad parent;
 
   gboolean got_eos;
+
+  /* output thread mode */
+  gint queued;
+  /* sticky events as of the last item the output thread handled */
+  GList *sticky;
 };
 
 struct _GstFunnelPadClass
@@ -78,16 +91,42 @@ struct _GstFunnelPadClass
 G_DEFINE_TYPE (GstFunnelPad, gst_funnel_pad, GST_TYPE_PAD);
 
 #define DEFAULT_FORWARD_STICKY_EVENTS	TRUE
+#define DEFAULT_OUTPUT_THREAD	FALSE
+#define DEFAULT_MAX_QUEUED	32
+#define DEFAULT_MAX_BATCH	16
 
 enum
 {
   PROP_0,
-  PROP_FORWARD_STICKY_EVENTS
+  PROP_FORWARD_STICKY_EVENTS,
+  PROP_OUTPUT_THREAD,
+  PROP_MAX_QUEUED,
+  PROP_MAX_BATCH
 };
 
+/* a buffer, buffer list or serialized event queued by a sink pad */
+typedef struct
+{
+  GstFunnelPad *pad;
+  GstMiniObject *obj;
+} GstFunnelItem;
+
+static void
+gst_funnel_pad_finalize (GObject * object)
+{
+  GstFunnelPad *fpad = GST_FUNNEL_PAD_CAST (object);
+
+  g_list_free_full (fpad->sticky, (GDestroyNotify) gst_event_unref);
+
+  G_OBJECT_CLASS (gst_funnel_pad_parent_class)->finalize (object);
+}
+
 static void
 gst_funnel_pad_class_init (GstFunnelPadClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_funnel_pad_finalize;
 }
 
 static void
@@ -123,6 +162,8 @@ static GstFlowReturn gst_funnel_sink_chain_list (GstPad * pad,
     GstObject * parent, GstBufferList * list);
 static gboolean gst_funnel_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
+static gboolean gst_funnel_src_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active);
 
 static void
 gst_funnel_set_property (GObject * object, guint prop_id,
@@ -134,6 +175,15 @@ gst_funnel_set_property (GObject * object, guint prop_id,
     case PROP_FORWARD_STICKY_EVENTS:
       funnel->forward_sticky_events = g_value_get_boolean (value);
       break;
+    case PROP_OUTPUT_THREAD:
+      funnel->output_thread = g_value_get_boolean (value);
+      break;
+    case PROP_MAX_QUEUED:
+      funnel->max_queued = g_value_get_uint (value);
+      break;
+    case PROP_MAX_BATCH:
+      funnel->max_batch = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -150,6 +200,15 @@ gst_funnel_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_FORWARD_STICKY_EVENTS:
       g_value_set_boolean (value, funnel->forward_sticky_events);
       break;
+    case PROP_OUTPUT_THREAD:
+      g_value_set_boolean (value, funnel->output_thread);
+      break;
+    case PROP_MAX_QUEUED:
+      g_value_set_uint (value, funnel->max_queued);
+      break;
+    case PROP_MAX_BATCH:
+      g_value_set_uint (value, funnel->max_batch);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -177,6 +236,22 @@ restart:
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void gst_funnel_flush_queue (GstFunnel * funnel);
+
+static void
+gst_funnel_finalize (GObject * object)
+{
+  GstFunnel *funnel = GST_FUNNEL (object);
+
+  gst_funnel_flush_queue (funnel);
+  gst_atomic_queue_unref (funnel->queue);
+  g_mutex_clear (&funnel->queue_lock);
+  g_cond_clear (&funnel->item_cond);
+  g_cond_clear (&funnel->space_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_funnel_class_init (GstFunnelClass * klass)
 {
@@ -186,6 +261,7 @@ gst_funnel_class_init (GstFunnelClass * klass)
   gobject_class->set_property = gst_funnel_set_property;
   gobject_class->get_property = gst_funnel_get_property;
   gobject_class->dispose = GST_DEBUG_FUNCPTR (gst_funnel_dispose);
+  gobject_class->finalize = gst_funnel_finalize;
 
   g_object_class_install_property (gobject_class, PROP_FORWARD_STICKY_EVENTS,
       g_param_spec_boolean ("forward-sticky-events", "Forward sticky events",
@@ -194,6 +270,52 @@ gst_funnel_class_init (GstFunnelClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstFunnel:output-thread:
+   *
+   * Queue the data of all sink pads and push it downstream from a single
+   * thread instead of from the streaming threads of the inputs.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_OUTPUT_THREAD,
+      g_param_spec_boolean ("output-thread", "Output thread",
+          "Push the data of all inputs downstream from a single thread",
+          DEFAULT_OUTPUT_THREAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFunnel:max-queued:
+   *
+   * The number of buffers, buffer lists and events each sink pad can have
+   * queued in #GstFunnel:output-thread mode before it blocks.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUED,
+      g_param_spec_uint ("max-queued", "Max queued",
+          "Maximum number of queued items per sink pad in output thread mode",
+          1, G_MAXINT, DEFAULT_MAX_QUEUED,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFunnel:max-batch:
+   *
+   * The maximum number of consecutive buffers of the same sink pad that are
+   * pushed as one buffer list in #GstFunnel:output-thread mode. 1 pushes
+   * every buffer on its own.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BATCH,
+      g_param_spec_uint ("max-batch", "Max batch",
+          "Maximum number of buffers pushed as one list in output thread mode",
+          1, G_MAXINT, DEFAULT_MAX_BATCH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Funnel pipe fitting", "Generic", "N-to-1 pipe fitting",
       "Olivier Crete <olivier.crete@collabora.co.uk>");
@@ -212,10 +334,22 @@ gst_funnel_init (GstFunnel * funnel)
 {
   funnel->srcpad = gst_pad_new_from_static_template (&src_template, "src");
   gst_pad_use_fixed_caps (funnel->srcpad);
+  gst_pad_set_activatemode_function (funnel->srcpad,
+      GST_DEBUG_FUNCPTR (gst_funnel_src_activate_mode));
 
   gst_element_add_pad (GST_ELEMENT (funnel), funnel->srcpad);
 
   funnel->forward_sticky_events = DEFAULT_FORWARD_STICKY_EVENTS;
+  funnel->output_thread = DEFAULT_OUTPUT_THREAD;
+  funnel->max_queued = DEFAULT_MAX_QUEUED;
+  funnel->max_batch = DEFAULT_MAX_BATCH;
+
+  funnel->queue = gst_atomic_queue_new (DEFAULT_MAX_QUEUED);
+  g_mutex_init (&funnel->queue_lock);
+  g_cond_init (&funnel->item_cond);
+  g_cond_init (&funnel->space_cond);
+  funnel->flushing = TRUE;
+  funnel->last_ret = GST_FLOW_OK;
 }
 
 static GstPad *
@@ -314,6 +448,338 @@ forward_events (GstPad * pad, GstEvent ** event, gpointer user_data)
   return TRUE;
 }
 
+/* output thread mode */
+
+/* whether @a and @b take the same place in the sticky events of a pad */
+static gboolean
+gst_funnel_event_same_slot (GstEvent * a, GstEvent * b)
+{
+  const GstStructure *s;
+
+  if (GST_EVENT_TYPE (a) != GST_EVENT_TYPE (b))
+    return FALSE;
+  if (!(GST_EVENT_TYPE (a) & GST_EVENT_TYPE_STICKY_MULTI))
+    return TRUE;
+
+  s = gst_event_get_structure (b);
+  return s && gst_event_has_name (a, gst_structure_get_name (s));
+}
+
+static gboolean
+gst_funnel_events_equal (GstEvent * a, GstEvent * b)
+{
+  const GstStructure *sa, *sb;
+
+  if (a == b)
+    return TRUE;
+
+  switch (GST_EVENT_TYPE (a)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *ca, *cb;
+
+      gst_event_parse_caps (a, &ca);
+      gst_event_parse_caps (b, &cb);
+      return gst_caps_is_equal (ca, cb);
+    }
+    case GST_EVENT_SEGMENT:
+    {
+      const GstSegment *sega, *segb;
+
+      gst_event_parse_segment (a, &sega);
+      gst_event_parse_segment (b, &segb);
+      return gst_segment_is_equal (sega, segb);
+    }
+    default:
+      sa = gst_event_get_structure (a);
+      sb = gst_event_get_structure (b);
+      return sa && sb && gst_structure_is_equal (sa, sb);
+  }
+}
+
+/* whether the source pad already has a sticky event equal to @event */
+static gboolean
+gst_funnel_event_is_current (GstFunnel * funnel, GstEvent * event)
+{
+  GstEvent *current;
+  gboolean res = FALSE;
+  guint idx = 0;
+
+  while ((current = gst_pad_get_sticky_event (funnel->srcpad,
+              GST_EVENT_TYPE (event), idx++))) {
+    if (gst_funnel_event_same_slot (current, event)) {
+      res = gst_funnel_events_equal (current, event);
+      gst_event_unref (current);
+      break;
+    }
+    gst_event_unref (current);
+  }
+
+  return res;
+}
+
+/* keep the sticky events of @fpad sorted by type like #GstPad does */
+static void
+gst_funnel_pad_store_event (GstFunnelPad * fpad, GstEvent * event)
+{
+  GList *l;
+
+  for (l = fpad->sticky; l; l = l->next) {
+    GstEvent *ev = l->data;
+
+    if (gst_funnel_event_same_slot (ev, event)) {
+      gst_event_replace ((GstEvent **) & l->data, event);
+      return;
+    }
+    if (GST_EVENT_TYPE (event) < GST_EVENT_TYPE (ev))
+      break;
+  }
+
+  fpad->sticky = g_list_insert_before (fpad->sticky, l, gst_event_ref (event));
+}
+
+/* make @fpad the active pad and send the sticky events that changed */
+static void
+gst_funnel_switch_pad (GstFunnel * funnel, GstFunnelPad * fpad)
+{
+  GList *l;
+
+  if (funnel->last_sinkpad != NULL && (!funnel->forward_sticky_events
+          || funnel->last_sinkpad == GST_PAD_CAST (fpad)))
+    return;
+
+  gst_object_replace ((GstObject **) & funnel->last_sinkpad,
+      GST_OBJECT (fpad));
+
+  GST_DEBUG_OBJECT (fpad, "Forwarding changed sticky events");
+  for (l = fpad->sticky; l; l = l->next) {
+    if (!gst_funnel_event_is_current (funnel, l->data))
+      gst_pad_push_event (funnel->srcpad, gst_event_ref (l->data));
+  }
+}
+
+static void
+gst_funnel_item_done (GstFunnel * funnel, GstFunnelItem * item)
+{
+  g_atomic_int_add (&item->pad->queued, -1);
+  if (g_atomic_int_get (&funnel->n_waiting)) {
+    g_mutex_lock (&funnel->queue_lock);
+    g_cond_broadcast (&funnel->space_cond);
+    g_mutex_unlock (&funnel->queue_lock);
+  }
+
+  gst_object_unref (item->pad);
+  g_slice_free (GstFunnelItem, item);
+}
+
+static void
+gst_funnel_flush_queue (GstFunnel * funnel)
+{
+  GstFunnelItem *item;
+
+  while ((item = gst_atomic_queue_pop (funnel->queue))) {
+    gst_mini_object_unref (item->obj);
+    gst_funnel_item_done (funnel, item);
+  }
+}
+
+static GstFlowReturn
+gst_funnel_enqueue (GstFunnel * funnel, GstFunnelPad * fpad,
+    GstMiniObject * obj)
+{
+  GstFunnelItem *item;
+
+  /* only wait when this pad used up its share of the queue, the other pads
+   * can go on */
+  if (g_atomic_int_add (&fpad->queued, 1) >= (gint) funnel->max_queued) {
+    g_mutex_lock (&funnel->queue_lock);
+    g_atomic_int_inc (&funnel->n_waiting);
+    while (!funnel->flushing
+        && g_atomic_int_get (&fpad->queued) > (gint) funnel->max_queued)
+      g_cond_wait (&funnel->space_cond, &funnel->queue_lock);
+    g_atomic_int_add (&funnel->n_waiting, -1);
+    g_mutex_unlock (&funnel->queue_lock);
+  }
+
+  if (G_UNLIKELY (g_atomic_int_get (&funnel->flushing)))
+    goto flushing;
+
+  item = g_slice_new (GstFunnelItem);
+  item->pad = gst_object_ref (fpad);
+  item->obj = obj;
+  gst_atomic_queue_push (funnel->queue, item);
+
+  if (g_atomic_int_get (&funnel->thread_waiting)) {
+    g_mutex_lock (&funnel->queue_lock);
+    g_cond_signal (&funnel->item_cond);
+    g_mutex_unlock (&funnel->queue_lock);
+  }
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+flushing:
+  {
+    GST_DEBUG_OBJECT (fpad, "flushing, dropping %" GST_PTR_FORMAT, obj);
+    g_atomic_int_add (&fpad->queued, -1);
+    gst_mini_object_unref (obj);
+    return GST_FLOW_FLUSHING;
+  }
+}
+
+static GstFunnelItem *
+gst_funnel_pop_item (GstFunnel * funnel)
+{
+  GstFunnelItem *item;
+  gboolean flushing;
+
+  while (!(item = gst_atomic_queue_pop (funnel->queue))) {
+    g_mutex_lock (&funnel->queue_lock);
+    g_atomic_int_set (&funnel->thread_waiting, 1);
+    while (!funnel->flushing && gst_atomic_queue_length (funnel->queue) == 0)
+      g_cond_wait (&funnel->item_cond, &funnel->queue_lock);
+    g_atomic_int_set (&funnel->thread_waiting, 0);
+    flushing = funnel->flushing;
+    g_mutex_unlock (&funnel->queue_lock);
+
+    if (flushing)
+      return NULL;
+  }
+
+  return item;
+}
+
+/* combine the buffers that the pad of @item queued in a row into a list */
+static GstMiniObject *
+gst_funnel_collect_batch (GstFunnel * funnel, GstFunnelItem * item)
+{
+  GstBufferList *list = NULL;
+  GstFunnelItem *next;
+
+  while ((!list || gst_buffer_list_length (list) < funnel->max_batch)
+      && (next = gst_atomic_queue_peek (funnel->queue))
+      && next->pad == item->pad && GST_IS_BUFFER (next->obj)) {
+    if (list == NULL) {
+      list = gst_buffer_list_new_sized (funnel->max_batch);
+      gst_buffer_list_add (list, GST_BUFFER_CAST (item->obj));
+    }
+    gst_atomic_queue_pop (funnel->queue);
+    gst_buffer_list_add (list, GST_BUFFER_CAST (next->obj));
+    gst_funnel_item_done (funnel, next);
+  }
+
+  return list ? GST_MINI_OBJECT_CAST (list) : item->obj;
+}
+
+static void
+gst_funnel_push_queued_event (GstFunnel * funnel, GstFunnelPad * fpad,
+    GstEvent * event)
+{
+  gboolean sticky = GST_EVENT_IS_STICKY (event)
+      && GST_EVENT_TYPE (event) != GST_EVENT_EOS;
+  GstEventType type;
+
+  if (sticky) {
+    gst_funnel_pad_store_event (fpad, event);
+
+    /* sent when the pad becomes active */
+    if (funnel->last_sinkpad && funnel->last_sinkpad != GST_PAD_CAST (fpad)) {
+      gst_event_unref (event);
+      return;
+    }
+  }
+
+  gst_funnel_switch_pad (funnel, fpad);
+
+  if (sticky && gst_funnel_event_is_current (funnel, event)) {
+    gst_event_unref (event);
+    return;
+  }
+
+  type = GST_EVENT_TYPE (event);
+  gst_pad_push_event (funnel->srcpad, event);
+
+  if (type == GST_EVENT_FLUSH_STOP)
+    g_atomic_int_set (&funnel->last_ret, GST_FLOW_OK);
+}
+
+static void
+gst_funnel_loop (GstFunnel * funnel)
+{
+  GstFunnelItem *item;
+  GstMiniObject *obj;
+  GstFlowReturn ret;
+
+  if (!(item = gst_funnel_pop_item (funnel)))
+    goto flushing;
+
+  obj = item->obj;
+
+  if (GST_IS_EVENT (obj)) {
+    gst_funnel_push_queued_event (funnel, item->pad, GST_EVENT_CAST (obj));
+    gst_funnel_item_done (funnel, item);
+    return;
+  }
+
+  gst_funnel_switch_pad (funnel, item->pad);
+
+  if (GST_IS_BUFFER (obj) && funnel->max_batch > 1)
+    obj = gst_funnel_collect_batch (funnel, item);
+
+  if (GST_IS_BUFFER_LIST (obj))
+    ret = gst_pad_push_list (funnel->srcpad, GST_BUFFER_LIST_CAST (obj));
+  else
+    ret = gst_pad_push (funnel->srcpad, GST_BUFFER_CAST (obj));
+
+  GST_LOG_OBJECT (item->pad, "pushed %" GST_PTR_FORMAT ": %s", obj,
+      gst_flow_get_name (ret));
+
+  /* returned to the inputs from their next buffer on */
+  g_atomic_int_set (&funnel->last_ret, ret);
+  gst_funnel_item_done (funnel, item);
+  return;
+
+flushing:
+  {
+    GST_DEBUG_OBJECT (funnel, "pausing task, flushing");
+    gst_pad_pause_task (funnel->srcpad);
+  }
+}
+
+static gboolean
+gst_funnel_src_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstFunnel *funnel = GST_FUNNEL (parent);
+  gboolean res = TRUE;
+
+  if (mode != GST_PAD_MODE_PUSH)
+    return FALSE;
+
+  if (active) {
+    gst_funnel_flush_queue (funnel);
+    g_atomic_int_set (&funnel->last_ret, GST_FLOW_OK);
+    g_mutex_lock (&funnel->queue_lock);
+    g_atomic_int_set (&funnel->flushing, FALSE);
+    g_mutex_unlock (&funnel->queue_lock);
+
+    if (funnel->output_thread)
+      res = gst_pad_start_task (pad, (GstTaskFunction) gst_funnel_loop, funnel,
+          NULL);
+  } else {
+    g_mutex_lock (&funnel->queue_lock);
+    g_atomic_int_set (&funnel->flushing, TRUE);
+    g_cond_broadcast (&funnel->item_cond);
+    g_cond_broadcast (&funnel->space_cond);
+    g_mutex_unlock (&funnel->queue_lock);
+
+    res = gst_pad_stop_task (pad);
+    gst_funnel_flush_queue (funnel);
+  }
+
+  return res;
+}
+
 static GstFlowReturn
 gst_funnel_sink_chain_object (GstPad * pad, GstFunnel * funnel,
     gboolean is_list, GstMiniObject * obj)
@@ -322,6 +788,13 @@ gst_funnel_sink_chain_object (GstPad * pad, GstFunnel * funnel,
 
   GST_DEBUG_OBJECT (pad, "received %" GST_PTR_FORMAT, obj);
 
+  if (funnel->output_thread) {
+    res = gst_funnel_enqueue (funnel, GST_FUNNEL_PAD_CAST (pad), obj);
+    if (res == GST_FLOW_OK)
+      res = g_atomic_int_get (&funnel->last_ret);
+    return res;
+  }
+
   GST_PAD_STREAM_LOCK (funnel->srcpad);
 
   if ((funnel->last_sinkpad == NULL) || (funnel->forward_sticky_events
@@ -376,6 +849,26 @@ gst_funnel_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   GST_DEBUG_OBJECT (pad, "received event %" GST_PTR_FORMAT, event);
 
+  if (funnel->output_thread && GST_EVENT_IS_SERIALIZED (event)) {
+    if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+      GST_OBJECT_LOCK (funnel);
+      fpad->got_eos = TRUE;
+      forward = gst_funnel_all_sinkpads_eos_unlocked (funnel, pad);
+      GST_OBJECT_UNLOCK (funnel);
+    } else if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP) {
+      GST_OBJECT_LOCK (funnel);
+      fpad->got_eos = FALSE;
+      GST_OBJECT_UNLOCK (funnel);
+    }
+
+    if (!forward) {
+      gst_event_unref (event);
+      return TRUE;
+    }
+    return gst_funnel_enqueue (funnel, fpad,
+        GST_MINI_OBJECT_CAST (event)) == GST_FLOW_OK;
+  }
+
   if (GST_EVENT_IS_STICKY (event)) {
     unlock = TRUE;
     GST_PAD_STREAM_LOCK (funnel->srcpad);
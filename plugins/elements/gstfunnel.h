@@ -57,6 +57,20 @@ struct _GstFunnel {
 
   GstPad *last_sinkpad;
   gboolean forward_sticky_events;
+
+  /* output thread mode */
+  gboolean output_thread;
+  guint max_queued;
+  guint max_batch;
+
+  GstAtomicQueue *queue;
+  GMutex queue_lock;
+  GCond item_cond;
+  GCond space_cond;
+  gint flushing;
+  gint thread_waiting;
+  gint n_waiting;
+  gint last_ret;
 };
 
 struct _GstFunnelClass {
@@ -26,6 +26,23 @@
  *
  * Dummy element that passes incoming data through unmodified. It has some
  * useful diagnostic functions, such as offset and timestamp checking.
+ *
+ * Identity always counts the buffers, bytes, gap events and discontinuities
+ * going through it without taking any lock, so it can stay in production
+ * pipelines as a cheap measurement point. The counters are available in the
+ * #GstIdentity:stats property and as the answer to a custom query with a
+ * "GstIdentityStats" structure sent to any of its pads:
+ * |[<!-- language="C" -->
+ *   GstQuery *query;
+ *   guint64 bytes;
+ *
+ *   query = gst_query_new_custom (GST_QUERY_CUSTOM,
+ *       gst_structure_new_empty ("GstIdentityStats"));
+ *   if (gst_pad_peer_query (pad, query))
+ *     gst_structure_get_uint64 (gst_query_get_structure (query), "num-bytes",
+ *         &bytes);
+ *   gst_query_unref (query);
+ * ]|
  */
 
 #ifdef HAVE_CONFIG_H
@@ -93,7 +110,8 @@ enum
   PROP_CHECK_IMPERFECT_TIMESTAMP,
   PROP_CHECK_IMPERFECT_OFFSET,
   PROP_SIGNAL_HANDOFFS,
-  PROP_DROP_ALLOCATION
+  PROP_DROP_ALLOCATION,
+  PROP_STATS
 };
 
 
@@ -237,6 +255,22 @@ gst_identity_class_init (GstIdentityClass * klass)
           "Don't forward allocation queries", DEFAULT_DROP_ALLOCATION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstIdentity:stats:
+   *
+   * The statistics of the buffers that went through identity since it was
+   * started: "num-buffers", "num-bytes", "num-gaps" for the gap events,
+   * "num-discont" for the buffers with the DISCONT flag (all #guint64) and
+   * "data-rate" (#gdouble), the bytes per second of running time between the
+   * start of the first and the end of the last buffer with a timestamp or 0.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistics of the buffers that went through", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstIdentity::handoff:
    * @identity: the identity instance
@@ -290,11 +324,96 @@ gst_identity_init (GstIdentity * identity)
   identity->last_message = NULL;
   identity->signal_handoffs = DEFAULT_SIGNAL_HANDOFFS;
   identity->ts_offset = DEFAULT_TS_OFFSET;
+  identity->first_running_time = GST_CLOCK_TIME_NONE;
+  identity->last_running_time = GST_CLOCK_TIME_NONE;
   g_cond_init (&identity->blocked_cond);
 
   gst_base_transform_set_gap_aware (GST_BASE_TRANSFORM_CAST (identity), TRUE);
 }
 
+/* a sequence counter lets gst_identity_get_stats() read consistent values
+ * while the streaming thread updates them, without locking either side */
+static inline void
+gst_identity_stats_begin (GstIdentity * identity)
+{
+  g_atomic_int_inc (&identity->stats_seq);
+}
+
+static inline void
+gst_identity_stats_end (GstIdentity * identity)
+{
+  g_atomic_int_inc (&identity->stats_seq);
+}
+
+static void
+gst_identity_reset_stats (GstIdentity * identity)
+{
+  gst_identity_stats_begin (identity);
+  identity->num_buffers = 0;
+  identity->num_bytes = 0;
+  identity->num_gaps = 0;
+  identity->num_discont = 0;
+  identity->first_running_time = GST_CLOCK_TIME_NONE;
+  identity->last_running_time = GST_CLOCK_TIME_NONE;
+  gst_identity_stats_end (identity);
+}
+
+static void
+gst_identity_update_stats (GstIdentity * identity, GstBuffer * buf, gsize size)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM_CAST (identity);
+  GstClockTime start = GST_CLOCK_TIME_NONE, end = GST_CLOCK_TIME_NONE;
+
+  if (trans->segment.format == GST_FORMAT_TIME) {
+    start = gst_segment_to_running_time (&trans->segment, GST_FORMAT_TIME,
+        GST_BUFFER_PTS (buf));
+    end = start;
+    if (GST_CLOCK_TIME_IS_VALID (start) && GST_BUFFER_DURATION_IS_VALID (buf))
+      end += GST_BUFFER_DURATION (buf);
+  }
+
+  gst_identity_stats_begin (identity);
+  identity->num_buffers++;
+  identity->num_bytes += size;
+  if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DISCONT))
+    identity->num_discont++;
+  if (GST_CLOCK_TIME_IS_VALID (start)) {
+    if (!GST_CLOCK_TIME_IS_VALID (identity->first_running_time))
+      identity->first_running_time = start;
+    identity->last_running_time = end;
+  }
+  gst_identity_stats_end (identity);
+}
+
+static void
+gst_identity_get_stats (GstIdentity * identity, GstStructure * s)
+{
+  guint64 buffers, bytes, gaps, discont;
+  GstClockTime first, last;
+  gdouble rate = 0.0;
+  gint seq;
+
+  do {
+    /* wait until the streaming thread is done updating */
+    while ((seq = g_atomic_int_get (&identity->stats_seq)) & 1);
+
+    buffers = identity->num_buffers;
+    bytes = identity->num_bytes;
+    gaps = identity->num_gaps;
+    discont = identity->num_discont;
+    first = identity->first_running_time;
+    last = identity->last_running_time;
+  } while (seq != g_atomic_int_get (&identity->stats_seq));
+
+  if (GST_CLOCK_TIME_IS_VALID (first) && last > first)
+    rate = (gdouble) bytes *GST_SECOND / (last - first);
+
+  gst_structure_set (s, "num-buffers", G_TYPE_UINT64, buffers,
+      "num-bytes", G_TYPE_UINT64, bytes, "num-gaps", G_TYPE_UINT64, gaps,
+      "num-discont", G_TYPE_UINT64, discont, "data-rate", G_TYPE_DOUBLE, rate,
+      NULL);
+}
+
 static void
 gst_identity_notify_last_message (GstIdentity * identity)
 {
@@ -413,6 +532,12 @@ gst_identity_sink_event (GstBaseTransform * trans, GstEvent * event)
     }
   }
 
+  if (GST_EVENT_TYPE (event) == GST_EVENT_GAP) {
+    gst_identity_stats_begin (identity);
+    identity->num_gaps++;
+    gst_identity_stats_end (identity);
+  }
+
   if (GST_EVENT_TYPE (event) == GST_EVENT_GAP &&
       trans->have_segment && trans->segment.format == GST_FORMAT_TIME) {
     GstClockTime start, dur;
@@ -613,6 +738,8 @@ gst_identity_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 
   size = gst_buffer_get_size (buf);
 
+  gst_identity_update_stats (identity, buf, size);
+
   if (identity->check_imperfect_timestamp)
     gst_identity_check_imperfect_timestamp (identity, buf);
   if (identity->check_imperfect_offset)
@@ -835,6 +962,14 @@ gst_identity_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DROP_ALLOCATION:
       g_value_set_boolean (value, identity->drop_allocation);
       break;
+    case PROP_STATS:
+    {
+      GstStructure *s = gst_structure_new_empty ("GstIdentityStats");
+
+      gst_identity_get_stats (identity, s);
+      g_value_take_boxed (value, s);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -853,6 +988,7 @@ gst_identity_start (GstBaseTransform * trans)
   identity->prev_duration = GST_CLOCK_TIME_NONE;
   identity->prev_offset_end = GST_BUFFER_OFFSET_NONE;
   identity->prev_offset = GST_BUFFER_OFFSET_NONE;
+  gst_identity_reset_stats (identity);
 
   return TRUE;
 }
@@ -906,6 +1042,15 @@ gst_identity_query (GstBaseTransform * base, GstPadDirection direction,
     return FALSE;
   }
 
+  if (GST_QUERY_TYPE (query) == GST_QUERY_CUSTOM) {
+    const GstStructure *s = gst_query_get_structure (query);
+
+    if (s && gst_structure_has_name (s, "GstIdentityStats")) {
+      gst_identity_get_stats (identity, gst_query_writable_structure (query));
+      return TRUE;
+    }
+  }
+
   ret = GST_BASE_TRANSFORM_CLASS (parent_class)->query (base, direction, query);
 
   if (GST_QUERY_TYPE (query) == GST_QUERY_LATENCY) {
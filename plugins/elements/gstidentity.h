@@ -79,6 +79,15 @@ struct _GstIdentity {
   gboolean       blocked;
   GstClockTimeDiff  ts_offset;
   gboolean       drop_allocation;
+
+  /* only written by the streaming thread, odd stats_seq while updating */
+  volatile gint  stats_seq;
+  guint64        num_buffers;
+  guint64        num_bytes;
+  guint64        num_gaps;
+  guint64        num_discont;
+  GstClockTime   first_running_time;
+  GstClockTime   last_running_time;
 };
 
 struct _GstIdentityClass {
@@ -39,6 +39,11 @@
  * * "always-ok" : Make an inactive pads return #GST_FLOW_OK instead of
  * #GST_FLOW_NOT_LINKED
  *
+ * When switching between many live inputs, #GstInputSelector:keyframe-preroll
+ * makes the inactive pads drop their buffers right away instead of waiting
+ * for the active pad. They only keep the buffers since their last keyframe,
+ * which a pad that becomes active pushes first so that downstream can decode
+ * the new stream without waiting for its next keyframe.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -100,12 +105,14 @@ enum
   PROP_ACTIVE_PAD,
   PROP_SYNC_STREAMS,
   PROP_SYNC_MODE,
-  PROP_CACHE_BUFFERS
+  PROP_CACHE_BUFFERS,
+  PROP_KEYFRAME_PREROLL
 };
 
 #define DEFAULT_SYNC_STREAMS TRUE
 #define DEFAULT_SYNC_MODE GST_INPUT_SELECTOR_SYNC_MODE_ACTIVE_SEGMENT
 #define DEFAULT_CACHE_BUFFERS FALSE
+#define DEFAULT_KEYFRAME_PREROLL 0
 #define DEFAULT_PAD_ALWAYS_OK TRUE
 
 enum
@@ -164,6 +171,10 @@ struct _GstSelectorPad
 
   gboolean sending_cached_buffers;
   GQueue *cached_buffers;
+
+  /* buffers since the last keyframe while inactive in keyframe-preroll mode,
+   * the first one is the keyframe */
+  GstQueueArray *preroll;
 };
 
 struct _GstSelectorPadCachedBuffer
@@ -197,6 +208,7 @@ static GstFlowReturn gst_selector_pad_chain (GstPad * pad, GstObject * parent,
 static void gst_selector_pad_cache_buffer (GstSelectorPad * selpad,
     GstBuffer * buffer);
 static void gst_selector_pad_free_cached_buffers (GstSelectorPad * selpad);
+static void gst_selector_pad_free_preroll (GstSelectorPad * selpad);
 
 G_DEFINE_TYPE (GstSelectorPad, gst_selector_pad, GST_TYPE_PAD);
 
@@ -248,6 +260,10 @@ gst_selector_pad_finalize (GObject * object)
   if (pad->tags)
     gst_tag_list_unref (pad->tags);
   gst_selector_pad_free_cached_buffers (pad);
+  if (pad->preroll) {
+    gst_selector_pad_free_preroll (pad);
+    gst_queue_array_free (pad->preroll);
+  }
 
   G_OBJECT_CLASS (gst_selector_pad_parent_class)->finalize (object);
 }
@@ -344,6 +360,7 @@ gst_selector_pad_reset (GstSelectorPad * pad)
   gst_segment_init (&pad->segment, GST_FORMAT_UNDEFINED);
   pad->sending_cached_buffers = FALSE;
   gst_selector_pad_free_cached_buffers (pad);
+  gst_selector_pad_free_preroll (pad);
   GST_OBJECT_UNLOCK (pad);
 }
 
@@ -396,6 +413,76 @@ gst_selector_pad_free_cached_buffers (GstSelectorPad * selpad)
   selpad->cached_buffers = NULL;
 }
 
+/* must be called with the SELECTOR_LOCK */
+static void
+gst_selector_pad_free_preroll (GstSelectorPad * selpad)
+{
+  GstBuffer *buffer;
+
+  if (!selpad->preroll)
+    return;
+
+  while ((buffer = gst_queue_array_pop_head (selpad->preroll)))
+    gst_buffer_unref (buffer);
+}
+
+/* must be called with the SELECTOR_LOCK, takes ownership of @buffer */
+static void
+gst_selector_pad_preroll_buffer (GstSelectorPad * selpad, GstBuffer * buffer,
+    guint max_buffers)
+{
+  if (!selpad->preroll)
+    selpad->preroll = gst_queue_array_new (max_buffers);
+
+  if (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    gst_selector_pad_free_preroll (selpad);
+
+    /* switching to this pad will start with this keyframe */
+    buffer = gst_buffer_make_writable (buffer);
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+  } else if (gst_queue_array_is_empty (selpad->preroll)) {
+    GST_LOG_OBJECT (selpad, "No keyframe yet, dropping buffer %p", buffer);
+    gst_buffer_unref (buffer);
+    return;
+  } else if (gst_queue_array_get_length (selpad->preroll) >= max_buffers) {
+    GST_DEBUG_OBJECT (selpad, "More than %u buffers since the last keyframe, "
+        "waiting for the next one", max_buffers);
+    gst_selector_pad_free_preroll (selpad);
+    gst_buffer_unref (buffer);
+    return;
+  }
+
+  gst_queue_array_push_tail (selpad->preroll, buffer);
+}
+
+/* must be called with the SELECTOR_LOCK, returns the buffers a pad that
+ * just became active has to push before @buf or %NULL */
+static GstBufferList *
+gst_selector_pad_take_preroll (GstSelectorPad * selpad, GstBuffer * buf)
+{
+  GstBufferList *list;
+  GstBuffer *buffer;
+
+  if (!selpad->preroll || gst_queue_array_is_empty (selpad->preroll))
+    return NULL;
+
+  /* not needed when the stream restarts with a keyframe anyway */
+  if (!GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    gst_selector_pad_free_preroll (selpad);
+    return NULL;
+  }
+
+  list =
+      gst_buffer_list_new_sized (gst_queue_array_get_length (selpad->preroll));
+  while ((buffer = gst_queue_array_pop_head (selpad->preroll)))
+    gst_buffer_list_add (list, buffer);
+
+  /* the keyframe is marked as discont already */
+  selpad->discont = FALSE;
+
+  return list;
+}
+
 /* strictly get the linked pad from the sinkpad. If the pad is active we return
  * the srcpad else we return NULL */
 static GstIterator *
@@ -566,6 +653,8 @@ gst_selector_pad_event (GstPad * pad, GstObject * parent, GstEvent * event)
     {
       gst_event_copy_segment (event, &selpad->segment);
       selpad->segment_seqnum = gst_event_get_seqnum (event);
+      /* the kept buffers don't belong to the new segment */
+      gst_selector_pad_free_preroll (selpad);
 
       GST_DEBUG_OBJECT (pad, "configured SEGMENT %" GST_SEGMENT_FORMAT,
           &selpad->segment);
@@ -989,6 +1078,8 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   GstPad *active_sinkpad;
   GstPad *prev_active_sinkpad = NULL;
   GstSelectorPad *selpad;
+  GstBufferList *preroll = NULL;
+  gboolean sync_streams, cache_buffers;
 
   sel = GST_INPUT_SELECTOR (parent);
   selpad = GST_SELECTOR_PAD_CAST (pad);
@@ -1004,6 +1095,10 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     goto flushing;
   }
 
+  /* inactive pads never wait in keyframe-preroll mode */
+  sync_streams = sel->sync_streams && sel->keyframe_preroll == 0;
+  cache_buffers = sync_streams && sel->cache_buffers;
+
   GST_LOG_OBJECT (pad, "getting active pad");
 
   prev_active_sinkpad =
@@ -1012,7 +1107,7 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   /* In sync mode wait until the active pad has advanced
    * after the running time of the current buffer */
-  if (sel->sync_streams) {
+  if (sync_streams) {
     /* call chain for each cached buffer if we are not the active pad
      * or if we are the active pad but didn't push anything yet. */
     if (active_sinkpad != pad || !selpad->pushed) {
@@ -1084,11 +1179,19 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   }
 
   /* Ignore buffers from pads except the selected one */
-  if (pad != active_sinkpad)
+  if (pad != active_sinkpad) {
+    if (sel->keyframe_preroll > 0) {
+      gst_selector_pad_preroll_buffer (selpad, buf, sel->keyframe_preroll);
+      buf = NULL;
+    }
     goto ignore;
+  }
+
+  if (G_UNLIKELY (sel->keyframe_preroll > 0))
+    preroll = gst_selector_pad_take_preroll (selpad, buf);
 
   /* Tell all non-active pads that we advanced the running time */
-  if (sel->sync_streams)
+  if (sync_streams)
     GST_INPUT_SELECTOR_BROADCAST (sel);
 
   GST_INPUT_SELECTOR_UNLOCK (sel);
@@ -1113,6 +1216,16 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     prev_active_sinkpad = NULL;
   }
 
+  if (G_UNLIKELY (preroll)) {
+    GST_DEBUG_OBJECT (pad, "Forwarding %u buffers since the last keyframe",
+        gst_buffer_list_length (preroll));
+    res = gst_pad_push_list (sel->srcpad, preroll);
+    if (res != GST_FLOW_OK) {
+      gst_buffer_unref (buf);
+      goto done;
+    }
+  }
+
   if (selpad->discont) {
     buf = gst_buffer_make_writable (buf);
 
@@ -1126,14 +1239,14 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       buf, GST_TIME_ARGS (GST_BUFFER_PTS (buf)));
 
   /* Only make the buffer read-only when necessary */
-  if (sel->sync_streams && sel->cache_buffers)
+  if (cache_buffers)
     buf = gst_buffer_ref (buf);
   res = gst_pad_push (sel->srcpad, buf);
   GST_LOG_OBJECT (pad, "Buffer %p forwarded result=%d", buf, res);
 
   GST_INPUT_SELECTOR_LOCK (sel);
 
-  if (sel->sync_streams && sel->cache_buffers) {
+  if (cache_buffers) {
     /* Might have changed while pushing */
     active_sinkpad = gst_input_selector_get_active_sinkpad (sel);
     /* only set pad to pushed if we are still the active pad */
@@ -1165,7 +1278,8 @@ ignore:
     /* when we drop a buffer, we're creating a discont on this pad */
     selpad->discont = TRUE;
     GST_INPUT_SELECTOR_UNLOCK (sel);
-    gst_buffer_unref (buf);
+    if (buf)
+      gst_buffer_unref (buf);
 
     /* figure out what to return upstream */
     GST_OBJECT_LOCK (selpad);
@@ -1288,6 +1402,27 @@ gst_input_selector_class_init (GstInputSelectorClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstInputSelector:keyframe-preroll
+   *
+   * If not 0, inactive pads drop their buffers immediately instead of
+   * waiting in GstInputSelector:sync-streams mode, and only keep up to this
+   * number of buffers since their last keyframe. A pad that becomes active
+   * first pushes those buffers so that switching doesn't need to wait for
+   * the next keyframe of the stream. Streams without a keyframe in that many
+   * buffers are switched to at their next keyframe. GstInputSelector:cache-buffers
+   * has no effect in this mode.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_KEYFRAME_PREROLL,
+      g_param_spec_uint ("keyframe-preroll", "Keyframe Preroll",
+          "Maximum number of buffers since the last keyframe that inactive "
+          "pads keep for switching (0 = wait like sync-streams)",
+          0, G_MAXINT, DEFAULT_KEYFRAME_PREROLL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gst_element_class_set_static_metadata (gstelement_class, "Input selector",
       "Generic", "N-to-1 input stream selector",
       "Julien Moutte <julien@moutte.net>, "
@@ -1318,6 +1453,7 @@ gst_input_selector_init (GstInputSelector * sel)
   sel->padcount = 0;
   sel->sync_streams = DEFAULT_SYNC_STREAMS;
   sel->sync_mode = DEFAULT_SYNC_MODE;
+  sel->keyframe_preroll = DEFAULT_KEYFRAME_PREROLL;
   sel->have_group_id = TRUE;
 
   g_mutex_init (&sel->lock);
@@ -1442,6 +1578,11 @@ gst_input_selector_set_property (GObject * object, guint prop_id,
       sel->cache_buffers = g_value_get_boolean (value);
       GST_INPUT_SELECTOR_UNLOCK (object);
       break;
+    case PROP_KEYFRAME_PREROLL:
+      GST_INPUT_SELECTOR_LOCK (sel);
+      sel->keyframe_preroll = g_value_get_uint (value);
+      GST_INPUT_SELECTOR_UNLOCK (sel);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1490,6 +1631,11 @@ gst_input_selector_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, sel->cache_buffers);
       GST_INPUT_SELECTOR_UNLOCK (object);
       break;
+    case PROP_KEYFRAME_PREROLL:
+      GST_INPUT_SELECTOR_LOCK (sel);
+      g_value_set_uint (value, sel->keyframe_preroll);
+      GST_INPUT_SELECTOR_UNLOCK (sel);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
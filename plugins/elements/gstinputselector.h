@@ -23,6 +23,7 @@
 #define __GST_INPUT_SELECTOR_H__
 
 #include <gst/gst.h>
+#include <gst/base/gstqueuearray.h>
 
 G_BEGIN_DECLS
 
@@ -71,6 +72,7 @@ struct _GstInputSelector {
   gboolean sync_streams;
   GstInputSelectorSyncMode sync_mode;
   gboolean cache_buffers;
+  guint keyframe_preroll;
 
   gboolean have_group_id;
 
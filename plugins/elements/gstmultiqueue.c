@@ -138,6 +138,13 @@ struct _GstSingleQueue
                                  * UNDEFINED as this doesn't requires adding ifs
                                  * in every segment usage */
 
+  /* protects the segments, the tainted flags, sinktime, srctime, cur_time
+   * and last_time against the other streaming thread of this queue. Taken
+   * after the multiqueue lock when both are needed. last_time is only
+   * written with both locks, and so is cur_time when buffering is enabled,
+   * so either lock is enough to read them. */
+  GMutex lock;
+
   /* position of src/sink */
   GstClockTimeDiff sinktime, srctime;
   /* cached input value, used for interleave */
@@ -154,14 +161,20 @@ struct _GstSingleQueue
   gboolean is_sparse;
   gboolean flushing;
   gboolean active;
+  /* TRUE after the tracers were told that the sink or src side blocks */
+  gboolean wait_full_traced, wait_empty_traced;
+  /* cooperative srcpad task suspended until an item is pushed, atomic */
+  gint suspended;
 
   /* Protected by global lock */
   guint32 nextid;               /* ID of the next object waiting to be pushed */
   guint32 oldid;                /* ID of the last object pushed (last in a series) */
   guint32 last_oldid;           /* Previously observed old_id, reset to MAXUINT32 on flush */
   GstClockTimeDiff next_time;   /* End running time of next buffer to be pushed */
-  GstClockTimeDiff last_time;   /* Start running time of last pushed buffer */
+  GstClockTimeDiff last_time;   /* Start running time of last pushed buffer,
+                                 * also protected by the single queue lock */
   GCond turn;                   /* SingleQueue turn waiting conditional */
+  gint waiting_index;           /* Position in the heap of waiting queues or -1 */
 
   /* for serialized queries */
   GCond query_handled;
@@ -194,10 +207,19 @@ static GstSingleQueue *gst_single_queue_new (GstMultiQueue * mqueue, guint id);
 static void gst_single_queue_free (GstSingleQueue * squeue);
 
 static void wake_up_next_non_linked (GstMultiQueue * mq);
+static void waiting_heap_push (GstMultiQueue * mq, GstSingleQueue * sq);
+static void waiting_heap_remove (GstMultiQueue * mq, GstSingleQueue * sq);
 static void compute_high_id (GstMultiQueue * mq);
 static void compute_high_time (GstMultiQueue * mq, guint groupid);
+static void single_queue_overrun (GstSingleQueue * sq, gboolean blocking);
 static void single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq);
 static void single_queue_underrun_cb (GstDataQueue * dq, GstSingleQueue * sq);
+static gboolean single_queue_push (GstSingleQueue * sq,
+    GstDataQueueItem * item);
+static void single_queue_wait_full_done (GstSingleQueue * sq);
+static gboolean single_queue_pop (GstSingleQueue * sq,
+    GstDataQueueItem ** item);
+static gboolean single_queue_suspend (GstSingleQueue * sq);
 
 static void update_buffering (GstMultiQueue * mq, GstSingleQueue * sq);
 static void gst_multi_queue_post_buffering (GstMultiQueue * mq);
@@ -254,6 +276,9 @@ enum
 #define DEFAULT_UNLINKED_CACHE_TIME 250 * GST_MSECOND
 
 #define DEFAULT_MINIMUM_INTERLEAVE (250 * GST_MSECOND)
+#define DEFAULT_SPIN_TIME 0
+#define DEFAULT_THREAD_SCHEDULING GST_TASK_SCHEDULING_DEFAULT
+#define DEFAULT_THREAD_PRIORITY 0
 
 enum
 {
@@ -273,6 +298,11 @@ enum
   PROP_USE_INTERLEAVE,
   PROP_UNLINKED_CACHE_TIME,
   PROP_MINIMUM_INTERLEAVE,
+  PROP_SPIN_TIME,
+  PROP_SPIN_HITS,
+  PROP_SPIN_BLOCKS,
+  PROP_THREAD_SCHEDULING,
+  PROP_THREAD_PRIORITY,
   PROP_LAST
 };
 
@@ -406,6 +436,14 @@ gst_multiqueue_pad_init (GstMultiQueuePad * pad)
   g_mutex_unlock (&q->qlock);                                            \
 } G_STMT_END
 
+#define GST_SINGLE_QUEUE_MUTEX_LOCK(sq) G_STMT_START {                         \
+  g_mutex_lock (&sq->lock);                                              \
+} G_STMT_END
+
+#define GST_SINGLE_QUEUE_MUTEX_UNLOCK(sq) G_STMT_START {                       \
+  g_mutex_unlock (&sq->lock);                                            \
+} G_STMT_END
+
 #define SET_PERCENT(mq, perc) G_STMT_START {                             \
   if (perc != mq->buffering_percent) {                                   \
     mq->buffering_percent = perc;                                        \
@@ -444,6 +482,8 @@ static GstStateChangeReturn gst_multi_queue_change_state (GstElement *
     element, GstStateChange transition);
 
 static void gst_multi_queue_loop (GstPad * pad);
+static void gst_single_queue_configure_task (GstMultiQueue * mq,
+    GstSingleQueue * sq);
 
 #define _do_init \
   GST_DEBUG_CATEGORY_INIT (multi_queue_debug, "multiqueue", 0, "multiqueue element");
@@ -625,6 +665,76 @@ gst_multi_queue_class_init (GstMultiQueueClass * klass)
           G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
           G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiQueue:spin-time:
+   *
+   * When the streaming thread of a queue finds it empty, busy-wait up to
+   * this time for new data before blocking. This trades CPU usage for a
+   * lower wakeup latency with high packet rates. 0 disables spinning.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_TIME,
+      g_param_spec_uint64 ("spin-time", "Spin time",
+          "Time to busy-wait for data before blocking in nanoseconds "
+          "(0 = disabled)", 0, G_MAXINT64, DEFAULT_SPIN_TIME,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiQueue:spin-hits:
+   *
+   * The number of waits for data of all current queues that ended while
+   * spinning.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_HITS,
+      g_param_spec_uint64 ("spin-hits", "Spin hits",
+          "Number of waits for data that ended while spinning", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiQueue:spin-blocks:
+   *
+   * The number of waits for data of all current queues that had to block.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_BLOCKS,
+      g_param_spec_uint64 ("spin-blocks", "Spin blocks",
+          "Number of waits for data that had to block", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiQueue:thread-scheduling:
+   *
+   * The scheduling policy of the streaming threads that push the data out
+   * of the queues.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_THREAD_SCHEDULING,
+      g_param_spec_enum ("thread-scheduling", "Thread scheduling",
+          "Scheduling policy of the streaming threads of the queues",
+          GST_TYPE_TASK_SCHEDULING_POLICY, DEFAULT_THREAD_SCHEDULING,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiQueue:thread-priority:
+   *
+   * The realtime priority of the streaming threads of the queues when
+   * #GstMultiQueue:thread-scheduling is a realtime policy.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_THREAD_PRIORITY,
+      g_param_spec_int ("thread-priority", "Thread priority",
+          "Realtime priority of the streaming threads of the queues", 0, 99,
+          DEFAULT_THREAD_PRIORITY, G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_multi_queue_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -663,10 +773,14 @@ gst_multi_queue_init (GstMultiQueue * mqueue)
   mqueue->use_interleave = DEFAULT_USE_INTERLEAVE;
   mqueue->min_interleave_time = DEFAULT_MINIMUM_INTERLEAVE;
   mqueue->unlinked_cache_time = DEFAULT_UNLINKED_CACHE_TIME;
+  mqueue->spin_time = DEFAULT_SPIN_TIME;
+  mqueue->thread_scheduling = DEFAULT_THREAD_SCHEDULING;
+  mqueue->thread_priority = DEFAULT_THREAD_PRIORITY;
 
   mqueue->counter = 1;
   mqueue->highid = -1;
   mqueue->high_time = GST_CLOCK_STIME_NONE;
+  mqueue->waiting = g_ptr_array_new ();
 
   g_mutex_init (&mqueue->qlock);
   g_mutex_init (&mqueue->buffering_post_lock);
@@ -681,6 +795,7 @@ gst_multi_queue_finalize (GObject * object)
   g_list_free (mqueue->queues);
   mqueue->queues = NULL;
   mqueue->queues_cookie++;
+  g_ptr_array_free (mqueue->waiting, TRUE);
 
   /* free/unref instance data */
   g_mutex_clear (&mqueue->qlock);
@@ -811,6 +926,33 @@ gst_multi_queue_set_property (GObject * object, guint prop_id,
         calculate_interleave (mq, NULL);
       GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
       break;
+    case PROP_SPIN_TIME:{
+      GList *tmp;
+
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      mq->spin_time = g_value_get_uint64 (value);
+      for (tmp = mq->queues; tmp; tmp = tmp->next) {
+        GstSingleQueue *q = (GstSingleQueue *) tmp->data;
+
+        g_object_set (q->queue, "spin-time", mq->spin_time, NULL);
+      }
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      break;
+    }
+    case PROP_THREAD_SCHEDULING:
+    case PROP_THREAD_PRIORITY:{
+      GList *tmp;
+
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      if (prop_id == PROP_THREAD_SCHEDULING)
+        mq->thread_scheduling = g_value_get_enum (value);
+      else
+        mq->thread_priority = g_value_get_int (value);
+      for (tmp = mq->queues; tmp; tmp = tmp->next)
+        gst_single_queue_configure_task (mq, (GstSingleQueue *) tmp->data);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -873,6 +1015,30 @@ gst_multi_queue_get_property (GObject * object, guint prop_id,
     case PROP_MINIMUM_INTERLEAVE:
       g_value_set_uint64 (value, mq->min_interleave_time);
       break;
+    case PROP_SPIN_TIME:
+      g_value_set_uint64 (value, mq->spin_time);
+      break;
+    case PROP_THREAD_SCHEDULING:
+      g_value_set_enum (value, mq->thread_scheduling);
+      break;
+    case PROP_THREAD_PRIORITY:
+      g_value_set_int (value, mq->thread_priority);
+      break;
+    case PROP_SPIN_HITS:
+    case PROP_SPIN_BLOCKS:{
+      const gchar *name = g_param_spec_get_name (pspec);
+      guint64 total = 0, count;
+      GList *tmp;
+
+      for (tmp = mq->queues; tmp; tmp = tmp->next) {
+        GstSingleQueue *q = (GstSingleQueue *) tmp->data;
+
+        g_object_get (q->queue, name, &count, NULL);
+        total += count;
+      }
+      g_value_set_uint64 (value, total);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1046,6 +1212,25 @@ gst_multi_queue_change_state (GstElement * element, GstStateChange transition)
   return result;
 }
 
+/* configure the scheduling of the srcpad task of @sq, WITH LOCK TAKEN. The
+ * thread of a running task picks it up before the next call of the loop */
+static void
+gst_single_queue_configure_task (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  GstTask *task;
+
+  GST_OBJECT_LOCK (sq->srcpad);
+  if ((task = GST_PAD_TASK (sq->srcpad)))
+    gst_object_ref (task);
+  GST_OBJECT_UNLOCK (sq->srcpad);
+
+  if (task == NULL)
+    return;
+
+  gst_task_set_scheduling (task, mq->thread_scheduling, mq->thread_priority);
+  gst_object_unref (task);
+}
+
 static gboolean
 gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
     gboolean full)
@@ -1072,11 +1257,14 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
 
     GST_LOG_OBJECT (mq, "SingleQueue %d : pausing task", sq->id);
     result = gst_pad_pause_task (sq->srcpad);
+    GST_SINGLE_QUEUE_MUTEX_LOCK (sq);
     sq->sink_tainted = sq->src_tainted = TRUE;
+    GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
   } else {
     gst_single_queue_flush_queue (sq, full);
 
     GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    GST_SINGLE_QUEUE_MUTEX_LOCK (sq);
     gst_segment_init (&sq->sink_segment, GST_FORMAT_TIME);
     gst_segment_init (&sq->src_segment, GST_FORMAT_TIME);
     sq->has_src_segment = FALSE;
@@ -1092,6 +1280,8 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
     sq->last_oldid = G_MAXUINT32;
     sq->next_time = GST_CLOCK_STIME_NONE;
     sq->last_time = GST_CLOCK_STIME_NONE;
+    GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
+    g_atomic_int_set (&sq->suspended, FALSE);
     sq->cached_sinktime = GST_CLOCK_STIME_NONE;
     sq->group_high_time = GST_CLOCK_STIME_NONE;
     gst_data_queue_set_flushing (sq->queue, FALSE);
@@ -1109,6 +1299,11 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush,
     result =
         gst_pad_start_task (sq->srcpad, (GstTaskFunction) gst_multi_queue_loop,
         sq->srcpad, NULL);
+
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    if (result && mq->thread_scheduling != GST_TASK_SCHEDULING_DEFAULT)
+      gst_single_queue_configure_task (mq, sq);
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
   }
   return result;
 }
@@ -1348,11 +1543,15 @@ beach:
 
 /* calculate the diff between running time on the sink and src of the queue.
  * This is the total amount of time in the queue.
- * WITH LOCK TAKEN */
-static void
+ * WITH SINGLE QUEUE LOCK TAKEN, and the multiqueue lock too when buffering or
+ * interleave calculation is enabled or the last time is unknown.
+ * Returns TRUE when the interleave needs to be recalculated, which is done by
+ * update_global_level() after releasing the single queue lock. */
+static gboolean
 update_time_level (GstMultiQueue * mq, GstSingleQueue * sq)
 {
   GstClockTimeDiff sink_time, src_time;
+  gboolean interleave_changed = FALSE;
 
   if (sq->sink_tainted) {
     sink_time = sq->sinktime = my_segment_to_running_time (&sq->sink_segment,
@@ -1375,7 +1574,7 @@ update_time_level (GstMultiQueue * mq, GstSingleQueue * sq)
       sq->sink_tainted = FALSE;
       if (mq->use_interleave) {
         sq->cached_sinktime = sink_time;
-        calculate_interleave (mq, sq);
+        interleave_changed = TRUE;
       }
     }
   } else
@@ -1421,10 +1620,22 @@ update_time_level (GstMultiQueue * mq, GstSingleQueue * sq)
   else
     sq->cur_time = 0;
 
+  return interleave_changed;
+}
+
+/* update the state that depends on the time level of all queues. Called
+ * without the single queue lock, the data queue callbacks take it while
+ * holding the data queue lock.
+ * WITH LOCK TAKEN */
+static void
+update_global_level (GstMultiQueue * mq, GstSingleQueue * sq,
+    gboolean interleave_changed)
+{
+  if (interleave_changed)
+    calculate_interleave (mq, sq);
+
   /* updating the time level can change the buffering state */
   update_buffering (mq, sq);
-
-  return;
 }
 
 /* take a SEGMENT event and apply the values to segment, updating the time
@@ -1433,6 +1644,11 @@ static void
 apply_segment (GstMultiQueue * mq, GstSingleQueue * sq, GstEvent * event,
     GstSegment * segment)
 {
+  gboolean interleave_changed;
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  GST_SINGLE_QUEUE_MUTEX_LOCK (sq);
+
   gst_event_copy_segment (event, segment);
 
   /* now configure the values, we use these to track timestamps on the
@@ -1445,7 +1661,6 @@ apply_segment (GstMultiQueue * mq, GstSingleQueue * sq, GstEvent * event,
     segment->stop = -1;
     segment->time = 0;
   }
-  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
 
   /* Make sure we have a valid initial segment position (and not garbage
    * from upstream) */
@@ -1464,18 +1679,35 @@ apply_segment (GstMultiQueue * mq, GstSingleQueue * sq, GstEvent * event,
       "queue %d, configured SEGMENT %" GST_SEGMENT_FORMAT, sq->id, segment);
 
   /* segment can update the time level of the queue */
-  update_time_level (mq, sq);
+  interleave_changed = update_time_level (mq, sq);
+  GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
 
+  update_global_level (mq, sq, interleave_changed);
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
   gst_multi_queue_post_buffering (mq);
 }
 
-/* take a buffer and update segment, updating the time level of the queue. */
+/* take a buffer and update segment, updating the time level of the queue.
+ *
+ * Unless buffering or interleave calculation is enabled, or the first time
+ * of the queue is still unknown, this only involves this queue and the
+ * multiqueue lock is not taken. */
 static void
 apply_buffer (GstMultiQueue * mq, GstSingleQueue * sq, GstClockTime timestamp,
     GstClockTime duration, GstSegment * segment)
 {
-  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  gboolean global, interleave_changed;
+
+  GST_SINGLE_QUEUE_MUTEX_LOCK (sq);
+  global = mq->use_buffering || mq->use_interleave ||
+      sq->last_time == GST_CLOCK_STIME_NONE;
+
+  if (G_UNLIKELY (global)) {
+    /* the multiqueue lock must be taken first */
+    GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    GST_SINGLE_QUEUE_MUTEX_LOCK (sq);
+  }
 
   /* if no timestamp is set, assume it's continuous with the previous
    * time */
@@ -1498,9 +1730,14 @@ apply_buffer (GstMultiQueue * mq, GstSingleQueue * sq, GstClockTime timestamp,
     sq->src_tainted = TRUE;
 
   /* calc diff with other end */
-  update_time_level (mq, sq);
-  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
-  gst_multi_queue_post_buffering (mq);
+  interleave_changed = update_time_level (mq, sq);
+  GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
+
+  if (G_UNLIKELY (global)) {
+    update_global_level (mq, sq, interleave_changed);
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+    gst_multi_queue_post_buffering (mq);
+  }
 }
 
 static void
@@ -1509,8 +1746,10 @@ apply_gap (GstMultiQueue * mq, GstSingleQueue * sq, GstEvent * event,
 {
   GstClockTime timestamp;
   GstClockTime duration;
+  gboolean interleave_changed;
 
   GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  GST_SINGLE_QUEUE_MUTEX_LOCK (sq);
 
   gst_event_parse_gap (event, &timestamp, &duration);
 
@@ -1528,7 +1767,12 @@ apply_gap (GstMultiQueue * mq, GstSingleQueue * sq, GstEvent * event,
       sq->src_tainted = TRUE;
 
     /* calc diff with other end */
-    update_time_level (mq, sq);
+    interleave_changed = update_time_level (mq, sq);
+    GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
+
+    update_global_level (mq, sq, interleave_changed);
+  } else {
+    GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
   }
 
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
@@ -1785,9 +2029,15 @@ next:
   if (sq->flushing)
     goto out_flushing;
 
+  /* A cooperative task gives its thread back instead of waiting for data, it
+   * is woken up again when something is pushed. Not while dropping after EOS,
+   * that state only lives in this call */
+  if (!dropping && single_queue_suspend (sq))
+    return;
+
   /* Get something from the queue, blocking until that happens, or we get
    * flushed */
-  if (!(gst_data_queue_pop (sq->queue, &sitem)))
+  if (!(single_queue_pop (sq, &sitem)))
     goto out_flushing;
 
   item = (GstMultiQueueItem *) sitem;
@@ -1873,7 +2123,9 @@ next:
         wake_up_next_non_linked (mq);
 
         mq->numwaiting++;
+        waiting_heap_push (mq, sq);
         g_cond_wait (&sq->turn, &mq->qlock);
+        waiting_heap_remove (mq, sq);
         mq->numwaiting--;
 
         if (sq->flushing) {
@@ -1930,8 +2182,10 @@ next:
   GST_MULTI_QUEUE_MUTEX_LOCK (mq);
   next_time = get_running_time (&sq->src_segment, object, TRUE);
   if (GST_CLOCK_STIME_IS_VALID (next_time)) {
+    GST_SINGLE_QUEUE_MUTEX_LOCK (sq);
     if (sq->last_time == GST_CLOCK_STIME_NONE || sq->last_time < next_time)
       sq->last_time = next_time;
+    GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
     if (mq->high_time == GST_CLOCK_STIME_NONE || mq->high_time <= next_time) {
       /* Wake up all non-linked pads now that we advanced the high time */
       mq->high_time = next_time;
@@ -2130,7 +2384,7 @@ gst_multi_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
   }
 
-  if (!(gst_data_queue_push (sq->queue, (GstDataQueueItem *) item)))
+  if (!(single_queue_push (sq, (GstDataQueueItem *) item)))
     goto flushing;
 
   /* update time level, we must do this after pushing the data in the queue so
@@ -2313,7 +2567,7 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       "SingleQueue %d : Enqueuing event %p of type %s with id %d",
       sq->id, event, GST_EVENT_TYPE_NAME (event), curid);
 
-  if (!gst_data_queue_push (sq->queue, (GstDataQueueItem *) item))
+  if (!single_queue_push (sq, (GstDataQueueItem *) item))
     goto flushing;
 
   /* mark EOS when we received one, we must do that after putting the
@@ -2324,7 +2578,7 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       GST_MULTI_QUEUE_MUTEX_LOCK (mq);
       update_buffering (mq, sq);
       GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
-      single_queue_overrun_cb (sq->queue, sq);
+      single_queue_overrun (sq, FALSE);
       gst_multi_queue_post_buffering (mq);
       break;
     case GST_EVENT_EOS:
@@ -2346,7 +2600,9 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       GST_MULTI_QUEUE_MUTEX_LOCK (mq);
       update_buffering (mq, sq);
       GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
-      single_queue_overrun_cb (sq->queue, sq);
+      single_queue_overrun (sq, FALSE);
+      /* nothing is pushed after EOS, so no wait may stay open */
+      single_queue_wait_full_done (sq);
       gst_multi_queue_post_buffering (mq);
       break;
     case GST_EVENT_SEGMENT:
@@ -2428,7 +2684,7 @@ gst_multi_queue_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
               "SingleQueue %d : Enqueuing query %p of type %s with id %d",
               sq->id, query, GST_QUERY_TYPE_NAME (query), curid);
           GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
-          res = gst_data_queue_push (sq->queue, (GstDataQueueItem *) item);
+          res = single_queue_push (sq, (GstDataQueueItem *) item);
           GST_MULTI_QUEUE_MUTEX_LOCK (mq);
           if (!res || sq->flushing)
             goto out_flushing;
@@ -2540,20 +2796,129 @@ gst_multi_queue_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
  * Next-non-linked functions
  */
 
+/* The not-linked queues that sleep until it is their turn are kept in a
+ * binary min-heap ordered by their nextid. The nextid of a queue does not
+ * change while it sleeps, so the queues to wake up for a given highid are
+ * found without looking at the other queues. */
+
+#define WAITING_HEAP_SQ(mq,i) \
+    ((GstSingleQueue *) g_ptr_array_index ((mq)->waiting, (i)))
+
+static inline void
+waiting_heap_set (GstMultiQueue * mq, guint i, GstSingleQueue * sq)
+{
+  g_ptr_array_index (mq->waiting, i) = sq;
+  sq->waiting_index = i;
+}
+
+static void
+waiting_heap_sift_up (GstMultiQueue * mq, guint i)
+{
+  GstSingleQueue *sq = WAITING_HEAP_SQ (mq, i);
+
+  while (i > 0) {
+    guint parent = (i - 1) / 2;
+    GstSingleQueue *psq = WAITING_HEAP_SQ (mq, parent);
+
+    if (psq->nextid <= sq->nextid)
+      break;
+    waiting_heap_set (mq, i, psq);
+    i = parent;
+  }
+  waiting_heap_set (mq, i, sq);
+}
+
+static void
+waiting_heap_sift_down (GstMultiQueue * mq, guint i)
+{
+  GstSingleQueue *sq = WAITING_HEAP_SQ (mq, i);
+  guint len = mq->waiting->len;
+
+  while (TRUE) {
+    guint child = 2 * i + 1;
+    GstSingleQueue *csq;
+
+    if (child >= len)
+      break;
+    if (child + 1 < len && WAITING_HEAP_SQ (mq, child + 1)->nextid <
+        WAITING_HEAP_SQ (mq, child)->nextid)
+      child++;
+    csq = WAITING_HEAP_SQ (mq, child);
+    if (sq->nextid <= csq->nextid)
+      break;
+    waiting_heap_set (mq, i, csq);
+    i = child;
+  }
+  waiting_heap_set (mq, i, sq);
+}
+
+/* WITH LOCK TAKEN */
+static void
+waiting_heap_push (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  g_ptr_array_add (mq->waiting, sq);
+  waiting_heap_sift_up (mq, mq->waiting->len - 1);
+}
+
+/* WITH LOCK TAKEN */
+static void
+waiting_heap_remove (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  guint i = sq->waiting_index;
+  GstSingleQueue *last;
+
+  g_assert (sq->waiting_index >= 0);
+
+  last = g_ptr_array_remove_index (mq->waiting, mq->waiting->len - 1);
+  sq->waiting_index = -1;
+  if (last == sq)
+    return;
+
+  waiting_heap_set (mq, i, last);
+  if (i > 0 && WAITING_HEAP_SQ (mq, (i - 1) / 2)->nextid > last->nextid)
+    waiting_heap_sift_up (mq, i);
+  else
+    waiting_heap_sift_down (mq, i);
+}
+
+/* signal all waiting queues in the subtree at @i with a nextid up to
+ * @highid, the subtrees of the other queues only contain higher ids */
+static void
+waiting_heap_wake_up_to (GstMultiQueue * mq, guint i, guint32 highid)
+{
+  GstSingleQueue *sq;
+
+  if (i >= mq->waiting->len)
+    return;
+
+  sq = WAITING_HEAP_SQ (mq, i);
+  if (sq->nextid > highid)
+    return;
+
+  if (sq->srcresult == GST_FLOW_NOT_LINKED) {
+    GST_LOG_OBJECT (mq, "Waking up singlequeue %d", sq->id);
+    g_cond_signal (&sq->turn);
+  }
+
+  waiting_heap_wake_up_to (mq, 2 * i + 1, highid);
+  waiting_heap_wake_up_to (mq, 2 * i + 2, highid);
+}
+
 /* WITH LOCK TAKEN */
 static void
 wake_up_next_non_linked (GstMultiQueue * mq)
 {
-  GList *tmp;
+  guint i;
 
   /* maybe no-one is waiting */
   if (mq->numwaiting < 1)
     return;
 
   if (mq->sync_by_running_time && GST_CLOCK_STIME_IS_VALID (mq->high_time)) {
-    /* Else figure out which singlequeue(s) need waking up */
-    for (tmp = mq->queues; tmp; tmp = tmp->next) {
-      GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
+    /* Else figure out which singlequeue(s) need waking up, the high time
+     * depends on the group so all waiting queues need to be checked */
+    for (i = 0; i < mq->waiting->len; i++) {
+      GstSingleQueue *sq = WAITING_HEAP_SQ (mq, i);
       if (sq->srcresult == GST_FLOW_NOT_LINKED) {
         GstClockTimeDiff high_time;
 
@@ -2571,15 +2936,8 @@ wake_up_next_non_linked (GstMultiQueue * mq)
       }
     }
   } else {
-    /* Else figure out which singlequeue(s) need waking up */
-    for (tmp = mq->queues; tmp; tmp = tmp->next) {
-      GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
-      if (sq->srcresult == GST_FLOW_NOT_LINKED &&
-          sq->nextid != 0 && sq->nextid <= mq->highid) {
-        GST_LOG_OBJECT (mq, "Waking up singlequeue %d", sq->id);
-        g_cond_signal (&sq->turn);
-      }
-    }
+    /* Else wake up the singlequeue(s) whose turn it is */
+    waiting_heap_wake_up_to (mq, 0, mq->highid);
   }
 }
 
@@ -2724,21 +3082,40 @@ compute_high_time (GstMultiQueue * mq, guint groupid)
 /*
  * GstSingleQueue functions
  */
+
+/* cur_time can be updated by the streaming threads with only the single
+ * queue lock, take it so that the 64 bits value doesn't tear */
+static GstClockTime
+get_cur_time (GstSingleQueue * sq)
+{
+  GstClockTime cur_time;
+
+  GST_SINGLE_QUEUE_MUTEX_LOCK (sq);
+  cur_time = sq->cur_time;
+  GST_SINGLE_QUEUE_MUTEX_UNLOCK (sq);
+
+  return cur_time;
+}
+
+/* signals the overrun when @sq is filled, @blocking is TRUE when this is
+ * called from the data queue because the push is about to wait */
 static void
-single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
+single_queue_overrun (GstSingleQueue * sq, gboolean blocking)
 {
   GstMultiQueue *mq = sq->mqueue;
   GList *tmp;
   GstDataQueueSize size;
+  GstClockTime cur_time;
   gboolean filled = TRUE;
   gboolean empty_found = FALSE;
 
   gst_data_queue_get_level (sq->queue, &size);
+  cur_time = get_cur_time (sq);
 
   GST_LOG_OBJECT (mq,
       "Single Queue %d: EOS %d, visible %u/%u, bytes %u/%u, time %"
       G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT, sq->id, sq->is_eos, size.visible,
-      sq->max_size.visible, size.bytes, sq->max_size.bytes, sq->cur_time,
+      sq->max_size.visible, size.bytes, sq->max_size.bytes, cur_time,
       sq->max_size.time);
 
   GST_MULTI_QUEUE_MUTEX_LOCK (mq);
@@ -2746,7 +3123,7 @@ single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
   /* check if we reached the hard time/bytes limits;
      time limit is only taken into account for non-sparse streams */
   if (sq->is_eos || IS_FILLED (sq, bytes, size.bytes) ||
-      (!sq->is_sparse && IS_FILLED (sq, time, sq->cur_time))) {
+      (!sq->is_sparse && IS_FILLED (sq, time, cur_time))) {
     goto done;
   }
 
@@ -2788,10 +3165,20 @@ done:
   /* Overrun is always forwarded, since this is blocking the upstream element */
   if (filled) {
     GST_DEBUG_OBJECT (mq, "Queue %d is filled, signalling overrun", sq->id);
+    if (blocking && !sq->wait_full_traced) {
+      sq->wait_full_traced = TRUE;
+      gst_tracing_queue_wait_pre (GST_ELEMENT_CAST (mq), sq->srcpad, TRUE);
+    }
     g_signal_emit (mq, gst_multi_queue_signals[SIGNAL_OVERRUN], 0);
   }
 }
 
+static void
+single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
+{
+  single_queue_overrun (sq, TRUE);
+}
+
 static void
 single_queue_underrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
 {
@@ -2799,6 +3186,11 @@ single_queue_underrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
   GstMultiQueue *mq = sq->mqueue;
   GList *tmp;
 
+  if (!sq->wait_empty_traced) {
+    sq->wait_empty_traced = TRUE;
+    gst_tracing_queue_wait_pre (GST_ELEMENT_CAST (mq), sq->srcpad, FALSE);
+  }
+
   if (sq->srcresult == GST_FLOW_NOT_LINKED) {
     GST_LOG_OBJECT (mq, "Single Queue %d is empty but not-linked", sq->id);
     return;
@@ -2840,11 +3232,15 @@ single_queue_check_full (GstDataQueue * dataq, guint visible, guint bytes,
 {
   gboolean res;
   GstMultiQueue *mq = sq->mqueue;
+  GstClockTime cur_time = get_cur_time (sq);
 
   GST_DEBUG_OBJECT (mq,
       "queue %d: visible %u/%u, bytes %u/%u, time %" G_GUINT64_FORMAT "/%"
       G_GUINT64_FORMAT, sq->id, visible, sq->max_size.visible, bytes,
-      sq->max_size.bytes, sq->cur_time, sq->max_size.time);
+      sq->max_size.bytes, cur_time, sq->max_size.time);
+
+  gst_tracing_queue_level (GST_ELEMENT_CAST (mq), sq->srcpad, visible, bytes,
+      cur_time);
 
   /* we are always filled on EOS */
   if (sq->is_eos || sq->is_segment_done)
@@ -2861,17 +3257,95 @@ single_queue_check_full (GstDataQueue * dataq, guint visible, guint bytes,
   if (!sq->is_sparse || !mq->sync_by_running_time) {
     /* If unlinked, take into account the extra unlinked cache time */
     if (mq->sync_by_running_time && sq->srcresult == GST_FLOW_NOT_LINKED) {
-      if (sq->cur_time > mq->unlinked_cache_time)
-        res |= IS_FILLED (sq, time, sq->cur_time - mq->unlinked_cache_time);
+      if (cur_time > mq->unlinked_cache_time)
+        res |= IS_FILLED (sq, time, cur_time - mq->unlinked_cache_time);
       else
         res = FALSE;
     } else
-      res |= IS_FILLED (sq, time, sq->cur_time);
+      res |= IS_FILLED (sq, time, cur_time);
+  }
+
+  return res;
+}
+
+/* push @item into the data queue, telling the tracers when the push had to
+ * wait in single_queue_overrun_cb() */
+static gboolean
+single_queue_push (GstSingleQueue * sq, GstDataQueueItem * item)
+{
+  gboolean res;
+
+  res = gst_data_queue_push (sq->queue, item);
+  single_queue_wait_full_done (sq);
+  if (res && g_atomic_int_get (&sq->suspended)) {
+    GstTask *task;
+
+    GST_OBJECT_LOCK (sq->srcpad);
+    if ((task = GST_PAD_TASK (sq->srcpad)))
+      gst_task_wakeup (task);
+    GST_OBJECT_UNLOCK (sq->srcpad);
   }
+  return res;
+}
+
+/* tells the tracers that a traced wait for a full queue ended */
+static void
+single_queue_wait_full_done (GstSingleQueue * sq)
+{
+  if (sq->wait_full_traced) {
+    sq->wait_full_traced = FALSE;
+    gst_tracing_queue_wait_post (GST_ELEMENT_CAST (sq->mqueue), sq->srcpad,
+        TRUE);
+  }
+}
 
+/* pop @item from the data queue, telling the tracers when the pop had to wait
+ * in single_queue_underrun_cb() */
+static gboolean
+single_queue_pop (GstSingleQueue * sq, GstDataQueueItem ** item)
+{
+  gboolean res;
+
+  res = gst_data_queue_pop (sq->queue, item);
+  if (sq->wait_empty_traced) {
+    sq->wait_empty_traced = FALSE;
+    gst_tracing_queue_wait_post (GST_ELEMENT_CAST (sq->mqueue), sq->srcpad,
+        FALSE);
+  }
   return res;
 }
 
+/* suspend the cooperative srcpad task instead of waiting in
+ * single_queue_pop() when the data queue is empty, called from the task.
+ * Returns TRUE when the task function has to return */
+static gboolean
+single_queue_suspend (GstSingleQueue * sq)
+{
+  GstTask *task = GST_PAD_TASK (sq->srcpad);
+
+  if (!gst_data_queue_is_empty (sq->queue)) {
+    g_atomic_int_set (&sq->suspended, FALSE);
+    return FALSE;
+  }
+
+  if (!gst_task_suspend (task))
+    return FALSE;
+
+  /* when we were suspended already, underrun was signaled */
+  if (!g_atomic_int_get (&sq->suspended)) {
+    single_queue_underrun_cb (sq->queue, sq);
+    g_atomic_int_set (&sq->suspended, TRUE);
+  }
+
+  /* single_queue_push() only wakes up the task from now on, recheck for
+   * something pushed in the meantime */
+  if (!gst_data_queue_is_empty (sq->queue))
+    gst_task_wakeup (task);
+
+  GST_LOG_OBJECT (sq->mqueue, "SingleQueue %d : suspended task", sq->id);
+  return TRUE;
+}
+
 static void
 gst_single_queue_flush_queue (GstSingleQueue * sq, gboolean full)
 {
@@ -2924,6 +3398,7 @@ gst_single_queue_free (GstSingleQueue * sq)
   g_object_unref (sq->queue);
   g_cond_clear (&sq->turn);
   g_cond_clear (&sq->query_handled);
+  g_mutex_clear (&sq->lock);
   g_free (sq);
 }
 
@@ -2985,6 +3460,7 @@ gst_single_queue_new (GstMultiQueue * mqueue, guint id)
       single_queue_check_full,
       (GstDataQueueFullCallback) single_queue_overrun_cb,
       (GstDataQueueEmptyCallback) single_queue_underrun_cb, sq);
+  g_object_set (sq->queue, "spin-time", mqueue->spin_time, NULL);
   sq->is_eos = FALSE;
   sq->is_sparse = FALSE;
   sq->flushing = FALSE;
@@ -2994,9 +3470,11 @@ gst_single_queue_new (GstMultiQueue * mqueue, guint id)
 
   sq->nextid = 0;
   sq->oldid = 0;
+  sq->waiting_index = -1;
   sq->next_time = GST_CLOCK_STIME_NONE;
   sq->last_time = GST_CLOCK_STIME_NONE;
   g_cond_init (&sq->turn);
+  g_mutex_init (&sq->lock);
   g_cond_init (&sq->query_handled);
 
   sq->sinktime = GST_CLOCK_STIME_NONE;
@@ -79,6 +79,7 @@ struct _GstMultiQueue {
 			/* GstMultiQueueSize, counter and highid */
 
   gint numwaiting;	/* number of not-linked pads waiting */
+  GPtrArray *waiting;	/* heap of the waiting not-linked queues by nextid */
 
   gboolean buffering_percent_changed;
   GMutex buffering_post_lock; /* assures only one posted at a time */
@@ -87,6 +88,11 @@ struct _GstMultiQueue {
   GstClockTimeDiff last_interleave_update;
 
   GstClockTime unlinked_cache_time;
+
+  GstClockTime spin_time;	/* time to spin before waiting for data */
+
+  GstTaskSchedulingPolicy thread_scheduling;	/* of the srcpad tasks */
+  gint thread_priority;
 };
 
 struct _GstMultiQueueClass {
@@ -23,6 +23,8 @@
  * @see_also: #GstOutputSelector, #GstInputSelector
  *
  * Direct input stream to one out of N output pads.
+ *
+ * Buffer lists are forwarded to the active pad as a whole.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -97,6 +99,8 @@ static void gst_output_selector_release_pad (GstElement * element,
     GstPad * pad);
 static GstFlowReturn gst_output_selector_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buf);
+static GstFlowReturn gst_output_selector_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static GstStateChangeReturn gst_output_selector_change_state (GstElement *
     element, GstStateChange transition);
 static gboolean gst_output_selector_event (GstPad * pad, GstObject * parent,
@@ -157,6 +161,8 @@ gst_output_selector_init (GstOutputSelector * sel)
       "sink");
   gst_pad_set_chain_function (sel->sinkpad,
       GST_DEBUG_FUNCPTR (gst_output_selector_chain));
+  gst_pad_set_chain_list_function (sel->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_output_selector_chain_list));
   gst_pad_set_event_function (sel->sinkpad,
       GST_DEBUG_FUNCPTR (gst_output_selector_event));
   gst_pad_set_query_function (sel->sinkpad,
@@ -189,7 +195,9 @@ gst_output_selector_reset (GstOutputSelector * osel)
     gst_buffer_unref (osel->latest_buffer);
     osel->latest_buffer = NULL;
   }
+  g_atomic_int_inc (&osel->active_cookie);
   GST_OBJECT_UNLOCK (osel);
+  gst_object_replace ((GstObject **) & osel->cached_srcpad, NULL);
   gst_segment_init (&osel->segment, GST_FORMAT_UNDEFINED);
 }
 
@@ -236,6 +244,7 @@ gst_output_selector_set_property (GObject * object, guint prop_id,
           sel->pending_srcpad = NULL;
         }
       }
+      g_atomic_int_inc (&sel->active_cookie);
       GST_OBJECT_UNLOCK (object);
       break;
     }
@@ -297,6 +306,25 @@ gst_output_selector_get_active (GstOutputSelector * sel)
   return active;
 }
 
+/* must be called from the streaming thread */
+static GstPad *
+gst_output_selector_get_cached_active (GstOutputSelector * osel)
+{
+  gint cookie = g_atomic_int_get (&osel->active_cookie);
+
+  if (G_UNLIKELY (cookie != osel->cached_cookie)) {
+    GstPad *active = gst_output_selector_get_active (osel);
+
+    gst_object_replace ((GstObject **) & osel->cached_srcpad,
+        (GstObject *) active);
+    if (active)
+      gst_object_unref (active);
+    osel->cached_cookie = cookie;
+  }
+
+  return osel->cached_srcpad;
+}
+
 static void
 gst_output_selector_switch_pad_negotiation_mode (GstOutputSelector * sel,
     gint mode)
@@ -342,6 +370,7 @@ gst_output_selector_request_new_pad (GstElement * element,
   GST_OBJECT_LOCK (osel);
   if (osel->active_srcpad == NULL) {
     osel->active_srcpad = srcpad;
+    g_atomic_int_inc (&osel->active_cookie);
     GST_OBJECT_UNLOCK (osel);
     g_object_notify (G_OBJECT (osel), "active-pad");
   } else {
@@ -365,6 +394,7 @@ gst_output_selector_release_pad (GstElement * element, GstPad * pad)
   GST_OBJECT_LOCK (osel);
   if (osel->active_srcpad == pad) {
     osel->active_srcpad = NULL;
+    g_atomic_int_inc (&osel->active_cookie);
     GST_OBJECT_UNLOCK (osel);
     g_object_notify (G_OBJECT (osel), "active-pad");
   } else {
@@ -399,6 +429,7 @@ gst_output_selector_switch (GstOutputSelector * osel)
   }
   gst_object_unref (osel->pending_srcpad);
   osel->pending_srcpad = NULL;
+  g_atomic_int_inc (&osel->active_cookie);
   active_srcpad = res ? gst_object_ref (osel->active_srcpad) : NULL;
   GST_OBJECT_UNLOCK (osel);
 
@@ -452,14 +483,13 @@ gst_output_selector_switch (GstOutputSelector * osel)
 }
 
 static GstFlowReturn
-gst_output_selector_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+gst_output_selector_chain_object (GstOutputSelector * osel, gboolean is_list,
+    GstMiniObject * obj)
 {
   GstFlowReturn res;
-  GstOutputSelector *osel;
   GstClockTime position, duration;
   GstPad *active_srcpad;
-
-  osel = GST_OUTPUT_SELECTOR (parent);
+  GstBuffer *buf;
 
   /*
    * The _switch function might push a buffer if 'resend-latest' is true.
@@ -477,28 +507,41 @@ gst_output_selector_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     gst_output_selector_switch (osel);
   }
 
-  active_srcpad = gst_output_selector_get_active (osel);
+  active_srcpad = gst_output_selector_get_cached_active (osel);
   if (!active_srcpad) {
     GST_DEBUG_OBJECT (osel, "No active srcpad");
-    gst_buffer_unref (buf);
+    gst_mini_object_unref (obj);
     return GST_FLOW_OK;
   }
 
-  GST_OBJECT_LOCK (osel);
-  if (osel->latest_buffer) {
-    gst_buffer_unref (osel->latest_buffer);
-    osel->latest_buffer = NULL;
+  /* the last buffer of a list is the one to resend and gives the position */
+  if (is_list) {
+    GstBufferList *list = GST_BUFFER_LIST_CAST (obj);
+    guint len = gst_buffer_list_length (list);
+
+    buf = len > 0 ? gst_buffer_list_get (list, len - 1) : NULL;
+  } else {
+    buf = GST_BUFFER_CAST (obj);
   }
 
-  if (osel->resend_latest) {
-    /* Keep reference to latest buffer to resend it after switch */
-    osel->latest_buffer = gst_buffer_ref (buf);
+  /* only written from the streaming thread */
+  if (osel->resend_latest || osel->latest_buffer) {
+    GST_OBJECT_LOCK (osel);
+    if (osel->latest_buffer) {
+      gst_buffer_unref (osel->latest_buffer);
+      osel->latest_buffer = NULL;
+    }
+
+    if (osel->resend_latest && buf) {
+      /* Keep reference to latest buffer to resend it after switch */
+      osel->latest_buffer = gst_buffer_ref (buf);
+    }
+    GST_OBJECT_UNLOCK (osel);
   }
-  GST_OBJECT_UNLOCK (osel);
 
   /* Keep track of last stop and use it in SEGMENT start after
      switching to a new src pad */
-  position = GST_BUFFER_TIMESTAMP (buf);
+  position = buf ? GST_BUFFER_TIMESTAMP (buf) : GST_CLOCK_TIME_NONE;
   if (GST_CLOCK_TIME_IS_VALID (position)) {
     duration = GST_BUFFER_DURATION (buf);
     if (GST_CLOCK_TIME_IS_VALID (duration)) {
@@ -509,14 +552,31 @@ gst_output_selector_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     osel->segment.position = position;
   }
 
-  GST_LOG_OBJECT (osel, "pushing buffer to %" GST_PTR_FORMAT, active_srcpad);
-  res = gst_pad_push (active_srcpad, buf);
-
-  gst_object_unref (active_srcpad);
+  GST_LOG_OBJECT (osel, "pushing buffer%s to %" GST_PTR_FORMAT,
+      is_list ? " list" : "", active_srcpad);
+  if (is_list)
+    res = gst_pad_push_list (active_srcpad, GST_BUFFER_LIST_CAST (obj));
+  else
+    res = gst_pad_push (active_srcpad, GST_BUFFER_CAST (obj));
 
   return res;
 }
 
+static GstFlowReturn
+gst_output_selector_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  return gst_output_selector_chain_object (GST_OUTPUT_SELECTOR (parent), FALSE,
+      GST_MINI_OBJECT_CAST (buf));
+}
+
+static GstFlowReturn
+gst_output_selector_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  return gst_output_selector_chain_object (GST_OUTPUT_SELECTOR (parent), TRUE,
+      GST_MINI_OBJECT_CAST (list));
+}
+
 static GstStateChangeReturn
 gst_output_selector_change_state (GstElement * element,
     GstStateChange transition)
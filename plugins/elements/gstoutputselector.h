@@ -55,6 +55,11 @@ struct _GstOutputSelector {
   gboolean resend_latest;
   GstBuffer *latest_buffer;
 
+  /* incremented when the active or pending pad changes, the streaming
+   * thread only takes the lock to update its cached pad then */
+  gint active_cookie;
+  gint cached_cookie;
+  GstPad *cached_srcpad;
 };
 
 struct _GstOutputSelectorClass {
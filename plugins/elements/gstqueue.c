@@ -121,13 +121,27 @@ enum
   PROP_MIN_THRESHOLD_TIME,
   PROP_LEAKY,
   PROP_SILENT,
-  PROP_FLUSH_ON_EOS
+  PROP_FLUSH_ON_EOS,
+  PROP_MAX_BATCH_BUFFERS,
+  PROP_MAX_BATCH_BYTES,
+  PROP_MAX_DRAIN_BUFFERS,
+  PROP_SPIN_TIME,
+  PROP_SPIN_HITS,
+  PROP_SPIN_BLOCKS,
+  PROP_THREAD_SCHEDULING,
+  PROP_THREAD_PRIORITY
 };
 
 /* default property values */
 #define DEFAULT_MAX_SIZE_BUFFERS  200   /* 200 buffers */
 #define DEFAULT_MAX_SIZE_BYTES    (10 * 1024 * 1024)    /* 10 MB       */
 #define DEFAULT_MAX_SIZE_TIME     GST_SECOND    /* 1 second    */
+#define DEFAULT_MAX_BATCH_BUFFERS 0     /* no batching */
+#define DEFAULT_MAX_BATCH_BYTES   0     /* no limit    */
+#define DEFAULT_MAX_DRAIN_BUFFERS 0     /* no draining */
+#define DEFAULT_SPIN_TIME         0     /* no spinning */
+#define DEFAULT_THREAD_SCHEDULING GST_TASK_SCHEDULING_DEFAULT
+#define DEFAULT_THREAD_PRIORITY   0
 
 #define GST_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
   g_mutex_lock (&q->qlock);                                              \
@@ -146,7 +160,9 @@ enum
 #define GST_QUEUE_WAIT_DEL_CHECK(q, label) G_STMT_START {               \
   STATUS (q, q->sinkpad, "wait for DEL");                               \
   q->waiting_del = TRUE;                                                \
+  gst_tracing_queue_wait_pre (GST_ELEMENT_CAST (q), q->srcpad, TRUE);   \
   g_cond_wait (&q->item_del, &q->qlock);                                  \
+  gst_tracing_queue_wait_post (GST_ELEMENT_CAST (q), q->srcpad, TRUE);  \
   q->waiting_del = FALSE;                                               \
   if (q->srcresult != GST_FLOW_OK) {                                    \
     STATUS (q, q->srcpad, "received DEL wakeup");                       \
@@ -158,7 +174,9 @@ enum
 #define GST_QUEUE_WAIT_ADD_CHECK(q, label) G_STMT_START {               \
   STATUS (q, q->srcpad, "wait for ADD");                                \
   q->waiting_add = TRUE;                                                \
+  gst_tracing_queue_wait_pre (GST_ELEMENT_CAST (q), q->srcpad, FALSE);  \
   g_cond_wait (&q->item_add, &q->qlock);                                  \
+  gst_tracing_queue_wait_post (GST_ELEMENT_CAST (q), q->srcpad, FALSE); \
   q->waiting_add = FALSE;                                               \
   if (q->srcresult != GST_FLOW_OK) {                                    \
     STATUS (q, q->srcpad, "received ADD wakeup");                       \
@@ -167,6 +185,11 @@ enum
   STATUS (q, q->srcpad, "received ADD");                                \
 } G_STMT_END
 
+/* report the current level to the tracers */
+#define GST_QUEUE_TRACE_LEVEL(q)                                        \
+  gst_tracing_queue_level (GST_ELEMENT_CAST (q), q->srcpad,             \
+      q->cur_level.buffers, q->cur_level.bytes, q->cur_level.time)
+
 #define GST_QUEUE_SIGNAL_DEL(q) G_STMT_START {                          \
   if (q->waiting_del) {                                                 \
     STATUS (q, q->srcpad, "signal DEL");                                \
@@ -175,12 +198,28 @@ enum
 } G_STMT_END
 
 #define GST_QUEUE_SIGNAL_ADD(q) G_STMT_START {                          \
+  g_atomic_int_inc (&q->add_cookie);                                    \
   if (q->waiting_add) {                                                 \
     STATUS (q, q->sinkpad, "signal ADD");                               \
     g_cond_signal (&q->item_add);                                        \
+  } else if (q->suspended_add) {                                        \
+    STATUS (q, q->sinkpad, "wakeup ADD");                               \
+    gst_queue_wakeup_task (q);                                          \
   }                                                                     \
 } G_STMT_END
 
+/* wake up the suspended cooperative task of the srcpad, with QUEUE_LOCK */
+static inline void
+gst_queue_wakeup_task (GstQueue * queue)
+{
+  GstTask *task;
+
+  GST_OBJECT_LOCK (queue->srcpad);
+  if ((task = GST_PAD_TASK (queue->srcpad)))
+    gst_task_wakeup (task);
+  GST_OBJECT_UNLOCK (queue->srcpad);
+}
+
 #define _do_init \
     GST_DEBUG_CATEGORY_INIT (queue_debug, "queue", 0, "queue element"); \
     GST_DEBUG_CATEGORY_INIT (queue_dataflow, "queue_dataflow", 0, \
@@ -200,6 +239,8 @@ static GstFlowReturn gst_queue_chain_list (GstPad * pad, GstObject * parent,
     GstBufferList * buffer_list);
 static GstFlowReturn gst_queue_push_one (GstQueue * queue);
 static void gst_queue_loop (GstPad * pad);
+static gboolean gst_queue_start_task (GstQueue * queue);
+static void gst_queue_configure_task (GstQueue * queue);
 
 static GstFlowReturn gst_queue_handle_sink_event (GstPad * pad,
     GstObject * parent, GstEvent * event);
@@ -403,6 +444,129 @@ gst_queue_class_init (GstQueueClass * klass)
           G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
           G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue:max-batch-buffers
+   *
+   * Push up to this many consecutive buffers that are already queued
+   * downstream together in one buffer list. This saves a round-trip through
+   * the queue per buffer and lets elements that implement a chain_list
+   * function handle the buffers at once. 0 or 1 pushes every buffer on its
+   * own, which is the default behaviour.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BATCH_BUFFERS,
+      g_param_spec_uint ("max-batch-buffers", "Max. batch buffers",
+          "Max. number of queued buffers to push together in a buffer list "
+          "(0=disable)", 0, G_MAXUINT, DEFAULT_MAX_BATCH_BUFFERS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:max-batch-bytes
+   *
+   * Limit the buffer lists pushed with #GstQueue:max-batch-buffers to this
+   * many bytes. A buffer that is bigger than this is still pushed on its own.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BATCH_BYTES,
+      g_param_spec_uint ("max-batch-bytes", "Max. batch bytes",
+          "Max. amount of data in a pushed buffer list (in bytes, 0=no limit)",
+          0, G_MAXUINT, DEFAULT_MAX_BATCH_BYTES,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:max-drain-buffers
+   *
+   * Take up to this many consecutive buffers out of the queue at once and
+   * push them downstream one by one without going through the queue lock
+   * for each of them. With one upstream and one downstream thread this
+   * avoids contending on the lock for every buffer while the queue is
+   * neither empty nor full. The drained buffers no longer count towards the
+   * queue levels. This property has no effect when
+   * #GstQueue:max-batch-buffers is enabled.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_DRAIN_BUFFERS,
+      g_param_spec_uint ("max-drain-buffers", "Max. drain buffers",
+          "Max. number of queued buffers to dequeue at once and push one by "
+          "one (0=disable)", 0, G_MAXUINT, DEFAULT_MAX_DRAIN_BUFFERS,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:spin-time
+   *
+   * When the streaming thread finds the queue empty, busy-wait up to this
+   * time for new data before blocking. This trades CPU usage for a lower
+   * wakeup latency with high packet rates. 0 disables spinning.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_TIME,
+      g_param_spec_uint64 ("spin-time", "Spin time",
+          "Time to busy-wait for data before blocking in nanoseconds "
+          "(0 = disabled)", 0, G_MAXINT64, DEFAULT_SPIN_TIME,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:spin-hits
+   *
+   * The number of waits for data that ended while spinning.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_HITS,
+      g_param_spec_uint64 ("spin-hits", "Spin hits",
+          "Number of waits for data that ended while spinning", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:spin-blocks
+   *
+   * The number of waits for data that had to block.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_SPIN_BLOCKS,
+      g_param_spec_uint64 ("spin-blocks", "Spin blocks",
+          "Number of waits for data that had to block", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:thread-scheduling
+   *
+   * The scheduling policy of the streaming thread that pushes the data out
+   * of the queue. With a realtime policy a branch of the pipeline, like a
+   * low-latency audio output, can be prioritized over the other threads.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_THREAD_SCHEDULING,
+      g_param_spec_enum ("thread-scheduling", "Thread scheduling",
+          "Scheduling policy of the streaming thread of the queue",
+          GST_TYPE_TASK_SCHEDULING_POLICY, DEFAULT_THREAD_SCHEDULING,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:thread-priority
+   *
+   * The realtime priority of the streaming thread of the queue when
+   * #GstQueue:thread-scheduling is a realtime policy.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_THREAD_PRIORITY,
+      g_param_spec_int ("thread-priority", "Thread priority",
+          "Realtime priority of the streaming thread of the queue", 0, 99,
+          DEFAULT_THREAD_PRIORITY, G_PARAM_READWRITE |
+          GST_PARAM_MUTABLE_PLAYING | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_queue_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -456,6 +620,12 @@ gst_queue_init (GstQueue * queue)
 
   queue->leaky = GST_QUEUE_NO_LEAK;
   queue->srcresult = GST_FLOW_FLUSHING;
+  queue->max_batch_buffers = DEFAULT_MAX_BATCH_BUFFERS;
+  queue->max_batch_bytes = DEFAULT_MAX_BATCH_BYTES;
+  queue->max_drain_buffers = DEFAULT_MAX_DRAIN_BUFFERS;
+  queue->spin_time = DEFAULT_SPIN_TIME;
+  queue->thread_scheduling = DEFAULT_THREAD_SCHEDULING;
+  queue->thread_priority = DEFAULT_THREAD_PRIORITY;
 
   g_mutex_init (&queue->qlock);
   g_cond_init (&queue->item_add);
@@ -725,6 +895,7 @@ gst_queue_locked_flush (GstQueue * queue, gboolean full)
   queue->sink_tainted = queue->src_tainted = TRUE;
 
   /* we deleted a lot of something */
+  GST_QUEUE_TRACE_LEVEL (queue);
   GST_QUEUE_SIGNAL_DEL (queue);
 }
 
@@ -745,6 +916,7 @@ gst_queue_locked_enqueue_buffer (GstQueue * queue, gpointer item)
   qitem.is_query = FALSE;
   qitem.size = bsize;
   gst_queue_array_push_tail_struct (queue->queue, &qitem);
+  GST_QUEUE_TRACE_LEVEL (queue);
   GST_QUEUE_SIGNAL_ADD (queue);
 }
 
@@ -766,6 +938,7 @@ gst_queue_locked_enqueue_buffer_list (GstQueue * queue, gpointer item)
   qitem.is_query = FALSE;
   qitem.size = bsize;
   gst_queue_array_push_tail_struct (queue->queue, &qitem);
+  GST_QUEUE_TRACE_LEVEL (queue);
   GST_QUEUE_SIGNAL_ADD (queue);
 }
 
@@ -890,6 +1063,7 @@ gst_queue_locked_dequeue (GstQueue * queue)
         item, GST_OBJECT_NAME (queue));
     item = NULL;
   }
+  GST_QUEUE_TRACE_LEVEL (queue);
   GST_QUEUE_SIGNAL_DEL (queue);
 
   return item;
@@ -902,6 +1076,44 @@ no_item:
   }
 }
 
+/* dequeue the buffers that directly follow @buffer in the queue and collect
+ * them together with @buffer in one buffer list of at most @max_buffers
+ * buffers and @max_bytes bytes (0 = no limit), with QUEUE_LOCK */
+static GstBufferList *
+gst_queue_locked_dequeue_batch (GstQueue * queue, GstBuffer * buffer,
+    guint max_buffers, guint max_bytes)
+{
+  GstBufferList *buffer_list;
+  gsize bytes;
+
+  /* max_buffers can be G_MAXUINT, never size the list larger than what is
+   * queued */
+  buffer_list = gst_buffer_list_new_sized (MIN (max_buffers,
+          gst_queue_array_get_length (queue->queue) + 1));
+  gst_buffer_list_add (buffer_list, buffer);
+  bytes = gst_buffer_get_size (buffer);
+
+  while (gst_buffer_list_length (buffer_list) < max_buffers) {
+    GstQueueItem *qitem;
+
+    qitem = gst_queue_array_peek_head_struct (queue->queue);
+    if (qitem == NULL || !GST_IS_BUFFER (qitem->item))
+      break;
+    if (max_bytes && bytes + qitem->size > max_bytes)
+      break;
+
+    bytes += qitem->size;
+    gst_buffer_list_add (buffer_list,
+        GST_BUFFER_CAST (gst_queue_locked_dequeue (queue)));
+  }
+
+  GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+      "batched %u buffers, %" G_GSIZE_FORMAT " bytes",
+      gst_buffer_list_length (buffer_list), bytes);
+
+  return buffer_list;
+}
+
 static GstFlowReturn
 gst_queue_handle_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -949,8 +1161,7 @@ gst_queue_handle_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       queue->eos = FALSE;
       queue->unexpected = FALSE;
       if (gst_pad_is_active (queue->srcpad)) {
-        gst_pad_start_task (queue->srcpad, (GstTaskFunction) gst_queue_loop,
-            queue->srcpad, NULL);
+        gst_queue_start_task (queue);
       } else {
         GST_INFO_OBJECT (queue->srcpad, "not re-starting task on srcpad, "
             "pad not active any longer");
@@ -1002,8 +1213,7 @@ gst_queue_handle_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
                 queue->srcresult = GST_FLOW_OK;
                 queue->eos = FALSE;
                 queue->unexpected = FALSE;
-                gst_pad_start_task (queue->srcpad,
-                    (GstTaskFunction) gst_queue_loop, queue->srcpad, NULL);
+                gst_queue_start_task (queue);
               } else {
                 queue->eos = FALSE;
                 queue->unexpected = FALSE;
@@ -1353,12 +1563,31 @@ gst_queue_push_one (GstQueue * queue)
   GstFlowReturn result = queue->srcresult;
   GstMiniObject *data;
   gboolean is_list;
+  gboolean drained = FALSE;
 
   data = gst_queue_locked_dequeue (queue);
   if (data == NULL)
     goto no_item;
 
 next:
+  /* push the buffers that are already queued together when batching */
+  if (GST_IS_BUFFER (data) && (queue->max_batch_buffers > 1 ||
+          queue->max_drain_buffers > 1)) {
+    GstQueueItem *qitem = gst_queue_array_peek_head_struct (queue->queue);
+
+    if (qitem != NULL && GST_IS_BUFFER (qitem->item)) {
+      if (queue->max_batch_buffers > 1) {
+        data = GST_MINI_OBJECT_CAST (gst_queue_locked_dequeue_batch (queue,
+                GST_BUFFER_CAST (data), queue->max_batch_buffers,
+                queue->max_batch_bytes));
+      } else {
+        data = GST_MINI_OBJECT_CAST (gst_queue_locked_dequeue_batch (queue,
+                GST_BUFFER_CAST (data), queue->max_drain_buffers, 0));
+        drained = TRUE;
+      }
+    }
+  }
+
   is_list = GST_IS_BUFFER_LIST (data);
 
   if (GST_IS_BUFFER (data) || is_list) {
@@ -1393,7 +1622,28 @@ next:
       }
 
       GST_QUEUE_MUTEX_UNLOCK (queue);
-      result = gst_pad_push_list (queue->srcpad, buffer_list);
+      if (drained) {
+        guint i, len;
+        gboolean writable;
+
+        /* push the drained buffers one by one without taking the lock, and
+         * hand them over when nobody else has the list */
+        len = gst_buffer_list_length (buffer_list);
+        writable = gst_buffer_list_is_writable (buffer_list);
+        result = GST_FLOW_OK;
+        for (i = 0; i < len && result == GST_FLOW_OK; i++) {
+          GstBuffer *buffer;
+
+          if (writable)
+            buffer = gst_buffer_list_take (buffer_list, 0);
+          else
+            buffer = gst_buffer_ref (gst_buffer_list_get (buffer_list, i));
+          result = gst_pad_push (queue->srcpad, buffer);
+        }
+        gst_buffer_list_unref (buffer_list);
+      } else {
+        result = gst_pad_push_list (queue->srcpad, buffer_list);
+      }
     }
 
     /* need to check for srcresult here as well */
@@ -1500,6 +1750,51 @@ out_flushing_query:
   }
 }
 
+/* busy-wait for at most the spin-time until something is added to the
+ * queue, without QUEUE_LOCK */
+static void
+gst_queue_spin_for_add (GstQueue * queue, gint cookie, GstClockTime spin_time)
+{
+  GstClockTime end = gst_util_get_timestamp () + spin_time;
+
+  while (g_atomic_int_get (&queue->add_cookie) == cookie
+      && gst_util_get_timestamp () < end);
+}
+
+/* configure the scheduling of the srcpad task, with the QUEUE_LOCK. The
+ * thread of a running task picks it up before the next call of the loop */
+static void
+gst_queue_configure_task (GstQueue * queue)
+{
+  GstTask *task;
+
+  GST_OBJECT_LOCK (queue->srcpad);
+  if ((task = GST_PAD_TASK (queue->srcpad)))
+    gst_object_ref (task);
+  GST_OBJECT_UNLOCK (queue->srcpad);
+
+  if (task == NULL)
+    return;
+
+  gst_task_set_scheduling (task, queue->thread_scheduling,
+      queue->thread_priority);
+  gst_object_unref (task);
+}
+
+/* with the QUEUE_LOCK */
+static gboolean
+gst_queue_start_task (GstQueue * queue)
+{
+  gboolean result;
+
+  result = gst_pad_start_task (queue->srcpad, (GstTaskFunction) gst_queue_loop,
+      queue->srcpad, NULL);
+  if (result && queue->thread_scheduling != GST_TASK_SCHEDULING_DEFAULT)
+    gst_queue_configure_task (queue);
+
+  return result;
+}
+
 static void
 gst_queue_loop (GstPad * pad)
 {
@@ -1511,18 +1806,45 @@ gst_queue_loop (GstPad * pad)
   /* have to lock for thread-safety */
   GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
 
-  while (gst_queue_is_empty (queue)) {
-    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is empty");
-    if (!queue->silent) {
+  while (gst_queue_is_empty (queue) || G_UNLIKELY (queue->suspended_add)) {
+    /* when we were suspended, underrun was already signaled */
+    if (!queue->suspended_add) {
+      GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is empty");
+      if (!queue->silent) {
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        g_signal_emit (queue, gst_queue_signals[SIGNAL_UNDERRUN], 0);
+        GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+      }
+    }
+
+    /* spin for a bit first, data could arrive soon */
+    if (queue->spin_time > 0 && gst_queue_is_empty (queue)) {
+      gint cookie = queue->add_cookie;
+      GstClockTime spin_time = queue->spin_time;
+
       GST_QUEUE_MUTEX_UNLOCK (queue);
-      g_signal_emit (queue, gst_queue_signals[SIGNAL_UNDERRUN], 0);
+      gst_queue_spin_for_add (queue, cookie, spin_time);
       GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+      if (!gst_queue_is_empty (queue))
+        queue->spin_hits++;
     }
 
+    if (gst_queue_is_empty (queue))
+      queue->spin_blocks++;
+
     /* we recheck, the signal could have changed the thresholds */
     while (gst_queue_is_empty (queue)) {
+      /* a cooperative task gives its thread back instead of waiting, it is
+       * woken up again when something is added */
+      if (gst_task_suspend (GST_PAD_TASK (pad))) {
+        STATUS (queue, queue->srcpad, "suspend for ADD");
+        queue->suspended_add = TRUE;
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        return;
+      }
       GST_QUEUE_WAIT_ADD_CHECK (queue, out_flushing);
     }
+    queue->suspended_add = FALSE;
 
     GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is not empty");
     if (!queue->silent) {
@@ -1548,6 +1870,7 @@ out_flushing:
     gboolean eos = queue->eos;
     GstFlowReturn ret = queue->srcresult;
 
+    queue->suspended_add = FALSE;
     gst_pad_pause_task (queue->srcpad);
     GST_CAT_LOG_OBJECT (queue_dataflow, queue,
         "pause task, reason:  %s", gst_flow_get_name (ret));
@@ -1587,7 +1910,7 @@ gst_queue_handle_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
         /* when we got not linked, assume downstream is linked again now and we
          * can try to start pushing again */
         queue->srcresult = GST_FLOW_OK;
-        gst_pad_start_task (pad, (GstTaskFunction) gst_queue_loop, pad, NULL);
+        gst_queue_start_task (queue);
       }
       GST_QUEUE_MUTEX_UNLOCK (queue);
 
@@ -1745,15 +2068,15 @@ gst_queue_src_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
         queue->srcresult = GST_FLOW_OK;
         queue->eos = FALSE;
         queue->unexpected = FALSE;
-        result =
-            gst_pad_start_task (pad, (GstTaskFunction) gst_queue_loop, pad,
-            NULL);
+        queue->suspended_add = FALSE;
+        result = gst_queue_start_task (queue);
         GST_QUEUE_MUTEX_UNLOCK (queue);
       } else {
         /* step 1, unblock loop function */
         GST_QUEUE_MUTEX_LOCK (queue);
         queue->srcresult = GST_FLOW_FLUSHING;
         /* the item add signal will unblock */
+        g_atomic_int_inc (&queue->add_cookie);
         g_cond_signal (&queue->item_add);
         GST_QUEUE_MUTEX_UNLOCK (queue);
 
@@ -1839,6 +2162,26 @@ gst_queue_set_property (GObject * object,
     case PROP_FLUSH_ON_EOS:
       queue->flush_on_eos = g_value_get_boolean (value);
       break;
+    case PROP_MAX_BATCH_BUFFERS:
+      queue->max_batch_buffers = g_value_get_uint (value);
+      break;
+    case PROP_MAX_BATCH_BYTES:
+      queue->max_batch_bytes = g_value_get_uint (value);
+      break;
+    case PROP_MAX_DRAIN_BUFFERS:
+      queue->max_drain_buffers = g_value_get_uint (value);
+      break;
+    case PROP_SPIN_TIME:
+      queue->spin_time = g_value_get_uint64 (value);
+      break;
+    case PROP_THREAD_SCHEDULING:
+      queue->thread_scheduling = g_value_get_enum (value);
+      gst_queue_configure_task (queue);
+      break;
+    case PROP_THREAD_PRIORITY:
+      queue->thread_priority = g_value_get_int (value);
+      gst_queue_configure_task (queue);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1892,6 +2235,30 @@ gst_queue_get_property (GObject * object,
     case PROP_FLUSH_ON_EOS:
       g_value_set_boolean (value, queue->flush_on_eos);
       break;
+    case PROP_MAX_BATCH_BUFFERS:
+      g_value_set_uint (value, queue->max_batch_buffers);
+      break;
+    case PROP_MAX_BATCH_BYTES:
+      g_value_set_uint (value, queue->max_batch_bytes);
+      break;
+    case PROP_MAX_DRAIN_BUFFERS:
+      g_value_set_uint (value, queue->max_drain_buffers);
+      break;
+    case PROP_SPIN_TIME:
+      g_value_set_uint64 (value, queue->spin_time);
+      break;
+    case PROP_SPIN_HITS:
+      g_value_set_uint64 (value, queue->spin_hits);
+      break;
+    case PROP_SPIN_BLOCKS:
+      g_value_set_uint64 (value, queue->spin_blocks);
+      break;
+    case PROP_THREAD_SCHEDULING:
+      g_value_set_enum (value, queue->thread_scheduling);
+      break;
+    case PROP_THREAD_PRIORITY:
+      g_value_set_int (value, queue->thread_priority);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
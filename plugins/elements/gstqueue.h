@@ -122,6 +122,7 @@ struct _GstQueue {
   GMutex qlock;        /* lock for queue (vs object lock) */
   gboolean waiting_add;
   GCond item_add;      /* signals buffers now available for reading */
+  gboolean suspended_add; /* cooperative task suspended until an item is added */
   gboolean waiting_del;
   GCond item_del;      /* signals space now available for writing */
 
@@ -138,6 +139,18 @@ struct _GstQueue {
   GstQuery *last_handled_query;
 
   gboolean flush_on_eos; /* flush on EOS */
+
+  guint max_batch_buffers; /* max. buffers per pushed buffer list */
+  guint max_batch_bytes;   /* max. bytes per pushed buffer list */
+  guint max_drain_buffers; /* max. buffers dequeued at once */
+
+  GstClockTime spin_time;  /* time to spin before waiting for ADD */
+  gint add_cookie;         /* incremented atomically on every ADD signal */
+  guint64 spin_hits;       /* waits for ADD that ended while spinning */
+  guint64 spin_blocks;     /* waits for ADD that blocked */
+
+  GstTaskSchedulingPolicy thread_scheduling; /* of the srcpad task */
+  gint thread_priority;
 };
 
 struct _GstQueueClass {
@@ -49,6 +49,29 @@
  *
  * The temp-location property will be used to notify the application of the
  * allocated filename.
+ *
+ * When both temp-template and ring-buffer-max-size are set, the temp file is
+ * used as a ring buffer of that size. Where possible it is then accessed
+ * through a memory mapping instead of with stdio.
+ *
+ * When the temp file is not used as a ring buffer, queue2 learns how
+ * downstream alternates between two areas of the stream, like the index and
+ * the data of an interleaved MP4 file. Once the reader switched back and
+ * forth a few times, the area it will return to is downloaded ahead of time
+ * while it still has enough data in the current area. The buffering
+ * messages then have "range-hits" and "range-misses" (#guint64) fields with
+ * the number of switches to an area that did and did not have the data
+ * already, and a "prefetches" (#guint64) field with the number of times an
+ * area was downloaded ahead of time.
+ *
+ * The input rate is a moving average with a half life set with the
+ * #GstQueue2:rate-half-life property. Buffering queries are answered with
+ * "avg-in-rate-low", "avg-in-rate-median" and "avg-in-rate-high" (#gint)
+ * fields with the 10th, 50th and 90th percentile of the recent input rates
+ * in bytes per second, and a "fill-time" (#gint64) field with the number of
+ * milliseconds until the queue is filled to #GstQueue2:fill-estimate-percent
+ * of the high watermark when the input stays at the low rate, or -1 when
+ * this is not known.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -74,6 +97,12 @@
 #include <unistd.h>
 #endif
 
+#if defined (HAVE_SYS_MMAN_H) && defined (HAVE_MMAP) \
+    && defined (HAVE_POSIX_FALLOCATE) && !defined (G_OS_WIN32)
+#include <sys/mman.h>
+#define HAVE_QUEUE2_MMAP 1
+#endif
+
 #ifdef __BIONIC__               /* Android */
 #undef lseek
 #define lseek lseek64
@@ -106,9 +135,23 @@ enum
 #define QUEUE_IS_USING_TEMP_FILE(queue) ((queue)->temp_template != NULL)
 #define QUEUE_IS_USING_RING_BUFFER(queue) ((queue)->ring_buffer_max_size != 0)  /* for consistency with the above macro */
 #define QUEUE_IS_USING_QUEUE(queue) (!QUEUE_IS_USING_TEMP_FILE(queue) && !QUEUE_IS_USING_RING_BUFFER (queue))
+/* temp file that is accessed with stdio instead of through a mapping */
+#define QUEUE_IS_USING_TEMP_STREAM(queue) (QUEUE_IS_USING_TEMP_FILE(queue) && (queue)->temp_map == NULL)
 
 #define QUEUE_MAX_BYTES(queue) MIN((queue)->max_level.bytes, (queue)->ring_buffer_max_size)
 
+/* the interval in seconds to recalculate the rate */
+#define RATE_INTERVAL    0.2
+/* Tuning for rate estimation. The input rate should be stable when connected
+ * to a network and uses the rate-half-life property. The output rate is less
+ * stable (the elements preroll, queues behind a demuxer fill, ...) and should
+ * therefore adapt more quickly. Both start with the plain average of the
+ * first measurements, an initial burst is then forgotten quickly. */
+#define OUT_RATE_HALF_LIFE 0.5
+/* percentiles of the input rate reported in the buffering query */
+#define RATE_PERCENTILE_LOW    10
+#define RATE_PERCENTILE_HIGH   90
+
 /* default property values */
 #define DEFAULT_MAX_SIZE_BUFFERS   100  /* 100 buffers */
 #define DEFAULT_MAX_SIZE_BYTES     (2 * 1024 * 1024)    /* 2 MB */
@@ -122,6 +165,8 @@ enum
 #define DEFAULT_HIGH_WATERMARK     0.99
 #define DEFAULT_TEMP_REMOVE        TRUE
 #define DEFAULT_RING_BUFFER_MAX_SIZE 0
+#define DEFAULT_RATE_HALF_LIFE     (2 * GST_SECOND)
+#define DEFAULT_FILL_ESTIMATE_PERCENT 100
 
 enum
 {
@@ -144,6 +189,8 @@ enum
   PROP_TEMP_REMOVE,
   PROP_RING_BUFFER_MAX_SIZE,
   PROP_AVG_IN_RATE,
+  PROP_RATE_HALF_LIFE,
+  PROP_FILL_ESTIMATE_PERCENT,
   PROP_LAST
 };
 
@@ -213,7 +260,9 @@ enum
 #define GST_QUEUE2_WAIT_DEL_CHECK(q, res, label) G_STMT_START {         \
   STATUS (queue, q->sinkpad, "wait for DEL");                           \
   q->waiting_del = TRUE;                                                \
+  gst_tracing_queue_wait_pre (GST_ELEMENT_CAST (q), q->srcpad, TRUE);   \
   g_cond_wait (&q->item_del, &queue->qlock);                              \
+  gst_tracing_queue_wait_post (GST_ELEMENT_CAST (q), q->srcpad, TRUE);  \
   q->waiting_del = FALSE;                                               \
   if (res != GST_FLOW_OK) {                                             \
     STATUS (queue, q->srcpad, "received DEL wakeup");                   \
@@ -225,7 +274,9 @@ enum
 #define GST_QUEUE2_WAIT_ADD_CHECK(q, res, label) G_STMT_START {         \
   STATUS (queue, q->srcpad, "wait for ADD");                            \
   q->waiting_add = TRUE;                                                \
+  gst_tracing_queue_wait_pre (GST_ELEMENT_CAST (q), q->srcpad, FALSE);  \
   g_cond_wait (&q->item_add, &q->qlock);                                  \
+  gst_tracing_queue_wait_post (GST_ELEMENT_CAST (q), q->srcpad, FALSE); \
   q->waiting_add = FALSE;                                               \
   if (res != GST_FLOW_OK) {                                             \
     STATUS (queue, q->srcpad, "received ADD wakeup");                   \
@@ -234,6 +285,11 @@ enum
   STATUS (queue, q->srcpad, "received ADD");                            \
 } G_STMT_END
 
+/* report the current level to the tracers */
+#define GST_QUEUE2_TRACE_LEVEL(q)                                       \
+  gst_tracing_queue_level (GST_ELEMENT_CAST (q), q->srcpad,             \
+      q->cur_level.buffers, q->cur_level.bytes, q->cur_level.time)
+
 #define GST_QUEUE2_SIGNAL_DEL(q) G_STMT_START {                          \
   if (q->waiting_del) {                                                 \
     STATUS (q, q->srcpad, "signal DEL");                                \
@@ -451,6 +507,35 @@ gst_queue2_class_init (GstQueue2Class * klass)
           "Average input data rate (bytes/s)",
           0, G_MAXINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue2:rate-half-life
+   *
+   * The time after which a measurement of the input rate has half of its
+   * weight in the average input rate. Shorter times follow changes of the
+   * network faster, longer times give a more stable estimate.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_RATE_HALF_LIFE,
+      g_param_spec_uint64 ("rate-half-life", "Rate half life (ns)",
+          "Half life of the input rate measurements in the average (in ns)",
+          GST_MSECOND, G_MAXUINT64, DEFAULT_RATE_HALF_LIFE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue2:fill-estimate-percent
+   *
+   * The percentage of the high watermark for which the "fill-time" field
+   * of the buffering query estimates the time to reach it.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_FILL_ESTIMATE_PERCENT,
+      g_param_spec_uint ("fill-estimate-percent", "Fill estimate percent",
+          "Percentage of the high watermark to estimate the fill time for",
+          0, 100, DEFAULT_FILL_ESTIMATE_PERCENT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* set several parent class virtual functions */
   gobject_class->finalize = gst_queue2_finalize;
 
@@ -522,6 +607,13 @@ gst_queue2_init (GstQueue2 * queue)
   queue->is_eos = FALSE;
   queue->in_timer = g_timer_new ();
   queue->out_timer = g_timer_new ();
+  queue->rate_half_life = DEFAULT_RATE_HALF_LIFE;
+  queue->fill_estimate_percent = DEFAULT_FILL_ESTIMATE_PERCENT;
+  queue->in_estimator =
+      gst_bandwidth_estimator_new ((gdouble) DEFAULT_RATE_HALF_LIFE /
+      GST_SECOND, GST_BANDWIDTH_ESTIMATOR_WINDOW);
+  queue->out_estimator = gst_bandwidth_estimator_new (OUT_RATE_HALF_LIFE,
+      GST_BANDWIDTH_ESTIMATOR_WINDOW);
 
   g_mutex_init (&queue->qlock);
   queue->waiting_add = FALSE;
@@ -540,6 +632,8 @@ gst_queue2_init (GstQueue2 * queue)
   queue->temp_template = NULL;
   queue->temp_location = NULL;
   queue->temp_remove = DEFAULT_TEMP_REMOVE;
+  queue->temp_map = NULL;
+  queue->temp_map_size = 0;
 
   queue->ring_buffer = NULL;
   queue->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
@@ -573,6 +667,8 @@ gst_queue2_finalize (GObject * object)
   g_cond_clear (&queue->query_handled);
   g_timer_destroy (queue->in_timer);
   g_timer_destroy (queue->out_timer);
+  gst_bandwidth_estimator_free (queue->in_estimator);
+  gst_bandwidth_estimator_free (queue->out_estimator);
 
   /* temp_file path cleanup  */
   g_free (queue->temp_template);
@@ -605,6 +701,10 @@ clean_ranges (GstQueue2 * queue)
   g_slice_free_chain (GstQueue2Range, queue->ranges, next);
   queue->ranges = NULL;
   queue->current = NULL;
+  queue->read_range = NULL;
+  queue->other_range = NULL;
+  queue->pingpong = 0;
+  queue->visit_bytes = 0;
 }
 
 /* find a range that contains @offset or NULL when nothing does */
@@ -614,12 +714,18 @@ find_range (GstQueue2 * queue, guint64 offset)
   GstQueue2Range *range = NULL;
   GstQueue2Range *walk;
 
-  /* first do a quick check for the current range */
-  for (walk = queue->ranges; walk; walk = walk->next) {
-    if (offset >= walk->offset && offset <= walk->writing_pos) {
-      /* we can reuse an existing range */
-      range = walk;
-      break;
+  /* first do a quick check for the current range, sequential reads and
+   * writes stay in it */
+  walk = queue->current;
+  if (walk && offset >= walk->offset && offset <= walk->writing_pos) {
+    range = walk;
+  } else {
+    for (walk = queue->ranges; walk; walk = walk->next) {
+      if (offset >= walk->offset && offset <= walk->writing_pos) {
+        /* we can reuse an existing range */
+        range = walk;
+        break;
+      }
     }
   }
   if (range) {
@@ -1057,6 +1163,53 @@ get_buffering_stats (GstQueue2 * queue, gint percent, GstBufferingMode * mode,
   }
 }
 
+/* Called with the lock taken. Estimate the time in milliseconds until the
+ * buffering level reaches @percent of the high watermark when the input
+ * keeps the low percentile of its recent rate. Only the byte and rate
+ * limits can be converted to an amount of data, -1 is returned when
+ * neither is used or the rate is not known yet. */
+static gint64
+estimate_fill_time (GstQueue2 * queue, guint percent)
+{
+  guint64 max_bytes, target, needed = G_MAXUINT64;
+  gdouble rate;
+
+  if (queue->is_eos)
+    return 0;
+
+  rate = gst_bandwidth_estimator_get_percentile (queue->in_estimator,
+      RATE_PERCENTILE_LOW);
+  if (rate <= 0.0)
+    return -1;
+
+  max_bytes = queue->max_level.bytes;
+  if (QUEUE_IS_USING_RING_BUFFER (queue) && max_bytes > 0)
+    max_bytes = QUEUE_MAX_BYTES (queue);
+
+  if (max_bytes > 0) {
+    target = gst_util_uint64_scale (max_bytes, queue->high_watermark * percent,
+        MAX_BUFFERING_LEVEL * 100);
+    needed = target > queue->cur_level.bytes ?
+        target - queue->cur_level.bytes : 0;
+  }
+
+  /* the level in time of the rate estimate is the amount of data divided by
+   * the average input rate */
+  if (queue->use_rate_estimate && queue->max_level.rate_time > 0
+      && queue->byte_in_rate > 0.0) {
+    target = gst_util_uint64_scale (queue->max_level.rate_time,
+        queue->high_watermark * percent, MAX_BUFFERING_LEVEL * 100);
+    target = target * queue->byte_in_rate / GST_SECOND;
+    needed = MIN (needed, target > queue->cur_level.bytes ?
+        target - queue->cur_level.bytes : 0);
+  }
+
+  if (needed == G_MAXUINT64)
+    return -1;
+
+  return needed * 1000 / rate;
+}
+
 /* Called with the lock taken */
 static GstMessage *
 gst_queue2_get_buffering_message (GstQueue2 * queue)
@@ -1073,6 +1226,13 @@ gst_queue2_get_buffering_message (GstQueue2 * queue)
 
     gst_message_set_buffering_stats (msg, queue->mode, queue->avg_in,
         queue->avg_out, queue->buffering_left);
+
+    if (QUEUE_IS_USING_TEMP_FILE (queue)
+        && !QUEUE_IS_USING_RING_BUFFER (queue))
+      gst_structure_set (gst_message_writable_structure (msg),
+          "range-hits", G_TYPE_UINT64, queue->range_hits,
+          "range-misses", G_TYPE_UINT64, queue->range_misses,
+          "prefetches", G_TYPE_UINT64, queue->prefetches, NULL);
   }
 
   return msg;
@@ -1131,8 +1291,9 @@ reset_rate_timer (GstQueue2 * queue)
   queue->bytes_in = 0;
   queue->bytes_out = 0;
   queue->byte_in_rate = 0.0;
-  queue->byte_in_period = 0;
   queue->byte_out_rate = 0.0;
+  gst_bandwidth_estimator_reset (queue->in_estimator);
+  gst_bandwidth_estimator_reset (queue->out_estimator);
   queue->last_update_in_rates_elapsed = 0.0;
   queue->last_in_elapsed = 0.0;
   queue->last_out_elapsed = 0.0;
@@ -1140,23 +1301,10 @@ reset_rate_timer (GstQueue2 * queue)
   queue->out_timer_started = FALSE;
 }
 
-/* the interval in seconds to recalculate the rate */
-#define RATE_INTERVAL    0.2
-/* Tuning for rate estimation. We use a large window for the input rate because
- * it should be stable when connected to a network. The output rate is less
- * stable (the elements preroll, queues behind a demuxer fill, ...) and should
- * therefore adapt more quickly.
- * However, initial input rate may be subject to a burst, and should therefore
- * initially also adapt more quickly to changes, and only later on give higher
- * weight to previous values. */
-#define AVG_IN(avg,val,w1,w2)  ((avg) * (w1) + (val) * (w2)) / ((w1) + (w2))
-#define AVG_OUT(avg,val) ((avg) * 3.0 + (val)) / 4.0
-
 static void
 update_in_rates (GstQueue2 * queue, gboolean force)
 {
   gdouble elapsed, period;
-  gdouble byte_in_rate;
 
   if (!queue->in_timer_started) {
     queue->in_timer_started = TRUE;
@@ -1172,20 +1320,12 @@ update_in_rates (GstQueue2 * queue, gboolean force)
     period = elapsed - queue->last_in_elapsed;
 
     GST_DEBUG_OBJECT (queue,
-        "rates: period %f, in %" G_GUINT64_FORMAT ", global period %f",
-        period, queue->bytes_in, queue->byte_in_period);
-
-    byte_in_rate = queue->bytes_in / period;
-
-    if (queue->byte_in_rate == 0.0)
-      queue->byte_in_rate = byte_in_rate;
-    else
-      queue->byte_in_rate = AVG_IN (queue->byte_in_rate, byte_in_rate,
-          (double) queue->byte_in_period, period);
+        "rates: period %f, in %" G_GUINT64_FORMAT, period, queue->bytes_in);
 
-    /* another data point, cap at 16 for long time running average */
-    if (queue->byte_in_period < 16 * RATE_INTERVAL)
-      queue->byte_in_period += period;
+    gst_bandwidth_estimator_add_sample (queue->in_estimator, queue->bytes_in,
+        period);
+    queue->byte_in_rate =
+        gst_bandwidth_estimator_get_average (queue->in_estimator);
 
     /* reset the values to calculate rate over the next interval */
     queue->last_in_elapsed = elapsed;
@@ -1204,7 +1344,6 @@ static void
 update_out_rates (GstQueue2 * queue)
 {
   gdouble elapsed, period;
-  gdouble byte_out_rate;
 
   if (!queue->out_timer_started) {
     queue->out_timer_started = TRUE;
@@ -1221,12 +1360,10 @@ update_out_rates (GstQueue2 * queue)
     GST_DEBUG_OBJECT (queue,
         "rates: period %f, out %" G_GUINT64_FORMAT, period, queue->bytes_out);
 
-    byte_out_rate = queue->bytes_out / period;
-
-    if (queue->byte_out_rate == 0.0)
-      queue->byte_out_rate = byte_out_rate;
-    else
-      queue->byte_out_rate = AVG_OUT (queue->byte_out_rate, byte_out_rate);
+    gst_bandwidth_estimator_add_sample (queue->out_estimator,
+        queue->bytes_out, period);
+    queue->byte_out_rate =
+        gst_bandwidth_estimator_get_average (queue->out_estimator);
 
     /* reset the values to calculate rate over the next interval */
     queue->last_out_elapsed = elapsed;
@@ -1310,6 +1447,95 @@ get_seek_threshold (GstQueue2 * queue)
   return threshold;
 }
 
+/* the number of times the reader has to go back and forth between two
+ * ranges before we start prefetching */
+#define PINGPONG_MIN 2
+
+static guint64
+range_lead (GstQueue2Range * range)
+{
+  if (range->writing_pos > range->max_reading_pos)
+    return range->writing_pos - range->max_reading_pos;
+  return 0;
+}
+
+/* keep track of the reads that go to another range than the previous read.
+ * Readers of interleaved files go back and forth between two areas, like
+ * the index and the data of an MP4 file. The size of the visits to a range
+ * tells us how much we need to download in the other range before we can
+ * leave it. */
+static void
+update_access_pattern (GstQueue2 * queue, GstQueue2Range * range,
+    guint64 offset, guint length)
+{
+  GstQueue2Range *prev = queue->read_range;
+
+  if (QUEUE_IS_USING_RING_BUFFER (queue))
+    return;
+
+  if (range != NULL && range == prev)
+    return;
+
+  if (prev) {
+    guint64 visit = 0;
+
+    if (prev->max_reading_pos > queue->visit_start)
+      visit = prev->max_reading_pos - queue->visit_start;
+    queue->visit_bytes = (3 * queue->visit_bytes + visit) / 4;
+  }
+
+  if (range != NULL && range == queue->other_range)
+    queue->pingpong++;
+  else
+    queue->pingpong = 0;
+
+  if (range != NULL && offset + length <= range->writing_pos)
+    queue->range_hits++;
+  else
+    queue->range_misses++;
+
+  GST_DEBUG_OBJECT (queue, "reader switched range at %" G_GUINT64_FORMAT
+      ", visits %" G_GUINT64_FORMAT " bytes, ping-pong %u", offset,
+      queue->visit_bytes, queue->pingpong);
+
+  queue->other_range = prev;
+  queue->read_range = range;
+  queue->visit_start = offset;
+}
+
+/* see if we should stop downloading the range the reader is in and fill
+ * the range it will switch back to. Only done when the current range has
+ * enough data for a typical visit and the other range doesn't. */
+static gboolean
+should_prefetch (GstQueue2 * queue)
+{
+  GstQueue2Range *other = queue->other_range;
+  guint64 target;
+
+  if (QUEUE_IS_USING_RING_BUFFER (queue) || queue->is_eos)
+    return FALSE;
+
+  if (queue->pingpong < PINGPONG_MIN || other == NULL
+      || other == queue->current || queue->read_range != queue->current)
+    return FALSE;
+
+  target = MAX (queue->visit_bytes, get_seek_threshold (queue));
+
+  return range_lead (queue->current) >= target && range_lead (other) < target;
+}
+
+/* a range that is merged into the current range is freed */
+static void
+forget_range (GstQueue2 * queue, GstQueue2Range * range)
+{
+  if (queue->read_range == range)
+    queue->read_range = queue->current;
+  if (queue->other_range == range)
+    queue->other_range = queue->current;
+  if (queue->other_range == queue->read_range)
+    queue->other_range = NULL;
+}
+
 /* see if there is enough data in the file to read a full buffer */
 static gboolean
 gst_queue2_have_data (GstQueue2 * queue, guint64 offset, guint length)
@@ -1320,7 +1546,17 @@ gst_queue2_have_data (GstQueue2 * queue, guint64 offset, guint length)
       offset, length);
 
   if ((range = find_range (queue, offset))) {
+    update_access_pattern (queue, range, offset, length);
+
     if (queue->current != range) {
+      /* we are filling the range the reader will switch back to, keep
+       * doing that while the reader still has enough data */
+      if (queue->pingpong >= PINGPONG_MIN
+          && !QUEUE_IS_USING_RING_BUFFER (queue)
+          && offset + length + get_seek_threshold (queue) <= range->writing_pos) {
+        GST_DEBUG_OBJECT (queue, "reading prefetched data from other range");
+        return TRUE;
+      }
       GST_DEBUG_OBJECT (queue, "switching ranges, do seek to range position");
       perform_seek_to_offset (queue, range->writing_pos);
     }
@@ -1354,12 +1590,15 @@ gst_queue2_have_data (GstQueue2 * queue, guint64 offset, guint length)
           queue->current->writing_pos + threshold) {
         GST_INFO_OBJECT (queue,
             "requested data is within range, wait for data");
+        update_access_pattern (queue, queue->current, offset, length);
         return FALSE;
       }
     }
 
     /* too far away, do a seek */
-    perform_seek_to_offset (queue, offset);
+    update_access_pattern (queue, NULL, offset, length);
+    if (perform_seek_to_offset (queue, offset) && queue->read_range == NULL)
+      queue->read_range = queue->current;
   }
 
   return FALSE;
@@ -1380,15 +1619,16 @@ gst_queue2_read_data_at_offset (GstQueue2 * queue, guint64 offset, guint length,
   guint8 *ring_buffer;
   size_t res;
 
-  ring_buffer = queue->ring_buffer;
+  ring_buffer = queue->temp_map ? queue->temp_map : queue->ring_buffer;
 
-  if (QUEUE_IS_USING_TEMP_FILE (queue) && FSEEK_FILE (queue->temp_file, offset))
+  if (QUEUE_IS_USING_TEMP_STREAM (queue)
+      && FSEEK_FILE (queue->temp_file, offset))
     goto seek_failed;
 
   /* this should not block */
   GST_LOG_OBJECT (queue, "Reading %d bytes from offset %" G_GUINT64_FORMAT,
       length, offset);
-  if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+  if (QUEUE_IS_USING_TEMP_STREAM (queue)) {
     res = fread (dst, 1, length, queue->temp_file);
   } else {
     memcpy (dst, ring_buffer + offset, length);
@@ -1398,7 +1638,7 @@ gst_queue2_read_data_at_offset (GstQueue2 * queue, guint64 offset, guint length,
   GST_LOG_OBJECT (queue, "read %" G_GSIZE_FORMAT " bytes", res);
 
   if (G_UNLIKELY (res < length)) {
-    if (!QUEUE_IS_USING_TEMP_FILE (queue))
+    if (!QUEUE_IS_USING_TEMP_STREAM (queue))
       goto could_not_read;
     /* check for errors or EOF */
     if (ferror (queue->temp_file))
@@ -1440,6 +1680,7 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
   guint64 rb_size;
   guint64 max_size;
   guint64 rpos;
+  GstQueue2Range *range;
   GstFlowReturn ret = GST_FLOW_OK;
 
   /* allocate the output buffer of the requested size */
@@ -1521,8 +1762,16 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
       read_length = remaining;
     }
 
+    /* in download mode we can be reading prefetched data from another range
+     * than the one being downloaded */
+    range = queue->current;
+    if (!QUEUE_IS_USING_RING_BUFFER (queue) && queue->read_range
+        && rpos >= queue->read_range->offset
+        && rpos < queue->read_range->writing_pos)
+      range = queue->read_range;
+
     /* set range reading_pos to actual reading position for this read */
-    queue->current->reading_pos = rpos;
+    range->reading_pos = rpos;
 
     /* configure how much and from where to read */
     if (QUEUE_IS_USING_RING_BUFFER (queue)) {
@@ -1558,8 +1807,11 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
       block_length = read_length;
       remaining -= read_return;
 
-      rpos = (queue->current->reading_pos += read_return);
-      update_cur_pos (queue, queue->current, queue->current->reading_pos);
+      rpos = (range->reading_pos += read_return);
+      if (range == queue->current)
+        update_cur_pos (queue, range, range->reading_pos);
+      else
+        range->max_reading_pos = MAX (range->max_reading_pos, rpos);
     }
     GST_QUEUE2_SIGNAL_DEL (queue);
     GST_DEBUG_OBJECT (queue, "%u bytes left to read", remaining);
@@ -1648,6 +1900,58 @@ gst_queue2_read_item_from_file (GstQueue2 * queue)
   return item;
 }
 
+/* A temp file used as ring buffer has a fixed size, map it so that data is
+ * copied straight into and out of the page cache without going through the
+ * stdio buffers. The space is allocated first, writing to a mapped hole on a
+ * full disk would raise SIGBUS instead of returning an error. */
+static void
+gst_queue2_map_temp_file (GstQueue2 * queue)
+{
+#ifdef HAVE_QUEUE2_MMAP
+  gsize size;
+  gpointer data;
+  gint fd;
+
+  if (!QUEUE_IS_USING_RING_BUFFER (queue)
+      || queue->ring_buffer_max_size > G_MAXSIZE)
+    return;
+
+  size = queue->ring_buffer_max_size;
+  fd = fileno (queue->temp_file);
+
+  if (posix_fallocate (fd, 0, size) != 0) {
+    GST_DEBUG_OBJECT (queue, "could not allocate temp file, not mapping it");
+    return;
+  }
+
+  data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    GST_WARNING_OBJECT (queue, "mmap failed, using stdio: %s",
+        g_strerror (errno));
+    return;
+  }
+
+  GST_DEBUG_OBJECT (queue, "mapped %" G_GSIZE_FORMAT " bytes of temp file",
+      size);
+
+  queue->temp_map = data;
+  queue->temp_map_size = size;
+#endif
+}
+
+static void
+gst_queue2_unmap_temp_file (GstQueue2 * queue)
+{
+#ifdef HAVE_QUEUE2_MMAP
+  if (queue->temp_map == NULL)
+    return;
+
+  munmap (queue->temp_map, queue->temp_map_size);
+  queue->temp_map = NULL;
+  queue->temp_map_size = 0;
+#endif
+}
+
 /* must be called with MUTEX_LOCK. Will briefly release the lock when notifying
  * the temp filename. */
 static gboolean
@@ -1685,6 +1989,8 @@ gst_queue2_open_temp_location_file (GstQueue2 * queue)
   if (queue->temp_file == NULL)
     goto open_failed;
 
+  gst_queue2_map_temp_file (queue);
+
   g_free (queue->temp_location);
   queue->temp_location = name;
 
@@ -1739,6 +2045,7 @@ gst_queue2_close_temp_location_file (GstQueue2 * queue)
 
   GST_DEBUG_OBJECT (queue, "closing temp file");
 
+  gst_queue2_unmap_temp_file (queue);
   fflush (queue->temp_file);
   fclose (queue->temp_file);
 
@@ -1761,6 +2068,10 @@ gst_queue2_flush_temp_file (GstQueue2 * queue)
 
   GST_DEBUG_OBJECT (queue, "flushing temp file");
 
+  /* the mapped file keeps its size, the ranges are reset by the caller */
+  if (queue->temp_map)
+    return;
+
   queue->temp_file = g_freopen (queue->temp_location, "wb+", queue->temp_file);
 }
 
@@ -1804,6 +2115,7 @@ gst_queue2_locked_flush (GstQueue2 * queue, gboolean full, gboolean clear_temp)
   gst_event_replace (&queue->stream_start_event, NULL);
 
   /* we deleted a lot of something */
+  GST_QUEUE2_TRACE_LEVEL (queue);
   GST_QUEUE2_SIGNAL_DEL (queue);
 }
 
@@ -1856,7 +2168,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
     writing_pos = queue->current->rb_writing_pos;
   else
     writing_pos = queue->current->writing_pos;
-  ring_buffer = queue->ring_buffer;
+  ring_buffer = queue->temp_map ? queue->temp_map : queue->ring_buffer;
   rb_size = queue->ring_buffer_max_size;
 
   if (!gst_buffer_map (buffer, &info, GST_MAP_READ))
@@ -1999,7 +2311,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
       new_writing_pos = writing_pos + to_write;
     }
 
-    if (QUEUE_IS_USING_TEMP_FILE (queue)
+    if (QUEUE_IS_USING_TEMP_STREAM (queue)
         && FSEEK_FILE (queue->temp_file, writing_pos))
       goto seek_failed;
 
@@ -2009,7 +2321,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
           "] (rb wpos %" G_GUINT64_FORMAT ")", to_write, queue->current->offset,
           queue->current->writing_pos, queue->current->rb_writing_pos);
       /* either not using ring buffer or no wrapping, just write */
-      if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+      if (QUEUE_IS_USING_TEMP_STREAM (queue)) {
         if (fwrite (data, to_write, 1, queue->temp_file) != 1)
           goto handle_error;
       } else {
@@ -2040,6 +2352,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
             new_writing_pos = next->writing_pos;
             do_seek = TRUE;
           }
+          forget_range (queue, next);
           g_slice_free (GstQueue2Range, next);
         }
         goto update_and_signal;
@@ -2054,7 +2367,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
       if (block_one > 0) {
         GST_INFO_OBJECT (queue, "writing %u bytes", block_one);
         /* write data to end of ring buffer */
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        if (QUEUE_IS_USING_TEMP_STREAM (queue)) {
           if (fwrite (data, block_one, 1, queue->temp_file) != 1)
             goto handle_error;
         } else {
@@ -2062,12 +2375,13 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
         }
       }
 
-      if (QUEUE_IS_USING_TEMP_FILE (queue) && FSEEK_FILE (queue->temp_file, 0))
+      if (QUEUE_IS_USING_TEMP_STREAM (queue)
+          && FSEEK_FILE (queue->temp_file, 0))
         goto seek_failed;
 
       if (block_two > 0) {
         GST_INFO_OBJECT (queue, "writing %u bytes", block_two);
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        if (QUEUE_IS_USING_TEMP_STREAM (queue)) {
           if (fwrite (data + block_one, block_two, 1, queue->temp_file) != 1)
             goto handle_error;
         } else {
@@ -2090,8 +2404,14 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
     } else {
       queue->current->writing_pos = writing_pos = new_writing_pos;
     }
-    if (do_seek)
+    if (do_seek) {
       perform_seek_to_offset (queue, new_writing_pos);
+    } else if (should_prefetch (queue)) {
+      GST_DEBUG_OBJECT (queue, "prefetching range at %" G_GUINT64_FORMAT,
+          queue->other_range->writing_pos);
+      queue->prefetches++;
+      perform_seek_to_offset (queue, queue->other_range->writing_pos);
+    }
 
     update_cur_level (queue, queue->current);
 
@@ -2311,6 +2631,7 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item,
       gst_mini_object_unref (GST_MINI_OBJECT_CAST (item));
     }
 
+    GST_QUEUE2_TRACE_LEVEL (queue);
     GST_QUEUE2_SIGNAL_ADD (queue);
   }
 
@@ -2430,6 +2751,7 @@ gst_queue2_locked_dequeue (GstQueue2 * queue, GstQueue2ItemType * item_type)
     item = NULL;
     *item_type = GST_QUEUE2_ITEM_TYPE_UNKNOWN;
   }
+  GST_QUEUE2_TRACE_LEVEL (queue);
   GST_QUEUE2_SIGNAL_DEL (queue);
 
   return item;
@@ -3240,6 +3562,21 @@ gst_queue2_handle_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       gst_query_set_buffering_stats (query, mode, avg_in, avg_out,
           buffering_left);
 
+      GST_QUEUE2_MUTEX_LOCK (queue);
+      gst_structure_set (gst_query_writable_structure (query),
+          "avg-in-rate-low", G_TYPE_INT,
+          (gint) gst_bandwidth_estimator_get_percentile (queue->in_estimator,
+              RATE_PERCENTILE_LOW),
+          "avg-in-rate-median", G_TYPE_INT,
+          (gint) gst_bandwidth_estimator_get_percentile (queue->in_estimator,
+              50),
+          "avg-in-rate-high", G_TYPE_INT,
+          (gint) gst_bandwidth_estimator_get_percentile (queue->in_estimator,
+              RATE_PERCENTILE_HIGH),
+          "fill-time", G_TYPE_INT64,
+          estimate_fill_time (queue, queue->fill_estimate_percent), NULL);
+      GST_QUEUE2_MUTEX_UNLOCK (queue);
+
       if (!QUEUE_IS_USING_QUEUE (queue)) {
         /* add ranges for download and ringbuffer buffering */
         GstFormat format;
@@ -3656,6 +3993,9 @@ gst_queue2_change_state (GstElement * element, GstStateChange transition)
             ret = GST_STATE_CHANGE_FAILURE;
         }
         init_ranges (queue);
+        queue->range_hits = 0;
+        queue->range_misses = 0;
+        queue->prefetches = 0;
       }
       queue->segment_event_received = FALSE;
       queue->starting_segment = NULL;
@@ -3823,6 +4163,14 @@ gst_queue2_set_property (GObject * object,
     case PROP_RING_BUFFER_MAX_SIZE:
       queue->ring_buffer_max_size = g_value_get_uint64 (value);
       break;
+    case PROP_RATE_HALF_LIFE:
+      queue->rate_half_life = g_value_get_uint64 (value);
+      gst_bandwidth_estimator_set_half_life (queue->in_estimator,
+          (gdouble) queue->rate_half_life / GST_SECOND);
+      break;
+    case PROP_FILL_ESTIMATE_PERCENT:
+      queue->fill_estimate_percent = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3907,6 +4255,12 @@ gst_queue2_get_property (GObject * object,
       g_value_set_int64 (value, (gint64) in_rate);
       break;
     }
+    case PROP_RATE_HALF_LIFE:
+      g_value_set_uint64 (value, queue->rate_half_life);
+      break;
+    case PROP_FILL_ESTIMATE_PERCENT:
+      g_value_set_uint (value, queue->fill_estimate_percent);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -27,6 +27,8 @@
 #include <gst/gst.h>
 #include <stdio.h>
 
+#include "gstbandwidthestimator.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_QUEUE2 \
@@ -126,13 +128,16 @@ struct _GstQueue2
   gdouble last_in_elapsed;
   guint64 bytes_in;
   gdouble byte_in_rate;
-  gdouble byte_in_period;
+  GstBandwidthEstimator *in_estimator;
+  GstClockTime rate_half_life;
+  guint fill_estimate_percent;
 
   GTimer *out_timer;
   gboolean out_timer_started;
   gdouble last_out_elapsed;
   guint64 bytes_out;
   gdouble byte_out_rate;
+  GstBandwidthEstimator *out_estimator;
 
   GMutex qlock;                /* lock for queue (vs object lock) */
   gboolean waiting_add;
@@ -146,9 +151,22 @@ struct _GstQueue2
   gchar *temp_location;
   gboolean temp_remove;
   FILE *temp_file;
+  /* mapping of the temp file when it is used as the ring buffer */
+  guint8 *temp_map;
+  gsize temp_map_size;
   /* list of downloaded areas and the current area */
   GstQueue2Range *ranges;
   GstQueue2Range *current;
+  /* access pattern of the reader in download mode, used to prefetch the
+   * range it keeps switching back to */
+  GstQueue2Range *read_range;
+  GstQueue2Range *other_range;
+  guint pingpong;
+  guint64 visit_start;
+  guint64 visit_bytes;
+  guint64 range_hits;
+  guint64 range_misses;
+  guint64 prefetches;
   /* we need this to send the first new segment event of the stream
    * because we can't save it on the file */
   gboolean segment_event_received;
@@ -61,13 +61,18 @@ typedef struct _GstSparseRange GstSparseRange;
 
 struct _GstSparseRange
 {
-  GstSparseRange *next;
+  /* the position of the range in the ranges of the file */
+  GSequenceIter *iter;
 
   gsize start;
   gsize stop;
+
+  /* the value of the use counter of the file when the range was last read
+   * or written */
+  guint64 last_use;
 };
 
-#define RANGE_CONTAINS(r,o) ((r)->start <= (o) && (r)->stop > (o))
+#define RANGE_CONTAINS(r,o,c) ((r)->start <= (o) && (r)->stop >= (o) + (c))
 
 struct _GstSparseFile
 {
@@ -75,49 +80,112 @@ struct _GstSparseFile
   FILE *file;
   gsize current_pos;
 
-  GstSparseRange *ranges;
+  /* GstSparseRange sorted by start, they never overlap or touch because
+   * they are merged when written */
+  GSequence *ranges;
   guint n_ranges;
+  guint max_ranges;
+  guint64 use_counter;
 
   GstSparseRange *write_range;
   GstSparseRange *read_range;
 };
 
+static void
+free_range (GstSparseRange * range)
+{
+  g_slice_free (GstSparseRange, range);
+}
+
+static gint
+compare_range (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  const GstSparseRange *ra = a, *rb = b;
+
+  return ra->start < rb->start ? -1 : ra->start > rb->start;
+}
+
+/* the last range that starts at or before @offset */
 static GstSparseRange *
-get_write_range (GstSparseFile * file, gsize offset)
+find_range_before (GstSparseFile * file, gsize offset)
 {
-  GstSparseRange *next, *prev, *result = NULL;
+  GstSparseRange key = { NULL, offset, offset, 0 };
+  GSequenceIter *iter;
 
-  if (file->write_range && file->write_range->stop == offset)
-    return file->write_range;
+  /* the position after the ranges that start at or before @offset */
+  iter = g_sequence_search (file->ranges, &key, compare_range, NULL);
+  if (g_sequence_iter_is_begin (iter))
+    return NULL;
 
-  prev = NULL;
-  next = file->ranges;
-  while (next) {
-    if (next->start > offset)
-      break;
+  return g_sequence_get (g_sequence_iter_prev (iter));
+}
 
-    if (next->stop >= offset) {
-      result = next;
-      break;
+static GstSparseRange *
+next_range (GstSparseRange * range)
+{
+  GSequenceIter *iter = g_sequence_iter_next (range->iter);
+
+  return g_sequence_iter_is_end (iter) ? NULL : g_sequence_get (iter);
+}
+
+static void
+remove_range (GstSparseFile * file, GstSparseRange * range)
+{
+  if (file->write_range == range)
+    file->write_range = NULL;
+  if (file->read_range == range)
+    file->read_range = NULL;
+  g_sequence_remove (range->iter);
+  file->n_ranges--;
+}
+
+/* forget the least recently used ranges other than @keep until there are no
+ * more than max_ranges */
+static void
+evict_ranges (GstSparseFile * file, GstSparseRange * keep)
+{
+  while (file->max_ranges && file->n_ranges > file->max_ranges) {
+    GSequenceIter *iter;
+    GstSparseRange *oldest = NULL;
+
+    for (iter = g_sequence_get_begin_iter (file->ranges);
+        !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
+      GstSparseRange *range = g_sequence_get (iter);
+
+      if (range != keep && (!oldest || range->last_use < oldest->last_use))
+        oldest = range;
     }
-    prev = next;
-    next = next->next;
+    if (!oldest)
+      break;
+
+    GST_DEBUG ("evicting range %" G_GSIZE_FORMAT "-%" G_GSIZE_FORMAT,
+        oldest->start, oldest->stop);
+    remove_range (file, oldest);
   }
-  if (result == NULL) {
+}
+
+static GstSparseRange *
+get_write_range (GstSparseFile * file, gsize offset)
+{
+  GstSparseRange *result;
+
+  if (file->write_range && file->write_range->stop == offset)
+    return file->write_range;
+
+  result = find_range_before (file, offset);
+  if (result == NULL || result->stop < offset) {
     result = g_slice_new0 (GstSparseRange);
     result->start = offset;
     result->stop = offset;
-
-    result->next = next;
-    if (prev)
-      prev->next = result;
-    else
-      file->ranges = result;
+    result->last_use = file->use_counter;
+    result->iter = g_sequence_insert_sorted (file->ranges, result,
+        compare_range, NULL);
 
     file->write_range = result;
     file->read_range = NULL;
 
     file->n_ranges++;
+    evict_ranges (file, result);
   }
   return result;
 }
@@ -125,20 +193,17 @@ get_write_range (GstSparseFile * file, gsize offset)
 static GstSparseRange *
 get_read_range (GstSparseFile * file, gsize offset, gsize count)
 {
-  GstSparseRange *walk, *result = NULL;
+  GstSparseRange *result;
 
-  if (file->read_range && RANGE_CONTAINS (file->read_range, offset))
+  if (file->read_range && RANGE_CONTAINS (file->read_range, offset, count))
     return file->read_range;
 
-  for (walk = file->ranges; walk; walk = walk->next) {
-    if (walk->start > offset)
-      break;
+  result = find_range_before (file, offset);
+  if (result == NULL || !RANGE_CONTAINS (result, offset, count))
+    return NULL;
+
+  file->read_range = result;
 
-    if (walk->stop >= offset + count) {
-      result = walk;
-      break;
-    }
-  }
   return result;
 }
 
@@ -158,7 +223,7 @@ gst_sparse_file_new (void)
 
   result = g_slice_new0 (GstSparseFile);
   result->current_pos = 0;
-  result->ranges = NULL;
+  result->ranges = g_sequence_new ((GDestroyNotify) free_range);
   result->n_ranges = 0;
 
   return result;
@@ -202,10 +267,31 @@ gst_sparse_file_clear (GstSparseFile * file)
     fclose (file->file);
     file->file = fdopen (file->fd, "wb+");
   }
-  g_slice_free_chain (GstSparseRange, file->ranges, next);
+  g_sequence_remove_range (g_sequence_get_begin_iter (file->ranges),
+      g_sequence_get_end_iter (file->ranges));
   file->current_pos = 0;
-  file->ranges = NULL;
   file->n_ranges = 0;
+  file->write_range = NULL;
+  file->read_range = NULL;
+}
+
+/**
+ * gst_sparse_file_set_max_ranges:
+ * @file: a #GstSparseFile
+ * @max_ranges: the maximum number of ranges or 0 for no maximum
+ *
+ * Limit the number of ranges that @file keeps track of. When writing makes a
+ * new range and there are more than @max_ranges, the range that was read or
+ * written the longest time ago is forgotten and its data has to be written
+ * again before it can be read.
+ */
+void
+gst_sparse_file_set_max_ranges (GstSparseFile * file, guint max_ranges)
+{
+  g_return_if_fail (file != NULL);
+
+  file->max_ranges = max_ranges;
+  evict_ranges (file, file->write_range);
 }
 
 /**
@@ -225,7 +311,7 @@ gst_sparse_file_free (GstSparseFile * file)
     fflush (file->file);
     fclose (file->file);
   }
-  g_slice_free_chain (GstSparseRange, file->ranges, next);
+  g_sequence_free (file->ranges);
   g_slice_free (GstSparseFile, file);
 }
 
@@ -273,9 +359,10 @@ gst_sparse_file_write (GstSparseFile * file, gsize offset, gconstpointer data,
   range = get_write_range (file, offset);
   stop = offset + count;
   range->stop = MAX (range->stop, stop);
+  range->last_use = ++file->use_counter;
 
   /* see if we can merge with next region */
-  while ((next = range->next)) {
+  while ((next = next_range (range))) {
     if (next->start > range->stop)
       break;
 
@@ -284,14 +371,7 @@ gst_sparse_file_write (GstSparseFile * file, gsize offset, gconstpointer data,
         next->start, next->stop);
 
     range->stop = MAX (next->stop, range->stop);
-    range->next = next->next;
-
-    if (file->write_range == next)
-      file->write_range = NULL;
-    if (file->read_range == next)
-      file->read_range = NULL;
-    g_slice_free (GstSparseRange, next);
-    file->n_ranges--;
+    remove_range (file, next);
   }
   if (available)
     *available = range->stop - stop;
@@ -355,6 +435,7 @@ gst_sparse_file_read (GstSparseFile * file, gsize offset, gpointer data,
   }
 
   file->current_pos = offset + res;
+  range->last_use = ++file->use_counter;
 
   if (remaining)
     *remaining = range->stop - file->current_pos;
@@ -417,19 +498,11 @@ gboolean
 gst_sparse_file_get_range_before (GstSparseFile * file, gsize offset,
     gsize * start, gsize * stop)
 {
-  GstSparseRange *walk, *result = NULL;
+  GstSparseRange *result;
 
   g_return_val_if_fail (file != NULL, FALSE);
 
-  for (walk = file->ranges; walk; walk = walk->next) {
-    GST_DEBUG ("start %" G_GSIZE_FORMAT " > %" G_GSIZE_FORMAT,
-        walk->stop, offset);
-    if (walk->start > offset)
-      break;
-
-    if (walk->start <= offset)
-      result = walk;
-  }
+  result = find_range_before (file, offset);
 
   if (result) {
     if (start)
@@ -458,18 +531,21 @@ gboolean
 gst_sparse_file_get_range_after (GstSparseFile * file, gsize offset,
     gsize * start, gsize * stop)
 {
-  GstSparseRange *walk, *result = NULL;
+  GstSparseRange *result;
+  GSequenceIter *iter;
 
   g_return_val_if_fail (file != NULL, FALSE);
 
-  for (walk = file->ranges; walk; walk = walk->next) {
-    GST_DEBUG ("stop %" G_GSIZE_FORMAT " > %" G_GSIZE_FORMAT,
-        walk->stop, offset);
-    if (walk->stop > offset) {
-      result = walk;
-      break;
-    }
+  /* the ranges don't overlap, so the stops are sorted like the starts */
+  result = find_range_before (file, offset);
+  if (result) {
+    if (result->stop <= offset)
+      result = next_range (result);
+  } else {
+    iter = g_sequence_get_begin_iter (file->ranges);
+    result = g_sequence_iter_is_end (iter) ? NULL : g_sequence_get (iter);
   }
+
   if (result) {
     if (start)
       *start = result->start;
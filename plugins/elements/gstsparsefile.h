@@ -81,6 +81,8 @@ void            gst_sparse_file_free         (GstSparseFile *file);
 gboolean        gst_sparse_file_set_fd       (GstSparseFile *file, gint fd);
 void            gst_sparse_file_clear        (GstSparseFile *file);
 
+void            gst_sparse_file_set_max_ranges (GstSparseFile *file, guint max_ranges);
+
 gsize           gst_sparse_file_write        (GstSparseFile *file,
                                               gsize offset,
                                               gconstpointer data,
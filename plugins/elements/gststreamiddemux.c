@@ -35,7 +35,7 @@
  * #GstStreamidDemux does not synchronize the different output streams.
  *
  * #GstStreamidDemux:active-pad provides information about which output pad
- * is activated at the moment.
+ * is activated at the moment. Buffer lists are forwarded to it as a whole.
  *
  * @see_also: #GstFunnel, #gst_event_new_stream_start
  */
@@ -82,6 +82,8 @@ static void gst_streamid_demux_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static GstFlowReturn gst_streamid_demux_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buf);
+static GstFlowReturn gst_streamid_demux_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static gboolean gst_streamid_demux_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static GstStateChangeReturn gst_streamid_demux_change_state (GstElement *
@@ -128,6 +130,8 @@ gst_streamid_demux_init (GstStreamidDemux * demux)
       "sink");
   gst_pad_set_chain_function (demux->sinkpad,
       GST_DEBUG_FUNCPTR (gst_streamid_demux_chain));
+  gst_pad_set_chain_list_function (demux->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_streamid_demux_chain_list));
   gst_pad_set_event_function (demux->sinkpad,
       GST_DEBUG_FUNCPTR (gst_streamid_demux_event));
 
@@ -199,34 +203,31 @@ gst_streamid_demux_srcpad_create (GstStreamidDemux * demux, GstPad * pad,
   g_return_val_if_fail (srcpad != NULL, FALSE);
 
   demux->active_srcpad = srcpad;
-  g_hash_table_insert (demux->stream_id_pairs, g_strdup (stream_id),
-      gst_object_ref (srcpad));
+  demux->active_stream_id = g_strdup (stream_id);
+  g_hash_table_insert (demux->stream_id_pairs,
+      (gchar *) demux->active_stream_id, gst_object_ref (srcpad));
 
   return TRUE;
 }
 
+/* the active pad is only changed from the streaming thread and kept alive
+ * by stream_id_pairs, so no lock or reference is needed to push to it */
 static GstFlowReturn
-gst_streamid_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+gst_streamid_demux_chain_object (GstStreamidDemux * demux, gboolean is_list,
+    GstMiniObject * obj)
 {
-  GstFlowReturn res = GST_FLOW_OK;
-  GstStreamidDemux *demux = NULL;
-  GstPad *srcpad = NULL;
+  GstFlowReturn res;
 
-  demux = GST_STREAMID_DEMUX (parent);
+  if (G_UNLIKELY (demux->active_srcpad == NULL))
+    goto no_active_srcpad;
 
-  GST_LOG_OBJECT (demux, "pushing buffer to %" GST_PTR_FORMAT,
-      demux->active_srcpad);
+  GST_LOG_OBJECT (demux, "pushing buffer%s to %" GST_PTR_FORMAT,
+      is_list ? " list" : "", demux->active_srcpad);
 
-  GST_OBJECT_LOCK (demux);
-  if (demux->active_srcpad) {
-    srcpad = gst_object_ref (demux->active_srcpad);
-    GST_OBJECT_UNLOCK (demux);
-    res = gst_pad_push (srcpad, buf);
-    gst_object_unref (srcpad);
-  } else {
-    GST_OBJECT_UNLOCK (demux);
-    goto no_active_srcpad;
-  }
+  if (is_list)
+    res = gst_pad_push_list (demux->active_srcpad, GST_BUFFER_LIST_CAST (obj));
+  else
+    res = gst_pad_push (demux->active_srcpad, GST_BUFFER_CAST (obj));
 
   GST_LOG_OBJECT (demux, "handled buffer %s", gst_flow_get_name (res));
   return res;
@@ -235,10 +236,26 @@ gst_streamid_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 no_active_srcpad:
   {
     GST_WARNING_OBJECT (demux, "srcpad is not initialized");
+    gst_mini_object_unref (obj);
     return GST_FLOW_NOT_NEGOTIATED;
   }
 }
 
+static GstFlowReturn
+gst_streamid_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  return gst_streamid_demux_chain_object (GST_STREAMID_DEMUX (parent), FALSE,
+      GST_MINI_OBJECT_CAST (buf));
+}
+
+static GstFlowReturn
+gst_streamid_demux_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  return gst_streamid_demux_chain_object (GST_STREAMID_DEMUX (parent), TRUE,
+      GST_MINI_OBJECT_CAST (list));
+}
+
 static GstPad *
 gst_streamid_demux_get_srcpad_by_stream_id (GstStreamidDemux * demux,
     const gchar * stream_id)
@@ -279,6 +296,11 @@ gst_streamid_demux_event (GstPad * pad, GstObject * parent, GstEvent * event)
     if (!stream_id)
       goto no_stream_id;
 
+    /* the stream goes on on the active pad */
+    if (demux->active_stream_id
+        && strcmp (demux->active_stream_id, stream_id) == 0)
+      goto forward;
+
     GST_OBJECT_LOCK (demux);
     active_srcpad =
         gst_streamid_demux_get_srcpad_by_stream_id (demux, stream_id);
@@ -298,6 +320,8 @@ gst_streamid_demux_event (GstPad * pad, GstObject * parent, GstEvent * event)
       }
     } else if (demux->active_srcpad != active_srcpad) {
       demux->active_srcpad = active_srcpad;
+      g_hash_table_lookup_extended (demux->stream_id_pairs, stream_id,
+          (gpointer *) & demux->active_stream_id, NULL);
       GST_OBJECT_UNLOCK (demux);
 
       g_object_notify (G_OBJECT (demux), "active-pad");
@@ -305,17 +329,13 @@ gst_streamid_demux_event (GstPad * pad, GstObject * parent, GstEvent * event)
       GST_OBJECT_UNLOCK (demux);
   }
 
+forward:
   if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_START
       || GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_STOP
       || GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
     res = gst_pad_event_default (pad, parent, event);
   } else if (demux->active_srcpad) {
-    GstPad *srcpad = NULL;
-    GST_OBJECT_LOCK (demux);
-    srcpad = gst_object_ref (demux->active_srcpad);
-    GST_OBJECT_UNLOCK (demux);
-    res = gst_pad_push_event (srcpad, event);
-    gst_object_unref (srcpad);
+    res = gst_pad_push_event (demux->active_srcpad, event);
   } else {
     gst_event_unref (event);
   }
@@ -363,6 +383,7 @@ gst_streamid_demux_reset (GstStreamidDemux * demux)
   GST_OBJECT_LOCK (demux);
   if (demux->active_srcpad != NULL)
     demux->active_srcpad = NULL;
+  demux->active_stream_id = NULL;
 
   demux->nb_srcpads = 0;
   GST_OBJECT_UNLOCK (demux);
@@ -54,7 +54,10 @@ struct _GstStreamidDemux
   GstPad *sinkpad;
 
   guint nb_srcpads;
+  /* only changed by the streaming thread, which reads it without locking */
   GstPad *active_srcpad;
+  /* the key of active_srcpad in stream_id_pairs */
+  const gchar *active_stream_id;
 
   /* This table contains srcpad and stream-id */
   GHashTable *stream_id_pairs;
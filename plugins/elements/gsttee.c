@@ -87,6 +87,8 @@ gst_tee_pull_mode_get_type (void)
 #define DEFAULT_PROP_LAST_MESSAGE	NULL
 #define DEFAULT_PULL_MODE		GST_TEE_PULL_MODE_NEVER
 #define DEFAULT_PROP_ALLOW_NOT_LINKED	FALSE
+#define DEFAULT_PROP_COPY_STATS		FALSE
+#define DEFAULT_PROP_PARALLEL		FALSE
 
 enum
 {
@@ -98,6 +100,10 @@ enum
   PROP_PULL_MODE,
   PROP_ALLOC_PAD,
   PROP_ALLOW_NOT_LINKED,
+  PROP_COPY_STATS,
+  PROP_NUM_COPIES,
+  PROP_PARALLEL,
+  PROP_TASK_POOL,
 };
 
 static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src_%u",
@@ -113,6 +119,80 @@ G_DEFINE_TYPE_WITH_CODE (GstTee, gst_tee, GST_TYPE_ELEMENT, _do_init);
 static GParamSpec *pspec_last_message = NULL;
 static GParamSpec *pspec_alloc_pad = NULL;
 
+/* Meta that is added to the pushed buffers when counting copies. Copying a
+ * buffer copies its metas, so the transform function of the meta is called
+ * whenever a downstream branch copies the buffer, usually to make it
+ * writable. The copied memories then need a memcpy when mapped for writing.
+ * The meta is tagged as memory meta so that elements producing new buffers
+ * from the pushed one don't carry it over. */
+typedef struct
+{
+  GstMeta meta;
+
+  GstTee *tee;
+} GstTeeCopyMeta;
+
+static GType
+gst_tee_copy_meta_api_get_type (void)
+{
+  static volatile GType type = 0;
+  static const gchar *tags[] = { GST_META_TAG_MEMORY_STR, NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstTeeCopyMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+static gboolean
+gst_tee_copy_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  ((GstTeeCopyMeta *) meta)->tee = NULL;
+
+  return TRUE;
+}
+
+static void
+gst_tee_copy_meta_free (GstMeta * meta, GstBuffer * buffer)
+{
+  GstTeeCopyMeta *cmeta = (GstTeeCopyMeta *) meta;
+
+  if (cmeta->tee)
+    gst_object_unref (cmeta->tee);
+}
+
+static gboolean
+gst_tee_copy_meta_transform (GstBuffer * dest, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  GstTeeCopyMeta *cmeta = (GstTeeCopyMeta *) meta;
+
+  /* count the copy but don't add the meta to the copy, only copies of the
+   * buffers that the tee pushed are counted */
+  if (GST_META_TRANSFORM_IS_COPY (type) && cmeta->tee) {
+    GST_CAT_LOG_OBJECT (GST_CAT_PERFORMANCE, cmeta->tee,
+        "buffer %p copied to %p", buffer, dest);
+    g_atomic_int_inc (&cmeta->tee->num_copies);
+  }
+
+  return TRUE;
+}
+
+static const GstMetaInfo *
+gst_tee_copy_meta_get_info (void)
+{
+  static const GstMetaInfo *meta_info = NULL;
+
+  if (g_once_init_enter ((GstMetaInfo **) & meta_info)) {
+    const GstMetaInfo *mi = gst_meta_register (gst_tee_copy_meta_api_get_type (),
+        "GstTeeCopyMeta", sizeof (GstTeeCopyMeta), gst_tee_copy_meta_init,
+        gst_tee_copy_meta_free, gst_tee_copy_meta_transform);
+    g_once_init_leave ((GstMetaInfo **) & meta_info, (GstMetaInfo *) mi);
+  }
+  return meta_info;
+}
+
 GType gst_tee_pad_get_type (void);
 
 #define GST_TYPE_TEE_PAD \
@@ -223,6 +303,12 @@ gst_tee_finalize (GObject * object)
 
   g_free (tee->last_message);
 
+  if (tee->task_pool) {
+    if (tee->own_task_pool)
+      gst_task_pool_cleanup (tee->task_pool);
+    gst_object_unref (tee->task_pool);
+  }
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -286,6 +372,63 @@ gst_tee_class_init (GstTeeClass * klass)
           "all unlinked", DEFAULT_PROP_ALLOW_NOT_LINKED,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstTee:copy-stats:
+   *
+   * Count how often the downstream branches copy the buffers pushed by the
+   * tee, for example to make them writable. The copies are reported by the
+   * #GstTee:num-copies property. This adds a small meta to every buffer.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_COPY_STATS,
+      g_param_spec_boolean ("copy-stats", "Copy statistics",
+          "Count the copies the branches make of the pushed buffers",
+          DEFAULT_PROP_COPY_STATS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstTee:num-copies:
+   *
+   * The number of times a downstream branch copied a buffer pushed by the
+   * tee since #GstTee:copy-stats was enabled.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_NUM_COPIES,
+      g_param_spec_uint ("num-copies", "Number of copies",
+          "The number of copies the branches made of the pushed buffers",
+          0, G_MAXUINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstTee:parallel:
+   *
+   * Push each buffer to the source pads in parallel from the threads of
+   * #GstTee:task-pool and wait for all of them before returning, instead of
+   * pushing to one pad after the other. This gives every branch its own
+   * thread without the need for a queue in each branch, but the streaming
+   * thread still waits for the slowest branch.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL,
+      g_param_spec_boolean ("parallel", "Parallel",
+          "Push to the source pads in parallel from a task pool",
+          DEFAULT_PROP_PARALLEL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstTee:task-pool:
+   *
+   * The #GstTaskPool used for pushing to the source pads in
+   * #GstTee:parallel mode. The pool must be prepared already. When no pool
+   * is set, the tee creates a default #GstTaskPool when needed.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_TASK_POOL,
+      g_param_spec_object ("task-pool", "Task pool",
+          "The task pool used for pushing in parallel mode",
+          GST_TYPE_TASK_POOL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Tee pipe fitting",
       "Generic",
@@ -481,6 +624,8 @@ gst_tee_set_property (GObject * object, guint prop_id, const GValue * value,
     GParamSpec * pspec)
 {
   GstTee *tee = GST_TEE (object);
+  GstTaskPool *old_pool = NULL;
+  gboolean own_old_pool = FALSE;
 
   GST_OBJECT_LOCK (tee);
   switch (prop_id) {
@@ -508,11 +653,33 @@ gst_tee_set_property (GObject * object, guint prop_id, const GValue * value,
     case PROP_ALLOW_NOT_LINKED:
       tee->allow_not_linked = g_value_get_boolean (value);
       break;
+    case PROP_PARALLEL:
+      tee->parallel = g_value_get_boolean (value);
+      break;
+    case PROP_TASK_POOL:
+      /* the old pool is cleaned up without the lock, it waits for the jobs
+       * that are still running */
+      old_pool = tee->task_pool;
+      own_old_pool = tee->own_task_pool;
+      tee->task_pool = g_value_dup_object (value);
+      tee->own_task_pool = FALSE;
+      break;
+    case PROP_COPY_STATS:
+      tee->copy_stats = g_value_get_boolean (value);
+      if (tee->copy_stats)
+        g_atomic_int_set (&tee->num_copies, 0);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
   GST_OBJECT_UNLOCK (tee);
+
+  if (old_pool) {
+    if (own_old_pool)
+      gst_task_pool_cleanup (old_pool);
+    gst_object_unref (old_pool);
+  }
 }
 
 static void
@@ -544,6 +711,18 @@ gst_tee_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_ALLOW_NOT_LINKED:
       g_value_set_boolean (value, tee->allow_not_linked);
       break;
+    case PROP_PARALLEL:
+      g_value_set_boolean (value, tee->parallel);
+      break;
+    case PROP_TASK_POOL:
+      g_value_set_object (value, tee->task_pool);
+      break;
+    case PROP_COPY_STATS:
+      g_value_set_boolean (value, tee->copy_stats);
+      break;
+    case PROP_NUM_COPIES:
+      g_value_set_uint (value, g_atomic_int_get (&tee->num_copies));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -839,25 +1018,158 @@ gst_tee_do_message (GstTee * tee, GstPad * pad, gpointer data, gboolean is_list)
   g_object_notify_by_pspec ((GObject *) tee, pspec_last_message);
 }
 
+/* push @data on @pad, when @take is set our reference to @data is handed
+ * over to @pad */
 static GstFlowReturn
-gst_tee_do_push (GstTee * tee, GstPad * pad, gpointer data, gboolean is_list)
+gst_tee_do_push (GstTee * tee, GstPad * pad, gpointer data, gboolean is_list,
+    gboolean take)
 {
   GstFlowReturn res;
 
   /* Push */
   if (pad == tee->pull_pad) {
     /* don't push on the pad we're pulling from */
+    if (take)
+      gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
     res = GST_FLOW_OK;
-  } else if (is_list) {
-    res =
-        gst_pad_push_list (pad,
-        gst_buffer_list_ref (GST_BUFFER_LIST_CAST (data)));
   } else {
-    res = gst_pad_push (pad, gst_buffer_ref (GST_BUFFER_CAST (data)));
+    if (!take)
+      gst_mini_object_ref (GST_MINI_OBJECT_CAST (data));
+
+    if (is_list)
+      res = gst_pad_push_list (pad, GST_BUFFER_LIST_CAST (data));
+    else
+      res = gst_pad_push (pad, GST_BUFFER_CAST (data));
   }
   return res;
 }
 
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint pending;
+} GstTeePushBatch;
+
+typedef struct
+{
+  GstTee *tee;
+  GstPad *pad;
+  gpointer data;
+  gboolean is_list;
+
+  GstTeePushBatch *batch;
+  gpointer id;
+  GstFlowReturn ret;
+} GstTeePushJob;
+
+static void
+gst_tee_push_job (GstTeePushJob * job)
+{
+  GstTeePushBatch *batch = job->batch;
+
+  GST_LOG_OBJECT (job->pad, "Starting to push %s %p",
+      job->is_list ? "list" : "buffer", job->data);
+
+  job->ret =
+      gst_tee_do_push (job->tee, job->pad, job->data, job->is_list, FALSE);
+
+  GST_LOG_OBJECT (job->pad, "Pushing item %p yielded result %s", job->data,
+      gst_flow_get_name (job->ret));
+
+  g_mutex_lock (&batch->lock);
+  if (--batch->pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* push @data to all pads that were not pushed on yet at the same time, one
+ * of them from the calling thread and the others from the task pool, and
+ * store the results in the pads. Called and returns with the OBJECT_LOCK. */
+static void
+gst_tee_push_parallel (GstTee * tee, gpointer data, gboolean is_list)
+{
+  GstTeePushBatch batch;
+  GstTeePushJob *jobs;
+  GstTaskPool *pool;
+  GList *pads;
+  guint i, n = 0;
+
+  jobs = g_new (GstTeePushJob, GST_ELEMENT_CAST (tee)->numsrcpads);
+  for (pads = GST_ELEMENT_CAST (tee)->srcpads; pads; pads = pads->next) {
+    GstPad *pad = GST_PAD_CAST (pads->data);
+
+    if (GST_TEE_PAD_CAST (pad)->pushed)
+      continue;
+
+    jobs[n].tee = tee;
+    jobs[n].pad = gst_object_ref (pad);
+    jobs[n].data = data;
+    jobs[n].is_list = is_list;
+    jobs[n].batch = &batch;
+    jobs[n].id = NULL;
+    n++;
+  }
+
+  if (G_UNLIKELY (tee->task_pool == NULL)) {
+    GError *err = NULL;
+
+    tee->task_pool = gst_task_pool_new ();
+    tee->own_task_pool = TRUE;
+    gst_task_pool_prepare (tee->task_pool, &err);
+    if (err) {
+      GST_WARNING_OBJECT (tee, "failed to prepare task pool: %s",
+          err->message);
+      g_clear_error (&err);
+    }
+  }
+  pool = gst_object_ref (tee->task_pool);
+  GST_OBJECT_UNLOCK (tee);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.pending = n;
+
+  /* the first pad is pushed from this thread, it would wait anyway */
+  for (i = 1; i < n; i++) {
+    GError *err = NULL;
+
+    jobs[i].id = gst_task_pool_push (pool, (GstTaskPoolFunction)
+        gst_tee_push_job, &jobs[i], &err);
+    if (G_UNLIKELY (err)) {
+      GST_WARNING_OBJECT (tee, "failed to push to task pool: %s, pushing "
+          "from the streaming thread", err->message);
+      g_clear_error (&err);
+      gst_tee_push_job (&jobs[i]);
+    }
+  }
+  if (n > 0)
+    gst_tee_push_job (&jobs[0]);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  for (i = 1; i < n; i++) {
+    if (jobs[i].id)
+      gst_task_pool_join (pool, jobs[i].id);
+  }
+  gst_object_unref (pool);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  GST_OBJECT_LOCK (tee);
+  /* keep track of which pad we pushed and the result value */
+  for (i = 0; i < n; i++) {
+    GST_TEE_PAD_CAST (jobs[i].pad)->pushed = TRUE;
+    GST_TEE_PAD_CAST (jobs[i].pad)->result = jobs[i].ret;
+    gst_object_unref (jobs[i].pad);
+  }
+  g_free (jobs);
+}
+
 static void
 clear_pads (GstPad * pad, GstTee * tee)
 {
@@ -914,6 +1226,11 @@ gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
   /* mark all pads as 'not pushed on yet' */
   g_list_foreach (pads, (GFunc) clear_pads, tee);
 
+  /* push to all pads at once, the loop below then only combines the results
+   * and pushes to pads that were added meanwhile */
+  if (tee->parallel)
+    gst_tee_push_parallel (tee, data, is_list);
+
 restart:
   if (tee->allow_not_linked) {
     cret = GST_FLOW_OK;
@@ -928,7 +1245,18 @@ restart:
 
     pad = GST_PAD_CAST (pads->data);
 
+    if (G_UNLIKELY (data == NULL && !GST_TEE_PAD_CAST (pad)->pushed)) {
+      /* added after we handed the data to the pad that was last, this pad
+       * will get the next buffer */
+      pads = g_list_next (pads);
+      continue;
+    }
+
     if (G_LIKELY (!GST_TEE_PAD_CAST (pad)->pushed)) {
+      /* the last pad gets our reference, this saves a ref and unref and
+       * the data might be writable when it arrives there */
+      gboolean take = (pads->next == NULL);
+
       /* not yet pushed, release lock and start pushing */
       gst_object_ref (pad);
       GST_OBJECT_UNLOCK (tee);
@@ -936,7 +1264,9 @@ restart:
       GST_LOG_OBJECT (pad, "Starting to push %s %p",
           is_list ? "list" : "buffer", data);
 
-      ret = gst_tee_do_push (tee, pad, data, is_list);
+      ret = gst_tee_do_push (tee, pad, data, is_list, take);
+      if (take)
+        data = NULL;
 
       GST_LOG_OBJECT (pad, "Pushing item %p yielded result %s", data,
           gst_flow_get_name (ret));
@@ -978,7 +1308,8 @@ restart:
   }
   GST_OBJECT_UNLOCK (tee);
 
-  gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
+  if (data)
+    gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
 
   /* no need to unset gvalue */
   return cret;
@@ -1004,7 +1335,8 @@ error:
 end:
   {
     GST_OBJECT_UNLOCK (tee);
-    gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
+    if (data)
+      gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
     return ret;
   }
 }
@@ -1019,6 +1351,16 @@ gst_tee_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
   GST_DEBUG_OBJECT (tee, "received buffer %p", buffer);
 
+  if (G_UNLIKELY (tee->copy_stats)) {
+    GstTeeCopyMeta *cmeta;
+
+    /* only a cheap copy of the buffer itself if upstream still uses it */
+    buffer = gst_buffer_make_writable (buffer);
+    cmeta = (GstTeeCopyMeta *) gst_buffer_add_meta (buffer,
+        gst_tee_copy_meta_get_info (), NULL);
+    cmeta->tee = gst_object_ref (tee);
+  }
+
   res = gst_tee_handle_data (tee, buffer, FALSE);
 
   GST_DEBUG_OBJECT (tee, "handled buffer %s", gst_flow_get_name (res));
@@ -81,6 +81,13 @@ struct _GstTee {
   GstPad         *pull_pad;
 
   gboolean        allow_not_linked;
+
+  gboolean        parallel;
+  GstTaskPool    *task_pool;
+  gboolean        own_task_pool;
+
+  gboolean        copy_stats;
+  gint            num_copies;   /* atomic */
 };
 
 struct _GstTeeClass {
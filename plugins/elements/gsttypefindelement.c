@@ -113,6 +113,7 @@ enum
   PROP_CAPS,
   PROP_MINIMUM,
   PROP_FORCE_CAPS,
+  PROP_PARALLEL,
   PROP_LAST
 };
 enum
@@ -262,6 +263,19 @@ gst_type_find_element_class_init (GstTypeFindElementClass * typefind_class)
       g_param_spec_boxed ("force-caps", _("force caps"),
           _("force caps without doing a typefind"), GST_TYPE_CAPS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstTypeFindElement:parallel:
+   *
+   * Call the typefind functions concurrently on a task pool when
+   * typefinding in push mode. The result is the same as when calling them
+   * one after another.
+   *
+   * Since: 1.14
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL,
+      g_param_spec_boolean ("parallel", "Parallel",
+          "Call the typefind functions in parallel in push mode", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   /**
    * GstTypeFindElement::have-type:
    * @typefind: the typefind instance
@@ -350,6 +364,12 @@ gst_type_find_element_dispose (GObject * object)
     typefind->force_caps = NULL;
   }
 
+  if (typefind->pool) {
+    gst_task_pool_cleanup (typefind->pool);
+    gst_object_unref (typefind->pool);
+    typefind->pool = NULL;
+  }
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -372,6 +392,11 @@ gst_type_find_element_set_property (GObject * object, guint prop_id,
       typefind->force_caps = g_value_dup_boxed (value);
       GST_OBJECT_UNLOCK (typefind);
       break;
+    case PROP_PARALLEL:
+      GST_OBJECT_LOCK (typefind);
+      typefind->parallel = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (typefind);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -400,6 +425,11 @@ gst_type_find_element_get_property (GObject * object, guint prop_id,
       g_value_set_boxed (value, typefind->force_caps);
       GST_OBJECT_UNLOCK (typefind);
       break;
+    case PROP_PARALLEL:
+      GST_OBJECT_LOCK (typefind);
+      g_value_set_boolean (value, typefind->parallel);
+      GST_OBJECT_UNLOCK (typefind);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -921,6 +951,28 @@ gst_type_find_element_chain (GstPad * pad, GstObject * parent,
   return res;
 }
 
+/* called with the object lock */
+static gboolean
+gst_type_find_element_ensure_pool (GstTypeFindElement * typefind)
+{
+  GError *err = NULL;
+
+  if (typefind->pool)
+    return TRUE;
+
+  typefind->pool = gst_task_pool_new ();
+  gst_task_pool_prepare (typefind->pool, &err);
+  if (err) {
+    GST_WARNING_OBJECT (typefind, "failed to prepare task pool: %s",
+        err->message);
+    g_error_free (err);
+    gst_object_unref (typefind->pool);
+    typefind->pool = NULL;
+    return FALSE;
+  }
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_type_find_element_chain_do_typefinding (GstTypeFindElement * typefind,
     gboolean check_avail, gboolean at_eos)
@@ -953,8 +1005,12 @@ gst_type_find_element_chain_do_typefinding (GstTypeFindElement * typefind,
 
     /* map all available data */
     data = gst_adapter_map (typefind->adapter, avail);
-    caps = gst_type_find_helper_for_data (GST_OBJECT (typefind),
-        data, avail, &probability);
+    if (typefind->parallel && gst_type_find_element_ensure_pool (typefind))
+      caps = gst_type_find_helper_for_data_with_pool (GST_OBJECT (typefind),
+          data, avail, typefind->pool, &probability);
+    else
+      caps = gst_type_find_helper_for_data (GST_OBJECT (typefind),
+          data, avail, &probability);
     gst_adapter_unmap (typefind->adapter);
 
     if (caps == NULL && have_max)
@@ -58,6 +58,10 @@ struct _GstTypeFindElement {
   GList *               cached_events;
   GstCaps *             force_caps;
 
+  /* to call the typefind functions in parallel */
+  gboolean              parallel;
+  GstTaskPool *         pool;
+
   guint64		initial_offset;
   
   /* Only used when driving the pipeline */
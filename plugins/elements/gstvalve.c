@@ -185,12 +185,16 @@ static GstFlowReturn
 gst_valve_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
   GstValve *valve = GST_VALVE (parent);
-  GstFlowReturn ret = GST_FLOW_OK;
+  GstFlowReturn ret;
 
-  if (g_atomic_int_get (&valve->drop)) {
+  if (G_UNLIKELY (g_atomic_int_get (&valve->drop))) {
     gst_buffer_unref (buffer);
     valve->discont = TRUE;
-  } else {
+    return GST_FLOW_OK;
+  }
+
+  /* only after the valve was reopened there is something to do */
+  if (G_UNLIKELY (valve->discont || valve->need_repush_sticky)) {
     if (valve->discont) {
       buffer = gst_buffer_make_writable (buffer);
       GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
@@ -199,15 +203,14 @@ gst_valve_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
     if (valve->need_repush_sticky)
       gst_valve_repush_sticky (valve);
-
-    ret = gst_pad_push (valve->srcpad, buffer);
   }
 
+  ret = gst_pad_push (valve->srcpad, buffer);
 
   /* Ignore errors if "drop" was changed while the thread was blocked
    * downwards
    */
-  if (g_atomic_int_get (&valve->drop))
+  if (G_UNLIKELY (ret != GST_FLOW_OK) && g_atomic_int_get (&valve->drop))
     ret = GST_FLOW_OK;
 
   return ret;
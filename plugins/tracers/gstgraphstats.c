@@ -0,0 +1,396 @@
+/* GStreamer
+ *
+ * gstgraphstats.c: tracing module with statistics for pipeline graphs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstgraphstats
+ * @short_description: show the data flow in pipeline graphs
+ *
+ * A tracing module that measures the data flow of the pipeline and adds it
+ * to the pipeline graphs that are made with #GST_DEBUG_GRAPH_SHOW_STATS:
+ * |[
+ * GST_TRACERS="graphstats" GST_DEBUG_DUMP_DOT_DIR=/tmp gst-launch-1.0 ...
+ * ]|
+ *
+ * The links get the number of buffers and bytes per second and the buffer
+ * pool that was negotiated with the allocation query. The elements get the
+ * share of the time they spent processing data, which also sets their color
+ * from white to red, and queues get their level.
+ *
+ * The values are measured since the previous graph, so that a graph made
+ * every few seconds shows where the time goes right now. The time of an
+ * element is the time spent in its chain and getrange functions without the
+ * time spent in the elements it pushes to. The time that the streaming
+ * threads of sources and queues spend outside of pushing is not measured.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstgraphstats.h"
+#include "gst/gstproctimestack.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_graph_stats_debug);
+#define GST_CAT_DEFAULT gst_graph_stats_debug
+
+static GQuark data_quark;
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_graph_stats_debug, "graphstats", 0, \
+        "graph stats tracer"); \
+    data_quark = g_quark_from_static_string ("gstgraphstats:data");
+#define gst_graph_stats_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstGraphStatsTracer, gst_graph_stats_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+/* per src pad, stored on the pad */
+typedef struct
+{
+  guint64 buffers, bytes;
+  /* the values at the previous graph */
+  guint64 last_buffers, last_bytes;
+  GstClockTime last_ts;
+  gchar *pool;
+} GstGraphStatsPad;
+
+/* per element, stored on the element */
+typedef struct
+{
+  GstClockTime proc_time;
+  /* the values at the previous graph */
+  GstClockTime last_proc_time;
+  GstClockTime last_ts;
+  /* the last level when the element is a queue */
+  gboolean is_queue;
+  guint level_buffers;
+  guint64 level_bytes, level_time;
+} GstGraphStatsElement;
+
+static void
+free_stack (GArray * stack)
+{
+  g_array_free (stack, TRUE);
+}
+
+/* the elements that are processing data in this thread, the time is charged
+ * to the innermost one */
+static GPrivate stack_key = G_PRIVATE_INIT ((GDestroyNotify) free_stack);
+
+static void
+free_pad_stats (GstGraphStatsPad * stats)
+{
+  g_free (stats->pool);
+  g_slice_free (GstGraphStatsPad, stats);
+}
+
+/* called with the lock */
+static GstGraphStatsPad *
+get_pad_stats (GstPad * pad, GstClockTime ts)
+{
+  GstGraphStatsPad *stats;
+
+  if (pad == NULL)
+    return NULL;
+
+  stats = g_object_get_qdata ((GObject *) pad, data_quark);
+  if (stats == NULL) {
+    stats = g_slice_new0 (GstGraphStatsPad);
+    stats->last_ts = ts;
+    g_object_set_qdata_full ((GObject *) pad, data_quark, stats,
+        (GDestroyNotify) free_pad_stats);
+  }
+  return stats;
+}
+
+static void
+free_element_stats (GstGraphStatsElement * stats)
+{
+  g_slice_free (GstGraphStatsElement, stats);
+}
+
+/* called with the lock */
+static GstGraphStatsElement *
+get_element_stats (GstElement * element, GstClockTime ts)
+{
+  GstGraphStatsElement *stats;
+
+  stats = g_object_get_qdata ((GObject *) element, data_quark);
+  if (stats == NULL) {
+    stats = g_slice_new0 (GstGraphStatsElement);
+    stats->last_ts = ts;
+    g_object_set_qdata_full ((GObject *) element, data_quark, stats,
+        (GDestroyNotify) free_element_stats);
+  }
+  return stats;
+}
+
+/* called with the lock, get the processing time of the element that
+ * processes the data of @pad. Ghost pads belong to bins, they don't process
+ * the data */
+static GstClockTime *
+get_pad_proc_time (GstPad * pad, GstClockTime ts)
+{
+  GstObject *parent;
+
+  if (pad == NULL)
+    return NULL;
+
+  parent = GST_OBJECT_PARENT (pad);
+  if (!GST_IS_ELEMENT (parent) || GST_IS_BIN (parent))
+    return NULL;
+
+  return &get_element_stats (GST_ELEMENT_CAST (parent), ts)->proc_time;
+}
+
+static GArray *
+get_stack (void)
+{
+  GArray *stack = g_private_get (&stack_key);
+
+  if (stack == NULL) {
+    stack = proc_time_stack_new ();
+    g_private_set (&stack_key, stack);
+  }
+  return stack;
+}
+
+static void
+push_pre (GstGraphStatsTracer * self, GstClockTime ts, GstPad * pad,
+    guint buffers, gsize bytes)
+{
+  GstGraphStatsPad *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_pad_stats (pad, ts);
+  stats->buffers += buffers;
+  stats->bytes += bytes;
+
+  proc_time_stack_push (get_stack (), get_pad_proc_time (GST_PAD_PEER (pad),
+          ts), ts);
+  g_mutex_unlock (&self->lock);
+}
+
+/* hooks */
+
+static void
+do_push_buffer_pre (GstGraphStatsTracer * self, GstClockTime ts,
+    GstPad * pad, GstBuffer * buffer)
+{
+  push_pre (self, ts, pad, 1, gst_buffer_get_size (buffer));
+}
+
+static void
+do_push_buffer_list_pre (GstGraphStatsTracer * self, GstClockTime ts,
+    GstPad * pad, GstBufferList * list)
+{
+  push_pre (self, ts, pad, gst_buffer_list_length (list),
+      gst_buffer_list_calculate_size (list));
+}
+
+static void
+do_push_post (GstGraphStatsTracer * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  g_mutex_lock (&self->lock);
+  proc_time_stack_pop (get_stack (), ts);
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_pull_range_pre (GstGraphStatsTracer * self, GstClockTime ts, GstPad * pad,
+    guint64 offset, guint size)
+{
+  g_mutex_lock (&self->lock);
+  proc_time_stack_push (get_stack (), get_pad_proc_time (GST_PAD_PEER (pad),
+          ts), ts);
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_pull_range_post (GstGraphStatsTracer * self, GstClockTime ts,
+    GstPad * pad, GstBuffer * buffer, GstFlowReturn res)
+{
+  GstGraphStatsPad *stats;
+
+  g_mutex_lock (&self->lock);
+  proc_time_stack_pop (get_stack (), ts);
+
+  /* the link is drawn from the src pad */
+  if (res == GST_FLOW_OK && buffer != NULL &&
+      (stats = get_pad_stats (GST_PAD_PEER (pad), ts))) {
+    stats->buffers++;
+    stats->bytes += gst_buffer_get_size (buffer);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_query_post (GstGraphStatsTracer * self, GstClockTime ts, GstPad * pad,
+    GstQuery * query, gboolean res)
+{
+  GstGraphStatsPad *stats;
+  GstBufferPool *pool = NULL;
+  guint size = 0, min = 0, max = 0;
+  gchar *desc;
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_ALLOCATION || !res)
+    return;
+
+  if (gst_query_get_n_allocation_pools (query) > 0)
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+
+  if (pool) {
+    desc = g_strdup_printf ("%s (%s), %u bytes, %u-%u buffers",
+        GST_OBJECT_NAME (pool), G_OBJECT_TYPE_NAME (pool), size, min, max);
+    gst_object_unref (pool);
+  } else if (size > 0) {
+    desc = g_strdup_printf ("none, %u bytes, %u-%u buffers", size, min, max);
+  } else {
+    desc = g_strdup ("none");
+  }
+
+  /* the query is answered by the sink pad, the link is drawn from the src
+   * pad that sent it */
+  g_mutex_lock (&self->lock);
+  if ((stats = get_pad_stats (GST_PAD_PEER (pad), ts))) {
+    g_free (stats->pool);
+    stats->pool = desc;
+    desc = NULL;
+  }
+  g_mutex_unlock (&self->lock);
+
+  g_free (desc);
+}
+
+static void
+do_queue_level (GstGraphStatsTracer * self, GstClockTime ts,
+    GstElement * queue, GstPad * pad, guint buffers, guint64 bytes,
+    guint64 time)
+{
+  GstGraphStatsElement *stats;
+
+  g_mutex_lock (&self->lock);
+  stats = get_element_stats (queue, ts);
+  stats->is_queue = TRUE;
+  stats->level_buffers = buffers;
+  stats->level_bytes = bytes;
+  stats->level_time = time;
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_graph_stats (GstGraphStatsTracer * self, GstClockTime ts,
+    GstObject * object, GstStructure * structure)
+{
+  g_mutex_lock (&self->lock);
+  if (GST_IS_PAD (object)) {
+    GstGraphStatsPad *stats = g_object_get_qdata ((GObject *) object,
+        data_quark);
+
+    if (stats == NULL)
+      goto done;
+
+    if (ts > stats->last_ts) {
+      gdouble elapsed = (gdouble) (ts - stats->last_ts) / GST_SECOND;
+
+      gst_structure_set (structure,
+          "buffers-per-second", G_TYPE_DOUBLE,
+          (stats->buffers - stats->last_buffers) / elapsed,
+          "bytes-per-second", G_TYPE_DOUBLE,
+          (stats->bytes - stats->last_bytes) / elapsed, NULL);
+    }
+    if (stats->pool)
+      gst_structure_set (structure, "allocation-pool", G_TYPE_STRING,
+          stats->pool, NULL);
+
+    stats->last_buffers = stats->buffers;
+    stats->last_bytes = stats->bytes;
+    stats->last_ts = ts;
+  } else if (GST_IS_ELEMENT (object)) {
+    GstGraphStatsElement *stats = g_object_get_qdata ((GObject *) object,
+        data_quark);
+
+    if (stats == NULL)
+      goto done;
+
+    if (ts > stats->last_ts) {
+      gst_structure_set (structure, "busy", G_TYPE_DOUBLE,
+          (gdouble) (stats->proc_time - stats->last_proc_time) /
+          (ts - stats->last_ts), NULL);
+    }
+    if (stats->is_queue)
+      gst_structure_set (structure, "level-buffers", G_TYPE_UINT,
+          stats->level_buffers, "level-bytes", G_TYPE_UINT64,
+          stats->level_bytes, "level-time", G_TYPE_UINT64, stats->level_time,
+          NULL);
+
+    stats->last_proc_time = stats->proc_time;
+    stats->last_ts = ts;
+  }
+
+done:
+  g_mutex_unlock (&self->lock);
+}
+
+/* tracer class */
+
+static void
+gst_graph_stats_tracer_finalize (GObject * obj)
+{
+  GstGraphStatsTracer *self = GST_GRAPH_STATS_TRACER (obj);
+
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_graph_stats_tracer_class_init (GstGraphStatsTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_graph_stats_tracer_finalize;
+}
+
+static void
+gst_graph_stats_tracer_init (GstGraphStatsTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  g_mutex_init (&self->lock);
+
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_post));
+  gst_tracing_register_hook (tracer, "pad-pull-range-pre",
+      G_CALLBACK (do_pull_range_pre));
+  gst_tracing_register_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_pull_range_post));
+  gst_tracing_register_hook (tracer, "pad-query-post",
+      G_CALLBACK (do_query_post));
+  gst_tracing_register_hook (tracer, "queue-level",
+      G_CALLBACK (do_queue_level));
+  gst_tracing_register_hook (tracer, "graph-stats",
+      G_CALLBACK (do_graph_stats));
+}
@@ -0,0 +1,67 @@
+/* GStreamer
+ *
+ * gstgraphstats.h: tracing module with statistics for pipeline graphs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_GRAPH_STATS_TRACER_H__
+#define __GST_GRAPH_STATS_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_GRAPH_STATS_TRACER \
+  (gst_graph_stats_tracer_get_type())
+#define GST_GRAPH_STATS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_GRAPH_STATS_TRACER,GstGraphStatsTracer))
+#define GST_GRAPH_STATS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_GRAPH_STATS_TRACER,GstGraphStatsTracerClass))
+#define GST_IS_GRAPH_STATS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_GRAPH_STATS_TRACER))
+#define GST_IS_GRAPH_STATS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_GRAPH_STATS_TRACER))
+#define GST_GRAPH_STATS_TRACER_CAST(obj) ((GstGraphStatsTracer *)(obj))
+
+typedef struct _GstGraphStatsTracer GstGraphStatsTracer;
+typedef struct _GstGraphStatsTracerClass GstGraphStatsTracerClass;
+
+/**
+ * GstGraphStatsTracer:
+ *
+ * Opaque #GstGraphStatsTracer data structure
+ */
+struct _GstGraphStatsTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  /* protects the statistics */
+  GMutex lock;
+};
+
+struct _GstGraphStatsTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_graph_stats_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_GRAPH_STATS_TRACER_H__ */
@@ -24,6 +24,18 @@
  *
  * A tracing module that determines src-to-sink latencies by injecting custom
  * events at sources and process them at sinks.
+ *
+ * The events are only injected for the buffers sampled by the tracing
+ * subsystem, e.g. GST_TRACERS_SAMPLING=100 measures the latency of 1 in 100
+ * buffers.
+ *
+ * With the "element" flag, e.g. GST_TRACERS="latency(flags=pipeline+element)",
+ * the tracer also logs the time between a buffer entering an element through
+ * a sink pad and the next buffer leaving it through a src pad. Buffers that
+ * leave from another thread than the one they entered with, like in queues,
+ * are logged as "queue-latency" records instead of "element-latency" ones,
+ * matching the buffers in the order they entered. This is only measured in
+ * push mode and doesn't use sampling.
  */
 /* TODO(ensonic): if there are two sources feeding into a mixer/muxer and later
  * we fan-out with tee and have two sinks, each sink would get all two events,
@@ -51,8 +63,25 @@ G_DEFINE_TYPE_WITH_CODE (GstLatencyTracer, gst_latency_tracer, GST_TYPE_TRACER,
 static GQuark latency_probe_id;
 static GQuark latency_probe_pad;
 static GQuark latency_probe_ts;
+static GQuark element_data_quark;
 
 static GstTracerRecord *tr_latency;
+static GstTracerRecord *tr_element_latency;
+static GstTracerRecord *tr_queue_latency;
+
+/* don't let the entry times grow without bounds for elements that drop or
+ * combine buffers */
+#define MAX_PENDING_ENTRIES 1024
+
+/* buffers that entered an element and did not leave it yet */
+typedef struct
+{
+  GMutex lock;
+  /* thread of the buffer that entered last */
+  GThread *thread;
+  /* entry timestamps, oldest first */
+  GQueue entries;
+} GstLatencyElementData;
 
 /* data helpers */
 
@@ -143,14 +172,136 @@ calculate_latency (GstElement * parent, GstPad * pad, guint64 ts)
 static void
 do_push_buffer_pre (GstTracer * self, guint64 ts, GstPad * pad)
 {
-  GstPad *peer_pad = GST_PAD_PEER (pad);
   GstElement *parent = get_real_pad_parent (pad);
-  GstElement *peer_parent = get_real_pad_parent (peer_pad);
 
   send_latency_probe (parent, pad, ts);
+}
+
+static void
+do_receive_buffer_pre (GstTracer * self, guint64 ts, GstPad * pad)
+{
+  GstPad *peer_pad = GST_PAD_PEER (pad);
+  GstElement *peer_parent = get_real_pad_parent (peer_pad);
+
   calculate_latency (peer_parent, peer_pad, ts);
 }
 
+static void
+free_element_data (GstLatencyElementData * data)
+{
+  GstClockTime *entry;
+
+  while ((entry = g_queue_pop_head (&data->entries)))
+    g_slice_free (GstClockTime, entry);
+  g_mutex_clear (&data->lock);
+  g_slice_free (GstLatencyElementData, data);
+}
+
+static GstLatencyElementData *
+get_element_data (GstElement * element)
+{
+  GstLatencyElementData *data, *old;
+
+  data = g_object_get_qdata ((GObject *) element, element_data_quark);
+  if (G_LIKELY (data))
+    return data;
+
+  data = g_slice_new0 (GstLatencyElementData);
+  g_mutex_init (&data->lock);
+  g_queue_init (&data->entries);
+
+  /* another thread might have been faster */
+  GST_OBJECT_LOCK (element);
+  old = g_object_get_qdata ((GObject *) element, element_data_quark);
+  if (!old)
+    g_object_set_qdata_full ((GObject *) element, element_data_quark, data,
+        (GDestroyNotify) free_element_data);
+  GST_OBJECT_UNLOCK (element);
+
+  if (old) {
+    free_element_data (data);
+    data = old;
+  }
+  return data;
+}
+
+static inline gboolean
+is_real_element (GstElement * element)
+{
+  return element && !GST_IS_BIN (element);
+}
+
+/* a buffer leaves @element through @pad */
+static void
+element_buffer_leave (GstElement * element, GstPad * pad, guint64 ts)
+{
+  GstLatencyElementData *data;
+  GstClockTime *entry, entry_ts;
+  gboolean same_thread;
+  gchar *src;
+
+  if (GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_SOURCE))
+    return;
+
+  data = get_element_data (element);
+
+  g_mutex_lock (&data->lock);
+  if (!(entry = g_queue_pop_head (&data->entries))) {
+    g_mutex_unlock (&data->lock);
+    return;
+  }
+  entry_ts = *entry;
+  g_slice_free (GstClockTime, entry);
+
+  same_thread = (data->thread == g_thread_self ());
+  if (same_thread) {
+    /* everything that entered before was handled by this push */
+    while ((entry = g_queue_pop_head (&data->entries)))
+      g_slice_free (GstClockTime, entry);
+  }
+  g_mutex_unlock (&data->lock);
+
+  src = g_strdup_printf ("%s_%s", GST_DEBUG_PAD_NAME (pad));
+  gst_tracer_record_log (same_thread ? tr_element_latency : tr_queue_latency,
+      GST_OBJECT_NAME (element), src, GST_CLOCK_DIFF (entry_ts, ts));
+  g_free (src);
+}
+
+/* a buffer enters @element */
+static void
+element_buffer_enter (GstElement * element, guint64 ts)
+{
+  GstLatencyElementData *data;
+  GstClockTime *entry;
+
+  if (GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_SINK))
+    return;
+
+  data = get_element_data (element);
+
+  entry = g_slice_new (GstClockTime);
+  *entry = ts;
+
+  g_mutex_lock (&data->lock);
+  g_queue_push_tail (&data->entries, entry);
+  if (data->entries.length > MAX_PENDING_ENTRIES)
+    g_slice_free (GstClockTime, g_queue_pop_head (&data->entries));
+  data->thread = g_thread_self ();
+  g_mutex_unlock (&data->lock);
+}
+
+static void
+do_push_buffer_pre_element (GstTracer * self, guint64 ts, GstPad * pad)
+{
+  GstElement *parent = get_real_pad_parent (pad);
+  GstElement *peer_parent = get_real_pad_parent (GST_PAD_PEER (pad));
+
+  if (is_real_element (parent))
+    element_buffer_leave (parent, pad, ts);
+  if (is_real_element (peer_parent))
+    element_buffer_enter (peer_parent, ts);
+}
+
 static void
 do_pull_range_pre (GstTracer * self, guint64 ts, GstPad * pad)
 {
@@ -191,12 +342,132 @@ do_push_event_pre (GstTracer * self, guint64 ts, GstPad * pad, GstEvent * ev)
 
 /* tracer class */
 
+static void
+set_flags (GstLatencyTracer * self, const gchar * flags)
+{
+  gchar **split = g_strsplit (flags, "+", -1);
+  guint i;
+
+  self->flags = GST_LATENCY_TRACER_FLAG_NONE;
+  for (i = 0; split[i]; i++) {
+    if (g_str_equal (split[i], "pipeline"))
+      self->flags |= GST_LATENCY_TRACER_FLAG_PIPELINE;
+    else if (g_str_equal (split[i], "element"))
+      self->flags |= GST_LATENCY_TRACER_FLAG_ELEMENT;
+    else
+      GST_WARNING_OBJECT (self, "unknown flag '%s'", split[i]);
+  }
+  g_strfreev (split);
+}
+
+static void
+set_params (GstLatencyTracer * self)
+{
+  gchar *params, *tmp;
+  GstStructure *params_struct;
+  const gchar *flags;
+
+  g_object_get (self, "params", &params, NULL);
+  if (!params)
+    return;
+
+  tmp = g_strdup_printf ("latency,%s", params);
+  params_struct = gst_structure_from_string (tmp, NULL);
+  g_free (tmp);
+
+  if (params_struct) {
+    if ((flags = gst_structure_get_string (params_struct, "flags")))
+      set_flags (self, flags);
+    gst_structure_free (params_struct);
+  } else {
+    GST_WARNING_OBJECT (self, "invalid params '%s'", params);
+  }
+  g_free (params);
+}
+
+static void
+gst_latency_tracer_constructed (GObject * object)
+{
+  GstLatencyTracer *self = GST_LATENCY_TRACER (object);
+  GstTracer *tracer = GST_TRACER (object);
+
+  set_params (self);
+
+  if (self->flags & GST_LATENCY_TRACER_FLAG_PIPELINE) {
+    /* in push mode, pre/post will be called before/after the peer chain
+     * function has been called. For this reaosn, we only use -pre to avoid
+     * accounting for the processing time of the peer element (the sink).
+     * Probes are only sent for sampled buffers, but the sinks always need to
+     * check for a pending probe */
+    gst_tracing_register_sampled_hook (tracer, "pad-push-pre",
+        G_CALLBACK (do_push_buffer_pre));
+    gst_tracing_register_sampled_hook (tracer, "pad-push-list-pre",
+        G_CALLBACK (do_push_buffer_pre));
+    gst_tracing_register_hook (tracer, "pad-push-pre",
+        G_CALLBACK (do_receive_buffer_pre));
+    gst_tracing_register_hook (tracer, "pad-push-list-pre",
+        G_CALLBACK (do_receive_buffer_pre));
+
+    /* while in pull mode, pre/post will happend before and after the upstream
+     * pull_range call is made, so it already only account for the upstream
+     * processing time. As a side effect, in pull mode, we can measure the
+     * source processing latency, while in push mode, we can't */
+    gst_tracing_register_sampled_hook (tracer, "pad-pull-range-pre",
+        G_CALLBACK (do_pull_range_pre));
+    gst_tracing_register_hook (tracer, "pad-pull-range-post",
+        G_CALLBACK (do_pull_range_post));
+
+    gst_tracing_register_hook (tracer, "pad-push-event-pre",
+        G_CALLBACK (do_push_event_pre));
+  }
+
+  if (self->flags & GST_LATENCY_TRACER_FLAG_ELEMENT) {
+    /* the entry and exit of a buffer are different calls, so this can't be
+     * sampled */
+    gst_tracing_register_hook (tracer, "pad-push-pre",
+        G_CALLBACK (do_push_buffer_pre_element));
+    gst_tracing_register_hook (tracer, "pad-push-list-pre",
+        G_CALLBACK (do_push_buffer_pre_element));
+  }
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+}
+
+static GstTracerRecord *
+new_element_record (const gchar * name, const gchar * description)
+{
+  /* *INDENT-OFF* */
+  return gst_tracer_record_new (name,
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE,
+              GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "src", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_PAD,
+          NULL),
+      "time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, description,
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64,
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+}
+
 static void
 gst_latency_tracer_class_init (GstLatencyTracerClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gst_latency_tracer_constructed;
+
   latency_probe_id = g_quark_from_static_string ("latency_probe.id");
   latency_probe_pad = g_quark_from_static_string ("latency_probe.pad");
   latency_probe_ts = g_quark_from_static_string ("latency_probe.ts");
+  element_data_quark = g_quark_from_static_string ("latency_element.data");
 
   /* announce trace formats */
   /* *INDENT-OFF* */
@@ -218,30 +489,16 @@ gst_latency_tracer_class_init (GstLatencyTracerClass * klass)
           NULL),
       NULL);
   /* *INDENT-ON* */
+
+  tr_element_latency = new_element_record ("element-latency.class",
+      "time it took for the buffer to go from a sink pad to a src pad of the "
+      "element in ns");
+  tr_queue_latency = new_element_record ("queue-latency.class",
+      "time the buffer was queued in the element in ns");
 }
 
 static void
 gst_latency_tracer_init (GstLatencyTracer * self)
 {
-  GstTracer *tracer = GST_TRACER (self);
-
-  /* in push mode, pre/post will be called before/after the peer chain
-   * function has been called. For this reaosn, we only use -pre to avoid
-   * accounting for the processing time of the peer element (the sink) */
-  gst_tracing_register_hook (tracer, "pad-push-pre",
-      G_CALLBACK (do_push_buffer_pre));
-  gst_tracing_register_hook (tracer, "pad-push-list-pre",
-      G_CALLBACK (do_push_buffer_pre));
-
-  /* while in pull mode, pre/post will happend before and after the upstream
-   * pull_range call is made, so it already only account for the upstream
-   * processing time. As a side effect, in pull mode, we can measure the
-   * source processing latency, while in push mode, we can't */
-  gst_tracing_register_hook (tracer, "pad-pull-range-pre",
-      G_CALLBACK (do_pull_range_pre));
-  gst_tracing_register_hook (tracer, "pad-pull-range-post",
-      G_CALLBACK (do_pull_range_post));
-
-  gst_tracing_register_hook (tracer, "pad-push-event-pre",
-      G_CALLBACK (do_push_event_pre));
+  self->flags = GST_LATENCY_TRACER_FLAG_PIPELINE;
 }
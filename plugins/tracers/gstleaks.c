@@ -26,6 +26,27 @@
  * alive when program is exiting and raising a warning.
  * The type of objects tracked can be filtered using the parameters of the
  * tracer, for example: GST_TRACERS=leaks(filters="GstEvent,GstMessage",stack-traces-flags=full)
+ *
+ * To keep the tracer cheap enough for long running processes only one in
+ * "sampling" created objects can be tracked, for example with
+ * GST_TRACERS=leaks(sampling=100). The objects that are not sampled are never
+ * seen again by the tracer.
+ *
+ * The objects created and destroyed since the previous checkpoint are logged
+ * as "object-added" and "object-removed" records every "checkpoint-interval"
+ * seconds if it is set. The application can also trigger the same actions
+ * while running by posting an application message with a "GstLeaksTracer"
+ * structure on any element with gst_element_post_message(). Its "action"
+ * field is one of:
+ *
+ * * "log-live-objects": log the objects currently alive
+ * * "start-tracking": start listing the objects created and destroyed
+ * * "checkpoint": log the objects created and destroyed since the previous
+ *   checkpoint, starting the tracking if needed
+ * * "stop-tracking": stop listing the objects created and destroyed
+ *
+ * On UNIX systems SIGUSR1 and SIGUSR2 do "log-live-objects" and "checkpoint"
+ * when the GST_LEAKS_TRACER_SIG environment variable is set.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -34,6 +55,8 @@
 
 #include "gstleaks.h"
 
+#include <string.h>
+
 #ifdef G_OS_UNIX
 #include <signal.h>
 #endif /* G_OS_UNIX */
@@ -49,10 +72,8 @@ G_DEFINE_TYPE_WITH_CODE (GstLeaksTracer, gst_leaks_tracer,
 
 static GstTracerRecord *tr_alive;
 static GstTracerRecord *tr_refings;
-#ifdef G_OS_UNIX
-static GstTracerRecord *tr_added = NULL;
-static GstTracerRecord *tr_removed = NULL;
-#endif /* G_OS_UNIX */
+static GstTracerRecord *tr_added;
+static GstTracerRecord *tr_removed;
 static GQueue instances = G_QUEUE_INIT;
 
 typedef struct
@@ -163,6 +184,11 @@ set_params_from_structure (GstLeaksTracer * self, GstStructure * params)
   if (filters)
     set_filters (self, filters);
   gst_structure_get_boolean (params, "check-refs", &self->check_refs);
+  gst_structure_get_uint (params, "sampling", &self->sampling);
+  if (self->sampling == 0)
+    self->sampling = 1;
+  gst_structure_get_uint (params, "checkpoint-interval",
+      &self->checkpoint_interval);
 }
 
 static void
@@ -241,7 +267,6 @@ should_handle_object_type (GstLeaksTracer * self, GType object_type)
   return FALSE;
 }
 
-#ifdef G_OS_UNIX
 /* The object may be destroyed when we log it using the checkpointing system so
  * we have to save its type name */
 typedef struct
@@ -270,12 +295,54 @@ object_log_free (ObjectLog * obj)
 {
   g_slice_free (ObjectLog, obj);
 }
-#endif /* G_OS_UNIX */
+
+/* The objects are spread over a number of shards by their address with a lock
+ * each, so that threads creating and destroying objects rarely wait for each
+ * other */
+#define N_SHARDS 16
+
+struct _GstLeaksShard
+{
+  GMutex lock;
+  /* gpointer (object currently alive) -> ObjectRefingInfos */
+  GHashTable *objects;
+  /* Sets of owned ObjectLog, only while tracking the activity */
+  GHashTable *added;
+  GHashTable *removed;
+};
+
+static inline GstLeaksShard *
+get_shard (GstLeaksTracer * self, gpointer object)
+{
+  /* the lowest bits are the same for all objects because of the alignment */
+  return &self->shards[(GPOINTER_TO_SIZE (object) >> 4) % N_SHARDS];
+}
+
+/* shards are always locked in the same order */
+static void
+lock_shards (GstLeaksTracer * self)
+{
+  guint i;
+
+  for (i = 0; i < N_SHARDS; i++)
+    g_mutex_lock (&self->shards[i].lock);
+}
+
+static void
+unlock_shards (GstLeaksTracer * self)
+{
+  guint i;
+
+  for (i = N_SHARDS; i > 0; i--)
+    g_mutex_unlock (&self->shards[i - 1].lock);
+}
 
 static void
 handle_object_destroyed (GstLeaksTracer * self, gpointer object)
 {
-  GST_OBJECT_LOCK (self);
+  GstLeaksShard *shard = get_shard (self, object);
+
+  g_mutex_lock (&shard->lock);
   if (self->done) {
     g_warning
         ("object %p destroyed while the leaks tracer was finalizing. Some threads are still running?",
@@ -283,13 +350,11 @@ handle_object_destroyed (GstLeaksTracer * self, gpointer object)
     goto out;
   }
 
-  g_hash_table_remove (self->objects, object);
-#ifdef G_OS_UNIX
-  if (self->removed)
-    g_hash_table_add (self->removed, object_log_new (object));
-#endif /* G_OS_UNIX */
+  g_hash_table_remove (shard->objects, object);
+  if (shard->removed)
+    g_hash_table_add (shard->removed, object_log_new (object));
 out:
-  GST_OBJECT_UNLOCK (self);
+  g_mutex_unlock (&shard->lock);
 }
 
 static void
@@ -313,11 +378,17 @@ handle_object_created (GstLeaksTracer * self, gpointer object, GType type,
     gboolean gobject)
 {
   ObjectRefingInfos *infos;
-
+  GstLeaksShard *shard;
 
   if (!should_handle_object_type (self, type))
     return;
 
+  /* only track one in sampling objects, the others are not even weak
+   * reffed so they cost nothing when they are destroyed */
+  if (self->sampling > 1 &&
+      ((guint) g_atomic_int_add (&self->sample_count, 1)) % self->sampling)
+    return;
+
   infos = g_malloc0 (sizeof (ObjectRefingInfos));
   if (gobject)
     g_object_weak_ref ((GObject *) object, object_weak_cb, self);
@@ -325,17 +396,15 @@ handle_object_created (GstLeaksTracer * self, gpointer object, GType type,
     gst_mini_object_weak_ref (GST_MINI_OBJECT_CAST (object),
         mini_object_weak_cb, self);
 
-  GST_OBJECT_LOCK (self);
   if ((gint) self->trace_flags != -1)
     infos->creation_trace = gst_debug_get_stack_trace (self->trace_flags);
 
-  g_hash_table_insert (self->objects, object, infos);
-
-#ifdef G_OS_UNIX
-  if (self->added)
-    g_hash_table_add (self->added, object_log_new (object));
-#endif /* G_OS_UNIX */
-  GST_OBJECT_UNLOCK (self);
+  shard = get_shard (self, object);
+  g_mutex_lock (&shard->lock);
+  g_hash_table_insert (shard->objects, object, infos);
+  if (shard->added)
+    g_hash_table_add (shard->added, object_log_new (object));
+  g_mutex_unlock (&shard->lock);
 }
 
 static void
@@ -366,12 +435,14 @@ handle_object_reffed (GstLeaksTracer * self, gpointer object, gint new_refcount,
 {
   ObjectRefingInfos *infos;
   ObjectRefingInfo *refinfo;
+  GstLeaksShard *shard;
 
   if (!self->check_refs)
     return;
 
-  GST_OBJECT_LOCK (self);
-  infos = g_hash_table_lookup (self->objects, object);
+  shard = get_shard (self, object);
+  g_mutex_lock (&shard->lock);
+  infos = g_hash_table_lookup (shard->objects, object);
   if (!infos)
     goto out;
 
@@ -385,7 +456,7 @@ handle_object_reffed (GstLeaksTracer * self, gpointer object, gint new_refcount,
   infos->refing_infos = g_list_prepend (infos->refing_infos, refinfo);
 
 out:
-  GST_OBJECT_UNLOCK (self);
+  g_mutex_unlock (&shard->lock);
 }
 
 static void
@@ -424,11 +495,147 @@ mini_object_unreffed_cb (GstTracer * tracer, GstClockTime ts,
   handle_object_reffed (self, object, new_refcount, FALSE, ts);
 }
 
+static gboolean log_leaked (GstLeaksTracer * self);
+
+static void
+log_checkpoint (GHashTable * hash, GstTracerRecord * record)
+{
+  GHashTableIter iter;
+  gpointer o;
+
+  g_hash_table_iter_init (&iter, hash);
+  while (g_hash_table_iter_next (&iter, &o, NULL)) {
+    ObjectLog *obj = o;
+
+    gst_tracer_record_log (record, obj->type_name, obj->object);
+  }
+}
+
+/* Start listing the objects created and destroyed from now on, or log those
+ * since the previous checkpoint. Must be called with all the shards locked */
+static void
+do_checkpoint (GstLeaksTracer * self)
+{
+  guint i;
+
+  if (!self->shards[0].added) {
+    GST_TRACE_OBJECT (self, "First checkpoint, start tracking objects");
+
+    for (i = 0; i < N_SHARDS; i++) {
+      self->shards[i].added = g_hash_table_new_full (NULL, NULL,
+          (GDestroyNotify) object_log_free, NULL);
+      self->shards[i].removed = g_hash_table_new_full (NULL, NULL,
+          (GDestroyNotify) object_log_free, NULL);
+    }
+    return;
+  }
+
+  GST_TRACE_OBJECT (self, "listing objects created since last checkpoint");
+  for (i = 0; i < N_SHARDS; i++)
+    log_checkpoint (self->shards[i].added, tr_added);
+  GST_TRACE_OBJECT (self, "listing objects removed since last checkpoint");
+  for (i = 0; i < N_SHARDS; i++)
+    log_checkpoint (self->shards[i].removed, tr_removed);
+
+  for (i = 0; i < N_SHARDS; i++) {
+    g_hash_table_remove_all (self->shards[i].added);
+    g_hash_table_remove_all (self->shards[i].removed);
+  }
+}
+
+/* Must be called with all the shards locked */
+static void
+stop_tracking (GstLeaksTracer * self)
+{
+  guint i;
+
+  GST_TRACE_OBJECT (self, "stop tracking objects");
+
+  for (i = 0; i < N_SHARDS; i++) {
+    g_clear_pointer (&self->shards[i].added, g_hash_table_unref);
+    g_clear_pointer (&self->shards[i].removed, g_hash_table_unref);
+  }
+}
+
+static gpointer
+checkpoint_thread_func (GstLeaksTracer * self)
+{
+  gint64 end_time;
+
+  g_mutex_lock (&self->checkpoint_lock);
+  end_time = g_get_monotonic_time ();
+  while (!self->checkpoint_stop) {
+    end_time += self->checkpoint_interval * G_TIME_SPAN_SECOND;
+    while (!self->checkpoint_stop &&
+        g_cond_wait_until (&self->checkpoint_cond, &self->checkpoint_lock,
+            end_time));
+    if (self->checkpoint_stop)
+      break;
+
+    lock_shards (self);
+    do_checkpoint (self);
+    unlock_shards (self);
+  }
+  g_mutex_unlock (&self->checkpoint_lock);
+
+  return NULL;
+}
+
+static void
+element_post_message_pre_cb (GstTracer * tracer, GstClockTime ts,
+    GstElement * element, GstMessage * msg)
+{
+  GstLeaksTracer *self = GST_LEAKS_TRACER_CAST (tracer);
+  const GstStructure *s;
+  const gchar *action;
+
+  if (GST_MESSAGE_TYPE (msg) != GST_MESSAGE_APPLICATION)
+    return;
+
+  s = gst_message_get_structure (msg);
+  if (!s || !gst_structure_has_name (s, "GstLeaksTracer"))
+    return;
+
+  action = gst_structure_get_string (s, "action");
+  if (!action) {
+    GST_WARNING_OBJECT (self, "%" GST_PTR_FORMAT " has no action", msg);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "action '%s' posted by %" GST_PTR_FORMAT, action,
+      element);
+
+  lock_shards (self);
+  if (!strcmp (action, "log-live-objects")) {
+    log_leaked (self);
+  } else if (!strcmp (action, "start-tracking")) {
+    if (!self->shards[0].added)
+      do_checkpoint (self);
+  } else if (!strcmp (action, "checkpoint")) {
+    do_checkpoint (self);
+  } else if (!strcmp (action, "stop-tracking")) {
+    stop_tracking (self);
+  } else {
+    GST_WARNING_OBJECT (self, "unknown action '%s'", action);
+  }
+  unlock_shards (self);
+}
+
 static void
 gst_leaks_tracer_init (GstLeaksTracer * self)
 {
-  self->objects = g_hash_table_new_full (NULL, NULL, NULL,
-      (GDestroyNotify) object_refing_infos_free);
+  guint i;
+
+  self->shards = g_new0 (GstLeaksShard, N_SHARDS);
+  for (i = 0; i < N_SHARDS; i++) {
+    g_mutex_init (&self->shards[i].lock);
+    self->shards[i].objects = g_hash_table_new_full (NULL, NULL, NULL,
+        (GDestroyNotify) object_refing_infos_free);
+  }
+
+  self->sampling = 1;
+  g_mutex_init (&self->checkpoint_lock);
+  g_cond_init (&self->checkpoint_cond);
 
   g_queue_push_tail (&instances, self);
 }
@@ -445,6 +652,8 @@ gst_leaks_tracer_constructed (GObject * object)
       G_CALLBACK (mini_object_created_cb));
   gst_tracing_register_hook (tracer, "object-created",
       G_CALLBACK (object_created_cb));
+  gst_tracing_register_hook (tracer, "element-post-message-pre",
+      G_CALLBACK (element_post_message_pre_cb));
 
   if (self->check_refs) {
     gst_tracing_register_hook (tracer, "object-reffed",
@@ -461,6 +670,15 @@ gst_leaks_tracer_constructed (GObject * object)
    * are notified of objects being destroyed even during the shuting down of
    * the tracing system. */
 
+  if (self->checkpoint_interval > 0) {
+    lock_shards (self);
+    do_checkpoint (self);
+    unlock_shards (self);
+
+    self->checkpoint_thread = g_thread_new ("leaks-checkpoint",
+        (GThreadFunc) checkpoint_thread_func, self);
+  }
+
   ((GObjectClass *) gst_leaks_tracer_parent_class)->constructed (object);
 }
 
@@ -473,8 +691,8 @@ typedef struct
   ObjectRefingInfos *infos;
 } Leak;
 
-/* The content of the returned Leak struct is valid until the self->objects
- * hash table has been modified. */
+/* The content of the returned Leak struct is valid until the objects hash
+ * tables of the shards have been modified. */
 static Leak *
 leak_new (gpointer obj, GType type, guint ref_count, ObjectRefingInfos * infos)
 {
@@ -510,27 +728,31 @@ create_leaks_list (GstLeaksTracer * self)
   GList *l = NULL;
   GHashTableIter iter;
   gpointer obj, infos;
+  guint i;
 
-  g_hash_table_iter_init (&iter, self->objects);
-  while (g_hash_table_iter_next (&iter, &obj, &infos)) {
-    GType type;
-    guint ref_count;
+  for (i = 0; i < N_SHARDS; i++) {
+    g_hash_table_iter_init (&iter, self->shards[i].objects);
+    while (g_hash_table_iter_next (&iter, &obj, &infos)) {
+      GType type;
+      guint ref_count;
 
-    if (GST_IS_OBJECT (obj)) {
-      if (GST_OBJECT_FLAG_IS_SET (obj, GST_OBJECT_FLAG_MAY_BE_LEAKED))
-        continue;
+      if (GST_IS_OBJECT (obj)) {
+        if (GST_OBJECT_FLAG_IS_SET (obj, GST_OBJECT_FLAG_MAY_BE_LEAKED))
+          continue;
 
-      type = G_OBJECT_TYPE (obj);
-      ref_count = ((GObject *) obj)->ref_count;
-    } else {
-      if (GST_MINI_OBJECT_FLAG_IS_SET (obj, GST_MINI_OBJECT_FLAG_MAY_BE_LEAKED))
-        continue;
+        type = G_OBJECT_TYPE (obj);
+        ref_count = ((GObject *) obj)->ref_count;
+      } else {
+        if (GST_MINI_OBJECT_FLAG_IS_SET (obj,
+                GST_MINI_OBJECT_FLAG_MAY_BE_LEAKED))
+          continue;
 
-      type = GST_MINI_OBJECT_TYPE (obj);
-      ref_count = ((GstMiniObject *) obj)->refcount;
-    }
+        type = GST_MINI_OBJECT_TYPE (obj);
+        ref_count = ((GstMiniObject *) obj)->refcount;
+      }
 
-    l = g_list_prepend (l, leak_new (obj, type, ref_count, infos));
+      l = g_list_prepend (l, leak_new (obj, type, ref_count, infos));
+    }
   }
 
   /* Sort leaks by type name so they are grouped together making the output
@@ -540,7 +762,8 @@ create_leaks_list (GstLeaksTracer * self)
   return l;
 }
 
-/* Return TRUE if at least one leaked object has been logged */
+/* Return TRUE if at least one leaked object has been logged. Must be called
+ * with all the shards locked */
 static gboolean
 log_leaked (GstLeaksTracer * self)
 {
@@ -570,6 +793,8 @@ log_leaked (GstLeaksTracer * self)
           leak->obj, refinfo->reffed ? "reffed" : "unreffed",
           refinfo->new_refcount, refinfo->trace ? refinfo->trace : "");
     }
+    /* keep the order in which the infos are prepended */
+    leak->infos->refing_infos = g_list_reverse (leak->infos->refing_infos);
   }
 
   g_list_free_full (leaks, (GDestroyNotify) leak_free);
@@ -589,29 +814,50 @@ gst_leaks_tracer_finalize (GObject * object)
   gboolean leaks;
   GHashTableIter iter;
   gpointer obj;
+  guint i;
+
+  if (self->checkpoint_thread) {
+    g_mutex_lock (&self->checkpoint_lock);
+    self->checkpoint_stop = TRUE;
+    g_cond_signal (&self->checkpoint_cond);
+    g_mutex_unlock (&self->checkpoint_lock);
+    g_thread_join (self->checkpoint_thread);
+    self->checkpoint_thread = NULL;
+  }
 
+  lock_shards (self);
   self->done = TRUE;
 
   /* Tracers are destroyed as part of gst_deinit() so now is a good time to
    * report all the objects which are still alive. */
   leaks = log_leaked (self);
+  unlock_shards (self);
 
   /* Remove weak references */
-  g_hash_table_iter_init (&iter, self->objects);
-  while (g_hash_table_iter_next (&iter, &obj, NULL)) {
-    if (GST_IS_OBJECT (obj))
-      g_object_weak_unref (obj, object_weak_cb, self);
-    else
-      gst_mini_object_weak_unref (GST_MINI_OBJECT_CAST (obj),
-          mini_object_weak_cb, self);
+  for (i = 0; i < N_SHARDS; i++) {
+    GstLeaksShard *shard = &self->shards[i];
+
+    g_hash_table_iter_init (&iter, shard->objects);
+    while (g_hash_table_iter_next (&iter, &obj, NULL)) {
+      if (GST_IS_OBJECT (obj))
+        g_object_weak_unref (obj, object_weak_cb, self);
+      else
+        gst_mini_object_weak_unref (GST_MINI_OBJECT_CAST (obj),
+            mini_object_weak_cb, self);
+    }
+
+    g_clear_pointer (&shard->objects, g_hash_table_unref);
+    g_clear_pointer (&shard->added, g_hash_table_unref);
+    g_clear_pointer (&shard->removed, g_hash_table_unref);
+    g_mutex_clear (&shard->lock);
   }
+  g_free (self->shards);
 
-  g_clear_pointer (&self->objects, g_hash_table_unref);
   if (self->filter)
     g_array_free (self->filter, TRUE);
-  g_clear_pointer (&self->added, g_hash_table_unref);
-  g_clear_pointer (&self->removed, g_hash_table_unref);
   g_clear_pointer (&self->unhandled_filter, g_hash_table_unref);
+  g_mutex_clear (&self->checkpoint_lock);
+  g_cond_clear (&self->checkpoint_cond);
 
   g_queue_remove (&instances, self);
 
@@ -659,9 +905,9 @@ sig_usr1_handler_foreach (gpointer data, gpointer user_data)
 {
   GstLeaksTracer *tracer = data;
 
-  GST_OBJECT_LOCK (tracer);
+  lock_shards (tracer);
   log_leaked (tracer);
-  GST_OBJECT_UNLOCK (tracer);
+  unlock_shards (tracer);
 }
 
 static void
@@ -670,51 +916,14 @@ sig_usr1_handler (G_GNUC_UNUSED int signal)
   g_queue_foreach (&instances, sig_usr1_handler_foreach, NULL);
 }
 
-static void
-log_checkpoint (GHashTable * hash, GstTracerRecord * record)
-{
-  GHashTableIter iter;
-  gpointer o;
-
-  g_hash_table_iter_init (&iter, hash);
-  while (g_hash_table_iter_next (&iter, &o, NULL)) {
-    ObjectLog *obj = o;
-
-    gst_tracer_record_log (record, obj->type_name, obj->object);
-  }
-}
-
-static void
-do_checkpoint (GstLeaksTracer * self)
-{
-  GST_TRACE_OBJECT (self, "listing objects created since last checkpoint");
-  log_checkpoint (self->added, tr_added);
-  GST_TRACE_OBJECT (self, "listing objects removed since last checkpoint");
-  log_checkpoint (self->removed, tr_removed);
-
-  g_hash_table_remove_all (self->added);
-  g_hash_table_remove_all (self->removed);
-}
-
 static void
 sig_usr2_handler_foreach (gpointer data, gpointer user_data)
 {
   GstLeaksTracer *tracer = data;
 
-  GST_OBJECT_LOCK (tracer);
-
-  if (!tracer->added) {
-    GST_TRACE_OBJECT (tracer, "First checkpoint, start tracking objects");
-
-    tracer->added = g_hash_table_new_full (NULL, NULL,
-        (GDestroyNotify) object_log_free, NULL);
-    tracer->removed = g_hash_table_new_full (NULL, NULL,
-        (GDestroyNotify) object_log_free, NULL);
-  } else {
-    do_checkpoint (tracer);
-  }
-
-  GST_OBJECT_UNLOCK (tracer);
+  lock_shards (tracer);
+  do_checkpoint (tracer);
+  unlock_shards (tracer);
 }
 
 static void
@@ -726,14 +935,6 @@ sig_usr2_handler (G_GNUC_UNUSED int signal)
 static void
 setup_signals (void)
 {
-  tr_added = gst_tracer_record_new ("object-added.class",
-      RECORD_FIELD_TYPE_NAME, RECORD_FIELD_ADDRESS, NULL);
-  GST_OBJECT_FLAG_SET (tr_added, GST_OBJECT_FLAG_MAY_BE_LEAKED);
-
-  tr_removed = gst_tracer_record_new ("object-removed.class",
-      RECORD_FIELD_TYPE_NAME, RECORD_FIELD_ADDRESS, NULL);
-  GST_OBJECT_FLAG_SET (tr_removed, GST_OBJECT_FLAG_MAY_BE_LEAKED);
-
   signal (SIGUSR1, sig_usr1_handler);
   signal (SIGUSR2, sig_usr2_handler);
 }
@@ -757,6 +958,14 @@ gst_leaks_tracer_class_init (GstLeaksTracerClass * klass)
       RECORD_FIELD_DESC, RECORD_FIELD_REF_COUNT, RECORD_FIELD_TRACE, NULL);
   GST_OBJECT_FLAG_SET (tr_alive, GST_OBJECT_FLAG_MAY_BE_LEAKED);
 
+  tr_added = gst_tracer_record_new ("object-added.class",
+      RECORD_FIELD_TYPE_NAME, RECORD_FIELD_ADDRESS, NULL);
+  GST_OBJECT_FLAG_SET (tr_added, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+
+  tr_removed = gst_tracer_record_new ("object-removed.class",
+      RECORD_FIELD_TYPE_NAME, RECORD_FIELD_ADDRESS, NULL);
+  GST_OBJECT_FLAG_SET (tr_removed, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+
   if (g_getenv ("GST_LEAKS_TRACER_SIG")) {
 #ifdef G_OS_UNIX
     setup_signals ();
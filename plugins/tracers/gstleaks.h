@@ -41,6 +41,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstLeaksTracer GstLeaksTracer;
 typedef struct _GstLeaksTracerClass GstLeaksTracerClass;
+typedef struct _GstLeaksShard GstLeaksShard;
 
 /**
  * GstLeaksTracer:
@@ -51,24 +52,31 @@ struct _GstLeaksTracer {
   GstTracer parent;
 
   /*< private >*/
-  /* gpointer (object currently alive) -> gchar * (its creation trace, or
-   * NULL). Protected by object lock */
-  GHashTable *objects;
+  /* the objects currently alive and those added and removed since the last
+   * checkpoint, spread over shards protected by their own lock */
+  GstLeaksShard *shards;
   /* array of GType used as filtering */
   GArray *filter;
-  /* Set of owned ObjectLog.  Protected by object lock */
-  GHashTable *added;
-  /* Set of owned ObjectLog.  Protected by object lock */
-  GHashTable *removed;
   /* If not NULL, contain a set of string representing type filter not
    * (yet?) known by the type system.
    * Protected by object lock. */
   GHashTable *unhandled_filter;
   /* The number of elements in unhandled_filter */
   gint unhandled_filter_count;
+  /* Set with all the shards locked */
   gboolean done;
 
   gboolean check_refs;
+  /* track one in sampling created objects */
+  guint sampling;
+  gint sample_count;
+
+  /* periodic checkpoints, in seconds or 0 */
+  guint checkpoint_interval;
+  GThread *checkpoint_thread;
+  GMutex checkpoint_lock;
+  GCond checkpoint_cond;
+  gboolean checkpoint_stop;
 
   GstStackTraceFlags trace_flags;
 };
@@ -0,0 +1,439 @@
+/* GStreamer
+ *
+ * gstnegotiation.c: tracing module that records caps negotiation costs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstnegotiation
+ * @short_description: log caps negotiation costs
+ *
+ * A tracing module that counts the CAPS, ACCEPT_CAPS and ALLOCATION queries
+ * each element answers and how long it takes for them, without the time
+ * spent in the queries it sends to its peers in turn, e.g. from
+ * gst_pad_proxy_query_caps(). It also records how deep the query was nested
+ * when the element got it, the largest caps it returned and how many caps
+ * and reconfigure events it sent, which shows renegotiation storms.
+ *
+ * The statistics are logged as "element-negotiation" records when a
+ * pipeline goes from PAUSED to READY and when the tracer is destroyed.
+ * gst-stats prints a summary of them.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstnegotiation.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_negotiation_debug);
+#define GST_CAT_DEFAULT gst_negotiation_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_negotiation_debug, "negotiation", 0, \
+        "negotiation tracer");
+#define gst_negotiation_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstNegotiationTracer, gst_negotiation_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GstTracerRecord *tr_element;
+static gint tracer_id;          /* 0 */
+
+typedef struct
+{
+  gchar *name;
+  guint caps_queries;
+  guint accept_caps_queries;
+  guint allocation_queries;
+  /* time spent answering the queries, without nested queries */
+  GstClockTime time;
+  guint max_depth;
+  guint max_caps_size;
+  guint caps_events;
+  guint reconfigure_events;
+} GstNegotiationEntry;
+
+/* a query that is in progress */
+typedef struct
+{
+  GstPad *pad;
+  GstQuery *query;
+  guint ix;
+  GstClockTime start;
+  /* time spent in nested queries */
+  GstClockTime nested;
+} GstNegotiationFrame;
+
+typedef struct
+{
+  GArray *frames;
+} GstNegotiationThread;
+
+static void
+free_thread (GstNegotiationThread * thread)
+{
+  g_array_free (thread->frames, TRUE);
+  g_slice_free (GstNegotiationThread, thread);
+}
+
+/* GstNegotiationThread of each tracer instance in this thread, keyed by the
+ * id of the instance. They are freed when the thread exits, ids are never
+ * reused so the data of a destroyed tracer is never picked up again. */
+static GPrivate thread_key = G_PRIVATE_INIT ((GDestroyNotify)
+    g_hash_table_unref);
+
+/* data helpers */
+
+static GstNegotiationThread *
+get_thread (GstNegotiationTracer * self)
+{
+  GHashTable *threads = g_private_get (&thread_key);
+  GstNegotiationThread *thread;
+
+  if (G_UNLIKELY (threads == NULL)) {
+    threads = g_hash_table_new_full (NULL, NULL, NULL,
+        (GDestroyNotify) free_thread);
+    g_private_set (&thread_key, threads);
+  }
+
+  thread = g_hash_table_lookup (threads, GUINT_TO_POINTER (self->id));
+  if (G_UNLIKELY (thread == NULL)) {
+    thread = g_slice_new0 (GstNegotiationThread);
+    thread->frames = g_array_new (FALSE, FALSE, sizeof (GstNegotiationFrame));
+    g_hash_table_insert (threads, GUINT_TO_POINTER (self->id), thread);
+  }
+  return thread;
+}
+
+static void
+free_entry (GstNegotiationEntry * entry)
+{
+  g_free (entry->name);
+  g_slice_free (GstNegotiationEntry, entry);
+}
+
+/*
+ * Get the element/bin owning the pad.
+ *
+ * in: a normal pad
+ * out: the element
+ *
+ * in: a proxy pad
+ * out: the element that contains the peer of the proxy
+ *
+ * in: a ghost pad
+ * out: the bin owning the ghostpad
+ */
+static GstElement *
+get_real_pad_parent (GstPad * pad)
+{
+  GstObject *parent;
+
+  if (!pad)
+    return NULL;
+
+  parent = GST_OBJECT_PARENT (pad);
+
+  /* if parent of pad is a ghost-pad, then pad is a proxy_pad */
+  if (parent && GST_IS_GHOST_PAD (parent)) {
+    pad = GST_PAD_CAST (parent);
+    parent = GST_OBJECT_PARENT (pad);
+  }
+  return GST_ELEMENT_CAST (parent);
+}
+
+/* The index of the entry for the element of @pad, kept in the qdata of the
+ * element. The entries stay in the tracer to log them after the element is
+ * gone. Must be called with the lock. */
+static guint
+get_entry_ix (GstNegotiationTracer * self, GstPad * pad)
+{
+  GstElement *element = get_real_pad_parent (pad);
+  GstNegotiationEntry *entry;
+  guint ix;
+
+  if (!element)
+    return G_MAXUINT;
+
+  ix = GPOINTER_TO_UINT (g_object_get_qdata ((GObject *) element,
+          self->entry_quark));
+  if (G_LIKELY (ix))
+    return ix - 1;
+
+  entry = g_slice_new0 (GstNegotiationEntry);
+  entry->name = g_strdup (GST_OBJECT_NAME (element));
+  g_ptr_array_add (self->entries, entry);
+  ix = self->entries->len;
+  g_object_set_qdata ((GObject *) element, self->entry_quark,
+      GUINT_TO_POINTER (ix));
+
+  return ix - 1;
+}
+
+static gboolean
+is_negotiation_query (GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    case GST_QUERY_ACCEPT_CAPS:
+    case GST_QUERY_ALLOCATION:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+static void
+log_entries (GstNegotiationTracer * self)
+{
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  for (i = 0; i < self->entries->len; i++) {
+    GstNegotiationEntry *entry = g_ptr_array_index (self->entries, i);
+
+    if (entry->caps_queries == 0 && entry->accept_caps_queries == 0 &&
+        entry->allocation_queries == 0 && entry->caps_events == 0 &&
+        entry->reconfigure_events == 0)
+      continue;
+
+    gst_tracer_record_log (tr_element, entry->name, i, entry->caps_queries,
+        entry->accept_caps_queries, entry->allocation_queries, entry->time,
+        entry->max_depth, entry->max_caps_size, entry->caps_events,
+        entry->reconfigure_events);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+/* hooks */
+
+static void
+do_query_pre (GstNegotiationTracer * self, guint64 ts, GstPad * pad,
+    GstQuery * query)
+{
+  GstNegotiationThread *thread;
+  GstNegotiationFrame frame;
+
+  if (!is_negotiation_query (query))
+    return;
+
+  thread = get_thread (self);
+
+  frame.pad = pad;
+  frame.query = query;
+  g_mutex_lock (&self->lock);
+  frame.ix = get_entry_ix (self, pad);
+  g_mutex_unlock (&self->lock);
+  frame.start = ts;
+  frame.nested = 0;
+
+  g_array_append_val (thread->frames, frame);
+}
+
+static void
+do_query_post (GstNegotiationTracer * self, guint64 ts, GstPad * pad,
+    GstQuery * query, gboolean res)
+{
+  GstNegotiationThread *thread;
+  GstNegotiationFrame *frame;
+  GstClockTime elapsed;
+  guint len;
+
+  if (!is_negotiation_query (query))
+    return;
+
+  thread = get_thread (self);
+
+  /* queries that failed before calling the query function have no post
+   * hook, drop their frames */
+  for (len = thread->frames->len; len > 0; len--) {
+    frame = &g_array_index (thread->frames, GstNegotiationFrame, len - 1);
+    if (frame->pad == pad && frame->query == query)
+      break;
+  }
+  /* the tracer was created while this query was running */
+  if (G_UNLIKELY (len == 0))
+    return;
+
+  elapsed = ts > frame->start ? ts - frame->start : 0;
+
+  g_mutex_lock (&self->lock);
+  if (frame->ix < self->entries->len) {
+    GstNegotiationEntry *entry = g_ptr_array_index (self->entries, frame->ix);
+
+    switch (GST_QUERY_TYPE (query)) {
+      case GST_QUERY_CAPS:
+        entry->caps_queries++;
+        if (res) {
+          GstCaps *caps;
+
+          gst_query_parse_caps_result (query, &caps);
+          if (caps)
+            entry->max_caps_size = MAX (entry->max_caps_size,
+                gst_caps_get_size (caps));
+        }
+        break;
+      case GST_QUERY_ACCEPT_CAPS:
+        entry->accept_caps_queries++;
+        break;
+      default:
+        entry->allocation_queries++;
+        break;
+    }
+    entry->time += elapsed > frame->nested ? elapsed - frame->nested : 0;
+    entry->max_depth = MAX (entry->max_depth, len);
+  }
+  g_mutex_unlock (&self->lock);
+
+  g_array_set_size (thread->frames, len - 1);
+  if (len > 1)
+    g_array_index (thread->frames, GstNegotiationFrame, len - 2).nested +=
+        elapsed;
+}
+
+static void
+do_push_event_pre (GstNegotiationTracer * self, guint64 ts, GstPad * pad,
+    GstEvent * event)
+{
+  GstNegotiationEntry *entry;
+  guint ix;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_CAPS &&
+      GST_EVENT_TYPE (event) != GST_EVENT_RECONFIGURE)
+    return;
+
+  g_mutex_lock (&self->lock);
+  ix = get_entry_ix (self, pad);
+  if (ix < self->entries->len) {
+    entry = g_ptr_array_index (self->entries, ix);
+    if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS)
+      entry->caps_events++;
+    else
+      entry->reconfigure_events++;
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+do_element_change_state_post (GstNegotiationTracer * self, guint64 ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY &&
+      GST_OBJECT_PARENT (element) == NULL)
+    log_entries (self);
+}
+
+/* tracer class */
+
+static void
+gst_negotiation_tracer_finalize (GObject * obj)
+{
+  GstNegotiationTracer *self = GST_NEGOTIATION_TRACER (obj);
+  GHashTable *threads;
+
+  log_entries (self);
+
+  /* the data of the other threads goes away when they exit */
+  if ((threads = g_private_get (&thread_key)))
+    g_hash_table_remove (threads, GUINT_TO_POINTER (self->id));
+  g_ptr_array_foreach (self->entries, (GFunc) free_entry, NULL);
+  g_ptr_array_free (self->entries, TRUE);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static GstStructure *
+new_value_description (GType type, const gchar * description)
+{
+  if (type == G_TYPE_UINT64)
+    return gst_structure_new ("value",
+        "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+        "description", G_TYPE_STRING, description,
+        "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+        "max", G_TYPE_UINT64, G_MAXUINT64, NULL);
+
+  return gst_structure_new ("value",
+      "type", G_TYPE_GTYPE, G_TYPE_UINT,
+      "description", G_TYPE_STRING, description,
+      "min", G_TYPE_UINT, 0, "max", G_TYPE_UINT, G_MAXUINT, NULL);
+}
+
+static void
+gst_negotiation_tracer_class_init (GstNegotiationTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_negotiation_tracer_finalize;
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_element = gst_tracer_record_new ("element-negotiation.class",
+      "element", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "element-ix", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "caps-queries", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT, "number of caps queries"),
+      "accept-caps-queries", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT, "number of accept-caps queries"),
+      "allocation-queries", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT, "number of allocation queries"),
+      "time", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT64,
+              "time spent answering the queries in ns"),
+      "max-depth", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT, "deepest query nesting"),
+      "max-caps-size", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT,
+              "largest number of structures in a caps query result"),
+      "caps-events", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT, "number of caps events sent"),
+      "reconfigure-events", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT,
+              "number of reconfigure events sent"),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_negotiation_tracer_init (GstNegotiationTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+  gchar *name;
+
+  g_mutex_init (&self->lock);
+  self->id = (guint) g_atomic_int_add (&tracer_id, 1);
+  /* a static quark would make the instances share the entry indices */
+  name = g_strdup_printf ("gstnegotiation:entry:%u", self->id);
+  self->entry_quark = g_quark_from_string (name);
+  g_free (name);
+  self->entries = g_ptr_array_new ();
+
+  gst_tracing_register_hook (tracer, "pad-query-pre",
+      G_CALLBACK (do_query_pre));
+  gst_tracing_register_hook (tracer, "pad-query-post",
+      G_CALLBACK (do_query_post));
+  gst_tracing_register_hook (tracer, "pad-push-event-pre",
+      G_CALLBACK (do_push_event_pre));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+}
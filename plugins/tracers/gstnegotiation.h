@@ -0,0 +1,73 @@
+/* GStreamer
+ *
+ * gstnegotiation.h: tracing module that records caps negotiation costs
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_NEGOTIATION_TRACER_H__
+#define __GST_NEGOTIATION_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_NEGOTIATION_TRACER \
+  (gst_negotiation_tracer_get_type())
+#define GST_NEGOTIATION_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_NEGOTIATION_TRACER,GstNegotiationTracer))
+#define GST_NEGOTIATION_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_NEGOTIATION_TRACER,GstNegotiationTracerClass))
+#define GST_IS_NEGOTIATION_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_NEGOTIATION_TRACER))
+#define GST_IS_NEGOTIATION_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_NEGOTIATION_TRACER))
+#define GST_NEGOTIATION_TRACER_CAST(obj) ((GstNegotiationTracer *)(obj))
+
+typedef struct _GstNegotiationTracer GstNegotiationTracer;
+typedef struct _GstNegotiationTracerClass GstNegotiationTracerClass;
+
+/**
+ * GstNegotiationTracer:
+ *
+ * Opaque #GstNegotiationTracer data structure
+ */
+struct _GstNegotiationTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  GMutex lock;
+  /* unique for the tracer instances, keys the per-thread data */
+  guint id;
+  /* per instance, keeps the entry index in the elements */
+  GQuark entry_quark;
+  /* GstNegotiationEntry with the statistics of an element, indexed by the
+   * entry index */
+  GPtrArray *entries;
+};
+
+struct _GstNegotiationTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_negotiation_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_NEGOTIATION_TRACER_H__ */
@@ -0,0 +1,623 @@
+/* GStreamer
+ *
+ * gstproctime.c: tracing module that records processing time histograms
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstproctime
+ * @short_description: log processing time histograms
+ *
+ * A tracing module that records how long the chain and getrange functions of
+ * each pad and element take, without the time spent in the peers they push to
+ * or pull from in turn. Instead of averages it keeps a histogram per pad and
+ * element with a relative precision of about 6%, so that the tail of the
+ * distribution can be read from it.
+ *
+ * The percentiles are logged as "pad-proctime" and "element-proctime" records
+ * when a pipeline goes from PAUSED to READY and when the tracer is destroyed.
+ *
+ * The histograms are updated without locks by each streaming thread and only
+ * merged when they are logged. The hooks are sampled, see
+ * GST_TRACERS_SAMPLING. When elements push to peers that are not sampled,
+ * their time is included.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstproctime.h"
+
+#include <string.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_proc_time_debug);
+#define GST_CAT_DEFAULT gst_proc_time_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_proc_time_debug, "proctime", 0, \
+        "processing time tracer");
+#define gst_proc_time_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstProcTimeTracer, gst_proc_time_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GstTracerRecord *tr_pad;
+static GstTracerRecord *tr_element;
+static gint tracer_id;          /* 0 */
+
+/* values below 2^HIST_SUB_BITS ns get their own bucket, above that every
+ * power of two is split in 2^HIST_SUB_BITS buckets, up to 2^HIST_MAX_BITS ns
+ * (about 18 minutes) */
+#define HIST_SUB_BITS 4
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_MAX_BITS 40
+#define HIST_N_BUCKETS ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS)
+
+typedef struct
+{
+  guint64 min;
+  guint64 max;
+  guint32 counts[HIST_N_BUCKETS];
+} GstProcTimeHistogram;
+
+typedef struct
+{
+  gboolean is_pad;
+  gchar *name;
+} GstProcTimeEntry;
+
+/* a push or pull that is in progress */
+typedef struct
+{
+  GstPad *pad;
+  guint pad_ix;
+  guint elem_ix;
+  GstClockTime start;
+  /* time spent in nested pushes and pulls */
+  GstClockTime nested;
+} GstProcTimeFrame;
+
+typedef struct
+{
+  /* one ref for the thread and one for the tracer */
+  gint ref_count;
+  /* set when the thread exited, the tracer then merges the histograms */
+  volatile gint exited;
+  /* protects resizing hists, the counts are only written by the thread
+   * itself and read without locking */
+  GMutex lock;
+  /* GstProcTimeHistogram, indexed by the entry index */
+  GPtrArray *hists;
+  GArray *frames;
+} GstProcTimeThread;
+
+/* GstProcTimeThread of each tracer instance in this thread, keyed by the id
+ * of the instance, ids are never reused. When the thread exits the tracer
+ * keeps the data until it merged the histograms. */
+static GPrivate thread_key = G_PRIVATE_INIT ((GDestroyNotify)
+    g_hash_table_unref);
+
+/* histogram helpers */
+
+static inline guint
+hist_bucket (guint64 val)
+{
+  guint exp;
+
+  if (val < HIST_SUB_BUCKETS)
+    return val;
+
+  if (G_UNLIKELY (val >= (G_GUINT64_CONSTANT (1) << HIST_MAX_BITS)))
+    return HIST_N_BUCKETS - 1;
+
+  exp = g_bit_storage (val) - HIST_SUB_BITS - 1;
+
+  return (exp + 1) * HIST_SUB_BUCKETS + (val >> exp) - HIST_SUB_BUCKETS;
+}
+
+/* the highest value that ends up in @bucket */
+static guint64
+hist_bucket_value (guint bucket)
+{
+  guint exp, mantissa;
+
+  if (bucket < HIST_SUB_BUCKETS)
+    return bucket;
+
+  exp = bucket / HIST_SUB_BUCKETS - 1;
+  mantissa = bucket % HIST_SUB_BUCKETS + HIST_SUB_BUCKETS;
+
+  return (((guint64) mantissa + 1) << exp) - 1;
+}
+
+/* the value below which @fraction of the @count values in @hist are */
+static guint64
+hist_percentile (const GstProcTimeHistogram * hist, guint64 count,
+    gdouble fraction)
+{
+  guint64 rank, seen = 0;
+  guint i;
+
+  rank = MAX ((guint64) (count * fraction + 0.5), 1);
+
+  for (i = 0; i < HIST_N_BUCKETS; i++) {
+    seen += hist->counts[i];
+    if (seen >= rank)
+      return CLAMP (hist_bucket_value (i), hist->min, hist->max);
+  }
+  return hist->max;
+}
+
+/* data helpers */
+
+static GstProcTimeThread *
+thread_new (void)
+{
+  GstProcTimeThread *thread = g_slice_new0 (GstProcTimeThread);
+
+  thread->ref_count = 1;
+  g_mutex_init (&thread->lock);
+  thread->hists = g_ptr_array_new ();
+  thread->frames = g_array_new (FALSE, FALSE, sizeof (GstProcTimeFrame));
+
+  return thread;
+}
+
+static void
+free_thread (GstProcTimeThread * thread)
+{
+  guint i;
+
+  for (i = 0; i < thread->hists->len; i++) {
+    GstProcTimeHistogram *hist = g_ptr_array_index (thread->hists, i);
+
+    if (hist)
+      g_slice_free (GstProcTimeHistogram, hist);
+  }
+  g_ptr_array_free (thread->hists, TRUE);
+  g_array_free (thread->frames, TRUE);
+  g_mutex_clear (&thread->lock);
+  g_slice_free (GstProcTimeThread, thread);
+}
+
+static void
+thread_unref (GstProcTimeThread * thread)
+{
+  if (g_atomic_int_dec_and_test (&thread->ref_count))
+    free_thread (thread);
+}
+
+static void
+thread_exited (GstProcTimeThread * thread)
+{
+  g_atomic_int_set (&thread->exited, 1);
+  thread_unref (thread);
+}
+
+/* adds the histograms of @src, whose thread exited, to @dest */
+static void
+merge_thread (GstProcTimeThread * dest, GstProcTimeThread * src)
+{
+  guint i, k;
+
+  g_mutex_lock (&dest->lock);
+  if (src->hists->len > dest->hists->len)
+    g_ptr_array_set_size (dest->hists, src->hists->len);
+
+  for (i = 0; i < src->hists->len; i++) {
+    GstProcTimeHistogram *s = g_ptr_array_index (src->hists, i);
+    GstProcTimeHistogram *d = g_ptr_array_index (dest->hists, i);
+
+    if (s == NULL)
+      continue;
+
+    if (d == NULL) {
+      g_ptr_array_index (dest->hists, i) = s;
+      g_ptr_array_index (src->hists, i) = NULL;
+      continue;
+    }
+
+    for (k = 0; k < HIST_N_BUCKETS; k++)
+      d->counts[k] += s->counts[k];
+    d->min = MIN (d->min, s->min);
+    d->max = MAX (d->max, s->max);
+  }
+  g_mutex_unlock (&dest->lock);
+}
+
+/* merges the threads that exited into the first one, must be called with
+ * the lock */
+static void
+retire_threads (GstProcTimeTracer * self)
+{
+  GstProcTimeThread *retired = g_ptr_array_index (self->threads, 0);
+  guint i;
+
+  for (i = self->threads->len - 1; i > 0; i--) {
+    GstProcTimeThread *thread = g_ptr_array_index (self->threads, i);
+
+    if (g_atomic_int_get (&thread->exited)) {
+      merge_thread (retired, thread);
+      g_ptr_array_remove_index_fast (self->threads, i);
+      thread_unref (thread);
+    }
+  }
+}
+
+static GstProcTimeThread *
+get_thread (GstProcTimeTracer * self)
+{
+  GHashTable *threads = g_private_get (&thread_key);
+  GstProcTimeThread *thread;
+
+  if (G_UNLIKELY (threads == NULL)) {
+    threads = g_hash_table_new_full (NULL, NULL, NULL,
+        (GDestroyNotify) thread_exited);
+    g_private_set (&thread_key, threads);
+  }
+
+  thread = g_hash_table_lookup (threads, GUINT_TO_POINTER (self->id));
+  if (G_UNLIKELY (thread == NULL)) {
+    thread = thread_new ();
+    g_hash_table_insert (threads, GUINT_TO_POINTER (self->id), thread);
+
+    g_mutex_lock (&self->lock);
+    retire_threads (self);
+    g_ptr_array_add (self->threads, thread);
+    g_atomic_int_inc (&thread->ref_count);
+    g_mutex_unlock (&self->lock);
+  }
+  return thread;
+}
+
+static void
+free_entry (GstProcTimeEntry * entry)
+{
+  g_free (entry->name);
+  g_slice_free (GstProcTimeEntry, entry);
+}
+
+/* The index of the entry for @object. It is kept in the qdata of the object,
+ * but the entries stay in the tracer to log them after the object is gone. */
+static guint
+get_entry_ix (GstProcTimeTracer * self, GstObject * object, gboolean is_pad)
+{
+  guint ix;
+
+  if (!object)
+    return G_MAXUINT;
+
+  ix = GPOINTER_TO_UINT (g_object_get_qdata ((GObject *) object,
+          self->entry_quark));
+  if (G_LIKELY (ix))
+    return ix - 1;
+
+  g_mutex_lock (&self->lock);
+  ix = GPOINTER_TO_UINT (g_object_get_qdata ((GObject *) object,
+          self->entry_quark));
+  if (!ix) {
+    GstProcTimeEntry *entry = g_slice_new0 (GstProcTimeEntry);
+
+    entry->is_pad = is_pad;
+    if (is_pad)
+      entry->name = g_strdup_printf ("%s_%s",
+          GST_DEBUG_PAD_NAME (GST_PAD_CAST (object)));
+    else
+      entry->name = g_strdup (GST_OBJECT_NAME (object));
+
+    g_ptr_array_add (self->entries, entry);
+    ix = self->entries->len;
+    g_object_set_qdata ((GObject *) object, self->entry_quark,
+        GUINT_TO_POINTER (ix));
+  }
+  g_mutex_unlock (&self->lock);
+
+  return ix - 1;
+}
+
+static void
+add_value (GstProcTimeThread * thread, guint ix, GstClockTime val)
+{
+  GstProcTimeHistogram *hist = NULL;
+
+  if (ix == G_MAXUINT)
+    return;
+
+  if (G_LIKELY (ix < thread->hists->len))
+    hist = g_ptr_array_index (thread->hists, ix);
+
+  if (G_UNLIKELY (hist == NULL)) {
+    hist = g_slice_new0 (GstProcTimeHistogram);
+    hist->min = G_MAXUINT64;
+
+    g_mutex_lock (&thread->lock);
+    if (ix >= thread->hists->len)
+      g_ptr_array_set_size (thread->hists, ix + 1);
+    g_ptr_array_index (thread->hists, ix) = hist;
+    g_mutex_unlock (&thread->lock);
+  }
+
+  hist->counts[hist_bucket (val)]++;
+  if (val < hist->min)
+    hist->min = val;
+  if (val > hist->max)
+    hist->max = val;
+}
+
+/*
+ * Get the element/bin owning the pad.
+ *
+ * in: a normal pad
+ * out: the element
+ *
+ * in: a proxy pad
+ * out: the element that contains the peer of the proxy
+ *
+ * in: a ghost pad
+ * out: the bin owning the ghostpad
+ */
+static GstElement *
+get_real_pad_parent (GstPad * pad)
+{
+  GstObject *parent;
+
+  if (!pad)
+    return NULL;
+
+  parent = GST_OBJECT_PARENT (pad);
+
+  /* if parent of pad is a ghost-pad, then pad is a proxy_pad */
+  if (parent && GST_IS_GHOST_PAD (parent)) {
+    pad = GST_PAD_CAST (parent);
+    parent = GST_OBJECT_PARENT (pad);
+  }
+  return GST_ELEMENT_CAST (parent);
+}
+
+/* @pad is the pad the hook is called for, the time is accounted to @peer,
+ * whose chain or getrange function runs */
+static void
+push_frame (GstProcTimeTracer * self, GstClockTime ts, GstPad * pad,
+    GstPad * peer)
+{
+  GstProcTimeThread *thread = get_thread (self);
+  GstProcTimeFrame frame;
+
+  frame.pad = pad;
+  frame.pad_ix = get_entry_ix (self, GST_OBJECT_CAST (peer), TRUE);
+  frame.elem_ix = get_entry_ix (self,
+      GST_OBJECT_CAST (get_real_pad_parent (peer)), FALSE);
+  frame.start = ts;
+  frame.nested = 0;
+
+  g_array_append_val (thread->frames, frame);
+}
+
+static void
+pop_frame (GstProcTimeTracer * self, GstClockTime ts, GstPad * pad)
+{
+  GstProcTimeThread *thread = get_thread (self);
+  GstProcTimeFrame *frame;
+  GstClockTime elapsed, val;
+  guint len = thread->frames->len;
+
+  if (G_UNLIKELY (len == 0))
+    return;
+
+  frame = &g_array_index (thread->frames, GstProcTimeFrame, len - 1);
+  /* the tracer was created while this pad was pushing */
+  if (G_UNLIKELY (frame->pad != pad))
+    return;
+
+  elapsed = ts > frame->start ? ts - frame->start : 0;
+  val = elapsed > frame->nested ? elapsed - frame->nested : 0;
+
+  add_value (thread, frame->pad_ix, val);
+  add_value (thread, frame->elem_ix, val);
+
+  g_array_set_size (thread->frames, len - 1);
+  if (len > 1)
+    g_array_index (thread->frames, GstProcTimeFrame, len - 2).nested +=
+        elapsed;
+}
+
+static void
+log_histograms (GstProcTimeTracer * self)
+{
+  GstProcTimeHistogram *merged;
+  guint i, j, k;
+
+  merged = g_slice_new (GstProcTimeHistogram);
+
+  g_mutex_lock (&self->lock);
+  for (i = 0; i < self->entries->len; i++) {
+    GstProcTimeEntry *entry = g_ptr_array_index (self->entries, i);
+    guint64 count = 0;
+
+    memset (merged, 0, sizeof (GstProcTimeHistogram));
+    merged->min = G_MAXUINT64;
+
+    for (j = 0; j < self->threads->len; j++) {
+      GstProcTimeThread *thread = g_ptr_array_index (self->threads, j);
+      GstProcTimeHistogram *hist = NULL;
+
+      g_mutex_lock (&thread->lock);
+      if (i < thread->hists->len)
+        hist = g_ptr_array_index (thread->hists, i);
+      if (hist) {
+        for (k = 0; k < HIST_N_BUCKETS; k++) {
+          merged->counts[k] += hist->counts[k];
+          count += hist->counts[k];
+        }
+        merged->min = MIN (merged->min, hist->min);
+        merged->max = MAX (merged->max, hist->max);
+      }
+      g_mutex_unlock (&thread->lock);
+    }
+
+    if (count == 0)
+      continue;
+
+    gst_tracer_record_log (entry->is_pad ? tr_pad : tr_element, entry->name,
+        count, merged->min, hist_percentile (merged, count, 0.5),
+        hist_percentile (merged, count, 0.99),
+        hist_percentile (merged, count, 0.999), merged->max);
+  }
+  g_mutex_unlock (&self->lock);
+
+  g_slice_free (GstProcTimeHistogram, merged);
+}
+
+/* hooks */
+
+static void
+do_push_buffer_pre (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  push_frame (self, ts, pad, GST_PAD_PEER (pad));
+}
+
+static void
+do_push_buffer_post (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  pop_frame (self, ts, pad);
+}
+
+static void
+do_pull_range_pre (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  push_frame (self, ts, pad, GST_PAD_PEER (pad));
+}
+
+static void
+do_pull_range_post (GstProcTimeTracer * self, guint64 ts, GstPad * pad)
+{
+  pop_frame (self, ts, pad);
+}
+
+static void
+do_element_change_state_post (GstProcTimeTracer * self, guint64 ts,
+    GstElement * element, GstStateChange transition,
+    GstStateChangeReturn result)
+{
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY &&
+      GST_OBJECT_PARENT (element) == NULL)
+    log_histograms (self);
+}
+
+/* tracer class */
+
+static void
+gst_proc_time_tracer_finalize (GObject * obj)
+{
+  GstProcTimeTracer *self = GST_PROC_TIME_TRACER (obj);
+  GHashTable *threads;
+
+  log_histograms (self);
+
+  /* the other threads drop their ref when they exit */
+  if ((threads = g_private_get (&thread_key)))
+    g_hash_table_remove (threads, GUINT_TO_POINTER (self->id));
+  g_ptr_array_foreach (self->threads, (GFunc) thread_unref, NULL);
+  g_ptr_array_free (self->threads, TRUE);
+  g_ptr_array_foreach (self->entries, (GFunc) free_entry, NULL);
+  g_ptr_array_free (self->entries, TRUE);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static GstStructure *
+new_value_description (const gchar * description)
+{
+  return gst_structure_new ("value",
+      "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+      "description", G_TYPE_STRING, description,
+      "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+      "max", G_TYPE_UINT64, G_MAXUINT64, NULL);
+}
+
+static GstTracerRecord *
+new_record (const gchar * name, const gchar * object,
+    GstTracerValueScope scope)
+{
+  /* *INDENT-OFF* */
+  return gst_tracer_record_new (name,
+      object, GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, scope,
+          NULL),
+      "count", GST_TYPE_STRUCTURE,
+          new_value_description ("number of measurements"),
+      "min", GST_TYPE_STRUCTURE,
+          new_value_description ("shortest processing time in ns"),
+      "p50", GST_TYPE_STRUCTURE,
+          new_value_description ("median processing time in ns"),
+      "p99", GST_TYPE_STRUCTURE,
+          new_value_description ("99th percentile of the processing time in ns"),
+      "p999", GST_TYPE_STRUCTURE,
+          new_value_description ("99.9th percentile of the processing time in ns"),
+      "max", GST_TYPE_STRUCTURE,
+          new_value_description ("longest processing time in ns"),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_proc_time_tracer_class_init (GstProcTimeTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_proc_time_tracer_finalize;
+
+  /* announce trace formats */
+  tr_pad = new_record ("pad-proctime.class", "pad",
+      GST_TRACER_VALUE_SCOPE_PAD);
+  tr_element = new_record ("element-proctime.class", "element",
+      GST_TRACER_VALUE_SCOPE_ELEMENT);
+}
+
+static void
+gst_proc_time_tracer_init (GstProcTimeTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+  gchar *name;
+
+  g_mutex_init (&self->lock);
+  self->id = (guint) g_atomic_int_add (&tracer_id, 1);
+  /* a static quark would make the instances share the entry indices */
+  name = g_strdup_printf ("gstproctime:entry:%u", self->id);
+  self->entry_quark = g_quark_from_string (name);
+  g_free (name);
+  self->entries = g_ptr_array_new ();
+  self->threads = g_ptr_array_new ();
+  /* holds the histograms of the threads that exited */
+  g_ptr_array_add (self->threads, thread_new ());
+
+  gst_tracing_register_sampled_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_sampled_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_sampled_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_sampled_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_sampled_hook (tracer, "pad-pull-range-pre",
+      G_CALLBACK (do_pull_range_pre));
+  gst_tracing_register_sampled_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_pull_range_post));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_element_change_state_post));
+}
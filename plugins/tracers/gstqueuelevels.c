@@ -0,0 +1,318 @@
+/* GStreamer
+ *
+ * gstqueuelevels.c: tracing module that samples the level of queues
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gstqueuelevels
+ * @short_description: log the level and occupancy of queues
+ *
+ * A tracing module that periodically logs the level of the queue, queue2 and
+ * multiqueue elements as "queue-level" records. Next to the number of queued
+ * buffers, bytes and nanoseconds each record has the time the queue spent
+ * full and empty since the previous record, and the longest time the
+ * upstream or downstream side was blocked on it.
+ *
+ * The interval between two records of a queue is set in milliseconds with
+ * the "interval" parameter and defaults to 100ms:
+ * |[
+ * GST_TRACERS="queuelevels(interval=500)"
+ * ]|
+ *
+ * Records are only written when data flows through the queue. A queue that
+ * stays blocked gets its next record after it started moving again.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gstqueuelevels.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_queue_levels_debug);
+#define GST_CAT_DEFAULT gst_queue_levels_debug
+
+static GQuark data_quark;
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_queue_levels_debug, "queuelevels", 0, \
+        "queue levels tracer"); \
+    data_quark = g_quark_from_static_string ("gstqueuelevels:data");
+#define gst_queue_levels_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstQueueLevelsTracer, gst_queue_levels_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+static GstTracerRecord *tr_level;
+
+#define DEFAULT_INTERVAL (100 * GST_MSECOND)
+
+/* per src pad of a queue, stored on the pad */
+typedef struct
+{
+  GMutex lock;
+  /* start of the current interval */
+  GstClockTime last_sample;
+  /* start of the wait that is in progress, or GST_CLOCK_TIME_NONE */
+  GstClockTime full_start, empty_start;
+  /* stats of the current interval */
+  GstClockTime time_full, time_empty;
+  GstClockTime max_wait_full, max_wait_empty;
+} GstQueueLevelsData;
+
+static void
+free_data (GstQueueLevelsData * data)
+{
+  g_mutex_clear (&data->lock);
+  g_slice_free (GstQueueLevelsData, data);
+}
+
+static GstQueueLevelsData *
+get_data (GstQueueLevelsTracer * self, GstPad * pad)
+{
+  GstQueueLevelsData *data;
+
+  if ((data = g_object_get_qdata ((GObject *) pad, data_quark)))
+    return data;
+
+  g_mutex_lock (&self->lock);
+  if (!(data = g_object_get_qdata ((GObject *) pad, data_quark))) {
+    data = g_slice_new0 (GstQueueLevelsData);
+    g_mutex_init (&data->lock);
+    data->last_sample = GST_CLOCK_TIME_NONE;
+    data->full_start = data->empty_start = GST_CLOCK_TIME_NONE;
+    g_object_set_qdata_full ((GObject *) pad, data_quark, data,
+        (GDestroyNotify) free_data);
+  }
+  g_mutex_unlock (&self->lock);
+
+  return data;
+}
+
+/* add the part of the wait that started at @start and is in the current
+ * interval */
+static inline GstClockTime
+wait_in_interval (GstQueueLevelsData * data, GstClockTime start,
+    GstClockTime ts)
+{
+  GstClockTime from = MAX (start, data->last_sample);
+
+  return ts > from ? ts - from : 0;
+}
+
+/* hooks */
+
+static void
+do_queue_level (GstQueueLevelsTracer * self, GstClockTime ts,
+    GstElement * queue, GstPad * pad, guint buffers, guint64 bytes,
+    guint64 time)
+{
+  GstQueueLevelsData *data = get_data (self, pad);
+  GstClockTime time_full, time_empty, max_wait_full, max_wait_empty;
+
+  g_mutex_lock (&data->lock);
+  if (!GST_CLOCK_TIME_IS_VALID (data->last_sample)) {
+    data->last_sample = ts;
+    g_mutex_unlock (&data->lock);
+    return;
+  }
+  if (ts < data->last_sample + self->interval) {
+    g_mutex_unlock (&data->lock);
+    return;
+  }
+
+  /* waits that are still in progress count up to now */
+  time_full = data->time_full;
+  if (GST_CLOCK_TIME_IS_VALID (data->full_start))
+    time_full += wait_in_interval (data, data->full_start, ts);
+  time_empty = data->time_empty;
+  if (GST_CLOCK_TIME_IS_VALID (data->empty_start))
+    time_empty += wait_in_interval (data, data->empty_start, ts);
+  max_wait_full = data->max_wait_full;
+  max_wait_empty = data->max_wait_empty;
+
+  data->last_sample = ts;
+  data->time_full = data->time_empty = 0;
+  data->max_wait_full = data->max_wait_empty = 0;
+  g_mutex_unlock (&data->lock);
+
+  gst_tracer_record_log (tr_level, GST_OBJECT_NAME (queue),
+      GST_OBJECT_NAME (pad), buffers, bytes, time, time_full, time_empty,
+      max_wait_full, max_wait_empty);
+}
+
+static void
+do_queue_wait_pre (GstQueueLevelsTracer * self, GstClockTime ts,
+    GstElement * queue, GstPad * pad, gboolean full)
+{
+  GstQueueLevelsData *data = get_data (self, pad);
+  GstClockTime *start = full ? &data->full_start : &data->empty_start;
+
+  g_mutex_lock (&data->lock);
+  /* keep the start of the first wait when a queue waits again */
+  if (!GST_CLOCK_TIME_IS_VALID (*start))
+    *start = ts;
+  g_mutex_unlock (&data->lock);
+}
+
+static void
+do_queue_wait_post (GstQueueLevelsTracer * self, GstClockTime ts,
+    GstElement * queue, GstPad * pad, gboolean full)
+{
+  GstQueueLevelsData *data = get_data (self, pad);
+  GstClockTime *start = full ? &data->full_start : &data->empty_start;
+  GstClockTime wait;
+
+  g_mutex_lock (&data->lock);
+  if (!GST_CLOCK_TIME_IS_VALID (*start))
+    goto done;
+
+  wait = ts > *start ? ts - *start : 0;
+  if (GST_CLOCK_TIME_IS_VALID (data->last_sample)) {
+    if (full) {
+      data->time_full += wait_in_interval (data, *start, ts);
+      data->max_wait_full = MAX (data->max_wait_full, wait);
+    } else {
+      data->time_empty += wait_in_interval (data, *start, ts);
+      data->max_wait_empty = MAX (data->max_wait_empty, wait);
+    }
+  }
+  GST_LOG_OBJECT (self, "%s:%s waited %" GST_TIME_FORMAT " while %s",
+      GST_DEBUG_PAD_NAME (pad), GST_TIME_ARGS (wait), full ? "full" : "empty");
+  *start = GST_CLOCK_TIME_NONE;
+
+done:
+  g_mutex_unlock (&data->lock);
+}
+
+/* tracer class */
+
+static void
+set_params (GstQueueLevelsTracer * self)
+{
+  gchar *params, *tmp;
+  GstStructure *params_struct;
+  guint interval;
+
+  g_object_get (self, "params", &params, NULL);
+  if (!params)
+    return;
+
+  tmp = g_strdup_printf ("queuelevels,%s", params);
+  params_struct = gst_structure_from_string (tmp, NULL);
+  g_free (tmp);
+
+  if (params_struct) {
+    if (gst_structure_get_uint (params_struct, "interval", &interval))
+      self->interval = interval * GST_MSECOND;
+    gst_structure_free (params_struct);
+  } else {
+    GST_WARNING_OBJECT (self, "invalid params '%s'", params);
+  }
+  g_free (params);
+}
+
+static void
+gst_queue_levels_tracer_constructed (GObject * object)
+{
+  GstQueueLevelsTracer *self = GST_QUEUE_LEVELS_TRACER (object);
+  GstTracer *tracer = GST_TRACER (object);
+
+  set_params (self);
+
+  gst_tracing_register_hook (tracer, "queue-level",
+      G_CALLBACK (do_queue_level));
+  gst_tracing_register_hook (tracer, "queue-wait-pre",
+      G_CALLBACK (do_queue_wait_pre));
+  gst_tracing_register_hook (tracer, "queue-wait-post",
+      G_CALLBACK (do_queue_wait_post));
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+}
+
+static void
+gst_queue_levels_tracer_finalize (GObject * obj)
+{
+  GstQueueLevelsTracer *self = GST_QUEUE_LEVELS_TRACER (obj);
+
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static GstStructure *
+new_value_description (GType type, const gchar * description)
+{
+  if (type == G_TYPE_UINT)
+    return gst_structure_new ("value",
+        "type", G_TYPE_GTYPE, type,
+        "description", G_TYPE_STRING, description,
+        "min", G_TYPE_UINT, 0, "max", G_TYPE_UINT, G_MAXUINT, NULL);
+
+  return gst_structure_new ("value",
+      "type", G_TYPE_GTYPE, type,
+      "description", G_TYPE_STRING, description,
+      "min", type, G_GUINT64_CONSTANT (0), "max", type, G_MAXUINT64, NULL);
+}
+
+static void
+gst_queue_levels_tracer_class_init (GstQueueLevelsTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gst_queue_levels_tracer_constructed;
+  gobject_class->finalize = gst_queue_levels_tracer_finalize;
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_level = gst_tracer_record_new ("queue-level.class",
+      "queue", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE,
+              GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "pad", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_PAD,
+          NULL),
+      "buffers", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT, "number of queued buffers"),
+      "bytes", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT64, "number of queued bytes"),
+      "time", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT64, "queued data in ns"),
+      "time-full", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT64,
+              "time the upstream side was blocked in ns"),
+      "time-empty", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT64,
+              "time the downstream side was blocked in ns"),
+      "max-wait-full", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT64,
+              "longest wait of the upstream side in ns"),
+      "max-wait-empty", GST_TYPE_STRUCTURE,
+          new_value_description (G_TYPE_UINT64,
+              "longest wait of the downstream side in ns"),
+      NULL);
+  /* *INDENT-ON* */
+}
+
+static void
+gst_queue_levels_tracer_init (GstQueueLevelsTracer * self)
+{
+  g_mutex_init (&self->lock);
+  self->interval = DEFAULT_INTERVAL;
+}
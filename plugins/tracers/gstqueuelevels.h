@@ -0,0 +1,68 @@
+/* GStreamer
+ *
+ * gstqueuelevels.h: tracing module that samples the level of queues
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_QUEUE_LEVELS_TRACER_H__
+#define __GST_QUEUE_LEVELS_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_QUEUE_LEVELS_TRACER \
+  (gst_queue_levels_tracer_get_type())
+#define GST_QUEUE_LEVELS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_QUEUE_LEVELS_TRACER,GstQueueLevelsTracer))
+#define GST_QUEUE_LEVELS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_QUEUE_LEVELS_TRACER,GstQueueLevelsTracerClass))
+#define GST_IS_QUEUE_LEVELS_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_QUEUE_LEVELS_TRACER))
+#define GST_IS_QUEUE_LEVELS_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_QUEUE_LEVELS_TRACER))
+#define GST_QUEUE_LEVELS_TRACER_CAST(obj) ((GstQueueLevelsTracer *)(obj))
+
+typedef struct _GstQueueLevelsTracer GstQueueLevelsTracer;
+typedef struct _GstQueueLevelsTracerClass GstQueueLevelsTracerClass;
+
+/**
+ * GstQueueLevelsTracer:
+ *
+ * Opaque #GstQueueLevelsTracer data structure
+ */
+struct _GstQueueLevelsTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  /* protects the creation of the per queue data */
+  GMutex lock;
+  GstClockTime interval;
+};
+
+struct _GstQueueLevelsTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_queue_levels_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_QUEUE_LEVELS_TRACER_H__ */
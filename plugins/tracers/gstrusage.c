@@ -23,6 +23,12 @@
  * @short_description: log resource usage stats
  *
  * A tracing module that take rusage() snapshots and logs them.
+ *
+ * The cpu time of the streaming threads is also attributed to the #GstTask
+ * that runs in them. The tracer follows the %GST_STREAM_STATUS_TYPE_ENTER and
+ * %GST_STREAM_STATUS_TYPE_LEAVE messages of the tasks and logs "task-rusage"
+ * records with the name of the task, which is the element and pad that
+ * started it.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -56,13 +62,17 @@ G_DEFINE_TYPE_WITH_CODE (GstRUsageTracer, gst_rusage_tracer, GST_TYPE_TRACER,
 /* number of cpus to scale cpu-usage in threads */
 static glong num_cpus = 1;
 
-static GstTracerRecord *tr_proc, *tr_thread;
+static GstTracerRecord *tr_proc, *tr_thread, *tr_task;
 
 typedef struct
 {
   /* time spend in this thread */
   GstClockTime tthread;
   GstTraceValues *tvs_thread;
+  /* the task that runs in this thread, and the ts and the time spent in this
+   * thread when it entered */
+  gchar *task;
+  GstClockTime task_ts, task_tthread;
 } GstThreadStats;
 
 /* data helper */
@@ -145,9 +155,73 @@ static void
 free_thread_stats (gpointer data)
 {
   free_trace_values (((GstThreadStats *) data)->tvs_thread);
+  g_free (((GstThreadStats *) data)->task);
   g_slice_free (GstThreadStats, data);
 }
 
+static GstThreadStats *
+get_thread_stats (GstRUsageTracer * self, gpointer thread_id)
+{
+  GstThreadStats *stats;
+
+  if (!(stats = g_hash_table_lookup (self->threads, thread_id))) {
+    stats = g_slice_new0 (GstThreadStats);
+    stats->tvs_thread = make_trace_values (GST_SECOND);
+    g_hash_table_insert (self->threads, thread_id, stats);
+  }
+  return stats;
+}
+
+/* cpu time of the current thread */
+static GstClockTime
+get_thread_time (GstTracer * obj)
+{
+  GstClockTime tthread = G_GUINT64_CONSTANT (0);
+#ifdef RUSAGE_THREAD
+  struct rusage ru;
+#endif
+
+#ifdef HAVE_CLOCK_GETTIME
+  {
+    struct timespec now;
+
+    if (!clock_gettime (CLOCK_THREAD_CPUTIME_ID, &now)) {
+      tthread = GST_TIMESPEC_TO_TIME (now);
+    } else {
+      GST_WARNING_OBJECT (obj,
+          "clock_gettime (CLOCK_THREAD_CPUTIME_ID,...) failed: %s",
+          g_strerror (errno));
+#ifdef RUSAGE_THREAD
+      getrusage (RUSAGE_THREAD, &ru);
+      tthread =
+          GST_TIMEVAL_TO_TIME (ru.ru_utime) + GST_TIMEVAL_TO_TIME (ru.ru_stime);
+#endif
+    }
+  }
+#else
+#ifdef RUSAGE_THREAD
+  getrusage (RUSAGE_THREAD, &ru);
+  tthread =
+      GST_TIMEVAL_TO_TIME (ru.ru_utime) + GST_TIMEVAL_TO_TIME (ru.ru_stime);
+#endif
+#endif
+  return tthread;
+}
+
+static void
+log_task_stats (GstThreadStats * stats, gpointer thread_id, guint64 ts,
+    guint cur_cpuload)
+{
+  GstClockTime dts = GST_CLOCK_DIFF (stats->task_ts, ts);
+  GstClockTime ttask = stats->tthread - stats->task_tthread;
+  guint avg_cpuload;
+
+  avg_cpuload = dts ? (guint) gst_util_uint64_scale (ttask,
+      G_GINT64_CONSTANT (1000), dts) : 0;
+  gst_tracer_record_log (tr_task, (guint64) (guintptr) thread_id, ts,
+      stats->task, MIN (avg_cpuload, 1000), MIN (cur_cpuload, 1000), ttask);
+}
+
 static void
 do_stats (GstTracer * obj, guint64 ts)
 {
@@ -157,7 +231,7 @@ do_stats (GstTracer * obj, guint64 ts)
   guint avg_cpuload, cur_cpuload;
   struct rusage ru;
   GstClockTime tproc = G_GUINT64_CONSTANT (0);
-  GstClockTime tthread = G_GUINT64_CONSTANT (0);
+  GstClockTime tthread;
   GstClockTime dts, dtproc;
 
 #ifdef HAVE_CLOCK_GETTIME
@@ -174,36 +248,16 @@ do_stats (GstTracer * obj, guint64 ts)
       tproc =
           GST_TIMEVAL_TO_TIME (ru.ru_utime) + GST_TIMEVAL_TO_TIME (ru.ru_stime);
     }
-
-    /* cpu time per thread */
-    if (!clock_gettime (CLOCK_THREAD_CPUTIME_ID, &now)) {
-      tthread = GST_TIMESPEC_TO_TIME (now);
-    } else {
-      GST_WARNING_OBJECT (obj,
-          "clock_gettime (CLOCK_THREAD_CPUTIME_ID,...) failed: %s",
-          g_strerror (errno));
-#ifdef RUSAGE_THREAD
-      getrusage (RUSAGE_THREAD, &ru);
-      tthread =
-          GST_TIMEVAL_TO_TIME (ru.ru_utime) + GST_TIMEVAL_TO_TIME (ru.ru_stime);
-#endif
-    }
   }
 #else
   getrusage (RUSAGE_SELF, &ru);
   tproc = GST_TIMEVAL_TO_TIME (ru.ru_utime) + GST_TIMEVAL_TO_TIME (ru.ru_stime);
-#ifdef RUSAGE_THREAD
-  getrusage (RUSAGE_THREAD, &ru);
-  tthread =
-      GST_TIMEVAL_TO_TIME (ru.ru_utime) + GST_TIMEVAL_TO_TIME (ru.ru_stime);
-#endif
 #endif
+  /* cpu time per thread */
+  tthread = get_thread_time (obj);
+
   /* get stats record for current thread */
-  if (!(stats = g_hash_table_lookup (self->threads, thread_id))) {
-    stats = g_slice_new0 (GstThreadStats);
-    stats->tvs_thread = make_trace_values (GST_SECOND);
-    g_hash_table_insert (self->threads, thread_id, stats);
-  }
+  stats = get_thread_stats (self, thread_id);
   stats->tthread = tthread;
 
   /* Calibrate ts for the process and main thread. For tthread[main] and tproc
@@ -241,6 +295,8 @@ do_stats (GstTracer * obj, guint64 ts)
       G_GINT64_CONSTANT (1000), dts);
   gst_tracer_record_log (tr_thread, (guint64) (guintptr) thread_id, ts,
       MIN (avg_cpuload, 1000), MIN (cur_cpuload, 1000), stats->tthread);
+  if (stats->task)
+    log_task_stats (stats, thread_id, ts, cur_cpuload);
 
   avg_cpuload = (guint) gst_util_uint64_scale (tproc / num_cpus,
       G_GINT64_CONSTANT (1000), ts);
@@ -254,6 +310,49 @@ do_stats (GstTracer * obj, guint64 ts)
   /* *INDENT-ON* */
 }
 
+/* the stream-status messages of a task are posted from its thread */
+static void
+do_post_message_pre (GstTracer * obj, guint64 ts, GstElement * element,
+    GstMessage * msg)
+{
+  GstRUsageTracer *self = GST_RUSAGE_TRACER_CAST (obj);
+  GstThreadStats *stats;
+  gpointer thread_id = g_thread_self ();
+  GstStreamStatusType type;
+  const GValue *val;
+  GstObject *task;
+
+  if (GST_MESSAGE_TYPE (msg) != GST_MESSAGE_STREAM_STATUS)
+    return;
+
+  gst_message_parse_stream_status (msg, &type, NULL);
+  if (type != GST_STREAM_STATUS_TYPE_ENTER &&
+      type != GST_STREAM_STATUS_TYPE_LEAVE)
+    return;
+
+  stats = get_thread_stats (self, thread_id);
+  stats->tthread = get_thread_time (obj);
+
+  if (type == GST_STREAM_STATUS_TYPE_ENTER) {
+    val = gst_message_get_stream_status_object (msg);
+    task = (val && G_VALUE_HOLDS_OBJECT (val)) ? g_value_get_object (val) :
+        NULL;
+
+    g_free (stats->task);
+    stats->task = g_strdup (task ? GST_OBJECT_NAME (task) :
+        GST_OBJECT_NAME (element));
+    stats->task_ts = ts;
+    stats->task_tthread = stats->tthread;
+    GST_DEBUG_OBJECT (self, "task %s entered thread %p", stats->task,
+        thread_id);
+  } else if (stats->task) {
+    /* log the totals of the task before the thread is reused */
+    log_task_stats (stats, thread_id, ts, 0);
+    g_free (stats->task);
+    stats->task = NULL;
+  }
+}
+
 /* tracer class */
 
 static void
@@ -315,6 +414,40 @@ gst_rusage_tracer_class_init (GstRUsageTracerClass * klass)
           "max", G_TYPE_UINT64, G_MAXUINT64,
           NULL),
       NULL);
+  tr_task = gst_tracer_record_new ("task-rusage.class",
+      "thread-id", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_THREAD,
+          NULL),
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "event ts",
+          NULL),
+      "task", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "name of the task, element:pad",
+          NULL),
+      "average-cpuload", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "average cpu usage per task in ‰",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          "min", G_TYPE_UINT, 0,
+          "max", G_TYPE_UINT, 1000,
+          NULL),
+      "current-cpuload", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "current cpu usage per task in ‰",
+          "min", G_TYPE_UINT, 0,
+          "max", G_TYPE_UINT, 1000,
+          NULL),
+      "time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "time spent in task in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64,
+          NULL),
+      NULL);
   tr_proc = gst_tracer_record_new ("proc-rusage.class",
       "process-id", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
           "type", G_TYPE_GTYPE, G_TYPE_UINT64,
@@ -367,6 +500,8 @@ gst_rusage_tracer_init (GstRUsageTracer * self)
   for (i = 0; i < G_N_ELEMENTS (hooks); i++) {
     gst_tracing_register_hook (tracer, hooks[i], G_CALLBACK (do_stats));
   }
+  gst_tracing_register_hook (tracer, "element-post-message-pre",
+      G_CALLBACK (do_post_message_pre));
 
   self->threads = g_hash_table_new_full (NULL, NULL, NULL, free_thread_stats);
   self->tvs_proc = make_trace_values (GST_SECOND);
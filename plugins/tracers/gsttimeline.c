@@ -0,0 +1,385 @@
+/* GStreamer
+ *
+ * gsttimeline.c: tracing module that writes a trace event timeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:gsttimeline
+ * @short_description: write a timeline of the dataflow
+ *
+ * A tracing module that writes the pad pushes and pulls, events, queries and
+ * state changes of each thread to a file in the JSON trace event format, which
+ * can be loaded in chrome://tracing or the Perfetto UI. The chain and getrange
+ * functions of the peers are run inside the push and pull slices.
+ *
+ * A buffer that is pushed again from another thread, e.g. by a queue, gets a
+ * flow arrow from the slice that pushed it before.
+ *
+ * The file is set with the "file" parameter and defaults to
+ * "gst-timeline.json" in the current directory:
+ * |[
+ * GST_TRACERS="timeline(file=/tmp/trace.json)"
+ * ]|
+ *
+ * The buffer flow hooks are sampled, see GST_TRACERS_SAMPLING, which makes
+ * the timeline smaller for long runs.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "gsttimeline.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_timeline_debug);
+#define GST_CAT_DEFAULT gst_timeline_debug
+
+static GQuark flow_quark;
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_timeline_debug, "timeline", 0, \
+        "timeline tracer"); \
+    flow_quark = g_quark_from_static_string ("gsttimeline:flow");
+#define gst_timeline_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstTimelineTracer, gst_timeline_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+#define DEFAULT_FILENAME "gst-timeline.json"
+
+/* all events are in one process */
+#define TIMELINE_PID 1
+
+/* the last push of a buffer, stored on the buffer */
+typedef struct
+{
+  guint64 id;
+  gint tid;
+} GstTimelineFlow;
+
+static volatile gint next_tid = 0;
+static volatile gint next_flow_id = 0;
+static GPrivate tid_key = G_PRIVATE_INIT (g_free);
+
+/* helpers */
+
+static gint
+get_tid (GstTimelineTracer * self)
+{
+  gint *tid = g_private_get (&tid_key);
+  gchar *line;
+
+  if (G_LIKELY (tid))
+    return *tid;
+
+  tid = g_new (gint, 1);
+  *tid = g_atomic_int_add (&next_tid, 1) + 1;
+  g_private_set (&tid_key, tid);
+
+  line = g_strdup_printf ("{\"name\":\"thread_name\",\"ph\":\"M\","
+      "\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+      TIMELINE_PID, *tid, *tid);
+  g_mutex_lock (&self->lock);
+  fprintf (self->out, ",\n%s", line);
+  g_mutex_unlock (&self->lock);
+  g_free (line);
+
+  return *tid;
+}
+
+/* object names can contain anything, only keep what is safe in a JSON
+ * string */
+static gchar *
+escape_name (const gchar * name)
+{
+  gchar *res = g_strdup (name ? name : "(null)");
+  gchar *p;
+
+  for (p = res; *p; p++) {
+    if (*p == '"' || *p == '\\' || (guchar) * p < 0x20)
+      *p = '_';
+  }
+  return res;
+}
+
+static void
+write_event (GstTimelineTracer * self, GstClockTime ts, const gchar * ph,
+    const gchar * name, const gchar * cat)
+{
+  gint tid = get_tid (self);
+  gchar *line;
+
+  if (name) {
+    gchar *ename = escape_name (name);
+
+    line = g_strdup_printf ("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%s\","
+        "\"ts\":%" G_GUINT64_FORMAT ".%03u,\"pid\":%d,\"tid\":%d}", ename,
+        cat, ph, ts / 1000, (guint) (ts % 1000), TIMELINE_PID, tid);
+    g_free (ename);
+  } else {
+    line = g_strdup_printf ("{\"ph\":\"%s\",\"ts\":%" G_GUINT64_FORMAT
+        ".%03u,\"pid\":%d,\"tid\":%d}", ph, ts / 1000, (guint) (ts % 1000),
+        TIMELINE_PID, tid);
+  }
+
+  g_mutex_lock (&self->lock);
+  fprintf (self->out, ",\n%s", line);
+  g_mutex_unlock (&self->lock);
+  g_free (line);
+}
+
+static void
+write_flow (GstTimelineTracer * self, GstClockTime ts, const gchar * ph,
+    guint64 id)
+{
+  gint tid = get_tid (self);
+  gchar *line;
+
+  /* finish events bind to the enclosing slice, like start events */
+  line = g_strdup_printf ("{\"name\":\"buffer\",\"cat\":\"flow\","
+      "\"ph\":\"%s\",%s\"id\":%" G_GUINT64_FORMAT ",\"ts\":%" G_GUINT64_FORMAT
+      ".%03u,\"pid\":%d,\"tid\":%d}", ph, ph[0] == 'f' ? "\"bp\":\"e\"," : "",
+      id, ts / 1000, (guint) (ts % 1000), TIMELINE_PID, tid);
+
+  g_mutex_lock (&self->lock);
+  fprintf (self->out, ",\n%s", line);
+  g_mutex_unlock (&self->lock);
+  g_free (line);
+}
+
+static void
+begin_pad_slice (GstTimelineTracer * self, GstClockTime ts, GstPad * pad,
+    const gchar * cat)
+{
+  GstObject *parent = GST_OBJECT_PARENT (pad);
+  gchar *name;
+
+  name = g_strdup_printf ("%s:%s", parent ? GST_OBJECT_NAME (parent) : "",
+      GST_OBJECT_NAME (pad));
+  write_event (self, ts, "B", name, cat);
+  g_free (name);
+}
+
+static void
+free_flow (GstTimelineFlow * flow)
+{
+  g_slice_free (GstTimelineFlow, flow);
+}
+
+/* link the push of @buffer to its previous push if that was done by another
+ * thread */
+static void
+do_buffer_flow (GstTimelineTracer * self, GstClockTime ts, GstBuffer * buffer)
+{
+  GstMiniObject *obj = GST_MINI_OBJECT_CAST (buffer);
+  GstTimelineFlow *flow;
+  gint tid = get_tid (self);
+
+  flow = gst_mini_object_get_qdata (obj, flow_quark);
+  if (flow && flow->tid != tid)
+    write_flow (self, ts, "f", flow->id);
+
+  flow = g_slice_new (GstTimelineFlow);
+  flow->id = g_atomic_int_add (&next_flow_id, 1) + 1;
+  flow->tid = tid;
+  write_flow (self, ts, "s", flow->id);
+
+  gst_mini_object_set_qdata (obj, flow_quark, flow,
+      (GDestroyNotify) free_flow);
+}
+
+/* hooks */
+
+static void
+do_push_buffer_pre (GstTimelineTracer * self, guint64 ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  begin_pad_slice (self, ts, pad, "push");
+  do_buffer_flow (self, ts, buffer);
+}
+
+static void
+do_push_buffer_list_pre (GstTimelineTracer * self, guint64 ts, GstPad * pad,
+    GstBufferList * list)
+{
+  begin_pad_slice (self, ts, pad, "push");
+  if (gst_buffer_list_length (list) > 0)
+    do_buffer_flow (self, ts, gst_buffer_list_get (list, 0));
+}
+
+static void
+do_pull_range_pre (GstTimelineTracer * self, guint64 ts, GstPad * pad)
+{
+  begin_pad_slice (self, ts, pad, "pull");
+}
+
+static void
+do_push_event_pre (GstTimelineTracer * self, guint64 ts, GstPad * pad,
+    GstEvent * event)
+{
+  begin_pad_slice (self, ts, pad, GST_EVENT_TYPE_NAME (event));
+}
+
+static void
+do_pad_query_pre (GstTimelineTracer * self, guint64 ts, GstPad * pad,
+    GstQuery * query)
+{
+  begin_pad_slice (self, ts, pad, GST_QUERY_TYPE_NAME (query));
+}
+
+static void
+do_element_query_pre (GstTimelineTracer * self, guint64 ts,
+    GstElement * element, GstQuery * query)
+{
+  write_event (self, ts, "B", GST_OBJECT_NAME (element),
+      GST_QUERY_TYPE_NAME (query));
+}
+
+static void
+do_element_change_state_pre (GstTimelineTracer * self, guint64 ts,
+    GstElement * element, GstStateChange transition)
+{
+  gchar *name;
+
+  name = g_strdup_printf ("%s %s->%s", GST_OBJECT_NAME (element),
+      gst_element_state_get_name (GST_STATE_TRANSITION_CURRENT (transition)),
+      gst_element_state_get_name (GST_STATE_TRANSITION_NEXT (transition)));
+  write_event (self, ts, "B", name, "state");
+  g_free (name);
+}
+
+/* all post hooks close the slice of their pre hook */
+static void
+do_post (GstTimelineTracer * self, guint64 ts)
+{
+  write_event (self, ts, "E", NULL, NULL);
+}
+
+/* tracer class */
+
+static void
+set_params (GstTimelineTracer * self)
+{
+  gchar *params, *tmp;
+  GstStructure *params_struct;
+  const gchar *filename;
+
+  g_object_get (self, "params", &params, NULL);
+  if (!params)
+    return;
+
+  tmp = g_strdup_printf ("timeline,%s", params);
+  params_struct = gst_structure_from_string (tmp, NULL);
+  g_free (tmp);
+
+  if (params_struct) {
+    if ((filename = gst_structure_get_string (params_struct, "file"))) {
+      g_free (self->filename);
+      self->filename = g_strdup (filename);
+    }
+    gst_structure_free (params_struct);
+  } else {
+    GST_WARNING_OBJECT (self, "invalid params '%s'", params);
+  }
+  g_free (params);
+}
+
+static void
+gst_timeline_tracer_constructed (GObject * object)
+{
+  GstTimelineTracer *self = GST_TIMELINE_TRACER (object);
+  GstTracer *tracer = GST_TRACER (object);
+  gchar *prgname;
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+
+  set_params (self);
+
+  self->out = g_fopen (self->filename, "w");
+  if (!self->out) {
+    GST_WARNING_OBJECT (self, "can't open '%s' for writing: %s",
+        self->filename, g_strerror (errno));
+    return;
+  }
+  GST_INFO_OBJECT (self, "writing timeline to '%s'", self->filename);
+
+  prgname = escape_name (g_get_prgname ());
+  fprintf (self->out, "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+      "\"args\":{\"name\":\"%s\"}}", TIMELINE_PID, prgname);
+  g_free (prgname);
+
+  gst_tracing_register_sampled_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_sampled_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_post));
+  gst_tracing_register_sampled_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_sampled_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_post));
+  gst_tracing_register_sampled_hook (tracer, "pad-pull-range-pre",
+      G_CALLBACK (do_pull_range_pre));
+  gst_tracing_register_sampled_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_post));
+  gst_tracing_register_hook (tracer, "pad-push-event-pre",
+      G_CALLBACK (do_push_event_pre));
+  gst_tracing_register_hook (tracer, "pad-push-event-post",
+      G_CALLBACK (do_post));
+  gst_tracing_register_hook (tracer, "pad-query-pre",
+      G_CALLBACK (do_pad_query_pre));
+  gst_tracing_register_hook (tracer, "pad-query-post", G_CALLBACK (do_post));
+  gst_tracing_register_hook (tracer, "element-query-pre",
+      G_CALLBACK (do_element_query_pre));
+  gst_tracing_register_hook (tracer, "element-query-post",
+      G_CALLBACK (do_post));
+  gst_tracing_register_hook (tracer, "element-change-state-pre",
+      G_CALLBACK (do_element_change_state_pre));
+  gst_tracing_register_hook (tracer, "element-change-state-post",
+      G_CALLBACK (do_post));
+}
+
+static void
+gst_timeline_tracer_finalize (GObject * obj)
+{
+  GstTimelineTracer *self = GST_TIMELINE_TRACER (obj);
+
+  if (self->out) {
+    fputs ("\n]\n", self->out);
+    fclose (self->out);
+  }
+  g_free (self->filename);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_timeline_tracer_class_init (GstTimelineTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gst_timeline_tracer_constructed;
+  gobject_class->finalize = gst_timeline_tracer_finalize;
+}
+
+static void
+gst_timeline_tracer_init (GstTimelineTracer * self)
+{
+  g_mutex_init (&self->lock);
+  self->filename = g_strdup (DEFAULT_FILENAME);
+}
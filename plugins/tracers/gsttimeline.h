@@ -0,0 +1,71 @@
+/* GStreamer
+ *
+ * gsttimeline.h: tracing module that writes a trace event timeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_TIMELINE_TRACER_H__
+#define __GST_TIMELINE_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+#include <stdio.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TIMELINE_TRACER \
+  (gst_timeline_tracer_get_type())
+#define GST_TIMELINE_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_TIMELINE_TRACER,GstTimelineTracer))
+#define GST_TIMELINE_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_TIMELINE_TRACER,GstTimelineTracerClass))
+#define GST_IS_TIMELINE_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_TIMELINE_TRACER))
+#define GST_IS_TIMELINE_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_TIMELINE_TRACER))
+#define GST_TIMELINE_TRACER_CAST(obj) ((GstTimelineTracer *)(obj))
+
+typedef struct _GstTimelineTracer GstTimelineTracer;
+typedef struct _GstTimelineTracerClass GstTimelineTracerClass;
+
+/**
+ * GstTimelineTracer:
+ *
+ * Opaque #GstTimelineTracer data structure
+ */
+struct _GstTimelineTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  /* protects out */
+  GMutex lock;
+  FILE *out;
+  gchar *filename;
+};
+
+struct _GstTimelineTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_timeline_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_TIMELINE_TRACER_H__ */
@@ -24,10 +24,15 @@
 #endif
 
 #include <gst/gst.h>
+#include "gstgraphstats.h"
 #include "gstlatency.h"
 #include "gstlog.h"
+#include "gstnegotiation.h"
+#include "gstproctime.h"
+#include "gstqueuelevels.h"
 #include "gstrusage.h"
 #include "gststats.h"
+#include "gsttimeline.h"
 #include "gstleaks.h"
 
 static gboolean
@@ -47,6 +52,21 @@ plugin_init (GstPlugin * plugin)
     return FALSE;
   if (!gst_tracer_register (plugin, "leaks", gst_leaks_tracer_get_type ()))
     return FALSE;
+  if (!gst_tracer_register (plugin, "negotiation",
+          gst_negotiation_tracer_get_type ()))
+    return FALSE;
+  if (!gst_tracer_register (plugin, "proctime",
+          gst_proc_time_tracer_get_type ()))
+    return FALSE;
+  if (!gst_tracer_register (plugin, "queuelevels",
+          gst_queue_levels_tracer_get_type ()))
+    return FALSE;
+  if (!gst_tracer_register (plugin, "timeline",
+          gst_timeline_tracer_get_type ()))
+    return FALSE;
+  if (!gst_tracer_register (plugin, "graphstats",
+          gst_graph_stats_tracer_get_type ()))
+    return FALSE;
   return TRUE;
 }
 
@@ -24,6 +24,8 @@
 
 
 #define NUM_CAPS 10000
+#define NUM_SIMPLIFY 1000
+#define NUM_FORMATS 50
 
 #define AUDIO_FORMATS_ALL " { S8, U8, " \
     "S16LE, S16BE, U16LE, U16BE, " \
@@ -71,5 +73,39 @@ main (gint argc, gchar * argv[])
   g_free (capses);
   gst_caps_unref (protocaps);
 
+  /* caps with one structure per format, like the ones built by elements
+   * that enumerate what their hardware supports */
+  protocaps = gst_caps_new_empty ();
+  for (i = 0; i < NUM_FORMATS; i++) {
+    gchar *format = g_strdup_printf ("F%03d", i);
+
+    gst_caps_append_structure (protocaps, gst_structure_new ("video/x-raw",
+            "format", G_TYPE_STRING, format, "width", GST_TYPE_INT_RANGE, 1,
+            G_MAXINT, "height", GST_TYPE_INT_RANGE, 1, G_MAXINT, NULL));
+    g_free (format);
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_SIMPLIFY; i++) {
+    GstCaps *caps = gst_caps_simplify (gst_caps_copy (protocaps));
+
+    gst_caps_unref (caps);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - simplifying %d caps of %d structures\n",
+      GST_TIME_ARGS (end - start), i, NUM_FORMATS);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_CAPS; i++) {
+    GstCaps *caps = gst_caps_fixate (gst_caps_ref (protocaps));
+
+    gst_caps_unref (caps);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - fixating %d shared caps of %d structures\n",
+      GST_TIME_ARGS (end - start), i, NUM_FORMATS);
+
+  gst_caps_unref (protocaps);
+
   return 0;
 }
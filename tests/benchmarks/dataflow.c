@@ -0,0 +1,268 @@
+/* GStreamer
+ *
+ * dataflow.c: benchmarks for the core dataflow
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Each benchmark prints one result, see gstbench.c for the options and the
+ * JSON format. The names contain the size of the pipeline so that the
+ * results of different releases can be compared by name. */
+
+#include <gst/gst.h>
+#include <gst/base/gstflowcombiner.h>
+
+#include "gstbench.h"
+
+#define BUFFER_SIZE 1024
+#define CAPS "application/x-bench, rate=(int)48000"
+
+static gchar *
+make_chain (const gchar * element, guint n)
+{
+  GString *s = g_string_new (element);
+  guint i;
+
+  for (i = 1; i < n; i++)
+    g_string_append_printf (s, " ! %s", element);
+
+  return g_string_free (s, FALSE);
+}
+
+/* buffers pushed through a chain of elements */
+static void
+run_push (GstBench * bench, const gchar * element, guint n,
+    GstBuffer * buffer)
+{
+  gchar *chain = make_chain (element, n);
+  gchar *name = g_strdup_printf ("push-%s-%u", element, n);
+  GstHarness *h = gst_harness_new_parse (chain);
+
+  gst_harness_set_src_caps_str (h, CAPS);
+  gst_bench_run_harness (bench, name, h, buffer);
+
+  gst_harness_teardown (h);
+  g_free (name);
+  g_free (chain);
+}
+
+/* buffers pushed into a tee with n branches, one of them to the harness */
+static void
+run_tee (GstBench * bench, guint n, GstBuffer * buffer)
+{
+  GString *s = g_string_new ("tee name=t");
+  gchar *name = g_strdup_printf ("tee-fanout-%u", n);
+  GstHarness *h;
+  guint i;
+
+  for (i = 1; i < n; i++)
+    g_string_append (s, " t. ! fakesink sync=false async=false");
+  g_string_append (s, " t. ! identity");
+
+  h = gst_harness_new_parse (s->str);
+  gst_harness_set_src_caps_str (h, CAPS);
+  gst_bench_run_harness (bench, name, h, buffer);
+
+  gst_harness_teardown (h);
+  g_free (name);
+  g_string_free (s, TRUE);
+}
+
+typedef struct
+{
+  GstFlowCombiner *combiner;
+  GstPad **pads;
+  guint n_pads;
+  guint next;
+  GstBuffer *buffer;
+} DemuxBench;
+
+static GstFlowReturn
+demux_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static void
+demux_push (DemuxBench * d)
+{
+  GstPad *pad = d->pads[d->next];
+  GstFlowReturn ret;
+
+  ret = gst_pad_push (pad, gst_buffer_ref (d->buffer));
+  gst_flow_combiner_update_pad_flow (d->combiner, pad, ret);
+  d->next = (d->next + 1) % d->n_pads;
+}
+
+/* what a demuxer does per buffer, push on one of n source pads and combine
+ * the flow return with the other pads */
+static void
+run_demux_push (GstBench * bench, guint n, GstBuffer * buffer)
+{
+  gchar *name = g_strdup_printf ("demux-push-%u", n);
+  GstPad **peers = g_new (GstPad *, n);
+  GstSegment segment;
+  DemuxBench d;
+  guint i;
+
+  d.combiner = gst_flow_combiner_new ();
+  d.pads = g_new (GstPad *, n);
+  d.n_pads = n;
+  d.next = 0;
+  d.buffer = buffer;
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  for (i = 0; i < n; i++) {
+    gchar *stream_id = g_strdup_printf ("stream-%u", i);
+
+    d.pads[i] = gst_pad_new (NULL, GST_PAD_SRC);
+    peers[i] = gst_pad_new (NULL, GST_PAD_SINK);
+    gst_pad_set_chain_function (peers[i], demux_sink_chain);
+    gst_pad_link (d.pads[i], peers[i]);
+    gst_pad_set_active (peers[i], TRUE);
+    gst_pad_set_active (d.pads[i], TRUE);
+    gst_pad_push_event (d.pads[i], gst_event_new_stream_start (stream_id));
+    gst_pad_push_event (d.pads[i], gst_event_new_segment (&segment));
+    gst_flow_combiner_add_pad (d.combiner, d.pads[i]);
+    g_free (stream_id);
+  }
+
+  gst_bench_run (bench, name, (GstBenchFunc) demux_push, &d);
+
+  gst_flow_combiner_free (d.combiner);
+  for (i = 0; i < n; i++) {
+    gst_pad_set_active (d.pads[i], FALSE);
+    gst_pad_set_active (peers[i], FALSE);
+    gst_object_unref (d.pads[i]);
+    gst_object_unref (peers[i]);
+  }
+  g_free (d.pads);
+  g_free (peers);
+  g_free (name);
+}
+
+static void
+buffer_pool_acquire (GstBufferPool * pool)
+{
+  GstBuffer *buffer;
+
+  gst_buffer_pool_acquire_buffer (pool, &buffer, NULL);
+  gst_buffer_unref (buffer);
+}
+
+static void
+run_buffer_pool (GstBench * bench)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *config;
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, BUFFER_SIZE, 0, 0);
+  gst_buffer_pool_set_config (pool, config);
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  gst_bench_run (bench, "buffer-pool-acquire-release",
+      (GstBenchFunc) buffer_pool_acquire, pool);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+static void
+caps_query (GstHarness * h)
+{
+  gst_caps_unref (gst_pad_peer_query_caps (h->srcpad, NULL));
+}
+
+/* caps queries through a chain of capsfilters, like negotiation does */
+static void
+run_caps_query (GstBench * bench, guint n)
+{
+  gchar *chain = make_chain ("capsfilter caps=\"" CAPS "\"", n);
+  gchar *name = g_strdup_printf ("caps-query-capsfilter-%u", n);
+  GstHarness *h = gst_harness_new_parse (chain);
+
+  gst_harness_set_sink_caps_str (h, CAPS ", channels=(int)2");
+  gst_bench_run_n (bench, name, 1000, (GstBenchFunc) caps_query, h);
+
+  gst_harness_teardown (h);
+  g_free (name);
+  g_free (chain);
+}
+
+static void
+state_change (GstElement * pipeline)
+{
+  gst_element_set_state (pipeline, GST_STATE_READY);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+}
+
+/* NULL to READY to NULL of a pipeline with n identities */
+static void
+run_state_change (GstBench * bench, guint n)
+{
+  gchar *chain = make_chain ("identity", n);
+  gchar *desc = g_strdup_printf ("fakesrc ! %s ! fakesink", chain);
+  gchar *name = g_strdup_printf ("state-change-identity-%u", n);
+  GstElement *pipeline = gst_parse_launch (desc, NULL);
+
+  gst_bench_run_n (bench, name, 100, (GstBenchFunc) state_change, pipeline);
+
+  gst_object_unref (pipeline);
+  g_free (name);
+  g_free (desc);
+  g_free (chain);
+}
+
+/* the registry is only loaded once by gst_init(), rescanning an up to date
+ * registry checks all plugin files the same way loading does */
+static void
+registry_update (gpointer user_data)
+{
+  gst_update_registry ();
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBench *bench;
+  GstBuffer *buffer;
+
+  bench = gst_bench_new (&argc, &argv);
+  buffer = gst_buffer_new_allocate (NULL, BUFFER_SIZE, NULL);
+
+  run_push (bench, "identity", 1, buffer);
+  run_push (bench, "identity", 10, buffer);
+  run_push (bench, "identity", 100, buffer);
+  run_push (bench, "queue", 1, buffer);
+  run_push (bench, "queue", 4, buffer);
+  run_tee (bench, 2, buffer);
+  run_tee (bench, 8, buffer);
+  run_demux_push (bench, 1, buffer);
+  run_demux_push (bench, 64, buffer);
+  run_buffer_pool (bench);
+  run_caps_query (bench, 10);
+  run_caps_query (bench, 50);
+  run_state_change (bench, 10);
+  run_state_change (bench, 100);
+  gst_bench_run_n (bench, "registry-update", 10, registry_update, NULL);
+
+  gst_buffer_unref (buffer);
+  gst_bench_free (bench);
+
+  return 0;
+}
@@ -0,0 +1,280 @@
+/* GStreamer
+ *
+ * gstbench.c: helpers for micro benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* A benchmark runs each operation a number of times to warm up, then
+ * measures a number of repetitions with a fixed number of operations each.
+ * The result is the median and the minimum time per operation over the
+ * repetitions, and the number of memory allocations and allocated bytes per
+ * operation. Memory is counted with an allocator that replaces the default
+ * allocator while the benchmark runs.
+ *
+ * The options are:
+ *   --warmup=N       operations before measuring (default 1000)
+ *   --repeat=N       number of measured repetitions (default 10)
+ *   --iterations=N   operations per repetition (default 10000)
+ *   --json           print one JSON object per benchmark
+ *   --filter=STRING  only run benchmarks whose name contains STRING
+ *
+ * The JSON objects are meant to be compared between releases, fields are
+ * only ever added and the "schema" field is increased when the meaning of
+ * an existing field changes:
+ *   "schema"         version of the format, currently 1
+ *   "name"           name of the benchmark
+ *   "repetitions"    number of measured repetitions
+ *   "iterations"     number of operations per repetition
+ *   "ns-per-op"      median time per operation in nanoseconds
+ *   "min-ns-per-op"  minimum time per operation in nanoseconds
+ *   "allocs-per-op"  memory allocations per operation
+ *   "bytes-per-op"   allocated bytes per operation
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gstbench.h"
+
+/* counting allocator */
+
+typedef struct
+{
+  GstAllocator parent;
+
+  GstAllocator *sysmem;
+  /* protected by the object lock */
+  guint64 allocs;
+  guint64 bytes;
+} GstBenchAllocator;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstBenchAllocatorClass;
+
+static GType gst_bench_allocator_get_type (void);
+G_DEFINE_TYPE (GstBenchAllocator, gst_bench_allocator, GST_TYPE_ALLOCATOR);
+
+static GstMemory *
+gst_bench_allocator_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  GstBenchAllocator *self = (GstBenchAllocator *) allocator;
+
+  GST_OBJECT_LOCK (self);
+  self->allocs++;
+  self->bytes += size;
+  GST_OBJECT_UNLOCK (self);
+
+  /* the memory belongs to the system allocator, which also frees it */
+  return gst_allocator_alloc (self->sysmem, size, params);
+}
+
+static void
+gst_bench_allocator_finalize (GObject * object)
+{
+  GstBenchAllocator *self = (GstBenchAllocator *) object;
+
+  gst_object_unref (self->sysmem);
+
+  G_OBJECT_CLASS (gst_bench_allocator_parent_class)->finalize (object);
+}
+
+static void
+gst_bench_allocator_class_init (GstBenchAllocatorClass * klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = gst_bench_allocator_finalize;
+  GST_ALLOCATOR_CLASS (klass)->alloc = gst_bench_allocator_alloc;
+}
+
+static void
+gst_bench_allocator_init (GstBenchAllocator * self)
+{
+  self->sysmem = gst_allocator_find (GST_ALLOCATOR_SYSMEM);
+}
+
+/* benchmarks */
+
+struct _GstBench
+{
+  guint warmup;
+  guint repeat;
+  guint iterations;
+  gboolean json;
+  gchar *filter;
+
+  GstBenchAllocator *allocator;
+  GstAllocator *old_allocator;
+
+  GstClockTime *times;
+};
+
+GstBench *
+gst_bench_new (gint * argc, gchar *** argv)
+{
+  GstBench *bench = g_new0 (GstBench, 1);
+  GOptionContext *ctx;
+  GError *err = NULL;
+  gint warmup = 1000, repeat = 10, iterations = 10000;
+  GOptionEntry options[] = {
+    {"warmup", 0, 0, G_OPTION_ARG_INT, &warmup,
+        "Number of operations before measuring", "N"},
+    {"repeat", 0, 0, G_OPTION_ARG_INT, &repeat,
+        "Number of measured repetitions", "N"},
+    {"iterations", 0, 0, G_OPTION_ARG_INT, &iterations,
+        "Number of operations per repetition", "N"},
+    {"json", 0, 0, G_OPTION_ARG_NONE, &bench->json,
+        "Print the results as JSON", NULL},
+    {"filter", 0, 0, G_OPTION_ARG_STRING, &bench->filter,
+        "Only run benchmarks whose name contains this", "STRING"},
+    {NULL}
+  };
+
+  ctx = g_option_context_new ("");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, argc, argv, &err)) {
+    g_print ("Error initializing: %s\n", GST_STR_NULL (err->message));
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    exit (1);
+  }
+  g_option_context_free (ctx);
+
+  bench->warmup = MAX (warmup, 0);
+  bench->repeat = MAX (repeat, 1);
+  bench->iterations = MAX (iterations, 1);
+  bench->times = g_new (GstClockTime, bench->repeat);
+
+  bench->old_allocator = gst_allocator_find (NULL);
+  bench->allocator = g_object_new (gst_bench_allocator_get_type (), NULL);
+  gst_allocator_set_default (gst_object_ref (bench->allocator));
+
+  return bench;
+}
+
+void
+gst_bench_free (GstBench * bench)
+{
+  gst_allocator_set_default (bench->old_allocator);
+  gst_object_unref (bench->allocator);
+  g_free (bench->times);
+  g_free (bench->filter);
+  g_free (bench);
+}
+
+static gint
+compare_times (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a;
+  GstClockTime tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+/* like gst_bench_run() for expensive operations, with at most @iterations
+ * operations per repetition and as many warmup operations */
+void
+gst_bench_run_n (GstBench * bench, const gchar * name, guint iterations,
+    GstBenchFunc func, gpointer user_data)
+{
+  GstClockTime start;
+  gdouble median, min, allocs, bytes;
+  guint64 n_ops;
+  guint i, r, warmup;
+
+  if (bench->filter && !strstr (name, bench->filter))
+    return;
+
+  iterations = MAX (MIN (iterations, bench->iterations), 1);
+  warmup = MIN (iterations, bench->warmup);
+
+  for (i = 0; i < warmup; i++)
+    func (user_data);
+
+  GST_OBJECT_LOCK (bench->allocator);
+  bench->allocator->allocs = bench->allocator->bytes = 0;
+  GST_OBJECT_UNLOCK (bench->allocator);
+
+  for (r = 0; r < bench->repeat; r++) {
+    start = gst_util_get_timestamp ();
+    for (i = 0; i < iterations; i++)
+      func (user_data);
+    bench->times[r] = gst_util_get_timestamp () - start;
+  }
+
+  qsort (bench->times, bench->repeat, sizeof (GstClockTime), compare_times);
+  min = (gdouble) bench->times[0] / iterations;
+  median = (gdouble) bench->times[bench->repeat / 2] / iterations;
+
+  n_ops = (guint64) bench->repeat * iterations;
+  GST_OBJECT_LOCK (bench->allocator);
+  allocs = (gdouble) bench->allocator->allocs / n_ops;
+  bytes = (gdouble) bench->allocator->bytes / n_ops;
+  GST_OBJECT_UNLOCK (bench->allocator);
+
+  if (bench->json) {
+    gchar *escaped = g_strescape (name, NULL);
+
+    g_print ("{\"schema\": 1, \"name\": \"%s\", \"repetitions\": %u, "
+        "\"iterations\": %u, \"ns-per-op\": %.2f, \"min-ns-per-op\": %.2f, "
+        "\"allocs-per-op\": %.3f, \"bytes-per-op\": %.1f}\n", escaped,
+        bench->repeat, iterations, median, min, allocs, bytes);
+    g_free (escaped);
+  } else {
+    g_print ("%-40s %10.2f ns/op (min %.2f) %8.3f allocs/op %10.1f B/op\n",
+        name, median, min, allocs, bytes);
+  }
+}
+
+void
+gst_bench_run (GstBench * bench, const gchar * name, GstBenchFunc func,
+    gpointer user_data)
+{
+  gst_bench_run_n (bench, name, G_MAXUINT, func, user_data);
+}
+
+typedef struct
+{
+  GstHarness *h;
+  GstBuffer *buffer;
+} HarnessData;
+
+static void
+harness_push_pull (HarnessData * data)
+{
+  GstBuffer *out;
+
+  gst_harness_push (data->h, gst_buffer_ref (data->buffer));
+  out = gst_harness_pull (data->h);
+  if (out)
+    gst_buffer_unref (out);
+}
+
+void
+gst_bench_run_harness (GstBench * bench, const gchar * name, GstHarness * h,
+    GstBuffer * buffer)
+{
+  HarnessData data = { h, buffer };
+
+  gst_bench_run (bench, name, (GstBenchFunc) harness_push_pull, &data);
+}
@@ -0,0 +1,48 @@
+/* GStreamer
+ *
+ * gstbench.h: helpers for micro benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BENCH_H__
+#define __GST_BENCH_H__
+
+#include <gst/gst.h>
+#include <gst/check/gstharness.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstBench GstBench;
+
+/* one operation of a benchmark */
+typedef void (*GstBenchFunc) (gpointer user_data);
+
+/* parses the benchmark options and initializes GStreamer */
+GstBench *  gst_bench_new           (gint * argc, gchar *** argv);
+void        gst_bench_free          (GstBench * bench);
+
+void        gst_bench_run           (GstBench * bench, const gchar * name,
+                                     GstBenchFunc func, gpointer user_data);
+void        gst_bench_run_n         (GstBench * bench, const gchar * name,
+                                     guint iterations, GstBenchFunc func,
+                                     gpointer user_data);
+void        gst_bench_run_harness   (GstBench * bench, const gchar * name,
+                                     GstHarness * h, GstBuffer * buffer);
+
+G_END_DECLS
+
+#endif /* __GST_BENCH_H__ */
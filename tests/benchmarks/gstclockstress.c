@@ -43,22 +43,71 @@ run_test (void *user_data)
   return NULL;
 }
 
+static gboolean
+async_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  return TRUE;
+}
+
+/* measure how long it takes to schedule and unschedule @num_ids periodic
+ * async ids that are spread over the next seconds */
+static void
+run_async_test (GstClock * sysclock, gint num_ids)
+{
+  GstClockID *ids;
+  GstClockTime base, start, end;
+  gint i;
+
+  ids = g_new (GstClockID, num_ids);
+
+  base = gst_clock_get_time (sysclock) + GST_SECOND;
+  for (i = 0; i < num_ids; i++) {
+    ids[i] = gst_clock_new_periodic_id (sysclock,
+        base + g_random_int_range (0, 1000) * GST_MSECOND, GST_SECOND);
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_ids; i++)
+    gst_clock_id_wait_async (ids[i], async_cb, NULL, NULL);
+  end = gst_util_get_timestamp ();
+
+  g_print ("scheduled %d async ids in %" GST_TIME_FORMAT " (%"
+      G_GUINT64_FORMAT " ns per id)\n", num_ids, GST_TIME_ARGS (end - start),
+      (end - start) / num_ids);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < num_ids; i++)
+    gst_clock_id_unschedule (ids[i]);
+  end = gst_util_get_timestamp ();
+
+  g_print ("unscheduled %d async ids in %" GST_TIME_FORMAT " (%"
+      G_GUINT64_FORMAT " ns per id)\n", num_ids, GST_TIME_ARGS (end - start),
+      (end - start) / num_ids);
+
+  for (i = 0; i < num_ids; i++)
+    gst_clock_id_unref (ids[i]);
+  g_free (ids);
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
   GThread *threads[MAX_THREADS];
-  gint num_threads;
+  gint num_threads, num_ids = 0;
   gint t;
   GstClock *sysclock;
 
   gst_init (&argc, &argv);
 
-  if (argc != 2) {
-    g_print ("usage: %s <num_threads>\n", argv[0]);
+  if (argc != 2 && argc != 3) {
+    g_print ("usage: %s <num_threads> [<num_async_ids>]\n", argv[0]);
     exit (-1);
   }
 
   num_threads = atoi (argv[1]);
+  if (argc == 3)
+    num_ids = atoi (argv[2]);
 
   if (num_threads <= 0 || num_threads > MAX_THREADS) {
     g_print ("number of threads must be between 0 and %d\n", MAX_THREADS);
@@ -81,8 +130,18 @@ main (gint argc, gchar * argv[])
   }
   printf ("main(): Created %d threads.\n", t);
 
-  /* run for 5 seconds */
-  g_usleep (G_USEC_PER_SEC * 5);
+  if (num_ids > 0) {
+    gint n;
+
+    /* the async ids are scheduled while the other threads keep reading the
+     * clock, 10 times more ids each round to show how it scales */
+    for (n = MIN (num_ids, 10); n < num_ids; n *= 10)
+      run_async_test (sysclock, n);
+    run_async_test (sysclock, num_ids);
+  } else {
+    /* run for 5 seconds */
+    g_usleep (G_USEC_PER_SEC * 5);
+  }
 
   printf ("main(): Stopping threads...\n");
 
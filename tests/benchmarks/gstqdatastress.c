@@ -0,0 +1,140 @@
+/* GStreamer
+ *
+ * gstqdatastress.c: stress test for the qdata of mini objects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#define MAX_THREADS  1000
+
+static guint64 nbiterations;
+static GstBuffer *shared_buffer;
+static GQuark quark;
+static GMutex mutex;
+
+static gpointer
+run_test (gpointer user_data)
+{
+  gint threadid = GPOINTER_TO_INT (user_data);
+  GstMiniObject *obj;
+  GstClockTime start, end;
+  guint64 nb;
+
+  g_mutex_lock (&mutex);
+  g_mutex_unlock (&mutex);
+
+  /* either all threads use the same buffer or each has its own */
+  if (shared_buffer)
+    obj = GST_MINI_OBJECT_CAST (gst_buffer_ref (shared_buffer));
+  else
+    obj = GST_MINI_OBJECT_CAST (gst_buffer_new ());
+
+  start = gst_util_get_timestamp ();
+
+  for (nb = nbiterations; nb; nb--) {
+    if (!shared_buffer)
+      gst_mini_object_set_qdata (obj, quark, GINT_TO_POINTER (threadid + 1),
+          NULL);
+    if (gst_mini_object_get_qdata (obj, quark) == NULL)
+      g_assert_not_reached ();
+  }
+
+  end = gst_util_get_timestamp ();
+  g_print ("total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Thread %d\n", GST_TIME_ARGS (end - start),
+      GST_TIME_ARGS ((end - start) / nbiterations), threadid);
+
+  gst_mini_object_unref (obj);
+
+  return NULL;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GThread *threads[MAX_THREADS];
+  gint num_threads;
+  gint t;
+  GstClockTime start, end;
+
+  gst_init (&argc, &argv);
+  g_mutex_init (&mutex);
+
+  if (argc < 3 || argc > 4 || (argc == 4 && strcmp (argv[3], "shared"))) {
+    g_print ("usage: %s <num_threads> <nbiterations> [shared]\n", argv[0]);
+    exit (-1);
+  }
+
+  num_threads = atoi (argv[1]);
+  nbiterations = atoi (argv[2]);
+
+  if (num_threads <= 0 || num_threads > MAX_THREADS) {
+    g_print ("number of threads must be between 0 and %d\n", MAX_THREADS);
+    exit (-2);
+  }
+
+  if (nbiterations <= 0) {
+    g_print ("number of iterations must be greater than 0\n");
+    exit (-3);
+  }
+
+  quark = g_quark_from_static_string ("qdatastress");
+  if (argc == 4) {
+    shared_buffer = gst_buffer_new ();
+    gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (shared_buffer), quark,
+        GINT_TO_POINTER (1), NULL);
+  }
+
+  g_mutex_lock (&mutex);
+  for (t = 0; t < num_threads; t++) {
+    GError *error = NULL;
+
+    threads[t] = g_thread_try_new ("qdatastresstest", run_test,
+        GINT_TO_POINTER (t), &error);
+
+    if (error) {
+      printf ("ERROR: g_thread_try_new() %s\n", error->message);
+      g_clear_error (&error);
+      exit (-1);
+    }
+  }
+
+  /* Signal all threads to start */
+  start = gst_util_get_timestamp ();
+  g_mutex_unlock (&mutex);
+
+  for (t = 0; t < num_threads; t++) {
+    if (threads[t])
+      g_thread_join (threads[t]);
+  }
+
+  end = gst_util_get_timestamp ();
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done with %" G_GUINT64_FORMAT " lookups\n",
+      GST_TIME_ARGS (end - start),
+      GST_TIME_ARGS ((end - start) / (num_threads * nbiterations)),
+      num_threads * nbiterations);
+
+  if (shared_buffer)
+    gst_buffer_unref (shared_buffer);
+
+  return 0;
+}
@@ -0,0 +1,264 @@
+/* GStreamer
+ *
+ * handoff.c: latency distribution of the thread hand-off elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Runs fakesrc ! QUEUE ! fakesink for every combination of the queues,
+ * rates and buffer sizes and prints the percentiles of the time between a
+ * buffer leaving fakesrc and arriving in fakesink.
+ *
+ * The queues are pipeline descriptions, so that properties can be set:
+ *   handoff --queue=queue --queue="queue leaky=downstream max-size-buffers=4"
+ *     --rates=0,1000 --sizes=64,65536
+ *
+ * A rate of 0 pushes as fast as possible, which measures the hand-off under
+ * load, otherwise the source pushes that many buffers per second. Buffers
+ * that a leaky queue drops are counted separately.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <gst/gst.h>
+
+static const gchar *default_queues[] = {
+  "queue",
+  "queue leaky=downstream max-size-buffers=16",
+  "queue max-batch-buffers=16 max-drain-buffers=16",
+  "queue2",
+  "multiqueue",
+  NULL
+};
+
+typedef struct
+{
+  GArray *latencies;
+  guint pushed;
+} HandoffData;
+
+static GstPadProbeReturn
+src_probe (GstPad * pad, GstPadProbeInfo * info, HandoffData * data)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_buffer_make_writable (GST_PAD_PROBE_INFO_BUFFER (info));
+
+  /* fakesrc's offsets are not needed, so the time goes there */
+  GST_BUFFER_OFFSET (buffer) = gst_util_get_timestamp ();
+  GST_PAD_PROBE_INFO_DATA (info) = buffer;
+  data->pushed++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+sink_probe (GstPad * pad, GstPadProbeInfo * info, HandoffData * data)
+{
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstClockTime latency =
+      gst_util_get_timestamp () - GST_BUFFER_OFFSET (buffer);
+
+  g_array_append_val (data->latencies, latency);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gint
+compare_times (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a;
+  GstClockTime tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+static GstClockTime
+percentile (GArray * sorted, gdouble p)
+{
+  guint i;
+
+  if (sorted->len == 0)
+    return 0;
+
+  i = MIN (p * sorted->len, sorted->len - 1);
+  return g_array_index (sorted, GstClockTime, i);
+}
+
+static gboolean
+run (const gchar * queue, guint rate, guint size, guint n_buffers,
+    gboolean json)
+{
+  HandoffData data = { NULL, 0 };
+  GstElement *pipeline, *src, *sink;
+  GstPad *pad;
+  GstMessage *msg;
+  GError *err = NULL;
+  gchar *desc;
+
+  desc = g_strdup_printf ("fakesrc name=src num-buffers=%u sizetype=fixed "
+      "sizemax=%u datarate=%u sync=%s ! %s ! fakesink name=sink sync=false",
+      n_buffers, size, (guint) MIN ((guint64) rate * size, G_MAXINT),
+      rate ? "true" : "false", queue);
+  pipeline = gst_parse_launch (desc, &err);
+  g_free (desc);
+  if (!pipeline) {
+    g_printerr ("Could not create pipeline for '%s': %s\n", queue,
+        err->message);
+    g_clear_error (&err);
+    return FALSE;
+  }
+
+  data.latencies = g_array_sized_new (FALSE, FALSE, sizeof (GstClockTime),
+      n_buffers);
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  pad = gst_element_get_static_pad (src, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) src_probe, &data, NULL);
+  gst_object_unref (pad);
+  gst_object_unref (src);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) sink_probe, &data, NULL);
+  gst_object_unref (pad);
+  gst_object_unref (sink);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, &err, NULL);
+    g_printerr ("Error running '%s': %s\n", queue, err->message);
+    g_clear_error (&err);
+  } else {
+    GArray *l = data.latencies;
+
+    g_array_sort (l, compare_times);
+    if (json) {
+      gchar *escaped = g_strescape (queue, NULL);
+
+      g_print ("{\"schema\": 1, \"queue\": \"%s\", \"rate\": %u, "
+          "\"size\": %u, \"buffers\": %u, \"dropped\": %u, "
+          "\"p50-ns\": %" G_GUINT64_FORMAT ", \"p90-ns\": %" G_GUINT64_FORMAT
+          ", \"p99-ns\": %" G_GUINT64_FORMAT ", \"p999-ns\": %"
+          G_GUINT64_FORMAT ", \"max-ns\": %" G_GUINT64_FORMAT "}\n", escaped,
+          rate, size, l->len, data.pushed - l->len, percentile (l, 0.5),
+          percentile (l, 0.9), percentile (l, 0.99), percentile (l, 0.999),
+          percentile (l, 1.0));
+      g_free (escaped);
+    } else {
+      g_print ("%s, rate %u/s, size %u: %u buffers, %u dropped\n", queue,
+          rate, size, l->len, data.pushed - l->len);
+      g_print ("  p50 %" GST_TIME_FORMAT "  p90 %" GST_TIME_FORMAT "  p99 %"
+          GST_TIME_FORMAT "  p99.9 %" GST_TIME_FORMAT "  max %"
+          GST_TIME_FORMAT "\n", GST_TIME_ARGS (percentile (l, 0.5)),
+          GST_TIME_ARGS (percentile (l, 0.9)),
+          GST_TIME_ARGS (percentile (l, 0.99)),
+          GST_TIME_ARGS (percentile (l, 0.999)),
+          GST_TIME_ARGS (percentile (l, 1.0)));
+    }
+  }
+
+  gst_message_unref (msg);
+  gst_object_unref (pipeline);
+  g_array_free (data.latencies, TRUE);
+
+  return TRUE;
+}
+
+static GArray *
+parse_uint_list (const gchar * str)
+{
+  GArray *res = g_array_new (FALSE, FALSE, sizeof (guint));
+  gchar **items = g_strsplit (str, ",", -1);
+  gchar **item;
+
+  for (item = items; *item; item++) {
+    guint v = strtoul (*item, NULL, 10);
+
+    g_array_append_val (res, v);
+  }
+  g_strfreev (items);
+
+  return res;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gchar **queues = NULL;
+  gchar *rates_str = NULL, *sizes_str = NULL;
+  gint n_buffers = 2000;
+  gboolean json = FALSE, res = TRUE;
+  GArray *rates, *sizes;
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GOptionEntry options[] = {
+    {"queue", 0, 0, G_OPTION_ARG_STRING_ARRAY, &queues,
+        "Hand-off element with properties, can be repeated", "DESCRIPTION"},
+    {"rates", 0, 0, G_OPTION_ARG_STRING, &rates_str,
+        "Buffers per second, 0 for as fast as possible (default 0,1000)",
+        "RATE,..."},
+    {"sizes", 0, 0, G_OPTION_ARG_STRING, &sizes_str,
+        "Buffer sizes in bytes (default 64,65536)", "SIZE,..."},
+    {"buffers", 0, 0, G_OPTION_ARG_INT, &n_buffers,
+        "Number of buffers of each run (default 2000)", "N"},
+    {"json", 0, 0, G_OPTION_ARG_NONE, &json,
+        "Print the results as JSON", NULL},
+    {NULL}
+  };
+  const gchar **queue;
+  guint r, s;
+
+  ctx = g_option_context_new ("");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_print ("Error initializing: %s\n", GST_STR_NULL (err->message));
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  rates = parse_uint_list (rates_str ? rates_str : "0,1000");
+  sizes = parse_uint_list (sizes_str ? sizes_str : "64,65536");
+  n_buffers = MAX (n_buffers, 1);
+
+  for (queue = queues ? (const gchar **) queues : default_queues; *queue;
+      queue++) {
+    for (r = 0; r < rates->len; r++) {
+      for (s = 0; s < sizes->len; s++) {
+        res &= run (*queue, g_array_index (rates, guint, r),
+            MAX (g_array_index (sizes, guint, s), 1), n_buffers, json);
+      }
+    }
+  }
+
+  g_array_free (rates, TRUE);
+  g_array_free (sizes, TRUE);
+  g_strfreev (queues);
+  g_free (rates_str);
+  g_free (sizes_str);
+
+  return res ? 0 : 1;
+}
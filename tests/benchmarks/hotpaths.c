@@ -0,0 +1,106 @@
+/* GStreamer
+ *
+ * hotpaths.c: micro benchmarks for frequently used code paths
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/gst.h>
+
+#include "gstbench.h"
+
+#define BUFFER_SIZE 1024
+#define CAPS "application/x-bench, rate=(int)48000"
+
+static void
+buffer_new_allocate (gpointer user_data)
+{
+  gst_buffer_unref (gst_buffer_new_allocate (NULL, BUFFER_SIZE, NULL));
+}
+
+static void
+buffer_copy_deep (GstBuffer * buffer)
+{
+  gst_buffer_unref (gst_buffer_copy_deep (buffer));
+}
+
+static void
+buffer_pool_acquire (GstBufferPool * pool)
+{
+  GstBuffer *buffer;
+
+  gst_buffer_pool_acquire_buffer (pool, &buffer, NULL);
+  gst_buffer_unref (buffer);
+}
+
+static void
+caps_intersect (GstCaps * caps)
+{
+  gst_caps_unref (gst_caps_intersect (caps, caps));
+}
+
+static void
+run_harness (GstBench * bench, const gchar * name, const gchar * element,
+    GstBuffer * buffer)
+{
+  GstHarness *h = gst_harness_new (element);
+
+  gst_harness_set_src_caps_str (h, CAPS);
+  gst_bench_run_harness (bench, name, h, buffer);
+  gst_harness_teardown (h);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBench *bench;
+  GstBuffer *buffer;
+  GstBufferPool *pool;
+  GstStructure *config;
+  GstCaps *caps;
+
+  bench = gst_bench_new (&argc, &argv);
+
+  buffer = gst_buffer_new_allocate (NULL, BUFFER_SIZE, NULL);
+
+  gst_bench_run (bench, "buffer-new-allocate", buffer_new_allocate, NULL);
+  gst_bench_run (bench, "buffer-copy-deep", (GstBenchFunc) buffer_copy_deep,
+      buffer);
+
+  pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, BUFFER_SIZE, 0, 0);
+  gst_buffer_pool_set_config (pool, config);
+  gst_buffer_pool_set_active (pool, TRUE);
+  gst_bench_run (bench, "buffer-pool-acquire",
+      (GstBenchFunc) buffer_pool_acquire, pool);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+
+  caps = gst_caps_from_string (CAPS "; " CAPS ", channels=(int)2");
+  gst_bench_run (bench, "caps-intersect", (GstBenchFunc) caps_intersect,
+      caps);
+  gst_caps_unref (caps);
+
+  run_harness (bench, "harness-identity", "identity", buffer);
+  run_harness (bench, "harness-capsfilter", "capsfilter", buffer);
+  run_harness (bench, "harness-queue", "queue", buffer);
+
+  gst_buffer_unref (buffer);
+  gst_bench_free (bench);
+
+  return 0;
+}
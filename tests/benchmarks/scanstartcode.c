@@ -0,0 +1,135 @@
+/* GStreamer
+ *
+ * scanstartcode.c: benchmark for the start code scan of GstByteReader and
+ *                  GstAdapter
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/base/gstadapter.h>
+#include <gst/base/gstbytereader.h>
+
+#define DATA_SIZE (16 * 1024 * 1024)
+/* about the size of a NAL unit in a high bitrate stream */
+#define UNIT_SIZE (16 * 1024)
+/* the payload size of an MPEG-TS packet */
+#define PACKET_SIZE 184
+
+static guint8 *
+make_data (void)
+{
+  guint8 *data;
+  guint i;
+
+  data = g_malloc (DATA_SIZE);
+  for (i = 0; i < DATA_SIZE; i++) {
+    data[i] = g_random_int_range (0, 256);
+    /* emulation prevention, like in real streams */
+    if (i >= 2 && data[i - 2] == 0 && data[i - 1] == 0 && data[i] <= 3)
+      data[i] = 3;
+  }
+  for (i = 0; i + 4 <= DATA_SIZE; i += UNIT_SIZE) {
+    data[i] = 0;
+    data[i + 1] = 0;
+    data[i + 2] = 1;
+  }
+  return data;
+}
+
+static guint
+scan_byte_reader (const guint8 * data)
+{
+  GstByteReader reader;
+  guint found = 0, offset = 0;
+  gint pos;
+
+  gst_byte_reader_init (&reader, data, DATA_SIZE);
+
+  while ((pos = gst_byte_reader_masked_scan_uint32 (&reader, 0xffffff00,
+              0x00000100, offset, DATA_SIZE - offset)) != -1) {
+    found++;
+    offset = pos + 1;
+    if (offset >= DATA_SIZE)
+      break;
+  }
+  return found;
+}
+
+static guint
+scan_adapter (GstAdapter * adapter)
+{
+  guint found = 0;
+  gsize offset = 0, avail;
+  gssize pos;
+
+  avail = gst_adapter_available (adapter);
+  while ((pos = gst_adapter_masked_scan_uint32 (adapter, 0xffffff00,
+              0x00000100, offset, avail - offset)) != -1) {
+    found++;
+    offset = pos + 1;
+    if (offset >= avail)
+      break;
+  }
+  return found;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstClockTime start, end;
+  GstAdapter *adapter;
+  guint8 *data;
+  guint i, found, runs = 10;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    runs = atoi (argv[1]);
+
+  data = make_data ();
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < runs; i++)
+    found = scan_byte_reader (data);
+  end = gst_util_get_timestamp ();
+  g_print ("byte reader: %u start codes, %" GST_TIME_FORMAT " per %u MB\n",
+      found, GST_TIME_ARGS ((end - start) / runs), DATA_SIZE >> 20);
+
+  adapter = gst_adapter_new ();
+  for (i = 0; i < DATA_SIZE; i += PACKET_SIZE) {
+    gst_adapter_push (adapter,
+        gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY, data + i,
+            MIN (PACKET_SIZE, DATA_SIZE - i), 0, MIN (PACKET_SIZE,
+                DATA_SIZE - i), NULL, NULL));
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < runs; i++)
+    found = scan_adapter (adapter);
+  end = gst_util_get_timestamp ();
+  g_print ("adapter (%u byte buffers): %u start codes, %" GST_TIME_FORMAT
+      " per %u MB\n", PACKET_SIZE, found,
+      GST_TIME_ARGS ((end - start) / runs), DATA_SIZE >> 20);
+
+  g_object_unref (adapter);
+  g_free (data);
+
+  return 0;
+}
@@ -518,6 +518,191 @@ GST_START_TEST (test_dataurisrc_from_uri)
 
 GST_END_TEST;
 
+/* as in gstdataurisrc.c */
+#define TYPEFIND_SIZE (64 * 1024)
+
+static gchar *
+make_base64_uri (const guint8 * bytes, gsize size)
+{
+  gchar *base64, *uri;
+
+  base64 = g_base64_encode (bytes, size);
+  uri = g_strdup_printf ("data:application/octet-stream;base64,%s", base64);
+  g_free (base64);
+
+  return uri;
+}
+
+static guint8 *
+make_bytes (gsize size)
+{
+  guint8 *bytes = g_malloc (size);
+  gsize i;
+
+  for (i = 0; i < size; i++)
+    bytes[i] = (i * 7 + 3) & 0xff;
+
+  return bytes;
+}
+
+/* sets @uri and activates @src in pull mode */
+static GstPad *
+start_pull (GstElement * src, const gchar * uri)
+{
+  GstPad *src_pad;
+
+  g_object_set (src, "uri", uri, NULL);
+  fail_unless_equals_int (gst_element_set_state (src, GST_STATE_READY),
+      GST_STATE_CHANGE_SUCCESS);
+  src_pad = gst_element_get_static_pad (src, "src");
+  fail_unless (gst_pad_activate_mode (src_pad, GST_PAD_MODE_PULL, TRUE));
+  fail_unless_equals_int (gst_element_set_state (src, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+
+  return src_pad;
+}
+
+static void
+check_range (GstPad * src_pad, const guint8 * bytes, gsize size,
+    guint64 offset, guint length)
+{
+  GstBuffer *buf = NULL;
+  gsize expected = MIN (length, size - offset);
+
+  fail_unless_equals_int (gst_pad_get_range (src_pad, offset, length, &buf),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_get_size (buf), expected);
+  fail_unless (gst_buffer_memcmp (buf, 0, bytes + offset, expected) == 0,
+      "wrong data at offset %" G_GUINT64_FORMAT ", size %u", offset, length);
+  gst_buffer_unref (buf);
+}
+
+/* the base64 data is decoded in place for each range, every 4 characters
+ * make 3 bytes so ranges that don't start or end on 3 bytes need to skip
+ * part of the decoded bytes */
+GST_START_TEST (test_dataurisrc_base64_ranges)
+{
+  /* 0, 2 and 1 padding characters */
+  const gsize sizes[] = { 300, 301, 302 };
+  guint i, offset, length;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    GstElement *src;
+    GstBuffer *buf = NULL;
+    GstPad *src_pad;
+    guint8 *bytes;
+    gchar *uri;
+    gsize size = sizes[i];
+
+    bytes = make_bytes (size);
+    uri = make_base64_uri (bytes, size);
+    src = setup_dataurisrc ();
+    src_pad = start_pull (src, uri);
+
+    /* unaligned starts and sizes */
+    for (offset = 0; offset < 6; offset++) {
+      for (length = 1; length < 8; length++)
+        check_range (src_pad, bytes, size, offset, length);
+    }
+    check_range (src_pad, bytes, size, 100, 101);
+
+    /* the end, where the last 4 characters can have padding */
+    for (length = 1; length < 6; length++)
+      check_range (src_pad, bytes, size, size - length, length);
+    check_range (src_pad, bytes, size, size - 2, 100);
+    check_range (src_pad, bytes, size, 0, size);
+
+    fail_unless_equals_int (gst_pad_get_range (src_pad, size, 1, &buf),
+        GST_FLOW_EOS);
+
+    gst_object_unref (src_pad);
+    fail_unless_equals_int (gst_element_set_state (src, GST_STATE_NULL),
+        GST_STATE_CHANGE_SUCCESS);
+    cleanup_dataurisrc (src);
+    g_free (uri);
+    g_free (bytes);
+  }
+}
+
+GST_END_TEST;
+
+/* data that is not plain base64 is decoded up front with g_base64_decode(),
+ * which skips the characters that are not part of the alphabet */
+GST_START_TEST (test_dataurisrc_base64_fallback)
+{
+  const guint8 bytes[] = { 0, 1, 2, 3, 4, 5, 6 };
+  const gchar *uri = "data:application/octet-stream;base64,AAEC\nAwQF\nBg==";
+  GstElement *src;
+  GstPad *src_pad;
+
+  src = setup_dataurisrc ();
+  src_pad = start_pull (src, uri);
+
+  check_range (src_pad, bytes, sizeof (bytes), 0, sizeof (bytes));
+  check_range (src_pad, bytes, sizeof (bytes), 1, 4);
+  check_range (src_pad, bytes, sizeof (bytes), 5, 2);
+
+  gst_object_unref (src_pad);
+  fail_unless_equals_int (gst_element_set_state (src, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  cleanup_dataurisrc (src);
+}
+
+GST_END_TEST;
+
+static gint typefind_calls;
+static gboolean typefind_saw_start;
+static gboolean typefind_saw_beyond;
+
+static void
+probe_typefind (GstTypeFind * tf, gpointer unused)
+{
+  typefind_calls++;
+  typefind_saw_start = gst_type_find_peek (tf, 0, TYPEFIND_SIZE) != NULL;
+  typefind_saw_beyond = gst_type_find_peek (tf, TYPEFIND_SIZE, 1) != NULL;
+}
+
+static GstStaticCaps probe_caps = GST_STATIC_CAPS ("test/x-probe");
+
+/* typefinding only decodes the start of big base64 data, the rest is decoded
+ * while reading */
+GST_START_TEST (test_dataurisrc_base64_typefind_size)
+{
+  GstElement *src;
+  GstPad *src_pad;
+  guint8 *bytes;
+  gchar *uri;
+  gsize size = TYPEFIND_SIZE * 2 + 1;
+
+  fail_unless (gst_type_find_register (NULL, "test/x-probe", GST_RANK_PRIMARY,
+          probe_typefind, NULL, gst_static_caps_get (&probe_caps), NULL,
+          NULL));
+
+  bytes = make_bytes (size);
+  uri = make_base64_uri (bytes, size);
+  src = setup_dataurisrc ();
+  typefind_calls = 0;
+  src_pad = start_pull (src, uri);
+
+  fail_unless_equals_int (typefind_calls, 1);
+  fail_unless (typefind_saw_start);
+  fail_if (typefind_saw_beyond);
+
+  /* the data after the typefind size is still all there */
+  check_range (src_pad, bytes, size, TYPEFIND_SIZE - 1, 5);
+  check_range (src_pad, bytes, size, size - 7, 7);
+  check_range (src_pad, bytes, size, 0, size);
+
+  gst_object_unref (src_pad);
+  fail_unless_equals_int (gst_element_set_state (src, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  cleanup_dataurisrc (src);
+  g_free (uri);
+  g_free (bytes);
+}
+
+GST_END_TEST;
+
 static Suite *
 dataurisrc_suite (void)
 {
@@ -530,6 +715,9 @@ dataurisrc_suite (void)
   tcase_add_test (tc_chain, test_dataurisrc_push);
   tcase_add_test (tc_chain, test_dataurisrc_uri_iface);
   tcase_add_test (tc_chain, test_dataurisrc_from_uri);
+  tcase_add_test (tc_chain, test_dataurisrc_base64_ranges);
+  tcase_add_test (tc_chain, test_dataurisrc_base64_fallback);
+  tcase_add_test (tc_chain, test_dataurisrc_base64_typefind_size);
 
   return s;
 }
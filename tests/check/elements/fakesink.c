@@ -1169,6 +1169,66 @@ GST_START_TEST (test_last_message_deep_notify)
 
 GST_END_TEST;
 
+GST_START_TEST (test_stats)
+{
+  GstElement *pipe, *src, *sink;
+  const GstStructure *s;
+  const GValue *histogram;
+  guint64 buffers = 0, bytes = 0, latency = 0;
+  gint n_stats = 0;
+  GstMessage *m;
+
+  pipe = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("fakesrc", NULL);
+  gst_util_set_object_arg (G_OBJECT (src), "data", "pool");
+  gst_util_set_object_arg (G_OBJECT (src), "sizetype", "fixed");
+  g_object_set (src, "num-buffers", 5, "buffer-list-size", 4, "sizemax", 100,
+      NULL);
+
+  /* only report on EOS */
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "stats-interval", G_MAXUINT, NULL);
+
+  gst_bin_add_many (GST_BIN (pipe), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  fail_unless_equals_int (gst_element_set_state (pipe, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  while ((m = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipe), -1,
+              GST_MESSAGE_EOS | GST_MESSAGE_ELEMENT))) {
+    if (GST_MESSAGE_TYPE (m) == GST_MESSAGE_EOS) {
+      gst_message_unref (m);
+      break;
+    }
+
+    s = gst_message_get_structure (m);
+    fail_unless (gst_structure_has_name (s, "GstFakeSinkStats"));
+    fail_unless (gst_structure_get_uint64 (s, "buffers", &buffers));
+    fail_unless (gst_structure_get_uint64 (s, "bytes", &bytes));
+
+    /* no latency without a TIME segment */
+    fail_unless (gst_structure_get_uint64 (s, "min-latency", &latency));
+    fail_unless_equals_uint64 (latency, GST_CLOCK_TIME_NONE);
+
+    histogram = gst_structure_get_value (s, "latency-histogram");
+    fail_unless (GST_VALUE_HOLDS_ARRAY (histogram));
+    fail_unless_equals_int (gst_value_array_get_size (histogram), 24);
+    n_stats++;
+    gst_message_unref (m);
+  }
+
+  fail_unless_equals_int (n_stats, 1);
+  fail_unless_equals_uint64 (buffers, 20);
+  fail_unless_equals_uint64 (bytes, 2000);
+
+  fail_unless_equals_int (gst_element_set_state (pipe, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipe);
+}
+
+GST_END_TEST;
+
 static Suite *
 fakesink_suite (void)
 {
@@ -1185,6 +1245,7 @@ fakesink_suite (void)
   tcase_add_test (tc_chain, test_position);
   tcase_add_test (tc_chain, test_notify_race);
   tcase_add_test (tc_chain, test_last_message_notify);
+  tcase_add_test (tc_chain, test_stats);
   tcase_skip_broken_test (tc_chain, test_last_message_deep_notify);
 
   return s;
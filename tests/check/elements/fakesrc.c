@@ -206,6 +206,55 @@ GST_START_TEST (test_sizetype_random)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pool_buffer_list)
+{
+  GstElement *src;
+  guint64 offset = 0;
+  GList *l;
+
+  src = setup_fakesrc ();
+
+  g_object_set (G_OBJECT (src), "data", 3, "filltype", 2, "sizetype", 3,
+      "sizemin", 16, "sizemax", 256, "buffer-list-size", 4,
+      "num-buffers", 25, NULL);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  while (!have_eos) {
+    g_usleep (1000);
+  }
+
+  /* each buffer list counts as one buffer */
+  fail_unless_equals_int (g_list_length (buffers), 100);
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *buf = l->data;
+    gsize size = gst_buffer_get_size (buf);
+    GstMapInfo map;
+    gsize i;
+
+    fail_if (size > 256);
+    fail_if (size < 16);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), offset);
+    offset += size;
+
+    fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+    for (i = 0; i < map.size; i++)
+      fail_unless_equals_int (map.data[i], 0);
+    gst_buffer_unmap (buf, &map);
+  }
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* cleanup */
+  cleanup_fakesrc (src);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_no_preroll)
 {
   GstElement *src;
@@ -326,6 +375,7 @@ fakesrc_suite (void)
   tcase_add_test (tc_chain, test_sizetype_empty);
   tcase_add_test (tc_chain, test_sizetype_fixed);
   tcase_add_test (tc_chain, test_sizetype_random);
+  tcase_add_test (tc_chain, test_pool_buffer_list);
   tcase_add_test (tc_chain, test_no_preroll);
   tcase_add_test (tc_chain, test_reuse_push);
 
@@ -118,6 +118,57 @@ GST_START_TEST (test_num_buffers)
 
 GST_END_TEST;
 
+GST_START_TEST (test_max_batch_size)
+{
+  GstElement *src;
+  gint pipe_fd[2];
+  gchar data[3 * 4096];
+  GList *l;
+  guint64 offset;
+
+#ifndef G_OS_WIN32
+  fail_if (pipe (pipe_fd) < 0);
+#else
+  fail_if (_pipe (pipe_fd, 2 * sizeof (data), _O_BINARY) < 0);
+#endif
+
+  /* the data is there before we start reading */
+  memset (data, 0, sizeof (data));
+  fail_if (write (pipe_fd[1], data, sizeof (data)) < 0);
+
+  src = setup_fdsrc ();
+  g_object_set (G_OBJECT (src), "num-buffers", 1, "blocksize", 4096,
+      "max-batch-size", 64 * 1024, "fd", pipe_fd[0], NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  while (!have_eos)
+    g_usleep (1000);
+
+  /* all the blocks are read after one wakeup and pushed in one list */
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  for (l = buffers, offset = 0; l; l = l->next) {
+    GstBuffer *buf = l->data;
+
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), offset);
+    fail_unless_equals_int (gst_buffer_get_size (buf), 4096);
+    offset += 4096;
+  }
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* cleanup */
+  cleanup_fdsrc (src);
+  close (pipe_fd[0]);
+  close (pipe_fd[1]);
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_nonseeking)
 {
   GstElement *src;
@@ -205,6 +256,7 @@ fdsrc_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_num_buffers);
+  tcase_add_test (tc_chain, test_max_batch_size);
   tcase_add_test (tc_chain, test_nonseeking);
   tcase_add_test (tc_chain, test_seeking);
 
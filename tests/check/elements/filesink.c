@@ -370,6 +370,101 @@ GST_START_TEST (test_flush)
 
 GST_END_TEST;
 
+GST_START_TEST (test_write_behind)
+{
+  GstElement *filesink;
+  gchar *tmp_fn;
+  GstSegment segment;
+
+  tmp_fn = create_temporary_file ();
+  if (tmp_fn == NULL)
+    return;
+  filesink = setup_filesink ();
+
+  GST_LOG ("using temp file '%s'", tmp_fn);
+  g_object_set (filesink, "location", tmp_fn, "write-behind", 16,
+      "sync-interval", GST_MSECOND, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_stream_start ("test")));
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* the position includes the bytes that are still queued */
+  PUSH_BYTES (8);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 8);
+  PUSH_BYTES (12);
+  PUSH_BUFFER_LIST (4, 10);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 60);
+
+  /* segments are only handled after all queued data was written */
+  segment.start = 8;
+  segment.time = 8;
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 8);
+  PUSH_BYTES (4);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 12);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  cleanup_filesink (filesink);
+
+  CHECK_WRITTEN_BYTES (0, 8, 60);
+  CHECK_WRITTEN_BYTES (8, 4, 60);
+
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_preallocate)
+{
+  GstElement *filesink;
+  gchar *tmp_fn;
+  GstSegment segment;
+
+  tmp_fn = create_temporary_file ();
+  if (tmp_fn == NULL)
+    return;
+  filesink = setup_filesink ();
+
+  GST_LOG ("using temp file '%s'", tmp_fn);
+  g_object_set (filesink, "location", tmp_fn, "preallocate",
+      (guint64) 64 * 1024, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_stream_start ("test")));
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  PUSH_BYTES (100);
+  PUSH_BUFFER_LIST (3, 50);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 250);
+
+  /* the preallocated space is removed again at EOS */
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  CHECK_WRITTEN_BYTES (0, 100, 250);
+  CHECK_WRITTEN_BYTES (100, 50, 250);
+
+  cleanup_filesink (filesink);
+
+  CHECK_WRITTEN_BYTES (200, 50, 250);
+
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_coverage)
 {
   GstElement *filesink;
@@ -485,6 +580,8 @@ filesink_suite (void)
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_flush);
+  tcase_add_test (tc_chain, test_write_behind);
+  tcase_add_test (tc_chain, test_preallocate);
 
   return s;
 }
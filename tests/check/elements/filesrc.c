@@ -22,6 +22,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <string.h>
+
+#include <glib/gstdio.h>
 
 #include <gst/check/gstcheck.h>
 
@@ -527,6 +530,181 @@ GST_START_TEST (test_uri_query)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pull_mmap)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstFlowReturn ret;
+  GstBuffer *buffer;
+  gchar *contents;
+  gsize length;
+  guint64 offset;
+
+  fail_unless (g_file_get_contents (TESTFILE, &contents, &length, NULL));
+  fail_unless (length > 2000);
+
+  src = setup_filesrc ();
+
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "use-mmap", TRUE, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to ready");
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (pad != NULL);
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* pull unaligned blocks over the complete file and compare */
+  for (offset = 0; offset < length; offset += 1000) {
+    buffer = NULL;
+    ret = gst_pad_get_range (pad, offset, 1000, &buffer);
+    fail_unless (ret == GST_FLOW_OK);
+    fail_unless_equals_int (gst_buffer_get_size (buffer),
+        MIN (1000, length - offset));
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffer), offset);
+    fail_unless (gst_buffer_memcmp (buffer, 0, contents + offset,
+            gst_buffer_get_size (buffer)) == 0);
+    gst_buffer_unref (buffer);
+  }
+
+  buffer = NULL;
+  ret = gst_pad_get_range (pad, length, 10, &buffer);
+  fail_unless (ret == GST_FLOW_EOS);
+
+  /* keep one buffer alive across the state change */
+  buffer = NULL;
+  ret = gst_pad_get_range (pad, 10, 100, &buffer);
+  fail_unless (ret == GST_FLOW_OK);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* the mapping must still be valid */
+  fail_unless (gst_buffer_memcmp (buffer, 0, contents + 10, 100) == 0);
+  gst_buffer_unref (buffer);
+
+  gst_object_unref (pad);
+  cleanup_filesrc (src);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+/* readahead only gives hints, the data must be unchanged */
+GST_START_TEST (test_pull_readahead)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstFlowReturn ret;
+  GstBuffer *buffer;
+  gchar *contents;
+  gsize length;
+  guint64 offset;
+  guint readahead;
+
+  fail_unless (g_file_get_contents (TESTFILE, &contents, &length, NULL));
+  fail_unless (length > 2000);
+
+  src = setup_filesrc ();
+
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "readahead", 4096, NULL);
+  g_object_get (G_OBJECT (src), "readahead", &readahead, NULL);
+  fail_unless_equals_int (readahead, 4096);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to ready");
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (pad != NULL);
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* sequential reads and a jump back to the start */
+  for (offset = 0; offset < length; offset += 300) {
+    buffer = NULL;
+    ret = gst_pad_get_range (pad, offset, 300, &buffer);
+    fail_unless (ret == GST_FLOW_OK);
+    fail_unless (gst_buffer_memcmp (buffer, 0, contents + offset,
+            gst_buffer_get_size (buffer)) == 0);
+    gst_buffer_unref (buffer);
+  }
+
+  buffer = NULL;
+  ret = gst_pad_get_range (pad, 0, 100, &buffer);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (gst_buffer_memcmp (buffer, 0, contents, 100) == 0);
+  gst_buffer_unref (buffer);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_object_unref (pad);
+  cleanup_filesrc (src);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+/* filesrc memories are sent from the file by fdsink */
+GST_START_TEST (test_mmap_fdsink)
+{
+  GstElement *pipeline, *src, *sink;
+  GstMessage *msg;
+  GstBus *bus;
+  gchar *contents, *written, *tmp_fn;
+  gsize length, written_length;
+  gint fd;
+
+  fail_unless (g_file_get_contents (TESTFILE, &contents, &length, NULL));
+
+  fd = g_file_open_tmp (NULL, &tmp_fn, NULL);
+  fail_unless (fd >= 0);
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("filesrc", NULL);
+  sink = gst_element_factory_make ("fdsink", NULL);
+  fail_unless (src != NULL && sink != NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  g_object_set (src, "location", TESTFILE, "use-mmap", TRUE, "blocksize",
+      1000, NULL);
+  g_object_set (sink, "fd", fd, NULL);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipeline);
+  close (fd);
+
+  fail_unless (g_file_get_contents (tmp_fn, &written, &written_length, NULL));
+  fail_unless_equals_int (written_length, length);
+  fail_unless (memcmp (written, contents, length) == 0);
+
+  g_unlink (tmp_fn);
+  g_free (tmp_fn);
+  g_free (written);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
 static Suite *
 filesrc_suite (void)
 {
@@ -537,6 +715,9 @@ filesrc_suite (void)
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_reverse);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_mmap);
+  tcase_add_test (tc_chain, test_pull_readahead);
+  tcase_add_test (tc_chain, test_mmap_fdsink);
   tcase_add_test (tc_chain, test_coverage);
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_uri_query);
@@ -407,6 +407,66 @@ GST_START_TEST (test_funnel_stress)
 
 GST_END_TEST;
 
+static void
+count_events (GstHarness * h, guint * stream_start, guint * caps)
+{
+  GstEvent *event;
+
+  *stream_start = *caps = 0;
+  while ((event = gst_harness_try_pull_event (h))) {
+    if (GST_EVENT_TYPE (event) == GST_EVENT_STREAM_START)
+      (*stream_start)++;
+    else if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS)
+      (*caps)++;
+    gst_event_unref (event);
+  }
+}
+
+GST_START_TEST (test_funnel_output_thread)
+{
+  GstElement *funnel = gst_element_factory_make ("funnel", NULL);
+  GstHarness *h0, *h1;
+  guint stream_start, caps;
+  guint i;
+
+  g_object_set (funnel, "output-thread", TRUE, "max-queued", 2,
+      "max-batch", 4, NULL);
+
+  h0 = gst_harness_new_with_element (funnel, "sink_0", "src");
+  h1 = gst_harness_new_with_element (funnel, "sink_1", NULL);
+  gst_object_unref (funnel);
+
+  gst_harness_set_src_caps_str (h0, "testcaps");
+  gst_harness_set_src_caps_str (h1, "testcaps");
+
+  /* more buffers than can be queued per pad */
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (gst_harness_push (h0, gst_buffer_new ()),
+        GST_FLOW_OK);
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (gst_harness_push (h1, gst_buffer_new ()),
+        GST_FLOW_OK);
+  for (i = 0; i < 20; i++)
+    gst_buffer_unref (gst_harness_pull (h0));
+
+  /* the streams differ but they have the same caps, which are only sent
+   * once */
+  count_events (h0, &stream_start, &caps);
+  fail_unless_equals_int (stream_start, 2);
+  fail_unless_equals_int (caps, 1);
+
+  fail_unless_equals_int (gst_harness_push (h0, gst_buffer_new ()),
+      GST_FLOW_OK);
+  gst_buffer_unref (gst_harness_pull (h0));
+  count_events (h0, &stream_start, &caps);
+  fail_unless_equals_int (stream_start, 1);
+  fail_unless_equals_int (caps, 0);
+
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h0);
+}
+
+GST_END_TEST;
 
 static Suite *
 funnel_suite (void)
@@ -419,6 +479,7 @@ funnel_suite (void)
   tcase_add_test (tc_chain, test_funnel_eos);
   tcase_add_test (tc_chain, test_funnel_gap_event);
   tcase_add_test (tc_chain, test_funnel_stress);
+  tcase_add_test (tc_chain, test_funnel_output_thread);
   suite_add_tcase (s, tc_chain);
 
   return s;
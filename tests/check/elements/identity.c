@@ -180,6 +180,73 @@ GST_START_TEST (test_stopping_element_unschedules_sync)
 
 GST_END_TEST;
 
+static void
+check_stats (const GstStructure * s, guint64 buffers, guint64 bytes,
+    guint64 gaps, guint64 discont, gdouble rate)
+{
+  guint64 val;
+  gdouble d;
+
+  fail_unless (gst_structure_get_uint64 (s, "num-buffers", &val));
+  fail_unless_equals_uint64 (val, buffers);
+  fail_unless (gst_structure_get_uint64 (s, "num-bytes", &val));
+  fail_unless_equals_uint64 (val, bytes);
+  fail_unless (gst_structure_get_uint64 (s, "num-gaps", &val));
+  fail_unless_equals_uint64 (val, gaps);
+  fail_unless (gst_structure_get_uint64 (s, "num-discont", &val));
+  fail_unless_equals_uint64 (val, discont);
+  fail_unless (gst_structure_get_double (s, "data-rate", &d));
+  fail_unless_equals_float (d, rate);
+}
+
+GST_START_TEST (test_stats)
+{
+  GstHarness *h = gst_harness_new ("identity");
+  GstStructure *s;
+  GstQuery *query;
+  GstBuffer *buf;
+  guint i;
+
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  g_object_get (h->element, "stats", &s, NULL);
+  check_stats (s, 0, 0, 0, 0, 0.0);
+  gst_structure_free (s);
+
+  /* 100 bytes per second for 3 seconds */
+  for (i = 0; i < 3; i++) {
+    buf = gst_buffer_new_and_alloc (100);
+    GST_BUFFER_PTS (buf) = i * GST_SECOND;
+    GST_BUFFER_DURATION (buf) = GST_SECOND;
+    if (i == 0)
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, buf));
+  }
+  fail_unless (gst_harness_push_event (h,
+          gst_event_new_gap (3 * GST_SECOND, GST_SECOND)));
+
+  g_object_get (h->element, "stats", &s, NULL);
+  check_stats (s, 3, 300, 1, 1, 100.0);
+  gst_structure_free (s);
+
+  /* the same counters are answered to the custom query from both sides */
+  query = gst_query_new_custom (GST_QUERY_CUSTOM,
+      gst_structure_new_empty ("GstIdentityStats"));
+  fail_unless (gst_pad_peer_query (h->srcpad, query));
+  check_stats (gst_query_get_structure (query), 3, 300, 1, 1, 100.0);
+  gst_query_unref (query);
+
+  query = gst_query_new_custom (GST_QUERY_CUSTOM,
+      gst_structure_new_empty ("GstIdentityStats"));
+  fail_unless (gst_pad_peer_query (h->sinkpad, query));
+  check_stats (gst_query_get_structure (query), 3, 300, 1, 1, 100.0);
+  gst_query_unref (query);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 identity_suite (void)
 {
@@ -191,6 +258,7 @@ identity_suite (void)
   tcase_add_test (tc_chain, test_signal_handoffs);
   tcase_add_test (tc_chain, test_sync_on_timestamp);
   tcase_add_test (tc_chain, test_stopping_element_unschedules_sync);
+  tcase_add_test (tc_chain, test_stats);
 
 
   return s;
@@ -1594,6 +1594,214 @@ GST_START_TEST (test_initial_events_nodelay)
 
 GST_END_TEST;
 
+#define N_CONCURRENT_BUFFERS 500
+
+static gpointer
+push_stream_thread (gpointer data)
+{
+  struct PadData *pad_data = data;
+  GstMapInfo info;
+  GstBuffer *buf;
+  GstFlowReturn ret;
+  gint i;
+
+  for (i = 0; i < N_CONCURRENT_BUFFERS; i++) {
+    buf = gst_buffer_new_and_alloc (4);
+    gst_buffer_map (buf, &info, GST_MAP_WRITE);
+    GST_WRITE_UINT32_BE (info.data, i + 1);
+    gst_buffer_unmap (buf, &info);
+    GST_BUFFER_PTS (buf) = i * 10 * GST_MSECOND;
+    GST_BUFFER_DURATION (buf) = 10 * GST_MSECOND;
+
+    ret = gst_pad_push (pad_data->input_pad, buf);
+    if (ret != GST_FLOW_OK)
+      return GINT_TO_POINTER (FALSE);
+  }
+  gst_pad_push_event (pad_data->input_pad, gst_event_new_eos ());
+
+  return GINT_TO_POINTER (TRUE);
+}
+
+static void
+run_concurrent_streams_test (gboolean use_buffering)
+{
+  GstElement *pipe;
+  GstElement *mq;
+  struct PadData pad_data[2];
+  GThread *threads[2];
+  guint32 eos_seen = 0;
+  GMutex mutex;
+  GCond cond;
+  gint i;
+
+  g_mutex_init (&mutex);
+  g_cond_init (&cond);
+
+  pipe = gst_bin_new ("testbin");
+  mq = gst_element_factory_make ("multiqueue", NULL);
+  fail_unless (mq != NULL);
+  gst_bin_add (GST_BIN (pipe), mq);
+
+  /* a small time limit so that the level checks run all the time */
+  g_object_set (mq, "max-size-bytes", (guint) 0, "max-size-buffers", (guint) 0,
+      "max-size-time", (guint64) 50 * GST_MSECOND, "use-buffering",
+      use_buffering, NULL);
+
+  construct_n_pads (mq, pad_data, 2, 2);
+  for (i = 0; i < 2; i++) {
+    pad_data[i].eos_count_ptr = &eos_seen;
+    pad_data[i].cond = &cond;
+    pad_data[i].mutex = &mutex;
+  }
+
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+
+  /* both streams push at the same time, each from its own thread */
+  for (i = 0; i < 2; i++)
+    threads[i] = g_thread_new ("push", push_stream_thread, &pad_data[i]);
+  for (i = 0; i < 2; i++)
+    fail_unless (g_thread_join (threads[i]));
+
+  g_mutex_lock (&mutex);
+  while (eos_seen < 2)
+    g_cond_wait (&cond, &mutex);
+  g_mutex_unlock (&mutex);
+
+  for (i = 0; i < 2; i++) {
+    GstPad *mq_input = gst_pad_get_peer (pad_data[i].input_pad);
+
+    gst_pad_unlink (pad_data[i].input_pad, mq_input);
+    gst_element_release_request_pad (mq, mq_input);
+    gst_object_unref (mq_input);
+    gst_object_unref (pad_data[i].input_pad);
+    gst_object_unref (pad_data[i].out_pad);
+  }
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (pipe);
+
+  g_cond_clear (&cond);
+  g_mutex_clear (&mutex);
+}
+
+GST_START_TEST (test_concurrent_streams)
+{
+  run_concurrent_streams_test (FALSE);
+  run_concurrent_streams_test (TRUE);
+}
+
+GST_END_TEST;
+
+static GstBusSyncReply
+make_tasks_cooperative (GstBus * bus, GstMessage * message, gpointer user_data)
+{
+  GstStreamStatusType type;
+  const GValue *val;
+
+  if (GST_MESSAGE_TYPE (message) != GST_MESSAGE_STREAM_STATUS)
+    return GST_BUS_PASS;
+
+  gst_message_parse_stream_status (message, &type, NULL);
+  val = gst_message_get_stream_status_object (message);
+  if (type == GST_STREAM_STATUS_TYPE_CREATE && G_VALUE_HOLDS_OBJECT (val)
+      && GST_IS_TASK (g_value_get_object (val)))
+    gst_task_set_cooperative (g_value_get_object (val), TRUE);
+
+  return GST_BUS_PASS;
+}
+
+static void
+multiqueue_underrun_cb (GstElement * mq, struct PadData *pad_data)
+{
+  g_mutex_lock (pad_data->mutex);
+  pad_data->event_count++;
+  g_cond_broadcast (pad_data->cond);
+  g_mutex_unlock (pad_data->mutex);
+}
+
+/* make the tasks of the multiqueue cooperative and check that they get
+ * suspended while the queues are empty and still push all the buffers that
+ * arrive afterwards */
+GST_START_TEST (test_cooperative_tasks)
+{
+  GstElement *pipe;
+  GstElement *mq;
+  GstBus *bus;
+  struct PadData pad_data[2];
+  GThread *threads[2];
+  guint32 eos_seen = 0;
+  GMutex mutex;
+  GCond cond;
+  gint i;
+
+  g_mutex_init (&mutex);
+  g_cond_init (&cond);
+
+  pipe = gst_pipeline_new ("testbin");
+  bus = gst_element_get_bus (pipe);
+  gst_bus_set_sync_handler (bus, make_tasks_cooperative, NULL, NULL);
+  gst_object_unref (bus);
+
+  mq = gst_element_factory_make ("multiqueue", NULL);
+  fail_unless (mq != NULL);
+  gst_bin_add (GST_BIN (pipe), mq);
+
+  construct_n_pads (mq, pad_data, 2, 2);
+  for (i = 0; i < 2; i++) {
+    pad_data[i].eos_count_ptr = &eos_seen;
+    pad_data[i].cond = &cond;
+    pad_data[i].mutex = &mutex;
+  }
+  /* count the underruns in the first pad data */
+  pad_data[0].event_count = 0;
+  g_signal_connect (mq, "underrun", G_CALLBACK (multiqueue_underrun_cb),
+      &pad_data[0]);
+
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+
+  for (i = 0; i < 2; i++) {
+    GstPad *mq_srcpad = gst_pad_get_peer (pad_data[i].out_pad);
+
+    fail_unless (gst_task_get_cooperative (GST_PAD_TASK (mq_srcpad)));
+    gst_object_unref (mq_srcpad);
+  }
+
+  /* the empty queues suspend their tasks */
+  g_mutex_lock (&mutex);
+  while (pad_data[0].event_count < 1)
+    g_cond_wait (&cond, &mutex);
+  g_mutex_unlock (&mutex);
+
+  /* and pushing wakes them up again */
+  for (i = 0; i < 2; i++)
+    threads[i] = g_thread_new ("push", push_stream_thread, &pad_data[i]);
+  for (i = 0; i < 2; i++)
+    fail_unless (g_thread_join (threads[i]));
+
+  g_mutex_lock (&mutex);
+  while (eos_seen < 2)
+    g_cond_wait (&cond, &mutex);
+  g_mutex_unlock (&mutex);
+
+  for (i = 0; i < 2; i++) {
+    GstPad *mq_input = gst_pad_get_peer (pad_data[i].input_pad);
+
+    gst_pad_unlink (pad_data[i].input_pad, mq_input);
+    gst_element_release_request_pad (mq, mq_input);
+    gst_object_unref (mq_input);
+    gst_object_unref (pad_data[i].input_pad);
+    gst_object_unref (pad_data[i].out_pad);
+  }
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (pipe);
+
+  g_cond_clear (&cond);
+  g_mutex_clear (&mutex);
+}
+
+GST_END_TEST;
+
 static Suite *
 multiqueue_suite (void)
 {
@@ -1623,6 +1831,8 @@ multiqueue_suite (void)
 
   tcase_add_test (tc_chain, test_buffering_with_none_pts);
   tcase_add_test (tc_chain, test_initial_events_nodelay);
+  tcase_add_test (tc_chain, test_concurrent_streams);
+  tcase_add_test (tc_chain, test_cooperative_tasks);
 
   return s;
 }
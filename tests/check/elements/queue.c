@@ -210,6 +210,59 @@ GST_START_TEST (test_non_leaky_underrun)
 
 GST_END_TEST;
 
+static void
+queue_underrun_make_cooperative (GstElement * queue, gpointer user_data)
+{
+  GstPad *srcpad = gst_element_get_static_pad (queue, "src");
+
+  /* called from the streaming thread of the queue before it waits */
+  gst_task_set_cooperative (GST_PAD_TASK (srcpad), TRUE);
+  gst_object_unref (srcpad);
+}
+
+/* make the task of the queue cooperative and check that it gives back its
+ * thread while the queue is empty and still pushes the buffers that arrive */
+GST_START_TEST (test_cooperative_task)
+{
+  GstBuffer *buffer;
+  GstSegment segment;
+
+  g_signal_connect (queue, "underrun",
+      G_CALLBACK (queue_underrun_make_cooperative), NULL);
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  buffer = gst_buffer_new_and_alloc (4);
+  fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < 1)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  /* the woken up task underruns again and suspends */
+  UNDERRUN_LOCK ();
+  while (underrun_count < 2)
+    UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
 static void
 queue_overrun_link_and_activate (GstElement * queue, gpointer user_data)
 {
@@ -1099,6 +1152,194 @@ GST_START_TEST (test_time_level_buffer_list)
 
 GST_END_TEST;
 
+static GstPadProbeReturn
+count_buffer_lists (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstBufferList *buffer_list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+  gint *n_lists = user_data;
+
+  GST_DEBUG ("got list of %u buffers", gst_buffer_list_length (buffer_list));
+  g_atomic_int_inc (n_lists);
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_batch_buffers)
+{
+  GstSegment segment;
+  GstPad *srcpad;
+  gint n_lists = 0;
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "max-batch-buffers", 3, NULL);
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  srcpad = gst_element_get_static_pad (queue, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      count_buffer_lists, &n_lists, NULL);
+  gst_object_unref (srcpad);
+
+  block_src ();
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  /* the queue thread is blocked on the first event, all buffers are queued */
+  for (i = 0; i < 5; i++)
+    fail_unless (gst_pad_push (mysrcpad,
+            gst_buffer_new_and_alloc (4)) == GST_FLOW_OK);
+
+  unblock_src ();
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < 5)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  /* 3 buffers in the first list and the 2 remaining ones in the second */
+  fail_unless_equals_int (g_atomic_int_get (&n_lists), 2);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_drain_buffers)
+{
+  GstSegment segment;
+  GstPad *srcpad;
+  gint n_lists = 0;
+  GList *l;
+  gint i;
+
+  g_object_set (G_OBJECT (queue), "max-drain-buffers", 3, NULL);
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  srcpad = gst_element_get_static_pad (queue, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      count_buffer_lists, &n_lists, NULL);
+  gst_object_unref (srcpad);
+
+  block_src ();
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < 5; i++) {
+    GstBuffer *buffer = gst_buffer_new_and_alloc (4);
+
+    GST_BUFFER_OFFSET (buffer) = i;
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  unblock_src ();
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < 5)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  /* drained buffers are pushed on their own and in order */
+  fail_unless_equals_int (g_atomic_int_get (&n_lists), 0);
+  for (l = buffers, i = 0; l; l = l->next, i++)
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (l->data), i);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_spin_time)
+{
+  guint64 spin_blocks;
+
+  /* long enough to never block before the event arrives */
+  g_object_set (G_OBJECT (queue), "spin-time", 5 * GST_SECOND, NULL);
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_event_function (mysinkpad, event_func);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+
+  g_mutex_lock (&events_lock);
+  while (events_count < 1)
+    g_cond_wait (&events_cond, &events_lock);
+  g_mutex_unlock (&events_lock);
+
+  g_object_get (G_OBJECT (queue), "spin-blocks", &spin_blocks, NULL);
+  fail_unless_equals_uint64 (spin_blocks, 0);
+
+  /* stopping interrupts the spinning */
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thread_scheduling)
+{
+  GstPad *srcpad;
+  GstTask *task;
+  gint priority;
+
+  g_object_set (G_OBJECT (queue), "thread-scheduling",
+      GST_TASK_SCHEDULING_FIFO, "thread-priority", 10, NULL);
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  srcpad = gst_element_get_static_pad (queue, "src");
+  GST_OBJECT_LOCK (srcpad);
+  task = gst_object_ref (GST_PAD_TASK (srcpad));
+  GST_OBJECT_UNLOCK (srcpad);
+
+  fail_unless_equals_int (gst_task_get_scheduling (task, &priority),
+      GST_TASK_SCHEDULING_FIFO);
+  fail_unless_equals_int (priority, 10);
+
+  /* the running task is reconfigured */
+  g_object_set (G_OBJECT (queue), "thread-scheduling",
+      GST_TASK_SCHEDULING_DEFAULT, NULL);
+  fail_unless_equals_int (gst_task_get_scheduling (task, NULL),
+      GST_TASK_SCHEDULING_DEFAULT);
+
+  gst_object_unref (task);
+  gst_object_unref (srcpad);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_initial_events_nodelay)
 {
   GstSegment segment;
@@ -1156,6 +1397,7 @@ queue_suite (void)
   tcase_add_checked_fixture (tc_chain, setup, cleanup);
   tcase_add_test (tc_chain, test_non_leaky_underrun);
   tcase_add_test (tc_chain, test_non_leaky_overrun);
+  tcase_add_test (tc_chain, test_cooperative_task);
   tcase_add_test (tc_chain, test_leaky_upstream);
   tcase_add_test (tc_chain, test_leaky_downstream);
   tcase_add_test (tc_chain, test_time_level);
@@ -1168,6 +1410,10 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_sticky_not_linked);
   tcase_add_test (tc_chain, test_time_level_buffer_list);
   tcase_add_test (tc_chain, test_initial_events_nodelay);
+  tcase_add_test (tc_chain, test_batch_buffers);
+  tcase_add_test (tc_chain, test_drain_buffers);
+  tcase_add_test (tc_chain, test_spin_time);
+  tcase_add_test (tc_chain, test_thread_scheduling);
 
   return s;
 }
@@ -438,6 +438,82 @@ GST_START_TEST (test_filled_read)
 
 GST_END_TEST;
 
+static GstBuffer *
+make_pattern_buffer (guint offset, guint size)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint i;
+
+  buffer = gst_buffer_new_and_alloc (size);
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+  for (i = 0; i < size; i++)
+    map.data[i] = (offset + i) % 251;
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static void
+check_pattern_range (GstPad * srcpad, guint offset, guint size)
+{
+  GstBuffer *buffer = NULL;
+  GstMapInfo map;
+  guint i;
+
+  fail_unless_equals_int (gst_pad_get_range (srcpad, offset, size, &buffer),
+      GST_FLOW_OK);
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, size);
+  for (i = 0; i < size; i++)
+    fail_unless_equals_int (map.data[i], (offset + i) % 251);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+}
+
+/* a temp file used as a ring buffer, data wrapping around its end */
+GST_START_TEST (test_temp_file_ring_buffer)
+{
+  GstElement *queue2;
+  GstPad *sinkpad, *srcpad;
+  GstSegment segment;
+  gchar *template;
+
+  queue2 = gst_element_factory_make ("queue2", NULL);
+  sinkpad = gst_element_get_static_pad (queue2, "sink");
+  srcpad = gst_element_get_static_pad (queue2, "src");
+
+  template = g_build_filename (g_get_tmp_dir (), "queue2-test-XXXXXX", NULL);
+  g_object_set (queue2, "ring-buffer-max-size", (guint64) 8 * 1024,
+      "temp-template", template, "use-buffering", FALSE,
+      "max-size-buffers", (guint) 0, "max-size-time", (guint64) 0,
+      "max-size-bytes", (guint) 8 * 1024, NULL);
+  g_free (template);
+
+  fail_unless (gst_pad_activate_mode (srcpad, GST_PAD_MODE_PULL, TRUE));
+  gst_element_set_state (queue2, GST_STATE_PLAYING);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_send_event (sinkpad, gst_event_new_stream_start ("test"));
+  gst_pad_send_event (sinkpad, gst_event_new_segment (&segment));
+
+  fail_unless_equals_int (gst_pad_chain (sinkpad, make_pattern_buffer (0,
+              6 * 1024)), GST_FLOW_OK);
+  check_pattern_range (srcpad, 0, 4 * 1024);
+
+  /* this wraps around the end of the file */
+  fail_unless_equals_int (gst_pad_chain (sinkpad,
+          make_pattern_buffer (6 * 1024, 4 * 1024)), GST_FLOW_OK);
+  check_pattern_range (srcpad, 4 * 1024, 6 * 1024);
+
+  gst_element_set_state (queue2, GST_STATE_NULL);
+
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (queue2);
+}
+
+GST_END_TEST;
 
 static GstPadProbeReturn
 block_callback (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
@@ -541,6 +617,302 @@ GST_START_TEST (test_small_ring_buffer)
 
 GST_END_TEST;
 
+/* an upstream pad that records the seeks queue2 sends in download mode */
+static GMutex seeks_lock;
+static GArray *seeks;
+
+static gboolean
+upstream_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK) {
+    gint64 start;
+
+    gst_event_parse_seek (event, NULL, NULL, NULL, NULL, &start, NULL, NULL);
+    g_mutex_lock (&seeks_lock);
+    g_array_append_val (seeks, start);
+    g_mutex_unlock (&seeks_lock);
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static guint
+n_seeks (void)
+{
+  guint n;
+
+  g_mutex_lock (&seeks_lock);
+  n = seeks->len;
+  g_mutex_unlock (&seeks_lock);
+
+  return n;
+}
+
+static void
+fail_unless_seek (guint i, gint64 offset)
+{
+  g_mutex_lock (&seeks_lock);
+  fail_unless (i < seeks->len);
+  fail_unless_equals_int64 (g_array_index (seeks, gint64, i), offset);
+  g_mutex_unlock (&seeks_lock);
+}
+
+/* queue2 with a temp file and no ring buffer, with 64KB at offset 0 */
+static GstElement *
+setup_download_queue2 (GstPad ** upstream)
+{
+  GstElement *queue2;
+  GstPad *sinkpad, *srcpad;
+  GstSegment segment;
+  gchar *template;
+
+  seeks = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+  queue2 = gst_element_factory_make ("queue2", NULL);
+  fail_unless (queue2 != NULL);
+  template = g_build_filename (g_get_tmp_dir (), "queue2-test-XXXXXX", NULL);
+  g_object_set (queue2, "temp-template", template, "use-buffering", TRUE,
+      "use-rate-estimate", FALSE, "max-size-buffers", (guint) 0,
+      "max-size-time", (guint64) 0, "max-size-bytes", (guint) 4 * 1024 * 1024,
+      NULL);
+  g_free (template);
+
+  *upstream = gst_pad_new ("src", GST_PAD_SRC);
+  gst_pad_set_event_function (*upstream, upstream_event);
+  sinkpad = gst_element_get_static_pad (queue2, "sink");
+  fail_unless_equals_int (gst_pad_link (*upstream, sinkpad), GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+  gst_pad_set_active (*upstream, TRUE);
+
+  srcpad = gst_element_get_static_pad (queue2, "src");
+  fail_unless (gst_pad_activate_mode (srcpad, GST_PAD_MODE_PULL, TRUE));
+  gst_object_unref (srcpad);
+  gst_element_set_state (queue2, GST_STATE_PLAYING);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (*upstream,
+          gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (*upstream,
+          gst_event_new_segment (&segment)));
+  fail_unless_equals_int (gst_pad_push (*upstream, make_pattern_buffer (0,
+              64 * 1024)), GST_FLOW_OK);
+
+  return queue2;
+}
+
+static void
+cleanup_download_queue2 (GstElement * queue2, GstPad * upstream)
+{
+  gst_element_set_state (queue2, GST_STATE_NULL);
+  gst_pad_set_active (upstream, FALSE);
+  gst_object_unref (upstream);
+  gst_object_unref (queue2);
+  g_array_free (seeks, TRUE);
+  seeks = NULL;
+}
+
+/* do what a source does for a flushing seek to @offset and push @size bytes
+ * from there */
+static void
+upstream_seek_done (GstPad * upstream, guint offset, guint size)
+{
+  GstSegment segment;
+  guint done;
+
+  fail_unless (gst_pad_push_event (upstream, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push_event (upstream,
+          gst_event_new_flush_stop (TRUE)));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  segment.start = segment.time = segment.position = offset;
+  fail_unless (gst_pad_push_event (upstream,
+          gst_event_new_segment (&segment)));
+
+  for (done = 0; done < size; done += 64 * 1024)
+    fail_unless_equals_int (gst_pad_push (upstream,
+            make_pattern_buffer (offset + done, 64 * 1024)), GST_FLOW_OK);
+}
+
+typedef struct
+{
+  GstPad *srcpad;
+  guint offset;
+  guint size;
+  GstBuffer *buffer;
+  GstFlowReturn ret;
+} PullRange;
+
+static gpointer
+pull_range_thread (PullRange * pull)
+{
+  pull->ret = gst_pad_get_range (pull->srcpad, pull->offset, pull->size,
+      &pull->buffer);
+
+  return NULL;
+}
+
+/* pull a range that is not downloaded yet, queue2 seeks to @offset and the
+ * data is provided once the reader waits in the new range. */
+static void
+check_pattern_range_after_seek (GstElement * queue2, GstPad * upstream,
+    guint offset, guint size)
+{
+  PullRange pull = { NULL, offset, size, NULL, GST_FLOW_ERROR };
+  GstMapInfo map;
+  GThread *thread;
+  guint i, level;
+
+  pull.srcpad = gst_element_get_static_pad (queue2, "src");
+  thread = g_thread_try_new ("gst-check", (GThreadFunc) pull_range_thread,
+      &pull, NULL);
+  fail_unless (thread != NULL);
+
+  /* the level is that of the new, empty range once the reader waits in it */
+  do {
+    g_usleep (1000);
+    g_object_get (queue2, "current-level-bytes", &level, NULL);
+  } while (level > 0);
+
+  upstream_seek_done (upstream, offset, 64 * 1024);
+  g_thread_join (thread);
+
+  fail_unless_equals_int (pull.ret, GST_FLOW_OK);
+  fail_unless (gst_buffer_map (pull.buffer, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, size);
+  for (i = 0; i < size; i++)
+    fail_unless_equals_int (map.data[i], (offset + i) % 251);
+  gst_buffer_unmap (pull.buffer, &map);
+  gst_buffer_unref (pull.buffer);
+  gst_object_unref (pull.srcpad);
+}
+
+/* a reader that stays in the downloaded range never makes queue2 seek */
+GST_START_TEST (test_download_sequential_reads)
+{
+  GstElement *queue2;
+  GstPad *upstream, *srcpad;
+  PullRange pull = { NULL, 64 * 1024, 4 * 1024, NULL, GST_FLOW_ERROR };
+  GThread *thread;
+  guint offset;
+
+  queue2 = setup_download_queue2 (&upstream);
+  srcpad = gst_element_get_static_pad (queue2, "src");
+
+  for (offset = 0; offset < 64 * 1024; offset += 4 * 1024)
+    check_pattern_range (srcpad, offset, 4 * 1024);
+
+  /* reading just after the downloaded data waits for it */
+  pull.srcpad = srcpad;
+  thread = g_thread_try_new ("gst-check", (GThreadFunc) pull_range_thread,
+      &pull, NULL);
+  fail_unless (thread != NULL);
+  fail_unless_equals_int (gst_pad_push (upstream,
+          make_pattern_buffer (64 * 1024, 64 * 1024)), GST_FLOW_OK);
+  g_thread_join (thread);
+  fail_unless_equals_int (pull.ret, GST_FLOW_OK);
+  gst_buffer_unref (pull.buffer);
+
+  /* a long download ahead of the reader is not a reason to prefetch */
+  for (offset = 128 * 1024; offset < 1024 * 1024; offset += 64 * 1024)
+    fail_unless_equals_int (gst_pad_push (upstream,
+            make_pattern_buffer (offset, 64 * 1024)), GST_FLOW_OK);
+  for (offset = 68 * 1024; offset < 1024 * 1024; offset += 60 * 1024)
+    check_pattern_range (srcpad, offset, 4 * 1024);
+
+  fail_unless_equals_int (n_seeks (), 0);
+
+  gst_object_unref (srcpad);
+  cleanup_download_queue2 (queue2, upstream);
+}
+
+GST_END_TEST;
+
+/* a reader that jumps around makes queue2 seek to where it reads, but the
+ * ranges are not prefetched since it doesn't go back and forth */
+GST_START_TEST (test_download_random_reads)
+{
+  GstElement *queue2;
+  GstPad *upstream, *srcpad;
+  guint offset;
+
+  queue2 = setup_download_queue2 (&upstream);
+  srcpad = gst_element_get_static_pad (queue2, "src");
+
+  check_pattern_range (srcpad, 0, 4 * 1024);
+  check_pattern_range_after_seek (queue2, upstream, 1024 * 1024, 4 * 1024);
+  fail_unless_equals_int (n_seeks (), 1);
+  fail_unless_seek (0, 1024 * 1024);
+  check_pattern_range_after_seek (queue2, upstream, 2048 * 1024, 4 * 1024);
+  fail_unless_equals_int (n_seeks (), 2);
+  fail_unless_seek (1, 2048 * 1024);
+
+  /* going back to ranges with data resumes downloading them */
+  check_pattern_range (srcpad, 4 * 1024, 4 * 1024);
+  fail_unless_equals_int (n_seeks (), 3);
+  fail_unless_seek (2, 64 * 1024);
+  upstream_seek_done (upstream, 64 * 1024, 0);
+
+  check_pattern_range (srcpad, 1028 * 1024, 4 * 1024);
+  fail_unless_equals_int (n_seeks (), 4);
+  fail_unless_seek (3, 1088 * 1024);
+  upstream_seek_done (upstream, 1088 * 1024, 0);
+
+  for (offset = 1088 * 1024; offset < 1664 * 1024; offset += 64 * 1024)
+    fail_unless_equals_int (gst_pad_push (upstream,
+            make_pattern_buffer (offset, 64 * 1024)), GST_FLOW_OK);
+  fail_unless_equals_int (n_seeks (), 4);
+
+  gst_object_unref (srcpad);
+  cleanup_download_queue2 (queue2, upstream);
+}
+
+GST_END_TEST;
+
+/* a reader that goes back and forth between two ranges gets the range it
+ * returns to downloaded once the current one has enough data */
+GST_START_TEST (test_download_pingpong_prefetch)
+{
+  GstElement *queue2;
+  GstPad *upstream, *srcpad;
+  guint offset;
+
+  queue2 = setup_download_queue2 (&upstream);
+  srcpad = gst_element_get_static_pad (queue2, "src");
+
+  check_pattern_range (srcpad, 0, 4 * 1024);
+  check_pattern_range_after_seek (queue2, upstream, 1024 * 1024, 4 * 1024);
+  check_pattern_range (srcpad, 4 * 1024, 4 * 1024);
+  fail_unless_seek (1, 64 * 1024);
+  upstream_seek_done (upstream, 64 * 1024, 0);
+  check_pattern_range (srcpad, 1028 * 1024, 4 * 1024);
+  fail_unless_seek (2, 1088 * 1024);
+  upstream_seek_done (upstream, 1088 * 1024, 0);
+  fail_unless_equals_int (n_seeks (), 3);
+
+  /* the reader is at 1032KB, the download switches to the first range when
+   * it is 512KB ahead of it */
+  for (offset = 1088 * 1024; offset < 1536 * 1024; offset += 64 * 1024)
+    fail_unless_equals_int (gst_pad_push (upstream,
+            make_pattern_buffer (offset, 64 * 1024)), GST_FLOW_OK);
+  fail_unless_equals_int (n_seeks (), 3);
+  fail_unless_equals_int (gst_pad_push (upstream,
+          make_pattern_buffer (1536 * 1024, 64 * 1024)), GST_FLOW_OK);
+  fail_unless_equals_int (n_seeks (), 4);
+  fail_unless_seek (3, 64 * 1024);
+  upstream_seek_done (upstream, 64 * 1024, 576 * 1024);
+
+  /* both ranges have data now, switching doesn't seek */
+  check_pattern_range (srcpad, 8 * 1024, 4 * 1024);
+  check_pattern_range (srcpad, 1032 * 1024, 4 * 1024);
+  check_pattern_range (srcpad, 12 * 1024, 4 * 1024);
+  fail_unless_equals_int (n_seeks (), 4);
+
+  gst_object_unref (srcpad);
+  cleanup_download_queue2 (queue2, upstream);
+}
+
+GST_END_TEST;
+
 static Suite *
 queue2_suite (void)
 {
@@ -555,8 +927,12 @@ queue2_suite (void)
   tcase_add_test (tc_chain, test_simple_shutdown_while_running_ringbuffer);
   tcase_add_test (tc_chain, test_watermark_and_fill_level);
   tcase_add_test (tc_chain, test_filled_read);
+  tcase_add_test (tc_chain, test_temp_file_ring_buffer);
   tcase_add_test (tc_chain, test_percent_overflow);
   tcase_add_test (tc_chain, test_small_ring_buffer);
+  tcase_add_test (tc_chain, test_download_sequential_reads);
+  tcase_add_test (tc_chain, test_download_random_reads);
+  tcase_add_test (tc_chain, test_download_pingpong_prefetch);
 
   return s;
 }
@@ -20,6 +20,7 @@
  */
 
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
 
 #define NUM_SELECTOR_PADS 4
 #define NUM_INPUT_BUFFERS 4     // buffers to send per each selector pad
@@ -823,6 +824,72 @@ GST_START_TEST (test_output_selector_getcaps_active)
 GST_END_TEST;
 
 
+static GstBuffer *
+new_timestamped_buffer (GstClockTime pts, gboolean keyframe)
+{
+  GstBuffer *buf = gst_buffer_new ();
+
+  GST_BUFFER_PTS (buf) = pts;
+  GST_BUFFER_DURATION (buf) = GST_SECOND;
+  if (!keyframe)
+    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+
+  return buf;
+}
+
+GST_START_TEST (test_input_selector_keyframe_preroll)
+{
+  GstElement *sel = gst_element_factory_make ("input-selector", NULL);
+  GstHarness *h0, *h1;
+  GstPad *sinkpad1;
+  GstBuffer *buf;
+  guint i;
+
+  g_object_set (sel, "keyframe-preroll", 4, NULL);
+
+  h0 = gst_harness_new_with_element (sel, "sink_0", "src");
+  h1 = gst_harness_new_with_element (sel, "sink_1", NULL);
+  gst_harness_set_src_caps_str (h0, "testcaps");
+  gst_harness_set_src_caps_str (h1, "testcaps");
+
+  fail_unless_equals_int (gst_harness_push (h0,
+          new_timestamped_buffer (0, TRUE)), GST_FLOW_OK);
+  gst_buffer_unref (gst_harness_pull (h0));
+
+  /* the inactive pad doesn't wait for the active one, it drops everything
+   * before its first keyframe and keeps the buffers after it */
+  fail_unless_equals_int (gst_harness_push (h1,
+          new_timestamped_buffer (0, FALSE)), GST_FLOW_OK);
+  for (i = 1; i < 4; i++)
+    fail_unless_equals_int (gst_harness_push (h1,
+            new_timestamped_buffer (i * GST_SECOND, i == 1)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h0), 0);
+
+  sinkpad1 = gst_pad_get_peer (h1->srcpad);
+  g_object_set (sel, "active-pad", sinkpad1, NULL);
+  gst_object_unref (sinkpad1);
+
+  /* the new active pad starts with its last keyframe */
+  fail_unless_equals_int (gst_harness_push (h1,
+          new_timestamped_buffer (4 * GST_SECOND, FALSE)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h0), 4);
+  for (i = 1; i <= 4; i++) {
+    buf = gst_harness_pull (h0);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), i * GST_SECOND);
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buf,
+            GST_BUFFER_FLAG_DISCONT), i == 1);
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buf,
+            GST_BUFFER_FLAG_DELTA_UNIT), i != 1);
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h0);
+  gst_object_unref (sel);
+}
+
+GST_END_TEST;
+
 static Suite *
 selector_suite (void)
 {
@@ -835,6 +902,7 @@ selector_suite (void)
   tcase_add_test (tc_chain, test_input_selector_empty_stream);
   tcase_add_test (tc_chain, test_input_selector_shorter_stream);
   tcase_add_test (tc_chain, test_input_selector_switch_to_eos_stream);
+  tcase_add_test (tc_chain, test_input_selector_keyframe_preroll);
   tcase_add_test (tc_chain, test_output_selector_no_srcpad_negotiation);
 
   tc_chain = tcase_create ("output-selector-negotiation");
@@ -261,6 +261,83 @@ GST_START_TEST (test_streamiddemux_simple)
 
 GST_END_TEST;
 
+static GstFlowReturn
+chain_list_count (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  guint *n_buffers = g_object_get_data (G_OBJECT (pad), "n-buffers");
+
+  /* lists arrive in one piece on the pad of their stream */
+  fail_unless (pad == GST_PAD_PEER (active_srcpad));
+  *n_buffers += gst_buffer_list_length (list);
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+static GstBufferList *
+new_buffer_list (guint n)
+{
+  GstBufferList *list = gst_buffer_list_new ();
+
+  while (n--)
+    gst_buffer_list_add (list, gst_buffer_new ());
+
+  return list;
+}
+
+GST_START_TEST (test_streamiddemux_buffer_list)
+{
+  struct TestData td;
+  guint n_buffers[2] = { 0, 0 };
+  gint i;
+
+  setup_test_objects (&td);
+
+  for (i = 0; i < 2; i++) {
+    td.mysink[i] = gst_pad_new (NULL, GST_PAD_SINK);
+    g_object_set_data (G_OBJECT (td.mysink[i]), "n-buffers", &n_buffers[i]);
+    gst_pad_set_chain_function (td.mysink[i], chain_ok);
+    gst_pad_set_chain_list_function (td.mysink[i], chain_list_count);
+    gst_pad_set_active (td.mysink[i], TRUE);
+  }
+
+  td.mysrc = gst_pad_new ("mysrc", GST_PAD_SRC);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (td.mysrc, td.demuxsink)));
+  gst_pad_set_active (td.mysrc, TRUE);
+
+  gst_check_setup_events_with_stream_id (td.mysrc, td.demux, td.mycaps,
+      GST_FORMAT_BYTES, "test0");
+  set_active_srcpad (&td);
+  fail_unless (gst_pad_push_list (td.mysrc, new_buffer_list (3)) ==
+      GST_FLOW_OK);
+
+  gst_check_setup_events_with_stream_id (td.mysrc, td.demux, td.mycaps,
+      GST_FORMAT_BYTES, "test1");
+  set_active_srcpad (&td);
+  fail_unless (gst_pad_push_list (td.mysrc, new_buffer_list (2)) ==
+      GST_FLOW_OK);
+
+  fail_unless (gst_pad_push_event (td.mysrc,
+          gst_event_new_stream_start ("test0")));
+  set_active_srcpad (&td);
+  fail_unless (gst_pad_push_list (td.mysrc, new_buffer_list (1)) ==
+      GST_FLOW_OK);
+
+  fail_unless_equals_int (n_buffers[0], 4);
+  fail_unless_equals_int (n_buffers[1], 2);
+
+  for (i = 0; i < 2; i++) {
+    gst_pad_set_active (td.mysink[i], FALSE);
+    gst_object_unref (td.mysink[i]);
+  }
+  gst_pad_set_active (td.mysrc, FALSE);
+  gst_object_unref (td.mysrc);
+
+  release_test_objects (&td);
+}
+
+GST_END_TEST;
+
 GList *expected[NUM_SUBSTREAMS];
 
 static gboolean
@@ -509,6 +586,7 @@ streamiddemux_suite (void)
   tcase_add_test (tc_chain, test_streamiddemux_simple);
   tcase_add_test (tc_chain, test_streamiddemux_num_buffers);
   tcase_add_test (tc_chain, test_streamiddemux_eos);
+  tcase_add_test (tc_chain, test_streamiddemux_buffer_list);
   suite_add_tcase (s, tc_chain);
 
   return s;
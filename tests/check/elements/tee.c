@@ -942,6 +942,270 @@ GST_START_TEST (test_allocation_query_empty)
 GST_END_TEST;
 
 
+static GstFlowReturn
+copying_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  /* the other branch still holds the buffer, this copies it */
+  buffer = gst_buffer_make_writable (buffer);
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+reading_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_copy_stats)
+{
+  static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK,
+      GST_PAD_ALWAYS,
+      GST_STATIC_CAPS_ANY);
+  static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC,
+      GST_PAD_ALWAYS,
+      GST_STATIC_CAPS_ANY);
+  GstElement *tee;
+  GstPad *srcpad, *src1, *src2, *sink1, *sink2;
+  GstSegment segment;
+  GstBuffer *buffer;
+  guint num_copies;
+  gint i;
+
+  tee = gst_check_setup_element ("tee");
+  g_object_set (tee, "copy-stats", TRUE, NULL);
+
+  srcpad = gst_check_setup_src_pad (tee, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+
+  src1 = gst_element_get_request_pad (tee, "src_%u");
+  sink1 = gst_pad_new_from_static_template (&sinktemplate, "sink1");
+  gst_pad_set_chain_function (sink1, copying_chain);
+  gst_pad_set_active (sink1, TRUE);
+  fail_unless (gst_pad_link (src1, sink1) == GST_PAD_LINK_OK);
+
+  src2 = gst_element_get_request_pad (tee, "src_%u");
+  sink2 = gst_pad_new_from_static_template (&sinktemplate, "sink2");
+  gst_pad_set_chain_function (sink2, reading_chain);
+  gst_pad_set_active (sink2, TRUE);
+  fail_unless (gst_pad_link (src2, sink2) == GST_PAD_LINK_OK);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < 3; i++) {
+    buffer = gst_buffer_new_allocate (NULL, 16, NULL);
+    fail_unless (gst_pad_push (srcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* only the copies of the first branch are counted */
+  g_object_get (tee, "num-copies", &num_copies, NULL);
+  fail_unless_equals_int (num_copies, 3);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_pad_unlink (src1, sink1);
+  gst_pad_unlink (src2, sink2);
+  gst_element_release_request_pad (tee, src1);
+  gst_element_release_request_pad (tee, src2);
+  gst_object_unref (src1);
+  gst_object_unref (src2);
+  gst_object_unref (sink1);
+  gst_object_unref (sink2);
+
+  gst_pad_set_active (srcpad, FALSE);
+  gst_check_teardown_src_pad (tee);
+  gst_check_teardown_element (tee);
+}
+
+GST_END_TEST;
+
+static GstFlowReturn
+thread_recording_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_object_set_data (G_OBJECT (pad), "thread", g_thread_self ());
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_parallel)
+{
+  static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK,
+      GST_PAD_ALWAYS,
+      GST_STATIC_CAPS_ANY);
+  static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC,
+      GST_PAD_ALWAYS,
+      GST_STATIC_CAPS_ANY);
+  GstElement *tee;
+  GstPad *srcpad, *src1, *src2, *sink1, *sink2;
+  GstTaskPool *pool, *cur_pool;
+  GstSegment segment;
+  GstBuffer *buffer;
+
+  tee = gst_check_setup_element ("tee");
+  g_object_set (tee, "parallel", TRUE, NULL);
+
+  srcpad = gst_check_setup_src_pad (tee, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+
+  src1 = gst_element_get_request_pad (tee, "src_%u");
+  sink1 = gst_pad_new_from_static_template (&sinktemplate, "sink1");
+  gst_pad_set_chain_function (sink1, thread_recording_chain);
+  gst_pad_set_active (sink1, TRUE);
+  fail_unless (gst_pad_link (src1, sink1) == GST_PAD_LINK_OK);
+
+  src2 = gst_element_get_request_pad (tee, "src_%u");
+  sink2 = gst_pad_new_from_static_template (&sinktemplate, "sink2");
+  gst_pad_set_chain_function (sink2, thread_recording_chain);
+  gst_pad_set_active (sink2, TRUE);
+  fail_unless (gst_pad_link (src2, sink2) == GST_PAD_LINK_OK);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  buffer = gst_buffer_new ();
+  fail_unless (gst_pad_push (srcpad, gst_buffer_ref (buffer)) == GST_FLOW_OK);
+
+  /* both branches are done when the push returns, the second one was pushed
+   * from a thread of the task pool */
+  fail_unless (g_object_get_data (G_OBJECT (sink1), "thread") != NULL);
+  fail_unless (g_object_get_data (G_OBJECT (sink2), "thread") != NULL);
+  fail_unless (g_object_get_data (G_OBJECT (sink1), "thread") !=
+      g_object_get_data (G_OBJECT (sink2), "thread"));
+  ASSERT_BUFFER_REFCOUNT (buffer, "buffer", 1);
+  gst_buffer_unref (buffer);
+
+  /* replacing the default pool cleans it up, the new one is used */
+  pool = gst_task_pool_new ();
+  gst_task_pool_prepare (pool, NULL);
+  g_object_set (tee, "task-pool", pool, NULL);
+  g_object_get (tee, "task-pool", &cur_pool, NULL);
+  fail_unless (cur_pool == pool);
+  gst_object_unref (cur_pool);
+  g_object_set_data (G_OBJECT (sink2), "thread", NULL);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (g_object_get_data (G_OBJECT (sink2), "thread") != NULL);
+
+  /* the results are still combined */
+  gst_pad_unlink (src2, sink2);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  gst_pad_unlink (src1, sink1);
+  fail_unless (gst_pad_push (srcpad,
+          gst_buffer_new ()) == GST_FLOW_NOT_LINKED);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_element_release_request_pad (tee, src1);
+  gst_element_release_request_pad (tee, src2);
+  gst_object_unref (src1);
+  gst_object_unref (src2);
+  gst_object_unref (sink1);
+  gst_object_unref (sink2);
+
+  gst_pad_set_active (srcpad, FALSE);
+  gst_check_teardown_src_pad (tee);
+  gst_check_teardown_element (tee);
+
+  /* the pool of the application is not cleaned up by tee */
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static GstFlowReturn
+writable_recording_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_object_set_data (G_OBJECT (pad), "writable",
+      GINT_TO_POINTER (gst_buffer_is_writable (buffer)));
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_last_pad_gets_reference)
+{
+  static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK,
+      GST_PAD_ALWAYS,
+      GST_STATIC_CAPS_ANY);
+  static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC,
+      GST_PAD_ALWAYS,
+      GST_STATIC_CAPS_ANY);
+  GstElement *tee;
+  GstPad *srcpad, *src1, *src2, *sink1, *sink2;
+  GstSegment segment;
+
+  tee = gst_check_setup_element ("tee");
+
+  srcpad = gst_check_setup_src_pad (tee, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+
+  src1 = gst_element_get_request_pad (tee, "src_%u");
+  sink1 = gst_pad_new_from_static_template (&sinktemplate, "sink1");
+  gst_pad_set_chain_function (sink1, writable_recording_chain);
+  gst_pad_set_active (sink1, TRUE);
+  fail_unless (gst_pad_link (src1, sink1) == GST_PAD_LINK_OK);
+
+  src2 = gst_element_get_request_pad (tee, "src_%u");
+  sink2 = gst_pad_new_from_static_template (&sinktemplate, "sink2");
+  gst_pad_set_chain_function (sink2, writable_recording_chain);
+  gst_pad_set_active (sink2, TRUE);
+  fail_unless (gst_pad_link (src2, sink2) == GST_PAD_LINK_OK);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  /* the first pad shares the buffer with tee, the last one gets the
+   * reference of tee and with it a writable buffer */
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_if (GPOINTER_TO_INT (g_object_get_data (G_OBJECT (sink1),
+              "writable")));
+  fail_unless (GPOINTER_TO_INT (g_object_get_data (G_OBJECT (sink2),
+              "writable")));
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_pad_unlink (src1, sink1);
+  gst_pad_unlink (src2, sink2);
+  gst_element_release_request_pad (tee, src1);
+  gst_element_release_request_pad (tee, src2);
+  gst_object_unref (src1);
+  gst_object_unref (src2);
+  gst_object_unref (sink1);
+  gst_object_unref (sink2);
+
+  gst_pad_set_active (srcpad, FALSE);
+  gst_check_teardown_src_pad (tee);
+  gst_check_teardown_element (tee);
+}
+
+GST_END_TEST;
+
 static Suite *
 tee_suite (void)
 {
@@ -964,6 +1228,9 @@ tee_suite (void)
   tcase_add_test (tc_chain, test_allocation_query_allow_not_linked);
   tcase_add_test (tc_chain, test_allocation_query_failure);
   tcase_add_test (tc_chain, test_allocation_query_empty);
+  tcase_add_test (tc_chain, test_copy_stats);
+  tcase_add_test (tc_chain, test_parallel);
+  tcase_add_test (tc_chain, test_last_pad_gets_reference);
 
   return s;
 }
@@ -80,6 +80,38 @@ GST_START_TEST (test_valve_upstream_events_dont_send_sticky)
 
 GST_END_TEST;
 
+GST_START_TEST (test_valve_discont_after_reopen)
+{
+  GstHarness *h = gst_harness_new ("valve");
+  GstBuffer *buf;
+
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, gst_buffer_new ()));
+  buf = gst_harness_pull (h);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DISCONT));
+  gst_buffer_unref (buf);
+
+  g_object_set (h->element, "drop", TRUE, NULL);
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, gst_buffer_new ()));
+  g_object_set (h->element, "drop", FALSE, NULL);
+
+  /* only the first buffer after reopening is marked */
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, gst_buffer_new ()));
+  buf = gst_harness_pull (h);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DISCONT));
+  gst_buffer_unref (buf);
+
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, gst_buffer_new ()));
+  buf = gst_harness_pull (h);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DISCONT));
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 valve_suite (void)
 {
@@ -89,6 +121,7 @@ valve_suite (void)
   tc_chain = tcase_create ("valve_basic");
   tcase_add_test (tc_chain, test_valve_basic);
   tcase_add_test (tc_chain, test_valve_upstream_events_dont_send_sticky);
+  tcase_add_test (tc_chain, test_valve_discont_after_reopen);
 
   suite_add_tcase (s, tc_chain);
 
@@ -31,6 +31,150 @@ GST_START_TEST (test_create_free)
 
 GST_END_TEST;
 
+GST_START_TEST (test_bounded)
+{
+  GstAtomicQueue *aq;
+  gpointer items[8];
+  guint i;
+
+  aq = gst_atomic_queue_new_bounded (3);
+  fail_unless_equals_int (gst_atomic_queue_get_capacity (aq), 4);
+  fail_unless (gst_atomic_queue_pop (aq) == NULL);
+  fail_unless (gst_atomic_queue_peek (aq) == NULL);
+
+  for (i = 0; i < 4; i++)
+    fail_unless (gst_atomic_queue_try_push (aq, GUINT_TO_POINTER (i + 1)));
+  fail_if (gst_atomic_queue_try_push (aq, GUINT_TO_POINTER (5)));
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 4);
+  fail_unless (gst_atomic_queue_peek (aq) == GUINT_TO_POINTER (1));
+
+  /* wrap around a few times */
+  for (i = 0; i < 10; i++) {
+    fail_unless (gst_atomic_queue_pop (aq) == GUINT_TO_POINTER (i + 1));
+    gst_atomic_queue_push (aq, GUINT_TO_POINTER (i + 5));
+  }
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 4);
+
+  /* batches stop when the queue is empty or full */
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, items, 8), 4);
+  for (i = 0; i < 4; i++)
+    fail_unless (items[i] == GUINT_TO_POINTER (i + 11));
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 0);
+
+  for (i = 0; i < 8; i++)
+    items[i] = GUINT_TO_POINTER (i + 1);
+  fail_unless_equals_int (gst_atomic_queue_push_many (aq, items, 3), 3);
+  fail_unless_equals_int (gst_atomic_queue_push_many (aq, items + 3, 5), 1);
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, items, 2), 2);
+  fail_unless (items[0] == GUINT_TO_POINTER (1));
+  fail_unless (items[1] == GUINT_TO_POINTER (2));
+
+  gst_atomic_queue_unref (aq);
+
+  /* capacities that can't be rounded up are refused */
+  ASSERT_CRITICAL (aq = gst_atomic_queue_new_bounded (G_MAXUINT));
+  fail_unless (aq == NULL);
+  ASSERT_CRITICAL (aq = gst_atomic_queue_new_bounded ((1U << 30) + 1));
+  fail_unless (aq == NULL);
+
+  /* unbounded queues take any batch */
+  aq = gst_atomic_queue_new (2);
+  fail_unless_equals_int (gst_atomic_queue_get_capacity (aq), 0);
+  for (i = 0; i < 8; i++)
+    items[i] = GUINT_TO_POINTER (i + 1);
+  fail_unless_equals_int (gst_atomic_queue_push_many (aq, items, 8), 8);
+  fail_unless (gst_atomic_queue_try_push (aq, GUINT_TO_POINTER (9)));
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, items, 8), 8);
+  fail_unless (items[7] == GUINT_TO_POINTER (8));
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, items, 8), 1);
+  fail_unless (items[0] == GUINT_TO_POINTER (9));
+  gst_atomic_queue_unref (aq);
+}
+
+GST_END_TEST;
+
+#define N_THREADS 4
+#define N_ITEMS 10000
+
+typedef struct
+{
+  GstAtomicQueue *aq;
+  guint id;
+  volatile gint *popped;
+  guint64 sum;
+} ThreadData;
+
+static gpointer
+push_thread (ThreadData * data)
+{
+  gpointer items[7];
+  guint i, j, n;
+
+  for (i = 0; i < N_ITEMS;) {
+    n = MIN (G_N_ELEMENTS (items), N_ITEMS - i);
+    for (j = 0; j < n; j++)
+      items[j] = GUINT_TO_POINTER (data->id * N_ITEMS + i + j + 1);
+    /* alternate between single and batched pushes */
+    if (i % 2)
+      i += gst_atomic_queue_push_many (data->aq, items, n);
+    else if (gst_atomic_queue_try_push (data->aq, items[0]))
+      i++;
+  }
+
+  return NULL;
+}
+
+static gpointer
+pop_thread (ThreadData * data)
+{
+  gpointer items[5];
+  guint i, n;
+
+  while (g_atomic_int_get (data->popped) < N_THREADS * N_ITEMS) {
+    n = gst_atomic_queue_pop_many (data->aq, items, G_N_ELEMENTS (items));
+    for (i = 0; i < n; i++)
+      data->sum += GPOINTER_TO_UINT (items[i]);
+    g_atomic_int_add (data->popped, n);
+  }
+
+  return NULL;
+}
+
+GST_START_TEST (test_bounded_threaded)
+{
+  ThreadData pushers[N_THREADS], poppers[N_THREADS];
+  GThread *threads[2 * N_THREADS];
+  GstAtomicQueue *aq;
+  volatile gint popped = 0;
+  guint64 sum = 0, expected;
+  guint i;
+
+  aq = gst_atomic_queue_new_bounded (64);
+
+  for (i = 0; i < N_THREADS; i++) {
+    pushers[i].aq = poppers[i].aq = aq;
+    pushers[i].id = i;
+    poppers[i].popped = &popped;
+    poppers[i].sum = 0;
+    threads[i] = g_thread_new ("push", (GThreadFunc) push_thread, &pushers[i]);
+    threads[N_THREADS + i] =
+        g_thread_new ("pop", (GThreadFunc) pop_thread, &poppers[i]);
+  }
+  for (i = 0; i < 2 * N_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  /* every item was popped exactly once */
+  for (i = 0; i < N_THREADS; i++)
+    sum += poppers[i].sum;
+  expected = (guint64) N_THREADS * N_ITEMS * (N_THREADS * N_ITEMS + 1) / 2;
+  fail_unless_equals_uint64 (sum, expected);
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 0);
+
+  gst_atomic_queue_unref (aq);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_atomic_queue_suite (void)
 {
@@ -39,6 +183,8 @@ gst_atomic_queue_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_create_free);
+  tcase_add_test (tc_chain, test_bounded);
+  tcase_add_test (tc_chain, test_bounded_threaded);
 
   return s;
 }
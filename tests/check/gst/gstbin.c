@@ -1098,6 +1098,64 @@ GST_START_TEST (test_iterate_sorted)
 
 GST_END_TEST;
 
+static void
+check_sorted_order (GstElement * bin, GstElement * first, ...)
+{
+  GstIterator *it;
+  GValue elem = { 0, };
+  GstElement *expected;
+  va_list args;
+
+  it = gst_bin_iterate_sorted (GST_BIN (bin));
+  va_start (args, first);
+  for (expected = first; expected; expected = va_arg (args, GstElement *)) {
+    fail_unless (gst_iterator_next (it, &elem) == GST_ITERATOR_OK);
+    fail_unless (g_value_get_object (&elem) == (gpointer) expected);
+    g_value_reset (&elem);
+  }
+  va_end (args);
+  fail_unless (gst_iterator_next (it, &elem) == GST_ITERATOR_DONE);
+  g_value_unset (&elem);
+  gst_iterator_free (it);
+}
+
+GST_START_TEST (test_iterate_sorted_relink)
+{
+  GstElement *pipeline, *src, *identity, *sink;
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("fakesrc", NULL);
+  fail_if (src == NULL, "Could not create fakesrc");
+  sink = gst_element_factory_make ("fakesink", NULL);
+  fail_if (sink == NULL, "Could not create fakesink");
+
+  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  /* the second sort gives the same order */
+  check_sorted_order (pipeline, sink, src, NULL);
+  check_sorted_order (pipeline, sink, src, NULL);
+
+  /* adding and relinking elements changes the order */
+  identity = gst_element_factory_make ("identity", NULL);
+  fail_if (identity == NULL, "Could not create identity");
+  gst_bin_add (GST_BIN (pipeline), identity);
+  gst_element_unlink (src, sink);
+  fail_unless (gst_element_link_many (src, identity, sink, NULL));
+
+  check_sorted_order (pipeline, sink, identity, src, NULL);
+  check_sorted_order (pipeline, sink, identity, src, NULL);
+
+  /* and so does removing them */
+  gst_bin_remove (GST_BIN (pipeline), sink);
+  check_sorted_order (pipeline, identity, src, NULL);
+
+  ASSERT_OBJECT_REFCOUNT (pipeline, "pipeline", 1);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_iterate_sorted_unlinked)
 {
   GstElement *pipeline, *src, *sink, *identity;
@@ -1776,6 +1834,203 @@ GST_START_TEST (test_suppressed_flags_when_removing)
 
 GST_END_TEST;
 
+GST_START_TEST (test_parallel_state_change)
+{
+  GstElement *pipeline, *src, *sink;
+  gint i;
+
+  pipeline = gst_pipeline_new (NULL);
+  g_object_set (pipeline, "parallel-state-change", TRUE, NULL);
+
+  for (i = 0; i < 4; i++) {
+    src = gst_element_factory_make ("fakesrc", NULL);
+    fail_unless (src != NULL);
+    g_object_set (src, "is-live", i == 0, NULL);
+    sink = gst_element_factory_make ("fakesink", NULL);
+    fail_unless (sink != NULL);
+    gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+    fail_unless (gst_element_link (src, sink));
+  }
+
+  /* the live source makes the pipeline not preroll */
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_NO_PREROLL);
+  fail_if (gst_element_set_state (pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static void
+deep_notify_count_cb (GstObject * object, GstObject * orig, GParamSpec * pspec,
+    gint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_deep_notify_filter)
+{
+  GstElement *pipeline, *bin, *src;
+  const gchar *props[] = { "num-buffers", NULL };
+  gint count = 0;
+
+  pipeline = gst_pipeline_new (NULL);
+  bin = gst_bin_new (NULL);
+  src = gst_element_factory_make ("fakesrc", NULL);
+  gst_bin_add (GST_BIN (bin), src);
+  gst_bin_add (GST_BIN (pipeline), bin);
+
+  g_signal_connect (pipeline, "deep-notify",
+      G_CALLBACK (deep_notify_count_cb), &count);
+
+  g_object_set (src, "sizemax", 10, NULL);
+  fail_unless_equals_int (count, 1);
+
+  /* only num-buffers is propagated past the bin */
+  gst_bin_set_deep_notify_filter (GST_BIN (bin), G_TYPE_INVALID, props);
+  g_object_set (src, "sizemax", 20, NULL);
+  fail_unless_equals_int (count, 1);
+  g_object_set (src, "num-buffers", 10, NULL);
+  fail_unless_equals_int (count, 2);
+
+  /* only notifications of pads are propagated */
+  gst_bin_set_deep_notify_filter (GST_BIN (bin), GST_TYPE_PAD, NULL);
+  g_object_set (src, "num-buffers", 20, NULL);
+  fail_unless_equals_int (count, 2);
+
+  /* the filter of the bin does not apply to itself */
+  g_object_set (bin, "async-handling", TRUE, NULL);
+  fail_unless_equals_int (count, 3);
+
+  gst_bin_set_deep_notify_filter (GST_BIN (bin), G_TYPE_INVALID, NULL);
+  g_object_set (src, "sizemax", 30, NULL);
+  fail_unless_equals_int (count, 4);
+
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_iterate_elements_snapshot)
+{
+  GstElement *bin, *e1, *e2;
+  GstIterator *it;
+  GValue item = G_VALUE_INIT;
+
+  bin = gst_bin_new (NULL);
+  e1 = gst_element_factory_make ("identity", NULL);
+  e2 = gst_element_factory_make ("identity", NULL);
+  gst_bin_add (GST_BIN (bin), e1);
+
+  it = gst_bin_iterate_elements_snapshot (GST_BIN (bin));
+
+  /* the iterator doesn't see the new child and doesn't resync */
+  gst_bin_add (GST_BIN (bin), e2);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_OK);
+  fail_unless (g_value_get_object (&item) == e1);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_DONE);
+  g_value_reset (&item);
+  gst_iterator_free (it);
+
+  /* a new snapshot has both, in the order of gst_bin_iterate_elements() */
+  it = gst_bin_iterate_elements_snapshot (GST_BIN (bin));
+  gst_bin_remove (GST_BIN (bin), e1);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_OK);
+  fail_unless (g_value_get_object (&item) == e2);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_OK);
+  fail_unless (g_value_get_object (&item) == e1);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_DONE);
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  gint calls;
+  gboolean release;
+  GstBin *bin;
+  gint done;
+} LatencyData;
+
+static gboolean
+blocking_failing_latency_cb (GstBin * bin, LatencyData * data)
+{
+  g_mutex_lock (&data->lock);
+  data->calls++;
+  g_cond_broadcast (&data->cond);
+  while (!data->release)
+    g_cond_wait (&data->cond, &data->lock);
+  g_mutex_unlock (&data->lock);
+
+  /* the latency query failed */
+  return FALSE;
+}
+
+static gpointer
+recalculate_latency_thread (LatencyData * data)
+{
+  gboolean res;
+
+  res = gst_bin_recalculate_latency (data->bin);
+  g_atomic_int_inc (&data->done);
+
+  return GINT_TO_POINTER (res);
+}
+
+GST_START_TEST (test_recalculate_latency_coalesced)
+{
+  LatencyData data = { {0}, };
+  GThread *t1, *t2;
+
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+  data.bin = GST_BIN (gst_pipeline_new (NULL));
+  g_signal_connect (data.bin, "do-latency",
+      G_CALLBACK (blocking_failing_latency_cb), &data);
+
+  /* the first recalculation blocks in the handler */
+  t1 = g_thread_new ("latency1", (GThreadFunc) recalculate_latency_thread,
+      &data);
+  g_mutex_lock (&data.lock);
+  while (data.calls < 1)
+    g_cond_wait (&data.cond, &data.lock);
+  g_mutex_unlock (&data.lock);
+
+  /* the second one is coalesced and must wait for the next pass */
+  t2 = g_thread_new ("latency2", (GThreadFunc) recalculate_latency_thread,
+      &data);
+  g_usleep (G_USEC_PER_SEC / 10);
+  fail_unless_equals_int (g_atomic_int_get (&data.done), 0);
+
+  g_mutex_lock (&data.lock);
+  data.release = TRUE;
+  g_cond_broadcast (&data.cond);
+  g_mutex_unlock (&data.lock);
+
+  /* both see the failure and the handler ran once more for the second */
+  fail_if (GPOINTER_TO_INT (g_thread_join (t1)));
+  fail_if (GPOINTER_TO_INT (g_thread_join (t2)));
+  fail_unless_equals_int (data.calls, 2);
+
+  gst_object_unref (data.bin);
+  g_cond_clear (&data.cond);
+  g_mutex_clear (&data.lock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bin_suite (void)
 {
@@ -1799,6 +2054,7 @@ gst_bin_suite (void)
   tcase_add_test (tc_chain, test_add_linked);
   tcase_add_test (tc_chain, test_add_self);
   tcase_add_test (tc_chain, test_iterate_sorted);
+  tcase_add_test (tc_chain, test_iterate_sorted_relink);
   tcase_add_test (tc_chain, test_iterate_sorted_unlinked);
   tcase_add_test (tc_chain, test_link_structure_change);
   tcase_add_test (tc_chain, test_state_failure_remove);
@@ -1809,6 +2065,10 @@ gst_bin_suite (void)
   tcase_add_test (tc_chain, test_deep_added_removed);
   tcase_add_test (tc_chain, test_suppressed_flags);
   tcase_add_test (tc_chain, test_suppressed_flags_when_removing);
+  tcase_add_test (tc_chain, test_parallel_state_change);
+  tcase_add_test (tc_chain, test_deep_notify_filter);
+  tcase_add_test (tc_chain, test_iterate_elements_snapshot);
+  tcase_add_test (tc_chain, test_recalculate_latency_coalesced);
 
   /* fails on OSX build bot for some reason, and is a bit silly anyway */
   if (0)
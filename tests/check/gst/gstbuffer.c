@@ -748,6 +748,98 @@ GST_START_TEST (test_map_range)
 
 GST_END_TEST;
 
+GST_START_TEST (test_map_merged_cache)
+{
+  GstBuffer *buf;
+  GstMemory *mem;
+  GstMapInfo map1, map2;
+  gpointer data;
+
+  buf = gst_buffer_new ();
+  gst_buffer_insert_memory (buf, -1, gst_allocator_alloc (NULL, 50, NULL));
+  gst_buffer_insert_memory (buf, -1, gst_allocator_alloc (NULL, 50, NULL));
+  gst_buffer_memset (buf, 0, 1, 100);
+
+  gst_buffer_ref (buf);
+  /* read maps of a buffer that is not writable merge only once */
+  fail_unless (gst_buffer_map (buf, &map1, GST_MAP_READ));
+  fail_unless (gst_buffer_map (buf, &map2, GST_MAP_READ));
+  fail_unless (map1.data == map2.data);
+  gst_buffer_unmap (buf, &map2);
+  data = map1.data;
+  gst_buffer_unmap (buf, &map1);
+  fail_unless (gst_buffer_map (buf, &map1, GST_MAP_READ));
+  fail_unless (map1.data == data);
+  gst_buffer_unmap (buf, &map1);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 2);
+  gst_buffer_unref (buf);
+
+  /* writing to the memory drops the cached copy */
+  mem = gst_buffer_peek_memory (buf, 1);
+  fail_unless (gst_memory_map (mem, &map1, GST_MAP_WRITE));
+  memset (map1.data, 2, map1.size);
+  gst_memory_unmap (mem, &map1);
+
+  gst_buffer_ref (buf);
+  fail_unless (gst_buffer_map (buf, &map1, GST_MAP_READ));
+  fail_unless_equals_int (map1.size, 100);
+  fail_unless_equals_int (map1.data[0], 1);
+  fail_unless_equals_int (map1.data[99], 2);
+  gst_buffer_unmap (buf, &map1);
+  gst_buffer_unref (buf);
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_many_memory)
+{
+  GstBuffer *buf, *copy;
+  GstMapInfo map;
+  guint i, n;
+
+  /* more than the memory stored inline in the buffer */
+  n = 100;
+  fail_unless (gst_buffer_get_max_memory () >= n);
+
+  buf = gst_buffer_new ();
+  for (i = 0; i < n; i++) {
+    GstMemory *mem = gst_allocator_alloc (NULL, 1, NULL);
+
+    gst_memory_map (mem, &map, GST_MAP_WRITE);
+    map.data[0] = i;
+    gst_memory_unmap (mem, &map);
+    gst_buffer_append_memory (buf, mem);
+  }
+  /* nothing got merged */
+  fail_unless_equals_int (gst_buffer_n_memory (buf), n);
+  fail_unless_equals_int (gst_buffer_get_size (buf), n);
+
+  /* subbuffers share the memory */
+  copy = gst_buffer_copy_region (buf, GST_BUFFER_COPY_MEMORY, 10, n - 20);
+  fail_unless_equals_int (gst_buffer_n_memory (copy), n - 20);
+  gst_buffer_unref (copy);
+
+  gst_buffer_remove_memory_range (buf, 0, 50);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), n - 50);
+
+  gst_buffer_insert_memory (buf, 0, gst_allocator_alloc (NULL, 1, NULL));
+  fail_unless_equals_int (gst_buffer_n_memory (buf), n - 49);
+
+  /* mapping merges and stores */
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, n - 49);
+  for (i = 1; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], i + 49);
+  gst_buffer_unmap (buf, &map);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 1);
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_find)
 {
   GstBuffer *buf;
@@ -865,6 +957,16 @@ GST_START_TEST (test_fill)
   fail_unless_equals_int (gst_buffer_extract (buf, 0, data2, 25), 25);
   fail_unless (memcmp (data2, data + 10, 25) == 0);
 
+  /* offsets in the later memories */
+  fail_unless_equals_int (gst_buffer_extract (buf, 12, data2, 25), 13);
+  fail_unless (memcmp (data2, data + 22, 13) == 0);
+  fail_unless (gst_buffer_memcmp (buf, 12, data + 22, 13) == 0);
+  fail_unless (gst_buffer_memcmp (buf, 25, data, 1) != 0);
+  fail_unless_equals_int (gst_buffer_memset (buf, 10, 0, 100), 15);
+  fail_unless (gst_buffer_memcmp (buf, 0, data + 10, 10) == 0);
+  fail_unless_equals_int (gst_buffer_extract (buf, 24, data2, 1), 1);
+  fail_unless_equals_int (data2[0], 0);
+
   gst_buffer_unref (buf);
 }
 
@@ -889,6 +991,299 @@ GST_START_TEST (test_parent_buffer_meta)
 
 GST_END_TEST;
 
+/* metas that fit in the inline meta storage of a buffer, the second one
+ * with the layout of a GstVideoMeta, and one that does not */
+typedef struct
+{
+  GstMeta meta;
+  guint32 value;
+} GstMetaSmall;
+
+typedef struct
+{
+  GstMeta meta;
+  GstBuffer *buffer;
+  guint flags, format, id, width, height, n_planes;
+  gsize offset[4];
+  gint stride[4];
+  gpointer map, unmap;
+} GstMetaVideoSized;
+
+typedef struct
+{
+  GstMeta meta;
+  guint8 data[128];
+} GstMetaLarge;
+
+static GType
+gst_meta_size_api_get_type (void)
+{
+  static volatile GType type;
+  static const gchar *tags[] = { NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstMetaSizeAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+static gboolean
+meta_small_init_func (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  ((GstMetaSmall *) meta)->value = 0;
+  return TRUE;
+}
+
+static gboolean
+meta_small_transform_func (GstBuffer * transbuf, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data);
+
+static const GstMetaInfo *
+gst_meta_small_get_info (void)
+{
+  static const GstMetaInfo *meta_small_info = NULL;
+
+  if (g_once_init_enter (&meta_small_info)) {
+    const GstMetaInfo *mi = gst_meta_register (gst_meta_size_api_get_type (),
+        "GstMetaSmall", sizeof (GstMetaSmall),
+        meta_small_init_func, NULL, meta_small_transform_func);
+    g_once_init_leave (&meta_small_info, mi);
+  }
+  return meta_small_info;
+}
+
+static GstMetaSmall *
+meta_small_add (GstBuffer * buffer, guint32 value)
+{
+  GstMetaSmall *meta;
+
+  meta = (GstMetaSmall *) gst_buffer_add_meta (buffer,
+      gst_meta_small_get_info (), NULL);
+  fail_unless (meta != NULL);
+  meta->value = value;
+
+  return meta;
+}
+
+static gboolean
+meta_small_transform_func (GstBuffer * transbuf, GstMeta * meta,
+    GstBuffer * buffer, GQuark type, gpointer data)
+{
+  if (!GST_META_TRANSFORM_IS_COPY (type))
+    return FALSE;
+
+  meta_small_add (transbuf, ((GstMetaSmall *) meta)->value);
+  return TRUE;
+}
+
+static GstMetaSmall *
+meta_small_find (GstBuffer * buffer, guint32 value)
+{
+  gpointer state = NULL;
+  GstMeta *meta;
+
+  while ((meta = gst_buffer_iterate_meta_filtered (buffer, &state,
+              gst_meta_size_api_get_type ()))) {
+    if (meta->info == gst_meta_small_get_info ()
+        && ((GstMetaSmall *) meta)->value == value)
+      return (GstMetaSmall *) meta;
+  }
+  return NULL;
+}
+
+static const GstMetaInfo *
+gst_meta_video_sized_get_info (void)
+{
+  static const GstMetaInfo *meta_video_sized_info = NULL;
+
+  if (g_once_init_enter (&meta_video_sized_info)) {
+    const GstMetaInfo *mi = gst_meta_register (gst_meta_size_api_get_type (),
+        "GstMetaVideoSized", sizeof (GstMetaVideoSized), NULL, NULL, NULL);
+    g_once_init_leave (&meta_video_sized_info, mi);
+  }
+  return meta_video_sized_info;
+}
+
+static const GstMetaInfo *
+gst_meta_large_get_info (void)
+{
+  static const GstMetaInfo *meta_large_info = NULL;
+
+  if (g_once_init_enter (&meta_large_info)) {
+    const GstMetaInfo *mi = gst_meta_register (gst_meta_size_api_get_type (),
+        "GstMetaLarge", sizeof (GstMetaLarge), NULL, NULL, NULL);
+    g_once_init_leave (&meta_large_info, mi);
+  }
+  return meta_large_info;
+}
+
+/* offset of @meta from the start of @buffer, the inline meta storage is at
+ * the same offset in every buffer */
+static gssize
+meta_offset (GstBuffer * buffer, gpointer meta)
+{
+  return (guint8 *) meta - (guint8 *) buffer;
+}
+
+/* the first small meta of a new buffer lands in the inline storage */
+static gssize
+inline_meta_offset (void)
+{
+  GstBuffer *buffer;
+  gssize offset;
+
+  buffer = gst_buffer_new ();
+  offset = meta_offset (buffer, meta_small_add (buffer, 0));
+  gst_buffer_unref (buffer);
+
+  /* inside the buffer structure */
+  fail_unless (offset > 0 && offset < 1024);
+
+  return offset;
+}
+
+GST_START_TEST (test_meta_inline)
+{
+  GstBuffer *buffer;
+  GstMetaSmall *meta1, *meta2, *meta3;
+  gssize inline_offset = inline_meta_offset ();
+
+  buffer = gst_buffer_new ();
+
+  /* the first meta takes the inline slot, the second one can't */
+  meta1 = meta_small_add (buffer, 1);
+  fail_unless_equals_int (meta_offset (buffer, meta1), inline_offset);
+  meta2 = meta_small_add (buffer, 2);
+  fail_if (meta_offset (buffer, meta2) == inline_offset);
+
+  /* removing the meta releases the slot and the next meta reuses it */
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta1));
+  fail_unless (meta_small_find (buffer, 1) == NULL);
+  meta3 = meta_small_add (buffer, 3);
+  fail_unless_equals_int (meta_offset (buffer, meta3), inline_offset);
+  fail_unless (meta_small_find (buffer, 2) == meta2);
+  fail_unless (meta_small_find (buffer, 3) == meta3);
+
+  /* removing the other meta leaves the slot taken */
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta2));
+  meta2 = meta_small_add (buffer, 4);
+  fail_if (meta_offset (buffer, meta2) == inline_offset);
+  fail_unless_equals_int (meta_small_find (buffer, 3)->value, 3);
+
+  /* and with all metas removed the slot is free again */
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta2));
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta3));
+  fail_unless_equals_int (gst_buffer_get_n_meta (buffer,
+          gst_meta_size_api_get_type ()), 0);
+  meta1 = meta_small_add (buffer, 5);
+  fail_unless_equals_int (meta_offset (buffer, meta1), inline_offset);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_meta_inline_copy)
+{
+  GstBuffer *src, *dest, *copy;
+  GstMetaSmall *meta;
+  gssize inline_offset = inline_meta_offset ();
+
+  src = gst_buffer_new ();
+  meta = meta_small_add (src, 42);
+  fail_unless_equals_int (meta_offset (src, meta), inline_offset);
+
+  /* the inline slot of dest is already taken, the copied meta goes to the
+   * heap */
+  dest = gst_buffer_new ();
+  meta = meta_small_add (dest, 7);
+  fail_unless_equals_int (meta_offset (dest, meta), inline_offset);
+  fail_unless (gst_buffer_copy_into (dest, src, GST_BUFFER_COPY_META, 0, -1));
+  meta = meta_small_find (dest, 42);
+  fail_unless (meta != NULL);
+  fail_if (meta_offset (dest, meta) == inline_offset);
+
+  /* a new buffer gets the copied meta inline */
+  copy = gst_buffer_copy (src);
+  meta = meta_small_find (copy, 42);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (meta_offset (copy, meta), inline_offset);
+  gst_buffer_unref (copy);
+
+  /* the copies don't refer to the storage of src */
+  gst_buffer_unref (src);
+  fail_unless (gst_buffer_remove_meta (dest,
+          (GstMeta *) meta_small_find (dest, 7)));
+  meta = meta_small_find (dest, 42);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (meta->value, 42);
+
+  gst_buffer_unref (dest);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_meta_inline_large)
+{
+  GstBuffer *buffer;
+  GstMetaLarge *large;
+  GstMetaSmall *meta;
+  gssize inline_offset = inline_meta_offset ();
+
+  fail_unless (sizeof (GstMetaLarge) > sizeof (GstMetaVideoSized));
+
+  /* a meta that does not fit in the slot goes to the heap and leaves the
+   * slot free for the next small meta */
+  buffer = gst_buffer_new ();
+  large = (GstMetaLarge *) gst_buffer_add_meta (buffer,
+      gst_meta_large_get_info (), NULL);
+  fail_unless (large != NULL);
+  fail_if (meta_offset (buffer, large) == inline_offset);
+  memset (large->data, 0xff, sizeof (large->data));
+
+  meta = meta_small_add (buffer, 1);
+  fail_unless_equals_int (meta_offset (buffer, meta), inline_offset);
+
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) large));
+  fail_unless (meta_small_find (buffer, 1) == meta);
+
+  /* with the slot taken, a large meta still goes to the heap */
+  large = (GstMetaLarge *) gst_buffer_add_meta (buffer,
+      gst_meta_large_get_info (), NULL);
+  fail_if (meta_offset (buffer, large) == inline_offset);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+/* the storage is big enough for the video meta that video pools add */
+GST_START_TEST (test_meta_inline_video_sized)
+{
+  GstBuffer *buffer;
+  GstMetaVideoSized *video;
+  GstMetaSmall *meta;
+  gssize inline_offset = inline_meta_offset ();
+
+  buffer = gst_buffer_new ();
+  video = (GstMetaVideoSized *) gst_buffer_add_meta (buffer,
+      gst_meta_video_sized_get_info (), NULL);
+  fail_unless (video != NULL);
+  fail_unless_equals_int (meta_offset (buffer, video), inline_offset);
+  memset ((guint8 *) video + sizeof (GstMeta), 0xff,
+      sizeof (GstMetaVideoSized) - sizeof (GstMeta));
+
+  /* the next meta goes elsewhere and is not overwritten */
+  meta = meta_small_add (buffer, 1);
+  fail_if (meta_offset (buffer, meta) == inline_offset);
+  fail_unless_equals_int (meta_small_find (buffer, 1)->value, 1);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_buffer_suite (void)
@@ -910,9 +1305,15 @@ gst_buffer_suite (void)
   tcase_add_test (tc_chain, test_resize);
   tcase_add_test (tc_chain, test_map);
   tcase_add_test (tc_chain, test_map_range);
+  tcase_add_test (tc_chain, test_map_merged_cache);
+  tcase_add_test (tc_chain, test_many_memory);
   tcase_add_test (tc_chain, test_find);
   tcase_add_test (tc_chain, test_fill);
   tcase_add_test (tc_chain, test_parent_buffer_meta);
+  tcase_add_test (tc_chain, test_meta_inline);
+  tcase_add_test (tc_chain, test_meta_inline_copy);
+  tcase_add_test (tc_chain, test_meta_inline_large);
+  tcase_add_test (tc_chain, test_meta_inline_video_sized);
 
   return s;
 }
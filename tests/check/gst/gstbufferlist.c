@@ -95,6 +95,81 @@ GST_START_TEST (test_remove)
 
 GST_END_TEST;
 
+GST_START_TEST (test_take)
+{
+  GstBuffer *buf1, *buf2, *buf;
+
+  buf1 = gst_buffer_new ();
+  buf2 = gst_buffer_new ();
+  gst_buffer_list_add (list, buf1);
+  gst_buffer_list_add (list, buf2);
+
+  ASSERT_CRITICAL (gst_buffer_list_take (list, 2));
+
+  /* the reference of the list is handed over */
+  buf = gst_buffer_list_take (list, 0);
+  fail_unless (buf == buf1);
+  ASSERT_BUFFER_REFCOUNT (buf1, "buf1", 1);
+  fail_unless_equals_int (gst_buffer_list_length (list), 1);
+  fail_unless (gst_buffer_list_get (list, 0) == buf2);
+  gst_buffer_unref (buf1);
+
+  /* only from a writable list */
+  gst_buffer_list_ref (list);
+  ASSERT_CRITICAL (gst_buffer_list_take (list, 0));
+  gst_buffer_list_unref (list);
+  fail_unless_equals_int (gst_buffer_list_length (list), 1);
+}
+
+GST_END_TEST;
+
+static void
+check_sizes (GstBufferList * l, guint first, guint n)
+{
+  guint i;
+
+  fail_unless_equals_int (gst_buffer_list_length (l), n);
+  for (i = 0; i < n; i++)
+    fail_unless_equals_int (gst_buffer_get_size (gst_buffer_list_get (l, i)),
+        first + i);
+}
+
+GST_START_TEST (test_take_from_front)
+{
+  GstBuffer *buf;
+  guint i;
+
+  for (i = 1; i <= 40; i++)
+    gst_buffer_list_add (list, gst_buffer_new_allocate (NULL, i, NULL));
+
+  for (i = 1; i <= 10; i++) {
+    buf = gst_buffer_list_take (list, 0);
+    fail_unless_equals_int (gst_buffer_get_size (buf), i);
+    gst_buffer_unref (buf);
+  }
+  check_sizes (list, 11, 30);
+
+  /* inserting at the front reuses the removed slots */
+  gst_buffer_list_insert (list, 0, gst_buffer_new_allocate (NULL, 10, NULL));
+  check_sizes (list, 10, 31);
+  gst_buffer_list_remove (list, 0, 5);
+  check_sizes (list, 15, 26);
+
+  /* growing moves the buffers back to the start */
+  for (i = 41; i <= 100; i++)
+    gst_buffer_list_add (list, gst_buffer_new_allocate (NULL, i, NULL));
+  check_sizes (list, 15, 86);
+
+  /* and so does removing all of them */
+  gst_buffer_list_remove (list, 0, 1);
+  gst_buffer_list_remove (list, 0, 85);
+  fail_unless_equals_int (gst_buffer_list_length (list), 0);
+  gst_buffer_list_add (list, gst_buffer_new_allocate (NULL, 1, NULL));
+  check_sizes (list, 1, 1);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_make_writable)
 {
   GstBufferList *wlist;
@@ -481,6 +556,8 @@ gst_buffer_list_suite (void)
   tcase_add_checked_fixture (tc_chain, setup, cleanup);
   tcase_add_test (tc_chain, test_add_and_iterate);
   tcase_add_test (tc_chain, test_remove);
+  tcase_add_test (tc_chain, test_take);
+  tcase_add_test (tc_chain, test_take_from_front);
   tcase_add_test (tc_chain, test_make_writable);
   tcase_add_test (tc_chain, test_copy);
   tcase_add_test (tc_chain, test_copy_deep);
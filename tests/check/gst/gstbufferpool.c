@@ -300,6 +300,114 @@ GST_START_TEST (test_flushing_pool_returns_flushing)
 
 GST_END_TEST;
 
+static gpointer
+acquire_buffer_thread (GstBufferPool * pool)
+{
+  GstBuffer *buf = NULL;
+  GstFlowReturn ret;
+
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  if (ret == GST_FLOW_OK)
+    gst_buffer_unref (buf);
+
+  return GINT_TO_POINTER (ret);
+}
+
+GST_START_TEST (test_acquire_waits_for_release)
+{
+  GstBufferPool *pool = create_pool (10, 0, 1);
+  GstBuffer *buf = NULL;
+  GThread *thread;
+  GstFlowReturn ret;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+
+  /* the pool is exhausted, the thread blocks until we release */
+  thread = g_thread_new ("acquire", (GThreadFunc) acquire_buffer_thread, pool);
+  g_usleep (G_USEC_PER_SEC / 10);
+  gst_buffer_unref (buf);
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+
+  /* and flushing unblocks it too */
+  ret = gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  ck_assert_int_eq (ret, GST_FLOW_OK);
+  thread = g_thread_new ("acquire", (GThreadFunc) acquire_buffer_thread, pool);
+  g_usleep (G_USEC_PER_SEC / 10);
+  gst_buffer_pool_set_flushing (pool, TRUE);
+  ret = GPOINTER_TO_INT (g_thread_join (thread));
+  ck_assert_int_eq (ret, GST_FLOW_FLUSHING);
+
+  gst_buffer_unref (buf);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static gpointer
+acquire_two_buffers_thread (GstBufferPool * pool)
+{
+  GstBuffer **bufs = g_new0 (GstBuffer *, 2);
+
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[0],
+          NULL) == GST_FLOW_OK);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[1],
+          NULL) == GST_FLOW_OK);
+
+  return bufs;
+}
+
+GST_START_TEST (test_numa_local_buffers_are_recycled)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *buf1 = NULL, *buf2 = NULL, *buf3 = NULL, **bufs;
+  gint dcount1 = 0, dcount2 = 0;
+
+  fail_unless (gst_buffer_pool_has_option (pool,
+          GST_BUFFER_POOL_OPTION_NUMA_LOCAL));
+
+  gst_buffer_pool_config_set_params (conf, NULL, 10, 1, 2);
+  gst_buffer_pool_config_add_option (conf, GST_BUFFER_POOL_OPTION_NUMA_LOCAL);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  gst_buffer_pool_acquire_buffer (pool, &buf1, NULL);
+  buffer_track_destroy (buf1, &dcount1);
+  gst_buffer_pool_acquire_buffer (pool, &buf2, NULL);
+  buffer_track_destroy (buf2, &dcount2);
+
+  /* the pool is exhausted */
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf3,
+          &params) == GST_FLOW_EOS);
+
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+  fail_unless (dcount1 == 0);
+  fail_unless (dcount2 == 0);
+
+  /* another thread, possibly on another node, gets the same buffers */
+  bufs = g_thread_join (g_thread_new ("acquire",
+          (GThreadFunc) acquire_two_buffers_thread, pool));
+  fail_unless ((bufs[0] == buf1 && bufs[1] == buf2) || (bufs[0] == buf2
+          && bufs[1] == buf1));
+  gst_buffer_unref (bufs[0]);
+  gst_buffer_unref (bufs[1]);
+  g_free (bufs);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  fail_unless (dcount1 == 1);
+  fail_unless (dcount2 == 1);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_pool_suite (void)
 {
@@ -318,6 +426,8 @@ gst_buffer_pool_suite (void)
   tcase_add_test (tc_chain, test_pool_activation_and_config);
   tcase_add_test (tc_chain, test_pool_config_validate);
   tcase_add_test (tc_chain, test_flushing_pool_returns_flushing);
+  tcase_add_test (tc_chain, test_acquire_waits_for_release);
+  tcase_add_test (tc_chain, test_numa_local_buffers_are_recycled);
 
   return s;
 }
@@ -196,6 +196,52 @@ GST_START_TEST (test_watch)
 
 GST_END_TEST;
 
+static gboolean
+batch_func (GstBus * bus, GstMessage ** messages, guint n_messages,
+    GArray * batches)
+{
+  guint i;
+
+  for (i = 0; i < n_messages; i++)
+    fail_unless (GST_IS_MESSAGE (messages[i]));
+  g_array_append_val (batches, n_messages);
+
+  return TRUE;
+}
+
+GST_START_TEST (test_batch_watch)
+{
+  GArray *batches;
+  guint id;
+
+  test_bus = gst_bus_new ();
+  batches = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  id = gst_bus_add_batch_watch_full (test_bus, G_PRIORITY_DEFAULT, 8,
+      (GstBusBatchFunc) batch_func, batches, NULL);
+  fail_if (id == 0);
+  /* there can only be one watch */
+  fail_unless_equals_int (gst_bus_add_watch (test_bus,
+          (GstBusFunc) message_func_app, NULL), 0);
+
+  /* 20 messages in batches of at most 8 */
+  send_messages (NULL);
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+
+  fail_unless_equals_int (batches->len, 3);
+  fail_unless_equals_int (g_array_index (batches, guint, 0), 8);
+  fail_unless_equals_int (g_array_index (batches, guint, 1), 8);
+  fail_unless_equals_int (g_array_index (batches, guint, 2), 4);
+  fail_if (gst_bus_have_pending (test_bus));
+
+  fail_unless (gst_bus_remove_watch (test_bus));
+  g_array_unref (batches);
+  gst_object_unref (test_bus);
+}
+
+GST_END_TEST;
+
 /* test if adding a signal watch for different message types calls the
  * respective callbacks. */
 GST_START_TEST (test_watch_with_custom_context)
@@ -445,6 +491,142 @@ GST_START_TEST (test_timed_pop)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pollfd_created_late)
+{
+  GPollFD pollfd;
+  guint i;
+
+  test_bus = gst_bus_new ();
+
+  /* messages queued before the fd exists make it readable */
+  send_10_app_messages ();
+  gst_bus_get_pollfd (test_bus, &pollfd);
+  pollfd.events = G_IO_IN;
+  fail_unless_equals_int (g_poll (&pollfd, 1, 0), 1);
+
+  for (i = 0; i < 10; i++)
+    gst_message_unref (gst_bus_timed_pop (test_bus, GST_CLOCK_TIME_NONE));
+  fail_if (gst_bus_have_pending (test_bus), "unexpected messages on bus");
+  fail_unless_equals_int (g_poll (&pollfd, 1, 0), 0);
+
+  send_10_app_messages ();
+  fail_unless_equals_int (g_poll (&pollfd, 1, 0), 1);
+  for (i = 0; i < 10; i++)
+    gst_message_unref (gst_bus_pop (test_bus));
+  fail_unless_equals_int (g_poll (&pollfd, 1, 0), 0);
+
+  gst_object_unref (test_bus);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_message_types)
+{
+  GstElement *pipeline, *bin, *element;
+  GstMessage *msg;
+
+  test_bus = gst_bus_new ();
+  gst_bus_set_message_types (test_bus, GST_MESSAGE_ERROR | GST_MESSAGE_EOS);
+  fail_unless_equals_int (gst_bus_get_message_types (test_bus),
+      GST_MESSAGE_ERROR | GST_MESSAGE_EOS);
+
+  /* filtered messages are dropped */
+  fail_unless (gst_bus_post (test_bus,
+          gst_message_new_application (NULL,
+              gst_structure_new_empty ("test"))));
+  fail_if (gst_bus_have_pending (test_bus));
+  fail_unless (gst_bus_post (test_bus, gst_message_new_eos (NULL)));
+  msg = gst_bus_pop (test_bus);
+  fail_unless (msg != NULL);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (test_bus);
+
+  /* elements in bins see the types of the bus of the pipeline */
+  pipeline = gst_pipeline_new (NULL);
+  bin = gst_bin_new (NULL);
+  element = gst_element_factory_make ("fakesrc", NULL);
+  gst_bin_add (GST_BIN (bin), element);
+  gst_bin_add (GST_BIN (pipeline), bin);
+
+  fail_unless (gst_element_accepts_message_type (element,
+          GST_MESSAGE_BUFFERING));
+  test_bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  gst_bus_set_message_types (test_bus, GST_MESSAGE_ERROR);
+  fail_if (gst_element_accepts_message_type (element, GST_MESSAGE_BUFFERING));
+  fail_if (gst_element_accepts_message_type (bin, GST_MESSAGE_BUFFERING));
+  /* message the bins use themselves */
+  fail_unless (gst_element_accepts_message_type (element, GST_MESSAGE_EOS));
+  fail_unless (gst_element_accepts_message_type (element, GST_MESSAGE_ERROR));
+
+  gst_element_post_message (element,
+      gst_message_new_buffering (GST_OBJECT (element), 50));
+  fail_if (gst_bus_have_pending (test_bus));
+
+  gst_object_unref (test_bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_coalesce_types)
+{
+  GstElement *element;
+  GstMessage *msg;
+  gint percent;
+
+  test_bus = gst_bus_new ();
+  element = gst_element_factory_make ("fakesrc", NULL);
+  gst_bus_set_coalesce_types (test_bus, GST_MESSAGE_BUFFERING);
+  fail_unless_equals_int (gst_bus_get_coalesce_types (test_bus),
+      GST_MESSAGE_BUFFERING);
+
+  gst_bus_post (test_bus,
+      gst_message_new_buffering (GST_OBJECT (element), 10));
+  gst_bus_post (test_bus, gst_message_new_eos (GST_OBJECT (element)));
+  gst_bus_post (test_bus,
+      gst_message_new_buffering (GST_OBJECT (element), 20));
+  gst_bus_post (test_bus,
+      gst_message_new_buffering (GST_OBJECT (element), 30));
+
+  /* the queued message got the newest percentage */
+  msg = gst_bus_pop (test_bus);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_BUFFERING);
+  gst_message_parse_buffering (msg, &percent);
+  fail_unless_equals_int (percent, 30);
+  gst_message_unref (msg);
+
+  msg = gst_bus_pop (test_bus);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  fail_if (gst_bus_have_pending (test_bus));
+
+  /* the popped message is not replaced anymore, neither are peeked ones */
+  gst_bus_post (test_bus,
+      gst_message_new_buffering (GST_OBJECT (element), 40));
+  msg = gst_bus_peek (test_bus);
+  gst_bus_post (test_bus,
+      gst_message_new_buffering (GST_OBJECT (element), 50));
+  gst_message_parse_buffering (msg, &percent);
+  fail_unless_equals_int (percent, 40);
+  gst_message_unref (msg);
+
+  msg = gst_bus_pop (test_bus);
+  gst_message_parse_buffering (msg, &percent);
+  fail_unless_equals_int (percent, 40);
+  gst_message_unref (msg);
+  msg = gst_bus_pop (test_bus);
+  gst_message_parse_buffering (msg, &percent);
+  fail_unless_equals_int (percent, 50);
+  gst_message_unref (msg);
+  fail_if (gst_bus_have_pending (test_bus));
+
+  gst_object_unref (element);
+  gst_object_unref (test_bus);
+}
+
+GST_END_TEST;
+
 typedef struct
 {
   GstDevice device;
@@ -820,11 +1002,15 @@ gst_bus_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_hammer_bus);
   tcase_add_test (tc_chain, test_watch);
+  tcase_add_test (tc_chain, test_batch_watch);
   tcase_add_test (tc_chain, test_watch_with_poll);
   tcase_add_test (tc_chain, test_watch_with_custom_context);
   tcase_add_test (tc_chain, test_add_watch_with_custom_context);
   tcase_add_test (tc_chain, test_remove_watch);
   tcase_add_test (tc_chain, test_timed_pop);
+  tcase_add_test (tc_chain, test_pollfd_created_late);
+  tcase_add_test (tc_chain, test_message_types);
+  tcase_add_test (tc_chain, test_coalesce_types);
   tcase_add_test (tc_chain, test_timed_pop_thread);
   tcase_add_test (tc_chain, test_timed_pop_filtered);
   tcase_add_test (tc_chain, test_timed_pop_filtered_with_timeout);
@@ -101,6 +101,7 @@ GST_END_TEST;
 GST_START_TEST (test_static_caps)
 {
   static GstStaticCaps scaps = GST_STATIC_CAPS ("audio/x-raw,rate=44100");
+  static GstStaticCaps scaps2 = GST_STATIC_CAPS ("audio/x-raw,rate=44100");
   GstCaps *caps1;
   GstCaps *caps2;
   static GstStaticCaps sany = GST_STATIC_CAPS_ANY;
@@ -123,6 +124,15 @@ GST_START_TEST (test_static_caps)
   gst_caps_unref (caps1);
   gst_caps_unref (caps2);
 
+  /* static caps with the same string share the caps */
+  caps1 = gst_static_caps_get (&scaps);
+  caps2 = gst_static_caps_get (&scaps2);
+  fail_unless (caps1 == caps2);
+  fail_unless (gst_caps_is_subset (caps1, caps2));
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+  gst_static_caps_cleanup (&scaps2);
+
   caps1 = gst_static_caps_get (&sany);
   fail_unless (gst_caps_is_equal (caps1, GST_CAPS_ANY));
   caps2 = gst_static_caps_get (&snone);
@@ -274,7 +284,7 @@ GST_END_TEST;
 
 GST_START_TEST (test_truncate)
 {
-  GstCaps *caps;
+  GstCaps *caps, *caps2;
 
   caps = gst_caps_from_string (non_simple_caps_string);
   fail_unless (caps != NULL,
@@ -283,6 +293,64 @@ GST_START_TEST (test_truncate)
   caps = gst_caps_truncate (caps);
   fail_unless_equals_int (gst_caps_get_size (caps), 1);
   gst_caps_unref (caps);
+
+  /* shared caps are not modified */
+  caps = gst_caps_from_string (non_simple_caps_string);
+  caps2 = gst_caps_ref (caps);
+  caps2 = gst_caps_truncate (caps2);
+  fail_unless (caps2 != caps);
+  fail_unless_equals_int (gst_caps_get_size (caps), 4);
+  fail_unless_equals_int (gst_caps_get_size (caps2), 1);
+  fail_unless (gst_structure_is_equal (gst_caps_get_structure (caps, 0),
+          gst_caps_get_structure (caps2, 0)));
+  gst_caps_unref (caps2);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_simplify_runs)
+{
+  static const gchar *formats[] = { "I420", "YV12", "YUY2", "NV12", "NV21" };
+  const GValue *val;
+  GstCaps *caps;
+  guint i;
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    gst_caps_append_structure (caps, gst_structure_new ("video/x-raw",
+            "format", G_TYPE_STRING, formats[i], "width", G_TYPE_INT, 320,
+            "height", G_TYPE_INT, 240, NULL));
+    /* duplicates are dropped */
+    gst_caps_append_structure (caps, gst_structure_new ("video/x-raw",
+            "format", G_TYPE_STRING, formats[i], "width", G_TYPE_INT, 320,
+            "height", G_TYPE_INT, 240, NULL));
+  }
+  gst_caps_append_structure (caps, gst_structure_new ("video/x-raw",
+          "format", G_TYPE_STRING, "I420", "width", G_TYPE_INT, 640,
+          "height", G_TYPE_INT, 480, NULL));
+
+  caps = gst_caps_simplify (caps);
+  GST_DEBUG ("simplified %" GST_PTR_FORMAT, caps);
+  fail_unless_equals_int (gst_caps_get_size (caps), 2);
+
+  for (i = 0; i < 2; i++) {
+    GstStructure *s = gst_caps_get_structure (caps, i);
+    gint width;
+
+    fail_unless (gst_structure_get_int (s, "width", &width));
+    val = gst_structure_get_value (s, "format");
+    if (width == 320) {
+      fail_unless (GST_VALUE_HOLDS_LIST (val));
+      fail_unless_equals_int (gst_value_list_get_size (val),
+          G_N_ELEMENTS (formats));
+    } else {
+      fail_unless_equals_int (width, 640);
+      fail_unless_equals_string (g_value_get_string (val), "I420");
+    }
+  }
+
+  gst_caps_unref (caps);
 }
 
 GST_END_TEST;
@@ -1386,6 +1454,41 @@ GST_START_TEST (test_filter_and_map_in_place)
 
 GST_END_TEST;
 
+GST_START_TEST (test_binary)
+{
+  GstCaps *caps, *caps2;
+  guint8 *data;
+  gsize size;
+
+  caps = gst_caps_from_string ("video/x-raw(memory:SystemMemory, meta:Foo), "
+      "format = (string) { I420, YUY2 }, width = (int) [ 16, 4096 ], "
+      "framerate = (fraction) [ 0/1, 2147483647/1 ]; audio/x-raw, "
+      "channels = (int) 2, layout = (string) < interleaved >");
+  data = gst_caps_to_binary (caps, &size);
+  fail_unless (data != NULL);
+  caps2 = gst_caps_from_binary (data, size);
+  fail_unless (caps2 != NULL);
+  fail_unless (gst_caps_is_strictly_equal (caps, caps2));
+  fail_unless (gst_caps_from_binary (data, size - 1) == NULL);
+  g_free (data);
+  gst_caps_unref (caps);
+  gst_caps_unref (caps2);
+
+  data = gst_caps_to_binary (GST_CAPS_ANY, &size);
+  caps2 = gst_caps_from_binary (data, size);
+  fail_unless (gst_caps_is_any (caps2));
+  g_free (data);
+  gst_caps_unref (caps2);
+
+  data = gst_caps_to_binary (GST_CAPS_NONE, &size);
+  caps2 = gst_caps_from_binary (data, size);
+  fail_unless (gst_caps_is_empty (caps2));
+  g_free (data);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_caps_suite (void)
 {
@@ -1398,6 +1501,7 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_mutability);
   tcase_add_test (tc_chain, test_static_caps);
   tcase_add_test (tc_chain, test_simplify);
+  tcase_add_test (tc_chain, test_simplify_runs);
   tcase_add_test (tc_chain, test_truncate);
   tcase_add_test (tc_chain, test_subset);
   tcase_add_test (tc_chain, test_subset_duplication);
@@ -1420,6 +1524,7 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_foreach);
   tcase_add_test (tc_chain, test_map_in_place);
   tcase_add_test (tc_chain, test_filter_and_map_in_place);
+  tcase_add_test (tc_chain, test_binary);
 
   return s;
 }
@@ -0,0 +1,290 @@
+/* GStreamer
+ *
+ * unit test for the caps cache, GST_CAPS_CACHE_SIZE is set before gst_init()
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#define CAPS_CACHE_SIZE 16
+
+#define CAPS1 \
+    "video/x-raw, format=(string){ I420, YV12 }, width=(int)[ 1, 100 ]"
+#define CAPS2 "video/x-raw, format=(string)I420, width=(int)[ 50, 200 ]"
+
+static void
+check_caps_string (GstCaps * caps, const gchar * str)
+{
+  GstCaps *expected = gst_caps_from_string (str);
+
+  fail_unless (gst_caps_is_equal (caps, expected),
+      "caps %" GST_PTR_FORMAT " are not %" GST_PTR_FORMAT, caps, expected);
+  gst_caps_unref (expected);
+}
+
+GST_START_TEST (test_cache_hit)
+{
+  GstCaps *caps1, *caps2, *res1, *res2;
+  gboolean can1, can2;
+
+  caps1 = gst_caps_from_string (CAPS1);
+  caps2 = gst_caps_from_string (CAPS2);
+  /* only caps that are not writable are cached */
+  gst_caps_ref (caps1);
+  gst_caps_ref (caps2);
+
+  /* the second intersection returns the cached result */
+  res1 = gst_caps_intersect (caps1, caps2);
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_unless (res1 == res2);
+  fail_if (gst_caps_is_writable (res1));
+  check_caps_string (res1, "video/x-raw, format=(string)I420, "
+      "width=(int)[ 50, 100 ]");
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  /* the other intersection mode has its own entry */
+  res1 = gst_caps_intersect_full (caps1, caps2, GST_CAPS_INTERSECT_FIRST);
+  res2 = gst_caps_intersect_full (caps1, caps2, GST_CAPS_INTERSECT_FIRST);
+  fail_unless (res1 == res2);
+  check_caps_string (res1, "video/x-raw, format=(string)I420, "
+      "width=(int)[ 50, 100 ]");
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  /* boolean results are cached as well */
+  can1 = gst_caps_can_intersect (caps1, caps2);
+  can2 = gst_caps_can_intersect (caps1, caps2);
+  fail_unless (can1 && can2);
+  fail_if (gst_caps_is_subset (caps1, caps2));
+  fail_if (gst_caps_is_subset (caps1, caps2));
+  fail_unless (gst_caps_is_subset (caps2, caps2));
+
+  /* looking at a structure of caps that are not writable keeps the entries */
+  fail_unless (gst_caps_get_structure (caps1, 0) != NULL);
+  res1 = gst_caps_intersect (caps1, caps2);
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_unless (res1 == res2);
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_cache_invalidate)
+{
+  GstCaps *caps1, *caps2, *res1, *res2;
+  GstStructure *s;
+
+  caps1 = gst_caps_from_string (CAPS1);
+  caps2 = gst_caps_from_string (CAPS2);
+  gst_caps_ref (caps1);
+  gst_caps_ref (caps2);
+
+  res1 = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_can_intersect (caps1, caps2));
+  fail_if (gst_caps_is_subset (caps1, caps2));
+
+  /* with a single ref the caps are writable again and can be changed in
+   * place through the structure, which drops the cached results */
+  gst_caps_unref (caps1);
+  fail_unless (gst_caps_is_writable (caps1));
+  s = gst_caps_get_structure (caps1, 0);
+  gst_structure_set (s, "width", GST_TYPE_INT_RANGE, 60, 70, NULL);
+  gst_caps_ref (caps1);
+
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_if (res1 == res2);
+  check_caps_string (res1, "video/x-raw, format=(string)I420, "
+      "width=(int)[ 50, 100 ]");
+  check_caps_string (res2, "video/x-raw, format=(string)I420, "
+      "width=(int)[ 60, 70 ]");
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  /* the boolean results are recomputed too */
+  gst_caps_unref (caps1);
+  s = gst_caps_get_structure (caps1, 0);
+  gst_structure_set (s, "format", G_TYPE_STRING, "YV12", NULL);
+  gst_caps_ref (caps1);
+  fail_if (gst_caps_can_intersect (caps1, caps2));
+
+  gst_caps_unref (caps1);
+  s = gst_caps_get_structure (caps1, 0);
+  gst_structure_set (s, "format", G_TYPE_STRING, "I420", NULL);
+  gst_caps_ref (caps1);
+  fail_unless (gst_caps_is_subset (caps1, caps2));
+
+  /* appending changes the caps as well */
+  gst_caps_unref (caps1);
+  gst_caps_append (caps1, gst_caps_from_string ("audio/x-raw"));
+  gst_caps_ref (caps1);
+  fail_if (gst_caps_is_subset (caps1, caps2));
+
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_cache_writable)
+{
+  GstCaps *caps1, *caps2, *copy, *res1, *res2;
+  GstStructure *s;
+
+  caps1 = gst_caps_from_string (CAPS1);
+  caps2 = gst_caps_from_string (CAPS2);
+
+  /* writable caps are never cached, the results are new caps */
+  res1 = gst_caps_intersect (caps1, caps2);
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_if (res1 == res2);
+  fail_unless (gst_caps_is_writable (res1));
+  fail_unless (gst_caps_is_equal (res1, res2));
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  /* one writable input is enough */
+  gst_caps_ref (caps1);
+  res1 = gst_caps_intersect (caps1, caps2);
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_if (res1 == res2);
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  /* a copy of cached caps is not cached and can be changed without
+   * affecting the result of the original */
+  gst_caps_ref (caps2);
+  res1 = gst_caps_intersect (caps1, caps2);
+  copy = gst_caps_copy (caps1);
+  fail_unless (gst_caps_is_writable (copy));
+  s = gst_caps_get_structure (copy, 0);
+  gst_structure_set (s, "width", GST_TYPE_INT_RANGE, 60, 70, NULL);
+  res2 = gst_caps_intersect (copy, caps2);
+  check_caps_string (res2, "video/x-raw, format=(string)I420, "
+      "width=(int)[ 60, 70 ]");
+  gst_caps_unref (res2);
+
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_unless (res1 == res2);
+  check_caps_string (res2, "video/x-raw, format=(string)I420, "
+      "width=(int)[ 50, 100 ]");
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  gst_caps_unref (copy);
+
+  /* make_writable() on shared caps copies them, the copy is not cached */
+  res1 = gst_caps_make_writable (gst_caps_ref (caps1));
+  fail_if (res1 == caps1);
+  s = gst_caps_get_structure (res1, 0);
+  gst_structure_set (s, "width", GST_TYPE_INT_RANGE, 60, 70, NULL);
+  res2 = gst_caps_intersect (caps1, caps2);
+  check_caps_string (res2, "video/x-raw, format=(string)I420, "
+      "width=(int)[ 50, 100 ]");
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_cache_eviction)
+{
+  GstCaps *caps1, *caps2, *res1, *res2;
+  GstCaps *others[CAPS_CACHE_SIZE];
+  gint i;
+
+  caps1 = gst_caps_from_string (CAPS1);
+  caps2 = gst_caps_from_string (CAPS2);
+  gst_caps_ref (caps1);
+  gst_caps_ref (caps2);
+
+  res1 = gst_caps_intersect (caps1, caps2);
+
+  /* fill the cache with other entries, the first result is evicted and a
+   * new one is computed. Freeing the other caps would remove their entries,
+   * so they are kept around until the end */
+  for (i = 0; i < CAPS_CACHE_SIZE; i++) {
+    GstCaps *res;
+
+    others[i] = gst_caps_new_simple ("video/x-raw", "width", G_TYPE_INT,
+        i + 1, NULL);
+    gst_caps_ref (others[i]);
+    res = gst_caps_intersect (others[i], caps1);
+    gst_caps_unref (res);
+  }
+
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_if (res1 == res2);
+  fail_unless (gst_caps_is_equal (res1, res2));
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+
+  for (i = 0; i < CAPS_CACHE_SIZE; i++) {
+    gst_caps_unref (others[i]);
+    gst_caps_unref (others[i]);
+  }
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_caps_cache_suite (void)
+{
+  Suite *s = suite_create ("GstCapsCache");
+  TCase *tc_chain = tcase_create ("operations");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_cache_hit);
+  tcase_add_test (tc_chain, test_cache_invalidate);
+  tcase_add_test (tc_chain, test_cache_writable);
+  tcase_add_test (tc_chain, test_cache_eviction);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  Suite *s;
+  gchar *size;
+
+  /* read by gst_init(), the cache is disabled by default */
+  size = g_strdup_printf ("%d", CAPS_CACHE_SIZE);
+  g_setenv ("GST_CAPS_CACHE_SIZE", size, TRUE);
+  g_free (size);
+
+  gst_check_init (&argc, &argv);
+  s = gst_caps_cache_suite ();
+  return gst_check_run_suite (s, "gst_caps_cache", __FILE__);
+}
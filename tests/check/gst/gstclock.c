@@ -111,6 +111,95 @@ GST_START_TEST (test_set_master_refcount)
 
 GST_END_TEST;
 
+GST_START_TEST (test_id_rearm)
+{
+  GstClock *clock, *other;
+  GstClockID id = NULL, prev;
+  GstClockTimeDiff jitter;
+
+  clock = gst_system_clock_obtain ();
+  other = g_object_new (TYPE_TEST_CLOCK, "name", "TestClock", NULL);
+  gst_object_ref_sink (other);
+
+  /* a new id is made when there is none */
+  prev = gst_clock_single_shot_id_rearm (clock, &id, 10);
+  fail_unless (prev != NULL);
+  fail_unless (prev == id);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id), 10);
+
+  /* the id is reused after waiting */
+  fail_unless_equals_int (gst_clock_id_wait (id, &jitter), GST_CLOCK_EARLY);
+  fail_unless (gst_clock_single_shot_id_rearm (clock, &id, 20) == prev);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id), 20);
+  fail_unless_equals_int (gst_clock_id_wait (id, &jitter), GST_CLOCK_EARLY);
+
+  /* and after unscheduling */
+  gst_clock_id_unschedule (id);
+  fail_unless (gst_clock_periodic_id_rearm (clock, &id, 30, 5) == prev);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id), 30);
+  fail_unless_equals_int (gst_clock_id_wait (id, &jitter), GST_CLOCK_EARLY);
+
+  /* a different clock needs a new id */
+  gst_clock_single_shot_id_rearm (other, &id, 40);
+  fail_unless (GST_CLOCK_ENTRY_CLOCK ((GstClockEntry *) id) == other);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id), 40);
+
+  gst_clock_id_unref (id);
+  gst_object_unref (other);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_observations)
+{
+  GstClock *clock;
+  GstClockTime internal, external, rate_num, rate_denom;
+  GstStructure *stats;
+  gdouble r_squared, rate;
+  guint i, n;
+
+  clock = g_object_new (TYPE_TEST_CLOCK, "window-size", 8,
+      "window-threshold", 4, NULL);
+
+  g_object_get (clock, "statistics", &stats, NULL);
+  fail_unless (gst_structure_get_uint (stats, "n-observations", &n));
+  fail_unless_equals_int (n, 0);
+  gst_structure_free (stats);
+
+  /* the master runs twice as fast, with an offset of 10 seconds, and the
+   * window slides over the observations several times */
+  for (i = 0; i < 100; i++) {
+    GstClockTime slave = 1000 * GST_SECOND + i * 100 * GST_MSECOND;
+    GstClockTime master = 10 * GST_SECOND + 2 * (slave - 1000 * GST_SECOND);
+    gboolean ret;
+
+    ret = gst_clock_add_observation_unapplied (clock, slave, master,
+        &r_squared, &internal, &external, &rate_num, &rate_denom);
+    if (i < 3) {
+      fail_if (ret);
+      continue;
+    }
+    fail_unless (ret);
+
+    fail_unless_equals_uint64 (internal, slave);
+    fail_unless_equals_uint64 (external, master);
+    fail_unless (ABS ((gdouble) rate_num / rate_denom - 2.0) < 1e-9);
+    fail_unless (r_squared > 0.999999);
+  }
+
+  g_object_get (clock, "statistics", &stats, NULL);
+  fail_unless (gst_structure_get_uint (stats, "n-observations", &n));
+  fail_unless_equals_int (n, 8);
+  fail_unless (gst_structure_get_double (stats, "rate", &rate));
+  fail_unless (ABS (rate - 2.0) < 1e-9);
+  gst_structure_free (stats);
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_clock_suite (void)
 {
@@ -119,6 +208,8 @@ gst_clock_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_set_master_refcount);
+  tcase_add_test (tc_chain, test_id_rearm);
+  tcase_add_test (tc_chain, test_observations);
 
   return s;
 }
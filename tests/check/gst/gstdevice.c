@@ -541,6 +541,64 @@ GST_START_TEST (test_device_monitor)
 
 GST_END_TEST;
 
+GST_START_TEST (test_device_monitor_cached_devices)
+{
+  GstDeviceProvider *dp2;
+  GstDeviceMonitor *mon;
+  GstDevice *mydev, *probed;
+  GList *devs;
+
+  register_test_device_provider ();
+  register_test_device_provider_monitor ();
+
+  dp2 = gst_device_provider_factory_get_by_name ("testdeviceprovidermonitor");
+  probed = test_device_new ();
+  devices = g_list_append (NULL, gst_object_ref_sink (probed));
+
+  mon = gst_device_monitor_new ();
+  fail_unless (gst_device_monitor_add_filter (mon, "Test1", NULL) > 0);
+
+  /* both providers are started, only the probed one has a device */
+  fail_unless (gst_device_monitor_start (mon));
+  devs = gst_device_monitor_get_devices (mon);
+  fail_unless_equals_int (g_list_length (devs), 1);
+  fail_unless_equals_pointer (devs->data, probed);
+  g_list_free_full (devs, (GDestroyNotify) gst_object_unref);
+
+  /* the probe results are kept while the monitor is started */
+  g_list_free_full (devices, (GDestroyNotify) gst_object_unref);
+  devices = NULL;
+  devs = gst_device_monitor_get_devices (mon);
+  fail_unless_equals_int (g_list_length (devs), 1);
+  fail_unless_equals_pointer (devs->data, probed);
+  g_list_free_full (devs, (GDestroyNotify) gst_object_unref);
+
+  /* the devices of the monitored provider are added and removed */
+  mydev = test_device_new ();
+  gst_device_provider_device_add (dp2, mydev);
+  devs = gst_device_monitor_get_devices (mon);
+  fail_unless_equals_int (g_list_length (devs), 2);
+  fail_unless_equals_pointer (devs->data, probed);
+  fail_unless_equals_pointer (devs->next->data, mydev);
+  g_list_free_full (devs, (GDestroyNotify) gst_object_unref);
+
+  gst_device_provider_device_remove (dp2, mydev);
+  devs = gst_device_monitor_get_devices (mon);
+  fail_unless_equals_int (g_list_length (devs), 1);
+  fail_unless_equals_pointer (devs->data, probed);
+  g_list_free_full (devs, (GDestroyNotify) gst_object_unref);
+
+  /* probes again when stopped */
+  gst_device_monitor_stop (mon);
+  devs = gst_device_monitor_get_devices (mon);
+  fail_unless (devs == NULL);
+
+  gst_object_unref (mon);
+  gst_object_unref (dp2);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_device_suite (void)
@@ -554,6 +612,7 @@ gst_device_suite (void)
   tcase_add_test (tc_chain, test_device_provider);
   tcase_add_test (tc_chain, test_device_provider_monitor);
   tcase_add_test (tc_chain, test_device_monitor);
+  tcase_add_test (tc_chain, test_device_monitor_cached_devices);
 
   return s;
 }
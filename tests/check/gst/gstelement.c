@@ -907,6 +907,115 @@ GST_START_TEST (test_foreach_pad)
 
 GST_END_TEST;
 
+GST_START_TEST (test_iterate_pads_snapshot)
+{
+  GstElement *e;
+  GstPad *pad1, *pad2;
+  GstIterator *it, *it2;
+  GValue item = G_VALUE_INIT;
+
+  e = gst_element_factory_make ("fakesrc", NULL);
+  pad1 = gst_element_get_static_pad (e, "src");
+  pad2 = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_element_add_pad (e, pad2);
+
+  it = gst_element_iterate_pads_snapshot (e);
+  it2 = gst_element_iterate_pads_snapshot (e);
+
+  /* changes after the snapshot don't cause a resync */
+  gst_element_remove_pad (e, pad2);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_OK);
+  fail_unless (g_value_get_object (&item) == pad1);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_OK);
+  fail_unless (g_value_get_object (&item) == pad2);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_DONE);
+  g_value_reset (&item);
+  gst_iterator_free (it);
+
+  /* the removed pad is kept alive by the other iterator */
+  fail_unless_equals_int (gst_iterator_next (it2, &item), GST_ITERATOR_OK);
+  fail_unless_equals_int (gst_iterator_next (it2, &item), GST_ITERATOR_OK);
+  fail_unless (GST_IS_PAD (g_value_get_object (&item)));
+  g_value_reset (&item);
+  gst_iterator_free (it2);
+
+  it = gst_element_iterate_pads_snapshot (e);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_OK);
+  fail_unless (g_value_get_object (&item) == pad1);
+  fail_unless_equals_int (gst_iterator_next (it, &item), GST_ITERATOR_DONE);
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  ASSERT_OBJECT_REFCOUNT (pad1, "pad", 2);
+  gst_object_unref (pad1);
+  gst_object_unref (e);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_state_snapshot)
+{
+  GstElement *pipeline, *sink;
+  GstState state, pending;
+  guint32 seqnum, last_seqnum;
+
+  pipeline = gst_pipeline_new (NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+
+  fail_unless_equals_int (gst_element_get_state_snapshot (pipeline, &state,
+          &pending, &last_seqnum), GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (state, GST_STATE_NULL);
+  fail_unless_equals_int (pending, GST_STATE_VOID_PENDING);
+
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_READY),
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (gst_element_get_state_snapshot (sink, &state,
+          &pending, NULL), GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (state, GST_STATE_READY);
+  fail_unless_equals_int (pending, GST_STATE_VOID_PENDING);
+
+  /* the sink can't preroll without data, the change stays pending */
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (gst_element_get_state_snapshot (pipeline, &state,
+          &pending, &seqnum), GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (state, GST_STATE_READY);
+  fail_unless_equals_int (pending, GST_STATE_PAUSED);
+  fail_unless (seqnum != last_seqnum);
+  fail_unless_equals_int (gst_element_get_state_snapshot (sink, &state,
+          &pending, NULL), GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (state, GST_STATE_READY);
+  fail_unless_equals_int (pending, GST_STATE_PAUSED);
+
+  /* nothing changed, so the sequence number must stay the same */
+  last_seqnum = seqnum;
+  gst_element_get_state_snapshot (pipeline, NULL, NULL, &seqnum);
+  fail_unless_equals_int (seqnum, last_seqnum);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (gst_element_get_state_snapshot (pipeline, &state,
+          &pending, NULL), GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (state, GST_STATE_NULL);
+  fail_unless_equals_int (pending, GST_STATE_VOID_PENDING);
+
+  /* committing without a pending state only updates the return value */
+  GST_STATE_LOCK (sink);
+  fail_unless_equals_int (gst_element_continue_state (sink,
+          GST_STATE_CHANGE_NO_PREROLL), GST_STATE_CHANGE_NO_PREROLL);
+  GST_STATE_UNLOCK (sink);
+  fail_unless_equals_int (gst_element_get_state_snapshot (sink, &state,
+          &pending, NULL), GST_STATE_CHANGE_NO_PREROLL);
+  fail_unless_equals_int (state, GST_STATE_NULL);
+  fail_unless_equals_int (pending, GST_STATE_VOID_PENDING);
+
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+
 static Suite *
 gst_element_suite (void)
 {
@@ -923,6 +1032,8 @@ gst_element_suite (void)
   tcase_add_test (tc_chain, test_property_notify_message);
   tcase_add_test (tc_chain, test_request_pad_templates);
   tcase_add_test (tc_chain, test_foreach_pad);
+  tcase_add_test (tc_chain, test_state_snapshot);
+  tcase_add_test (tc_chain, test_iterate_pads_snapshot);
 
   return s;
 }
@@ -119,6 +119,50 @@ GST_START_TEST (test_can_sink_all_caps)
 
 GST_END_TEST;
 
+/* test that templates are matched by media type before intersecting */
+GST_START_TEST (test_can_sink_caps_media_type)
+{
+  GstElementFactory *factory;
+  GList *list, *filtered;
+  GstCaps *caps;
+
+  factory = setup_factory ();
+  fail_if (factory == NULL);
+
+  caps = gst_caps_new_empty_simple ("video/x-raw");
+  fail_if (gst_element_factory_can_sink_any_caps (factory, caps));
+  fail_if (gst_element_factory_can_sink_all_caps (factory, caps));
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("video/x-raw; audio/x-raw, channels = 2");
+  fail_unless (gst_element_factory_can_sink_any_caps (factory, caps));
+  fail_if (gst_element_factory_can_sink_all_caps (factory, caps));
+
+  list = g_list_prepend (NULL, factory);
+  filtered = gst_element_factory_list_filter (list, caps, GST_PAD_SINK, FALSE);
+  fail_unless_equals_int (g_list_length (filtered), 1);
+  gst_plugin_feature_list_free (filtered);
+  filtered = gst_element_factory_list_filter (list, caps, GST_PAD_SINK, TRUE);
+  fail_unless (filtered == NULL);
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("audio/x-raw, channels = 2");
+  filtered = gst_element_factory_list_filter (list, caps, GST_PAD_SINK, TRUE);
+  fail_unless_equals_int (g_list_length (filtered), 1);
+  gst_plugin_feature_list_free (filtered);
+  gst_caps_unref (caps);
+  g_list_free (list);
+
+  caps = gst_caps_new_any ();
+  fail_unless (gst_element_factory_can_sink_any_caps (factory, caps));
+  fail_if (gst_element_factory_can_sink_all_caps (factory, caps));
+  gst_caps_unref (caps);
+
+  g_object_unref (factory);
+}
+
+GST_END_TEST;
+
 /* check if the elementfactory of a class is filled (see #131079) */
 GST_START_TEST (test_class)
 {
@@ -164,6 +208,65 @@ GST_START_TEST (test_class)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pool)
+{
+  GstElementFactory *factory;
+  GstElement *element, *reused;
+  gboolean sync;
+  gchar *name;
+
+  factory = gst_element_factory_find ("fakesink");
+  fail_if (factory == NULL);
+
+  /* without a pool, elements are not kept */
+  fail_unless_equals_int (gst_element_factory_get_pool_size (factory), 0);
+  element = gst_object_ref_sink (gst_element_factory_create (factory, "a"));
+  fail_if (gst_element_recycle (element));
+
+  gst_element_factory_set_pool_size (factory, 1);
+  fail_unless_equals_int (gst_element_factory_get_pool_size (factory), 1);
+
+  element = gst_object_ref_sink (gst_element_factory_create (factory, "a"));
+  g_object_set (element, "sync", TRUE, NULL);
+  fail_unless_equals_int (gst_element_set_state (element, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+
+  /* only elements in the NULL state can be reset */
+  fail_if (gst_element_reset (element));
+  fail_unless_equals_int (gst_element_set_state (element, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* elements that are still referenced are not recycled */
+  gst_object_ref (element);
+  fail_if (gst_element_recycle (element));
+  ASSERT_OBJECT_REFCOUNT (element, "element", 1);
+
+  fail_unless (gst_element_recycle (element));
+
+  /* the recycled element is handed out again with default properties and a
+   * new name */
+  reused = gst_element_factory_create (factory, NULL);
+  fail_unless (reused == element);
+  fail_unless (g_object_is_floating (reused));
+  g_object_get (reused, "sync", &sync, "name", &name, NULL);
+  fail_if (sync);
+  fail_if (g_strcmp0 (name, "a") == 0);
+  g_free (name);
+
+  /* the pool is empty again */
+  element = gst_element_factory_create (factory, "b");
+  fail_if (element == reused);
+  gst_object_unref (element);
+
+  gst_object_ref_sink (reused);
+  fail_unless (gst_element_recycle (reused));
+  gst_element_factory_set_pool_size (factory, 0);
+
+  gst_object_unref (factory);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_element_factory_suite (void)
@@ -176,6 +279,8 @@ gst_element_factory_suite (void)
   tcase_add_test (tc_chain, test_create);
   tcase_add_test (tc_chain, test_can_sink_any_caps);
   tcase_add_test (tc_chain, test_can_sink_all_caps);
+  tcase_add_test (tc_chain, test_can_sink_caps_media_type);
+  tcase_add_test (tc_chain, test_pool);
 
   return s;
 }
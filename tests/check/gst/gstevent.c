@@ -696,6 +696,222 @@ GST_START_TEST (send_custom_events)
 
 GST_END_TEST;
 
+GST_START_TEST (test_binary)
+{
+  GstEvent *event, *event2;
+  GstQuery *query, *query2;
+  GstFormat format;
+  gint64 position;
+  guint8 *data;
+  gsize size;
+
+  event = gst_event_new_segment_done (GST_FORMAT_TIME, 5 * GST_SECOND);
+  gst_event_set_running_time_offset (event, GST_SECOND);
+  data = gst_event_to_binary (event, &size);
+  fail_unless (data != NULL);
+  event2 = gst_event_new_from_binary (data, size);
+  fail_unless (event2 != NULL);
+  g_free (data);
+
+  fail_unless_equals_int (GST_EVENT_TYPE (event2), GST_EVENT_SEGMENT_DONE);
+  fail_unless_equals_int (GST_EVENT_SEQNUM (event2), GST_EVENT_SEQNUM (event));
+  fail_unless_equals_int64 (gst_event_get_running_time_offset (event2),
+      GST_SECOND);
+  gst_event_parse_segment_done (event2, &format, &position);
+  fail_unless_equals_int (format, GST_FORMAT_TIME);
+  fail_unless_equals_int64 (position, 5 * GST_SECOND);
+  gst_event_unref (event);
+  gst_event_unref (event2);
+
+  /* events and queries are not mixed up */
+  query = gst_query_new_duration (GST_FORMAT_BYTES);
+  data = gst_query_to_binary (query, &size);
+  fail_unless (data != NULL);
+  fail_unless (gst_event_new_from_binary (data, size) == NULL);
+  query2 = gst_query_new_from_binary (data, size);
+  fail_unless (query2 != NULL);
+  fail_unless_equals_int (GST_QUERY_TYPE (query2), GST_QUERY_DURATION);
+  gst_query_parse_duration (query2, &format, NULL);
+  fail_unless_equals_int (format, GST_FORMAT_BYTES);
+  g_free (data);
+  gst_query_unref (query);
+  gst_query_unref (query2);
+}
+
+GST_END_TEST;
+
+/* the type follows the 6 byte header in event and query blobs */
+static void
+binary_set_type (guint8 * data, guint32 type)
+{
+  type = GUINT32_TO_LE (type);
+  memcpy (data + 6, &type, 4);
+}
+
+static gboolean
+binary_event_is_valid (GstEvent * event, GstEventType type)
+{
+  GstEvent *event2;
+  guint8 *data;
+  gsize size;
+
+  data = gst_event_to_binary (event, &size);
+  fail_unless (data != NULL);
+  gst_event_unref (event);
+  binary_set_type (data, type);
+  event2 = gst_event_new_from_binary (data, size);
+  g_free (data);
+
+  if (event2 == NULL)
+    return FALSE;
+  fail_unless_equals_int (GST_EVENT_TYPE (event2), type);
+  gst_event_unref (event2);
+  return TRUE;
+}
+
+static gboolean
+binary_query_is_valid (GstQuery * query, GstQueryType type,
+    gboolean strip_structure)
+{
+  GstQuery *query2;
+  guint8 *data;
+  gsize size;
+
+  data = gst_query_to_binary (query, &size);
+  fail_unless (data != NULL);
+  gst_query_unref (query);
+  binary_set_type (data, type);
+  if (strip_structure) {
+    /* header, type and a has_structure flag of 0 */
+    size = 6 + 4 + 1;
+    data[size - 1] = 0;
+  }
+  query2 = gst_query_new_from_binary (data, size);
+  g_free (data);
+
+  if (query2 == NULL)
+    return FALSE;
+  fail_unless_equals_int (GST_QUERY_TYPE (query2), type);
+  gst_query_unref (query2);
+  return TRUE;
+}
+
+GST_START_TEST (test_binary_invalid)
+{
+  GstSegment segment;
+  GstEvent *event;
+  const GstSegment *parsed;
+  guint8 *data;
+  gsize size;
+
+  /* a real segment event goes through */
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  segment.start = GST_SECOND;
+  data = gst_event_to_binary (gst_event_new_segment (&segment), &size);
+  fail_unless (data != NULL);
+  event = gst_event_new_from_binary (data, size);
+  fail_unless (event != NULL);
+  g_free (data);
+  gst_event_parse_segment (event, &parsed);
+  fail_unless_equals_int (parsed->format, GST_FORMAT_TIME);
+  fail_unless_equals_uint64 (parsed->start, GST_SECOND);
+  fail_unless (binary_event_is_valid (event, GST_EVENT_SEGMENT));
+
+  /* without a segment it would crash in gst_event_parse_segment() */
+  fail_unless (binary_event_is_valid (gst_event_new_eos (), GST_EVENT_EOS));
+  fail_if (binary_event_is_valid (gst_event_new_eos (), GST_EVENT_SEGMENT));
+
+  /* an unrelated segment structure */
+  segment.rate = 0.0;
+  fail_if (binary_event_is_valid (gst_event_new_custom
+          (GST_EVENT_CUSTOM_DOWNSTREAM, gst_structure_new ("GstEventSegment",
+                  "segment", GST_TYPE_SEGMENT, &segment, NULL)),
+          GST_EVENT_SEGMENT));
+
+  /* fields of the wrong type */
+  fail_if (binary_event_is_valid (gst_event_new_custom
+          (GST_EVENT_CUSTOM_DOWNSTREAM, gst_structure_new ("GstEventCaps",
+                  "caps", G_TYPE_STRING, "x", NULL)), GST_EVENT_CAPS));
+  fail_if (binary_event_is_valid (gst_event_new_custom
+          (GST_EVENT_CUSTOM_DOWNSTREAM, gst_structure_new_empty ("x")),
+          GST_EVENT_CAPS));
+
+  /* unknown types are rejected */
+  fail_if (binary_event_is_valid (gst_event_new_eos (),
+          GST_EVENT_MAKE_TYPE (1000, GST_EVENT_TYPE_DOWNSTREAM)));
+
+  /* custom events need a structure */
+  fail_unless (binary_event_is_valid (gst_event_new_custom
+          (GST_EVENT_CUSTOM_DOWNSTREAM, gst_structure_new_empty ("x")),
+          GST_EVENT_CUSTOM_UPSTREAM));
+  fail_if (binary_event_is_valid (gst_event_new_eos (),
+          GST_EVENT_CUSTOM_DOWNSTREAM));
+
+  /* queries have the same checks */
+  fail_unless (binary_query_is_valid (gst_query_new_drain (),
+          GST_QUERY_DRAIN, FALSE));
+  fail_if (binary_query_is_valid (gst_query_new_drain (),
+          GST_QUERY_DRAIN, TRUE));
+  fail_if (binary_query_is_valid (gst_query_new_drain (),
+          GST_QUERY_DURATION, FALSE));
+  fail_if (binary_query_is_valid (gst_query_new_duration (GST_FORMAT_TIME),
+          GST_QUERY_ACCEPT_CAPS, FALSE));
+  fail_if (binary_query_is_valid (gst_query_new_duration (GST_FORMAT_TIME),
+          GST_QUERY_MAKE_TYPE (1000, 0), FALSE));
+  fail_unless (binary_query_is_valid (gst_query_new_custom (GST_QUERY_CUSTOM,
+              gst_structure_new_empty ("x")), GST_QUERY_CUSTOM, FALSE));
+  fail_if (binary_query_is_valid (gst_query_new_custom (GST_QUERY_CUSTOM,
+              gst_structure_new_empty ("x")), GST_QUERY_CUSTOM, TRUE));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_lazy_structure)
+{
+  GstEvent *event, *copy;
+  GstSegment segment;
+  const GstSegment *parsed;
+  const GstStructure *s;
+  GstStructure *ws;
+  GstClockTime latency;
+  GstClockTimeDiff diff;
+  gdouble proportion;
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  segment.start = GST_SECOND;
+  event = gst_event_new_segment (&segment);
+  gst_event_parse_segment (event, &parsed);
+  fail_unless_equals_uint64 (parsed->start, GST_SECOND);
+
+  /* the structure has the same values */
+  s = gst_event_get_structure (event);
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_has_name (s, "GstEventSegment"));
+  gst_event_parse_segment (event, &parsed);
+  fail_unless_equals_uint64 (parsed->start, GST_SECOND);
+  fail_unless (gst_event_get_structure (event) == s);
+  gst_event_unref (event);
+
+  event = gst_event_new_qos (GST_QOS_TYPE_UNDERFLOW, 0.5, -10, 20);
+  copy = gst_event_copy (event);
+  gst_event_unref (event);
+  gst_event_parse_qos (copy, NULL, &proportion, &diff, NULL);
+  fail_unless (proportion == 0.5);
+  fail_unless_equals_int64 (diff, -10);
+  fail_unless (gst_event_has_name (copy, "GstEventQOS"));
+  gst_event_unref (copy);
+
+  /* changes to the structure are visible when parsing */
+  event = gst_event_new_latency (GST_SECOND);
+  ws = gst_event_writable_structure (event);
+  gst_structure_set (ws, "latency", G_TYPE_UINT64, 2 * GST_SECOND, NULL);
+  gst_event_parse_latency (event, &latency);
+  fail_unless_equals_uint64 (latency, 2 * GST_SECOND);
+  gst_event_unref (event);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_event_suite (void)
 {
@@ -707,6 +923,9 @@ gst_event_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, create_events);
   tcase_add_test (tc_chain, send_custom_events);
+  tcase_add_test (tc_chain, test_binary);
+  tcase_add_test (tc_chain, test_binary_invalid);
+  tcase_add_test (tc_chain, test_lazy_structure);
   return s;
 }
 
@@ -0,0 +1,148 @@
+/* GStreamer
+ *
+ * gstfreelist.c: Unit test for the per-thread free-lists
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* gstfreelistdisabled.c runs these tests with the free-lists disabled */
+#ifndef FREE_LIST_SIZE
+#define FREE_LIST_SIZE 16
+#endif
+
+#define N_BUFFERS 100
+
+GST_START_TEST (test_recycle)
+{
+  guint64 hits, misses, overflows, hits2, misses2, overflows2;
+  GstBuffer *bufs[N_BUFFERS];
+  GstBuffer *buf, *prev;
+  gint i;
+
+  fail_if (gst_free_list_get_stats ("foo", NULL, NULL, NULL));
+  fail_unless (gst_free_list_get_stats ("buffer", &hits, &misses,
+          &overflows));
+
+  /* a freed buffer is handed out again to the same thread */
+  prev = gst_buffer_new ();
+  gst_buffer_unref (prev);
+  buf = gst_buffer_new ();
+  if (FREE_LIST_SIZE > 0)
+    fail_unless (buf == prev);
+  gst_buffer_unref (buf);
+
+  fail_unless (gst_free_list_get_stats ("buffer", &hits2, &misses2,
+          &overflows2));
+  if (FREE_LIST_SIZE > 0) {
+    fail_unless (hits2 >= hits + 1);
+  } else {
+    fail_unless_equals_uint64 (hits2, 0);
+    fail_unless_equals_uint64 (misses2, 0);
+  }
+
+  /* the free-list is bounded, the other blocks are released */
+  for (i = 0; i < N_BUFFERS; i++)
+    bufs[i] = gst_buffer_new ();
+  for (i = 0; i < N_BUFFERS; i++)
+    gst_buffer_unref (bufs[i]);
+
+  fail_unless (gst_free_list_get_stats ("buffer", NULL, NULL, &overflows));
+  if (FREE_LIST_SIZE > 0)
+    fail_unless (overflows >= overflows2 + N_BUFFERS - FREE_LIST_SIZE);
+  else
+    fail_unless_equals_uint64 (overflows, 0);
+}
+
+GST_END_TEST;
+
+static gpointer
+alloc_and_free_thread (gpointer data)
+{
+  GstBuffer *buf = data;
+
+  /* free a buffer of the main thread and reuse its block */
+  gst_buffer_unref (buf);
+  buf = gst_buffer_new ();
+  gst_buffer_unref (buf);
+
+  /* and give one to the main thread */
+  return gst_buffer_new ();
+}
+
+GST_START_TEST (test_free_other_thread)
+{
+  guint64 hits, hits2;
+  GstBuffer *buf;
+  GThread *thread;
+  GstEvent *event;
+
+  fail_unless (gst_free_list_get_stats ("buffer", &hits, NULL, NULL));
+
+  thread = g_thread_new ("free", alloc_and_free_thread, gst_buffer_new ());
+  buf = g_thread_join (thread);
+  fail_unless (GST_IS_BUFFER (buf));
+  gst_buffer_unref (buf);
+
+  /* the stats of the exited thread are kept */
+  fail_unless (gst_free_list_get_stats ("buffer", &hits2, NULL, NULL));
+  if (FREE_LIST_SIZE > 0)
+    fail_unless (hits2 >= hits + 1);
+  else
+    fail_unless_equals_uint64 (hits2, 0);
+
+  /* other types work the same */
+  event = gst_event_new_eos ();
+  gst_event_unref (event);
+  event = gst_event_new_flush_start ();
+  fail_unless (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_START);
+  gst_event_unref (event);
+  fail_unless (gst_free_list_get_stats ("event", &hits, NULL, NULL));
+  if (FREE_LIST_SIZE == 0)
+    fail_unless_equals_uint64 (hits, 0);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_free_list_suite (void)
+{
+  Suite *s = suite_create ("GstFreeList");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_recycle);
+  tcase_add_test (tc_chain, test_free_other_thread);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  gchar *size;
+  Suite *s;
+
+  /* read by gst_init(), this also overrides the default under valgrind */
+  size = g_strdup_printf ("%d", FREE_LIST_SIZE);
+  g_setenv ("GST_FREE_LIST_SIZE", size, TRUE);
+  g_free (size);
+
+  gst_check_init (&argc, &argv);
+  s = gst_free_list_suite ();
+  return gst_check_run_suite (s, "gst_free_list", __FILE__);
+}
@@ -1168,6 +1168,122 @@ GST_START_TEST (test_ghost_pads_remove_while_playing)
 
 GST_END_TEST;
 
+static GstFlowReturn
+count_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gint *count = g_object_get_data (G_OBJECT (pad), "count");
+
+  (*count)++;
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static GstPadProbeReturn
+count_probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  gint *count = data;
+
+  (*count)++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gpointer
+push_buffer_thread (GstPad * srcpad)
+{
+  return GINT_TO_POINTER (gst_pad_push (srcpad, gst_buffer_new ()));
+}
+
+GST_START_TEST (test_ghost_pads_push_through)
+{
+  GstElement *outer, *inner;
+  GstPad *srcpad, *sinkpad, *ghost1, *ghost2, *internal;
+  GstBufferList *list;
+  GstSegment segment;
+  gint count = 0, probe_count = 0;
+  GThread *thread;
+  gulong id;
+
+  /* srcpad ! outer:ghost1 ! inner:ghost2 ! sinkpad */
+  outer = gst_bin_new ("outer");
+  inner = gst_bin_new ("inner");
+  gst_bin_add (GST_BIN (outer), inner);
+
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  g_object_set_data (G_OBJECT (sinkpad), "count", &count);
+  gst_pad_set_chain_function (sinkpad, count_chain);
+  gst_element_add_pad (inner, sinkpad);
+
+  ghost2 = gst_ghost_pad_new ("sink", sinkpad);
+  gst_element_add_pad (inner, ghost2);
+  ghost1 = gst_ghost_pad_new ("sink", ghost2);
+  gst_element_add_pad (outer, ghost1);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (gst_pad_link (srcpad, ghost1) == GST_PAD_LINK_OK);
+
+  fail_unless (gst_pad_set_active (srcpad, TRUE));
+  gst_element_set_state (outer, GST_STATE_PLAYING);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  /* buffers and lists go through both ghost pads */
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (count, 1);
+
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, gst_buffer_new ());
+  gst_buffer_list_add (list, gst_buffer_new ());
+  fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+  fail_unless_equals_int (count, 3);
+
+  /* the stream lock of the ghost pads is still taken */
+  GST_PAD_STREAM_LOCK (ghost2);
+  thread = g_thread_new ("push", (GThreadFunc) push_buffer_thread, srcpad);
+  g_usleep (G_USEC_PER_SEC / 10);
+  fail_unless_equals_int (g_atomic_int_get (&count), 3);
+  GST_PAD_STREAM_UNLOCK (ghost2);
+  fail_unless_equals_int (GPOINTER_TO_INT (g_thread_join (thread)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (count, 4);
+
+  /* probes on the internal pad are still called */
+  internal = GST_PAD (gst_proxy_pad_get_internal (GST_PROXY_PAD (ghost2)));
+  id = gst_pad_add_probe (internal, GST_PAD_PROBE_TYPE_BUFFER, count_probe_cb,
+      &probe_count, NULL);
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (count, 5);
+  fail_unless_equals_int (probe_count, 1);
+  gst_pad_remove_probe (internal, id);
+  gst_object_unref (internal);
+
+  /* and so are probes on the ghost pads */
+  gst_pad_add_probe (ghost1, GST_PAD_PROBE_TYPE_BUFFER, count_probe_cb,
+      &probe_count, NULL);
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (count, 6);
+  fail_unless_equals_int (probe_count, 2);
+
+  /* flushing is not skipped */
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_flush_start ()));
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_FLUSHING);
+  fail_unless_equals_int (count, 6);
+
+  gst_element_set_state (outer, GST_STATE_NULL);
+  fail_unless (gst_pad_set_active (srcpad, FALSE));
+  gst_object_unref (srcpad);
+  gst_object_unref (outer);
+}
+
+GST_END_TEST;
 
 GST_START_TEST (test_activate_src)
 {
@@ -1346,6 +1462,7 @@ gst_ghost_pad_suite (void)
   tcase_add_test (tc_chain, test_ghost_pads_change_when_linked);
   tcase_add_test (tc_chain, test_ghost_pads_internal_link);
   tcase_add_test (tc_chain, test_ghost_pads_remove_while_playing);
+  tcase_add_test (tc_chain, test_ghost_pads_push_through);
 
   tcase_add_test (tc_chain, test_activate_src);
   tcase_add_test (tc_chain, test_activate_sink_and_src);
@@ -23,6 +23,9 @@
 #include <gst/check/gstcheck.h>
 
 #include <string.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
 
 #ifndef GST_DISABLE_GST_DEBUG
 
@@ -401,6 +404,174 @@ GST_START_TEST (info_set_and_unset_multiple)
   fail_unless (cat3 = GST_LEVEL_WARNING);
 }
 
+GST_END_TEST;
+
+GST_START_TEST (info_set_threshold_explicit)
+{
+  GstDebugLevel orig = gst_debug_get_default_threshold ();
+  GstDebugCategory *cat = NULL;
+
+  GST_DEBUG_CATEGORY_INIT (cat, "explicitcat", 0, "explicit threshold");
+  gst_debug_set_default_threshold (GST_LEVEL_WARNING);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_WARNING);
+
+  /* patterns that don't match keep the explicit threshold */
+  gst_debug_category_set_threshold (cat, GST_LEVEL_LOG);
+  gst_debug_set_threshold_for_name ("othercat*", GST_LEVEL_DEBUG);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_LOG);
+
+  /* a matching pattern overrides it */
+  gst_debug_set_threshold_for_name ("explicit*", GST_LEVEL_FIXME);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_FIXME);
+
+  /* and so does setting it again later */
+  gst_debug_category_set_threshold (cat, GST_LEVEL_INFO);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_INFO);
+  gst_debug_set_threshold_for_name ("othercat2*", GST_LEVEL_DEBUG);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_INFO);
+
+  /* resetting goes back to the patterns */
+  gst_debug_category_reset_threshold (cat);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_FIXME);
+
+  /* unsetting a pattern resets all thresholds */
+  gst_debug_category_set_threshold (cat, GST_LEVEL_LOG);
+  gst_debug_unset_threshold_for_name ("othercat*");
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_FIXME);
+  gst_debug_unset_threshold_for_name ("othercat2*");
+  gst_debug_unset_threshold_for_name ("explicit*");
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_WARNING);
+
+  /* and so does changing the default */
+  gst_debug_category_set_threshold (cat, GST_LEVEL_LOG);
+  gst_debug_set_default_threshold (GST_LEVEL_ERROR);
+  fail_unless_equals_int (gst_debug_category_get_threshold (cat),
+      GST_LEVEL_ERROR);
+
+  gst_debug_set_default_threshold (orig);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (info_async_logger)
+{
+  GstDebugCategory *cat = NULL;
+  guint i;
+
+  GST_DEBUG_CATEGORY_INIT (cat, "asynccat", 0, "async logger category");
+  gst_debug_category_set_threshold (cat, GST_LEVEL_LOG);
+
+  gst_debug_add_async_logger (4);
+  fail_unless_equals_int (gst_debug_async_logger_get_dropped (), 0);
+
+  for (i = 0; i < 100; i++)
+    GST_CAT_LOG (cat, "line %u", i);
+  fail_unless (gst_debug_async_logger_get_dropped () <= 100);
+
+  /* writes out the pending lines */
+  gst_debug_remove_async_logger ();
+  fail_unless_equals_int (gst_debug_async_logger_get_dropped (), 0);
+
+  gst_debug_category_reset_threshold (cat);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (info_binary_logger)
+{
+  GstDebugCategory *cat = NULL;
+  gchar *filename, *contents, *name;
+  gsize length;
+  gint fd;
+
+  fd = g_file_open_tmp (NULL, &filename, NULL);
+  fail_unless (fd >= 0);
+  close (fd);
+
+  GST_DEBUG_CATEGORY_INIT (cat, "binarycat", 0, "binary logger category");
+  gst_debug_category_set_threshold (cat, GST_LEVEL_LOG);
+
+  fail_unless (gst_debug_add_binary_logger (filename));
+  fail_if (gst_debug_add_binary_logger (filename));
+  GST_CAT_LOG (cat, "first line");
+  GST_CAT_LOG (cat, "second line");
+  gst_debug_remove_binary_logger ();
+
+  gst_debug_category_reset_threshold (cat);
+
+  fail_unless (g_file_get_contents (filename, &contents, &length, NULL));
+  fail_unless (length > 8);
+  fail_unless (memcmp (contents, "GSTBLOG1", 8) == 0);
+  fail_unless (g_strstr_len (contents, length, "first line") != NULL);
+  /* the names are only written once */
+  name = g_strstr_len (contents, length, "binarycat");
+  fail_unless (name != NULL);
+  fail_if (g_strstr_len (name + 1, length - (name + 1 - contents),
+          "binarycat"));
+
+  g_unlink (filename);
+  g_free (filename);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (info_caps_description)
+{
+  GstCaps *caps, *ref;
+  gchar *long_str;
+
+  gst_debug_remove_log_function (gst_debug_log_default);
+  gst_debug_add_log_function (printf_extension_log_func, NULL, NULL);
+  gst_debug_set_default_threshold (GST_LEVEL_LOG);
+  save_messages = TRUE;
+
+  caps = gst_caps_new_simple ("foo/bar", "width", G_TYPE_INT, 320, NULL);
+
+  /* the description of shared caps is kept */
+  ref = gst_caps_ref (caps);
+  GST_LOG ("%" GST_PTR_FORMAT, caps);
+  GST_LOG ("%" GST_PTR_FORMAT, caps);
+  gst_caps_unref (ref);
+
+  /* and forgotten when the caps are modified */
+  gst_caps_set_simple (caps, "width", G_TYPE_INT, 640, NULL);
+  ref = gst_caps_ref (caps);
+  GST_LOG ("%" GST_PTR_FORMAT, caps);
+  gst_caps_unref (ref);
+  gst_caps_unref (caps);
+
+  /* messages that don't fit in the message buffer */
+  long_str = g_strnfill (1000, 'x');
+  GST_LOG ("%s", long_str);
+
+  fail_unless_equals_int (g_list_length (messages), 4);
+  fail_unless_equals_string (g_list_nth_data (messages, 0),
+      "foo/bar, width=(int)320");
+  fail_unless_equals_string (g_list_nth_data (messages, 1),
+      "foo/bar, width=(int)320");
+  fail_unless_equals_string (g_list_nth_data (messages, 2),
+      "foo/bar, width=(int)640");
+  fail_unless_equals_string (g_list_nth_data (messages, 3), long_str);
+  g_free (long_str);
+
+  save_messages = FALSE;
+  g_list_free_full (messages, g_free);
+  messages = NULL;
+
+  gst_debug_set_default_threshold (GST_LEVEL_NONE);
+  gst_debug_remove_log_function (printf_extension_log_func);
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+}
+
 GST_END_TEST;
 #endif
 
@@ -442,6 +613,10 @@ gst_info_suite (void)
   tcase_add_test (tc_chain, info_register_same_debug_category_twice);
   tcase_add_test (tc_chain, info_set_and_unset_single);
   tcase_add_test (tc_chain, info_set_and_unset_multiple);
+  tcase_add_test (tc_chain, info_set_threshold_explicit);
+  tcase_add_test (tc_chain, info_async_logger);
+  tcase_add_test (tc_chain, info_binary_logger);
+  tcase_add_test (tc_chain, info_caps_description);
 #endif
 
   return s;
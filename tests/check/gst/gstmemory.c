@@ -446,6 +446,45 @@ GST_START_TEST (test_map_nested)
 
 GST_END_TEST;
 
+GST_START_TEST (test_map_unlocked_read)
+{
+  GstAllocator *alloc;
+  GstMemory *mem;
+  GstMapInfo info1, info2;
+
+  alloc = gst_allocator_find (NULL);
+  GST_OBJECT_FLAG_SET (alloc, GST_ALLOCATOR_FLAG_UNLOCKED_READ_MAP);
+  mem = gst_allocator_alloc (alloc, 100, NULL);
+
+  /* read maps leave the lock state alone */
+  fail_unless (gst_memory_map (mem, &info1, GST_MAP_READ));
+  fail_unless (gst_memory_map (mem, &info2, GST_MAP_READ));
+  fail_unless (info2.data == info1.data);
+  fail_unless_equals_int (GST_MINI_OBJECT_CAST (mem)->lockstate, 0);
+  gst_memory_unmap (mem, &info2);
+  gst_memory_unmap (mem, &info1);
+  fail_unless_equals_int (GST_MINI_OBJECT_CAST (mem)->lockstate, 0);
+
+  /* write maps still lock */
+  fail_unless (gst_memory_map (mem, &info1, GST_MAP_WRITE));
+  fail_if (GST_MINI_OBJECT_CAST (mem)->lockstate == 0);
+  fail_if (gst_memory_map (mem, &info2, GST_MAP_READWRITE));
+  gst_memory_unmap (mem, &info1);
+  fail_unless_equals_int (GST_MINI_OBJECT_CAST (mem)->lockstate, 0);
+
+  /* readonly memory can still not be mapped for writing */
+  GST_MINI_OBJECT_FLAG_SET (mem, GST_MEMORY_FLAG_READONLY);
+  fail_if (gst_memory_map (mem, &info1, GST_MAP_WRITE));
+  fail_unless (gst_memory_map (mem, &info1, GST_MAP_READ));
+  gst_memory_unmap (mem, &info1);
+
+  gst_memory_unref (mem);
+  GST_OBJECT_FLAG_UNSET (alloc, GST_ALLOCATOR_FLAG_UNLOCKED_READ_MAP);
+  gst_object_unref (alloc);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_map_resize)
 {
   GstMemory *mem;
@@ -537,6 +576,103 @@ GST_START_TEST (test_alloc_params)
 
 GST_END_TEST;
 
+GST_START_TEST (test_alloc_large_aligned)
+{
+  GstMemory *mem, *copy;
+  GstMapInfo info;
+  GstAllocationParams params;
+  gsize sizes[] = { 100, 512 * 1024, 4 * 1024 * 1024 };
+  guint i;
+
+  gst_allocation_params_init (&params);
+  params.align = 63;
+  params.prefix = 16;
+  params.padding = 16;
+  params.flags = GST_MEMORY_FLAG_ZERO_PREFIXED | GST_MEMORY_FLAG_ZERO_PADDED;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    gsize size, offset, maxalloc;
+
+    mem = gst_allocator_alloc (NULL, sizes[i], &params);
+    size = gst_memory_get_sizes (mem, &offset, &maxalloc);
+    fail_unless_equals_int (size, sizes[i]);
+    fail_unless_equals_int (offset, 16);
+    fail_unless (maxalloc >= sizes[i] + 32);
+
+    fail_unless (gst_memory_map (mem, &info, GST_MAP_READ));
+    fail_unless_equals_int (((guintptr) info.data - 16) & 63, 0);
+    fail_unless (info.data[-1] == 0);
+    fail_unless (info.data[size] == 0);
+    gst_memory_unmap (mem, &info);
+
+    /* copies keep the alignment */
+    copy = gst_memory_copy (mem, 0, -1);
+    fail_unless (gst_memory_map (copy, &info, GST_MAP_READ));
+    fail_unless_equals_int ((guintptr) info.data & 63, 0);
+    gst_memory_unmap (copy, &info);
+
+    gst_memory_unref (copy);
+    gst_memory_unref (mem);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_alloc_hugepage)
+{
+  GstAllocator *alloc;
+  GstMemory *mem, *sub;
+  GstMapInfo info;
+  GstAllocationParams params;
+  gsize sizes[] = { 100, 4 * 1024 * 1024 + 100 };
+  guint i;
+
+  alloc = gst_allocator_find (GST_ALLOCATOR_HUGEPAGE);
+  fail_unless (alloc != NULL);
+
+  gst_allocation_params_init (&params);
+  params.align = 63;
+  params.prefix = 16;
+  params.padding = 16;
+  params.flags = GST_MEMORY_FLAG_ZERO_PREFIXED | GST_MEMORY_FLAG_ZERO_PADDED;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    gsize size, offset, maxalloc;
+
+    mem = gst_allocator_alloc (alloc, sizes[i], &params);
+    fail_unless (mem != NULL);
+    /* small blocks, or when mapping fails, are system memory */
+    fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_HUGEPAGE)
+        || gst_memory_is_type (mem, GST_ALLOCATOR_SYSMEM));
+    if (sizes[i] < 1024)
+      fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_SYSMEM));
+
+    size = gst_memory_get_sizes (mem, &offset, &maxalloc);
+    fail_unless_equals_int (size, sizes[i]);
+    fail_unless_equals_int (offset, 16);
+    fail_unless (maxalloc >= sizes[i] + 32);
+
+    fail_unless (gst_memory_map (mem, &info, GST_MAP_READWRITE));
+    fail_unless_equals_int (((guintptr) info.data - 16) & 63, 0);
+    fail_unless (info.data[-1] == 0);
+    fail_unless (info.data[size] == 0);
+    memset (info.data, 0xaa, size);
+    gst_memory_unmap (mem, &info);
+
+    /* sharing keeps the memory alive */
+    sub = gst_memory_share (mem, 1, 10);
+    gst_memory_unref (mem);
+    fail_unless (gst_memory_map (sub, &info, GST_MAP_READ));
+    fail_unless (info.data[0] == 0xaa && info.data[9] == 0xaa);
+    gst_memory_unmap (sub, &info);
+    gst_memory_unref (sub);
+  }
+
+  gst_object_unref (alloc);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_lock)
 {
   GstMemory *mem;
@@ -754,8 +890,11 @@ gst_memory_suite (void)
   tcase_add_test (tc_chain, test_resize);
   tcase_add_test (tc_chain, test_map);
   tcase_add_test (tc_chain, test_map_nested);
+  tcase_add_test (tc_chain, test_map_unlocked_read);
   tcase_add_test (tc_chain, test_map_resize);
   tcase_add_test (tc_chain, test_alloc_params);
+  tcase_add_test (tc_chain, test_alloc_large_aligned);
+  tcase_add_test (tc_chain, test_alloc_hugepage);
   tcase_add_test (tc_chain, test_lock);
 #ifndef GST_DISABLE_GST_DEBUG
   tcase_add_test (tc_chain, test_no_error_and_no_warning_on_map_failure);
@@ -605,6 +605,85 @@ GST_START_TEST (test_parsing)
 
 GST_END_TEST;
 
+GST_START_TEST (test_lazy_structure)
+{
+  GstMessage *message, *copy;
+  const GstStructure *s;
+  GstFormat format;
+  guint64 processed, dropped, running_time;
+  gint64 jitter, left;
+  gdouble proportion;
+  gint quality, percent, avg_in, avg_out;
+  GstBufferingMode mode;
+
+  /* the values set before the structure exists end up in the structure */
+  message = gst_message_new_qos (NULL, TRUE, 1, 2, 3, 4);
+  gst_message_set_qos_values (message, -5, 0.5, 100);
+  gst_message_set_qos_stats (message, GST_FORMAT_BUFFERS, 10, 20);
+
+  copy = gst_message_copy (message);
+  gst_message_parse_qos_values (copy, &jitter, &proportion, &quality);
+  fail_unless_equals_int64 (jitter, -5);
+  fail_unless (proportion == 0.5);
+  fail_unless_equals_int (quality, 100);
+  gst_message_unref (copy);
+
+  s = gst_message_get_structure (message);
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_has_name (s, "GstMessageQOS"));
+  fail_unless (gst_structure_get_uint64 (s, "running-time", &running_time));
+  fail_unless_equals_uint64 (running_time, 1);
+  fail_unless (gst_structure_get_int64 (s, "jitter", &jitter));
+  fail_unless_equals_int64 (jitter, -5);
+  fail_unless (gst_structure_get_uint64 (s, "dropped", &dropped));
+  fail_unless_equals_uint64 (dropped, 20);
+  fail_unless (gst_message_get_structure (message) == s);
+
+  /* after that the structure has the values */
+  gst_message_set_qos_stats (message, GST_FORMAT_BUFFERS, 11, 21);
+  gst_message_parse_qos_stats (message, &format, &processed, &dropped);
+  fail_unless_equals_int (format, GST_FORMAT_BUFFERS);
+  fail_unless_equals_uint64 (processed, 11);
+  fail_unless_equals_uint64 (dropped, 21);
+  fail_unless (gst_structure_get_uint64 (s, "processed", &processed));
+  fail_unless_equals_uint64 (processed, 11);
+  gst_message_unref (message);
+
+  message = gst_message_new_buffering (NULL, 50);
+  gst_message_set_buffering_stats (message, GST_BUFFERING_DOWNLOAD, 1, 2, 3);
+  fail_unless (gst_message_has_name (message, "GstMessageBuffering"));
+  gst_message_parse_buffering (message, &percent);
+  fail_unless_equals_int (percent, 50);
+  gst_message_parse_buffering_stats (message, &mode, &avg_in, &avg_out, &left);
+  fail_unless_equals_int (mode, GST_BUFFERING_DOWNLOAD);
+  fail_unless_equals_int (avg_in, 1);
+  fail_unless_equals_int (avg_out, 2);
+  fail_unless_equals_int64 (left, 3);
+
+  /* extra fields can be added next to the lazily filled ones */
+  gst_structure_set (gst_message_writable_structure (message),
+      "prefetches", G_TYPE_UINT64, G_GUINT64_CONSTANT (7), NULL);
+  s = gst_message_get_structure (message);
+  fail_unless (gst_structure_get_uint64 (s, "prefetches", &processed));
+  fail_unless_equals_uint64 (processed, 7);
+  gst_message_parse_buffering (message, &percent);
+  fail_unless_equals_int (percent, 50);
+  gst_message_parse_buffering_stats (message, &mode, NULL, NULL, &left);
+  fail_unless_equals_int (mode, GST_BUFFERING_DOWNLOAD);
+  fail_unless_equals_int64 (left, 3);
+  gst_message_unref (message);
+
+  message = gst_message_new_async_done (NULL, 42);
+  copy = gst_message_copy (message);
+  gst_message_unref (message);
+  s = gst_message_get_structure (copy);
+  fail_unless (gst_structure_get_uint64 (s, "running-time", &running_time));
+  fail_unless_equals_uint64 (running_time, 42);
+  gst_message_unref (copy);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_message_suite (void)
 {
@@ -613,6 +692,7 @@ gst_message_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_parsing);
+  tcase_add_test (tc_chain, test_lazy_structure);
 
   return s;
 }
@@ -365,6 +365,52 @@ GST_START_TEST (test_meta_foreach_remove_one)
 
 GST_END_TEST;
 
+static gboolean
+foreach_meta_remove_all (GstBuffer * buffer, GstMeta ** meta,
+    gpointer user_data)
+{
+  *meta = NULL;
+  return TRUE;
+}
+
+GST_START_TEST (test_meta_get_after_remove)
+{
+  GstBuffer *buffer, *copy;
+  GstMetaTest *test;
+  GstMetaFoo *foo;
+
+  buffer = gst_buffer_new_and_alloc (4);
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless (GST_META_FOO_GET (buffer) == NULL);
+
+  test = GST_META_TEST_ADD (buffer);
+  fail_unless (test != NULL);
+  foo = GST_META_FOO_ADD (buffer);
+  fail_unless (foo != NULL);
+  fail_unless (GST_META_TEST_GET (buffer) == test);
+  fail_unless (GST_META_FOO_GET (buffer) == foo);
+
+  /* copies find the copied metadata */
+  copy = gst_buffer_copy (buffer);
+  fail_unless (GST_META_TEST_GET (copy) != NULL);
+  gst_buffer_unref (copy);
+
+  fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) foo));
+  fail_unless (GST_META_FOO_GET (buffer) == NULL);
+  fail_unless (GST_META_TEST_GET (buffer) == test);
+
+  gst_buffer_foreach_meta (buffer, foreach_meta_remove_all, NULL);
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless_equals_int (count_buffer_meta (buffer), 0);
+
+  test = GST_META_TEST_ADD (buffer);
+  fail_unless (GST_META_TEST_GET (buffer) == test);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_meta_iterate)
 {
   GstBuffer *buffer;
@@ -474,6 +520,7 @@ gst_buffermeta_suite (void)
   tcase_add_test (tc_chain, test_meta_locked);
   tcase_add_test (tc_chain, test_meta_foreach_remove_one);
   tcase_add_test (tc_chain, test_meta_iterate);
+  tcase_add_test (tc_chain, test_meta_get_after_remove);
 
   return s;
 }
@@ -413,6 +413,57 @@ GST_START_TEST (test_default_accept_caps)
 
 GST_END_TEST;
 
+/* Repeated queries with the same caps against the template caps give the
+ * same results as the first one */
+GST_START_TEST (test_accept_caps_cache)
+{
+  GstCaps *caps, *accepted, *refused, *extra;
+  GstPadTemplate *sink_template;
+  GstPad *sink;
+  guint i;
+
+  caps = gst_caps_from_string ("foo/bar, dummy=(int){1, 2}");
+  sink_template = gst_pad_template_new ("sink", GST_PAD_SINK,
+      GST_PAD_ALWAYS, caps);
+  gst_caps_unref (caps);
+
+  sink = gst_pad_new_from_template (sink_template, "sink");
+  fail_if (sink == NULL);
+  gst_object_unref (sink_template);
+  GST_PAD_SET_ACCEPT_TEMPLATE (sink);
+  gst_pad_set_active (sink, TRUE);
+
+  accepted = gst_caps_from_string ("foo/bar, dummy=(int)1");
+  refused = gst_caps_from_string ("foo/bar, dummy=(int)3");
+  extra = gst_caps_from_string ("foo/bar, extra-field=(int)1");
+
+  for (i = 0; i < 3; i++) {
+    GST_PAD_UNSET_ACCEPT_INTERSECT (sink);
+    fail_unless (gst_pad_query_accept_caps (sink, accepted));
+    fail_if (gst_pad_query_accept_caps (sink, refused));
+    fail_if (gst_pad_query_accept_caps (sink, extra));
+
+    /* the result depends on the flags */
+    GST_PAD_SET_ACCEPT_INTERSECT (sink);
+    fail_unless (gst_pad_query_accept_caps (sink, accepted));
+    fail_if (gst_pad_query_accept_caps (sink, refused));
+    fail_unless (gst_pad_query_accept_caps (sink, extra));
+  }
+
+  /* the cache does not keep the caps alive after the pad */
+  ASSERT_OBJECT_REFCOUNT (sink, "sink", 1);
+  gst_object_unref (sink);
+  ASSERT_CAPS_REFCOUNT (accepted, "accepted", 1);
+  ASSERT_CAPS_REFCOUNT (refused, "refused", 1);
+  ASSERT_CAPS_REFCOUNT (extra, "extra", 1);
+
+  gst_caps_unref (accepted);
+  gst_caps_unref (refused);
+  gst_caps_unref (extra);
+}
+
+GST_END_TEST;
+
 /* Same as test_sticky_caps_unlinked except that the source pad
  * has a template of ANY and we will attempt to push
  * incompatible caps */
@@ -1097,6 +1148,60 @@ GST_START_TEST (test_push_buffer_list_compat)
 
 GST_END_TEST;
 
+static gint n_writable;
+
+static GstFlowReturn
+writable_counting_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  if (gst_buffer_is_writable (buffer))
+    n_writable++;
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_push_buffer_list_handoff)
+{
+  GstPad *src, *sink;
+  GstBufferList *list;
+
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, writable_counting_chain);
+  src = gst_pad_new ("src", GST_PAD_SRC);
+
+  gst_pad_set_active (src, TRUE);
+  fail_unless (gst_pad_push_event (src, gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)));
+  gst_pad_set_active (sink, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+
+  /* the buffers of a list that is only ours are handed over */
+  n_writable = 0;
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, gst_buffer_new ());
+  gst_buffer_list_add (list, gst_buffer_new ());
+  fail_unless (gst_pad_push_list (src, list) == GST_FLOW_OK);
+  fail_unless_equals_int (n_writable, 2);
+
+  /* the list is left alone when someone else has it too */
+  n_writable = 0;
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, gst_buffer_new ());
+  gst_buffer_list_add (list, gst_buffer_new ());
+  fail_unless (gst_pad_push_list (src,
+          gst_buffer_list_ref (list)) == GST_FLOW_OK);
+  fail_unless_equals_int (n_writable, 0);
+  fail_unless_equals_int (gst_buffer_list_length (list), 2);
+  gst_buffer_list_unref (list);
+
+  gst_pad_unlink (src, sink);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_flowreturn)
 {
   GstFlowReturn ret;
@@ -2040,6 +2145,81 @@ GST_START_TEST (test_pad_probe_flush_events_only)
 
 GST_END_TEST;
 
+static GstPadProbeReturn
+count_probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  (*(guint *) user_data)++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+count_and_remove_probe_cb (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  (*(guint *) user_data)++;
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+GST_START_TEST (test_pad_probe_type_mask)
+{
+  GstPad *src, *sink;
+  guint n_events = 0, n_buffers = 0;
+  gulong id;
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, gst_check_chain_func);
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+
+  fail_unless (gst_pad_link (src, sink) == GST_PAD_LINK_OK);
+
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_stream_start ("test")) == TRUE);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+
+  /* an event probe is not called for buffers */
+  id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      count_probe_cb, &n_events, NULL);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_events, 0);
+
+  /* a buffer probe that removes itself */
+  gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER,
+      count_and_remove_probe_cb, &n_buffers, NULL);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_buffers, 1);
+  fail_unless_equals_int (n_events, 0);
+
+  /* the event probe still works after the buffer probe was removed */
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+              gst_structure_new_empty ("test"))) == TRUE);
+  fail_unless_equals_int (n_events, 1);
+
+  gst_pad_remove_probe (src, id);
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+              gst_structure_new_empty ("test"))) == TRUE);
+  fail_unless_equals_int (n_events, 1);
+
+  /* new probes are still called */
+  gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER, count_probe_cb,
+      &n_buffers, NULL);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_buffers, 2);
+
+  gst_check_drop_buffers ();
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
 #define NUM_PROBES 4
 static guint count;
 
@@ -2602,6 +2782,79 @@ GST_START_TEST (test_sticky_events)
 
 GST_END_TEST;
 
+static gboolean
+count_sticky_events_handler (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  if (GST_EVENT_IS_STICKY (event))
+    sticky_count++;
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+GST_START_TEST (test_sticky_events_resend)
+{
+  GstPad *srcpad, *sinkpad;
+  GstSegment seg;
+  GstEvent *event;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (srcpad != NULL);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (sinkpad != NULL);
+  gst_pad_set_event_function (sinkpad, count_sticky_events_handler);
+  gst_pad_set_chain_function (sinkpad, test_sticky_chain);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+  sticky_count = 0;
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&seg, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&seg));
+  fail_unless_equals_int (sticky_count, 2);
+
+  /* lookups of stored and missing events */
+  event = gst_pad_get_sticky_event (srcpad, GST_EVENT_SEGMENT, 0);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_SEGMENT, 1) == NULL);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_TAG, 0) == NULL);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_CAPS, 0) == NULL);
+
+  /* received events are not sent again */
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (sticky_count, 2);
+
+  /* relinking only sends what the new peer didn't get */
+  gst_pad_unlink (srcpad, sinkpad);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (sticky_count, 2);
+
+  /* a new offset resends all events once */
+  gst_pad_set_offset (srcpad, GST_SECOND);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (sticky_count, 4);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (sticky_count, 4);
+
+  /* a removed event is not found anymore */
+  gst_pad_push_event (srcpad, gst_event_new_eos ());
+  fail_unless_equals_int (sticky_count, 5);
+  gst_pad_push_event (srcpad, gst_event_new_flush_start ());
+  gst_pad_push_event (srcpad, gst_event_new_flush_stop (TRUE));
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_EOS, 0) == NULL);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_SEGMENT, 0) == NULL);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
 static GstFlowReturn next_return;
 
 static GstFlowReturn
@@ -3298,12 +3551,14 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_sticky_caps_unlinked_incompatible);
   tcase_add_test (tc_chain, test_sticky_caps_flushing);
   tcase_add_test (tc_chain, test_default_accept_caps);
+  tcase_add_test (tc_chain, test_accept_caps_cache);
   tcase_add_test (tc_chain, test_link_unlink_threaded);
   tcase_add_test (tc_chain, test_name_is_valid);
   tcase_add_test (tc_chain, test_push_unlinked);
   tcase_add_test (tc_chain, test_push_linked);
   tcase_add_test (tc_chain, test_push_linked_flushing);
   tcase_add_test (tc_chain, test_push_buffer_list_compat);
+  tcase_add_test (tc_chain, test_push_buffer_list_handoff);
   tcase_add_test (tc_chain, test_flowreturn);
   tcase_add_test (tc_chain, test_push_negotiation);
   tcase_add_test (tc_chain, test_src_unref_unlink);
@@ -3320,6 +3575,7 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_pad_probe_block_and_drop_buffer);
   tcase_add_test (tc_chain, test_pad_probe_flush_events);
   tcase_add_test (tc_chain, test_pad_probe_flush_events_only);
+  tcase_add_test (tc_chain, test_pad_probe_type_mask);
   tcase_add_test (tc_chain, test_pad_probe_call_order);
   tcase_add_test (tc_chain, test_pad_probe_handled_and_drop);
   tcase_add_test (tc_chain, test_events_query_unlinked);
@@ -3332,6 +3588,7 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_block_async_full_destroy_dispose);
   tcase_add_test (tc_chain, test_block_async_replace_callback_no_flush);
   tcase_add_test (tc_chain, test_sticky_events);
+  tcase_add_test (tc_chain, test_sticky_events_resend);
   tcase_add_test (tc_chain, test_last_flow_return_push);
   tcase_add_test (tc_chain, test_last_flow_return_pull);
   tcase_add_test (tc_chain, test_flush_stop_inactive);
@@ -659,6 +659,97 @@ GST_START_TEST (test_pipeline_reset_start_time)
 
 GST_END_TEST;
 
+static GstBusSyncReply
+thread_policy_sync_handler (GstBus * bus, GstMessage * message,
+    gpointer user_data)
+{
+  GHashTable *pools = user_data;
+  GstStreamStatusType type;
+  GstElement *owner;
+  const GValue *val;
+
+  if (GST_MESSAGE_TYPE (message) != GST_MESSAGE_STREAM_STATUS)
+    return GST_BUS_PASS;
+
+  gst_message_parse_stream_status (message, &type, &owner);
+  val = gst_message_get_stream_status_object (message);
+  if (type == GST_STREAM_STATUS_TYPE_CREATE && G_VALUE_HOLDS (val,
+          GST_TYPE_TASK)) {
+    GstTaskPool *pool = gst_task_get_pool (g_value_get_object (val));
+
+    g_hash_table_insert (pools, gst_element_get_name (owner), pool);
+  }
+
+  return GST_BUS_PASS;
+}
+
+GST_START_TEST (test_pipeline_thread_policy)
+{
+  GstElement *pipeline;
+  GstThreadPolicy *policy, *sub_policy, *tmp;
+  GstTaskPool *pool, *sub_pool;
+  GHashTable *pools;
+  GstBus *bus;
+  guint cpus[] = { 0 };
+  guint *res, n_cpus;
+
+  pipeline = gst_parse_launch ("fakesrc name=src1 num-buffers=5 ! fakesink "
+      "( name=sub fakesrc name=src2 num-buffers=5 ! fakesink )", NULL);
+  fail_unless (GST_IS_PIPELINE (pipeline));
+
+  pool = gst_task_pool_new ();
+  sub_pool = gst_task_pool_new ();
+  gst_task_pool_prepare (pool, NULL);
+  gst_task_pool_prepare (sub_pool, NULL);
+
+  policy = gst_thread_policy_new ();
+  gst_thread_policy_set_task_pool (policy, pool);
+  gst_thread_policy_set_cpus (policy, cpus, G_N_ELEMENTS (cpus));
+  res = gst_thread_policy_get_cpus (policy, &n_cpus);
+  fail_unless_equals_int (n_cpus, 1);
+  fail_unless_equals_int (res[0], 0);
+  g_free (res);
+
+  sub_policy = gst_thread_policy_new ();
+  gst_thread_policy_set_task_pool (sub_policy, sub_pool);
+  gst_thread_policy_set_element_policy (policy, "sub", sub_policy);
+  fail_unless (gst_thread_policy_apply (sub_policy));
+
+  gst_pipeline_set_thread_policy (GST_PIPELINE (pipeline), policy);
+  g_object_get (pipeline, "thread-policy", &tmp, NULL);
+  fail_unless (tmp == policy);
+  gst_object_unref (tmp);
+
+  pools = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      gst_object_unref);
+  bus = gst_element_get_bus (pipeline);
+  gst_bus_set_sync_handler (bus, thread_policy_sync_handler, pools, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL, -1),
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* the tasks of the bin use its override */
+  fail_unless (g_hash_table_lookup (pools, "src1") == pool);
+  fail_unless (g_hash_table_lookup (pools, "src2") == sub_pool);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_bus_set_sync_handler (bus, NULL, NULL, NULL);
+  gst_object_unref (bus);
+
+  g_hash_table_unref (pools);
+  gst_object_unref (pipeline);
+  gst_object_unref (sub_policy);
+  gst_object_unref (policy);
+  gst_task_pool_cleanup (sub_pool);
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (sub_pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_pipeline_suite (void)
 {
@@ -677,6 +768,7 @@ gst_pipeline_suite (void)
   tcase_add_test (tc_chain, test_concurrent_create);
   tcase_add_test (tc_chain, test_pipeline_in_pipeline);
   tcase_add_test (tc_chain, test_pipeline_reset_start_time);
+  tcase_add_test (tc_chain, test_pipeline_thread_policy);
 
   return s;
 }
@@ -28,6 +28,7 @@
 #include <fcntl.h>
 #else
 #include <sys/socket.h>
+#include <fcntl.h>
 #endif
 
 GST_START_TEST (test_poll_wait)
@@ -318,6 +319,146 @@ GST_START_TEST (test_poll_controllable)
 
 GST_END_TEST;
 
+#define N_PAIRS 64
+
+GST_START_TEST (test_poll_many_fds)
+{
+  GstPoll *set;
+  GstPollFD rfd[N_PAIRS];
+  gint wfd[N_PAIRS];
+  guchar c = 'A';
+  gint i;
+
+  set = gst_poll_new (TRUE);
+  fail_if (set == NULL, "Failed to create a GstPoll");
+
+  /* enough fds to make the set switch to epoll where available */
+  for (i = 0; i < N_PAIRS; i++) {
+    gint socks[2];
+
+    fail_if (socketpair (PF_UNIX, SOCK_STREAM, 0, socks) < 0,
+        "Could not create a pipe");
+    gst_poll_fd_init (&rfd[i]);
+    rfd[i].fd = socks[0];
+    wfd[i] = socks[1];
+    fail_unless (gst_poll_add_fd (set, &rfd[i]));
+    fail_unless (gst_poll_fd_ctl_read (set, &rfd[i], TRUE));
+  }
+
+  fail_unless (gst_poll_wait (set, GST_MSECOND) == 0);
+
+  fail_unless (write (wfd[10], &c, 1) == 1, "write() failed");
+  fail_unless (write (wfd[50], &c, 1) == 1, "write() failed");
+
+  fail_unless_equals_int (gst_poll_wait (set, GST_CLOCK_TIME_NONE), 2);
+  for (i = 0; i < N_PAIRS; i++) {
+    fail_unless (gst_poll_fd_can_read (set, &rfd[i]) == (i == 10 || i == 50));
+    fail_if (gst_poll_fd_has_closed (set, &rfd[i]));
+  }
+
+  /* data not read, still readable */
+  fail_unless_equals_int (gst_poll_wait (set, GST_CLOCK_TIME_NONE), 2);
+
+  fail_unless (read (rfd[10].fd, &c, 1) == 1, "read() failed");
+  fail_unless_equals_int (gst_poll_wait (set, GST_CLOCK_TIME_NONE), 1);
+  fail_if (gst_poll_fd_can_read (set, &rfd[10]));
+  fail_unless (gst_poll_fd_can_read (set, &rfd[50]));
+
+  /* removing moves other fds around in the set */
+  fail_unless (gst_poll_remove_fd (set, &rfd[0]));
+  fail_unless (gst_poll_fd_ctl_read (set, &rfd[50], FALSE));
+  fail_unless (write (wfd[N_PAIRS - 1], &c, 1) == 1, "write() failed");
+  fail_unless_equals_int (gst_poll_wait (set, GST_CLOCK_TIME_NONE), 1);
+  fail_unless (gst_poll_fd_can_read (set, &rfd[N_PAIRS - 1]));
+  fail_if (gst_poll_fd_can_read (set, &rfd[50]));
+
+  /* closing the other end is reported */
+  close (wfd[20]);
+  wfd[20] = -1;
+  fail_unless_equals_int (gst_poll_wait (set, GST_CLOCK_TIME_NONE), 2);
+  fail_unless (gst_poll_fd_can_read (set, &rfd[20]));
+
+  gst_poll_free (set);
+
+  for (i = 0; i < N_PAIRS; i++) {
+    close (rfd[i].fd);
+    if (wfd[i] >= 0)
+      close (wfd[i]);
+  }
+}
+
+GST_END_TEST;
+
+static GstPoll *fallback_set;
+
+static gpointer
+delayed_add_file (gpointer data)
+{
+  GstPollFD *fd = data;
+
+  THREAD_START ();
+
+  g_usleep (100000);
+
+  /* epoll can't handle files, the waiter needs to switch to poll() */
+  fail_unless (gst_poll_add_fd (fallback_set, fd));
+  fail_unless (gst_poll_fd_ctl_read (fallback_set, fd, TRUE));
+
+  return NULL;
+}
+
+GST_START_TEST (test_poll_many_fds_fallback)
+{
+  GstPoll *set;
+  GstPollFD rfd[N_PAIRS];
+  GstPollFD file_fd = GST_POLL_FD_INIT;
+  gint wfd[N_PAIRS];
+  gint i;
+
+  set = gst_poll_new (TRUE);
+  fail_if (set == NULL, "Failed to create a GstPoll");
+
+  for (i = 0; i < N_PAIRS; i++) {
+    gint socks[2];
+
+    fail_if (socketpair (PF_UNIX, SOCK_STREAM, 0, socks) < 0,
+        "Could not create a pipe");
+    gst_poll_fd_init (&rfd[i]);
+    rfd[i].fd = socks[0];
+    wfd[i] = socks[1];
+    fail_unless (gst_poll_add_fd (set, &rfd[i]));
+    fail_unless (gst_poll_fd_ctl_read (set, &rfd[i], TRUE));
+  }
+  fail_unless (gst_poll_wait (set, GST_MSECOND) == 0);
+
+  file_fd.fd = open ("/dev/null", O_RDONLY);
+  fail_if (file_fd.fd < 0);
+
+  fallback_set = set;
+  MAIN_START_THREADS (1, delayed_add_file, &file_fd);
+
+  /* the waiter is woken up and the file is always readable */
+  fail_unless_equals_int (gst_poll_wait (set, 10 * GST_SECOND), 1);
+  fail_unless (gst_poll_fd_can_read (set, &file_fd));
+
+  MAIN_STOP_THREADS ();
+
+  /* and the set keeps working */
+  fail_unless (write (wfd[3], "A", 1) == 1, "write() failed");
+  fail_unless_equals_int (gst_poll_wait (set, GST_CLOCK_TIME_NONE), 2);
+  fail_unless (gst_poll_fd_can_read (set, &rfd[3]));
+
+  gst_poll_free (set);
+
+  close (file_fd.fd);
+  for (i = 0; i < N_PAIRS; i++) {
+    close (rfd[i].fd);
+    close (wfd[i]);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_poll_suite (void)
 {
@@ -336,6 +477,8 @@ gst_poll_suite (void)
   tcase_add_test (tc_chain, test_poll_wait_restart);
   tcase_add_test (tc_chain, test_poll_wait_flush);
   tcase_add_test (tc_chain, test_poll_controllable);
+  tcase_add_test (tc_chain, test_poll_many_fds);
+  tcase_add_test (tc_chain, test_poll_many_fds_fallback);
 #else
   tcase_skip_broken_test (tc_chain, test_poll_basic);
   tcase_skip_broken_test (tc_chain, test_poll_wait);
@@ -343,6 +486,8 @@ gst_poll_suite (void)
   tcase_skip_broken_test (tc_chain, test_poll_wait_restart);
   tcase_skip_broken_test (tc_chain, test_poll_wait_flush);
   tcase_skip_broken_test (tc_chain, test_poll_controllable);
+  tcase_skip_broken_test (tc_chain, test_poll_many_fds);
+  tcase_skip_broken_test (tc_chain, test_poll_many_fds_fallback);
 #endif
 
   return s;
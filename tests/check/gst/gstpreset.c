@@ -242,6 +242,46 @@ GST_START_TEST (test_two_instances)
 
 GST_END_TEST;
 
+GST_START_TEST (test_resave)
+{
+  GstElement *elem1, *elem2;
+  gint val;
+  guint i;
+
+  elem1 = gst_element_factory_make (GST_PRESET_TEST_NAME, NULL);
+  g_object_set (elem1, "test", 5, NULL);
+  fail_unless (gst_preset_save_preset (GST_PRESET (elem1), "test"));
+
+  /* the values are remembered after the first load */
+  for (i = 0; i < 3; i++) {
+    elem2 = gst_element_factory_make (GST_PRESET_TEST_NAME, NULL);
+    fail_unless (gst_preset_load_preset (GST_PRESET (elem2), "test"));
+    g_object_get (elem2, "test", &val, NULL);
+    fail_unless_equals_int (val, 5);
+    gst_object_unref (elem2);
+  }
+
+  /* and forgotten when the preset changes */
+  g_object_set (elem1, "test", 7, NULL);
+  fail_unless (gst_preset_save_preset (GST_PRESET (elem1), "test"));
+  elem2 = gst_element_factory_make (GST_PRESET_TEST_NAME, NULL);
+  fail_unless (gst_preset_load_preset (GST_PRESET (elem2), "test"));
+  g_object_get (elem2, "test", &val, NULL);
+  fail_unless_equals_int (val, 7);
+
+  /* saving the same values again keeps the file */
+  fail_unless (gst_preset_save_preset (GST_PRESET (elem1), "test"));
+  fail_unless (gst_preset_load_preset (GST_PRESET (elem2), "test"));
+
+  fail_unless (gst_preset_delete_preset (GST_PRESET (elem1), "test"));
+  fail_if (gst_preset_load_preset (GST_PRESET (elem2), "test"));
+
+  gst_object_unref (elem1);
+  gst_object_unref (elem2);
+}
+
+GST_END_TEST;
+
 
 static void
 remove_preset_file (void)
@@ -294,6 +334,7 @@ gst_preset_suite (void)
     tcase_add_test (tc, test_add);
     tcase_add_test (tc, test_del);
     tcase_add_test (tc, test_two_instances);
+    tcase_add_test (tc, test_resave);
   }
   tcase_add_unchecked_fixture (tc, test_setup, test_teardown);
 
@@ -276,6 +276,47 @@ GST_START_TEST (test_queries)
 
 GST_END_TEST;
 
+GST_START_TEST (test_lazy_structure)
+{
+  GstQuery *query, *copy;
+  GstStructure *s;
+  GstFormat format;
+  gint64 position;
+  gboolean live;
+  GstClockTime min, max;
+
+  query = gst_query_new_position (GST_FORMAT_TIME);
+  gst_query_set_position (query, GST_FORMAT_TIME, 5);
+  copy = gst_query_copy (query);
+  gst_query_parse_position (copy, &format, &position);
+  fail_unless_equals_int (format, GST_FORMAT_TIME);
+  fail_unless_equals_int64 (position, 5);
+  gst_query_unref (copy);
+
+  /* the structure has the values and is used from now on */
+  s = gst_query_writable_structure (query);
+  fail_unless (gst_structure_has_name (s, "GstQueryPosition"));
+  fail_unless (gst_structure_get_int64 (s, "current", &position));
+  fail_unless_equals_int64 (position, 5);
+  gst_query_set_position (query, GST_FORMAT_TIME, 6);
+  fail_unless (gst_structure_get_int64 (s, "current", &position));
+  fail_unless_equals_int64 (position, 6);
+  gst_query_unref (query);
+
+  query = gst_query_new_latency ();
+  gst_query_parse_latency (query, &live, &min, &max);
+  fail_if (live);
+  fail_unless_equals_uint64 (min, 0);
+  fail_unless_equals_uint64 (max, GST_CLOCK_TIME_NONE);
+  gst_query_set_latency (query, TRUE, 10, 20);
+  fail_unless (gst_structure_get_uint64 (gst_query_get_structure (query),
+          "max-latency", &max));
+  fail_unless_equals_uint64 (max, 20);
+  gst_query_unref (query);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_query_suite (void)
 {
@@ -287,6 +328,7 @@ gst_query_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, create_queries);
   tcase_add_test (tc_chain, test_queries);
+  tcase_add_test (tc_chain, test_lazy_structure);
   return s;
 }
 
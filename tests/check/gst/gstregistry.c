@@ -203,6 +203,132 @@ GST_START_TEST (test_registry_update)
 
 GST_END_TEST;
 
+GST_START_TEST (test_registry_element_list_rank)
+{
+  GstElementFactory *fakesink;
+  GList *list1, *list2;
+  guint rank;
+
+  fakesink = gst_element_factory_find ("fakesink");
+  fail_unless (fakesink != NULL);
+  rank = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (fakesink));
+
+  list1 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_NONE);
+  fail_unless (g_list_find (list1, fakesink) != NULL);
+  list2 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_NONE);
+  fail_unless_equals_int (g_list_length (list1), g_list_length (list2));
+  gst_plugin_feature_list_free (list2);
+
+  /* the result must follow rank changes */
+  gst_plugin_feature_set_rank (GST_PLUGIN_FEATURE (fakesink),
+      GST_RANK_PRIMARY + 100);
+  list2 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_NONE);
+  fail_unless (list2->data == (gpointer) fakesink);
+  gst_plugin_feature_list_free (list2);
+
+  list2 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_PRIMARY + 1);
+  fail_unless_equals_int (g_list_length (list2), 1);
+  gst_plugin_feature_list_free (list2);
+
+  gst_plugin_feature_set_rank (GST_PLUGIN_FEATURE (fakesink), rank);
+  list2 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_PRIMARY + 1);
+  fail_unless (list2 == NULL);
+
+  gst_plugin_feature_list_free (list1);
+  gst_object_unref (fakesink);
+}
+
+GST_END_TEST;
+
+static gboolean
+plugin_name_filter (GstPluginFeature * feature, gpointer user_data)
+{
+  return strcmp (feature->plugin_name, user_data) == 0;
+}
+
+GST_START_TEST (test_registry_feature_list_by_plugin)
+{
+  GstRegistry *registry = gst_registry_get ();
+  GstPluginFeature *feature;
+  GList *list1, *list2, *l;
+
+  list1 = gst_registry_get_feature_list_by_plugin (registry, "coreelements");
+  fail_unless (list1 != NULL);
+  list2 = gst_registry_feature_filter (registry, plugin_name_filter, FALSE,
+      (gpointer) "coreelements");
+  fail_unless_equals_int (g_list_length (list1), g_list_length (list2));
+  for (l = list2; l != NULL; l = l->next)
+    fail_unless (g_list_find (list1, l->data) != NULL);
+  gst_plugin_feature_list_free (list1);
+  gst_plugin_feature_list_free (list2);
+
+  fail_unless (gst_registry_get_feature_list_by_plugin (registry,
+          "coffeemaker") == NULL);
+
+  /* the lists follow the features that are added and removed */
+  fail_unless (gst_element_register (NULL, "testbin", GST_RANK_NONE,
+          GST_TYPE_BIN));
+  feature = gst_registry_lookup_feature (registry, "testbin");
+  fail_unless (feature != NULL);
+  list1 = gst_registry_get_feature_list_by_plugin (registry, "NULL");
+  fail_unless (g_list_find (list1, feature) != NULL);
+  gst_plugin_feature_list_free (list1);
+
+  gst_registry_remove_feature (registry, feature);
+  list1 = gst_registry_get_feature_list_by_plugin (registry, "NULL");
+  fail_if (g_list_find (list1, feature) != NULL);
+  gst_plugin_feature_list_free (list1);
+  gst_object_unref (feature);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_registry_preload_freeze)
+{
+  const gchar *names[] = { "coreelements", "fakesink", NULL };
+  const gchar *missing[] = { "fakesink", "coffeesink", NULL };
+  GstElementFactory *factory;
+  GstRegistry *registry;
+  const gchar *path;
+  GList *plugins;
+
+  fail_unless (gst_registry_preload (gst_registry_get (), names));
+  fail_if (gst_registry_preload (gst_registry_get (), missing));
+
+  factory = gst_element_factory_find ("fakesink");
+  fail_unless (GST_PLUGIN_FEATURE (factory)->loaded);
+  fail_unless (g_type_class_peek (gst_element_factory_get_element_type
+          (factory)) != NULL);
+  gst_object_unref (factory);
+
+  /* a frozen registry is not scanned */
+  registry = g_object_new (GST_TYPE_REGISTRY, NULL);
+  fail_if (gst_registry_is_frozen (registry));
+  gst_registry_freeze (registry);
+  fail_unless (gst_registry_is_frozen (registry));
+
+  path = g_getenv ("GST_PLUGIN_PATH_1_0");
+  if (path == NULL)
+    path = g_getenv ("GST_PLUGIN_PATH");
+  if (path != NULL) {
+    gchar **paths = g_strsplit (path, G_SEARCHPATH_SEPARATOR_S, -1);
+
+    fail_if (gst_registry_scan_path (registry, paths[0]));
+    g_strfreev (paths);
+  }
+  plugins = gst_registry_get_plugin_list (registry);
+  fail_unless (plugins == NULL);
+
+  gst_object_unref (registry);
+}
+
+GST_END_TEST;
+
 static Suite *
 registry_suite (void)
 {
@@ -212,6 +338,9 @@ registry_suite (void)
   suite_add_tcase (s, tc_chain);
 
   tcase_add_test (tc_chain, test_registry_update);
+  tcase_add_test (tc_chain, test_registry_element_list_rank);
+  tcase_add_test (tc_chain, test_registry_feature_list_by_plugin);
+  tcase_add_test (tc_chain, test_registry_preload_freeze);
 
   return s;
 }
@@ -0,0 +1,142 @@
+/* GStreamer
+ *
+ * gstsample.c: Unit test for GstSample
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+GST_START_TEST (test_new)
+{
+  GstSample *sample;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  GstSegment segment;
+
+  buffer = gst_buffer_new ();
+  caps = gst_caps_new_empty_simple ("foo/bar");
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  segment.position = 100;
+
+  sample = gst_sample_new (buffer, caps, &segment,
+      gst_structure_new_empty ("info"));
+  fail_unless (gst_sample_get_buffer (sample) == buffer);
+  fail_unless (gst_sample_get_caps (sample) == caps);
+  fail_unless (gst_segment_is_equal (gst_sample_get_segment (sample),
+          &segment));
+  fail_unless (gst_structure_has_name (gst_sample_get_info (sample), "info"));
+  fail_unless (gst_sample_get_buffer_list (sample) == NULL);
+  ASSERT_MINI_OBJECT_REFCOUNT (buffer, "buffer", 2);
+  ASSERT_MINI_OBJECT_REFCOUNT (caps, "caps", 2);
+  gst_sample_unref (sample);
+
+  /* everything is optional */
+  sample = gst_sample_new (NULL, NULL, NULL, NULL);
+  fail_unless (gst_sample_get_buffer (sample) == NULL);
+  fail_unless (gst_sample_get_caps (sample) == NULL);
+  fail_unless (gst_sample_get_info (sample) == NULL);
+  fail_unless_equals_int (gst_sample_get_segment (sample)->format,
+      GST_FORMAT_TIME);
+  gst_sample_unref (sample);
+
+  ASSERT_MINI_OBJECT_REFCOUNT (buffer, "buffer", 1);
+  ASSERT_MINI_OBJECT_REFCOUNT (caps, "caps", 1);
+  gst_buffer_unref (buffer);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_reuse)
+{
+  GstSample *sample;
+  GstBuffer *buffer1, *buffer2;
+  GstStructure *info;
+  GstCaps *caps;
+  GstSegment segment;
+
+  buffer1 = gst_buffer_new ();
+  buffer2 = gst_buffer_new ();
+  caps = gst_caps_new_empty_simple ("foo/bar");
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+
+  sample = gst_sample_new (buffer1, caps, &segment, NULL);
+  fail_unless (gst_sample_is_writable (sample));
+
+  /* setting the same caps again doesn't take another ref */
+  gst_sample_set_buffer (sample, buffer2);
+  gst_sample_set_caps (sample, caps);
+  ASSERT_MINI_OBJECT_REFCOUNT (buffer1, "buffer1", 1);
+  ASSERT_MINI_OBJECT_REFCOUNT (buffer2, "buffer2", 2);
+  ASSERT_MINI_OBJECT_REFCOUNT (caps, "caps", 2);
+  fail_unless (gst_sample_get_buffer (sample) == buffer2);
+
+  segment.position = 10 * GST_SECOND;
+  gst_sample_set_segment (sample, &segment);
+  fail_unless_equals_uint64 (gst_sample_get_segment (sample)->position,
+      10 * GST_SECOND);
+
+  fail_unless (gst_sample_set_info (sample, gst_structure_new_empty ("a")));
+  fail_unless (gst_sample_set_info (sample, gst_structure_new_empty ("b")));
+  fail_unless (gst_structure_has_name (gst_sample_get_info (sample), "b"));
+
+  /* the info can only have one parent */
+  info = gst_structure_new_empty ("c");
+  fail_unless (gst_structure_set_parent_refcount (info,
+          &GST_MINI_OBJECT_REFCOUNT (buffer1)));
+  ASSERT_WARNING (fail_if (gst_sample_set_info (sample, info)));
+  fail_unless (gst_structure_has_name (gst_sample_get_info (sample), "b"));
+  gst_structure_set_parent_refcount (info, NULL);
+  gst_structure_free (info);
+
+  gst_sample_set_buffer (sample, NULL);
+  gst_sample_set_caps (sample, NULL);
+  gst_sample_set_segment (sample, NULL);
+  fail_unless (gst_sample_get_buffer (sample) == NULL);
+  fail_unless (gst_sample_get_caps (sample) == NULL);
+  fail_unless_equals_uint64 (gst_sample_get_segment (sample)->position, 0);
+
+  /* shared samples can't be changed */
+  gst_sample_ref (sample);
+  fail_if (gst_sample_is_writable (sample));
+  ASSERT_CRITICAL (gst_sample_set_buffer (sample, buffer1));
+  gst_sample_unref (sample);
+
+  gst_sample_unref (sample);
+  ASSERT_MINI_OBJECT_REFCOUNT (buffer2, "buffer2", 1);
+  ASSERT_MINI_OBJECT_REFCOUNT (caps, "caps", 1);
+  gst_buffer_unref (buffer1);
+  gst_buffer_unref (buffer2);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_sample_suite (void)
+{
+  Suite *s = suite_create ("GstSample");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_new);
+  tcase_add_test (tc_chain, test_reuse);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_sample);
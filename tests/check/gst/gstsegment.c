@@ -1035,6 +1035,78 @@ GST_START_TEST (segment_negative_applied_rate)
 
 GST_END_TEST;
 
+static void
+check_times_n (GstSegment * segment)
+{
+  guint64 positions[12], running_times[12], stream_times[12];
+  guint i;
+
+  for (i = 0; i < 11; i++)
+    positions[i] = i * 25;
+  positions[11] = -1;
+
+  gst_segment_to_running_time_n (segment, GST_FORMAT_TIME, positions,
+      running_times, 12);
+  gst_segment_to_stream_time_n (segment, GST_FORMAT_TIME, positions,
+      stream_times, 12);
+
+  for (i = 0; i < 12; i++) {
+    fail_unless_equals_uint64 (running_times[i],
+        gst_segment_to_running_time (segment, GST_FORMAT_TIME, positions[i]));
+    fail_unless_equals_uint64 (stream_times[i],
+        gst_segment_to_stream_time (segment, GST_FORMAT_TIME, positions[i]));
+  }
+
+  /* in place */
+  gst_segment_to_running_time_n (segment, GST_FORMAT_TIME, positions,
+      positions, 12);
+  for (i = 0; i < 12; i++)
+    fail_unless_equals_uint64 (positions[i], running_times[i]);
+}
+
+GST_START_TEST (segment_to_time_n)
+{
+  GstSegment segment;
+  guint64 positions[2] = { 100, 150 }, results[2];
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  segment.start = 50;
+  segment.stop = 200;
+  segment.time = 100;
+  segment.base = 100;
+  check_times_n (&segment);
+
+  segment.rate = 2.0;
+  segment.applied_rate = 0.5;
+  check_times_n (&segment);
+
+  segment.rate = -1.0;
+  segment.applied_rate = -1.0;
+  check_times_n (&segment);
+
+  segment.offset = 20;
+  segment.rate = -3.0;
+  check_times_n (&segment);
+
+  segment.rate = 1.0;
+  segment.applied_rate = 1.0;
+  segment.offset = 120;
+  check_times_n (&segment);
+
+  segment.stop = -1;
+  segment.offset = 0;
+  segment.base = 0;
+  check_times_n (&segment);
+
+  /* a wrong format gives invalid times */
+  gst_segment_to_running_time_n (&segment, GST_FORMAT_BYTES, positions,
+      results, 2);
+  fail_unless_equals_uint64 (results[0], -1);
+  fail_unless_equals_uint64 (results[1], -1);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_segment_suite (void)
 {
@@ -1055,6 +1127,7 @@ gst_segment_suite (void)
   tcase_add_test (tc_chain, segment_negative_rate);
   tcase_add_test (tc_chain, segment_negative_applied_rate);
   tcase_add_test (tc_chain, segment_stream_time_full);
+  tcase_add_test (tc_chain, segment_to_time_n);
 
   return s;
 }
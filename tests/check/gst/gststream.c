@@ -209,6 +209,42 @@ GST_START_TEST (test_notifies)
 
 GST_END_TEST;
 
+GST_START_TEST (test_collection_find_stream)
+{
+  GstStreamCollection *collection;
+  GstStream *streams[100], *dup;
+  gchar id[16];
+  guint i;
+
+  collection = gst_stream_collection_new ("upstream-id");
+
+  for (i = 0; i < G_N_ELEMENTS (streams); i++) {
+    g_snprintf (id, sizeof (id), "stream-%u", i);
+    streams[i] = gst_stream_new (id, NULL, GST_STREAM_TYPE_AUDIO, 0);
+    fail_unless (gst_stream_collection_add_stream (collection, streams[i]));
+  }
+  /* the first stream with an id is found */
+  dup = gst_stream_new ("stream-10", NULL, GST_STREAM_TYPE_VIDEO, 0);
+  fail_unless (gst_stream_collection_add_stream (collection, dup));
+
+  fail_unless_equals_int (gst_stream_collection_get_size (collection), 101);
+  fail_unless (gst_stream_collection_get_stream (collection, 100) == dup);
+  fail_unless (gst_stream_collection_get_stream (collection, 101) == NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (streams); i++) {
+    g_snprintf (id, sizeof (id), "stream-%u", i);
+    fail_unless (gst_stream_collection_find_stream (collection, id) ==
+        streams[i]);
+    fail_unless (gst_stream_collection_get_stream (collection, i) ==
+        streams[i]);
+  }
+  fail_unless (gst_stream_collection_find_stream (collection, "none") == NULL);
+
+  gst_object_unref (collection);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_streams_suite (void)
 {
@@ -219,6 +255,7 @@ gst_streams_suite (void)
   tcase_add_test (tc_chain, test_stream_creation);
   tcase_add_test (tc_chain, test_stream_event);
   tcase_add_test (tc_chain, test_notifies);
+  tcase_add_test (tc_chain, test_collection_find_stream);
   return s;
 }
 
@@ -870,6 +870,273 @@ GST_START_TEST (test_flagset)
 
 GST_END_TEST;
 
+GST_START_TEST (test_many_fields)
+{
+  GstStructure *s, *s2;
+  gchar name[16];
+  gint i, val;
+
+  s = gst_structure_new_empty ("test");
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    gst_structure_set (s, name, G_TYPE_INT, i, NULL);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+
+  /* order of the fields is kept */
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    fail_unless_equals_string (gst_structure_nth_field_name (s, i), name);
+    fail_unless (gst_structure_get_int (s, name, &val));
+    fail_unless_equals_int (val, i);
+  }
+
+  /* replacing a field keeps its position */
+  gst_structure_set (s, "field50", G_TYPE_INT, 500, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+  fail_unless_equals_string (gst_structure_nth_field_name (s, 50), "field50");
+  fail_unless (gst_structure_get_int (s, "field50", &val));
+  fail_unless_equals_int (val, 500);
+
+  for (i = 0; i < 100; i += 2) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    gst_structure_remove_field (s, name);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 50);
+
+  s2 = gst_structure_copy (s);
+  fail_unless (gst_structure_is_equal (s, s2));
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    fail_unless_equals_int (gst_structure_has_field (s2, name), i % 2);
+    if (i % 2) {
+      fail_unless (gst_structure_get_int (s2, name, &val));
+      fail_unless_equals_int (val, i);
+    }
+  }
+  fail_if (gst_structure_has_field (s2, "nonexistent"));
+
+  gst_structure_remove_all_fields (s);
+  fail_unless_equals_int (gst_structure_n_fields (s), 0);
+  fail_if (gst_structure_has_field (s, "field1"));
+
+  gst_structure_free (s);
+  gst_structure_free (s2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_binary)
+{
+  GstStructure *s, *s2, *nested;
+  GstBuffer *buf;
+  guint8 *data;
+  gsize size;
+
+  nested = gst_structure_new ("nested", "int", G_TYPE_INT, 1, NULL);
+  buf = gst_buffer_new_wrapped (g_strdup ("data"), 4);
+  s = gst_structure_new ("test",
+      "int", G_TYPE_INT, -5,
+      "uint64", G_TYPE_UINT64, G_MAXUINT64,
+      "double", G_TYPE_DOUBLE, 1.5,
+      "bool", G_TYPE_BOOLEAN, TRUE,
+      "string", G_TYPE_STRING, "foo bar",
+      "null-string", G_TYPE_STRING, NULL,
+      "fraction", GST_TYPE_FRACTION, 30000, 1001,
+      "format", GST_TYPE_FORMAT, GST_FORMAT_TIME,
+      "flags", GST_TYPE_SEEK_FLAGS,
+      GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT,
+      "range", GST_TYPE_INT_RANGE, 2, 10,
+      "struct", GST_TYPE_STRUCTURE, nested,
+      "buffer", GST_TYPE_BUFFER, buf, NULL);
+  gst_structure_free (nested);
+  gst_buffer_unref (buf);
+
+  data = gst_structure_to_binary (s, &size);
+  fail_unless (data != NULL);
+  s2 = gst_structure_from_binary (data, size);
+  fail_unless (s2 != NULL);
+  fail_unless (gst_structure_is_equal (s, s2));
+  fail_unless_equals_string (gst_structure_nth_field_name (s2, 0), "int");
+  gst_structure_free (s2);
+
+  /* truncated and broken data is rejected */
+  fail_unless (gst_structure_from_binary (data, size - 1) == NULL);
+  fail_unless (gst_structure_from_binary (data + 1, size - 1) == NULL);
+  fail_unless (gst_structure_from_binary (data, 0) == NULL);
+
+  g_free (data);
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+/* build binary structures by hand, see the format in gstvalue.c */
+#define BINARY_TAG_SERIALIZED 0
+#define BINARY_TAG_INT 2
+#define BINARY_TAG_ENUM 9
+#define BINARY_TAG_FRACTION 11
+#define BINARY_TAG_FRACTION_RANGE 15
+
+static void
+binary_append_uint32 (GByteArray * array, guint32 val)
+{
+  val = GUINT32_TO_LE (val);
+  g_byte_array_append (array, (const guint8 *) &val, 4);
+}
+
+static void
+binary_append_string (GByteArray * array, const gchar * str)
+{
+  binary_append_uint32 (array, strlen (str) + 1);
+  g_byte_array_append (array, (const guint8 *) str, strlen (str));
+}
+
+/* the start of a structure named "test" with one field @field, the value
+ * is appended by the caller */
+static GByteArray *
+binary_structure_new (const gchar * field, guint8 tag)
+{
+  GByteArray *array = g_byte_array_new ();
+  const guint8 header[] = { 'G', 'S', 'T', 'B', 1, 1 };
+
+  g_byte_array_append (array, header, sizeof (header));
+  binary_append_string (array, "test");
+  binary_append_uint32 (array, 1);
+  binary_append_string (array, field);
+  g_byte_array_append (array, &tag, 1);
+
+  return array;
+}
+
+static gboolean
+binary_structure_is_valid (GByteArray * array)
+{
+  GstStructure *s;
+
+  s = gst_structure_from_binary (array->data, array->len);
+  g_byte_array_unref (array);
+
+  if (s == NULL)
+    return FALSE;
+  gst_structure_free (s);
+  return TRUE;
+}
+
+static gboolean
+binary_fraction_is_valid (guint8 tag, gint n1, gint d1, gint n2, gint d2)
+{
+  GByteArray *array = binary_structure_new ("f", tag);
+
+  binary_append_uint32 (array, n1);
+  binary_append_uint32 (array, d1);
+  if (tag == BINARY_TAG_FRACTION_RANGE) {
+    binary_append_uint32 (array, n2);
+    binary_append_uint32 (array, d2);
+  }
+  return binary_structure_is_valid (array);
+}
+
+static gboolean
+binary_typed_is_valid (guint8 tag, const gchar * type, const gchar * str)
+{
+  GByteArray *array = binary_structure_new ("v", tag);
+
+  binary_append_string (array, type);
+  if (tag == BINARY_TAG_ENUM)
+    binary_append_uint32 (array, 0);
+  else
+    binary_append_string (array, str);
+  return binary_structure_is_valid (array);
+}
+
+static gboolean
+binary_field_name_is_valid (const gchar * name)
+{
+  GByteArray *array = binary_structure_new (name, BINARY_TAG_INT);
+
+  binary_append_uint32 (array, 1);
+  return binary_structure_is_valid (array);
+}
+
+GST_START_TEST (test_binary_invalid)
+{
+  /* fractions with G_MININT can't be stored in a GstFraction */
+  fail_unless (binary_fraction_is_valid (BINARY_TAG_FRACTION, 1, 2, 0, 0));
+  fail_if (binary_fraction_is_valid (BINARY_TAG_FRACTION, G_MININT, 1, 0, 0));
+  fail_if (binary_fraction_is_valid (BINARY_TAG_FRACTION, 1, G_MININT, 0, 0));
+  fail_unless (binary_fraction_is_valid (BINARY_TAG_FRACTION_RANGE, 1, 2, 3,
+          4));
+  fail_if (binary_fraction_is_valid (BINARY_TAG_FRACTION_RANGE, G_MININT, 1,
+          3, 4));
+  fail_if (binary_fraction_is_valid (BINARY_TAG_FRACTION_RANGE, 1, 2, 3,
+          G_MININT));
+
+  /* only instantiable value types */
+  fail_unless (binary_typed_is_valid (BINARY_TAG_ENUM, "GstFormat", NULL));
+  fail_if (binary_typed_is_valid (BINARY_TAG_ENUM, "GEnum", NULL));
+  fail_unless (binary_typed_is_valid (BINARY_TAG_SERIALIZED, "gint", "5"));
+  fail_if (binary_typed_is_valid (BINARY_TAG_SERIALIZED, "GstObject", "x"));
+  fail_if (binary_typed_is_valid (BINARY_TAG_SERIALIZED, "GInterface", "x"));
+  fail_if (binary_typed_is_valid (BINARY_TAG_SERIALIZED, "GstNoSuchType",
+          "x"));
+
+  /* field names follow the rules of structure names */
+  fail_unless (binary_field_name_is_valid ("field-1"));
+  fail_if (binary_field_name_is_valid (""));
+  fail_if (binary_field_name_is_valid ("1field"));
+  fail_if (binary_field_name_is_valid ("a field"));
+  fail_if (binary_field_name_is_valid ("a=b"));
+}
+
+GST_END_TEST;
+
+#define N_NAME_THREADS 4
+#define N_NAMES 200
+
+static gpointer
+new_names_thread (gpointer data)
+{
+  GstStructure *s;
+  gchar name[32];
+  gint i;
+
+  /* all threads use the same names so that they race to add them */
+  for (i = 0; i < N_NAMES; i++) {
+    g_snprintf (name, sizeof (name), "test/name-%d", i);
+    s = gst_structure_new (name, "field", G_TYPE_INT, i, NULL);
+    if (!gst_structure_has_name (s, name) ||
+        gst_structure_get_name_id (s) != g_quark_from_string (name) ||
+        !gst_structure_has_field (s, "field"))
+      return GINT_TO_POINTER (FALSE);
+    gst_structure_free (s);
+  }
+
+  return GINT_TO_POINTER (TRUE);
+}
+
+GST_START_TEST (test_name_threads)
+{
+  GThread *threads[N_NAME_THREADS];
+  GstStructure *s;
+  gint i;
+
+  for (i = 0; i < N_NAME_THREADS; i++)
+    threads[i] = g_thread_new ("names", new_names_thread, NULL);
+  for (i = 0; i < N_NAME_THREADS; i++)
+    fail_unless (g_thread_join (threads[i]));
+
+  /* names that were seen before map to the same quark */
+  s = gst_structure_new_empty ("video/x-raw");
+  fail_unless_equals_int (gst_structure_get_name_id (s),
+      g_quark_from_string ("video/x-raw"));
+  gst_structure_set_name (s, "test/name-0");
+  fail_unless (gst_structure_has_name (s, "test/name-0"));
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_structure_suite (void)
 {
@@ -900,6 +1167,10 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_map_in_place);
   tcase_add_test (tc_chain, test_filter_and_map_in_place);
   tcase_add_test (tc_chain, test_flagset);
+  tcase_add_test (tc_chain, test_many_fields);
+  tcase_add_test (tc_chain, test_binary);
+  tcase_add_test (tc_chain, test_binary_invalid);
+  tcase_add_test (tc_chain, test_name_threads);
   return s;
 }
 
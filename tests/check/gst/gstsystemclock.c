@@ -227,6 +227,56 @@ GST_START_TEST (test_single_shot)
 
 GST_END_TEST;
 
+static gpointer
+spin_wait_thread_func (gpointer data)
+{
+  return GINT_TO_POINTER (gst_clock_id_wait ((GstClockID) data, NULL));
+}
+
+GST_START_TEST (test_spin_time)
+{
+  GstClock *clock;
+  GstClockID id;
+  GstClockTime base, spin_time;
+  GstClockReturn result;
+  GThread *thread;
+
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", "SpinClock",
+      "spin-time", TIME_UNIT / 2, NULL);
+  gst_object_ref_sink (clock);
+
+  g_object_get (clock, "spin-time", &spin_time, NULL);
+  fail_unless_equals_uint64 (spin_time, TIME_UNIT / 2);
+
+  /* the last half of the wait is spent spinning */
+  base = gst_clock_get_time (clock);
+  id = gst_clock_new_single_shot_id (clock, base + TIME_UNIT);
+  result = gst_clock_id_wait (id, NULL);
+  fail_unless (result == GST_CLOCK_OK, "Waiting did not return OK (result=%d)",
+      result);
+  fail_unless (gst_clock_get_time (clock) >= (base + TIME_UNIT),
+      "target time has not been reached");
+  gst_clock_id_unref (id);
+
+  /* a spinning wait can still be unscheduled */
+  g_object_set (clock, "spin-time", 10 * TIME_UNIT, NULL);
+  base = gst_clock_get_time (clock);
+  id = gst_clock_new_single_shot_id (clock, base + 5 * TIME_UNIT);
+  thread = g_thread_new ("spin-wait", spin_wait_thread_func, id);
+  g_usleep (TIME_UNIT / 1000);
+  gst_clock_id_unschedule (id);
+  result = GPOINTER_TO_INT (g_thread_join (thread));
+  fail_unless (result == GST_CLOCK_UNSCHEDULED,
+      "Waiting did not return UNSCHEDULED (result=%d)", result);
+  fail_unless (gst_clock_get_time (clock) < (base + 5 * TIME_UNIT),
+      "unscheduled wait did not return early");
+  gst_clock_id_unref (id);
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_periodic_shot)
 {
   GstClock *clock;
@@ -392,6 +442,61 @@ GST_START_TEST (test_async_order_stress_test)
 
 GST_END_TEST;
 
+GST_START_TEST (test_async_order_unschedule)
+{
+#define ID_COUNT 100
+  GstClock *clock;
+  GstClockID id[ID_COUNT];
+  GList *cb_list = NULL, *cb_list_it;
+  GstClockTime base, last;
+  GstClockReturn result;
+  guint i;
+
+  clock = gst_system_clock_obtain ();
+  fail_unless (clock != NULL, "Could not create instance of GstSystemClock");
+
+  base = gst_clock_get_time (clock);
+
+  /* schedule the ids in a shuffled order, one millisecond apart */
+  for (i = 0; i < ID_COUNT; i++) {
+    GstClockTime time = base + TIME_UNIT + ((i * 37) % ID_COUNT) * GST_MSECOND;
+
+    id[i] = gst_clock_new_single_shot_id (clock, time);
+    result = gst_clock_id_wait_async (id[i], store_callback, &cb_list, NULL);
+    fail_unless (result == GST_CLOCK_OK, "Waiting did not return OK");
+  }
+
+  /* and unschedule half of them again */
+  for (i = 1; i < ID_COUNT; i += 2)
+    gst_clock_id_unschedule (id[i]);
+
+  g_usleep ((TIME_UNIT + ID_COUNT * GST_MSECOND) / 1000 + G_USEC_PER_SEC / 2);
+
+  g_mutex_lock (&store_lock);
+  fail_unless_equals_int (g_list_length (cb_list), ID_COUNT / 2);
+  last = base;
+  for (cb_list_it = cb_list; cb_list_it; cb_list_it = cb_list_it->next) {
+    GstClockTime time = gst_clock_id_get_time (cb_list_it->data);
+
+    fail_unless (time >= last, "Notifications came out of order");
+    for (i = 1; i < ID_COUNT; i += 2)
+      fail_if (cb_list_it->data == id[i], "Unscheduled id[%u] notified", i);
+    last = time;
+  }
+  g_mutex_unlock (&store_lock);
+
+  /* the clock must have released all ids by now */
+  for (i = 0; i < ID_COUNT; i++) {
+    fail_unless_equals_int (((GstClockEntry *) id[i])->refcount, 1);
+    gst_clock_id_unref (id[i]);
+  }
+  g_list_free (cb_list);
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 struct test_async_sync_interaction_data
 {
   GMutex lock;
@@ -912,10 +1017,12 @@ gst_systemclock_suite (void)
   tcase_add_test (tc_chain, test_range);
   tcase_add_test (tc_chain, test_signedness);
   tcase_add_test (tc_chain, test_single_shot);
+  tcase_add_test (tc_chain, test_spin_time);
   tcase_add_test (tc_chain, test_periodic_shot);
   tcase_add_test (tc_chain, test_periodic_multi);
   tcase_add_test (tc_chain, test_async_order);
   tcase_add_test (tc_chain, test_async_order_stress_test);
+  tcase_add_test (tc_chain, test_async_order_unschedule);
   tcase_add_test (tc_chain, test_async_sync_interaction);
   tcase_add_test (tc_chain, test_diff);
   tcase_add_test (tc_chain, test_mixed);
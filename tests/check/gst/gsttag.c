@@ -626,6 +626,59 @@ GST_START_TEST (test_empty_taglist_serialization)
 
 GST_END_TEST;
 
+GST_START_TEST (test_copy_on_write)
+{
+  GstTagList *list, *copy, *merged;
+  const gchar *str, *str2;
+  gchar *artist;
+
+  list = gst_tag_list_new (GST_TAG_TITLE, "title", GST_TAG_ARTIST, "artist",
+      NULL);
+  gst_tag_list_set_scope (list, GST_TAG_SCOPE_GLOBAL);
+
+  /* copies share the values until they are modified */
+  copy = gst_tag_list_copy (list);
+  fail_unless (gst_tag_list_is_equal (list, copy));
+  fail_unless (gst_tag_list_peek_string_index (list, GST_TAG_TITLE, 0, &str));
+  fail_unless (gst_tag_list_peek_string_index (copy, GST_TAG_TITLE, 0,
+          &str2));
+  fail_unless (str == str2);
+
+  gst_tag_list_add (copy, GST_TAG_MERGE_REPLACE, GST_TAG_TITLE, "other",
+      NULL);
+  fail_unless (gst_tag_list_get_string (list, GST_TAG_TITLE, &artist));
+  fail_unless_equals_string (artist, "title");
+  g_free (artist);
+  fail_unless (gst_tag_list_get_string (copy, GST_TAG_TITLE, &artist));
+  fail_unless_equals_string (artist, "other");
+  g_free (artist);
+
+  gst_tag_list_remove_tag (copy, GST_TAG_ARTIST);
+  fail_unless_equals_int (gst_tag_list_n_tags (list), 2);
+  fail_unless_equals_int (gst_tag_list_n_tags (copy), 1);
+
+  /* merging with an empty list keeps the scope of the first list */
+  merged = gst_tag_list_merge (NULL, list, GST_TAG_MERGE_APPEND);
+  fail_unless (gst_tag_list_is_equal (merged, list));
+  fail_unless_equals_int (gst_tag_list_get_scope (merged),
+      GST_TAG_SCOPE_STREAM);
+  gst_tag_list_add (merged, GST_TAG_MERGE_APPEND, GST_TAG_ARTIST, "second",
+      NULL);
+  fail_unless_equals_int (gst_tag_list_get_tag_size (merged, GST_TAG_ARTIST),
+      2);
+  fail_unless_equals_int (gst_tag_list_get_tag_size (list, GST_TAG_ARTIST), 1);
+  gst_tag_list_unref (merged);
+
+  merged = gst_tag_list_merge (NULL, list, GST_TAG_MERGE_KEEP_ALL);
+  fail_unless (gst_tag_list_is_empty (merged));
+  gst_tag_list_unref (merged);
+
+  gst_tag_list_unref (copy);
+  gst_tag_list_unref (list);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_tag_suite (void)
@@ -648,6 +701,7 @@ gst_tag_suite (void)
   tcase_add_test (tc_chain, test_writability);
   tcase_add_test (tc_chain, test_serialization);
   tcase_add_test (tc_chain, test_empty_taglist_serialization);
+  tcase_add_test (tc_chain, test_copy_on_write);
 
   return s;
 }
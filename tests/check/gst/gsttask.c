@@ -248,6 +248,245 @@ GST_START_TEST (test_create)
 
 GST_END_TEST;
 
+#define POOL_FUNC_COUNT 100
+
+static gint pool_func_count;
+
+static void
+pool_child_func (void *data)
+{
+  g_atomic_int_inc (&pool_func_count);
+}
+
+static void
+pool_func (void *data)
+{
+  GstTaskPool *pool = data;
+  GError *error = NULL;
+
+  g_atomic_int_inc (&pool_func_count);
+
+  /* queued on the worker of this thread */
+  gst_task_pool_push (pool, pool_child_func, NULL, &error);
+  fail_unless (error == NULL);
+}
+
+GST_START_TEST (test_work_stealing_pool)
+{
+  GstTaskPool *pool;
+  GError *error = NULL;
+  gint i;
+
+  pool = gst_work_stealing_task_pool_new (2);
+  fail_unless_equals_int (gst_work_stealing_task_pool_get_n_threads
+      (GST_WORK_STEALING_TASK_POOL (pool)), 2);
+
+  gst_task_pool_prepare (pool, &error);
+  fail_unless (error == NULL);
+
+  pool_func_count = 0;
+  for (i = 0; i < POOL_FUNC_COUNT; i++) {
+    gst_task_pool_push (pool, pool_func, pool, &error);
+    fail_unless (error == NULL);
+  }
+
+  /* runs all the queued functions before stopping the workers */
+  gst_task_pool_cleanup (pool);
+  fail_unless_equals_int (g_atomic_int_get (&pool_func_count),
+      2 * POOL_FUNC_COUNT);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_work_stealing_pool_task)
+{
+  GstTaskPool *pool;
+  GstTask *t;
+  gboolean ret;
+
+  pool = gst_work_stealing_task_pool_new (0);
+  fail_unless (gst_work_stealing_task_pool_get_n_threads
+      (GST_WORK_STEALING_TASK_POOL (pool)) > 0);
+  gst_task_pool_prepare (pool, NULL);
+
+  t = gst_task_new (task_func, NULL, NULL);
+  fail_if (t == NULL);
+  gst_task_set_pool (t, pool);
+
+  g_rec_mutex_init (&task_mutex);
+  gst_task_set_lock (t, &task_mutex);
+
+  g_cond_init (&task_cond);
+  g_mutex_init (&task_lock);
+
+  g_mutex_lock (&task_lock);
+  ret = gst_task_start (t);
+  fail_unless (ret == TRUE);
+  /* wait for it to spin up */
+  g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  ret = gst_task_join (t);
+  fail_unless (ret == TRUE);
+
+  gst_object_unref (t);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GstTask *task;
+  GRecMutex lock;
+  gint count;
+} CoopData;
+
+static void
+coop_task_func (void *data)
+{
+  CoopData *d = data;
+
+  g_mutex_lock (&task_lock);
+  d->count++;
+  /* wait for the next wakeup without keeping the thread */
+  fail_unless (gst_task_suspend (d->task));
+  g_cond_broadcast (&task_cond);
+  g_mutex_unlock (&task_lock);
+}
+
+GST_START_TEST (test_cooperative)
+{
+  GstTaskPool *pool;
+  CoopData data[2];
+  gint i;
+
+  g_cond_init (&task_cond);
+  g_mutex_init (&task_lock);
+
+  /* both tasks share the one thread of the pool */
+  pool = gst_work_stealing_task_pool_new (1);
+  gst_task_pool_prepare (pool, NULL);
+
+  g_mutex_lock (&task_lock);
+  for (i = 0; i < 2; i++) {
+    data[i].count = 0;
+    data[i].task = gst_task_new (coop_task_func, &data[i], NULL);
+    g_rec_mutex_init (&data[i].lock);
+    gst_task_set_lock (data[i].task, &data[i].lock);
+    gst_task_set_pool (data[i].task, pool);
+
+    fail_if (gst_task_get_cooperative (data[i].task));
+    gst_task_set_cooperative (data[i].task, TRUE);
+    fail_unless (gst_task_get_cooperative (data[i].task));
+
+    fail_unless (gst_task_start (data[i].task));
+  }
+  while (data[0].count < 1 || data[1].count < 1)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* the tasks stay suspended until woken up */
+  g_usleep (G_USEC_PER_SEC / 10);
+  g_mutex_lock (&task_lock);
+  fail_unless_equals_int (data[0].count, 1);
+  fail_unless_equals_int (data[1].count, 1);
+
+  for (i = 0; i < 2; i++)
+    gst_task_wakeup (data[i].task);
+  while (data[0].count < 2 || data[1].count < 2)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* joining lets the suspended tasks exit */
+  for (i = 0; i < 2; i++) {
+    fail_unless (gst_task_join (data[i].task));
+    gst_object_unref (data[i].task);
+    g_rec_mutex_clear (&data[i].lock);
+  }
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+
+  g_cond_clear (&task_cond);
+  g_mutex_clear (&task_lock);
+}
+
+GST_END_TEST;
+
+static gint sched_count;
+
+static void
+sched_task_func (void *data)
+{
+  g_mutex_lock (&task_lock);
+  sched_count++;
+  g_cond_broadcast (&task_cond);
+  g_mutex_unlock (&task_lock);
+  g_usleep (1000);
+}
+
+GST_START_TEST (test_scheduling)
+{
+  GstTask *t;
+  guint cpus[] = { 0 };
+  guint *res, n_cpus;
+  gint priority = -1;
+
+  g_cond_init (&task_cond);
+  g_mutex_init (&task_lock);
+  sched_count = 0;
+
+  t = gst_task_new (sched_task_func, NULL, NULL);
+  g_rec_mutex_init (&task_mutex);
+  gst_task_set_lock (t, &task_mutex);
+
+  fail_unless_equals_int (gst_task_get_scheduling (t, &priority),
+      GST_TASK_SCHEDULING_DEFAULT);
+  fail_unless_equals_int (priority, 0);
+  fail_unless (gst_task_get_cpus (t, &n_cpus) == NULL);
+  fail_unless_equals_int (n_cpus, 0);
+
+  gst_task_set_cpus (t, cpus, G_N_ELEMENTS (cpus));
+  res = gst_task_get_cpus (t, &n_cpus);
+  fail_unless_equals_int (n_cpus, 1);
+  fail_unless_equals_int (res[0], 0);
+  g_free (res);
+
+  /* failing to apply the configuration does not stop the task */
+  fail_unless (gst_task_start (t));
+  g_mutex_lock (&task_lock);
+  while (sched_count < 1)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* changes are picked up by the running thread */
+  gst_task_set_scheduling (t, GST_TASK_SCHEDULING_RR, 1);
+  fail_unless_equals_int (gst_task_get_scheduling (t, &priority),
+      GST_TASK_SCHEDULING_RR);
+  fail_unless_equals_int (priority, 1);
+  gst_task_set_cpus (t, NULL, 0);
+
+  g_mutex_lock (&task_lock);
+  sched_count = 0;
+  while (sched_count < 2)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  fail_unless (gst_task_join (t));
+  gst_object_unref (t);
+
+  g_rec_mutex_clear (&task_mutex);
+  g_cond_clear (&task_cond);
+  g_mutex_clear (&task_lock);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_task_suite (void)
@@ -262,6 +501,10 @@ gst_task_suite (void)
   tcase_add_test (tc_chain, test_lock_start);
   tcase_add_test (tc_chain, test_join);
   tcase_add_test (tc_chain, test_pause_stop_race);
+  tcase_add_test (tc_chain, test_work_stealing_pool);
+  tcase_add_test (tc_chain, test_work_stealing_pool_task);
+  tcase_add_test (tc_chain, test_cooperative);
+  tcase_add_test (tc_chain, test_scheduling);
 
   return s;
 }
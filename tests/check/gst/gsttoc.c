@@ -305,6 +305,57 @@ GST_START_TEST (test_serializing)
 
 GST_END_TEST;
 
+GST_START_TEST (test_find_entry)
+{
+  GstToc *toc, *copy;
+  GstTocEntry *ed, *ch, *found;
+  gchar uid[32];
+  guint i;
+
+  toc = gst_toc_new (GST_TOC_SCOPE_GLOBAL);
+  ed = gst_toc_entry_new (GST_TOC_ENTRY_TYPE_EDITION, ENTRY_ED1);
+  gst_toc_entry_set_tags (ed, gst_tag_list_new (GST_TAG_TITLE, ENTRY_TAG,
+          NULL));
+  for (i = 0; i < 1000; i++) {
+    g_snprintf (uid, sizeof (uid), "chapter%u", i);
+    ch = gst_toc_entry_new (GST_TOC_ENTRY_TYPE_CHAPTER, uid);
+    gst_toc_entry_append_sub_entry (ed, ch);
+  }
+  gst_toc_append_entry (toc, ed);
+
+  for (i = 0; i < 1000; i++) {
+    g_snprintf (uid, sizeof (uid), "chapter%u", i);
+    found = gst_toc_find_entry (toc, uid);
+    fail_unless (found != NULL);
+    fail_unless_equals_string (gst_toc_entry_get_uid (found), uid);
+    fail_unless (gst_toc_entry_get_parent (found) == ed);
+  }
+  fail_unless (gst_toc_find_entry (toc, ENTRY_ED1) == ed);
+  fail_unless (gst_toc_find_entry (toc, ENTRY_CH1) == NULL);
+
+  /* entries added after a lookup are found */
+  ch = gst_toc_entry_new (GST_TOC_ENTRY_TYPE_CHAPTER, ENTRY_CH1);
+  gst_toc_entry_append_sub_entry (ed, ch);
+  fail_unless (gst_toc_find_entry (toc, ENTRY_CH1) == ch);
+  ed = gst_toc_entry_new (GST_TOC_ENTRY_TYPE_EDITION, ENTRY_ED2);
+  gst_toc_append_entry (toc, ed);
+  fail_unless (gst_toc_find_entry (toc, ENTRY_ED2) == ed);
+
+  /* a copy finds its own entries and shares the tags */
+  copy = gst_toc_copy (toc);
+  found = gst_toc_find_entry (copy, ENTRY_CH1);
+  fail_unless (found != NULL);
+  fail_unless (found != ch);
+  fail_unless (gst_toc_entry_get_toc (found) == copy);
+  fail_unless (gst_toc_entry_get_tags (gst_toc_entry_get_parent (found)) ==
+      gst_toc_entry_get_tags (gst_toc_find_entry (toc, ENTRY_ED1)));
+  gst_toc_unref (copy);
+
+  gst_toc_unref (toc);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_toc_suite (void)
 {
@@ -313,6 +364,7 @@ gst_toc_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_serializing);
+  tcase_add_test (tc_chain, test_find_entry);
 
   return s;
 }
@@ -0,0 +1,190 @@
+/* GStreamer
+ *
+ * Unit tests for the tracer hooks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* a tracer that counts the push hooks it is called for */
+typedef struct
+{
+  GstTracer parent;
+
+  guint n_push_pre;
+  guint n_push_post;
+} GstTestTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstTestTracerClass;
+
+static GType gst_test_tracer_get_type (void);
+
+G_DEFINE_TYPE (GstTestTracer, gst_test_tracer, GST_TYPE_TRACER);
+
+static void
+gst_test_tracer_class_init (GstTestTracerClass * klass)
+{
+}
+
+static void
+gst_test_tracer_init (GstTestTracer * self)
+{
+}
+
+static void
+do_push_buffer_pre (GstTestTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  self->n_push_pre++;
+}
+
+static void
+do_push_buffer_post (GstTestTracer * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  self->n_push_post++;
+}
+
+static GstTestTracer *
+test_tracer_new (gboolean sampled)
+{
+  GstTestTracer *self = g_object_new (gst_test_tracer_get_type (), NULL);
+
+  gst_object_ref_sink (self);
+  if (sampled) {
+    gst_tracing_register_sampled_hook (GST_TRACER (self), "pad-push-pre",
+        G_CALLBACK (do_push_buffer_pre));
+    gst_tracing_register_sampled_hook (GST_TRACER (self), "pad-push-post",
+        G_CALLBACK (do_push_buffer_post));
+  } else {
+    gst_tracing_register_hook (GST_TRACER (self), "pad-push-pre",
+        G_CALLBACK (do_push_buffer_pre));
+    gst_tracing_register_hook (GST_TRACER (self), "pad-push-post",
+        G_CALLBACK (do_push_buffer_post));
+  }
+  return self;
+}
+
+static GstFlowReturn
+chain_func (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static void
+push_buffers (guint n_buffers)
+{
+  GstPad *src, *sink;
+  GstSegment segment;
+  guint i;
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, chain_func);
+  fail_unless (gst_pad_link (src, sink) == GST_PAD_LINK_OK);
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (src, gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (src, gst_event_new_segment (&segment)));
+
+  for (i = 0; i < n_buffers; i++)
+    fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()),
+        GST_FLOW_OK);
+
+  gst_pad_set_active (src, FALSE);
+  gst_pad_set_active (sink, FALSE);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_START_TEST (test_sampled_hooks)
+{
+  GstTestTracer *sampled, *unsampled;
+
+  sampled = test_tracer_new (TRUE);
+  gst_tracing_set_sampling (10, 0);
+
+  /* with only sampled hooks the unsampled buffers are skipped */
+  push_buffers (100);
+  fail_unless_equals_int (sampled->n_push_pre, 10);
+  fail_unless_equals_int (sampled->n_push_post, 10);
+
+  /* an unsampled hook sees all buffers, the sampled one still 1 in 10 */
+  unsampled = test_tracer_new (FALSE);
+  sampled->n_push_pre = sampled->n_push_post = 0;
+  push_buffers (100);
+  fail_unless_equals_int (sampled->n_push_pre, 10);
+  fail_unless_equals_int (sampled->n_push_post, 10);
+  fail_unless_equals_int (unsampled->n_push_pre, 100);
+  fail_unless_equals_int (unsampled->n_push_post, 100);
+
+  gst_tracing_set_sampling (1, 0);
+
+  /* the hooks keep a ref until the tracing system is shut down */
+  gst_object_unref (sampled);
+  gst_object_unref (unsampled);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_unsampled_hook_other_id)
+{
+  GstTestTracer *sampled, *other;
+
+  sampled = test_tracer_new (TRUE);
+  gst_tracing_set_sampling (10, 0);
+
+  /* an unsampled hook for a different hook-id doesn't change what the
+   * sampled pad-push hooks see */
+  other = g_object_new (gst_test_tracer_get_type (), NULL);
+  gst_object_ref_sink (other);
+  gst_tracing_register_hook (GST_TRACER (other), "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_pre));
+
+  push_buffers (100);
+  fail_unless_equals_int (sampled->n_push_pre, 10);
+  fail_unless_equals_int (sampled->n_push_post, 10);
+  fail_unless_equals_int (other->n_push_pre, 0);
+
+  gst_tracing_set_sampling (1, 0);
+
+  gst_object_unref (sampled);
+  gst_object_unref (other);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_tracer_suite (void)
+{
+  Suite *s = suite_create ("GstTracer");
+  TCase *tc_chain = tcase_create ("hooks");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_sampled_hooks);
+  tcase_add_test (tc_chain, test_unsampled_hook_other_id);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_tracer);
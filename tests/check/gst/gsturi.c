@@ -197,6 +197,135 @@ GST_START_TEST (test_element_make_from_uri)
 
 GST_END_TEST;
 
+/* URI sources for the "gsttest" protocol, to check the order in which
+ * gst_element_make_from_uri() tries the handlers */
+typedef GstElement TestUriSrc;
+typedef GstElementClass TestUriSrcClass;
+
+static GType test_uri_src_get_type (void);
+
+static GstURIType
+test_uri_src_get_uri_type (GType type)
+{
+  return GST_URI_SRC;
+}
+
+static const gchar *const *
+test_uri_src_get_protocols (GType type)
+{
+  static const gchar *protocols[] = { "gsttest", "GstTest", NULL };
+
+  return protocols;
+}
+
+static gchar *
+test_uri_src_get_uri (GstURIHandler * handler)
+{
+  return g_strdup ("gsttest://");
+}
+
+static gboolean
+test_uri_src_set_uri (GstURIHandler * handler, const gchar * uri,
+    GError ** error)
+{
+  return TRUE;
+}
+
+static void
+test_uri_src_uri_handler_init (gpointer g_iface, gpointer iface_data)
+{
+  GstURIHandlerInterface *iface = (GstURIHandlerInterface *) g_iface;
+
+  iface->get_type = test_uri_src_get_uri_type;
+  iface->get_protocols = test_uri_src_get_protocols;
+  iface->get_uri = test_uri_src_get_uri;
+  iface->set_uri = test_uri_src_set_uri;
+}
+
+static void
+test_uri_src_class_init (TestUriSrcClass * klass)
+{
+  gst_element_class_set_metadata (klass, "Test URI source", "Source",
+      "Handles gsttest URIs", "GStreamer");
+}
+
+static void
+test_uri_src_init (TestUriSrc * src)
+{
+}
+
+G_DEFINE_TYPE_WITH_CODE (TestUriSrc, test_uri_src, GST_TYPE_ELEMENT,
+    G_IMPLEMENT_INTERFACE (GST_TYPE_URI_HANDLER,
+        test_uri_src_uri_handler_init));
+
+/* every factory needs its own type */
+typedef TestUriSrc TestUriSrc2;
+typedef TestUriSrcClass TestUriSrc2Class;
+
+static GType test_uri_src2_get_type (void);
+
+static void
+test_uri_src2_class_init (TestUriSrc2Class * klass)
+{
+}
+
+static void
+test_uri_src2_init (TestUriSrc2 * src)
+{
+}
+
+G_DEFINE_TYPE (TestUriSrc2, test_uri_src2, test_uri_src_get_type ());
+
+static gchar *
+make_test_uri_src_factory_name (const gchar * uri)
+{
+  GstElement *element;
+  gchar *name;
+
+  element = gst_element_make_from_uri (GST_URI_SRC, uri, NULL, NULL);
+  fail_unless (element != NULL);
+  name = g_strdup (GST_OBJECT_NAME (gst_element_get_factory (element)));
+  gst_object_unref (element);
+
+  return name;
+}
+
+GST_START_TEST (test_element_make_from_uri_rank)
+{
+  GstPluginFeature *feature;
+  gchar *name;
+
+  fail_if (gst_uri_protocol_is_supported (GST_URI_SRC, "gsttest"));
+
+  fail_unless (gst_element_register (NULL, "testurisrc1", GST_RANK_MARGINAL,
+          test_uri_src_get_type ()));
+  fail_unless (gst_uri_protocol_is_supported (GST_URI_SRC, "gsttest"));
+  fail_unless (gst_uri_protocol_is_supported (GST_URI_SRC, "GSTTEST"));
+  fail_if (gst_uri_protocol_is_supported (GST_URI_SINK, "gsttest"));
+
+  name = make_test_uri_src_factory_name ("gsttest://foo");
+  fail_unless_equals_string (name, "testurisrc1");
+  g_free (name);
+
+  /* new handlers are found */
+  fail_unless (gst_element_register (NULL, "testurisrc2", GST_RANK_PRIMARY,
+          test_uri_src2_get_type ()));
+  name = make_test_uri_src_factory_name ("GstTest://foo");
+  fail_unless_equals_string (name, "testurisrc2");
+  g_free (name);
+
+  /* and rank changes are seen */
+  feature = gst_registry_lookup_feature (gst_registry_get (), "testurisrc1");
+  fail_unless (feature != NULL);
+  gst_plugin_feature_set_rank (feature, GST_RANK_PRIMARY + 1);
+  name = make_test_uri_src_factory_name ("gsttest://foo");
+  fail_unless_equals_string (name, "testurisrc1");
+  g_free (name);
+  gst_object_unref (feature);
+}
+
+GST_END_TEST;
+
 /* Taken from the GNet unit test and extended with other URIs:
  * https://git.gnome.org/browse/archive/gnet/plain/tests/check/gnet/gneturi.c
  */
@@ -1103,6 +1232,7 @@ gst_uri_suite (void)
 #endif
   tcase_add_test (tc_chain, test_uri_misc);
   tcase_add_test (tc_chain, test_element_make_from_uri);
+  tcase_add_test (tc_chain, test_element_make_from_uri_rank);
 #ifdef G_OS_WIN32
   tcase_add_test (tc_chain, test_win32_uri);
 #endif
@@ -349,6 +349,58 @@ GST_START_TEST (test_math_scale_random)
 
 GST_END_TEST;
 
+static void
+check_scaler (guint64 num, guint64 denom, guint64 val)
+{
+  GstUInt64Scaler scaler;
+
+  gst_util_uint64_scaler_init (&scaler, num, denom);
+  fail_unless_equals_uint64 (gst_util_uint64_scaler_scale (&scaler, val),
+      gst_util_uint64_scale (val, num, denom));
+  fail_unless_equals_uint64 (gst_util_uint64_scaler_scale_round (&scaler,
+          val), gst_util_uint64_scale_round (val, num, denom));
+  fail_unless_equals_uint64 (gst_util_uint64_scaler_scale_ceil (&scaler,
+          val), gst_util_uint64_scale_ceil (val, num, denom));
+}
+
+GST_START_TEST (test_math_scaler)
+{
+  guint64 ratios[][2] = {
+    {GST_SECOND, 48000}, {48000, GST_SECOND}, {GST_SECOND, 44100},
+    {44100, GST_SECOND}, {1001, 30000}, {1, 3}, {3, 1}, {0, 7}, {5, 5},
+    {1, 1024}, {1024, 1}, {G_MAXUINT64, G_MAXUINT64 - 1},
+    {G_MAXUINT64 - 1, G_MAXUINT64}, {1, G_MAXUINT64}, {G_MAXUINT32 + 2, 3}
+  };
+  guint64 vals[] = { 0, 1, 2, 3, 47999, 48000, 48001, GST_SECOND,
+    G_MAXUINT32, G_MAXUINT64 / 48000, G_MAXUINT64 - 1, G_MAXUINT64
+  };
+  GRand *rand;
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (ratios); i++)
+    for (j = 0; j < G_N_ELEMENTS (vals); j++)
+      check_scaler (ratios[i][0], ratios[i][1], vals[j]);
+
+  rand = g_rand_new ();
+  for (i = 0; i < 10000; i++) {
+    guint64 num, denom, val;
+
+    num = g_rand_int_range (rand, 0, 200000);
+    denom = ((guint64) g_rand_int (rand)) << 32 | g_rand_int (rand);
+    if (i & 1)
+      denom >>= g_rand_int_range (rand, 0, 64);
+    denom = MAX (denom, 1);
+    val = ((guint64) g_rand_int (rand)) << 32 | g_rand_int (rand);
+    val >>= g_rand_int_range (rand, 0, 64);
+
+    check_scaler (num, denom, val);
+    check_scaler (denom, MAX (num, 1), val);
+  }
+  g_rand_free (rand);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_guint64_to_gdouble)
 {
   guint64 from[] = { 0, 1, 100, 10000, (guint64) (1) << 63,
@@ -1967,6 +2019,7 @@ gst_utils_suite (void)
   tcase_add_test (tc_chain, test_math_scale_ceil);
   tcase_add_test (tc_chain, test_math_scale_uint64);
   tcase_add_test (tc_chain, test_math_scale_random);
+  tcase_add_test (tc_chain, test_math_scaler);
 #ifdef HAVE_GSL
 #ifdef HAVE_GMP
   tcase_add_test (tc_chain, test_math_scale_gmp);
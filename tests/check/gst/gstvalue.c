@@ -3424,6 +3424,183 @@ GST_START_TEST (test_serialize_null_aray)
 
 GST_END_TEST;
 
+GST_START_TEST (test_list_grow)
+{
+  GValue list = G_VALUE_INIT;
+  GValue copy = G_VALUE_INIT;
+  GValue v = G_VALUE_INIT;
+  gint i;
+
+  g_value_init (&list, GST_TYPE_LIST);
+  g_value_init (&v, G_TYPE_INT);
+
+  /* grow beyond the inline storage, from both ends */
+  for (i = 1; i < 10; i++) {
+    g_value_set_int (&v, i);
+    gst_value_list_append_value (&list, &v);
+  }
+  g_value_set_int (&v, 0);
+  gst_value_list_prepend_value (&list, &v);
+
+  fail_unless_equals_int (gst_value_list_get_size (&list), 10);
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (g_value_get_int (gst_value_list_get_value (&list,
+                i)), i);
+
+  gst_value_init_and_copy (&copy, &list);
+  fail_unless_equals_int (gst_value_list_get_size (&copy), 10);
+  fail_unless (gst_value_compare (&list, &copy) == GST_VALUE_EQUAL);
+
+  g_value_unset (&copy);
+  g_value_unset (&list);
+  g_value_unset (&v);
+}
+
+GST_END_TEST;
+
+static void
+free_value_garray (GArray * array)
+{
+  guint i;
+
+  for (i = 0; i < array->len; i++)
+    g_value_unset (&g_array_index (array, GValue, i));
+  g_array_free (array, TRUE);
+}
+
+GST_START_TEST (test_list_collect_garray)
+{
+  GstStructure *s;
+  GArray *array, *out;
+  const GValue *field;
+  gint i;
+
+  /* lists and arrays are collected and copied out as a GArray of GValue */
+  array = g_array_new (FALSE, TRUE, sizeof (GValue));
+  for (i = 0; i < 6; i++) {
+    GValue v = G_VALUE_INIT;
+
+    g_value_init (&v, G_TYPE_INT);
+    g_value_set_int (&v, i);
+    g_array_append_val (array, v);
+  }
+
+  s = gst_structure_new ("test", "list", GST_TYPE_LIST, array,
+      "array", GST_TYPE_ARRAY, array, NULL);
+  free_value_garray (array);
+
+  field = gst_structure_get_value (s, "list");
+  fail_unless_equals_int (gst_value_list_get_size (field), 6);
+  fail_unless_equals_int (g_value_get_int (gst_value_list_get_value (field,
+              5)), 5);
+  array = g_value_peek_pointer (field);
+  fail_unless_equals_int (array->len, 6);
+  fail_unless_equals_int (g_value_get_int (&g_array_index (array, GValue,
+              2)), 2);
+
+  field = gst_structure_get_value (s, "array");
+  fail_unless_equals_int (gst_value_array_get_size (field), 6);
+
+  fail_unless (gst_structure_get (s, "array", GST_TYPE_ARRAY, &out, NULL));
+  fail_unless_equals_int (out->len, 6);
+  for (i = 0; i < 6; i++)
+    fail_unless_equals_int (g_value_get_int (&g_array_index (out, GValue, i)),
+        i);
+  free_value_garray (out);
+
+  fail_unless (gst_structure_get (s, "list", GST_TYPE_LIST, &out, NULL));
+  fail_unless_equals_int (out->len, 6);
+  fail_unless_equals_int (g_value_get_int (&g_array_index (out, GValue, 3)),
+      3);
+  free_value_garray (out);
+
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+static gpointer
+late_value_copy (gpointer boxed)
+{
+  return g_memdup (boxed, sizeof (gint));
+}
+
+static gint
+late_value_compare (const GValue * value1, const GValue * value2)
+{
+  gint v1 = *(gint *) g_value_get_boxed (value1);
+  gint v2 = *(gint *) g_value_get_boxed (value2);
+
+  return v1 == v2 ? GST_VALUE_EQUAL : (v1 < v2 ? GST_VALUE_LESS_THAN :
+      GST_VALUE_GREATER_THAN);
+}
+
+static void
+late_value_init (GValue * value, GType type, gint v)
+{
+  g_value_init (value, type);
+  g_value_take_boxed (value, g_memdup (&v, sizeof (gint)));
+}
+
+/* a type registered after gst_init() is not in the union, intersect and
+ * subtract dispatch tables and must take the generic paths */
+GST_START_TEST (test_late_registered_type)
+{
+  static GstValueTable table = { 0, late_value_compare, NULL, NULL };
+  GValue v1 = G_VALUE_INIT, v2 = G_VALUE_INIT, v3 = G_VALUE_INIT;
+  GValue dest = G_VALUE_INIT;
+  GType type;
+
+  type = g_boxed_type_register_static ("GstTestLateValue", late_value_copy,
+      g_free);
+  table.type = type;
+  gst_value_register (&table);
+
+  late_value_init (&v1, type, 1);
+  late_value_init (&v2, type, 1);
+  late_value_init (&v3, type, 2);
+
+  /* union */
+  fail_if (gst_value_can_union (&v1, &v3));
+  fail_unless (gst_value_union (&dest, &v1, &v3));
+  fail_unless (GST_VALUE_HOLDS_LIST (&dest));
+  fail_unless_equals_int (gst_value_list_get_size (&dest), 2);
+  fail_unless (gst_value_compare (gst_value_list_get_value (&dest, 0),
+          &v1) == GST_VALUE_EQUAL);
+  fail_unless (gst_value_compare (gst_value_list_get_value (&dest, 1),
+          &v3) == GST_VALUE_EQUAL);
+  g_value_unset (&dest);
+
+  /* intersect */
+  fail_unless (gst_value_can_intersect (&v1, &v2));
+  fail_unless (gst_value_intersect (&dest, &v1, &v2));
+  fail_unless (gst_value_compare (&dest, &v1) == GST_VALUE_EQUAL);
+  g_value_unset (&dest);
+  fail_if (gst_value_intersect (NULL, &v1, &v3));
+
+  /* subtract */
+  fail_if (gst_value_subtract (NULL, &v1, &v2));
+  fail_unless (gst_value_subtract (&dest, &v1, &v3));
+  fail_unless (gst_value_compare (&dest, &v1) == GST_VALUE_EQUAL);
+  g_value_unset (&dest);
+
+  /* and the same through a list */
+  g_value_unset (&v2);
+  fail_unless (gst_value_union (&dest, &v1, &v3));
+  fail_unless (gst_value_intersect (&v2, &dest, &v3));
+  fail_unless (gst_value_compare (&v2, &v3) == GST_VALUE_EQUAL);
+  g_value_unset (&v2);
+  fail_unless (gst_value_subtract (&v2, &dest, &v3));
+  fail_unless (gst_value_compare (&v2, &v1) == GST_VALUE_EQUAL);
+  g_value_unset (&dest);
+  g_value_unset (&v2);
+
+  g_value_unset (&v1);
+  g_value_unset (&v3);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_value_suite (void)
 {
@@ -3476,6 +3653,9 @@ gst_value_suite (void)
   tcase_add_test (tc_chain, test_transform_array);
   tcase_add_test (tc_chain, test_transform_list);
   tcase_add_test (tc_chain, test_serialize_null_aray);
+  tcase_add_test (tc_chain, test_list_grow);
+  tcase_add_test (tc_chain, test_list_collect_garray);
+  tcase_add_test (tc_chain, test_late_registered_type);
 
   return s;
 }
@@ -1445,6 +1445,191 @@ GST_START_TEST (test_take_buffer_fast)
 
 GST_END_TEST;
 
+GST_START_TEST (test_map_segments)
+{
+  GstAdapter *adapter;
+  GstBuffer *buffer;
+  const GstAdapterSegment *segments;
+  guint8 data[30];
+  guint i, n_segments;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = i;
+
+  adapter = gst_adapter_new ();
+
+  /* one buffer with two memories and one with a single memory */
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data, 10, 0, 10,
+          NULL, NULL));
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data + 10, 10, 0, 10,
+          NULL, NULL));
+  gst_adapter_push (adapter, buffer);
+  gst_adapter_push (adapter,
+      gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY, data + 20, 10, 0,
+          10, NULL, NULL));
+
+  fail_unless (gst_adapter_map_segments (adapter, 31, &n_segments) == NULL);
+  fail_unless_equals_int (n_segments, 0);
+
+  gst_adapter_flush (adapter, 5);
+
+  /* the segments point into the pushed memory */
+  segments = gst_adapter_map_segments (adapter, 20, &n_segments);
+  fail_unless (segments != NULL);
+  fail_unless_equals_int (n_segments, 3);
+  fail_unless (segments[0].data == data + 5);
+  fail_unless_equals_int (segments[0].size, 5);
+  fail_unless (segments[1].data == data + 10);
+  fail_unless_equals_int (segments[1].size, 10);
+  fail_unless (segments[2].data == data + 20);
+  fail_unless_equals_int (segments[2].size, 5);
+  gst_adapter_unmap_segments (adapter);
+
+  /* mapping within the first memory returns a single segment */
+  segments = gst_adapter_map_segments (adapter, 3, &n_segments);
+  fail_unless_equals_int (n_segments, 1);
+  fail_unless (segments[0].data == data + 5);
+  fail_unless_equals_int (segments[0].size, 3);
+
+  /* flushing releases the mapped segments */
+  gst_adapter_flush (adapter, 15);
+  segments = gst_adapter_map_segments (adapter, 10, &n_segments);
+  fail_unless_equals_int (n_segments, 1);
+  fail_unless (segments[0].data == data + 20);
+  fail_unless_equals_int (segments[0].size, 10);
+
+  gst_adapter_clear (adapter);
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
+/* start codes within and across buffers of all sizes */
+GST_START_TEST (test_scan_start_code)
+{
+  GstAdapter *adapter;
+  guint8 data[64];
+  guint32 val;
+  guint pos, bsize, i;
+
+  adapter = gst_adapter_new ();
+
+  for (bsize = 1; bsize <= 20; bsize++) {
+    for (pos = 0; pos + 4 <= sizeof (data); pos++) {
+      memset (data, 0xff, sizeof (data));
+      data[pos] = 0x00;
+      data[pos + 1] = 0x00;
+      data[pos + 2] = 0x01;
+      data[pos + 3] = 0xe0;
+
+      for (i = 0; i < sizeof (data); i += bsize) {
+        guint len = MIN (bsize, sizeof (data) - i);
+
+        gst_adapter_push (adapter, gst_buffer_new_wrapped (g_memdup (data + i,
+                    len), len));
+      }
+
+      fail_unless_equals_int (gst_adapter_masked_scan_uint32_peek (adapter,
+              0xffffff00, 0x00000100, 0, sizeof (data), &val), pos);
+      fail_unless_equals_int (val, 0x000001e0);
+
+      /* starting after the start code */
+      fail_unless_equals_int (gst_adapter_masked_scan_uint32 (adapter,
+              0xffffff00, 0x00000100, pos + 1, sizeof (data) - pos - 1), -1);
+
+      gst_adapter_clear (adapter);
+    }
+  }
+
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
+#define PACKET_SIZE 188
+#define N_PACKETS 100
+
+GST_START_TEST (test_coalesce)
+{
+  GstAdapter *adapter;
+  GstBuffer *buffer, *taken;
+  const guint8 *mapped;
+  guint8 packet[PACKET_SIZE];
+  gsize i, j;
+
+  adapter = gst_adapter_new ();
+  gst_adapter_set_coalesce_size (adapter, PACKET_SIZE);
+
+  for (i = 0; i < N_PACKETS; i++) {
+    memset (packet, i, PACKET_SIZE);
+    gst_adapter_push (adapter, gst_buffer_new_wrapped (g_memdup (packet,
+                PACKET_SIZE), PACKET_SIZE));
+  }
+  fail_unless_equals_int (gst_adapter_available (adapter),
+      N_PACKETS * PACKET_SIZE);
+
+  /* all packets were copied into one buffer */
+  fail_unless_equals_int (gst_adapter_available_fast (adapter),
+      N_PACKETS * PACKET_SIZE);
+  mapped = gst_adapter_map (adapter, N_PACKETS * PACKET_SIZE);
+  fail_unless (mapped != NULL);
+  for (i = 0; i < N_PACKETS * PACKET_SIZE; i++)
+    fail_unless_equals_int (mapped[i], i / PACKET_SIZE);
+  gst_adapter_unmap (adapter);
+
+  /* timestamped and large buffers are queued as they are */
+  buffer = gst_buffer_new_wrapped (g_memdup (packet, PACKET_SIZE),
+      PACKET_SIZE);
+  GST_BUFFER_PTS (buffer) = GST_SECOND;
+  gst_adapter_push (adapter, buffer);
+  buffer = gst_buffer_new_allocate (NULL, PACKET_SIZE + 1, NULL);
+  gst_buffer_memset (buffer, 0, 0xff, PACKET_SIZE + 1);
+  gst_adapter_push (adapter, buffer);
+  fail_unless_equals_int (gst_adapter_available_fast (adapter),
+      N_PACKETS * PACKET_SIZE);
+
+  /* a taken packet shares the memory of the coalesced buffer */
+  taken = gst_adapter_take_buffer (adapter, PACKET_SIZE);
+  fail_unless (taken != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (taken), PACKET_SIZE);
+  memset (packet, 0, PACKET_SIZE);
+  fail_unless (gst_buffer_memcmp (taken, 0, packet, PACKET_SIZE) == 0);
+  gst_adapter_flush (adapter, (N_PACKETS - 1) * PACKET_SIZE);
+
+  fail_unless_equals_uint64 (gst_adapter_prev_pts (adapter, NULL), GST_SECOND);
+  fail_unless_equals_int (gst_adapter_available (adapter),
+      2 * PACKET_SIZE + 1);
+
+  /* new packets after the large buffer go into a new coalesced buffer */
+  for (i = 0; i < 3; i++) {
+    memset (packet, i, PACKET_SIZE);
+    gst_adapter_push (adapter, gst_buffer_new_wrapped (g_memdup (packet,
+                PACKET_SIZE), PACKET_SIZE));
+  }
+  gst_adapter_flush (adapter, 2 * PACKET_SIZE + 1);
+  fail_unless_equals_int (gst_adapter_available_fast (adapter),
+      3 * PACKET_SIZE);
+  for (i = 0; i < 3; i++) {
+    buffer = gst_adapter_take_buffer (adapter, PACKET_SIZE);
+    for (j = 0; j < PACKET_SIZE; j++) {
+      guint8 val;
+
+      gst_buffer_extract (buffer, j, &val, 1);
+      fail_unless_equals_int (val, i);
+    }
+    gst_buffer_unref (buffer);
+  }
+  fail_unless_equals_int (gst_adapter_available (adapter), 0);
+
+  gst_buffer_unref (taken);
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_adapter_suite (void)
 {
@@ -1462,6 +1647,7 @@ gst_adapter_suite (void)
   tcase_add_test (tc_chain, test_take_buf_order);
   tcase_add_test (tc_chain, test_timestamp);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_start_code);
   tcase_add_test (tc_chain, test_take_list);
   tcase_add_test (tc_chain, test_get_list);
   tcase_add_test (tc_chain, test_take_buffer_list);
@@ -1469,6 +1655,8 @@ gst_adapter_suite (void)
   tcase_add_test (tc_chain, test_merge);
   tcase_add_test (tc_chain, test_take_buffer_fast);
   tcase_add_test (tc_chain, test_offset);
+  tcase_add_test (tc_chain, test_map_segments);
+  tcase_add_test (tc_chain, test_coalesce);
 
   return s;
 }
@@ -0,0 +1,125 @@
+/* GStreamer
+ *
+ * unit test for the bandwidth estimator of queue2
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+
+/* not public API */
+#include "../../../plugins/elements/gstbandwidthestimator.c"
+
+GST_START_TEST (test_average)
+{
+  GstBandwidthEstimator *est;
+
+  est = gst_bandwidth_estimator_new (1.0, 16);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_average (est), 0.0);
+
+  /* samples without a duration are ignored */
+  gst_bandwidth_estimator_add_sample (est, 1000, 0.0);
+  fail_unless_equals_int (gst_bandwidth_estimator_get_n_samples (est), 0);
+
+  /* the first samples are not averaged with 0 */
+  gst_bandwidth_estimator_add_sample (est, 1000, 0.5);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_average (est), 2000.0);
+  gst_bandwidth_estimator_add_sample (est, 1000, 0.5);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_average (est), 2000.0);
+
+  /* after one half life the old rate weighs half */
+  gst_bandwidth_estimator_add_sample (est, 4000, 1.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_average (est), 3000.0);
+  gst_bandwidth_estimator_add_sample (est, 0, 1.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_average (est), 1500.0);
+
+  /* a shorter half life forgets the old rate faster */
+  gst_bandwidth_estimator_set_half_life (est, 0.5);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_half_life (est), 0.5);
+  gst_bandwidth_estimator_add_sample (est, 0, 1.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_average (est), 375.0);
+
+  gst_bandwidth_estimator_reset (est);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_average (est), 0.0);
+  gst_bandwidth_estimator_add_sample (est, 100, 1.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_average (est), 100.0);
+
+  gst_bandwidth_estimator_free (est);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_percentile)
+{
+  GstBandwidthEstimator *est;
+  guint i;
+
+  est = gst_bandwidth_estimator_new (1.0, 4);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 50),
+      0.0);
+
+  /* only the last 4 samples are kept */
+  for (i = 5; i > 0; i--)
+    gst_bandwidth_estimator_add_sample (est, i, 1.0);
+  gst_bandwidth_estimator_add_sample (est, 6, 1.0);
+  fail_unless_equals_int (gst_bandwidth_estimator_get_n_samples (est), 4);
+
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 0),
+      1.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 10),
+      1.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 50),
+      2.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 90),
+      6.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 100),
+      6.0);
+
+  /* new samples invalidate the sorted values */
+  gst_bandwidth_estimator_add_sample (est, 10, 1.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 0),
+      1.0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 100),
+      10.0);
+
+  gst_bandwidth_estimator_reset (est);
+  fail_unless_equals_int (gst_bandwidth_estimator_get_n_samples (est), 0);
+  fail_unless_equals_float (gst_bandwidth_estimator_get_percentile (est, 50),
+      0.0);
+
+  gst_bandwidth_estimator_free (est);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_bandwidth_estimator_suite (void)
+{
+  Suite *s = suite_create ("GstBandwidthEstimator");
+  TCase *tc = tcase_create ("general");
+
+  suite_add_tcase (s, tc);
+  tcase_add_test (tc, test_average);
+  tcase_add_test (tc, test_percentile);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_bandwidth_estimator);
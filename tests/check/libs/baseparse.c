@@ -34,6 +34,7 @@ static gboolean have_eos = FALSE;
 static gboolean have_data = FALSE;
 static gint buffer_count = 0;
 static gboolean caps_set = FALSE;
+static gint process_count = 0;
 
 #define TEST_VIDEO_WIDTH 640
 #define TEST_VIDEO_HEIGHT 480
@@ -104,6 +105,17 @@ gst_parser_tester_handle_frame (GstBaseParse * parse,
   return ret;
 }
 
+static GstFlowReturn
+gst_parser_tester_process_frame (GstBaseParse * parse,
+    GstBaseParseFrame * frame)
+{
+  /* finish frames in a random order when processed in parallel */
+  g_usleep (g_random_int_range (0, 1000));
+  g_atomic_int_inc (&process_count);
+
+  return GST_FLOW_OK;
+}
+
 static void
 gst_parser_tester_class_init (GstParserTesterClass * klass)
 {
@@ -128,6 +140,7 @@ gst_parser_tester_class_init (GstParserTesterClass * klass)
   baseparse_class->stop = gst_parser_tester_stop;
   baseparse_class->handle_frame = gst_parser_tester_handle_frame;
   baseparse_class->set_sink_caps = gst_parser_tester_set_sink_caps;
+  baseparse_class->process_frame = gst_parser_tester_process_frame;
 }
 
 static void
@@ -324,6 +337,26 @@ GST_START_TEST (parser_reverse_playback_on_passthrough)
 
 GST_END_TEST;
 
+GST_START_TEST (parser_parallel_playback)
+{
+  GList *input = NULL;
+  gint i;
+
+  setup_parsertester ();
+
+  gst_base_parse_set_max_parallel_frames (GST_BASE_PARSE (parsetest), 4);
+
+  for (i = 0; i < 50; i++)
+    input = g_list_append (input, create_test_buffer (i));
+
+  /* checks that the frames come out in order */
+  run_parser_playback_test (input, 50, 1.0);
+
+  fail_unless_equals_int (g_atomic_int_get (&process_count), 50);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (parser_empty_stream)
 {
   setup_parsertester ();
@@ -453,6 +486,98 @@ GST_START_TEST (parser_reverse_playback)
 
 GST_END_TEST;
 
+/* 10 seconds of 8 byte frames at 30 fps */
+#define SAMPLE_STREAM_SIZE 2400
+
+static GstClockTime sampled_duration;
+
+static GstFlowReturn
+_sample_src_getrange (GstPad * pad, GstObject * parent, guint64 offset,
+    guint length, GstBuffer ** buffer)
+{
+  if (offset >= SAMPLE_STREAM_SIZE)
+    return GST_FLOW_EOS;
+
+  *buffer = create_test_buffer (offset / 8);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+_sample_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstFormat format;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_SEEKING:
+      gst_query_parse_seeking (query, &format, NULL, NULL, NULL);
+      if (format != GST_FORMAT_BYTES)
+        return FALSE;
+      gst_query_set_seeking (query, format, TRUE, 0, SAMPLE_STREAM_SIZE);
+      return TRUE;
+    case GST_QUERY_DURATION:
+      gst_query_parse_duration (query, &format, NULL);
+      if (format != GST_FORMAT_BYTES)
+        return FALSE;
+      gst_query_set_duration (query, format, SAMPLE_STREAM_SIZE);
+      return TRUE;
+    default:
+      return _src_query (pad, parent, query);
+  }
+}
+
+static GstFlowReturn
+_sample_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gint64 duration;
+
+  /* the duration is known before the first frame */
+  if (buffer_count == 0) {
+    fail_unless (gst_pad_peer_query_duration (pad, GST_FORMAT_TIME,
+            &duration));
+    sampled_duration = duration;
+  }
+
+  return _sink_chain (pad, parent, buffer);
+}
+
+GST_START_TEST (parser_bitrate_sampling)
+{
+  have_eos = FALSE;
+  have_data = FALSE;
+  sampled_duration = GST_CLOCK_TIME_NONE;
+  loop = g_main_loop_new (NULL, FALSE);
+
+  setup_parsertester ();
+  gst_base_parse_set_bitrate_sampling (GST_BASE_PARSE (parsetest), 4);
+  gst_pad_set_getrange_function (mysrcpad, _sample_src_getrange);
+  gst_pad_set_query_function (mysrcpad, _sample_src_query);
+  gst_pad_set_chain_function (mysinkpad, _sample_sink_chain);
+  gst_pad_set_event_function (mysinkpad, _sink_event);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_element_set_state (parsetest, GST_STATE_PLAYING);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  g_main_loop_run (loop);
+  fail_unless (have_eos == TRUE);
+  fail_unless_equals_int (buffer_count, SAMPLE_STREAM_SIZE / 8);
+
+  fail_unless (GST_CLOCK_TIME_IS_VALID (sampled_duration));
+  fail_unless (sampled_duration > 10 * GST_SECOND - 100 * GST_MSECOND);
+  fail_unless (sampled_duration < 10 * GST_SECOND + 100 * GST_MSECOND);
+
+  gst_element_set_state (parsetest, GST_STATE_NULL);
+
+  check_no_error_received ();
+  cleanup_parsertest ();
+
+  g_main_loop_unref (loop);
+  loop = NULL;
+}
+
+GST_END_TEST;
+
 static void
 baseparse_setup (void)
 {
@@ -463,6 +588,7 @@ baseparse_setup (void)
   loop = NULL;
   have_eos = have_data = caps_set = FALSE;
   buffer_count = 0;
+  process_count = 0;
 }
 
 static void
@@ -479,9 +605,11 @@ gst_baseparse_suite (void)
   suite_add_tcase (s, tc);
   tcase_add_checked_fixture (tc, baseparse_setup, baseparse_teardown);
   tcase_add_test (tc, parser_playback);
+  tcase_add_test (tc, parser_parallel_playback);
   tcase_add_test (tc, parser_empty_stream);
   tcase_add_test (tc, parser_reverse_playback_on_passthrough);
   tcase_add_test (tc, parser_reverse_playback);
+  tcase_add_test (tc, parser_bitrate_sampling);
 
   return s;
 }
@@ -23,6 +23,7 @@
 #endif
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
 #include <gst/base/gstbasesink.h>
 
 GST_START_TEST (basesink_last_sample_enabled)
@@ -242,6 +243,230 @@ GST_START_TEST (basesink_test_eos_after_playing)
 
 GST_END_TEST;
 
+static void
+count_handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    gint * count)
+{
+  g_atomic_int_inc (count);
+}
+
+GST_START_TEST (basesink_test_sync_window)
+{
+  GstHarness *h;
+  GstElement *sink;
+  GstTestClock *testclock;
+  GstClockID id;
+  GstClockTime first, second;
+  GstClockTime ts[] = { 1000, 1010, 1020, 1030, 1040, 1200 };
+  gint handoffs = 0;
+  guint i;
+
+  /* the queue makes pushing asynchronous, fakesink waits on the clock */
+  h = gst_harness_new_parse ("queue ! fakesink name=sink sync=true "
+      "sync-window=100000000 signal-handoffs=true");
+  gst_harness_use_testclock (h);
+  gst_harness_set_src_caps_str (h, "mycaps");
+  testclock = gst_harness_get_testclock (h);
+
+  sink = gst_bin_get_by_name (GST_BIN (h->element), "sink");
+  fail_unless_equals_uint64 (gst_base_sink_get_sync_window (GST_BASE_SINK
+          (sink)), 100 * GST_MSECOND);
+  g_signal_connect (sink, "handoff", G_CALLBACK (count_handoff), &handoffs);
+
+  for (i = 0; i < G_N_ELEMENTS (ts); i++) {
+    GstBuffer *buf = gst_buffer_new ();
+
+    GST_BUFFER_TIMESTAMP (buf) = ts[i] * GST_MSECOND;
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  /* one wait for the first buffer */
+  gst_test_clock_wait_for_next_pending_id (testclock, &id);
+  first = gst_clock_id_get_time (id);
+  gst_clock_id_unref (id);
+  fail_unless (gst_test_clock_crank (testclock));
+
+  /* the buffers within 100ms render without waiting, the last one waits */
+  gst_test_clock_wait_for_next_pending_id (testclock, &id);
+  second = gst_clock_id_get_time (id);
+  gst_clock_id_unref (id);
+  fail_unless_equals_uint64 (second - first, 200 * GST_MSECOND);
+  fail_unless_equals_int (g_atomic_int_get (&handoffs), 5);
+  fail_unless (gst_test_clock_crank (testclock));
+
+  gst_object_unref (sink);
+  gst_object_unref (testclock);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GstBuffer *
+create_timed_buffer (GstClockTime ts, GstClockTime duration)
+{
+  GstBuffer *buf = gst_buffer_new ();
+
+  GST_BUFFER_TIMESTAMP (buf) = ts;
+  GST_BUFFER_DURATION (buf) = duration;
+
+  return buf;
+}
+
+GST_START_TEST (basesink_test_predictive_qos)
+{
+  GstHarness *h;
+  GstEvent *event;
+  GstClockTimeDiff diff;
+  GstClockTime timestamp;
+
+  h = gst_harness_new_parse ("fakesink sync=true qos=true predictive-qos=true");
+  gst_harness_use_testclock (h);
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  /* the second buffer arrives 30ms after the first one left, while the
+   * buffers only last 10ms */
+  fail_unless (gst_harness_set_time (h, 0));
+  fail_unless_equals_int (gst_harness_push (h, create_timed_buffer (0,
+              10 * GST_MSECOND)), GST_FLOW_OK);
+  fail_unless (gst_harness_set_time (h, 30 * GST_MSECOND));
+  fail_unless_equals_int (gst_harness_push (h,
+          create_timed_buffer (10 * GST_MSECOND, 10 * GST_MSECOND)),
+      GST_FLOW_OK);
+
+  while ((event = gst_harness_try_pull_upstream_event (h))) {
+    if (GST_EVENT_TYPE (event) == GST_EVENT_QOS)
+      break;
+    gst_event_unref (event);
+  }
+  fail_unless (event != NULL);
+
+  /* the buffer was 20ms late, and the next ones will be another 30ms late
+   * by the time they are processed */
+  gst_event_parse_qos (event, NULL, NULL, &diff, &timestamp);
+  fail_unless_equals_uint64 (timestamp, 10 * GST_MSECOND);
+  fail_unless_equals_int64 (diff, 50 * GST_MSECOND);
+  gst_event_unref (event);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static gpointer
+get_last_sample_func (gpointer data)
+{
+  GstBaseSink *sink = data;
+  volatile gint *stop = g_object_get_data (G_OBJECT (sink), "stop");
+  GstSample *sample;
+
+  while (!g_atomic_int_get (stop)) {
+    if ((sample = gst_base_sink_get_last_sample (sink))) {
+      fail_unless (gst_sample_get_buffer (sample) != NULL);
+      gst_sample_unref (sample);
+    }
+  }
+  return NULL;
+}
+
+GST_START_TEST (basesink_test_last_sample_concurrent)
+{
+  GstHarness *h;
+  GstSample *sample;
+  GstBuffer *buf;
+  GstCaps *caps;
+  GThread *threads[2];
+  volatile gint stop = 0;
+  guint i;
+
+  h = gst_harness_new_parse ("fakesink sync=false");
+  gst_harness_set_src_caps_str (h, "mycaps");
+  g_object_set_data (G_OBJECT (h->element), "stop", (gpointer) & stop);
+
+  /* the readers don't block the streaming thread and always see a valid
+   * buffer while it is replaced */
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("reader", get_last_sample_func, h->element);
+
+  for (i = 0; i < 1000; i++) {
+    buf = gst_buffer_new ();
+    GST_BUFFER_OFFSET (buf) = i;
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  g_atomic_int_set (&stop, 1);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  sample = gst_base_sink_get_last_sample (GST_BASE_SINK (h->element));
+  fail_unless (sample != NULL);
+  fail_unless_equals_int (GST_BUFFER_OFFSET (gst_sample_get_buffer (sample)),
+      999);
+  caps = gst_caps_from_string ("mycaps");
+  fail_unless (gst_caps_is_equal (gst_sample_get_caps (sample), caps));
+  gst_caps_unref (caps);
+  gst_sample_unref (sample);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static gpointer
+check_last_sample_caps_func (gpointer data)
+{
+  GstBaseSink *sink = data;
+  volatile gint *stop = g_object_get_data (G_OBJECT (sink), "stop");
+  GstSample *sample;
+  gint n;
+
+  while (!g_atomic_int_get (stop)) {
+    if ((sample = gst_base_sink_get_last_sample (sink))) {
+      /* the caps are those of the buffer, never the ones before */
+      fail_unless (gst_structure_get_int (gst_caps_get_structure
+              (gst_sample_get_caps (sample), 0), "n", &n));
+      fail_unless_equals_int (n,
+          GST_BUFFER_OFFSET (gst_sample_get_buffer (sample)));
+      gst_sample_unref (sample);
+    }
+  }
+  return NULL;
+}
+
+GST_START_TEST (basesink_test_last_sample_caps_change)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GThread *threads[2];
+  volatile gint stop = 0;
+  gchar *caps;
+  guint i;
+
+  h = gst_harness_new_parse ("fakesink sync=false");
+  g_object_set_data (G_OBJECT (h->element), "stop", (gpointer) & stop);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("reader", check_last_sample_caps_func,
+        h->element);
+
+  for (i = 0; i < 200; i++) {
+    caps = g_strdup_printf ("mycaps, n=(int)%u", i);
+    gst_harness_set_src_caps_str (h, caps);
+    g_free (caps);
+
+    buf = gst_buffer_new ();
+    GST_BUFFER_OFFSET (buf) = i;
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+
+  g_atomic_int_set (&stop, 1);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_basesrc_suite (void)
 {
@@ -253,6 +478,10 @@ gst_basesrc_suite (void)
   tcase_add_test (tc, basesink_last_sample_disabled);
   tcase_add_test (tc, basesink_test_gap);
   tcase_add_test (tc, basesink_test_eos_after_playing);
+  tcase_add_test (tc, basesink_test_sync_window);
+  tcase_add_test (tc, basesink_test_predictive_qos);
+  tcase_add_test (tc, basesink_test_last_sample_concurrent);
+  tcase_add_test (tc, basesink_test_last_sample_caps_change);
 
   return s;
 }
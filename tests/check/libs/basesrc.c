@@ -26,7 +26,9 @@
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstconsistencychecker.h>
+#include <gst/check/gstharness.h>
 #include <gst/base/gstbasesrc.h>
+#include <gst/base/gstpushsrc.h>
 
 static GstPadProbeReturn
 eos_event_counter (GstObject * pad, GstPadProbeInfo * info, guint * p_num_eos)
@@ -768,6 +770,394 @@ GST_START_TEST (basesrc_seek_on_last_buffer)
 
 GST_END_TEST;
 
+typedef struct
+{
+  GstClock *clock;
+  guint n_buffers;
+  GstClockTime before;
+  GstClockTime last_dts;
+  gint n_fast;
+  gint n_fast_calibrated;
+} TimestampCheck;
+
+static void
+timestamp_handoff (GstElement * src, GstBuffer * buf, GstPad * pad,
+    TimestampCheck * c)
+{
+  /* from the middle on the clock is one second ahead */
+  if (c->n_buffers == 25) {
+    c->n_fast_calibrated = g_atomic_int_get (&c->n_fast);
+    gst_clock_set_calibration (c->clock, 0, GST_SECOND, 1, 1);
+  }
+
+  c->before = gst_clock_get_time (c->clock) - gst_element_get_base_time (src);
+}
+
+static GstPadProbeReturn
+timestamp_checker (GstPad * pad, GstPadProbeInfo * info, TimestampCheck * c)
+{
+  GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER (info);
+  GstElement *src = GST_PAD_PARENT (pad);
+  GstClockTime now;
+
+  now = gst_clock_get_time (c->clock) - gst_element_get_base_time (src);
+
+  /* the timestamps are running times of the pipeline clock, taken between
+   * the handoff and now */
+  fail_unless (GST_BUFFER_DTS_IS_VALID (buf));
+  fail_unless (GST_BUFFER_DTS (buf) >= c->before);
+  fail_unless (GST_BUFFER_DTS (buf) <= now);
+  if (c->n_buffers > 0)
+    fail_unless (GST_BUFFER_DTS (buf) >= c->last_dts);
+
+  c->last_dts = GST_BUFFER_DTS (buf);
+  c->n_buffers++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+#ifndef GST_DISABLE_GST_DEBUG
+static void
+count_fast_timestamps (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, TimestampCheck * c)
+{
+  if (strstr (gst_debug_message_get (message), "from the monotonic clock"))
+    g_atomic_int_inc (&c->n_fast);
+}
+#endif
+
+/* basesrc_do_timestamp_live:
+ *  - live sources timestamp with the running time of the pipeline clock
+ *  - when it is the plain monotonic system clock it is read directly
+ *  - not anymore once the clock is calibrated
+ */
+GST_START_TEST (basesrc_do_timestamp_live)
+{
+  TimestampCheck check = { NULL, 0, 0, GST_CLOCK_TIME_NONE, 0, 0 };
+  GstElement *src, *sink, *pipe;
+  GstMessage *msg;
+  GstBus *bus;
+  GstPad *srcpad;
+
+  check.clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "clock-type",
+      GST_CLOCK_TYPE_MONOTONIC, NULL);
+#ifndef GST_DISABLE_GST_DEBUG
+  gst_debug_set_threshold_for_name ("basesrc", GST_LEVEL_LOG);
+  gst_debug_add_log_function ((GstLogFunction) count_fast_timestamps, &check,
+      NULL);
+#endif
+
+  pipe = gst_pipeline_new ("pipeline");
+  gst_pipeline_use_clock (GST_PIPELINE (pipe), check.clock);
+  sink = gst_element_factory_make ("fakesink", "sink");
+  src = gst_element_factory_make ("fakesrc", "src");
+
+  fail_unless (gst_bin_add (GST_BIN (pipe), src) == TRUE);
+  fail_unless (gst_bin_add (GST_BIN (pipe), sink) == TRUE);
+  fail_unless (gst_element_link (src, sink) == TRUE);
+
+  g_object_set (src, "is-live", TRUE, "do-timestamp", TRUE, "num-buffers",
+      50, "signal-handoffs", TRUE, NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+  g_signal_connect (src, "handoff", G_CALLBACK (timestamp_handoff), &check);
+
+  srcpad = gst_element_get_static_pad (src, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) timestamp_checker, &check, NULL);
+
+  bus = gst_element_get_bus (pipe);
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  fail_unless_equals_int (check.n_buffers, 50);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+
+#ifndef GST_DISABLE_GST_DEBUG
+  gst_debug_remove_log_function ((GstLogFunction) count_fast_timestamps);
+  /* all but the first buffer before the calibration took the fast path, and
+   * none after it */
+#if !defined (__APPLE__) && !defined (G_OS_WIN32) && \
+    defined (HAVE_POSIX_TIMERS) && defined (HAVE_MONOTONIC_CLOCK) && \
+    defined (HAVE_CLOCK_GETTIME)
+  fail_unless_equals_int (check.n_fast_calibrated, 24);
+#endif
+  fail_unless_equals_int (check.n_fast, check.n_fast_calibrated);
+#endif
+
+  gst_message_unref (msg);
+  gst_object_unref (srcpad);
+  gst_object_unref (bus);
+  gst_object_unref (pipe);
+  gst_object_unref (check.clock);
+}
+
+GST_END_TEST;
+
+#define RANGE_SRC_SIZE 10000
+
+typedef struct
+{
+  GstBaseSrc parent;
+  guint n_fills;
+} GstRangeSrc;
+
+typedef struct
+{
+  GstBaseSrcClass parent_class;
+} GstRangeSrcClass;
+
+static GType gst_range_src_get_type (void);
+
+G_DEFINE_TYPE (GstRangeSrc, gst_range_src, GST_TYPE_BASE_SRC);
+
+static GstStaticPadTemplate range_src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+static gboolean
+gst_range_src_get_size (GstBaseSrc * src, guint64 * size)
+{
+  *size = RANGE_SRC_SIZE;
+  return TRUE;
+}
+
+static gboolean
+gst_range_src_is_seekable (GstBaseSrc * src)
+{
+  return TRUE;
+}
+
+/* every byte is the low byte of its offset */
+static GstFlowReturn
+gst_range_src_fill (GstBaseSrc * src, guint64 offset, guint size,
+    GstBuffer * buf)
+{
+  GstMapInfo map;
+  guint i;
+
+  ((GstRangeSrc *) src)->n_fills++;
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  for (i = 0; i < size; i++)
+    map.data[i] = (offset + i) & 0xff;
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_set_size (buf, size);
+  GST_BUFFER_OFFSET (buf) = offset;
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_range_src_class_init (GstRangeSrcClass * klass)
+{
+  GstBaseSrcClass *basesrc_class = GST_BASE_SRC_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (GST_ELEMENT_CLASS (klass),
+      &range_src_template);
+
+  basesrc_class->get_size = gst_range_src_get_size;
+  basesrc_class->is_seekable = gst_range_src_is_seekable;
+  basesrc_class->fill = gst_range_src_fill;
+}
+
+static void
+gst_range_src_init (GstRangeSrc * src)
+{
+}
+
+static void
+check_range (GstPad * pad, guint64 offset, guint length)
+{
+  GstBuffer *buf = NULL;
+  GstMapInfo map;
+  guint i;
+
+  fail_unless_equals_int (gst_pad_get_range (pad, offset, length, &buf),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_get_size (buf), length);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), offset);
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  for (i = 0; i < length; i++)
+    fail_unless_equals_int (map.data[i], (offset + i) & 0xff);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+}
+
+/* basesrc_read_cache:
+ *  - small pull mode reads are served from cached blocks
+ */
+GST_START_TEST (basesrc_read_cache)
+{
+  GstRangeSrc *src;
+  GstBuffer *buf = NULL;
+  GstPad *pad;
+
+  src = g_object_new (gst_range_src_get_type (), NULL);
+  gst_base_src_set_read_cache (GST_BASE_SRC (src), 1024, 2);
+  pad = GST_BASE_SRC_PAD (src);
+
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+
+  /* one fill for all reads within the first block */
+  check_range (pad, 0, 8);
+  check_range (pad, 100, 16);
+  check_range (pad, 1000, 24);
+  fail_unless_equals_int (src->n_fills, 1);
+
+  /* a read across two blocks fetches both at once */
+  check_range (pad, 2040, 16);
+  fail_unless_equals_int (src->n_fills, 2);
+  check_range (pad, 2048, 16);
+  fail_unless_equals_int (src->n_fills, 2);
+
+  /* the least recently used block was dropped */
+  check_range (pad, 3100, 8);
+  fail_unless_equals_int (src->n_fills, 3);
+  check_range (pad, 0, 8);
+  fail_unless_equals_int (src->n_fills, 4);
+
+  /* the last block is short, reads past the end are still EOS */
+  check_range (pad, RANGE_SRC_SIZE - 8, 8);
+  fail_unless_equals_int (gst_pad_get_range (pad, RANGE_SRC_SIZE, 8, &buf),
+      GST_FLOW_EOS);
+
+  /* large reads bypass the cache */
+  check_range (pad, 4096, 4096);
+
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, FALSE));
+  gst_object_unref (src);
+}
+
+GST_END_TEST;
+
+#define BURST_SIZE 3
+#define BURST_DURATION (10 * GST_MSECOND)
+
+typedef struct
+{
+  GstPushSrc parent;
+  guint n_buffers;
+} GstBurstSrc;
+
+typedef struct
+{
+  GstPushSrcClass parent_class;
+} GstBurstSrcClass;
+
+static GType gst_burst_src_get_type (void);
+
+G_DEFINE_TYPE (GstBurstSrc, gst_burst_src, GST_TYPE_PUSH_SRC);
+
+static void
+gst_burst_src_get_times (GstBaseSrc * src, GstBuffer * buf,
+    GstClockTime * start, GstClockTime * end)
+{
+  if (gst_base_src_is_live (src)) {
+    *start = GST_BUFFER_PTS (buf);
+    *end = *start + GST_BUFFER_DURATION (buf);
+  }
+}
+
+static GstFlowReturn
+gst_burst_src_create_list (GstPushSrc * src, GstBufferList ** list)
+{
+  GstBurstSrc *self = (GstBurstSrc *) src;
+  guint i;
+
+  *list = gst_buffer_list_new_sized (BURST_SIZE);
+  for (i = 0; i < BURST_SIZE; i++) {
+    GstBuffer *buf = gst_buffer_new ();
+
+    GST_BUFFER_PTS (buf) = self->n_buffers++ * BURST_DURATION;
+    GST_BUFFER_DURATION (buf) = BURST_DURATION;
+    gst_buffer_list_add (*list, buf);
+  }
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_burst_src_class_init (GstBurstSrcClass * klass)
+{
+  GstBaseSrcClass *basesrc_class = GST_BASE_SRC_CLASS (klass);
+  GstPushSrcClass *pushsrc_class = GST_PUSH_SRC_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (GST_ELEMENT_CLASS (klass),
+      &range_src_template);
+
+  basesrc_class->get_times = gst_burst_src_get_times;
+  pushsrc_class->create_list = gst_burst_src_create_list;
+}
+
+static void
+gst_burst_src_init (GstBurstSrc * src)
+{
+  gst_base_src_set_format (GST_BASE_SRC (src), GST_FORMAT_TIME);
+}
+
+/* pushsrc_create_list:
+ *  - all buffers of the lists are pushed in order
+ */
+GST_START_TEST (pushsrc_create_list)
+{
+  GstElement *src;
+  GstHarness *h;
+  guint i;
+
+  src = g_object_new (gst_burst_src_get_type (), NULL);
+  h = gst_harness_new_with_element (src, NULL, "src");
+  gst_harness_play (h);
+
+  for (i = 0; i < 2 * BURST_SIZE; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), i * BURST_DURATION);
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+  gst_object_unref (src);
+}
+
+GST_END_TEST;
+
+/* pushsrc_create_list_live:
+ *  - the first buffer of a list is synchronised and all buffers of the list
+ *    get the same timestamp offset
+ */
+GST_START_TEST (pushsrc_create_list_live)
+{
+  GstElement *src;
+  GstHarness *h;
+  GstBuffer *bufs[BURST_SIZE];
+  guint i;
+
+  src = g_object_new (gst_burst_src_get_type (), NULL);
+  gst_base_src_set_live (GST_BASE_SRC (src), TRUE);
+  h = gst_harness_new_with_element (src, NULL, "src");
+  gst_harness_set_time (h, 5 * GST_SECOND);
+  gst_harness_play (h);
+
+  fail_unless (gst_harness_crank_single_clock_wait (h));
+  for (i = 0; i < BURST_SIZE; i++)
+    bufs[i] = gst_harness_pull (h);
+
+  fail_unless (GST_BUFFER_PTS_IS_VALID (bufs[0]));
+  for (i = 1; i < BURST_SIZE; i++)
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (bufs[i]),
+        GST_BUFFER_PTS (bufs[0]) + i * BURST_DURATION);
+
+  for (i = 0; i < BURST_SIZE; i++)
+    gst_buffer_unref (bufs[i]);
+  gst_harness_teardown (h);
+  gst_object_unref (src);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_basesrc_suite (void)
 {
@@ -783,6 +1173,10 @@ gst_basesrc_suite (void)
   tcase_add_test (tc, basesrc_eos_events_pull_live_eos);
   tcase_add_test (tc, basesrc_seek_events_rate_update);
   tcase_add_test (tc, basesrc_seek_on_last_buffer);
+  tcase_add_test (tc, basesrc_do_timestamp_live);
+  tcase_add_test (tc, basesrc_read_cache);
+  tcase_add_test (tc, pushsrc_create_list);
+  tcase_add_test (tc, pushsrc_create_list_live);
 
   return s;
 }
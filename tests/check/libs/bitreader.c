@@ -235,6 +235,78 @@ GST_START_TEST (test_position_tracking)
 
 GST_END_TEST;
 
+GST_START_TEST (test_peek_bits_positions)
+{
+  guint8 data[16];
+  GstBitReader reader = GST_BIT_READER_INIT (data, 16);
+  guint pos, nbits, i;
+  guint32 val, expected;
+
+  for (i = 0; i < 16; i++)
+    data[i] = i * 37 + 11;
+
+  /* the 64 bit fast path and the bytewise reading must agree */
+  for (pos = 0; pos < 16 * 8; pos++) {
+    for (nbits = 1; nbits <= 32 && pos + nbits <= 16 * 8; nbits++) {
+      expected = 0;
+      for (i = pos; i < pos + nbits; i++)
+        expected = (expected << 1) | ((data[i / 8] >> (7 - i % 8)) & 1);
+
+      fail_unless (gst_bit_reader_set_pos (&reader, pos));
+      fail_unless (gst_bit_reader_peek_bits_uint32 (&reader, &val, nbits));
+      fail_unless_equals_int (val, expected);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_exp_golomb)
+{
+  /* ue: 0, 1, 2, 3, 7, se: -1, 2, -3 */
+  guint8 data[] = { 0xa6, 0x41, 0x0c, 0x87 };
+  /* 31 leading zeros and the maximum value */
+  guint8 max[] = { 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xfe };
+  guint8 zeros[] = { 0x00, 0x00, 0x00, 0x00, 0xff };
+  GstBitReader reader = GST_BIT_READER_INIT (data, sizeof (data));
+  guint32 uval;
+  gint32 sval;
+
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+  fail_unless_equals_int (uval, 0);
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+  fail_unless_equals_int (uval, 1);
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+  fail_unless_equals_int (uval, 2);
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+  fail_unless_equals_int (uval, 3);
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+  fail_unless_equals_int (uval, 7);
+  fail_unless (gst_bit_reader_get_exp_golomb_int32 (&reader, &sval));
+  fail_unless_equals_int (sval, -1);
+  fail_unless (gst_bit_reader_get_exp_golomb_int32 (&reader, &sval));
+  fail_unless_equals_int (sval, 2);
+  fail_unless (gst_bit_reader_get_exp_golomb_int32 (&reader, &sval));
+  fail_unless_equals_int (sval, -3);
+  fail_unless_equals_int (gst_bit_reader_get_remaining (&reader), 0);
+  fail_if (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+
+  gst_bit_reader_init (&reader, max, sizeof (max));
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+  fail_unless_equals_uint64 (uval, G_MAXUINT32 - 1);
+
+  /* truncated code */
+  gst_bit_reader_init (&reader, max, sizeof (max) - 1);
+  fail_if (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+  fail_unless_equals_int (gst_bit_reader_get_pos (&reader), 0);
+
+  /* too many leading zeros */
+  gst_bit_reader_init (&reader, zeros, sizeof (zeros));
+  fail_if (gst_bit_reader_get_exp_golomb_uint32 (&reader, &uval));
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bit_reader_suite (void)
 {
@@ -246,6 +318,8 @@ gst_bit_reader_suite (void)
   tcase_add_test (tc_chain, test_initialization);
   tcase_add_test (tc_chain, test_get_bits);
   tcase_add_test (tc_chain, test_position_tracking);
+  tcase_add_test (tc_chain, test_peek_bits_positions);
+  tcase_add_test (tc_chain, test_exp_golomb);
 
   return s;
 }
@@ -818,6 +818,72 @@ GST_START_TEST (test_sub_reader)
 
 GST_END_TEST;
 
+/* the start code scan must find the same position as a byte by byte scan
+ * wherever the start code is */
+GST_START_TEST (test_scan_start_code)
+{
+  GstByteReader reader;
+  guint8 data[100];
+  guint32 val;
+  guint pos, size;
+
+  for (size = 4; size <= sizeof (data); size++) {
+    for (pos = 0; pos + 4 <= size; pos++) {
+      memset (data, 0xff, sizeof (data));
+      /* leading zeros that are no start code */
+      if (pos >= 2)
+        data[pos - 2] = 0x00;
+      data[pos] = 0x00;
+      data[pos + 1] = 0x00;
+      data[pos + 2] = 0x01;
+      data[pos + 3] = 0xb3;
+
+      gst_byte_reader_init (&reader, data, size);
+      fail_unless_equals_int (gst_byte_reader_masked_scan_uint32_peek (&reader,
+              0xffffff00, 0x00000100, 0, size, &val), pos);
+      fail_unless_equals_int (val, 0x000001b3);
+
+      /* not found when the byte after the start code is missing */
+      gst_byte_reader_init (&reader, data, pos + 3);
+      fail_unless_equals_int (gst_byte_reader_masked_scan_uint32 (&reader,
+              0xffffff00, 0x00000100, 0, pos + 3), -1);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_get_uint_array)
+{
+  guint8 data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11
+  };
+  GstByteReader reader = GST_BYTE_READER_INIT (data, sizeof (data));
+  guint16 v16[2];
+  guint32 v32[2];
+  guint64 v64[1];
+
+  /* unaligned start */
+  fail_unless (gst_byte_reader_skip (&reader, 1));
+  fail_unless (gst_byte_reader_get_uint16_be_array (&reader, v16, 2));
+  fail_unless_equals_int (v16[0], 0x0203);
+  fail_unless_equals_int (v16[1], 0x0405);
+  fail_unless (gst_byte_reader_get_uint32_le_array (&reader, v32, 1));
+  fail_unless_equals_uint64 (v32[0], 0x09080706);
+  fail_unless (gst_byte_reader_get_uint64_be_array (&reader, v64, 1));
+  fail_unless_equals_uint64 (v64[0], G_GUINT64_CONSTANT (0x0a0b0c0d0e0f1011));
+  fail_unless_equals_int (gst_byte_reader_get_remaining (&reader), 0);
+
+  /* not enough data leaves the position unchanged */
+  fail_unless (gst_byte_reader_set_pos (&reader, 10));
+  fail_if (gst_byte_reader_get_uint32_be_array (&reader, v32, 2));
+  fail_unless_equals_int (gst_byte_reader_get_pos (&reader), 10);
+  fail_unless (gst_byte_reader_get_uint16_le_array (&reader, v16, 0));
+  fail_if (gst_byte_reader_get_uint64_le_array (&reader, v64, G_MAXUINT));
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_byte_reader_suite (void)
 {
@@ -833,8 +899,10 @@ gst_byte_reader_suite (void)
   tcase_add_test (tc_chain, test_get_int_be);
   tcase_add_test (tc_chain, test_get_float_le);
   tcase_add_test (tc_chain, test_get_float_be);
+  tcase_add_test (tc_chain, test_get_uint_array);
   tcase_add_test (tc_chain, test_position_tracking);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_start_code);
   tcase_add_test (tc_chain, test_string_funcs);
   tcase_add_test (tc_chain, test_dup_string);
   tcase_add_test (tc_chain, test_sub_reader);
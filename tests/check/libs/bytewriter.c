@@ -236,6 +236,53 @@ GST_START_TEST (test_fill)
 }
 
 GST_END_TEST;
+GST_START_TEST (test_put_uint_array)
+{
+  GstByteWriter writer;
+  GstByteReader reader;
+  guint32 vals[1000], vals2[1000];
+  guint16 vals16[] = { 0x0102, 0x0304 };
+  guint8 data[] = { 0x02, 0x01, 0x04, 0x03 };
+  guint8 *data2;
+  guint i, size;
+
+  for (i = 0; i < G_N_ELEMENTS (vals); i++)
+    vals[i] = i * 0x01020304;
+
+  gst_byte_writer_init (&writer);
+  fail_unless (gst_byte_writer_put_uint8 (&writer, 0));
+  fail_unless (gst_byte_writer_put_uint32_be_array (&writer, vals,
+          G_N_ELEMENTS (vals)));
+  fail_unless (gst_byte_writer_put_uint16_le_array (&writer, vals16, 2));
+  size = gst_byte_writer_get_size (&writer);
+  fail_unless_equals_int (size, 1 + sizeof (vals) + 4);
+
+  data2 = gst_byte_writer_reset_and_get_data (&writer);
+  fail_unless (memcmp (data2 + size - 4, data, 4) == 0);
+
+  gst_byte_reader_init (&reader, data2, size);
+  fail_unless (gst_byte_reader_skip (&reader, 1));
+  for (i = 0; i < 10; i++) {
+    guint32 val;
+
+    fail_unless (gst_byte_reader_peek_uint32_be (&reader, &val));
+    fail_unless_equals_uint64 (val, vals[i]);
+    fail_unless (gst_byte_reader_skip (&reader, 4));
+  }
+  fail_unless (gst_byte_reader_get_uint32_be_array (&reader, vals2 + 10,
+          G_N_ELEMENTS (vals) - 10));
+  fail_unless (memcmp (vals + 10, vals2 + 10, sizeof (vals) - 40) == 0);
+  g_free (data2);
+
+  /* fixed size writers fail without writing anything */
+  gst_byte_writer_init_with_size (&writer, 4, TRUE);
+  fail_if (gst_byte_writer_put_uint32_le_array (&writer, vals, 2));
+  fail_unless_equals_int (gst_byte_writer_get_pos (&writer), 0);
+  gst_byte_writer_reset (&writer);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_byte_writer_suite (void)
 {
@@ -250,6 +297,7 @@ gst_byte_writer_suite (void)
   tcase_add_test (tc_chain, test_from_data);
   tcase_add_test (tc_chain, test_put_data_strings);
   tcase_add_test (tc_chain, test_fill);
+  tcase_add_test (tc_chain, test_put_uint_array);
 
   return s;
 }
@@ -687,6 +687,115 @@ GST_START_TEST (test_collect_default)
 
 GST_END_TEST;
 
+#define ORDER_PADS 8
+#define ORDER_BUFFERS 10
+
+/* timestamps of all pads interleave, the last pad has the earliest buffers */
+#define ORDER_TS(pad, buf) \
+    (((buf) * ORDER_PADS + ORDER_PADS - 1 - (pad)) * GST_MSECOND)
+
+static guint order_count;
+static GstClockTime order_last_ts;
+static gboolean order_eos;
+
+static GstFlowReturn
+order_buffer_cb (GstCollectPads * pads, GstCollectData * data,
+    GstBuffer * buf, gpointer user_data)
+{
+  if (buf == NULL) {
+    g_mutex_lock (&lock);
+    order_eos = TRUE;
+    g_cond_signal (&cond);
+    g_mutex_unlock (&lock);
+    return GST_FLOW_EOS;
+  }
+
+  if (order_count > 0)
+    fail_unless (GST_BUFFER_TIMESTAMP (buf) > order_last_ts);
+  order_last_ts = GST_BUFFER_TIMESTAMP (buf);
+  order_count++;
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+static gpointer
+push_buffers (gpointer user_data)
+{
+  GstPad *pad = user_data;
+  GstSegment segment;
+  GstCaps *caps;
+  guint i, n;
+
+  n = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (pad), "num"));
+
+  gst_pad_push_event (pad, gst_event_new_stream_start ("test"));
+  caps = gst_caps_new_empty_simple ("foo/x-bar");
+  gst_pad_push_event (pad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (pad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < ORDER_BUFFERS; i++) {
+    GstBuffer *buf = gst_buffer_new ();
+
+    GST_BUFFER_TIMESTAMP (buf) = ORDER_TS (n, i);
+    fail_unless_equals_int (gst_pad_push (pad, buf), GST_FLOW_OK);
+  }
+  gst_pad_push_event (pad, gst_event_new_eos ());
+
+  return NULL;
+}
+
+GST_START_TEST (test_collect_default_order)
+{
+  GstPad *src[ORDER_PADS], *sink[ORDER_PADS];
+  GThread *thread[ORDER_PADS];
+  guint i;
+
+  order_count = 0;
+  order_eos = FALSE;
+  gst_collect_pads_set_buffer_function (collect, order_buffer_cb, NULL);
+
+  for (i = 0; i < ORDER_PADS; i++) {
+    src[i] = gst_pad_new_from_static_template (&srctemplate, NULL);
+    sink[i] = gst_pad_new_from_static_template (&sinktemplate, NULL);
+    fail_unless (gst_pad_link (src[i], sink[i]) == GST_PAD_LINK_OK);
+    fail_unless (gst_collect_pads_add_pad (collect, sink[i],
+            sizeof (GstCollectData), NULL, TRUE) != NULL);
+    g_object_set_data (G_OBJECT (src[i]), "num", GUINT_TO_POINTER (i));
+    gst_pad_set_active (src[i], TRUE);
+  }
+
+  gst_collect_pads_start (collect);
+
+  /* all pads are waiting, so the buffers come out in timestamp order no
+   * matter in which order the threads push them */
+  for (i = 0; i < ORDER_PADS; i++)
+    thread[i] = g_thread_new ("gst-check", push_buffers, src[i]);
+
+  g_mutex_lock (&lock);
+  while (!order_eos)
+    g_cond_wait (&cond, &lock);
+  g_mutex_unlock (&lock);
+
+  for (i = 0; i < ORDER_PADS; i++)
+    g_thread_join (thread[i]);
+
+  fail_unless_equals_int (order_count, ORDER_PADS * ORDER_BUFFERS);
+  fail_unless_equals_uint64 (order_last_ts,
+      ORDER_TS (0, ORDER_BUFFERS - 1));
+
+  gst_collect_pads_stop (collect);
+
+  for (i = 0; i < ORDER_PADS; i++) {
+    gst_collect_pads_remove_pad (collect, sink[i]);
+    gst_object_unref (src[i]);
+    gst_object_unref (sink[i]);
+  }
+}
+
+GST_END_TEST;
 
 #define NUM_BUFFERS 3
 static void
@@ -1093,6 +1202,7 @@ gst_collect_pads_suite (void)
   suite_add_tcase (suite, buffers);
   tcase_add_checked_fixture (buffers, setup_buffer_cb, teardown);
   tcase_add_test (buffers, test_collect_default);
+  tcase_add_test (buffers, test_collect_default_order);
 
   pipeline = tcase_create ("pipeline");
   suite_add_tcase (suite, pipeline);
@@ -24,6 +24,7 @@
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <math.h>
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
 #include <gst/controller/gstinterpolationcontrolsource.h>
@@ -730,6 +731,52 @@ GST_START_TEST (controller_interpolation_linear_value_array)
 GST_END_TEST;
 
 /* test if values below minimum and above maximum are clipped */
+/* get_value_array() gives the same values as get_value() in all modes, also
+ * before the first and after the last control point */
+GST_START_TEST (controller_interpolation_value_array_all_modes)
+{
+  GstInterpolationMode modes[] = { GST_INTERPOLATION_MODE_NONE,
+    GST_INTERPOLATION_MODE_LINEAR, GST_INTERPOLATION_MODE_CUBIC,
+    GST_INTERPOLATION_MODE_CUBIC_MONOTONIC
+  };
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  gdouble values[200], value;
+  guint i, m;
+
+  cs = gst_interpolation_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+
+  fail_unless (gst_timed_value_control_source_set (tvcs, 1 * GST_SECOND, 0.0));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 2 * GST_SECOND, 1.0));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 4 * GST_SECOND, 0.5));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 5 * GST_SECOND, 0.8));
+
+  for (m = 0; m < G_N_ELEMENTS (modes); m++) {
+    g_object_set (cs, "mode", modes[m], NULL);
+
+    /* the interval does not divide the distance of the control points */
+    fail_unless (gst_control_source_get_value_array (cs, 0,
+            37 * GST_MSECOND, G_N_ELEMENTS (values), values));
+
+    for (i = 0; i < G_N_ELEMENTS (values); i++) {
+      GstClockTime ts = i * 37 * GST_MSECOND;
+
+      if (ts < 1 * GST_SECOND) {
+        fail_unless (isnan (values[i]));
+        fail_if (gst_control_source_get_value (cs, ts, &value));
+      } else {
+        fail_unless (gst_control_source_get_value (cs, ts, &value));
+        fail_unless_equals_float (values[i], value);
+      }
+    }
+  }
+
+  gst_object_unref (cs);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (controller_interpolation_linear_invalid_values)
 {
   GstControlSource *cs;
@@ -1006,6 +1053,67 @@ GST_START_TEST (controller_interpolation_set_from_list)
 
 GST_END_TEST;
 
+/* test many control points, set in and out of order */
+GST_START_TEST (controller_interpolation_set_from_list_many)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  GstTimedValue *tvals;
+  GSList *list = NULL;
+  gdouble v;
+  gint i, n = 10000;
+
+  cs = gst_interpolation_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_NONE, NULL);
+
+  /* even points in order, then odd points backwards */
+  tvals = g_new0 (GstTimedValue, n);
+  for (i = 0; i < n; i++) {
+    gint p = i < n / 2 ? 2 * i : 2 * (n - i) - 1;
+
+    tvals[i].timestamp = p * GST_MSECOND;
+    tvals[i].value = p;
+    list = g_slist_prepend (list, &tvals[i]);
+  }
+  list = g_slist_reverse (list);
+  fail_unless (gst_timed_value_control_source_set_from_list (tvcs, list));
+  fail_unless_equals_int (gst_timed_value_control_source_get_count (tvcs), n);
+
+  /* lookups forwards, backwards and between points */
+  for (i = 0; i < n; i++) {
+    fail_unless (gst_control_source_get_value (cs, i * GST_MSECOND, &v));
+    fail_unless_equals_float (v, i);
+  }
+  for (i = n - 1; i >= 0; i -= 7) {
+    fail_unless (gst_control_source_get_value (cs,
+            i * GST_MSECOND + GST_USECOND, &v));
+    fail_unless_equals_float (v, i);
+  }
+
+  /* changing existing values keeps the count */
+  for (i = 0; i < n; i++)
+    tvals[i].value = -1.0;
+  fail_unless (gst_timed_value_control_source_set_from_list (tvcs, list));
+  fail_unless_equals_int (gst_timed_value_control_source_get_count (tvcs), n);
+  fail_unless (gst_control_source_get_value (cs, 1234 * GST_MSECOND, &v));
+  fail_unless_equals_float (v, -1.0);
+
+  /* removing the point at the last lookup */
+  fail_unless (gst_timed_value_control_source_unset (tvcs,
+          1234 * GST_MSECOND));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 1233 * GST_MSECOND,
+          5.0));
+  fail_unless (gst_control_source_get_value (cs, 1234 * GST_MSECOND, &v));
+  fail_unless_equals_float (v, 5.0);
+
+  g_slist_free (list);
+  g_free (tvals);
+  gst_object_unref (cs);
+}
+
+GST_END_TEST;
+
 
 /* test linear interpolation for ts < first control point */
 GST_START_TEST (controller_interpolation_linear_before_ts0)
@@ -1092,6 +1200,58 @@ GST_START_TEST (controller_interpolation_linear_enums)
 
 GST_END_TEST;
 
+static void
+count_notify (GObject * obj, GParamSpec * pspec, gint * count)
+{
+  (*count)++;
+}
+
+/* test that properties are only set when their value changes */
+GST_START_TEST (controller_sync_unchanged_values)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  GstElement *elem;
+  gint i, count = 0;
+
+  elem = gst_element_factory_make ("testobj", NULL);
+
+  cs = gst_interpolation_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+
+  fail_unless (gst_object_add_control_binding (GST_OBJECT (elem),
+          gst_direct_control_binding_new (GST_OBJECT (elem), "boolean", cs)));
+
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+  fail_unless (gst_timed_value_control_source_set (tvcs, 0 * GST_SECOND, 0.0));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 1 * GST_SECOND, 1.0));
+
+  g_signal_connect (elem, "notify::boolean", G_CALLBACK (count_notify),
+      &count);
+
+  /* the control value changes on every sync, the property only once after
+   * the first sync */
+  for (i = 0; i <= 100; i++)
+    gst_object_sync_values (GST_OBJECT (elem), i * 10 * GST_MSECOND);
+  fail_unless_equals_int (count, 2);
+  fail_unless (GST_TEST_OBJ (elem)->val_boolean);
+
+  /* going back always sets the value */
+  gst_object_sync_values (GST_OBJECT (elem), 0);
+  fail_unless_equals_int (count, 3);
+  fail_if (GST_TEST_OBJ (elem)->val_boolean);
+
+  /* disabled bindings are skipped */
+  gst_object_set_control_binding_disabled (GST_OBJECT (elem), "boolean", TRUE);
+  gst_object_sync_values (GST_OBJECT (elem), 1 * GST_SECOND);
+  fail_unless_equals_int (count, 3);
+
+  gst_object_unref (cs);
+  gst_object_unref (elem);
+}
+
+GST_END_TEST;
+
 /* test timed value counts */
 GST_START_TEST (controller_timed_value_count)
 {
@@ -1439,6 +1599,38 @@ GST_START_TEST (controller_lfo_triangle)
 GST_END_TEST;
 
 /* test timed value handling in trigger mode */
+/* test that value arrays match the single values for all waveforms */
+GST_START_TEST (controller_lfo_value_array)
+{
+  GstControlSource *cs;
+  gdouble values[1000], v;
+  GstClockTime ts, interval = GST_SECOND / 300;
+  gint waveform, i;
+
+  cs = gst_lfo_control_source_new ();
+
+  for (waveform = GST_LFO_WAVEFORM_SINE; waveform <= GST_LFO_WAVEFORM_TRIANGLE;
+      waveform++) {
+    g_object_set (cs, "waveform", waveform, "frequency", 3.3,
+        "timeshift", 250 * GST_MSECOND, "amplitude", 0.5, "offset", 0.5, NULL);
+
+    /* starting before the timeshift, covering several periods */
+    fail_unless (gst_control_source_get_value_array (cs, 100 * GST_MSECOND,
+            interval, G_N_ELEMENTS (values), values));
+    for (i = 0; i < G_N_ELEMENTS (values); i++) {
+      ts = 100 * GST_MSECOND + i * interval;
+      fail_unless (gst_control_source_get_value (cs, ts, &v));
+      fail_unless (fabs (values[i] - v) < 1e-12,
+          "waveform %d at %" GST_TIME_FORMAT ": %lf != %lf", waveform,
+          GST_TIME_ARGS (ts), values[i], v);
+    }
+  }
+
+  gst_object_unref (cs);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (controller_trigger_exact)
 {
   GstControlSource *cs;
@@ -1651,12 +1843,15 @@ gst_controller_suite (void)
   tcase_add_test (tc, controller_interpolation_unset_all);
   tcase_add_test (tc, controller_interpolation_linear_absolute_value_array);
   tcase_add_test (tc, controller_interpolation_linear_value_array);
+  tcase_add_test (tc, controller_interpolation_value_array_all_modes);
   tcase_add_test (tc, controller_interpolation_linear_invalid_values);
   tcase_add_test (tc, controller_interpolation_linear_default_values);
   tcase_add_test (tc, controller_interpolation_linear_disabled);
   tcase_add_test (tc, controller_interpolation_set_from_list);
+  tcase_add_test (tc, controller_interpolation_set_from_list_many);
   tcase_add_test (tc, controller_interpolation_linear_before_ts0);
   tcase_add_test (tc, controller_interpolation_linear_enums);
+  tcase_add_test (tc, controller_sync_unchanged_values);
   tcase_add_test (tc, controller_timed_value_count);
   tcase_add_test (tc, controller_lfo_sine);
   tcase_add_test (tc, controller_lfo_sine_timeshift);
@@ -1664,6 +1859,7 @@ gst_controller_suite (void)
   tcase_add_test (tc, controller_lfo_saw);
   tcase_add_test (tc, controller_lfo_rsaw);
   tcase_add_test (tc, controller_lfo_triangle);
+  tcase_add_test (tc, controller_lfo_value_array);
   tcase_add_test (tc, controller_trigger_exact);
   tcase_add_test (tc, controller_trigger_tolerance);
   tcase_add_test (tc, controller_proxy);
@@ -0,0 +1,155 @@
+/* GStreamer
+ *
+ * unit test for GstDataQueue
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstdataqueue.h>
+
+#define N_ITEMS 1000
+#define MAX_VISIBLE 10
+
+static gboolean
+check_full (GstDataQueue * queue, guint visible, guint bytes, guint64 time,
+    gpointer checkdata)
+{
+  return visible >= MAX_VISIBLE;
+}
+
+static void
+free_item (GstDataQueueItem * item)
+{
+  gst_mini_object_unref (item->object);
+  g_slice_free (GstDataQueueItem, item);
+}
+
+static GstDataQueueItem *
+new_item (guint num)
+{
+  GstDataQueueItem *item = g_slice_new0 (GstDataQueueItem);
+  GstBuffer *buf = gst_buffer_new ();
+
+  GST_BUFFER_OFFSET (buf) = num;
+  item->object = GST_MINI_OBJECT_CAST (buf);
+  item->size = 1;
+  item->duration = GST_MSECOND;
+  item->visible = TRUE;
+  item->destroy = (GDestroyNotify) free_item;
+
+  return item;
+}
+
+GST_START_TEST (test_pop_many)
+{
+  GstDataQueue *queue;
+  GstDataQueueItem *items[4];
+  GstDataQueueSize level;
+  guint i;
+
+  queue = gst_data_queue_new (check_full, NULL, NULL, NULL);
+
+  for (i = 0; i < 6; i++)
+    fail_unless (gst_data_queue_push (queue, new_item (i)));
+
+  fail_unless_equals_int (gst_data_queue_pop_many (queue, items, 4), 4);
+  for (i = 0; i < 4; i++) {
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (items[i]->object), i);
+    items[i]->destroy (items[i]);
+  }
+
+  gst_data_queue_get_level (queue, &level);
+  fail_unless_equals_int (level.visible, 2);
+  fail_unless_equals_int (level.bytes, 2);
+  fail_unless_equals_uint64 (level.time, 2 * GST_MSECOND);
+
+  /* only the available items are returned */
+  fail_unless_equals_int (gst_data_queue_pop_many (queue, items, 4), 2);
+  for (i = 0; i < 2; i++) {
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (items[i]->object), i + 4);
+    items[i]->destroy (items[i]);
+  }
+  fail_unless (gst_data_queue_is_empty (queue));
+
+  /* nothing is returned when flushing */
+  gst_data_queue_set_flushing (queue, TRUE);
+  fail_unless_equals_int (gst_data_queue_pop_many (queue, items, 4), 0);
+
+  g_object_unref (queue);
+}
+
+GST_END_TEST;
+
+static gpointer
+push_items (GstDataQueue * queue)
+{
+  guint i;
+
+  for (i = 0; i < N_ITEMS; i++)
+    fail_unless (gst_data_queue_push (queue, new_item (i)));
+
+  return NULL;
+}
+
+GST_START_TEST (test_pop_many_threaded)
+{
+  GstDataQueue *queue;
+  GstDataQueueItem *items[MAX_VISIBLE];
+  GThread *thread;
+  guint i, n, count = 0;
+
+  queue = gst_data_queue_new (check_full, NULL, NULL, NULL);
+
+  thread = g_thread_new ("push", (GThreadFunc) push_items, queue);
+
+  /* the writer blocks on the full queue and is woken up by the reader */
+  while (count < N_ITEMS) {
+    n = gst_data_queue_pop_many (queue, items, MAX_VISIBLE);
+    fail_unless (n > 0);
+    for (i = 0; i < n; i++) {
+      fail_unless_equals_uint64 (GST_BUFFER_OFFSET (items[i]->object), count);
+      items[i]->destroy (items[i]);
+      count++;
+    }
+  }
+
+  g_thread_join (thread);
+  fail_unless (gst_data_queue_is_empty (queue));
+
+  g_object_unref (queue);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_data_queue_suite (void)
+{
+  Suite *s = suite_create ("GstDataQueue");
+  TCase *tc = tcase_create ("general");
+
+  suite_add_tcase (s, tc);
+  tcase_add_test (tc, test_pop_many);
+  tcase_add_test (tc, test_pop_many_threaded);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_data_queue);
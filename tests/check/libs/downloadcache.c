@@ -0,0 +1,259 @@
+/* GStreamer
+ *
+ * unit test for the download cache shared between downloadbuffer elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib/gstdio.h>
+
+#include <gst/check/gstcheck.h>
+
+/* not public API */
+#include "../../../plugins/elements/gstsparsefile.c"
+#include "../../../plugins/elements/gstdownloadcache.c"
+
+static gchar *
+make_template (void)
+{
+  return g_build_filename (g_get_tmp_dir (), "gstdownloadcache-XXXXXX",
+      NULL);
+}
+
+static void
+count_notify (GstObject * owner)
+{
+  gint count = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (owner), "n"));
+
+  g_object_set_data (G_OBJECT (owner), "n", GINT_TO_POINTER (count + 1));
+}
+
+static gint
+get_notify_count (GstObject * owner)
+{
+  return GPOINTER_TO_INT (g_object_get_data (G_OBJECT (owner), "n"));
+}
+
+static void
+write_data (GstDownloadCache * cache, GstObject * owner, gsize offset,
+    gsize count)
+{
+  gchar data[100] = { 0, };
+  gsize res;
+
+  fail_unless (count <= sizeof (data));
+
+  gst_download_cache_lock (cache);
+  res = gst_sparse_file_write (gst_download_cache_get_file (cache), offset,
+      data, count, NULL, NULL);
+  gst_download_cache_unlock (cache);
+  fail_unless_equals_int (res, count);
+
+  gst_download_cache_written (cache, owner, offset + count);
+  gst_download_cache_notify (cache, owner);
+}
+
+GST_START_TEST (test_shared)
+{
+  GstDownloadCache *cache1, *cache2;
+  GstObject *owner1, *owner2;
+  gchar *template, *location;
+  gsize start, stop;
+
+  template = make_template ();
+  owner1 = gst_object_ref_sink (gst_pad_new ("owner1", GST_PAD_SINK));
+  owner2 = gst_object_ref_sink (gst_pad_new ("owner2", GST_PAD_SINK));
+
+  cache1 = gst_download_cache_acquire ("http://example.com/1", template,
+      FALSE, 1000, owner1, count_notify, NULL);
+  fail_unless (cache1 != NULL);
+  cache2 = gst_download_cache_acquire ("http://example.com/1", template,
+      FALSE, 1000, owner2, count_notify, NULL);
+  fail_unless (cache1 == cache2);
+
+  /* writes of one user are seen by the other */
+  write_data (cache1, owner1, 0, 100);
+  fail_unless_equals_int (get_notify_count (owner1), 0);
+  fail_unless_equals_int (get_notify_count (owner2), 1);
+
+  gst_download_cache_lock (cache2);
+  fail_unless (gst_sparse_file_get_range_after (gst_download_cache_get_file
+          (cache2), 0, &start, &stop));
+  fail_unless_equals_int (start, 0);
+  fail_unless_equals_int (stop, 100);
+
+  /* owner1 just wrote up to 100 */
+  fail_unless (gst_download_cache_is_filled_by_other (cache2, owner2, 50, 50));
+  fail_unless (gst_download_cache_is_filled_by_other (cache2, owner2, 100,
+          50));
+  fail_if (gst_download_cache_is_filled_by_other (cache2, owner2, 101, 50));
+  fail_if (gst_download_cache_is_filled_by_other (cache2, owner2, 0, 50));
+  fail_if (gst_download_cache_is_filled_by_other (cache2, owner1, 50, 50));
+  gst_download_cache_unlock (cache2);
+
+  /* the other user is woken up on release */
+  gst_download_cache_release (cache1, owner1);
+  fail_unless_equals_int (get_notify_count (owner2), 2);
+  gst_download_cache_lock (cache2);
+  fail_if (gst_download_cache_is_filled_by_other (cache2, owner2, 50, 50));
+  gst_download_cache_unlock (cache2);
+
+  location = g_strdup (gst_download_cache_get_location (cache2));
+  gst_download_cache_release (cache2, owner2);
+
+  /* the data stays for the next user */
+  fail_unless (g_file_test (location, G_FILE_TEST_EXISTS));
+  cache1 = gst_download_cache_acquire ("http://example.com/1", template,
+      FALSE, 1000, owner1, count_notify, NULL);
+  fail_unless_equals_string (gst_download_cache_get_location (cache1),
+      location);
+  gst_download_cache_lock (cache1);
+  fail_unless (gst_sparse_file_get_range_after (gst_download_cache_get_file
+          (cache1), 0, &start, &stop));
+  fail_unless_equals_int (stop, 100);
+  gst_download_cache_unlock (cache1);
+
+  /* a size of 0 evicts the cache when it is not used anymore */
+  gst_download_cache_release (cache1, owner1);
+  cache1 = gst_download_cache_acquire ("http://example.com/2", template,
+      FALSE, 0, owner1, count_notify, NULL);
+  gst_download_cache_release (cache1, owner1);
+  fail_if (g_file_test (location, G_FILE_TEST_EXISTS));
+
+  g_free (location);
+  gst_object_unref (owner1);
+  gst_object_unref (owner2);
+  g_free (template);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_eviction)
+{
+  GstDownloadCache *cache1, *cache2, *cache3;
+  GstObject *owner;
+  gchar *template, *location1, *location2, *location3;
+
+  template = make_template ();
+  owner = gst_object_ref_sink (gst_pad_new ("owner", GST_PAD_SINK));
+
+  cache1 = gst_download_cache_acquire ("http://example.com/1", template,
+      FALSE, 250, owner, NULL, NULL);
+  write_data (cache1, owner, 0, 100);
+  location1 = g_strdup (gst_download_cache_get_location (cache1));
+  gst_download_cache_release (cache1, owner);
+
+  cache2 = gst_download_cache_acquire ("http://example.com/2", template,
+      FALSE, 250, owner, NULL, NULL);
+  write_data (cache2, owner, 0, 100);
+  location2 = g_strdup (gst_download_cache_get_location (cache2));
+  gst_download_cache_release (cache2, owner);
+
+  /* using the first one again makes the second one the oldest */
+  cache1 = gst_download_cache_acquire ("http://example.com/1", template,
+      FALSE, 250, owner, NULL, NULL);
+  gst_download_cache_release (cache1, owner);
+
+  cache3 = gst_download_cache_acquire ("http://example.com/3", template,
+      FALSE, 250, owner, NULL, NULL);
+  location3 = g_strdup (gst_download_cache_get_location (cache3));
+  write_data (cache3, owner, 0, 100);
+  fail_unless (g_file_test (location1, G_FILE_TEST_EXISTS));
+  fail_if (g_file_test (location2, G_FILE_TEST_EXISTS));
+  fail_unless (g_file_test (location3, G_FILE_TEST_EXISTS));
+
+  /* caches in use are not evicted */
+  write_data (cache3, owner, 100, 100);
+  write_data (cache3, owner, 200, 100);
+  fail_if (g_file_test (location1, G_FILE_TEST_EXISTS));
+  fail_unless (g_file_test (location3, G_FILE_TEST_EXISTS));
+
+  gst_download_cache_release (cache3, owner);
+  fail_if (g_file_test (location3, G_FILE_TEST_EXISTS));
+
+  g_free (location1);
+  g_free (location2);
+  g_free (location3);
+  gst_object_unref (owner);
+  g_free (template);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_temp_remove)
+{
+  GstDownloadCache *cache1, *cache2;
+  GstObject *owner1, *owner2;
+  gchar *template;
+  gsize start, stop;
+
+  template = make_template ();
+  owner1 = gst_object_ref_sink (gst_pad_new ("owner1", GST_PAD_SINK));
+  owner2 = gst_object_ref_sink (gst_pad_new ("owner2", GST_PAD_SINK));
+
+  cache1 = gst_download_cache_acquire ("http://example.com/1", template,
+      TRUE, 1000, owner1, NULL, NULL);
+  fail_unless (cache1 != NULL);
+#ifndef G_OS_WIN32
+  /* nothing stays on disk, the open file still has the data */
+  fail_if (g_file_test (gst_download_cache_get_location (cache1),
+          G_FILE_TEST_EXISTS));
+#endif
+  write_data (cache1, owner1, 0, 100);
+  gst_download_cache_release (cache1, owner1);
+
+  /* the next user gets the data of the unlinked file */
+  cache2 = gst_download_cache_acquire ("http://example.com/1", template,
+      TRUE, 1000, owner2, NULL, NULL);
+  fail_unless (cache1 == cache2);
+  gst_download_cache_lock (cache2);
+  fail_unless (gst_sparse_file_get_range_after (gst_download_cache_get_file
+          (cache2), 0, &start, &stop));
+  fail_unless_equals_int (stop, 100);
+  gst_download_cache_unlock (cache2);
+
+  /* a size of 0 evicts all the unused caches */
+  gst_download_cache_release (cache2, owner2);
+  cache1 = gst_download_cache_acquire ("http://example.com/2", template,
+      FALSE, 0, owner1, NULL, NULL);
+  gst_download_cache_release (cache1, owner1);
+
+  gst_object_unref (owner1);
+  gst_object_unref (owner2);
+  g_free (template);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_download_cache_suite (void)
+{
+  Suite *s = suite_create ("GstDownloadCache");
+  TCase *tc = tcase_create ("general");
+
+  suite_add_tcase (s, tc);
+  tcase_add_test (tc, test_shared);
+  tcase_add_test (tc, test_eviction);
+  tcase_add_test (tc, test_temp_remove);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_download_cache);
@@ -232,6 +232,71 @@ GST_START_TEST (test_clear)
 
 GST_END_TEST;
 
+GST_START_TEST (test_update_pad_flow)
+{
+  GstFlowCombiner *combiner;
+  GstPad *pad1, *pad2, *pad3;
+
+  combiner = gst_flow_combiner_new ();
+  pad1 = gst_pad_new ("src1", GST_PAD_SRC);
+  pad2 = gst_pad_new ("src2", GST_PAD_SRC);
+  pad3 = gst_pad_new ("src3", GST_PAD_SRC);
+  gst_flow_combiner_add_pad (combiner, pad1);
+  gst_flow_combiner_add_pad (combiner, pad2);
+  gst_flow_combiner_add_pad (combiner, pad3);
+
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_EOS), GST_FLOW_OK);
+  fail_unless_equals_int (GST_PAD_LAST_FLOW_RETURN (pad1), GST_FLOW_EOS);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad2,
+          GST_FLOW_NOT_LINKED), GST_FLOW_OK);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_EOS), GST_FLOW_EOS);
+
+  /* errors win until the pad returns something else */
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_ERROR), GST_FLOW_ERROR);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_OK), GST_FLOW_ERROR);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_NOT_LINKED), GST_FLOW_OK);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_NOT_LINKED), GST_FLOW_NOT_LINKED);
+
+  /* removed pads don't count anymore */
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad2,
+          GST_FLOW_FLUSHING), GST_FLOW_FLUSHING);
+  gst_flow_combiner_remove_pad (combiner, pad2);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_EOS), GST_FLOW_EOS);
+
+  /* after a reset all pads are ok */
+  gst_flow_combiner_reset (combiner);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_EOS), GST_FLOW_OK);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_EOS), GST_FLOW_EOS);
+
+  /* flows set on the pads directly, like by gst_pad_push(), are picked up
+   * when not all pads are ok */
+  gst_flow_combiner_reset (combiner);
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad1,
+          GST_FLOW_EOS), GST_FLOW_OK);
+  GST_PAD_LAST_FLOW_RETURN (pad1) = GST_FLOW_OK;
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_EOS), GST_FLOW_OK);
+  GST_PAD_LAST_FLOW_RETURN (pad1) = GST_FLOW_EOS;
+  fail_unless_equals_int (gst_flow_combiner_update_pad_flow (combiner, pad3,
+          GST_FLOW_EOS), GST_FLOW_EOS);
+
+  gst_flow_combiner_free (combiner);
+  gst_object_unref (pad1);
+  gst_object_unref (pad2);
+  gst_object_unref (pad3);
+}
+
+GST_END_TEST;
+
 static Suite *
 flow_combiner_suite (void)
 {
@@ -241,6 +306,7 @@ flow_combiner_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_combined_flows);
   tcase_add_test (tc_chain, test_clear);
+  tcase_add_test (tc_chain, test_update_pad_flow);
 
   return s;
 }
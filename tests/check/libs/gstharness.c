@@ -167,6 +167,125 @@ GST_START_TEST (test_forward_event_and_query_to_sink_harness_while_teardown)
 
 GST_END_TEST;
 
+static GstPadProbeReturn
+copy_buffer_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+  GST_PAD_PROBE_INFO_DATA (info) = gst_buffer_copy (buffer);
+  gst_buffer_unref (buffer);
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_allocations_per_buffer)
+{
+  GstHarness *h;
+  GstBuffer *buffer;
+
+  if (!gst_check_allocations_start ())
+    return;
+
+  /* one buffer with one memory */
+  buffer = gst_buffer_new_allocate (NULL, 16, NULL);
+  gst_check_allocations_stop ();
+  fail_unless_equals_int (gst_check_allocations_get (GST_TYPE_BUFFER), 1);
+  fail_unless_equals_int (gst_check_allocations_get (GST_TYPE_MEMORY), 1);
+  fail_unless_equals_int (gst_check_allocations_get (G_TYPE_NONE), 2);
+
+  /* nothing is counted after stopping */
+  gst_buffer_unref (gst_buffer_copy_deep (buffer));
+  fail_unless_equals_int (gst_check_allocations_get (G_TYPE_NONE), 2);
+
+  h = gst_harness_new ("identity");
+  gst_harness_set_src_caps_str (h, "foo/bar");
+  fail_unless_allocations_per_buffer (h, buffer, 0);
+
+  /* copying the buffer allocates a new buffer that shares the memory */
+  gst_harness_add_probe (h, "identity", "src", GST_PAD_PROBE_TYPE_BUFFER,
+      copy_buffer_probe, NULL, NULL);
+  fail_unless_allocations_per_buffer (h, buffer, 1);
+  fail_unless_equals_int (gst_check_allocations_get (GST_TYPE_MEMORY), 0);
+
+  gst_harness_teardown (h);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+static GstBuffer *
+new_load_buffer (GstHarness * h, gpointer data)
+{
+  return gst_buffer_new_allocate (NULL, 100, NULL);
+}
+
+static guint64
+get_uint64_field (const GstStructure * s, const gchar * name)
+{
+  guint64 value;
+
+  fail_unless (gst_structure_get_uint64 (s, name, &value));
+  return value;
+}
+
+GST_START_TEST (test_stress_push_load)
+{
+  GstHarness *h, *h2;
+  GstHarnessThread *t1, *t2;
+  GstSegment segment;
+  GstCaps *caps;
+  GstStructure *s;
+  gdouble rate;
+
+  h = gst_harness_new_with_padnames ("funnel", "sink_0", "src");
+  h2 = gst_harness_new_with_element (h->element, "sink_1", NULL);
+  gst_harness_set_drop_buffers (h, TRUE);
+
+  caps = gst_caps_new_empty_simple ("foo/bar");
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+
+  /* two producers into the two sink pads, one pushing lists */
+  t1 = gst_harness_stress_push_load_start_full (h, caps, &segment,
+      new_load_buffer, NULL, NULL, 0, 0, 10);
+  t2 = gst_harness_stress_push_load_start_full (h2, caps, &segment,
+      new_load_buffer, NULL, NULL, 0, 4, 0);
+
+  while (gst_harness_buffers_received (h) < 1000)
+    g_usleep (G_USEC_PER_SEC / 1000);
+
+  s = gst_harness_stress_thread_get_stats (t2);
+  fail_unless (get_uint64_field (s, "buffers") > 0);
+  fail_unless_equals_uint64 (get_uint64_field (s, "buffers"),
+      4 * get_uint64_field (s, "pushes"));
+  fail_unless_equals_uint64 (get_uint64_field (s, "bytes"),
+      100 * get_uint64_field (s, "buffers"));
+  fail_unless (get_uint64_field (s, "push-latency-min") <=
+      get_uint64_field (s, "push-latency-p50"));
+  fail_unless (get_uint64_field (s, "push-latency-p99") <=
+      get_uint64_field (s, "push-latency-max"));
+  gst_structure_free (s);
+
+  gst_harness_stress_thread_stop (t1);
+  gst_harness_stress_thread_stop (t2);
+
+  /* the buffers of both producers came out of the funnel */
+  s = gst_harness_get_load_stats (h);
+  fail_unless_equals_string (gst_structure_get_string (s, "element"),
+      GST_OBJECT_NAME (h->element));
+  fail_unless (get_uint64_field (s, "buffers") >= 1000);
+  fail_unless (get_uint64_field (s, "latency-p50") <=
+      get_uint64_field (s, "latency-max"));
+  fail_unless (gst_structure_get_double (s, "buffers-per-second", &rate));
+  fail_unless (rate > 0.0);
+  gst_structure_free (s);
+
+  gst_caps_unref (caps);
+  gst_harness_teardown (h2);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_harness_suite (void)
 {
@@ -182,6 +301,8 @@ gst_harness_suite (void)
 
   tcase_add_test (tc_chain,
       test_forward_event_and_query_to_sink_harness_while_teardown);
+  tcase_add_test (tc_chain, test_allocations_per_buffer);
+  tcase_add_test (tc_chain, test_stress_push_load);
 
   return s;
 }
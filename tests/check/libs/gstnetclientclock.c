@@ -117,6 +117,64 @@ GST_START_TEST (test_functioning)
 
 GST_END_TEST;
 
+GST_START_TEST (test_multiple_servers)
+{
+  GstNetTimeProvider *ntp1, *ntp2, *ntp3;
+  GstClock *client, *server, *wrong;
+  GstClockTime basex, basey, rate_num, rate_denom;
+  GstClockTime servtime, clienttime, diff;
+  gint port1, port2, port3;
+  gchar *address;
+
+  server = gst_system_clock_obtain ();
+  fail_unless (server != NULL, "failed to get system clock");
+
+  /* move the clock ahead 100 seconds */
+  gst_clock_get_calibration (server, &basex, &basey, &rate_num, &rate_denom);
+  basey += 100 * GST_SECOND;
+  gst_clock_set_calibration (server, basex, basey, rate_num, rate_denom);
+
+  /* and a clock that is 10 seconds further ahead */
+  wrong = g_object_new (GST_TYPE_SYSTEM_CLOCK, NULL);
+  gst_object_ref_sink (wrong);
+  gst_clock_set_calibration (wrong, basex, basey + 10 * GST_SECOND, rate_num,
+      rate_denom);
+
+  ntp1 = gst_net_time_provider_new (server, "127.0.0.1", 0);
+  ntp2 = gst_net_time_provider_new (wrong, "127.0.0.1", 0);
+  ntp3 = gst_net_time_provider_new (server, "127.0.0.1", 0);
+  fail_unless (ntp1 != NULL && ntp2 != NULL && ntp3 != NULL);
+
+  g_object_get (ntp1, "port", &port1, NULL);
+  g_object_get (ntp2, "port", &port2, NULL);
+  g_object_get (ntp3, "port", &port3, NULL);
+
+  /* the majority of the time providers wins */
+  address = g_strdup_printf ("127.0.0.1:%d, 127.0.0.1:%d, 127.0.0.1:%d",
+      port1, port2, port3);
+  client = gst_net_client_clock_new (NULL, address, port1, GST_SECOND);
+  fail_unless (client != NULL, "failed to get network client clock");
+  g_free (address);
+
+  fail_unless (gst_clock_wait_for_sync (client, 5 * GST_SECOND));
+
+  servtime = gst_clock_get_time (server);
+  clienttime = gst_clock_get_time (client);
+  diff = servtime > clienttime ? servtime - clienttime : clienttime - servtime;
+
+  if (diff > 100 * GST_MSECOND)
+    fail ("clocks not in sync (%" GST_TIME_FORMAT ")", GST_TIME_ARGS (diff));
+
+  gst_object_unref (client);
+  gst_object_unref (ntp1);
+  gst_object_unref (ntp2);
+  gst_object_unref (ntp3);
+  gst_object_unref (wrong);
+  gst_object_unref (server);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_net_client_clock_suite (void)
 {
@@ -128,6 +186,7 @@ gst_net_client_clock_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_instantiation);
   tcase_add_test (tc_chain, test_functioning);
+  tcase_add_test (tc_chain, test_multiple_servers);
 
   return s;
 }
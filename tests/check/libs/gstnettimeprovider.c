@@ -106,6 +106,83 @@ GST_START_TEST (test_functioning)
 
 GST_END_TEST;
 
+#define N_PACKETS 100
+
+GST_START_TEST (test_burst)
+{
+  GstNetTimeProvider *ntp;
+  GstNetTimePacket *packet;
+  GstClock *clock;
+  GSocketAddress *server_addr;
+  GInetAddress *addr;
+  GSocket *socket;
+  gboolean seen[N_PACKETS] = { FALSE, };
+  gint port = -1;
+  guint i;
+
+  clock = gst_system_clock_obtain ();
+  fail_unless (clock != NULL, "failed to get system clock");
+  ntp = g_initable_new (GST_TYPE_NET_TIME_PROVIDER, NULL, NULL, "clock", clock,
+      "address", "127.0.0.1", "port", 0, "n-threads", 4, NULL);
+  fail_unless (ntp != NULL, "failed to create net time provider");
+  gst_object_ref_sink (ntp);
+
+  g_object_get (ntp, "port", &port, NULL);
+  fail_unless (port > 0);
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, NULL);
+  fail_unless (socket != NULL, "could not create socket");
+  g_socket_set_timeout (socket, 5);
+
+  addr = g_inet_address_new_from_string ("127.0.0.1");
+  server_addr = g_inet_socket_address_new (addr, port);
+  g_object_unref (addr);
+
+  /* all packets are sent before the first reply is read, so that the
+   * provider answers several of them at once */
+  packet = gst_net_time_packet_new (NULL);
+  for (i = 0; i < N_PACKETS; i++) {
+    packet->local_time = i;
+    fail_unless (gst_net_time_packet_send (packet, socket, server_addr, NULL));
+  }
+  g_free (packet);
+
+  for (i = 0; i < N_PACKETS / 2; i++) {
+    packet = gst_net_time_packet_receive (socket, NULL, NULL);
+    fail_unless (packet != NULL, "failed to receive packet %u", i);
+    fail_unless (packet->local_time < N_PACKETS);
+    fail_if (seen[packet->local_time], "packet answered twice");
+    seen[packet->local_time] = TRUE;
+    fail_unless (GST_CLOCK_TIME_IS_VALID (packet->remote_time));
+    g_free (packet);
+  }
+
+  /* the others are received into the same packet */
+  for (; i < N_PACKETS; i++) {
+    GstNetTimePacket reply;
+    guint64 native_addr[16];
+    gsize native_addr_len = sizeof (native_addr);
+
+    fail_unless (gst_net_time_packet_receive_into (socket, &reply,
+            native_addr, &native_addr_len, NULL),
+        "failed to receive packet %u", i);
+    fail_unless (native_addr_len > 0);
+    fail_unless (reply.local_time < N_PACKETS);
+    fail_if (seen[reply.local_time], "packet answered twice");
+    seen[reply.local_time] = TRUE;
+    fail_unless (GST_CLOCK_TIME_IS_VALID (reply.remote_time));
+  }
+
+  g_object_unref (socket);
+  g_object_unref (server_addr);
+
+  gst_object_unref (ntp);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_net_time_provider_suite (void)
 {
@@ -115,6 +192,7 @@ gst_net_time_provider_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_refcounts);
   tcase_add_test (tc_chain, test_functioning);
+  tcase_add_test (tc_chain, test_burst);
 
   return s;
 }
@@ -1040,6 +1040,92 @@ GST_START_TEST (test_crank)
 
 GST_END_TEST;
 
+static gboolean
+test_async_record_time_cb (GstClock * clock,
+    GstClockTime time, GstClockID id, gpointer user_data)
+{
+  GArray *times = user_data;
+  GstClockTime id_time = gst_clock_id_get_time (id);
+
+  g_array_append_val (times, id_time);
+
+  return TRUE;
+}
+
+static void
+assert_times_sorted (GArray * times)
+{
+  guint i;
+
+  for (i = 1; i < times->len; i++)
+    g_assert_cmpuint (g_array_index (times, GstClockTime, i - 1), <=,
+        g_array_index (times, GstClockTime, i));
+}
+
+GST_START_TEST (test_set_time_and_process)
+{
+  GstClock *clock;
+  GstTestClock *test_clock;
+  GstClockID clock_id, periodic_id;
+  GList *pending_list, *cur;
+  GArray *times;
+  guint i;
+
+  clock = gst_test_clock_new ();
+  test_clock = GST_TEST_CLOCK (clock);
+  times = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  /* register the waits in reverse order */
+  for (i = 100; i > 0; i--) {
+    clock_id = gst_clock_new_single_shot_id (clock, i * GST_MSECOND);
+    g_assert (gst_clock_id_wait_async (clock_id, test_async_record_time_cb,
+            times, NULL) == GST_CLOCK_OK);
+    gst_clock_id_unref (clock_id);
+  }
+  periodic_id = gst_clock_new_periodic_id (clock, 0, 30 * GST_MSECOND);
+  g_assert (gst_clock_id_wait_async (periodic_id, test_async_record_time_cb,
+          times, NULL) == GST_CLOCK_OK);
+
+  /* the pending ids are sorted by time */
+  gst_test_clock_wait_for_multiple_pending_ids (test_clock, 101,
+      &pending_list);
+  g_assert_cmpuint (g_list_length (pending_list), ==, 101);
+  g_assert (pending_list->data == periodic_id);
+  for (cur = pending_list; cur->next != NULL; cur = cur->next)
+    g_assert_cmpuint (gst_clock_id_get_time (cur->data), <=,
+        gst_clock_id_get_time (cur->next->data));
+  g_list_free_full (pending_list, gst_clock_id_unref);
+
+  /* 50 single shots and the periodic id at 0 and 30ms are due */
+  g_assert_cmpuint (gst_test_clock_set_time_and_process (test_clock,
+          50 * GST_MSECOND), ==, 52);
+  g_assert_cmpuint (times->len, ==, 52);
+  assert_times_sorted (times);
+  g_assert_cmpuint (gst_test_clock_peek_id_count (test_clock), ==, 51);
+  g_assert_cmpuint (gst_clock_get_time (clock), ==, 50 * GST_MSECOND);
+
+  g_assert_cmpuint (gst_test_clock_set_time_and_process (test_clock,
+          50 * GST_MSECOND), ==, 0);
+
+  /* the rest and the periodic id from 60 to 180ms */
+  g_assert_cmpuint (gst_test_clock_set_time_and_process (test_clock,
+          200 * GST_MSECOND), ==, 55);
+  g_assert_cmpuint (times->len, ==, 107);
+  assert_times_sorted (times);
+  g_assert_cmpuint (gst_test_clock_peek_id_count (test_clock), ==, 1);
+  g_assert_cmpuint (gst_test_clock_get_next_entry_time (test_clock), ==,
+      210 * GST_MSECOND);
+
+  gst_clock_id_unschedule (periodic_id);
+  g_assert_cmpuint (gst_test_clock_peek_id_count (test_clock), ==, 0);
+
+  gst_clock_id_unref (periodic_id);
+  g_array_free (times, TRUE);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_test_clock_suite (void)
 {
@@ -1072,6 +1158,7 @@ gst_test_clock_suite (void)
   tcase_add_test (tc_chain, test_periodic_async);
   tcase_add_test (tc_chain, test_periodic_uniqueness);
   tcase_add_test (tc_chain, test_crank);
+  tcase_add_test (tc_chain, test_set_time_and_process);
 
   return s;
 }
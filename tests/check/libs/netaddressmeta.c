@@ -0,0 +1,128 @@
+/* GStreamer
+ *
+ * unit test for the network address meta
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/net/gstnet.h>
+
+static gsize
+make_native (const gchar * host, guint16 port, gpointer native, gsize len)
+{
+  GSocketAddress *addr;
+  gsize size;
+
+  addr = g_inet_socket_address_new_from_string (host, port);
+  size = g_socket_address_get_native_size (addr);
+  fail_unless (size <= len);
+  memset (native, 0, len);
+  fail_unless (g_socket_address_to_native (addr, native, size, NULL));
+  g_object_unref (addr);
+
+  return size;
+}
+
+GST_START_TEST (test_from_native)
+{
+  guint8 native1[128], native2[128];
+  gsize len1, len2;
+  GstBuffer *buf1, *buf2, *buf3;
+  GstNetAddressMeta *meta1, *meta2, *meta3;
+  GInetSocketAddress *inet;
+  gchar *host;
+
+  len1 = make_native ("192.168.1.10", 5004, native1, sizeof (native1));
+  len2 = make_native ("192.168.1.11", 5004, native2, sizeof (native2));
+
+  buf1 = gst_buffer_new ();
+  buf2 = gst_buffer_new ();
+  buf3 = gst_buffer_new ();
+
+  meta1 = gst_buffer_add_net_address_meta_from_native (buf1, native1, len1);
+  meta2 = gst_buffer_add_net_address_meta_from_native (buf2, native1, len1);
+  meta3 = gst_buffer_add_net_address_meta_from_native (buf3, native2, len2);
+  fail_unless (meta1 != NULL && meta2 != NULL && meta3 != NULL);
+
+  /* the same peer shares the address */
+  fail_unless (meta1->addr == meta2->addr);
+  fail_unless (meta1->addr != meta3->addr);
+
+  inet = G_INET_SOCKET_ADDRESS (meta3->addr);
+  host = g_inet_address_to_string (g_inet_socket_address_get_address (inet));
+  fail_unless_equals_string (host, "192.168.1.11");
+  fail_unless_equals_int (g_inet_socket_address_get_port (inet), 5004);
+  g_free (host);
+
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+  gst_buffer_unref (buf3);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_buffer_list)
+{
+  GstBufferList *list;
+  GSocketAddress *addr, *other;
+  GstBuffer *buf;
+  guint i;
+
+  addr = g_inet_socket_address_new_from_string ("10.0.0.1", 1234);
+  other = g_inet_socket_address_new_from_string ("10.0.0.2", 1234);
+
+  list = gst_buffer_list_new ();
+  fail_unless (gst_buffer_list_get_net_address (list) == NULL);
+
+  for (i = 0; i < 3; i++)
+    gst_buffer_list_add (list, gst_buffer_new ());
+  fail_unless (gst_buffer_list_get_net_address (list) == NULL);
+
+  gst_buffer_list_add_net_address_meta (list, addr);
+  fail_unless (gst_buffer_list_get_net_address (list) == addr);
+  for (i = 0; i < 3; i++) {
+    buf = gst_buffer_list_get (list, i);
+    fail_unless (gst_buffer_get_net_address_meta (buf)->addr == addr);
+  }
+
+  /* a buffer from another peer */
+  buf = gst_buffer_new ();
+  gst_buffer_add_net_address_meta (buf, other);
+  gst_buffer_list_add (list, buf);
+  fail_unless (gst_buffer_list_get_net_address (list) == NULL);
+
+  gst_buffer_list_unref (list);
+  g_object_unref (addr);
+  g_object_unref (other);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_net_address_meta_suite (void)
+{
+  Suite *s = suite_create ("GstNetAddressMeta");
+  TCase *tc = tcase_create ("general");
+
+  suite_add_tcase (s, tc);
+  tcase_add_test (tc, test_from_native);
+  tcase_add_test (tc, test_buffer_list);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_net_address_meta);
@@ -0,0 +1,146 @@
+/* GStreamer
+ *
+ * unit test for the network segmentation meta
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/net/net.h>
+
+static GstBuffer *
+make_packet (gsize size, guint8 fill)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, size, NULL);
+
+  gst_buffer_memset (buf, 0, fill, size);
+
+  return buf;
+}
+
+GST_START_TEST (test_merge_split)
+{
+  GstBufferList *list, *split;
+  GstNetSegmentMeta *meta;
+  GstBuffer *merged, *buf;
+  guint8 fill;
+  guint i;
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++)
+    gst_buffer_list_add (list, make_packet (100, i));
+  gst_buffer_list_add (list, make_packet (50, 3));
+  GST_BUFFER_PTS (gst_buffer_list_get (list, 0)) = GST_SECOND;
+
+  merged = gst_buffer_list_merge_net_segments (list);
+  fail_unless (merged != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (merged), 350);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (merged), GST_SECOND);
+  meta = gst_buffer_get_net_segment_meta (merged);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (meta->segment_size, 100);
+  fail_unless_equals_int (meta->n_segments, 4);
+
+  /* the memory is shared */
+  fail_unless (gst_buffer_peek_memory (merged, 0) ==
+      gst_buffer_peek_memory (gst_buffer_list_get (list, 0), 0));
+
+  split = gst_buffer_split_net_segments (merged);
+  fail_unless_equals_int (gst_buffer_list_length (split), 4);
+  for (i = 0; i < 4; i++) {
+    buf = gst_buffer_list_get (split, i);
+    fail_unless_equals_int (gst_buffer_get_size (buf), i < 3 ? 100 : 50);
+    fail_unless_equals_int (gst_buffer_extract (buf, 0, &fill, 1), 1);
+    fail_unless_equals_int (fill, i);
+    /* the packets are not segmented anymore */
+    fail_unless (gst_buffer_get_net_segment_meta (buf) == NULL);
+  }
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (gst_buffer_list_get (split, 0)),
+      GST_SECOND);
+
+  gst_buffer_list_unref (split);
+  gst_buffer_unref (merged);
+  gst_buffer_list_unref (list);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_merge_fails)
+{
+  GstBufferList *list;
+  GstBuffer *buf, *merged;
+  guint i;
+
+  list = gst_buffer_list_new ();
+  fail_unless (gst_buffer_list_merge_net_segments (list) == NULL);
+
+  /* only the last packet can be smaller */
+  gst_buffer_list_add (list, make_packet (100, 0));
+  gst_buffer_list_add (list, make_packet (50, 0));
+  gst_buffer_list_add (list, make_packet (100, 0));
+  fail_unless (gst_buffer_list_merge_net_segments (list) == NULL);
+  gst_buffer_list_unref (list);
+
+  /* and no packet can be bigger */
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, make_packet (100, 0));
+  gst_buffer_list_add (list, make_packet (150, 0));
+  fail_unless (gst_buffer_list_merge_net_segments (list) == NULL);
+  gst_buffer_list_unref (list);
+
+  /* the memory of the packets doesn't fit in one buffer */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < gst_buffer_get_max_memory () + 1; i++)
+    gst_buffer_list_add (list, make_packet (100, 0));
+  fail_unless (gst_buffer_list_merge_net_segments (list) == NULL);
+
+  /* with one packet less it does, still without a copy */
+  gst_buffer_list_remove (list, 0, 1);
+  merged = gst_buffer_list_merge_net_segments (list);
+  fail_unless (merged != NULL);
+  fail_unless_equals_int (gst_buffer_n_memory (merged),
+      gst_buffer_get_max_memory ());
+  fail_unless (gst_buffer_peek_memory (merged, gst_buffer_get_max_memory () -
+          1) == gst_buffer_peek_memory (gst_buffer_list_get (list,
+              gst_buffer_get_max_memory () - 1), 0));
+  gst_buffer_unref (merged);
+  gst_buffer_list_unref (list);
+
+  /* a buffer without the meta is one packet */
+  buf = make_packet (100, 0);
+  list = gst_buffer_split_net_segments (buf);
+  fail_unless_equals_int (gst_buffer_list_length (list), 1);
+  fail_unless (gst_buffer_list_get (list, 0) == buf);
+  gst_buffer_list_unref (list);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_net_segment_meta_suite (void)
+{
+  Suite *s = suite_create ("GstNetSegmentMeta");
+  TCase *tc = tcase_create ("general");
+
+  suite_add_tcase (s, tc);
+  tcase_add_test (tc, test_merge_split);
+  tcase_add_test (tc, test_merge_fails);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_net_segment_meta);
@@ -262,6 +262,106 @@ GST_START_TEST (test_array_grow_from_prealloc1)
 
 GST_END_TEST;
 
+GST_START_TEST (test_array_bulk)
+{
+  GstQueueArray *array;
+  gpointer in[20], out[20];
+  guint i, j;
+
+  for (i = 0; i < 20; i++)
+    in[i] = GINT_TO_POINTER (i);
+
+  array = gst_queue_array_new (8);
+
+  /* move the head around so that the bulk operations wrap */
+  for (i = 0; i < 10; i++) {
+    gst_queue_array_push_tail_n (array, in, 5);
+    fail_unless_equals_int (gst_queue_array_get_length (array), 5);
+    fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, 3), 3);
+    fail_unless_equals_int (gst_queue_array_pop_head_n (array, out + 3, 10),
+        2);
+    for (j = 0; j < 5; j++)
+      fail_unless (out[j] == in[j]);
+  }
+
+  /* and make it grow while wrapped */
+  gst_queue_array_push_tail_n (array, in, 6);
+  fail_unless_equals_int (gst_queue_array_pop_head_n (array, NULL, 4), 4);
+  gst_queue_array_push_tail_n (array, in + 6, 14);
+  fail_unless_equals_int (gst_queue_array_get_length (array), 16);
+  for (i = 4; i < 20; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (gst_queue_array_pop_head (array)),
+        i);
+  fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, 1), 0);
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_array_bulk_struct)
+{
+  GstQueueArray *array;
+  GstSegment in[5], out[5];
+  guint i;
+
+  for (i = 0; i < 5; i++) {
+    gst_segment_init (&in[i], GST_FORMAT_TIME);
+    in[i].position = i;
+  }
+
+  array = gst_queue_array_new_for_struct (sizeof (GstSegment), 2);
+  gst_queue_array_push_tail_n (array, in, 5);
+  fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, 5), 5);
+  for (i = 0; i < 5; i++)
+    fail_unless_equals_uint64 (out[i].position, i);
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_array_clear_shrink)
+{
+  GstQueueArray *array;
+  guint i;
+
+  array = gst_queue_array_new (4);
+  gst_queue_array_reserve (array, 100);
+
+  for (i = 0; i < 100; i++)
+    gst_queue_array_push_tail (array, GINT_TO_POINTER (i));
+  gst_queue_array_clear (array);
+  fail_unless (gst_queue_array_is_empty (array));
+  fail_unless (gst_queue_array_pop_head (array) == NULL);
+
+  /* wrap the elements around the end before shrinking */
+  for (i = 0; i < 100; i++)
+    gst_queue_array_push_tail (array, GINT_TO_POINTER (i));
+  for (i = 0; i < 95; i++)
+    gst_queue_array_pop_head (array);
+  for (i = 100; i < 105; i++)
+    gst_queue_array_push_tail (array, GINT_TO_POINTER (i));
+
+  gst_queue_array_shrink (array, 0);
+  fail_unless_equals_int (gst_queue_array_get_length (array), 10);
+  for (i = 95; i < 105; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (gst_queue_array_pop_head (array)),
+        i);
+
+  /* and it still grows after shrinking to the minimum */
+  gst_queue_array_shrink (array, 0);
+  for (i = 0; i < 10; i++)
+    gst_queue_array_push_tail (array, GINT_TO_POINTER (i));
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (gst_queue_array_pop_head (array)),
+        i);
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_queue_array_suite (void)
 {
@@ -277,6 +377,9 @@ gst_queue_array_suite (void)
   tcase_add_test (tc_chain, test_array_grow_end);
   tcase_add_test (tc_chain, test_array_drop2);
   tcase_add_test (tc_chain, test_array_grow_from_prealloc1);
+  tcase_add_test (tc_chain, test_array_bulk);
+  tcase_add_test (tc_chain, test_array_bulk_struct);
+  tcase_add_test (tc_chain, test_array_clear_shrink);
 
   return s;
 }
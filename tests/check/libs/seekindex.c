@@ -0,0 +1,194 @@
+/* GStreamer
+ *
+ * unit test for the seek index of GstBaseParse
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib/gstdio.h>
+
+#include <gst/check/gstcheck.h>
+
+/* not public API */
+#include "../../../libs/gst/base/gstseekindex.c"
+
+#define N_ENTRIES 1000
+
+/* entries every second, at 1000 bytes per second with some jitter */
+#define ENTRY_TS(i) ((i) * GST_SECOND)
+#define ENTRY_OFFSET(i) ((i) * 1000 + ((i) % 7) * 10)
+
+static void
+expect_entry (GstSeekIndex * index, GstClockTime ts, gboolean before,
+    GstClockTime expected_ts, guint64 expected_offset)
+{
+  GstClockTime entry_ts = GST_CLOCK_TIME_NONE;
+  guint64 entry_offset = -1;
+
+  fail_unless (gst_seek_index_lookup (index, ts, before, &entry_ts,
+          &entry_offset));
+  fail_unless_equals_uint64 (entry_ts, expected_ts);
+  fail_unless_equals_uint64 (entry_offset, expected_offset);
+}
+
+static void
+check_entries (GstSeekIndex * index)
+{
+  guint i;
+
+  fail_unless_equals_int (gst_seek_index_get_size (index), N_ENTRIES);
+
+  for (i = 0; i < N_ENTRIES; i++) {
+    expect_entry (index, ENTRY_TS (i), TRUE, ENTRY_TS (i), ENTRY_OFFSET (i));
+    expect_entry (index, ENTRY_TS (i), FALSE, ENTRY_TS (i), ENTRY_OFFSET (i));
+    expect_entry (index, ENTRY_TS (i) + GST_MSECOND, TRUE, ENTRY_TS (i),
+        ENTRY_OFFSET (i));
+    if (i + 1 < N_ENTRIES)
+      expect_entry (index, ENTRY_TS (i) + GST_MSECOND, FALSE,
+          ENTRY_TS (i + 1), ENTRY_OFFSET (i + 1));
+  }
+
+  /* after the last entry */
+  fail_if (gst_seek_index_lookup (index, ENTRY_TS (N_ENTRIES), FALSE, NULL,
+          NULL));
+  expect_entry (index, ENTRY_TS (N_ENTRIES), TRUE, ENTRY_TS (N_ENTRIES - 1),
+      ENTRY_OFFSET (N_ENTRIES - 1));
+}
+
+GST_START_TEST (test_lookup)
+{
+  GstSeekIndex *index;
+  guint i;
+
+  index = gst_seek_index_new ();
+
+  fail_if (gst_seek_index_lookup (index, 0, TRUE, NULL, NULL));
+  fail_if (gst_seek_index_lookup (index, 0, FALSE, NULL, NULL));
+
+  for (i = 1; i < N_ENTRIES; i++)
+    gst_seek_index_add (index, ENTRY_TS (i), ENTRY_OFFSET (i));
+
+  /* before the first entry */
+  fail_if (gst_seek_index_lookup (index, 0, TRUE, NULL, NULL));
+  expect_entry (index, 0, FALSE, ENTRY_TS (1), ENTRY_OFFSET (1));
+
+  /* entries before the end are inserted */
+  gst_seek_index_add (index, ENTRY_TS (0), ENTRY_OFFSET (0));
+  check_entries (index);
+
+  /* the same timestamp replaces the entry */
+  gst_seek_index_add (index, ENTRY_TS (500), 1);
+  expect_entry (index, ENTRY_TS (500), TRUE, ENTRY_TS (500), 1);
+  fail_unless_equals_int (gst_seek_index_get_size (index), N_ENTRIES);
+
+  gst_seek_index_clear (index);
+  fail_unless_equals_int (gst_seek_index_get_size (index), 0);
+  fail_if (gst_seek_index_lookup (index, ENTRY_TS (1), TRUE, NULL, NULL));
+
+  gst_seek_index_free (index);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_out_of_order)
+{
+  GstSeekIndex *index;
+  guint i;
+
+  index = gst_seek_index_new ();
+
+  /* like the entries of a stream that is played from the middle, then from
+   * the start and then from the end */
+  for (i = N_ENTRIES / 2; i < N_ENTRIES / 2 + 100; i++)
+    gst_seek_index_add (index, ENTRY_TS (i), ENTRY_OFFSET (i));
+  for (i = 0; i < N_ENTRIES / 2 + 50; i++)
+    gst_seek_index_add (index, ENTRY_TS (i), ENTRY_OFFSET (i));
+  for (i = N_ENTRIES - 1; i >= N_ENTRIES / 2 + 100; i--)
+    gst_seek_index_add (index, ENTRY_TS (i), ENTRY_OFFSET (i));
+
+  check_entries (index);
+
+  gst_seek_index_free (index);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_save_load)
+{
+  GstSeekIndex *index;
+  GError *err = NULL;
+  gchar *name;
+  gint fd;
+  guint i;
+
+  fd = g_file_open_tmp (NULL, &name, NULL);
+  fail_unless (fd != -1);
+  g_close (fd, NULL);
+
+  index = gst_seek_index_new ();
+  for (i = 0; i < N_ENTRIES; i++)
+    gst_seek_index_add (index, ENTRY_TS (i), ENTRY_OFFSET (i));
+  fail_unless (gst_seek_index_save (index, name, 12345, &err));
+  fail_unless (err == NULL);
+  gst_seek_index_free (index);
+
+  index = gst_seek_index_new ();
+  gst_seek_index_add (index, ENTRY_TS (1), 1);
+
+  /* the index of another stream is not loaded */
+  fail_if (gst_seek_index_load (index, name, 1234, &err));
+  fail_unless (err != NULL);
+  g_clear_error (&err);
+  fail_unless_equals_int (gst_seek_index_get_size (index), 1);
+
+  fail_unless (gst_seek_index_load (index, name, 12345, &err));
+  fail_unless (err == NULL);
+  check_entries (index);
+
+  /* truncated files are refused */
+  fail_unless (g_file_set_contents (name, "GSTSIDX\1", 8, NULL));
+  fail_if (gst_seek_index_load (index, name, 12345, &err));
+  fail_unless (err != NULL);
+  g_clear_error (&err);
+  check_entries (index);
+
+  gst_seek_index_free (index);
+
+  g_unlink (name);
+  g_free (name);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_seek_index_suite (void)
+{
+  Suite *s = suite_create ("GstSeekIndex");
+  TCase *tc = tcase_create ("general");
+
+  suite_add_tcase (s, tc);
+  tcase_add_test (tc, test_lookup);
+  tcase_add_test (tc, test_out_of_order);
+  tcase_add_test (tc, test_save_load);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_seek_index);
@@ -211,6 +211,89 @@ GST_START_TEST (test_write_merge)
 
 GST_END_TEST;
 
+GST_START_TEST (test_many_ranges)
+{
+  GstSparseFile *file;
+  gint fd;
+  gchar *name;
+  guint i;
+
+  name = g_strdup ("cachefile-testXXXXXX");
+  fd = g_mkstemp (name);
+  fail_if (fd == -1);
+
+  file = gst_sparse_file_new ();
+  gst_sparse_file_set_fd (file, fd);
+
+  /* every other block of 10 bytes, written backwards */
+  for (i = 500; i > 0; i--)
+    fail_unless (expect_write (file, (i - 1) * 20, 10, 10, 0));
+  fail_unless_equals_int (gst_sparse_file_n_ranges (file), 500);
+
+  for (i = 0; i < 500; i++) {
+    expect_range_before (file, i * 20 + 15, i * 20, i * 20 + 10);
+    expect_range_after (file, i * 20 + 5, i * 20, i * 20 + 10);
+    if (i < 499)
+      expect_range_after (file, i * 20 + 10, i * 20 + 20, i * 20 + 30);
+    fail_unless (expect_read (file, i * 20, 10, 10, 0));
+    fail_unless (expect_read (file, i * 20 + 5, 10, 0, 0));
+  }
+
+  /* fill the holes, every write merges with the next range */
+  for (i = 0; i < 500; i++)
+    fail_unless (expect_write (file, i * 20 + 10, 10, 10,
+            i < 499 ? 10 : 0));
+  fail_unless_equals_int (gst_sparse_file_n_ranges (file), 1);
+  expect_range_before (file, 5000, 0, 10000);
+
+  g_unlink (name);
+  gst_sparse_file_free (file);
+  g_free (name);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_max_ranges)
+{
+  GstSparseFile *file;
+  gint fd;
+  gchar *name;
+
+  name = g_strdup ("cachefile-testXXXXXX");
+  fd = g_mkstemp (name);
+  fail_if (fd == -1);
+
+  file = gst_sparse_file_new ();
+  gst_sparse_file_set_fd (file, fd);
+  gst_sparse_file_set_max_ranges (file, 3);
+
+  fail_unless (expect_write (file, 0, 50, 50, 0));
+  fail_unless (expect_write (file, 100, 50, 50, 0));
+  fail_unless (expect_write (file, 200, 50, 50, 0));
+  fail_unless_equals_int (gst_sparse_file_n_ranges (file), 3);
+
+  /* use the first range again, the second one is the oldest now */
+  fail_unless (expect_read (file, 0, 50, 50, 0));
+
+  fail_unless (expect_write (file, 300, 50, 50, 0));
+  fail_unless_equals_int (gst_sparse_file_n_ranges (file), 3);
+  fail_unless (expect_read (file, 0, 50, 50, 0));
+  fail_unless (expect_read (file, 100, 50, 0, 0));
+  fail_unless (expect_read (file, 200, 50, 50, 0));
+  fail_unless (expect_read (file, 300, 50, 50, 0));
+
+  /* lowering the maximum evicts right away */
+  gst_sparse_file_set_max_ranges (file, 1);
+  fail_unless_equals_int (gst_sparse_file_n_ranges (file), 1);
+  fail_unless (expect_read (file, 300, 50, 50, 0));
+
+  g_unlink (name);
+  gst_sparse_file_free (file);
+  g_free (name);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_cachefile_suite (void)
 {
@@ -220,6 +303,8 @@ gst_cachefile_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_write_read);
   tcase_add_test (tc_chain, test_write_merge);
+  tcase_add_test (tc_chain, test_many_ranges);
+  tcase_add_test (tc_chain, test_max_ranges);
 
   return s;
 }
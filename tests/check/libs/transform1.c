@@ -282,6 +282,99 @@ GST_START_TEST (basetransform_chain_ip1)
 
 GST_END_TEST;
 
+static guint transform_ip_list_count;
+static guint result_list_count;
+
+static GstFlowReturn
+transform_ip_list (GstBaseTransform * trans, GstBuffer * buf)
+{
+  transform_ip_list_count++;
+  fail_unless (gst_buffer_is_writable (buf));
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+result_sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  TestTransData *data = gst_pad_get_element_private (pad);
+  guint i, len;
+
+  result_list_count++;
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++)
+    data->buffers = g_list_append (data->buffers,
+        gst_buffer_ref (gst_buffer_list_get (list, i)));
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+static GstBufferList *
+make_buffer_list (guint n_buffers)
+{
+  GstBufferList *list;
+  guint i;
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < n_buffers; i++)
+    gst_buffer_list_add (list, gst_buffer_new_and_alloc (10 + i));
+
+  return list;
+}
+
+/* buffer lists are split, unless the transform was asked to keep them */
+GST_START_TEST (basetransform_chain_list)
+{
+  TestTransData *trans;
+  GstBuffer *buffer;
+  GstFlowReturn res;
+  guint i;
+
+  klass_transform_ip = transform_ip_list;
+  trans = gst_test_trans_new ();
+  gst_pad_set_chain_list_function (trans->sinkpad, result_sink_chain_list);
+
+  gst_test_trans_push_segment (trans);
+
+  fail_if (gst_base_transform_get_keep_lists (GST_BASE_TRANSFORM
+          (trans->trans)));
+
+  transform_ip_list_count = 0;
+  result_list_count = 0;
+  res = gst_pad_push_list (trans->srcpad, make_buffer_list (3));
+  fail_unless (res == GST_FLOW_OK);
+  fail_unless_equals_int (transform_ip_list_count, 3);
+  fail_unless_equals_int (result_list_count, 0);
+  fail_unless_equals_int (g_list_length (trans->buffers), 3);
+  while ((buffer = gst_test_trans_pop (trans)))
+    gst_buffer_unref (buffer);
+
+  gst_base_transform_set_keep_lists (GST_BASE_TRANSFORM (trans->trans), TRUE);
+  fail_unless (gst_base_transform_get_keep_lists (GST_BASE_TRANSFORM
+          (trans->trans)));
+
+  transform_ip_list_count = 0;
+  res = gst_pad_push_list (trans->srcpad, make_buffer_list (3));
+  fail_unless (res == GST_FLOW_OK);
+  fail_unless_equals_int (transform_ip_list_count, 3);
+  fail_unless_equals_int (result_list_count, 1);
+  fail_unless_equals_int (g_list_length (trans->buffers), 3);
+
+  /* the order of the buffers is kept */
+  for (i = 0; i < 3; i++) {
+    buffer = gst_test_trans_pop (trans);
+    fail_unless (buffer != NULL);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 10 + i);
+    gst_buffer_unref (buffer);
+  }
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
 static gboolean set_caps_1_called;
 
 static gboolean
@@ -887,6 +980,72 @@ GST_START_TEST (basetransform_chain_ct3)
 
 GST_END_TEST;
 
+static gboolean
+transform_size_pool (GstBaseTransform * trans, GstPadDirection direction,
+    GstCaps * caps, gsize size, GstCaps * othercaps, gsize * othersize)
+{
+  *othersize = size;
+
+  return TRUE;
+}
+
+/* downstream asks for a pool of 20 byte buffers but doesn't provide one */
+static gboolean
+sink_query_pool (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION) {
+    gst_query_add_allocation_pool (query, NULL, 20, 2, 0);
+    return TRUE;
+  }
+  return gst_pad_query_default (pad, parent, query);
+}
+
+/* renegotiating to caps that need the same buffers keeps the pool */
+GST_START_TEST (basetransform_chain_ct_reuse_pool)
+{
+  TestTransData *trans;
+  GstBuffer *buffer, *buffer1, *buffer2;
+  GstCaps *caps1, *caps2;
+
+  klass_transform = transform_ct1;
+  klass_transform_size = transform_size_pool;
+  klass_passthrough_on_same_caps = FALSE;
+
+  trans = gst_test_trans_new ();
+  gst_pad_set_query_function (trans->sinkpad, sink_query_pool);
+
+  caps1 = gst_caps_from_string ("foo/x-bar, rate=(int)1");
+  caps2 = gst_caps_from_string ("foo/x-bar, rate=(int)2");
+
+  fail_unless (gst_test_trans_setcaps (trans, caps1));
+  gst_test_trans_push_segment (trans);
+
+  buffer = gst_buffer_new_and_alloc (20);
+  fail_unless_equals_int (gst_test_trans_push (trans, buffer), GST_FLOW_OK);
+  buffer1 = gst_test_trans_pop (trans);
+  fail_unless (buffer1 != NULL);
+  fail_unless (buffer1->pool != NULL);
+
+  /* keep buffer1 in flight while renegotiating */
+  fail_unless (gst_test_trans_setcaps (trans, caps2));
+
+  buffer = gst_buffer_new_and_alloc (20);
+  fail_unless_equals_int (gst_test_trans_push (trans, buffer), GST_FLOW_OK);
+  buffer2 = gst_test_trans_pop (trans);
+  fail_unless (buffer2 != NULL);
+  fail_unless (buffer2->pool == buffer1->pool);
+
+  gst_buffer_unref (buffer1);
+  gst_buffer_unref (buffer2);
+
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
 static void
 transform1_setup (void)
 {
@@ -922,10 +1081,12 @@ gst_basetransform_suite (void)
   /* in place */
   tcase_add_test (tc, basetransform_chain_ip1);
   tcase_add_test (tc, basetransform_chain_ip2);
+  tcase_add_test (tc, basetransform_chain_list);
   /* copy transform */
   tcase_add_test (tc, basetransform_chain_ct1);
   tcase_add_test (tc, basetransform_chain_ct2);
   tcase_add_test (tc, basetransform_chain_ct3);
+  tcase_add_test (tc, basetransform_chain_ct_reuse_pool);
 
   return s;
 }
@@ -72,6 +72,135 @@ GST_START_TEST (test_buffer_range)
 
 GST_END_TEST;
 
+static gint unprefixed_calls;
+
+static void
+unprefixed_typefind (GstTypeFind * tf, gpointer unused)
+{
+  unprefixed_calls++;
+  gst_type_find_suggest_simple (tf, GST_TYPE_FIND_LIKELY, "foo/x-unprefixed",
+      NULL);
+}
+
+static void
+prefixed_typefind (GstTypeFind * tf, gpointer unused)
+{
+  const guint8 *data;
+
+  data = gst_type_find_peek (tf, 0, 4);
+  if (data && GST_READ_UINT32_BE (data) == 0xdeadbeef)
+    gst_type_find_suggest_simple (tf, GST_TYPE_FIND_MAXIMUM,
+        "foo/x-prefixed", NULL);
+}
+
+/* typefinders with a matching prefix are tried before higher ranked ones */
+GST_START_TEST (test_prefixes)
+{
+  static const guint8 prefixed_data[8] = { 0xde, 0xad, 0xbe, 0xef, 0x01,
+    0x02, 0x03, 0x04
+  };
+  static const guint8 other_data[8] = { 0x00, 0xad, 0xbe, 0xef, 0x01,
+    0x02, 0x03, 0x04
+  };
+  GstRegistry *registry;
+  GstTypeFindFactory *factory;
+  GstCaps *caps;
+
+  fail_unless (gst_type_find_register (NULL, "foo/x-unprefixed",
+          GST_RANK_PRIMARY + 100, unprefixed_typefind, NULL, NULL, NULL,
+          NULL));
+  fail_unless (gst_type_find_register_with_prefixes (NULL, "foo/x-prefixed",
+          GST_RANK_MARGINAL, prefixed_typefind, NULL, "123,DEADBEEF,1a2b",
+          NULL, NULL, NULL));
+
+  /* the invalid prefix is dropped */
+  registry = gst_registry_get ();
+  factory = GST_TYPE_FIND_FACTORY (gst_registry_lookup_feature (registry,
+          "foo/x-prefixed"));
+  fail_unless (factory != NULL);
+  fail_unless_equals_int (g_strv_length ((gchar **)
+          gst_type_find_factory_get_prefixes (factory)), 2);
+  gst_object_unref (factory);
+
+  unprefixed_calls = 0;
+  caps = gst_type_find_helper_for_data (NULL, prefixed_data,
+      sizeof (prefixed_data), NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "foo/x-prefixed"));
+  fail_unless_equals_int (unprefixed_calls, 0);
+  gst_caps_unref (caps);
+
+  /* all others are still tried if no prefix matches */
+  caps = gst_type_find_helper_for_data (NULL, other_data,
+      sizeof (other_data), NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "foo/x-unprefixed"));
+  fail_unless_equals_int (unprefixed_calls, 1);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+static void
+likely_typefind (GstTypeFind * tf, gpointer name)
+{
+  gst_type_find_suggest_simple (tf, GST_TYPE_FIND_LIKELY, name, NULL);
+}
+
+static void
+maximum_typefind (GstTypeFind * tf, gpointer name)
+{
+  gst_type_find_suggest_simple (tf, GST_TYPE_FIND_MAXIMUM, name, NULL);
+}
+
+/* the parallel helper gives the same results as the serial one */
+GST_START_TEST (test_for_data_with_pool)
+{
+  static const guint8 data[8] = { 0, };
+  GstTaskPool *pool;
+  GstTypeFindProbability prob;
+  GstCaps *caps;
+
+  pool = gst_task_pool_new ();
+  gst_task_pool_prepare (pool, NULL);
+
+  /* of the same probability the one with the higher rank wins */
+  fail_unless (gst_type_find_register (NULL, "foo/x-likely-high",
+          GST_RANK_PRIMARY, likely_typefind, NULL, NULL,
+          (gpointer) "foo/x-likely-high", NULL));
+  fail_unless (gst_type_find_register (NULL, "foo/x-likely-low",
+          GST_RANK_SECONDARY, likely_typefind, NULL, NULL,
+          (gpointer) "foo/x-likely-low", NULL));
+
+  caps = gst_type_find_helper_for_data_with_pool (NULL, data, sizeof (data),
+      pool, &prob);
+  fail_unless (caps != NULL);
+  fail_unless_equals_int (prob, GST_TYPE_FIND_LIKELY);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "foo/x-likely-high"));
+  gst_caps_unref (caps);
+
+  /* a higher probability wins over the rank */
+  fail_unless (gst_type_find_register (NULL, "foo/x-maximum",
+          GST_RANK_MARGINAL, maximum_typefind, NULL, NULL,
+          (gpointer) "foo/x-maximum", NULL));
+
+  caps = gst_type_find_helper_for_data_with_pool (NULL, data, sizeof (data),
+      pool, &prob);
+  fail_unless (caps != NULL);
+  fail_unless_equals_int (prob, GST_TYPE_FIND_MAXIMUM);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "foo/x-maximum"));
+  gst_caps_unref (caps);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_typefindhelper_suite (void)
 {
@@ -80,6 +209,8 @@ gst_typefindhelper_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_buffer_range);
+  tcase_add_test (tc_chain, test_prefixes);
+  tcase_add_test (tc_chain, test_for_data_with_pool);
 
   return s;
 }
@@ -704,6 +704,73 @@ GST_START_TEST (test_parsing)
 
 GST_END_TEST;
 
+GST_START_TEST (test_parse_template)
+{
+  GstParseTemplate *tmpl;
+  GstStructure *overrides;
+  GstElement *pipeline, *src, *sink;
+  GError *err = NULL;
+  gboolean sync;
+  gint num_buffers;
+
+  tmpl = gst_parse_template_new ("fakesrc name=src num-buffers=3 ! "
+      "fakesink name=sink", GST_PARSE_FLAG_NONE, &err);
+  fail_unless (tmpl != NULL);
+  fail_unless (err == NULL);
+
+  /* without overrides */
+  pipeline = gst_parse_template_instantiate (tmpl, NULL, &err);
+  fail_unless (GST_IS_PIPELINE (pipeline));
+  fail_unless (err == NULL);
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  fail_unless (src != NULL);
+  g_object_get (src, "num-buffers", &num_buffers, NULL);
+  fail_unless_equals_int (num_buffers, 3);
+  gst_object_unref (src);
+  gst_object_unref (pipeline);
+
+  /* with overrides, from strings and typed values */
+  overrides = gst_structure_new ("overrides", "sink::sync", G_TYPE_BOOLEAN,
+      TRUE, "src::num-buffers", G_TYPE_STRING, "5", NULL);
+  pipeline = gst_parse_template_instantiate (tmpl, overrides, &err);
+  fail_unless (GST_IS_PIPELINE (pipeline));
+  fail_unless (err == NULL);
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_object_get (src, "num-buffers", &num_buffers, NULL);
+  fail_unless_equals_int (num_buffers, 5);
+  g_object_get (sink, "sync", &sync, NULL);
+  fail_unless (sync);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+  gst_structure_free (overrides);
+
+  /* unknown properties are errors */
+  overrides = gst_structure_new ("overrides", "sink::coffee", G_TYPE_INT, 1,
+      NULL);
+  pipeline = gst_parse_template_instantiate (tmpl, overrides, &err);
+  fail_unless (pipeline == NULL);
+  fail_unless (g_error_matches (err, GST_PARSE_ERROR,
+          GST_PARSE_ERROR_NO_SUCH_PROPERTY));
+  g_clear_error (&err);
+  gst_structure_free (overrides);
+
+  fail_unless_equals_string (gst_parse_template_get_description (tmpl),
+      "fakesrc name=src num-buffers=3 ! fakesink name=sink");
+  gst_parse_template_unref (tmpl);
+
+  /* missing elements are always fatal for templates */
+  tmpl = gst_parse_template_new ("fakesrc ! coffeesink", GST_PARSE_FLAG_NONE,
+      &err);
+  fail_unless (tmpl == NULL);
+  fail_unless (g_error_matches (err, GST_PARSE_ERROR,
+          GST_PARSE_ERROR_NO_SUCH_ELEMENT));
+  g_clear_error (&err);
+}
+
+GST_END_TEST;
+
 static Suite *
 parse_suite (void)
 {
@@ -722,6 +789,7 @@ parse_suite (void)
   tcase_add_test (tc_chain, test_flags);
   tcase_add_test (tc_chain, test_missing_elements);
   tcase_add_test (tc_chain, test_parsing);
+  tcase_add_test (tc_chain, test_parse_template);
   return s;
 }
 
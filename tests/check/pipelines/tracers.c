@@ -0,0 +1,242 @@
+/* GStreamer unit tests for the core tracers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+static GList *records;          /* NULL */
+static GMutex records_lock;
+
+static void
+tracer_log_func (GstDebugCategory * category,
+    GstDebugLevel level, const gchar * file, const gchar * function,
+    gint line, GObject * object, GstDebugMessage * message, gpointer unused)
+{
+  GstStructure *s;
+
+  if (level != GST_LEVEL_TRACE || !g_str_equal (category->name, "GST_TRACER"))
+    return;
+
+  s = gst_structure_from_string (gst_debug_message_get (message), NULL);
+  if (s == NULL)
+    return;
+
+  g_mutex_lock (&records_lock);
+  records = g_list_append (records, s);
+  g_mutex_unlock (&records_lock);
+}
+
+static void
+setup (void)
+{
+  gst_debug_remove_log_function (gst_debug_log_default);
+  gst_debug_add_log_function (tracer_log_func, NULL, NULL);
+  gst_debug_set_threshold_for_name ("GST_TRACER", GST_LEVEL_TRACE);
+  records = NULL;
+}
+
+static void
+cleanup (void)
+{
+  gst_debug_set_threshold_for_name ("GST_TRACER", GST_LEVEL_NONE);
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+  gst_debug_remove_log_function (tracer_log_func);
+  g_list_free_full (records, (GDestroyNotify) gst_structure_free);
+  records = NULL;
+}
+
+/* the factory type is opaque, load the plugin and look up @type_name */
+static GstTracer *
+tracer_new (const gchar * name, const gchar * type_name)
+{
+  GstPluginFeature *feature, *loaded;
+  GstTracer *tracer;
+  GType type;
+
+  feature = gst_registry_lookup_feature (gst_registry_get (), name);
+  fail_unless (feature != NULL, "no tracer named '%s'", name);
+  loaded = gst_plugin_feature_load (feature);
+  fail_unless (loaded != NULL);
+  gst_object_unref (loaded);
+  gst_object_unref (feature);
+
+  type = g_type_from_name (type_name);
+  fail_unless (type != 0);
+  tracer = g_object_new (type, NULL);
+  gst_object_ref_sink (tracer);
+
+  return tracer;
+}
+
+static void
+play_to_eos (GstElement * pipeline)
+{
+  GstMessage *msg;
+  GstBus *bus;
+
+  fail_if (gst_element_set_state (pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+}
+
+static void
+run_pipeline (const gchar * name)
+{
+  GstElement *pipeline, *src, *filter, *sink;
+  GstCaps *caps;
+
+  pipeline = gst_pipeline_new (name);
+  src = gst_element_factory_make ("fakesrc", "src");
+  filter = gst_element_factory_make ("capsfilter", "filter");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  fail_unless (pipeline && src && filter && sink);
+
+  g_object_set (src, "num-buffers", 3, NULL);
+  caps = gst_caps_new_empty_simple ("foo/bar");
+  g_object_set (filter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  gst_bin_add_many (GST_BIN (pipeline), src, filter, sink, NULL);
+  fail_unless (gst_element_link_many (src, filter, sink, NULL));
+
+  play_to_eos (pipeline);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipeline);
+}
+
+/* the number of element-negotiation records for @element and the sum of
+ * their caps queries */
+static guint
+count_negotiation_records (const gchar * element, guint * caps_queries)
+{
+  GList *l;
+  guint n = 0;
+
+  *caps_queries = 0;
+  for (l = records; l; l = l->next) {
+    GstStructure *s = l->data;
+    guint ix, queries;
+
+    if (!gst_structure_has_name (s, "element-negotiation") ||
+        g_strcmp0 (gst_structure_get_string (s, "element"), element))
+      continue;
+
+    fail_unless (gst_structure_get_uint (s, "element-ix", &ix));
+    fail_unless (gst_structure_get_uint (s, "caps-queries", &queries));
+    *caps_queries += queries;
+    n++;
+  }
+  return n;
+}
+
+GST_START_TEST (test_negotiation_two_instances)
+{
+  GstTracer *t1, *t2;
+  guint n, queries1, queries2;
+
+  /* each instance keeps its own entries for the same elements */
+  t1 = tracer_new ("negotiation", "GstNegotiationTracer");
+  t2 = tracer_new ("negotiation", "GstNegotiationTracer");
+
+  run_pipeline ("pipeline");
+
+  g_mutex_lock (&records_lock);
+  n = count_negotiation_records ("filter", &queries1);
+  fail_unless_equals_int (n, 2);
+  fail_unless (queries1 > 0);
+  fail_unless_equals_int (count_negotiation_records ("sink", &queries2), 2);
+  g_mutex_unlock (&records_lock);
+
+  g_list_free_full (records, (GDestroyNotify) gst_structure_free);
+  records = NULL;
+
+  /* an element of the same name in a second pipeline gets a new entry, the
+   * totals of the first one are logged again along with it */
+  run_pipeline ("pipeline");
+
+  g_mutex_lock (&records_lock);
+  fail_unless_equals_int (count_negotiation_records ("filter", &queries2), 4);
+  fail_unless (queries2 > queries1);
+  g_mutex_unlock (&records_lock);
+
+  /* the hooks keep a ref until the tracing system is shut down */
+  gst_object_unref (t1);
+  gst_object_unref (t2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_graph_stats)
+{
+  GstElement *pipeline;
+  GstTracer *tracer;
+  gchar *dot;
+
+  tracer = tracer_new ("graphstats", "GstGraphStatsTracer");
+
+  pipeline = gst_parse_launch ("fakesrc num-buffers=10 sizetype=fixed "
+      "sizemax=100 ! fakesink", NULL);
+  fail_unless (pipeline != NULL);
+  play_to_eos (pipeline);
+
+  /* the statistics are only asked for when explicitly requested */
+  dot = gst_debug_bin_to_dot_data (GST_BIN (pipeline),
+      GST_DEBUG_GRAPH_SHOW_VERBOSE);
+  fail_if (strstr (dot, "buffers/s") != NULL);
+  fail_if (strstr (dot, "busy") != NULL);
+  g_free (dot);
+
+  dot = gst_debug_bin_to_dot_data (GST_BIN (pipeline),
+      GST_DEBUG_GRAPH_SHOW_ALL | GST_DEBUG_GRAPH_SHOW_STATS);
+  fail_unless (strstr (dot, "buffers/s") != NULL);
+  fail_unless (strstr (dot, "B/s") != NULL);
+  fail_unless (strstr (dot, "% busy") != NULL);
+  g_free (dot);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipeline);
+  gst_object_unref (tracer);
+}
+
+GST_END_TEST;
+
+static Suite *
+tracers_suite (void)
+{
+  Suite *s = suite_create ("tracers");
+  TCase *tc_chain = tcase_create ("negotiation");
+  TCase *tc_graph = tcase_create ("graphstats");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_checked_fixture (tc_chain, setup, cleanup);
+  tcase_add_test (tc_chain, test_negotiation_two_instances);
+
+  suite_add_tcase (s, tc_graph);
+  tcase_add_test (tc_graph, test_graph_stats);
+
+  return s;
+}
+
+GST_CHECK_MAIN (tracers);
@@ -1093,55 +1093,36 @@ print_all_uri_handlers (void)
       GstPluginFeature *feature = GST_PLUGIN_FEATURE (f->data);
 
       if (GST_IS_ELEMENT_FACTORY (feature)) {
-        GstElementFactory *factory;
-        GstElement *element;
-
-        factory = GST_ELEMENT_FACTORY (gst_plugin_feature_load (feature));
-        if (!factory) {
-          g_print ("element plugin %s couldn't be loaded\n",
-              gst_plugin_get_name (plugin));
+        GstElementFactory *factory = GST_ELEMENT_FACTORY (feature);
+        const gchar *const *uri_protocols;
+        const gchar *dir;
+        gchar *joined;
+
+        /* the URI type and protocols are stored in the registry, no need to
+         * load the plugin and create the element */
+        uri_protocols = gst_element_factory_get_uri_protocols (factory);
+        if (uri_protocols == NULL)
           continue;
-        }
 
-        element = gst_element_factory_create (factory, NULL);
-        if (!element) {
-          g_print ("couldn't construct element for %s for some reason\n",
-              GST_OBJECT_NAME (factory));
-          gst_object_unref (factory);
-          continue;
+        switch (gst_element_factory_get_uri_type (factory)) {
+          case GST_URI_SRC:
+            dir = "read";
+            break;
+          case GST_URI_SINK:
+            dir = "write";
+            break;
+          default:
+            dir = "unknown";
+            break;
         }
 
-        if (GST_IS_URI_HANDLER (element)) {
-          const gchar *const *uri_protocols;
-          const gchar *dir;
-          gchar *joined;
-
-          switch (gst_uri_handler_get_uri_type (GST_URI_HANDLER (element))) {
-            case GST_URI_SRC:
-              dir = "read";
-              break;
-            case GST_URI_SINK:
-              dir = "write";
-              break;
-            default:
-              dir = "unknown";
-              break;
-          }
-
-          uri_protocols =
-              gst_uri_handler_get_protocols (GST_URI_HANDLER (element));
-          joined = g_strjoinv (", ", (gchar **) uri_protocols);
+        joined = g_strjoinv (", ", (gchar **) uri_protocols);
 
-          g_print ("%s (%s, rank %u): %s\n",
-              gst_plugin_feature_get_name (GST_PLUGIN_FEATURE (factory)), dir,
-              gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (factory)),
-              joined);
+        g_print ("%s (%s, rank %u): %s\n",
+            gst_plugin_feature_get_name (feature), dir,
+            gst_plugin_feature_get_rank (feature), joined);
 
-          g_free (joined);
-        }
-
-        gst_object_unref (element);
-        gst_object_unref (factory);
+        g_free (joined);
       }
     }
 
@@ -1575,19 +1556,16 @@ print_plugin_automatic_install_info (GstPlugin * plugin)
 {
   GList *features, *l;
 
-  /* not interested in typefind factories, only element factories */
-  features = gst_registry_get_feature_list (gst_registry_get (),
-      GST_TYPE_ELEMENT_FACTORY);
+  features = gst_registry_get_feature_list_by_plugin (gst_registry_get (),
+      gst_plugin_get_name (plugin));
 
   for (l = features; l != NULL; l = l->next) {
     GstPluginFeature *feature;
-    GstPlugin *feature_plugin;
 
     feature = GST_PLUGIN_FEATURE (l->data);
 
-    /* only interested in the ones that are in the plugin we just loaded */
-    feature_plugin = gst_plugin_feature_get_plugin (feature);
-    if (feature_plugin == plugin) {
+    /* not interested in typefind factories, only element factories */
+    if (GST_IS_ELEMENT_FACTORY (feature)) {
       GstElementFactory *factory;
 
       g_print ("element-%s\n", gst_plugin_feature_get_name (feature));
@@ -1596,12 +1574,9 @@ print_plugin_automatic_install_info (GstPlugin * plugin)
       print_plugin_automatic_install_info_protocols (factory);
       print_plugin_automatic_install_info_codecs (factory);
     }
-    if (feature_plugin)
-      gst_object_unref (feature_plugin);
   }
 
-  g_list_foreach (features, (GFunc) gst_object_unref, NULL);
-  g_list_free (features);
+  gst_plugin_feature_list_free (features);
 }
 
 static void
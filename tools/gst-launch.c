@@ -40,7 +40,16 @@
 #include <windows.h>
 #endif
 #include <locale.h>             /* for LC_ALL */
+#ifdef HAVE_CLOCK_GETTIME
+#include <time.h>
+#endif
+
+/* for the tracer hooks used by --stats */
+#define GST_USE_UNSTABLE_API
 #include "tools.h"
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+#include "gst/gstproctimestack.h"
+#endif
 
 extern volatile gboolean glib_on_error_halt;
 
@@ -66,6 +75,7 @@ static gboolean messages = FALSE;
 static gboolean is_live = FALSE;
 static gboolean waiting_eos = FALSE;
 static gchar **exclude_args = NULL;
+static gint stats_interval = 0;
 
 /* convenience macro so we don't have to litter the code with if(!quiet) */
 #define PRINT if(!quiet)g_print
@@ -510,9 +520,11 @@ hup_handler (gpointer user_data)
         "environment variable not set.\n");
   }
 
-  /* dump graph on hup */
+  /* dump graph on hup, with the statistics of the tracers since the previous
+   * snapshot */
   GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS (GST_BIN (pipeline),
-      GST_DEBUG_GRAPH_SHOW_ALL, "gst-launch.snapshot");
+      GST_DEBUG_GRAPH_SHOW_ALL | GST_DEBUG_GRAPH_SHOW_STATS,
+      "gst-launch.snapshot");
 
   return G_SOURCE_CONTINUE;
 }
@@ -529,6 +541,383 @@ w32_intr_handler (DWORD dwCtrlType)
 #endif /* G_OS_WIN32 */
 #endif /* G_OS_UNIX */
 
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+/* statistics of the elements, gathered with a tracer when --stats is used */
+typedef struct
+{
+  gchar *name;
+  guint64 buffers, bytes;
+  GstClockTime proc_time;
+  /* the values at the previous report */
+  guint64 last_buffers, last_bytes;
+  GstClockTime last_proc_time;
+  /* the last level when the element is a queue */
+  gboolean is_queue;
+  guint level_buffers;
+  guint64 level_bytes, level_time;
+} LaunchElementStats;
+
+typedef struct
+{
+  GThread *thread;
+  /* the elements that are processing a buffer in this thread, the time is
+   * charged to the innermost one */
+  GArray *stack;
+  GstClockTime cpu, last_cpu;
+} LaunchThreadStats;
+
+typedef struct
+{
+  GstTracer parent;
+} LaunchStatsTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} LaunchStatsTracerClass;
+
+static GType launch_stats_tracer_get_type (void);
+G_DEFINE_TYPE (LaunchStatsTracer, launch_stats_tracer, GST_TYPE_TRACER);
+
+static GstTracer *stats_tracer;
+static GThread *stats_thread;
+static GMutex stats_thread_lock;
+static GCond stats_thread_cond;
+static gboolean stats_thread_stop;
+static GstClockTime stats_start, stats_last;
+
+/* protects the statistics */
+G_LOCK_DEFINE_STATIC (stats);
+static GPtrArray *elem_stats;
+static GPtrArray *thread_stats;
+static GPrivate thread_stats_key;
+static GQuark stats_quark;
+
+static GstClockTime
+get_thread_cpu_time (void)
+{
+#if defined (HAVE_CLOCK_GETTIME) && defined (CLOCK_THREAD_CPUTIME_ID)
+  struct timespec now;
+
+  if (clock_gettime (CLOCK_THREAD_CPUTIME_ID, &now) == 0)
+    return GST_TIMESPEC_TO_TIME (now);
+#endif
+  return 0;
+}
+
+/* called with the stats lock */
+static LaunchElementStats *
+get_element_stats (GstPad * pad)
+{
+  GstObject *parent;
+  LaunchElementStats *stats;
+
+  if (pad == NULL)
+    return NULL;
+
+  /* ghost pads belong to bins, they don't process the data */
+  parent = GST_OBJECT_PARENT (pad);
+  if (!GST_IS_ELEMENT (parent) || GST_IS_BIN (parent))
+    return NULL;
+
+  stats = g_object_get_qdata ((GObject *) parent, stats_quark);
+  if (stats == NULL) {
+    stats = g_slice_new0 (LaunchElementStats);
+    stats->name = g_strdup (GST_OBJECT_NAME (parent));
+    g_ptr_array_add (elem_stats, stats);
+    g_object_set_qdata ((GObject *) parent, stats_quark, stats);
+  }
+  return stats;
+}
+
+/* called with the stats lock */
+static LaunchThreadStats *
+get_thread_stats (void)
+{
+  LaunchThreadStats *stats = g_private_get (&thread_stats_key);
+
+  if (stats == NULL) {
+    stats = g_slice_new0 (LaunchThreadStats);
+    stats->thread = g_thread_self ();
+    stats->stack = proc_time_stack_new ();
+    g_ptr_array_add (thread_stats, stats);
+    g_private_set (&thread_stats_key, stats);
+  }
+  return stats;
+}
+
+static void
+stats_push_pre (GstClockTime ts, GstPad * pad, guint buffers, gsize bytes)
+{
+  LaunchElementStats *stats;
+  LaunchThreadStats *tstats;
+
+  G_LOCK (stats);
+  if ((stats = get_element_stats (pad))) {
+    stats->buffers += buffers;
+    stats->bytes += bytes;
+  }
+
+  tstats = get_thread_stats ();
+  stats = get_element_stats (GST_PAD_PEER (pad));
+  proc_time_stack_push (tstats->stack, stats ? &stats->proc_time : NULL, ts);
+  G_UNLOCK (stats);
+}
+
+static void
+stats_push_post (GstClockTime ts)
+{
+  LaunchThreadStats *tstats;
+  GstClockTime cpu = get_thread_cpu_time ();
+
+  G_LOCK (stats);
+  tstats = get_thread_stats ();
+  tstats->cpu = cpu;
+  proc_time_stack_pop (tstats->stack, ts);
+  G_UNLOCK (stats);
+}
+
+static void
+do_push_buffer_pre (GstTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  stats_push_pre (ts, pad, 1, gst_buffer_get_size (buffer));
+}
+
+static void
+do_push_buffer_list_pre (GstTracer * self, GstClockTime ts, GstPad * pad,
+    GstBufferList * list)
+{
+  stats_push_pre (ts, pad, gst_buffer_list_length (list),
+      gst_buffer_list_calculate_size (list));
+}
+
+static void
+do_push_post (GstTracer * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  stats_push_post (ts);
+}
+
+static void
+do_pull_range_post (GstTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  LaunchElementStats *stats;
+
+  if (res != GST_FLOW_OK || buffer == NULL)
+    return;
+
+  G_LOCK (stats);
+  if ((stats = get_element_stats (GST_PAD_PEER (pad)))) {
+    stats->buffers++;
+    stats->bytes += gst_buffer_get_size (buffer);
+  }
+  G_UNLOCK (stats);
+}
+
+static void
+do_queue_level (GstTracer * self, GstClockTime ts, GstElement * queue,
+    GstPad * pad, guint buffers, guint64 bytes, guint64 time)
+{
+  LaunchElementStats *stats;
+
+  G_LOCK (stats);
+  if ((stats = get_element_stats (pad))) {
+    stats->is_queue = TRUE;
+    stats->level_buffers = buffers;
+    stats->level_bytes = bytes;
+    stats->level_time = time;
+  }
+  G_UNLOCK (stats);
+}
+
+static void
+launch_stats_tracer_class_init (LaunchStatsTracerClass * klass)
+{
+}
+
+static void
+launch_stats_tracer_init (LaunchStatsTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_post));
+  gst_tracing_register_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_pull_range_post));
+  gst_tracing_register_hook (tracer, "queue-level",
+      G_CALLBACK (do_queue_level));
+}
+
+static void
+free_element_stats (LaunchElementStats * stats)
+{
+  g_free (stats->name);
+  g_slice_free (LaunchElementStats, stats);
+}
+
+static void
+free_thread_stats (LaunchThreadStats * stats)
+{
+  g_array_free (stats->stack, TRUE);
+  g_slice_free (LaunchThreadStats, stats);
+}
+
+static gdouble
+per_second (guint64 value, GstClockTime elapsed)
+{
+  if (elapsed == 0)
+    return 0.0;
+
+  return (gdouble) value * GST_SECOND / elapsed;
+}
+
+/* prints the statistics since the previous report, or since the start when
+ * @summary is set */
+static void
+print_stats (gboolean summary)
+{
+  GstClockTime now, elapsed, proc_total = 0;
+  guint i;
+
+  G_LOCK (stats);
+  now = gst_util_get_timestamp ();
+  elapsed = summary ? now - stats_start : now - stats_last;
+
+  for (i = 0; i < elem_stats->len; i++) {
+    LaunchElementStats *stats = g_ptr_array_index (elem_stats, i);
+
+    proc_total += summary ? stats->proc_time :
+        stats->proc_time - stats->last_proc_time;
+  }
+
+  if (summary)
+    g_print (_("Statistics after %" GST_TIME_FORMAT ":\n"),
+        GST_TIME_ARGS (elapsed));
+  else
+    g_print (_("Statistics of the last %" GST_TIME_FORMAT ":\n"),
+        GST_TIME_ARGS (elapsed));
+
+  g_print ("  %-24s %12s %14s %7s\n", _("element"), _("buffers/s"),
+      _("bytes/s"), _("time"));
+  for (i = 0; i < elem_stats->len; i++) {
+    LaunchElementStats *stats = g_ptr_array_index (elem_stats, i);
+    guint64 buffers, bytes;
+    GstClockTime proc_time;
+
+    if (summary) {
+      buffers = stats->buffers;
+      bytes = stats->bytes;
+      proc_time = stats->proc_time;
+    } else {
+      buffers = stats->buffers - stats->last_buffers;
+      bytes = stats->bytes - stats->last_bytes;
+      proc_time = stats->proc_time - stats->last_proc_time;
+    }
+
+    g_print ("  %-24s %12.1f %14.1f %6.1f%%\n", stats->name,
+        per_second (buffers, elapsed), per_second (bytes, elapsed),
+        proc_total ? 100.0 * proc_time / proc_total : 0.0);
+    if (stats->is_queue && !summary)
+      g_print (_("  %-24s level %u buffers, %" G_GUINT64_FORMAT " bytes, %"
+              GST_TIME_FORMAT "\n"), "", stats->level_buffers,
+          stats->level_bytes, GST_TIME_ARGS (stats->level_time));
+
+    stats->last_buffers = stats->buffers;
+    stats->last_bytes = stats->bytes;
+    stats->last_proc_time = stats->proc_time;
+  }
+
+  for (i = 0; i < thread_stats->len; i++) {
+    LaunchThreadStats *stats = g_ptr_array_index (thread_stats, i);
+    GstClockTime cpu = summary ? stats->cpu : stats->cpu - stats->last_cpu;
+
+    g_print (_("  thread %p: cpu %5.1f%%\n"), stats->thread,
+        elapsed ? 100.0 * cpu / elapsed : 0.0);
+    stats->last_cpu = stats->cpu;
+  }
+  stats_last = now;
+  G_UNLOCK (stats);
+}
+
+static gpointer
+stats_thread_func (gpointer data)
+{
+  gint64 end_time = g_get_monotonic_time ();
+
+  g_mutex_lock (&stats_thread_lock);
+  while (!stats_thread_stop) {
+    end_time += stats_interval * G_TIME_SPAN_SECOND;
+    while (!stats_thread_stop && g_cond_wait_until (&stats_thread_cond,
+            &stats_thread_lock, end_time));
+    if (!stats_thread_stop)
+      print_stats (FALSE);
+  }
+  g_mutex_unlock (&stats_thread_lock);
+
+  return NULL;
+}
+
+static void
+stats_start_tracing (void)
+{
+  stats_quark = g_quark_from_static_string ("gst-launch-stats");
+  elem_stats = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      free_element_stats);
+  thread_stats = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      free_thread_stats);
+  stats_tracer = g_object_ref_sink (g_object_new (launch_stats_tracer_get_type
+          (), NULL));
+}
+
+static void
+stats_start_reporting (void)
+{
+  if (stats_tracer == NULL)
+    return;
+
+  G_LOCK (stats);
+  stats_start = stats_last = gst_util_get_timestamp ();
+  G_UNLOCK (stats);
+  stats_thread = g_thread_new ("gst-launch-stats", stats_thread_func, NULL);
+}
+
+static void
+stats_stop_reporting (void)
+{
+  if (stats_thread == NULL)
+    return;
+
+  g_mutex_lock (&stats_thread_lock);
+  stats_thread_stop = TRUE;
+  g_cond_signal (&stats_thread_cond);
+  g_mutex_unlock (&stats_thread_lock);
+
+  g_thread_join (stats_thread);
+  stats_thread = NULL;
+}
+
+static void
+stats_free (void)
+{
+  if (elem_stats)
+    g_ptr_array_unref (elem_stats);
+  if (thread_stats)
+    g_ptr_array_unref (thread_stats);
+  elem_stats = thread_stats = NULL;
+  if (stats_tracer)
+    gst_object_unref (stats_tracer);
+  stats_tracer = NULL;
+}
+#endif /* GST_DISABLE_GST_TRACER_HOOKS */
+
 /* returns ELR_ERROR if there was an error
  * or ELR_INTERRUPT if we caught a keyboard interrupt
  * or ELR_NO_ERROR otherwise. */
@@ -1005,6 +1394,12 @@ main (int argc, char *argv[])
         N_("Do not install a fault handler"), NULL},
     {"eos-on-shutdown", 'e', 0, G_OPTION_ARG_NONE, &eos_on_shutdown,
         N_("Force EOS on sources before shutting the pipeline down"), NULL},
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+    {"stats", 's', 0, G_OPTION_ARG_INT, &stats_interval,
+          N_("Output the throughput and processing time of the elements "
+              "every SECONDS seconds and a summary at the end"),
+        N_("SECONDS")},
+#endif
 #if 0
     {"index", 'i', 0, G_OPTION_ARG_NONE, &check_index,
         N_("Gather and print index statistics"), NULL},
@@ -1063,6 +1458,11 @@ main (int argc, char *argv[])
     fault_setup ();
 #endif
 
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  if (stats_interval > 0)
+    stats_start_tracing ();
+#endif
+
   /* make a null-terminated version of argv */
   argvn = g_new0 (char *, argc);
   memcpy (argvn, argv + 1, sizeof (char *) * (argc - 1));
@@ -1184,6 +1584,9 @@ main (int argc, char *argv[])
         goto end;
       }
 
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+      stats_start_reporting ();
+#endif
       tfthen = gst_util_get_timestamp ();
       caught_error = event_loop (pipeline, TRUE, FALSE, GST_STATE_PLAYING);
       res = caught_error;
@@ -1228,6 +1631,13 @@ main (int argc, char *argv[])
 
       PRINT (_("Execution ended after %" GST_TIME_FORMAT "\n"),
           GST_TIME_ARGS (diff));
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+      if (stats_thread) {
+        stats_stop_reporting ();
+        print_stats (TRUE);
+      }
+#endif
     }
 
     PRINT (_("Setting pipeline to PAUSED ...\n"));
@@ -1263,5 +1673,9 @@ main (int argc, char *argv[])
 
   gst_deinit ();
 
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  stats_free ();
+#endif
+
   return res;
 }
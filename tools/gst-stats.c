@@ -37,6 +37,7 @@ static GRegex *ansi_log = NULL;
 static GHashTable *threads = NULL;
 static GPtrArray *elements = NULL;
 static GPtrArray *pads = NULL;
+static GHashTable *negotiations = NULL;
 static guint64 num_buffers = 0, num_events = 0, num_messages = 0, num_queries =
     0;
 static guint num_elements = 0, num_bins = 0, num_pads = 0, num_ghostpads = 0;
@@ -44,6 +45,11 @@ static GstClockTime last_ts = G_GUINT64_CONSTANT (0);
 static guint total_cpuload = 0;
 static gboolean have_cpuload = FALSE;
 
+/* buffer sizes are counted in buckets of 8 steps per power of two, this gives
+ * percentiles within 12.5% without keeping all the sizes */
+#define SIZE_BUCKET_STEPS 8
+#define NUM_SIZE_BUCKETS (32 * SIZE_BUCKET_STEPS)
+
 typedef struct
 {
   /* human readable pad name and details */
@@ -56,6 +62,7 @@ typedef struct
   guint num_live, num_decode_only, num_discont, num_resync, num_corrupted,
       num_marker, num_header, num_gap, num_droppable, num_delta;
   guint min_size, max_size, avg_size;
+  guint *size_buckets;
   /* first and last activity on the pad, expected next_ts */
   GstClockTime first_ts, last_ts, next_ts;
   /* in which thread does it operate */
@@ -86,8 +93,25 @@ typedef struct
   /* time spend in this thread */
   GstClockTime tthread;
   guint cpuload;
+  /* the last task that ran in this thread */
+  gchar *task;
+  GstClockTime ttask;
+  guint task_cpuload;
 } GstThreadStats;
 
+typedef struct
+{
+  gchar *name;
+  /* the element-ix of the negotiation tracer, the key in the negotiations
+   * table, names are not unique */
+  guint ix;
+  /* as logged by the negotiation tracer */
+  guint caps_queries, accept_caps_queries, allocation_queries;
+  GstClockTime time;
+  guint max_depth, max_caps_size;
+  guint caps_events, reconfigure_events;
+} GstNegotiationStats;
+
 /* stats helper */
 
 static void
@@ -113,9 +137,52 @@ get_pad_stats (guint ix)
 static void
 free_pad_stats (gpointer data)
 {
+  g_free (((GstPadStats *) data)->size_buckets);
   g_slice_free (GstPadStats, data);
 }
 
+static guint
+size_to_bucket (guint size)
+{
+  guint msb;
+
+  if (size < SIZE_BUCKET_STEPS)
+    return size;
+
+  msb = g_bit_nth_msf (size, -1);
+  return (msb - 2) * SIZE_BUCKET_STEPS +
+      ((size >> (msb - 3)) & (SIZE_BUCKET_STEPS - 1));
+}
+
+static guint
+bucket_to_size (guint bucket)
+{
+  guint msb, step;
+
+  if (bucket < SIZE_BUCKET_STEPS)
+    return bucket;
+
+  msb = bucket / SIZE_BUCKET_STEPS + 2;
+  step = bucket % SIZE_BUCKET_STEPS;
+  return (SIZE_BUCKET_STEPS + step) << (msb - 3);
+}
+
+/* the size that @percentile percent of the buffers of @stats are below */
+static guint
+get_size_percentile (GstPadStats * stats, guint percentile)
+{
+  guint64 rank, count = 0;
+  guint i;
+
+  rank = ((guint64) stats->num_buffers * percentile + 99) / 100;
+  for (i = 0; i < NUM_SIZE_BUCKETS; i++) {
+    count += stats->size_buckets[i];
+    if (count >= rank && count > 0)
+      return CLAMP (bucket_to_size (i), stats->min_size, stats->max_size);
+  }
+  return stats->max_size;
+}
+
 static inline GstThreadStats *
 get_thread_stats (gpointer id)
 {
@@ -200,6 +267,7 @@ new_element_stats (GstStructure * s)
 static void
 free_thread_stats (gpointer data)
 {
+  g_free (((GstThreadStats *) data)->task);
   g_slice_free (GstThreadStats, data);
 }
 
@@ -219,12 +287,15 @@ do_pad_stats (GstPadStats * stats, guint elem_ix, guint size, guint64 ts,
   }
 
   /* size stats */
+  if (G_UNLIKELY (!stats->size_buckets))
+    stats->size_buckets = g_new0 (guint, NUM_SIZE_BUCKETS);
+  stats->size_buckets[size_to_bucket (size)]++;
   avg_size = (((gulong) stats->avg_size * (gulong) stats->num_buffers) + size);
   stats->num_buffers++;
   stats->avg_size = (guint) (avg_size / stats->num_buffers);
   if (size < stats->min_size)
     stats->min_size = size;
-  else if (size > stats->max_size)
+  if (size > stats->max_size)
     stats->max_size = size;
   /* time stats */
   if (!GST_CLOCK_TIME_IS_VALID (stats->last_ts))
@@ -382,6 +453,43 @@ do_query_stats (GstStructure * s)
   elem_stats->num_queries++;
 }
 
+static void
+free_negotiation_stats (gpointer data)
+{
+  g_free (((GstNegotiationStats *) data)->name);
+  g_slice_free (GstNegotiationStats, data);
+}
+
+static void
+do_negotiation_stats (GstStructure * s)
+{
+  GstNegotiationStats *stats;
+  const gchar *name;
+  guint ix;
+
+  if (!(name = gst_structure_get_string (s, "element")) ||
+      !gst_structure_get_uint (s, "element-ix", &ix))
+    return;
+
+  /* the tracer logs the totals so far, keep the last ones */
+  if (!(stats = g_hash_table_lookup (negotiations, GUINT_TO_POINTER (ix)))) {
+    stats = g_slice_new0 (GstNegotiationStats);
+    stats->name = g_strdup (name);
+    stats->ix = ix;
+    g_hash_table_insert (negotiations, GUINT_TO_POINTER (ix), stats);
+  }
+
+  gst_structure_get (s,
+      "caps-queries", G_TYPE_UINT, &stats->caps_queries,
+      "accept-caps-queries", G_TYPE_UINT, &stats->accept_caps_queries,
+      "allocation-queries", G_TYPE_UINT, &stats->allocation_queries,
+      "time", G_TYPE_UINT64, &stats->time,
+      "max-depth", G_TYPE_UINT, &stats->max_depth,
+      "max-caps-size", G_TYPE_UINT, &stats->max_caps_size,
+      "caps-events", G_TYPE_UINT, &stats->caps_events,
+      "reconfigure-events", G_TYPE_UINT, &stats->reconfigure_events, NULL);
+}
+
 static void
 do_thread_rusage_stats (GstStructure * s)
 {
@@ -399,6 +507,29 @@ do_thread_rusage_stats (GstStructure * s)
   last_ts = MAX (last_ts, ts);
 }
 
+static void
+do_task_rusage_stats (GstStructure * s)
+{
+  guint64 ts, ttask, thread_id;
+  guint cpuload;
+  const gchar *task;
+  GstThreadStats *thread_stats;
+
+  gst_structure_get (s, "ts", G_TYPE_UINT64, &ts,
+      "thread-id", G_TYPE_UINT64, &thread_id,
+      "average-cpuload", G_TYPE_UINT, &cpuload, "time", G_TYPE_UINT64, &ttask,
+      NULL);
+  task = gst_structure_get_string (s, "task");
+  thread_stats = get_thread_stats ((gpointer) (guintptr) thread_id);
+  if (g_strcmp0 (thread_stats->task, task)) {
+    g_free (thread_stats->task);
+    thread_stats->task = g_strdup (task);
+  }
+  thread_stats->task_cpuload = cpuload;
+  thread_stats->ttask = ttask;
+  last_ts = MAX (last_ts, ts);
+}
+
 static void
 do_proc_rusage_stats (GstStructure * s)
 {
@@ -451,6 +582,9 @@ print_pad_stats (gpointer value, gpointer user_data)
       } else {
         printf (" size (min/avg/max) %7u/%7u/%7u,",
             stats->min_size, stats->avg_size, stats->max_size);
+        printf (" size (p50/p90/p99) %7u/%7u/%7u,",
+            get_size_percentile (stats, 50), get_size_percentile (stats, 90),
+            get_size_percentile (stats, 99));
       }
       printf (" time %" GST_TIME_FORMAT ","
           " bytes/sec %lf\n",
@@ -477,6 +611,11 @@ print_thread_stats (gpointer key, gpointer value, gpointer user_data)
     printf ("  Time: %" GST_TIME_FORMAT "\n", GST_TIME_ARGS (stats->tthread));
     printf ("  Avg CPU load: %4.1f %%\n", (gfloat) stats->cpuload / 10.0);
   }
+  if (stats->task) {
+    printf ("  Task %s: %" GST_TIME_FORMAT ", Avg CPU load: %4.1f %%\n",
+        stats->task, GST_TIME_ARGS (stats->ttask),
+        (gfloat) stats->task_cpuload / 10.0);
+  }
 
   puts ("  Pad Statistics:");
   g_slist_foreach (node, print_pad_stats, key);
@@ -542,6 +681,28 @@ accum_element_stats (gpointer value, gpointer user_data)
 
 /* sorting */
 
+static gint
+sort_negotiation_stats_by_time (gconstpointer ns1, gconstpointer ns2)
+{
+  GstClockTime t1 = ((GstNegotiationStats *) ns1)->time;
+  GstClockTime t2 = ((GstNegotiationStats *) ns2)->time;
+
+  return (t1 < t2) - (t1 > t2);
+}
+
+static void
+print_negotiation_stats (gpointer value, gpointer user_data)
+{
+  GstNegotiationStats *stats = (GstNegotiationStats *) value;
+
+  printf ("  %-45s: caps/accept/alloc %6u/%6u/%6u time %" GST_TIME_FORMAT
+      " depth %3u caps size %4u caps/reconfigure events %5u/%5u\n",
+      stats->name, stats->caps_queries, stats->accept_caps_queries,
+      stats->allocation_queries, GST_TIME_ARGS (stats->time),
+      stats->max_depth, stats->max_caps_size, stats->caps_events,
+      stats->reconfigure_events);
+}
+
 static gint
 sort_pad_stats_by_first_activity (gconstpointer ps1, gconstpointer ps2)
 {
@@ -668,6 +829,8 @@ init (void)
   elements = g_ptr_array_new_with_free_func (free_element_stats);
   pads = g_ptr_array_new_with_free_func (free_pad_stats);
   threads = g_hash_table_new_full (NULL, NULL, NULL, free_thread_stats);
+  negotiations = g_hash_table_new_full (NULL, NULL, NULL,
+      free_negotiation_stats);
 
   return TRUE;
 }
@@ -681,6 +844,8 @@ done (void)
     g_ptr_array_free (elements, TRUE);
   if (threads)
     g_hash_table_destroy (threads);
+  if (negotiations)
+    g_hash_table_destroy (negotiations);
 
   if (raw_log)
     g_regex_unref (raw_log);
@@ -689,11 +854,10 @@ done (void)
 }
 
 static void
-print_stats (void)
+print_overall_stats (void)
 {
   guint num_threads = g_hash_table_size (threads);
 
-  /* print overall stats */
   puts ("\nOverall Statistics:");
   printf ("Number of Threads: %u\n", num_threads);
   printf ("Number of Elements: %u\n", num_elements - num_bins);
@@ -709,6 +873,15 @@ print_stats (void)
     printf ("Avg CPU load: %4.1f %%\n", (gfloat) total_cpuload / 10.0);
   }
   puts ("");
+}
+
+static void
+print_stats (void)
+{
+  guint num_threads = g_hash_table_size (threads);
+
+  /* print overall stats */
+  print_overall_stats ();
 
   /* thread stats */
   if (num_threads) {
@@ -758,21 +931,284 @@ print_stats (void)
     puts ("");
     g_slist_free (list);
   }
+
+  /* negotiation stats */
+  if (g_hash_table_size (negotiations)) {
+    GList *list = g_hash_table_get_values (negotiations);
+
+    puts ("Negotiation Statistics:");
+    /* the most expensive first */
+    list = g_list_sort (list, sort_negotiation_stats_by_time);
+    g_list_foreach (list, print_negotiation_stats, NULL);
+    puts ("");
+    g_list_free (list);
+  }
+}
+
+/* the log is parsed in a thread per file, the records are aggregated in the
+ * main thread in the order of the files */
+#define READER_BATCH_SIZE 1024
+#define READER_MAX_BATCHES 16
+
+typedef struct
+{
+  const gchar *filename;
+  GThread *thread;
+
+  GMutex lock;
+  GCond cond;
+  /* the parsed records, in batches of #GstStructure */
+  GQueue batches;
+  gboolean done;
+
+  /* the batch that is being filled by the parser thread */
+  GPtrArray *batch;
+} LogReader;
+
+static GstClockTime report_interval = 0;
+static GstClockTime next_report = 0;
+
+static void
+reader_flush (LogReader * reader)
+{
+  g_mutex_lock (&reader->lock);
+  /* limit the memory used when parsing is faster than aggregating */
+  while (g_queue_get_length (&reader->batches) >= READER_MAX_BATCHES)
+    g_cond_wait (&reader->cond, &reader->lock);
+  g_queue_push_tail (&reader->batches, reader->batch);
+  g_cond_signal (&reader->cond);
+  g_mutex_unlock (&reader->lock);
+
+  reader->batch = g_ptr_array_new ();
+}
+
+/* called from the parser thread */
+static void
+parse_trace_record (LogReader * reader, const gchar * data)
+{
+  GstStructure *s;
+
+  if ((s = gst_structure_from_string (data, NULL))) {
+    /* TODO(ensonic): parse the xxx.class log lines */
+    if (g_str_has_suffix (gst_structure_get_name (s), ".class")) {
+      gst_structure_free (s);
+      return;
+    }
+    g_ptr_array_add (reader->batch, s);
+    if (reader->batch->len >= READER_BATCH_SIZE)
+      reader_flush (reader);
+  } else {
+    GST_WARNING ("unknown log entry: '%s'", data);
+  }
 }
 
 static void
-collect_stats (const gchar * filename)
+process_trace_record (GstStructure * s)
 {
+  const gchar *name = gst_structure_get_name (s);
+
+  if (!strcmp (name, "new-pad")) {
+    new_pad_stats (s);
+  } else if (!strcmp (name, "new-element")) {
+    new_element_stats (s);
+  } else if (!strcmp (name, "buffer")) {
+    do_buffer_stats (s);
+  } else if (!strcmp (name, "event")) {
+    do_event_stats (s);
+  } else if (!strcmp (name, "message")) {
+    do_message_stats (s);
+  } else if (!strcmp (name, "query")) {
+    do_query_stats (s);
+  } else if (!strcmp (name, "thread-rusage")) {
+    do_thread_rusage_stats (s);
+  } else if (!strcmp (name, "task-rusage")) {
+    do_task_rusage_stats (s);
+  } else if (!strcmp (name, "proc-rusage")) {
+    do_proc_rusage_stats (s);
+  } else if (!strcmp (name, "element-negotiation")) {
+    do_negotiation_stats (s);
+  } else {
+    GST_WARNING ("unknown log entry: '%s'", name);
+  }
+
+  if (report_interval && last_ts >= next_report) {
+    if (next_report)
+      print_overall_stats ();
+    next_report = (last_ts / report_interval + 1) * report_interval;
+  }
+}
+
+/* binary logs as written by gst_debug_add_binary_logger() */
+#define BINARY_LOG_MAGIC "GSTBLOG1"
+
+static gboolean
+read_binary (FILE * log, gpointer data, gsize size, gboolean swap)
+{
+  if (fread (data, size, 1, log) != 1)
+    return FALSE;
+
+  if (swap && size == 4)
+    *(guint32 *) data = GUINT32_SWAP_LE_BE (*(guint32 *) data);
+  else if (swap && size == 8)
+    *(guint64 *) data = GUINT64_SWAP_LE_BE (*(guint64 *) data);
+
+  return TRUE;
+}
+
+static gchar *
+read_binary_string (FILE * log, guint32 len)
+{
+  gchar *str = g_malloc (len + 1);
+
+  if (len > 0 && fread (str, len, 1, log) != 1) {
+    g_free (str);
+    return NULL;
+  }
+  str[len] = '\0';
+
+  return str;
+}
+
+/* reads the log after the magic, prints it as text when @reader is %NULL
+ * and parses the tracer records for @reader otherwise */
+static void
+read_binary_log (const gchar * filename, FILE * log, LogReader * reader)
+{
+  GHashTable *strings;
+  guint32 order, pid;
+  gboolean swap;
+  gint tag;
+
+  if (!read_binary (log, &order, 4, FALSE) || !read_binary (log, &pid, 4,
+          FALSE))
+    goto truncated;
+  if (order != 0x01020304 && order != 0x04030201)
+    goto corrupt;
+  swap = (order != 0x01020304);
+  if (swap)
+    pid = GUINT32_SWAP_LE_BE (pid);
+
+  strings = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  while ((tag = fgetc (log)) != EOF) {
+    if (tag == 'S') {
+      guint32 id, len;
+      gchar *str;
+
+      if (!read_binary (log, &id, 4, swap) || !read_binary (log, &len, 4, swap)
+          || !(str = read_binary_string (log, len)))
+        break;
+      g_hash_table_insert (strings, GUINT_TO_POINTER (id), str);
+    } else if (tag == 'L') {
+      guint8 level;
+      guint32 line, cat, file, func, obj_len, msg_len;
+      guint64 ts, thread;
+      gchar *obj, *msg;
+
+      if (!read_binary (log, &level, 1, swap)
+          || !read_binary (log, &line, 4, swap)
+          || !read_binary (log, &cat, 4, swap)
+          || !read_binary (log, &file, 4, swap)
+          || !read_binary (log, &func, 4, swap)
+          || !read_binary (log, &ts, 8, swap)
+          || !read_binary (log, &thread, 8, swap)
+          || !read_binary (log, &obj_len, 4, swap)
+          || !read_binary (log, &msg_len, 4, swap))
+        break;
+      if (!(obj = read_binary_string (log, obj_len)))
+        break;
+      if (!(msg = read_binary_string (log, msg_len))) {
+        g_free (obj);
+        break;
+      }
+
+      if (!reader) {
+        gchar thread_str[24];
+
+        g_snprintf (thread_str, sizeof (thread_str), "0x%" G_GINT64_MODIFIER
+            "x", thread);
+        printf ("%" GST_TIME_FORMAT " %5u %14s %s %20s %s:%u:%s:%s %s\n",
+            GST_TIME_ARGS (ts), pid, thread_str,
+            gst_debug_level_get_name (level),
+            (gchar *) g_hash_table_lookup (strings, GUINT_TO_POINTER (cat)),
+            (gchar *) g_hash_table_lookup (strings, GUINT_TO_POINTER (file)),
+            line, (gchar *) g_hash_table_lookup (strings,
+                GUINT_TO_POINTER (func)), obj, msg);
+      } else if (level == GST_LEVEL_TRACE) {
+        parse_trace_record (reader, msg);
+      }
+      g_free (obj);
+      g_free (msg);
+    } else {
+      g_hash_table_unref (strings);
+      goto corrupt;
+    }
+  }
+  if (tag != EOF)
+    GST_WARNING ("truncated binary log: %s", filename);
+
+  g_hash_table_unref (strings);
+  return;
+
+truncated:
+  {
+    GST_WARNING ("truncated binary log: %s", filename);
+    return;
+  }
+corrupt:
+  {
+    GST_WARNING ("corrupt binary log: %s", filename);
+    return;
+  }
+}
+
+static gboolean
+is_binary_log (FILE * log)
+{
+  gchar magic[8];
+
+  if (fread (magic, sizeof (magic), 1, log) == 1
+      && !memcmp (magic, BINARY_LOG_MAGIC, sizeof (magic)))
+    return TRUE;
+
+  rewind (log);
+  return FALSE;
+}
+
+static void
+decode_log (const gchar * filename)
+{
+  FILE *log;
+
+  if (!(log = fopen (filename, "rb"))) {
+    g_printerr ("Could not open %s\n", filename);
+    return;
+  }
+
+  if (is_binary_log (log))
+    read_binary_log (filename, log, NULL);
+  else
+    g_printerr ("%s is not a binary log\n", filename);
+
+  fclose (log);
+}
+
+static void
+parse_log (LogReader * reader)
+{
+  const gchar *filename = reader->filename;
   FILE *log;
 
-  if ((log = fopen (filename, "rt"))) {
+  if ((log = fopen (filename, "rb")) && is_binary_log (log)) {
+    read_binary_log (filename, log, reader);
+    fclose (log);
+  } else if (log) {
     gchar line[5001];
 
     /* probe format */
     if (fgets (line, 5000, log)) {
       GMatchInfo *match_info;
       GRegex *parser;
-      GstStructure *s;
       guint lnr = 0;
       gchar *level, *data;
 
@@ -793,36 +1229,10 @@ collect_stats (const gchar * filename)
             level = g_match_info_fetch (match_info, 4);
             if (!strcmp (level, "TRACE")) {
               data = g_match_info_fetch (match_info, 7);
-              if ((s = gst_structure_from_string (data, NULL))) {
-                const gchar *name = gst_structure_get_name (s);
-
-                if (!strcmp (name, "new-pad")) {
-                  new_pad_stats (s);
-                } else if (!strcmp (name, "new-element")) {
-                  new_element_stats (s);
-                } else if (!strcmp (name, "buffer")) {
-                  do_buffer_stats (s);
-                } else if (!strcmp (name, "event")) {
-                  do_event_stats (s);
-                } else if (!strcmp (name, "message")) {
-                  do_message_stats (s);
-                } else if (!strcmp (name, "query")) {
-                  do_query_stats (s);
-                } else if (!strcmp (name, "thread-rusage")) {
-                  do_thread_rusage_stats (s);
-                } else if (!strcmp (name, "proc-rusage")) {
-                  do_proc_rusage_stats (s);
-                } else {
-                  // TODO(ensonic): parse the xxx.class log lines
-                  if (!g_str_has_suffix (data, ".class")) {
-                    GST_WARNING ("unknown log entry: '%s'", data);
-                  }
-                }
-                gst_structure_free (s);
-              } else {
-                GST_WARNING ("unknown log entry: '%s'", data);
-              }
+              parse_trace_record (reader, data);
+              g_free (data);
             }
+            g_free (level);
           } else {
             if (*line) {
               GST_WARNING ("foreign log entry: %s:%d:'%s'", filename, lnr,
@@ -843,7 +1253,97 @@ collect_stats (const gchar * filename)
       GST_WARNING ("empty log");
     }
     fclose (log);
+  } else {
+    g_printerr ("Could not open %s\n", filename);
+  }
+}
+
+static gpointer
+reader_thread_func (LogReader * reader)
+{
+  parse_log (reader);
+
+  g_mutex_lock (&reader->lock);
+  if (reader->batch->len)
+    g_queue_push_tail (&reader->batches, reader->batch);
+  else
+    g_ptr_array_unref (reader->batch);
+  reader->batch = NULL;
+  reader->done = TRUE;
+  g_cond_signal (&reader->cond);
+  g_mutex_unlock (&reader->lock);
+
+  return NULL;
+}
+
+static LogReader *
+reader_new (const gchar * filename)
+{
+  LogReader *reader = g_slice_new0 (LogReader);
+
+  reader->filename = filename;
+  g_mutex_init (&reader->lock);
+  g_cond_init (&reader->cond);
+  g_queue_init (&reader->batches);
+  reader->batch = g_ptr_array_new ();
+  reader->thread = g_thread_new ("gst-stats-parser",
+      (GThreadFunc) reader_thread_func, reader);
+
+  return reader;
+}
+
+/* returns the next batch of records or %NULL when the whole log was read */
+static GPtrArray *
+reader_pop (LogReader * reader)
+{
+  GPtrArray *batch;
+
+  g_mutex_lock (&reader->lock);
+  while (g_queue_is_empty (&reader->batches) && !reader->done)
+    g_cond_wait (&reader->cond, &reader->lock);
+  batch = g_queue_pop_head (&reader->batches);
+  g_cond_signal (&reader->cond);
+  g_mutex_unlock (&reader->lock);
+
+  return batch;
+}
+
+static void
+reader_free (LogReader * reader)
+{
+  g_thread_join (reader->thread);
+  g_mutex_clear (&reader->lock);
+  g_cond_clear (&reader->cond);
+  g_slice_free (LogReader, reader);
+}
+
+/* the logs are parsed in parallel and aggregated in the given order, the
+ * files can be the parts of a log that was split */
+static void
+collect_stats (gchar ** filenames)
+{
+  LogReader **readers;
+  guint i, j, num = g_strv_length (filenames);
+
+  readers = g_new (LogReader *, num);
+  for (i = 0; i < num; i++)
+    readers[i] = reader_new (filenames[i]);
+
+  for (i = 0; i < num; i++) {
+    GPtrArray *batch;
+
+    while ((batch = reader_pop (readers[i]))) {
+      for (j = 0; j < batch->len; j++) {
+        GstStructure *s = g_ptr_array_index (batch, j);
+
+        process_trace_record (s);
+        gst_structure_free (s);
+      }
+      g_ptr_array_unref (batch);
+    }
+    reader_free (readers[i]);
   }
+  g_free (readers);
 }
 
 gint
@@ -853,8 +1353,15 @@ main (gint argc, gchar * argv[])
   guint num;
   GError *err = NULL;
   GOptionContext *ctx;
+  gboolean decode = FALSE;
+  gint interval = 0;
   GOptionEntry options[] = {
     GST_TOOLS_GOPTION_VERSION,
+    {"decode", 'd', 0, G_OPTION_ARG_NONE, &decode,
+        N_("Print a binary debug log as text"), NULL},
+    {"interval", 'i', 0, G_OPTION_ARG_INT, &interval,
+          N_("Print the overall statistics every SECONDS seconds of the log"),
+        N_("SECONDS")},
     // TODO(ensonic): add a summary flag, if set read the whole thing, print
     // stats once, and exit
     {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL}
@@ -870,7 +1377,7 @@ main (gint argc, gchar * argv[])
 
   g_set_prgname ("gst-stats-" GST_API_VERSION);
 
-  ctx = g_option_context_new ("FILE");
+  ctx = g_option_context_new ("FILE...");
   g_option_context_add_main_entries (ctx, options, GETTEXT_PACKAGE);
   g_option_context_add_group (ctx, gst_init_get_option_group ());
   if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
@@ -886,14 +1393,18 @@ main (gint argc, gchar * argv[])
     return 1;
   }
   num = g_strv_length (filenames);
-  if (num == 0 || num > 1) {
+  if (decode && num > 1) {
     g_print ("Please give exactly one filename to %s (%d given).\n\n",
         g_get_prgname (), num);
     return 1;
   }
+  if (interval > 0)
+    report_interval = interval * GST_SECOND;
 
-  if (init ()) {
-    collect_stats (filenames[0]);
+  if (decode) {
+    decode_log (filenames[0]);
+  } else if (init ()) {
+    collect_stats (filenames);
     print_stats ();
   }
   done ();